@@ -70,6 +70,47 @@ void BM_InitOp(int iters) {
 }
 BENCHMARK(BM_InitOp);
 
+// Measures the dispatch work preceding the execution of an op: reset, inputs
+// and attrs. The op is reset for MatMul every time, as at the call site of a
+// loop, or alternately for MatMul and Identity.
+void BM_ResetOp(int iters, int alternate) {
+  tensorflow::testing::StopTiming();
+  tensorflow::testing::SetLabel(alternate ? "Alternate" : "SameOp");
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_Op* op = TFE_NewOp(ctx, "MatMul", status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  tensorflow::testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    if (alternate && i % 2 == 1) {
+      TFE_OpReset(op, "Identity", nullptr, status);
+      CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_OpAddInput(op, m, status);
+      CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    } else {
+      TFE_OpReset(op, "MatMul", nullptr, status);
+      CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_OpAddInput(op, m, status);
+      CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_OpAddInput(op, m, status);
+      CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_OpSetAttrBool(op, "transpose_a", 0);
+      TFE_OpSetAttrBool(op, "transpose_b", 0);
+    }
+  }
+  tensorflow::testing::StopTiming();
+  TFE_DeleteOp(op);
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+BENCHMARK(BM_ResetOp)->Arg(0)->Arg(1);
+
 void BM_Execute(int iters, int async) {
   tensorflow::testing::StopTiming();
   tensorflow::testing::SetLabel(async ? "ExecuteAsync" : "Execute");
@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/c/eager/c_api_experimental.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tf_status_internal.h"
+#include "tensorflow/c/tf_tensor.h"
+#include "tensorflow/c/tf_tensor_internal.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -111,8 +113,15 @@ DLContext GetDlContext(TFE_TensorHandle* h, TF_Status* status) {
   DLContext ctx;
   const char* device_name =
       tensorflow::unwrap(h)->BackingDeviceName(&status->status);
+  if (!status->status.ok()) {
+    return ctx;
+  }
   DeviceNameUtils::ParsedName parsed_name;
-  tensorflow::DeviceNameUtils::ParseFullName(device_name, &parsed_name);
+  if (!tensorflow::DeviceNameUtils::ParseFullName(device_name, &parsed_name)) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Unable to parse device name ", device_name);
+    return ctx;
+  }
   std::string device_type = parsed_name.type;
   int device_id = 0;
   if (parsed_name.has_id) {
@@ -225,6 +234,30 @@ void DeallocatorWrapperFunc(void* data, size_t len, void* dlmt_vptr) {
   TFE_CallDLManagedTensorDeleter(dlmt_vptr);
 }
 
+// Argument of DeviceDeallocatorWrapperFunc. `device` is null until the tensor
+// handle aliasing the DLPack tensor has been created.
+struct DeviceDeallocatorArg {
+  DLManagedTensor* dlmt;
+  Device* device;
+};
+
+// Like DeallocatorWrapperFunc, but first waits for the kernels queued on the
+// device of the aliasing tensor handle. The memory is owned by another
+// framework, which may reuse it as soon as the deleter is called, while TF
+// kernels reading it may still be pending on the device streams.
+void DeviceDeallocatorWrapperFunc(void* data, size_t len, void* arg_vptr) {
+  DeviceDeallocatorArg* arg = static_cast<DeviceDeallocatorArg*>(arg_vptr);
+  if (arg->device != nullptr) {
+    Status s = arg->device->Sync();
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to synchronize " << arg->device->name()
+                 << " before releasing a DLPack tensor: " << s;
+    }
+  }
+  TFE_CallDLManagedTensorDeleter(arg->dlmt);
+  delete arg;
+}
+
 // Checks whether the stride array matches the layout of compact, row-majored
 // data.
 bool IsValidStrideCompactRowMajorData(int64_t* shape_arr, int64_t* stride_arr,
@@ -239,53 +272,101 @@ bool IsValidStrideCompactRowMajorData(int64_t* shape_arr, int64_t* stride_arr,
   }
   return true;
 }
-}  // namespace
 
-void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
-  DLManagedTensor* dlMTensor = static_cast<DLManagedTensor*>(dlm_ptr);
-  if (dlMTensor->deleter != nullptr) {
-    dlMTensor->deleter(dlMTensor);
+// Returns a DLManagedTensor aliasing `data`, the buffer of `tensor` on the
+// device described by `dl_ctx`. The buffer is kept alive until the deleter of
+// the returned tensor is called.
+DLManagedTensor* NewDLManagedTensor(const Tensor& tensor,
+                                    const DLContext& dl_ctx, void* data,
+                                    TF_Status* status) {
+  DLDataType dtype =
+      GetDlDataType(static_cast<TF_DataType>(tensor.dtype()), status);
+  if (!status->status.ok()) {
+    return nullptr;
   }
-}
 
-void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
-  const Tensor* tensor = GetTensorFromHandle(h, status);
-  TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
-  TensorReference tensor_ref(*tensor);  // This will call buf_->Ref()
-
-  auto* tf_dlm_tensor_ctx = new TfDlManagedTensorCtx(tensor_ref);
-  tf_dlm_tensor_ctx->reference = tensor_ref;
+  // This will call buf_->Ref(), the deleter calls the matching Unref().
+  auto* tf_dlm_tensor_ctx = new TfDlManagedTensorCtx(TensorReference(tensor));
 
   DLManagedTensor* dlm_tensor = &tf_dlm_tensor_ctx->tensor;
   dlm_tensor->manager_ctx = tf_dlm_tensor_ctx;
   dlm_tensor->deleter = &DLManagedTensorDeleter;
-  dlm_tensor->dl_tensor.ctx = GetDlContext(h, status);
-  int ndim = tensor->dims();
+  dlm_tensor->dl_tensor.ctx = dl_ctx;
+  int ndim = tensor.dims();
   dlm_tensor->dl_tensor.ndim = ndim;
-  dlm_tensor->dl_tensor.data = TFE_TensorHandleDevicePointer(h, status);
-  dlm_tensor->dl_tensor.dtype = GetDlDataType(data_type, status);
+  dlm_tensor->dl_tensor.data = data;
+  dlm_tensor->dl_tensor.dtype = dtype;
 
   std::vector<int64_t>* shape_arr = &tf_dlm_tensor_ctx->shape;
   std::vector<int64_t>* stride_arr = &tf_dlm_tensor_ctx->strides;
   shape_arr->resize(ndim);
   stride_arr->resize(ndim, 1);
   for (int i = 0; i < ndim; i++) {
-    (*shape_arr)[i] = tensor->dim_size(i);
+    (*shape_arr)[i] = tensor.dim_size(i);
   }
   for (int i = ndim - 2; i >= 0; --i) {
     (*stride_arr)[i] = (*shape_arr)[i + 1] * (*stride_arr)[i + 1];
   }
 
-  dlm_tensor->dl_tensor.shape = &(*shape_arr)[0];
+  dlm_tensor->dl_tensor.shape = shape_arr->data();
   // There are two ways to represent compact row-major data
   // 1) nullptr indicates tensor is compact and row-majored.
   // 2) fill in the strides array as the real case for compact row-major data.
   // Here we choose option 2, since some frameworks didn't handle the strides
   // argument properly.
-  dlm_tensor->dl_tensor.strides = &(*stride_arr)[0];
+  dlm_tensor->dl_tensor.strides = stride_arr->data();
   dlm_tensor->dl_tensor.byte_offset =
       0;  // TF doesn't handle the strides and byte_offsets here
-  return static_cast<void*>(dlm_tensor);
+  return dlm_tensor;
+}
+
+// Validates `dl_tensor`, and returns the TF type, the address and the size in
+// bytes of the data it describes.
+Status ParseDlTensor(const DLTensor& dl_tensor, TF_DataType* dtype,
+                     void** data, size_t* total_bytes) {
+  if (dl_tensor.dtype.lanes != 1) {
+    return tensorflow::errors::InvalidArgument(
+        "Unsupported number of lanes from DLPack: ", dl_tensor.dtype.lanes);
+  }
+  TF_RETURN_IF_ERROR(TfDataTypeFormDlDataType(dl_tensor.dtype, dtype));
+  if (dl_tensor.strides != nullptr &&
+      !IsValidStrideCompactRowMajorData(dl_tensor.shape, dl_tensor.strides,
+                                        dl_tensor.ndim)) {
+    return tensorflow::errors::InvalidArgument(
+        "Invalid strides array from DLPack");
+  }
+  *total_bytes = dl_tensor.dtype.bits / 8;
+  for (int i = 0; i < dl_tensor.ndim; i++) {
+    *total_bytes *= dl_tensor.shape[i];
+  }
+  *data = static_cast<char*>(dl_tensor.data) + dl_tensor.byte_offset;
+  return Status::OK();
+}
+}  // namespace
+
+void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
+  DLManagedTensor* dlMTensor = static_cast<DLManagedTensor*>(dlm_ptr);
+  if (dlMTensor->deleter != nullptr) {
+    dlMTensor->deleter(dlMTensor);
+  }
+}
+
+void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
+  const Tensor* tensor = GetTensorFromHandle(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  DLContext dl_ctx = GetDlContext(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  // This waits for the kernels queued on the device of `h`, so the consumer
+  // can read the data without synchronizing with the TF streams.
+  void* data = TFE_TensorHandleDevicePointer(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  return static_cast<void*>(NewDLManagedTensor(*tensor, dl_ctx, data, status));
 }
 
 TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
@@ -300,33 +381,72 @@ TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
     return nullptr;
   }
   TF_DataType dtype;
-  Status s = TfDataTypeFormDlDataType(dl_tensor->dtype, &dtype);
+  void* data;
+  size_t total_bytes;
+  Status s = ParseDlTensor(*dl_tensor, &dtype, &data, &total_bytes);
   if (!s.ok()) {
     status->status = std::move(s);
     return nullptr;
   }
-  int num_dims = dl_tensor->ndim;
-  const int64_t* dims = dl_tensor->shape;
-  void* data = dl_tensor->data;
 
-  size_t total_bytes = dl_tensor->dtype.bits / 8;
-  for (int i = 0; i < num_dims; i++) {
-    total_bytes *= dims[i];
+  if (dl_tensor->ctx.device_type == DLDeviceType::kDLCPU) {
+    return TFE_NewTensorHandleFromDeviceMemory(
+        ctx, device_name.value().c_str(), dtype, dl_tensor->shape,
+        dl_tensor->ndim, data, total_bytes, &DeallocatorWrapperFunc, dlmt,
+        status);
   }
 
-  if (dl_tensor->strides != nullptr &&
-      !IsValidStrideCompactRowMajorData(dl_tensor->shape, dl_tensor->strides,
-                                        num_dims)) {
-    status->status = tensorflow::errors::InvalidArgument(
-        "Invalid strides array from DLPack");
-    return nullptr;
+  auto* arg = new DeviceDeallocatorArg{dlmt, nullptr};
+  TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
+      ctx, device_name.value().c_str(), dtype, dl_tensor->shape,
+      dl_tensor->ndim, data, total_bytes, &DeviceDeallocatorWrapperFunc, arg,
+      status);
+  if (handle != nullptr) {
+    // The handle keeps the buffer alive, so the deallocator cannot run yet.
+    tensorflow::TensorHandle* tensor_handle =
+        tensorflow::TensorHandleFromInterface(tensorflow::unwrap(handle));
+    if (!VariantDeviceIsCustom(tensor_handle->device())) {
+      arg->device = absl::get<Device*>(tensor_handle->device());
+    }
   }
+  return handle;
+}
 
-  TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
-      ctx, device_name.value().c_str(), dtype, dims, num_dims, data,
-      total_bytes, &DeallocatorWrapperFunc, dlmt, status);
+void* TF_TensorToDLPack(TF_Tensor* t, TF_Status* status) {
+  if (t == nullptr) {
+    status->status = tensorflow::errors::InvalidArgument("Invalid tensor");
+    return nullptr;
+  }
+  Tensor tensor;
+  status->status = TF_TensorToTensor(t, &tensor);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  DLContext dl_ctx;
+  dl_ctx.device_type = DLDeviceType::kDLCPU;
+  dl_ctx.device_id = 0;
+  return static_cast<void*>(
+      NewDLManagedTensor(tensor, dl_ctx, tensor.data(), status));
+}
 
-  return handle;
+TF_Tensor* TF_TensorFromDLPack(void* dlm, TF_Status* status) {
+  DLManagedTensor* dlmt = static_cast<DLManagedTensor*>(dlm);
+  DLTensor* dl_tensor = &dlmt->dl_tensor;
+  if (dl_tensor->ctx.device_type != DLDeviceType::kDLCPU) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "TF_Tensor only supports DLPack tensors in host memory");
+    return nullptr;
+  }
+  TF_DataType dtype;
+  void* data;
+  size_t total_bytes;
+  Status s = ParseDlTensor(*dl_tensor, &dtype, &data, &total_bytes);
+  if (!s.ok()) {
+    status->status = std::move(s);
+    return nullptr;
+  }
+  return TF_NewTensor(dtype, dl_tensor->shape, dl_tensor->ndim, data,
+                      total_bytes, &DeallocatorWrapperFunc, dlmt);
 }
 
 }  // namespace tensorflow
@@ -24,15 +24,31 @@ namespace tensorflow {
 const char* const kDlTensorCapsuleName = "dltensor";
 
 // Converts eager tensor handle to DLPack (DLManagedTensor*), and return the
-// void* for further PyCapsule construction.
+// void* for further PyCapsule construction. The DLPack tensor aliases the
+// memory of `h`, which is kept alive until its deleter is called. This blocks
+// until the kernels producing `h` have completed on its device, so the memory
+// can be read without synchronizing with TF.
 TF_CAPI_EXPORT extern void* TFE_HandleToDLPack(TFE_TensorHandle* h,
                                                TF_Status* status);
 
-// Converts DLPack (DLManagedTensor*) to eager tensor handle.
+// Converts DLPack (DLManagedTensor*) to an eager tensor handle aliasing its
+// memory. The data must be ready when this is called. On success the handle
+// owns `dlm`, whose deleter is called once the memory is no longer used by TF;
+// for device memory, this waits for the kernels queued on the device first.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
                                                              TF_Status* status,
                                                              TFE_Context* ctx);
 
+// Converts a TF_Tensor to DLPack (DLManagedTensor*) aliasing its memory, which
+// is kept alive until the deleter of the DLPack tensor is called.
+TF_CAPI_EXPORT extern void* TF_TensorToDLPack(TF_Tensor* t, TF_Status* status);
+
+// Converts DLPack (DLManagedTensor*) in host memory to a TF_Tensor. On success
+// the TF_Tensor owns `dlm`. As with TF_NewTensor, the data is aliased unless it
+// is not aligned as required by TF, in which case it is copied.
+TF_CAPI_EXPORT extern TF_Tensor* TF_TensorFromDLPack(void* dlm,
+                                                     TF_Status* status);
+
 // Calls the destructor of DLManagedTensor, used in the destructor of PyCapsule.
 TF_CAPI_EXPORT extern void TFE_CallDLManagedTensorDeleter(void* dlm_ptr);
 }  // namespace tensorflow
@@ -0,0 +1,140 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/c/eager/dlpack.h"
+
+#include <vector>
+
+#include "include/dlpack/dlpack.h"  // from @dlpack
+#include "tensorflow/c/eager/c_api.h"
+#include "tensorflow/c/eager/c_api_test_util.h"
+#include "tensorflow/c/tf_status.h"
+#include "tensorflow/c/tf_tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A DLManagedTensor owned by the test, recording whether it was deleted.
+struct TestDLManagedTensor {
+  std::vector<int64_t> shape;
+  DLManagedTensor tensor;
+  bool deleted = false;
+
+  TestDLManagedTensor(void* data, std::vector<int64_t> dims,
+                      uint64_t byte_offset)
+      : shape(std::move(dims)) {
+    tensor.dl_tensor.data = data;
+    tensor.dl_tensor.ctx = {kDLCPU, 0};
+    tensor.dl_tensor.ndim = shape.size();
+    tensor.dl_tensor.dtype = {kDLFloat, 32, 1};
+    tensor.dl_tensor.shape = shape.data();
+    tensor.dl_tensor.strides = nullptr;
+    tensor.dl_tensor.byte_offset = byte_offset;
+    tensor.manager_ctx = this;
+    tensor.deleter = [](DLManagedTensor* self) {
+      static_cast<TestDLManagedTensor*>(self->manager_ctx)->deleted = true;
+    };
+  }
+};
+
+TEST(DLPackTest, TensorRoundTripAliasesMemory) {
+  TF_Status* status = TF_NewStatus();
+  const int64_t dims[] = {2, 3};
+  TF_Tensor* t = TF_AllocateTensor(TF_FLOAT, dims, 2, 6 * sizeof(float));
+  float* data = static_cast<float*>(TF_TensorData(t));
+  for (int i = 0; i < 6; ++i) data[i] = i;
+
+  DLManagedTensor* dlm =
+      static_cast<DLManagedTensor*>(TF_TensorToDLPack(t, status));
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(data, dlm->dl_tensor.data);
+  EXPECT_EQ(kDLCPU, dlm->dl_tensor.ctx.device_type);
+  EXPECT_EQ(kDLFloat, dlm->dl_tensor.dtype.code);
+  EXPECT_EQ(32, dlm->dl_tensor.dtype.bits);
+  ASSERT_EQ(2, dlm->dl_tensor.ndim);
+  EXPECT_EQ(2, dlm->dl_tensor.shape[0]);
+  EXPECT_EQ(3, dlm->dl_tensor.shape[1]);
+  EXPECT_EQ(3, dlm->dl_tensor.strides[0]);
+  EXPECT_EQ(1, dlm->dl_tensor.strides[1]);
+  // The DLPack tensor keeps the buffer alive.
+  TF_DeleteTensor(t);
+
+  TF_Tensor* result = TF_TensorFromDLPack(dlm, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(data, TF_TensorData(result));
+  EXPECT_EQ(6 * sizeof(float), TF_TensorByteSize(result));
+  EXPECT_EQ(5.0f, static_cast<float*>(TF_TensorData(result))[5]);
+  TF_DeleteTensor(result);
+  TF_DeleteStatus(status);
+}
+
+TEST(DLPackTest, TensorFromDLPackAppliesByteOffset) {
+  TF_Status* status = TF_NewStatus();
+  alignas(64) float buffer[32] = {};
+  buffer[16] = 42.0f;
+  TestDLManagedTensor dlm(buffer, {4, 4}, 16 * sizeof(float));
+
+  TF_Tensor* t = TF_TensorFromDLPack(&dlm.tensor, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(&buffer[16], TF_TensorData(t));
+  EXPECT_EQ(42.0f, static_cast<float*>(TF_TensorData(t))[0]);
+  EXPECT_FALSE(dlm.deleted);
+  TF_DeleteTensor(t);
+  EXPECT_TRUE(dlm.deleted);
+  TF_DeleteStatus(status);
+}
+
+TEST(DLPackTest, TensorFromDLPackRejectsVectorTypes) {
+  TF_Status* status = TF_NewStatus();
+  alignas(64) float buffer[4] = {};
+  TestDLManagedTensor dlm(buffer, {2}, 0);
+  dlm.tensor.dl_tensor.dtype.lanes = 2;
+
+  EXPECT_EQ(nullptr, TF_TensorFromDLPack(&dlm.tensor, status));
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  // The caller keeps the ownership of the DLPack tensor on failure.
+  EXPECT_FALSE(dlm.deleted);
+  TF_DeleteStatus(status);
+}
+
+TEST(DLPackTest, HandleRoundTrip) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* h = TestMatrixTensorHandle(ctx);
+  void* dlm = TFE_HandleToDLPack(h, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteTensorHandle(h);
+
+  TFE_TensorHandle* result = TFE_HandleFromDLPack(dlm, status, ctx);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_Tensor* t = TFE_TensorHandleResolve(result, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  float* data = static_cast<float*>(TF_TensorData(t));
+  EXPECT_EQ(1.0f, data[0]);
+  EXPECT_EQ(4.0f, data[3]);
+  TF_DeleteTensor(t);
+  TFE_DeleteTensorHandle(result);
+
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -24,6 +24,10 @@ constexpr char kSavedModelAssetsDirectory[] = "assets";
 /// SavedModel assets.extra directory.
 constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
 
+/// Directory of assets.extra in which to save the autotuning results of the
+/// kernels, see tensorflow/core/util/autotune_cache_registry.h.
+constexpr char kSavedModelAutotuneCachesDirectory[] = "autotune";
+
 /// SavedModel assets key for graph collection-def.
 constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/autotune_cache_registry.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -219,6 +220,20 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Starts the kernels with the autotuning results saved with the SavedModel,
+// if any. They only save time, so failing to load them is not an error.
+void LoadAutotuneCachesIfPresent(const string& export_dir) {
+  const string dir = io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                                  kSavedModelAutotuneCachesDirectory);
+  if (!Env::Default()->IsDirectory(dir).ok()) return;
+  const Status status =
+      autotune_cache_registry::LoadAutotuneCaches(Env::Default(), dir);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring the autotuning results of the SavedModel: "
+                 << status;
+  }
+}
+
 }  // namespace
 
 SavedModelBundleInterface::~SavedModelBundleInterface() {}
@@ -244,6 +259,7 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
+  LoadAutotuneCachesIfPresent(export_dir);
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return Status::OK();
@@ -24,7 +24,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <mutex>   // NOLINT(build/c++11)
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -103,37 +105,73 @@ void DumpStatsToStdout(const Stats& stats) {
   // Dump stats out.
   printf("Benchmark ran %zu iterations over %lld us\n", count_us,
          static_cast<long long>(stats.total_us));  // NOLINT
+  printf("  %-*s %*.3f iters/s\n", max_label_size, "Throughput:",
+         max_digits + 4,
+         stats.total_us > 0 ? count_us * 1e6 / stats.total_us : 0.0);
   for (const auto& g : groups) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
 }
 
-void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
-  // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
-  const int64 max_us = (options.max_micros <= 0 && options.max_iters <= 0)
-                           ? Options::kDefaultMicros
-                           : options.max_micros;
-  // NOLINTNEXTLINE
-  printf("Running benchmark for %lld us\n", static_cast<long long>(max_us));
-  const int64 start_us = NowMicros();
+// Runs `fn` until either limit is reached, appending the duration of each
+// iteration to `per_iter_us`. Returns the time at which the loop stopped.
+static int64 RunLoop(const BenchmarkFn& fn, int64 start_us, int64 max_us,
+                     int64 max_iters, std::vector<int64>* per_iter_us) {
   int64 iters = 0;
   while (true) {
     const int64 iter_start_us = NowMicros();
     fn();
     const int64 end_us = NowMicros();
     // Collect stats and decide whether to stop.
-    stats->per_iter_us.push_back(end_us - iter_start_us);
-    const int64 total_us = end_us - start_us;
+    per_iter_us->push_back(end_us - iter_start_us);
     ++iters;
-    if ((max_us > 0 && total_us >= max_us) ||
-        (options.max_iters > 0 && iters >= options.max_iters)) {
-      stats->total_us = total_us;
-      break;
+    if ((max_us > 0 && end_us - start_us >= max_us) ||
+        (max_iters > 0 && iters >= max_iters)) {
+      return end_us;
     }
   }
 }
 
+void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
+  // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
+  const int64 max_us = (options.max_micros <= 0 && options.max_iters <= 0)
+                           ? Options::kDefaultMicros
+                           : options.max_micros;
+  // NOLINTNEXTLINE
+  printf("Running benchmark for %lld us\n", static_cast<long long>(max_us));
+  const int64 start_us = NowMicros();
+  if (options.num_threads <= 1) {
+    stats->total_us = RunLoop(fn, start_us, max_us, options.max_iters,
+                              &stats->per_iter_us) -
+                      start_us;
+    return;
+  }
+
+  // Each thread collects its own stats, which are merged once all threads are
+  // done so that the mutex is not on the timed path.
+  std::mutex mu;
+  int64 end_us = start_us;
+  std::vector<std::thread> threads;
+  threads.reserve(options.num_threads);
+  for (int i = 0; i < options.num_threads; ++i) {
+    threads.emplace_back([&] {
+      std::vector<int64> per_iter_us;
+      per_iter_us.reserve(5000);
+      const int64 thread_end_us =
+          RunLoop(fn, start_us, max_us, options.max_iters, &per_iter_us);
+      std::lock_guard<std::mutex> lock(mu);
+      stats->per_iter_us.insert(stats->per_iter_us.end(), per_iter_us.begin(),
+                                per_iter_us.end());
+      end_us = std::max(end_us, thread_end_us);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  stats->total_us = end_us - start_us;
+}
+
 }  // namespace benchmark
 }  // namespace tfcompile
 }  // namespace tensorflow
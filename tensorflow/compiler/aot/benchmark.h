@@ -42,12 +42,16 @@ struct Options {
 
   int64 max_iters = 0;   // Maximum iterations to run, ignored if <= 0.
   int64 max_micros = 0;  // Maximum microseconds to run, ignored if <= 0.
+
+  // Number of threads calling the benchmarked function concurrently. Each
+  // thread runs max_iters iterations, or until max_micros have passed.
+  int num_threads = 1;
 };
 
 // Stats holds statistics collected during benchmarking.
 struct Stats {
-  std::vector<int64> per_iter_us;  // Per-iteration deltas in us.
-  int64 total_us;                  // Total time in us.
+  std::vector<int64> per_iter_us;  // Per-iteration deltas in us, all threads.
+  int64 total_us;                  // Total wall time in us.
 
   Stats() : total_us(0) { per_iter_us.reserve(5000); }
 };
@@ -60,7 +64,10 @@ void DumpStatsToStdout(const Stats& stats);
 typedef std::function<void()> BenchmarkFn;
 
 // Benchmark runs a benchmark of the function `fn`, collecting stats in `stats`.
-// Use `options` to configure benchmarking options.
+// Use `options` to configure benchmarking options. If options.num_threads > 1,
+// `fn` is called concurrently and must be thread-safe; tfcompile generated
+// classes are not, so use an XlaCompiledCpuFunctionPool to get an instance per
+// call.
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats);
 
 }  // namespace benchmark
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/aot/benchmark.h"
 
 #include "tensorflow/compiler/aot/test_graph_tfadd.h"
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function_pool.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -40,6 +41,29 @@ TEST(Benchmark, Benchmark) {
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
 }
 
+TEST(Benchmark, MultipleThreads) {
+  XlaCompiledCpuFunctionPool<AddComp> pool;
+
+  Options options;
+  options.max_iters = 5;
+  options.num_threads = 4;
+  Stats stats;
+  Benchmark(
+      options,
+      [&] {
+        auto add = pool.Acquire();
+        add->arg0_data()[0] = 1;
+        add->arg1_data()[0] = 2;
+        ASSERT_TRUE(add->Run());
+        EXPECT_EQ(add->result0_data()[0], 3);
+      },
+      &stats);
+  EXPECT_EQ(stats.per_iter_us.size(), 20);
+  // Every instance has been returned, and at most one was created per thread.
+  EXPECT_GE(pool.num_idle(), 1);
+  EXPECT_LE(pool.num_idle(), 4);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tfcompile
@@ -411,6 +411,7 @@ def tf_library(
             deps = [
                 ":" + name,
                 "//tensorflow/compiler/aot:benchmark",
+                "//tensorflow/compiler/tf2xla:xla_compiled_cpu_function_pool",
                 "//tensorflow/compiler/xla:executable_run_options",
                 "//third_party/eigen3",
             ] + if_android([
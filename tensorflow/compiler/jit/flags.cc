@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/flags.h"
 
+#include <algorithm>
 #include <mutex>  // NOLINT
 
 #include "absl/base/call_once.h"
@@ -163,6 +164,7 @@ void AllocateAndParseFlags() {
 
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
+  ops_flags->tf_xla_async_compilation = false;
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -170,6 +172,21 @@ void AllocateAndParseFlags() {
   mlir_flags = new MlirCommonFlags;
   mlir_flags->tf_mlir_enable_mlir_bridge = false;
 
+  auto setter_for_dynamic_dim_buckets = [](string sequence) {
+    ops_flags->tf_xla_dynamic_dim_buckets.clear();
+    for (absl::string_view bucket :
+         absl::StrSplit(sequence, ',', absl::SkipEmpty())) {
+      int64 size;
+      if (!absl::SimpleAtoi(bucket, &size) || size <= 0) {
+        return false;
+      }
+      ops_flags->tf_xla_dynamic_dim_buckets.push_back(size);
+    }
+    std::sort(ops_flags->tf_xla_dynamic_dim_buckets.begin(),
+              ops_flags->tf_xla_dynamic_dim_buckets.end());
+    return true;
+  };
+
   auto setter_for_jitter_tensor_names = [](string sequence) {
     jitter_flags->tensor_names = absl::StrSplit(sequence, ',');
     return true;
@@ -207,6 +224,17 @@ void AllocateAndParseFlags() {
 
        Flag("tf_xla_always_defer_compilation",
             &ops_flags->tf_xla_always_defer_compilation, ""),
+       Flag("tf_xla_async_compilation", &ops_flags->tf_xla_async_compilation,
+            "When lazy compilation is enabled, compile clusters on a "
+            "background thread pool and run them in the TF executor until "
+            "their executable is ready, instead of blocking on the "
+            "compilation."),
+       Flag("tf_xla_dynamic_dim_buckets", setter_for_dynamic_dim_buckets, "",
+            "Comma-separated sizes to round the leading dimension of cluster "
+            "inputs up to once it is seen to vary, e.g. \"32,64,128,256\". "
+            "The padding is masked with XLA's dynamic dimension support, and "
+            "clusters whose outputs would have dynamic shapes keep being "
+            "compiled per shape."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
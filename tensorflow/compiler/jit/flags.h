@@ -97,6 +97,16 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If true, _XlaCompile compiles clusters it has no executable for on a
+  // background thread, and runs them in the TF executor until the compilation
+  // finishes, instead of blocking the step.  Defaults to false.
+  bool tf_xla_async_compilation;
+
+  // Sorted sizes to round varying leading dimensions of cluster inputs up to,
+  // so that one executable serves every size within a bucket.  Empty (the
+  // default) compiles every distinct shape separately.
+  std::vector<int64> tf_xla_dynamic_dim_buckets;
 };
 
 // Flags for the build_xla_ops pass.
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <deque>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/jit/defs.h"
@@ -77,12 +79,15 @@ class XlaExecutableClosure {
   explicit XlaExecutableClosure(
       xla::LocalClient* client, xla::LocalExecutable* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      std::vector<int> padded_args, int num_args)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        padded_args_(std::move(padded_args)),
+        num_args_(num_args) {}
 
   XlaExecutableClosure(XlaExecutableClosure&&) = default;
   XlaExecutableClosure& operator=(XlaExecutableClosure&&) = default;
@@ -96,6 +101,8 @@ class XlaExecutableClosure {
     return resource_var_snapshots_;
   }
   int num_constant_args() const { return num_constant_args_; }
+  const std::vector<int>& padded_args() const { return padded_args_; }
+  int num_args() const { return num_args_; }
 
  private:
   xla::LocalClient* client_;
@@ -103,6 +110,8 @@ class XlaExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  std::vector<int> padded_args_;
+  int num_args_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(XlaExecutableClosure);
 };
@@ -166,10 +175,12 @@ static Status CompileToLocalExecutable(
     const XlaPlatformInfo& platform_info,
     absl::Span<const Tensor* const> inputs,
     absl::Span<VariableInfo const> variable_infos,
-    absl::Span<const int> constants, bool lazy, bool may_alias_resource_update,
+    absl::Span<const int> constants,
+    XlaCompilationCache::CompileMode compile_mode,
+    bool may_alias_resource_update,
     xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable, std::vector<int>* padded_args) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -209,10 +220,98 @@ static Status CompileToLocalExecutable(
       XlaComputationLaunchContext::BuildXlaCompilerArguments(constants, inputs,
                                                              variable_infos);
   TF_RETURN_IF_ERROR(args.status());
+  // Inputs are padded by copying them into larger buffers, which XLA devices
+  // don't hold their inputs in.
+  const bool can_pad_inputs =
+      !platform_info.is_on_xla_device() && !platform_info.UseMultipleStreams();
   return cache->Compile(options, function, *args, compile_options,
-                        lazy ? XlaCompilationCache::CompileMode::kLazy
-                             : XlaCompilationCache::CompileMode::kStrict,
-                        compilation_result, executable);
+                        compile_mode, compilation_result, executable,
+                        can_pad_inputs ? padded_args : nullptr);
+}
+
+// Pads the leading dimension of the inputs `padded_args` of `ctx` to the
+// shapes of the parameters of `compilation_result`, which were compiled for
+// bucketed shapes, and creates the size arguments following the `num_args`
+// arguments of the cluster. Fills `input_overrides` with the tensors to pass
+// instead of the inputs, which are owned by `padded_inputs`.
+static Status PadBucketedInputs(
+    OpKernelContext* ctx,
+    const XlaCompiler::CompilationResult& compilation_result,
+    const std::vector<int>& padded_args, int num_args,
+    int missing_ctx_input_prefix, std::deque<Tensor>* padded_inputs,
+    std::map<int, const Tensor*>* input_overrides) {
+  if (padded_args.empty()) {
+    return Status::OK();
+  }
+  std::map<int, const xla::Shape*> parameter_shapes;
+  for (int i = 0, end = compilation_result.input_mapping.size(); i < end;
+       ++i) {
+    parameter_shapes[compilation_result.input_mapping[i]] =
+        &compilation_result.xla_input_shapes[i];
+  }
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+
+  std::vector<Tensor> host_sizes;
+  for (int k = 0, end = padded_args.size(); k < end; ++k) {
+    const int arg_num = padded_args[k];
+    const Tensor& input = ctx->input(arg_num - missing_ctx_input_prefix);
+
+    const int size_arg_num = num_args + k;
+    padded_inputs->emplace_back();
+    Tensor* size = &padded_inputs->back();
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DT_INT32, TensorShape({}), size));
+    (*input_overrides)[size_arg_num] = size;
+    if (stream == nullptr) {
+      size->scalar<int32>()() = input.dim_size(0);
+    } else {
+      AllocatorAttributes host_alloc_attrs;
+      host_alloc_attrs.set_gpu_compatible(true);
+      host_alloc_attrs.set_on_host(true);
+      host_sizes.emplace_back();
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(DT_INT32, TensorShape({}),
+                                            &host_sizes.back(),
+                                            host_alloc_attrs));
+      host_sizes.back().scalar<int32>()() = input.dim_size(0);
+      se::DeviceMemoryBase size_dst(DMAHelper::base(size), sizeof(int32));
+      stream->ThenMemcpy(&size_dst, DMAHelper::base(&host_sizes.back()),
+                         sizeof(int32));
+    }
+
+    auto it = parameter_shapes.find(arg_num);
+    if (it == parameter_shapes.end()) continue;
+    TensorShape padded_shape;
+    TF_RETURN_IF_ERROR(XLAShapeToTensorShape(*it->second, &padded_shape));
+    if (padded_shape == input.shape()) continue;
+
+    padded_inputs->emplace_back();
+    Tensor* padded = &padded_inputs->back();
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(input.dtype(), padded_shape, padded));
+    (*input_overrides)[arg_num] = padded;
+    const uint64 num_bytes = input.TotalBytes();
+    if (num_bytes == 0) continue;
+    if (stream == nullptr) {
+      memcpy(DMAHelper::base(padded), DMAHelper::base(&input), num_bytes);
+    } else {
+      se::DeviceMemoryBase src(const_cast<void*>(DMAHelper::base(&input)),
+                               num_bytes);
+      se::DeviceMemoryBase dst(DMAHelper::base(padded), num_bytes);
+      stream->ThenMemcpy(&dst, src, num_bytes);
+    }
+  }
+
+  if (stream != nullptr) {
+    if (!stream->ok()) {
+      return errors::Internal("Failed to pad the inputs of a cluster compiled "
+                              "for bucketed shapes");
+    }
+    // Keeps the host sizes alive until they have been copied.
+    TF_RETURN_IF_ERROR(ctx->op_device_context()->ThenExecute(
+        down_cast<Device*>(ctx->device()), stream,
+        [host_sizes = std::move(host_sizes)]() {}));
+  }
+  return Status::OK();
 }
 
 void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
@@ -223,6 +322,7 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   xla::LocalClient* client;
   const XlaCompiler::CompilationResult* compilation_result;
   xla::LocalExecutable* executable;
+  std::vector<int> padded_args;
 
   std::vector<VariableInfo> variable_infos;
   {
@@ -232,9 +332,9 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
     Status s = CompileToLocalExecutable(
         ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_, inputs,
-        variable_infos, constants_, /*lazy=*/false,
+        variable_infos, constants_, XlaCompilationCache::CompileMode::kStrict,
         /*may_alias_resource_update=*/true, &client, &compilation_result,
-        &executable);
+        &executable, &padded_args);
     OP_REQUIRES_OK(ctx, s);
   }
 
@@ -261,10 +361,16 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
       platform_info_.UseMultipleStreams());
   const xla::HloInputOutputAliasConfig& input_output_alias =
       executable->executable()->module().input_output_alias_config();
+  std::deque<Tensor> padded_inputs;
+  std::map<int, const Tensor*> input_overrides;
+  OP_REQUIRES_OK(ctx, PadBucketedInputs(ctx, *compilation_result, padded_args,
+                                        inputs.size(),
+                                        /*missing_ctx_input_prefix=*/0,
+                                        &padded_inputs, &input_overrides));
   xla::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
       launch_context.PopulateInputs(ctx, compilation_result, resource_var_ptrs,
                                     /*missing_ctx_input_prefix=*/0,
-                                    input_output_alias);
+                                    input_output_alias, input_overrides);
   OP_REQUIRES_OK(ctx, execution_inputs.status());
 
   // Execute the computation.
@@ -387,6 +493,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* kernel;
   xla::LocalExecutable* executable;
   ResourceVarsSnapshot variables;
+  std::vector<int> padded_args;
 
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
   bool cannot_compile_cluster;
@@ -405,13 +512,23 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
                                         inputs, resources_, &variable_infos));
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
 
+    // Clusters that must be compiled can't fall back to the TF executor while
+    // they are compiled asynchronously.
+    XlaCompilationCache::CompileMode compile_mode =
+        XlaCompilationCache::CompileMode::kStrict;
+    if (!must_compile_) {
+      compile_mode = GetXlaOpsCommonFlags().tf_xla_async_compilation
+                         ? XlaCompilationCache::CompileMode::kAsync
+                         : XlaCompilationCache::CompileMode::kLazy;
+    }
+
     // Do not alias resource updates as locking variables in XlaCompile and
     // unlocking them in XlaRun may lead to deadlocks.
     Status status = CompileToLocalExecutable(
         ctx, function_, has_ref_vars_, platform_info_, inputs, variable_infos,
-        constants_,
-        /*lazy=*/!must_compile_,
-        /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+        constants_, compile_mode,
+        /*may_alias_resource_update=*/false, &client, &kernel, &executable,
+        &padded_args);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
     if (must_compile_ || status.code() != error::UNIMPLEMENTED) {
@@ -453,7 +570,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // variables.
   XlaExecutableClosureStore::KeyT key =
       XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
-          client, executable, kernel, std::move(variables), constants_.size()));
+          client, executable, kernel, std::move(variables), constants_.size(),
+          std::move(padded_args), inputs.size()));
 
   Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
   compilation_key.flat<tstring>()(0) = key;
@@ -497,6 +615,8 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       closure.executable()->executable()->module().input_output_alias_config();
   xla::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
+  std::deque<Tensor> padded_inputs;
+  std::map<int, const Tensor*> input_overrides;
   {
     tensorflow::profiler::TraceMe hlo_module_activity(
         [&] {
@@ -510,10 +630,16 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       snapshot_ptrs.emplace(p.first,
                             p.second.has_value() ? &p.second.value() : nullptr);
     }
+    OP_REQUIRES_OK(
+        ctx, PadBucketedInputs(
+                 ctx, *closure.compilation_result(), closure.padded_args(),
+                 closure.num_args(),
+                 /*missing_ctx_input_prefix=*/closure.num_constant_args(),
+                 &padded_inputs, &input_overrides));
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
-        input_output_alias);
+        input_output_alias, input_overrides);
     OP_REQUIRES_OK(ctx, execution_inputs.status());
   }
 
@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "absl/base/call_once.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -48,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/stream_executor/tf_allocator_adapter.h"
 
 namespace tensorflow {
 
@@ -58,6 +62,13 @@ XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
     : client_(client), device_type_(std::move(device_type)) {}
 
 XlaCompilationCache::~XlaCompilationCache() {
+  // Wait for the asynchronous compilations, which refer to the entries.
+  std::unique_ptr<thread::ThreadPool> async_compiler_threads;
+  {
+    mutex_lock lock(async_compilation_mu_);
+    async_compiler_threads = std::move(async_compiler_threads_);
+  }
+  async_compiler_threads.reset();
   // Ensure any use of our programs have completed by waiting for all stream
   // executors to complete.
   for (auto* executor : client_->backend().stream_executors()) {
@@ -179,24 +190,178 @@ Status XlaCompilationCache::BuildExecutable(
   return Status::OK();
 }
 
+namespace {
+
+// Returns the leading dimension of `arg` if it is a parameter that can be
+// padded by copying it into a larger buffer, or -1.
+int64 PaddableLeadingDim(const XlaCompiler::Argument& arg) {
+  if (arg.kind != XlaCompiler::Argument::kParameter ||
+      !absl::holds_alternative<TensorShape>(arg.shape) ||
+      !DataTypeCanUseMemcpy(arg.type)) {
+    return -1;
+  }
+  const TensorShape& shape = absl::get<TensorShape>(arg.shape);
+  return shape.dims() > 0 ? shape.dim_size(0) : -1;
+}
+
+// Returns the function compiling `function` for `args`. The compilations of
+// `kAsync` mode outlive the calls to Compile, so the function then keeps
+// copies of its inputs.
+std::function<Status(XlaCompiler*, XlaCompiler::CompilationResult*)>
+CompileFunctionFn(const XlaCompiler::CompileOptions& compile_options,
+                  const NameAttrList& function,
+                  absl::Span<const XlaCompiler::Argument> args,
+                  XlaCompilationCache::CompileMode compile_mode) {
+  if (compile_mode == XlaCompilationCache::CompileMode::kAsync) {
+    std::vector<XlaCompiler::Argument> args_copy(args.begin(), args.end());
+    return [compile_options, function, args = std::move(args_copy)](
+               XlaCompiler* compiler, XlaCompiler::CompilationResult* result) {
+      return compiler->CompileFunction(compile_options, function, args, result);
+    };
+  }
+  return [&compile_options, &function, args](
+             XlaCompiler* compiler, XlaCompiler::CompilationResult* result) {
+    return compiler->CompileFunction(compile_options, function, args, result);
+  };
+}
+
+bool HasDynamicOutputs(const XlaCompiler::CompilationResult& result) {
+  bool has_dynamic_outputs = false;
+  xla::ShapeUtil::ForEachSubshape(
+      result.xla_output_shape,
+      [&](const xla::Shape& subshape, const xla::ShapeIndex& /*index*/) {
+        has_dynamic_outputs |= subshape.IsArray() && subshape.is_dynamic();
+      });
+  return has_dynamic_outputs;
+}
+
+}  // namespace
+
+std::vector<XlaCompiler::Argument> XlaCompilationCache::BucketArguments(
+    absl::Span<const XlaCompiler::Argument> args,
+    const std::vector<bool>& varying, absl::Span<const int64> buckets,
+    std::vector<int>* padded_args) {
+  padded_args->clear();
+  std::vector<XlaCompiler::Argument> bucketed_args(args.begin(), args.end());
+  for (int i = 0, end = args.size(); i < end; ++i) {
+    const int64 leading_dim = PaddableLeadingDim(args[i]);
+    if (!varying[i] || leading_dim < 0) continue;
+    auto bucket = std::lower_bound(buckets.begin(), buckets.end(), leading_dim);
+    if (bucket == buckets.end()) continue;
+
+    TensorShape shape = absl::get<TensorShape>(args[i].shape);
+    shape.set_dim(0, *bucket);
+    bucketed_args[i].shape = shape;
+    bucketed_args[i].dynamic_dim_to_arg_num_map[0] =
+        args.size() + padded_args->size();
+    padded_args->push_back(i);
+  }
+  for (int arg_num : *padded_args) {
+    XlaCompiler::Argument size_arg;
+    size_arg.kind = XlaCompiler::Argument::kParameter;
+    size_arg.type = DT_INT32;
+    size_arg.shape = TensorShape({});
+    size_arg.name = absl::StrCat(args[arg_num].name, "_leading_dim");
+    bucketed_args.push_back(std::move(size_arg));
+  }
+  return bucketed_args;
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
     const XlaCompiler::CompileOptions& compile_options,
     CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    xla::LocalExecutable** out_executable) {
-  absl::optional<int64> compile_threshold;
-  if (compile_mode == CompileMode::kLazy) {
-    compile_threshold = kDefaultCompilationThreshold;
+    xla::LocalExecutable** out_executable, std::vector<int>* out_padded_args) {
+  if (out_padded_args != nullptr) {
+    out_padded_args->clear();
+    if (!GetXlaOpsCommonFlags().tf_xla_dynamic_dim_buckets.empty()) {
+      TF_RETURN_IF_ERROR(CompileBucketed(
+          options, function, args, compile_options, compile_mode,
+          out_compilation_result, out_executable, out_padded_args));
+      if (!out_padded_args->empty()) {
+        return Status::OK();
+      }
+    }
   }
-  auto compile_fn = [&](XlaCompiler* compiler,
-                        XlaCompiler::CompilationResult* result) {
-    return compiler->CompileFunction(compile_options, function, args, result);
-  };
-  return CompileImpl(options, function, args, compile_fn,
-                     /*compile_threshold=*/compile_threshold,
-                     out_compilation_result, out_executable);
+  return CompileImpl(
+      options, function, args,
+      CompileFunctionFn(compile_options, function, args, compile_mode),
+      compile_mode, out_compilation_result, out_executable,
+      /*out_compiled=*/nullptr);
+}
+
+Status XlaCompilationCache::CompileBucketed(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args,
+    const XlaCompiler::CompileOptions& compile_options,
+    CompileMode compile_mode,
+    const XlaCompiler::CompilationResult** out_compilation_result,
+    xla::LocalExecutable** out_executable, std::vector<int>* out_padded_args) {
+  // Only dimensions that have been seen to vary are bucketed, so that the
+  // static dimensions of a cluster keep their exact sizes.
+  std::vector<bool> varying;
+  {
+    mutex_lock lock(cluster_compile_stats_mu_);
+    ClusterCompileStats& stats = cluster_compile_stats_[function.name()];
+    if (stats.bucketing_failed) {
+      return Status::OK();
+    }
+    if (stats.first_leading_dims.size() != args.size()) {
+      stats.first_leading_dims.resize(args.size());
+      for (int i = 0, end = args.size(); i < end; ++i) {
+        stats.first_leading_dims[i] = PaddableLeadingDim(args[i]);
+      }
+      stats.leading_dim_varies.assign(args.size(), false);
+    }
+    for (int i = 0, end = args.size(); i < end; ++i) {
+      if (PaddableLeadingDim(args[i]) != stats.first_leading_dims[i]) {
+        stats.leading_dim_varies[i] = true;
+      }
+    }
+    varying = stats.leading_dim_varies;
+  }
+
+  const std::vector<XlaCompiler::Argument> bucketed_args = BucketArguments(
+      args, varying, GetXlaOpsCommonFlags().tf_xla_dynamic_dim_buckets,
+      out_padded_args);
+  if (out_padded_args->empty()) {
+    return Status::OK();
+  }
+  bool compiled = false;
+  Status status = CompileImpl(
+      options, function, bucketed_args,
+      CompileFunctionFn(compile_options, function, bucketed_args, compile_mode),
+      compile_mode, out_compilation_result, out_executable, &compiled);
+  // Outputs with dynamic shapes would have to be sliced back to their real
+  // sizes, which the launch kernels don't do.
+  if (status.ok() && *out_compilation_result != nullptr &&
+      HasDynamicOutputs(**out_compilation_result)) {
+    status = errors::Unimplemented("the outputs have dynamic shapes");
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Compiling " << function.name()
+            << " for exact shapes, as it could not be compiled for bucketed "
+               "shapes: "
+            << status;
+    mutex_lock lock(cluster_compile_stats_mu_);
+    cluster_compile_stats_[function.name()].bucketing_failed = true;
+    out_padded_args->clear();
+    return Status::OK();
+  }
+  if (*out_compilation_result == nullptr) {
+    // Deferred by lazy or asynchronous compilation.
+    return Status::OK();
+  }
+
+  TF_ASSIGN_OR_RETURN(Signature signature, BuildSignature(function, args));
+  mutex_lock lock(compile_cache_mu_);
+  if (bucketed_signatures_.insert(Signature::Hash()(signature)).second &&
+      !compiled) {
+    metrics::RecordXlaCompilationAvoidedByBucketing();
+  }
+  return Status::OK();
 }
 
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
@@ -298,9 +463,9 @@ Status XlaCompilationCache::CompileSingleOp(
         options.device_type.type_string(), compile_options.use_tuple_arg,
         *options.flib_def, debug_info, options.shape_representation_fn, result);
   };
-  return CompileImpl(options, name, args, compile_op,
-                     /*compile_threshold=*/absl::nullopt,
-                     out_compilation_result, out_executable);
+  return CompileImpl(options, name, args, compile_op, CompileMode::kStrict,
+                     out_compilation_result, out_executable,
+                     /*out_compiled=*/nullptr);
 }
 
 namespace {
@@ -319,18 +484,24 @@ void LogOnceXlaCompiledFirstCluster() {
 
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
-    absl::Span<const XlaCompiler::Argument> args,
-    const std::function<Status(XlaCompiler* compiler,
-                               XlaCompiler::CompilationResult*)>& compile_fn,
-    absl::optional<int64> compile_threshold,
+    absl::Span<const XlaCompiler::Argument> args, const CompileFn& compile_fn,
+    CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    xla::LocalExecutable** out_executable) {
+    xla::LocalExecutable** out_executable, bool* out_compiled) {
+  if (out_compiled != nullptr) {
+    *out_compiled = false;
+  }
   if (FailOnXlaCompilation()) {
     return errors::Internal("XLA compilation disabled");
   }
 
   DCHECK_NE(out_executable, nullptr);
   VLOG(2) << "XlaCompilationCache::Compile " << DebugString();
+  absl::optional<int64> compile_threshold;
+  if (compile_mode == CompileMode::kLazy ||
+      compile_mode == CompileMode::kAsync) {
+    compile_threshold = kDefaultCompilationThreshold;
+  }
 
   if (VLOG_IS_ON(2)) {
     VLOG(2) << "num_inputs=" << args.size();
@@ -392,13 +563,21 @@ Status XlaCompilationCache::CompileImpl(
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
   int64 current_request_count = ++entry->request_count;
-  VLOG(2) << "Compilation cache entry hit: " << entry->compiled
+  VLOG(2) << "Compilation cache entry hit: "
+          << static_cast<int>(entry->compile_state)
           << " signature: " << signature.HumanString() << " with request count "
           << current_request_count << " and compile threshold "
           << compile_threshold.value_or(0);
-  if (!entry->compiled) {
+  if (entry->compile_state == CompileState::kCompiling) {
+    VLOG(2) << "Not waiting for the ongoing compilation of signature: "
+            << signature.HumanString();
+    *out_compilation_result = nullptr;
+    *out_executable = nullptr;
+    return Status::OK();
+  }
+  if (entry->compile_state == CompileState::kUncompiled) {
     XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
-    const bool should_compile = [&] {
+    bool should_compile = [&] {
       if (!compile_threshold.has_value()) {
         // Lazy compilation is disabled.
         return true;
@@ -429,6 +608,18 @@ Status XlaCompilationCache::CompileImpl(
       return reached_compile_threshold;
     }();
 
+    if (should_compile && compile_mode == CompileMode::kAsync) {
+      mutex_lock lock(async_compilation_mu_);
+      if (num_ongoing_async_compilations_ >= kNumAsyncCompilerThreads) {
+        VLOG(3) << "Not compiling cluster " << function.name()
+                << " because " << num_ongoing_async_compilations_
+                << " compilations are ongoing.";
+        should_compile = false;
+      } else {
+        ++num_ongoing_async_compilations_;
+      }
+    }
+
     if (!should_compile) {
       VLOG(2) << "Not compiling for signature: " << signature.HumanString();
       *out_compilation_result = nullptr;
@@ -436,13 +627,24 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     }
 
+    if (out_compiled != nullptr) {
+      *out_compiled = true;
+    }
+    if (compile_mode == CompileMode::kAsync) {
+      entry->compile_state = CompileState::kCompiling;
+      CompileAsynchronous(entry, options, function.name(), compile_fn);
+      *out_compilation_result = nullptr;
+      *out_executable = nullptr;
+      return Status::OK();
+    }
+
     tensorflow::Env* env = tensorflow::Env::Default();
     const uint64 compile_start_us = env->NowMicros();
     // Do the actual JIT compilation without holding the lock (it can take
     // a long time.)
 
     XlaCompiler compiler(options);
-    entry->compiled = true;
+    entry->compile_state = CompileState::kCompiled;
 
     entry->compilation_status =
         compile_fn(&compiler, &entry->compilation_result);
@@ -451,37 +653,8 @@ Status XlaCompilationCache::CompileImpl(
     entry->compilation_status =
         BuildExecutable(options, entry->compilation_result, &entry->executable);
 
-    const uint64 compile_end_us = env->NowMicros();
-    const uint64 compile_time_us = compile_end_us - compile_start_us;
-    metrics::UpdateXlaCompilationTime(compile_time_us);
-    {
-      mutex_lock lock(cluster_compile_stats_mu_);
-      auto it = cluster_compile_stats_.find(function.name());
-      it->second.compile_count++;
-      it->second.cumulative_compile_time_us += compile_time_us;
-      LogOnceXlaCompiledFirstCluster();
-      VLOG(1) << "compiled " << function.name() << " "
-              << it->second.compile_count
-              << " times, compile time: " << compile_time_us
-              << " us, cumulative: " << it->second.cumulative_compile_time_us
-              << " us ("
-              << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
-                                                               1.0e6)
-              << " / "
-              << tensorflow::strings::HumanReadableElapsedTime(
-                     it->second.cumulative_compile_time_us / 1.0e6)
-              << ")";
-
-      XlaJitCompilationActivity jit_compilation_activity;
-      jit_compilation_activity.set_cluster_name(function.name());
-      jit_compilation_activity.set_compile_count(it->second.compile_count);
-      jit_compilation_activity.set_compile_time_us(compile_time_us);
-      jit_compilation_activity.set_cumulative_compile_time_us(
-          it->second.cumulative_compile_time_us);
-
-      TF_RETURN_IF_ERROR(
-          BroadcastXlaActivity(std::move(jit_compilation_activity)));
-    }
+    TF_RETURN_IF_ERROR(RecordCompilation(
+        function.name(), env->NowMicros() - compile_start_us));
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
   *out_compilation_result = &entry->compilation_result;
@@ -489,4 +662,89 @@ Status XlaCompilationCache::CompileImpl(
   return Status::OK();
 }
 
+void XlaCompilationCache::CompileAsynchronous(
+    Entry* entry, const XlaCompiler::Options& options,
+    const string& function_name, const CompileFn& compile_fn) {
+  // The compilation outlives the kernel that requested it, so it gets its own
+  // copy of the function library, and of the allocator adapter that wraps the
+  // allocator of the device.
+  XlaCompiler::Options async_options = options;
+  auto flib_def =
+      std::make_shared<FunctionLibraryDefinition>(*options.flib_def);
+  async_options.flib_def = flib_def.get();
+  std::shared_ptr<se::TfAllocatorAdapter> allocator;
+  if (auto* tf_allocator =
+          dynamic_cast<se::TfAllocatorAdapter*>(options.device_allocator)) {
+    allocator = std::make_shared<se::TfAllocatorAdapter>(*tf_allocator);
+    async_options.device_allocator = allocator.get();
+  }
+
+  mutex_lock lock(async_compilation_mu_);
+  if (async_compiler_threads_ == nullptr) {
+    async_compiler_threads_ = absl::make_unique<thread::ThreadPool>(
+        Env::Default(), "async_xla_compilation", kNumAsyncCompilerThreads);
+  }
+  async_compiler_threads_->Schedule([this, entry, async_options, flib_def,
+                                     allocator, function_name, compile_fn] {
+    VLOG(2) << "Compiling " << function_name << " asynchronously";
+    Env* env = Env::Default();
+    const uint64 compile_start_us = env->NowMicros();
+    XlaCompiler compiler(async_options);
+    XlaCompiler::CompilationResult result;
+    std::unique_ptr<xla::LocalExecutable> executable;
+    Status status = compile_fn(&compiler, &result);
+    if (status.ok()) {
+      status = BuildExecutable(async_options, result, &executable);
+      Status record_status =
+          RecordCompilation(function_name, env->NowMicros() - compile_start_us);
+      if (!record_status.ok()) {
+        LOG(WARNING) << "Failed to record the compilation of "
+                     << function_name << ": " << record_status;
+      }
+    }
+    {
+      mutex_lock entry_lock(entry->mu);
+      entry->compilation_status = status;
+      entry->compilation_result = std::move(result);
+      entry->executable = std::move(executable);
+      entry->compile_state = CompileState::kCompiled;
+    }
+    mutex_lock lock(async_compilation_mu_);
+    --num_ongoing_async_compilations_;
+  });
+}
+
+Status XlaCompilationCache::RecordCompilation(const string& function_name,
+                                              int64 compile_time_us) {
+  metrics::UpdateXlaCompilationTime(compile_time_us);
+  {
+    mutex_lock lock(cluster_compile_stats_mu_);
+    auto it = cluster_compile_stats_.find(function_name);
+    it->second.compile_count++;
+    it->second.cumulative_compile_time_us += compile_time_us;
+    LogOnceXlaCompiledFirstCluster();
+    VLOG(1) << "compiled " << function_name << " " << it->second.compile_count
+            << " times, compile time: " << compile_time_us
+            << " us, cumulative: " << it->second.cumulative_compile_time_us
+            << " us ("
+            << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
+                                                             1.0e6)
+            << " / "
+            << tensorflow::strings::HumanReadableElapsedTime(
+                   it->second.cumulative_compile_time_us / 1.0e6)
+            << ")";
+
+    XlaJitCompilationActivity jit_compilation_activity;
+    jit_compilation_activity.set_cluster_name(function_name);
+    jit_compilation_activity.set_compile_count(it->second.compile_count);
+    jit_compilation_activity.set_compile_time_us(compile_time_us);
+    jit_compilation_activity.set_cumulative_compile_time_us(
+        it->second.cumulative_compile_time_us);
+
+    TF_RETURN_IF_ERROR(
+        BroadcastXlaActivity(std::move(jit_compilation_activity)));
+  }
+  return Status::OK();
+}
+
 }  // namespace tensorflow
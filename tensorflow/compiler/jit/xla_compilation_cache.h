@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
@@ -50,6 +51,7 @@ class XlaCompilationCache : public ResourceBase {
   enum class CompileMode {
     kLazy,
     kStrict,
+    kAsync,
   };
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -62,20 +64,33 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss.
+  // cache always attempts the compilation on a cache miss.  If `compile_mode`
+  // is `kAsync` then the compilation cache decides like in `kLazy` mode, but
+  // runs the compilations on a background thread, and returns null until the
+  // compilation of the signature has finished.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
   // xla::LocalExecutable and sets `out_executable` to point to it. The
   // resulting executable pointer may be null if the computation has no
   // non-constant outputs.
+  //
+  // If `out_padded_args` is non-null and --tf_xla_dynamic_dim_buckets is set,
+  // the leading dimensions of parameters that vary between executions of
+  // `function` are rounded up to their bucket, and `*out_padded_args` is set
+  // to the numbers of the padded arguments. The computation then expects those
+  // arguments padded to the shapes in `xla_input_shapes`, and one int32
+  // scalar holding the real leading dimension of each of them, in order,
+  // after all the other arguments. `*out_padded_args` is left empty when the
+  // computation was compiled for the exact shapes.
   Status Compile(const XlaCompiler::Options& options,
                  const NameAttrList& function,
                  absl::Span<const XlaCompiler::Argument> args,
                  const XlaCompiler::CompileOptions& compile_options,
                  CompileMode compile_mode,
                  const XlaCompiler::CompilationResult** out_compilation_result,
-                 xla::LocalExecutable** out_executable);
+                 xla::LocalExecutable** out_executable,
+                 std::vector<int>* out_padded_args = nullptr);
 
   // As above, but calls XlaCompiler::CompileSingleOp instead of
   // XlaCompiler::CompileFunction. If MLIR bridge is enabled through ConfigProto
@@ -122,16 +137,51 @@ class XlaCompilationCache : public ResourceBase {
       const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args);
 
+  // Returns `args` with the leading dimension of every parameter `i` with
+  // `varying[i]` rounded up to the smallest of the sorted `buckets` that holds
+  // it, followed by the int32 arguments carrying the unpadded sizes. Sets
+  // `padded_args` to the numbers of the padded arguments, which is empty if
+  // no argument fits a bucket.
+  static std::vector<XlaCompiler::Argument> BucketArguments(
+      absl::Span<const XlaCompiler::Argument> args,
+      const std::vector<bool>& varying, absl::Span<const int64> buckets,
+      std::vector<int>* padded_args);
+
  private:
-  // Common implementation of Compile and CompileSingleOp.
+  struct Entry;
+  using CompileFn = std::function<Status(XlaCompiler* compiler,
+                                         XlaCompiler::CompilationResult*)>;
+
+  // Common implementation of Compile and CompileSingleOp. In `kAsync` mode,
+  // `compile_fn` must not refer to objects that don't outlive the call.
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args,
-      const std::function<Status(XlaCompiler* compiler,
-                                 XlaCompiler::CompilationResult*)>& compile_fn,
-      absl::optional<int64> compile_threshold,
+      const CompileFn& compile_fn, CompileMode compile_mode,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      xla::LocalExecutable** out_executable);
+      xla::LocalExecutable** out_executable, bool* out_compiled);
+
+  // Schedules the compilation of `entry` with `compile_fn` on
+  // `async_compiler_threads_`.
+  void CompileAsynchronous(Entry* entry, const XlaCompiler::Options& options,
+                           const string& function_name,
+                           const CompileFn& compile_fn);
+
+  // Updates the statistics of `function_name` after a compilation that took
+  // `compile_time_us`.
+  Status RecordCompilation(const string& function_name, int64 compile_time_us);
+
+  // The part of Compile that tries to compile `function` for bucketed shapes.
+  // Sets `*out_padded_args` to empty if the exact shapes have to be compiled
+  // instead.
+  Status CompileBucketed(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      absl::Span<const XlaCompiler::Argument> args,
+      const XlaCompiler::CompileOptions& compile_options,
+      CompileMode compile_mode,
+      const XlaCompiler::CompilationResult** out_compilation_result,
+      xla::LocalExecutable** out_executable,
+      std::vector<int>* out_padded_args);
 
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
@@ -142,12 +192,14 @@ class XlaCompilationCache : public ResourceBase {
   xla::LocalClient* const client_;
   const DeviceType device_type_;
 
+  enum class CompileState { kUncompiled, kCompiling, kCompiled };
+
   // The value associated with a cache entry.
   struct Entry {
     mutex mu;
 
-    // Have we tried compiling this entry?
-    bool compiled = false;
+    // Have we tried compiling this entry, and has the compilation finished?
+    CompileState compile_state TF_GUARDED_BY(mu) = CompileState::kUncompiled;
 
     // The number of times a compilation with this signature has been requested.
     int64 request_count = 0;
@@ -181,8 +233,23 @@ class XlaCompilationCache : public ResourceBase {
     // change too frequently) to profitably JIT compile.  Once a cluster is
     // tagged megamorphic, it stays megamorphic forever.
     bool is_megamorphic = false;
+
+    // The leading dimension of each argument the first time the cluster was
+    // compiled (-1 for arguments without one), and whether it has changed
+    // since. Only tracked when bucketing is enabled.
+    std::vector<int64> first_leading_dims;
+    std::vector<bool> leading_dim_varies;
+
+    // True once a bucketed compilation of the cluster failed, or produced
+    // outputs with dynamic shapes. Such clusters are compiled per shape.
+    bool bucketing_failed = false;
   };
 
+  // Signature hashes of the exact shapes that were run with a bucketed
+  // executable, to count the compilations bucketing avoided.
+  absl::flat_hash_set<uint64> bucketed_signatures_
+      TF_GUARDED_BY(compile_cache_mu_);
+
   mutex cluster_compile_stats_mu_;
 
   // Maps cluster names to compilation statistics for said cluster.
@@ -193,6 +260,20 @@ class XlaCompilationCache : public ResourceBase {
   // signature before  we attempt to compile it.
   static constexpr int64 kDefaultCompilationThreshold = 2;
 
+  // The maximum number of compilations running in the background in `kAsync`
+  // mode. Further cache misses fall back to the TF executor without
+  // scheduling a compilation, until a thread is free.
+  static constexpr int kNumAsyncCompilerThreads = 4;
+
+  mutex async_compilation_mu_;
+  int num_ongoing_async_compilations_ TF_GUARDED_BY(async_compilation_mu_) = 0;
+
+  // Created on the first compilation in `kAsync` mode. Declared last, and
+  // reset first by the destructor, so that the compilations it runs can use
+  // the rest of the cache.
+  std::unique_ptr<thread::ThreadPool> async_compiler_threads_
+      TF_GUARDED_BY(async_compilation_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
 
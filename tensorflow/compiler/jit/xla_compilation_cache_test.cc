@@ -18,6 +18,10 @@ limitations under the License.
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -54,6 +58,48 @@ TEST(XlaCompilationCacheTest, SignatureEquality) {
   }
 }
 
+TEST(XlaCompilationCacheTest, AsyncCompilation) {
+  FunctionDefLibrary fdef_lib;
+  *fdef_lib.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), fdef_lib);
+  NameAttrList fn;
+  fn.set_name("XTimesTwo");
+  (*fn.mutable_attr())["T"].set_type(DT_FLOAT);
+
+  xla::LocalClient* client = xla::ClientLibrary::LocalClientOrDie();
+  DeviceType device_type = DeviceType(DEVICE_CPU_XLA_JIT);
+  auto cache = new XlaCompilationCache(client, device_type);
+  core::ScopedUnref cache_ref(cache);
+
+  XlaCompiler::Options options;
+  options.device_type = device_type;
+  options.client = client;
+  options.flib_def = &flib_def;
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2});
+
+  const XlaCompiler::CompilationResult* compilation_result;
+  xla::LocalExecutable* executable;
+  auto compile = [&] {
+    return cache->Compile(options, fn, args, XlaCompiler::CompileOptions{},
+                          XlaCompilationCache::CompileMode::kAsync,
+                          &compilation_result, &executable);
+  };
+  // The first execution starts the compilation without waiting for it.
+  TF_ASSERT_OK(compile());
+  EXPECT_EQ(compilation_result, nullptr);
+  EXPECT_EQ(executable, nullptr);
+
+  for (int i = 0; i < 1000 && executable == nullptr; ++i) {
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+    TF_ASSERT_OK(compile());
+  }
+  EXPECT_NE(compilation_result, nullptr);
+  EXPECT_NE(executable, nullptr);
+}
+
 TEST(XlaCompilationCacheTest, TestDisabledXlaCompilation) {
   NameAttrList fn;
   fn.set_name("afunction");
@@ -78,6 +124,44 @@ TEST(XlaCompilationCacheTest, TestDisabledXlaCompilation) {
       absl::StrContains(status.error_message(), "XLA compilation disabled"));
 }
 
+TEST(XlaCompilationCacheTest, BucketArguments) {
+  std::vector<XlaCompiler::Argument> args(4);
+  for (int i = 0; i < args.size(); ++i) {
+    args[i].kind = XlaCompiler::Argument::kParameter;
+    args[i].type = DT_FLOAT;
+    args[i].shape = TensorShape({5, 3});
+    args[i].name = absl::StrCat("arg", i);
+  }
+  args[1].kind = XlaCompiler::Argument::kConstant;
+  args[1].constant_value = Tensor(DT_FLOAT, {5, 3});
+  args[3].shape = TensorShape({100, 3});
+  const std::vector<int64> buckets = {4, 8, 16};
+
+  std::vector<int> padded_args;
+  std::vector<XlaCompiler::Argument> bucketed_args =
+      XlaCompilationCache::BucketArguments(
+          args, /*varying=*/{true, true, false, true}, buckets, &padded_args);
+  // Only the first argument is padded: the second one is a constant, the
+  // third one doesn't vary and the fourth one is larger than all buckets.
+  EXPECT_EQ(padded_args, std::vector<int>({0}));
+  ASSERT_EQ(bucketed_args.size(), 5);
+  EXPECT_EQ(absl::get<TensorShape>(bucketed_args[0].shape),
+            TensorShape({8, 3}));
+  EXPECT_EQ(bucketed_args[0].dynamic_dim_to_arg_num_map.at(0), 4);
+  for (int i = 1; i < args.size(); ++i) {
+    EXPECT_EQ(absl::get<TensorShape>(bucketed_args[i].shape),
+              absl::get<TensorShape>(args[i].shape));
+    EXPECT_TRUE(bucketed_args[i].dynamic_dim_to_arg_num_map.empty());
+  }
+  EXPECT_EQ(bucketed_args[4].kind, XlaCompiler::Argument::kParameter);
+  EXPECT_EQ(bucketed_args[4].type, DT_INT32);
+  EXPECT_EQ(absl::get<TensorShape>(bucketed_args[4].shape), TensorShape({}));
+
+  XlaCompilationCache::BucketArguments(
+      args, /*varying=*/{false, false, false, false}, buckets, &padded_args);
+  EXPECT_TRUE(padded_args.empty());
+}
+
 static void BM_BuildSignature(int iters, int n_args) {
   NameAttrList fn;
   fn.set_name("afunction");
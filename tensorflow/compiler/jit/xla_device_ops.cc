@@ -32,6 +32,7 @@ void XlaDeviceDummyOp::Compute(OpKernelContext* ctx) {
 XlaAssignVariableOp::XlaAssignVariableOp(OpKernelConstruction* c)
     : OpKernel(c) {
   OP_REQUIRES_OK(c, c->GetAttr("dtype", &dtype_));
+  OP_REQUIRES_OK(c, c->GetAttr("read_only", &read_only_));
 }
 
 void XlaAssignVariableOp::Compute(OpKernelContext* context) {
@@ -59,6 +60,7 @@ void XlaAssignVariableOp::Compute(OpKernelContext* context) {
                                 return Status::OK();
                               }));
   mutex_lock ml(*variable->mu());
+  OP_REQUIRES_OK(context, variable->CheckWritable());
   OP_REQUIRES(
       context,
       !variable->is_initialized || variable->tensor()->dtype() == dtype_,
@@ -68,6 +70,7 @@ void XlaAssignVariableOp::Compute(OpKernelContext* context) {
           DataTypeString(dtype_)));
   variable->is_initialized = true;
   *variable->tensor() = value;
+  if (read_only_) variable->read_only.store(true);
 }
 
 }  // namespace tensorflow
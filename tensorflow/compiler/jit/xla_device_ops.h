@@ -51,6 +51,7 @@ class XlaAssignVariableOp : public OpKernel {
 
  private:
   DataType dtype_;
+  bool read_only_;
 };
 
 #define REGISTER_XLA_LAUNCH_KERNEL(DEVICE, KERNEL, TYPES) \
@@ -206,7 +206,8 @@ XlaComputationLaunchContext::PopulateInputs(
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    const std::map<int, const Tensor*>& input_overrides) {
   std::vector<xla::ExecutionInput> arguments;
   arguments.reserve(compilation_result->xla_input_shapes.size());
 
@@ -228,9 +229,14 @@ XlaComputationLaunchContext::PopulateInputs(
                          return update.input_index == i && update.modified;
                        });
 
-    const Tensor* t = is_resource_variable
-                          ? resource_vars.at(arg_num)
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+    const Tensor* t;
+    if (is_resource_variable) {
+      t = resource_vars.at(arg_num);
+    } else if (input_overrides.count(arg_num)) {
+      t = input_overrides.at(arg_num);
+    } else {
+      t = &(ctx->input(arg_num - missing_ctx_input_prefix));
+    }
     CHECK(t);
     bool donate_buffer =
         t->RefCountIsOne() && is_updated_resource_variable &&
@@ -527,6 +533,7 @@ Status XlaComputationLaunchContext::PopulateOutputs(
     CHECK_LT(actual_input_index, ctx->num_inputs());
     Var* var = variable_infos[variable_info_lookup[actual_input_index]].var();
     CHECK(var);
+    TF_RETURN_IF_ERROR(var->CheckWritable());
 
     VLOG(2) << "Updating variable #" << i
             << " at input index: " << actual_input_index << " with shape "
@@ -323,6 +323,51 @@ static Optional<TfLitePoolParams> GetTflitePoolParams(Operation* inst,
   return llvm::None;
 }
 
+// Returns the value of `inst` if it is a constant operation exported as a
+// TFLite buffer, and a null attribute otherwise.
+static ElementsAttr GetConstantBufferValue(Operation* inst) {
+  if (auto cst = dyn_cast<mlir::ConstantOp>(inst)) {
+    // ConstantOp have ElementAttr at this point due to validation of the TFLite
+    // module.
+    return cst.getValue().cast<ElementsAttr>();
+  } else if (auto cst = dyn_cast<mlir::TF::ConstOp>(inst)) {
+    return cst.value();
+  } else if (auto cst = dyn_cast<tfl::ConstOp>(inst)) {
+    return cst.value();
+  } else if (auto cst = dyn_cast<tfl::QConstOp>(inst)) {
+    return cst.value();
+  } else if (auto cst = dyn_cast<tfl::SparseConstOp>(inst)) {
+    return cst.compressed_data();
+  } else if (auto cst = dyn_cast<tfl::SparseQConstOp>(inst)) {
+    return cst.compressed_data();
+  }
+  return {};
+}
+
+// Alignment of the data of every buffer, as required by the schema so that
+// constants can be used in place when the model is mmap-ed.
+constexpr size_t kBufferAlignment = 16;
+
+// Returns an upper bound of the size of the FlatBuffer, not counting strings
+// and ops. Sizing the builder from the start avoids growing it by doubling
+// while the constants are copied in, which copies everything built so far
+// and briefly holds both the old and the new allocation; for multi-GB models
+// this dominates the peak memory of the export.
+static size_t EstimateFlatBufferSize(ModuleOp module) {
+  size_t size = kInitialBufferSize;
+  module.walk([&](Operation* inst) {
+    ElementsAttr attr = GetConstantBufferValue(inst);
+    if (!attr) return;
+    Type element_type = attr.getType().getElementType();
+    if (!element_type.isIntOrFloat()) return;
+    const size_t bytes =
+        (element_type.getIntOrFloatBitWidth() + 7) / 8 * attr.getNumElements();
+    // The vector length, the Buffer table and the alignment padding.
+    size += bytes + kBufferAlignment + 32;
+  });
+  return size;
+}
+
 namespace {
 
 // Translates an MLIR module in TFLite dialect to TFLite FlatBuffer.
@@ -342,7 +387,7 @@ class Translator {
                       OpOrArgNameMapper* op_or_arg_name_mapper)
       : module_(module),
         name_mapper_(*op_or_arg_name_mapper),
-        builder_(kInitialBufferSize) {
+        builder_(EstimateFlatBufferSize(module)) {
     // The first buffer must be empty according to the schema definition.
     empty_buffer_ = tflite::CreateBuffer(builder_);
     buffers_.push_back(empty_buffer_);
@@ -497,23 +542,23 @@ std::string Translator::UniqueName(mlir::Value val) {
 
 Optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     Operation* inst) {
-  ElementsAttr attr;
-  if (auto cst = dyn_cast<mlir::ConstantOp>(inst)) {
-    // ConstantOp have ElementAttr at this point due to validation of the TFLite
-    // module.
-    attr = cst.getValue().cast<ElementsAttr>();
-  } else if (auto cst = dyn_cast<mlir::TF::ConstOp>(inst)) {
-    attr = cst.value();
-  } else if (auto cst = dyn_cast<tfl::ConstOp>(inst)) {
-    attr = cst.value();
-  } else if (auto cst = dyn_cast<tfl::QConstOp>(inst)) {
-    attr = cst.value();
-  } else if (auto cst = dyn_cast<tfl::SparseConstOp>(inst)) {
-    attr = cst.compressed_data();
-  } else if (auto cst = dyn_cast<tfl::SparseQConstOp>(inst)) {
-    attr = cst.compressed_data();
-  } else {
-    return empty_buffer_;
+  ElementsAttr attr = GetConstantBufferValue(inst);
+  if (!attr) return empty_buffer_;
+
+  // Dense attributes of byte-sized numeric elements already hold the data in
+  // the layout of the buffer, so copy it over directly instead of through an
+  // intermediate tensor. Splats and booleans are stored compressed.
+  if (auto dense = attr.dyn_cast<mlir::DenseElementsAttr>()) {
+    Type element_type = dense.getType().getElementType();
+    if (!dense.isSplat() && element_type.isIntOrFloat() &&
+        element_type.getIntOrFloatBitWidth() % 8 == 0) {
+      llvm::ArrayRef<char> raw_data = dense.getRawData();
+      builder_.ForceVectorAlignment(raw_data.size(), sizeof(uint8_t),
+                                    kBufferAlignment);
+      auto buffer_data = builder_.CreateVector(
+          reinterpret_cast<const uint8_t*>(raw_data.data()), raw_data.size());
+      return tflite::CreateBuffer(builder_, buffer_data);
+    }
   }
 
   tensorflow::Tensor tensor;
@@ -536,6 +581,7 @@ Optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
     char* tensor_buffer;
     int bytes = dynamic_buffer.WriteToBuffer(&tensor_buffer);
+    builder_.ForceVectorAlignment(bytes, sizeof(uint8_t), kBufferAlignment);
     auto buffer_data =
         builder_.CreateVector(reinterpret_cast<uint8_t*>(tensor_buffer), bytes);
     free(tensor_buffer);
@@ -543,6 +589,8 @@ Optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
   }
 
   absl::string_view tensor_data = tensor.tensor_data();
+  builder_.ForceVectorAlignment(tensor_data.size(), sizeof(uint8_t),
+                                kBufferAlignment);
   auto buffer_data = builder_.CreateVector(
       reinterpret_cast<const uint8_t*>(tensor_data.data()), tensor_data.size());
   return tflite::CreateBuffer(builder_, buffer_data);
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -86,6 +87,7 @@ class AsyncHelper : public core::RefCounted {
 class TRTEngineOp : public AsyncOpKernel {
  public:
   explicit TRTEngineOp(OpKernelConstruction* context);
+  ~TRTEngineOp() override;
 
   void ComputeAsync(OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
@@ -128,13 +130,22 @@ class TRTEngineOp : public AsyncOpKernel {
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
   // Builds and returns a cuda engine for the input shapes. If building the
-  // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // engine fails, the caller should enter a dummy entry into the
+  // cache_resource cache so we don't continually try to build the same failing
+  // engine.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource);
 
+  // Starts building an engine for the input shapes on a background thread,
+  // unless one is already being built, and adds it to the cache of
+  // cache_resource when it is ready.
+  Status StartBackgroundEngineBuild(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -173,8 +184,22 @@ class TRTEngineOp : public AsyncOpKernel {
   // Maximum number of cached engines.
   int max_cached_engines_;
 
+  // Maximum number of execution contexts of each engine, i.e. of concurrent
+  // executions of the engine. Only used when use_implicit_batch_=true.
+  int64 max_execution_contexts_;
+
   int64 workspace_size_;
   mutex engine_mutex_;
+
+  // Whether to build engines for new input shapes on a background thread, and
+  // run the native segment until they are ready.
+  bool build_engines_in_background_;
+
+  // The input shapes of the engines that are being built in the background.
+  std::vector<std::vector<TensorShape>> pending_engine_builds_
+      TF_GUARDED_BY(engine_mutex_);
+  // Signalled when a background engine build finishes.
+  condition_variable engine_build_done_;
   FunctionLibraryRuntime::Handle func_handle_;
 
   // The finalized calibrator for inference.
@@ -322,6 +347,14 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   }
   OP_REQUIRES_OK(context, context->GetAttr("max_cached_engines_count",
                                            &max_cached_engines_));
+  OP_REQUIRES_OK(context,
+                 ReadInt64FromEnvVar("TF_TRT_MAX_EXECUTION_CONTEXTS_PER_ENGINE",
+                                     /*default_val=*/1,
+                                     &max_execution_contexts_));
+  OP_REQUIRES_OK(context,
+                 ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_IN_BACKGROUND",
+                                    /*default_val=*/false,
+                                    &build_engines_in_background_));
 
   status = context->GetAttr("_use_implicit_batch", &use_implicit_batch_);
   if (status.code() == tensorflow::error::NOT_FOUND) {
@@ -521,6 +554,21 @@ Status TRTEngineOp::VerifyInputShapes(
   return Status::OK();
 }
 
+TRTEngineOp::~TRTEngineOp() {
+  // The background engine builds use the members of the op.
+  mutex_lock lock(engine_mutex_);
+  while (!pending_engine_builds_.empty()) {
+    engine_build_done_.wait(lock);
+  }
+}
+
+// Returned by TRTEngineOp::GetEngine() while the engine for the input shapes
+// is being built in the background.
+static EngineContext* PendingEngineContext() {
+  static EngineContext* pending_context = new EngineContext();
+  return pending_context;
+}
+
 static bool AllowEngineNativeSegmentExecution() {
   bool value;
   Status status =
@@ -625,10 +673,16 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
     return true;
   };
   if (!engine_context->cuda_engine) {
-    LOG_WARNING_WITH_PREFIX
-        << "Engine retrieval for input shapes: "
-        << TensorShapeUtils::ShapeListString(input_concrete_shapes)
-        << " failed. Running native segment for " << name();
+    if (engine_context == PendingEngineContext()) {
+      VLOG(2) << "Engine for input shapes "
+              << TensorShapeUtils::ShapeListString(input_concrete_shapes)
+              << " is being built. Running native segment for " << name();
+    } else {
+      LOG_WARNING_WITH_PREFIX
+          << "Engine retrieval for input shapes: "
+          << TensorShapeUtils::ShapeListString(input_concrete_shapes)
+          << " failed. Running native segment for " << name();
+    }
     if (may_execute_native_segment()) {
       ExecuteNativeSegment(ctx, helper);
     }
@@ -680,12 +734,28 @@ Status TRTEngineOp::ExecuteTrtEngine(OpKernelContext* ctx,
   const int num_binding = cuda_engine->getNbBindings();
   std::vector<void*> buffers(num_binding);
 
-  // nvinfer1::IExecutionContext::enqueue is not thread safe and we need a mutex
-  // for it.
-  mutex_lock lock(engine_context->mu);
+  // nvinfer1::IExecutionContext::enqueue is not thread safe, so each context
+  // is used by one execution at a time. Engines with optimization profiles
+  // have exactly one context per profile.
+  const int max_contexts =
+      use_implicit_batch_ ? std::max<int64>(max_execution_contexts_, 1) : 1;
   nvinfer1::IExecutionContext* execution_context;
-  TF_RETURN_IF_ERROR(
-      engine_context->GetExecutionContext(trt_context_idx, &execution_context));
+  bool needs_device_memory;
+  TF_RETURN_IF_ERROR(engine_context->AcquireExecutionContext(
+      trt_context_idx, max_contexts, &execution_context, &needs_device_memory));
+  auto release_context = gtl::MakeCleanup([&] {
+    engine_context->ReleaseExecutionContext(trt_context_idx, execution_context);
+  });
+  // The scratch memory of the context comes from the device allocator, and is
+  // reused by later executions once this one has been enqueued.
+  Tensor device_memory;
+  if (needs_device_memory) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_INT8,
+        TensorShape({static_cast<int64>(cuda_engine->getDeviceMemorySize())}),
+        &device_memory));
+    execution_context->setDeviceMemory(device_memory.flat<int8>().data());
+  }
 
   const int num_batch =
       use_implicit_batch_ ? ctx->input(0).shape().dim_size(0) : 0;
@@ -758,10 +828,6 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     LOG_WARNING_WITH_PREFIX << "Engine creation for " << name() << " failed. "
                             << "The native segment will be used instead. "
                             << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   absl::make_unique<EngineContext>());
     return status;
   }
   return engine;
@@ -831,6 +897,10 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                 /*use_calibration=*/false,
                                 /*calibrator=*/nullptr, cache_res);
       if (!result.ok()) {
+        // Store an empty engine in the cache for these input shapes so we
+        // don't try to build the same failing engine again.
+        cache.emplace(input_concrete_shapes,
+                      absl::make_unique<EngineContext>());
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.ValueOrDie());
@@ -894,11 +964,22 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    // The native segment cannot substitute for the engine while it is being
+    // built if the user disallowed it.
+    if (build_engines_in_background_ && AllowEngineNativeSegmentExecution()) {
+      TF_RETURN_IF_ERROR(StartBackgroundEngineBuild(
+          input_concrete_shapes, batch_size, ctx, cache_res));
+      return std::pair<EngineContext*, int>(PendingEngineContext(), 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result = BuildEngine(input_concrete_shapes, batch_size,
                               use_calibration_, calibrator_.get(), cache_res);
     if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache.emplace(input_concrete_shapes, absl::make_unique<EngineContext>());
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
@@ -917,6 +998,66 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                         use_implicit_batch_ ? 0 : profile_id);
 }
 
+Status TRTEngineOp::StartBackgroundEngineBuild(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_res) {
+  // In explicit batch mode the cache holds a single engine for all the
+  // profiles, so only one engine is ever built.
+  for (const auto& shapes : pending_engine_builds_) {
+    if (!use_implicit_batch_ || shapes == input_concrete_shapes) {
+      return Status::OK();
+    }
+  }
+  const int platform_gpu_id =
+      ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  if (platform_gpu_id < 0) {
+    return errors::InvalidArgument(
+        "Context->device doesn't contain device info!");
+  }
+  VLOG(1) << "Building a TensorRT engine for " << name()
+          << " in the background for input shapes: "
+          << TensorShapeUtils::ShapeListString(input_concrete_shapes);
+  pending_engine_builds_.push_back(input_concrete_shapes);
+  cache_res->Ref();
+  ctx->env()->SchedClosure([this, input_concrete_shapes, batch_size,
+                            platform_gpu_id, cache_res]() {
+    core::ScopedUnref sc(cache_res);
+    auto err = cudaSetDevice(platform_gpu_id);
+    if (err != cudaSuccess) {
+      LOG(ERROR) << "Couldn't set cuda device to " << platform_gpu_id
+                 << " in engine build thread";
+    }
+    auto result = BuildEngine(input_concrete_shapes, batch_size,
+                              use_calibration_, calibrator_.get(), cache_res);
+    std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> exec_context;
+    Status status = result.status();
+    if (status.ok()) {
+      status = cache_res->profiles_.CreateExecutionContexts(
+          result.ValueOrDie().get(), exec_context);
+    }
+
+    mutex_lock lock(engine_mutex_);
+    if (status.ok()) {
+      cache_res->cache_.emplace(
+          input_concrete_shapes,
+          absl::make_unique<EngineContext>(std::move(result.ValueOrDie()),
+                                           std::move(exec_context)));
+      VLOG(1) << "Added new engine to cache of " << name()
+              << ". Cache size: " << cache_res->cache_.size();
+    } else {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache_res->cache_.emplace(input_concrete_shapes,
+                                absl::make_unique<EngineContext>());
+    }
+    pending_engine_builds_.erase(std::find(pending_engine_builds_.begin(),
+                                           pending_engine_builds_.end(),
+                                           input_concrete_shapes));
+    engine_build_done_.notify_all();
+  });
+  return Status::OK();
+}
+
 // TODO(hinsu): Move this allocation to CalibrationContext constructor, if
 // possible.
 Status TRTEngineOp::AllocateCalibrationResources(
@@ -96,6 +96,62 @@ string TRTEngineCacheResource::DebugString() const {
   return oss.str();
 }
 
+Status EngineContext::AcquireExecutionContext(
+    int idx, int max_contexts, nvinfer1::IExecutionContext** exec_ctx,
+    bool* needs_device_memory) {
+  mutex_lock lock(mu);
+  if (idx >= execution_context.size()) {
+    return errors::Internal("Requested engine context with index ", idx,
+                            ", but only ", execution_context.size(),
+                            "contexts are present.");
+  }
+  if (free_execution_contexts_.empty()) {
+    free_execution_contexts_.resize(execution_context.size());
+    num_execution_contexts_.resize(execution_context.size(), 1);
+    for (int i = 0; i < execution_context.size(); ++i) {
+      free_execution_contexts_[i].push_back(execution_context[i].get());
+    }
+  }
+  auto& free_contexts = free_execution_contexts_[idx];
+  if (free_contexts.empty() && num_execution_contexts_[idx] < max_contexts) {
+#if IS_TRT_VERSION_GE(6, 0, 0, 0)
+    nvinfer1::IExecutionContext* ctx =
+        cuda_engine->createExecutionContextWithoutDeviceMemory();
+#else
+    nvinfer1::IExecutionContext* ctx = cuda_engine->createExecutionContext();
+#endif
+    if (ctx != nullptr) {
+      VLOG(1) << "Created execution context " << num_execution_contexts_[idx]
+              << " for profile " << idx;
+      extra_execution_contexts_.emplace_back(ctx);
+      ++num_execution_contexts_[idx];
+      free_contexts.push_back(ctx);
+    } else {
+      LOG(WARNING) << "Failed to create an additional execution context";
+    }
+  }
+  while (free_contexts.empty()) {
+    context_released_.wait(lock);
+  }
+  *exec_ctx = free_contexts.back();
+  free_contexts.pop_back();
+#if IS_TRT_VERSION_GE(6, 0, 0, 0)
+  *needs_device_memory = *exec_ctx != execution_context[idx].get();
+#else
+  *needs_device_memory = false;
+#endif
+  return Status::OK();
+}
+
+void EngineContext::ReleaseExecutionContext(
+    int idx, nvinfer1::IExecutionContext* exec_ctx) {
+  {
+    mutex_lock lock(mu);
+    free_execution_contexts_[idx].push_back(exec_ctx);
+  }
+  context_released_.notify_one();
+}
+
 EngineContext* TRTEngineCacheResource::GetEngineContext(
     const std::vector<TensorShape>& input_shapes) {
   EngineContext* engine_context = nullptr;
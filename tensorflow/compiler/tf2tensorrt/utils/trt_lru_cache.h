@@ -145,6 +145,25 @@ struct EngineContext {
     return Status::OK();
   }
 
+  // Borrows an execution context for profile `idx` for the exclusive use of
+  // the caller, which must return it with ReleaseExecutionContext(). If all
+  // the contexts of the profile are in use and there are fewer than
+  // `max_contexts`, creates another one, so that concurrent executions of the
+  // engine do not wait for each other. Otherwise waits for a context to be
+  // released. `max_contexts` must be 1 for engines with optimization profiles,
+  // because a profile may only be used by one context at a time.
+  //
+  // Contexts created this way have no device memory of their own. For them,
+  // `*needs_device_memory` is set to true, and the caller must pass a scratch
+  // buffer of `cuda_engine->getDeviceMemorySize()` bytes to
+  // `setDeviceMemory()` before enqueueing work.
+  Status AcquireExecutionContext(int idx, int max_contexts,
+                                 nvinfer1::IExecutionContext** exec_ctx,
+                                 bool* needs_device_memory)
+      TF_LOCKS_EXCLUDED(mu);
+  void ReleaseExecutionContext(int idx, nvinfer1::IExecutionContext* exec_ctx)
+      TF_LOCKS_EXCLUDED(mu);
+
   // In explicit batch mode, we maintain a vector of contexts for each engine,
   // where each context is created for a different profile. The
   // IExecutionContext object is not thread safe: only one thread should use it
@@ -152,6 +171,20 @@ struct EngineContext {
   // https://docs.nvidia.com/deeplearning/sdk/tensorrt-best-practices/index.html#thread-safety
   std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> execution_context
       TF_GUARDED_BY(mu);
+
+ private:
+  // Signalled when a context is released.
+  condition_variable context_released_;
+  // The contexts of each profile that are not in use. Filled in by the first
+  // call to AcquireExecutionContext().
+  std::vector<std::vector<nvinfer1::IExecutionContext*>>
+      free_execution_contexts_ TF_GUARDED_BY(mu);
+  // The number of contexts of each profile, including those in use.
+  std::vector<int> num_execution_contexts_ TF_GUARDED_BY(mu);
+  // The contexts created by AcquireExecutionContext(), which share the device
+  // memory of the executions that use them.
+  std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>>
+      extra_execution_contexts_ TF_GUARDED_BY(mu);
 };
 
 // Contains the context required to build the calibration data.
@@ -0,0 +1,129 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2XLA_XLA_COMPILED_CPU_FUNCTION_POOL_H_
+#define TENSORFLOW_COMPILER_TF2XLA_XLA_COMPILED_CPU_FUNCTION_POOL_H_
+
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+// Forward-declare, rather than include, to reduce code size for users that
+// never use this functionality.
+namespace Eigen {
+struct ThreadPoolDevice;
+}
+
+namespace tensorflow {
+
+// XlaCompiledCpuFunctionPool hands out instances of the tfcompile generated
+// class T to concurrent callers. Generated classes are thread-compatible and
+// own their arg, result and temp buffers, so a caller must have exclusive
+// access to an instance while it sets args, runs and reads results. Rather
+// than constructing an instance (and allocating its buffers) for every call,
+// callers acquire an idle instance from the pool and return it when done:
+//
+//   XlaCompiledCpuFunctionPool<MyClass> pool(&device);
+//   ...
+//   // On any thread:
+//   auto computation = pool.Acquire();
+//   // ...set args using computation->argN methods
+//   CHECK(computation->Run());
+//   // ...inspect results using computation->resultN methods
+//
+// Instances are created on demand, so the pool grows to the largest number of
+// concurrent callers and stays there. If `thread_pool` is non-null it is used
+// as the intra-op thread pool of every instance; Eigen thread pools may be
+// shared by concurrent Run calls.
+//
+// This class is thread-safe.
+template <typename T>
+class XlaCompiledCpuFunctionPool {
+ public:
+  // Handle gives exclusive access to an instance of T until it is destroyed,
+  // at which point the instance is returned to the pool.
+  class Handle {
+   public:
+    Handle(Handle&& other) : pool_(other.pool_), fn_(std::move(other.fn_)) {
+      other.pool_ = nullptr;
+    }
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+    Handle& operator=(Handle&&) = delete;
+
+    ~Handle() {
+      if (pool_ != nullptr) pool_->Release(std::move(fn_));
+    }
+
+    T* get() const { return fn_.get(); }
+    T* operator->() const { return fn_.get(); }
+    T& operator*() const { return *fn_; }
+
+   private:
+    friend class XlaCompiledCpuFunctionPool;
+
+    Handle(XlaCompiledCpuFunctionPool* pool, std::unique_ptr<T> fn)
+        : pool_(pool), fn_(std::move(fn)) {}
+
+    XlaCompiledCpuFunctionPool* pool_;
+    std::unique_ptr<T> fn_;
+  };
+
+  explicit XlaCompiledCpuFunctionPool(
+      const Eigen::ThreadPoolDevice* thread_pool = nullptr)
+      : thread_pool_(thread_pool) {}
+
+  XlaCompiledCpuFunctionPool(const XlaCompiledCpuFunctionPool&) = delete;
+  XlaCompiledCpuFunctionPool& operator=(const XlaCompiledCpuFunctionPool&) =
+      delete;
+
+  // Returns an idle instance, creating a new one if all instances are in use.
+  // REQUIRES: The returned handle does not outlive the pool.
+  Handle Acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!idle_.empty()) {
+        std::unique_ptr<T> fn = std::move(idle_.back());
+        idle_.pop_back();
+        return Handle(this, std::move(fn));
+      }
+    }
+    std::unique_ptr<T> fn(new T());
+    if (thread_pool_ != nullptr) fn->set_thread_pool(thread_pool_);
+    return Handle(this, std::move(fn));
+  }
+
+  // Returns the number of instances waiting in the pool.
+  size_t num_idle() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return idle_.size();
+  }
+
+ private:
+  void Release(std::unique_ptr<T> fn) {
+    std::lock_guard<std::mutex> lock(mu_);
+    idle_.push_back(std::move(fn));
+  }
+
+  const Eigen::ThreadPoolDevice* const thread_pool_;
+  mutable std::mutex mu_;
+  std::vector<std::unique_ptr<T>> idle_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_TF2XLA_XLA_COMPILED_CPU_FUNCTION_POOL_H_
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 
+#include <algorithm>
 #include <numeric>
+#include <set>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -671,14 +673,34 @@ Status XlaCompiler::CompileFunction(
   const FunctionBody* fbody;
   TF_RETURN_IF_ERROR(FindFunctionBody(fn_name_attrs, &fbody));
 
+  // Arguments past the function's own may only carry the sizes of dynamic
+  // dimensions of the others.
+  const int num_function_args = fbody->arg_types.size();
+  std::set<int> dynamic_size_args;
+  for (const XlaCompiler::Argument& arg : args) {
+    for (const auto& dim_and_arg_num : arg.dynamic_dim_to_arg_num_map) {
+      dynamic_size_args.insert(dim_and_arg_num.second);
+    }
+  }
+  for (int i = num_function_args, end = args.size(); i < end; i++) {
+    if (!dynamic_size_args.count(i) ||
+        args[i].kind != XlaCompiler::Argument::kParameter) {
+      return errors::Internal("Compilation arguments have ", args.size(),
+                              " elements while function has ",
+                              num_function_args);
+    }
+  }
   TF_RETURN_WITH_CONTEXT_IF_ERROR(
-      CheckSignature(fbody->arg_types, args),
+      CheckSignature(fbody->arg_types,
+                     args.first(std::min<size_t>(args.size(),
+                                                 num_function_args))),
       "Signature check failure while compiling: ", fn_name_attrs.name());
 
   // Set shapes for _Arg nodes. They are useful for constant folding (e.g. an
   // Xla op requires a compile-time constant input, and that input is shape of
   // an _Arg node.
-  for (int i = 0, end = args.size(); i < end; i++) {
+  for (int i = 0, end = std::min<int>(args.size(), num_function_args);
+       i < end; i++) {
     // Skip resource variables and tensor lists.
     DataType dtype;
     TF_RETURN_IF_ERROR(GetNodeAttr(fbody->arg_nodes[i]->def(), "T", &dtype));
@@ -695,10 +717,17 @@ Status XlaCompiler::CompileFunction(
                                      std::vector<TensorShape>{tensor_shape});
       }
     } else {
-      TensorShape tensor_shape = absl::get<TensorShape>(args[i].shape);
+      // Dynamic dimensions are only bounded by the static shape, so they must
+      // not be folded into constants.
+      gtl::InlinedVector<int64, 4> dims =
+          absl::get<TensorShape>(args[i].shape).dim_sizes();
+      for (const auto& dim_and_arg_num : args[i].dynamic_dim_to_arg_num_map) {
+        dims[dim_and_arg_num.first] = -1;
+      }
       fbody->arg_nodes[i]->ClearAttr("_output_shapes");
-      fbody->arg_nodes[i]->AddAttr("_output_shapes",
-                                   std::vector<TensorShape>{tensor_shape});
+      fbody->arg_nodes[i]->AddAttr(
+          "_output_shapes",
+          std::vector<PartialTensorShape>{PartialTensorShape(dims)});
     }
   }
 
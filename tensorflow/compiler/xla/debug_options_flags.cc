@@ -38,6 +38,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_cpu_multi_thread_eigen(true);
   opts.set_xla_gpu_cuda_data_dir("./cuda_sdk_lib");
   opts.set_xla_gpu_asm_extra_flags("");
+  opts.set_xla_gpu_persistent_cache_max_bytes(4LL << 30);
   opts.set_xla_eliminate_hlo_implicit_broadcast(true);
   opts.set_xla_dump_hlo_as_html(false);
   opts.set_xla_dump_include_timestamp(true);
@@ -137,6 +138,13 @@ static void AllocateFlags() {
     };
   };
 
+  auto int64_setter_for = [](void (DebugOptions::*member_setter)(int64)) {
+    return [member_setter](int64 value) {
+      (flag_values->*member_setter)(value);
+      return true;
+    };
+  };
+
   auto string_setter_for =
       [](void (DebugOptions::*member_setter)(const string& value)) {
         return [member_setter](const string& value) {
@@ -436,6 +444,36 @@ static void AllocateFlags() {
       string_setter_for(&DebugOptions::set_xla_gpu_asm_extra_flags), "",
       "Pass extra parameters to the GPU assembler tool (i.e., ptxas for CUDA). "
       "If multiple parameters, separate them by comma."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_persistent_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_persistent_cache_dir), "",
+      "If set, caches the PTX and cubin of compiled modules in this "
+      "directory, so that other processes, and later runs of this one, skip "
+      "LLVM optimization and ptxas for modules they have seen before. The "
+      "directory may live on a shared file system."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_persistent_cache_max_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_persistent_cache_max_bytes),
+      flag_values->xla_gpu_persistent_cache_max_bytes(),
+      "Size budget of --xla_gpu_persistent_cache_dir. The least recently "
+      "used entries are deleted once it is exceeded; <= 0 means unbounded."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cost_model_fusion",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cost_model_fusion),
+      flag_values->xla_gpu_enable_cost_model_fusion(),
+      "In XLA:GPU, veto the fusions and fusion merges that a roofline model "
+      "of the device predicts to be slower than running the kernels "
+      "separately. With --xla_hlo_profile, the optimal times of the profile "
+      "come from the same model, to compare its predictions with the "
+      "measured kernel times."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_async_all_reduce",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_async_all_reduce),
+      flag_values->xla_gpu_enable_async_all_reduce(),
+      "In XLA:GPU, run all-reduces on a stream of their own, and schedule "
+      "independent kernels between the launch of each all-reduce and its "
+      "first user, up to the estimated time of the all-reduce."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_fuel", setter_for_xla_fuel, /*default_value_for_display=*/"",
       "Sets compiler fuel, useful for bisecting bugs in passes.  Format "
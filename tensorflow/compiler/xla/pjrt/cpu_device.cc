@@ -15,14 +15,19 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/cpu_device.h"
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/pjrt/pooled_device_memory_allocator.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
 
 namespace xla {
 
 static const char kCpuPlatformName[] = "cpu";
 
+// The bytes of freed buffers kept for reuse by later executions, per device.
+static constexpr int64 kCpuPooledBytesPerDevice = 256LL * 1024 * 1024;
+
 CpuDevice::CpuDevice(int id,
                      std::unique_ptr<LocalDeviceState> local_device_state)
     : PjRtDevice(id, std::move(local_device_state), kCpuPlatformName,
@@ -58,7 +63,9 @@ StatusOr<std::shared_ptr<PjRtClient>> GetCpuClient(bool asynchronous) {
 
   return std::make_shared<PjRtClient>(
       kCpuPlatformName, client, std::move(devices), /*host_id=*/0,
-      /*allocator=*/nullptr, /*host_memory_allocator=*/nullptr,
+      absl::make_unique<PooledDeviceMemoryAllocator>(
+          client->backend().memory_allocator(), kCpuPooledBytesPerDevice),
+      /*host_memory_allocator=*/nullptr,
       /*should_stage_host_to_device_transfers=*/false,
       /*gpu_run_options=*/nullptr);
 }
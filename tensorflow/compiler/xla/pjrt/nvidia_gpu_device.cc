@@ -19,6 +19,7 @@ limitations under the License.
 #include "third_party/nccl/nccl.h"
 #endif  // NCCL_ENABLED
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/pjrt/pooled_device_memory_allocator.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
 #include "tensorflow/compiler/xla/util.h"
@@ -311,6 +312,16 @@ StatusOr<std::shared_ptr<PjRtClient>> GetNvidiaGpuClient(
   TF_ASSIGN_OR_RETURN(
       auto allocator,
       GetGpuDeviceAllocator(allocator_config, local_device_states));
+  if (allocator_config.pooled_bytes_per_device > 0) {
+    if (allocator) {
+      allocator = absl::make_unique<PooledDeviceMemoryAllocator>(
+          std::move(allocator), allocator_config.pooled_bytes_per_device);
+    } else {
+      allocator = absl::make_unique<PooledDeviceMemoryAllocator>(
+          xla_client->backend().memory_allocator(),
+          allocator_config.pooled_bytes_per_device);
+    }
+  }
   auto host_memory_allocator =
       GetGpuHostAllocator(local_device_states.front()->executor());
 
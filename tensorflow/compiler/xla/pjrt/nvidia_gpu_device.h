@@ -49,6 +49,11 @@ struct GpuAllocatorConfig {
   // fragmentation, allowing more of the total memory to be used. If false, the
   // allocator will allocate more memory as allocations are requested.
   bool preallocate = true;
+
+  // If positive, the buffers freed by executions are kept in per-device pools
+  // of up to this many bytes, and reused by later allocations of the same
+  // size. See PooledDeviceMemoryAllocator.
+  int64 pooled_bytes_per_device = 0;
 };
 
 // distributed_client may be nullptr in non-distributed settings.
@@ -69,7 +69,9 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
@@ -1726,11 +1728,10 @@ std::vector<std::unique_ptr<PjRtBuffer>> PjRtExecutable::MakeOutputBuffers(
   return outputs;
 }
 
-StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
-PjRtExecutable::ExecuteHelper(absl::Span<PjRtBuffer* const> argument_handles,
-                              int replica, int partition, const RunId& run_id,
-                              const ExecuteOptions& options,
-                              PjRtDevice* device) const {
+Status PjRtExecutable::StartExecution(
+    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
+    const RunId& run_id, const ExecuteOptions& options, PjRtDevice* device,
+    EnqueuedExecution* execution) const {
   std::shared_ptr<DeviceAssignment> device_assignment;
   if (device == nullptr) {
     CHECK(device_assignment_ != nullptr);
@@ -1755,43 +1756,55 @@ PjRtExecutable::ExecuteHelper(absl::Span<PjRtBuffer* const> argument_handles,
   // SPMD sharding produces a single executable for multiple partitions.
   int executable_idx = executables_.size() > 1 ? partition : 0;
 
-  std::vector<PjRtBuffer::ScopedHold> device_buffers;
-  device_buffers.reserve(argument_handles.size());
+  execution->device = device;
+  execution->device_ordinal = device_ordinal;
+  execution->device_buffers.reserve(argument_handles.size());
   StatusOr<ScopedShapedBuffer> result_buffer_or_status = EnqueueExecution(
       argument_handles, replica, partition, executable_idx, run_id, options,
-      device, &device_buffers, std::move(device_assignment));
+      device, &execution->device_buffers, std::move(device_assignment));
 
   if (!result_buffer_or_status.ok()) {
     LOG(ERROR) << "Execution of replica " << replica
                << " failed: " << result_buffer_or_status.status();
     return result_buffer_or_status.status();
   }
-  ScopedShapedBuffer result_buffer =
-      result_buffer_or_status.ConsumeValueOrDie();
+  execution->result_buffer.emplace(
+      result_buffer_or_status.ConsumeValueOrDie());
+  return Status::OK();
+}
 
-  LocalDeviceState* device_state = &client_->device_state(device_ordinal);
-  se::Stream* stream = device_state->compute_stream();
-  StatusOr<EventPool::Handle> event_or =
-      device_state->event_pool().ThenAllocateAndRecordEvent(stream);
-  if (!event_or.ok()) {
-    StallStreamOnError(device_state, stream);
-    for (PjRtBuffer::ScopedHold& b : device_buffers) {
-      if (b.type() == PjRtBuffer::ScopedHold::kDonation) {
-        // Even though there was an error we need to call ConfirmDonation, which
-        // renders b invalid, since the computation has been enqueued and b has
-        // been donated.
-        b.ConfirmDonation();
-      }
+namespace {
+
+// Called when the definition event of an enqueued execution could not be
+// created.
+void AbortEnqueuedExecution(
+    LocalDeviceState* device_state,
+    std::vector<PjRtBuffer::ScopedHold>* device_buffers) {
+  StallStreamOnError(device_state, device_state->compute_stream());
+  for (PjRtBuffer::ScopedHold& b : *device_buffers) {
+    if (b.type() == PjRtBuffer::ScopedHold::kDonation) {
+      // Even though there was an error we need to call ConfirmDonation, which
+      // renders b invalid, since the computation has been enqueued and b has
+      // been donated.
+      b.ConfirmDonation();
     }
-    return event_or.status();
   }
-  auto definition_event = std::make_shared<BufferSequencingEvent>();
-  definition_event->SetSequencingEvent(event_or.ConsumeValueOrDie(), stream);
-  std::vector<std::unique_ptr<PjRtBuffer>> outputs =
-      MakeOutputBuffers(device_ordinal, options, std::move(result_buffer),
-                        definition_event, device);
+}
+
+}  // namespace
+
+std::vector<std::unique_ptr<PjRtBuffer>> PjRtExecutable::FinishExecution(
+    const ExecuteOptions& options,
+    std::shared_ptr<BufferSequencingEvent> definition_event,
+    EnqueuedExecution* execution) const {
+  LocalDeviceState* device_state =
+      &client_->device_state(execution->device_ordinal);
+  se::Stream* stream = device_state->compute_stream();
+  std::vector<std::unique_ptr<PjRtBuffer>> outputs = MakeOutputBuffers(
+      execution->device_ordinal, options, std::move(*execution->result_buffer),
+      definition_event, execution->device);
 
-  for (PjRtBuffer::ScopedHold& b : device_buffers) {
+  for (PjRtBuffer::ScopedHold& b : execution->device_buffers) {
     // prefer_to_retain_reference=false because when using the
     // ComputeSynchronized allocation model we don't need to retain a reference
     // to the device_buffer during execution because by definition the compute
@@ -1809,6 +1822,50 @@ PjRtExecutable::ExecuteHelper(absl::Span<PjRtBuffer* const> argument_handles,
   return outputs;
 }
 
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+PjRtExecutable::ExecuteHelper(absl::Span<PjRtBuffer* const> argument_handles,
+                              int replica, int partition, const RunId& run_id,
+                              const ExecuteOptions& options,
+                              PjRtDevice* device) const {
+  EnqueuedExecution execution;
+  TF_RETURN_IF_ERROR(StartExecution(argument_handles, replica, partition,
+                                    run_id, options, device, &execution));
+
+  LocalDeviceState* device_state =
+      &client_->device_state(execution.device_ordinal);
+  se::Stream* stream = device_state->compute_stream();
+  StatusOr<EventPool::Handle> event_or =
+      device_state->event_pool().ThenAllocateAndRecordEvent(stream);
+  if (!event_or.ok()) {
+    AbortEnqueuedExecution(device_state, &execution.device_buffers);
+    return event_or.status();
+  }
+  auto definition_event = std::make_shared<BufferSequencingEvent>();
+  definition_event->SetSequencingEvent(event_or.ConsumeValueOrDie(), stream);
+  return FinishExecution(options, std::move(definition_event), &execution);
+}
+
+Status PjRtExecutable::GetLocalReplicaAndPartition(PjRtDevice** device,
+                                                   int* replica,
+                                                   int* partition) const {
+  *replica = 0;
+  *partition = 0;
+  if (device_assignment_ == nullptr) {
+    return Status::OK();
+  }
+  for (int i = 0; i < local_devices_.size(); ++i) {
+    if (local_devices_[i] == *device) {
+      *replica = local_logical_device_ids_[i].first;
+      *partition = local_logical_device_ids_[i].second;
+      *device = nullptr;
+      return Status::OK();
+    }
+  }
+  return InvalidArgument(
+      "Attempted to execute on device id %d which is not a local device",
+      (*device)->id());
+}
+
 StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> PjRtExecutable::Execute(
     absl::Span<PjRtBuffer* const> argument_handles,
     const ExecuteOptions& options) const {
@@ -1834,22 +1891,14 @@ PjRtExecutable::ExecuteOnLocalDevice(
   if (device_assignment_ == nullptr) {
     VLOG(1) << "Executing portable single-core program on "
             << device->DebugString();
-    return ExecuteHelper(argument_handles,
-                         /*replica=*/0,
-                         /*partition=*/0, RunId(), options, device);
-  }
-  for (int i = 0; i < local_devices_.size(); ++i) {
-    if (local_devices_[i] == device) {
-      VLOG(1) << "Executing computation " << name();
-      return ExecuteHelper(argument_handles,
-                           /*replica=*/local_logical_device_ids_[i].first,
-                           /*partition=*/local_logical_device_ids_[i].second,
-                           RunId(), options);
-    }
+  } else {
+    VLOG(1) << "Executing computation " << name();
   }
-  return InvalidArgument(
-      "Attempted to execute on device id %d which is not a local device",
-      device->id());
+  int replica, partition;
+  TF_RETURN_IF_ERROR(
+      GetLocalReplicaAndPartition(&device, &replica, &partition));
+  return ExecuteHelper(argument_handles, replica, partition, RunId(), options,
+                       device);
 }
 
 StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
@@ -2182,4 +2231,84 @@ StatusOr<std::pair<std::vector<Shape>, Shape>> GetShardedProgramShapes(
   return executable;
 }
 
+StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+PjRtExecutable::ExecuteBatch(absl::Span<const BatchedExecution> executions,
+                             const ExecuteOptions& options) {
+  tensorflow::profiler::TraceMe traceme("PjRtExecutable::ExecuteBatch");
+  VLOG(1) << "Executing a batch of " << executions.size() << " computations";
+
+  std::vector<EnqueuedExecution> enqueued(executions.size());
+  // The devices with enqueued executions, in the order they were first used.
+  absl::InlinedVector<LocalDeviceState*, 4> device_states;
+  Status status;
+  int num_enqueued = 0;
+  for (; num_enqueued < executions.size(); ++num_enqueued) {
+    const BatchedExecution& execution = executions[num_enqueued];
+    const PjRtExecutable* executable = execution.executable;
+    PjRtDevice* device = execution.device;
+    int replica = 0, partition = 0;
+    if (device == nullptr) {
+      if (executable->num_replicas() != 1 ||
+          executable->num_partitions() != 1) {
+        status = InvalidArgument(
+            "Attempted to execute computation with %d replicas and %d "
+            "partitions using ExecuteBatch() without a device",
+            executable->num_replicas(), executable->num_partitions());
+        break;
+      }
+    } else {
+      status = executable->GetLocalReplicaAndPartition(&device, &replica,
+                                                       &partition);
+      if (!status.ok()) break;
+    }
+    EnqueuedExecution* enqueued_execution = &enqueued[num_enqueued];
+    status = executable->StartExecution(execution.argument_handles, replica,
+                                        partition, RunId(), options, device,
+                                        enqueued_execution);
+    if (!status.ok()) break;
+    LocalDeviceState* device_state =
+        enqueued_execution->device->local_device_state();
+    if (!absl::c_linear_search(device_states, device_state)) {
+      device_states.push_back(device_state);
+    }
+  }
+  if (!status.ok()) {
+    status = AppendStatus(
+        status, absl::StrFormat("while enqueueing execution %d of a batch",
+                                num_enqueued));
+  }
+
+  // One definition event per device, recorded after the last execution
+  // enqueued on it, defines the outputs of all the executions on the device.
+  absl::flat_hash_map<LocalDeviceState*, std::shared_ptr<BufferSequencingEvent>>
+      definition_events;
+  for (LocalDeviceState* device_state : device_states) {
+    se::Stream* stream = device_state->compute_stream();
+    StatusOr<EventPool::Handle> event_or =
+        device_state->event_pool().ThenAllocateAndRecordEvent(stream);
+    if (!event_or.ok()) {
+      for (int i = 0; i < num_enqueued; ++i) {
+        if (enqueued[i].device->local_device_state() == device_state) {
+          AbortEnqueuedExecution(device_state, &enqueued[i].device_buffers);
+        }
+      }
+      status.Update(event_or.status());
+      continue;
+    }
+    auto definition_event = std::make_shared<BufferSequencingEvent>();
+    definition_event->SetSequencingEvent(event_or.ConsumeValueOrDie(), stream);
+    definition_events[device_state] = std::move(definition_event);
+  }
+
+  std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> results(num_enqueued);
+  for (int i = 0; i < num_enqueued; ++i) {
+    auto it = definition_events.find(enqueued[i].device->local_device_state());
+    if (it == definition_events.end()) continue;
+    results[i] = executions[i].executable->FinishExecution(
+        options, it->second, &enqueued[i]);
+  }
+  TF_RETURN_IF_ERROR(status);
+  return results;
+}
+
 }  // namespace xla
@@ -768,6 +768,29 @@ class PjRtExecutable {
       absl::Span<const std::vector<PjRtBuffer*>> argument_handles,
       const ExecuteOptions& options) const;
 
+  // One execution of a batch passed to ExecuteBatch().
+  struct BatchedExecution {
+    const PjRtExecutable* executable;
+    absl::Span<PjRtBuffer* const> argument_handles;
+    // If null, the executable is run as by Execute(), otherwise it is run on
+    // this device as by ExecuteOnLocalDevice().
+    PjRtDevice* device = nullptr;
+  };
+
+  // Enqueues a sequence of executions of the same or different executables,
+  // in order, and returns their results (one result per execution). This is
+  // cheaper than calling Execute() once per execution when running many small
+  // programs: a single definition event is recorded per device after the last
+  // execution enqueued on it, and shared by all the outputs produced on that
+  // device. As a consequence, an output of the batch only becomes ready once
+  // all the executions enqueued on its device in the batch have completed. All
+  // the executions share `options`. If an execution fails to be
+  // enqueued, the executions enqueued before it still run, but their outputs
+  // are discarded and the error is returned.
+  static StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+  ExecuteBatch(absl::Span<const BatchedExecution> executions,
+               const ExecuteOptions& options);
+
   void Delete() { executables_.clear(); }
 
   const string& name() const;
@@ -809,6 +832,34 @@ class PjRtExecutable {
       int partition, const RunId& run_id, const ExecuteOptions& options,
       PjRtDevice* device = nullptr) const;
 
+  // An execution that has been enqueued, but whose outputs have not been
+  // created yet since they need a definition event.
+  struct EnqueuedExecution {
+    PjRtDevice* device = nullptr;
+    int device_ordinal = -1;
+    absl::optional<ScopedShapedBuffer> result_buffer;
+    std::vector<PjRtBuffer::ScopedHold> device_buffers;
+  };
+
+  // The two halves of ExecuteHelper(), which are split so that ExecuteBatch()
+  // can record one definition event for many executions. StartExecution()
+  // enqueues the execution, and FinishExecution() creates its outputs, defined
+  // by `definition_event`, which must be recorded on the compute stream of the
+  // device after the execution.
+  Status StartExecution(absl::Span<PjRtBuffer* const> argument_handles,
+                        int replica, int partition, const RunId& run_id,
+                        const ExecuteOptions& options, PjRtDevice* device,
+                        EnqueuedExecution* execution) const;
+  std::vector<std::unique_ptr<PjRtBuffer>> FinishExecution(
+      const ExecuteOptions& options,
+      std::shared_ptr<BufferSequencingEvent> definition_event,
+      EnqueuedExecution* execution) const;
+
+  // Returns the replica and partition to execute on `device`, or sets `device`
+  // to null if the executable is portable, as in ExecuteOnLocalDevice().
+  Status GetLocalReplicaAndPartition(PjRtDevice** device, int* replica,
+                                     int* partition) const;
+
   // Create shared pointers so we can free them after the execution: with
   // asynchronous execution, the process being executed can outlive the
   // executable itself.
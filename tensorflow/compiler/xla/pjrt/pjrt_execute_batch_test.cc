@@ -0,0 +1,155 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/pjrt/cpu_device.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace xla {
+namespace {
+
+constexpr int kNumElements = 4;
+
+// Compiles a computation applying `op` to a single S32[kNumElements] parameter.
+std::unique_ptr<PjRtExecutable> CompileUnary(PjRtClient* client,
+                                             XlaOp (*op)(XlaOp)) {
+  XlaBuilder builder("unary");
+  op(Parameter(&builder, 0, ShapeUtil::MakeShape(S32, {kNumElements}), "p"));
+  XlaComputation computation = builder.Build().ValueOrDie();
+  return PjRtExecutable::Compile(computation, client, CompileOptions())
+      .ValueOrDie();
+}
+
+XlaOp AddOne(XlaOp x) { return x + ConstantR0<int32>(x.builder(), 1); }
+
+XlaOp Negate(XlaOp x) { return Neg(x); }
+
+std::unique_ptr<PjRtBuffer> MakeInput(PjRtClient* client,
+                                      const std::vector<int32>& data) {
+  return PjRtBuffer::FromHostBuffer(
+             data.data(), ShapeUtil::MakeShape(S32, {kNumElements}),
+             PjRtBuffer::HostBufferSemantics::kImmutableUntilTransferCompletes,
+             /*buffer_reference=*/nullptr, client, client->local_devices()[0])
+      .ValueOrDie();
+}
+
+TEST(PjRtExecuteBatchTest, MatchesExecute) {
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtClient> client,
+                          GetCpuClient(/*asynchronous=*/true));
+  std::unique_ptr<PjRtExecutable> add_one = CompileUnary(client.get(), AddOne);
+  std::unique_ptr<PjRtExecutable> negate = CompileUnary(client.get(), Negate);
+  std::unique_ptr<PjRtBuffer> input = MakeInput(client.get(), {1, 2, 3, 4});
+  PjRtBuffer* args[] = {input.get()};
+
+  std::vector<PjRtExecutable::BatchedExecution> executions;
+  for (int i = 0; i < 3; ++i) {
+    executions.push_back({add_one.get(), args});
+    executions.push_back({negate.get(), args, client->local_devices()[0]});
+  }
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto results, PjRtExecutable::ExecuteBatch(executions, ExecuteOptions()));
+  ASSERT_EQ(executions.size(), results.size());
+  for (int i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(1, results[i].size());
+    TF_ASSERT_OK_AND_ASSIGN(auto literal, results[i][0]->ToLiteral());
+    if (i % 2 == 0) {
+      LiteralTestUtil::ExpectR1Equal<int32>({2, 3, 4, 5}, *literal);
+    } else {
+      LiteralTestUtil::ExpectR1Equal<int32>({-1, -2, -3, -4}, *literal);
+    }
+  }
+
+  // The outputs of a batch can be consumed by the next one.
+  PjRtBuffer* chained_args[] = {results[0][0].get()};
+  std::vector<PjRtExecutable::BatchedExecution> chained_executions = {
+      {add_one.get(), chained_args}};
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto chained,
+      PjRtExecutable::ExecuteBatch(chained_executions, ExecuteOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, chained[0][0]->ToLiteral());
+  LiteralTestUtil::ExpectR1Equal<int32>({3, 4, 5, 6}, *literal);
+}
+
+TEST(PjRtExecuteBatchTest, ReportsTheFailingExecution) {
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtClient> client,
+                          GetCpuClient(/*asynchronous=*/true));
+  std::unique_ptr<PjRtExecutable> add_one = CompileUnary(client.get(), AddOne);
+  std::unique_ptr<PjRtBuffer> input = MakeInput(client.get(), {1, 2, 3, 4});
+  PjRtBuffer* args[] = {input.get()};
+
+  std::vector<PjRtExecutable::BatchedExecution> executions = {
+      {add_one.get(), args}, {add_one.get(), {}}};
+  auto results = PjRtExecutable::ExecuteBatch(executions, ExecuteOptions());
+  ASSERT_FALSE(results.ok());
+  EXPECT_THAT(results.status().error_message(),
+              ::testing::HasSubstr("execution 1 of a batch"));
+
+  // The input is still usable after the failed batch.
+  TF_ASSERT_OK_AND_ASSIGN(auto outputs,
+                          add_one->Execute(args, ExecuteOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, outputs[0]->ToLiteral());
+  LiteralTestUtil::ExpectR1Equal<int32>({2, 3, 4, 5}, *literal);
+}
+
+// Dispatch rate of small programs, one Execute() call per program.
+void BM_ExecuteSmallPrograms(int iters, int num_programs) {
+  tensorflow::testing::StopTiming();
+  std::shared_ptr<PjRtClient> client =
+      GetCpuClient(/*asynchronous=*/true).ValueOrDie();
+  std::unique_ptr<PjRtExecutable> add_one = CompileUnary(client.get(), AddOne);
+  std::unique_ptr<PjRtBuffer> input = MakeInput(client.get(), {1, 2, 3, 4});
+  PjRtBuffer* args[] = {input.get()};
+  tensorflow::testing::ItemsProcessed(static_cast<int64>(iters) *
+                                      num_programs);
+  tensorflow::testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    std::vector<std::unique_ptr<PjRtBuffer>> outputs;
+    for (int j = 0; j < num_programs; ++j) {
+      outputs = add_one->Execute(args, ExecuteOptions()).ValueOrDie();
+    }
+    TF_CHECK_OK(outputs[0]->BlockHostUntilReady());
+  }
+}
+BENCHMARK(BM_ExecuteSmallPrograms)->Arg(1)->Arg(16)->Arg(256);
+
+// Dispatch rate of small programs, one ExecuteBatch() call for all programs.
+void BM_ExecuteBatchSmallPrograms(int iters, int num_programs) {
+  tensorflow::testing::StopTiming();
+  std::shared_ptr<PjRtClient> client =
+      GetCpuClient(/*asynchronous=*/true).ValueOrDie();
+  std::unique_ptr<PjRtExecutable> add_one = CompileUnary(client.get(), AddOne);
+  std::unique_ptr<PjRtBuffer> input = MakeInput(client.get(), {1, 2, 3, 4});
+  PjRtBuffer* args[] = {input.get()};
+  std::vector<PjRtExecutable::BatchedExecution> executions(
+      num_programs, {add_one.get(), args});
+  tensorflow::testing::ItemsProcessed(static_cast<int64>(iters) *
+                                      num_programs);
+  tensorflow::testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    auto results =
+        PjRtExecutable::ExecuteBatch(executions, ExecuteOptions()).ValueOrDie();
+    TF_CHECK_OK(results.back()[0]->BlockHostUntilReady());
+  }
+}
+BENCHMARK(BM_ExecuteBatchSmallPrograms)->Arg(1)->Arg(16)->Arg(256);
+
+}  // namespace
+}  // namespace xla
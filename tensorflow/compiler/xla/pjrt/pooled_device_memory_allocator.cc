@@ -0,0 +1,136 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/pooled_device_memory_allocator.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+
+PooledDeviceMemoryAllocator::PooledDeviceMemoryAllocator(
+    se::DeviceMemoryAllocator* wrapped, int64 max_pooled_bytes_per_device)
+    : se::DeviceMemoryAllocator(wrapped->platform()),
+      wrapped_(wrapped),
+      max_pooled_bytes_per_device_(max_pooled_bytes_per_device) {}
+
+PooledDeviceMemoryAllocator::PooledDeviceMemoryAllocator(
+    std::unique_ptr<se::DeviceMemoryAllocator> wrapped,
+    int64 max_pooled_bytes_per_device)
+    : se::DeviceMemoryAllocator(wrapped->platform()),
+      owned_wrapped_(std::move(wrapped)),
+      wrapped_(owned_wrapped_.get()),
+      max_pooled_bytes_per_device_(max_pooled_bytes_per_device) {}
+
+PooledDeviceMemoryAllocator::~PooledDeviceMemoryAllocator() {
+  absl::MutexLock lock(&mu_);
+  for (auto& device_and_pool : pools_) {
+    TF_CHECK_OK(ReleasePoolLocked(device_and_pool.first));
+  }
+}
+
+StatusOr<se::OwningDeviceMemory> PooledDeviceMemoryAllocator::Allocate(
+    int device_ordinal, uint64 size, bool retry_on_failure,
+    int64 memory_space) {
+  if (size == 0) {
+    return se::OwningDeviceMemory();
+  }
+  if (memory_space == 0) {
+    absl::MutexLock lock(&mu_);
+    DevicePool& pool = pools_[device_ordinal];
+    auto it = pool.buffers.find(size);
+    if (it != pool.buffers.end() && !it->second.empty()) {
+      se::DeviceMemoryBase buffer = it->second.back();
+      it->second.pop_back();
+      pool.bytes -= size;
+      return se::OwningDeviceMemory(buffer, device_ordinal, this);
+    }
+  }
+
+  StatusOr<se::OwningDeviceMemory> allocated = wrapped_->Allocate(
+      device_ordinal, size, retry_on_failure, memory_space);
+  if (!allocated.ok() &&
+      allocated.status().code() == tensorflow::error::RESOURCE_EXHAUSTED &&
+      pooled_bytes(device_ordinal) > 0) {
+    // The pooled buffers may be what the allocation is missing.
+    VLOG(1) << "Releasing the buffer pool of device " << device_ordinal
+            << " after failing to allocate " << size << " bytes";
+    TF_RETURN_IF_ERROR(ReleasePool(device_ordinal));
+    allocated = wrapped_->Allocate(device_ordinal, size, retry_on_failure,
+                                   memory_space);
+  }
+  TF_RETURN_IF_ERROR(allocated.status());
+  se::DeviceMemoryBase buffer = allocated.ValueOrDie().Release();
+  if (memory_space != 0) {
+    absl::MutexLock lock(&mu_);
+    unpooled_.insert(buffer.opaque());
+  }
+  return se::OwningDeviceMemory(buffer, device_ordinal, this);
+}
+
+Status PooledDeviceMemoryAllocator::Deallocate(int device_ordinal,
+                                               se::DeviceMemoryBase mem) {
+  if (mem.is_null()) {
+    return Status::OK();
+  }
+  absl::MutexLock lock(&mu_);
+  if (unpooled_.erase(mem.opaque()) > 0) {
+    return wrapped_->Deallocate(device_ordinal, mem);
+  }
+  DevicePool& pool = pools_[device_ordinal];
+  if (pool.bytes + static_cast<int64>(mem.size()) >
+      max_pooled_bytes_per_device_) {
+    return wrapped_->Deallocate(device_ordinal, mem);
+  }
+  pool.buffers[mem.size()].push_back(mem);
+  pool.bytes += mem.size();
+  return Status::OK();
+}
+
+int64 PooledDeviceMemoryAllocator::pooled_bytes(int device_ordinal) const {
+  absl::MutexLock lock(&mu_);
+  return pooled_bytes_locked(device_ordinal);
+}
+
+int64 PooledDeviceMemoryAllocator::pooled_bytes_locked(
+    int device_ordinal) const {
+  auto it = pools_.find(device_ordinal);
+  return it == pools_.end() ? 0 : it->second.bytes;
+}
+
+Status PooledDeviceMemoryAllocator::ReleasePool(int device_ordinal) {
+  absl::MutexLock lock(&mu_);
+  return ReleasePoolLocked(device_ordinal);
+}
+
+Status PooledDeviceMemoryAllocator::ReleasePoolLocked(int device_ordinal) {
+  auto it = pools_.find(device_ordinal);
+  if (it == pools_.end()) {
+    return Status::OK();
+  }
+  DevicePool& pool = it->second;
+  for (auto& size_and_buffers : pool.buffers) {
+    for (se::DeviceMemoryBase buffer : size_and_buffers.second) {
+      TF_RETURN_IF_ERROR(wrapped_->Deallocate(device_ordinal, buffer));
+    }
+  }
+  pool.buffers.clear();
+  pool.bytes = 0;
+  return Status::OK();
+}
+
+}  // namespace xla
@@ -0,0 +1,107 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_POOLED_DEVICE_MEMORY_ALLOCATOR_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_POOLED_DEVICE_MEMORY_ALLOCATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/stream_executor/device_memory_allocator.h"
+
+namespace xla {
+
+// Keeps the buffers freed through it in per-device pools, and hands them out
+// again to later allocations of the same size, instead of going back to the
+// wrapped allocator.
+//
+// Executing the same executable over and over allocates the same temporary and
+// output buffer sizes every time, and frees them once the execution, or the
+// consumer of the outputs, is done. With this allocator the executions that
+// follow the first ones are served from the pools, and don't touch the wrapped
+// allocator. Buffers donated to an execution and freed by it are pooled
+// alike.
+//
+// Reusing a pooled buffer is safe whenever reusing the same memory from the
+// wrapped allocator would be: it is only handed out after it was freed, in the
+// order of the Allocate and Deallocate calls.
+//
+// Only allocations in the default memory space are pooled.
+class PooledDeviceMemoryAllocator : public se::DeviceMemoryAllocator {
+ public:
+  // `max_pooled_bytes_per_device` bounds the bytes kept in the pool of each
+  // device; buffers freed beyond it go back to `wrapped`.
+  PooledDeviceMemoryAllocator(se::DeviceMemoryAllocator* wrapped,
+                              int64 max_pooled_bytes_per_device);
+  PooledDeviceMemoryAllocator(
+      std::unique_ptr<se::DeviceMemoryAllocator> wrapped,
+      int64 max_pooled_bytes_per_device);
+  ~PooledDeviceMemoryAllocator() override;
+
+  using se::DeviceMemoryAllocator::Allocate;
+  StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal, uint64 size,
+                                            bool retry_on_failure,
+                                            int64 memory_space) override;
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override;
+
+  bool AllowsAsynchronousDeallocation() const override {
+    return wrapped_->AllowsAsynchronousDeallocation();
+  }
+
+  StatusOr<se::Stream*> GetStream(int device_ordinal) override {
+    return wrapped_->GetStream(device_ordinal);
+  }
+
+  // Returns the bytes currently kept in the pool of `device_ordinal`.
+  int64 pooled_bytes(int device_ordinal) const;
+
+  // Returns the buffers of the pool of `device_ordinal` to the wrapped
+  // allocator.
+  Status ReleasePool(int device_ordinal);
+
+ private:
+  struct DevicePool {
+    // The pooled buffers, by size.
+    absl::flat_hash_map<uint64, std::vector<se::DeviceMemoryBase>> buffers;
+    int64 bytes = 0;
+  };
+
+  int64 pooled_bytes_locked(int device_ordinal) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status ReleasePoolLocked(int device_ordinal)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  std::unique_ptr<se::DeviceMemoryAllocator> owned_wrapped_;
+  se::DeviceMemoryAllocator* const wrapped_;
+  const int64 max_pooled_bytes_per_device_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<int, DevicePool> pools_ TF_GUARDED_BY(mu_);
+  // The live buffers allocated outside of the default memory space, which are
+  // not pooled when freed.
+  absl::flat_hash_set<const void*> unpooled_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_POOLED_DEVICE_MEMORY_ALLOCATOR_H_
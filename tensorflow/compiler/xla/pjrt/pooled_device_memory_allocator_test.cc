@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/pooled_device_memory_allocator.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/stream_executor/device_memory_allocator.h"
+
+namespace xla {
+namespace {
+
+class PooledDeviceMemoryAllocatorTest : public ::testing::Test {
+ protected:
+  PooledDeviceMemoryAllocatorTest() {
+    se::Platform* platform =
+        PlatformUtil::GetPlatform("Host").ConsumeValueOrDie();
+    se::StreamExecutor* executor =
+        platform->ExecutorForDevice(0).ConsumeValueOrDie();
+    wrapped_ = absl::make_unique<se::StreamExecutorMemoryAllocator>(executor);
+  }
+
+  std::unique_ptr<se::StreamExecutorMemoryAllocator> wrapped_;
+};
+
+TEST_F(PooledDeviceMemoryAllocatorTest, ReusesFreedBuffersOfTheSameSize) {
+  PooledDeviceMemoryAllocator allocator(wrapped_.get(),
+                                        /*max_pooled_bytes_per_device=*/1024);
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory first,
+                          allocator.Allocate(0, 256));
+  const void* first_opaque = first->opaque();
+  TF_ASSERT_OK(first.Free());
+  EXPECT_EQ(allocator.pooled_bytes(0), 256);
+
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory other_size,
+                          allocator.Allocate(0, 128));
+  EXPECT_NE(other_size->opaque(), first_opaque);
+  EXPECT_EQ(allocator.pooled_bytes(0), 256);
+
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory second,
+                          allocator.Allocate(0, 256));
+  EXPECT_EQ(second->opaque(), first_opaque);
+  EXPECT_EQ(second->size(), 256);
+  EXPECT_EQ(allocator.pooled_bytes(0), 0);
+}
+
+TEST_F(PooledDeviceMemoryAllocatorTest, PoolIsBounded) {
+  PooledDeviceMemoryAllocator allocator(wrapped_.get(),
+                                        /*max_pooled_bytes_per_device=*/300);
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory first,
+                          allocator.Allocate(0, 256));
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory second,
+                          allocator.Allocate(0, 256));
+  TF_ASSERT_OK(first.Free());
+  TF_ASSERT_OK(second.Free());
+  EXPECT_EQ(allocator.pooled_bytes(0), 256);
+
+  TF_ASSERT_OK(allocator.ReleasePool(0));
+  EXPECT_EQ(allocator.pooled_bytes(0), 0);
+}
+
+TEST_F(PooledDeviceMemoryAllocatorTest, EmptyAllocationsAreNull) {
+  PooledDeviceMemoryAllocator allocator(wrapped_.get(),
+                                        /*max_pooled_bytes_per_device=*/1024);
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory empty,
+                          allocator.Allocate(0, 0));
+  EXPECT_TRUE(empty.is_null());
+  TF_ASSERT_OK(empty.Free());
+  EXPECT_EQ(allocator.pooled_bytes(0), 0);
+}
+
+}  // namespace
+}  // namespace xla
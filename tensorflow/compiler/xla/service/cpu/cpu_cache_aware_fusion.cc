@@ -0,0 +1,164 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_cache_aware_fusion.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Whether every output element of 'consumer' reads at most the element of
+// 'producer' at the same index: in a fusion, only elementwise instructions
+// are on the paths from the fused parameters of 'producer' to the root.
+bool ReadsElementwise(const HloInstruction& consumer,
+                      const HloInstruction* producer) {
+  if (consumer.opcode() != HloOpcode::kFusion) {
+    return consumer.IsElementwise();
+  }
+  const HloInstruction* root = consumer.fused_expression_root();
+  std::vector<const HloInstruction*> worklist;
+  for (int64 i = 0; i < consumer.operand_count(); ++i) {
+    if (consumer.operand(i) == producer) {
+      worklist.push_back(consumer.fused_parameter(i));
+    }
+  }
+  while (!worklist.empty()) {
+    const HloInstruction* instr = worklist.back();
+    worklist.pop_back();
+    for (const HloInstruction* user : instr->users()) {
+      if (user == root && root->opcode() == HloOpcode::kTuple) {
+        continue;
+      }
+      if (!user->IsElementwise()) {
+        return false;
+      }
+      worklist.push_back(user);
+    }
+  }
+  return true;
+}
+
+int64 OutputCount(const HloInstruction& instr) {
+  return instr.IsMultiOutputFusion()
+             ? ShapeUtil::TupleElementCount(instr.shape())
+             : 1;
+}
+
+// Fuses 'producer' and its users, all loop fusible, into one multi-output
+// loop fusion whose outputs are the outputs of the users.
+Status FuseIntoUsers(HloComputation* computation, HloInstruction* producer) {
+  std::vector<HloInstruction*> users = producer->users();
+  HloInstruction* fusion = users[0];
+  if (fusion->opcode() != HloOpcode::kFusion) {
+    fusion = computation->AddInstruction(HloInstruction::CreateFusion(
+        users[0]->shape(), HloInstruction::FusionKind::kLoop, users[0]));
+    TF_RETURN_IF_ERROR(computation->ReplaceInstruction(users[0], fusion));
+  }
+  for (int64 i = 1; i < users.size(); ++i) {
+    HloInstruction* user = users[i];
+    if (user->opcode() == HloOpcode::kFusion) {
+      fusion->MergeFusionInstructionIntoMultiOutput(user);
+    } else {
+      fusion->FuseInstructionIntoMultiOutput(user);
+      TF_RETURN_IF_ERROR(computation->RemoveInstruction(user));
+    }
+  }
+  VLOG(2) << "Fusing " << producer->name() << " into " << fusion->name();
+  if (producer->opcode() == HloOpcode::kFusion) {
+    fusion->MergeFusionInstruction(producer);
+  } else {
+    fusion->FuseInstruction(producer);
+  }
+  return computation->RemoveInstruction(producer);
+}
+
+}  // namespace
+
+StatusOr<bool> CpuCacheAwareFusion::RunOnComputation(
+    HloComputation* computation) {
+  // Whether a candidate can be fused depends on the reachability between its
+  // users, which each fusion changes, so the analysis starts over after each
+  // fusion.
+  auto find_candidate = [&]() -> HloInstruction* {
+    std::unique_ptr<HloReachabilityMap> reachability =
+        HloReachabilityMap::Build(computation);
+    for (HloInstruction* producer : computation->MakeInstructionPostOrder()) {
+      if (producer->user_count() == 0 ||
+          producer == computation->root_instruction() ||
+          !producer->shape().IsArray() ||
+          !IsMultiOutputLoopFusible(*producer) ||
+          ShapeUtil::ByteSizeOf(producer->shape()) <= cache_size_in_bytes_) {
+        continue;
+      }
+      const std::vector<HloInstruction*>& users = producer->users();
+      int64 output_count = 0;
+      bool fusible = true;
+      for (const HloInstruction* user : users) {
+        output_count += OutputCount(*user);
+        if (!IsMultiOutputLoopFusible(*user) ||
+            !ShapeUtil::EqualIgnoringElementType(GetLoopShape(*user),
+                                                 producer->shape()) ||
+            !ReadsElementwise(*user, producer)) {
+          fusible = false;
+          break;
+        }
+      }
+      if (!fusible || output_count > kMaxMultiOutputLoopFusionOutputs) {
+        continue;
+      }
+      // Fusing two users where one reaches the other would create a cycle.
+      for (int64 i = 0; fusible && i < users.size(); ++i) {
+        for (int64 j = i + 1; fusible && j < users.size(); ++j) {
+          fusible = !reachability->IsConnected(users[i], users[j]);
+        }
+      }
+      if (fusible) {
+        return producer;
+      }
+    }
+    return nullptr;
+  };
+
+  bool changed = false;
+  while (HloInstruction* producer = find_candidate()) {
+    TF_RETURN_IF_ERROR(FuseIntoUsers(computation, producer));
+    changed = true;
+  }
+  return changed;
+}
+
+StatusOr<bool> CpuCacheAwareFusion::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed,
+                        RunOnComputation(computation));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,60 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_CACHE_AWARE_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_CACHE_AWARE_FUSION_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// Fuses a loop whose output doesn't fit in the L2 cache into the loops that
+// consume it, so that the intermediate is consumed in the loop iteration that
+// produces it instead of being written to memory in full and read back by
+// every consumer.
+//
+// CpuInstructionFusion doesn't fuse an expensive producer, like an exp or a
+// tanh, into several consumers, because each consumer would recompute it.
+// This pass fuses the producer and all of its consumers into one multi-output
+// loop fusion instead, where each producer element is computed once. This only
+// applies when every consumer reads the producer elementwise, with the same
+// loop shape, so that all of them read the element computed in the current
+// iteration. Intermediates that fit in the cache are left alone, since the
+// consumers then read them from the cache anyway.
+class CpuCacheAwareFusion : public HloModulePass {
+ public:
+  // 'cache_size_in_bytes': the size of the cache the intermediates should not
+  // overflow, typically the L2 cache.
+  explicit CpuCacheAwareFusion(int64 cache_size_in_bytes)
+      : cache_size_in_bytes_(cache_size_in_bytes) {}
+
+  absl::string_view name() const override { return "cpu-cache-aware-fusion"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  StatusOr<bool> RunOnComputation(HloComputation* computation);
+
+  const int64 cache_size_in_bytes_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_CACHE_AWARE_FUSION_H_
@@ -0,0 +1,134 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_cache_aware_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+constexpr int64 kCacheSizeInBytes = 256 * 1024;
+
+using CpuCacheAwareFusionTest = HloTestBase;
+
+TEST_F(CpuCacheAwareFusionTest, LargeIntermediateIsFusedIntoConsumers) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+fused_scale {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  c = f32[] constant(2)
+  b = f32[1024,1024]{1,0} broadcast(c), dimensions={}
+  ROOT mul = f32[1024,1024]{1,0} multiply(p0, b)
+}
+
+fused_derivative {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  one = f32[] constant(1)
+  b = f32[1024,1024]{1,0} broadcast(one), dimensions={}
+  square = f32[1024,1024]{1,0} multiply(p0, p0)
+  ROOT sub = f32[1024,1024]{1,0} subtract(b, square)
+}
+
+ENTRY e {
+  p = f32[1024,1024]{1,0} parameter(0)
+  tanh = f32[1024,1024]{1,0} tanh(p)
+  scale = f32[1024,1024]{1,0} fusion(tanh), kind=kLoop, calls=fused_scale
+  derivative = f32[1024,1024]{1,0} fusion(tanh), kind=kLoop,
+      calls=fused_derivative
+  ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0})
+      tuple(scale, derivative)
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(
+      CpuCacheAwareFusion(kCacheSizeInBytes).Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_THAT(fusion, op::Fusion(op::Parameter(0)));
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_EQ(fusion->fused_expression_root()->operand_count(), 2);
+}
+
+TEST_F(CpuCacheAwareFusionTest, SmallIntermediateIsNotFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p = f32[1024]{0} parameter(0)
+  exp = f32[1024]{0} exponential(p)
+  neg = f32[1024]{0} negate(exp)
+  log = f32[1024]{0} log(exp)
+  ROOT tuple = (f32[1024]{0}, f32[1024]{0}) tuple(neg, log)
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(
+      CpuCacheAwareFusion(kCacheSizeInBytes).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(CpuCacheAwareFusionTest, TransposingConsumerIsNotFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+fused_transpose {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  t = f32[1024,1024]{1,0} transpose(p0), dimensions={1,0}
+  ROOT neg = f32[1024,1024]{1,0} negate(t)
+}
+
+ENTRY e {
+  p = f32[1024,1024]{1,0} parameter(0)
+  exp = f32[1024,1024]{1,0} exponential(p)
+  transpose = f32[1024,1024]{1,0} fusion(exp), kind=kLoop,
+      calls=fused_transpose
+  log = f32[1024,1024]{1,0} log(exp)
+  ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0})
+      tuple(transpose, log)
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(
+      CpuCacheAwareFusion(kCacheSizeInBytes).Run(module.get()).ValueOrDie());
+}
+
+// The two users of exp can't be fused together directly, since one reaches the
+// other, but fusing neg into add first makes add the only user of exp.
+TEST_F(CpuCacheAwareFusionTest, DependentConsumersAreFusedInOrder) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p = f32[1024,1024]{1,0} parameter(0)
+  exp = f32[1024,1024]{1,0} exponential(p)
+  neg = f32[1024,1024]{1,0} negate(exp)
+  ROOT add = f32[1024,1024]{1,0} add(exp, neg)
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(
+      CpuCacheAwareFusion(kCacheSizeInBytes).Run(module.get()).ValueOrDie());
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              op::Fusion(op::Parameter(0)));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -68,13 +68,17 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/buffer_info_util.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/service/cpu/conv_canonicalization.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_cache_aware_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_horizontal_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_layout_assignment.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_options.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/parallel_reduction_splitter.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
@@ -364,6 +368,14 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
       LayoutAssignment::InstructionCanChangeLayout, target_machine_features);
 
   pipeline.AddPass<CpuInstructionFusion>();
+  // Fuse the loops left after instruction fusion into multi-output loops,
+  // which share one parallel task partition.
+  pipeline.AddPass<CpuMultiOutputFusion>();
+  // Fuse producers whose outputs don't fit in the L2 cache into their
+  // consumers, so that the intermediates are not materialized.
+  pipeline.AddPass<CpuCacheAwareFusion>(
+      target_machine_features->l2_cache_size_in_bytes());
+  pipeline.AddPass<CpuHorizontalFusion>();
 
   return pipeline.Run(module).status();
 }
@@ -409,6 +421,7 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // and thread synchronization dependencies which would likely increase
     // binary size (and most AOT applications are single-threaded).
     // TODO(b/29630486) Support multi-threaded AOT.
+    pipeline.AddPass<ParallelReductionSplitter>(max_parallelism);
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
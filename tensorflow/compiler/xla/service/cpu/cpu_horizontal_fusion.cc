@@ -0,0 +1,134 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_horizontal_fusion.h"
+
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Returns the operands of 'consumer' that can be fused horizontally, in
+// operand order.
+std::vector<HloInstruction*> GetFusionCandidates(HloInstruction* consumer) {
+  std::vector<HloInstruction*> candidates;
+  absl::flat_hash_set<HloInstruction*> seen;
+  for (HloInstruction* operand : consumer->operands()) {
+    if (!seen.insert(operand).second) {
+      continue;
+    }
+    if (operand->user_count() != 1 || !IsMultiOutputLoopFusible(*operand)) {
+      continue;
+    }
+    candidates.push_back(operand);
+  }
+  return candidates;
+}
+
+// Splits 'candidates' into groups that can be emitted in one loop nest.
+std::vector<std::vector<HloInstruction*>> GroupByLoopShape(
+    const std::vector<HloInstruction*>& candidates) {
+  std::vector<std::vector<HloInstruction*>> groups;
+  std::vector<int64> group_output_counts;
+  for (HloInstruction* candidate : candidates) {
+    const int64 output_count =
+        candidate->IsMultiOutputFusion()
+            ? ShapeUtil::TupleElementCount(candidate->shape())
+            : 1;
+    bool grouped = false;
+    for (int64 i = 0; i < groups.size(); ++i) {
+      if (ShapeUtil::EqualIgnoringElementType(GetLoopShape(*groups[i][0]),
+                                              GetLoopShape(*candidate)) &&
+          group_output_counts[i] + output_count <=
+              kMaxMultiOutputLoopFusionOutputs) {
+        groups[i].push_back(candidate);
+        group_output_counts[i] += output_count;
+        grouped = true;
+        break;
+      }
+    }
+    if (!grouped) {
+      groups.push_back({candidate});
+      group_output_counts.push_back(output_count);
+    }
+  }
+  return groups;
+}
+
+// Fuses 'group' into one multi-output loop fusion.
+Status FuseGroup(HloComputation* computation,
+                 const std::vector<HloInstruction*>& group) {
+  HloInstruction* fusion = group[0];
+  if (fusion->opcode() != HloOpcode::kFusion) {
+    fusion = computation->AddInstruction(HloInstruction::CreateFusion(
+        group[0]->shape(), HloInstruction::FusionKind::kLoop, group[0]));
+    TF_RETURN_IF_ERROR(computation->ReplaceInstruction(group[0], fusion));
+  }
+  for (int64 i = 1; i < group.size(); ++i) {
+    HloInstruction* instr = group[i];
+    VLOG(2) << "Horizontally fusing " << instr->name() << " into "
+            << fusion->name();
+    if (instr->opcode() == HloOpcode::kFusion) {
+      fusion->MergeFusionInstructionIntoMultiOutput(instr);
+    } else {
+      fusion->FuseInstructionIntoMultiOutput(instr);
+      TF_RETURN_IF_ERROR(computation->RemoveInstruction(instr));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<bool> CpuHorizontalFusion::RunOnComputation(
+    HloComputation* computation) {
+  bool changed = false;
+  // The candidates of a consumer come before it in post order, and are only
+  // used by it, so the instructions fused away are never visited again.
+  for (HloInstruction* consumer : computation->MakeInstructionPostOrder()) {
+    for (const std::vector<HloInstruction*>& group :
+         GroupByLoopShape(GetFusionCandidates(consumer))) {
+      if (group.size() < 2) {
+        continue;
+      }
+      TF_RETURN_IF_ERROR(FuseGroup(computation, group));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+StatusOr<bool> CpuHorizontalFusion::Run(HloModule* module) {
+  bool changed = false;
+  VLOG(2) << "Run horizontal fusion.";
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed,
+                        RunOnComputation(computation));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,54 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_HORIZONTAL_FUSION_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// Fuses independent loops into multi-output loop fusions, so that they run as
+// one loop nest and share one parallel task partition, instead of each paying
+// the fork/join overhead of ParallelForkJoin. This targets the many small
+// elementwise updates of training optimizers, which CpuMultiOutputFusion
+// doesn't fuse because they read different variables.
+//
+// Like the GPU horizontal fusion, the candidates are the operands of one
+// consumer whose only user is that consumer, typically the root tuple of the
+// entry computation. No candidate can then reach another one, so fusing them
+// can't create cycles. Unlike on GPU, the fused loops share their loop nest
+// rather than being concatenated, so only candidates with the same loop shape
+// (up to element type) are fused together.
+class CpuHorizontalFusion : public HloModulePass {
+ public:
+  CpuHorizontalFusion() = default;
+
+  absl::string_view name() const override { return "cpu-horizontal-fusion"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  StatusOr<bool> RunOnComputation(HloComputation* computation);
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_HORIZONTAL_FUSION_H_
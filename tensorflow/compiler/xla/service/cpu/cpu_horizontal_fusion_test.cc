@@ -0,0 +1,83 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_horizontal_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+using CpuHorizontalFusionTest = HloTestBase;
+
+TEST_F(CpuHorizontalFusionTest, IndependentLoopsAreFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+fused_update {
+  p0 = f32[1024]{0} parameter(0)
+  p1 = f32[1024]{0} parameter(1)
+  mul = f32[1024]{0} multiply(p0, p1)
+  ROOT sub = f32[1024]{0} subtract(p0, mul)
+}
+
+ENTRY e {
+  var0 = f32[1024]{0} parameter(0)
+  grad0 = f32[1024]{0} parameter(1)
+  var1 = f32[1024]{0} parameter(2)
+  grad1 = f32[1024]{0} parameter(3)
+  var2 = s32[1024]{0} parameter(4)
+  update0 = f32[1024]{0} fusion(var0, grad0), kind=kLoop, calls=fused_update
+  update1 = f32[1024]{0} fusion(var1, grad1), kind=kLoop, calls=fused_update
+  update2 = s32[1024]{0} negate(var2)
+  ROOT tuple = (f32[1024]{0}, f32[1024]{0}, s32[1024]{0})
+      tuple(update0, update1, update2)
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(CpuHorizontalFusion().Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_EQ(fusion, root->operand(2)->operand(0));
+}
+
+TEST_F(CpuHorizontalFusionTest, LoopsWithOtherUsersAreNotFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024]{0} parameter(0)
+  p1 = f32[1024]{0} parameter(1)
+  neg = f32[1024]{0} negate(p0)
+  exp = f32[1024]{0} exponential(p1)
+  add = f32[1024]{0} add(neg, exp)
+  ROOT tuple = (f32[1024]{0}, f32[1024]{0}) tuple(neg, add)
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(CpuHorizontalFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
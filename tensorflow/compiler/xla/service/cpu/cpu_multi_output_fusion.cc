@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+int64 OutputCount(const HloInstruction& instr) {
+  return instr.IsMultiOutputFusion()
+             ? ShapeUtil::TupleElementCount(instr.shape())
+             : 1;
+}
+
+}  // namespace
+
+bool IsMultiOutputLoopFusible(const HloInstruction& instr) {
+  if (instr.opcode() == HloOpcode::kFusion) {
+    if (!instr.IsLoopFusion()) {
+      return false;
+    }
+    // In-place dynamic-update-slices are emitted in a loop over the update
+    // rather than over the output.
+    if (instr.fused_expression_root()->opcode() ==
+        HloOpcode::kDynamicUpdateSlice) {
+      return false;
+    }
+    // Loop fusions with a non-tuple root, e.g. a variadic reduce, produce a
+    // tuple in one loop nest and can't be split into outputs.
+    return instr.IsMultiOutputFusion() || instr.shape().IsArray();
+  }
+  return instr.IsElementwise() && instr.shape().IsArray() &&
+         instr.shape().rank() > 0;
+}
+
+const Shape& GetLoopShape(const HloInstruction& instr) {
+  return instr.IsMultiOutputFusion() ? instr.shape().tuple_shapes(0)
+                                     : instr.shape();
+}
+
+bool LoopShapesCompatibleForMultiOutputFusion(const HloInstruction& instr1,
+                                              const HloInstruction& instr2) {
+  // The loop emitter writes every output with the index of the first one, so
+  // the outputs need the same dimensions and layout.
+  if (!ShapeUtil::EqualIgnoringElementType(GetLoopShape(instr1),
+                                           GetLoopShape(instr2))) {
+    return false;
+  }
+  return OutputCount(instr1) + OutputCount(instr2) <=
+         kMaxMultiOutputLoopFusionOutputs;
+}
+
+bool CpuMultiOutputFusion::ShapesCompatibleForFusion(HloInstruction* instr1,
+                                                     HloInstruction* instr2) {
+  return LoopShapesCompatibleForMultiOutputFusion(*instr1, *instr2);
+}
+
+bool CpuMultiOutputFusion::IsFusible(HloInstruction* instr) {
+  return IsMultiOutputLoopFusible(*instr);
+}
+
+int64 CpuMultiOutputFusion::GetProfit(HloInstruction* instr1,
+                                      HloInstruction* instr2) {
+  absl::flat_hash_set<HloInstruction*> instr1_operands(
+      instr1->operands().begin(), instr1->operands().end());
+  absl::flat_hash_set<HloInstruction*> counted_operands;
+  int64 profit = 0;
+  for (HloInstruction* operand : instr2->operands()) {
+    if (instr1_operands.contains(operand) && IsProfitableOperand(operand) &&
+        counted_operands.insert(operand).second) {
+      profit += ShapeUtil::ByteSizeOf(operand->shape(), sizeof(void*));
+    }
+  }
+  return CeilOfRatio<int64>(profit, 1024);
+}
+
+bool CpuMultiOutputFusion::LegalToFuse(HloInstruction* instr1,
+                                       HloInstruction* instr2) {
+  // Unlike the default, this also fuses unfused siblings: Fuse() wraps them in
+  // a new loop fusion.
+  return LegalToFuseMainConstraints(instr1, instr2);
+}
+
+HloInstruction* CpuMultiOutputFusion::Fuse(HloInstruction* instr1,
+                                           HloInstruction* instr2) {
+  if (instr1->opcode() != HloOpcode::kFusion &&
+      instr2->opcode() != HloOpcode::kFusion) {
+    instr1 = CreateFusion(instr1, instr2);
+  }
+  return MultiOutputFusion::Fuse(instr1, instr2);
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,77 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/multi_output_fusion.h"
+#include "tensorflow/compiler/xla/shape.h"
+
+namespace xla {
+namespace cpu {
+
+// The maximum number of outputs of the multi-output loop fusions created by
+// the CPU backend. More outputs make the fused loop body grow past what the
+// LLVM optimizer handles well.
+constexpr int64 kMaxMultiOutputLoopFusionOutputs = 16;
+
+// Whether 'instr' can be an output of a multi-output loop fusion: it is either
+// a loop fusion, or an unfused elementwise instruction. Fusions that may be
+// emitted in place (dynamic-update-slice) or that contain ops the CPU backend
+// doesn't emit in loop fusions are excluded.
+bool IsMultiOutputLoopFusible(const HloInstruction& instr);
+
+// Returns the shape of the loop nest emitted for 'instr', that is its shape,
+// or the shape of its first output if it is a multi-output fusion.
+const Shape& GetLoopShape(const HloInstruction& instr);
+
+// Whether 'instr1' and 'instr2' can be emitted in one loop nest: their loop
+// shapes are equal up to element type, and fusing them keeps the number of
+// outputs under kMaxMultiOutputLoopFusionOutputs.
+bool LoopShapesCompatibleForMultiOutputFusion(const HloInstruction& instr1,
+                                              const HloInstruction& instr2);
+
+// Fuses sibling loop fusions and elementwise instructions that read a common
+// operand into multi-output loop fusions. The fused loop reads the operand
+// once instead of once per sibling, and the siblings share one parallel task
+// partition instead of each paying the fork/join overhead of
+// ParallelForkJoin.
+class CpuMultiOutputFusion : public MultiOutputFusion {
+ public:
+  CpuMultiOutputFusion() = default;
+
+  absl::string_view name() const override { return "cpu-multi-output-fusion"; }
+
+ protected:
+  bool ShapesCompatibleForFusion(HloInstruction* instr1,
+                                 HloInstruction* instr2) override;
+
+  bool IsFusible(HloInstruction* instr) override;
+
+  // Returns the size in KiB of the operands shared by 'instr1' and 'instr2',
+  // rounded up.
+  int64 GetProfit(HloInstruction* instr1, HloInstruction* instr2) override;
+
+  bool LegalToFuse(HloInstruction* instr1, HloInstruction* instr2) override;
+
+  HloInstruction* Fuse(HloInstruction* instr1, HloInstruction* instr2) override;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
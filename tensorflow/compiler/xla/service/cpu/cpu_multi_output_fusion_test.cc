@@ -0,0 +1,106 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+using CpuMultiOutputFusionTest = HloTestBase;
+
+TEST_F(CpuMultiOutputFusionTest, SiblingLoopFusionsAreFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+fused_add {
+  p0 = f32[128,64]{1,0} parameter(0)
+  p1 = f32[128,64]{1,0} parameter(1)
+  add = f32[128,64]{1,0} add(p0, p1)
+  ROOT exp = f32[128,64]{1,0} exponential(add)
+}
+
+fused_mul {
+  p0 = f32[128,64]{1,0} parameter(0)
+  p1 = f32[128,64]{1,0} parameter(1)
+  mul = f32[128,64]{1,0} multiply(p0, p1)
+  ROOT log = f32[128,64]{1,0} log(mul)
+}
+
+ENTRY e {
+  p0 = f32[128,64]{1,0} parameter(0)
+  p1 = f32[128,64]{1,0} parameter(1)
+  p2 = f32[128,64]{1,0} parameter(2)
+  f0 = f32[128,64]{1,0} fusion(p0, p1), kind=kLoop, calls=fused_add
+  f1 = f32[128,64]{1,0} fusion(p0, p2), kind=kLoop, calls=fused_mul
+  ROOT tuple = (f32[128,64]{1,0}, f32[128,64]{1,0}) tuple(f0, f1)
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(CpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_TRUE(fusion->IsLoopFusion());
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+}
+
+TEST_F(CpuMultiOutputFusionTest, UnfusedElementwiseSiblingsAreFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[128,64]{1,0} parameter(0)
+  p1 = f32[128,64]{1,0} parameter(1)
+  add = f32[128,64]{1,0} add(p0, p1)
+  sub = f32[128,64]{1,0} subtract(p0, p1)
+  ROOT tuple = (f32[128,64]{1,0}, f32[128,64]{1,0}) tuple(add, sub)
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(CpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  EXPECT_TRUE(root->operand(0)->operand(0)->IsMultiOutputFusion());
+}
+
+TEST_F(CpuMultiOutputFusionTest, DifferentLoopShapesAreNotFused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[128,64]{1,0} parameter(0)
+  p1 = f32[128,64]{1,0} parameter(1)
+  add = f32[128,64]{1,0} add(p0, p1)
+  transpose = f32[64,128]{1,0} transpose(p0), dimensions={1,0}
+  neg = f32[64,128]{1,0} negate(transpose)
+  sub = f32[128,64]{0,1} subtract(p0, p1)
+  ROOT tuple = (f32[128,64]{1,0}, f32[64,128]{1,0}, f32[128,64]{0,1})
+      tuple(add, neg, sub)
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(CpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
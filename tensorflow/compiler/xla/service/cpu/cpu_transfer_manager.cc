@@ -149,6 +149,24 @@ Status CpuTransferManager::TransferBufferToInfeed(se::StreamExecutor* executor,
   return Status::OK();
 }
 
+StatusOr<TransferManager::XfeedQueueStats>
+CpuTransferManager::GetXfeedQueueStats(se::StreamExecutor* executor) {
+  cpu::runtime::XfeedManager* xfeed_manager =
+      cpu::runtime::GetXfeedManager(executor->device_ordinal());
+  const cpu::runtime::XfeedQueueManager::Stats infeed_stats =
+      xfeed_manager->infeed()->GetStats();
+  const cpu::runtime::XfeedQueueManager::Stats outfeed_stats =
+      xfeed_manager->outfeed()->GetStats();
+  XfeedQueueStats stats;
+  stats.infeed_queue_depth = infeed_stats.depth;
+  stats.infeed_dequeue_count = infeed_stats.dequeue_count;
+  stats.infeed_wait_micros = infeed_stats.wait_micros;
+  stats.outfeed_queue_depth = outfeed_stats.depth;
+  stats.outfeed_dequeue_count = outfeed_stats.dequeue_count;
+  stats.outfeed_wait_micros = outfeed_stats.wait_micros;
+  return stats;
+}
+
 StatusOr<cpu::runtime::XfeedBuffer*>
 CpuTransferManager::TransferBufferToInfeedInternal(se::StreamExecutor* executor,
                                                    int64 size,
@@ -44,6 +44,8 @@ class CpuTransferManager : public GenericTransferManager {
   Status TransferLiteralFromOutfeed(se::StreamExecutor* executor,
                                     const Shape& literal_shape,
                                     MutableBorrowingLiteral literal) override;
+  StatusOr<XfeedQueueStats> GetXfeedQueueStats(
+      se::StreamExecutor* executor) override;
 
   bool CanShapedBufferBeAccessedNow(
       se::StreamExecutor* executor,
@@ -1806,10 +1806,41 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type()));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
+    // The reduced elements of each output element are contiguous iff the
+    // reduced dimensions are the most minor ones.
+    int64 reduced_element_count = 1;
+    for (int64 i = 0; i < dimensions.size(); ++i) {
+      int64 dimension = LayoutUtil::Minor(arg->shape().layout(), i);
+      if (!absl::c_linear_search(dimensions, dimension)) {
+        *failure_reason =
+            "reduction over minor and non-contiguous dimensions not "
+            "implemented";
+        return false;
+      }
+      reduced_element_count *= arg->shape().dimensions(dimension);
+    }
+    if (reduced_element_count < vectorization_factor) {
+      *failure_reason = "too few reduced elements to vectorize";
+      return false;
+    }
+    TF_RETURN_IF_ERROR(EmitVectorizedReduceOverMinorDimensions(
+        reduce, arg, init_value, reduction_generator, reduced_element_count,
+        vectorization_factor, element_alignment));
+    return true;
+  }
+
+  // The outer loops of the loop nest below iterate over the most major output
+  // dimensions, so they can be partitioned, except for the innermost one.
+  const int64 num_partitioned_dimensions =
+      ShouldEmitParallelLoopFor(*reduce) ? num_dynamic_loop_bounds_ : 0;
+  if (num_partitioned_dimensions >= reduce->shape().dimensions_size()) {
+    *failure_reason = "partitioned innermost output dimension not implemented";
     return false;
   }
+  std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds;
+  if (num_partitioned_dimensions > 0) {
+    dynamic_loop_bounds = compute_function_->GetDynamicLoopBounds();
+  }
 
   CHECK(!reduce->shape().IsTuple());
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(reduce));
@@ -1840,10 +1871,19 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   for (int i = LayoutUtil::MinorToMajor(reduce->shape()).size() - 1; i > 0;
        --i) {
     int64 dimension = LayoutUtil::Minor(reduce->shape().layout(), i);
-    int64 start_index = 0;
-    int64 end_index = reduce->shape().dimensions(dimension);
-    std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
-        start_index, end_index, absl::StrFormat("dim.%d", dimension));
+    const int bounds_index = reduce->shape().dimensions_size() - 1 - i;
+    std::unique_ptr<llvm_ir::ForLoop> loop;
+    if (bounds_index < num_partitioned_dimensions) {
+      // Only iterate over the partition of the parallel task.
+      loop = loop_nest.AddLoop(absl::StrFormat("dim.%d", dimension),
+                               dynamic_loop_bounds[bounds_index].first,
+                               dynamic_loop_bounds[bounds_index].second);
+    } else {
+      int64 start_index = 0;
+      int64 end_index = reduce->shape().dimensions(dimension);
+      loop = loop_nest.AddLoop(start_index, end_index,
+                               absl::StrFormat("dim.%d", dimension));
+    }
     array_multi_index[dimension] = loop->GetIndVarValue();
   }
 
@@ -1926,6 +1966,132 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   return true;
 }
 
+Status IrEmitter::EmitVectorizedReduceOverMinorDimensions(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    const ReductionGenerator& reduction_generator, int64 reduced_element_count,
+    int vectorization_factor, unsigned element_alignment) {
+  // We lower the reduction of every output element as:
+  //
+  //  1. N is the number of reduced elements, which are contiguous.
+  //  2. VS is the vectorization stride.
+  //
+  //  vector_acc = input[0:VS]
+  //  for (i in [VS, N - N % VS) with stride VS) {
+  //    vector_acc = elementwise_reduce(vector_acc, input[i:i+VS])
+  //  }
+  //  acc = reduce(init, horizontal_reduce(vector_acc))
+  //  for (i in [N - N % VS, N)) {
+  //    acc = reduce(acc, input[i])
+  //  }
+  //
+  // This reassociates the reduction, like TreeReductionRewriter does.
+  const PrimitiveType element_type = reduce->shape().element_type();
+  llvm::Type* element_ir_type =
+      llvm_ir::PrimitiveTypeToIrType(element_type, module_);
+  ShardedVectorType vector_type =
+      CreateShardedVectorType(element_type, vectorization_factor);
+  for (llvm::Type* shard_type : vector_type) {
+    // vectorization_factor is a power of two, so all the shards are full
+    // vectors of the same size.
+    TF_RET_CHECK(shard_type == vector_type.front());
+  }
+  const int64 shard_element_count =
+      llvm::cast<llvm::VectorType>(vector_type.front())->getNumElements();
+  const int64 vectorized_element_count =
+      reduced_element_count - reduced_element_count % vectorization_factor;
+
+  llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+  llvm::Value* arg_base =
+      BitCast(arg_array.GetBasePointer(), element_ir_type->getPointerTo());
+
+  // Loads the vector of "vectorization_factor" elements at "offset".
+  auto load_vector = [&](llvm::Value* offset) {
+    ShardedVector vector;
+    for (int64 i = 0; i < vector_type.size(); ++i) {
+      llvm::Value* shard_offset =
+          Add(offset, b_.getInt64(i * shard_element_count));
+      llvm::Value* address =
+          BitCast(InBoundsGEP(arg_base, {shard_offset}),
+                  vector_type[i]->getPointerTo());
+      llvm::LoadInst* shard = AlignedLoad(address, element_alignment);
+      arg_array.AnnotateLoadStoreInstructionWithMetadata(shard);
+      vector.push_back(shard);
+    }
+    return vector;
+  };
+
+  auto element_generator = [&](const llvm_ir::IrArray::Index& output_index)
+      -> StatusOr<llvm::Value*> {
+    // The unreduced dimensions are the most major ones of the operand and
+    // keep their order, so the reduced elements of the output element with
+    // linear index L start at L * N.
+    llvm::Value* output_linear_index = b_.getInt64(0);
+    int64 stride = 1;
+    for (int64 dimension : LayoutUtil::MinorToMajor(reduce->shape())) {
+      output_linear_index = Add(
+          output_linear_index,
+          Mul(SExtOrTrunc(output_index[dimension], b_.getInt64Ty()),
+              b_.getInt64(stride)));
+      stride *= reduce->shape().dimensions(dimension);
+    }
+    llvm::Value* begin =
+        Mul(output_linear_index, b_.getInt64(reduced_element_count));
+
+    ShardedVector vector_accumulator;
+    ShardedVector first_vector = load_vector(begin);
+    for (llvm::Value* shard : first_vector) {
+      llvm::Value* shard_accumulator = llvm_ir::EmitAllocaAtFunctionEntry(
+          shard->getType(), "vector_accumulator", &b_);
+      Store(shard, shard_accumulator);
+      vector_accumulator.push_back(shard_accumulator);
+    }
+    if (vectorized_element_count > vectorization_factor) {
+      llvm_ir::ForLoopNest loop_nest(IrName(reduce, "vectorized"), &b_);
+      std::unique_ptr<llvm_ir::ForLoop> loop =
+          loop_nest.AddLoop(vectorization_factor, vectorized_element_count,
+                            vectorization_factor, "reduced");
+      SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+      ShardedVector vector =
+          load_vector(Add(begin, loop->GetIndVarValue()));
+      for (int64 i = 0; i < vector.size(); ++i) {
+        Store(reduction_generator(&b_, Load(vector_accumulator[i]), vector[i]),
+              vector_accumulator[i]);
+      }
+      SetToFirstInsertPoint(loop_nest.GetOuterLoopExitBasicBlock(), &b_);
+    }
+
+    // Reduce the shards into one vector, and then its elements into the
+    // scalar accumulator.
+    llvm::Value* vector_result = Load(vector_accumulator[0]);
+    for (int64 i = 1; i < vector_accumulator.size(); ++i) {
+      vector_result = reduction_generator(&b_, vector_result,
+                                          Load(vector_accumulator[i]));
+    }
+    llvm::Value* accumulator = llvm_ir::EmitAllocaAtFunctionEntry(
+        element_ir_type, "accumulator", &b_);
+    llvm::Value* result = Load(GetEmittedValueFor(init_value));
+    for (int64 i = 0; i < shard_element_count; ++i) {
+      result = reduction_generator(
+          &b_, result, b_.CreateExtractElement(vector_result, i));
+    }
+    Store(result, accumulator);
+
+    if (vectorized_element_count < reduced_element_count) {
+      llvm_ir::ForLoopNest loop_nest(IrName(reduce, "epilogue"), &b_);
+      std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
+          vectorized_element_count, reduced_element_count, "reduced");
+      SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+      llvm::LoadInst* element = Load(
+          InBoundsGEP(arg_base, {Add(begin, loop->GetIndVarValue())}));
+      arg_array.AnnotateLoadStoreInstructionWithMetadata(element);
+      Store(reduction_generator(&b_, Load(accumulator), element), accumulator);
+      SetToFirstInsertPoint(loop_nest.GetOuterLoopExitBasicBlock(), &b_);
+    }
+    return Load(accumulator);
+  };
+  return EmitTargetElementLoop(reduce, element_generator);
+}
+
 Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto arg = reduce->mutable_operand(0);
   auto init_value = reduce->mutable_operand(1);
@@ -2265,8 +2431,12 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
         /*profile_counters_arg=*/GetProfileCountersArgument());
 
     HloInstruction* root = computation->root_instruction();
+    // The outputs of a multi-output fusion are partitioned like its first
+    // output.
+    const Shape& partitioned_shape =
+        root->shape().IsTuple() ? root->shape().tuple_shapes(0) : root->shape();
     TF_RETURN_IF_ERROR(EmitCallToParallelForkJoin(
-        call_args, root->shape(), root->outer_dimension_partitions(), &b_,
+        call_args, partitioned_shape, root->outer_dimension_partitions(), &b_,
         call_ir_function, computation->name()));
   } else {
     EmitGlobalCall(*computation, computation->name());
@@ -3272,7 +3442,8 @@ Status IrEmitter::EmitTargetElementLoop(
   if (target_shape.IsTuple() && (target_op->opcode() == HloOpcode::kFusion ||
                                  target_op->opcode() == HloOpcode::kReduce)) {
     // For multiple outputs fusion, we need to emit each operand and the root.
-    TF_RET_CHECK(num_dynamic_loop_bounds_ == 0);
+    TF_RET_CHECK(num_dynamic_loop_bounds_ == 0 ||
+                 ShouldEmitParallelLoopFor(*target_op));
     std::vector<llvm_ir::IrArray> output_arrays;
     for (int64 i = 0; i < ShapeUtil::TupleElementCount(target_shape); ++i) {
       TF_ASSIGN_OR_RETURN(BufferAllocation::Slice slice,
@@ -3282,9 +3453,18 @@ Status IrEmitter::EmitTargetElementLoop(
       output_arrays.push_back(
           llvm_ir::IrArray(op_target_address, element_shape));
     }
-    TF_RETURN_IF_ERROR(
-        llvm_ir::LoopEmitter(element_generator, output_arrays, &b_)
-            .EmitLoop(IrName(target_op)));
+    if (ShouldEmitParallelLoopFor(*target_op)) {
+      // All the outputs share the loop nest, so they share its partitioning.
+      std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds =
+          compute_function_->GetDynamicLoopBounds();
+      TF_RETURN_IF_ERROR(ParallelLoopEmitter(element_generator, output_arrays,
+                                             &dynamic_loop_bounds, &b_)
+                             .EmitLoop(IrName(target_op)));
+    } else {
+      TF_RETURN_IF_ERROR(
+          llvm_ir::LoopEmitter(element_generator, output_arrays, &b_)
+              .EmitLoop(IrName(target_op)));
+    }
 
     std::vector<llvm::Value*> tuple_operand_ptrs;
     for (int64 i = 0; i < output_arrays.size(); ++i) {
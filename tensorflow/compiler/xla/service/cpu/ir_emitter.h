@@ -399,6 +399,18 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   ReductionGenerator MatchReductionGenerator(HloComputation* function,
                                              string* failure_reason) const;
 
+  // Emits a reduction whose reduced dimensions are the most minor dimensions
+  // of its operand, so that the "reduced_element_count" elements reduced into
+  // each output element are contiguous in memory.  Each output element is
+  // accumulated "vectorization_factor" elements at a time, and the output
+  // elements are partitioned like those of an elementwise op.  Helper function
+  // for EmitVectorizedReduce.
+  Status EmitVectorizedReduceOverMinorDimensions(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      const ReductionGenerator& reduction_generator,
+      int64 reduced_element_count, int vectorization_factor,
+      unsigned element_alignment);
+
   // Emits the inner loop nest that runs the reduction.  Helper function for
   // EmitVectorizedReduce.
   StatusOr<ShardedVector> EmitInnerLoopForVectorizedReduction(
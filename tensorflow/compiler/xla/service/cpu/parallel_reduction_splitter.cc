@@ -0,0 +1,308 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/parallel_reduction_splitter.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/primitive_util.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Splitting only pays off if every parallel task reduces at least this many
+// elements.
+constexpr int64 kMinReducedElementsPerTask = 16 * 1024;
+
+// Returns the identity of 'function' for elements of type 'type', if
+// 'function' is a binary op with a known identity on its two parameters.
+absl::optional<Literal> GetReductionIdentity(const HloComputation& function,
+                                             PrimitiveType type) {
+  if (function.num_parameters() != 2) {
+    return absl::nullopt;
+  }
+  const HloInstruction* root = function.root_instruction();
+  const HloInstruction* param_0 = function.parameter_instruction(0);
+  const HloInstruction* param_1 = function.parameter_instruction(1);
+  if (root->operand_count() != 2 ||
+      !((root->operand(0) == param_0 && root->operand(1) == param_1) ||
+        (root->operand(0) == param_1 && root->operand(1) == param_0))) {
+    return absl::nullopt;
+  }
+  const bool is_integral_or_pred =
+      type == PRED || primitive_util::IsIntegralType(type);
+  switch (root->opcode()) {
+    case HloOpcode::kAdd:
+      return LiteralUtil::Zero(type);
+    case HloOpcode::kMultiply:
+      return LiteralUtil::One(type);
+    case HloOpcode::kMaximum:
+      if (primitive_util::IsComplexType(type)) {
+        return absl::nullopt;
+      }
+      return LiteralUtil::MinValue(type);
+    case HloOpcode::kMinimum:
+      if (primitive_util::IsComplexType(type)) {
+        return absl::nullopt;
+      }
+      return LiteralUtil::MaxValue(type);
+    case HloOpcode::kOr:
+    case HloOpcode::kXor:
+      if (!is_integral_or_pred) {
+        return absl::nullopt;
+      }
+      return LiteralUtil::Zero(type);
+    case HloOpcode::kAnd:
+      if (type != PRED) {
+        return absl::nullopt;
+      }
+      return LiteralUtil::One(type);
+    default:
+      return absl::nullopt;
+  }
+}
+
+// The operand dimension that is split, and the number of parts it is split
+// into.
+struct Split {
+  int64 dimension;
+  int64 num_partitions;
+};
+
+absl::optional<Split> ChooseSplit(const HloInstruction& reduce,
+                                  int64 max_parallelism) {
+  const Shape& arg_shape = reduce.operand(0)->shape();
+  if (!reduce.shape().IsArray() || arg_shape.is_dynamic() ||
+      !LayoutUtil::HasLayout(arg_shape)) {
+    return absl::nullopt;
+  }
+  const int64 output_element_count = ShapeUtil::ElementsIn(reduce.shape());
+  if (output_element_count == 0 || output_element_count >= max_parallelism) {
+    return absl::nullopt;
+  }
+  const int64 reduced_element_count =
+      ShapeUtil::ElementsIn(arg_shape) / output_element_count;
+
+  // Splitting the majormost reduced dimension keeps the elements reduced by
+  // each parallel task contiguous.
+  int64 dimension = -1;
+  for (int64 i = arg_shape.rank() - 1; i >= 0; --i) {
+    const int64 minor_dimension = LayoutUtil::Minor(arg_shape.layout(), i);
+    if (absl::c_linear_search(reduce.dimensions(), minor_dimension)) {
+      dimension = minor_dimension;
+      break;
+    }
+  }
+  if (dimension < 0) {
+    return absl::nullopt;
+  }
+
+  const int64 dimension_size = arg_shape.dimensions(dimension);
+  const int64 max_partitions = std::min(
+      {dimension_size, reduced_element_count / kMinReducedElementsPerTask,
+       std::max<int64>(2, max_parallelism / output_element_count)});
+  for (int64 num_partitions = max_partitions; num_partitions >= 2;
+       --num_partitions) {
+    if (dimension_size % num_partitions == 0) {
+      return Split{dimension, num_partitions};
+    }
+  }
+  return absl::nullopt;
+}
+
+// Adds to 'computation' the first reduction of the split of 'reduce', which
+// computes the partial results of the parallel tasks, and returns it.
+HloInstruction* AddPartialReduce(HloComputation* computation,
+                                 HloInstruction* reduce, const Split& split,
+                                 Literal identity) {
+  HloInstruction* arg = reduce->mutable_operand(0);
+  const Shape& arg_shape = arg->shape();
+  const int64 d = split.dimension;
+
+  // In the split operand, dimension d is the partition and d + 1 the part of
+  // the original dimension within a partition. The split is a bitcast.
+  std::vector<int64> split_dimensions;
+  for (int64 i = 0; i < arg_shape.rank(); ++i) {
+    if (i == d) {
+      split_dimensions.push_back(split.num_partitions);
+      split_dimensions.push_back(arg_shape.dimensions(i) /
+                                 split.num_partitions);
+    } else {
+      split_dimensions.push_back(arg_shape.dimensions(i));
+    }
+  }
+  std::vector<int64> split_minor_to_major;
+  for (int64 i : LayoutUtil::MinorToMajor(arg_shape)) {
+    if (i == d) {
+      split_minor_to_major.push_back(d + 1);
+      split_minor_to_major.push_back(d);
+    } else {
+      split_minor_to_major.push_back(i < d ? i : i + 1);
+    }
+  }
+  const Shape split_shape = ShapeUtil::MakeShapeWithLayout(
+      arg_shape.element_type(), split_dimensions, split_minor_to_major);
+
+  std::vector<int64> partial_reduced_dimensions;
+  for (int64 i : reduce->dimensions()) {
+    partial_reduced_dimensions.push_back(i < d ? i : i + 1);
+  }
+  absl::c_sort(partial_reduced_dimensions);
+
+  // The partial results keep the relative layout of the unreduced dimensions,
+  // like the reduction.
+  absl::flat_hash_map<int64, int64> partial_dimension_index;
+  std::vector<int64> partial_dimensions;
+  for (int64 i = 0; i < split_shape.rank(); ++i) {
+    if (!absl::c_linear_search(partial_reduced_dimensions, i)) {
+      partial_dimension_index[i] = partial_dimensions.size();
+      partial_dimensions.push_back(split_shape.dimensions(i));
+    }
+  }
+  std::vector<int64> partial_minor_to_major;
+  for (int64 i : split_minor_to_major) {
+    auto it = partial_dimension_index.find(i);
+    if (it != partial_dimension_index.end()) {
+      partial_minor_to_major.push_back(it->second);
+    }
+  }
+  const Shape partial_shape = ShapeUtil::MakeShapeWithLayout(
+      reduce->shape().element_type(), partial_dimensions,
+      partial_minor_to_major);
+
+  HloInstruction* bitcast = computation->AddInstruction(
+      HloInstruction::CreateBitcast(split_shape, arg));
+  HloInstruction* identity_constant = computation->AddInstruction(
+      HloInstruction::CreateConstant(std::move(identity)));
+  return computation->AddInstruction(HloInstruction::CreateReduce(
+      partial_shape, bitcast, identity_constant, partial_reduced_dimensions,
+      reduce->to_apply()));
+}
+
+// Returns the dimension of the partial results that the second reduction of
+// the split of 'reduce' reduces.
+int64 MergedDimension(const HloInstruction& reduce, const Split& split) {
+  return split.dimension - absl::c_count_if(reduce.dimensions(), [&](int64 i) {
+           return i < split.dimension;
+         });
+}
+
+Status SplitUnfusedReduce(HloComputation* computation, HloInstruction* reduce,
+                          const Split& split, Literal identity) {
+  HloInstruction* partial =
+      AddPartialReduce(computation, reduce, split, std::move(identity));
+  HloInstruction* merged =
+      computation->AddInstruction(HloInstruction::CreateReduce(
+          reduce->shape(), partial, reduce->mutable_operand(1),
+          {MergedDimension(*reduce, split)}, reduce->to_apply()));
+  return computation->ReplaceInstruction(reduce, merged);
+}
+
+// Splits the reduce at the root of 'fusion': the fusion computes the partial
+// results, and a new reduction after it merges them.
+StatusOr<bool> SplitFusedReduce(HloComputation* computation,
+                                HloInstruction* fusion, const Split& split,
+                                Literal identity) {
+  HloComputation* fused_computation = fusion->fused_instructions_computation();
+  HloInstruction* reduce = fused_computation->root_instruction();
+  HloInstruction* init_value = reduce->mutable_operand(1);
+  HloInstruction* outer_init_value;
+  if (init_value->opcode() == HloOpcode::kParameter) {
+    outer_init_value =
+        fusion->mutable_operand(init_value->parameter_number());
+  } else if (init_value->opcode() == HloOpcode::kConstant) {
+    outer_init_value = computation->AddInstruction(init_value->Clone());
+  } else {
+    return false;
+  }
+
+  HloInstruction* partial = AddPartialReduce(fused_computation, reduce, split,
+                                             std::move(identity));
+  std::vector<HloInstruction*> users = fusion->users();
+  HloInstruction* merged =
+      computation->AddInstruction(HloInstruction::CreateReduce(
+          fusion->shape(), fusion, outer_init_value,
+          {MergedDimension(*reduce, split)}, reduce->to_apply()));
+  TF_RETURN_IF_ERROR(fusion->ReplaceUsesWith(users, merged));
+  if (computation->root_instruction() == fusion) {
+    computation->set_root_instruction(merged);
+  }
+  fused_computation->set_root_instruction(partial,
+                                          /*accept_different_shape=*/true);
+  TF_RETURN_IF_ERROR(fused_computation->RemoveInstruction(reduce));
+  *fusion->mutable_shape() = partial->shape();
+  return true;
+}
+
+}  // namespace
+
+StatusOr<bool> ParallelReductionSplitter::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    for (HloInstruction* instruction :
+         computation->MakeInstructionPostOrder()) {
+      HloInstruction* reduce;
+      if (instruction->opcode() == HloOpcode::kReduce) {
+        reduce = instruction;
+      } else if (instruction->IsLoopFusion() &&
+                 instruction->fused_expression_root()->opcode() ==
+                     HloOpcode::kReduce) {
+        reduce = instruction->fused_expression_root();
+      } else {
+        continue;
+      }
+      absl::optional<Split> split = ChooseSplit(*reduce, max_parallelism_);
+      if (!split) {
+        continue;
+      }
+      absl::optional<Literal> identity = GetReductionIdentity(
+          *reduce->to_apply(), reduce->shape().element_type());
+      if (!identity) {
+        continue;
+      }
+      VLOG(2) << "Splitting dimension " << split->dimension << " of "
+              << reduce->ToString() << " into " << split->num_partitions
+              << " partitions";
+      if (instruction == reduce) {
+        TF_RETURN_IF_ERROR(SplitUnfusedReduce(computation, reduce, *split,
+                                              std::move(*identity)));
+        changed = true;
+      } else {
+        TF_ASSIGN_OR_RETURN(bool split_fusion,
+                            SplitFusedReduce(computation, instruction, *split,
+                                             std::move(*identity)));
+        changed |= split_fusion;
+      }
+    }
+  }
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_REDUCTION_SPLITTER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_REDUCTION_SPLITTER_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// ParallelTaskAssigner partitions the output of a reduction between parallel
+// tasks, so reductions with fewer output elements than threads, like full
+// reductions and column reductions into a few columns, run on one or a few
+// threads. This pass splits the majormost reduced dimension of such
+// reductions in two:
+//
+//   f32[1048576] -> f32[]
+//
+// becomes
+//
+//   f32[1048576] -> bitcast f32[16,65536] -> reduce f32[16] -> reduce f32[]
+//
+// The first reduction computes one partial result per parallel task, and
+// ParallelTaskAssigner partitions it between threads. The second one merges
+// the partial results with the original initial value. The first reduction
+// starts from the identity of the reduction function, so this only applies to
+// reductions with an add, multiply, maximum, minimum, and, or or xor function.
+//
+// This rewrite reassociates the reduction, like TreeReductionRewriter does. It
+// runs after layout assignment and instruction fusion, so that the
+// simplifications in between don't merge the two reductions back, and applies
+// to both unfused reductions and loop fusions with a reduction root.
+class ParallelReductionSplitter : public HloModulePass {
+ public:
+  // 'max_parallelism': the maximum number of parallel tasks per instruction,
+  // as given to ParallelTaskAssigner.
+  explicit ParallelReductionSplitter(int64 max_parallelism)
+      : max_parallelism_(max_parallelism) {}
+  ~ParallelReductionSplitter() override = default;
+
+  absl::string_view name() const override {
+    return "parallel-reduction-splitter";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 max_parallelism_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_REDUCTION_SPLITTER_H_
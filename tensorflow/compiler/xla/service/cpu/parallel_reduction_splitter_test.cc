@@ -0,0 +1,183 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/parallel_reduction_splitter.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+using ParallelReductionSplitterTest = HloTestBase;
+
+TEST_F(ParallelReductionSplitterTest, FullReductionIsSplit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY e {
+  p = f32[1048576]{0} parameter(0)
+  init = f32[] parameter(1)
+  ROOT reduce = f32[] reduce(p, init), dimensions={0}, to_apply=add
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(ParallelReductionSplitter(16).Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Reduce(op::Reduce(op::Bitcast(op::Parameter(0)),
+                                          op::Constant()),
+                               op::Parameter(1)));
+  EXPECT_EQ(root->dimensions(), std::vector<int64>({0}));
+  const HloInstruction* partial = root->operand(0);
+  EXPECT_TRUE(ShapeUtil::Equal(partial->shape(),
+                               ShapeUtil::MakeShapeWithLayout(F32, {16}, {0})));
+  EXPECT_EQ(partial->dimensions(), std::vector<int64>({1}));
+  EXPECT_TRUE(partial->operand(1)->literal().IsAll(0));
+}
+
+TEST_F(ParallelReductionSplitterTest, ColumnReductionIsSplit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+max {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT max = f32[] maximum(a, b)
+}
+
+ENTRY e {
+  p = f32[65536,4]{1,0} parameter(0)
+  init = f32[] constant(0)
+  ROOT reduce = f32[4]{0} reduce(p, init), dimensions={0}, to_apply=max
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(ParallelReductionSplitter(16).Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root,
+              op::Reduce(op::Reduce(op::Bitcast(op::Parameter(0)),
+                                    op::Constant()),
+                         op::Constant()));
+  EXPECT_EQ(root->dimensions(), std::vector<int64>({0}));
+  const HloInstruction* partial = root->operand(0);
+  EXPECT_TRUE(ShapeUtil::Equal(
+      partial->shape(), ShapeUtil::MakeShapeWithLayout(F32, {4, 4}, {1, 0})));
+  EXPECT_EQ(partial->dimensions(), std::vector<int64>({1}));
+  EXPECT_TRUE(ShapeUtil::Equal(
+      partial->operand(0)->shape(),
+      ShapeUtil::MakeShapeWithLayout(F32, {4, 16384, 4}, {2, 1, 0})));
+}
+
+TEST_F(ParallelReductionSplitterTest, FusedReductionIsSplit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+fused_reduce {
+  p0 = f32[1048576]{0} parameter(0)
+  p1 = f32[] parameter(1)
+  mul = f32[1048576]{0} multiply(p0, p0)
+  ROOT reduce = f32[] reduce(mul, p1), dimensions={0}, to_apply=add
+}
+
+ENTRY e {
+  p = f32[1048576]{0} parameter(0)
+  init = f32[] parameter(1)
+  ROOT fusion = f32[] fusion(p, init), kind=kLoop, calls=fused_reduce
+})")
+                    .ValueOrDie();
+  ASSERT_TRUE(ParallelReductionSplitter(8).Run(module.get()).ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Reduce(op::Fusion(), op::Parameter(1)));
+  const HloInstruction* fusion = root->operand(0);
+  EXPECT_TRUE(ShapeUtil::Equal(fusion->shape(),
+                               ShapeUtil::MakeShapeWithLayout(F32, {8}, {0})));
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Reduce(op::Bitcast(op::Multiply()), op::Constant()));
+}
+
+TEST_F(ParallelReductionSplitterTest, ReductionWithManyOutputsIsNotSplit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY e {
+  p = f32[32,65536]{1,0} parameter(0)
+  init = f32[] constant(0)
+  ROOT reduce = f32[32]{0} reduce(p, init), dimensions={1}, to_apply=add
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(ParallelReductionSplitter(16).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(ParallelReductionSplitterTest, ReductionWithoutIdentityIsNotSplit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+sub {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT sub = f32[] subtract(a, b)
+}
+
+ENTRY e {
+  p = f32[1048576]{0} parameter(0)
+  init = f32[] constant(0)
+  ROOT reduce = f32[] reduce(p, init), dimensions={0}, to_apply=sub
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(ParallelReductionSplitter(16).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(ParallelReductionSplitterTest, SmallReductionIsNotSplit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY e {
+  p = f32[1024]{0} parameter(0)
+  init = f32[] constant(0)
+  ROOT reduce = f32[] reduce(p, init), dimensions={0}, to_apply=add
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(ParallelReductionSplitter(16).Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
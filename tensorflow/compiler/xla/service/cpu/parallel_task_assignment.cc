@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -24,10 +25,50 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Returns the shape whose outer dimensions are partitioned between the
+// parallel tasks of 'instruction'. All the outputs of a multi-output loop
+// fusion have the same dimensions and are partitioned like the first one.
+const Shape& PartitionedShape(const HloInstruction& instruction) {
+  return instruction.shape().IsTuple() ? instruction.shape().tuple_shapes(0)
+                                       : instruction.shape();
+}
+
+// Returns the size of all the outputs of 'instruction'.
+int64 OutputSize(const HloInstruction& instruction,
+                 const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  if (!instruction.shape().IsTuple()) {
+    return shape_size(instruction.shape());
+  }
+  int64 size = 0;
+  for (const Shape& output_shape : instruction.shape().tuple_shapes()) {
+    size += shape_size(output_shape);
+  }
+  return size;
+}
+
+// Returns whether 'instruction' is a multi-output loop fusion whose outputs
+// can share one loop nest.
+bool IsPartitionableMultiOutputFusion(const HloInstruction& instruction) {
+  if (!instruction.IsLoopFusion() || !instruction.IsMultiOutputFusion()) {
+    return false;
+  }
+  const Shape& first_output = instruction.shape().tuple_shapes(0);
+  return absl::c_all_of(
+      instruction.shape().tuple_shapes(), [&](const Shape& output_shape) {
+        return output_shape.IsArray() &&
+               ShapeUtil::EqualIgnoringElementType(output_shape, first_output);
+      });
+}
+
+}  // namespace
+
 class SimpleCostModel : public ParallelCostModel {
  public:
   SimpleCostModel(const int64 max_parallelism,
@@ -37,7 +78,7 @@ class SimpleCostModel : public ParallelCostModel {
 
   int64 GetParallelTaskCount(HloInstruction* instruction) override {
     // Simple cost model based on hlo size and typical L2 cache size.
-    const int64 instruction_cost = shape_size_(instruction->shape());
+    const int64 instruction_cost = OutputSize(*instruction, shape_size_);
     const int64 min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     // Return target parallel task count in [1, max_parallelism_].
     return std::min(max_parallelism_,
@@ -79,7 +120,7 @@ class DefaultCostModel : public ParallelCostModel {
           max_parallelism_,
           std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
       // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
+      instruction_cost = OutputSize(*instruction, shape_size_);
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
       // Use max parallelism for compute bound instructions.
@@ -135,7 +176,7 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
   // *) Internal threading (library calls to kConv, kDot, kFft, kCustomCall).
   // *) Emit custom loops (kSelectAndScatter).
   // *) Operations that are not thread safe (like infeed and rng).
-  // *) Tuple-shaped.
+  // *) Tuple-shaped, except for multi-output loop fusions.
   // *) Operations that might be implemented as an in-place
   //    dynamic-update-slice, because we can't know how many output elements
   //    they will write (out-of-place will touch the whole output buffer, while
@@ -143,7 +184,9 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
   // TODO(b/27458679) Parallelize instructions which are skipped here.
   auto opcode = instruction->opcode();
   if (llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instruction) ||
-      instruction->shape().IsTuple() || opcode == HloOpcode::kRng) {
+      (instruction->shape().IsTuple() &&
+       !IsPartitionableMultiOutputFusion(*instruction)) ||
+      opcode == HloOpcode::kRng) {
     return 1;
   }
 
@@ -217,8 +260,9 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
     // Get target parallel task count computed for 'instruction'.
     const int64 target_parallel_task_count = (*it).second;
     // Assign feasible dimension partitions (based on actual dimension sizes).
-    auto dim_partition_counts = ShapePartitionAssigner(instruction->shape())
-                                    .Run(target_parallel_task_count);
+    auto dim_partition_counts =
+        ShapePartitionAssigner(PartitionedShape(*instruction))
+            .Run(target_parallel_task_count);
     const int64 total_partition_count =
         ShapePartitionAssigner::GetTotalPartitionCount(dim_partition_counts);
     if (total_partition_count <= 1) {
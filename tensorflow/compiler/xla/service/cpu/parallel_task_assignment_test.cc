@@ -191,5 +191,37 @@ TEST_F(ParallelTaskAssignmentTest, AllReduceNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, MultiOutputLoopFusionParallelized) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_multi_output_fusion
+    fused_computation {
+      p0 = f32[1234567,2]{1,0} parameter(0)
+      p1 = f32[1234567,2]{1,0} parameter(1)
+      add = f32[1234567,2]{1,0} add(p0, p1)
+      multiply = f32[1234567,2]{1,0} multiply(p0, p1)
+      ROOT tuple = (f32[1234567,2]{1,0}, f32[1234567,2]{1,0})
+        tuple(add, multiply)
+    }
+
+    ENTRY MultiOutputFusion {
+      p0 = f32[1234567,2]{1,0} parameter(0)
+      p1 = f32[1234567,2]{1,0} parameter(1)
+      ROOT fusion = (f32[1234567,2]{1,0}, f32[1234567,2]{1,0}) fusion(p0, p1),
+        kind=kLoop, calls=fused_computation
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* root = m->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kCall);
+  EXPECT_FALSE(root->to_apply()
+                   ->root_instruction()
+                   ->outer_dimension_partitions()
+                   .empty());
+}
+
 }  // namespace
 }  // namespace xla
@@ -15,12 +15,20 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Most x86 server and desktop cores have at least this much L2 cache.
+constexpr int64 kDefaultL2CacheSizeInBytes = 256 * 1024;
+
+}  // namespace
+
 llvm::TargetTransformInfo* LLVMTargetMachineFeatures::GetTargetTransformInfoFor(
     const llvm::Function& function) const {
   auto it = target_transform_info_cache_.find(&function);
@@ -49,5 +57,13 @@ int64 LLVMTargetMachineFeatures::minimum_alignment_for_allocation(
                          cpu_function_runtime::kMinAlign);
 }
 
+int64 LLVMTargetMachineFeatures::l2_cache_size_in_bytes() const {
+  // Cache levels are numbered from 0 for the L1 cache. Few targets describe
+  // their caches in the subtarget info, so fall back to a typical size.
+  llvm::Optional<unsigned> size =
+      target_machine_->getMCSubtargetInfo()->getCacheSize(/*Level=*/1);
+  return size.hasValue() ? *size : kDefaultL2CacheSizeInBytes;
+}
+
 }  // namespace cpu
 }  // namespace xla
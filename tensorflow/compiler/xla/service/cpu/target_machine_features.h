@@ -61,6 +61,10 @@ class TargetMachineFeatures {
   // Returns the minimum alignment for a buffer of size size_bytes.
   virtual int64 minimum_alignment_for_allocation(int64 size_bytes) const = 0;
 
+  // Returns the size in bytes of the L2 data cache, or an estimate of it if
+  // the target doesn't describe its caches.
+  virtual int64 l2_cache_size_in_bytes() const = 0;
+
   virtual ~TargetMachineFeatures() = default;
 };
 
@@ -98,6 +102,8 @@ class LLVMTargetMachineFeatures : public TargetMachineFeatures {
 
   int64 minimum_alignment_for_allocation(int64 size_bytes) const override;
 
+  int64 l2_cache_size_in_bytes() const override;
+
  private:
   llvm::TargetTransformInfo* GetTargetTransformInfoFor(
       const llvm::Function& function) const;
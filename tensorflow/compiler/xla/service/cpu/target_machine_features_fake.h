@@ -48,6 +48,10 @@ class TargetMachineFeaturesWithFakeAlignmentLogic
     LOG(FATAL) << "Unexpected call to " << __func__;
   }
 
+  int64 l2_cache_size_in_bytes() const override {
+    LOG(FATAL) << "Unexpected call to " << __func__;
+  }
+
   int64 minimum_alignment_for_allocation(int64 size_bytes) const override {
     return fake_alignment_logic_(size_bytes);
   }
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/xfeed_manager.h"
 
 #include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -57,13 +58,18 @@ void XfeedQueueManager::EnqueueBuffersAtomically(
 XfeedBuffer* XfeedQueueManager::BlockingDequeueBuffer() {
   tensorflow::mutex_lock l(mu_);
   VLOG(3) << "Waiting for an available buffer.";
-  while (enqueued_buffers_.empty()) {
-    cv_.wait(l);
+  if (enqueued_buffers_.empty()) {
+    const uint64 wait_start_micros = tensorflow::Env::Default()->NowMicros();
+    while (enqueued_buffers_.empty()) {
+      cv_.wait(l);
+    }
+    wait_micros_ += tensorflow::Env::Default()->NowMicros() - wait_start_micros;
   }
   VLOG(3) << "A buffer is available!";
   CHECK(current_buffer_ == nullptr);
   current_buffer_ = enqueued_buffers_.front();
   enqueued_buffers_.pop_front();
+  ++dequeue_count_;
   return current_buffer_;
 }
 
@@ -80,6 +86,15 @@ void XfeedQueueManager::ReleaseCurrentBuffer(int32 length, void* data,
   current_buffer_ = nullptr;
 }
 
+XfeedQueueManager::Stats XfeedQueueManager::GetStats() {
+  tensorflow::mutex_lock l(mu_);
+  Stats stats;
+  stats.depth = enqueued_buffers_.size();
+  stats.dequeue_count = dequeue_count_;
+  stats.wait_micros = wait_micros_;
+  return stats;
+}
+
 }  // namespace runtime
 }  // namespace cpu
 }  // namespace xla
@@ -85,6 +85,19 @@ class XfeedQueueManager {
   // sanity checking purposes.
   void ReleaseCurrentBuffer(int32 length, void* data, StatusOr<Shape> shape);
 
+  // Counters of the queue, for monitoring whether the runtime is starved.
+  struct Stats {
+    // Number of buffers enqueued and not yet dequeued.
+    int64 depth = 0;
+    // Number of buffers returned by BlockingDequeueBuffer so far.
+    int64 dequeue_count = 0;
+    // Total time BlockingDequeueBuffer waited for the queue to become
+    // non-empty.
+    int64 wait_micros = 0;
+  };
+
+  Stats GetStats();
+
  private:
   const string queue_name_;
 
@@ -101,6 +114,9 @@ class XfeedQueueManager {
   // If non-NULL, the buffer that is currently being processed by the
   // runtime. Not owned.
   XfeedBuffer* current_buffer_ = nullptr;
+
+  int64 dequeue_count_ = 0;
+  int64 wait_micros_ = 0;
 };
 
 // Client-side class used to enqueue infeed buffers.
@@ -128,6 +128,37 @@ TEST_F(InfeedManagerTest, MultiThreaded) {
   ProcessNextBuffer(length);
 }
 
+TEST_F(InfeedManagerTest, Stats) {
+  tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(), "test", 2);
+
+  cpu::runtime::XfeedManager* xfeed = cpu::runtime::GetXfeedManager(0);
+  const cpu::runtime::XfeedQueueManager::Stats initial_stats =
+      xfeed->infeed()->GetStats();
+
+  xfeed->infeed()->EnqueueBuffersAtomically(
+      {new TestInfeedBuffer(64), new TestInfeedBuffer(32)});
+  cpu::runtime::XfeedQueueManager::Stats stats = xfeed->infeed()->GetStats();
+  EXPECT_EQ(stats.depth, initial_stats.depth + 2);
+  EXPECT_EQ(stats.dequeue_count, initial_stats.dequeue_count);
+
+  ProcessNextBuffer(64);
+  ProcessNextBuffer(32);
+  stats = xfeed->infeed()->GetStats();
+  EXPECT_EQ(stats.depth, initial_stats.depth);
+  EXPECT_EQ(stats.dequeue_count, initial_stats.dequeue_count + 2);
+  // The buffers were already enqueued, so nothing waited for them.
+  EXPECT_EQ(stats.wait_micros, initial_stats.wait_micros);
+
+  pool.Schedule([&xfeed]() {
+    tensorflow::Env::Default()->SleepForMicroseconds(100000);  // 100 ms
+    xfeed->infeed()->EnqueueBuffersAtomically({new TestInfeedBuffer(64)});
+  });
+  ProcessNextBuffer(64);
+  stats = xfeed->infeed()->GetStats();
+  EXPECT_EQ(stats.dequeue_count, initial_stats.dequeue_count + 3);
+  EXPECT_GT(stats.wait_micros, initial_stats.wait_micros);
+}
+
 TEST_F(InfeedManagerTest, OutfeedWrongShape) {
   TestInfeedBuffer* b = new TestInfeedBuffer(32, /*expect_shape_match=*/false);
   cpu::runtime::XfeedManager* xfeed = cpu::runtime::GetXfeedManager(0);
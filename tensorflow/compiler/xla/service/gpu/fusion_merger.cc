@@ -20,7 +20,9 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
@@ -129,8 +131,9 @@ double GetMergedBytesTransferred(HloInstruction* fusion) {
 // Accumulates and reports stats on successful/failed merge attempts.
 class FusionInstructionMerger {
  public:
-  explicit FusionInstructionMerger(HloComputation* computation)
-      : computation_(computation) {}
+  FusionInstructionMerger(HloComputation* computation,
+                          const absl::optional<GpuDeviceInfo>& device_info)
+      : computation_(computation), device_info_(device_info) {}
 
   Status Run();
 
@@ -139,7 +142,12 @@ class FusionInstructionMerger {
  private:
   Status HandleFusion(HloInstruction* fusion);
 
+  // Returns true unless GpuPerformanceModel predicts that merging `fusion`
+  // into all its users makes them faster. REQUIRES: device_info_ is set.
+  bool MergeIsSlowerWithCostModel(HloInstruction* fusion);
+
   HloComputation* computation_;
+  const absl::optional<GpuDeviceInfo>& device_info_;
   bool changed_ = false;
 
   // Fusion instruction merge stats.
@@ -152,6 +160,7 @@ class FusionInstructionMerger {
   int num_fail_net_bytes_transferred_ratio_ = 0;
   int num_fail_inefficient_fusion_emitter_ = 0;
   int num_fail_fusion_too_large_ = 0;
+  int num_fail_slower_with_cost_model_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FusionInstructionMerger);
 };
@@ -174,7 +183,9 @@ Status FusionInstructionMerger::Run() {
           << " net_bytes_transferred: " << num_fail_net_bytes_transferred_ratio_
           << " inefficient_fusion_emitter: "
           << num_fail_inefficient_fusion_emitter_
-          << " fusion_too_large: " << num_fail_fusion_too_large_ << " }";
+          << " fusion_too_large: " << num_fail_fusion_too_large_
+          << " slower_with_cost_model: " << num_fail_slower_with_cost_model_
+          << " }";
   return Status::OK();
 }
 
@@ -217,7 +228,14 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
   const double merged_bytes_transferred = GetMergedBytesTransferred(fusion);
   const double merged_to_current_bytes_ratio =
       merged_bytes_transferred / std::max(1.0, current_bytes_transferred);
-  if (merged_to_current_bytes_ratio > 1.10) {
+  if (device_info_.has_value()) {
+    // The performance model accounts for both the bytes transferred and the
+    // duplicated instructions.
+    if (MergeIsSlowerWithCostModel(fusion)) {
+      ++num_fail_slower_with_cost_model_;
+      return Status::OK();
+    }
+  } else if (merged_to_current_bytes_ratio > 1.10) {
     VLOG(3) << "Not merging " << fusion->name()
             << ": merged-to-current-bytes-ratio of "
             << merged_to_current_bytes_ratio << " is not favorable.";
@@ -236,7 +254,7 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
   // trivial (above 1K).  This likely has room for improvement in the future.
 
   bool allow_expensive_ops =
-      fusion->user_count() == 1 ||
+      device_info_.has_value() || fusion->user_count() == 1 ||
       (merged_to_current_bytes_ratio < 0.3 && current_bytes_transferred > 1024);
 
   if (!allow_expensive_ops &&
@@ -307,6 +325,28 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
   return computation_->RemoveInstruction(fusion);
 }
 
+bool FusionInstructionMerger::MergeIsSlowerWithCostModel(
+    HloInstruction* fusion) {
+  std::vector<const HloInstruction*> users(fusion->users().begin(),
+                                           fusion->users().end());
+  StatusOr<GpuPerformanceModel::RunTimes> run_times =
+      GpuPerformanceModel::EstimateRunTimes(fusion, *device_info_, users);
+  if (!run_times.ok()) {
+    // Leave the instructions the cost analysis can't handle alone.
+    VLOG(3) << "Not merging " << fusion->name()
+            << ": No estimate of the run time: " << run_times.status();
+    return true;
+  }
+  if (run_times->time_fused > run_times->time_unfused) {
+    VLOG(3) << "Not merging " << fusion->name()
+            << ": Estimated to take "
+            << absl::FormatDuration(run_times->time_fused) << " instead of "
+            << absl::FormatDuration(run_times->time_unfused);
+    return true;
+  }
+  return false;
+}
+
 StatusOr<bool> FusionMerger::Run(HloModule* module) {
   bool changed = false;
   VLOG(2) << "FusionMerger for module: " << module->name();
@@ -315,7 +355,7 @@ StatusOr<bool> FusionMerger::Run(HloModule* module) {
             << computation->name();
     XLA_VLOG_LINES(3, computation->ToString());
 
-    FusionInstructionMerger fusion_merger(computation);
+    FusionInstructionMerger fusion_merger(computation, device_info_);
     TF_RETURN_IF_ERROR(fusion_merger.Run());
     changed |= fusion_merger.changed();
 
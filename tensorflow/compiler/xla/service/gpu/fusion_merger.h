@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_MERGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_MERGER_H_
 
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 
@@ -32,11 +34,20 @@ namespace gpu {
 // 2) The result of merging the fusion instruction into its users would not
 //    increase bytes transferred.
 //
+// If `device_info` is given, these two conditions are replaced by the
+// prediction of GpuPerformanceModel that the merge makes the kernels faster.
 class FusionMerger : public HloModulePass {
  public:
+  explicit FusionMerger(
+      absl::optional<GpuDeviceInfo> device_info = absl::nullopt)
+      : device_info_(device_info) {}
+
   absl::string_view name() const override { return "fusion_merger"; }
 
   StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  absl::optional<GpuDeviceInfo> device_info_;
 };
 
 }  // namespace gpu
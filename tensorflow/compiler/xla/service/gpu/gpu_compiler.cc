@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_layout_assignment.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
@@ -121,6 +122,55 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
+namespace {
+
+GpuDeviceInfo GetGpuDeviceInfo(se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& description =
+      stream_exec->GetDeviceDescription();
+  GpuDeviceInfo gpu_device_info;
+  gpu_device_info.threads_per_block_limit =
+      description.threads_per_block_limit();
+  gpu_device_info.threads_per_warp = description.threads_per_warp();
+  gpu_device_info.shared_memory_per_block =
+      description.shared_memory_per_block();
+  gpu_device_info.core_count = description.core_count();
+  gpu_device_info.memory_bandwidth = description.memory_bandwidth();
+  gpu_device_info.clock_rate_ghz = description.clock_rate_ghz();
+  return gpu_device_info;
+}
+
+// Returns the device to run the fusion passes' performance model for, if it
+// is enabled.
+absl::optional<GpuDeviceInfo> CostModelDeviceInfo(
+    const HloModule& module, se::StreamExecutor* stream_exec) {
+  if (stream_exec == nullptr ||
+      !module.config().debug_options().xla_gpu_enable_cost_model_fusion()) {
+    return absl::nullopt;
+  }
+  return GetGpuDeviceInfo(stream_exec);
+}
+
+// Writes the run time GpuPerformanceModel predicts for every instruction of
+// the entry computation, to compare with the times measured by the HLO
+// profile.
+void DumpPerformanceModelPredictions(const HloModule& module,
+                                     const GpuDeviceInfo& gpu_device_info) {
+  std::string predictions;
+  for (const HloInstruction* instruction :
+       module.entry_computation()->MakeInstructionPostOrder()) {
+    StatusOr<absl::Duration> run_time =
+        GpuPerformanceModel::EstimateRunTime(instruction, gpu_device_info);
+    absl::StrAppend(&predictions, instruction->name(), "\t",
+                    run_time.ok() ? absl::FormatDuration(*run_time)
+                                  : run_time.status().error_message(),
+                    "\n");
+  }
+  DumpToFileInDirOrStdout(module, "", "gpu_performance_model.txt",
+                          predictions);
+}
+
+}  // namespace
+
 GpuCompiler::GpuCompiler(se::Platform::Id platform_id,
                          const char* target_triple, const char* data_layout)
     : platform_id_(platform_id),
@@ -291,9 +341,13 @@ Status GpuCompiler::OptimizeHloModule(
         /*layout_sensitive=*/true,
         /*allow_mixed_precision=*/false,
         LayoutAssignment::InstructionCanChangeLayout);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
-    fusion.AddPass<FusionMerger>();
+    const absl::optional<GpuDeviceInfo> cost_model_device_info =
+        CostModelDeviceInfo(*hlo_module, stream_exec);
+    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false,
+                                         cost_model_device_info);
+    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true,
+                                         cost_model_device_info);
+    fusion.AddPass<FusionMerger>(cost_model_device_info);
     fusion.AddPass<GpuMultiOutputFusion>();
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
                            /*only_fusion_computations=*/true);
@@ -493,7 +547,8 @@ static Status CompileModuleToLlvmIrImpl(
       AssignStreams(*hlo_module);
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<GpuHloSchedule> hlo_schedule,
-      GpuHloSchedule::Build(*hlo_module, *stream_assignment, pointer_size));
+      GpuHloSchedule::Build(*hlo_module, *stream_assignment, pointer_size,
+                            gpu_device_info));
 
   auto buffer_size_bytes_function =
       [pointer_size](const BufferValue& buffer_value) -> int64 {
@@ -605,13 +660,7 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   };
   llvm_context.setDiagnosticHandlerCallBack(DiagnosticHandler, &printer);
 
-  GpuDeviceInfo gpu_device_info;
-  gpu_device_info.threads_per_block_limit =
-      stream_exec->GetDeviceDescription().threads_per_block_limit();
-  gpu_device_info.threads_per_warp =
-      stream_exec->GetDeviceDescription().threads_per_warp();
-  gpu_device_info.shared_memory_per_block =
-      stream_exec->GetDeviceDescription().shared_memory_per_block();
+  GpuDeviceInfo gpu_device_info = GetGpuDeviceInfo(stream_exec);
 
   absl::optional<CudaComputeCapability> cuda_compute_capability =
       [&]() -> absl::optional<CudaComputeCapability> {
@@ -629,8 +678,18 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
 
   if (module->config().hlo_profiling_enabled() || VLOG_IS_ON(1)) {
     HloCostAnalysis cost_analysis(ShapeSizeBytesFunction());
-    cost_analysis.set_bytes_per_second(
-        stream_exec->GetDeviceDescription().memory_bandwidth());
+    if (module->config().debug_options().xla_gpu_enable_cost_model_fusion()) {
+      // Makes the optimal times of the profile the predictions of the
+      // performance model the fusion passes used.
+      GpuPerformanceModel::SetCostAnalysisRates(gpu_device_info,
+                                                &cost_analysis);
+      if (module->config().hlo_profiling_enabled()) {
+        DumpPerformanceModelPredictions(*module, gpu_device_info);
+      }
+    } else {
+      cost_analysis.set_bytes_per_second(
+          stream_exec->GetDeviceDescription().memory_bandwidth());
+    }
     TF_RETURN_IF_ERROR(module->entry_computation()->Accept(&cost_analysis));
     VLOG(1) << "HLO memory read+written: "
             << tensorflow::strings::HumanReadableNumBytes(
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_DEVICE_INFO_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_DEVICE_INFO_H_
 
+#include "tensorflow/compiler/xla/types.h"
+
 namespace xla {
 namespace gpu {
 
@@ -32,6 +34,12 @@ struct GpuDeviceInfo {
   int threads_per_block_limit;
   int threads_per_warp;
   int shared_memory_per_block;
+
+  // Used by the performance model, which assumes typical values when these
+  // are 0.
+  int core_count = 0;
+  int64 memory_bandwidth = 0;  // In bytes per second.
+  float clock_rate_ghz = 0;
 };
 }  // namespace gpu
 }  // namespace xla
@@ -13,17 +13,22 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
 #include "tensorflow/compiler/xla/service/hlo_schedule.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/types.h"
 
 namespace xla {
@@ -184,6 +189,142 @@ void BFSLaunchOrder(const HloComputation* computation,
   }
 }
 
+// Used to estimate the time of all-reduces: the bandwidth of the links between
+// the devices, in bytes per second, and the latency of an all-reduce.
+constexpr double kInterconnectBandwidth = 25e9;
+constexpr absl::Duration kAllReduceLatency = absl::Microseconds(10);
+
+// Estimates the time of an all-reduce with the ring algorithm, where every
+// participant sends and receives 2 * (n - 1) / n times the reduced bytes.
+absl::Duration EstimateAllReduceTime(const HloInstruction& all_reduce,
+                                     int64 pointer_size) {
+  int64 num_participants = all_reduce.GetModule()->config().replica_count();
+  if (!all_reduce.replica_groups().empty()) {
+    num_participants = all_reduce.replica_groups()[0].replica_ids_size();
+  }
+  if (num_participants <= 1) {
+    return kAllReduceLatency;
+  }
+  int64 bytes = 0;
+  for (const HloInstruction* operand : all_reduce.operands()) {
+    bytes += ShapeUtil::ByteSizeOf(operand->shape(), pointer_size);
+  }
+  return kAllReduceLatency +
+         absl::Seconds(2.0 * (num_participants - 1) / num_participants *
+                       bytes / kInterconnectBandwidth);
+}
+
+// Computes a topological launch order that hides the latency of all-reduces
+// running on a stream of their own. Each all-reduce is launched as soon as its
+// operands are, and the kernels that don't depend on the all-reduces in
+// flight are launched before the users of these all-reduces, which would make
+// the compute stream wait. To decide when an all-reduce is done, the order is
+// simulated with estimated times of the all-reduces and the kernels, with the
+// all-reduces running in order on their stream and the other kernels in order
+// on the compute stream. Among the kernels that can run without waiting, the
+// order is breadth-first, like BFSLaunchOrder.
+void LatencyHidingLaunchOrder(const HloComputation* computation,
+                              const GpuDeviceInfo& device_info,
+                              int64 pointer_size,
+                              std::vector<HloInstruction*>* launch_order) {
+  // The instructions whose operands were all launched, in the order they
+  // became ready.
+  std::vector<HloInstruction*> ready;
+  std::unordered_map<const HloInstruction*, int64> incoming_edge_count;
+  for (auto* hlo : computation->instructions()) {
+    if (hlo->operand_count() == 0) {
+      ready.push_back(hlo);
+    } else {
+      incoming_edge_count[hlo] =
+          std::set<HloInstruction*>(hlo->operands().begin(),
+                                    hlo->operands().end())
+              .size();
+    }
+  }
+
+  // The simulated times at which the compute stream and the all-reduce stream
+  // are done with the kernels launched so far.
+  absl::Duration compute_time = absl::ZeroDuration();
+  absl::Duration all_reduce_time = absl::ZeroDuration();
+  // For each launched instruction, the time at which the all-reduces whose
+  // results it reads, directly or through instructions without kernels, are
+  // done.
+  absl::flat_hash_map<const HloInstruction*, absl::Duration> all_reduces_done;
+  auto operand_all_reduces_done = [&](const HloInstruction* hlo) {
+    absl::Duration done = absl::ZeroDuration();
+    for (const HloInstruction* operand : hlo->operands()) {
+      done = std::max(done, all_reduces_done.at(operand));
+    }
+    return done;
+  };
+  auto estimate_run_time = [&](const HloInstruction* hlo) {
+    StatusOr<absl::Duration> run_time =
+        GpuPerformanceModel::EstimateRunTime(hlo, device_info);
+    return run_time.ok() ? std::max(run_time.ValueOrDie(), absl::ZeroDuration())
+                         : absl::ZeroDuration();
+  };
+
+  while (!ready.empty()) {
+    // Launch ready all-reduces first, then the first ready kernel that doesn't
+    // wait for an all-reduce, and otherwise the kernel whose wait is shortest.
+    int64 next = -1;
+    for (int64 i = 0; i < ready.size() && next < 0; ++i) {
+      if (ready[i]->opcode() == HloOpcode::kAllReduce) {
+        next = i;
+      }
+    }
+    for (int64 i = 0; i < ready.size() && next < 0; ++i) {
+      if (operand_all_reduces_done(ready[i]) <= compute_time) {
+        next = i;
+      }
+    }
+    if (next < 0) {
+      next = 0;
+      for (int64 i = 1; i < ready.size(); ++i) {
+        if (operand_all_reduces_done(ready[i]) <
+            operand_all_reduces_done(ready[next])) {
+          next = i;
+        }
+      }
+    }
+    HloInstruction* x = ready[next];
+    ready.erase(ready.begin() + next);
+    launch_order->push_back(x);
+
+    if (x->opcode() == HloOpcode::kAllReduce) {
+      all_reduce_time = std::max(all_reduce_time, compute_time) +
+                        EstimateAllReduceTime(*x, pointer_size);
+      all_reduces_done[x] = all_reduce_time;
+    } else {
+      const absl::Duration run_time = estimate_run_time(x);
+      if (run_time == absl::ZeroDuration()) {
+        // Instructions without kernels forward the results of their operands.
+        all_reduces_done[x] = operand_all_reduces_done(x);
+      } else {
+        compute_time =
+            std::max(compute_time, operand_all_reduces_done(x)) + run_time;
+        all_reduces_done[x] = absl::ZeroDuration();
+      }
+    }
+
+    for (HloInstruction* y : x->users()) {
+      --incoming_edge_count[y];
+      if (incoming_edge_count[y] == 0) {
+        ready.push_back(y);
+      }
+    }
+  }
+}
+
+bool HasAllReduce(const HloComputation& computation) {
+  for (const HloInstruction* hlo : computation.instructions()) {
+    if (hlo->opcode() == HloOpcode::kAllReduce) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // end namespace
 
 GpuHloSchedule::GpuHloSchedule() {}
@@ -191,7 +332,7 @@ GpuHloSchedule::GpuHloSchedule() {}
 /* static */
 StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
     const HloModule& module, const StreamAssignment& stream_assignment,
-    int64 pointer_size) {
+    int64 pointer_size, const GpuDeviceInfo& device_info) {
   std::unique_ptr<GpuHloSchedule> schedule(new GpuHloSchedule);
 
   // Initialize thunk_launch_order_, the total order of thunk launches.
@@ -206,6 +347,12 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
               return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
             }));
     schedule->thunk_launch_order_ = sequence.instructions();
+  } else if (module.config()
+                 .debug_options()
+                 .xla_gpu_enable_async_all_reduce() &&
+             HasAllReduce(*entry_computation)) {
+    LatencyHidingLaunchOrder(entry_computation, device_info, pointer_size,
+                             &schedule->thunk_launch_order_);
   } else {
     // BFS tends to increase concurrency, but also increases memory usage.
     BFSLaunchOrder(entry_computation, &schedule->thunk_launch_order_);
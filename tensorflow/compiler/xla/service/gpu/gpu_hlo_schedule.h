@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
@@ -39,10 +40,12 @@ namespace gpu {
 class GpuHloSchedule {
  public:
   // Constructs an GpuHloSchedule for the given module, based on the given
-  // stream assignment.
+  // stream assignment. With async all-reduces, `device_info` is used to
+  // estimate the run times of the kernels that hide the all-reduces; the
+  // performance model assumes typical values for the fields that are 0.
   static StatusOr<std::unique_ptr<GpuHloSchedule>> Build(
       const HloModule& module, const StreamAssignment& stream_assignment,
-      int64 pointer_size);
+      int64 pointer_size, const GpuDeviceInfo& device_info = GpuDeviceInfo());
 
   // Returns the total order of thunk launches, represented in terms of HLO
   // instructions.
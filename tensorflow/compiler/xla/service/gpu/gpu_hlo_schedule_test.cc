@@ -401,5 +401,55 @@ TEST_F(GpuHloScheduleTest, LatticeMatMul) {
   }
 }
 
+// With async all-reduces, the independent kernels are launched before the user
+// of the all-reduce, which would make the compute stream wait. The
+// breadth-first order would launch the user before log and sqrt.
+TEST_F(GpuHloScheduleTest, AsyncAllReduceOverlapsIndependentKernels) {
+  HloModuleConfig config = GetModuleConfigForTest(/*replica_count=*/2);
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  debug_options.set_xla_gpu_enable_async_all_reduce(true);
+  config.set_debug_options(debug_options);
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  gradient = f32[1024,1024] exponential(p0)
+  all-reduce = f32[1024,1024] all-reduce(gradient), replica_groups={},
+      to_apply=add
+  update = f32[1024,1024] negate(all-reduce)
+  exp = f32[1024,1024] exponential(p1)
+  log = f32[1024,1024] log(exp)
+  sqrt = f32[1024,1024] sqrt(log)
+  ROOT tuple = (f32[1024,1024], f32[1024,1024]) tuple(update, sqrt)
+})",
+                                             config)
+                    .ValueOrDie();
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+  HloInstruction* all_reduce = FindInstruction(module.get(), "all-reduce");
+  HloInstruction* update = FindInstruction(module.get(), "update");
+  HloInstruction* sqrt = FindInstruction(module.get(), "sqrt");
+  EXPECT_NE(streams->StreamNumberForHlo(*all_reduce),
+            streams->StreamNumberForHlo(*update));
+  EXPECT_EQ(streams->StreamNumberForHlo(*update),
+            streams->StreamNumberForHlo(*sqrt));
+
+  auto schedule = BuildGpuHloSchedule(*module, *streams);
+  const HloVec& order = schedule->ThunkLaunchOrder();
+  auto position = [&](const HloInstruction* hlo) {
+    return std::find(order.begin(), order.end(), hlo) - order.begin();
+  };
+  EXPECT_LT(position(all_reduce), position(sqrt));
+  EXPECT_LT(position(sqrt), position(update));
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -0,0 +1,202 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/algorithm/container.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Used for the devices that don't report their properties. These are the
+// figures of a V100.
+constexpr double kDefaultMemoryBandwidth = 900e9;
+constexpr int kDefaultCoreCount = 80;
+constexpr double kDefaultClockRateGhz = 1.5;
+
+// Peak rate of a streaming multiprocessor: 64 fp32 FMA units per cycle.
+constexpr double kFlopsPerCyclePerCore = 128;
+
+// The special function units compute about one transcendental per cycle for
+// every four FMA units.
+constexpr double kFlopsPerTranscendental = 8;
+
+constexpr absl::Duration kKernelLaunchOverhead = absl::Microseconds(5);
+
+double MemoryBandwidth(const GpuDeviceInfo& device_info) {
+  return device_info.memory_bandwidth > 0 ? device_info.memory_bandwidth
+                                          : kDefaultMemoryBandwidth;
+}
+
+double FlopsPerSecond(const GpuDeviceInfo& device_info) {
+  const int core_count = device_info.core_count > 0 ? device_info.core_count
+                                                    : kDefaultCoreCount;
+  const double clock_rate_ghz = device_info.clock_rate_ghz > 0
+                                    ? device_info.clock_rate_ghz
+                                    : kDefaultClockRateGhz;
+  return core_count * clock_rate_ghz * 1e9 * kFlopsPerCyclePerCore;
+}
+
+int64 ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+}
+
+// Instructions that the GPU backend doesn't emit kernels for.
+bool RunsWithoutKernel(const HloInstruction& instruction) {
+  switch (instruction.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Runs HloCostAnalysis on `instruction` alone, rather than on the whole
+// computation, because the fusion passes change the computation between the
+// estimates.
+StatusOr<std::unique_ptr<HloCostAnalysis>> AnalyzeInstruction(
+    const HloInstruction* instruction) {
+  auto cost_analysis = absl::make_unique<HloCostAnalysis>(ShapeSize);
+  TF_RETURN_IF_ERROR(cost_analysis->Preprocess(instruction));
+  // Visit() doesn't modify the instruction.
+  TF_RETURN_IF_ERROR(
+      const_cast<HloInstruction*>(instruction)->Visit(cost_analysis.get()));
+  TF_RETURN_IF_ERROR(cost_analysis->Postprocess(instruction));
+  return std::move(cost_analysis);
+}
+
+double Flops(const HloCostAnalysis& cost_analysis,
+             const HloInstruction& instruction) {
+  return cost_analysis.flop_count(instruction) +
+         cost_analysis.transcendental_count(instruction) *
+             kFlopsPerTranscendental;
+}
+
+absl::Duration KernelTime(double bytes, double flops,
+                          const GpuDeviceInfo& device_info) {
+  const double seconds =
+      std::max(std::max(bytes, 0.0) / MemoryBandwidth(device_info),
+               flops / FlopsPerSecond(device_info));
+  return kKernelLaunchOverhead + absl::Seconds(seconds);
+}
+
+}  // namespace
+
+/*static*/ StatusOr<absl::Duration> GpuPerformanceModel::EstimateRunTime(
+    const HloInstruction* instruction, const GpuDeviceInfo& device_info) {
+  if (RunsWithoutKernel(*instruction)) {
+    return absl::ZeroDuration();
+  }
+  if (IsCublasGemm(*instruction)) {
+    // HloCostAnalysis doesn't know what custom calls do, so count the flops of
+    // the dot the gemm computes.
+    TF_ASSIGN_OR_RETURN(GemmBackendConfig config,
+                        instruction->backend_config<GemmBackendConfig>());
+    const Shape& lhs_shape = instruction->operand(0)->shape();
+    int64 contracted_elements = 1;
+    for (int64 dimension :
+         config.dot_dimension_numbers().lhs_contracting_dimensions()) {
+      contracted_elements *= lhs_shape.dimensions(dimension);
+    }
+    double bytes = ShapeSize(instruction->shape());
+    for (const HloInstruction* operand : instruction->operands()) {
+      bytes += ShapeSize(operand->shape());
+    }
+    return KernelTime(bytes,
+                      2.0 * ShapeUtil::ElementsIn(instruction->shape()) *
+                          contracted_elements,
+                      device_info);
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloCostAnalysis> cost_analysis,
+                      AnalyzeInstruction(instruction));
+  return KernelTime(cost_analysis->bytes_accessed(*instruction),
+                    Flops(*cost_analysis, *instruction), device_info);
+}
+
+/*static*/ StatusOr<GpuPerformanceModel::RunTimes>
+GpuPerformanceModel::EstimateRunTimes(
+    const HloInstruction* producer, const GpuDeviceInfo& device_info,
+    absl::Span<const HloInstruction* const> fused_users) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloCostAnalysis> producer_analysis,
+                      AnalyzeInstruction(producer));
+  const double producer_output_bytes =
+      producer_analysis->output_bytes_accessed(*producer);
+  const double producer_input_bytes =
+      producer_analysis->bytes_accessed(*producer) - producer_output_bytes;
+  const double producer_flops = Flops(*producer_analysis, *producer);
+  const absl::Duration producer_time =
+      RunsWithoutKernel(*producer)
+          ? absl::ZeroDuration()
+          : KernelTime(producer_analysis->bytes_accessed(*producer),
+                       producer_flops, device_info);
+
+  RunTimes run_times{producer_time, absl::ZeroDuration()};
+  for (const HloInstruction* user : fused_users) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<HloCostAnalysis> user_analysis,
+                        AnalyzeInstruction(user));
+    const double user_bytes = user_analysis->bytes_accessed(*user);
+    const double user_flops = Flops(*user_analysis, *user);
+    run_times.time_unfused += KernelTime(user_bytes, user_flops, device_info);
+
+    // After the fusion, the user computes the part of the producer it reads
+    // instead of reading it, which costs it the corresponding part of the
+    // inputs and flops of the producer.
+    double bytes_read_from_producer = 0;
+    for (int64 operand_index : user->OperandIndices(producer)) {
+      bytes_read_from_producer +=
+          user_analysis->operand_bytes_accessed(*user, operand_index);
+    }
+    const double fraction_of_producer =
+        producer_output_bytes > 0
+            ? bytes_read_from_producer / producer_output_bytes
+            : 1.0;
+    run_times.time_fused += KernelTime(
+        user_bytes - bytes_read_from_producer +
+            fraction_of_producer * producer_input_bytes,
+        user_flops + fraction_of_producer * producer_flops, device_info);
+  }
+  if (absl::c_any_of(producer->users(), [&](const HloInstruction* user) {
+        return !absl::c_linear_search(fused_users, user);
+      })) {
+    run_times.time_fused += producer_time;
+  }
+  return run_times;
+}
+
+/*static*/ void GpuPerformanceModel::SetCostAnalysisRates(
+    const GpuDeviceInfo& device_info, HloCostAnalysis* cost_analysis) {
+  cost_analysis->set_bytes_per_second(MemoryBandwidth(device_info));
+  cost_analysis->set_flops_per_second(FlopsPerSecond(device_info));
+  cost_analysis->set_transcendentals_per_second(FlopsPerSecond(device_info) /
+                                                kFlopsPerTranscendental);
+}
+
+}  // namespace gpu
+}  // namespace xla
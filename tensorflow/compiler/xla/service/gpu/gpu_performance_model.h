@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_PERFORMANCE_MODEL_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_PERFORMANCE_MODEL_H_
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace gpu {
+
+// Estimates the run time of GPU kernels with a roofline model: a kernel takes
+// its launch overhead plus the larger of the time to move the bytes it
+// accesses at the memory bandwidth of the device, and the time to do its flops
+// at the peak rate of the device. The bytes and flops come from
+// HloCostAnalysis.
+class GpuPerformanceModel {
+ public:
+  struct RunTimes {
+    absl::Duration time_unfused;
+    absl::Duration time_fused;
+  };
+
+  // Estimates the run time of `producer` and `fused_users` as separate
+  // kernels, and the run time after fusing `producer` into each of
+  // `fused_users`. `producer` keeps running as a kernel of its own after the
+  // fusion if it has users that aren't in `fused_users`.
+  static StatusOr<RunTimes> EstimateRunTimes(
+      const HloInstruction* producer, const GpuDeviceInfo& device_info,
+      absl::Span<const HloInstruction* const> fused_users);
+
+  // Estimates the run time of `instruction` as a kernel of its own.
+  static StatusOr<absl::Duration> EstimateRunTime(
+      const HloInstruction* instruction, const GpuDeviceInfo& device_info);
+
+  // Sets the rates of `cost_analysis` to those of the model, so that its
+  // optimal seconds are the predictions of the model without the launch
+  // overheads.
+  static void SetCostAnalysisRates(const GpuDeviceInfo& device_info,
+                                   HloCostAnalysis* cost_analysis);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_PERFORMANCE_MODEL_H_
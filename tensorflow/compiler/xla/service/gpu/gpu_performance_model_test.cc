@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+
+#include "absl/time/time.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class GpuPerformanceModelTest : public HloTestBase {
+ protected:
+  GpuPerformanceModelTest() {
+    device_info_.core_count = 80;
+    device_info_.memory_bandwidth = 900e9;
+    device_info_.clock_rate_ghz = 1.5;
+  }
+
+  GpuDeviceInfo device_info_;
+};
+
+TEST_F(GpuPerformanceModelTest, FusingElementwiseProducerIsFaster) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  exp = f32[1024,1024] exponential(p0)
+  ROOT add = f32[1024,1024] add(exp, p1)
+})")
+                    .ValueOrDie();
+  const HloInstruction* add = module->entry_computation()->root_instruction();
+  const HloInstruction* exp = add->operand(0);
+
+  auto run_times =
+      GpuPerformanceModel::EstimateRunTimes(exp, device_info_, {add});
+  TF_ASSERT_OK(run_times.status());
+  EXPECT_LT(run_times.ValueOrDie().time_fused,
+            run_times.ValueOrDie().time_unfused);
+}
+
+TEST_F(GpuPerformanceModelTest, FusingProducerWithOtherUsersIsSlower) {
+  // The producer still runs for the tuple after the fusion, and the fused add
+  // reads both of its inputs instead of its output.
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  p2 = f32[1024,1024] parameter(2)
+  producer = f32[1024,1024] add(p0, p1)
+  consumer = f32[1024,1024] add(producer, p2)
+  ROOT tuple = (f32[1024,1024], f32[1024,1024]) tuple(producer, consumer)
+})")
+                    .ValueOrDie();
+  const HloInstruction* consumer =
+      module->entry_computation()->root_instruction()->operand(1);
+  const HloInstruction* producer = consumer->operand(0);
+
+  auto run_times =
+      GpuPerformanceModel::EstimateRunTimes(producer, device_info_, {consumer});
+  TF_ASSERT_OK(run_times.status());
+  EXPECT_GT(run_times.ValueOrDie().time_fused,
+            run_times.ValueOrDie().time_unfused);
+}
+
+TEST_F(GpuPerformanceModelTest, InstructionsWithoutKernelsAreFree) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[16,16] parameter(0)
+  ROOT bitcast = f32[256] bitcast(p0)
+})")
+                    .ValueOrDie();
+  auto run_time = GpuPerformanceModel::EstimateRunTime(
+      module->entry_computation()->root_instruction(), device_info_);
+  TF_ASSERT_OK(run_time.status());
+  EXPECT_EQ(run_time.ValueOrDie(), absl::ZeroDuration());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -110,7 +110,7 @@ StatusOr<InfeedBuffer> GpuTransferManager::TransferBufferToInfeedInternal(
     return InternalError("Failed to obtain a stream");
   }
 
-  InfeedBuffer buffer(executor, size);
+  InfeedBuffer buffer = infeed_manager->AcquireBuffer(executor, size);
   stream->ThenMemcpy(buffer.device_memory(), source, size);
 
   VLOG(2) << "Queued infeed data on stream " << stream;
@@ -176,6 +176,23 @@ Status GpuTransferManager::TransferLiteralFromOutfeed(
   return Status::OK();
 }
 
+StatusOr<TransferManager::XfeedQueueStats>
+GpuTransferManager::GetXfeedQueueStats(se::StreamExecutor* /*executor*/) {
+  // The GPU infeed and outfeed managers are shared by all the devices.
+  const InfeedManager::Stats infeed_stats =
+      gpu::GetOrCreateInfeedManager()->GetStats();
+  const OutfeedManager::Stats outfeed_stats =
+      gpu::GetOrCreateOutfeedManager()->GetStats();
+  XfeedQueueStats stats;
+  stats.infeed_queue_depth = infeed_stats.depth;
+  stats.infeed_dequeue_count = infeed_stats.dequeue_count;
+  stats.infeed_wait_micros = infeed_stats.wait_micros;
+  stats.outfeed_queue_depth = outfeed_stats.depth;
+  stats.outfeed_dequeue_count = outfeed_stats.dequeue_count;
+  stats.outfeed_wait_micros = outfeed_stats.wait_micros;
+  return stats;
+}
+
 }  // namespace gpu
 }  // namespace xla
 
@@ -43,10 +43,12 @@ class GpuTransferManager : public GenericTransferManager {
   Status TransferLiteralFromOutfeed(se::StreamExecutor* executor,
                                     const Shape& literal_shape,
                                     MutableBorrowingLiteral literal) override;
+  StatusOr<XfeedQueueStats> GetXfeedQueueStats(
+      se::StreamExecutor* executor) override;
 
  private:
-  // Initiates the infeed data transfers. InfeedBuffer->Done() must be
-  // called to clean up the memory allocated for InfeedBuffer.
+  // Initiates the infeed data transfers. The InfeedBuffer is taken from the
+  // infeed manager, which reuses the buffers of consumed infeeds.
   StatusOr<InfeedBuffer> TransferBufferToInfeedInternal(
       se::StreamExecutor* executor, int64 size, const void* source);
 
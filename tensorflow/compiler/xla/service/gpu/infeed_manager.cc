@@ -15,11 +15,22 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/infeed_manager.h"
 
+#include <utility>
+
 #include "absl/memory/memory.h"
 
 namespace xla {
 namespace gpu {
 
+namespace {
+
+// Number of released buffers of each length kept for reuse: enough for the
+// host to fill the buffers of the next infeed while the device consumes the
+// current one.
+constexpr int kMaxFreeBuffersPerLength = 2;
+
+}  // namespace
+
 se::Stream* InfeedManager::GetStream(se::StreamExecutor* executor) {
   tensorflow::mutex_lock l(host_to_device_stream_mu_);
   if (host_to_device_executor_ == nullptr) {
@@ -37,6 +48,44 @@ se::Stream* InfeedManager::GetStream(se::StreamExecutor* executor) {
   return host_to_device_stream_.get();
 }
 
+InfeedBuffer InfeedManager::AcquireBuffer(se::StreamExecutor* executor,
+                                          int64 length) {
+  // Buffers in excess of kMaxFreeBuffersPerLength are freed here, after the
+  // lock is released, rather than in ReleaseBuffers(), which may be running on
+  // a stream callback where freeing device memory is not allowed.
+  std::vector<InfeedBuffer> excess_buffers;
+  {
+    tensorflow::mutex_lock l(free_buffers_mu_);
+    auto it = free_buffers_.find(length);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      std::vector<InfeedBuffer>& buffers = it->second;
+      InfeedBuffer buffer = std::move(buffers.back());
+      buffers.pop_back();
+      while (buffers.size() > kMaxFreeBuffersPerLength) {
+        excess_buffers.push_back(std::move(buffers.back()));
+        buffers.pop_back();
+      }
+      return buffer;
+    }
+  }
+  return InfeedBuffer(executor, length);
+}
+
+void InfeedManager::ReleaseBuffers(ShapeTree<InfeedBuffer> buffers) {
+  std::vector<InfeedBuffer> released_buffers;
+  buffers.ForEachMutableElement(
+      [&](const ShapeIndex& /*index*/, InfeedBuffer* buffer) {
+        // Tuple index buffers are never allocated.
+        if (!buffer->device_memory()->is_null()) {
+          released_buffers.push_back(std::move(*buffer));
+        }
+      });
+  tensorflow::mutex_lock l(free_buffers_mu_);
+  for (InfeedBuffer& buffer : released_buffers) {
+    free_buffers_[buffer.length()].push_back(std::move(buffer));
+  }
+}
+
 InfeedManager* GetOrCreateInfeedManager() {
   static InfeedManager* manager = new InfeedManager;
   return manager;
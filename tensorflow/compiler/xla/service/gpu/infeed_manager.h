@@ -20,7 +20,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INFEED_MANAGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INFEED_MANAGER_H_
 
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/xla/service/gpu/xfeed_queue.h"
 #include "tensorflow/compiler/xla/shape_tree.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -36,10 +39,11 @@ namespace gpu {
 // Current limitations:
 // * Does not handle multiple devices/replicas.
 //
-// * Buffer space on GPU is allocated on every infeed enqueue request,
-// and it does not handle the case when it runs out of
-// memory. Potential solution is to pre-allocate a fixed amount of
-// memory and block when that memory is full.
+// * Buffer space on GPU is allocated on infeed enqueue requests that
+// cannot reuse the buffer of an earlier infeed, and it does not handle
+// the case when it runs out of memory. Potential solution is to
+// pre-allocate a fixed amount of memory and block when that memory is
+// full.
 
 // Defines an infeed buffer that is passed to the runtime by
 // the client. The client manages the memory of the buffer.
@@ -58,7 +62,7 @@ class InfeedBuffer {
 
  private:
   se::ScopedDeviceMemory<uint8> device_memory_;
-  int64 length_;
+  int64 length_ = 0;
 };
 
 // Client-side class used to enqueue infeed buffers.
@@ -70,6 +74,18 @@ class InfeedManager : public XfeedQueue<ShapeTree<InfeedBuffer>> {
   // returns null.
   se::Stream* GetStream(se::StreamExecutor* executor);
 
+  // Returns a buffer of `length` bytes on `executor`, reusing a buffer of
+  // that length returned by ReleaseBuffers() if there is one. A training loop
+  // infeeding the same shapes at every step thus allocates its buffers once,
+  // rather than allocating and freeing device memory at every step. `executor`
+  // must be the executor of the cached stream.
+  InfeedBuffer AcquireBuffer(se::StreamExecutor* executor, int64 length);
+
+  // Returns the buffers of an infeed to the manager for reuse, once the device
+  // no longer reads them. This does not call into the StreamExecutor, so it
+  // may be called from a stream callback.
+  void ReleaseBuffers(ShapeTree<InfeedBuffer> buffers);
+
  private:
   // Mutex for serializing the creation of host_to_device_stream_.
   tensorflow::mutex host_to_device_stream_mu_;
@@ -80,6 +96,12 @@ class InfeedManager : public XfeedQueue<ShapeTree<InfeedBuffer>> {
 
   // Executor that the host_to_device_stream belongs to. Not owned.
   se::StreamExecutor* host_to_device_executor_ = nullptr;
+
+  tensorflow::mutex free_buffers_mu_;
+
+  // Buffers released by earlier infeeds, keyed by length.
+  absl::flat_hash_map<int64, std::vector<InfeedBuffer>> free_buffers_
+      ABSL_GUARDED_BY(free_buffers_mu_);
 };
 
 // Singleton creator-or-accessor: Returns the GPU infeed manager.
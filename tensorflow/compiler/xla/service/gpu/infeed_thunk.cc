@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/xla/service/gpu/infeed_thunk.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
 #include "tensorflow/compiler/xla/service/gpu/infeed_manager.h"
 #include "tensorflow/compiler/xla/util.h"
@@ -89,12 +94,15 @@ Status InfeedThunk::ExecuteOnStream(const ExecuteParams& params) {
 
           // Create a buffer of pointers for non-leaf buffers.
           CHECK_EQ(tuple_element_count, inner_tuple_element_addresses.size());
-          auto host_size = inner_tuple_element_addresses.size() * sizeof(void*);
+          auto tuple_data = absl::make_unique<void*[]>(tuple_element_count);
+          std::copy(inner_tuple_element_addresses.begin(),
+                    inner_tuple_element_addresses.end(), tuple_data.get());
           se::DeviceMemoryBase tuple_address =
               buffer_allocations.GetDeviceAddress(
                   infeed_slices_.element(index));
-          stream.ThenMemcpy(&tuple_address,
-                            inner_tuple_element_addresses.data(), host_size);
+          SafeH2DMemcpy(se::DeviceMemory<void*>(tuple_address),
+                        std::move(tuple_data), tuple_element_count, &stream,
+                        params.deferred_host_callbacks);
           tuple_element_addresses->push_back(tuple_address.opaque());
         };
 
@@ -107,18 +115,25 @@ Status InfeedThunk::ExecuteOnStream(const ExecuteParams& params) {
   // a nullptr for the token, it should never be dereferenced.
   se::DeviceMemoryBase data_address =
       buffer_allocations.GetDeviceAddress(infeed_slices_.element({0}));
-  void* infeed_addresses[] = {data_address.opaque(), nullptr};
+  auto infeed_addresses = absl::make_unique<void*[]>(2);
+  infeed_addresses[0] = data_address.opaque();
+  infeed_addresses[1] = nullptr;
   se::DeviceMemoryBase top_level_address =
       buffer_allocations.GetDeviceAddress(infeed_slices_.element({}));
-  stream.ThenMemcpy(&top_level_address, infeed_addresses, 2 * sizeof(void*));
-
-  Status block_status = stream.BlockHostUntilDone();
-  if (!block_status.ok()) {
-    return InternalError("Failed to complete data transfer on stream %p: %s",
-                         &stream, block_status.error_message());
-  }
-
-  VLOG(2) << "Infeeding to GPU complete";
+  SafeH2DMemcpy(se::DeviceMemory<void*>(top_level_address),
+                std::move(infeed_addresses), 2, &stream,
+                params.deferred_host_callbacks);
+
+  // Rather than blocking the host until the copies out of the infeed buffers
+  // complete, hand the buffers back to the infeed manager for reuse once they
+  // do. This lets the host keep enqueueing work while the device copies.
+  auto consumed_buffers =
+      std::make_shared<ShapeTree<InfeedBuffer>>(std::move(infeed_buffers));
+  stream.ThenDoHostCallback([consumed_buffers]() {
+    GetOrCreateInfeedManager()->ReleaseBuffers(std::move(*consumed_buffers));
+  });
+
+  VLOG(2) << "Infeeding to GPU enqueued";
   return Status::OK();
 }
 
@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/hlo_query.h"
@@ -97,24 +99,52 @@ bool GpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
             << consumer->ToString() << ") would be too large";
     return false;
   }
-  if (consumer->opcode() != HloOpcode::kFusion) {
-    return true;
+  if (consumer->opcode() == HloOpcode::kFusion) {
+    // Also check that our emitter can handle the fusion node. We currently can
+    // have exponential time/memory requirements for emitting certain fusion
+    // kernels, in which case we don't want to fuse.
+    // TODO(b/119692968): Remove this once we have fixed our fusion emitter.
+    if (fusion_node_evaluations_.find(consumer) ==
+        fusion_node_evaluations_.end()) {
+      // We have no cached results for this fusion node yet. This can happen
+      // when we run the InstructionFusion pass more than once. We can only
+      // cache the results within one run.
+      fusion_node_evaluations_.emplace(consumer,
+                                       FusionNodeIndexingEvaluation(consumer));
+    }
+    if (fusion_node_evaluations_.at(consumer).CodeDuplicationTooHigh(
+            producer)) {
+      VLOG(5) << "Fusion of " << producer->name() << " into "
+              << consumer->name()
+              << " would result in overly large code duplication.";
+      return false;
+    }
+  }
+  if (device_info_.has_value() &&
+      !FusionIsFasterWithCostModel(consumer, operand_index)) {
+    return false;
   }
-  // Also check that our emitter can handle the fusion node. We currently can
-  // have exponential time/memory requirements for emitting certain fusion
-  // kernels, in which case we don't want to fuse.
-  // TODO(b/119692968): Remove this once we have fixed our fusion emitter.
-  if (fusion_node_evaluations_.find(consumer) ==
-      fusion_node_evaluations_.end()) {
-    // We have no cached results for this fusion node yet. This can happen when
-    // we run the InstructionFusion pass more than once. We can only cache the
-    // results within one run.
-    fusion_node_evaluations_.emplace(consumer,
-                                     FusionNodeIndexingEvaluation(consumer));
+  return true;
+}
+
+bool GpuInstructionFusion::FusionIsFasterWithCostModel(HloInstruction* consumer,
+                                                       int64 operand_index) {
+  const HloInstruction* producer = consumer->operand(operand_index);
+  StatusOr<GpuPerformanceModel::RunTimes> run_times =
+      GpuPerformanceModel::EstimateRunTimes(producer, *device_info_,
+                                            {consumer});
+  if (!run_times.ok()) {
+    // Fall back to the heuristics for the instructions the cost analysis
+    // can't handle.
+    VLOG(5) << "No estimate of the fusion of " << producer->name() << " into "
+            << consumer->name() << ": " << run_times.status();
+    return true;
   }
-  if (fusion_node_evaluations_.at(consumer).CodeDuplicationTooHigh(producer)) {
+  if (run_times->time_fused > run_times->time_unfused) {
     VLOG(5) << "Fusion of " << producer->name() << " into " << consumer->name()
-            << " would result in overly large code duplication.";
+            << " is estimated to take "
+            << absl::FormatDuration(run_times->time_fused) << " instead of "
+            << absl::FormatDuration(run_times->time_unfused);
     return false;
   }
   return true;
@@ -17,17 +17,24 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
 
 namespace xla {
 namespace gpu {
 
+// If `device_info` is given, the fusions that GpuPerformanceModel predicts to
+// be slower than the unfused instructions are rejected as well.
 class GpuInstructionFusion : public InstructionFusion {
  public:
-  explicit GpuInstructionFusion(bool may_duplicate)
-      : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate) {}
+  explicit GpuInstructionFusion(
+      bool may_duplicate,
+      absl::optional<GpuDeviceInfo> device_info = absl::nullopt)
+      : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate),
+        device_info_(device_info) {}
 
   static bool IsExpensive(const HloInstruction& instruction);
 
@@ -53,6 +60,13 @@ class GpuInstructionFusion : public InstructionFusion {
   HloInstruction* FuseInstruction(HloInstruction* fusion_instruction,
                                   HloInstruction* producer) override;
 
+  // Returns true if GpuPerformanceModel predicts that fusing the operand
+  // `operand_index` into `consumer` is faster. REQUIRES: device_info_ is set.
+  bool FusionIsFasterWithCostModel(HloInstruction* consumer,
+                                   int64 operand_index);
+
+  absl::optional<GpuDeviceInfo> device_info_;
+
   // Keep track of the number of times each instruction inside a fusion node is
   // indexed with different index vectors.
   absl::flat_hash_map<const HloInstruction*, FusionNodeIndexingEvaluation>
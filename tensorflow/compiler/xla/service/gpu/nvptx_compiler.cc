@@ -20,6 +20,7 @@ limitations under the License.
 #include <fstream>
 
 #include "absl/base/call_once.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_gemm_pad_for_tensor_cores.h"
@@ -40,15 +41,19 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
+#include "tensorflow/compiler/xla/service/persistent_compilation_cache.h"
 #include "tensorflow/compiler/xla/service/tuple_simplifier.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/cuda_libdevice_path.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/stream_executor/cuda/cuda_diagnostics.h"
 #include "tensorflow/stream_executor/gpu/asm_compiler.h"
 
@@ -272,6 +277,47 @@ bool MaybeLoadPtxFromFile(const HloModule* module, std::string* ptx) {
   return false;
 }
 
+// Returns the key of the persistent cache entry holding the PTX and cubin
+// compiled from the unoptimized `llvm_module`.
+string PersistentCacheKey(const llvm::Module& llvm_module,
+                          std::pair<int, int> compute_capability,
+                          const string& libdevice_dir,
+                          DebugOptions debug_options) {
+  // The cache settings don't change what is compiled.
+  debug_options.clear_xla_gpu_persistent_cache_dir();
+  debug_options.clear_xla_gpu_persistent_cache_max_bytes();
+  string serialized_options;
+  tensorflow::SerializeToStringDeterministic(debug_options,
+                                             &serialized_options);
+  // The version of LLVM isn't part of the module, so key on the build too.
+  return absl::StrCat(tf_git_version(), "\n", compute_capability.first, ".",
+                      compute_capability.second, "\n", libdevice_dir, "\n",
+                      serialized_options, "\n",
+                      llvm_ir::DumpModuleToString(llvm_module));
+}
+
+string EncodePtxAndCubin(const string& ptx, const std::vector<uint8>& cubin) {
+  string encoded;
+  tensorflow::core::PutVarint64(&encoded, ptx.size());
+  absl::StrAppend(&encoded, ptx,
+                  absl::string_view(reinterpret_cast<const char*>(cubin.data()),
+                                    cubin.size()));
+  return encoded;
+}
+
+bool DecodePtxAndCubin(absl::string_view encoded, string* ptx,
+                       std::vector<uint8>* cubin) {
+  uint64 ptx_size;
+  if (!tensorflow::core::GetVarint64(&encoded, &ptx_size) ||
+      ptx_size > encoded.size()) {
+    return false;
+  }
+  *ptx = string(encoded.substr(0, ptx_size));
+  encoded.remove_prefix(ptx_size);
+  cubin->assign(encoded.begin(), encoded.end());
+  return true;
+}
+
 }  // namespace
 
 NVPTXCompiler::NVPTXCompiler()
@@ -317,6 +363,35 @@ NVPTXCompiler::CompileTargetBinary(const HloModule* module,
   }
   VLOG(2) << "Libdevice dir = " << libdevice_dir << "\n";
 
+  // The key has to be computed before CompileToPtx optimizes `llvm_module`
+  // in place. Modules loaded from PTX files or seen by the user hook always
+  // take the regular path.
+  const DebugOptions& debug_options = module->config().debug_options();
+  PersistentCompilationCache* persistent_cache = nullptr;
+  string persistent_cache_key;
+  if (!debug_options.xla_gpu_persistent_cache_dir().empty() &&
+      debug_options.xla_gpu_ptx_file().empty() &&
+      !user_post_optimization_hook_) {
+    persistent_cache = PersistentCompilationCache::Get(
+        debug_options.xla_gpu_persistent_cache_dir(),
+        debug_options.xla_gpu_persistent_cache_max_bytes());
+    persistent_cache_key = PersistentCacheKey(*llvm_module, compute_capability,
+                                              libdevice_dir, debug_options);
+    if (absl::optional<string> entry =
+            persistent_cache->Lookup(persistent_cache_key)) {
+      std::pair<std::string, std::vector<uint8>> ptx_and_cubin;
+      if (DecodePtxAndCubin(*entry, &ptx_and_cubin.first,
+                            &ptx_and_cubin.second)) {
+        VLOG(1) << "Loaded " << module->name() << " from the persistent "
+                << "compilation cache in " << persistent_cache->dir();
+        if (DumpingEnabledForHloModule(*module)) {
+          DumpToFileInDirOrStdout(*module, "", "ptx", ptx_and_cubin.first);
+        }
+        return ptx_and_cubin;
+      }
+    }
+  }
+
   string ptx;
   if (!MaybeLoadPtxFromFile(module, &ptx)) {
     XLA_SCOPED_LOGGING_TIMER(
@@ -340,6 +415,17 @@ NVPTXCompiler::CompileTargetBinary(const HloModule* module,
       stream_exec, ptx, compute_capability.first, compute_capability.second,
       module->config());
 
+  // An empty cubin means the driver compiles the PTX, which isn't worth
+  // caching.
+  if (persistent_cache != nullptr && !cubin.empty()) {
+    Status status = persistent_cache->Insert(persistent_cache_key,
+                                             EncodePtxAndCubin(ptx, cubin));
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write " << module->name()
+                   << " to the persistent compilation cache: " << status;
+    }
+  }
+
   return std::pair<std::string, std::vector<uint8>>(std::move(ptx),
                                                     std::move(cubin));
 }
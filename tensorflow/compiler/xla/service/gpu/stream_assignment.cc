@@ -62,11 +62,13 @@ inline bool IsStreamNumValid(int stream_num) {
 // Returns which existing stream to assign to `hlo`, or -1 if a stream is not
 // needed. `stream_assignment` is the existing stream assignment for all
 // instructions topologically before `hlo`. `seen_gemms` contains all GEMMs that
-// are topologically before `hlo`.
+// are topologically before `hlo`. `stream_num_for_all_reduce` is the stream
+// reserved for all-reduces, if any, which no other instruction is assigned.
 int ComputeStreamToAssign(
     const HloInstruction& hlo, const StreamAssignment& stream_assignment,
     const HloReachabilityMap& reachability,
-    const std::vector<const HloInstruction*>& seen_gemms) {
+    const std::vector<const HloInstruction*>& seen_gemms,
+    int stream_num_for_all_reduce) {
   if (hlo.opcode() == HloOpcode::kParameter ||
       hlo.opcode() == HloOpcode::kConstant) {
     // kParameter and kConstant do not need a thunk.
@@ -89,7 +91,9 @@ int ComputeStreamToAssign(
     // avoid excessive synchronization.
     int stream_num = -1;
     for (const auto* operand : hlo.operands()) {
-      if (stream_assignment.HasStreamAssigned(*operand)) {
+      if (stream_assignment.HasStreamAssigned(*operand) &&
+          stream_assignment.StreamNumberForHlo(*operand) !=
+              stream_num_for_all_reduce) {
         stream_num = std::max(stream_num,
                               stream_assignment.StreamNumberForHlo(*operand));
       }
@@ -105,6 +109,9 @@ int ComputeStreamToAssign(
   // streams assigned to GEMMs that are concurrent with `hlo`. Then, we assign
   // `hlo` a different stream.
   absl::flat_hash_set<int> forbidden_stream_numbers;
+  if (IsStreamNumValid(stream_num_for_all_reduce)) {
+    forbidden_stream_numbers.insert(stream_num_for_all_reduce);
+  }
   for (const auto* seen_gemm : seen_gemms) {
     int stream_num = stream_assignment.StreamNumberForHlo(*seen_gemm);
     if (!forbidden_stream_numbers.contains(stream_num) &&
@@ -137,14 +144,32 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   // TODO(b/111791052): If we remove such a common variable, we will need to
   // clean up the code here.
   int stream_num_for_rng = kInvalidStreamNum;
+  // With async all-reduces, all the all-reduces run in order on a stream of
+  // their own, so that compute kernels can run while they wait for the other
+  // replicas. Keeping them on one stream also keeps the order of the
+  // collectives the same on all replicas.
+  const auto& debug_options = module.config().debug_options();
+  const bool async_all_reduce =
+      debug_options.xla_gpu_enable_async_all_reduce() &&
+      !debug_options.xla_gpu_disable_multi_streaming();
+  int stream_num_for_all_reduce = kInvalidStreamNum;
   for (const auto* hlo : computation.MakeInstructionPostOrder()) {
+    int stream_num;
     // If we ever enable fusion of RNG instructions, we will need to extend this
     // code to look inside a fused instruction.
-    int stream_num = (hlo->opcode() == HloOpcode::kRng &&
-                      IsStreamNumValid(stream_num_for_rng))
-                         ? stream_num_for_rng
-                         : ComputeStreamToAssign(*hlo, *stream_assignment,
-                                                 *reachability, seen_gemms);
+    if (hlo->opcode() == HloOpcode::kRng &&
+        IsStreamNumValid(stream_num_for_rng)) {
+      stream_num = stream_num_for_rng;
+    } else if (async_all_reduce && hlo->opcode() == HloOpcode::kAllReduce) {
+      if (!IsStreamNumValid(stream_num_for_all_reduce)) {
+        stream_num_for_all_reduce = stream_assignment->StreamCount();
+      }
+      stream_num = stream_num_for_all_reduce;
+    } else {
+      stream_num =
+          ComputeStreamToAssign(*hlo, *stream_assignment, *reachability,
+                                seen_gemms, stream_num_for_all_reduce);
+    }
     if (IsStreamNumValid(stream_num)) {
       stream_assignment->AssignStreamToHlo(hlo, stream_num);
       if (hlo->opcode() == HloOpcode::kRng &&
@@ -21,9 +21,11 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace xla {
 namespace gpu {
@@ -56,11 +58,18 @@ class XfeedQueue {
     BufferType current_buffer;
     {
       tensorflow::mutex_lock l(mu_);
-      while (enqueued_buffers_.empty()) {
-        cv_.wait(l);
+      if (enqueued_buffers_.empty()) {
+        const tensorflow::uint64 wait_start_micros =
+            tensorflow::Env::Default()->NowMicros();
+        while (enqueued_buffers_.empty()) {
+          cv_.wait(l);
+        }
+        wait_micros_ +=
+            tensorflow::Env::Default()->NowMicros() - wait_start_micros;
       }
       current_buffer = std::move(enqueued_buffers_.front());
       enqueued_buffers_.pop_front();
+      ++dequeue_count_;
       became_empty = enqueued_buffers_.empty();
     }
     if (became_empty) {
@@ -71,6 +80,26 @@ class XfeedQueue {
     return current_buffer;
   }
 
+  // Counters of the queue, for monitoring whether its consumer is starved.
+  struct Stats {
+    // Number of buffers in the queue.
+    tensorflow::int64 depth = 0;
+    // Number of buffers returned by BlockingGetNextDestination() so far.
+    tensorflow::int64 dequeue_count = 0;
+    // Total time BlockingGetNextDestination() waited for the queue to become
+    // non-empty.
+    tensorflow::int64 wait_micros = 0;
+  };
+
+  Stats GetStats() {
+    tensorflow::mutex_lock l(mu_);
+    Stats stats;
+    stats.depth = enqueued_buffers_.size();
+    stats.dequeue_count = dequeue_count_;
+    stats.wait_micros = wait_micros_;
+    return stats;
+  }
+
   void RegisterOnEmptyCallback(std::function<void()> callback) {
     on_empty_callbacks_.push_back(std::move(callback));
   }
@@ -88,6 +117,9 @@ class XfeedQueue {
   // The queue of trees of buffers. Buffer* queue contents are not owned.
   std::deque<BufferType> enqueued_buffers_ ABSL_GUARDED_BY(mu_);
 
+  tensorflow::int64 dequeue_count_ ABSL_GUARDED_BY(mu_) = 0;
+  tensorflow::int64 wait_micros_ ABSL_GUARDED_BY(mu_) = 0;
+
   // List of callbacks which will be called when 'enqueued_buffers_' becomes
   // empty.
   std::vector<std::function<void()>> on_empty_callbacks_;
@@ -21,14 +21,19 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
+#include "tensorflow/compiler/xla/service/hlo_casting_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_evaluator.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/hlo_query.h"
+#include "tensorflow/compiler/xla/service/slow_operation_alarm.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -63,11 +68,62 @@ static bool IsOrContainsIllegalInstr(const HloInstruction* instr) {
   return false;
 }
 
+// Returns a rough count of the scalar operations HloEvaluator performs to
+// evaluate `instr`: one per output element, times the number of operand
+// elements combined into each of them for the instructions that contract or
+// reduce their operands.
+static int64 EstimateEvaluationCost(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kDot: {
+      const Shape& lhs_shape = instr->operand(0)->shape();
+      int64 cost = ShapeUtil::ElementsIn(instr->shape());
+      for (int64 dim :
+           instr->dot_dimension_numbers().lhs_contracting_dimensions()) {
+        cost *= lhs_shape.dimensions(dim);
+      }
+      return cost;
+    }
+    case HloOpcode::kConvolution: {
+      // Each output element combines a whole kernel for one output feature.
+      const Shape& kernel_shape = instr->operand(1)->shape();
+      const ConvolutionDimensionNumbers& dnums =
+          instr->convolution_dimension_numbers();
+      const int64 output_features =
+          kernel_shape.dimensions(dnums.kernel_output_feature_dimension());
+      return ShapeUtil::ElementsIn(instr->shape()) *
+             (output_features == 0
+                  ? 0
+                  : ShapeUtil::ElementsIn(kernel_shape) / output_features);
+    }
+    case HloOpcode::kReduce: {
+      // Every input element is combined into one output element.
+      int64 cost = 0;
+      for (const HloInstruction* input :
+           Cast<HloReduceInstruction>(instr)->inputs()) {
+        cost += ShapeUtil::ElementsIn(input->shape());
+      }
+      return cost;
+    }
+    case HloOpcode::kReduceWindow: {
+      int64 window_size = 1;
+      for (const WindowDimension& dim : instr->window().dimensions()) {
+        window_size *= dim.size();
+      }
+      return ShapeUtil::ElementsIn(instr->shape()) * window_size;
+    }
+    default:
+      return instr->shape().IsArray() ? ShapeUtil::ElementsIn(instr->shape())
+                                      : 0;
+  }
+}
+
 StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
   // Limit the constant folding to 0 iterations to skip folding loops. This
   // retains the behavior from before while loop support in HloEvaluator and may
   // be revised.
   auto evaluator = absl::make_unique<HloEvaluator>(/*max_loop_iterations=*/0);
+  // Evaluate rank 2 F32 dots with Eigen rather than element by element.
+  evaluator->set_use_fast_path(true);
 
   XLA_VLOG_LINES(2,
                  "HloConstantFolding::Run(), before:\n" + module->ToString());
@@ -137,10 +193,31 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
         }
       }
 
+      // Don't constant fold instructions that would take the evaluator too
+      // long, e.g. large dots and convolutions. They are much cheaper to run on
+      // the device than to evaluate at compile time.
+      static const int64 kMaximumEvaluationCost = 1000 * 1000 * 1000;
+      const int64 evaluation_cost = EstimateEvaluationCost(instruction);
+      if (evaluation_cost > kMaximumEvaluationCost) {
+        VLOG(2) << "Not constant folding " << instruction->name()
+                << ", which would take about " << evaluation_cost
+                << " operations to evaluate";
+        continue;
+      }
+
       Literal result;
-      // Currently we skip unimplemented operations.
-      // TODO(b/35975797): Fold constant computations for more operations.
-      if (!evaluator->TryEvaluate(instruction, &result)) {
+      bool evaluated;
+      {
+        SlowOperationAlarm slow_alarm(
+            absl::Seconds(10),
+            absl::StrFormat("Constant folding %s is taking longer than 10s. "
+                            "Its estimated cost is %d operations.",
+                            instruction->name(), evaluation_cost));
+        // Currently we skip unimplemented operations.
+        // TODO(b/35975797): Fold constant computations for more operations.
+        evaluated = evaluator->TryEvaluate(instruction, &result);
+      }
+      if (!evaluated) {
         VLOG(2) << "Constant folding failed for instruction: "
                 << instruction->ToString();
         continue;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
@@ -269,6 +270,49 @@ TEST_F(HloConstantFoldingTest, DoesNotFoldLargePad) {
               GmockMatch(m::Pad(m::Constant(), m::Constant())));
 }
 
+// Builds a module whose root is a dot of two [n, n] F32 constants filled
+// with ones.
+std::unique_ptr<HloModule> MakeSquareDotModule(HloTestBase* test, int64 n) {
+  HloComputation::Builder builder("square_dot");
+  HloInstruction* lhs = builder.AddInstruction(HloInstruction::CreateConstant(
+      LiteralUtil::CreateR2FromArray2D(Array2D<float>(n, n, 1.0f))));
+  HloInstruction* rhs = builder.AddInstruction(HloInstruction::CreateConstant(
+      LiteralUtil::CreateR2FromArray2D(Array2D<float>(n, n, 1.0f))));
+  DotDimensionNumbers dnums;
+  dnums.add_lhs_contracting_dimensions(1);
+  dnums.add_rhs_contracting_dimensions(0);
+  builder.AddInstruction(HloInstruction::CreateDot(
+      ShapeUtil::MakeShape(F32, {n, n}), lhs, rhs, dnums,
+      HloTestBase::DefaultPrecisionConfig(2)));
+  auto module = test->CreateNewVerifiedModule();
+  module->AddEntryComputation(builder.Build());
+  return module;
+}
+
+TEST_F(HloConstantFoldingTest, FoldsSmallDot) {
+  std::unique_ptr<HloModule> module = MakeSquareDotModule(this, 4);
+  HloConstantFolding const_folder;
+  TF_ASSERT_OK_AND_ASSIGN(bool result, const_folder.Run(module.get()));
+  EXPECT_TRUE(result);
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, GmockMatch(m::Constant()));
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR2FromArray2D(Array2D<float>(4, 4, 4.0f)),
+      root->literal()));
+}
+
+TEST_F(HloConstantFoldingTest, DoesNotFoldExpensiveDot) {
+  // 1024^3 multiply-adds are more than the constant folding budget.
+  std::unique_ptr<HloModule> module = MakeSquareDotModule(this, 1024);
+  HloConstantFolding const_folder;
+  TF_ASSERT_OK_AND_ASSIGN(bool result, const_folder.Run(module.get()));
+  EXPECT_FALSE(result);
+
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Dot(m::Constant(), m::Constant())));
+}
+
 TEST_F(HloConstantFoldingTest, DontFoldSubcomputationContainingAfterAll) {
   const char* const kModuleStr = R"(
   HloModule test
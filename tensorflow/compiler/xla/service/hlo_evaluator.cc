@@ -398,6 +398,20 @@ StatusOr<Literal> HloEvaluator::EvaluateDotOp(
   return Evaluate(cloned_instruction.get());
 }
 
+/* static */ bool HloEvaluator::HaveSameLinearLayout(
+    const Literal& result, absl::Span<const Literal* const> operands) {
+  const Shape& shape = result.shape();
+  if (!shape.IsArray() || !shape.is_static()) {
+    return false;
+  }
+  return absl::c_all_of(operands, [&](const Literal* operand) {
+    const Shape& operand_shape = operand->shape();
+    return operand_shape.IsArray() && operand_shape.is_static() &&
+           ShapeUtil::SameDimensions(shape, operand_shape) &&
+           LayoutUtil::Equal(shape.layout(), operand_shape.layout());
+  });
+}
+
 Status HloEvaluator::HandleBitcast(HloInstruction* bitcast) {
   const Literal& operand_literal = GetEvaluatedLiteralFor(bitcast->operand(0));
   Literal result(bitcast->shape());
@@ -2268,9 +2282,13 @@ Status HloEvaluator::HandleSort(HloInstruction* sort) {
   return Status::OK();
 }
 
-static bool IsScalarAdd(HloComputation* computation) {
+// Returns true if `computation` applies a single add, maximum or minimum to
+// its two scalar parameters, in either order.
+static bool IsScalarAddMaxOrMin(HloComputation* computation) {
   HloInstruction* instruction = computation->root_instruction();
-  if (instruction->opcode() == HloOpcode::kAdd &&
+  if ((instruction->opcode() == HloOpcode::kAdd ||
+       instruction->opcode() == HloOpcode::kMaximum ||
+       instruction->opcode() == HloOpcode::kMinimum) &&
       computation->num_parameters() == 2) {
     const HloInstruction* lhs = instruction->operand(0);
     const HloInstruction* rhs = instruction->operand(1);
@@ -2282,6 +2300,23 @@ static bool IsScalarAdd(HloComputation* computation) {
   return false;
 }
 
+// Applies the root of a computation accepted by IsScalarAddMaxOrMin to the
+// given floating point values, with the semantics of HandleMaximum and
+// HandleMinimum for NaNs.
+static double ApplyScalarAddMaxOrMin(HloOpcode opcode, double lhs,
+                                     double rhs) {
+  switch (opcode) {
+    case HloOpcode::kAdd:
+      return lhs + rhs;
+    case HloOpcode::kMaximum:
+      return ((lhs >= rhs) || std::isnan(lhs)) ? lhs : rhs;
+    case HloOpcode::kMinimum:
+      return ((lhs <= rhs) || std::isnan(lhs)) ? lhs : rhs;
+    default:
+      LOG(FATAL) << "Unexpected opcode " << HloOpcodeString(opcode);
+  }
+}
+
 // Run a single step of an inner loop while running reduction, which applies
 // the user-provided computation on the accumulator and the output element
 // (until the reduction is completed, the output element is also used as
@@ -2351,8 +2386,8 @@ static StatusOr<bool> GenerateReduceOutputElement(
     absl::Span<const int64> arg_dim_steps,
     absl::Span<const int64> arg_dim_counts,
     absl::Span<const int64> result_to_arg_index) {
-  bool use_fast_add = ShapeUtil::ElementIsFloating(init_values[0]->shape()) &&
-                      IsScalarAdd(function) && !is_tuple;
+  bool use_fast_path = ShapeUtil::ElementIsFloating(init_values[0]->shape()) &&
+                       IsScalarAddMaxOrMin(function) && !is_tuple;
 
   const Shape& arg_shape = input_args[0]->shape();
   absl::Span<const int64> arg_dimensions = AsInt64Slice(arg_shape.dimensions());
@@ -2366,12 +2401,20 @@ static StatusOr<bool> GenerateReduceOutputElement(
         results[i].CopyElementFrom(*init_values[i], {}, output_index));
   }
 
-  if (use_fast_add) {
+  if (use_fast_path) {
+    const HloInstruction* root = function->root_instruction();
+    // The accumulator is parameter 0 of the reduction computation.
+    const bool accumulator_is_lhs = root->operand(0)->parameter_number() == 0;
     double computed_result = *init_values[0]->GetAsDouble({});
     auto reduction_step =
         [&](absl::Span<const int64> input_index) -> StatusOr<bool> {
       double argument = *input_args[0]->GetAsDouble(input_index);
-      computed_result += argument;
+      computed_result =
+          accumulator_is_lhs
+              ? ApplyScalarAddMaxOrMin(root->opcode(), computed_result,
+                                       argument)
+              : ApplyScalarAddMaxOrMin(root->opcode(), argument,
+                                       computed_result);
       return true;
     };
     TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
@@ -326,6 +326,13 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   bool use_fast_path_ = false;
 
  private:
+  // Returns true if `result` and all of `operands` are static arrays with the
+  // same dimensions and layout. An elementwise op can then be evaluated by a
+  // single pass over their linear data, rather than by computing the linear
+  // index of every element from its multi-dimensional index.
+  static bool HaveSameLinearLayout(const Literal& result,
+                                   absl::Span<const Literal* const> operands);
+
   template <typename ReturnT, typename NativeT>
   static StatusOr<Literal> ElementWiseUnaryOpImpl(
       HloInstruction* instruction,
@@ -336,6 +343,14 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HaveSameLinearLayout(result, {&operand_literal})) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = unary_op(operand_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/xla/service/hlo_evaluator.h"
 
+#include <cmath>
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -332,6 +334,18 @@ TEST_P(HloEvaluatorBf16Test, DoesAnd) {
 }
 // Verifies that HloEvaluator evaluates a HLO instruction that performs
 // element-wise or with 2 operands.
+TEST_F(HloEvaluatorTest, DoesAddWithDifferentOperandLayouts) {
+  auto lhs = LiteralUtil::CreateR2WithLayout<float>(
+      {{1, 2, 3}, {4, 5, 6}}, LayoutUtil::MakeLayout({0, 1}));
+  auto rhs = LiteralUtil::CreateR2WithLayout<float>(
+      {{10, 20, 30}, {40, 50, 60}}, LayoutUtil::MakeLayout({1, 0}));
+  auto expected = LiteralUtil::CreateR2WithLayout<float>(
+      {{11, 22, 33}, {44, 55, 66}}, LayoutUtil::MakeLayout({1, 0}));
+  TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
+               std::move(rhs));
+}
+// Verifies that HloEvaluator evaluates a HLO instruction that performs
+// element-wise or with 2 operands.
 TEST_F(HloEvaluatorTest, DoesOr) {
   auto lhs = LiteralUtil::CreateR2<int64>({{1, 0}, {-100, 4}});
   auto rhs = LiteralUtil::CreateR2<int64>({{2, 4}, {4, 4}});
@@ -2624,6 +2638,40 @@ TEST_P(HloEvaluatorBf16Test, ReduceAdd) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+TEST_P(HloEvaluatorBf16Test, ReduceMaxPropagatesNaN) {
+  HloComputation::Builder b(TestName());
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  auto arg_literal = LiteralUtil::CreateR2<float>({{1, nan, 3}, {5, 7, 6}});
+  HloInstruction* arg_instruction =
+      b.AddInstruction(HloInstruction::CreateConstant(std::move(arg_literal)));
+
+  auto init_value = b.AddInstruction(HloInstruction::CreateConstant(
+      LiteralUtil::CreateR0<float>(-std::numeric_limits<float>::infinity())));
+
+  HloComputation::Builder max_computation("max");
+  Shape scalar_shape = ShapeUtil::MakeShape(F32, {});
+  auto param_lhs = max_computation.AddInstruction(
+      HloInstruction::CreateParameter(0, scalar_shape, "lhs"));
+  auto param_rhs = max_computation.AddInstruction(
+      HloInstruction::CreateParameter(1, scalar_shape, "rhs"));
+  max_computation.AddInstruction(HloInstruction::CreateBinary(
+      scalar_shape, HloOpcode::kMaximum, param_lhs, param_rhs));
+  auto max_func = m_->AddEmbeddedComputation(max_computation.Build());
+
+  Shape shape = ShapeUtil::MakeShape(F32, {2});
+  b.AddInstruction(
+      HloInstruction::CreateReduce(shape, arg_instruction, init_value,
+                                   /*dimensions_to_reduce=*/{1}, max_func));
+
+  m_->AddEntryComputation(b.Build());
+
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+
+  EXPECT_TRUE(std::isnan(result.Get<float>({0})));
+  EXPECT_EQ(result.Get<float>({1}), 7);
+}
+
 TEST_P(HloEvaluatorBf16Test, ReduceWindowMax) {
   HloComputation::Builder b(TestName());
 
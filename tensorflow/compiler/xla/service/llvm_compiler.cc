@@ -14,7 +14,13 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/xla/service/llvm_compiler.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/env.h"
 
 #ifdef __FAST_MATH__
 #error "Don't build XLA with -ffast-math"
@@ -37,7 +43,6 @@ StatusOr<std::vector<std::unique_ptr<Executable>>> LLVMCompiler::Compile(
   // to get some defense-in-depth.
   tensorflow::port::ScopedDontFlushDenormal dont_flush_denormals;
 
-  std::vector<std::unique_ptr<Executable>> result;
   std::vector<std::unique_ptr<HloModule>> modules =
       module_group->ConsumeModules();
   for (size_t i = 0; i < modules.size(); i++) {
@@ -45,14 +50,47 @@ StatusOr<std::vector<std::unique_ptr<Executable>>> LLVMCompiler::Compile(
       return Unimplemented(
           "Model partitioning not implemented for the CPU/GPU compilers!");
     }
+  }
 
-    TF_ASSIGN_OR_RETURN(modules[i],
-                        RunHloPasses(std::move(modules[i]), stream_execs[i][0],
-                                     device_allocator));
-    TF_ASSIGN_OR_RETURN(std::unique_ptr<Executable> executable,
-                        RunBackend(std::move(modules[i]), stream_execs[i][0],
-                                   device_allocator));
-    result.push_back(std::move(executable));
+  // The modules are independent, so they are compiled in parallel. The
+  // compilers are already safe to use from several threads at once, as
+  // several clients may compile through one backend concurrently.
+  std::vector<std::unique_ptr<Executable>> result(modules.size());
+  std::vector<Status> statuses(modules.size());
+  auto compile_module = [&](size_t i) {
+    tensorflow::port::ScopedDontFlushDenormal dont_flush_denormals;
+    StatusOr<std::unique_ptr<HloModule>> optimized = RunHloPasses(
+        std::move(modules[i]), stream_execs[i][0], device_allocator);
+    if (!optimized.ok()) {
+      statuses[i] = optimized.status();
+      return;
+    }
+    StatusOr<std::unique_ptr<Executable>> executable =
+        RunBackend(std::move(optimized).ValueOrDie(), stream_execs[i][0],
+                   device_allocator);
+    if (!executable.ok()) {
+      statuses[i] = executable.status();
+      return;
+    }
+    result[i] = std::move(executable).ValueOrDie();
+  };
+  const int num_threads = std::min<int>(modules.size(),
+                                        tensorflow::port::MaxParallelism());
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < modules.size(); i++) {
+      compile_module(i);
+      TF_RETURN_IF_ERROR(statuses[i]);
+    }
+  } else {
+    // The destructor of the pool waits for all compilations to finish.
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "xla_compile_modules", num_threads);
+    for (size_t i = 0; i < modules.size(); i++) {
+      pool.Schedule([&compile_module, i] { compile_module(i); });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
   }
 
   return {std::move(result)};
@@ -0,0 +1,185 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/persistent_compilation_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/raw_coding.h"
+
+namespace xla {
+
+namespace {
+
+constexpr char kEntrySuffix[] = ".entry";
+constexpr char kTempInfix[] = ".tmp-";
+constexpr int kChecksumBytes = sizeof(uint64);
+
+// Entries hit this long after they were written are rewritten, to mark them
+// as recently used for eviction.
+constexpr int64 kRefreshIntervalNanos = 3600LL * 1000 * 1000 * 1000;
+
+// Temporary files older than this were abandoned by a crashed writer.
+constexpr int64 kAbandonedTempFileNanos = kRefreshIntervalNanos;
+
+}  // namespace
+
+/*static*/ PersistentCompilationCache* PersistentCompilationCache::Get(
+    const string& dir, int64 max_bytes) {
+  static tensorflow::mutex mu(tensorflow::LINKER_INITIALIZED);
+  static auto* caches =
+      new absl::flat_hash_map<string,
+                              std::unique_ptr<PersistentCompilationCache>>();
+  tensorflow::mutex_lock lock(mu);
+  std::unique_ptr<PersistentCompilationCache>& cache = (*caches)[dir];
+  if (cache == nullptr) {
+    cache = absl::make_unique<PersistentCompilationCache>(
+        tensorflow::Env::Default(), dir, max_bytes);
+  }
+  return cache.get();
+}
+
+PersistentCompilationCache::PersistentCompilationCache(tensorflow::Env* env,
+                                                       string dir,
+                                                       int64 max_bytes)
+    : env_(env), dir_(std::move(dir)), max_bytes_(max_bytes) {}
+
+string PersistentCompilationCache::EntryPath(absl::string_view key) const {
+  const tensorflow::Fprint128 fingerprint = tensorflow::Fingerprint128(key);
+  return tensorflow::io::JoinPath(
+      dir_, absl::StrFormat("%016x%016x%s", fingerprint.high64,
+                            fingerprint.low64, kEntrySuffix));
+}
+
+absl::optional<string> PersistentCompilationCache::Lookup(
+    absl::string_view key) {
+  const string path = EntryPath(key);
+  string contents;
+  if (!tensorflow::ReadFileToString(env_, path, &contents).ok()) {
+    return absl::nullopt;
+  }
+  if (contents.size() < kChecksumBytes) {
+    LOG(WARNING) << "Ignoring truncated compilation cache entry " << path;
+    return absl::nullopt;
+  }
+  const size_t value_size = contents.size() - kChecksumBytes;
+  if (tensorflow::core::DecodeFixed64(contents.data() + value_size) !=
+      tensorflow::Fingerprint64(absl::string_view(contents.data(),
+                                                  value_size))) {
+    LOG(WARNING) << "Ignoring corrupted compilation cache entry " << path;
+    return absl::nullopt;
+  }
+
+  tensorflow::FileStatistics stat;
+  if (env_->Stat(path, &stat).ok() &&
+      env_->NowMicros() * 1000 - stat.mtime_nsec > kRefreshIntervalNanos) {
+    // Failing to refresh only makes the entry more likely to be evicted.
+    WriteEntry(path, contents).IgnoreError();
+  }
+  contents.resize(value_size);
+  return std::move(contents);
+}
+
+Status PersistentCompilationCache::Insert(absl::string_view key,
+                                          absl::string_view value) {
+  string contents(value);
+  contents.resize(value.size() + kChecksumBytes);
+  tensorflow::core::EncodeFixed64(&contents[value.size()],
+                                  tensorflow::Fingerprint64(value));
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(dir_));
+  TF_RETURN_IF_ERROR(WriteEntry(EntryPath(key), contents));
+
+  if (max_bytes_ <= 0) {
+    return Status::OK();
+  }
+  tensorflow::mutex_lock lock(mu_);
+  if (total_bytes_ >= 0) {
+    total_bytes_ += contents.size();
+  }
+  if (total_bytes_ < 0 || total_bytes_ > max_bytes_) {
+    return Evict();
+  }
+  return Status::OK();
+}
+
+Status PersistentCompilationCache::WriteEntry(const string& path,
+                                              absl::string_view contents) {
+  string temp_path = absl::StrCat(path, kTempInfix);
+  if (!env_->CreateUniqueFileName(&temp_path, "")) {
+    return tensorflow::errors::AlreadyExists(
+        "Could not create a unique temporary file name for ", path);
+  }
+  Status status = tensorflow::WriteStringToFile(env_, temp_path, contents);
+  if (status.ok()) {
+    status = env_->RenameFile(temp_path, path);
+  }
+  if (!status.ok()) {
+    env_->DeleteFile(temp_path).IgnoreError();
+  }
+  return status;
+}
+
+Status PersistentCompilationCache::Evict() {
+  std::vector<string> children;
+  TF_RETURN_IF_ERROR(env_->GetChildren(dir_, &children));
+  const int64 now_nanos = env_->NowMicros() * 1000;
+
+  // (mtime, size, path) of every entry, oldest first once sorted.
+  std::vector<std::tuple<int64, int64, string>> entries;
+  int64 total_bytes = 0;
+  for (const string& child : children) {
+    const string path = tensorflow::io::JoinPath(dir_, child);
+    tensorflow::FileStatistics stat;
+    // Other processes may delete files concurrently.
+    if (!env_->Stat(path, &stat).ok() || stat.is_directory) continue;
+    if (absl::StrContains(child, kTempInfix)) {
+      if (now_nanos - stat.mtime_nsec > kAbandonedTempFileNanos) {
+        env_->DeleteFile(path).IgnoreError();
+      }
+    } else if (absl::EndsWith(child, kEntrySuffix)) {
+      entries.emplace_back(stat.mtime_nsec, stat.length, path);
+      total_bytes += stat.length;
+    }
+  }
+
+  if (total_bytes > max_bytes_) {
+    std::sort(entries.begin(), entries.end());
+    const int64 target_bytes = max_bytes_ / 4 * 3;
+    for (const auto& entry : entries) {
+      if (total_bytes <= target_bytes) break;
+      VLOG(1) << "Evicting compilation cache entry " << std::get<2>(entry);
+      env_->DeleteFile(std::get<2>(entry)).IgnoreError();
+      total_bytes -= std::get<1>(entry);
+    }
+  }
+  total_bytes_ = total_bytes;
+  return Status::OK();
+}
+
+}  // namespace xla
@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_PERSISTENT_COMPILATION_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_PERSISTENT_COMPILATION_CACHE_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+
+// A cache of compiled artifacts stored as files in a directory, so that they
+// survive process restarts and can be shared by every process pointing at the
+// same (local or networked) directory.
+//
+// Entries are named by a fingerprint of their key, which must capture
+// everything the artifact depends on. Every entry is written to a temporary
+// file first and then renamed into place, so concurrent writers of the same
+// key never expose a partially written entry, and readers verify a checksum
+// of the contents on file systems where renames are not atomic.
+//
+// Once the entries exceed `max_bytes`, the least recently used ones are
+// deleted. Recency is tracked through file modification times: an entry is
+// rewritten when it is hit more than an hour after it was last written.
+class PersistentCompilationCache {
+ public:
+  // Returns the cache rooted at `dir`, shared by all users in the process.
+  // `max_bytes` <= 0 disables eviction.
+  static PersistentCompilationCache* Get(const string& dir, int64 max_bytes);
+
+  PersistentCompilationCache(tensorflow::Env* env, string dir,
+                             int64 max_bytes);
+
+  // Returns the value stored for `key`, or nullopt if there is none. Entries
+  // that cannot be read or fail their checksum are treated as misses.
+  absl::optional<string> Lookup(absl::string_view key);
+
+  // Stores `value` for `key`, replacing any previous value.
+  Status Insert(absl::string_view key, absl::string_view value);
+
+  const string& dir() const { return dir_; }
+
+ private:
+  string EntryPath(absl::string_view key) const;
+
+  // Atomically writes `contents` to `path`.
+  Status WriteEntry(const string& path, absl::string_view contents);
+
+  // Deletes the least recently used entries until the cache fits in 3/4 of
+  // `max_bytes_`, along with temporary files abandoned by crashed writers.
+  Status Evict() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  tensorflow::Env* const env_;
+  const string dir_;
+  const int64 max_bytes_;
+
+  tensorflow::mutex mu_;
+
+  // Approximate size of the entries in `dir_`, or -1 if it has not been
+  // computed yet. Other processes may write to the directory too, so the
+  // size is recomputed whenever an eviction runs.
+  int64 total_bytes_ TF_GUARDED_BY(mu_) = -1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PersistentCompilationCache);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_PERSISTENT_COMPILATION_CACHE_H_
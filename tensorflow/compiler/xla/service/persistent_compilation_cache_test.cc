@@ -0,0 +1,88 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/persistent_compilation_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace {
+
+class PersistentCompilationCacheTest : public ::testing::Test {
+ protected:
+  PersistentCompilationCacheTest()
+      : dir_(tensorflow::io::JoinPath(
+            tensorflow::testing::TmpDir(),
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())) {
+  }
+
+  std::vector<string> Children() {
+    std::vector<string> children;
+    TF_CHECK_OK(tensorflow::Env::Default()->GetChildren(dir_, &children));
+    return children;
+  }
+
+  const string dir_;
+};
+
+TEST_F(PersistentCompilationCacheTest, EntriesOutliveTheCache) {
+  {
+    PersistentCompilationCache cache(tensorflow::Env::Default(), dir_,
+                                     /*max_bytes=*/0);
+    EXPECT_FALSE(cache.Lookup("module").has_value());
+    TF_ASSERT_OK(cache.Insert("module", "binary"));
+    TF_ASSERT_OK(cache.Insert("other module", string("\0\1", 2)));
+  }
+  PersistentCompilationCache cache(tensorflow::Env::Default(), dir_,
+                                   /*max_bytes=*/0);
+  EXPECT_EQ(cache.Lookup("module"), "binary");
+  EXPECT_EQ(cache.Lookup("other module"), string("\0\1", 2));
+  EXPECT_FALSE(cache.Lookup("modul").has_value());
+  EXPECT_EQ(Children().size(), 2);
+}
+
+TEST_F(PersistentCompilationCacheTest, CorruptedEntriesAreMisses) {
+  PersistentCompilationCache cache(tensorflow::Env::Default(), dir_,
+                                   /*max_bytes=*/0);
+  TF_ASSERT_OK(cache.Insert("module", "binary"));
+  const std::vector<string> children = Children();
+  ASSERT_EQ(children.size(), 1);
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(
+      tensorflow::Env::Default(),
+      tensorflow::io::JoinPath(dir_, children[0]), "binarz__checksum"));
+  EXPECT_FALSE(cache.Lookup("module").has_value());
+  TF_ASSERT_OK(cache.Insert("module", "binary"));
+  EXPECT_EQ(cache.Lookup("module"), "binary");
+}
+
+TEST_F(PersistentCompilationCacheTest, EvictsDownToThreeQuartersOfMaxBytes) {
+  // Every entry takes 100 bytes including its checksum.
+  PersistentCompilationCache cache(tensorflow::Env::Default(), dir_,
+                                   /*max_bytes=*/250);
+  TF_ASSERT_OK(cache.Insert("a", string(92, 'a')));
+  TF_ASSERT_OK(cache.Insert("b", string(92, 'b')));
+  EXPECT_EQ(Children().size(), 2);
+  TF_ASSERT_OK(cache.Insert("c", string(92, 'c')));
+  EXPECT_EQ(Children().size(), 1);
+}
+
+}  // namespace
+}  // namespace xla
@@ -0,0 +1,294 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/compiler/xla/service/spmd/sharding_search.h"
+
+#include <limits>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/array.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace spmd {
+
+absl::optional<HloSharding> ShardingSearch::TileDimension(const Shape& shape,
+                                                          int64 dim) const {
+  if (shape.dimensions(dim) % options_.num_partitions != 0) {
+    return absl::nullopt;
+  }
+  std::vector<int64> tile_dimensions(shape.rank(), 1);
+  tile_dimensions[dim] = options_.num_partitions;
+  Array<int64> tile_assignment(tile_dimensions);
+  tile_assignment.FillIota(0);
+  return HloSharding::Tile(tile_assignment);
+}
+
+std::vector<ShardingSearch::Candidate> ShardingSearch::GetDotCandidates(
+    const HloInstruction* dot) const {
+  const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
+  const Shape& lhs_shape = dot->operand(0)->shape();
+  const Shape& rhs_shape = dot->operand(1)->shape();
+  const Shape& output_shape = dot->shape();
+
+  // Start with keeping the dot replicated.
+  std::vector<Candidate> candidates(1);
+  auto add_candidate = [&](const absl::optional<HloSharding>& lhs,
+                           const absl::optional<HloSharding>& rhs,
+                           const absl::optional<HloSharding>& output,
+                           bool partial_result) {
+    if (!lhs || !rhs || !output) {
+      return;
+    }
+    Candidate candidate;
+    candidate.lhs = *lhs;
+    candidate.rhs = *rhs;
+    candidate.output = *output;
+    candidate.partial_result = partial_result;
+    candidates.push_back(std::move(candidate));
+  };
+  const absl::optional<HloSharding> replicated = HloSharding::Replicate();
+
+  // The output dimensions are the batch dimensions, then the non-contracting
+  // dimensions of the lhs, then those of the rhs.
+  int64 output_dim = 0;
+  for (int64 i = 0; i < dnums.lhs_batch_dimensions_size(); ++i) {
+    add_candidate(TileDimension(lhs_shape, dnums.lhs_batch_dimensions(i)),
+                  TileDimension(rhs_shape, dnums.rhs_batch_dimensions(i)),
+                  TileDimension(output_shape, output_dim++),
+                  /*partial_result=*/false);
+  }
+  for (int64 dim = 0; dim < lhs_shape.rank(); ++dim) {
+    if (absl::c_linear_search(dnums.lhs_batch_dimensions(), dim) ||
+        absl::c_linear_search(dnums.lhs_contracting_dimensions(), dim)) {
+      continue;
+    }
+    add_candidate(TileDimension(lhs_shape, dim), replicated,
+                  TileDimension(output_shape, output_dim++),
+                  /*partial_result=*/false);
+  }
+  for (int64 dim = 0; dim < rhs_shape.rank(); ++dim) {
+    if (absl::c_linear_search(dnums.rhs_batch_dimensions(), dim) ||
+        absl::c_linear_search(dnums.rhs_contracting_dimensions(), dim)) {
+      continue;
+    }
+    add_candidate(replicated, TileDimension(rhs_shape, dim),
+                  TileDimension(output_shape, output_dim++),
+                  /*partial_result=*/false);
+  }
+  for (int64 i = 0; i < dnums.lhs_contracting_dimensions_size(); ++i) {
+    add_candidate(TileDimension(lhs_shape, dnums.lhs_contracting_dimensions(i)),
+                  TileDimension(rhs_shape, dnums.rhs_contracting_dimensions(i)),
+                  replicated, /*partial_result=*/true);
+  }
+  return candidates;
+}
+
+std::vector<ShardingSearch::Candidate> ShardingSearch::GetConvolutionCandidates(
+    const HloInstruction* conv) const {
+  std::vector<Candidate> candidates(1);
+  // Grouped convolutions are only considered replicated.
+  if (conv->feature_group_count() != 1 || conv->batch_group_count() != 1) {
+    return candidates;
+  }
+  const ConvolutionDimensionNumbers& dnums =
+      conv->convolution_dimension_numbers();
+  const Shape& lhs_shape = conv->operand(0)->shape();
+  const Shape& rhs_shape = conv->operand(1)->shape();
+  const Shape& output_shape = conv->shape();
+
+  absl::optional<HloSharding> lhs =
+      TileDimension(lhs_shape, dnums.input_batch_dimension());
+  absl::optional<HloSharding> output =
+      TileDimension(output_shape, dnums.output_batch_dimension());
+  if (lhs && output) {
+    Candidate candidate;
+    candidate.lhs = *lhs;
+    candidate.output = *output;
+    candidates.push_back(std::move(candidate));
+  }
+
+  absl::optional<HloSharding> rhs =
+      TileDimension(rhs_shape, dnums.kernel_output_feature_dimension());
+  output = TileDimension(output_shape, dnums.output_feature_dimension());
+  if (rhs && output) {
+    Candidate candidate;
+    candidate.rhs = *rhs;
+    candidate.output = *output;
+    candidates.push_back(std::move(candidate));
+  }
+
+  lhs = TileDimension(lhs_shape, dnums.input_feature_dimension());
+  rhs = TileDimension(rhs_shape, dnums.kernel_input_feature_dimension());
+  if (lhs && rhs) {
+    Candidate candidate;
+    candidate.lhs = *lhs;
+    candidate.rhs = *rhs;
+    candidate.partial_result = true;
+    candidates.push_back(std::move(candidate));
+  }
+  return candidates;
+}
+
+std::vector<ShardingSearch::Candidate> ShardingSearch::GetCandidates(
+    const HloInstruction* hlo) const {
+  switch (hlo->opcode()) {
+    case HloOpcode::kDot:
+      return GetDotCandidates(hlo);
+    case HloOpcode::kConvolution:
+      return GetConvolutionCandidates(hlo);
+    default:
+      return {};
+  }
+}
+
+double ShardingSearch::EstimateReshardingTime(const HloInstruction* hlo,
+                                              const HloSharding& target) const {
+  if (!hlo->has_sharding() || hlo->sharding() == target) {
+    return 0;
+  }
+  const HloSharding& source = hlo->sharding();
+  // Every device slices its shard out of a replicated tensor locally.
+  if (source.IsReplicated()) {
+    return 0;
+  }
+  const double n = options_.num_partitions;
+  const double bytes = ShapeUtil::ByteSizeOf(hlo->shape());
+  if (!source.IsTileMaximal() && !target.IsTileMaximal() &&
+      !source.ReplicateOnLastTileDim() && !target.ReplicateOnLastTileDim()) {
+    // Moving between tilings is an all-to-all, in which every device sends out
+    // (n - 1) / n of its shard.
+    return (n - 1) / n * (bytes / n) / options_.interconnect_bytes_per_second;
+  }
+  // Otherwise the whole tensor is gathered on every device. A ring all-gather
+  // receives (n - 1) / n of it on every device.
+  return (n - 1) / n * bytes / options_.interconnect_bytes_per_second;
+}
+
+double ShardingSearch::EstimateStepTime(const HloInstruction* hlo,
+                                        const Candidate& candidate,
+                                        int64 flops) const {
+  const double n = options_.num_partitions;
+  const bool partitioned =
+      !candidate.output.IsReplicated() || candidate.partial_result;
+  double time =
+      flops / options_.device_flops_per_second / (partitioned ? n : 1);
+  time += EstimateReshardingTime(hlo->operand(0), candidate.lhs);
+  time += EstimateReshardingTime(hlo->operand(1), candidate.rhs);
+  if (candidate.partial_result) {
+    // A ring all-reduce sends and receives 2 (n - 1) / n of the result on
+    // every device.
+    time += 2 * (n - 1) / n * ShapeUtil::ByteSizeOf(hlo->shape()) /
+            options_.interconnect_bytes_per_second;
+  }
+  return time;
+}
+
+int64 ShardingSearch::ShardSizeBytes(const Shape& shape,
+                                     const HloSharding& sharding) const {
+  const int64 bytes = ShapeUtil::ByteSizeOf(shape);
+  if (sharding.IsTileMaximal()) {
+    return bytes;
+  }
+  int64 num_shards = sharding.tile_assignment().num_elements();
+  if (sharding.ReplicateOnLastTileDim()) {
+    num_shards /= sharding.tile_assignment().dimensions().back();
+  }
+  return CeilOfRatio(bytes, num_shards);
+}
+
+int64 ShardingSearch::FootprintBytes(const HloInstruction* hlo,
+                                     const Candidate& candidate) const {
+  return ShardSizeBytes(hlo->operand(0)->shape(), candidate.lhs) +
+         ShardSizeBytes(hlo->operand(1)->shape(), candidate.rhs) +
+         ShardSizeBytes(hlo->shape(), candidate.output);
+}
+
+StatusOr<bool> ShardingSearch::Run(HloModule* module) {
+  if (options_.num_partitions <= 1) {
+    return false;
+  }
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    HloCostAnalysis cost_analysis([](const Shape& shape) {
+      return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+    });
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+
+    for (HloInstruction* hlo : computation->MakeInstructionPostOrder()) {
+      if ((hlo->opcode() != HloOpcode::kDot &&
+           hlo->opcode() != HloOpcode::kConvolution) ||
+          hlo->has_sharding()) {
+        continue;
+      }
+      const int64 flops = cost_analysis.flop_count(*hlo);
+      const std::vector<Candidate> candidates = GetCandidates(hlo);
+
+      // Pick the fastest candidate that fits in memory, or the smallest one
+      // if none does.
+      const Candidate* best = nullptr;
+      bool best_fits = false;
+      double best_time = std::numeric_limits<double>::infinity();
+      int64 best_bytes = std::numeric_limits<int64>::max();
+      for (const Candidate& candidate : candidates) {
+        const int64 bytes = FootprintBytes(hlo, candidate);
+        const bool fits = options_.per_device_memory_limit_bytes == 0 ||
+                          bytes <= options_.per_device_memory_limit_bytes;
+        const double time = EstimateStepTime(hlo, candidate, flops);
+        VLOG(3) << hlo->name() << ": lhs " << candidate.lhs.ToString()
+                << ", rhs " << candidate.rhs.ToString() << ", output "
+                << candidate.output.ToString() << " takes " << time
+                << "s and " << bytes << " bytes per device";
+        const bool better =
+            best == nullptr || (fits && !best_fits) ||
+            (fits && best_fits && time < best_time) ||
+            (!fits && !best_fits && bytes < best_bytes);
+        if (better) {
+          best = &candidate;
+          best_fits = fits;
+          best_time = time;
+          best_bytes = bytes;
+        }
+      }
+      CHECK(best != nullptr);
+      VLOG(2) << "Sharding " << hlo->name() << " as "
+              << best->output.ToString() << ", estimated at " << best_time
+              << "s" << (best_fits ? "" : " (exceeds the memory limit)");
+
+      hlo->set_sharding(best->output);
+      HloInstruction* lhs = hlo->mutable_operand(0);
+      HloInstruction* rhs = hlo->mutable_operand(1);
+      if (!lhs->has_sharding()) {
+        lhs->set_sharding(best->lhs);
+      }
+      if (!rhs->has_sharding()) {
+        rhs->set_sharding(best->rhs);
+      }
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace spmd
+}  // namespace xla
@@ -0,0 +1,121 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_SPMD_SHARDING_SEARCH_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_SPMD_SHARDING_SEARCH_H_
+
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/service/hlo_sharding.h"
+
+namespace xla {
+namespace spmd {
+
+// Chooses shardings for the dots and convolutions that have none, so that a
+// model can be partitioned without annotating it by hand. Run it before
+// ShardingPropagation, which then spreads the chosen shardings to the rest of
+// the graph.
+//
+// For every unsharded dot and convolution, in post order, the pass considers
+// keeping it replicated and partitioning each of its batch, non-contracting
+// and contracting dimensions (batch and output feature dimensions for
+// convolutions) across all the partitions. It estimates the step time of each
+// choice as the time to compute its share of the FLOPs reported by
+// HloCostAnalysis, plus the time of the collectives it needs: all-gathers and
+// all-to-alls to reshard operands that already have a sharding, and an
+// all-reduce of partial results when the contracting dimension is partitioned.
+// It picks the fastest choice whose operands and result fit in the memory
+// limit, and also assigns the sharding it assumed to operands that have none,
+// so that later ops account for them.
+//
+// The search is greedy and per op over a 1D mesh of all the partitions: it
+// does not revisit earlier choices, and the memory limit only bounds the
+// operands and result of each op, not the live memory of the whole program.
+class ShardingSearch : public HloModulePass {
+ public:
+  struct Options {
+    // Number of partitions the ops are sharded across.
+    int64 num_partitions = 1;
+    // Compute throughput of a device, in floating point operations per
+    // second.
+    double device_flops_per_second = 1e14;
+    // Bandwidth of the links between devices used by collectives, in bytes
+    // per second.
+    double interconnect_bytes_per_second = 1e11;
+    // Maximum size of the operands and result of a single op on a device, in
+    // bytes. Choices exceeding it are only taken when no choice fits. Zero
+    // means no limit.
+    int64 per_device_memory_limit_bytes = 0;
+  };
+
+  // A sharding choice for a dot or convolution.
+  struct Candidate {
+    HloSharding lhs = HloSharding::Replicate();
+    HloSharding rhs = HloSharding::Replicate();
+    HloSharding output = HloSharding::Replicate();
+    // Whether each partition computes partial sums of the whole result, which
+    // must be all-reduced.
+    bool partial_result = false;
+  };
+
+  explicit ShardingSearch(const Options& options) : options_(options) {}
+  ~ShardingSearch() override = default;
+  absl::string_view name() const override { return "sharding-search"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // Returns the sharding choices considered for a dot or convolution.
+  std::vector<Candidate> GetCandidates(const HloInstruction* hlo) const;
+
+  // Returns the estimated time, in seconds, to run `hlo` with the given
+  // sharding choice, given the current shardings of its operands.
+  double EstimateStepTime(const HloInstruction* hlo, const Candidate& candidate,
+                          int64 flops) const;
+
+  // Returns the estimated time, in seconds, to reshard `hlo` to `target`.
+  // A reshard is free when `hlo` has no sharding yet or already has `target`.
+  double EstimateReshardingTime(const HloInstruction* hlo,
+                                const HloSharding& target) const;
+
+ private:
+  // Returns the bytes held by each device for a `shape` with `sharding`.
+  int64 ShardSizeBytes(const Shape& shape, const HloSharding& sharding) const;
+
+  // Returns the bytes held by each device for the operands and result of
+  // `hlo` with the given sharding choice.
+  int64 FootprintBytes(const HloInstruction* hlo,
+                       const Candidate& candidate) const;
+
+  // Returns a sharding of `shape` that tiles dimension `dim` across all the
+  // partitions, or nullopt if the dimension does not divide evenly.
+  absl::optional<HloSharding> TileDimension(const Shape& shape,
+                                            int64 dim) const;
+
+  std::vector<Candidate> GetDotCandidates(const HloInstruction* dot) const;
+  std::vector<Candidate> GetConvolutionCandidates(
+      const HloInstruction* conv) const;
+
+  const Options options_;
+};
+
+}  // namespace spmd
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_SPMD_SHARDING_SEARCH_H_
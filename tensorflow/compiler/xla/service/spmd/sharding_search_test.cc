@@ -0,0 +1,150 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/compiler/xla/service/spmd/sharding_search.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace spmd {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class ShardingSearchTest : public HloTestBase {
+ public:
+  StatusOr<std::unique_ptr<HloModule>> RunSearch(
+      const char* hlo_module, const ShardingSearch::Options& options) {
+    TF_ASSIGN_OR_RETURN(auto module, ParseAndReturnVerifiedModule(hlo_module));
+    TF_RETURN_IF_ERROR(ShardingSearch(options).Run(module.get()).status());
+    return StatusOr<std::unique_ptr<HloModule>>(std::move(module));
+  }
+};
+
+TEST_F(ShardingSearchTest, PartitionsBatchDimension) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  lhs = f32[8,128,64] parameter(0)
+  rhs = f32[8,64,128] parameter(1)
+  ROOT dot = f32[8,128,128] dot(lhs, rhs), lhs_batch_dims={0},
+    rhs_batch_dims={0}, lhs_contracting_dims={2}, rhs_contracting_dims={1}
+})";
+  ShardingSearch::Options options;
+  options.num_partitions = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto module, RunSearch(hlo_string, options));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Sharding("{devices=[4,1,1]0,1,2,3}"));
+  EXPECT_THAT(root->operand(0), op::Sharding("{devices=[4,1,1]0,1,2,3}"));
+  EXPECT_THAT(root->operand(1), op::Sharding("{devices=[4,1,1]0,1,2,3}"));
+}
+
+TEST_F(ShardingSearchTest, FollowsShardedContractingDimension) {
+  // Resharding the lhs away from its contracting dimension costs more than
+  // all-reducing the small result.
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  lhs = f32[8,4096] parameter(0), sharding={devices=[1,4]0,1,2,3}
+  rhs = f32[4096,8] parameter(1)
+  ROOT dot = f32[8,8] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})";
+  ShardingSearch::Options options;
+  options.num_partitions = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto module, RunSearch(hlo_string, options));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Sharding("{replicated}"));
+  EXPECT_THAT(root->operand(0), op::Sharding("{devices=[1,4]0,1,2,3}"));
+  EXPECT_THAT(root->operand(1), op::Sharding("{devices=[4,1]0,1,2,3}"));
+}
+
+const char* const kLargeRhsDot = R"(
+HloModule module
+
+ENTRY entry {
+  lhs = f32[64,1024] parameter(0)
+  rhs = f32[1024,4096] parameter(1)
+  ROOT dot = f32[64,4096] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})";
+
+TEST_F(ShardingSearchTest, PrefersFirstFastestCandidateWithoutMemoryLimit) {
+  ShardingSearch::Options options;
+  options.num_partitions = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto module, RunSearch(kLargeRhsDot, options));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Sharding("{devices=[4,1]0,1,2,3}"));
+  EXPECT_THAT(root->operand(1), op::Sharding("{replicated}"));
+}
+
+TEST_F(ShardingSearchTest, MemoryLimitAvoidsReplicatingLargeOperand) {
+  // Partitioning the lhs rows keeps the whole 16MB rhs on every device.
+  ShardingSearch::Options options;
+  options.num_partitions = 4;
+  options.per_device_memory_limit_bytes = 8 * 1024 * 1024;
+  TF_ASSERT_OK_AND_ASSIGN(auto module, RunSearch(kLargeRhsDot, options));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Sharding("{devices=[1,4]0,1,2,3}"));
+  EXPECT_THAT(root->operand(0), op::Sharding("{replicated}"));
+  EXPECT_THAT(root->operand(1), op::Sharding("{devices=[1,4]0,1,2,3}"));
+}
+
+TEST_F(ShardingSearchTest, PartitionsConvolutionBatch) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  input = f32[16,32,32,8] parameter(0)
+  kernel = f32[3,3,8,6] parameter(1)
+  ROOT conv = f32[16,32,32,6] convolution(input, kernel),
+    window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+})";
+  ShardingSearch::Options options;
+  options.num_partitions = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto module, RunSearch(hlo_string, options));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Sharding("{devices=[4,1,1,1]0,1,2,3}"));
+  EXPECT_THAT(root->operand(1), op::Sharding("{replicated}"));
+}
+
+TEST_F(ShardingSearchTest, KeepsExistingSharding) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  lhs = f32[8,128,64] parameter(0)
+  rhs = f32[8,64,128] parameter(1)
+  ROOT dot = f32[8,128,128] dot(lhs, rhs), lhs_batch_dims={0},
+    rhs_batch_dims={0}, lhs_contracting_dims={2}, rhs_contracting_dims={1},
+    sharding={replicated}
+})";
+  ShardingSearch::Options options;
+  options.num_partitions = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto module, RunSearch(hlo_string, options));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Sharding("{replicated}"));
+  EXPECT_FALSE(root->operand(0)->has_sharding());
+}
+
+}  // namespace
+}  // namespace spmd
+}  // namespace xla
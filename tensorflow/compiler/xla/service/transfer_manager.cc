@@ -428,6 +428,12 @@ StatusOr<ScopedShapedBuffer> TransferManager::AllocateScopedShapedBuffer(
   return std::move(shaped_buffer);
 }
 
+StatusOr<TransferManager::XfeedQueueStats>
+TransferManager::GetXfeedQueueStats(se::StreamExecutor* executor) {
+  return Unimplemented("Infeed and outfeed statistics are not supported on %s",
+                       executor->platform()->Name());
+}
+
 StatusOr<Shape> TransferManager::ChooseCompactLayoutForShape(
     const Shape& host_shape) const {
   return LayoutUtil::GetWithDefaultLayout(host_shape);
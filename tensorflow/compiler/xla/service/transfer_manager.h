@@ -204,6 +204,30 @@ class TransferManager {
       se::StreamExecutor* executor, const Shape& literal_shape,
       MutableBorrowingLiteral literal) = 0;
 
+  // Counters of the infeed and outfeed queues of a device. A program that
+  // spends much of its time waiting on its infeed is starved of data, while an
+  // infeed queue that keeps growing is fed faster than the program consumes it.
+  struct XfeedQueueStats {
+    // Number of infeed buffers enqueued and not yet consumed by the device.
+    int64 infeed_queue_depth = 0;
+    // Number of infeed buffers consumed by the device so far.
+    int64 infeed_dequeue_count = 0;
+    // Total time the device spent waiting for infeed data, in microseconds.
+    int64 infeed_wait_micros = 0;
+    // Number of outfeed destinations enqueued and not yet filled by the device.
+    int64 outfeed_queue_depth = 0;
+    // Number of outfeed destinations filled by the device so far.
+    int64 outfeed_dequeue_count = 0;
+    // Total time the device spent waiting for an outfeed destination, in
+    // microseconds.
+    int64 outfeed_wait_micros = 0;
+  };
+
+  // Returns the counters of the infeed and outfeed queues of the device of the
+  // given executor. The default implementation returns Unimplemented.
+  virtual StatusOr<XfeedQueueStats> GetXfeedQueueStats(
+      se::StreamExecutor* executor);
+
   // Resets the devices associated with this transfer manager.
   virtual Status ResetDevices(
       absl::Span<se::StreamExecutor* const> executor) = 0;
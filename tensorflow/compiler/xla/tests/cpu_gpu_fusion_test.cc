@@ -20,6 +20,7 @@ limitations under the License.
 #include <new>
 #include <random>
 #include <utility>
+#include <vector>
 
 #define EIGEN_USE_THREADS
 
@@ -927,5 +928,78 @@ void BM_ParallelFusion(int num_iters) {
 
 BENCHMARK(BM_ParallelFusion);
 
+void BM_MlpActivationFusion(int num_iters, int batch_size) {
+  // The activation of an MLP layer and its derivative, which both read the
+  // [batch_size, 1024] output of the tanh.
+  tensorflow::testing::StopTiming();
+
+  LocalClient* client = ClientLibrary::LocalClientOrDie();
+  int device_ordinal = client->default_device_ordinal();
+  const int64 features = 1024;
+
+  XlaBuilder builder("MlpActivationFusion");
+  auto x = Parameter(&builder, 0,
+                     ShapeUtil::MakeShape(F32, {batch_size, features}), "x");
+  auto w = Parameter(&builder, 1,
+                     ShapeUtil::MakeShape(F32, {features, features}), "w");
+  auto bias =
+      Parameter(&builder, 2, ShapeUtil::MakeShape(F32, {features}), "bias");
+  auto activation = Tanh(Add(Dot(x, w), bias, /*broadcast_dimensions=*/{1}));
+  Tuple(&builder,
+        {Mul(activation, ConstantR0<float>(&builder, 0.5f)),
+         Sub(ConstantR0<float>(&builder, 1.0f), Mul(activation, activation))});
+  auto computation = builder.Build().ConsumeValueOrDie();
+
+  std::vector<ScopedShapedBuffer> buffers;
+  buffers.push_back(
+      client
+          ->LiteralToShapedBuffer(LiteralUtil::CreateR2F32Linspace(
+                                      -1.0, 1.0, batch_size, features),
+                                  device_ordinal)
+          .ConsumeValueOrDie());
+  buffers.push_back(
+      client
+          ->LiteralToShapedBuffer(
+              LiteralUtil::CreateR2F32Linspace(-0.01, 0.01, features, features),
+              device_ordinal)
+          .ConsumeValueOrDie());
+  buffers.push_back(
+      client
+          ->LiteralToShapedBuffer(
+              LiteralUtil::CreateR1<float>(std::vector<float>(features, 0.1f)),
+              device_ordinal)
+          .ConsumeValueOrDie());
+  std::vector<const ShapedBuffer*> arguments;
+  std::vector<const Shape*> argument_shapes;
+  for (const ScopedShapedBuffer& buffer : buffers) {
+    arguments.push_back(&buffer);
+    argument_shapes.push_back(&buffer.on_host_shape());
+  }
+
+  auto executable =
+      std::move(client
+                    ->Compile(computation, argument_shapes,
+                              ExecutableBuildOptions())
+                    .ConsumeValueOrDie()[0]);
+
+  // Run some warm-up executions.
+  const int kWarmups = 2;
+  for (int i = 0; i < kWarmups; ++i) {
+    ASSERT_TRUE(executable->Run(arguments, ExecutableRunOptions()).ok());
+  }
+
+  // The bytes of the activation, written once and read by both outputs when
+  // it is materialized.
+  tensorflow::testing::BytesProcessed(static_cast<int64>(num_iters) *
+                                      batch_size * features * sizeof(float));
+  tensorflow::testing::UseRealTime();
+  tensorflow::testing::StartTiming();
+  for (int i = 0; i < num_iters; ++i) {
+    ASSERT_TRUE(executable->Run(arguments, ExecutableRunOptions()).ok());
+  }
+}
+
+BENCHMARK(BM_MlpActivationFusion)->Arg(64)->Arg(1024)->Arg(4096);
+
 }  // namespace
 }  // namespace xla
@@ -144,9 +144,15 @@ class LLVMCompilerTest : public ::testing::Test {
     executors.push_back({backend_->default_stream_executor()});
     executors.push_back({backend_->default_stream_executor()});
 
-    EXPECT_IS_OK(compiler->Compile(std::move(module_group),
-                                   std::move(executors),
-                                   /*device_allocator=*/nullptr));
+    auto executables_or = compiler->Compile(std::move(module_group),
+                                            std::move(executors),
+                                            /*device_allocator=*/nullptr);
+    ASSERT_IS_OK(executables_or.status());
+    // The modules are compiled in parallel, into one executable each.
+    const auto &executables = executables_or.ValueOrDie();
+    ASSERT_EQ(executables.size(), 2);
+    EXPECT_NE(executables[0], nullptr);
+    EXPECT_NE(executables[1], nullptr);
   }
 
  private:
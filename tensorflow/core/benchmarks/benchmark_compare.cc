@@ -0,0 +1,118 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/benchmarks/benchmark_compare.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace benchmarks {
+namespace {
+
+// Returns the wall time per iteration of `entry`, in nanoseconds.
+double WallTimeNanosPerIteration(const BenchmarkEntry& entry) {
+  return entry.iters() > 0 ? entry.wall_time() * 1e9 / entry.iters()
+                           : entry.wall_time() * 1e9;
+}
+
+}  // namespace
+
+Status ReadBenchmarkEntries(Env* env, const string& pattern,
+                            BenchmarkEntryMap* entries) {
+  std::vector<string> files;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(pattern, &files));
+  if (files.empty()) {
+    return errors::NotFound("No benchmark results match ", pattern);
+  }
+  for (const string& file : files) {
+    string contents;
+    TF_RETURN_IF_ERROR(ReadFileToString(env, file, &contents));
+    BenchmarkEntries file_entries;
+    if (!file_entries.ParseFromString(contents) &&
+        !protobuf::TextFormat::ParseFromString(contents, &file_entries)) {
+      return errors::DataLoss("Could not parse the benchmark results in ",
+                              file);
+    }
+    for (const BenchmarkEntry& entry : file_entries.entry()) {
+      (*entries)[entry.name()] = entry;
+    }
+  }
+  return Status::OK();
+}
+
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const BenchmarkEntryMap& baseline, const BenchmarkEntryMap& candidate,
+    double threshold) {
+  std::map<string, BenchmarkComparison> comparisons;
+  for (const auto& pair : baseline) {
+    BenchmarkComparison& comparison = comparisons[pair.first];
+    comparison.name = pair.first;
+    comparison.baseline_nanos = WallTimeNanosPerIteration(pair.second);
+  }
+  for (const auto& pair : candidate) {
+    BenchmarkComparison& comparison = comparisons[pair.first];
+    comparison.name = pair.first;
+    comparison.candidate_nanos = WallTimeNanosPerIteration(pair.second);
+  }
+  std::vector<BenchmarkComparison> result;
+  result.reserve(comparisons.size());
+  for (auto& pair : comparisons) {
+    BenchmarkComparison& comparison = pair.second;
+    if (comparison.baseline_nanos > 0 && comparison.candidate_nanos >= 0) {
+      comparison.relative_change =
+          comparison.candidate_nanos / comparison.baseline_nanos - 1;
+      comparison.regression = comparison.relative_change > threshold;
+    }
+    result.push_back(std::move(comparison));
+  }
+  return result;
+}
+
+string FormatComparisons(const std::vector<BenchmarkComparison>& comparisons) {
+  size_t width = 10;
+  for (const BenchmarkComparison& comparison : comparisons) {
+    width = std::max(width, comparison.name.size());
+  }
+  string result = absl::StrFormat("%-*s %14s %14s %9s\n", width, "Benchmark",
+                                  "Baseline(ns)", "Candidate(ns)", "Change");
+  for (const BenchmarkComparison& comparison : comparisons) {
+    if (comparison.baseline_nanos < 0 || comparison.candidate_nanos < 0) {
+      absl::StrAppendFormat(
+          &result, "%-*s %14s %14s %9s\n", width, comparison.name,
+          comparison.baseline_nanos < 0
+              ? "-"
+              : absl::StrFormat("%.0f", comparison.baseline_nanos),
+          comparison.candidate_nanos < 0
+              ? "-"
+              : absl::StrFormat("%.0f", comparison.candidate_nanos),
+          "missing");
+      continue;
+    }
+    absl::StrAppendFormat(&result, "%-*s %14.0f %14.0f %+8.1f%%%s\n", width,
+                          comparison.name, comparison.baseline_nanos,
+                          comparison.candidate_nanos,
+                          comparison.relative_change * 100,
+                          comparison.regression ? " REGRESSION" : "");
+  }
+  return result;
+}
+
+}  // namespace benchmarks
+}  // namespace tensorflow
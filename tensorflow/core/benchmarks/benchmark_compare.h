@@ -0,0 +1,68 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_BENCHMARKS_BENCHMARK_COMPARE_H_
+#define TENSORFLOW_CORE_BENCHMARKS_BENCHMARK_COMPARE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+namespace benchmarks {
+
+// Benchmark entries indexed by benchmark name.
+using BenchmarkEntryMap = std::map<string, BenchmarkEntry>;
+
+// Reads the `BenchmarkEntries` files matching `pattern`, i.e. the files written
+// by benchmarks run with `TEST_REPORT_FILE_PREFIX=<prefix>` when `pattern` is
+// `<prefix>*`. The files may be in the binary or the text format.
+Status ReadBenchmarkEntries(Env* env, const string& pattern,
+                            BenchmarkEntryMap* entries);
+
+// The comparison of a benchmark between a baseline and a candidate run.
+struct BenchmarkComparison {
+  string name;
+  // Wall time per iteration, in nanoseconds. Negative if the benchmark is
+  // missing from the run.
+  double baseline_nanos = -1;
+  double candidate_nanos = -1;
+  // Relative change of the wall time per iteration, e.g. 0.1 if the candidate
+  // is 10% slower than the baseline.
+  double relative_change = 0;
+  // Whether the candidate is slower than the baseline by more than the
+  // threshold.
+  bool regression = false;
+};
+
+// Compares the benchmarks of `candidate` with the ones of `baseline`, sorted by
+// name. A benchmark regresses if its wall time per iteration grows by more than
+// `threshold` (e.g. 0.05 for 5%).
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const BenchmarkEntryMap& baseline, const BenchmarkEntryMap& candidate,
+    double threshold);
+
+// Returns a human-readable table of `comparisons`.
+string FormatComparisons(const std::vector<BenchmarkComparison>& comparisons);
+
+}  // namespace benchmarks
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_BENCHMARKS_BENCHMARK_COMPARE_H_
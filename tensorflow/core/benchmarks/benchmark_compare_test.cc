@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/benchmarks/benchmark_compare.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace benchmarks {
+namespace {
+
+BenchmarkEntry MakeEntry(const string& name, int64 iters, double wall_time) {
+  BenchmarkEntry entry;
+  entry.set_name(name);
+  entry.set_iters(iters);
+  entry.set_wall_time(wall_time);
+  return entry;
+}
+
+TEST(BenchmarkCompareTest, ReadBenchmarkEntries) {
+  Env* env = Env::Default();
+  const string dir = io::JoinPath(testing::TmpDir(), "read_benchmark_entries");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+  BenchmarkEntries entries;
+  *entries.add_entry() = MakeEntry("BM_A/1", 10, 1.0);
+  TF_ASSERT_OK(WriteStringToFile(env, io::JoinPath(dir, "run_BM_A__1"),
+                                 entries.SerializeAsString()));
+  entries.Clear();
+  *entries.add_entry() = MakeEntry("BM_B", 20, 2.0);
+  TF_ASSERT_OK(WriteTextProto(env, io::JoinPath(dir, "run_BM_B"), entries));
+
+  BenchmarkEntryMap result;
+  TF_ASSERT_OK(ReadBenchmarkEntries(env, io::JoinPath(dir, "run_*"), &result));
+  ASSERT_EQ(2, result.size());
+  EXPECT_EQ(10, result["BM_A/1"].iters());
+  EXPECT_EQ(20, result["BM_B"].iters());
+
+  EXPECT_TRUE(errors::IsNotFound(
+      ReadBenchmarkEntries(env, io::JoinPath(dir, "missing_*"), &result)));
+}
+
+TEST(BenchmarkCompareTest, CompareBenchmarks) {
+  BenchmarkEntryMap baseline = {
+      {"BM_Faster", MakeEntry("BM_Faster", 100, 1.0)},
+      {"BM_Removed", MakeEntry("BM_Removed", 100, 1.0)},
+      {"BM_Same", MakeEntry("BM_Same", 100, 1.0)},
+      {"BM_Slower", MakeEntry("BM_Slower", 100, 1.0)},
+  };
+  BenchmarkEntryMap candidate = {
+      {"BM_Added", MakeEntry("BM_Added", 100, 1.0)},
+      {"BM_Faster", MakeEntry("BM_Faster", 200, 1.0)},
+      // Within the threshold.
+      {"BM_Same", MakeEntry("BM_Same", 100, 1.04)},
+      {"BM_Slower", MakeEntry("BM_Slower", 50, 1.0)},
+  };
+  std::vector<BenchmarkComparison> comparisons =
+      CompareBenchmarks(baseline, candidate, /*threshold=*/0.05);
+  ASSERT_EQ(5, comparisons.size());
+
+  EXPECT_EQ("BM_Added", comparisons[0].name);
+  EXPECT_LT(comparisons[0].baseline_nanos, 0);
+  EXPECT_FALSE(comparisons[0].regression);
+
+  EXPECT_EQ("BM_Faster", comparisons[1].name);
+  EXPECT_DOUBLE_EQ(1e7, comparisons[1].baseline_nanos);
+  EXPECT_DOUBLE_EQ(5e6, comparisons[1].candidate_nanos);
+  EXPECT_DOUBLE_EQ(-0.5, comparisons[1].relative_change);
+  EXPECT_FALSE(comparisons[1].regression);
+
+  EXPECT_EQ("BM_Removed", comparisons[2].name);
+  EXPECT_LT(comparisons[2].candidate_nanos, 0);
+  EXPECT_FALSE(comparisons[2].regression);
+
+  EXPECT_EQ("BM_Same", comparisons[3].name);
+  EXPECT_FALSE(comparisons[3].regression);
+
+  EXPECT_EQ("BM_Slower", comparisons[4].name);
+  EXPECT_DOUBLE_EQ(1.0, comparisons[4].relative_change);
+  EXPECT_TRUE(comparisons[4].regression);
+
+  const string table = FormatComparisons(comparisons);
+  EXPECT_NE(string::npos, table.find("BM_Slower"));
+  EXPECT_NE(string::npos, table.find("REGRESSION"));
+  EXPECT_NE(string::npos, table.find("missing"));
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace tensorflow
@@ -0,0 +1,77 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares two runs of benchmarks, e.g. of the suite in this directory, and
+// fails if any benchmark of the candidate run regressed. To record a run:
+//
+//   TEST_REPORT_FILE_PREFIX=/tmp/baseline/ bazel run -c opt \
+//     //tensorflow/core/benchmarks:session_benchmark_test -- --benchmarks=all
+//
+// and to compare two runs:
+//
+//   bazel run //tensorflow/core/benchmarks:compare_benchmarks -- \
+//     --baseline="/tmp/baseline/*" --candidate="/tmp/candidate/*"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/benchmarks/benchmark_compare.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+int main(int argc, char** argv) {
+  tensorflow::string baseline;
+  tensorflow::string candidate;
+  float threshold = 0.05;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("baseline", &baseline,
+                       "Pattern of the result files of the baseline run."),
+      tensorflow::Flag("candidate", &candidate,
+                       "Pattern of the result files of the candidate run."),
+      tensorflow::Flag("threshold", &threshold,
+                       "Relative increase of the wall time per iteration "
+                       "above which a benchmark regresses.")};
+  std::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  bool parsed_values_ok = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parsed_values_ok || baseline.empty() || candidate.empty()) {
+    std::cerr << usage << std::endl;
+    return 2;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+
+  tensorflow::Env* env = tensorflow::Env::Default();
+  tensorflow::benchmarks::BenchmarkEntryMap baseline_entries;
+  tensorflow::benchmarks::BenchmarkEntryMap candidate_entries;
+  tensorflow::Status status = tensorflow::benchmarks::ReadBenchmarkEntries(
+      env, baseline, &baseline_entries);
+  if (status.ok()) {
+    status = tensorflow::benchmarks::ReadBenchmarkEntries(env, candidate,
+                                                         &candidate_entries);
+  }
+  if (!status.ok()) {
+    std::cerr << status << std::endl;
+    return 2;
+  }
+  const std::vector<tensorflow::benchmarks::BenchmarkComparison> comparisons =
+      tensorflow::benchmarks::CompareBenchmarks(baseline_entries,
+                                                candidate_entries, threshold);
+  std::cout << tensorflow::benchmarks::FormatComparisons(comparisons);
+  for (const auto& comparison : comparisons) {
+    if (comparison.regression) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of tf.data input pipelines run outside of a session, on a grid of
+// batch sizes and thread counts.
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+void AddConst(const string& name, const Tensor& value, GraphDef* graph_def) {
+  TF_CHECK_OK(NodeDefBuilder(name, "Const")
+                  .Attr("dtype", value.dtype())
+                  .Attr("value", value)
+                  .Finalize(graph_def->add_node()));
+}
+
+// Returns the graph of `range(num_elements).batch(batch_size).prefetch(1)`.
+GraphDef RangeBatchPrefetchGraph(int64 num_elements, int64 batch_size) {
+  GraphDef graph_def;
+  AddConst("start", test::AsScalar<int64>(0), &graph_def);
+  AddConst("stop", test::AsScalar<int64>(num_elements), &graph_def);
+  AddConst("step", test::AsScalar<int64>(1), &graph_def);
+  AddConst("batch_size", test::AsScalar<int64>(batch_size), &graph_def);
+  AddConst("drop_remainder", test::AsScalar<bool>(false), &graph_def);
+  AddConst("buffer_size", test::AsScalar<int64>(1), &graph_def);
+  const DataTypeVector output_types = {DT_INT64};
+  TF_CHECK_OK(NodeDefBuilder("range", "RangeDataset")
+                  .Input("start", 0, DT_INT64)
+                  .Input("stop", 0, DT_INT64)
+                  .Input("step", 0, DT_INT64)
+                  .Attr("output_types", output_types)
+                  .Attr("output_shapes", {PartialTensorShape({})})
+                  .Finalize(graph_def.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("batch", "BatchDatasetV2")
+                  .Input("range", 0, DT_VARIANT)
+                  .Input("batch_size", 0, DT_INT64)
+                  .Input("drop_remainder", 0, DT_BOOL)
+                  .Attr("output_types", output_types)
+                  .Attr("output_shapes", {PartialTensorShape({-1})})
+                  .Finalize(graph_def.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("prefetch", "PrefetchDataset")
+                  .Input("batch", 0, DT_VARIANT)
+                  .Input("buffer_size", 0, DT_INT64)
+                  .Attr("output_types", output_types)
+                  .Attr("output_shapes", {PartialTensorShape({-1})})
+                  .Finalize(graph_def.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("retval", "_Retval")
+                  .Input("prefetch", 0, DT_VARIANT)
+                  .Attr("T", DT_VARIANT)
+                  .Attr("index", 0)
+                  .Finalize(graph_def.add_node()));
+  return graph_def;
+}
+
+// Produces `iters` batches of `batch_size` elements, with `num_threads`
+// threads available to the pipeline.
+void BM_RangeBatchPrefetch(int iters, int batch_size, int num_threads) {
+  testing::StopTiming();
+  standalone::Dataset::Params params;
+  params.session_options.config.set_intra_op_parallelism_threads(num_threads);
+  params.session_options.config.set_inter_op_parallelism_threads(num_threads);
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_CHECK_OK(standalone::Dataset::FromGraph(
+      params,
+      RangeBatchPrefetchGraph(static_cast<int64>(iters) * batch_size,
+                              batch_size),
+      &dataset));
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_CHECK_OK(dataset->MakeIterator(&iterator));
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch_size);
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    std::vector<Tensor> outputs;
+    bool end_of_input = false;
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    CHECK(!end_of_input);
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_RangeBatchPrefetch)->RangePair(1, 1024, 1, 16);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
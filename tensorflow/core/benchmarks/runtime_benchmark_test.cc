@@ -0,0 +1,116 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the runtime components on the hot path of every step, i.e. the
+// rendezvous and the allocators, run concurrently from a grid of thread counts.
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs `fn(thread_id)` `iters` times in total, split evenly among
+// `num_threads` threads.
+void RunConcurrently(int iters, int num_threads,
+                     const std::function<void(int)>& fn) {
+  thread::ThreadPool pool(Env::Default(), "benchmark", num_threads);
+  BlockingCounter counter(num_threads);
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int t = 0; t < num_threads; ++t) {
+    pool.Schedule([&counter, &fn, iters, num_threads, t]() {
+      for (int i = t; i < iters; i += num_threads) {
+        fn(t);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  testing::StopTiming();
+}
+
+// Allocates and frees `num_bytes` from `num_threads` threads.
+void BM_Allocator(int iters, Allocator* allocator, int num_bytes,
+                  int num_threads) {
+  testing::ItemsProcessed(iters);
+  RunConcurrently(iters, num_threads, [allocator, num_bytes](int) {
+    void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                       num_bytes);
+    CHECK(ptr != nullptr);
+    allocator->DeallocateRaw(ptr);
+  });
+}
+
+void BM_BFCAllocator(int iters, int num_bytes, int num_threads) {
+  testing::StopTiming();
+  BFCAllocator allocator(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}),
+      /*total_memory=*/1LL << 32, /*allow_growth=*/true, "benchmark_bfc");
+  BM_Allocator(iters, &allocator, num_bytes, num_threads);
+}
+BENCHMARK(BM_BFCAllocator)->RangePair(64, 1 << 20, 1, 16);
+
+void BM_CPUAllocator(int iters, int num_bytes, int num_threads) {
+  testing::StopTiming();
+  BM_Allocator(iters, cpu_allocator(), num_bytes, num_threads);
+}
+BENCHMARK(BM_CPUAllocator)->RangePair(64, 1 << 20, 1, 16);
+
+// Sends and receives tensors of `num_elements` floats through a local
+// rendezvous from `num_threads` threads, each thread using its own key.
+void BM_LocalRendezvous(int iters, int num_elements, int num_threads) {
+  testing::StopTiming();
+  Rendezvous* rendezvous = NewLocalRendezvous();
+  std::vector<Rendezvous::ParsedKey> keys(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    const string key = Rendezvous::CreateKey(
+        "/job:localhost/replica:0/task:0/cpu:0", /*src_incarnation=*/1,
+        "/job:localhost/replica:0/task:0/cpu:0", strings::StrCat("tensor", t),
+        FrameAndIter(0, 0));
+    TF_CHECK_OK(Rendezvous::ParseKey(key, &keys[t]));
+  }
+  Tensor tensor(DT_FLOAT, TensorShape({num_elements}));
+  tensor.flat<float>().setZero();
+  testing::ItemsProcessed(iters);
+  RunConcurrently(iters, num_threads, [&](int t) {
+    Rendezvous::Args args;
+    TF_CHECK_OK(rendezvous->Send(keys[t], args, tensor, /*is_dead=*/false));
+    Tensor received;
+    bool is_dead;
+    TF_CHECK_OK(rendezvous->Recv(keys[t], args, &received, &is_dead));
+  });
+  rendezvous->Unref();
+}
+BENCHMARK(BM_LocalRendezvous)->RangePair(1, 1 << 16, 1, 16);
+
+}  // namespace
+}  // namespace tensorflow
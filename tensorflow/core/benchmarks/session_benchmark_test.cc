@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end benchmarks of running steps through a session, covering the step
+// overhead of the session and the dispatch overhead of the executor on a grid
+// of graph sizes, thread counts and batch sizes.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// Creates a session for `graph` whose executors use `num_threads` threads, and
+// runs it once, so that the one-time pruning and partitioning of the graph are
+// not part of the timed runs.
+std::unique_ptr<Session> CreateSession(const Graph& graph, int num_threads,
+                                       const std::vector<string>& fetches,
+                                       const std::vector<string>& targets) {
+  GraphDef graph_def;
+  graph.ToGraphDef(&graph_def);
+  SessionOptions options;
+  options.config.set_inter_op_parallelism_threads(num_threads);
+  options.config.set_intra_op_parallelism_threads(num_threads);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_CHECK_OK(session->Create(graph_def));
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, fetches, targets, &outputs));
+  return session;
+}
+
+void RunSession(int iters, Session* session, const std::vector<string>& fetches,
+                const std::vector<string>& targets) {
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run({}, fetches, targets, &outputs));
+  }
+  testing::StopTiming();
+}
+
+// A chain of `length` Identity ops, which measures the per-op dispatch
+// overhead of the executor when the ops cannot run in parallel.
+void BM_SessionRunChain(int iters, int length, int num_threads) {
+  testing::StopTiming();
+  Graph graph(OpRegistry::Global());
+  Node* node = test::graph::Constant(&graph, test::AsScalar<float>(1));
+  for (int i = 0; i < length; ++i) {
+    node = test::graph::Identity(&graph, node);
+  }
+  const std::vector<string> fetches = {node->name()};
+  std::unique_ptr<Session> session =
+      CreateSession(graph, num_threads, fetches, {});
+  testing::ItemsProcessed(static_cast<int64>(iters) * length);
+  RunSession(iters, session.get(), fetches, {});
+}
+BENCHMARK(BM_SessionRunChain)->RangePair(1, 1024, 1, 16);
+
+// `width` independent NoOps, which measures how well the executor dispatches
+// ready ops to its threads.
+void BM_SessionRunFanOut(int iters, int width, int num_threads) {
+  testing::StopTiming();
+  Graph graph(OpRegistry::Global());
+  std::vector<Node*> nodes;
+  for (int i = 0; i < width; ++i) {
+    nodes.push_back(test::graph::NoOp(&graph, {}));
+  }
+  Node* join = test::graph::NoOp(&graph, nodes);
+  const std::vector<string> targets = {join->name()};
+  std::unique_ptr<Session> session =
+      CreateSession(graph, num_threads, {}, targets);
+  testing::ItemsProcessed(static_cast<int64>(iters) * width);
+  RunSession(iters, session.get(), {}, targets);
+}
+BENCHMARK(BM_SessionRunFanOut)->RangePair(1, 1024, 1, 16);
+
+// A [batch_size, 256] x [256, 256] MatMul, which measures the step overhead
+// relative to a typical dense layer as the batch size grows.
+void BM_SessionRunMatMul(int iters, int batch_size, int num_threads) {
+  testing::StopTiming();
+  constexpr int kDepth = 256;
+  Graph graph(OpRegistry::Global());
+  Tensor lhs(DT_FLOAT, TensorShape({batch_size, kDepth}));
+  lhs.flat<float>().setRandom();
+  Tensor rhs(DT_FLOAT, TensorShape({kDepth, kDepth}));
+  rhs.flat<float>().setRandom();
+  Node* matmul = test::graph::Matmul(
+      &graph, test::graph::Constant(&graph, lhs),
+      test::graph::Constant(&graph, rhs), /*transpose_a=*/false,
+      /*transpose_b=*/false);
+  const std::vector<string> fetches = {matmul->name()};
+  std::unique_ptr<Session> session =
+      CreateSession(graph, num_threads, fetches, {});
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch_size);
+  RunSession(iters, session.get(), fetches, {});
+}
+BENCHMARK(BM_SessionRunMatMul)->RangePair(1, 512, 1, 16);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/allocation_plan.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+int AllocationTrace::RecordAllocation(size_t num_bytes) {
+  sizes_.push_back(num_bytes);
+  allocated_at_.push_back(num_events_++);
+  deallocated_at_.push_back(-1);
+  return sizes_.size() - 1;
+}
+
+void AllocationTrace::RecordDeallocation(int index) {
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, sizes_.size());
+  DCHECK_EQ(deallocated_at_[index], -1);
+  deallocated_at_[index] = num_events_++;
+}
+
+bool AllocationTrace::operator==(const AllocationTrace& other) const {
+  return sizes_ == other.sizes_ && allocated_at_ == other.allocated_at_ &&
+         deallocated_at_ == other.deallocated_at_;
+}
+
+AllocationPlan ComputeAllocationPlan(const AllocationTrace& trace,
+                                     size_t alignment) {
+  const int n = trace.num_allocations();
+  AllocationPlan plan;
+  plan.sizes.resize(n);
+  plan.offsets.assign(n, -1);
+
+  std::vector<int> order;
+  order.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    plan.sizes[i] = (trace.size(i) + alignment - 1) / alignment * alignment;
+    if (trace.deallocated_at(i) >= 0) {
+      order.push_back(i);
+    }
+  }
+  // Place the largest allocations first, breaking ties by allocation order so
+  // that the plan is deterministic.
+  std::stable_sort(order.begin(), order.end(), [&plan](int a, int b) {
+    return plan.sizes[a] > plan.sizes[b];
+  });
+
+  // The placed allocations, in order of increasing offset.
+  std::vector<int> placed;
+  placed.reserve(order.size());
+  std::vector<int> overlapping;
+  for (int i : order) {
+    const int64 begin = trace.allocated_at(i);
+    const int64 end = trace.deallocated_at(i);
+    const size_t size = plan.sizes[i];
+
+    // Find the smallest gap between the placed allocations that are live at
+    // the same time as `i`, which is large enough to hold it.
+    overlapping.clear();
+    for (int j : placed) {
+      if (trace.allocated_at(j) < end && begin < trace.deallocated_at(j)) {
+        overlapping.push_back(j);
+      }
+    }
+    int64 best_offset = -1;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (int j : overlapping) {
+      const size_t offset = plan.offsets[j];
+      if (offset >= prev_end) {
+        const size_t gap = offset - prev_end;
+        if (gap >= size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+      }
+      prev_end = std::max(prev_end, offset + plan.sizes[j]);
+    }
+    if (best_offset < 0) {
+      best_offset = prev_end;
+    }
+    plan.offsets[i] = best_offset;
+    plan.total_bytes =
+        std::max(plan.total_bytes, static_cast<size_t>(best_offset) + size);
+
+    auto pos = std::upper_bound(placed.begin(), placed.end(), i,
+                                [&plan](int a, int b) {
+                                  return plan.offsets[a] < plan.offsets[b];
+                                });
+    placed.insert(pos, i);
+  }
+  return plan;
+}
+
+}  // namespace tensorflow
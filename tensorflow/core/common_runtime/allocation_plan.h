@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_PLAN_H_
+
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Records the sequence of allocations and deallocations made by one step.
+//
+// Allocations are identified by their index in the trace, i.e. the i-th
+// allocation of the step has index i. The lifetime of an allocation is the
+// half-open interval of "event times" between its allocation and its
+// deallocation, where every allocation or deallocation advances the time by
+// one.
+class AllocationTrace {
+ public:
+  // Records an allocation of `num_bytes`, and returns its index.
+  int RecordAllocation(size_t num_bytes);
+
+  // Records the deallocation of the allocation with the given index.
+  void RecordDeallocation(int index);
+
+  int num_allocations() const { return sizes_.size(); }
+  size_t size(int index) const { return sizes_[index]; }
+  int64 allocated_at(int index) const { return allocated_at_[index]; }
+  // Returns -1 if the allocation was not deallocated during the step.
+  int64 deallocated_at(int index) const { return deallocated_at_[index]; }
+
+  // Returns true if both traces contain the same allocations, in the same
+  // order, with the same lifetimes.
+  bool operator==(const AllocationTrace& other) const;
+  bool operator!=(const AllocationTrace& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  int64 num_events_ = 0;
+  std::vector<size_t> sizes_;
+  std::vector<int64> allocated_at_;
+  std::vector<int64> deallocated_at_;
+};
+
+// An assignment of offsets within a single buffer to the allocations of an
+// `AllocationTrace`, such that allocations whose lifetimes overlap never
+// overlap in memory.
+struct AllocationPlan {
+  // Size of the i-th allocation of the trace.
+  std::vector<size_t> sizes;
+
+  // Offset of the i-th allocation in the buffer, or -1 if the allocation is
+  // not part of the plan because it outlives the step.
+  std::vector<int64> offsets;
+
+  // Size of the buffer needed to hold all planned allocations.
+  size_t total_bytes = 0;
+};
+
+// Computes an `AllocationPlan` for `trace`, using offsets that are multiples
+// of `alignment`.
+//
+// Allocations are placed in decreasing order of size, each at the lowest
+// offset of the smallest gap between the already-placed allocations whose
+// lifetimes overlap its own ("greedy by size"). This is not optimal in
+// general, but is usually close to the peak number of live bytes of the trace,
+// which is a lower bound for any plan.
+AllocationPlan ComputeAllocationPlan(const AllocationTrace& trace,
+                                     size_t alignment);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_PLAN_H_
@@ -0,0 +1,166 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/allocation_plan.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Checks that no two planned allocations with overlapping lifetimes overlap
+// in memory, and that all allocations fit in the buffer.
+void CheckPlan(const AllocationTrace& trace, const AllocationPlan& plan) {
+  ASSERT_EQ(trace.num_allocations(), plan.offsets.size());
+  for (int i = 0; i < trace.num_allocations(); ++i) {
+    if (plan.offsets[i] < 0) {
+      EXPECT_EQ(-1, trace.deallocated_at(i));
+      continue;
+    }
+    EXPECT_GE(plan.sizes[i], trace.size(i));
+    EXPECT_LE(plan.offsets[i] + plan.sizes[i], plan.total_bytes);
+    for (int j = 0; j < i; ++j) {
+      if (plan.offsets[j] < 0) continue;
+      const bool live_together =
+          trace.allocated_at(i) < trace.deallocated_at(j) &&
+          trace.allocated_at(j) < trace.deallocated_at(i);
+      const bool overlap =
+          plan.offsets[i] < plan.offsets[j] + plan.sizes[j] &&
+          plan.offsets[j] < plan.offsets[i] + plan.sizes[i];
+      EXPECT_FALSE(live_together && overlap)
+          << "Allocations " << i << " and " << j << " overlap";
+    }
+  }
+}
+
+TEST(AllocationPlanTest, Empty) {
+  AllocationTrace trace;
+  AllocationPlan plan = ComputeAllocationPlan(trace, 256);
+  EXPECT_EQ(0, plan.total_bytes);
+  EXPECT_TRUE(plan.offsets.empty());
+}
+
+TEST(AllocationPlanTest, ReusesMemoryOfDeadAllocations) {
+  AllocationTrace trace;
+  int a = trace.RecordAllocation(1024);
+  int b = trace.RecordAllocation(1024);
+  trace.RecordDeallocation(a);
+  int c = trace.RecordAllocation(1000);
+  trace.RecordDeallocation(b);
+  trace.RecordDeallocation(c);
+
+  AllocationPlan plan = ComputeAllocationPlan(trace, 256);
+  CheckPlan(trace, plan);
+  EXPECT_EQ(2048, plan.total_bytes);
+  EXPECT_EQ(plan.offsets[a], plan.offsets[c]);
+  EXPECT_EQ(1024, plan.sizes[c]);
+}
+
+TEST(AllocationPlanTest, AllocationsThatOutliveTheStepAreNotPlanned) {
+  AllocationTrace trace;
+  int a = trace.RecordAllocation(256);
+  int b = trace.RecordAllocation(512);
+  trace.RecordDeallocation(a);
+
+  AllocationPlan plan = ComputeAllocationPlan(trace, 256);
+  CheckPlan(trace, plan);
+  EXPECT_EQ(0, plan.offsets[a]);
+  EXPECT_EQ(-1, plan.offsets[b]);
+  EXPECT_EQ(256, plan.total_bytes);
+}
+
+TEST(AllocationPlanTest, FillsSmallestGap) {
+  // `big` and `small` are live during the whole step, with a gap between
+  // them once `gap` has been deallocated.
+  AllocationTrace trace;
+  int big = trace.RecordAllocation(4096);
+  int gap = trace.RecordAllocation(1024);
+  int small = trace.RecordAllocation(2048);
+  trace.RecordDeallocation(gap);
+  int fill = trace.RecordAllocation(1024);
+  trace.RecordDeallocation(fill);
+  trace.RecordDeallocation(small);
+  trace.RecordDeallocation(big);
+
+  AllocationPlan plan = ComputeAllocationPlan(trace, 256);
+  CheckPlan(trace, plan);
+  EXPECT_EQ(4096 + 2048 + 1024, plan.total_bytes);
+  EXPECT_EQ(plan.offsets[gap], plan.offsets[fill]);
+}
+
+TEST(AllocationPlanTest, TraceEquality) {
+  AllocationTrace a;
+  AllocationTrace b;
+  EXPECT_EQ(a, b);
+  a.RecordDeallocation(a.RecordAllocation(256));
+  EXPECT_NE(a, b);
+  int x = b.RecordAllocation(256);
+  EXPECT_NE(a, b);
+  b.RecordDeallocation(x);
+  EXPECT_EQ(a, b);
+
+  // Same sizes, but different lifetimes.
+  AllocationTrace c;
+  AllocationTrace d;
+  int c0 = c.RecordAllocation(256);
+  int c1 = c.RecordAllocation(256);
+  c.RecordDeallocation(c0);
+  c.RecordDeallocation(c1);
+  int d0 = d.RecordAllocation(256);
+  int d1 = d.RecordAllocation(256);
+  d.RecordDeallocation(d1);
+  d.RecordDeallocation(d0);
+  EXPECT_NE(c, d);
+}
+
+TEST(AllocationPlanTest, RandomTraces) {
+  random::PhiloxRandom philox(123, 17);
+  random::SimplePhilox rand(&philox);
+  for (int iter = 0; iter < 20; ++iter) {
+    AllocationTrace trace;
+    std::vector<int> live;
+    size_t live_bytes = 0;
+    size_t peak_bytes = 0;
+    for (int i = 0; i < 500; ++i) {
+      if (!live.empty() && rand.OneIn(2)) {
+        int victim = rand.Uniform(live.size());
+        std::swap(live[victim], live.back());
+        trace.RecordDeallocation(live.back());
+        live_bytes -= trace.size(live.back());
+        live.pop_back();
+      } else {
+        const size_t size = 256 * (1 + rand.Uniform(64));
+        live.push_back(trace.RecordAllocation(size));
+        live_bytes += size;
+        peak_bytes = std::max(peak_bytes, live_bytes);
+      }
+    }
+    // Keep a few allocations alive past the end of the step.
+    for (size_t i = 0; i + 2 < live.size(); ++i) {
+      trace.RecordDeallocation(live[i]);
+    }
+    AllocationPlan plan = ComputeAllocationPlan(trace, 256);
+    CheckPlan(trace, plan);
+    // The peak number of live bytes is a lower bound for any plan. Greedy by
+    // size should not be far from it.
+    EXPECT_LE(plan.total_bytes, 2 * peak_bytes);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
 #include <atomic>
+#include <iterator>
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
@@ -33,9 +34,18 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Computing an `AllocationPlan` takes time quadratic in the number of
+// allocations, so we do not plan steps with more allocations than this.
+constexpr int kMaxMemoryPlanAllocations = 16384;
+
+}  // namespace
+
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
@@ -76,6 +86,35 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  Status s = ReadBoolFromEnvVar("TF_BFC_ALLOCATOR_THREAD_CACHE", false,
+                                &use_thread_caches_);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    use_thread_caches_ = false;
+  }
+  if (use_thread_caches_) {
+    VLOG(1) << "Enabling thread-local caches for " << name_;
+    thread_cache_shards_.reset(new ThreadCacheShard[kNumThreadCacheShards]);
+    cached_ptr_stripes_.reset(new CachedPtrStripe[kNumCachedPtrStripes]);
+  }
+
+  int64 memory_plan_steps = 0;
+  s = ReadInt64FromEnvVar("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS", 0,
+                          &memory_plan_steps);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  } else if (memory_plan_steps > 0) {
+    VLOG(1) << "Recording up to " << memory_plan_steps
+            << " steps to build a memory plan for " << name_;
+    memory_plan_.reset(new MemoryPlanState);
+    memory_plan_->steps_to_record = memory_plan_steps;
+  }
+
+  timeline_ = AllocationTimeline::CreateFromEnv();
+  if (timeline_ != nullptr) {
+    VLOG(1) << "Recording the allocation timeline of " << name_;
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -230,6 +269,35 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  // Like the thread caches below, the memory plan does not track when memory
+  // was freed.
+  const bool use_memory_plan =
+      memory_plan_ != nullptr && num_bytes > 0 && timing_counter_ == nullptr &&
+      allocation_attr.freed_by_func == nullptr;
+  const size_t requested_bytes = num_bytes;
+  if (use_memory_plan) {
+    void* ptr = AllocateFromMemoryPlan(num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+  // Chunks in the thread caches have no timestamps, so they cannot be used for
+  // allocations that depend on when memory was freed.
+  int size_class = -1;
+  if (use_thread_caches_ && num_bytes > 0 && timing_counter_ == nullptr &&
+      allocation_attr.freed_by_func == nullptr) {
+    size_class = ThreadCacheClassForSize(RoundedBytes(num_bytes));
+    if (size_class >= 0) {
+      void* ptr = AllocateFromThreadCache(size_class);
+      if (ptr != nullptr) {
+        return ptr;
+      }
+      // Allocate a chunk of the full size class, so that the chunk can be
+      // cached when it is deallocated.
+      num_bytes = ThreadCacheClassToSize(size_class);
+    }
+  }
+  void* result;
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -238,8 +306,8 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     if (allocation_attr.freed_by_func != nullptr) {
       freed_by_count = (*allocation_attr.freed_by_func)();
     }
-    void* result = AllocateRawInternal(unused_alignment, num_bytes,
-                                       dump_log_on_failure, freed_by_count);
+    result = AllocateRawInternal(unused_alignment, num_bytes,
+                                 dump_log_on_failure, freed_by_count);
     if (result == nullptr) {
       static std::atomic<int32> log_counter{0};
       int32 counter_value = log_counter.load(std::memory_order_relaxed);
@@ -255,11 +323,17 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
             << " memory were available.";
       }
     }
-    return result;
   } else {
-    return AllocateRawInternalWithRetry(unused_alignment, num_bytes,
-                                        allocation_attr);
+    result = AllocateRawInternalWithRetry(unused_alignment, num_bytes,
+                                          allocation_attr);
+  }
+  if (size_class >= 0 && result != nullptr) {
+    RegisterCachedPtr(result, size_class);
   }
+  if (use_memory_plan && result != nullptr) {
+    RecordAllocationForMemoryPlan(result, requested_bytes);
+  }
+  return result;
 }
 
 // static
@@ -425,6 +499,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Free chunks held by the thread caches may coalesce into a chunk that is
+  // large enough.
+  if (use_thread_caches_ && FlushThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -461,6 +545,7 @@ double BFCAllocator::GetFragmentation() {
 
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
+  RecordTimelineEvent(chunk->ptr, chunk->size);
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
 }
 
@@ -617,6 +702,13 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (memory_plan_ != nullptr && ptr != nullptr &&
+      DeallocateToMemoryPlan(ptr)) {
+    return;
+  }
+  if (use_thread_caches_ && ptr != nullptr && DeallocateToThreadCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -627,7 +719,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  FreeChunkPtr(ptr);
+}
 
+void BFCAllocator::FreeChunkPtr(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -649,6 +744,7 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
 
   // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
   // correct aggregation stats (bytes_in_use, fragmentation).
+  RecordTimelineEvent(chunk_ptr, -alloc_bytes);
   AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
 
   if (VLOG_IS_ON(4)) {
@@ -779,6 +875,213 @@ BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
   return coalesced_chunk;
 }
 
+void BFCAllocator::NotifyStepEnd(int64 step_id) {
+  if (timeline_ == nullptr) {
+    return;
+  }
+  mutex_lock report_lock(report_mu_);
+  AllocationTimelineReport report = timeline_->Report();
+  {
+    mutex_lock l(lock_);
+    report.largest_free_chunk_bytes = LargestFreeChunk();
+    if (static_cast<int64>(total_region_allocated_bytes_) >
+        stats_.bytes_in_use) {
+      report.fragmentation = GetFragmentation();
+    }
+  }
+  VLOG(1) << "Memory use of " << name_ << " in step " << step_id << ": "
+          << report.DebugString();
+  last_step_report_ = std::move(report);
+}
+
+absl::optional<AllocationTimelineReport> BFCAllocator::LastStepMemoryReport() {
+  mutex_lock l(report_mu_);
+  return last_step_report_;
+}
+
+void BFCAllocator::NotifyStepBegin() {
+  if (memory_plan_ == nullptr) {
+    return;
+  }
+  MemoryPlanState* state = memory_plan_.get();
+  size_t total_bytes = 0;
+  {
+    mutex_lock l(state->mu);
+    switch (state->mode) {
+      case MemoryPlanState::kRecording:
+        break;
+      case MemoryPlanState::kReplaying:
+        // The plan can only be followed from the start if the previous steps
+        // have released all of their planned allocations.
+        state->next_index = 0;
+        state->diverged = !state->live.empty();
+        if (state->diverged) {
+          VLOG(1) << "Not replaying the memory plan of " << name_
+                  << " because " << state->live.size()
+                  << " planned allocations are still live";
+          ++state->num_divergences;
+        }
+        return;
+      case MemoryPlanState::kPlanning:
+      case MemoryPlanState::kDisabled:
+        return;
+    }
+
+    ++state->num_steps;
+    state->recorded_ptrs.clear();
+    bool have_plan = false;
+    if (state->current_trace != nullptr) {
+      if (state->previous_trace != nullptr &&
+          *state->previous_trace == *state->current_trace) {
+        state->plan = ComputeAllocationPlan(*state->current_trace,
+                                            kMinAllocationSize);
+        have_plan = true;
+      }
+      state->previous_trace = std::move(state->current_trace);
+    }
+    if (!have_plan) {
+      if (state->num_steps > state->steps_to_record) {
+        VLOG(1) << "Giving up on building a memory plan for " << name_
+                << ": no two consecutive steps out of "
+                << state->steps_to_record
+                << " made the same sequence of allocations";
+        state->mode = MemoryPlanState::kDisabled;
+        state->previous_trace.reset();
+      } else {
+        state->current_trace.reset(new AllocationTrace);
+      }
+      return;
+    }
+    state->previous_trace.reset();
+    total_bytes = state->plan.total_bytes;
+    if (total_bytes == 0) {
+      state->mode = MemoryPlanState::kDisabled;
+      return;
+    }
+    state->mode = MemoryPlanState::kPlanning;
+  }
+
+  // The plan buffer is an ordinary chunk, which is never deallocated.
+  void* base = AllocateRawInternal(kAllocatorAlignment, total_bytes,
+                                   /*dump_log_on_failure=*/false,
+                                   /*freed_before_count=*/0);
+  mutex_lock l(state->mu);
+  if (base == nullptr) {
+    LOG(WARNING) << "Allocator (" << Name() << ") could not reserve "
+                 << strings::HumanReadableNumBytes(total_bytes)
+                 << " for its memory plan; falling back to BFC allocation.";
+    state->mode = MemoryPlanState::kDisabled;
+    state->plan = AllocationPlan();
+    return;
+  }
+  LOG(INFO) << "Allocator (" << Name() << ") is replaying a memory plan of "
+            << state->plan.sizes.size() << " allocations in "
+            << strings::HumanReadableNumBytes(total_bytes);
+  state->base = static_cast<char*>(base);
+  state->mode = MemoryPlanState::kReplaying;
+  state->next_index = 0;
+  state->diverged = false;
+}
+
+void* BFCAllocator::AllocateFromMemoryPlan(size_t num_bytes) {
+  MemoryPlanState* state = memory_plan_.get();
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  mutex_lock l(state->mu);
+  if (state->mode != MemoryPlanState::kReplaying || state->diverged) {
+    return nullptr;
+  }
+  const AllocationPlan& plan = state->plan;
+  const int index = state->next_index;
+  bool diverged = index >= static_cast<int>(plan.sizes.size()) ||
+                  plan.sizes[index] != rounded_bytes;
+  if (!diverged) {
+    ++state->next_index;
+    if (plan.offsets[index] < 0) {
+      // The allocation outlives the step, so it is served by the bins.
+      return nullptr;
+    }
+    // Even if the step makes the same allocations as the recorded one, they
+    // may be deallocated in a different order. Never hand out a range that
+    // overlaps a live planned allocation.
+    const size_t offset = plan.offsets[index];
+    auto it = state->live.lower_bound(offset);
+    if (it != state->live.end() && it->first < offset + rounded_bytes) {
+      diverged = true;
+    } else if (it != state->live.begin()) {
+      auto prev = std::prev(it);
+      diverged = prev->first + plan.sizes[prev->second.index] > offset;
+    }
+    if (!diverged) {
+      state->live.emplace_hint(
+          it, offset,
+          MemoryPlanState::PlannedAllocation{index, num_bytes,
+                                             state->next_allocation_id--});
+      ++state->num_planned_allocs;
+      return state->base + offset;
+    }
+  }
+  VLOG(1) << "Step diverged from the memory plan of " << name_
+          << " at allocation " << index;
+  state->diverged = true;
+  ++state->num_divergences;
+  return nullptr;
+}
+
+void BFCAllocator::RecordAllocationForMemoryPlan(const void* ptr,
+                                                 size_t num_bytes) {
+  MemoryPlanState* state = memory_plan_.get();
+  mutex_lock l(state->mu);
+  if (state->mode != MemoryPlanState::kRecording ||
+      state->current_trace == nullptr) {
+    return;
+  }
+  if (state->current_trace->num_allocations() >= kMaxMemoryPlanAllocations) {
+    VLOG(1) << "Not building a memory plan for " << name_
+            << " because steps make more than " << kMaxMemoryPlanAllocations
+            << " allocations";
+    state->mode = MemoryPlanState::kDisabled;
+    state->previous_trace.reset();
+    state->current_trace.reset();
+    state->recorded_ptrs.clear();
+    return;
+  }
+  state->recorded_ptrs[ptr] =
+      state->current_trace->RecordAllocation(RoundedBytes(num_bytes));
+}
+
+bool BFCAllocator::DeallocateToMemoryPlan(const void* ptr) {
+  MemoryPlanState* state = memory_plan_.get();
+  mutex_lock l(state->mu);
+  if (state->mode == MemoryPlanState::kRecording) {
+    auto it = state->recorded_ptrs.find(ptr);
+    if (it != state->recorded_ptrs.end()) {
+      state->current_trace->RecordDeallocation(it->second);
+      state->recorded_ptrs.erase(it);
+    }
+    return false;
+  }
+  if (FindPlannedAllocation(ptr) == nullptr) {
+    return false;
+  }
+  state->live.erase(static_cast<const char*>(ptr) - state->base);
+  return true;
+}
+
+const BFCAllocator::MemoryPlanState::PlannedAllocation*
+BFCAllocator::FindPlannedAllocation(const void* ptr) const {
+  const MemoryPlanState* state = memory_plan_.get();
+  const char* p = static_cast<const char*>(ptr);
+  if (state->base == nullptr || p < state->base ||
+      p >= state->base + state->plan.total_bytes) {
+    return nullptr;
+  }
+  auto it = state->live.find(p - state->base);
+  CHECK(it != state->live.end())
+      << "Pointer " << ptr << " in the memory plan of " << name_
+      << " is not allocated";
+  return &it->second;
+}
+
 void BFCAllocator::SetSafeFrontier(uint64 count) {
   uint64 current = safe_frontier_.load(std::memory_order_relaxed);
   while (count > current) {
@@ -866,10 +1169,178 @@ bool BFCAllocator::MergeTimestampedChunks(size_t required_bytes) {
   return satisfied;
 }
 
+// static
+int BFCAllocator::ThreadCacheClassForSize(size_t rounded_bytes) {
+  DCHECK_GE(rounded_bytes, kMinAllocationSize);
+  if (rounded_bytes > ThreadCacheClassToSize(kNumThreadCacheClasses - 1)) {
+    return -1;
+  }
+  const int size_class = Log2Ceiling64(rounded_bytes >> kMinAllocationBits);
+  DCHECK_GE(ThreadCacheClassToSize(size_class), rounded_bytes);
+  return size_class;
+}
+
+// static
+size_t BFCAllocator::ThreadCacheCapacity(int size_class) {
+  return std::max<size_t>(
+      4, kThreadCacheBytesPerClass / ThreadCacheClassToSize(size_class));
+}
+
+BFCAllocator::ThreadCacheShard* BFCAllocator::CurrentThreadCacheShard() {
+  // Threads are assigned to shards round-robin, the first time they allocate
+  // from any BFCAllocator.
+  static std::atomic<int> next_shard{0};
+  static thread_local int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) %
+      kNumThreadCacheShards;
+  return &thread_cache_shards_[shard];
+}
+
+BFCAllocator::CachedPtrStripe* BFCAllocator::CachedPtrStripeFor(
+    const void* ptr) {
+  const uintptr_t p = reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+  return &cached_ptr_stripes_[p % kNumCachedPtrStripes];
+}
+
+void* BFCAllocator::AllocateFromThreadCache(int size_class) {
+  ThreadCacheShard* shard = CurrentThreadCacheShard();
+  {
+    mutex_lock l(shard->mu);
+    std::vector<void*>& free_chunks = shard->free_chunks[size_class];
+    if (!free_chunks.empty()) {
+      void* ptr = free_chunks.back();
+      free_chunks.pop_back();
+      ++shard->num_hits;
+      shard->bytes_cached -= ThreadCacheClassToSize(size_class);
+      return ptr;
+    }
+    ++shard->num_misses;
+  }
+
+  // Refill the cache with a batch of free chunks, taking the allocator lock
+  // only once. We do not extend the allocator to refill the cache; if there
+  // are no free chunks, the caller falls back to the regular allocation path.
+  const size_t class_bytes = ThreadCacheClassToSize(size_class);
+  const size_t batch_size = std::min<size_t>(
+      32, std::max<size_t>(1, ThreadCacheCapacity(size_class) / 4));
+  std::vector<void*> batch;
+  batch.reserve(batch_size);
+  {
+    mutex_lock l(lock_);
+    const BinNum bin_num = BinNumForSize(class_bytes);
+    while (batch.size() < batch_size) {
+      void* ptr = FindChunkPtr(bin_num, class_bytes, class_bytes, 0);
+      if (ptr == nullptr) break;
+      AddTraceMe("MemoryAllocation", ptr);
+      batch.push_back(ptr);
+    }
+  }
+  if (batch.empty()) {
+    return nullptr;
+  }
+  for (void* ptr : batch) {
+    RegisterCachedPtr(ptr, size_class);
+  }
+  void* result = batch.back();
+  batch.pop_back();
+  if (!batch.empty()) {
+    mutex_lock l(shard->mu);
+    std::vector<void*>& free_chunks = shard->free_chunks[size_class];
+    free_chunks.insert(free_chunks.end(), batch.begin(), batch.end());
+    shard->bytes_cached += batch.size() * class_bytes;
+  }
+  return result;
+}
+
+void BFCAllocator::RegisterCachedPtr(const void* ptr, int size_class) {
+  CachedPtrStripe* stripe = CachedPtrStripeFor(ptr);
+  mutex_lock l(stripe->mu);
+  stripe->size_classes[ptr] = size_class;
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  int size_class;
+  {
+    CachedPtrStripe* stripe = CachedPtrStripeFor(ptr);
+    mutex_lock l(stripe->mu);
+    auto it = stripe->size_classes.find(ptr);
+    if (it == stripe->size_classes.end()) {
+      return false;
+    }
+    size_class = it->second;
+  }
+
+  const size_t class_bytes = ThreadCacheClassToSize(size_class);
+  std::vector<void*> overflow;
+  {
+    ThreadCacheShard* shard = CurrentThreadCacheShard();
+    mutex_lock l(shard->mu);
+    std::vector<void*>& free_chunks = shard->free_chunks[size_class];
+    if (free_chunks.size() >= ThreadCacheCapacity(size_class)) {
+      // The cache is full: return the older half of it to the bins in one
+      // batch.
+      const size_t num_released = free_chunks.size() / 2;
+      overflow.assign(free_chunks.begin(),
+                      free_chunks.begin() + num_released);
+      free_chunks.erase(free_chunks.begin(),
+                        free_chunks.begin() + num_released);
+      shard->bytes_cached -= num_released * class_bytes;
+    }
+    free_chunks.push_back(ptr);
+    shard->bytes_cached += class_bytes;
+  }
+  if (!overflow.empty()) {
+    {
+      mutex_lock l(lock_);
+      ReleaseCachedChunks(overflow);
+    }
+    retry_helper_.NotifyDealloc();
+  }
+  return true;
+}
+
+void BFCAllocator::ReleaseCachedChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    {
+      CachedPtrStripe* stripe = CachedPtrStripeFor(ptr);
+      mutex_lock l(stripe->mu);
+      stripe->size_classes.erase(ptr);
+    }
+    FreeChunkPtr(ptr);
+  }
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  std::vector<void*> ptrs;
+  for (int i = 0; i < kNumThreadCacheShards; ++i) {
+    ThreadCacheShard* shard = &thread_cache_shards_[i];
+    mutex_lock l(shard->mu);
+    for (std::vector<void*>& free_chunks : shard->free_chunks) {
+      ptrs.insert(ptrs.end(), free_chunks.begin(), free_chunks.end());
+      free_chunks.clear();
+    }
+    shard->bytes_cached = 0;
+  }
+  if (ptrs.empty()) {
+    return false;
+  }
+  VLOG(1) << "Flushing " << ptrs.size() << " chunks from the thread caches of "
+          << Name();
+  ReleaseCachedChunks(ptrs);
+  return true;
+}
+
 bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  if (memory_plan_ != nullptr) {
+    mutex_lock l(memory_plan_->mu);
+    const MemoryPlanState::PlannedAllocation* a = FindPlannedAllocation(ptr);
+    if (a != nullptr) {
+      return a->requested_size;
+    }
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -879,6 +1350,13 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
+  if (memory_plan_ != nullptr) {
+    mutex_lock l(memory_plan_->mu);
+    const MemoryPlanState::PlannedAllocation* a = FindPlannedAllocation(ptr);
+    if (a != nullptr) {
+      return memory_plan_->plan.sizes[a->index];
+    }
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -888,6 +1366,13 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64 BFCAllocator::AllocationId(const void* ptr) const {
+  if (memory_plan_ != nullptr) {
+    mutex_lock l(memory_plan_->mu);
+    const MemoryPlanState::PlannedAllocation* a = FindPlannedAllocation(ptr);
+    if (a != nullptr) {
+      return a->allocation_id;
+    }
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1140,11 +1625,49 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
+  int64 num_hits = 0;
+  int64 num_misses = 0;
+  int64 bytes_cached = 0;
+  if (use_thread_caches_) {
+    for (int i = 0; i < kNumThreadCacheShards; ++i) {
+      ThreadCacheShard* shard = &thread_cache_shards_[i];
+      mutex_lock l(shard->mu);
+      num_hits += shard->num_hits;
+      num_misses += shard->num_misses;
+      bytes_cached += shard->bytes_cached;
+    }
+  }
+  int64 num_planned_allocs = 0;
+  int64 num_plan_divergences = 0;
+  if (memory_plan_ != nullptr) {
+    mutex_lock l(memory_plan_->mu);
+    num_planned_allocs = memory_plan_->num_planned_allocs;
+    num_plan_divergences = memory_plan_->num_divergences;
+  }
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.num_planned_allocs = num_planned_allocs;
+  stats.num_plan_divergences = num_plan_divergences;
+  stats.num_thread_cache_hits = num_hits;
+  stats.num_thread_cache_misses = num_misses;
+  stats.bytes_in_thread_caches = bytes_cached;
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
+  if (use_thread_caches_) {
+    for (int i = 0; i < kNumThreadCacheShards; ++i) {
+      ThreadCacheShard* shard = &thread_cache_shards_[i];
+      mutex_lock l(shard->mu);
+      shard->num_hits = 0;
+      shard->num_misses = 0;
+    }
+  }
+  if (memory_plan_ != nullptr) {
+    mutex_lock l(memory_plan_->mu);
+    memory_plan_->num_planned_allocs = 0;
+    memory_plan_->num_divergences = 0;
+  }
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
@@ -18,14 +18,18 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/allocation_plan.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
+#include "tensorflow/core/framework/allocation_timeline.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -46,6 +50,23 @@ class MemoryDump;
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If the TF_BFC_ALLOCATOR_THREAD_CACHE environment variable is set to true,
+// small allocations (up to 64KiB) are served from per-thread caches of free
+// chunks, rounded up to power-of-two size classes. The caches are refilled
+// from, and returned to, the BFC bins in batches, so that most small
+// allocations and deallocations do not need to acquire the allocator-wide
+// lock. Chunks held by the caches count towards `bytes_in_use`.
+//
+// If the TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS environment variable is set to
+// N > 0, the allocator records the sequence of allocations made by each of the
+// first N steps (as delimited by `NotifyStepBegin()`). As soon as two
+// consecutive steps make exactly the same sequence of allocations, it computes
+// an `AllocationPlan` for that sequence, reserves a single buffer for it, and
+// serves the allocations of later steps at their planned offsets in that
+// buffer. This avoids the fragmentation of long-running jobs with a fixed
+// allocation pattern. A step that diverges from the plan falls back to the BFC
+// bins for the rest of the step.
 class BFCAllocator : public Allocator {
  public:
   // Takes ownership of sub_allocator.
@@ -81,6 +102,15 @@ class BFCAllocator : public Allocator {
 
   void SetSafeFrontier(uint64 count) override;
 
+  void NotifyStepBegin() override;
+
+  // Reports the memory use of the step that ended, when the environment
+  // variable TF_ALLOCATION_TIMELINE_EVENTS enables the allocation timeline.
+  void NotifyStepEnd(int64 step_id) override;
+
+  // Returns the report made by the last NotifyStepEnd(), if any.
+  absl::optional<AllocationTimelineReport> LastStepMemoryReport();
+
   bool ShouldRecordOpName() const { return true; }
 
   MemoryDump RecordMemoryMap();
@@ -98,6 +128,122 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns the chunk that contains `ptr` to the bins.
+  void FreeChunkPtr(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Thread-local caches of free chunks for small size classes. Each thread is
+  // assigned to one of `kNumThreadCacheShards` shards, which are only
+  // contended by threads that share a shard.
+  static constexpr int kNumThreadCacheClasses = 9;  // 256B to 64KiB.
+  static constexpr int kNumThreadCacheShards = 16;
+  static constexpr int kNumCachedPtrStripes = 64;
+  // Maximum number of bytes held by one shard for each size class.
+  static constexpr size_t kThreadCacheBytesPerClass = 256 << 10;
+
+  struct ThreadCacheShard {
+    mutex mu;
+    std::vector<void*> free_chunks[kNumThreadCacheClasses] TF_GUARDED_BY(mu);
+    int64 num_hits TF_GUARDED_BY(mu) = 0;
+    int64 num_misses TF_GUARDED_BY(mu) = 0;
+    int64 bytes_cached TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Maps the pointers of the chunks that may be returned to a thread cache to
+  // their size class. The map is striped by address so that deallocations
+  // from different threads rarely contend.
+  struct CachedPtrStripe {
+    mutex mu;
+    absl::flat_hash_map<const void*, int> size_classes TF_GUARDED_BY(mu);
+  };
+
+  // Returns the size class for an allocation of `rounded_bytes`, or -1 if
+  // allocations of that size are not cached.
+  static int ThreadCacheClassForSize(size_t rounded_bytes);
+  static size_t ThreadCacheClassToSize(int size_class) {
+    return kMinAllocationSize << size_class;
+  }
+  static size_t ThreadCacheCapacity(int size_class);
+
+  ThreadCacheShard* CurrentThreadCacheShard();
+  CachedPtrStripe* CachedPtrStripeFor(const void* ptr);
+
+  // Returns a chunk of `size_class` from the calling thread's cache, refilling
+  // the cache with a batch of free chunks from the bins on a miss. Returns
+  // nullptr if the bins have no free chunks that fit the size class.
+  void* AllocateFromThreadCache(int size_class);
+
+  // Records that the chunk at `ptr` belongs to `size_class`, so that it is
+  // returned to a thread cache when it is deallocated.
+  void RegisterCachedPtr(const void* ptr, int size_class);
+
+  // Returns true if the chunk at `ptr` was returned to the calling thread's
+  // cache.
+  bool DeallocateToThreadCache(void* ptr);
+
+  // Returns the chunks at `ptrs`, which were held by thread caches, to the
+  // bins.
+  void ReleaseCachedChunks(const std::vector<void*>& ptrs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns every chunk held by the thread caches to the bins. Returns true if
+  // any chunk was released.
+  bool FlushThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // State of the memory plan (see the class comment). Only allocated if
+  // TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS is set.
+  struct MemoryPlanState {
+    // Steps are recorded until two consecutive traces are identical. The mode
+    // is `kPlanning` while the plan buffer is being reserved.
+    enum Mode { kRecording, kPlanning, kReplaying, kDisabled };
+
+    // An allocation served from the plan buffer.
+    struct PlannedAllocation {
+      int index;  // Index in the plan.
+      size_t requested_size;
+      int64 allocation_id;
+    };
+
+    mutex mu;
+    Mode mode TF_GUARDED_BY(mu) = kRecording;
+    int64 steps_to_record = 0;
+    int64 num_steps TF_GUARDED_BY(mu) = 0;
+
+    // Recording state.
+    std::unique_ptr<AllocationTrace> previous_trace TF_GUARDED_BY(mu);
+    std::unique_ptr<AllocationTrace> current_trace TF_GUARDED_BY(mu);
+    // Maps the pointers allocated during the current step to their index in
+    // `current_trace`.
+    absl::flat_hash_map<const void*, int> recorded_ptrs TF_GUARDED_BY(mu);
+
+    // Replay state.
+    AllocationPlan plan TF_GUARDED_BY(mu);
+    // The buffer of `plan.total_bytes` bytes.
+    char* base TF_GUARDED_BY(mu) = nullptr;
+    int next_index TF_GUARDED_BY(mu) = 0;
+    bool diverged TF_GUARDED_BY(mu) = false;
+    // The live planned allocations, keyed by their offset in the buffer.
+    std::map<size_t, PlannedAllocation> live TF_GUARDED_BY(mu);
+    int64 next_allocation_id TF_GUARDED_BY(mu) = -1;
+    int64 num_planned_allocs TF_GUARDED_BY(mu) = 0;
+    int64 num_divergences TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Returns a buffer of `rounded_bytes` from the memory plan, or nullptr if
+  // the allocation must be served by the bins.
+  void* AllocateFromMemoryPlan(size_t rounded_bytes);
+
+  // Records an allocation served by the bins in the trace of the current step.
+  void RecordAllocationForMemoryPlan(const void* ptr, size_t rounded_bytes);
+
+  // Returns true if `ptr` was served by the memory plan (and has now been
+  // released).
+  bool DeallocateToMemoryPlan(const void* ptr);
+
+  // Returns the planned allocation at `ptr`, or nullptr if `ptr` was not
+  // allocated from the plan buffer.
+  const MemoryPlanState::PlannedAllocation* FindPlannedAllocation(
+      const void* ptr) const TF_EXCLUSIVE_LOCKS_REQUIRED(memory_plan_->mu);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -130,6 +276,15 @@ class BFCAllocator : public Allocator {
                   int64 req_bytes, int64 alloc_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Records an allocation (or a deallocation, if `bytes` is negative) in the
+  // timeline, if enabled.
+  void RecordTimelineEvent(const void* chunk_ptr, int64 bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    if (timeline_ != nullptr) {
+      timeline_->Record(chunk_ptr, bytes, stats_.bytes_in_use);
+    }
+  }
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   typedef size_t ChunkHandle;
@@ -547,6 +702,19 @@ class BFCAllocator : public Allocator {
   // newly-created chunk.
   int64 next_allocation_id_ TF_GUARDED_BY(lock_);
 
+  // Thread-local caches. Only allocated if `use_thread_caches_` is true.
+  bool use_thread_caches_ = false;
+  std::unique_ptr<ThreadCacheShard[]> thread_cache_shards_;
+  std::unique_ptr<CachedPtrStripe[]> cached_ptr_stripes_;
+
+  std::unique_ptr<MemoryPlanState> memory_plan_;
+
+  // Only allocated if TF_ALLOCATION_TIMELINE_EVENTS is set.
+  std::unique_ptr<AllocationTimeline> timeline_;
+  mutex report_mu_;
+  absl::optional<AllocationTimelineReport> last_step_report_
+      TF_GUARDED_BY(report_mu_);
+
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
 #ifdef TENSORFLOW_MEM_DEBUG
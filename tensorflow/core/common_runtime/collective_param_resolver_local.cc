@@ -66,7 +66,11 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      if (cp->instance.impl_details.communication_hint == "torus") {
+        return "HierarchicalTorusReduce";
+      }
+      return "RingReduce";
 
     case GATHER_COLLECTIVE:
       return "RingGather";
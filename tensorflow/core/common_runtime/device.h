@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -51,6 +52,12 @@ limitations under the License.
 
 namespace tensorflow {
 
+class StepArenaPool;
+
+// The device contexts of the nodes of a graph, indexed by node id. A null
+// entry means that the node runs with the context of its executor.
+typedef std::vector<DeviceContext*> DeviceContextMap;
+
 class Device : public DeviceBase {
  public:
   // Callback type that takes a Status and returns void.
@@ -151,6 +158,24 @@ class Device : public DeviceBase {
     return Status::OK();
   }
 
+  // Fills in `device_context_map` with the context that each node of `graph`
+  // should run with, for devices that run different nodes of a graph with
+  // different contexts (e.g. on different streams). Leaves the map empty if
+  // every node runs with the context from TryGetDeviceContext(), which is the
+  // default.
+  //
+  // The caller takes ownership of one reference on each non-null entry of the
+  // map, and should call Unref() on them.
+  virtual Status FillContextMap(const Graph* graph,
+                                DeviceContextMap* device_context_map) {
+    return Status::OK();
+  }
+
+  // Returns the pool of per-step arenas from which the executor may allocate
+  // tensors that do not outlive a step, or nullptr if the device does not
+  // support step arenas. See `StepArenaAllocator`.
+  virtual StepArenaPool* step_arena_pool() { return nullptr; }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_segment.h"
 #include "tensorflow/core/framework/run_handler.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -152,6 +153,58 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns the batch sizes listed, comma separated, in the environment variable
+// TF_DIRECT_SESSION_SPECIALIZED_BATCH_SIZES.
+std::unordered_set<int64> SpecializedBatchSizesFromEnvironment() {
+  string batch_sizes_str;
+  Status s = ReadStringFromEnvVar("TF_DIRECT_SESSION_SPECIALIZED_BATCH_SIZES",
+                                  "", &batch_sizes_str);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+    return {};
+  }
+  std::unordered_set<int64> batch_sizes;
+  for (StringPiece batch_size_str :
+       str_util::Split(batch_sizes_str, ',', str_util::SkipEmpty())) {
+    int64 batch_size;
+    if (!strings::safe_strto64(batch_size_str, &batch_size) ||
+        batch_size <= 0) {
+      LOG(ERROR) << "Ignoring invalid specialized batch size: "
+                 << batch_size_str;
+      continue;
+    }
+    batch_sizes.insert(batch_size);
+  }
+  return batch_sizes;
+}
+
+// Returns the shapes of `inputs` by node name if they all share a batch size
+// (the size of their first dimension) from `batch_sizes`, or an empty map if
+// the graph shouldn't be specialized for them.
+std::unordered_map<string, TensorShape> SpecializedFeedShapes(
+    const std::vector<std::pair<string, Tensor>>& inputs,
+    const std::unordered_set<int64>& batch_sizes) {
+  std::unordered_map<string, TensorShape> feed_shapes;
+  if (batch_sizes.empty() || inputs.empty()) {
+    return feed_shapes;
+  }
+  const int64 batch_size =
+      inputs[0].second.dims() > 0 ? inputs[0].second.dim_size(0) : -1;
+  if (batch_sizes.count(batch_size) == 0) {
+    return feed_shapes;
+  }
+  for (const auto& input : inputs) {
+    const TensorId id = ParseTensorName(input.first);
+    const Tensor& tensor = input.second;
+    if (id.index() != 0 || tensor.dtype() == DT_RESOURCE ||
+        tensor.dims() == 0 || tensor.dim_size(0) != batch_size) {
+      return {};
+    }
+    feed_shapes.emplace(string(id.node()), tensor.shape());
+  }
+  return feed_shapes;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -345,6 +398,13 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  specialized_batch_sizes_ = SpecializedBatchSizesFromEnvironment();
+  const Status share_status =
+      ReadBoolFromEnvVar("TF_DIRECT_SESSION_SHARE_STATELESS_KERNELS", false,
+                         &share_stateless_kernels_);
+  if (!share_status.ok()) {
+    LOG(ERROR) << share_status.error_message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -625,6 +685,16 @@ Status DirectSession::RunInternal(
     };
   }
 
+  // Notify the allocator of each device used by this step, once per device,
+  // when the step begins and ends.
+  absl::flat_hash_set<Allocator*> step_allocators;
+  for (const auto& item : executors_and_keys->items) {
+    Allocator* allocator = item.device->GetAllocator(AllocatorAttributes());
+    if (step_allocators.insert(allocator).second) {
+      allocator->NotifyStepBegin();
+    }
+  }
+
   // Start parallel Executors.
 
   // We can execute this step synchronously on the calling thread whenever
@@ -753,6 +823,10 @@ Status DirectSession::RunInternal(
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
 
+  for (Allocator* allocator : step_allocators) {
+    allocator->NotifyStepEnd(step_id);
+  }
+
   if (profiler_session) {
     TF_RETURN_IF_ERROR(profiler_session->CollectData(run_metadata));
   }
@@ -785,6 +859,14 @@ Status DirectSession::RunInternal(
     mutex_lock l(executor_lock_);
     run_state.collector->BuildCostModel(&cost_model_manager_, device_to_graph);
 
+    // Let the executors use the measured kernel costs to decide which kernels
+    // are cheap enough to run inline.
+    for (const auto& item : executors_and_keys->items) {
+      item.executor->UpdateCostEstimates(
+          *item.graph,
+          *cost_model_manager_.FindOrCreateCostModel(item.graph.get()));
+    }
+
     // annotate stats onto cost graph.
     CostGraphDef* cost_graph = run_metadata->mutable_cost_graph();
     for (const auto& item : executors_and_keys->items) {
@@ -850,6 +932,8 @@ Status DirectSession::Run(const RunOptions& run_options,
   RunStateArgs run_state_args(run_options.debug_options());
   run_state_args.collective_graph_key =
       run_options.experimental().collective_graph_key();
+  run_state_args.feed_shapes =
+      SpecializedFeedShapes(inputs, specialized_batch_sizes_);
 
   TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
                                           target_nodes, &executors_and_keys,
@@ -1296,6 +1380,7 @@ Status DirectSession::CreateExecutors(
   options.use_function_convention = !run_state_args->is_partial_run;
   options.collective_graph_key =
       callable_options.run_options().experimental().collective_graph_key();
+  options.feed_shapes = run_state_args->feed_shapes;
   if (options_.config.experimental()
           .collective_deterministic_sequential_execution()) {
     options.collective_order = GraphCollectiveOrder::kEdges;
@@ -1380,20 +1465,30 @@ Status DirectSession::CreateExecutors(
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
           // is stateful, the `CallOp` that invokes it is not.
-          if (!OpSegment::ShouldOwnKernel(lib, props->node_def.op())) {
-            return lib->CreateKernel(props, kernel);
-          }
           auto create_fn = [lib, &props](OpKernel** kernel) {
             return lib->CreateKernel(props, kernel);
           };
+          if (share_stateless_kernels_ &&
+              SharedKernelCache::ShouldShareKernel(lib, props->node_def)) {
+            // Stateless kernels are shared with the other sessions of the
+            // process that run the same node on a device of the same name.
+            return SharedKernelCache::Global()->FindOrCreate(
+                lib->device()->name(), lib->graph_def_version(),
+                props->node_def, kernel, create_fn);
+          }
+          if (!OpSegment::ShouldOwnKernel(lib, props->node_def.op())) {
+            return lib->CreateKernel(props, kernel);
+          }
           // Kernels created for subgraph nodes need to be cached.  On
           // cache miss, create_fn() is invoked to create a kernel based
           // on the function library here + global op registry.
           return opseg->FindOrCreate(session_handle_, props->node_def.name(),
                                      kernel, create_fn);
         };
-    params.delete_kernel = [lib](OpKernel* kernel) {
-      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
+    params.delete_kernel = [lib, share = share_stateless_kernels_](
+                               OpKernel* kernel) {
+      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()) &&
+          !(share && SharedKernelCache::Global()->Release(kernel)))
         delete kernel;
     };
 
@@ -1476,11 +1571,24 @@ Status DirectSession::GetOrCreateExecutors(
         run_state_args->debug_options.debug_tensor_watch_opts());
   }
 
+  // Graphs specialized for the shapes of the feeds are cached separately from
+  // the generic graph.
+  string feed_shapes_summary;
+  if (!run_state_args->feed_shapes.empty()) {
+    std::vector<string> feed_shapes;
+    for (const auto& feed_shape : run_state_args->feed_shapes) {
+      feed_shapes.push_back(strings::StrCat(feed_shape.first, ":",
+                                            feed_shape.second.DebugString()));
+    }
+    std::sort(feed_shapes.begin(), feed_shapes.end());
+    feed_shapes_summary = absl::StrJoin(feed_shapes, ",");
+  }
+
   // Fast lookup path, no sorting.
   const string key = strings::StrCat(
       absl::StrJoin(inputs, ","), "->", absl::StrJoin(outputs, ","), "/",
       absl::StrJoin(target_nodes, ","), "/", run_state_args->is_partial_run,
-      "/", debug_tensor_watches_summary);
+      "/", debug_tensor_watches_summary, "/", feed_shapes_summary);
   // Set the handle, if it's needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1513,7 +1621,8 @@ Status DirectSession::GetOrCreateExecutors(
   const string sorted_key = strings::StrCat(
       absl::StrJoin(inputs_sorted, ","), "->",
       absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
-      "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
+      "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary,
+      "/", feed_shapes_summary);
   // Set the handle, if its needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1861,11 +1970,13 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       const std::vector<Allocator*>* fetch_allocators)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        fetch_allocators_(fetch_allocators) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1891,11 +2002,17 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return Status::OK();
   }
 
+  Allocator* GetRetvalAllocator(int index) const override {
+    if (fetch_allocators_->empty()) return nullptr;
+    return (*fetch_allocators_)[index];
+  }
+
  private:
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  const std::vector<Allocator*>* const fetch_allocators_;  // Not owned.
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1909,6 +2026,15 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
+  return RunCallable(handle, feed_tensors, fetch_tensors, run_metadata,
+                     threadpool_options, {});
+}
+
+::tensorflow::Status DirectSession::RunCallable(
+    CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options,
+    const std::vector<Allocator*>& fetch_allocators) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
   direct_session_runs->GetCell()->IncrementBy(1);
@@ -1949,6 +2075,12 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "`fetch_tensors` must be provided when the callable has one or more "
         "outputs.");
   }
+  if (!fetch_allocators.empty() &&
+      fetch_allocators.size() != executors_and_keys->output_types.size()) {
+    return errors::InvalidArgument(
+        "Expected ", executors_and_keys->output_types.size(),
+        " fetch allocators, but got ", fetch_allocators.size());
+  }
 
   size_t input_size = 0;
   bool any_resource_feeds = false;
@@ -1981,7 +2113,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+                                  actual_feed_tensors, fetch_tensors,
+                                  &fetch_allocators);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
@@ -131,6 +131,12 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  ::tensorflow::Status RunCallable(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Allocator*>& fetch_allocators) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -236,6 +242,8 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
     int64 collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // The shapes of the feeds the graph is specialized for, by node name.
+    std::unordered_map<string, TensorShape> feed_shapes;
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
@@ -355,6 +363,14 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // Batch sizes for which Run() uses a graph optimized for the exact shapes of
+  // the feeds, read from TF_DIRECT_SESSION_SPECIALIZED_BATCH_SIZES.
+  std::unordered_set<int64> specialized_batch_sizes_;
+
+  // If true, the kernels of stateless nodes come from SharedKernelCache, read
+  // from TF_DIRECT_SESSION_SHARE_STATELESS_KERNELS.
+  bool share_stateless_kernels_ = false;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
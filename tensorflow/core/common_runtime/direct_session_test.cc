@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <random>
@@ -43,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
@@ -198,6 +200,65 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+// An allocator that forwards to the CPU allocator, and counts the number of
+// allocations made through it.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting_allocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+
+ private:
+  std::atomic<int> num_allocations_{0};
+};
+
+TEST_F(DirectSessionMinusAXTest, RunCallableWithFetchAllocators) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(MakeCallableOptions({}, {y_ + ":0"}, {}),
+                                     &handle));
+
+  CountingAllocator allocator;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr,
+                                      thread::ThreadPoolOptions(),
+                                      {&allocator}));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_EQ(i + 1, allocator.num_allocations());
+  }
+
+  // A null allocator falls back to the device allocator.
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr,
+                                    thread::ThreadPoolOptions(), {nullptr}));
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_EQ(2, allocator.num_allocations());
+
+  Status s = session->RunCallable(handle, {}, &outputs, nullptr,
+                                  thread::ThreadPoolOptions(),
+                                  {&allocator, &allocator});
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  EXPECT_TRUE(
+      absl::StrContains(s.error_message(), "Expected 1 fetch allocators"));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -839,6 +900,55 @@ TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   EXPECT_EQ(20.0, outputs[0].flat<float>()(0));
 }
 
+TEST(DirectSessionTest, SpecializesGraphForBatchSizes) {
+  setenv("TF_DIRECT_SESSION_SPECIALIZED_BATCH_SIZES", "1,8", 1);
+  Graph g(OpRegistry::Global());
+  Node* x;
+  TF_CHECK_OK(NodeBuilder("x", "Placeholder")
+                  .Attr("shape", PartialTensorShape({-1}))
+                  .Attr("dtype", DT_FLOAT)
+                  .Finalize(&g, &x));
+  Node* shape;
+  TF_CHECK_OK(NodeBuilder("shape", "Shape")
+                  .Input(x)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("out_type", DT_INT32)
+                  .Finalize(&g, &shape));
+  Node* y = test::graph::Add(&g, shape, shape);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  unsetenv("TF_DIRECT_SESSION_SPECIALIZED_BATCH_SIZES");
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  for (const int64 batch_size : {8, 3}) {
+    std::vector<std::pair<string, Tensor>> inputs = {
+        {"x", test::AsTensor<float>(std::vector<float>(batch_size, 1.0f))}};
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(run_options, inputs, {y->name() + ":0"}, {},
+                              &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<int32>(
+        test::AsTensor<int32>({static_cast<int32>(2 * batch_size)}),
+        outputs[0]);
+
+    // The graph is only specialized for the listed batch sizes, in which case
+    // the shape of x is known and folded into a constant.
+    bool has_shape_op = false;
+    for (const GraphDef& partition : run_metadata.partition_graphs()) {
+      for (const NodeDef& node : partition.node()) {
+        has_shape_op |= node.op() == "Shape";
+      }
+    }
+    EXPECT_EQ(batch_size != 8, has_shape_op) << batch_size;
+  }
+}
+
 TEST(DirectSessionTest, MultipleFeedTest) {
   GraphDef def;
   Graph g(OpRegistry::Global());
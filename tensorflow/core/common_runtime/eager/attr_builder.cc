@@ -291,8 +291,16 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
 
 tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
     const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
+  if (!cached_op_and_device_key_ ||
+      op_name_ != op_for_cached_op_and_device_key_ ||
+      device != device_for_cached_op_and_device_key_) {
+    cached_op_and_device_key_ =
+        tensorflow::FingerprintCat128(tensorflow::Fingerprint128(op_name_),
+                                      tensorflow::Fingerprint128(device));
+    op_for_cached_op_and_device_key_ = op_name_;
+    device_for_cached_op_and_device_key_ = string(device);
+  }
+  tensorflow::Fprint128 f = *cached_op_and_device_key_;
   for (const auto& p : encoded_attrs_) {
     CombineUnordered(
         CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
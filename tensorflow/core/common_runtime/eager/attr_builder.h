@@ -190,6 +190,14 @@ class AttrBuilder {
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+
+  // Fingerprint of the op name and device the last cache key was built for.
+  // Unlike the cache key, it is kept by Reset(...), so that an AttrBuilder
+  // reused for the same op and device, e.g. at the call site of a loop, does
+  // not fingerprint them again.
+  mutable absl::optional<tensorflow::Fprint128> cached_op_and_device_key_;
+  mutable string op_for_cached_op_and_device_key_;
+  mutable string device_for_cached_op_and_device_key_;
 };
 
 template <>
@@ -83,6 +83,25 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrTypeMap, CacheKeyAfterReset) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  const tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+
+  a.Reset("op_name");
+  a.Set("T", TF_FLOAT);
+  ASSERT_TRUE(cache_key == a.CacheKey("cpu:0"));
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:1"));
+
+  a.Reset("other_op_name");
+  a.Set("T", TF_FLOAT);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
+
+  a.Reset("op_name");
+  a.Set("T", TF_FLOAT);
+  ASSERT_TRUE(cache_key == a.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
@@ -23,6 +23,12 @@ limitations under the License.
 
 namespace tensorflow {
 namespace {
+
+// Maximum number of queued nodes taken at once by the executor thread. The
+// nodes of a batch still run one by one: they are EagerNodes, not ops, so they
+// cannot be fused into a single function here.
+constexpr size_t kMaxNodeBatchSize = 64;
+
 bool IsAsyncWaitForRemoteFunctionEnabled() {
   bool enabled = true;
   TF_CHECK_OK(ReadBoolFromEnvVar("TF_ENABLE_ASYNC_WAIT_FOR_REMOTE_FUNCTION",
@@ -45,6 +51,7 @@ EagerExecutor::EagerExecutor(bool async)
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   state_ = ExecutorState::kShutDown;
+  ++queue_generation_;
   nodes_pending_.notify_all();
   for (const auto& cleanups_for_key : cleanups_) {
     for (const std::function<void()>& cleanup : cleanups_for_key.second) {
@@ -70,6 +77,7 @@ Status EagerExecutor::ShutDown() {
       // as the final status_.
       WaitForAllPendingNodesLocked(&l).IgnoreError();
       state_ = ExecutorState::kShutDown;
+      ++queue_generation_;
       has_thread = thread_ != nullptr;
       status = status_;
       if (has_thread) {
@@ -153,7 +161,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -235,7 +243,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -269,8 +277,9 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
+      ++queue_generation_;
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
       }
@@ -321,28 +330,42 @@ void EagerExecutor::NotifyWaiters(uint64 id) {
 void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
+  std::vector<core::RefCountPtr<NodeItem>> batch;
+  batch.reserve(kMaxNodeBatchSize);
   while (true) {
-    core::RefCountPtr<NodeItem> curr_item;
+    uint64 generation;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
         if (state_ == ExecutorState::kShutDown) return;
         nodes_pending_.wait(l);
       }
-      // Obtain raw pointer since we don't want to remove from the queue until
-      // the node has been run. Otherwise, WaitForAllPendingNodes can return
-      // too early.
-      // Note, we don't std::move from the here because the front of the queue
-      // will then contain a nullptr. This can be a problem in
-      // WaitForAllPendingNodes where we get the top EagerNode pointer
-      // and register a notification for its completion.
-      curr_item.reset(node_queue_.front().get());
-      curr_item->Ref();
+      // Obtain raw pointers since we don't want to remove from the queue
+      // until the nodes have been run. Otherwise, WaitForAllPendingNodes can
+      // return too early.
+      // Note, we don't std::move from the here because the queue will then
+      // contain nullptrs. This can be a problem in WaitForAllPendingNodes
+      // where we get the top EagerNode pointer and register a notification
+      // for its completion.
+      const size_t batch_size = std::min(node_queue_.size(), kMaxNodeBatchSize);
+      for (size_t i = 0; i < batch_size; ++i) {
+        batch.emplace_back(node_queue_[i].get());
+        batch.back()->Ref();
+      }
+      generation = queue_generation_;
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
-    if (!status.ok()) {
-      VLOG(1) << "Failed to run item: " << status;
+    // Each node is popped from the queue when done, leaving the next one of
+    // the batch at the front.
+    for (core::RefCountPtr<NodeItem>& curr_item : batch) {
+      // The remaining nodes were aborted by an error, or the executor is
+      // shutting down.
+      if (queue_generation_ != generation) break;
+      Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
+      if (!status.ok()) {
+        VLOG(1) << "Failed to run item: " << status;
+      }
     }
+    batch.clear();
   }
 }
 
@@ -408,7 +431,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
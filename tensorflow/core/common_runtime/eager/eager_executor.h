@@ -19,7 +19,7 @@ limitations under the License.
 #include <cstddef>
 #include <map>
 #include <memory>
-#include <queue>
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -200,7 +200,9 @@ class EagerExecutor {
   // Starts execution of pending EagerNodes. This function loops till executor
   // state_ is set to kShutDown. If any errors are encountered, these are set
   // inside `status_`. The loop blocks anytime there are no pending nodes, or if
-  // `status_` is not ok.
+  // `status_` is not ok. The nodes queued behind each other are taken by
+  // batches, locking the queue once per batch to take them. Each node is
+  // still popped from the queue under the lock once done, in NodeDone().
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
@@ -221,9 +223,14 @@ class EagerExecutor {
   condition_variable nodes_pending_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
+  // Incremented when the pending NodeItems are dropped, by an error or the
+  // shut down of the executor, so that `thread_` stops running the nodes it
+  // took from the queue.
+  std::atomic<uint64> queue_generation_{0};
+
   // Ordered by NodeItem::id.
   std::map<uint64, core::RefCountPtr<NodeItem>, std::less<uint64>>
       unfinished_nodes_ TF_GUARDED_BY(node_queue_mutex_);
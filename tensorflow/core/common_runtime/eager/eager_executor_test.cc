@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/eager_executor.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Records the nodes run and aborted, in order.
+struct NodeLog {
+  mutex mu;
+  std::vector<int> run TF_GUARDED_BY(mu);
+  std::vector<int> aborted TF_GUARDED_BY(mu);
+};
+
+class TestNode : public EagerNode {
+ public:
+  // Returns `status` when run. If they are not null, notifies `started` when
+  // run and then waits for `start`.
+  TestNode(int id, NodeLog* log, Status status = Status::OK(),
+           Notification* started = nullptr, Notification* start = nullptr)
+      : id_(id),
+        log_(log),
+        status_(status),
+        started_(started),
+        start_(start) {}
+
+  Status Run() override {
+    if (started_ != nullptr) started_->Notify();
+    if (start_ != nullptr) start_->WaitForNotification();
+    mutex_lock l(log_->mu);
+    log_->run.push_back(id_);
+    return status_;
+  }
+
+  void Abort(Status status) override {
+    mutex_lock l(log_->mu);
+    log_->aborted.push_back(id_);
+  }
+
+  string DebugString() const override { return "TestNode"; }
+
+ private:
+  const int id_;
+  NodeLog* const log_;
+  const Status status_;
+  Notification* const started_;
+  Notification* const start_;
+};
+
+// Queues node 0, which blocks, and nodes 1 to `num_nodes - 1` behind it, so
+// that the executor thread takes the latter as one batch. Node `failing`
+// fails, if it is in range.
+Status RunQueuedNodes(int num_nodes, int failing, NodeLog* log) {
+  EagerExecutor executor(/*async=*/true);
+  Notification started;
+  Notification start;
+  TF_RETURN_IF_ERROR(executor.AddOrExecute(absl::make_unique<TestNode>(
+      0, log, Status::OK(), &started, &start)));
+  started.WaitForNotification();
+  for (int i = 1; i < num_nodes; ++i) {
+    const Status status =
+        i == failing ? errors::Internal("node ", i) : Status::OK();
+    TF_RETURN_IF_ERROR(
+        executor.AddOrExecute(absl::make_unique<TestNode>(i, log, status)));
+  }
+  start.Notify();
+  Status s = executor.WaitForAllPendingNodes();
+  executor.ShutDown().IgnoreError();
+  return s;
+}
+
+TEST(EagerExecutorTest, RunsBatchInOrder) {
+  NodeLog log;
+  TF_ASSERT_OK(RunQueuedNodes(10, /*failing=*/-1, &log));
+  mutex_lock l(log.mu);
+  EXPECT_EQ(log.run, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  EXPECT_TRUE(log.aborted.empty());
+}
+
+TEST(EagerExecutorTest, ErrorAbortsRestOfBatch) {
+  NodeLog log;
+  Status s = RunQueuedNodes(6, /*failing=*/3, &log);
+  EXPECT_EQ(error::INTERNAL, s.code()) << s;
+  mutex_lock l(log.mu);
+  EXPECT_EQ(log.run, std::vector<int>({0, 1, 2, 3}));
+  std::sort(log.aborted.begin(), log.aborted.end());
+  EXPECT_EQ(log.aborted, std::vector<int>({4, 5}));
+}
+
+}  // namespace
+}  // namespace tensorflow
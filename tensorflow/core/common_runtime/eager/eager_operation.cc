@@ -284,6 +284,14 @@ Status EagerOperation::Reset(
   DCHECK(inputs_.empty());
   ClearInferenceState();
   bool is_function = false;
+  if (primitive_op_def_ != nullptr && primitive_op_name_ == op) {
+    // The attr types, OpDef and colocation exemption of a registered op never
+    // change, and are the ones of the last Reset.
+    op_def_ = primitive_op_def_;
+    is_function_ = false;
+    return ResetForOp(op, device_name, executor, remote_func_params);
+  }
+  primitive_op_def_ = nullptr;
   TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
 
   // Don't update the device of direct function calls.
@@ -298,6 +306,8 @@ Status EagerOperation::Reset(
     colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
 
     TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
+    primitive_op_name_ = op;
+    primitive_op_def_ = op_def_;
   } else if (!remote && !ctx_.FindFunctionByName(op)) {
     return errors::NotFound(
         "'", op,
@@ -307,9 +317,15 @@ Status EagerOperation::Reset(
         ". Make sure the operation or function is "
         "registered in the binary running in this process.");
   }
+  is_function_ = is_function;
+  return ResetForOp(op, device_name, executor, remote_func_params);
+}
+
+Status EagerOperation::ResetForOp(
+    const char* op, const char* device_name, EagerExecutor* executor,
+    const absl::optional<EagerRemoteFunctionParams>& remote_func_params) {
   attrs_.Reset(op);
   stack_trace_.reset();
-  is_function_ = is_function;
   cancellation_manager_ = nullptr;
   executor_ = executor ? executor : &ctx_.Executor();
   remote_func_params_ = remote_func_params;
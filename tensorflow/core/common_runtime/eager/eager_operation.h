@@ -190,6 +190,12 @@ class EagerOperation : public ImmediateExecutionOperation {
     inference_attrs_.clear_no_resize();
   }
 
+  // Resets the state of the operation which does not depend on the op
+  // definition.
+  Status ResetForOp(
+      const char* op, const char* device_name, EagerExecutor* executor,
+      const absl::optional<EagerRemoteFunctionParams>& remote_func_params);
+
   Status MaybeInferSingleInputAttrs(TensorHandle* handle);
   Status InferInputListAttrs(int num_inputs);
 
@@ -234,6 +240,11 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
+  // The primitive op of the last Reset, and its definition. Reset skips the
+  // registry lookups when the operation is reset for the same primitive op,
+  // as done at the call sites of loops.
+  string primitive_op_name_;
+  const tensorflow::OpDef* primitive_op_def_ = nullptr;
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
@@ -47,5 +47,34 @@ TEST(EagerOperationTest, DeviceName) {
   ctx->Unref();
 }
 
+TEST(EagerOperationTest, ResetForSameAndOtherOps) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      false, &device_mgr, false, nullptr, nullptr, nullptr);
+
+  auto op = new EagerOperation(ctx);
+  for (const char* name : {"Identity", "Identity", "MatMul", "Identity"}) {
+    op->Clear();
+    TF_ASSERT_OK(op->Reset(name, nullptr));
+    EXPECT_EQ(name, op->Name());
+    ASSERT_NE(op->OpDef(), nullptr);
+    EXPECT_EQ(name, op->OpDef()->name());
+    EXPECT_FALSE(op->is_function());
+    EXPECT_EQ(name, op->MutableAttrs()->op_name());
+  }
+  op->Clear();
+  EXPECT_TRUE(errors::IsNotFound(op->Reset("NotAnOpOrFunction", nullptr)));
+  // The failed Reset does not leave a stale OpDef behind.
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  EXPECT_EQ("Identity", op->OpDef()->name());
+
+  delete op;
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
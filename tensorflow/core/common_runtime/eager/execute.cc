@@ -787,6 +787,24 @@ void PrepareRemoteOp(eager::Operation* remote_op, EagerOperation* op) {
   remote_op->set_is_function(op->is_function());
 }
 
+// Sets the id of the signature of `remote_op` to be sent to `remote_task`.
+// Once the remote worker has registered the signature, the name, attrs and
+// device of the op are only sent through this id.
+void SetRemoteOpSignature(eager::Operation* remote_op, EagerOperation* op,
+                          const string& remote_task) {
+  EagerContext& ctx = op->EagerContext();
+  bool registered = false;
+  remote_op->set_signature_id(ctx.RemoteMgr()->GetOpSignatureId(
+      remote_task, ctx.GetContextViewId(),
+      op->MutableAttrs()->CacheKey(remote_op->device()), &registered));
+  if (registered) {
+    remote_op->clear_name();
+    remote_op->clear_attrs();
+    remote_op->clear_device();
+    remote_op->clear_is_function();
+  }
+}
+
 Status StoreResourceDtypesAndShapes(const eager::Operation& remote_op,
                                     const DataTypeVector& output_dtypes,
                                     TensorHandle** retvals) {
@@ -948,6 +966,8 @@ Status EagerRemoteExecute(EagerOperation* op, TensorHandle** retvals,
         StoreResourceDtypesAndShapes(*remote_op, output_dtypes, retvals));
   }
 
+  SetRemoteOpSignature(remote_op, op, remote_task);
+
   auto& executor = op->Executor();
   DVLOG(4) << "Execute remote eager op: " << op->Name()
            << " (is async?: " << executor.Async() << ").";
@@ -0,0 +1,334 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/lazy_trace_device.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/framework/graph_to_functiondef.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+
+LazyTraceDevice::LazyTraceDevice(EagerContext* ctx, const string& name,
+                                 const Options& options)
+    : ctx_(ctx), name_(name), options_(options) {}
+
+LazyTraceDevice::~LazyTraceDevice() {
+  mutex_lock l(mu_);
+  for (auto& value : values_) {
+    if (value.second.materialized != nullptr) {
+      value.second.materialized->Unref();
+    }
+    value.first->Unref();
+  }
+  for (TensorHandle* arg : args_) {
+    arg->Unref();
+  }
+}
+
+TensorHandle* LazyTraceDevice::NewHandle(DataType dtype, const Value& value) {
+  // The tensor only carries the dtype; the value lives in `values_`.
+  TensorHandle* handle = TensorHandle::CreateLocalHandle(
+      Tensor(dtype, TensorShape({0})), this, ctx_);
+  handle->Ref();
+  values_[handle] = value;
+  return handle;
+}
+
+void LazyTraceDevice::CaptureArg(TensorHandle* handle, Endpoint* endpoint) {
+  auto it = arg_index_.find(handle);
+  if (it == arg_index_.end()) {
+    handle->Ref();
+    it = arg_index_.emplace(handle, args_.size()).first;
+    args_.push_back(handle);
+  }
+  *endpoint = {Endpoint::kArg, it->second};
+}
+
+Status LazyTraceDevice::CopyTensorToDevice(TensorHandle* tensor,
+                                           TensorHandle** result) {
+  mutex_lock l(mu_);
+  Value value;
+  tensor->Ref();
+  value.materialized = tensor;
+  *result = NewHandle(tensor->dtype, value);
+  return Status::OK();
+}
+
+Status LazyTraceDevice::CopyTensorFromDevice(TensorHandle* tensor,
+                                             const string& target_device_name,
+                                             TensorHandle** result) {
+  mutex_lock l(mu_);
+  auto it = values_.find(tensor);
+  if (it == values_.end()) {
+    return errors::Internal("Unknown handle on ", name_);
+  }
+  if (it->second.materialized == nullptr && it->second.status.ok()) {
+    // A failed trace records its error in the values it computes.
+    FlushLocked().IgnoreError();
+    it = values_.find(tensor);
+  }
+  TF_RETURN_IF_ERROR(it->second.status);
+
+  TensorHandle* materialized = it->second.materialized;
+  Device* device;
+  TF_RETURN_IF_ERROR(
+      ctx_->FindDeviceFromName(target_device_name.c_str(), &device));
+  VariantDevice current = materialized->DeviceOrHostCPU(*ctx_);
+  if (!VariantDeviceIsCustom(current) &&
+      absl::get<Device*>(current) == device) {
+    materialized->Ref();
+    *result = materialized;
+    return Status::OK();
+  }
+  return EagerCopyToDevice(materialized, ctx_, &ctx_->Executor(), device,
+                           /*mirror=*/false, result);
+}
+
+Status LazyTraceDevice::Execute(const EagerOperation* op,
+                                TensorHandle** retvals, int* num_retvals) {
+  mutex_lock l(mu_);
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(ctx_->FuncLibDef()->LookUpOpDef(op->Name(), &op_def));
+  TraceNode node;
+  node.ndef.set_name(absl::StrCat("n", nodes_.size()));
+  node.ndef.set_op(op->Name());
+  op->Attrs().FillAttrValueMap(node.ndef.mutable_attr());
+  AddDefaultsToNodeDef(*op_def, &node.ndef);
+  node.is_stateful = op_def->is_stateful();
+
+  for (TensorHandle* input : op->Inputs()) {
+    Endpoint endpoint;
+    if (VariantDeviceIsCustom(input->device())) {
+      if (absl::get<CustomDevice*>(input->device()) != this) {
+        return errors::InvalidArgument(
+            "Cannot trace ", op->Name(), " on ", name_, " with an input on ",
+            VariantDeviceName(input->device()));
+      }
+      auto it = values_.find(input);
+      if (it == values_.end()) {
+        return errors::Internal("Unknown handle on ", name_);
+      }
+      TF_RETURN_IF_ERROR(it->second.status);
+      if (it->second.materialized != nullptr) {
+        CaptureArg(it->second.materialized, &endpoint);
+      } else {
+        endpoint = it->second.pending;
+      }
+    } else {
+      CaptureArg(input, &endpoint);
+    }
+    node.inputs.push_back(endpoint);
+  }
+
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(OutputTypesForNode(node.ndef, *op_def, &output_types));
+  if (static_cast<int>(output_types.size()) > *num_retvals) {
+    return errors::InvalidArgument("Expected at most ", *num_retvals,
+                                   " outputs for ", op->Name(), " but got ",
+                                   output_types.size());
+  }
+  const int node_id = nodes_.size();
+  nodes_.push_back(std::move(node));
+  for (int i = 0; i < output_types.size(); ++i) {
+    Value value;
+    value.pending = {node_id, i};
+    retvals[i] = NewHandle(output_types[i], value);
+  }
+  *num_retvals = output_types.size();
+
+  if (nodes_.size() >= options_.max_trace_length) {
+    // Errors are reported when the results are read.
+    FlushLocked().IgnoreError();
+  }
+  return Status::OK();
+}
+
+Status LazyTraceDevice::BuildFunction(const std::vector<Endpoint>& outputs,
+                                      FunctionDef* fdef) {
+  Graph graph(*ctx_->FuncLibDef());
+  Status s;
+  std::vector<Node*> arg_nodes;
+  arg_nodes.reserve(args_.size());
+  for (int i = 0; i < args_.size(); ++i) {
+    NodeDef ndef;
+    ndef.set_name(absl::StrCat("arg", i));
+    ndef.set_op(FunctionLibraryDefinition::kArgOp);
+    AddNodeAttr("T", args_[i]->dtype, &ndef);
+    AddNodeAttr("index", i, &ndef);
+    arg_nodes.push_back(graph.AddNode(std::move(ndef), &s));
+    TF_RETURN_IF_ERROR(s);
+  }
+
+  // Stateful ops run in the order they were traced, even if no data flows
+  // between them, and run even if none of their outputs is read.
+  std::vector<Node*> trace_nodes;
+  trace_nodes.reserve(nodes_.size());
+  absl::flat_hash_set<const Node*> stateful_nodes;
+  Node* last_stateful = nullptr;
+  for (const TraceNode& trace_node : nodes_) {
+    Node* n = graph.AddNode(trace_node.ndef, &s);
+    TF_RETURN_IF_ERROR(s);
+    for (int i = 0; i < trace_node.inputs.size(); ++i) {
+      const Endpoint& input = trace_node.inputs[i];
+      if (input.node == Endpoint::kArg) {
+        graph.AddEdge(arg_nodes[input.index], 0, n, i);
+      } else {
+        graph.AddEdge(trace_nodes[input.node], input.index, n, i);
+      }
+    }
+    if (trace_node.is_stateful) {
+      if (last_stateful != nullptr) graph.AddControlEdge(last_stateful, n);
+      last_stateful = n;
+      stateful_nodes.insert(n);
+    }
+    trace_nodes.push_back(n);
+  }
+
+  for (int i = 0; i < outputs.size(); ++i) {
+    Node* src = trace_nodes[outputs[i].node];
+    NodeDef ndef;
+    ndef.set_name(absl::StrCat("ret", i));
+    ndef.set_op(FunctionLibraryDefinition::kRetOp);
+    AddNodeAttr("T", src->output_type(outputs[i].index), &ndef);
+    AddNodeAttr("index", i, &ndef);
+    Node* ret = graph.AddNode(std::move(ndef), &s);
+    TF_RETURN_IF_ERROR(s);
+    graph.AddEdge(src, outputs[i].index, ret, 0);
+  }
+
+  TF_RETURN_IF_ERROR(GraphToFunctionDef(
+      graph, "", /*control_ret=*/
+      [&stateful_nodes](const Node* n) -> absl::optional<string> {
+        if (stateful_nodes.contains(n)) return n->name();
+        return absl::nullopt;
+      },
+      fdef));
+  if (options_.jit_compile) {
+    (*fdef->mutable_attr())["_XlaMustCompile"].set_b(true);
+  }
+
+  // Name the function after its body, so that the same trace maps to the
+  // same function.
+  string serialized;
+  if (!SerializeToStringDeterministic(*fdef, &serialized)) {
+    return errors::Internal("Failed to serialize a trace of ", name_);
+  }
+  fdef->mutable_signature()->set_name(
+      absl::StrCat("__lazy_trace_", Fingerprint64(serialized)));
+  return Status::OK();
+}
+
+Status LazyTraceDevice::RunTrace(const std::vector<TensorHandle*>& outputs) {
+  std::vector<Endpoint> endpoints;
+  endpoints.reserve(outputs.size());
+  for (TensorHandle* output : outputs) {
+    endpoints.push_back(values_[output].pending);
+  }
+  FunctionDef fdef;
+  TF_RETURN_IF_ERROR(BuildFunction(endpoints, &fdef));
+  const string& function_name = fdef.signature().name();
+  if (!traced_functions_.contains(function_name)) {
+    if (ctx_->FindFunctionDef(function_name) == nullptr) {
+      TF_RETURN_IF_ERROR(ctx_->AddFunctionDef(fdef));
+    }
+    traced_functions_.insert(function_name);
+  }
+
+  EagerOperation call(ctx_);
+  TF_RETURN_IF_ERROR(call.Reset(function_name.c_str(),
+                                options_.target_device_name.c_str()));
+  for (TensorHandle* arg : args_) {
+    TF_RETURN_IF_ERROR(call.AddInput(arg));
+  }
+  std::vector<TensorHandle*> results(outputs.size(), nullptr);
+  int num_results = results.size();
+  TF_RETURN_IF_ERROR(call.Execute(
+      absl::MakeSpan(reinterpret_cast<AbstractTensorHandle**>(results.data()),
+                     results.size()),
+      &num_results));
+  for (int i = 0; i < outputs.size(); ++i) {
+    values_[outputs[i]].materialized = results[i];
+  }
+  return Status::OK();
+}
+
+Status LazyTraceDevice::FlushLocked() {
+  // Drop the values nobody else references, and collect the pending ones that
+  // the trace has to return.
+  std::vector<std::pair<std::pair<int, int>, TensorHandle*>> pending;
+  for (auto it = values_.begin(); it != values_.end();) {
+    auto current = it++;
+    TensorHandle* handle = current->first;
+    Value& value = current->second;
+    if (handle->RefCountIsOne()) {
+      if (value.materialized != nullptr) value.materialized->Unref();
+      values_.erase(current);
+      handle->Unref();
+    } else if (value.materialized == nullptr && value.status.ok()) {
+      pending.push_back(
+          {{value.pending.node, value.pending.index}, handle});
+    }
+  }
+  if (nodes_.empty()) return Status::OK();
+
+  // Return the outputs in trace order, which the function name depends on.
+  std::sort(pending.begin(), pending.end());
+  std::vector<TensorHandle*> outputs;
+  outputs.reserve(pending.size());
+  for (const auto& p : pending) {
+    outputs.push_back(p.second);
+  }
+  Status s = RunTrace(outputs);
+  if (!s.ok()) {
+    for (TensorHandle* output : outputs) {
+      values_[output].status = s;
+    }
+  }
+  for (TensorHandle* arg : args_) {
+    arg->Unref();
+  }
+  args_.clear();
+  arg_index_.clear();
+  nodes_.clear();
+  return s;
+}
+
+Status LazyTraceDevice::Flush() {
+  mutex_lock l(mu_);
+  return FlushLocked();
+}
+
+Status RegisterLazyTraceDevice(EagerContext* ctx, const string& device_name,
+                               const LazyTraceDevice::Options& options) {
+  Device* target;
+  TF_RETURN_IF_ERROR(
+      ctx->FindDeviceFromName(options.target_device_name.c_str(), &target));
+  return ctx->RegisterCustomDevice(
+      device_name,
+      absl::make_unique<LazyTraceDevice>(ctx, device_name, options));
+}
+
+}  // namespace tensorflow
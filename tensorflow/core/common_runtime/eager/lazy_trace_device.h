@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_TRACE_DEVICE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_TRACE_DEVICE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A custom device which records the ops placed on it instead of running them.
+// The recorded trace is turned into a function and run on the target device
+// when one of its results is read, so a sequence of small eager ops costs one
+// function call and can be optimized as a whole by grappler (or compiled by
+// XLA if `jit_compile` is set).
+//
+// The function is named after a fingerprint of the trace, so repeating the
+// same sequence of ops (e.g. one training step) reuses the function, and the
+// kernel the context caches for it, instead of tracing a new one.
+//
+// Handles on this device have the dtype of the value they stand for but not
+// its shape; their contents are only available after a copy to a physical
+// device.
+class LazyTraceDevice : public CustomDevice {
+ public:
+  struct Options {
+    // Device the traced functions run on.
+    string target_device_name;
+    // Marks the traced functions for XLA compilation.
+    bool jit_compile = false;
+    // Runs the trace once it records this many ops, to bound the memory held
+    // by pending values.
+    int max_trace_length = 1024;
+  };
+
+  LazyTraceDevice(EagerContext* ctx, const string& name,
+                  const Options& options);
+  ~LazyTraceDevice() override;
+
+  const string& name() override { return name_; }
+
+  Status CopyTensorToDevice(TensorHandle* tensor,
+                            TensorHandle** result) override;
+
+  // Runs the pending trace if `tensor` is not computed yet.
+  Status CopyTensorFromDevice(TensorHandle* tensor,
+                              const string& target_device_name,
+                              TensorHandle** result) override;
+
+  // Records `op` into the pending trace.
+  Status Execute(const EagerOperation* op, TensorHandle** retvals,
+                 int* num_retvals) override;
+
+  // Runs the pending trace, if any.
+  Status Flush();
+
+  int num_pending_ops() const {
+    tf_shared_lock l(mu_);
+    return nodes_.size();
+  }
+
+  int num_traced_functions() const {
+    tf_shared_lock l(mu_);
+    return traced_functions_.size();
+  }
+
+ private:
+  // A node output, or an argument of the trace if `node` is kArg.
+  struct Endpoint {
+    static constexpr int kArg = -1;
+    int node;
+    int index;
+  };
+
+  struct TraceNode {
+    NodeDef ndef;
+    std::vector<Endpoint> inputs;
+    bool is_stateful;
+  };
+
+  // What a handle on this device stands for: a pending output of the trace,
+  // or a handle on a physical device once the trace ran.
+  struct Value {
+    Endpoint pending;
+    TensorHandle* materialized = nullptr;
+    Status status;
+  };
+
+  TensorHandle* NewHandle(DataType dtype, const Value& value)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void CaptureArg(TensorHandle* handle, Endpoint* endpoint)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status BuildFunction(const std::vector<Endpoint>& outputs, FunctionDef* fdef)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status RunTrace(const std::vector<TensorHandle*>& outputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status FlushLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  EagerContext* const ctx_;
+  const string name_;
+  const Options options_;
+
+  mutable mutex mu_;
+  std::vector<TraceNode> nodes_ TF_GUARDED_BY(mu_);
+  // Handles on physical devices read by the trace, referenced until it runs.
+  std::vector<TensorHandle*> args_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<TensorHandle*, int> arg_index_ TF_GUARDED_BY(mu_);
+  // Every live handle on this device, each referenced by the map so that
+  // unused values can be dropped from the trace when it runs.
+  absl::flat_hash_map<TensorHandle*, Value> values_ TF_GUARDED_BY(mu_);
+  // Names of the functions already added to the context.
+  absl::flat_hash_set<string> traced_functions_ TF_GUARDED_BY(mu_);
+};
+
+// Registers a LazyTraceDevice named `device_name` with `ctx`, which then
+// traces the ops placed on `device_name` or reading its handles.
+Status RegisterLazyTraceDevice(EagerContext* ctx, const string& device_name,
+                               const LazyTraceDevice::Options& options);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_TRACE_DEVICE_H_
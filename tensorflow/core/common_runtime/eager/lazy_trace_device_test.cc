@@ -0,0 +1,85 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/lazy_trace_device.h"
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpuDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kLazyDevice[] = "/job:localhost/replica:0/task:0/device:LAZY:0";
+
+TensorHandle* BinaryOp(EagerContext* ctx, const char* op_name, TensorHandle* a,
+                       TensorHandle* b) {
+  EagerOperation op(ctx);
+  TF_CHECK_OK(op.Reset(op_name, kLazyDevice));
+  TF_CHECK_OK(op.AddInput(a));
+  TF_CHECK_OK(op.AddInput(b));
+  TensorHandle* result = nullptr;
+  int num_retvals = 1;
+  TF_CHECK_OK(op.Execute(
+      absl::MakeSpan(reinterpret_cast<AbstractTensorHandle**>(&result), 1),
+      &num_retvals));
+  CHECK_EQ(num_retvals, 1);
+  return result;
+}
+
+TEST(LazyTraceDeviceTest, RunsTraceOnReadAndReusesFunction) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice("CPU", {}, kCpuDevice));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      false, &device_mgr, false, nullptr, nullptr, nullptr);
+  LazyTraceDevice::Options options;
+  options.target_device_name = kCpuDevice;
+  TF_ASSERT_OK(RegisterLazyTraceDevice(ctx, kLazyDevice, options));
+  CustomDevice* custom_device;
+  ASSERT_TRUE(ctx->FindCustomDeviceFromName(kLazyDevice, &custom_device));
+  auto* device = static_cast<LazyTraceDevice*>(custom_device);
+
+  TensorHandle* x =
+      TensorHandle::CreateLocalHandle(test::AsTensor<float>({1, 2, 3}));
+  for (int step = 0; step < 2; ++step) {
+    TensorHandle* y;
+    TF_ASSERT_OK(device->CopyTensorToDevice(x, &y));
+    TensorHandle* square = BinaryOp(ctx, "Mul", y, y);
+    TensorHandle* z = BinaryOp(ctx, "AddV2", square, y);
+    EXPECT_EQ(DT_FLOAT, z->dtype);
+    EXPECT_EQ(2, device->num_pending_ops());
+
+    TensorHandle* result;
+    TF_ASSERT_OK(device->CopyTensorFromDevice(z, kCpuDevice, &result));
+    EXPECT_EQ(0, device->num_pending_ops());
+    EXPECT_EQ(1, device->num_traced_functions());
+    const Tensor* t;
+    TF_ASSERT_OK(result->Tensor(&t));
+    test::ExpectTensorEqual<float>(test::AsTensor<float>({2, 6, 12}), *t);
+
+    result->Unref();
+    z->Unref();
+    square->Unref();
+    y->Unref();
+  }
+  x->Unref();
+  ctx->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
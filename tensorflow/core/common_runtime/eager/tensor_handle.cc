@@ -54,8 +54,85 @@ int64 GetRemoteDeviceIncarnation(Device* device) {
   if (device == nullptr || device->IsLocal()) return 0;
   return device->attributes().incarnation();
 }
+
+// Free memory blocks of the size of a TensorHandle. Blocks may be freed by
+// another thread than the one which allocated them, which is fine since all
+// the blocks are alike.
+class TensorHandleFreeList {
+ public:
+  // Maximum number of free blocks kept by a thread.
+  static constexpr int kMaxFreeBlocks = 256;
+
+  TensorHandleFreeList() = default;
+  ~TensorHandleFreeList() {
+    destroyed_ = true;
+    while (head_ != nullptr) {
+      Block* block = head_;
+      head_ = block->next;
+      ::operator delete(block);
+    }
+  }
+
+  static TensorHandleFreeList* Get() {
+    // Handles may be released by thread local destructors running after the
+    // one of the free list.
+    if (destroyed_) return nullptr;
+    thread_local TensorHandleFreeList free_list;
+    return &free_list;
+  }
+
+  void* Allocate(size_t size) {
+    if (head_ == nullptr) return ::operator new(size);
+    Block* block = head_;
+    head_ = block->next;
+    --num_free_blocks_;
+    return block;
+  }
+
+  void Free(void* ptr) {
+    if (num_free_blocks_ >= kMaxFreeBlocks) {
+      ::operator delete(ptr);
+      return;
+    }
+    Block* block = static_cast<Block*>(ptr);
+    block->next = head_;
+    head_ = block;
+    ++num_free_blocks_;
+  }
+
+ private:
+  struct Block {
+    Block* next;
+  };
+
+  static thread_local bool destroyed_;
+  Block* head_ = nullptr;
+  int num_free_blocks_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TensorHandleFreeList);
+};
+
+thread_local bool TensorHandleFreeList::destroyed_ = false;
+
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  TensorHandleFreeList* free_list = TensorHandleFreeList::Get();
+  if (size != sizeof(TensorHandle) || free_list == nullptr) {
+    return ::operator new(size);
+  }
+  return free_list->Allocate(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  TensorHandleFreeList* free_list = TensorHandleFreeList::Get();
+  if (size != sizeof(TensorHandle) || free_list == nullptr) {
+    ::operator delete(ptr);
+    return;
+  }
+  free_list->Free(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
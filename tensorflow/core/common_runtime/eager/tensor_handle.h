@@ -271,6 +271,11 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 
   ~TensorHandle() override;
 
+  // Eager ops allocate a TensorHandle per output, and their memory is
+  // recycled through a free list per thread.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   // The TensorHandleData can either represent a local or remote tensor handle.
   // Further, it can be in a non-ready state. It would become ready with a call
   // to either SetTensor or SetRemoteShape which replaces the underlying data
@@ -15,21 +15,27 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/frozen_plan_propagator_state.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/op_latency_stats.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -55,6 +61,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -134,16 +141,43 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  struct Options {
+    // If true, each step dispatches ready nodes through per-worker
+    // work-stealing queues instead of handing every expensive node to the
+    // inter-op runner as a separate closure.
+    bool use_work_stealing = false;
+
+    // If true, and the graph does not require control flow support, each step
+    // runs the nodes sequentially in a precomputed order (see
+    // `FrozenPlanPropagatorState`).
+    bool use_frozen_plan = false;
+  };
+
+  ExecutorImpl(const LocalExecutorParams& p, const Options& options)
+      : immutable_state_(p), options_(options) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(),
+                             immutable_state_.params().device);
+    if (options_.use_frozen_plan &&
+        !immutable_state_.requires_control_flow_support()) {
+      const Status s = immutable_state_.BuildFrozenPlan();
+      if (!s.ok()) {
+        VLOG(1) << "Not using a frozen plan: " << s;
+      }
+    }
     return Status::OK();
   }
 
   void RunAsync(const Args& args, DoneCallback done) override;
 
+  void UpdateCostEstimates(const Graph& graph,
+                           const CostModel& cost_model) override {
+    kernel_stats_.UpdateFromCostModel(immutable_state_.graph_view(), graph,
+                                      cost_model);
+  }
+
  private:
   template <class PropagatorStateType>
   friend class ExecutorState;
@@ -153,19 +187,36 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    void Initialize(const GraphView& gview, const Device* device) {
       is_expensive_ = absl::make_unique<std::atomic<bool>[]>(gview.num_nodes());
       cost_estimates_ =
           absl::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      const bool record_latencies = OpLatencyStats::Enabled();
+      if (record_latencies) {
+        latency_stats_ =
+            absl::make_unique<OpLatencyStats*[]>(gview.num_nodes());
+      }
       for (int32 i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
+          const OpKernel* kernel = gview.node(i)->kernel;
+          is_expensive_[i] = kernel && kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
+          if (record_latencies) {
+            latency_stats_[i] =
+                kernel ? OpLatencyStats::Get(kernel->type_string_view(),
+                                             device->device_type())
+                       : nullptr;
+          }
         }
       }
     }
 
+    // Returns the stats to record the latency of the given node in, or
+    // nullptr if latencies are not recorded.
+    OpLatencyStats* LatencyStats(const NodeItem& node) const {
+      return latency_stats_ ? latency_stats_[node.node_id] : nullptr;
+    }
+
     // Returns true iff the given node is considered "expensive". The
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
@@ -183,7 +234,7 @@ class ExecutorImpl : public Executor {
     // `is_expensive_[node.node_id]` is true (or at least, it *was* true, when
     // we started to execute the kernel. As a result, we expect that a kernel
     // can only ever transition from "expensive" to "inexpensive", but not vice
-    // versa.
+    // versa, except through `UpdateFromCostModel()`.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -199,6 +250,39 @@ class ExecutorImpl : public Executor {
       }
     }
 
+    // Replaces the cost estimates of the kernels in `gview` with the average
+    // execution times measured in `cost_model`, which was built for `graph`
+    // (e.g. by the `CostModelManager` of a session).
+    //
+    // Inexpensive kernels are not timed by the executor, so this is the only
+    // way for a kernel to become "expensive" again, and it lets cheap kernels
+    // run inline without first spending many steps in the inter-op
+    // threadpool. Kernels that report `OpKernel::IsExpensive() == false`, and
+    // kernels that have no measurements, keep their current estimates.
+    void UpdateFromCostModel(const GraphView& gview, const Graph& graph,
+                             const CostModel& cost_model) {
+      const double cycles_per_usec =
+          1.0 / profile_utils::CpuUtils::GetMicroSecPerClock();
+      if (!(cycles_per_usec > 0)) return;
+      for (const Node* n : graph.op_nodes()) {
+        const int32 id = n->id();
+        if (id >= gview.num_nodes()) continue;
+        const NodeItem* item = gview.node(id);
+        const int32 count = cost_model.TotalCount(n);
+        if (item == nullptr || item->kernel == nullptr ||
+            !item->kernel->IsExpensive() || count <= 0) {
+          continue;
+        }
+        // NOTE: `CostModel::TimeEstimate()` rounds up to one microsecond,
+        // which is above the threshold on most machines.
+        const uint64 estimate = static_cast<uint64>(
+            cost_model.TotalTime(n).value() * cycles_per_usec / count);
+        cost_estimates_[id].store(estimate, std::memory_order_relaxed);
+        is_expensive_[id].store(estimate > kOpIsExpensiveThresholdCycles,
+                                std::memory_order_relaxed);
+      }
+    }
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
@@ -209,10 +293,13 @@ class ExecutorImpl : public Executor {
 
     std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    // Null if latencies are not recorded.
+    std::unique_ptr<OpLatencyStats*[]> latency_stats_;
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const Options options_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -271,7 +358,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -285,15 +373,38 @@ class ExecutorState {
 
   struct AsyncState;
 
+  // A queue of ready nodes owned by the thread that is currently running
+  // `Process()` in work-stealing mode. Other threads steal from its back.
+  typedef WorkStealingQueue<TaggedNode, 64> WorkQueue;
+
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
+  // Claims an unused work queue for the calling thread, allocating it on first
+  // use. Returns the index of the claimed queue, or -1 if all queues are in
+  // use.
+  int ClaimWorkQueue();
+
+  // Steals a node from the back of any work queue other than `self` (which may
+  // be -1). Returns false if no work could be found.
+  bool StealWork(int self, TaggedNode* node);
+
+  // Starts up to `num_queued` thief closures on `runner_`, bounded by the
+  // maximum number of concurrent thieves.
+  void MaybeStartThieves(int num_queued, int64 scheduled_nsec);
+
+  // Body of a thief closure: steals a single node and then runs it via
+  // `Process()`, which keeps stealing until no more work is available.
+  void RunThief(int64 scheduled_nsec);
+
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
                     const TaggedNode& tagged_node, Entry* first_input,
                     NodeExecStatsInterface* stats);
   void ProcessNoop(NodeExecStatsInterface* stats);
+  void ProcessIdentity(const NodeItem& item, Entry* first_input,
+                       EntryVector* outputs, NodeExecStatsInterface* stats);
   void ProcessConstTensor(const NodeItem& item, EntryVector* outputs,
                           NodeExecStatsInterface* stats);
 
@@ -313,15 +424,21 @@ class ExecutorState {
   // This method will clear `*ready` before returning.
   bool NodeDone(const Status& s, TaggedNodeSeq* ready,
                 NodeExecStatsInterface* stats,
-                TaggedNodeReadyQueue* inline_ready);
+                TaggedNodeReadyQueue* inline_ready,
+                WorkQueue* work_queue = nullptr);
 
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // nodes in 'ready' into 'inline_ready'. If `work_queue` is not null, the
+  // expensive nodes that are not run inline are pushed onto `work_queue` for
+  // the calling thread (or a thief) to pick up, instead of being dispatched to
+  // `runner_`.
   //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
-  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
+  // REQUIRES: `work_queue == nullptr || inline_ready != nullptr`.
+  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+                     WorkQueue* work_queue = nullptr);
 
   // Clean up when this executor is done.
   void Finish();
@@ -363,6 +480,25 @@ class ExecutorState {
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
+  // The arena from which the nodes with `outputs_step_local` set allocate, if
+  // the device supports step arenas. This is declared before `propagator_` so
+  // that the arena is only released after the propagator has dropped its
+  // references to the step's tensors.
+  struct StepArena {
+    ~StepArena() {
+      if (arena != nullptr) pool->Release(arena);
+    }
+    StepArenaPool* pool = nullptr;
+    StepArenaAllocator* arena = nullptr;
+  };
+  StepArena step_arena_;
+
+  // The allocators that the caller provided for return values, indexed by the
+  // ID of the node that produces them, and by output number (see
+  // `OpKernelContext::Params::output_allocators`).
+  absl::flat_hash_map<int32, gtl::InlinedVector<Allocator*, 4>>
+      output_allocators_;
+
   PropagatorStateType propagator_;
 
   // Invoked when the execution finishes.
@@ -378,12 +514,26 @@ class ExecutorState {
 
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+
+  // Work-stealing dispatch state. Each thread that runs `Process()` claims one
+  // of the `kNumWorkQueues` queues for the duration of the call, and pushes
+  // the expensive nodes that it cannot run inline onto that queue. Idle
+  // threads (the "thieves") steal queued nodes from the back.
+  //
+  // Queues are allocated lazily, so a step with little parallelism only pays
+  // for the queues it actually uses.
+  static constexpr int kNumWorkQueues = 16;
+  const bool use_work_stealing_;
+  const int max_thieves_;
+  std::atomic<WorkQueue*> work_queues_[kNumWorkQueues];
+  std::atomic<bool> work_queue_claimed_[kNumWorkQueues];
+  std::atomic<int> num_thieves_;
 };
 
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -407,12 +557,44 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
-      num_outstanding_ops_(0) {
+      num_outstanding_ops_(0),
+      use_work_stealing_(use_work_stealing && !run_all_kernels_inline_),
+      max_thieves_(std::max(
+          1, std::min(kNumWorkQueues - 1, port::MaxParallelism() - 1))),
+      num_thieves_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  for (int i = 0; i < kNumWorkQueues; ++i) {
+    work_queues_[i].store(nullptr, std::memory_order_relaxed);
+    work_queue_claimed_[i].store(false, std::memory_order_relaxed);
+  }
+  if (immutable_state_.has_step_local_nodes()) {
+    step_arena_.pool = immutable_state_.params().device->step_arena_pool();
+    if (step_arena_.pool != nullptr) {
+      step_arena_.arena = step_arena_.pool->Acquire();
+    }
+  }
+  if (call_frame_ != nullptr) {
+    for (const auto& retval_output : immutable_state_.retval_outputs()) {
+      Allocator* allocator =
+          call_frame_->GetRetvalAllocator(retval_output.retval_index);
+      if (allocator == nullptr) continue;
+      auto& allocators = output_allocators_[retval_output.node_id];
+      if (allocators.empty()) {
+        allocators.resize(
+            immutable_state_.graph_view().node(retval_output.node_id)
+                ->num_outputs,
+            nullptr);
+      }
+      // If an output is returned more than once, the first allocator wins.
+      if (allocators[retval_output.output] == nullptr) {
+        allocators[retval_output.output] = allocator;
+      }
+    }
+  }
 }
 
 template <class PropagatorStateType>
@@ -421,6 +603,13 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  for (int i = 0; i < kNumWorkQueues; ++i) {
+    WorkQueue* queue = work_queues_[i].load(std::memory_order_relaxed);
+    if (queue != nullptr) {
+      DCHECK(queue->Empty());
+      delete queue;
+    }
+  }
 }
 
 template <class PropagatorStateType>
@@ -483,6 +672,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
   Entry* first_input;
   OpKernelContext ctx;
   NodeExecStatsInterface* stats;
+  // Started when the kernel is, if its latency is recorded.
+  KernelTimer timer;
 
  private:
   OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
@@ -525,6 +716,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  OpLatencyStats* latency_stats = kernel_stats_->LatencyStats(item);
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -535,13 +727,19 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
               ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
         },
         profiler::GetTFTraceMeLevel(is_expensive));
+    KernelTimer timer;
     device->Compute(op_kernel, &ctx);
+    if (latency_stats) latency_stats->Record(timer.ElapsedCycles());
   } else {
     // In the common case, avoid creating any tracing objects.
-    if (is_expensive) {
+    if (is_expensive || latency_stats) {
       KernelTimer timer;
       device->Compute(op_kernel, &ctx);
-      kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
+      const uint64 elapsed_cycles = timer.ElapsedCycles();
+      if (is_expensive) {
+        kernel_stats_->UpdateCostEstimate(item, elapsed_cycles);
+      }
+      if (latency_stats) latency_stats->Record(elapsed_cycles);
     } else {
       device->Compute(op_kernel, &ctx);
     }
@@ -568,6 +766,8 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     NodeExecStatsInterface* stats = state->stats;  // Shorthand
     Entry* first_input = state->first_input;       // Shorthand
 
+    OpLatencyStats* latency_stats = kernel_stats_->LatencyStats(*state->item);
+    if (latency_stats) latency_stats->Record(state->timer.ElapsedCycles());
     nodestats::SetOpEnd(stats);
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
@@ -595,6 +795,7 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     if (completed) ScheduleFinish();
   };
   nodestats::SetOpStart(stats);
+  state->timer = KernelTimer();
   {
     profiler::AnnotatedTraceMe activity(
         [async_kernel, state] {
@@ -614,6 +815,19 @@ void ExecutorState<PropagatorStateType>::ProcessNoop(
   nodestats::SetOpEnd(stats);
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ProcessIdentity(
+    const NodeItem& item, Entry* first_input, EntryVector* outputs,
+    NodeExecStatsInterface* stats) {
+  nodestats::SetOpStart(stats);
+  nodestats::SetOpEnd(stats);
+  // Forward the input entry without building an `OpKernelContext`. This is
+  // what `IdentityOp::Compute()` does for a non-ref input.
+  Entry& output = (*outputs)[0];
+  output = std::move(*first_input);
+  output.alloc_attr = item.output_attrs()[0];
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ProcessConstTensor(
     const NodeItem& item, EntryVector* outputs, NodeExecStatsInterface* stats) {
@@ -646,6 +860,21 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
 
+  // In work-stealing mode, claim a queue for the nodes that this thread
+  // produces but cannot run inline. While it owns a queue, this thread holds
+  // an extra reference on `num_outstanding_ops_`, so that the step cannot
+  // complete (and `this` cannot be deleted) before the queue is released.
+  int work_queue_index = -1;
+  WorkQueue* work_queue = nullptr;
+  if (use_work_stealing_) {
+    work_queue_index = ClaimWorkQueue();
+    if (work_queue_index >= 0) {
+      num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+      work_queue =
+          work_queues_[work_queue_index].load(std::memory_order_relaxed);
+    }
+  }
+
   // Parameters passed to OpKernel::Compute.
   TensorValueVec inputs;
   AllocatorAttributeVec input_alloc_attrs;
@@ -706,7 +935,18 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
 
   bool completed = false;
   inline_ready.push_back(tagged_node);
-  while (!inline_ready.empty()) {
+  while (true) {
+    if (inline_ready.empty()) {
+      // Run the most recently queued node from our own queue first, so that
+      // its inputs are likely to still be in cache. If our queue is empty, try
+      // to help other threads by stealing from theirs.
+      if (work_queue == nullptr) break;
+      if (!work_queue->PopFront(&tagged_node) &&
+          !StealWork(work_queue_index, &tagged_node)) {
+        break;
+      }
+      inline_ready.push_back(tagged_node);
+    }
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
     const NodeItem& item = tagged_node.get_node_item();
@@ -744,6 +984,10 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       ProcessNoop(stats);
     } else if (item.const_tensor != nullptr && !params.track_allocations) {
       ProcessConstTensor(item, &outputs, stats);
+    } else if (item.is_identity && !params.track_allocations &&
+               (first_input->state == Entry::State::HAS_VALUE ||
+                first_input->state == Entry::State::HAS_CONST_TENSOR)) {
+      ProcessIdentity(item, first_input, &outputs, stats);
     } else {
       // Prepares inputs.
       bool is_input_dead = false;
@@ -757,17 +1001,32 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         }
         propagator_.MaybeMarkCompleted(tagged_node);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, &ready, stats, &inline_ready);
+        completed = NodeDone(s, &ready, stats, &inline_ready, work_queue);
         continue;
       }
 
       // Set up compute params.
       params.op_kernel = item.kernel;
+      DeviceContext* node_device_context =
+          immutable_state_.node_device_context(item);
+      params.op_device_context = node_device_context != nullptr
+                                     ? node_device_context
+                                     : device_context_;
       params.frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
       params.outputs_required_array = item.outputs_required.get();
+      params.step_allocator =
+          item.outputs_step_local ? step_arena_.arena : nullptr;
+      params.output_allocators =
+          immutable_state_.recycling_output_allocators(item);
+      if (TF_PREDICT_FALSE(!output_allocators_.empty())) {
+        auto it = output_allocators_.find(id);
+        if (it != output_allocators_.end()) {
+          params.output_allocators = it->second.data();
+        }
+      }
 
       if (item.kernel_is_async) {
         ProcessAsync(item, params, tagged_node, first_input, stats);
@@ -806,14 +1065,83 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         scheduled_nsec = nodestats::NowInNsec();
       }
       // Postprocess.
-      completed = NodeDone(s, &ready, stats, &inline_ready);
+      completed = NodeDone(s, &ready, stats, &inline_ready, work_queue);
     }
-  }  // while !inline_ready.empty()
+  }  // while (true)
+
+  if (work_queue != nullptr) {
+    // NOTE: Only the owner pushes onto `work_queue`, so it is guaranteed to
+    // stay empty once we have observed it to be empty above.
+    DCHECK(!completed);
+    work_queue_claimed_[work_queue_index].store(false,
+                                                std::memory_order_release);
+    completed = num_outstanding_ops_.fetch_sub(1) == 1;
+  }
 
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
 }
 
+template <class PropagatorStateType>
+int ExecutorState<PropagatorStateType>::ClaimWorkQueue() {
+  for (int i = 0; i < kNumWorkQueues; ++i) {
+    if (work_queue_claimed_[i].load(std::memory_order_relaxed)) continue;
+    bool expected = false;
+    if (work_queue_claimed_[i].compare_exchange_strong(
+            expected, true, std::memory_order_acquire)) {
+      if (work_queues_[i].load(std::memory_order_relaxed) == nullptr) {
+        work_queues_[i].store(new WorkQueue, std::memory_order_release);
+      }
+      return i;
+    }
+  }
+  return -1;
+}
+
+template <class PropagatorStateType>
+bool ExecutorState<PropagatorStateType>::StealWork(int self,
+                                                   TaggedNode* node) {
+  const int start = self + 1;
+  for (int i = 0; i < kNumWorkQueues; ++i) {
+    const int victim = (start + i) % kNumWorkQueues;
+    if (victim == self) continue;
+    WorkQueue* queue = work_queues_[victim].load(std::memory_order_acquire);
+    if (queue != nullptr && !queue->Empty() && queue->PopBack(node)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartThieves(
+    int num_queued, int64 scheduled_nsec) {
+  for (int i = 0; i < num_queued; ++i) {
+    int num_thieves = num_thieves_.load(std::memory_order_relaxed);
+    if (num_thieves >= max_thieves_ ||
+        !num_thieves_.compare_exchange_weak(num_thieves, num_thieves + 1,
+                                            std::memory_order_relaxed)) {
+      return;
+    }
+    // Like the owners of work queues, each thief holds a reference on
+    // `num_outstanding_ops_` until it returns.
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+    runner_([this, scheduled_nsec]() { RunThief(scheduled_nsec); });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunThief(int64 scheduled_nsec) {
+  num_thieves_.fetch_sub(1, std::memory_order_relaxed);
+  TaggedNode tagged_node;
+  if (StealWork(-1, &tagged_node)) {
+    // `Process()` continues to steal work after it has finished
+    // `tagged_node` and everything that it made ready.
+    Process(tagged_node, scheduled_nsec);
+  }
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::PrepareInputs(
     const NodeItem& item, Entry* first_input, TensorValueVec* inputs,
@@ -1027,7 +1355,7 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
 template <class PropagatorStateType>
 bool ExecutorState<PropagatorStateType>::NodeDone(
     const Status& s, TaggedNodeSeq* ready, NodeExecStatsInterface* stats,
-    TaggedNodeReadyQueue* inline_ready) {
+    TaggedNodeReadyQueue* inline_ready, WorkQueue* work_queue) {
   if (stats) {
     nodestats::SetAllEnd(stats);
     DCHECK_NE(stats_collector_, nullptr);
@@ -1046,7 +1374,7 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
       }
 
       // Schedule the ready nodes in 'ready'.
-      ScheduleReady(ready, inline_ready);
+      ScheduleReady(ready, inline_ready, work_queue);
 
       return false;
     }
@@ -1102,8 +1430,10 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
 
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleReady(
-    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    WorkQueue* work_queue) {
   DCHECK(!ready->empty());
+  DCHECK(work_queue == nullptr || inline_ready != nullptr);
 
   int64 scheduled_nsec = 0;
   if (stats_collector_) {
@@ -1126,6 +1456,39 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_queue != nullptr) {
+    // Keep the first expensive node for this thread (unless there are
+    // inexpensive nodes to run inline), and queue the remaining ones where
+    // this thread or an idle thief can pick them up.
+    const TaggedNode* curr_expensive_node = nullptr;
+    int num_queued = 0;
+    auto enqueue = [this, work_queue, scheduled_nsec,
+                    &num_queued](const TaggedNode& tagged_node) {
+      if (work_queue->PushFront(tagged_node)) {
+        ++num_queued;
+      } else {
+        // The queue is full: fall back to dispatching a closure.
+        runner_(std::bind(&ExecutorState::Process, this, tagged_node,
+                          scheduled_nsec));
+      }
+    };
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        inline_ready->push_back(tagged_node);
+      } else {
+        if (curr_expensive_node) enqueue(*curr_expensive_node);
+        curr_expensive_node = &tagged_node;
+      }
+    }
+    if (curr_expensive_node) {
+      if (inline_ready->empty()) {
+        inline_ready->push_back(*curr_expensive_node);
+      } else {
+        enqueue(*curr_expensive_node);
+      }
+    }
+    if (num_queued > 0) MaybeStartThieves(num_queued, scheduled_nsec);
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
@@ -1299,20 +1662,31 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        options_.use_work_stealing))
+        ->RunAsync(std::move(done));
+  } else if (immutable_state_.has_frozen_plan()) {
+    // NOTE: Nodes run one at a time with a frozen plan, so there is no work
+    // to steal.
+    (new ExecutorState<FrozenPlanPropagatorState>(
+         args, immutable_state_, &kernel_stats_, /*use_work_stealing=*/false))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, options_.use_work_stealing))
         ->RunAsync(std::move(done));
   }
 }
 
 }  // namespace
 
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+namespace {
+
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph,
+                            const ExecutorImpl::Options& options,
+                            Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, options);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1322,6 +1696,14 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph, ExecutorImpl::Options(),
+                              executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1357,6 +1739,47 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers variants of the default executor that are selected by setting
+// `ConfigProto.experimental.executor_type`:
+//
+// * "WORK_STEALING" dispatches ready nodes through per-thread work-stealing
+//   queues.
+// * "FROZEN_PLAN" runs graphs without control flow as a sequential walk over
+//   a precomputed schedule, which minimizes the per-node overhead for graphs
+//   with little inter-op parallelism.
+class ExecutorVariantRegistrar {
+ public:
+  ExecutorVariantRegistrar() {
+    ExecutorImpl::Options work_stealing_options;
+    work_stealing_options.use_work_stealing = true;
+    ExecutorFactory::Register("WORK_STEALING",
+                              new Factory(work_stealing_options));
+
+    ExecutorImpl::Options frozen_plan_options;
+    frozen_plan_options.use_frozen_plan = true;
+    ExecutorFactory::Register("FROZEN_PLAN", new Factory(frozen_plan_options));
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+   public:
+    explicit Factory(const ExecutorImpl::Options& options)
+        : options_(options) {}
+
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, graph, options_, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+
+   private:
+    const ExecutorImpl::Options options_;
+  };
+};
+static ExecutorVariantRegistrar executor_variant_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
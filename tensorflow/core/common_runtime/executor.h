@@ -31,6 +31,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+class CostModel;
 class StepStatsCollector;
 
 // Executor runs a graph computation.
@@ -122,6 +123,14 @@ class Executor {
     n.WaitForNotification();
     return ret;
   }
+
+  // Updates the executor's estimates of how long each kernel takes from the
+  // execution times measured in "cost_model", which must have been built for
+  // "graph", the graph that this executor computes. The executor may use
+  // these estimates to run cheap kernels inline, on the thread that made them
+  // ready, instead of dispatching a closure for each of them to "runner".
+  virtual void UpdateCostEstimates(const Graph& graph,
+                                   const CostModel& cost_model) {}
 };
 
 // Creates an Executor that computes the given "graph".
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,10 +26,12 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/op.h"
@@ -37,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -66,8 +70,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is not empty, the executor is created through the
+  // corresponding `ExecutorFactory`.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -82,7 +89,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -205,6 +218,95 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(out));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, IdentityChain) {
+  // b <- Identity^10(a) + Identity^10(c), where c is a constant.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto c = test::graph::Constant(g.get(), V(2.0));
+  const int N = 10;
+  for (int i = 0; i < N; ++i) {
+    v = test::graph::Identity(g.get(), v);
+    c = test::graph::Identity(g.get(), c);
+  }
+  test::graph::Send(g.get(), test::graph::Add(g.get(), v, c), "b", BOB, 1,
+                    ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(3.0, V(out));
+}
+
+// Builds a graph that computes the sum of `N` identical additions of a
+// constant, which all become ready at the same time.
+void BuildFanOut(int N, Graph* g) {
+  auto c = test::graph::Constant(g, V(1.0));
+  std::vector<Node*> nodes;
+  for (int i = 0; i < N; ++i) {
+    nodes.push_back(test::graph::Add(g, c, c));
+  }
+  while (nodes.size() > 1) {
+    nodes.push_back(test::graph::Add(g, nodes[0], nodes[1]));
+    nodes.erase(nodes.begin(), nodes.begin() + 2);
+  }
+  test::graph::Send(g, nodes.back(), "b", BOB, 1, ALICE);
+}
+
+TEST_F(ExecutorTest, CostModelInlinesCheapKernels) {
+  const int N = 16;
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildFanOut(N, g.get());
+  Create(std::move(g));
+  // An identical graph (with the same node ids) for the cost model.
+  Graph graph(OpRegistry::Global());
+  BuildFanOut(N, &graph);
+
+  std::atomic<int> num_closures(0);
+  runner_ = [this, &num_closures](std::function<void()> fn) {
+    ++num_closures;
+    thread_pool_->Schedule(fn);
+  };
+  auto run_step = [this, &num_closures]() {
+    num_closures = 0;
+    TF_EXPECT_OK(Run(rendez_));
+    Rendezvous::Args args;
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_EXPECT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(2.0 * N, V(out));
+    return num_closures.load();
+  };
+  // Records that each kernel ran 100 times, in `time` microseconds in total.
+  auto update_cost_estimates = [this, &graph](Microseconds time) {
+    CostModel cost_model(/*is_global=*/false);
+    cost_model.InitFromGraph(graph);
+    for (const Node* n : graph.op_nodes()) {
+      cost_model.RecordCount(n, 100);
+      cost_model.RecordTime(n, time);
+    }
+    exec_->UpdateCostEstimates(graph, cost_model);
+  };
+
+  // The additions start out "expensive", and all but one of them are
+  // dispatched to the threadpool.
+  EXPECT_GE(run_step(), N - 1);
+
+  // Once the executor knows that they are cheap, they run inline and only
+  // the root nodes are dispatched.
+  update_cost_estimates(/*time=*/Microseconds(10));
+  EXPECT_LE(run_step(), 2);
+
+  // ... and they can become expensive again.
+  update_cost_estimates(/*time=*/Microseconds(100 * 1000));
+  EXPECT_GE(run_step(), N - 1);
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -212,10 +314,13 @@ TEST_F(ExecutorTest, SelfAdd) {
 //     (a + a) + (a + a)
 //     ((a + a) + a) + a
 // are all possibly generated.
-void BuildTree(int N, Graph* g) {
+//
+// The input is received from `sender`. If `sender` is BOB, the graph does not
+// require control flow support.
+void BuildTree(int N, Graph* g, const char* sender = ALICE) {
   CHECK_GT(N, 1);
   // A single input node "in".
-  auto in = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  auto in = test::graph::Recv(g, "a", "float", sender, 1, BOB);
   std::vector<Node*> nodes;
   int i = 0;
   // Duplicate "in" N times. Each copies is named as l0, l1, l2, ....
@@ -255,6 +360,148 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 8; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, RandomTreeFrozenPlan) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get(), /*sender=*/BOB);
+  Create(std::move(g), "FROZEN_PLAN");
+  for (int iters = 0; iters < 8; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(BOB, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, RandomTreeStepArena) {
+  // Step arenas are enabled when the device is created.
+  setenv("TF_CPU_STEP_ARENA_MB", "16", /*overwrite=*/1);
+  device_ =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  unsetenv("TF_CPU_STEP_ARENA_MB");
+  StepArenaPool* pool = device_->step_arena_pool();
+  ASSERT_NE(nullptr, pool);
+
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get(), /*sender=*/BOB);
+  Create(std::move(g));
+  for (int iters = 0; iters < 8; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(BOB, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+    // The intermediate tensors were allocated from the arena. The fetched
+    // tensor may still pin a chunk if a kernel forwarded an arena buffer to
+    // it, but that chunk is reclaimed once the tensor has been released.
+    EXPECT_LT(0, pool->num_cached_chunks() + pool->num_pinned_chunks());
+    EXPECT_LE(pool->num_pinned_chunks(), 1);
+  }
+}
+
+TEST_F(ExecutorTest, FrozenPlanAbort) {
+  // c = a + b, where "b" is never sent.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", BOB, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", BOB, 1, BOB);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), "FROZEN_PLAN");
+  TF_ASSERT_OK(rendez_->Send(Key(BOB, kIncarnation, BOB, "a"),
+                             Rendezvous::Args(), V(1.0), false));
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(100 * 1000);
+    rendez_->StartAbort(errors::Aborted(""));
+    rendez_->Unref();
+  });
+  EXPECT_TRUE(errors::IsAborted(Run(rendez_)));
+}
+
+TEST_F(ExecutorTest, FrozenPlanRecvOfSendInGraph) {
+  // "b" is sent and received by the graph, so its receive must not block a
+  // frozen plan that runs it before the send. The receive is created first
+  // so that it would come first in the plan.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto recv_b = test::graph::Recv(g.get(), "b", "float", BOB, 1, BOB);
+  auto recv_a = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  test::graph::Send(g.get(), recv_a, "b", BOB, 1, BOB);
+  test::graph::Send(g.get(), recv_b, "c", BOB, 1, ALICE);
+  Create(std::move(g), "FROZEN_PLAN");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));
+}
+
+TEST_F(ExecutorTest, SimpleSwitchDeadFrozenPlan) {
+  // Graphs that require control flow support fall back to the default
+  // propagator.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), "FROZEN_PLAN");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
+TEST_F(ExecutorTest, SimpleSwitchDeadWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -433,7 +680,8 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(int iters, int width, int depth) {
+static void BM_ExecutorHelper(int iters, int width, int depth,
+                              const char* executor_type) {
   testing::StopTiming();
 #ifdef PLATFORM_GOOGLE
   BenchmarkUseRealTime();
@@ -472,7 +720,12 @@ static void BM_executor(int iters, int width, int depth) {
 #endif  // PLATFORM_GOOGLE
   FixupSourceAndSinkEdges(g);
   testing::StartTiming();
-  test::Benchmark("cpu", g).Run(iters);
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr, executor_type)
+      .Run(iters);
+}
+
+static void BM_executor(int iters, int width, int depth) {
+  BM_ExecutorHelper(iters, width, depth, /*executor_type=*/"");
 }
 
 // Tall skinny graphs
@@ -486,6 +739,29 @@ BENCHMARK(BM_executor)->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->ArgPair(1024, 1024);
 
+// Same graphs as `BM_executor`, run with the work-stealing executor. Compare
+// the per-iteration (i.e. step) latency against `BM_executor`.
+static void BM_work_stealing_executor(int iters, int width, int depth) {
+  BM_ExecutorHelper(iters, width, depth, /*executor_type=*/"WORK_STEALING");
+}
+
+BENCHMARK(BM_work_stealing_executor)->ArgPair(16, 1024);
+BENCHMARK(BM_work_stealing_executor)->ArgPair(32, 8192);
+BENCHMARK(BM_work_stealing_executor)->ArgPair(1024, 16);
+BENCHMARK(BM_work_stealing_executor)->ArgPair(8192, 32);
+BENCHMARK(BM_work_stealing_executor)->ArgPair(1024, 1024);
+
+// Same graphs as `BM_executor`, run with a frozen plan.
+static void BM_frozen_plan_executor(int iters, int width, int depth) {
+  BM_ExecutorHelper(iters, width, depth, /*executor_type=*/"FROZEN_PLAN");
+}
+
+BENCHMARK(BM_frozen_plan_executor)->ArgPair(16, 1024);
+BENCHMARK(BM_frozen_plan_executor)->ArgPair(32, 8192);
+BENCHMARK(BM_frozen_plan_executor)->ArgPair(1024, 16);
+BENCHMARK(BM_frozen_plan_executor)->ArgPair(8192, 32);
+BENCHMARK(BM_frozen_plan_executor)->ArgPair(1024, 1024);
+
 static void BM_const_identity(int iters, int width, int outputs_per_const) {
 #ifdef PLATFORM_GOOGL
   BenchmarkUseRealTime();
@@ -0,0 +1,102 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/frozen_plan_propagator_state.h"
+
+#include "tensorflow/core/common_runtime/propagator_debug_utils.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+FrozenPlanPropagatorState::FrozenPlanPropagatorState(
+    const ImmutableExecutorState& immutable_state, int64 step_id, bool vlog)
+    : immutable_state_(immutable_state),
+      step_id_(step_id),
+      vlog_(vlog || VLOG_IS_ON(1)),
+      plan_(immutable_state.frozen_plan()),
+      input_tensors_(immutable_state.get_root_frame_info().total_inputs),
+      active_position_(-1) {}
+
+FrozenPlanPropagatorState::~FrozenPlanPropagatorState() {}
+
+void FrozenPlanPropagatorState::ActivateRoots(
+    gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
+  if (plan_.empty()) return;
+  DCHECK(!roots.empty());
+  DCHECK_EQ(plan_[0]->num_inputs, 0);
+  ready->emplace_back(plan_[0]);
+}
+
+void FrozenPlanPropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
+                                                 EntryVector* outputs,
+                                                 TaggedNodeSeq* ready) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat(
+            "ExecutorPropagateOutputs#", "id=", step_id_,
+            ",kernel_name=", tagged_node.node_item->kernel->name_view(),
+            ",num_output_edges=", tagged_node.node_item->num_output_edges, "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+
+  DCHECK(ready->empty());
+  const NodeItem* item = tagged_node.node_item;
+
+  // The destination slots were resolved when the graph view was built, so we
+  // only need to copy (or move, for the last consumer) each output. Control
+  // edges need no work at all, because the plan already orders their
+  // endpoints.
+  for (const EdgeInfo& e : item->output_edges()) {
+    if (e.is_last) {
+      input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+    } else {
+      input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+    }
+  }
+
+  const size_t next = immutable_state_.frozen_plan_position(*item) + 1;
+  if (next < plan_.size()) {
+    ready->emplace_back(plan_[next]);
+  }
+}
+
+void FrozenPlanPropagatorState::DumpState() {
+  // Dump the nodes that have not run yet and are holding on to tensors.
+  const int32 active = active_position_.load(std::memory_order_relaxed);
+  for (size_t i = active + 1; i < plan_.size(); ++i) {
+    DumpPendingNodeState(*plan_[i], input_tensors_.data(), false);
+  }
+  // Then the active node.
+  if (active >= 0) {
+    DumpActiveNodeState(*plan_[active], input_tensors_.data());
+  }
+  // Show all input tensors in use.
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < input_tensors_.size(); ++i) {
+    const Entry& input = input_tensors_[i];
+    const Tensor* tensor = GetTensorValueForDump(input);
+    if (tensor && tensor->IsInitialized()) {
+      LOG(WARNING) << "    Input " << i << ": "
+                   << strings::StrCat(
+                          "Tensor<type: ", DataTypeString(tensor->dtype()),
+                          " shape: ", tensor->shape().DebugString(),
+                          ", bytes: ", tensor->TotalBytes(), ">");
+      total_bytes += tensor->TotalBytes();
+    }
+  }
+  LOG(WARNING) << "    Total bytes " << total_bytes;
+}
+
+}  // namespace tensorflow
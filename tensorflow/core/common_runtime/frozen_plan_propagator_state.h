@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FROZEN_PLAN_PROPAGATOR_STATE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FROZEN_PLAN_PROPAGATOR_STATE_H_
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Represents the ephemeral "edge state" associated with one invocation of
+// `Executor::Run()` for an executor that uses a frozen plan (see
+// `ImmutableExecutorState::BuildFrozenPlan()`).
+//
+// Instead of tracking how many inputs of each node are still pending,
+// `FrozenPlanPropagatorState` runs the nodes one at a time, in the precomputed
+// topological order. Because a node always runs after all of its producers,
+// propagating outputs reduces to writing them into the pre-resolved input
+// slots of the consumers, and making the next node in the plan ready. As a
+// result, every step is a sequential walk over a flat array, and cheap kernels
+// run back-to-back on the same thread without any atomic operations or
+// closure dispatch.
+//
+// This is only profitable for graphs without inter-op parallelism to exploit,
+// e.g. small-batch CPU inference graphs, and is therefore only used when the
+// executor is explicitly created with the "FROZEN_PLAN" executor type.
+//
+// NOTE: Like `SimplePropagatorState`, `FrozenPlanPropagatorState` does not
+// support "v1-style" control flow. Graphs with asynchronous kernels which may
+// wait for other nodes of the graph, such as queue ops, are not frozen either.
+class FrozenPlanPropagatorState {
+ public:
+  FrozenPlanPropagatorState(const ImmutableExecutorState& immutable_state,
+                            int64 step_id, bool vlog);
+  ~FrozenPlanPropagatorState();
+
+  // The node and queue types are the same as for `SimplePropagatorState`.
+  typedef SimplePropagatorState::TaggedNode TaggedNode;
+  typedef SimplePropagatorState::TaggedNodeReadyQueue TaggedNodeReadyQueue;
+  typedef SimplePropagatorState::TaggedNodeSeq TaggedNodeSeq;
+
+  // Adds a `TaggedNode` for the first node of the plan to `*ready`. All other
+  // roots in `roots` are made ready in plan order, by `PropagateOutputs()`.
+  void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
+                     TaggedNodeSeq* ready);
+
+  // After processing the outputs, propagates the outputs to their dsts, and
+  // adds the next node in the plan (if any) to `*ready`.
+  // Contents of *outputs are left in an indeterminate state after
+  // returning from this method.
+  void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
+                        TaggedNodeSeq* ready);
+
+  // Returns an array of `Entry` objects corresponding to the inputs of
+  // `tagged_node`.
+  Entry* GetInputTensors(const TaggedNode& tagged_node) {
+    return input_tensors_.data() + tagged_node.node_item->input_start;
+  }
+
+  FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
+    return {0, 0};
+  }
+
+  // Provide debugging output of the state of the executor.
+  void DumpState();
+
+  // For debugging/logging only.
+  void MaybeMarkStarted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_)) {
+      active_position_.store(
+          immutable_state_.frozen_plan_position(*tagged_node.node_item),
+          std::memory_order_relaxed);
+    }
+  }
+  void MaybeMarkCompleted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_)) {
+      active_position_.store(-1, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  const ImmutableExecutorState& immutable_state_;
+  const int64 step_id_;
+  const bool vlog_;
+  const std::vector<const NodeItem*>& plan_;
+
+  // The i-th node's j-th input is stored at
+  // `input_tensors[impl_->nodes[i].input_start + j]`.
+  //
+  // NOTE: No need to protect input_tensors[i] by any locks because nodes run
+  // one at a time, and there is a happens-before relation (through the
+  // executor's ready queue or closure dispatch) between a node and its
+  // successor in the plan.
+  std::vector<Entry> input_tensors_;
+
+  // If `vlog_` is true, the plan position of the currently running node, or
+  // -1 if no node is running.
+  std::atomic<int32> active_position_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FrozenPlanPropagatorState);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FROZEN_PLAN_PROPAGATOR_STATE_H_
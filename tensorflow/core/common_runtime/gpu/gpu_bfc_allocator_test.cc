@@ -233,6 +233,278 @@ TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST(GPUBFCAllocatorTest, ThreadLocalCaches) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_BFC_ALLOCATOR_THREAD_CACHE", "true", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_THREAD_CACHE");
+
+  // Small allocations are rounded up to their size class.
+  void* p1 = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(1024, a.AllocatedSize(p1));
+  a.DeallocateRaw(p1);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->num_thread_cache_hits);
+  EXPECT_EQ(1, stats->num_thread_cache_misses);
+  EXPECT_EQ(1024, stats->bytes_in_thread_caches);
+  EXPECT_EQ(1024, stats->bytes_in_use);
+
+  // The freed chunk is reused from the cache.
+  void* p2 = a.AllocateRaw(1, 900);
+  EXPECT_EQ(p1, p2);
+  stats = a.GetStats();
+  EXPECT_EQ(1, stats->num_thread_cache_hits);
+  EXPECT_EQ(0, stats->bytes_in_thread_caches);
+
+  // Large allocations bypass the caches.
+  void* p3 = a.AllocateRaw(1, 1 << 20);
+  EXPECT_EQ(1 << 20, a.AllocatedSize(p3));
+  a.DeallocateRaw(p3);
+  a.DeallocateRaw(p2);
+  stats = a.GetStats();
+  EXPECT_EQ(1, stats->num_thread_cache_hits);
+  EXPECT_EQ(1, stats->num_thread_cache_misses);
+  EXPECT_EQ(1024, stats->bytes_in_use);
+}
+
+TEST(GPUBFCAllocatorTest, ThreadLocalCachesAreFlushedOnOOM) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_BFC_ALLOCATOR_THREAD_CACHE", "true", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 20, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_THREAD_CACHE");
+
+  // Fill up the memory with small allocations, and free them into the caches.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    void* ptr = a.AllocateRaw(1, 16 << 10);
+    ASSERT_NE(nullptr, ptr);
+    ptrs.push_back(ptr);
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  EXPECT_LT(0, a.GetStats()->bytes_in_thread_caches);
+
+  // A large allocation can only be satisfied after the caches are flushed.
+  void* large = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, large);
+  EXPECT_EQ(0, a.GetStats()->bytes_in_thread_caches);
+  a.DeallocateRaw(large);
+}
+
+TEST(GPUBFCAllocatorTest, ThreadLocalCachesMultipleThreads) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_BFC_ALLOCATOR_THREAD_CACHE", "true", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_THREAD_CACHE");
+
+  constexpr int kNumThreads = 8;
+  std::vector<std::vector<void*>> live(kNumThreads);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&a, &live, t]() {
+        random::PhiloxRandom philox(t, 17);
+        random::SimplePhilox rand(&philox);
+        for (int i = 0; i < 10000; ++i) {
+          void* ptr = a.AllocateRaw(1, 1 + rand.Uniform(64 << 10));
+          // Keep some allocations alive, and free the rest from a thread
+          // other than the one that allocated them.
+          live[t].push_back(ptr);
+          if (i % 3 != 0) {
+            int victim = rand.Uniform(live[t].size());
+            std::swap(live[t][victim], live[t].back());
+            a.DeallocateRaw(live[t].back());
+            live[t].pop_back();
+          }
+        }
+      });
+    }
+  }
+  std::vector<void*> ptrs;
+  for (const auto& v : live) ptrs.insert(ptrs.end(), v.begin(), v.end());
+  std::sort(ptrs.begin(), ptrs.end());
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    ASSERT_LE(static_cast<char*>(ptrs[i - 1]) + a.AllocatedSize(ptrs[i - 1]),
+              static_cast<char*>(ptrs[i]));
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_LT(0, stats->num_thread_cache_hits);
+  EXPECT_EQ(stats->bytes_in_use, stats->bytes_in_thread_caches);
+}
+
+// Makes the same sequence of allocations as every step of a training loop
+// with fixed shapes, and returns the allocated pointers.
+std::vector<void*> RunPlannedStep(BFCAllocator* a) {
+  a->NotifyStepBegin();
+  std::vector<void*> ptrs;
+  void* p1 = a->AllocateRaw(1, 1000);
+  void* p2 = a->AllocateRaw(1, 5000);
+  a->DeallocateRaw(p1);
+  void* p3 = a->AllocateRaw(1, 3000);
+  a->DeallocateRaw(p2);
+  EXPECT_EQ(3072, a->AllocatedSize(p3));
+  EXPECT_EQ(3000, a->RequestedSize(p3));
+  a->DeallocateRaw(p3);
+  return {p1, p2, p3};
+}
+
+TEST(GPUBFCAllocatorTest, MemoryPlan) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS", "4", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS");
+
+  // The first two steps are recorded, and the following ones are replayed.
+  RunPlannedStep(&a);
+  RunPlannedStep(&a);
+  EXPECT_EQ(0, a.GetStats()->num_planned_allocs);
+  std::vector<void*> planned = RunPlannedStep(&a);
+  EXPECT_EQ(3, a.GetStats()->num_planned_allocs);
+  // The plan reuses the memory of p1 for p3.
+  EXPECT_EQ(planned[0], planned[2]);
+  EXPECT_NE(planned[0], planned[1]);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(planned, RunPlannedStep(&a));
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(12, stats->num_planned_allocs);
+  EXPECT_EQ(0, stats->num_plan_divergences);
+
+  // A step that makes different allocations falls back to the bins as soon
+  // as it diverges from the plan.
+  a.NotifyStepBegin();
+  void* p1 = a.AllocateRaw(1, 1000);
+  void* p2 = a.AllocateRaw(1, 8000);
+  EXPECT_EQ(planned[0], p1);
+  EXPECT_NE(planned[1], p2);
+  EXPECT_EQ(8192, a.AllocatedSize(p2));
+  void* p3 = a.AllocateRaw(1, 3000);
+  EXPECT_NE(planned[2], p3);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  stats = a.GetStats();
+  EXPECT_EQ(13, stats->num_planned_allocs);
+  EXPECT_EQ(1, stats->num_plan_divergences);
+
+  // The following steps replay the plan again.
+  EXPECT_EQ(planned, RunPlannedStep(&a));
+  EXPECT_EQ(16, a.GetStats()->num_planned_allocs);
+}
+
+TEST(GPUBFCAllocatorTest, MemoryPlanWithLiveAllocations) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS", "4", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS");
+
+  RunPlannedStep(&a);
+  RunPlannedStep(&a);
+  std::vector<void*> planned = RunPlannedStep(&a);
+
+  // Deallocating in a different order than recorded diverges from the plan
+  // instead of handing out memory that is still in use.
+  a.NotifyStepBegin();
+  void* p1 = a.AllocateRaw(1, 1000);
+  void* p2 = a.AllocateRaw(1, 5000);
+  void* p3 = a.AllocateRaw(1, 3000);
+  EXPECT_EQ(planned[0], p1);
+  EXPECT_EQ(planned[1], p2);
+  EXPECT_NE(p1, p3);
+  a.DeallocateRaw(p2);
+  EXPECT_EQ(1, a.GetStats()->num_plan_divergences);
+
+  // A step that starts while planned allocations are still live does not
+  // replay the plan.
+  a.NotifyStepBegin();
+  void* p4 = a.AllocateRaw(1, 1000);
+  EXPECT_NE(p1, p4);
+  EXPECT_EQ(2, a.GetStats()->num_plan_divergences);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p3);
+  a.DeallocateRaw(p4);
+  EXPECT_EQ(planned, RunPlannedStep(&a));
+}
+
+TEST(GPUBFCAllocatorTest, MemoryPlanGivesUpOnNonRepeatingSteps) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS", "3", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_MEMORY_PLAN_STEPS");
+
+  for (int step = 0; step < 10; ++step) {
+    a.NotifyStepBegin();
+    a.DeallocateRaw(a.AllocateRaw(1, 1024 * (step + 1)));
+  }
+  RunPlannedStep(&a);
+  RunPlannedStep(&a);
+  RunPlannedStep(&a);
+  EXPECT_EQ(0, a.GetStats()->num_planned_allocs);
+}
+
+TEST(GPUBFCAllocatorTest, AllocationTimeline) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  setenv("TF_ALLOCATION_TIMELINE_EVENTS", "64", 1);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_ALLOCATION_TIMELINE_EVENTS");
+  EXPECT_FALSE(a.LastStepMemoryReport().has_value());
+
+  a.NotifyStepBegin();
+  void* p1;
+  void* p2;
+  {
+    ScopedMemoryDebugAnnotation annotation("conv", /*step_id=*/3);
+    p1 = a.AllocateRaw(1, 4096);
+    p2 = a.AllocateRaw(1, 1024);
+  }
+  a.DeallocateRaw(p2);
+  void* p3;
+  {
+    ScopedMemoryDebugAnnotation annotation("add", /*step_id=*/3);
+    p3 = a.AllocateRaw(1, 256);
+  }
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p3);
+  a.NotifyStepEnd(3);
+
+  absl::optional<AllocationTimelineReport> report = a.LastStepMemoryReport();
+  ASSERT_TRUE(report.has_value());
+  EXPECT_EQ(6, report->num_events);
+  EXPECT_EQ(4096 + 1024, report->peak_bytes_in_use);
+  EXPECT_EQ(3, report->peak_step_id);
+  ASSERT_EQ(1, report->peak_bytes_by_op.size());
+  EXPECT_EQ("conv", report->peak_bytes_by_op[0].first);
+  EXPECT_EQ(4096 + 1024, report->peak_bytes_by_op[0].second);
+  EXPECT_EQ(0, report->peak_bytes_from_earlier);
+  EXPECT_GT(report->largest_free_chunk_bytes, 0);
+}
+
 TEST(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
@@ -0,0 +1,174 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef GOOGLE_CUDA
+#include "third_party/gpus/cuda/include/cuda.h"
+#include "tensorflow/stream_executor/cuda/cuda_activation.h"
+#endif  // GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
+#include "tensorflow/core/platform/logging.h"
+
+// cuMemAllocAsync and the memory pools were added in CUDA 11.2.
+#if defined(GOOGLE_CUDA) && CUDA_VERSION >= 11020
+#define TF_CUDA_MALLOC_ASYNC_SUPPORTED 1
+#endif
+
+namespace tensorflow {
+
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+namespace {
+
+string GetCudaErrorString(CUresult result) {
+  const char* error = nullptr;
+  cuGetErrorString(result, &error);
+  return error == nullptr ? "unknown error" : error;
+}
+
+}  // namespace
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
+GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
+    PlatformGpuId platform_gpu_id, size_t pool_size, size_t release_threshold,
+    const string& name)
+    : name_(name) {
+  stream_exec_ =
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie();
+  stats_.bytes_limit = static_cast<int64>(pool_size);
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUdevice device;
+  CUresult res = cuDeviceGet(&device, stream_exec_->device_ordinal());
+  if (res == CUDA_SUCCESS) {
+    CUmemoryPool pool;
+    res = cuDeviceGetDefaultMemPool(&pool, device);
+    pool_ = pool;
+  }
+  if (res != CUDA_SUCCESS) {
+    LOG(FATAL) << "Failed to get the memory pool of GPU "
+               << platform_gpu_id.value() << ": " << GetCudaErrorString(res);
+  }
+  // Without a threshold, the pool gives all freed memory back to the device
+  // at every synchronization, and cuMemAllocAsync keeps asking the driver for
+  // it again.
+  cuuint64_t threshold = release_threshold > 0 ? release_threshold : pool_size;
+  res = cuMemPoolSetAttribute(static_cast<CUmemoryPool>(pool_),
+                              CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold);
+  if (res != CUDA_SUCCESS) {
+    LOG(FATAL) << "Failed to set the release threshold of GPU "
+               << platform_gpu_id.value() << ": " << GetCudaErrorString(res);
+  }
+  VLOG(1) << Name() << " keeps up to " << threshold
+          << " bytes of freed memory cached";
+#else
+  LOG(FATAL) << "GPUOptions.allocator_type cuda_malloc_async requires "
+                "TensorFlow to be built with CUDA 11.2 or newer.";
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+GpuCudaMallocAsyncAllocator::~GpuCudaMallocAsyncAllocator() {}
+
+/*static*/ bool GpuCudaMallocAsyncAllocator::IsSupported() {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  int driver_version = 0;
+  return cuDriverGetVersion(&driver_version) == CUDA_SUCCESS &&
+         driver_version >= 11020;
+#else
+  return false;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+void GpuCudaMallocAsyncAllocator::SetStream(void* stream) {
+  mutex_lock l(mu_);
+  stream_ = stream;
+}
+
+void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
+                                               size_t num_bytes) {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  mutex_lock l(mu_);
+  if (stats_.bytes_in_use + static_cast<int64>(num_bytes) >
+      *stats_.bytes_limit) {
+    LOG(WARNING) << Name() << " ran out of memory trying to allocate "
+                 << num_bytes << " bytes with " << stats_.bytes_in_use
+                 << " of " << *stats_.bytes_limit << " bytes in use";
+    return nullptr;
+  }
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUdeviceptr ptr = 0;
+  CUresult res = cuMemAllocAsync(&ptr, num_bytes,
+                                 static_cast<CUstream>(stream_));
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "cuMemAllocAsync failed to allocate " << num_bytes
+               << " bytes: " << GetCudaErrorString(res);
+    return nullptr;
+  }
+  void* rv = reinterpret_cast<void*>(ptr);
+  sizes_[rv] = num_bytes;
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += num_bytes;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64>(stats_.largest_alloc_size, num_bytes);
+  return rv;
+#else
+  return nullptr;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  if (ptr == nullptr) return;
+  mutex_lock l(mu_);
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUresult res = cuMemFreeAsync(reinterpret_cast<CUdeviceptr>(ptr),
+                                static_cast<CUstream>(stream_));
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "cuMemFreeAsync failed to free " << ptr << ": "
+               << GetCudaErrorString(res);
+  }
+  auto it = sizes_.find(ptr);
+  if (it != sizes_.end()) {
+    stats_.bytes_in_use -= it->second;
+    sizes_.erase(it);
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+size_t GpuCudaMallocAsyncAllocator::RequestedSize(const void* ptr) const {
+  mutex_lock l(mu_);
+  auto it = sizes_.find(ptr);
+  CHECK(it != sizes_.end()) << "Asked for the size of unknown pointer " << ptr;
+  return it->second;
+}
+
+absl::optional<AllocatorStats> GpuCudaMallocAsyncAllocator::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+void GpuCudaMallocAsyncAllocator::ClearStats() {
+  mutex_lock l(mu_);
+  stats_.num_allocs = 0;
+  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.largest_alloc_size = 0;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that passes every request to the stream-ordered allocator of
+// CUDA 11.2 (cuMemAllocAsync and cuMemFreeAsync), enabled with
+// GPUOptions.allocator_type = "cuda_malloc_async".
+//
+// Unlike the BFC allocator, the memory pool is owned by the driver. It keeps at
+// most `release_threshold` bytes of freed memory cached, and gives the rest
+// back to the device at the next synchronization, so that several processes
+// can share a GPU without each reserving its peak usage. Allocations and frees
+// are ordered on the compute stream set by SetStream, which is where the
+// kernels of the device run.
+class GpuCudaMallocAsyncAllocator : public Allocator {
+ public:
+  // `pool_size` limits the bytes in use at a time, like the memory limit of
+  // the BFC allocator. A `release_threshold` of 0 keeps `pool_size` bytes
+  // cached.
+  GpuCudaMallocAsyncAllocator(PlatformGpuId platform_gpu_id, size_t pool_size,
+                              size_t release_threshold, const string& name);
+  ~GpuCudaMallocAsyncAllocator() override;
+
+  string Name() override { return name_; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override {
+    return RequestedSize(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override;
+  void ClearStats() override;
+
+  // Orders the allocations and frees on `stream`, a CUstream. Until this is
+  // called, they are ordered on the legacy default stream.
+  void SetStream(void* stream);
+
+  // Returns true if this binary and the driver support stream-ordered
+  // allocation.
+  static bool IsSupported();
+
+ private:
+  se::StreamExecutor* stream_exec_;  // Not owned.
+  const string name_;
+
+  // A CUmemoryPool and a CUstream.
+  void* pool_ = nullptr;
+  void* stream_ = nullptr;
+
+  mutable mutex mu_;
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<const void*, size_t> sizes_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuCudaMallocAsyncAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
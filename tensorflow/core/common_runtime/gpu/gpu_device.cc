@@ -33,8 +33,10 @@ limitations under the License.
 #include <tuple>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -376,6 +379,59 @@ class BaseGPUDevice::StreamGroupFactory {
   TF_DISALLOW_COPY_AND_ASSIGN(StreamGroupFactory);
 };
 
+namespace {
+
+// Wraps the timestamped allocator of a device that runs kernels on several
+// compute streams. A buffer freed by a kernel on one stream may still be in use
+// by pending GPU work when the host frees it, which is only safe to reuse on
+// the same stream. Every allocation therefore only reuses the buffers freed
+// before the safe allocation frontier, before which all the tracked kernels of
+// all streams have completed.
+class StreamSafeAllocator : public AllocatorWrapper {
+ public:
+  // `safe_alloc_frontier` returns the current safe allocation frontier, given
+  // the previously returned one (see BaseGPUDevice::SafeAllocFrontier()).
+  StreamSafeAllocator(Allocator* wrapped,
+                      std::function<uint64(uint64)> safe_alloc_frontier)
+      : AllocatorWrapper(wrapped),
+        safe_alloc_frontier_(std::move(safe_alloc_frontier)) {}
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    if (allocation_attr.freed_by_func != nullptr) {
+      return wrapped()->AllocateRaw(alignment, num_bytes, allocation_attr);
+    }
+    uint64 safe_alloc_frontier = 0;
+    std::function<uint64()> freed_by_func = [this, &safe_alloc_frontier]() {
+      safe_alloc_frontier = safe_alloc_frontier_(safe_alloc_frontier);
+      return safe_alloc_frontier;
+    };
+    AllocationAttributes safe_attr(allocation_attr.retry_on_failure,
+                                   allocation_attr.allocation_will_be_logged,
+                                   &freed_by_func);
+    return wrapped()->AllocateRaw(alignment, num_bytes, safe_attr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped()->GetStats();
+  }
+  void ClearStats() override { wrapped()->ClearStats(); }
+  void SetSafeFrontier(uint64 count) override {
+    wrapped()->SetSafeFrontier(count);
+  }
+
+ private:
+  const std::function<uint64(uint64)> safe_alloc_frontier_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StreamSafeAllocator);
+};
+
+}  // namespace
+
 BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
                              Bytes memory_limit, const DeviceLocality& locality,
                              TfGpuId tf_gpu_id,
@@ -394,16 +450,27 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 }
 
 BaseGPUDevice::~BaseGPUDevice() {
+  if (graph_capture_stream_ != nullptr) {
+    // Wait for the pending replays before destroying their graphs.
+    graph_capture_stream_->BlockHostUntilDone().IgnoreError();
+    gpu_graph_cache_.reset();
+  }
   delete gpu_device_info_;
-  gpu_allocator_->DeallocateRaw(scratch_);
-  device_context_->Unref();
+  for (char* scratch : scratch_) {
+    gpu_allocator_->DeallocateRaw(scratch);
+  }
+  for (GPUDeviceContext* device_context : device_contexts_) {
+    device_context->Unref();
+  }
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
-    DCHECK(stream_);
+  // Each compute stream has its own scratch buffer, because Eigen uses the
+  // semaphore at its end to synchronize the blocks of a reduction.
+  while (scratch_.size() < streams_.size()) {
+    DCHECK(streams_[scratch_.size()]);
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
     void* scratch_buffer = gpu_allocator_->AllocateRaw(
@@ -416,7 +483,7 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    scratch_.push_back(static_cast<char*>(scratch_buffer));
   }
   return Status::OK();
 }
@@ -430,15 +497,62 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   executor_ = executor_status.ValueOrDie();
 
-  stream_ = StreamGroupFactory::Global().GetOrCreate(
-      tf_gpu_id_, 0, executor_, options.config.gpu_options());
-  device_context_ =
-      new GPUDeviceContext(0, stream_->compute,
+  timestamped_allocator_ =
+      options.config.gpu_options().experimental().timestamped_allocator();
+
+  // The stream-ordered allocator frees memory in the order of the compute
+  // stream rather than when the freeing kernels complete, and keeps no
+  // timestamps.
+  GpuCudaMallocAsyncAllocator* async_allocator =
+      dynamic_cast<GpuCudaMallocAsyncAllocator*>(gpu_allocator_);
+  if (async_allocator != nullptr && timestamped_allocator_) {
+    LOG(WARNING) << "Ignoring GPUOptions.experimental.timestamped_allocator "
+                 << "for GPU " << tf_gpu_id_.value()
+                 << " because it uses the cuda_malloc_async allocator.";
+    timestamped_allocator_ = false;
+  }
+
+  // The number of compute streams on which the kernels of this device run.
+  // This option is experimental. With more than one stream, independent
+  // kernels may run concurrently on the GPU, which helps graphs with many
+  // small kernels that each cannot fill the device. Buffers freed by the
+  // kernels of one stream are then only reused once all the kernels queued
+  // before they were freed have completed, which requires
+  // GPUOptions.experimental.timestamped_allocator.
+  int64 num_compute_streams = 1;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_GPU_NUM_COMPUTE_STREAMS",
+                                         /*default_val=*/1,
+                                         &num_compute_streams));
+  if (num_compute_streams < 1) {
+    return errors::InvalidArgument("Invalid TF_GPU_NUM_COMPUTE_STREAMS: ",
+                                   num_compute_streams);
+  }
+  if (num_compute_streams > 1 && !timestamped_allocator_) {
+    LOG(WARNING) << "Ignoring TF_GPU_NUM_COMPUTE_STREAMS="
+                 << num_compute_streams << " for GPU " << tf_gpu_id_.value()
+                 << " because GPUOptions.experimental.timestamped_allocator "
+                 << "is not set.";
+    num_compute_streams = 1;
+  }
+
+  for (int i = 0; i < num_compute_streams; ++i) {
+    StreamGroup* group = StreamGroupFactory::Global().GetOrCreate(
+        tf_gpu_id_, i, executor_, options.config.gpu_options());
+    streams_.push_back(group);
+    device_contexts_.push_back(
+        new GPUDeviceContext(i, group->compute,
 #if TENSORFLOW_USE_ROCM
-                           stream_->nccl,
+                             group->nccl,
 #endif
-                           stream_->host_to_device, stream_->device_to_host,
-                           stream_->device_to_device);
+                             group->host_to_device, group->device_to_host,
+                             group->device_to_device));
+  }
+  stream_ = streams_[0];
+  device_context_ = device_contexts_[0];
+  if (async_allocator != nullptr) {
+    async_allocator->SetStream(
+        stream_->compute->implementation()->GpuStreamMemberHack());
+  }
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
@@ -447,8 +561,12 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
       options.config.gpu_options().experimental().kernel_tracker_max_bytes(),
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
-  timestamped_allocator_ =
-      options.config.gpu_options().experimental().timestamped_allocator();
+  if (streams_.size() > 1) {
+    // Kernels on different streams complete out of order, so the safe
+    // allocation frontier is only correct if every kernel is tracked.
+    tracker_params.max_interval = 0;
+    tracker_params.max_bytes = 0;
+  }
   pending_cap_ = tracker_params.max_pending;
   if (timestamped_allocator_ ||
       (tracker_params.max_interval > 0 || tracker_params.max_bytes > 0 ||
@@ -467,6 +585,12 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         tracker_params, Env::Default(), stream_->compute, timing_counter,
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
+  if (streams_.size() > 1) {
+    stream_safe_allocator_ = absl::make_unique<StreamSafeAllocator>(
+        gpu_allocator_,
+        [this](uint64 old_value) { return SafeAllocFrontier(old_value); });
+    gpu_allocator_ = stream_safe_allocator_.get();
+  }
 
   gpu_device_info_ = new GpuDeviceInfo;
   gpu_device_info_->stream = stream_->compute;
@@ -478,6 +602,25 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   gpu_device_info_->gpu_id = platform_gpu_id.value();
   set_tensorflow_gpu_device_info(gpu_device_info_);
 
+  // Whether the GPU work of repeated executions may be captured into graphs
+  // and replayed with a single launch (see GpuGraphCache). The captured work
+  // runs on a dedicated stream, because any work that other threads enqueue
+  // onto a stream while it is capturing would be captured as well.
+  bool enable_graph_capture = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_GPU_ENABLE_GRAPH_CAPTURE",
+                                        /*default_val=*/false,
+                                        &enable_graph_capture));
+  if (enable_graph_capture) {
+    graph_capture_stream_ = absl::make_unique<se::Stream>(executor_);
+    graph_capture_stream_->Init();
+    if (!graph_capture_stream_->ok()) {
+      return errors::Internal("Failed to create the graph capture stream of ",
+                              "GPU ", tf_gpu_id_.value());
+    }
+    gpu_graph_cache_ =
+        absl::make_unique<GpuGraphCache>(graph_capture_stream_.get());
+  }
+
   // Whether and how the GPU device uses its own threadpool.
   // This option is experimental. Once we confirm the best setting, we
   // may change the default behavior and completely remove this flag.
@@ -548,6 +691,9 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   }
   se::Stream* stream = gpu_device_context->stream();
   const auto stream_id = gpu_device_context->stream_id();
+  for (se::Stream* producer_stream : gpu_device_context->wait_for_streams()) {
+    stream->ThenWaitFor(producer_stream);
+  }
 
   const bool vlog_1 = VLOG_IS_ON(1);
 
@@ -617,11 +763,102 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   VLOG(1) << "GpuDevice::ComputeAsync " << op_kernel->name() << " op "
           << op_kernel->type_string() << " on GPU" << tf_gpu_id_ << " stream["
           << stream_id << "]";
+  for (se::Stream* producer_stream : gpu_device_context->wait_for_streams()) {
+    stream->ThenWaitFor(producer_stream);
+  }
+
+  if (kernel_tracker_ && streams_.size() > 1) {
+    // Track the work of asynchronous kernels too, which Compute() does not
+    // see, so that the kernels of the other streams do not reuse their inputs
+    // while the work is pending. The inputs are freed after `done`.
+    GPUKernelTracker* tracker = kernel_tracker_.get();
+    EventMgr* em = em_;
+    done = [tracker, em, stream, context, done = std::move(done)]() {
+      uint64 queued_count = tracker->MaybeQueue(context);
+      if (queued_count > 0) {
+        em->ThenExecute(stream, [tracker, queued_count]() {
+          tracker->RecordTerminated(queued_count);
+        });
+      }
+      done();
+    };
+  }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
+Status BaseGPUDevice::FillContextMap(const Graph* graph,
+                                     DeviceContextMap* device_context_map) {
+  if (streams_.size() <= 1) return Status::OK();
+  const int num_streams = streams_.size();
+
+  // Assign the nodes to streams in topological order, so that the producers
+  // of a node are assigned before it (except along back edges). The first
+  // consumer of a node that has not yet been continued continues its chain.
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  std::vector<int> node_stream(graph->num_node_ids(), -1);
+  std::vector<bool> chain_continued(graph->num_node_ids(), false);
+  int next_stream = 0;
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    int stream = -1;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      const int src_id = e->src()->id();
+      if (node_stream[src_id] >= 0 && !chain_continued[src_id]) {
+        stream = node_stream[src_id];
+        chain_continued[src_id] = true;
+        break;
+      }
+    }
+    if (stream < 0) {
+      stream = next_stream;
+      next_stream = (next_stream + 1) % num_streams;
+    }
+    node_stream[n->id()] = stream;
+  }
+
+  // Give the nodes with producers on other streams a context of their own,
+  // which makes their stream wait for those streams. The waits only order the
+  // kernels of the streams on the GPU, since the executor already runs the
+  // producers before the node.
+  device_context_map->resize(graph->num_node_ids(), nullptr);
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    const int stream = node_stream[n->id()];
+    gtl::InlinedVector<se::Stream*, 4> wait_for_streams;
+    for (const Edge* e : n->in_edges()) {
+      const int src_stream = node_stream[e->src()->id()];
+      if (src_stream < 0 || src_stream == stream) continue;
+      se::Stream* producer_stream = streams_[src_stream]->compute;
+      if (std::find(wait_for_streams.begin(), wait_for_streams.end(),
+                    producer_stream) == wait_for_streams.end()) {
+        wait_for_streams.push_back(producer_stream);
+      }
+    }
+    GPUDeviceContext* device_context = device_contexts_[stream];
+    if (wait_for_streams.empty()) {
+      device_context->Ref();
+    } else {
+      const StreamGroup* group = streams_[stream];
+      device_context =
+          new GPUDeviceContext(stream, group->compute,
+#if TENSORFLOW_USE_ROCM
+                               group->nccl,
+#endif
+                               group->host_to_device, group->device_to_host,
+                               group->device_to_device);
+      device_context->set_wait_for_streams(std::move(wait_for_streams));
+    }
+    (*device_context_map)[n->id()] = device_context;
+    VLOG(2) << "Assigned node " << n->name() << " to stream[" << stream
+            << "] of GPU " << tf_gpu_id_.value();
+  }
+  return Status::OK();
+}
+
 Status BaseGPUDevice::MaybeCopyTensorToGPU(
     const AllocatorAttributes& alloc_attrs, const Tensor& from, Tensor* to,
     StatusCallback done) {
@@ -991,11 +1228,12 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_GE(stream_id, 0);
+  DCHECK_LT(stream_id, static_cast<int>(streams_.size()));
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      streams_[stream_id]->compute->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_gpu_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1012,7 +1250,7 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
+    CHECK_LT(stream_id, static_cast<int>(streams_.size()));
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
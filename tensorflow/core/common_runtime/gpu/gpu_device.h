@@ -28,6 +28,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
@@ -69,6 +70,14 @@ class BaseGPUDevice : public LocalDevice {
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
+  // Spreads the nodes of `graph` over the compute streams of this device, if
+  // it has more than one (see TF_GPU_NUM_COMPUTE_STREAMS in Init()). Chains of
+  // nodes stay on the stream of their first producer, while the other
+  // consumers of a node start chains on the next stream in turn. A node whose
+  // producers run on other streams waits for those streams before it runs.
+  Status FillContextMap(const Graph* graph,
+                        DeviceContextMap* device_context_map) override;
+
   Status MakeTensorFromProto(const TensorProto& tensor_proto,
                              const AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
@@ -116,6 +125,11 @@ class BaseGPUDevice : public LocalDevice {
 
   int priority() const { return stream_->priority; }
 
+  // Returns the cache of captured GPU work of this device, or nullptr unless
+  // GPU graph capture has been enabled by setting the environment variable
+  // TF_GPU_ENABLE_GRAPH_CAPTURE to true.
+  GpuGraphCache* gpu_graph_cache() const { return gpu_graph_cache_.get(); }
+
   // Helper method for unit tests to reset the streams. Never use in production.
   static void TestOnlyReset();
 
@@ -140,10 +154,20 @@ class BaseGPUDevice : public LocalDevice {
   };
   class StreamGroupFactory;
 
+  // The stream groups of the compute streams of this device, and their
+  // contexts. `stream_` and `device_context_` are those of the first one, which
+  // runs every kernel that has not been given another context.
   StreamGroup* stream_;
+  std::vector<StreamGroup*> streams_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // The scratch buffer used by Eigen on each compute stream.
+  std::vector<char*> scratch_;
   GPUDeviceContext* device_context_;
+  std::vector<GPUDeviceContext*> device_contexts_;
+  // If there are several compute streams, wraps the allocator of the device so
+  // that buffers freed by kernels on one stream are not reused by kernels on
+  // another stream before the first have completed.
+  std::unique_ptr<Allocator> stream_safe_allocator_;
   GpuDeviceInfo* gpu_device_info_ = nullptr;
   mutex trace_mu_;
   TfGpuId tf_gpu_id_;
@@ -153,6 +177,9 @@ class BaseGPUDevice : public LocalDevice {
   std::unique_ptr<GPUKernelTracker> kernel_tracker_;
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
+  // The stream used by `gpu_graph_cache_`, which must outlive it.
+  std::unique_ptr<se::Stream> graph_capture_stream_;
+  std::unique_ptr<GpuGraphCache> gpu_graph_cache_;
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -477,6 +479,51 @@ TEST_F(GPUDeviceTest, DeviceDetails) {
   }
 }
 
+TEST_F(GPUDeviceTest, MultipleComputeStreams) {
+  setenv("TF_GPU_NUM_COMPUTE_STREAMS", "2", /*overwrite=*/1);
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_timestamped_allocator(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  unsetenv("TF_GPU_NUM_COMPUTE_STREAMS");
+  Device* device = devices[0].get();
+
+  // Two independent chains, joined by `add`.
+  Graph graph(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 1.0;
+  Node* a = test::graph::Constant(&graph, value);
+  Node* b = test::graph::Identity(&graph, a);
+  Node* c = test::graph::Constant(&graph, value);
+  Node* d = test::graph::Identity(&graph, c);
+  Node* add = test::graph::Binary(&graph, "Add", b, d);
+
+  DeviceContextMap device_context_map;
+  TF_ASSERT_OK(device->FillContextMap(&graph, &device_context_map));
+  ASSERT_EQ(device_context_map.size(), graph.num_node_ids());
+  auto stream_id = [&device_context_map](const Node* n) {
+    return static_cast<GPUDeviceContext*>(device_context_map[n->id()])
+        ->stream_id();
+  };
+  auto wait_for_streams = [&device_context_map](const Node* n) {
+    return static_cast<GPUDeviceContext*>(device_context_map[n->id()])
+        ->wait_for_streams()
+        .size();
+  };
+  EXPECT_EQ(stream_id(a), stream_id(b));
+  EXPECT_EQ(stream_id(c), stream_id(d));
+  EXPECT_NE(stream_id(b), stream_id(d));
+  EXPECT_EQ(wait_for_streams(b), 0);
+  EXPECT_EQ(wait_for_streams(d), 0);
+  EXPECT_EQ(wait_for_streams(add), 1);
+  for (DeviceContext* device_context : device_context_map) {
+    if (device_context != nullptr) device_context->Unref();
+  }
+}
+
 class GPUKernelTrackerTest : public ::testing::Test {
  protected:
   void Init(const GPUKernelTracker::Params& params) {
@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -96,11 +98,21 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
                                       : 10),
       threadpool_(Env::Default(), "GPU_Event_Manager", kNumThreads) {
   gpu_event_mgr::InitThreadpoolLabels(&threadpool_);
+  // Host callbacks report completions without the polling delay, but each
+  // one costs a driver thread hop, so they are not the default.
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+                                 /*default_val=*/false, &use_host_callbacks_));
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -165,6 +177,47 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::FreeMemory(const ToFreeVector& to_free) {
+  std::vector<std::function<void()>> funcs;
+  for (const auto& iu : to_free) {
+    if (iu.func != nullptr) funcs.push_back(iu.func);
+  }
+  if (funcs.empty()) return;
+  // The functions must be called in another thread. Running all the functions
+  // whose events completed in the same poll in one closure costs a single
+  // thread hop, and keeps them in the order of their events.
+  const uint64 completed_micros = Env::Default()->NowMicros();
+  threadpool_.Schedule([completed_micros, funcs = std::move(funcs)]() {
+    metrics::RecordGpuEventMgrDispatch(
+        funcs.size(), Env::Default()->NowMicros() - completed_micros);
+    for (const auto& func : funcs) {
+      func();
+    }
+  });
+}
+
+void EventMgr::QueueHostCallback(se::Stream* stream,
+                                 std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++num_pending_host_callbacks_;
+  }
+  // The host callback runs on a thread of the driver, which must neither block
+  // nor call back into the driver, so it only hands `func` to the threadpool.
+  stream->ThenDoHostCallback([this, func = std::move(func)]() {
+    const uint64 completed_micros = Env::Default()->NowMicros();
+    threadpool_.Schedule([completed_micros, func]() {
+      metrics::RecordGpuEventMgrDispatch(
+          1, Env::Default()->NowMicros() - completed_micros);
+      func();
+    });
+    mutex_lock l(mu_);
+    if (--num_pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  });
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -68,6 +68,10 @@ class EventMgr {
   // func must be brief and non-blocking since it executes in the one
   // thread used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      QueueHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -83,8 +87,17 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // Whether ThenExecute() learns of the completion of the work of a stream
+  // from a host callback enqueued on the stream, rather than from an event
+  // polled by PollLoop(). Set by the environment variable
+  // TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS.
+  bool use_host_callbacks_ = false;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
+  // The number of host callbacks enqueued by QueueHostCallback() that have not
+  // yet run, which the destructor waits for.
+  int64 num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(mu_);
 
   struct InUse {
     se::Event* event;
@@ -95,12 +108,14 @@ class EventMgr {
 
   EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options);
 
-  void FreeMemory(const ToFreeVector& to_free) {
-    for (const auto& iu : to_free) {
-      // The function must be called in another thread.
-      if (iu.func != nullptr) threadpool_.Schedule(iu.func);
-    }
-  }
+  // Runs the functions of `to_free` on the threadpool, in order and in a
+  // single closure.
+  void FreeMemory(const ToFreeVector& to_free);
+
+  // Enqueues on `stream` a host callback that hands `func` to the threadpool,
+  // so that it runs as soon as the driver reports that the work of the stream
+  // has completed, without waiting for the next poll.
+  void QueueHostCallback(se::Stream* stream, std::function<void()> func);
 
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -138,6 +139,53 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that the functions whose events complete in the same poll run in the
+// order in which they were queued.
+TEST(EventMgr, ThenExecuteInOrder) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  constexpr int kNumFuncs = 10;
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter counter(kNumFuncs);
+  for (int i = 0; i < kNumFuncs; ++i) {
+    em.ThenExecute(stream.get(), [i, &mu, &order, &counter]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(i);
+      }
+      counter.DecrementCount();
+    });
+  }
+  th.PollEvents();
+  counter.Wait();
+  mutex_lock l(mu);
+  for (int i = 0; i < kNumFuncs; ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+}
+
+// Tests that host callbacks run the functions without queueing events.
+TEST(EventMgr, HostCallbacks) {
+  setenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS", "true", /*overwrite=*/1);
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  unsetenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS");
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  Notification note;
+  em.ThenExecute(stream.get(), [&note]() { note.Notify(); });
+  EXPECT_EQ(0, th.queue_size());
+  note.WaitForNotification();
+  EXPECT_EQ(0, th.free_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
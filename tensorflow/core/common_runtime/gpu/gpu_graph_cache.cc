@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/stream_executor/gpu/gpu_graph.h"
+
+namespace tensorflow {
+
+GpuGraphCache::GpuGraphCache(se::Stream* stream) : stream_(stream) {}
+
+GpuGraphCache::~GpuGraphCache() {}
+
+Status GpuGraphCache::Run(const string& key, const string& signature,
+                          se::Stream* compute_stream,
+                          const EnqueueFn& enqueue) {
+  mutex_lock l(mu_);
+  Entry& entry = entries_[key];
+  if (entry.signature != signature) {
+    if (entry.graph != nullptr || entry.uncapturable) {
+      ++stats_.num_invalidations;
+    }
+    entry.graph.reset();
+    entry.uncapturable = false;
+    entry.signature = signature;
+  }
+
+  stream_->ThenWaitFor(compute_stream);
+  Status s;
+  if (entry.graph != nullptr) {
+    ++stats_.num_replays;
+    s = entry.graph->Launch(stream_);
+  } else if (entry.uncapturable) {
+    ++stats_.num_uncaptured_runs;
+    s = enqueue(stream_);
+  } else {
+    s = CaptureLocked(key, enqueue, &entry);
+  }
+  compute_stream->ThenWaitFor(stream_);
+  return s;
+}
+
+Status GpuGraphCache::CaptureLocked(const string& key,
+                                    const EnqueueFn& enqueue, Entry* entry) {
+  Status s = se::gpu::GpuGraph::BeginCapture(stream_);
+  if (s.ok()) {
+    const Status enqueue_status = enqueue(stream_);
+    auto graph = se::gpu::GpuGraph::EndCapture(stream_);
+    // None of the captured work has been executed, so there is nothing to
+    // clean up. The next run of `key` tries to capture it again.
+    TF_RETURN_IF_ERROR(enqueue_status);
+    if (graph.ok()) {
+      ++stats_.num_captures;
+      entry->graph = std::move(graph).ValueOrDie();
+      return entry->graph->Launch(stream_);
+    }
+    s = graph.status();
+  }
+  VLOG(1) << "Could not capture the GPU work of " << key
+          << ", executing it directly: " << s;
+  entry->uncapturable = true;
+  ++stats_.num_uncaptured_runs;
+  return enqueue(stream_);
+}
+
+void GpuGraphCache::Erase(const string& key) {
+  mutex_lock l(mu_);
+  entries_.erase(key);
+}
+
+GpuGraphCache::Stats GpuGraphCache::GetStats() const {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,120 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace stream_executor {
+class Stream;
+namespace gpu {
+class GpuGraph;
+}  // namespace gpu
+}  // namespace stream_executor
+
+namespace tensorflow {
+
+// Caches the GPU work enqueued by a piece of host code as executable graphs
+// (see `se::gpu::GpuGraph`), so that later executions of the same work are
+// replayed with a single launch instead of launching each kernel again. This
+// mostly helps work made of many tiny kernels, whose launch overhead dominates
+// their execution time.
+//
+// The work is identified by a `key` (e.g. the name of a graph partition) and a
+// `signature` (e.g. the shapes of its inputs). The cache holds at most one
+// graph per key: running a key with a new signature invalidates its graph,
+// and captures a new one.
+//
+// A replay reads and writes exactly the device memory that was used while
+// capturing. It is up to the caller to make sure that the enqueued work uses
+// the same buffers every time it runs with the same key and signature, and
+// that those buffers stay allocated for as long as the graph may be replayed
+// (i.e. until `Erase()` or the destruction of the cache).
+//
+// All of the work runs on a dedicated stream, which nothing outside the cache
+// may use, because any work that other threads enqueue onto a stream while it
+// is capturing would be captured as well.
+//
+// Thread-safe. Runs are serialized.
+class GpuGraphCache {
+ public:
+  // Enqueues the work to cache onto the given stream. May be called more than
+  // once for the same run (e.g. to execute it directly if it turns out that it
+  // cannot be captured), so it must not have side effects other than the work
+  // that it enqueues.
+  typedef std::function<Status(se::Stream*)> EnqueueFn;
+
+  struct Stats {
+    int64 num_captures = 0;
+    int64 num_replays = 0;
+    int64 num_invalidations = 0;
+    // Number of runs that could not be captured, and were executed directly.
+    int64 num_uncaptured_runs = 0;
+  };
+
+  // `stream` must outlive the cache.
+  explicit GpuGraphCache(se::Stream* stream);
+  ~GpuGraphCache();
+
+  // Runs the work of `enqueue` for `key` and `signature`, replaying its cached
+  // graph if there is one, and capturing it otherwise. The work is ordered
+  // after all of the work enqueued onto `compute_stream` so far, and all of
+  // the work enqueued onto `compute_stream` afterwards is ordered after it.
+  //
+  // If the work cannot be captured (e.g. because it synchronizes with the
+  // host), it is executed directly, and so are all later runs of `key` with
+  // the same signature.
+  Status Run(const string& key, const string& signature,
+             se::Stream* compute_stream, const EnqueueFn& enqueue);
+
+  // Drops the graph of `key`, if any.
+  void Erase(const string& key);
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    string signature;
+    // The captured work of `signature`, if it has been captured.
+    std::unique_ptr<se::gpu::GpuGraph> graph;
+    // True if the work of `signature` cannot be captured.
+    bool uncapturable = false;
+  };
+
+  // Captures the work of `enqueue` into `entry`, and launches it.
+  Status CaptureLocked(const string& key, const EnqueueFn& enqueue,
+                       Entry* entry) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  se::Stream* const stream_;  // not owned
+
+  mutable mutex mu_;
+  absl::flat_hash_map<string, Entry> entries_ TF_GUARDED_BY(mu_);
+  Stats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuGraphCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
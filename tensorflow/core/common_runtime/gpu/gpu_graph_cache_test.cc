@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class GpuGraphCacheTest : public ::testing::Test {
+ protected:
+  GpuGraphCacheTest()
+      : executor_(GPUMachineManager()->ExecutorForDevice(0).ValueOrDie()),
+        compute_stream_(executor_),
+        capture_stream_(executor_) {
+    compute_stream_.Init();
+    capture_stream_.Init();
+    buffer_ = executor_->AllocateArray<uint32>(kNumElements);
+  }
+
+  ~GpuGraphCacheTest() override { executor_->Deallocate(&buffer_); }
+
+  // Returns a function that fills the buffer with `value`, and counts how
+  // often it is called.
+  GpuGraphCache::EnqueueFn Fill(uint32 value) {
+    return [this, value](se::Stream* stream) {
+      ++num_enqueues_;
+      stream->ThenMemset32(&buffer_, value, kNumElements * sizeof(uint32));
+      return Status::OK();
+    };
+  }
+
+  // Overwrites the buffer with zeros, runs `key`, and returns the first
+  // element of the buffer.
+  uint32 RunAndRead(GpuGraphCache* cache, const string& key,
+                    const string& signature, uint32 value) {
+    compute_stream_.ThenMemZero(&buffer_, kNumElements * sizeof(uint32));
+    TF_EXPECT_OK(cache->Run(key, signature, &compute_stream_, Fill(value)));
+    uint32 result = 0;
+    compute_stream_.ThenMemcpy(&result, buffer_, sizeof(result));
+    TF_EXPECT_OK(compute_stream_.BlockHostUntilDone());
+    return result;
+  }
+
+  static constexpr int kNumElements = 1024;
+
+  se::StreamExecutor* executor_;
+  se::Stream compute_stream_;
+  se::Stream capture_stream_;
+  se::DeviceMemory<uint32> buffer_;
+  int num_enqueues_ = 0;
+};
+
+TEST_F(GpuGraphCacheTest, ReplaysCapturedWork) {
+  GpuGraphCache cache(&capture_stream_);
+  EXPECT_EQ(42, RunAndRead(&cache, "fill", "s", 42));
+  EXPECT_EQ(1, num_enqueues_);
+  // The replays execute the captured work, without enqueuing it again.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(42, RunAndRead(&cache, "fill", "s", 42));
+  }
+  EXPECT_EQ(1, num_enqueues_);
+
+  GpuGraphCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1, stats.num_captures);
+  EXPECT_EQ(3, stats.num_replays);
+  EXPECT_EQ(0, stats.num_invalidations);
+  EXPECT_EQ(0, stats.num_uncaptured_runs);
+}
+
+TEST_F(GpuGraphCacheTest, NewSignatureInvalidatesGraph) {
+  GpuGraphCache cache(&capture_stream_);
+  EXPECT_EQ(1, RunAndRead(&cache, "fill", "s1", 1));
+  EXPECT_EQ(2, RunAndRead(&cache, "fill", "s2", 2));
+  EXPECT_EQ(2, RunAndRead(&cache, "fill", "s2", 2));
+  // Other keys have their own graphs.
+  EXPECT_EQ(3, RunAndRead(&cache, "other", "s1", 3));
+  EXPECT_EQ(3, num_enqueues_);
+
+  GpuGraphCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(3, stats.num_captures);
+  EXPECT_EQ(1, stats.num_replays);
+  EXPECT_EQ(1, stats.num_invalidations);
+
+  cache.Erase("fill");
+  EXPECT_EQ(4, RunAndRead(&cache, "fill", "s2", 4));
+  EXPECT_EQ(4, num_enqueues_);
+}
+
+TEST_F(GpuGraphCacheTest, EnqueueErrorIsReturned) {
+  GpuGraphCache cache(&capture_stream_);
+  EXPECT_FALSE(cache
+                   .Run("fail", "s", &compute_stream_,
+                        [](se::Stream* stream) {
+                          return errors::Internal("enqueue failed");
+                        })
+                   .ok());
+  TF_EXPECT_OK(compute_stream_.BlockHostUntilDone());
+  // The stream is usable again, and the next run captures the work.
+  EXPECT_EQ(5, RunAndRead(&cache, "fail", "s", 5));
+  EXPECT_EQ(1, cache.GetStats().num_captures);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
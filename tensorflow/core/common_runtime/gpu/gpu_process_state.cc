@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamalloc_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_debug_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_host_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
@@ -53,6 +54,13 @@ bool useCudaMemoryGuardAllocator() {
          std::strcmp(debug_allocator_str, "memory_guard") == 0;
 }
 
+bool useCudaMallocAsyncAllocator(const string& allocator_type) {
+  if (allocator_type == "cuda_malloc_async") return true;
+  const char* allocator_str = std::getenv("TF_GPU_ALLOCATOR");
+  return allocator_str != nullptr &&
+         std::strcmp(allocator_str, "cuda_malloc_async") == 0;
+}
+
 }  // namespace
 
 /*static*/ GPUProcessState* GPUProcessState::singleton(GPUProcessState* ps) {
@@ -93,7 +101,8 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
   AllocatorParts& allocator_parts = gpu_allocators_[tf_gpu_id.value()];
   if (allocator_parts.allocator == nullptr) {
     // Validate allocator types.
-    if (!allocator_type.empty() && allocator_type != "BFC") {
+    if (!allocator_type.empty() && allocator_type != "BFC" &&
+        allocator_type != "cuda_malloc_async") {
       LOG(ERROR) << "Invalid allocator type: " << allocator_type;
       return nullptr;
     }
@@ -105,20 +114,39 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
     while (bus_id >= gpu_visitors_.size()) {
       gpu_visitors_.push_back({});
     }
-    GPUMemAllocator* sub_allocator = new GPUMemAllocator(
-        GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
-        platform_gpu_id,
-        (options.per_process_gpu_memory_fraction() > 1.0 ||
-         options.experimental().use_unified_memory()),
-        gpu_visitors_[bus_id], {});
-    GPUBFCAllocator* gpu_bfc_allocator =
-        new GPUBFCAllocator(sub_allocator, total_bytes, options,
-                            strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
-    Allocator* gpu_allocator = gpu_bfc_allocator;
+    GPUMemAllocator* sub_allocator = nullptr;
+    GPUBFCAllocator* gpu_bfc_allocator = nullptr;
+    Allocator* gpu_allocator = nullptr;
     SharedCounter* timing_counter = nullptr;
-    if (options.experimental().timestamped_allocator()) {
-      timing_counter = new SharedCounter;
-      gpu_bfc_allocator->SetTimingCounter(timing_counter);
+    if (useCudaMallocAsyncAllocator(allocator_type)) {
+      // The driver owns the memory pool, and gives the memory cached above
+      // the release threshold back to the device, for other processes to use.
+      LOG(INFO) << "Using CUDA stream-ordered allocator for GPU.";
+      int64 release_threshold_in_mb = 0;
+      Status status =
+          ReadInt64FromEnvVar("TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD_IN_MB",
+                              0, &release_threshold_in_mb);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetGPUAllocator: " << status.error_message();
+      }
+      gpu_allocator = new GpuCudaMallocAsyncAllocator(
+          platform_gpu_id, total_bytes, release_threshold_in_mb * (1LL << 20),
+          strings::StrCat("GPU_", tf_gpu_id.value(), "_cuda_malloc_async"));
+    } else {
+      sub_allocator = new GPUMemAllocator(
+          GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+          platform_gpu_id,
+          (options.per_process_gpu_memory_fraction() > 1.0 ||
+           options.experimental().use_unified_memory()),
+          gpu_visitors_[bus_id], {});
+      gpu_bfc_allocator = new GPUBFCAllocator(
+          sub_allocator, total_bytes, options,
+          strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
+      gpu_allocator = gpu_bfc_allocator;
+      if (options.experimental().timestamped_allocator()) {
+        timing_counter = new SharedCounter;
+        gpu_bfc_allocator->SetTimingCounter(timing_counter);
+      }
     }
 
     // If true, checks for memory overwrites by writing
@@ -176,6 +204,10 @@ SharedCounter* GPUProcessState::GPUAllocatorCounter(TfGpuId tf_gpu_id) {
   }
 
   AllocatorParts& allocator_parts = gpu_allocators_[tf_gpu_id.value()];
+  if (allocator_parts.bfc_allocator == nullptr) {
+    // Only the BFC allocator keeps timestamps of freed chunks.
+    return nullptr;
+  }
   if (allocator_parts.counter.get() == nullptr) {
     SharedCounter* timing_counter = new SharedCounter;
     allocator_parts.bfc_allocator->SetTimingCounter(timing_counter);
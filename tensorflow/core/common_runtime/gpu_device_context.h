@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -59,6 +61,16 @@ class GPUDeviceContext : public DeviceContext {
   }
   int stream_id() const { return stream_id_; }
 
+  // The compute streams of other contexts that the work of a kernel run with
+  // this context must wait for, because they run the kernels that produce its
+  // inputs. Empty unless the device runs kernels on several compute streams.
+  const gtl::InlinedVector<se::Stream*, 4>& wait_for_streams() const {
+    return wait_for_streams_;
+  }
+  void set_wait_for_streams(gtl::InlinedVector<se::Stream*, 4> streams) {
+    wait_for_streams_ = std::move(streams);
+  }
+
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor, StatusCallback done,
                              bool sync_dst_compute) const override;
@@ -92,6 +104,8 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  // The streams that kernels run with this context must wait for.
+  gtl::InlinedVector<se::Stream*, 4> wait_for_streams_;
 };
 
 }  // namespace tensorflow
@@ -44,8 +44,11 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -66,6 +69,10 @@ inline bool IsNextIteration(const NodeDef& node_def) {
          node_def.op() == "RefNextIteration";
 }
 
+// Graphs with fewer nodes are converted in a single thread, since starting
+// the threads would cost more than it saves.
+constexpr int kMinNodesToPrepareInParallel = 4096;
+
 bool IsValidNodeName(StringPiece s, bool allow_internal_ops) {
   using ::tensorflow::strings::Scanner;
   Scanner scanner(s);
@@ -208,6 +215,10 @@ class GraphConstructor {
   Status ValidateInputMapAndControlDependencies();
   Status BuildNodeIndex();
   Status InitFromEdges();
+  // Looks up the ops, adds the default attrs, validates and infers the types
+  // of all the NodeDefs in parallel, ahead of Convert(), when that does not
+  // depend on the nodes converted before.
+  void PrepareNodes();
   Status Convert();
   Status AddBackEdges();
   Status UpdateVersionDef();
@@ -225,7 +236,17 @@ class GraphConstructor {
            absl::flat_hash_set<int>* unvisited);
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(NodeDef&& node_def, Node** node);
+  // The result of PrepareNodes() for one NodeDef.
+  struct PreparedNode {
+    NodeDef node_def;
+    const OpRegistrationData* op_reg_data = nullptr;
+    DataTypeVector inputs;
+    DataTypeVector outputs;
+    Status status;
+  };
+  Status PrepareNode(PreparedNode* prepared) const;
+  // `prepared` is nullptr if PrepareNodes() did not run.
+  Status MakeNode(NodeDef&& node_def, PreparedNode* prepared, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -289,6 +310,13 @@ class GraphConstructor {
   // available.
   virtual const FunctionDefLibrary* library() const = 0;
 
+  // Returns the i^th node in the graph, which must not have been converted
+  // yet.
+  const NodeDef& unconverted_node_def(int i) const {
+    return prepared_nodes_.empty() ? get_node_def(i)
+                                   : prepared_nodes_[i].node_def;
+  }
+
   // From constructor
   const Options opts_;
   Graph* g_;
@@ -389,6 +417,10 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // Indexed like node_defs_, empty if PrepareNodes() did not run. The
+  // NodeDefs are consumed into it by PrepareNodes().
+  std::vector<PreparedNode> prepared_nodes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphConstructor);
 };
 
@@ -771,11 +803,58 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
+Status GraphConstructor::PrepareNode(PreparedNode* prepared) const {
+  NodeDef& node_def = prepared->node_def;
+  TF_RETURN_IF_ERROR(
+      g_->op_registry()->LookUp(node_def.op(), &prepared->op_reg_data));
+  const OpDef& op_def = prepared->op_reg_data->op_def;
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(op_def, &node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, op_def));
+  }
+  Status status = InOutTypesForNode(node_def, op_def, &prepared->inputs,
+                                    &prepared->outputs);
+  if (!status.ok()) return AttachDef(status, node_def);
+  return Status::OK();
+}
+
+void GraphConstructor::PrepareNodes() {
+  // When importing, the NodeDefs are rewritten according to the names of the
+  // nodes converted before them.
+  if (opts_.importing || node_def_count() < kMinNodesToPrepareInParallel) {
+    return;
+  }
+  const int num_threads = port::MaxParallelism();
+  if (num_threads <= 1) return;
+
+  prepared_nodes_.resize(node_def_count());
+  for (int i = 0; i < prepared_nodes_.size(); ++i) {
+    prepared_nodes_[i].node_def = consume_node_def(i);
+  }
+  thread::ThreadPool pool(Env::Default(), "graph_constructor", num_threads);
+  pool.ParallelFor(prepared_nodes_.size(), /*cost_per_unit=*/10000,
+                   [this](int64 start, int64 limit) {
+                     for (int64 i = start; i < limit; ++i) {
+                       PreparedNode* prepared = &prepared_nodes_[i];
+                       prepared->status = PrepareNode(prepared);
+                     }
+                   });
+}
+
+Status GraphConstructor::MakeNode(NodeDef&& node_def, PreparedNode* prepared,
+                                  Node** node) {
   // Add the node to the graph.
-  Status status;
-  *node = g_->AddNode(std::move(node_def), &status);
-  if (!status.ok()) return status;
+  if (prepared != nullptr) {
+    *node = g_->AddNode(std::move(node_def), *prepared->op_reg_data,
+                        std::move(prepared->inputs),
+                        std::move(prepared->outputs));
+  } else {
+    Status status;
+    *node = g_->AddNode(std::move(node_def), &status);
+    if (!status.ok()) return status;
+  }
   if (opts_.expect_device_spec) {
     (*node)->set_assigned_device_name((*node)->def().device());
   }
@@ -1070,7 +1149,7 @@ void GraphConstructor::DFS(int cur_node, std::vector<int>* cur_branch,
             std::find(cur_branch->begin(), cur_branch->end(), next_node);
         LOG(WARNING) << "Cycle detected:";
         while (iter != cur_branch->end()) {
-          LOG(WARNING) << SummarizeNodeDef(get_node_def(*iter));
+          LOG(WARNING) << SummarizeNodeDef(unconverted_node_def(*iter));
           ++iter;
         }
         LOG(WARNING) << "End of cycle";
@@ -1112,6 +1191,8 @@ Status GraphConstructor::Convert() {
     // avoid unnecessarily copying `*library()` here.
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
+  PrepareNodes();
+  PreparedNode* prepared = nullptr;
 
   std::vector<InputInfo> inputs;
   int processed = 0;
@@ -1129,7 +1210,9 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    if (!prepared_nodes_.empty()) prepared = &prepared_nodes_[o];
+    NodeDef node_def = prepared == nullptr ? consume_node_def(o)
+                                           : std::move(prepared->node_def);
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1230,6 +1313,8 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (prepared != nullptr) {
+      TF_RETURN_IF_ERROR(prepared->status);
     } else {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
@@ -1242,7 +1327,7 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), prepared, &node));
 
     if (opts_.importing) {
       // Use interned original node name so StringPiece remains valid.
@@ -1286,7 +1371,7 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64 i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(unconverted_node_def(i))
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -1545,29 +1630,6 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
   }
 }
 
-void CopyGraph(const Graph& src, Graph* dest) {
-  for (Node* n : dest->nodes()) {
-    CHECK(n->IsSource() || n->IsSink()) << "*dest must be empty";
-  }
-
-  // Copy GraphDef versions
-  dest->set_versions(src.versions());
-
-  // Copy the nodes.
-  // "Node in src" -> "Node in *dest"
-  gtl::FlatMap<const Node*, Node*> node_map;
-  node_map[src.source_node()] = dest->source_node();
-  node_map[src.sink_node()] = dest->sink_node();
-  for (Node* n : src.op_nodes()) {
-    node_map[n] = dest->CopyNode(n);
-  }
-
-  // Copy the edges
-  for (const Edge* e : src.edges()) {
-    Node* src_copy = node_map[e->src()];
-    Node* dst_copy = node_map[e->dst()];
-    dest->AddEdge(src_copy, e->src_output(), dst_copy, e->dst_input());
-  }
-}
+void CopyGraph(const Graph& src, Graph* dest) { dest->Copy(src); }
 
 }  // namespace tensorflow
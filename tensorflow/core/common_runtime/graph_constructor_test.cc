@@ -822,6 +822,57 @@ TEST_F(GraphConstructorTest, TypeMismatch) {
        "expected int32."});
 }
 
+// Returns a chain of `num_nodes` TestOneInputOneOutput nodes n0, n1, ...,
+// large enough for the NodeDefs to be prepared in parallel.
+string LargeChainGraph(int num_nodes) {
+  string gdef_ascii = "node { name: 'input' op: 'TestInput' }";
+  for (int i = 0; i < num_nodes; ++i) {
+    strings::StrAppend(&gdef_ascii, "node { name: 'n", i,
+                       "' op: 'TestOneInputOneOutput' input: [ '",
+                       i == 0 ? "input" : strings::StrCat("n", i - 1),
+                       "' ] attr { key: 'T' value { type: DT_FLOAT } } }");
+  }
+  strings::StrAppend(&gdef_ascii, "node { name: 'default' op: ",
+                     "'TestDefaultAttr' input: [ '^n", num_nodes - 1, "' ] }");
+  return gdef_ascii;
+}
+
+TEST_F(GraphConstructorTest, LargeGraph) {
+  const int kNumNodes = 5000;
+  ExpectOK(LargeChainGraph(kNumNodes));
+  EXPECT_TRUE(HasEdge("input", 0, "n0", 0));
+  EXPECT_TRUE(HasEdge("n2000", 0, "n2001", 0));
+  EXPECT_TRUE(HasControlEdge(strings::StrCat("n", kNumNodes - 1), "default"));
+  int64 default_int = 0;
+  TF_EXPECT_OK(
+      GetNodeAttr(FindNode("default")->attrs(), "default_int", &default_int));
+  EXPECT_EQ(31415, default_int);
+}
+
+TEST_F(GraphConstructorTest, LargeGraphWithInvalidNode) {
+  string gdef_ascii = LargeChainGraph(5000);
+  strings::StrAppend(&gdef_ascii,
+                     "node { name: 'int' op: 'TestInt' input: [ 'n42' ] }");
+  ExpectError(gdef_ascii,
+              {"Input 0 of node int was passed float from n42:0 incompatible "
+               "with expected int32."});
+}
+
+TEST_F(GraphConstructorTest, LargeGraphWithUnknownOp) {
+  string gdef_ascii = LargeChainGraph(5000);
+  strings::StrAppend(
+      &gdef_ascii, "node { name: 'unknown' op: 'UnknownOp' input: [ 'n7' ] }");
+  ExpectError(gdef_ascii, {"Op type not registered 'UnknownOp'"});
+}
+
+TEST_F(GraphConstructorTest, LargeGraphWithCycle) {
+  string gdef_ascii = LargeChainGraph(5000);
+  strings::StrAppend(&gdef_ascii,
+                     "node { name: 'a' op: 'TestMul' input: [ 'n0', 'b' ] }"
+                     "node { name: 'b' op: 'TestMul' input: [ 'n0', 'a' ] }");
+  ExpectError(gdef_ascii, {"2 nodes in a cycle"});
+}
+
 TEST_F(GraphConstructorTest, EmptyGraph) {
   ExpectOK("");
   ExpectVersions(0, 0);
@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -644,6 +645,50 @@ Status GraphExecutionState::OptimizeGraph(
     item.id = "tf_graph";
     graph_->ToGraphDef(&item.graph);
 
+    // The optimizers treat the shapes of fed tensors as unknown. When the
+    // graph is specialized for the shapes of its feeds, route the feeds
+    // through EnsureShape nodes, so that the optimizers can rely on fully
+    // defined shapes downstream while the exact shapes are still checked at
+    // run time.
+    if (!options.feed_shapes.empty()) {
+      std::unordered_map<string, string> specialized_feeds;
+      std::unordered_set<string> node_names;
+      for (const NodeDef& node : item.graph.node()) {
+        node_names.insert(node.name());
+      }
+      const int num_nodes = item.graph.node_size();
+      for (int i = 0; i < num_nodes; ++i) {
+        const NodeDef& node = item.graph.node(i);
+        auto it = options.feed_shapes.find(node.name());
+        if (it == options.feed_shapes.end() || node.op() != "Placeholder") {
+          continue;
+        }
+        const string name = strings::StrCat(node.name(), "/specialized_shape");
+        if (!node_names.insert(name).second) continue;
+        // Copy the feed, since adding a node invalidates references to the
+        // existing ones.
+        const NodeDef feed = node;
+        NodeDef* ensure_shape = item.graph.add_node();
+        ensure_shape->set_name(name);
+        ensure_shape->set_op("EnsureShape");
+        ensure_shape->set_device(feed.device());
+        ensure_shape->add_input(feed.name());
+        (*ensure_shape->mutable_attr())["T"] = feed.attr().at("dtype");
+        it->second.AsProto(
+            (*ensure_shape->mutable_attr())["shape"].mutable_shape());
+        specialized_feeds.emplace(feed.name(), name);
+      }
+      for (int i = 0; i < num_nodes; ++i) {
+        NodeDef* node = item.graph.mutable_node(i);
+        for (string& input : *node->mutable_input()) {
+          const TensorId id = ParseTensorName(input);
+          if (id.index() != 0) continue;
+          auto it = specialized_feeds.find(string(id.node()));
+          if (it != specialized_feeds.end()) input = it->second;
+        }
+      }
+    }
+
     // It's ok to skip invalid device annotations in Grappler.
     for (const Device* d : device_set_->devices()) {
       Status added_device = item.AddDevice(d->name());
@@ -710,6 +755,10 @@ Status GraphExecutionState::OptimizeGraph(
         DataType type;
         Status st = GetFeedShapeAndTypeFromAttribute(node->def(),
                                                      &partial_shape, &type);
+        auto feed_shape = options.feed_shapes.find(node->name());
+        if (st.ok() && feed_shape != options.feed_shapes.end()) {
+          partial_shape = PartialTensorShape(feed_shape->second.dim_sizes());
+        }
 
         // Failed to get type and shape of the feed node.
         if (!st.ok()) {
@@ -76,6 +76,9 @@ struct NodeItem {
   bool is_recv_or_switch : 1;     // True iff IsRecv(node) || IsSwitch(node)
   bool is_next_iteration : 1;     // True iff IsNextIteration(node)
   bool is_noop : 1;  // True iff item->kernel->type_string_view() == "NoOp")
+  bool is_identity : 1;  // True iff the kernel is a CPU or GPU "Identity"
+                         // with a non-ref input, which only forwards its
+                         // input to its output.
   bool
       is_any_consumer_merge_or_control_trigger : 1;  // True iff the destination
                                                      // of any output edge is a
@@ -83,6 +86,8 @@ struct NodeItem {
                                                      // node.
   bool is_any_input_ref_typed : 1;  // True iff any IsRefType(dt) for dt in this
                                     // node's input types.
+  bool outputs_step_local : 1;      // True iff no buffer allocated by this
+                                    // node is expected to outlive the step.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -0,0 +1,397 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_torus_reducer.h"
+
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Key of the buffer holding chunk `chunk_idx` that device `src_idx` sends in
+// step `step` of phase `phase`.
+string TorusBufKey(const string& exec_key, int phase, int step, int chunk_idx,
+                   int src_idx) {
+  return strings::StrCat("TorusReduce(", exec_key, "):", phase, ":", step, ":",
+                         chunk_idx, ":", src_idx);
+}
+
+int Mod(int x, int k) { return ((x % k) + k) % k; }
+
+}  // namespace
+
+Status HierarchicalTorusReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalTorusReducer does not support ",
+                            "collective type ", col_params->instance.type);
+  }
+  if (col_params->instance.impl_details.collective_name !=
+      "HierarchicalTorusReduce") {
+    return errors::Internal(
+        "Unexpected collective name ",
+        col_params->instance.impl_details.collective_name,
+        " for HierarchicalTorusReducer");
+  }
+  return Status::OK();
+}
+
+Status HierarchicalTorusReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+/* static */
+HierarchicalTorusReducer::Topology HierarchicalTorusReducer::ComputeTopology(
+    const CollectiveParams& col_params) {
+  const std::vector<string>& task_names = col_params.instance.task_names;
+  const int group_size = col_params.group.group_size;
+  Topology topology;
+  int num_tasks = group_size;
+  // Use the task structure only if every task has the same number of
+  // adjacent devices.
+  int devices_per_task = 1;
+  while (devices_per_task < group_size &&
+         task_names[devices_per_task] == task_names[0]) {
+    ++devices_per_task;
+  }
+  bool uniform = group_size % devices_per_task == 0;
+  for (int i = devices_per_task; uniform && i < group_size; ++i) {
+    if (i % devices_per_task == 0) {
+      // The first device of a task.
+      uniform = task_names[i] != task_names[i - 1];
+    } else {
+      uniform = task_names[i] == task_names[i - 1];
+    }
+  }
+  if (uniform) {
+    topology.devices_per_task = devices_per_task;
+    num_tasks = group_size / devices_per_task;
+  }
+  // Make the grid as square as possible.
+  int rows = 1;
+  for (int r = 1; r * r <= num_tasks; ++r) {
+    if (num_tasks % r == 0) rows = r;
+  }
+  topology.rows = rows;
+  topology.cols = num_tasks / rows;
+  return topology;
+}
+
+void HierarchicalTorusReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  topology_ = ComputeTopology(*col_params_);
+  const int local_size = topology_.devices_per_task;
+  const int rows = topology_.rows;
+  const int cols = topology_.cols;
+  const int rank = col_params_->default_rank;
+  const int local = rank % local_size;
+  const int task = rank / local_size;
+  const int row = task / cols;
+  const int col = task % cols;
+  VLOG(1) << "HierarchicalTorusReducer::Run for device "
+          << col_ctx_->device_name << " rank " << rank << " local " << local
+          << " of " << local_size << " grid position (" << row << ", " << col
+          << ") of (" << rows << ", " << cols << ")";
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output,
+                                  local_size * cols * rows,
+                                  col_ctx_->device->GetAllocator(attr)));
+
+  if (col_params_->final_op) {
+    // Create an on-device scalar value from the group size for the final op.
+    Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+    if (col_params_->group.device_type != "CPU") {
+      uint64 safe_alloc_frontier = col_ctx_->device->SafeAllocFrontier(0);
+      AllocationAttributes aa;
+      std::function<uint64()> freed_by_func = [this, &safe_alloc_frontier]() {
+        safe_alloc_frontier =
+            col_ctx_->device->SafeAllocFrontier(safe_alloc_frontier);
+        return safe_alloc_frontier;
+      };
+      if (safe_alloc_frontier > 0) {
+        aa.freed_by_func = &freed_by_func;
+      }
+      group_size_tensor_ = ca_->Scalar(
+          col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+          aa);
+      DeviceContext* op_dev_ctx = col_ctx_->op_ctx->op_device_context();
+      op_dev_ctx->CopyCPUTensorToDevice(
+          &group_size_val, col_ctx_->device, &group_size_tensor_,
+          [this](const Status& s) {
+            if (!s.ok()) {
+              StartAbort(s);
+            }
+            group_size_tensor_ready_.Notify();
+          },
+          (safe_alloc_frontier == 0));
+    } else {
+      group_size_tensor_ = group_size_val;
+      group_size_tensor_ready_.Notify();
+    }
+  } else {
+    group_size_tensor_ready_.Notify();
+  }
+
+  const Ring local_ring = MakeRing(1, 0, local, col, row);
+  const Ring row_ring = MakeRing(2, 1, local, col, row);
+  const Ring col_ring = MakeRing(3, 2, local, col, row);
+  bool ok = RunRing(local_ring, /*reduce=*/true) &&
+            RunRing(row_ring, /*reduce=*/true) &&
+            RunRing(col_ring, /*reduce=*/true);
+  if (ok && col_params_->final_op) {
+    // After the reduce-scatters each chunk is held by exactly one device.
+    ok = Finalize(col_ring.blocks[col_ring.my_member][0]);
+  }
+  ok = ok && RunRing(col_ring, /*reduce=*/false) &&
+       RunRing(row_ring, /*reduce=*/false) &&
+       RunRing(local_ring, /*reduce=*/false);
+
+  group_size_tensor_ready_.WaitForNotification();
+  if (ok) {
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  ca_.reset();
+  Status s;
+  {
+    mutex_lock l(status_mu_);
+    s = status_;
+  }
+  done(s);
+}
+
+HierarchicalTorusReducer::Ring HierarchicalTorusReducer::MakeRing(
+    int phase, int dim, int local, int col, int row) const {
+  const int local_size = topology_.devices_per_task;
+  const int rows = topology_.rows;
+  const int cols = topology_.cols;
+  auto device_index = [&](int l, int c, int r) {
+    return (r * cols + c) * local_size + l;
+  };
+  auto chunk_index = [&](int l, int c, int r) {
+    return (l * cols + c) * rows + r;
+  };
+  Ring ring;
+  ring.phase = phase;
+  switch (dim) {
+    case 0:
+      ring.my_member = local;
+      for (int l = 0; l < local_size; ++l) {
+        ring.members.push_back(device_index(l, col, row));
+        ring.blocks.emplace_back();
+        for (int c = 0; c < cols; ++c) {
+          for (int r = 0; r < rows; ++r) {
+            ring.blocks.back().push_back(chunk_index(l, c, r));
+          }
+        }
+      }
+      break;
+    case 1:
+      ring.my_member = col;
+      for (int c = 0; c < cols; ++c) {
+        ring.members.push_back(device_index(local, c, row));
+        ring.blocks.emplace_back();
+        for (int r = 0; r < rows; ++r) {
+          ring.blocks.back().push_back(chunk_index(local, c, r));
+        }
+      }
+      break;
+    default:
+      ring.my_member = row;
+      for (int r = 0; r < rows; ++r) {
+        ring.members.push_back(device_index(local, col, r));
+        ring.blocks.push_back({chunk_index(local, col, r)});
+      }
+      break;
+  }
+  return ring;
+}
+
+bool HierarchicalTorusReducer::RunRing(const Ring& ring, bool reduce) {
+  const int k = ring.members.size();
+  const int p = ring.my_member;
+  // A reduce-scatter leaves member p with block p, which an all-gather then
+  // passes around the ring.
+  for (int step = 0; step < k - 1; ++step) {
+    const int send_block = reduce ? Mod(p - step - 1, k) : Mod(p - step, k);
+    const int recv_block =
+        reduce ? Mod(p - step - 2, k) : Mod(p - step - 1, k);
+    if (!RingStep(ring, reduce ? step : k + step, send_block, recv_block,
+                  reduce)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HierarchicalTorusReducer::RingStep(const Ring& ring, int step,
+                                        int send_block, int recv_block,
+                                        bool reduce) {
+  const int k = ring.members.size();
+  const int self = ring.members[ring.my_member];
+  const int next = ring.members[(ring.my_member + 1) % k];
+  const int prev = ring.members[(ring.my_member + k - 1) % k];
+  std::vector<int> send_chunks;
+  std::vector<int> recv_chunks;
+  for (int i : ring.blocks[send_block]) {
+    if (ca_->ChunkBytes(i) > 0) send_chunks.push_back(i);
+  }
+  for (int i : ring.blocks[recv_block]) {
+    if (ca_->ChunkBytes(i) > 0) recv_chunks.push_back(i);
+  }
+  // The aliases must outlive the transfers.
+  std::vector<Tensor> send_tensors;
+  std::vector<Tensor> recv_tensors;
+  std::vector<Tensor> tmp_tensors;
+  for (int i : send_chunks) send_tensors.push_back(ca_->ChunkAlias(i));
+  for (int i : recv_chunks) {
+    recv_tensors.push_back(ca_->ChunkAlias(i));
+    if (reduce) tmp_tensors.push_back(ca_->TempChunk(i));
+  }
+
+  mutex mu;
+  Status status;
+  BlockingCounter counter(send_chunks.size() + recv_chunks.size());
+  auto on_done = [&mu, &status, &counter](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    counter.DecrementCount();
+  };
+  const string& exec_key = col_ctx_->exec_key;
+  const auto& device_names = col_params_->instance.device_names;
+  const auto& task_names = col_params_->instance.task_names;
+  for (size_t j = 0; j < send_chunks.size(); ++j) {
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        device_names[next], task_names[next],
+        TorusBufKey(exec_key, ring.phase, step, send_chunks[j], self),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &send_tensors[j],
+        col_ctx_->device_locality, on_done);
+  }
+  for (size_t j = 0; j < recv_chunks.size(); ++j) {
+    Tensor* dst = reduce ? &tmp_tensors[j] : &recv_tensors[j];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        device_names[prev], task_names[prev], col_params_->task.is_local[prev],
+        TorusBufKey(exec_key, ring.phase, step, recv_chunks[j], prev),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), dst, col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/, on_done);
+  }
+  counter.Wait();
+  if (!status.ok()) {
+    StartAbort(status);
+    return false;
+  }
+  if (reduce) {
+    for (size_t j = 0; j < recv_chunks.size(); ++j) {
+      Status s = collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op.get(), &recv_tensors[j], &tmp_tensors[j]);
+      if (!s.ok()) {
+        StartAbort(s);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool HierarchicalTorusReducer::Finalize(int chunk_idx) {
+  group_size_tensor_ready_.WaitForNotification();
+  {
+    mutex_lock l(status_mu_);
+    if (!status_.ok()) return false;
+  }
+  if (ca_->ChunkBytes(chunk_idx) == 0) return true;
+  Tensor chunk = ca_->ChunkAlias(chunk_idx);
+  Status s = collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op.get(), &chunk, &group_size_tensor_);
+  if (!s.ok()) {
+    StartAbort(s);
+    return false;
+  }
+  return true;
+}
+
+void HierarchicalTorusReducer::StartAbort(const Status& s) {
+  bool abort_started = false;
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      LOG(ERROR) << "Aborting HierarchicalTorusReduce with " << s;
+      abort_started = true;
+      status_.Update(s);
+    }
+  }
+  // Cancels the outstanding transfers of every device in the group.
+  if (abort_started) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalTorusReduce, HierarchicalTorusReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_TORUS_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_TORUS_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+class Device;
+
+// Hierarchical 2D-torus implementation of collective all-reduce.
+//
+// The devices of each task form a local ring, and the tasks are arranged in
+// an R x C grid whose rows and columns form rings across tasks.  The tensor
+// is split into L * C * R chunks for L devices per task, and reduced in
+// phases:
+//  1. A reduce-scatter over the local ring, after which local device l holds
+//     segment l (C * R chunks) reduced over the task.
+//  2. A reduce-scatter of segment l over the row ring, after which the
+//     device holds R chunks reduced over its row.
+//  3. A reduce-scatter over the column ring, after which the device holds
+//     one chunk reduced over the whole group, followed by an all-gather over
+//     the column ring.
+//  4. All-gathers over the row ring and then the local ring.
+// Each ring has at most max(L, C, R) members, so the number of sequential
+// steps grows with L + C + R rather than with the group size.
+//
+// If the tasks do not all have the same number of devices, every device is
+// treated as its own task.
+class HierarchicalTorusReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalTorusReducer() = default;
+  ~HierarchicalTorusReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // No-op for hierarchical torus reducer.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Runs the all-reduce.  Blocks until it completes, so it must be called in
+  // a blockable thread.
+  void Run(StatusCallback done) override;
+
+  // The layout of the group.  Device `i` of the group is local device
+  // `i % devices_per_task` of task `i / devices_per_task`, and task `t` is at
+  // row `t / cols` and column `t % cols` of the grid.
+  struct Topology {
+    int devices_per_task = 1;
+    int rows = 1;
+    int cols = 1;
+  };
+
+  // Returns the layout for `col_params`, whose devices must be sorted so that
+  // the devices of a task are adjacent.
+  static Topology ComputeTopology(const CollectiveParams& col_params);
+
+ private:
+  // A ring of devices that take part in one phase.  `members[m]` is the group
+  // index of member `m`, and `blocks[b]` holds the chunk indices that member
+  // `b` owns after a reduce-scatter over the ring.
+  struct Ring {
+    int phase = 0;
+    int my_member = 0;
+    std::vector<int> members;
+    std::vector<std::vector<int>> blocks;
+  };
+
+  // Returns the ring of the devices that differ from this device only in the
+  // coordinate `dim` (0 for local, 1 for column, 2 for row).
+  Ring MakeRing(int phase, int dim, int local, int col, int row) const;
+
+  // Runs a ring reduce-scatter, or an all-gather if `reduce` is false.
+  // Returns false if it failed.
+  bool RunRing(const Ring& ring, bool reduce);
+
+  // Sends the chunks of `send_block` to the next member of `ring` and
+  // receives the chunks of `recv_block` from the previous member, merging
+  // them into the output if `reduce` is true.
+  bool RingStep(const Ring& ring, int step, int send_block, int recv_block,
+                bool reduce);
+
+  // Applies the final op to chunk `chunk_idx`.
+  bool Finalize(int chunk_idx);
+
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Topology topology_;
+  Tensor group_size_tensor_;
+  Notification group_size_tensor_ready_;
+
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_TORUS_REDUCER_H_
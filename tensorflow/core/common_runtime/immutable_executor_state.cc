@@ -16,14 +16,17 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/recycling_allocator.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -40,6 +43,16 @@ ImmutableExecutorState::~ImmutableExecutorState() {
       params_.delete_kernel(item->kernel);
     }
   }
+  for (DeviceContext* device_context : device_context_map_) {
+    if (device_context != nullptr) device_context->Unref();
+  }
+  for (const auto& allocators : recycling_output_allocators_) {
+    for (Allocator* allocator : allocators) {
+      if (allocator != nullptr) {
+        static_cast<RecyclingAllocator*>(allocator)->Unref();
+      }
+    }
+  }
 }
 
 namespace {
@@ -154,6 +167,11 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
     item->const_tensor = const_tensor;
     item->is_noop = (item->kernel->type_string_view() == "NoOp");
+    const string& device_type = params_.device->device_type();
+    item->is_identity =
+        item->kernel->type_string_view() == "Identity" &&
+        !item->is_any_input_ref_typed &&
+        (device_type == DEVICE_CPU || device_type == DEVICE_GPU);
     item->is_enter = IsEnter(n);
     if (item->is_enter) {
       bool is_constant_enter;
@@ -254,9 +272,15 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  MarkStepLocalNodes(graph);
+  FindRetvalOutputs(graph);
+  MaybeCreateRecyclingOutputAllocators(graph);
+
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map_));
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -344,6 +368,207 @@ Status ImmutableExecutorState::BuildControlFlowInfo(const Graph* g,
   return Status::OK();
 }
 
+Status ImmutableExecutorState::BuildFrozenPlan() {
+  if (requires_control_flow_) {
+    return errors::FailedPrecondition(
+        "Cannot build a frozen plan for a graph that requires control flow "
+        "support.");
+  }
+  TF_RETURN_IF_ERROR(CheckNoBlockingKernelsForFrozenPlan());
+
+  // Count the number of incoming edges of each node. We derive the counts from
+  // the `NodeItem` edges (rather than the `Graph`) because those are exactly
+  // the edges along which `PropagateOutputs()` delivers values.
+  const int32 num_nodes = gview_.num_nodes();
+  std::vector<int32> num_pending(num_nodes, 0);
+  int32 num_items = 0;
+  for (int32 id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item == nullptr || item->kernel == nullptr) continue;
+    ++num_items;
+    for (const EdgeInfo& e : item->output_edges()) {
+      ++num_pending[e.dst_id];
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      ++num_pending[e.dst_id];
+    }
+  }
+
+  // Linearize the graph with a depth-first variant of Kahn's algorithm. Using
+  // a stack instead of a queue tends to run a consumer right after its
+  // producer, which keeps the intermediate tensors hot in cache and shortens
+  // their lifetimes.
+  std::vector<const NodeItem*> plan;
+  plan.reserve(num_items);
+  std::vector<const NodeItem*> stack(root_nodes_.rbegin(), root_nodes_.rend());
+  while (!stack.empty()) {
+    const NodeItem* item = stack.back();
+    stack.pop_back();
+    plan.push_back(item);
+    auto maybe_push = [this, &num_pending, &stack](int32 dst_id) {
+      if (--num_pending[dst_id] == 0) stack.push_back(gview_.node(dst_id));
+    };
+    for (const EdgeInfo& e : item->output_edges()) {
+      maybe_push(e.dst_id);
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      maybe_push(e.dst_id);
+    }
+  }
+
+  if (plan.size() != static_cast<size_t>(num_items)) {
+    return errors::FailedPrecondition(
+        "Cannot build a frozen plan because only ", plan.size(), " of ",
+        num_items, " nodes are reachable in topological order.");
+  }
+
+  frozen_plan_ = std::move(plan);
+  frozen_plan_positions_.reset(new int32[num_nodes]);
+  std::fill(frozen_plan_positions_.get(),
+            frozen_plan_positions_.get() + num_nodes, -1);
+  for (int32 i = 0, end = frozen_plan_.size(); i < end; ++i) {
+    frozen_plan_positions_[frozen_plan_[i]->node_id] = i;
+  }
+  return Status::OK();
+}
+
+Status ImmutableExecutorState::CheckNoBlockingKernelsForFrozenPlan() const {
+  // The nodes of a frozen plan run one at a time, so a node that waits for
+  // another node of the same step would never complete if the plan placed it
+  // first, e.g. a queue dequeue before its enqueue. Such waits go through
+  // asynchronous kernels, so the only ones we accept are the receives of
+  // tensors that no node of this graph sends.
+  const int32 num_nodes = gview_.num_nodes();
+  gtl::FlatSet<string> sent_tensors;
+  for (int32 id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item == nullptr || item->kernel == nullptr) continue;
+    if (item->is_transfer_node && !item->is_recv_or_switch) {
+      string tensor_name;
+      TF_RETURN_IF_ERROR(
+          GetNodeAttr(item->kernel->def(), "tensor_name", &tensor_name));
+      sent_tensors.insert(std::move(tensor_name));
+    }
+  }
+  for (int32 id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item == nullptr || item->kernel == nullptr ||
+        !item->kernel_is_async) {
+      continue;
+    }
+    if (item->is_transfer_node && item->is_recv_or_switch) {
+      string tensor_name;
+      TF_RETURN_IF_ERROR(
+          GetNodeAttr(item->kernel->def(), "tensor_name", &tensor_name));
+      if (sent_tensors.count(tensor_name) == 0) continue;
+    }
+    return errors::FailedPrecondition(
+        "Cannot build a frozen plan because node ", item->kernel->name(),
+        " may wait for another node of the graph.");
+  }
+  return Status::OK();
+}
+
+namespace {
+// Returns true if `node` is expected to pass its input buffers through to its
+// outputs, either by aliasing them or by capturing them in a variant.
+bool ForwardsInputBuffers(const Node* node) {
+  if (IsIdentity(node)) return true;
+  for (int i = 0; i < node->num_outputs(); ++i) {
+    if (node->output_type(i) == DT_VARIANT) return true;
+  }
+  return false;
+}
+}  // namespace
+
+void ImmutableExecutorState::MarkStepLocalNodes(const Graph& graph) {
+  // NOTE: Step arenas are only reclaimed at the end of a step, so we do not use
+  // them for graphs with loops, where the amount of memory allocated in a step
+  // is not bounded by the size of the graph.
+  if (requires_control_flow_) return;
+
+  // Visit the consumers of each node before the node itself, so that escapes
+  // can be propagated backwards through the nodes that forward their inputs.
+  //
+  // The analysis only has to be right in the common case: a buffer that
+  // unexpectedly outlives the step (e.g. because a kernel forwarded its input
+  // to a fetched output) keeps its arena chunk alive until it is deallocated.
+  std::vector<Node*> order;
+  GetPostOrder(graph, &order);
+  std::vector<bool> escapes(graph.num_node_ids(), false);
+  for (const Node* n : order) {
+    if (n->IsSource() || n->IsSink()) continue;
+    // Stateful nodes may store their outputs (or their inputs) in resources
+    // that outlive the step. This also covers `_Retval` and `_Send`, whose
+    // inputs are handed off to the caller or to another device.
+    bool node_escapes = n->op_def().is_stateful() || n->IsFunctionCall();
+    for (int i = 0; !node_escapes && i < n->num_outputs(); ++i) {
+      node_escapes = IsRefType(n->output_type(i));
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (node_escapes) break;
+      const Node* dst = e->dst();
+      if (e->IsControlEdge() || IsSink(dst)) continue;
+      node_escapes = dst->op_def().is_stateful() || dst->IsFunctionCall() ||
+                     (escapes[dst->id()] && ForwardsInputBuffers(dst));
+    }
+    escapes[n->id()] = node_escapes;
+
+    NodeItem* item = gview_.node(n->id());
+    item->outputs_step_local = !node_escapes;
+    has_step_local_nodes_ |= !node_escapes;
+  }
+}
+
+void ImmutableExecutorState::FindRetvalOutputs(const Graph& graph) {
+  // The buffers of the caller are host memory.
+  if (params_.device->device_type() != DEVICE_CPU) return;
+  for (const Node* n : graph.op_nodes()) {
+    if (!n->IsRetval()) continue;
+    int32 index;
+    if (!GetNodeAttr(n->attrs(), "index", &index).ok()) continue;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      const Node* src = e->src();
+      // `_Arg` and `Const` nodes do not allocate their outputs.
+      if (src->IsArg() || src->IsConstant() ||
+          IsRefType(src->output_type(e->src_output()))) {
+        continue;
+      }
+      retval_outputs_.push_back({src->id(), e->src_output(), index});
+    }
+  }
+}
+
+void ImmutableExecutorState::MaybeCreateRecyclingOutputAllocators(
+    const Graph& graph) {
+  bool recycle_output_buffers = false;
+  Status s = ReadBoolFromEnvVar("TF_EXECUTOR_RECYCLE_OUTPUT_BUFFERS",
+                                /*default_val=*/false, &recycle_output_buffers);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+  // Device allocators other than the CPU allocator may need to know which
+  // stream uses a buffer before reusing it, so only host buffers are recycled.
+  if (!recycle_output_buffers ||
+      params_.device->device_type() != DEVICE_CPU) {
+    return;
+  }
+  Allocator* base_allocator =
+      params_.device->GetAllocator(AllocatorAttributes());
+  recycling_output_allocators_.resize(gview_.num_nodes());
+  for (const Node* n : graph.op_nodes()) {
+    // `_Arg` and `Const` nodes do not allocate their outputs.
+    if (n->IsArg() || n->IsConstant()) continue;
+    auto& allocators = recycling_output_allocators_[n->id()];
+    allocators.resize(n->num_outputs(), nullptr);
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      if (IsRefType(n->output_type(i))) continue;
+      allocators[i] = new RecyclingAllocator(base_allocator);
+    }
+  }
+}
+
 void ImmutableExecutorState::InitializePending(const Graph* graph,
                                                const ControlFlowInfo& cf_info) {
   for (auto& it : cf_info.unique_frame_names) {
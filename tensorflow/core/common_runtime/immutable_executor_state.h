@@ -21,13 +21,16 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -44,6 +47,7 @@ class ImmutableExecutorState {
   struct FrameInfo {
     explicit FrameInfo(string name)
         : name(std::move(name)),
+          name_hash(Hash64(this->name)),
           input_count(0),
           total_inputs(0),
           pending_counts(nullptr),
@@ -53,6 +57,10 @@ class ImmutableExecutorState {
     // The name of the frame.
     string name;
 
+    // Hash64(name), combined into the ids of the frame's instances so that
+    // creating one does not hash the name.
+    const uint64 name_hash;
+
     // The total number of inputs to a frame.
     int input_count;
 
@@ -101,6 +109,75 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Precomputes a "frozen plan": a linearized, topologically sorted schedule
+  // of every node in the graph, which `FrozenPlanPropagatorState` walks in
+  // order on each step instead of maintaining pending counts.
+  //
+  // Returns an error if the graph cannot be linearized, for example because
+  // it requires control flow support, or if it has asynchronous kernels which
+  // may wait for other nodes of the graph.
+  //
+  // REQUIRES: `Initialize()` has returned OK.
+  Status BuildFrozenPlan();
+
+  // Returns true if `BuildFrozenPlan()` has completed successfully.
+  bool has_frozen_plan() const { return frozen_plan_positions_ != nullptr; }
+
+  // The nodes of the graph in the order in which they will be run when using
+  // the frozen plan.
+  //
+  // REQUIRES: `has_frozen_plan()`.
+  const std::vector<const NodeItem*>& frozen_plan() const {
+    DCHECK(has_frozen_plan());
+    return frozen_plan_;
+  }
+
+  // Returns the position of `node_item` in `frozen_plan()`.
+  //
+  // REQUIRES: `has_frozen_plan()`.
+  int32 frozen_plan_position(const NodeItem& node_item) const {
+    DCHECK(has_frozen_plan());
+    return frozen_plan_positions_[node_item.node_id];
+  }
+
+  // Returns the device context that `node_item` should run with, or nullptr
+  // if it should run with the context of the executor. See
+  // `Device::FillContextMap()`.
+  DeviceContext* node_device_context(const NodeItem& node_item) const {
+    return device_context_map_.empty() ? nullptr
+                                       : device_context_map_[node_item.node_id];
+  }
+
+  // Returns true if the outputs of at least one node in the graph were found
+  // not to outlive the step (see `NodeItem::outputs_step_local`).
+  bool has_step_local_nodes() const { return has_step_local_nodes_; }
+
+  // An output of a node that is returned as-is by a `_Retval` node.
+  struct RetvalOutput {
+    int32 node_id;
+    int32 output;
+    int32 retval_index;
+  };
+
+  // Returns the outputs that are returned as-is by the `_Retval` nodes of the
+  // graph, which the caller may ask to allocate itself (see
+  // `CallFrameInterface::GetRetvalAllocator()`). Always empty unless the graph
+  // runs on a CPU device.
+  const std::vector<RetvalOutput>& retval_outputs() const {
+    return retval_outputs_;
+  }
+
+  // Returns an array of `node_item.num_outputs` allocators that recycle the
+  // output buffers of `node_item` across steps (see `RecyclingAllocator`), in
+  // the form expected by `OpKernelContext::Params::output_allocators`, or
+  // nullptr if the output buffers of the graph are not recycled.
+  Allocator* const* recycling_output_allocators(
+      const NodeItem& node_item) const {
+    return recycling_output_allocators_.empty()
+               ? nullptr
+               : recycling_output_allocators_[node_item.node_id].data();
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -126,6 +203,21 @@ class ImmutableExecutorState {
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
 
+  // Sets `NodeItem::outputs_step_local` for every node in `graph`, based on a
+  // conservative escape analysis of the buffers that each node allocates.
+  void MarkStepLocalNodes(const Graph& graph);
+
+  // Fills in `retval_outputs_`.
+  void FindRetvalOutputs(const Graph& graph);
+
+  // Returns an error if a node of the graph may wait for another one, which
+  // `BuildFrozenPlan()` could schedule after it.
+  Status CheckNoBlockingKernelsForFrozenPlan() const;
+
+  // Fills in `recycling_output_allocators_` if the
+  // TF_EXECUTOR_RECYCLE_OUTPUT_BUFFERS environment variable is set.
+  void MaybeCreateRecyclingOutputAllocators(const Graph& graph);
+
   FrameInfo* EnsureFrameInfo(const string& fname);
 
   // Owned.
@@ -155,6 +247,26 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // If `BuildFrozenPlan()` has been called, the linearized schedule of the
+  // graph, and the position of each node in that schedule (indexed by node ID).
+  std::vector<const NodeItem*> frozen_plan_;
+  std::unique_ptr<int32[]> frozen_plan_positions_;
+
+  // True iff `outputs_step_local` is set for at least one node.
+  bool has_step_local_nodes_ = false;
+
+  std::vector<RetvalOutput> retval_outputs_;
+
+  // The allocators that recycle the output buffers of each node, indexed by
+  // node ID and by output number. Empty if output buffers are not recycled.
+  // Holds one reference on each non-null `RecyclingAllocator`.
+  std::vector<gtl::InlinedVector<Allocator*, 4>> recycling_output_allocators_;
+
+  // The device contexts of the nodes that do not run with the context of the
+  // executor, indexed by node ID. Empty if there are no such nodes. Holds one
+  // reference on each non-null entry.
+  DeviceContextMap device_context_map_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableExecutorState);
 };
 
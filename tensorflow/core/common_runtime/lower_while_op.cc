@@ -15,11 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/lower_while_op.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/function_body.h"
+#include "tensorflow/core/common_runtime/function_def_utils.h"
 #include "tensorflow/core/common_runtime/inline_function_utils.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_def_util.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 
@@ -500,6 +506,118 @@ bool LowerWhileHelper::IsResource(int index) {
   return while_op_->input_type(index) == DT_RESOURCE;
 }
 
+// Returns the node producing the value that `n` forwards through Identity
+// nodes.
+const Node* SkipIdentities(const Node* n) {
+  while (n->IsIdentity()) {
+    const Edge* e;
+    if (!n->input_edge(0, &e).ok()) break;
+    n = e->src();
+  }
+  return n;
+}
+
+const Node* InputNode(const Node* n, int index) {
+  const Edge* e;
+  if (!n->input_edge(index, &e).ok()) return nullptr;
+  return SkipIdentities(e->src());
+}
+
+// Returns true if `n` depends on no function argument.
+bool IsConstantValue(const Node* n, int depth = 0) {
+  if (n->IsConstant()) return true;
+  if (n->IsArg() || n->num_inputs() == 0 || depth > 8) return false;
+  for (const Edge* e : n->in_edges()) {
+    if (e->IsControlEdge()) continue;
+    if (!IsConstantValue(e->src(), depth + 1)) return false;
+  }
+  return true;
+}
+
+// Returns true if `n` adds a constant to the loop variable `arg`.
+bool IsCounterStep(const Node* n, const Node* arg) {
+  if (n->type_string() != "Add" && n->type_string() != "AddV2") return false;
+  const Node* x = InputNode(n, 0);
+  const Node* y = InputNode(n, 1);
+  if (x == nullptr || y == nullptr) return false;
+  return (x == arg && IsConstantValue(y)) || (y == arg && IsConstantValue(x));
+}
+
+// Returns true if `n` writes an element of the TensorArray or TensorList
+// carried by the loop variable `arg`.
+bool IsElementWrite(const Node* n, const Node* arg) {
+  if (n->type_string() == "TensorArrayWriteV3") {
+    return InputNode(n, 3) == arg;  // flow_in
+  }
+  if (n->type_string() == "TensorListSetItem") {
+    return InputNode(n, 0) == arg;  // input_handle
+  }
+  return false;
+}
+
+// Returns true if all values computed by `n` flow into `consumer`.
+bool OnlyFeeds(const Node* n, const Node* consumer) {
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge() || e->dst() == consumer) continue;
+    if (!e->dst()->IsIdentity() || !OnlyFeeds(e->dst(), consumer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Stateful ops which do not order the iterations that run them, as long as
+// each iteration reads and writes its own TensorArray elements.
+bool IsTensorArrayElementAccess(const Node* n) {
+  return n->type_string() == "TensorArrayReadV3" ||
+         n->type_string() == "TensorArrayWriteV3" ||
+         n->type_string() == "TensorArraySizeV3";
+}
+
+// Returns true if no iteration of the loop with body `body_fn` reads a value
+// computed by an earlier one, other than loop counters and the TensorArrays or
+// TensorLists it only writes elements to. All iterations of such a loop, e.g.
+// a map over a TensorArray, may run at the same time.
+bool HasIndependentIterations(const Graph& g, const NameAttrList& body_fn) {
+  const FunctionDef* fdef = g.flib_def().Find(body_fn.name());
+  if (fdef == nullptr) return false;
+  std::unique_ptr<FunctionBody> fbody;
+  if (!FunctionDefToBodyHelper(*fdef, AttrSlice(&body_fn.attr()),
+                               &g.flib_def(), &fbody)
+           .ok()) {
+    return false;
+  }
+  for (const Node* n : fbody->graph->op_nodes()) {
+    if (n->IsArg() || n->IsRetval()) continue;
+    // Function calls and side effects may order the iterations.
+    if (g.flib_def().Find(n->type_string()) != nullptr) return false;
+    if (n->op_def().is_stateful() && !IsTensorArrayElementAccess(n)) {
+      return false;
+    }
+  }
+
+  const int num_loop_vars = fbody->arg_nodes.size();
+  if (fbody->ret_nodes.size() != fbody->arg_nodes.size()) return false;
+  for (int i = 0; i < num_loop_vars; ++i) {
+    const Node* arg = fbody->arg_nodes[i];
+    const Node* next = InputNode(fbody->ret_nodes[i], 0);
+    if (next == nullptr) return false;
+    if (next == arg || IsCounterStep(next, arg)) continue;
+    // Later iterations must not read the elements this one wrote.
+    if (IsElementWrite(next, arg) && OnlyFeeds(arg, next)) continue;
+    return false;
+  }
+  return true;
+}
+
+// Returns true if `parallel_iterations` is the default of the While node `n`,
+// i.e. the graph did not ask for a number of parallel iterations.
+bool IsDefaultParallelIterations(const Node* n, int parallel_iterations) {
+  const OpDef::AttrDef* attr = FindAttr("parallel_iterations", n->op_def());
+  return attr != nullptr && attr->has_default_value() &&
+         attr->default_value().i() == parallel_iterations;
+}
+
 }  // namespace
 
 Status RewriteWhileNode(Node* n, Graph* g,
@@ -521,9 +639,22 @@ Status RewriteWhileNode(Node* n, Graph* g,
     return errors::InvalidArgument("parallel_iterations attr missing");
   }
 
-  TF_RETURN_IF_ERROR(LowerWhileHelper::Run(
-      n, cond_attr->func(), body_attr->func(), parallel_iterations_attr->i(), g,
-      keep_node_fetchable));
+  int parallel_iterations = parallel_iterations_attr->i();
+  if (IsDefaultParallelIterations(n, parallel_iterations) &&
+      HasIndependentIterations(*g, body_attr->func())) {
+    // Nothing orders the iterations but the loop counters, so let as many run
+    // at once as there are cores to run them. A number of parallel iterations
+    // other than the default is kept, since it may bound the memory used by
+    // the iterations in flight.
+    parallel_iterations = std::max(parallel_iterations, port::MaxParallelism());
+    VLOG(2) << "While node " << n->name() << " has independent iterations, "
+            << "running up to " << parallel_iterations << " at once";
+  }
+
+  TF_RETURN_IF_ERROR(LowerWhileHelper::Run(n, cond_attr->func(),
+                                           body_attr->func(),
+                                           parallel_iterations, g,
+                                           keep_node_fetchable));
   g->RemoveNode(n);
 
   return Status::OK();
@@ -26,10 +26,12 @@ limitations under the License.
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -171,6 +173,100 @@ TEST(LowerWhileOpTest, Simple) {
   }
 }
 
+// Lowers a While node that runs `body` on an int32 from 1 while it is at most
+// 8, with `parallel_iterations` if it is positive and with the default
+// otherwise. Sets `*enter_parallel_iterations` to the parallel_iterations of
+// the Enter node of the lowered loop and `*result` to the loop output.
+void LowerLoop(const FunctionDef& body, int parallel_iterations,
+               int* enter_parallel_iterations, int* result) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+
+  FunctionDefLibrary f_lib_proto;
+  *f_lib_proto.add_function() = body;
+  *f_lib_proto.add_function() = test::function::LessThanOrEqualToN(8);
+
+  Scope root = Scope::NewRootScope().ExitOnError();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto a = ops::Placeholder(root.WithOpName("A"), DT_INT32);
+  Node* while_node;
+  std::vector<NodeBuilder::NodeOut> inputs({NodeBuilder::NodeOut(a.node())});
+  AttrValue cond_func;
+  cond_func.mutable_func()->set_name("LessThanOrEqualToN");
+  AttrValue body_func;
+  body_func.mutable_func()->set_name(body.signature().name());
+  NodeBuilder builder("while", "While", &root.graph()->flib_def());
+  builder.Input(inputs)
+      .Attr("T", {DT_INT32})
+      .Attr("cond", cond_func)
+      .Attr("body", body_func)
+      .Attr(LowerFunctionalOpsPass::kLowerUsingSwitchMergeAttr, true);
+  if (parallel_iterations > 0) {
+    builder.Attr("parallel_iterations", parallel_iterations);
+  }
+  TF_ASSERT_OK(builder.Finalize(root.graph(), &while_node));
+  TF_ASSERT_OK(root.DoShapeInference(while_node));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+
+  TF_ASSERT_OK(Rewrite(&graph));
+
+  int enter_count = 0;
+  for (const auto* op : graph->op_nodes()) {
+    if (op->IsEnter()) {
+      ++enter_count;
+      *enter_parallel_iterations =
+          op->attrs().Find("parallel_iterations")->i();
+    }
+  }
+  EXPECT_EQ(enter_count, 1);
+
+  ClientSession session(root, SessionOptionsWithInlining());
+  ClientSession::FeedType feeds;
+  feeds.emplace(Output(a.node()), Input::Initializer(1));
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(session.Run(feeds, {Output(while_node)}, &out_tensors));
+  ASSERT_EQ(out_tensors.size(), 1);
+  *result = out_tensors[0].scalar<int>()();
+}
+
+// A body that only increments the loop counter.
+FunctionDef XPlusOne() {
+  const Tensor kOne = test::AsScalar<int32>(1);
+  return FunctionDefHelper::Define(
+      "XPlusOne", {"x: int32"}, {"y: int32"}, {},
+      {
+          {{"one"}, "Const", {}, {{"value", kOne}, {"dtype", DT_INT32}}},
+          {{"y"}, "AddV2", {"x", "one"}, {{"T", DT_INT32}}},
+      });
+}
+
+TEST(LowerWhileOpTest, IndependentIterationsRunInParallel) {
+  int parallel_iterations = 0;
+  int result = 0;
+  LowerLoop(XPlusOne(), /*parallel_iterations=*/0, &parallel_iterations,
+            &result);
+  EXPECT_EQ(parallel_iterations, std::max(10, port::MaxParallelism()));
+  EXPECT_EQ(result, 9);
+}
+
+TEST(LowerWhileOpTest, ExplicitParallelIterationsAreKept) {
+  int parallel_iterations = 0;
+  int result = 0;
+  LowerLoop(XPlusOne(), /*parallel_iterations=*/1, &parallel_iterations,
+            &result);
+  EXPECT_EQ(parallel_iterations, 1);
+  EXPECT_EQ(result, 9);
+}
+
+TEST(LowerWhileOpTest, DependentIterationsAreKept) {
+  // Each iteration doubles the value computed by the previous one.
+  int parallel_iterations = 0;
+  int result = 0;
+  LowerLoop(test::function::XTimesTwo(), /*parallel_iterations=*/0,
+            &parallel_iterations, &result);
+  EXPECT_EQ(parallel_iterations, 10);
+  EXPECT_EQ(result, 16);
+}
+
 TEST(LowerWhileOpTest, ForwardAssignedInputDevice) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
 
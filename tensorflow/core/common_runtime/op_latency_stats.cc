@@ -0,0 +1,159 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/op_latency_stats.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Interval at which each thread merges its samples into the sampler.
+constexpr uint64 kMergeIntervalMicros = 1000 * 1000;
+
+// Number of samples recorded by a thread between reads of the clock.
+constexpr int kSamplesPerClockCheck = 128;
+
+struct OpLatencyMetric {
+  monitoring::Sampler<2>* sampler;
+  // The bucket boundaries of the cells of `sampler`.
+  std::vector<double> bucket_limits;
+};
+
+const OpLatencyMetric& GetOpLatencyMetric() {
+  static const OpLatencyMetric* metric = [] {
+    // Power of 2 with bucket count 25 (> 16 seconds)
+    std::unique_ptr<monitoring::Buckets> buckets =
+        monitoring::Buckets::Exponential(1, 2, 25);
+    auto* metric = new OpLatencyMetric;
+    metric->bucket_limits = buckets->explicit_bounds();
+    metric->sampler = monitoring::Sampler<2>::New(
+        {"/tensorflow/core/op_latency_usecs",
+         "The execution time of kernels in microseconds, by op type and "
+         "device type.",
+         "op_type", "device_type"},
+        std::move(buckets));
+    return metric;
+  }();
+  return *metric;
+}
+
+}  // namespace
+
+// The histograms of a thread, indexed by OpLatencyStats::id_.
+struct OpLatencyStats::ThreadSamples {
+  struct Entry {
+    OpLatencyStats* stats = nullptr;
+    std::unique_ptr<histogram::Histogram> histogram;
+    bool has_samples = false;
+  };
+
+  ~ThreadSamples() { Merge(); }
+
+  void Merge() {
+    for (Entry& entry : entries) {
+      if (!entry.has_samples) continue;
+      entry.stats->cell_->Merge(*entry.histogram);
+      entry.histogram->Clear();
+      entry.has_samples = false;
+    }
+  }
+
+  std::vector<Entry> entries;
+  int samples_until_clock_check = kSamplesPerClockCheck;
+  uint64 next_merge_micros = 0;
+};
+
+/*static*/ bool OpLatencyStats::Enabled() {
+#ifdef IS_MOBILE_PLATFORM
+  return false;
+#else
+  static const bool enabled = [] {
+    bool enabled = true;
+    Status s = ReadBoolFromEnvVar("TF_OP_LATENCY_METRICS", true, &enabled);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+    }
+    return enabled;
+  }();
+  return enabled;
+#endif
+}
+
+/*static*/ OpLatencyStats* OpLatencyStats::Get(absl::string_view op_type,
+                                               absl::string_view device_type) {
+  static mutex* mu = new mutex;
+  static auto* stats_by_label =
+      new absl::flat_hash_map<std::pair<string, string>, OpLatencyStats*>;
+  std::pair<string, string> labels(op_type, device_type);
+  mutex_lock lock(*mu);
+  OpLatencyStats*& stats = (*stats_by_label)[labels];
+  if (stats == nullptr) {
+    monitoring::SamplerCell* cell =
+        GetOpLatencyMetric().sampler->GetCell(labels.first, labels.second);
+    stats = new OpLatencyStats(stats_by_label->size() - 1, cell);
+  }
+  return stats;
+}
+
+/*static*/ OpLatencyStats::ThreadSamples* OpLatencyStats::GetThreadSamples() {
+  static thread_local ThreadSamples samples;
+  return &samples;
+}
+
+void OpLatencyStats::Record(uint64 elapsed_cycles) {
+  static const double micros_per_cycle =
+      profile_utils::CpuUtils::GetMicroSecPerClock();
+  ThreadSamples* samples = GetThreadSamples();
+  if (TF_PREDICT_FALSE(id_ >= samples->entries.size())) {
+    samples->entries.resize(id_ + 1);
+  }
+  ThreadSamples::Entry& entry = samples->entries[id_];
+  if (TF_PREDICT_FALSE(entry.histogram == nullptr)) {
+    entry.stats = this;
+    entry.histogram = absl::make_unique<histogram::Histogram>(
+        GetOpLatencyMetric().bucket_limits);
+  }
+  entry.histogram->Add(elapsed_cycles * micros_per_cycle);
+  entry.has_samples = true;
+
+  if (TF_PREDICT_FALSE(--samples->samples_until_clock_check == 0)) {
+    samples->samples_until_clock_check = kSamplesPerClockCheck;
+    const uint64 now_micros = EnvTime::NowMicros();
+    if (now_micros >= samples->next_merge_micros) {
+      samples->Merge();
+      samples->next_merge_micros = now_micros + kMergeIntervalMicros;
+    }
+  }
+}
+
+/*static*/ void OpLatencyStats::MergeThreadSamples() {
+  GetThreadSamples()->Merge();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OP_LATENCY_STATS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OP_LATENCY_STATS_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Latency histogram of the kernels of one op type on one device type,
+// exported as the "/tensorflow/core/op_latency_usecs" sampler with the op type
+// and the device type as labels. The histogram count is the number of kernel
+// executions.
+//
+// Samples are measured in CPU cycles and added to a histogram owned by the
+// recording thread, without locking. Each thread merges its histograms into
+// the sampler every second or so, and when it exits, so the exported values
+// lag behind by up to a second (or more, for a thread that stops running
+// kernels).
+//
+// Recording is enabled unless the environment variable TF_OP_LATENCY_METRICS
+// is false.
+//
+// This class is thread-safe.
+class OpLatencyStats {
+ public:
+  // Returns whether the latencies of kernels should be recorded.
+  static bool Enabled();
+
+  // Returns the stats of the kernels of type `op_type` on devices of type
+  // `device_type`. The result is never deleted.
+  static OpLatencyStats* Get(absl::string_view op_type,
+                             absl::string_view device_type);
+
+  // Records a kernel execution that took `elapsed_cycles` CPU cycles.
+  void Record(uint64 elapsed_cycles);
+
+  // Merges the samples recorded by the calling thread into the sampler.
+  static void MergeThreadSamples();
+
+ private:
+  OpLatencyStats(size_t id, monitoring::SamplerCell* cell)
+      : id_(id), cell_(cell) {}
+
+  struct ThreadSamples;
+  static ThreadSamples* GetThreadSamples();
+
+  // Index of the histogram of these stats in each ThreadSamples.
+  const size_t id_;
+  monitoring::SamplerCell* const cell_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OpLatencyStats);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OP_LATENCY_STATS_H_
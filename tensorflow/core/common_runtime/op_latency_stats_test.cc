@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/op_latency_stats.h"
+
+#include <memory>
+
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the number of samples recorded for the given labels.
+double NumSamples(const string& op_type, const string& device_type) {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  options.collect_metric_descriptors = false;
+  const std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  auto it = metrics->point_set_map.find("/tensorflow/core/op_latency_usecs");
+  if (it == metrics->point_set_map.end()) return 0;
+  for (const auto& point : it->second->points) {
+    if (point->labels.size() == 2 && point->labels[0].value == op_type &&
+        point->labels[1].value == device_type) {
+      return point->histogram_value.num();
+    }
+  }
+  return 0;
+}
+
+TEST(OpLatencyStatsTest, GetReturnsSameStatsForSameLabels) {
+  OpLatencyStats* stats = OpLatencyStats::Get("SameLabelsOp", "CPU");
+  EXPECT_EQ(stats, OpLatencyStats::Get("SameLabelsOp", "CPU"));
+  EXPECT_NE(stats, OpLatencyStats::Get("SameLabelsOp", "GPU"));
+  EXPECT_NE(stats, OpLatencyStats::Get("OtherOp", "CPU"));
+}
+
+TEST(OpLatencyStatsTest, MergesThreadSamples) {
+  OpLatencyStats* stats = OpLatencyStats::Get("MergedOp", "CPU");
+  stats->Record(1000);
+  stats->Record(2000);
+  OpLatencyStats::MergeThreadSamples();
+  EXPECT_EQ(NumSamples("MergedOp", "CPU"), 2);
+  EXPECT_EQ(NumSamples("MergedOp", "GPU"), 0);
+}
+
+TEST(OpLatencyStatsTest, MergesSamplesOfExitedThreads) {
+  OpLatencyStats* stats = OpLatencyStats::Get("ExitedThreadOp", "CPU");
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "record", [stats] { stats->Record(1000); }));
+  thread.reset();
+  EXPECT_EQ(NumSamples("ExitedThreadOp", "CPU"), 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
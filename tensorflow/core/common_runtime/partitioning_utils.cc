@@ -18,10 +18,16 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_partition.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -163,4 +169,85 @@ string FunctionNameGenerator::GetName() {
   }
 }
 
+PartitionedFunctionGraphCache* PartitionedFunctionGraphCache::Global() {
+  static PartitionedFunctionGraphCache* cache = [] {
+    int64 capacity;
+    Status s = ReadInt64FromEnvVar("TF_PARTITIONED_FUNCTION_GRAPH_CACHE_SIZE",
+                                   /*default_val=*/0, &capacity);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      capacity = 0;
+    }
+    return new PartitionedFunctionGraphCache(capacity);
+  }();
+  return cache;
+}
+
+uint64 PartitionedFunctionGraphCache::Fingerprint(
+    const string& function_key, const FunctionDefLibrary& library,
+    const DeviceSet& device_set) {
+  uint64 fingerprint = Fingerprint64(function_key);
+  string serialized;
+  SerializeToStringDeterministic(library, &serialized);
+  fingerprint = FingerprintCat64(fingerprint, Fingerprint64(serialized));
+  // The devices are identified by their names and properties, and not their
+  // incarnations, which are set by ImportPartitions().
+  for (const Device* device : device_set.devices()) {
+    const DeviceAttributes& attributes = device->attributes();
+    fingerprint = FingerprintCat64(
+        fingerprint,
+        Fingerprint64(strings::StrCat(attributes.name(), "|",
+                                      attributes.device_type(), "|",
+                                      attributes.memory_limit(), "|",
+                                      attributes.physical_device_desc())));
+  }
+  return fingerprint;
+}
+
+std::shared_ptr<const PartitionedFunctionGraphCache::Entry>
+PartitionedFunctionGraphCache::Lookup(uint64 key) const {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  return it == entries_.end() ? nullptr : it->second;
+}
+
+void PartitionedFunctionGraphCache::Insert(uint64 key,
+                                           std::shared_ptr<const Entry> entry) {
+  mutex_lock l(mu_);
+  if (entries_.size() >= capacity_) return;
+  entries_.emplace(key, std::move(entry));
+}
+
+Status PartitionedFunctionGraphCache::ImportPartitions(
+    const Entry& entry, const DeviceSet& device_set,
+    const FunctionLibraryDefinition& flib_def,
+    std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs) {
+  for (const auto& partition : entry.partitions) {
+    GraphDef graph_def = partition.second;
+    for (NodeDef& ndef : *graph_def.mutable_node()) {
+      if (ndef.op() != "_Send" && ndef.op() != "_Recv") continue;
+      const string& send_device = GetNodeAttrString(ndef, "send_device");
+      if (send_device.empty()) continue;
+      const Device* device = device_set.FindDeviceByName(send_device);
+      if (device == nullptr) {
+        return errors::NotFound("Cannot find the send device ", send_device,
+                                " of ", ndef.name());
+      }
+      SetAttrValue(static_cast<int64>(device->attributes().incarnation()),
+                   &(*ndef.mutable_attr())["send_device_incarnation"]);
+    }
+    std::unique_ptr<Graph> subgraph(
+        new Graph(flib_def.ReachableDefinitions(graph_def)));
+    FunctionLibraryDefinition global_flib(OpRegistry::Global(), {});
+    TF_CHECK_OK(subgraph->AddFunctionLibrary(global_flib.ToProto()));
+    GraphConstructorOptions opts;
+    opts.allow_internal_ops = true;
+    opts.expect_device_spec = true;
+    TF_RETURN_IF_ERROR(
+        ConvertGraphDefToGraph(opts, std::move(graph_def), subgraph.get()));
+    subgraphs->emplace(partition.first, std::move(subgraph));
+  }
+  return Status::OK();
+}
+
 }  // namespace tensorflow
@@ -15,12 +15,18 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PARTITIONING_UTILS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PARTITIONING_UTILS_H_
 
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -82,6 +88,62 @@ class FunctionNameGenerator {
   uint32 counter_;
 };
 
+// A process-wide cache of optimized and partitioned multi-device function
+// graphs, shared read-only by all the ProcessFunctionLibraryRuntimes of the
+// process. Instantiating a function already instantiated by another runtime
+// (e.g. of another session or eager context) then skips the graph
+// optimization passes, the placer and the partitioner.
+class PartitionedFunctionGraphCache {
+ public:
+  struct Entry {
+    int num_outputs = 0;
+    DataTypeVector ret_types;
+    // The function library after running the graph optimization passes.
+    FunctionDefLibrary library;
+    // Maps names of the nodes of the partitions to control output names.
+    std::unordered_map<string, string> node_name_to_control_ret;
+    // The device names and graphs of the partitions.
+    std::vector<std::pair<string, GraphDef>> partitions;
+  };
+
+  // Returns the cache of the process, which holds up to
+  // TF_PARTITIONED_FUNCTION_GRAPH_CACHE_SIZE entries. The cache is disabled
+  // unless this environment variable is set.
+  static PartitionedFunctionGraphCache* Global();
+
+  explicit PartitionedFunctionGraphCache(int64 capacity)
+      : capacity_(capacity) {}
+
+  bool enabled() const { return capacity_ > 0; }
+
+  // Returns the key of a function instantiated as `function_key` from
+  // `library` on `device_set`. `function_key` must not depend on the runtime,
+  // e.g. on the address of its function library.
+  static uint64 Fingerprint(const string& function_key,
+                            const FunctionDefLibrary& library,
+                            const DeviceSet& device_set);
+
+  // Returns the entry for `key`, or nullptr if there is none.
+  std::shared_ptr<const Entry> Lookup(uint64 key) const;
+
+  // Inserts `entry` for `key`, unless the cache is full. Entries are never
+  // evicted, since their graphs are only copied by Lookup() callers.
+  void Insert(uint64 key, std::shared_ptr<const Entry> entry);
+
+  // Builds the partitions of `entry` in `subgraphs`, setting the incarnations
+  // of the devices of `device_set` on their Send and Recv nodes.
+  static Status ImportPartitions(
+      const Entry& entry, const DeviceSet& device_set,
+      const FunctionLibraryDefinition& flib_def,
+      std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs);
+
+ private:
+  const int64 capacity_;
+  mutable mutex mu_;
+  std::unordered_map<uint64, std::shared_ptr<const Entry>> entries_
+      TF_GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PARTITIONING_UTILS_H_
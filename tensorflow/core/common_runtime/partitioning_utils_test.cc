@@ -251,5 +251,66 @@ TEST_F(PartitioningUtilsTest, UpdateArgsAndRets_Order) {
   CheckAlloc({false, false, false, false, false}, ret_alloc_attrs);
 }
 
+TEST_F(PartitioningUtilsTest, PartitionedFunctionGraphCache) {
+  std::unique_ptr<Graph> graph = absl::make_unique<Graph>(OpRegistry::Global());
+  TwoDeviceSwapGraph(graph.get());
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+  TF_ASSERT_OK(
+      PartitionFunctionGraph(device_set_, std::move(graph), &subgraphs));
+
+  // Make the partitions look like they were made with devices of another
+  // runtime.
+  auto entry = std::make_shared<PartitionedFunctionGraphCache::Entry>();
+  for (const auto& pair : subgraphs) {
+    entry->partitions.emplace_back(pair.first, GraphDef());
+    GraphDef* def = &entry->partitions.back().second;
+    pair.second->ToGraphDef(def);
+    for (NodeDef& ndef : *def->mutable_node()) {
+      if (ndef.op() == "_Send" || ndef.op() == "_Recv") {
+        (*ndef.mutable_attr())["send_device_incarnation"].set_i(1234);
+      }
+    }
+  }
+
+  PartitionedFunctionGraphCache cache(/*capacity=*/1);
+  FunctionDefLibrary library;
+  const uint64 key =
+      PartitionedFunctionGraphCache::Fingerprint("f[]", library, device_set_);
+  EXPECT_NE(key,
+            PartitionedFunctionGraphCache::Fingerprint("g[]", library,
+                                                       device_set_));
+  EXPECT_EQ(cache.Lookup(key), nullptr);
+  cache.Insert(key, entry);
+  EXPECT_EQ(cache.Lookup(key), entry);
+  // The cache is full.
+  cache.Insert(key + 1, entry);
+  EXPECT_EQ(cache.Lookup(key + 1), nullptr);
+
+  std::unordered_map<string, std::unique_ptr<Graph>> imported;
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), library);
+  TF_ASSERT_OK(PartitionedFunctionGraphCache::ImportPartitions(
+      *entry, device_set_, flib_def, &imported));
+  ASSERT_EQ(2, imported.size());
+  int num_send_recv = 0;
+  for (const auto& pair : imported) {
+    EXPECT_EQ(subgraphs[pair.first]->num_op_nodes(),
+              pair.second->num_op_nodes());
+    for (const Node* n : pair.second->op_nodes()) {
+      if (!n->IsSend() && !n->IsRecv()) continue;
+      ++num_send_recv;
+      string send_device;
+      TF_ASSERT_OK(GetNodeAttr(n->attrs(), "send_device", &send_device));
+      int64 incarnation;
+      TF_ASSERT_OK(
+          GetNodeAttr(n->attrs(), "send_device_incarnation", &incarnation));
+      EXPECT_EQ(static_cast<int64>(device_set_.FindDeviceByName(send_device)
+                                       ->attributes()
+                                       .incarnation()),
+                incarnation);
+    }
+  }
+  EXPECT_GT(num_send_recv, 0);
+}
+
 }  // anonymous namespace
 }  // namespace tensorflow
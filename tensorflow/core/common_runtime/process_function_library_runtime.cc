@@ -14,11 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
+#include <algorithm>
 #include <iterator>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -645,49 +647,14 @@ Status GetGraphAndArgRets(
 
 }  // anonymous namespace
 
-Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
-    const string& function_name, AttrSlice attrs,
+Status ProcessFunctionLibraryRuntime::OptimizeAndPartitionMultiDeviceFunction(
+    const string& function_name, AttrSlice attrs, const FunctionDef* fdef,
+    const FunctionLibraryDefinition* lib_def,
     const FunctionLibraryRuntime::InstantiateOptions& options,
-    FunctionLibraryRuntime::Handle* handle) {
-  // Check if this function has already been instantiated.
-  const string& function_key = Canonicalize(function_name, attrs, options);
-
-  {
-    mutex_lock l(mu_);
-    const auto& it = table_.find(function_key);
-    if (it != table_.end()) {
-      *handle = it->second;
-      ++mdevice_data_[*handle]->instantiation_counter_;
-      return Status::OK();
-    }
-  }
-
-  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
-          << "\" on default device \"" << options.target << "\"";
-  if (VLOG_IS_ON(3)) {
-    int index = 0;
-    VLOG(3) << "Requested input devices:";
-    for (const string& device : options.input_devices) {
-      VLOG(3) << "    [input " << index++ << "] " << device;
-    }
-    index = 0;
-    VLOG(3) << "Requested output devices:";
-    for (const string& device : options.output_devices) {
-      VLOG(3) << "    [output " << index++ << "] " << device;
-    }
-  }
-
-  const FunctionLibraryDefinition* lib_def =
-      options.lib_def == nullptr ? lib_def_ : options.lib_def;
-
-  const FunctionDef* fdef = lib_def->Find(function_name);
-  if (fdef == nullptr) {
-    return errors::InvalidArgument("Failed to find function \"", function_name,
-                                   "\" in function library: ", lib_def);
-  }
-
-  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
-
+    const string& function_key, const DeviceSet* dev_set,
+    std::unique_ptr<MultiDeviceFunctionData>* data,
+    std::unordered_map<string, string>* node_name_to_control_ret,
+    std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs) {
   std::unique_ptr<Graph> graph;
   std::vector<Node*> arg_nodes, ret_nodes;
   std::vector<string> ret_node_names;
@@ -718,8 +685,6 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
     default_device = flr->device();
   }
-  const std::shared_ptr<DeviceSet> dev_set = device_set();
-
   TF_RETURN_IF_ERROR(
       SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
   TF_RETURN_IF_ERROR(PinArgsAndRets(
@@ -727,27 +692,24 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
       ret_nodes,
       options.config_proto.allow_soft_placement() ? default_device : nullptr));
 
-  auto data = absl::make_unique<MultiDeviceFunctionData>(
+  *data = absl::make_unique<MultiDeviceFunctionData>(
       function_name, function_key, ret_node_names.size(),
       lib_def->ReachableDefinitions(*fdef), std::move(ret_types));
 
-  // Mapping from a function body node name to the control output name.
-  std::unordered_map<string, string> node_name_to_control_ret;
-
   bool control_rets_updated = false;
   TF_RETURN_IF_ERROR(FunctionOptimizationPassRegistry::Global().Run(
-      *dev_set, options.config_proto, &graph, &data->lib_def_,
+      *dev_set, options.config_proto, &graph, &(*data)->lib_def_,
       &control_ret_node_names, &control_rets_updated));
 
   if (control_rets_updated) {
     // Function graph pass may have resulted in different nodes/node names for
     // control rets.
     for (const auto& control_ret : control_ret_node_names) {
-      node_name_to_control_ret.emplace(control_ret, control_ret);
+      node_name_to_control_ret->emplace(control_ret, control_ret);
     }
   } else {
     for (const auto& control_ret : fdef->control_ret()) {
-      node_name_to_control_ret.emplace(control_ret.second, control_ret.first);
+      node_name_to_control_ret->emplace(control_ret.second, control_ret.first);
     }
   }
 
@@ -758,8 +720,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   session_options.config = options.config_proto;
   optimization_options.session_options = &session_options;
   optimization_options.graph = &graph;
-  optimization_options.flib_def = &data->lib_def_;
-  optimization_options.device_set = dev_set.get();
+  optimization_options.flib_def = &(*data)->lib_def_;
+  optimization_options.device_set = dev_set;
   optimization_options.is_function_graph = true;
 
   // Do not run graph optimization passes for component functions, since they
@@ -781,7 +743,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   // exceptions/warnings in case where nested function call options are ignored.
   DumpGraph("Before calling Placer", graph.get());
   Placer placer(graph.get(), function_name, optimization_options.flib_def,
-                dev_set.get(), default_device,
+                dev_set, default_device,
                 options.config_proto.allow_soft_placement(),
                 options.config_proto.log_device_placement());
   TF_RETURN_IF_ERROR(placer.Run());
@@ -799,7 +761,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     DumpGraph("Before running graph optimization fn", graph.get());
     Status status = options.optimize_graph_fn(
         std::move(ret_node_names), std::move(control_ret_node_names),
-        &data->lib_def_, *dev_set, cpu_device, &graph);
+        &(*data)->lib_def_, *dev_set, cpu_device, &graph);
     if (!status.ok()) {
       LOG(WARNING) << "Ignoring multi-device function optimization failure: "
                    << status.ToString();
@@ -831,18 +793,17 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   VLOG(4) << "Main function graph to be partitioned:";
   VLOG(4) << DebugString(graph->ToGraphDefDebug());
 
-  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
   TF_RETURN_IF_ERROR(
-      PartitionFunctionGraph(*dev_set, std::move(graph), &subgraphs));
+      PartitionFunctionGraph(*dev_set, std::move(graph), subgraphs));
 
-  for (const auto& pair : subgraphs) {
+  for (const auto& pair : *subgraphs) {
     DumpGraph(strings::StrCat("Before running POST_PARTITIONING passes (",
                               pair.first, ")"),
               pair.second.get());
   }
   optimization_options.graph = nullptr;
   optimization_options.device_set = nullptr;
-  optimization_options.partition_graphs = &subgraphs;
+  optimization_options.partition_graphs = subgraphs;
   // Normally POST_PARTITIONING passes are run by distributed workers.
   // Distributed workers are currently not supported in this code path, so we
   // run the passes here.
@@ -850,7 +811,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
         OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
   }
-  for (const auto& pair : subgraphs) {
+  for (const auto& pair : *subgraphs) {
     const auto* optimized_subgraph = pair.second.get();
     DumpGraph(
         strings::StrCat("After all optimization passes (", pair.first, ")"),
@@ -865,7 +826,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
 
   if (options.graph_collector != nullptr) {
-    for (const auto& pair : subgraphs) {
+    for (const auto& pair : *subgraphs) {
       GraphDef def;
       pair.second->ToGraphDef(&def);
       *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
@@ -873,6 +834,118 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
+  return Status::OK();
+}
+
+Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    FunctionLibraryRuntime::Handle* handle) {
+  // Check if this function has already been instantiated.
+  const string& function_key = Canonicalize(function_name, attrs, options);
+
+  {
+    mutex_lock l(mu_);
+    const auto& it = table_.find(function_key);
+    if (it != table_.end()) {
+      *handle = it->second;
+      ++mdevice_data_[*handle]->instantiation_counter_;
+      return Status::OK();
+    }
+  }
+
+  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
+          << "\" on default device \"" << options.target << "\"";
+  if (VLOG_IS_ON(3)) {
+    int index = 0;
+    VLOG(3) << "Requested input devices:";
+    for (const string& device : options.input_devices) {
+      VLOG(3) << "    [input " << index++ << "] " << device;
+    }
+    index = 0;
+    VLOG(3) << "Requested output devices:";
+    for (const string& device : options.output_devices) {
+      VLOG(3) << "    [output " << index++ << "] " << device;
+    }
+  }
+
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? lib_def_ : options.lib_def;
+
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return errors::InvalidArgument("Failed to find function \"", function_name,
+                                   "\" in function library: ", lib_def);
+  }
+
+  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
+
+  const std::shared_ptr<DeviceSet> dev_set = device_set();
+  std::unique_ptr<MultiDeviceFunctionData> data;
+  // Mapping from a function body node name to the control output name.
+  std::unordered_map<string, string> node_name_to_control_ret;
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+
+  // The graphs collected from the optimization passes are not cached.
+  PartitionedFunctionGraphCache* graph_cache =
+      PartitionedFunctionGraphCache::Global();
+  const bool use_graph_cache =
+      graph_cache->enabled() && options.graph_collector == nullptr;
+  uint64 graph_cache_key = 0;
+  std::shared_ptr<const PartitionedFunctionGraphCache::Entry> cached_graphs;
+  if (use_graph_cache) {
+    // Unlike `function_key`, the key must not depend on the address of the
+    // function library of this runtime.
+    FunctionLibraryRuntime::InstantiateOptions key_options = options;
+    key_options.lib_def = nullptr;
+    std::vector<string> composite_devices;
+    for (const auto& composite_device : options.composite_devices) {
+      composite_devices.push_back(absl::StrCat(
+          composite_device.first, ":",
+          absl::StrJoin(*composite_device.second, ",")));
+    }
+    std::sort(composite_devices.begin(), composite_devices.end());
+    const string cache_function_key = absl::StrCat(
+        Canonicalize(function_name, attrs, key_options),
+        "|component:", options.is_component_function ? 1 : 0,
+        "|default_device_to_target:", options.default_device_to_target ? 1 : 0,
+        "|optimize_graph_fn:", options.optimize_graph_fn != nullptr ? 1 : 0,
+        "|composite_devices:", absl::StrJoin(composite_devices, ";"));
+    graph_cache_key = PartitionedFunctionGraphCache::Fingerprint(
+        cache_function_key, lib_def->ReachableDefinitions(*fdef).ToProto(),
+        *dev_set);
+    cached_graphs = graph_cache->Lookup(graph_cache_key);
+  }
+
+  if (cached_graphs != nullptr) {
+    VLOG(1) << "Reusing the partitioned graphs of MultiDevice function \""
+            << function_name << "\"";
+    data = absl::make_unique<MultiDeviceFunctionData>(
+        function_name, function_key, cached_graphs->num_outputs,
+        FunctionLibraryDefinition(OpRegistry::Global(),
+                                  cached_graphs->library),
+        cached_graphs->ret_types);
+    node_name_to_control_ret = cached_graphs->node_name_to_control_ret;
+    TF_RETURN_IF_ERROR(PartitionedFunctionGraphCache::ImportPartitions(
+        *cached_graphs, *dev_set, data->lib_def_, &subgraphs));
+  } else {
+    TF_RETURN_IF_ERROR(OptimizeAndPartitionMultiDeviceFunction(
+        function_name, attrs, fdef, lib_def, options, function_key,
+        dev_set.get(), &data, &node_name_to_control_ret, &subgraphs));
+    if (use_graph_cache) {
+      auto entry = std::make_shared<PartitionedFunctionGraphCache::Entry>();
+      entry->num_outputs = data->num_outputs_;
+      entry->ret_types = data->ret_types_;
+      entry->library = data->lib_def_.ToProto();
+      entry->node_name_to_control_ret = node_name_to_control_ret;
+      for (const auto& pair : subgraphs) {
+        entry->partitions.emplace_back(pair.first, GraphDef());
+        pair.second->ToGraphDef(&entry->partitions.back().second);
+      }
+      graph_cache->Insert(graph_cache_key, std::move(entry));
+    }
+  }
+
   // We must preserve control returns in each of the function components,
   // otherwise after function inlining we might prune side-effectful nodes.
   const auto control_ret =
@@ -883,6 +956,35 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
                : absl::nullopt;
   };
 
+  // Bind a channel to every edge between two partitions, which are run in this
+  // process unless a partition has no local function library runtime.
+  bool all_partitions_local = true;
+  for (const auto& pair : subgraphs) {
+    if (GetFLR(pair.first) == nullptr) all_partitions_local = false;
+  }
+  if (all_partitions_local) {
+    for (const auto& pair : subgraphs) {
+      for (const Node* node : pair.second->op_nodes()) {
+        if (!node->IsRecv()) continue;
+        bool client_terminated;
+        string tensor_name, send_device, recv_device;
+        TF_RETURN_IF_ERROR(GetNodeAttr(node->attrs(), "client_terminated",
+                                       &client_terminated));
+        TF_RETURN_IF_ERROR(
+            GetNodeAttr(node->attrs(), "tensor_name", &tensor_name));
+        TF_RETURN_IF_ERROR(
+            GetNodeAttr(node->attrs(), "send_device", &send_device));
+        TF_RETURN_IF_ERROR(
+            GetNodeAttr(node->attrs(), "recv_device", &recv_device));
+        if (client_terminated || subgraphs.count(send_device) == 0 ||
+            subgraphs.count(recv_device) == 0) {
+          continue;
+        }
+        data->channels_.emplace(tensor_name, data->channels_.size());
+      }
+    }
+  }
+
   int i = 0;
   // Generate a random function_name to avoid one function reuse the partition
   // function instantiated by another function.
@@ -984,6 +1086,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     group.Update(status);
   }
   TF_RETURN_IF_ERROR(group.as_summary_status());
+  if (data->is_cross_process_) data->channels_.clear();
 
   *handle = AddMultiDeviceHandle(std::move(data), function_key);
   VLOG(2) << "Instantiated MultiDevice function \"" << function_name
@@ -1102,12 +1205,25 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
     cm = local_cm.get();
   }
 
+  // Pass the tensors between the component functions through the channels
+  // bound at instantiation, rather than the keyed table of the rendezvous.
+  IntraProcessChannelRendezvous* channel_rendezvous = nullptr;
+  if (!data->channels_.empty() && opts.rendezvous != nullptr) {
+    channel_rendezvous = new IntraProcessChannelRendezvous(
+        device_mgr_, &data->channels_, opts.rendezvous);
+    done = [channel_rendezvous, done = std::move(done)](const Status& s) {
+      delete channel_rendezvous;
+      done(s);
+    };
+  }
+
   auto* refcounted_done = new ReffedStatusCallback(std::move(done));
   for (int i = 0; i < data->glue_.size(); ++i) {
     refcounted_done->Ref();
   }
 
   FunctionLibraryRuntime::Options opts_copy = opts;
+  if (channel_rendezvous != nullptr) opts_copy.rendezvous = channel_rendezvous;
   for (const auto& pair : data->glue_) {
     const string& target = pair.first;
     const ComponentFunctionData& comp_data = pair.second;
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -293,6 +294,11 @@ class ProcessFunctionLibraryRuntime {
     // Maps the device name to the information about the component function
     // be run on this device.
     std::unordered_map<string, ComponentFunctionData> glue_;
+
+    // The edges between the component functions, when they all run in this
+    // process. Their tensors are passed through the channels of an
+    // IntraProcessChannelRendezvous, instead of the rendezvous of the caller.
+    IntraProcessChannelRendezvous::ChannelMap channels_;
   };
 
   struct CleanUpItem {
@@ -369,6 +375,19 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Runs the graph optimization passes, the placer and the partitioner on the
+  // body of `fdef` for InstantiateMultiDevice(). Returns the graphs of the
+  // devices in `subgraphs`, and the function data to instantiate them in
+  // `data`.
+  Status OptimizeAndPartitionMultiDeviceFunction(
+      const string& function_name, AttrSlice attrs, const FunctionDef* fdef,
+      const FunctionLibraryDefinition* lib_def,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const string& function_key, const DeviceSet* dev_set,
+      std::unique_ptr<MultiDeviceFunctionData>* data,
+      std::unordered_map<string, string>* node_name_to_control_ret,
+      std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session_options.h"
@@ -1239,5 +1240,80 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, SessionMetadataPresentAfterCloning) {
   EXPECT_EQ(session_metadata.version(), read_metadata.version());
 }
 
+Rendezvous::ParsedKey MakeKey(const string& edge_name,
+                              const FrameAndIter& frame_iter) {
+  Rendezvous::ParsedKey parsed;
+  TF_CHECK_OK(Rendezvous::ParseKey(
+      Rendezvous::CreateKey("/job:a/replica:0/task:0/device:CPU:0", 1,
+                            "/job:a/replica:0/task:0/device:CPU:1", edge_name,
+                            frame_iter),
+      &parsed));
+  return parsed;
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest, IntraProcessChannelRendezvous) {
+  const IntraProcessChannelRendezvous::ChannelMap channels = {{"edge_1", 0},
+                                                              {"edge_2", 1}};
+  PrivateIntraProcessRendezvous base(device_mgr_.get());
+  IntraProcessChannelRendezvous rendezvous(device_mgr_.get(), &channels,
+                                           &base);
+  Tensor val;
+  bool is_dead;
+
+  // Sent before received.
+  TF_ASSERT_OK(rendezvous.Send(MakeKey("edge_1", {0, 0}), Rendezvous::Args(),
+                               test::AsScalar<float>(1), false));
+  TF_ASSERT_OK(rendezvous.Recv(MakeKey("edge_1", {0, 0}), Rendezvous::Args(),
+                               &val, &is_dead));
+  test::ExpectTensorEqual<float>(val, test::AsScalar<float>(1));
+  EXPECT_FALSE(is_dead);
+
+  // Received before sent.
+  Notification received;
+  rendezvous.RecvAsync(
+      MakeKey("edge_2", {0, 0}), Rendezvous::Args(),
+      [&](const Status& s, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& v, bool dead) {
+        TF_EXPECT_OK(s);
+        test::ExpectTensorEqual<float>(v, test::AsScalar<float>(2));
+        received.Notify();
+      });
+  TF_ASSERT_OK(rendezvous.Send(MakeKey("edge_2", {0, 0}), Rendezvous::Args(),
+                               test::AsScalar<float>(2), false));
+  received.WaitForNotification();
+
+  // The tensors of other edges and of loops go through the base rendezvous.
+  TF_ASSERT_OK(rendezvous.Send(MakeKey("edge_3", {0, 0}), Rendezvous::Args(),
+                               test::AsScalar<float>(3), false));
+  TF_ASSERT_OK(base.Recv(MakeKey("edge_3", {0, 0}), Rendezvous::Args(), &val,
+                         &is_dead));
+  test::ExpectTensorEqual<float>(val, test::AsScalar<float>(3));
+  TF_ASSERT_OK(rendezvous.Send(MakeKey("edge_1", {0, 1}), Rendezvous::Args(),
+                               test::AsScalar<float>(4), false));
+  TF_ASSERT_OK(base.Recv(MakeKey("edge_1", {0, 1}), Rendezvous::Args(), &val,
+                         &is_dead));
+  test::ExpectTensorEqual<float>(val, test::AsScalar<float>(4));
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest, IntraProcessChannelRendezvousAbort) {
+  const IntraProcessChannelRendezvous::ChannelMap channels = {{"edge_1", 0}};
+  PrivateIntraProcessRendezvous base(device_mgr_.get());
+  IntraProcessChannelRendezvous rendezvous(device_mgr_.get(), &channels,
+                                           &base);
+  Notification received;
+  rendezvous.RecvAsync(
+      MakeKey("edge_1", {0, 0}), Rendezvous::Args(),
+      [&](const Status& s, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& v, bool dead) {
+        EXPECT_TRUE(errors::IsCancelled(s)) << s;
+        received.Notify();
+      });
+  rendezvous.StartAbort(errors::Cancelled("cancelled"));
+  received.WaitForNotification();
+  EXPECT_TRUE(errors::IsCancelled(
+      rendezvous.Send(MakeKey("edge_1", {0, 0}), Rendezvous::Args(),
+                      test::AsScalar<float>(1), false)));
+}
+
 }  // anonymous namespace
 }  // namespace tensorflow
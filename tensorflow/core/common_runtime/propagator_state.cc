@@ -49,6 +49,11 @@ PropagatorState::~PropagatorState() {
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
+  for (auto& info_frames : free_frames_) {
+    for (FrameState* frame : info_frames.second) {
+      delete frame;
+    }
+  }
 }
 
 void PropagatorState::ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
@@ -231,7 +236,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
 
   const uint64 child_id = Hash64Combine(
       frame->frame_id,
-      Hash64Combine(iter_state->iter_num, Hash64(frame_info.name)));
+      Hash64Combine(iter_state->iter_num, frame_info.name_hash));
 
   {
     tf_shared_lock executor_lock(mu_);
@@ -250,8 +255,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
     VLOG(2) << "Create frame: " << child_name << " id: " << child_id;
   }
 
-  FrameState* temp =
-      new FrameState(immutable_state_, frame_info.parallel_iterations);
+  FrameState* temp = NewFrame(frame_info);
   temp->frame_id = child_id;
   temp->parent_frame = frame;
   temp->parent_iter = iter_state;
@@ -260,8 +264,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
   // Initialize iteration 0.
   {
     mutex_lock l(temp->mu);
-    temp->SetIteration(0, new IterationState(0, temp->pending_counts,
-                                             temp->total_input_tensors));
+    temp->SetIteration(0, temp->NewIteration(0));
   }
 
   {
@@ -277,7 +280,30 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
       temp = nullptr;
     }
   }
-  delete temp;  // Not used so delete it.
+  if (temp != nullptr) ReleaseFrame(temp);  // Not used so release it.
+}
+
+PropagatorState::FrameState* PropagatorState::NewFrame(
+    const ImmutableExecutorState::FrameInfo& frame_info) {
+  {
+    mutex_lock l(free_frames_mu_);
+    auto it = free_frames_.find(&frame_info);
+    if (it != free_frames_.end() && !it->second.empty()) {
+      FrameState* frame = it->second.back();
+      it->second.pop_back();
+      return frame;
+    }
+  }
+  return new FrameState(immutable_state_, frame_info.parallel_iterations);
+}
+
+void PropagatorState::ReleaseFrame(FrameState* frame) {
+  {
+    mutex_lock l(frame->mu);
+    frame->Reset();
+  }
+  mutex_lock l(free_frames_mu_);
+  free_frames_[frame->frame_info].push_back(frame);
 }
 
 void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
@@ -354,7 +380,7 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
     mutex_lock executor_lock(mu_);
     outstanding_frames_.erase(frame->frame_id);
   }
-  delete frame;
+  ReleaseFrame(frame);
 }
 
 void PropagatorState::CleanupFramesIterations(FrameState* frame,
@@ -616,8 +642,7 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter = NewIteration(iteration_count);
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   dead_exits.clear();
@@ -635,7 +660,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64 curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    ReleaseIteration(iter_state);
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -655,6 +680,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
 
 void PropagatorState::FrameState::InitializeFrameInfo(
     const ImmutableExecutorState::FrameInfo& finfo) {
+  frame_info = &finfo;
   pending_counts = finfo.pending_counts.get();
   total_input_tensors = finfo.total_inputs;
   num_pending_inputs = finfo.input_count;
@@ -672,6 +698,46 @@ void PropagatorState::FrameState::SetIteration(int64 iter,
   }
 }
 
+PropagatorState::IterationState* PropagatorState::FrameState::NewIteration(
+    int64 iter) TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+  if (free_iterations.empty()) {
+    return new IterationState(iter, pending_counts, total_input_tensors);
+  }
+  IterationState* iter_state = free_iterations.back();
+  free_iterations.pop_back();
+  iter_state->Reset(iter, pending_counts);
+  return iter_state;
+}
+
+void PropagatorState::FrameState::ReleaseIteration(IterationState* iter_state)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+  // Tensors left over, e.g. in the untaken inputs of merges, are freed now
+  // rather than when the state is reused.
+  for (int i = 0; i < total_input_tensors; ++i) {
+    iter_state->input_tensors[i].ClearVal();
+  }
+  free_iterations.push_back(iter_state);
+}
+
+void PropagatorState::FrameState::Reset() TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+  for (size_t i = 0; i < iterations.size(); ++i) {
+    if (iterations_raw[i] != nullptr) {
+      ReleaseIteration(iterations_raw[i]);
+      iterations_raw[i] = nullptr;
+    }
+  }
+  iterations_first = nullptr;
+  frame_id = 0;
+  parent_iter = nullptr;
+  parent_frame = nullptr;
+  num_pending_inputs = 0;
+  iteration_count = 0;
+  num_outstanding_iterations = 1;
+  next_iter_roots.clear();
+  inv_values.clear();
+  dead_exits.clear();
+}
+
 // Decrement the outstanding op count and clean up the iterations in the
 // frame. Return true iff the execution of the frame is done.
 bool PropagatorState::FrameState::DecrementOutstandingOps(
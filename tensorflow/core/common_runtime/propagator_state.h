@@ -130,7 +130,7 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64 iter_num;  // The index of this iteration in the enclosing loop.
+    int64 iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -173,6 +173,15 @@ class PropagatorState {
 
     ~IterationState() { delete[] input_tensors; }
 
+    // Prepares a finished iteration state for reuse as iteration `iter`.
+    // REQUIRES: All entries of `input_tensors` are cleared.
+    void Reset(int64 iter, const PendingCounts* pending_counts) {
+      iter_num = iter;
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyCountsFrom(*pending_counts);
+    }
+
    private:
     PendingCounts counts;
   };
@@ -272,6 +281,7 @@ class PropagatorState {
     std::vector<const NodeItem*> dead_exits TF_GUARDED_BY(mu);
 
     // Static information specific to this frame.
+    const ImmutableExecutorState::FrameInfo* frame_info = nullptr;
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
     std::vector<const NodeItem*>* nodes = nullptr;
@@ -294,6 +304,19 @@ class PropagatorState {
 
     void SetIteration(int64 iter, IterationState* state);
 
+    // Returns a state for iteration `iter`, reusing one of a finished
+    // iteration if possible.
+    IterationState* NewIteration(int64 iter) TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Releases the tensors of a finished iteration and keeps its state for
+    // reuse by a later one.
+    void ReleaseIteration(IterationState* iter_state)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Clears the state of a finished frame, so that it can be reused for
+    // another instance of the same frame.
+    void Reset() TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
     // Decrement the outstanding op count and clean up the iterations in the
     // frame. Return true iff the execution of the frame is done.
     bool DecrementOutstandingOps(IterationState* iter_state,
@@ -355,9 +378,16 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* iter_state : free_iterations) {
+        delete iter_state;
+      }
     }
 
    private:
+    // States of finished iterations, kept for reuse. There are at most
+    // `max_parallel_iterations + 1` iterations alive, which bounds its size.
+    std::vector<IterationState*> free_iterations TF_GUARDED_BY(mu);
+
     // REQUIRES: `!item->is_any_consumer_merge_or_control_trigger`.
     void ActivateNodesFastPath(const NodeItem* item, const bool is_dead,
                                IterationState* iter_state, EntryVector* outputs,
@@ -431,6 +461,14 @@ class PropagatorState {
   // Delete a frame. Called when the frame is done.
   void DeleteFrame(FrameState* frame, TaggedNodeSeq* ready);
 
+  // Returns a frame for an instance of `frame_info`, reusing a finished one if
+  // possible. Nested loops create a frame per iteration of the enclosing loop,
+  // which would otherwise allocate a frame and its iteration states each time.
+  FrameState* NewFrame(const ImmutableExecutorState::FrameInfo& frame_info);
+
+  // Keeps the finished `frame` for reuse by NewFrame.
+  void ReleaseFrame(FrameState* frame);
+
   // Cleanup frames and iterations starting from frame/iter. Called when
   // a child frame is done.
   void CleanupFramesIterations(FrameState* frame, IterationState* iter_state,
@@ -456,6 +494,13 @@ class PropagatorState {
   absl::flat_hash_map<uint64, FrameState*> outstanding_frames_
       TF_GUARDED_BY(mu_);
 
+  // Finished frames, per frame info. Guarded by a separate mutex, which is
+  // never held while acquiring another one.
+  mutex free_frames_mu_;
+  absl::flat_hash_map<const ImmutableExecutorState::FrameInfo*,
+                      std::vector<FrameState*>>
+      free_frames_ TF_GUARDED_BY(free_frames_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(PropagatorState);
 };
 
@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/recycling_allocator.h"
+
+namespace tensorflow {
+
+RecyclingAllocator::RecyclingAllocator(Allocator* base_allocator)
+    : base_allocator_(base_allocator) {}
+
+RecyclingAllocator::~RecyclingAllocator() {
+  // Every buffer that was handed out holds a reference, so only the cached
+  // buffer can remain.
+  DCHECK(last_ == nullptr);
+  if (cached_ != nullptr) base_allocator_->DeallocateRaw(cached_);
+}
+
+void* RecyclingAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  void* ptr = nullptr;
+  void* stale = nullptr;
+  {
+    mutex_lock l(mu_);
+    if (cached_ != nullptr) {
+      if (cached_num_bytes_ == num_bytes &&
+          reinterpret_cast<uintptr_t>(cached_) % alignment == 0) {
+        ptr = cached_;
+        last_ = ptr;
+        last_num_bytes_ = num_bytes;
+      } else {
+        // The size of the output changed, so the buffer is unlikely to be
+        // reused.
+        stale = cached_;
+      }
+      cached_ = nullptr;
+    }
+  }
+  if (stale != nullptr) base_allocator_->DeallocateRaw(stale);
+  if (ptr == nullptr) {
+    ptr = base_allocator_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) return nullptr;
+    mutex_lock l(mu_);
+    last_ = ptr;
+    last_num_bytes_ = num_bytes;
+  }
+  Ref();
+  return ptr;
+}
+
+void RecyclingAllocator::DeallocateRaw(void* ptr) {
+  bool cached = false;
+  {
+    mutex_lock l(mu_);
+    if (ptr == last_) {
+      last_ = nullptr;
+      if (cached_ == nullptr) {
+        cached_ = ptr;
+        cached_num_bytes_ = last_num_bytes_;
+        cached = true;
+      }
+    }
+  }
+  if (!cached) base_allocator_->DeallocateRaw(ptr);
+  // May delete `this`.
+  Unref();
+}
+
+bool RecyclingAllocator::has_cached_buffer() const {
+  mutex_lock l(mu_);
+  return cached_ != nullptr;
+}
+
+}  // namespace tensorflow
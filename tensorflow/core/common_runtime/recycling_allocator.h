@@ -0,0 +1,77 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RECYCLING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RECYCLING_ALLOCATOR_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that holds on to the buffer that it handed out last when that
+// buffer is deallocated, and hands it back to the next allocation of the same
+// size, instead of returning it to the underlying allocator.
+//
+// The executor may use one such allocator for each output of a node (see
+// `ImmutableExecutorState::recycling_output_allocators()`), so that a node
+// whose output has the same shape at every step allocates its output buffer
+// once. A buffer is only recycled once it has been deallocated, i.e. once no
+// tensor refers to it any more, so recycling is invisible to the kernels.
+//
+// At most one buffer is cached. Buffers that were not the last one handed out
+// (e.g. when several steps run concurrently) are returned to the underlying
+// allocator, and a cached buffer is dropped when an allocation of another size
+// is requested.
+//
+// The allocator is reference counted, and every buffer that it handed out holds
+// a reference on it, because tensors may outlive the executor that allocated
+// them.
+class RecyclingAllocator : public Allocator, public core::RefCounted {
+ public:
+  // `base_allocator` must outlive this allocator.
+  explicit RecyclingAllocator(Allocator* base_allocator);
+
+  string Name() override { return base_allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // For testing and debugging only.
+  bool has_cached_buffer() const;
+
+ private:
+  ~RecyclingAllocator() override;
+
+  Allocator* const base_allocator_;  // Not owned.
+
+  mutable mutex mu_;
+  // The buffer that was handed out last, if it has not been deallocated yet.
+  void* last_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t last_num_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // A deallocated buffer that is waiting to be reused.
+  void* cached_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t cached_num_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecyclingAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RECYCLING_ALLOCATOR_H_
@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/recycling_allocator.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(RecyclingAllocatorTest, ReusesBufferOfSameSize) {
+  RecyclingAllocator* allocator = new RecyclingAllocator(cpu_allocator_base());
+  core::ScopedUnref unref(allocator);
+
+  void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_FALSE(allocator->has_cached_buffer());
+  allocator->DeallocateRaw(ptr);
+  EXPECT_TRUE(allocator->has_cached_buffer());
+
+  EXPECT_EQ(ptr, allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100));
+  EXPECT_FALSE(allocator->has_cached_buffer());
+  allocator->DeallocateRaw(ptr);
+}
+
+TEST(RecyclingAllocatorTest, DropsBufferOfOtherSize) {
+  RecyclingAllocator* allocator = new RecyclingAllocator(cpu_allocator_base());
+  core::ScopedUnref unref(allocator);
+
+  void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  allocator->DeallocateRaw(ptr);
+  EXPECT_TRUE(allocator->has_cached_buffer());
+
+  void* other = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  ASSERT_NE(nullptr, other);
+  EXPECT_FALSE(allocator->has_cached_buffer());
+  allocator->DeallocateRaw(other);
+  EXPECT_TRUE(allocator->has_cached_buffer());
+}
+
+TEST(RecyclingAllocatorTest, OnlyCachesLastBuffer) {
+  RecyclingAllocator* allocator = new RecyclingAllocator(cpu_allocator_base());
+  core::ScopedUnref unref(allocator);
+
+  void* first = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* second = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  allocator->DeallocateRaw(first);
+  EXPECT_FALSE(allocator->has_cached_buffer());
+  allocator->DeallocateRaw(second);
+  EXPECT_TRUE(allocator->has_cached_buffer());
+}
+
+TEST(RecyclingAllocatorTest, TensorOutlivesOwner) {
+  RecyclingAllocator* allocator = new RecyclingAllocator(cpu_allocator_base());
+  Tensor t(allocator, DT_FLOAT, TensorShape({10}));
+  test::FillIota<float>(&t, 0.0f);
+  // The tensor keeps the allocator alive after its owner is gone.
+  allocator->Unref();
+  test::ExpectTensorEqual<float>(
+      t, test::AsTensor<float>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+}  // namespace
+}  // namespace tensorflow
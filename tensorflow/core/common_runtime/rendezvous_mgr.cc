@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 
+#include <cstring>
 #include <unordered_set>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -45,6 +47,31 @@ void SameWorkerRecvDone(const DeviceMgr* device_mgr,
   const bool dst_host =
       (recv_args.alloc_attrs.on_host() || parsed.dst.type == "CPU");
   if (src_host && dst_host) {
+    if (parsed.src.type == "CPU" && parsed.dst.type == "CPU" &&
+        parsed.src_device != parsed.dst_device &&
+        DataTypeCanUseMemcpy(in.dtype()) && in.TotalBytes() > 0) {
+      // With NUMA affinity, CPU devices may be bound to different NUMA nodes.
+      // Copy the tensor into memory local to the destination device, so that
+      // the consumers do not repeatedly read it from a remote node.
+      Device* src_device;
+      Device* dst_device;
+      if (device_mgr->LookupDevice(parsed.src_device, &src_device).ok() &&
+          device_mgr->LookupDevice(parsed.dst_device, &dst_device).ok() &&
+          src_device->attributes().locality().numa_node() !=
+              dst_device->attributes().locality().numa_node()) {
+        Tensor copy(dst_device->GetAllocator(recv_args.alloc_attrs),
+                    in.dtype(), in.shape());
+        // If the allocation fails, fall back to sharing the buffer.
+        if (copy.IsInitialized()) {
+          StringPiece src_data = in.tensor_data();
+          memcpy(const_cast<char*>(copy.tensor_data().data()),
+                 src_data.data(), src_data.size());
+          *out = std::move(copy);
+          done(Status::OK());
+          return;
+        }
+      }
+    }
     *out = in;
     done(Status::OK());
     return;
@@ -112,6 +139,33 @@ void SameWorkerRecvDone(const DeviceMgr* device_mgr,
       out, 0 /*dev_to_dev_stream_index*/, std::move(done), sync_dst_compute);
 }
 
+// Passes `in` to the receiver of `parsed`, copying it to its device if needed.
+void IntraProcessRecvDone(const DeviceMgr* device_mgr,
+                          const Rendezvous::ParsedKey& parsed,
+                          const Status& status,
+                          const Rendezvous::Args& send_args,
+                          const Rendezvous::Args& recv_args, const Tensor& in,
+                          bool is_dead,
+                          RendezvousInterface::DoneCallback done) {
+  // If "in" is an uninitialized tensor, do copy-construction to
+  // preserve the uninitialized state, along with data type and shape
+  // info, which is useful for debugger purposes.
+  Tensor* out = in.IsInitialized() ? new Tensor : new Tensor(in);
+
+  auto final_callback = [send_args, recv_args, out, is_dead,
+                         done = std::move(done)](const Status& s) {
+    done(s, send_args, recv_args, *out, is_dead);
+    delete out;
+  };
+
+  if (status.ok() && in.IsInitialized()) {
+    SameWorkerRecvDone(device_mgr, parsed, send_args, recv_args, in, out,
+                       std::move(final_callback));
+  } else {
+    final_callback(status);
+  }
+}
+
 void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
                                LocalRendezvous* local,
                                const RendezvousInterface::ParsedKey& parsed,
@@ -127,23 +181,8 @@ void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& in,
           bool is_dead) mutable {
-        // If "in" is an uninitialized tensor, do copy-construction to
-        // preserve the uninitialized state, along with data type and shape
-        // info, which is useful for debugger purposes.
-        Tensor* out = in.IsInitialized() ? new Tensor : new Tensor(in);
-
-        auto final_callback = [send_args, recv_args, out, is_dead,
-                               done = std::move(done)](const Status& s) {
-          done(s, send_args, recv_args, *out, is_dead);
-          delete out;
-        };
-
-        if (status.ok() && in.IsInitialized()) {
-          SameWorkerRecvDone(device_mgr, parsed, send_args, recv_args, in, out,
-                             std::move(final_callback));
-        } else {
-          final_callback(status);
-        }
+        IntraProcessRecvDone(device_mgr, parsed, status, send_args, recv_args,
+                             in, is_dead, std::move(done));
       });
 }
 
@@ -200,4 +239,131 @@ void PrivateIntraProcessRendezvous::StartAbort(const Status& s) {
   local_.StartAbort(s);
 }
 
+IntraProcessChannelRendezvous::IntraProcessChannelRendezvous(
+    const DeviceMgr* device_mgr, const ChannelMap* channels,
+    RendezvousInterface* base)
+    : device_mgr_(device_mgr),
+      channels_(channels),
+      base_(base),
+      slots_(new Channel[channels->size()]) {}
+
+IntraProcessChannelRendezvous::~IntraProcessChannelRendezvous() {}
+
+IntraProcessChannelRendezvous::Channel*
+IntraProcessChannelRendezvous::FindChannel(const ParsedKey& key) const {
+  // Tensors sent in loops have several values per edge, one per frame and
+  // iteration.
+  if (!absl::EndsWith(key.FullKey(), ";0:0")) return nullptr;
+  auto it = channels_->find(key.edge_name);
+  return it == channels_->end() ? nullptr : &slots_[it->second];
+}
+
+Status IntraProcessChannelRendezvous::abort_status() const {
+  mutex_lock l(mu_);
+  return status_;
+}
+
+Status IntraProcessChannelRendezvous::Send(const ParsedKey& key,
+                                           const Rendezvous::Args& args,
+                                           const Tensor& val,
+                                           const bool is_dead) {
+  Channel* channel = FindChannel(key);
+  if (channel == nullptr) return base_->Send(key, args, val, is_dead);
+  DVLOG(1) << "IntraProcessChannelRendezvous Send " << this << " "
+           << key.FullKey();
+
+  DoneCallback recv_done;
+  Rendezvous::Args recv_args;
+  {
+    mutex_lock l(channel->mu);
+    if (aborted_.load()) return abort_status();
+    if (channel->has_value) {
+      return errors::Aborted("Duplicated send: ", key.FullKey());
+    }
+    if (channel->recv_done == nullptr) {
+      channel->has_value = true;
+      channel->value = val;
+      channel->send_args = args;
+      channel->is_dead = is_dead;
+      return Status::OK();
+    }
+    recv_done = std::move(channel->recv_done);
+    channel->recv_done = nullptr;
+    recv_args = channel->recv_args;
+  }
+  IntraProcessRecvDone(device_mgr_, key, Status::OK(), args, recv_args, val,
+                       is_dead, std::move(recv_done));
+  return Status::OK();
+}
+
+void IntraProcessChannelRendezvous::RecvAsync(const ParsedKey& key,
+                                              const Rendezvous::Args& args,
+                                              DoneCallback done) {
+  Channel* channel = FindChannel(key);
+  if (channel == nullptr) {
+    base_->RecvAsync(key, args, std::move(done));
+    return;
+  }
+  DVLOG(1) << "IntraProcessChannelRendezvous Recv " << this << " "
+           << key.FullKey();
+
+  Tensor value;
+  Rendezvous::Args send_args;
+  bool is_dead;
+  {
+    mutex_lock l(channel->mu);
+    // The abort is checked while holding the lock of the channel, so that
+    // StartAbort() either sees the callback or is seen here.
+    if (aborted_.load()) {
+      l.unlock();
+      done(abort_status(), Rendezvous::Args(), args, Tensor(), false);
+      return;
+    }
+    if (!channel->has_value) {
+      if (channel->recv_done != nullptr) {
+        l.unlock();
+        done(errors::Aborted("Duplicated recv: ", key.FullKey()),
+             Rendezvous::Args(), args, Tensor(), false);
+        return;
+      }
+      channel->recv_done = std::move(done);
+      channel->recv_args = args;
+      return;
+    }
+    value = std::move(channel->value);
+    channel->value = Tensor();
+    send_args = channel->send_args;
+    is_dead = channel->is_dead;
+  }
+  IntraProcessRecvDone(device_mgr_, key, Status::OK(), send_args, args, value,
+                       is_dead, std::move(done));
+}
+
+void IntraProcessChannelRendezvous::StartAbort(const Status& status) {
+  CHECK(!status.ok());
+  {
+    mutex_lock l(mu_);
+    if (!aborted_.load()) {
+      status_ = status;
+      aborted_.store(true);
+    }
+  }
+  for (int i = 0; i < channels_->size(); ++i) {
+    Channel* channel = &slots_[i];
+    DoneCallback recv_done;
+    Rendezvous::Args recv_args;
+    {
+      mutex_lock l(channel->mu);
+      channel->has_value = false;
+      channel->value = Tensor();
+      if (channel->recv_done == nullptr) continue;
+      recv_done = std::move(channel->recv_done);
+      channel->recv_done = nullptr;
+      recv_args = channel->recv_args;
+    }
+    recv_done(status, Rendezvous::Args(), recv_args, Tensor(), false);
+  }
+  base_->StartAbort(status);
+}
+
 }  // end namespace tensorflow
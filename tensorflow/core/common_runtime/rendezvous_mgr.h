@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/rendezvous.h"
@@ -87,6 +90,61 @@ class PrivateIntraProcessRendezvous : public RendezvousInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(PrivateIntraProcessRendezvous);
 };
 
+// A rendezvous for one run of the components of a multi-device function in
+// one process. The tensors of the edges between the components, which are
+// known when the function is instantiated, are passed through channels
+// preallocated for the run instead of a table of rendezvous keys. The other
+// tensors, including those sent in loops, go through `base`.
+//
+// Not reference-counted: it must be destroyed after the run is done.
+class IntraProcessChannelRendezvous : public RendezvousInterface {
+ public:
+  // Maps the edge names of the channels to their indices.
+  using ChannelMap = absl::flat_hash_map<string, int>;
+
+  // `device_mgr`, `channels` and `base` must outlive this.
+  IntraProcessChannelRendezvous(const DeviceMgr* device_mgr,
+                                const ChannelMap* channels,
+                                RendezvousInterface* base);
+  ~IntraProcessChannelRendezvous() override;
+
+  // Implementation of RendezvousInterface methods.
+  Status Send(const ParsedKey& key, const Rendezvous::Args& args,
+              const Tensor& val, const bool is_dead) override;
+  void RecvAsync(const ParsedKey& key, const Rendezvous::Args& args,
+                 DoneCallback done) override;
+  void StartAbort(const Status& status) override;
+
+ private:
+  // Holds the tensor of an edge until it is received, or the callback of its
+  // receiver until it is sent.
+  struct Channel {
+    mutex mu;
+    bool has_value TF_GUARDED_BY(mu) = false;
+    Tensor value TF_GUARDED_BY(mu);
+    Rendezvous::Args send_args TF_GUARDED_BY(mu);
+    bool is_dead TF_GUARDED_BY(mu) = false;
+    DoneCallback recv_done TF_GUARDED_BY(mu);
+    Rendezvous::Args recv_args TF_GUARDED_BY(mu);
+  };
+
+  // Returns the channel of `key`, or nullptr if `key` must go through `base_`.
+  Channel* FindChannel(const ParsedKey& key) const;
+
+  Status abort_status() const;
+
+  const DeviceMgr* const device_mgr_;
+  const ChannelMap* const channels_;
+  RendezvousInterface* const base_;
+  const std::unique_ptr<Channel[]> slots_;
+
+  std::atomic<bool> aborted_{false};
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IntraProcessChannelRendezvous);
+};
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
@@ -79,6 +79,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool do_send = false;   // is the value sent in this pass?
     bool do_recv = false;   // is the value recv'd in this pass?
     bool is_final = false;  // is the last field in the pass for this rank
+    bool reduce_pending = false;  // is an asynchronous merge_op in flight?
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
     Status status;
@@ -209,9 +209,17 @@ bool RingReducer::RunAsyncParts() {
     }
   }
 
+  // On CPU the merge_op runs synchronously on the calling thread, which would
+  // keep this loop from dispatching the sends and recvs of the other fields
+  // until it returns.  Run it on the collective executor's work queue
+  // instead, so that the transfer of one field overlaps the reduction of
+  // another.  On GPU the merge_op only enqueues work on a stream.
+  const bool async_reduce = (gpu_info == nullptr) && (rfv_.size() > 1);
+
   int field_done_count = 0;
   int send_pending_count = 0;
   int recv_pending_count = 0;
+  int reduce_pending_count = 0;
   std::atomic<bool> aborted(false);
 
   {
@@ -221,6 +229,10 @@ bool RingReducer::RunAsyncParts() {
       VLOG(4) << FieldState();
       // Wait for a RingField to appear in the ready_queue.
       RingField* rf = ready_queue.Dequeue();
+      if (rf->reduce_pending) {
+        rf->reduce_pending = false;
+        --reduce_pending_count;
+      }
       // Advance the RingField to its next action and execute, repeating
       // until either an async action has been started or the RingField
       // is done.
@@ -254,12 +266,30 @@ bool RingReducer::RunAsyncParts() {
             --recv_pending_count;
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
-              Status s = collective_util::ComputeBinOp(
-                  col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
-                  col_params_->merge_op.get(), &rf->chunk, &rf->tmp_chunk);
-              if (!s.ok()) {
-                aborted = true;
-                StartAbort(s);
+              if (async_reduce) {
+                rf->reduce_pending = true;
+                col_ctx_->col_exec->RunClosure(
+                    [this, rf, &ready_queue, &aborted]() {
+                      Status s = collective_util::ComputeBinOp(
+                          col_ctx_->op_ctx, col_ctx_->op_params,
+                          col_ctx_->device, col_params_->merge_op.get(),
+                          &rf->chunk, &rf->tmp_chunk);
+                      if (!s.ok()) {
+                        aborted = true;
+                        StartAbort(s);
+                      }
+                      ready_queue.Enqueue(rf);
+                    });
+                dispatched = true;
+                ++reduce_pending_count;
+              } else {
+                Status s = collective_util::ComputeBinOp(
+                    col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+                    col_params_->merge_op.get(), &rf->chunk, &rf->tmp_chunk);
+                if (!s.ok()) {
+                  aborted = true;
+                  StartAbort(s);
+                }
               }
             } else {
               rf->action = RF_SEND_READY;
@@ -325,8 +355,14 @@ bool RingReducer::RunAsyncParts() {
     if (aborted) {
       // All of the pending data actions should be aborted; field the
       // callbacks and clear the queue before quitting.
-      while ((send_pending_count > 0) || (recv_pending_count > 0)) {
+      while ((send_pending_count > 0) || (recv_pending_count > 0) ||
+             (reduce_pending_count > 0)) {
         RingField* rf = ready_queue.Dequeue();
+        if (rf->reduce_pending) {
+          rf->reduce_pending = false;
+          --reduce_pending_count;
+          continue;
+        }
         switch (rf->action) {
           case RF_RECV:
             --recv_pending_count;
@@ -343,6 +379,7 @@ bool RingReducer::RunAsyncParts() {
 
   CHECK_EQ(send_pending_count, 0);
   CHECK_EQ(recv_pending_count, 0);
+  CHECK_EQ(reduce_pending_count, 0);
 
   VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
           << " final value " << TensorDebugString(ca_->Value());
@@ -95,6 +95,28 @@ class FailTestRMA : public CollectiveRemoteAccessLocal {
   int fail_after_ TF_GUARDED_BY(mu_);
 };
 
+// Wraps BaseCollectiveExecutor with a count of the closures it runs.
+class CountingCollectiveExecutor : public BaseCollectiveExecutor {
+ public:
+  CountingCollectiveExecutor(CollectiveExecutorMgrInterface* cem,
+                             CollectiveRemoteAccess* remote_access,
+                             int64 step_id, const DeviceMgr* dev_mgr,
+                             const string* gpu_ring_order,
+                             std::shared_ptr<UnboundedWorkQueue> work_queue,
+                             std::atomic<int>* num_closures)
+      : BaseCollectiveExecutor(cem, remote_access, step_id, dev_mgr,
+                               gpu_ring_order, std::move(work_queue)),
+        num_closures_(num_closures) {}
+
+  void RunClosure(std::function<void()> closure) override {
+    ++*num_closures_;
+    BaseCollectiveExecutor::RunClosure(std::move(closure));
+  }
+
+ private:
+  std::atomic<int>* num_closures_;  // Not owned.
+};
+
 std::unique_ptr<OpKernel> GetKernel(const NodeDef& node,
                                     const DeviceType& device_type,
                                     DeviceBase* device) {
@@ -196,9 +218,10 @@ class RingReducerTest : public ::testing::Test {
     work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
     rma_ = new FailTestRMA(dev_mgr_.get(), dev_resolver_.get(), kStepId,
                            fail_after);
-    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
-                                           dev_mgr_.get(),
-                                           gpu_ring_order_.get(), work_queue_);
+    num_closures_ = 0;
+    col_exec_ = new CountingCollectiveExecutor(
+        &col_exec_mgr_, rma_, kStepId, dev_mgr_.get(), gpu_ring_order_.get(),
+        work_queue_, &num_closures_);
     col_params_.name = "test_collective";
     static const int kGroupKey = 5;
     col_params_.group.group_key = kGroupKey;
@@ -544,6 +567,9 @@ class RingReducerTest : public ::testing::Test {
   CollectiveRemoteAccessLocal* rma_;
   std::unique_ptr<DeviceResolverLocal> dev_resolver_;
   std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  // Closures run by col_exec_, i.e. the merges taken off the RingReducer
+  // loop thread, since DoReduce calls RingReducer::Run directly.
+  std::atomic<int> num_closures_;
   std::vector<DeviceInstance*> instances_;
   CollectiveParams col_params_;
   std::vector<std::unique_ptr<tensorflow::Device>> gpu_devices_;
@@ -702,6 +728,17 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+// On CPU the merges of the first pass run on the collective executor, off
+// the RingReducer loop thread, while the other fields keep transferring.
+TEST_F(RingReducerTest, CpuMergesRunAsynchronously) {
+  const int kNumDevices = 4;
+  const int kNumSubdivs = 2;
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, 1, kNumDevices, kNumSubdivs, 1001, 0);
+  // Each of the num_subdivs * group_size chunks is merged group_size - 1
+  // times, on a different device each time.
+  EXPECT_EQ(kNumSubdivs * kNumDevices * (kNumDevices - 1), num_closures_);
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
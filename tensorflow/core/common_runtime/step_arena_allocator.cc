@@ -0,0 +1,262 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <new>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Rounds `n` up to a multiple of `alignment`, which must be a power of two.
+inline size_t RoundUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(StepArenaPool* pool)
+    : pool_(pool), current_(nullptr), bytes_allocated_(0) {}
+
+StepArenaAllocator::~StepArenaAllocator() {}
+
+StepArenaAllocator::ChunkHeader* StepArenaAllocator::ChunkFor(
+    void* ptr) const {
+  const uintptr_t mask =
+      ~static_cast<uintptr_t>(pool_->options_.chunk_size - 1);
+  return reinterpret_cast<ChunkHeader*>(reinterpret_cast<uintptr_t>(ptr) &
+                                        mask);
+}
+
+/* static */
+void* StepArenaAllocator::AllocateFromChunk(ChunkHeader* chunk,
+                                            size_t alignment,
+                                            size_t num_bytes) {
+  // Reserve enough space to align the result within the reservation. Every
+  // reservation is non-empty, so that the returned pointer always lies
+  // strictly inside the chunk (and `ChunkFor()` finds the right header).
+  size_t reserved =
+      RoundUp(std::max<size_t>(num_bytes, 1), kAllocatorAlignment);
+  if (alignment > kAllocatorAlignment) {
+    reserved += alignment - kAllocatorAlignment;
+  }
+  const size_t offset =
+      chunk->offset.fetch_add(reserved, std::memory_order_relaxed);
+  if (offset + reserved > chunk->size) {
+    return nullptr;
+  }
+  chunk->num_live.fetch_add(1, std::memory_order_relaxed);
+  const uintptr_t start = reinterpret_cast<uintptr_t>(chunk) + offset;
+  return reinterpret_cast<void*>(RoundUp(start, alignment));
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  const StepArenaPool::Options& options = pool_->options_;
+  alignment = std::max(alignment, kAllocatorAlignment);
+  if (num_bytes + alignment > options.chunk_size / 4) {
+    return AllocateDedicated(alignment, num_bytes);
+  }
+  while (true) {
+    ChunkHeader* chunk = current_.load(std::memory_order_acquire);
+    if (chunk != nullptr) {
+      void* ptr = AllocateFromChunk(chunk, alignment, num_bytes);
+      if (ptr != nullptr) {
+        bytes_allocated_.fetch_add(num_bytes, std::memory_order_relaxed);
+        return ptr;
+      }
+    }
+    if (bytes_allocated_.load(std::memory_order_relaxed) + num_bytes >
+        options.max_bytes_per_step) {
+      return AllocateDedicated(alignment, num_bytes);
+    }
+    // Slow path: install a new chunk, unless another thread has already done
+    // so since we loaded `current_`.
+    mutex_lock l(mu_);
+    if (current_.load(std::memory_order_relaxed) == chunk) {
+      ChunkHeader* new_chunk = pool_->AllocateChunk();
+      if (new_chunk == nullptr) {
+        return nullptr;
+      }
+      chunks_.push_back(new_chunk);
+      current_.store(new_chunk, std::memory_order_release);
+    }
+  }
+}
+
+void* StepArenaAllocator::AllocateDedicated(size_t alignment,
+                                            size_t num_bytes) {
+  DCHECK_LT(alignment, pool_->options_.chunk_size);
+  const size_t offset = RoundUp(kHeaderSize, alignment);
+  ChunkHeader* chunk =
+      pool_->NewChunk(offset + std::max<size_t>(num_bytes, 1), true);
+  if (chunk == nullptr) {
+    return nullptr;
+  }
+  chunk->num_live.store(1, std::memory_order_relaxed);
+  return reinterpret_cast<char*>(chunk) + offset;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  ChunkHeader* chunk = ChunkFor(ptr);
+  // NOTE: A pooled chunk may be recycled (and even freed) as soon as its live
+  // count drops to zero, so we must not touch it after the decrement.
+  const bool dedicated = chunk->dedicated;
+  if (chunk->num_live.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+      dedicated) {
+    pool_->base_allocator_->DeallocateRaw(chunk);
+  }
+}
+
+void StepArenaAllocator::Reset(std::vector<ChunkHeader*>* chunks) {
+  mutex_lock l(mu_);
+  chunks->insert(chunks->end(), chunks_.begin(), chunks_.end());
+  chunks_.clear();
+  current_.store(nullptr, std::memory_order_relaxed);
+  bytes_allocated_.store(0, std::memory_order_relaxed);
+}
+
+StepArenaPool::StepArenaPool(Allocator* base_allocator, const Options& options)
+    : base_allocator_(base_allocator), options_(options) {
+  CHECK_GT(options_.chunk_size, StepArenaAllocator::kHeaderSize);
+  CHECK_EQ(options_.chunk_size & (options_.chunk_size - 1), 0)
+      << "StepArenaPool chunk size must be a power of two.";
+}
+
+StepArenaPool::~StepArenaPool() {
+  mutex_lock l(mu_);
+  DCHECK_EQ(free_arenas_.size(), all_arenas_.size())
+      << "StepArenaPool destroyed while a step is still using an arena.";
+  for (ChunkHeader* chunk : free_chunks_) {
+    base_allocator_->DeallocateRaw(chunk);
+  }
+  bool leaked = false;
+  for (ChunkHeader* chunk : pinned_chunks_) {
+    if (chunk->num_live.load(std::memory_order_acquire) == 0) {
+      base_allocator_->DeallocateRaw(chunk);
+    } else {
+      leaked = true;
+    }
+  }
+  if (leaked) {
+    // Some tensors allocated from the arenas are still alive. Keep their
+    // chunks and their allocators around so that they can be safely
+    // deallocated later.
+    LOG(WARNING) << "StepArenaPool destroyed before all of its tensors were "
+                 << "deallocated; leaking the remaining chunks.";
+    return;
+  }
+  for (StepArenaAllocator* arena : all_arenas_) {
+    delete arena;
+  }
+}
+
+StepArenaAllocator* StepArenaPool::Acquire() {
+  mutex_lock l(mu_);
+  if (!free_arenas_.empty()) {
+    StepArenaAllocator* arena = free_arenas_.back();
+    free_arenas_.pop_back();
+    return arena;
+  }
+  StepArenaAllocator* arena = new StepArenaAllocator(this);
+  all_arenas_.push_back(arena);
+  return arena;
+}
+
+void StepArenaPool::Release(StepArenaAllocator* arena) {
+  std::vector<ChunkHeader*> chunks;
+  arena->Reset(&chunks);
+
+  mutex_lock l(mu_);
+  for (ChunkHeader* chunk : chunks) {
+    if (chunk->num_live.load(std::memory_order_acquire) == 0) {
+      RecycleChunkLocked(chunk);
+    } else {
+      pinned_chunks_.push_back(chunk);
+    }
+  }
+  // Reclaim the chunks of earlier steps whose escaping tensors have since
+  // been deallocated.
+  auto it = std::partition(
+      pinned_chunks_.begin(), pinned_chunks_.end(), [](ChunkHeader* chunk) {
+        return chunk->num_live.load(std::memory_order_acquire) != 0;
+      });
+  for (auto reclaim = it; reclaim != pinned_chunks_.end(); ++reclaim) {
+    RecycleChunkLocked(*reclaim);
+  }
+  pinned_chunks_.erase(it, pinned_chunks_.end());
+  free_arenas_.push_back(arena);
+}
+
+StepArenaPool::ChunkHeader* StepArenaPool::AllocateChunk() {
+  {
+    mutex_lock l(mu_);
+    if (!free_chunks_.empty()) {
+      ChunkHeader* chunk = free_chunks_.back();
+      free_chunks_.pop_back();
+      return chunk;
+    }
+  }
+  return NewChunk(options_.chunk_size, false);
+}
+
+StepArenaPool::ChunkHeader* StepArenaPool::NewChunk(size_t size,
+                                                    bool dedicated) {
+  void* mem = base_allocator_->AllocateRaw(options_.chunk_size, size);
+  if (mem == nullptr) {
+    return nullptr;
+  }
+  if ((reinterpret_cast<uintptr_t>(mem) & (options_.chunk_size - 1)) != 0) {
+    // `ChunkFor()` relies on chunks being aligned to their size.
+    LOG(ERROR) << base_allocator_->Name() << " does not support "
+               << options_.chunk_size << "-byte aligned allocations, which "
+               << "are required by StepArenaPool.";
+    base_allocator_->DeallocateRaw(mem);
+    return nullptr;
+  }
+  ChunkHeader* chunk = new (mem) ChunkHeader;
+  chunk->num_live.store(0, std::memory_order_relaxed);
+  chunk->offset.store(StepArenaAllocator::kHeaderSize,
+                      std::memory_order_relaxed);
+  chunk->size = size;
+  chunk->dedicated = dedicated;
+  return chunk;
+}
+
+void StepArenaPool::RecycleChunkLocked(ChunkHeader* chunk) {
+  DCHECK(!chunk->dedicated);
+  if (static_cast<int64>((free_chunks_.size() + 1) * options_.chunk_size) >
+      options_.max_cached_bytes) {
+    base_allocator_->DeallocateRaw(chunk);
+    return;
+  }
+  chunk->offset.store(StepArenaAllocator::kHeaderSize,
+                      std::memory_order_relaxed);
+  free_chunks_.push_back(chunk);
+}
+
+int64 StepArenaPool::num_cached_chunks() const {
+  mutex_lock l(mu_);
+  return free_chunks_.size();
+}
+
+int64 StepArenaPool::num_pinned_chunks() const {
+  mutex_lock l(mu_);
+  return pinned_chunks_.size();
+}
+
+}  // namespace tensorflow
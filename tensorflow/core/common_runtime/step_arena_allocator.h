@@ -0,0 +1,186 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class StepArenaPool;
+
+// A bump-pointer allocator for tensors whose lifetime is bounded by a single
+// step (i.e. one `Executor::RunAsync()` call).
+//
+// Memory is carved out of large, aligned chunks that are obtained from a
+// `StepArenaPool`. Allocation is a single atomic increment on the current
+// chunk in the common case, and deallocation only decrements the number of
+// live allocations in the owning chunk (which is found by masking the
+// pointer). When the step ends, `StepArenaPool::Release()` recycles every
+// chunk in one shot.
+//
+// Tensors allocated from the arena may safely outlive the step: a chunk that
+// still has live allocations when the arena is released is "pinned", and is
+// only recycled once its last allocation has been deallocated. The executor
+// therefore only uses the arena for nodes whose outputs are not expected to
+// escape the step, but escaping tensors cost memory rather than correctness.
+//
+// Allocations that are too large for a chunk, or that would exceed the
+// per-step budget of the pool, are served by a dedicated chunk that is
+// returned to the underlying allocator as soon as it is deallocated.
+class StepArenaAllocator : public Allocator {
+ public:
+  ~StepArenaAllocator() override;
+
+  string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Returns the number of bytes handed out from pooled chunks since the arena
+  // was acquired. Dedicated chunks do not count towards this number.
+  int64 bytes_allocated() const {
+    return bytes_allocated_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class StepArenaPool;
+
+  // Header stored at the start of every chunk. The payload starts at
+  // `kHeaderSize` bytes from the start of the chunk.
+  struct ChunkHeader {
+    std::atomic<int64> num_live;  // Number of live allocations.
+    std::atomic<size_t> offset;   // Next free byte, relative to the chunk.
+    size_t size;                  // Total size of the chunk in bytes.
+    bool dedicated;               // True iff the chunk holds one allocation.
+  };
+  static constexpr size_t kHeaderSize = Allocator::kAllocatorAlignment;
+  static_assert(sizeof(ChunkHeader) <= kHeaderSize,
+                "ChunkHeader does not fit in the chunk header.");
+
+  explicit StepArenaAllocator(StepArenaPool* pool);
+
+  // Returns the header of the chunk that contains `ptr`.
+  ChunkHeader* ChunkFor(void* ptr) const;
+
+  // Tries to bump-allocate `num_bytes` with the given alignment from `chunk`.
+  // Returns nullptr if the chunk does not have enough space left.
+  static void* AllocateFromChunk(ChunkHeader* chunk, size_t alignment,
+                                 size_t num_bytes);
+
+  void* AllocateDedicated(size_t alignment, size_t num_bytes);
+
+  // Resets the arena so that it may be reused by a subsequent step, and
+  // appends the chunks that it used to `*chunks`.
+  void Reset(std::vector<ChunkHeader*>* chunks);
+
+  StepArenaPool* const pool_;  // Not owned.
+
+  std::atomic<ChunkHeader*> current_;
+  std::atomic<int64> bytes_allocated_;
+
+  mutex mu_;
+  std::vector<ChunkHeader*> chunks_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+// Owns the chunks and the `StepArenaAllocator` objects used by the steps that
+// run on one device. A pool is long-lived (its lifetime is that of the
+// device), and the arenas that it hands out are reused across steps, because
+// tensors that outlive a step keep a pointer to their allocator.
+//
+// Example:
+//
+//   StepArenaPool pool(cpu_allocator(), StepArenaPool::Options());
+//   StepArenaAllocator* arena = pool.Acquire();
+//   ... allocate step-local tensors from `arena` ...
+//   pool.Release(arena);
+class StepArenaPool {
+ public:
+  struct Options {
+    // Size of the chunks that are carved up by the arenas. Must be a power of
+    // two, because chunks are aligned to their size.
+    size_t chunk_size = 1 << 20;
+
+    // Maximum number of bytes that one step may bump-allocate from pooled
+    // chunks. Allocations beyond the budget are served by dedicated chunks.
+    int64 max_bytes_per_step = 64 << 20;
+
+    // Maximum number of bytes of free chunks retained by the pool between
+    // steps.
+    int64 max_cached_bytes = 256 << 20;
+  };
+
+  // `base_allocator` must outlive the pool.
+  StepArenaPool(Allocator* base_allocator, const Options& options);
+  ~StepArenaPool();
+
+  // Returns an arena for the exclusive use of one step.
+  StepArenaAllocator* Acquire();
+
+  // Returns `arena` to the pool, and recycles all of its chunks that no longer
+  // contain live allocations. Chunks that remain in use are pinned until their
+  // allocations have been deallocated.
+  //
+  // REQUIRES: `arena` was returned by `Acquire()` on this pool, and no further
+  // allocations will be made from it.
+  void Release(StepArenaAllocator* arena);
+
+  const Options& options() const { return options_; }
+
+  // For testing and debugging only.
+  int64 num_cached_chunks() const;
+  int64 num_pinned_chunks() const;
+
+ private:
+  friend class StepArenaAllocator;
+
+  using ChunkHeader = StepArenaAllocator::ChunkHeader;
+
+  // Returns a chunk of `options_.chunk_size` bytes, either from the free list
+  // or from the base allocator.
+  ChunkHeader* AllocateChunk();
+
+  // Allocates a chunk of `size` bytes from the base allocator, aligned to
+  // `options_.chunk_size`.
+  ChunkHeader* NewChunk(size_t size, bool dedicated);
+
+  // Returns `chunk` to the free list, or to the base allocator if it is a
+  // dedicated chunk or the free list is full.
+  void RecycleChunkLocked(ChunkHeader* chunk) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_allocator_;  // Not owned.
+  const Options options_;
+
+  mutable mutex mu_;
+  std::vector<ChunkHeader*> free_chunks_ TF_GUARDED_BY(mu_);
+  std::vector<ChunkHeader*> pinned_chunks_ TF_GUARDED_BY(mu_);
+  std::vector<StepArenaAllocator*> free_arenas_ TF_GUARDED_BY(mu_);
+  std::vector<StepArenaAllocator*> all_arenas_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaPool);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
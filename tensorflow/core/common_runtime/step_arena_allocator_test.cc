@@ -0,0 +1,185 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+StepArenaPool::Options SmallChunks() {
+  StepArenaPool::Options options;
+  options.chunk_size = 1 << 16;
+  return options;
+}
+
+TEST(StepArenaAllocatorTest, AllocateAndRecycle) {
+  StepArenaPool pool(cpu_allocator_base(), SmallChunks());
+  StepArenaAllocator* arena = pool.Acquire();
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(nullptr, ptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) %
+                     Allocator::kAllocatorAlignment);
+    memset(ptr, i, 100);
+    ptrs.push_back(ptr);
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(static_cast<char>(i), static_cast<char*>(ptrs[i])[99]);
+    arena->DeallocateRaw(ptrs[i]);
+  }
+  pool.Release(arena);
+  EXPECT_EQ(0, pool.num_pinned_chunks());
+  EXPECT_EQ(1, pool.num_cached_chunks());
+
+  // The next step reuses both the arena and its chunk.
+  StepArenaAllocator* next = pool.Acquire();
+  EXPECT_EQ(arena, next);
+  void* ptr = next->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_EQ(ptrs[0], ptr);
+  EXPECT_EQ(0, pool.num_cached_chunks());
+  next->DeallocateRaw(ptr);
+  pool.Release(next);
+}
+
+TEST(StepArenaAllocatorTest, LargeAlignment) {
+  StepArenaPool pool(cpu_allocator_base(), SmallChunks());
+  StepArenaAllocator* arena = pool.Acquire();
+  void* a = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1);
+  void* b = arena->AllocateRaw(1024, 1);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) % 1024);
+  EXPECT_NE(a, b);
+  arena->DeallocateRaw(a);
+  arena->DeallocateRaw(b);
+  pool.Release(arena);
+  EXPECT_EQ(0, pool.num_pinned_chunks());
+}
+
+TEST(StepArenaAllocatorTest, EscapingTensorPinsChunk) {
+  StepArenaPool pool(cpu_allocator_base(), SmallChunks());
+  StepArenaAllocator* arena = pool.Acquire();
+  std::unique_ptr<Tensor> escaped(
+      new Tensor(arena, DT_FLOAT, TensorShape({4})));
+  test::FillValues<float>(escaped.get(), {1, 2, 3, 4});
+  pool.Release(arena);
+  EXPECT_EQ(1, pool.num_pinned_chunks());
+  EXPECT_EQ(0, pool.num_cached_chunks());
+
+  // The chunk is not reused while the tensor is alive.
+  arena = pool.Acquire();
+  Tensor t(arena, DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&t, {5, 6, 7, 8});
+  test::ExpectTensorEqual<float>(
+      *escaped, test::AsTensor<float>({1, 2, 3, 4}, TensorShape({4})));
+  t = Tensor();
+  escaped.reset();
+  pool.Release(arena);
+  EXPECT_EQ(0, pool.num_pinned_chunks());
+  EXPECT_EQ(2, pool.num_cached_chunks());
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsUseDedicatedChunks) {
+  StepArenaPool pool(cpu_allocator_base(), SmallChunks());
+  StepArenaAllocator* arena = pool.Acquire();
+  const size_t large = 1 << 20;
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, large);
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0, large);
+  EXPECT_EQ(0, arena->bytes_allocated());
+  arena->DeallocateRaw(ptr);
+  pool.Release(arena);
+  EXPECT_EQ(0, pool.num_pinned_chunks());
+  EXPECT_EQ(0, pool.num_cached_chunks());
+}
+
+TEST(StepArenaAllocatorTest, StepBudget) {
+  StepArenaPool::Options options = SmallChunks();
+  options.max_bytes_per_step = 1 << 16;
+  StepArenaPool pool(cpu_allocator_base(), options);
+  StepArenaAllocator* arena = pool.Acquire();
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+    ASSERT_NE(nullptr, ptr);
+    ptrs.push_back(ptr);
+  }
+  // Once the budget is exhausted, allocations no longer grow the arena.
+  EXPECT_LE(arena->bytes_allocated(), options.max_bytes_per_step);
+  for (void* ptr : ptrs) {
+    arena->DeallocateRaw(ptr);
+  }
+  pool.Release(arena);
+  EXPECT_EQ(0, pool.num_pinned_chunks());
+  EXPECT_LE(pool.num_cached_chunks(), 2);
+}
+
+TEST(StepArenaAllocatorTest, ConcurrentAllocations) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumAllocations = 1000;
+  StepArenaPool pool(cpu_allocator_base(), SmallChunks());
+  StepArenaAllocator* arena = pool.Acquire();
+  std::vector<std::vector<Tensor>> tensors(kNumThreads);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back(
+          Env::Default()->StartThread(ThreadOptions(), "alloc", [&, i]() {
+            for (int j = 0; j < kNumAllocations; ++j) {
+              Tensor t(arena, DT_INT32, TensorShape({j % 17 + 1}));
+              t.flat<int32>().setConstant(i * kNumAllocations + j);
+              if (j % 2 == 0) tensors[i].push_back(t);
+            }
+          }));
+    }
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumAllocations / 2; ++j) {
+      const Tensor& t = tensors[i][j];
+      EXPECT_EQ(i * kNumAllocations + 2 * j, t.flat<int32>()(0));
+      EXPECT_EQ(i * kNumAllocations + 2 * j,
+                t.flat<int32>()(t.NumElements() - 1));
+    }
+  }
+  tensors.clear();
+  pool.Release(arena);
+  EXPECT_EQ(0, pool.num_pinned_chunks());
+}
+
+static void BM_StepArenaAllocateDeallocate(int iters, int num_bytes) {
+  StepArenaPool pool(cpu_allocator_base(), StepArenaPool::Options());
+  StepArenaAllocator* arena = pool.Acquire();
+  for (int i = 0; i < iters; ++i) {
+    arena->DeallocateRaw(
+        arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes));
+    if (i % 1024 == 1023) {
+      pool.Release(arena);
+      arena = pool.Acquire();
+    }
+  }
+  pool.Release(arena);
+}
+BENCHMARK(BM_StepArenaAllocateDeallocate)->Arg(64)->Arg(4096);
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifdef INTEL_MKL
@@ -50,6 +53,22 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  // Step arenas are disabled by default. When enabled, TF_CPU_STEP_ARENA_MB
+  // bounds the number of megabytes that one step may bump-allocate.
+  int64 step_arena_mb = 0;
+  Status s = ReadInt64FromEnvVar("TF_CPU_STEP_ARENA_MB", 0, &step_arena_mb);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  } else if (step_arena_mb > 0) {
+    StepArenaPool::Options arena_options;
+    arena_options.max_bytes_per_step = step_arena_mb << 20;
+    arena_options.max_cached_bytes =
+        std::max(arena_options.max_cached_bytes, step_arena_mb << 20);
+    // The arena chunks must be aligned to their size, which the default CPU
+    // allocator (unlike e.g. BFC-backed allocators) guarantees.
+    step_arena_pool_.reset(
+        new StepArenaPool(cpu_allocator_base(), arena_options));
+  }
 #if !defined(ENABLE_MKLDNN_THREADPOOL) && defined(INTEL_MKL)
   // Early return when MKL is disabled
   if (DisableMKL()) return;
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 
 namespace tensorflow {
 
@@ -42,11 +43,16 @@ class ThreadPoolDevice : public LocalDevice {
                               const DeviceContext* device_context,
                               StatusCallback done) override;
 
+  StepArenaPool* step_arena_pool() override { return step_arena_pool_.get(); }
+
   Status Sync() override { return Status::OK(); }
 
  private:
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+  // Non-null iff step arenas are enabled with the TF_CPU_STEP_ARENA_MB
+  // environment variable.
+  std::unique_ptr<StepArenaPool> step_arena_pool_;
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,201 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+#include "tensorflow/core/lib/gtl/manual_constructor.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// WorkStealingQueue is a fixed-capacity, lock-free double-ended queue used by
+// the work-stealing executor to keep ready nodes on the thread that produced
+// them.
+//
+// A single owner thread pushes and pops elements at the front of the queue
+// (LIFO order, which maximizes cache locality for the owner), while any number
+// of thief threads may concurrently steal elements from the back of the queue
+// (FIFO order, which tends to steal the oldest and therefore largest pieces of
+// work).
+//
+// Each slot carries its own state word. A thread only reads or writes the
+// element stored in a slot after it has moved the slot to `kBusy` with a
+// compare-and-swap, so element accesses never race with each other. Because
+// the capacity is fixed, `PushFront()` fails instead of growing the buffer when
+// the queue is full; callers are expected to fall back to another dispatch
+// mechanism in that case.
+//
+// Example:
+//
+//   WorkStealingQueue<Task, 64> q;
+//   // Owner thread:
+//   if (!q.PushFront(task)) RunElsewhere(task);
+//   Task t;
+//   while (q.PopFront(&t)) Run(t);
+//   // Any other thread:
+//   if (q.PopBack(&t)) Run(t);
+template <typename T, int kCapacity>
+class WorkStealingQueue {
+ public:
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "WorkStealingQueue capacity must be a power of two.");
+
+  WorkStealingQueue() : front_(0), back_(0) {
+    for (int i = 0; i < kCapacity; ++i) {
+      slots_[i].state.store(kEmpty, std::memory_order_relaxed);
+    }
+  }
+
+  ~WorkStealingQueue() {
+    // NOTE: Elements are only ever constructed in `kReady` slots, so any
+    // left-over elements can be destroyed without synchronization because the
+    // queue is no longer shared at this point.
+    for (int i = 0; i < kCapacity; ++i) {
+      if (slots_[i].state.load(std::memory_order_relaxed) == kReady) {
+        slots_[i].value.Destroy();
+      }
+    }
+  }
+
+  // Adds `value` to the front of the queue. Returns false if the queue is full.
+  //
+  // REQUIRES: Only called by the owner thread.
+  bool PushFront(const T& value) {
+    const int64 front = front_.load(std::memory_order_relaxed);
+    Slot* slot = &slots_[front & kMask];
+    uint8 state = kEmpty;
+    if (!slot->state.compare_exchange_strong(state, kBusy,
+                                             std::memory_order_acquire)) {
+      // The slot still holds an element that has not been stolen yet, or a
+      // thief is in the process of taking it.
+      return false;
+    }
+    slot->value.Init(value);
+    // Publish the slot before advancing `front_` so that a thief which observes
+    // the new front will also observe the element.
+    slot->state.store(kReady, std::memory_order_release);
+    front_.store(front + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Removes the element at the front of the queue and stores it in `*value`.
+  // Returns false if the queue is empty.
+  //
+  // REQUIRES: Only called by the owner thread.
+  bool PopFront(T* value) {
+    const int64 front = front_.load(std::memory_order_relaxed);
+    while (true) {
+      if (back_.load(std::memory_order_acquire) >= front) return false;
+      Slot* slot = &slots_[(front - 1) & kMask];
+      uint8 state = kReady;
+      if (slot->state.compare_exchange_strong(state, kBusy,
+                                              std::memory_order_acquire)) {
+        // We own the slot. A thief may have already claimed the previous
+        // element (which advances `back_` past `front - 1`), in which case the
+        // slot we now hold belongs to the next lap of the ring and must be
+        // given back untouched.
+        if (back_.load(std::memory_order_acquire) >= front) {
+          slot->state.store(kReady, std::memory_order_release);
+          return false;
+        }
+        front_.store(front - 1, std::memory_order_release);
+        *value = std::move(*slot->value);
+        slot->value.Destroy();
+        slot->state.store(kEmpty, std::memory_order_release);
+        return true;
+      }
+      // A thief holds the slot. Either it will take the element (and advance
+      // `back_`), or it will give the slot back shortly; retry in both cases.
+    }
+  }
+
+  // Removes the element at the back of the queue and stores it in `*value`.
+  // Returns false if the queue is (or appears to be) empty.
+  //
+  // May be called concurrently from any number of threads, including the
+  // owner thread.
+  bool PopBack(T* value) {
+    while (true) {
+      int64 back = back_.load(std::memory_order_acquire);
+      if (back >= front_.load(std::memory_order_acquire)) return false;
+      Slot* slot = &slots_[back & kMask];
+      uint8 state = kReady;
+      if (!slot->state.compare_exchange_strong(state, kBusy,
+                                               std::memory_order_acquire)) {
+        // Another thread is operating on the slot (or has just emptied it).
+        // Re-read `back_` and retry.
+        continue;
+      }
+      if (!back_.compare_exchange_strong(back, back + 1,
+                                         std::memory_order_acq_rel)) {
+        // Another thief has already taken the element at `back`, and the slot
+        // we hold belongs to a later lap of the ring. Give it back.
+        slot->state.store(kReady, std::memory_order_release);
+        continue;
+      }
+      *value = std::move(*slot->value);
+      slot->value.Destroy();
+      slot->state.store(kEmpty, std::memory_order_release);
+      return true;
+    }
+  }
+
+  // Returns the approximate number of elements in the queue. The result is
+  // only exact when the queue is not being concurrently modified.
+  int64 Size() const {
+    const int64 size = front_.load(std::memory_order_acquire) -
+                       back_.load(std::memory_order_acquire);
+    return size < 0 ? 0 : size;
+  }
+
+  // Returns true if the queue was (approximately) empty.
+  bool Empty() const { return Size() == 0; }
+
+  static constexpr int capacity() { return kCapacity; }
+
+ private:
+  static constexpr int64 kMask = kCapacity - 1;
+
+  enum : uint8 {
+    kEmpty,  // The slot does not hold an element.
+    kBusy,   // A thread is reading or writing the element in the slot.
+    kReady,  // The slot holds an element that may be popped or stolen.
+  };
+
+  struct Slot {
+    std::atomic<uint8> state;
+    gtl::ManualConstructor<T> value;
+  };
+
+  // `front_` is only modified by the owner thread, and `back_` is modified by
+  // thieves (and by the owner when it steals from itself). The elements in the
+  // queue occupy positions [back_, front_). Positions grow monotonically and
+  // are mapped to slots modulo `kCapacity`.
+  std::atomic<int64> front_;
+  char padding_[64 - sizeof(std::atomic<int64>)];
+  std::atomic<int64> back_;
+  Slot slots_[kCapacity];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
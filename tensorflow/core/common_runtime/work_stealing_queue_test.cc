@@ -0,0 +1,151 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueueTest, OwnerIsLifo) {
+  WorkStealingQueue<int, 8> q;
+  EXPECT_TRUE(q.Empty());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(q.PushFront(i));
+  }
+  EXPECT_EQ(5, q.Size());
+  int v = -1;
+  for (int i = 4; i >= 0; --i) {
+    ASSERT_TRUE(q.PopFront(&v));
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_FALSE(q.PopFront(&v));
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingQueueTest, ThiefIsFifo) {
+  WorkStealingQueue<int, 8> q;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(q.PushFront(i));
+  }
+  int v = -1;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(q.PopBack(&v));
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_FALSE(q.PopBack(&v));
+}
+
+TEST(WorkStealingQueueTest, Full) {
+  WorkStealingQueue<int, 4> q;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(q.PushFront(i));
+  }
+  EXPECT_FALSE(q.PushFront(4));
+  int v = -1;
+  ASSERT_TRUE(q.PopBack(&v));
+  EXPECT_EQ(0, v);
+  // Stealing from the back frees up a slot for the owner.
+  EXPECT_TRUE(q.PushFront(4));
+  ASSERT_TRUE(q.PopFront(&v));
+  EXPECT_EQ(4, v);
+}
+
+TEST(WorkStealingQueueTest, Wraparound) {
+  WorkStealingQueue<int, 4> q;
+  int v = -1;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(q.PushFront(i));
+    EXPECT_TRUE(q.PushFront(i + 1000));
+    ASSERT_TRUE(q.PopBack(&v));
+    EXPECT_EQ(i, v);
+    ASSERT_TRUE(q.PopFront(&v));
+    EXPECT_EQ(i + 1000, v);
+  }
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingQueueTest, NonTrivialElements) {
+  // Use a reference-counted element to check that elements are constructed
+  // and destroyed exactly once.
+  WorkStealingQueue<std::shared_ptr<int>, 4> sq;
+  auto value = std::make_shared<int>(17);
+  EXPECT_TRUE(sq.PushFront(value));
+  EXPECT_TRUE(sq.PushFront(value));
+  EXPECT_EQ(3, value.use_count());
+  std::shared_ptr<int> out;
+  ASSERT_TRUE(sq.PopBack(&out));
+  EXPECT_EQ(17, *out);
+  out.reset();
+  EXPECT_EQ(2, value.use_count());
+  // The remaining element is released when the queue is destroyed.
+}
+
+TEST(WorkStealingQueueTest, ConcurrentStealing) {
+  constexpr int kNumElements = 100000;
+  constexpr int kNumThieves = 4;
+  WorkStealingQueue<int, 64> q;
+  std::vector<std::atomic<int>> seen(kNumElements);
+  for (auto& s : seen) s = 0;
+  std::atomic<bool> done(false);
+
+  std::vector<std::unique_ptr<Thread>> thieves;
+  for (int i = 0; i < kNumThieves; ++i) {
+    thieves.emplace_back(
+        Env::Default()->StartThread(ThreadOptions(), "thief", [&]() {
+          int v;
+          while (!done.load()) {
+            if (q.PopBack(&v)) seen[v]++;
+          }
+          while (q.PopBack(&v)) seen[v]++;
+        }));
+  }
+
+  int v;
+  for (int i = 0; i < kNumElements; ++i) {
+    while (!q.PushFront(i)) {
+      if (q.PopFront(&v)) seen[v]++;
+    }
+    if (i % 3 == 0 && q.PopFront(&v)) seen[v]++;
+  }
+  while (q.PopFront(&v)) seen[v]++;
+  done = true;
+  thieves.clear();
+
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(1, seen[i].load()) << "element " << i;
+  }
+  EXPECT_TRUE(q.Empty());
+}
+
+static void BM_PushPopFront(int iters) {
+  WorkStealingQueue<int, 256> q;
+  int v;
+  for (int i = 0; i < iters; ++i) {
+    q.PushFront(i);
+    q.PopFront(&v);
+  }
+}
+BENCHMARK(BM_PushPopFront);
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,12 +20,13 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
 
-Status CompressElement(const std::vector<Tensor>& element,
-                       CompressedElement* out) {
-  // Step 1: Determine the total uncompressed size. This requires serializing
-  // non-memcopyable tensors, which we save to use again later.
-  std::vector<TensorProto> non_memcpy_components;
+// Returns the total uncompressed size of `element`. This requires serializing
+// its non-memcopyable tensors, which are saved to `non_memcpy_components` to
+// be used again by `WriteElement`.
+int64 UncompressedSize(const std::vector<Tensor>& element,
+                       std::vector<TensorProto>& non_memcpy_components) {
   int64 total_size = 0;
   for (auto& component : element) {
     if (DataTypeCanUseMemcpy(component.dtype())) {
@@ -38,13 +39,16 @@ Status CompressElement(const std::vector<Tensor>& element,
       total_size += non_memcpy_components.back().ByteSizeLong();
     }
   }
+  return total_size;
+}
 
-  // Step 2: Write the tensor data to a buffer, and compress that buffer.
-  // We use tstring for access to resize_uninitialized.
-  tstring uncompressed;
-  uncompressed.resize_uninitialized(total_size);
-  // Position in `uncompressed` to write the next component.
-  char* position = uncompressed.mdata();
+// Writes the tensor data of `element` to `dst`, which must hold its
+// uncompressed size, and the metadata of its components to `out`.
+void WriteElement(const std::vector<Tensor>& element,
+                  const std::vector<TensorProto>& non_memcpy_components,
+                  char* dst, CompressedElement* out) {
+  // Position in `dst` to write the next component.
+  char* position = dst;
   int non_memcpy_component_index = 0;
   for (auto& component : element) {
     CompressedComponentMetadata* metadata =
@@ -56,23 +60,60 @@ Status CompressElement(const std::vector<Tensor>& element,
       memcpy(position, buffer->data(), buffer->size());
       metadata->set_tensor_size_bytes(buffer->size());
     } else {
-      TensorProto& proto = non_memcpy_components[non_memcpy_component_index++];
+      const TensorProto& proto =
+          non_memcpy_components[non_memcpy_component_index++];
       proto.SerializeToArray(position, proto.ByteSizeLong());
       metadata->set_tensor_size_bytes(proto.ByteSizeLong());
     }
     position += metadata->tensor_size_bytes();
   }
-  DCHECK_EQ(position, uncompressed.mdata() + total_size);
+}
+
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       absl::string_view compression, CompressedElement* out) {
+  if (compression != kSnappyCompression && compression != kNoCompression &&
+      compression != kAutoCompression) {
+    return errors::InvalidArgument("Unsupported element compression: ",
+                                   compression);
+  }
+  // Step 1: Determine the total uncompressed size.
+  std::vector<TensorProto> non_memcpy_components;
+  const int64 total_size = UncompressedSize(element, non_memcpy_components);
 
+  // Step 2: Write the tensor data to a buffer, and compress that buffer.
+  if (compression == kNoCompression) {
+    std::string* data = out->mutable_data();
+    data->resize(total_size);
+    WriteElement(element, non_memcpy_components, &(*data)[0], out);
+    out->set_compression(CompressedElement::NONE);
+    return Status::OK();
+  }
+  // We use tstring for access to resize_uninitialized.
+  tstring uncompressed;
+  uncompressed.resize_uninitialized(total_size);
+  WriteElement(element, non_memcpy_components, uncompressed.mdata(), out);
   if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
                              out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
           << out->data().size() << " bytes";
+  if (compression == kAutoCompression &&
+      out->data().size() > kAutoCompressionMaxRatio * total_size) {
+    VLOG(3) << "Sending the element uncompressed instead";
+    out->set_data(uncompressed.data(), total_size);
+    out->set_compression(CompressedElement::NONE);
+  }
   return Status::OK();
 }
 
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement* out) {
+  return CompressElement(element, kSnappyCompression, out);
+}
+
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
   int num_components = compressed.component_metadata_size();
@@ -111,20 +152,35 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal("Could not get snappy uncompressed length");
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.compression() == CompressedElement::NONE) {
+    if (compressed_data.size() != static_cast<size_t>(total_size)) {
+      return errors::Internal(
+          "Uncompressed size mismatch. The element has ",
+          compressed_data.size(), " bytes whereas the tensor metadata ",
+          "suggests ", total_size);
+    }
+    const char* position = compressed_data.data();
+    for (int i = 0; i < num_components; ++i) {
+      memcpy(iov[i].iov_base, position, iov[i].iov_len);
+      position += iov[i].iov_len;
+    }
+  } else {
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                            compressed_data.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal("Could not get snappy uncompressed length");
+    }
+    if (uncompressed_size != static_cast<size_t>(total_size)) {
+      return errors::Internal(
+          "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+          " whereas the tensor metadata suggests ", total_size);
+    }
+    if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                        compressed_data.size(), iov.data(),
+                                        num_components)) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/platform/status.h"
@@ -22,10 +23,29 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
-// Compresses the components of `element` into the `CompressedElement` proto.
+// The compressions supported by `CompressElement`.
+//
+// Compresses every element with snappy.
+constexpr char kSnappyCompression[] = "SNAPPY";
+// Leaves elements uncompressed. This saves the CPU time spent compressing and
+// uncompressing elements when network bandwidth is not the bottleneck.
+constexpr char kNoCompression[] = "NONE";
+// Compresses elements with snappy, but leaves uncompressed the elements that
+// snappy does not shrink to at most `kAutoCompressionMaxRatio` of their size,
+// such as already encoded images, so that consumers don't spend time
+// uncompressing them.
+constexpr char kAutoCompression[] = "AUTO";
+constexpr double kAutoCompressionMaxRatio = 0.8;
+
+// Compresses the components of `element` into the `CompressedElement` proto,
+// using `compression`, which is one of the compressions above.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
+Status CompressElement(const std::vector<Tensor>& element,
+                       absl::string_view compression, CompressedElement* out);
+
+// Compresses the components of `element` with snappy.
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
@@ -49,5 +49,61 @@ std::vector<std::vector<Tensor>> TestCases() {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+class CompressionUtilsTest : public DatasetOpsTestBase {};
+
+TEST_F(CompressionUtilsTest, RoundTripWithEachCompression) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64>(TensorShape{64}, std::vector<int64>(64, 7)),
+      CreateTensor<tstring>(TensorShape{1}, {"a"})};
+  for (const char* compression :
+       {kSnappyCompression, kNoCompression, kAutoCompression}) {
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, compression, &compressed));
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(
+        ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+  }
+}
+
+TEST_F(CompressionUtilsTest, NoCompression) {
+  std::vector<Tensor> element =
+      CreateTensors<int64>(TensorShape{64}, {std::vector<int64>(64, 7)});
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, kNoCompression, &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::NONE);
+  EXPECT_EQ(compressed.data().size(), 64 * sizeof(int64));
+}
+
+TEST_F(CompressionUtilsTest, AutoCompressionCompressesCompressibleElements) {
+  std::vector<Tensor> element =
+      CreateTensors<int64>(TensorShape{64}, {std::vector<int64>(64, 7)});
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, kAutoCompression, &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::SNAPPY);
+  EXPECT_LT(compressed.data().size(), 64 * sizeof(int64));
+}
+
+TEST_F(CompressionUtilsTest, AutoCompressionSkipsIncompressibleElements) {
+  // A single byte does not compress.
+  std::vector<Tensor> element = CreateTensors<uint8>(TensorShape{1}, {{1}});
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, kAutoCompression, &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::NONE);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+TEST_F(CompressionUtilsTest, UnsupportedCompression) {
+  CompressedElement compressed;
+  EXPECT_EQ(
+      CompressElement(CreateTensors<int64>(TensorShape{1}, {{1}}), "ZSTD",
+                      &compressed)
+          .code(),
+      error::INVALID_ARGUMENT);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/cross_job_cache.h"
+
+#include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+
+CrossJobCache::CrossJobCache(Producer producer, int64 max_bytes)
+    : max_bytes_(max_bytes), producer_(std::move(producer)) {}
+
+Status CrossJobCache::GetNext(int64 consumer_id, std::vector<Tensor>& element,
+                              bool& end_of_sequence) {
+  mutex_lock l(mu_);
+  auto it = next_index_.find(consumer_id);
+  if (it == next_index_.end()) {
+    it = next_index_.emplace(consumer_id, window_start_).first;
+  }
+  int64& index = it->second;
+  if (index < window_start_) {
+    VLOG(2) << "Consumer " << consumer_id << " skips "
+            << window_start_ - index << " evicted elements";
+    num_skipped_elements_ += window_start_ - index;
+    index = window_start_;
+  }
+  if (index == window_start_ + static_cast<int64>(window_.size())) {
+    if (!producer_finished_) {
+      TF_RETURN_IF_ERROR(ProduceLocked());
+    }
+    if (producer_finished_) {
+      end_of_sequence = true;
+      return Status::OK();
+    }
+  }
+  element = window_[index - window_start_].components;
+  ++index;
+  end_of_sequence = false;
+  return Status::OK();
+}
+
+Status CrossJobCache::ProduceLocked() {
+  std::vector<Tensor> components;
+  bool end_of_sequence = false;
+  TF_RETURN_IF_ERROR(producer_(components, end_of_sequence));
+  if (end_of_sequence) {
+    producer_finished_ = true;
+    // Releases the iterator held by the producer.
+    producer_ = nullptr;
+    return Status::OK();
+  }
+  const int64 bytes = ElementBytes(components);
+  window_.push_back({std::move(components), bytes});
+  window_bytes_ += bytes;
+  while (window_bytes_ > max_bytes_ && window_.size() > 1) {
+    window_bytes_ -= window_.front().bytes;
+    window_.pop_front();
+    ++window_start_;
+  }
+  return Status::OK();
+}
+
+void CrossJobCache::RemoveConsumer(int64 consumer_id) {
+  mutex_lock l(mu_);
+  next_index_.erase(consumer_id);
+}
+
+bool CrossJobCache::producer_finished() const {
+  mutex_lock l(mu_);
+  return producer_finished_;
+}
+
+int64 CrossJobCache::num_skipped_elements() const {
+  mutex_lock l(mu_);
+  return num_skipped_elements_;
+}
+
+/* static */
+int64 CrossJobCache::ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& tensor : element) {
+    // The worker produces compressed elements wrapped in scalar variants,
+    // whose TotalBytes() only counts the Variant itself.
+    if (tensor.dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(tensor.shape())) {
+      const CompressedElement* compressed =
+          tensor.scalar<Variant>()().get<CompressedElement>();
+      if (compressed != nullptr) {
+        bytes += compressed->ByteSizeLong();
+        continue;
+      }
+    }
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_JOB_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CROSS_JOB_CACHE_H_
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A sliding window over the elements of one producer, shared by the tasks of
+// several jobs reading the same dataset, so that the dataset is only computed
+// once per worker.
+//
+// Each consumer reads the stream in order from its own position. A new
+// consumer starts at the oldest element still in the window. The window holds
+// at most `max_bytes` bytes of elements (and at least one element); when it is
+// full, producing a new element evicts the oldest one. Consumers whose next
+// element has been evicted skip ahead to the oldest element in the window,
+// so slow consumers never hold back fast ones.
+//
+// Late and slow consumers miss elements, so the cache is meant for datasets
+// which repeat indefinitely, such as the training input of a hyperparameter
+// sweep. Once the producer reaches the end of its sequence, every consumer
+// reads the rest of the window and then gets end_of_sequence.
+//
+// This class is thread-safe.
+class CrossJobCache {
+ public:
+  // Produces the next element, setting end_of_sequence at the end.
+  using Producer = std::function<Status(std::vector<Tensor>& element,
+                                        bool& end_of_sequence)>;
+
+  CrossJobCache(Producer producer, int64 max_bytes);
+
+  // Gets the next element for `consumer_id`.
+  Status GetNext(int64 consumer_id, std::vector<Tensor>& element,
+                 bool& end_of_sequence) TF_LOCKS_EXCLUDED(mu_);
+
+  // Forgets the position of `consumer_id`.
+  void RemoveConsumer(int64 consumer_id) TF_LOCKS_EXCLUDED(mu_);
+
+  // Whether the producer has reached the end of its sequence.
+  bool producer_finished() const TF_LOCKS_EXCLUDED(mu_);
+
+  // The total number of elements consumers skipped because they were evicted
+  // before the consumers read them.
+  int64 num_skipped_elements() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Estimates the memory held by `element`.
+  static int64 ElementBytes(const std::vector<Tensor>& element);
+
+ private:
+  struct CachedElement {
+    std::vector<Tensor> components;
+    int64 bytes;
+  };
+
+  // Appends the next element of the producer to the window, evicting the
+  // oldest elements beyond max_bytes_.
+  Status ProduceLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 max_bytes_;
+  mutable mutex mu_;
+  Producer producer_ TF_GUARDED_BY(mu_);
+  std::deque<CachedElement> window_ TF_GUARDED_BY(mu_);
+  // The stream index of the front of window_.
+  int64 window_start_ TF_GUARDED_BY(mu_) = 0;
+  int64 window_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool producer_finished_ TF_GUARDED_BY(mu_) = false;
+  // The stream index of the next element of each consumer.
+  absl::flat_hash_map<int64, int64> next_index_ TF_GUARDED_BY(mu_);
+  int64 num_skipped_elements_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CROSS_JOB_CACHE_H_
@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/cross_job_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64 kElementBytes = sizeof(int64);
+
+// Returns a producer of the int64 scalars 0, 1, ..., num_elements - 1, which
+// counts the elements it produced in `num_produced`.
+CrossJobCache::Producer RangeProducer(int64 num_elements,
+                                      int64* num_produced) {
+  return [num_elements, num_produced](std::vector<Tensor>& element,
+                                      bool& end_of_sequence) {
+    end_of_sequence = *num_produced == num_elements;
+    if (!end_of_sequence) {
+      element = {test::AsScalar<int64>((*num_produced)++)};
+    }
+    return Status::OK();
+  };
+}
+
+// Reads the next element of `consumer_id`, or -1 at the end of the sequence.
+int64 Next(CrossJobCache& cache, int64 consumer_id) {
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_CHECK_OK(cache.GetNext(consumer_id, element, end_of_sequence));
+  if (end_of_sequence) return -1;
+  CHECK_EQ(element.size(), 1);
+  return element[0].scalar<int64>()();
+}
+
+TEST(CrossJobCacheTest, ConsumersShareOneProducer) {
+  int64 num_produced = 0;
+  CrossJobCache cache(RangeProducer(3, &num_produced), 10 * kElementBytes);
+  for (int64 i = 0; i < 3; ++i) {
+    EXPECT_EQ(Next(cache, /*consumer_id=*/0), i);
+    EXPECT_EQ(Next(cache, /*consumer_id=*/1), i);
+  }
+  EXPECT_EQ(num_produced, 3);
+  EXPECT_EQ(Next(cache, 0), -1);
+  EXPECT_EQ(Next(cache, 1), -1);
+  EXPECT_TRUE(cache.producer_finished());
+  EXPECT_EQ(cache.num_skipped_elements(), 0);
+}
+
+TEST(CrossJobCacheTest, NewConsumerStartsAtOldestCachedElement) {
+  int64 num_produced = 0;
+  CrossJobCache cache(RangeProducer(10, &num_produced), 2 * kElementBytes);
+  for (int64 i = 0; i < 4; ++i) {
+    EXPECT_EQ(Next(cache, 0), i);
+  }
+  // Only elements 2 and 3 are still cached.
+  EXPECT_EQ(Next(cache, 1), 2);
+  EXPECT_EQ(Next(cache, 1), 3);
+  EXPECT_EQ(Next(cache, 1), 4);
+  EXPECT_EQ(Next(cache, 0), 4);
+  EXPECT_EQ(num_produced, 5);
+}
+
+TEST(CrossJobCacheTest, SlowConsumerSkipsEvictedElements) {
+  int64 num_produced = 0;
+  CrossJobCache cache(RangeProducer(10, &num_produced), 2 * kElementBytes);
+  EXPECT_EQ(Next(cache, 0), 0);
+  EXPECT_EQ(Next(cache, 1), 0);
+  for (int64 i = 1; i < 6; ++i) {
+    EXPECT_EQ(Next(cache, 0), i);
+  }
+  // Elements 1 to 3 were evicted before consumer 1 read them.
+  EXPECT_EQ(Next(cache, 1), 4);
+  EXPECT_EQ(cache.num_skipped_elements(), 3);
+}
+
+TEST(CrossJobCacheTest, KeepsOneElementLargerThanTheLimit) {
+  int64 num_produced = 0;
+  CrossJobCache cache(RangeProducer(2, &num_produced), /*max_bytes=*/1);
+  EXPECT_EQ(Next(cache, 0), 0);
+  EXPECT_EQ(Next(cache, 1), 0);
+  EXPECT_EQ(Next(cache, 0), 1);
+  EXPECT_EQ(Next(cache, 1), 1);
+  EXPECT_EQ(Next(cache, 0), -1);
+}
+
+TEST(CrossJobCacheTest, RemovedConsumerRestartsAtOldestCachedElement) {
+  int64 num_produced = 0;
+  CrossJobCache cache(RangeProducer(10, &num_produced), 2 * kElementBytes);
+  EXPECT_EQ(Next(cache, 0), 0);
+  EXPECT_EQ(Next(cache, 0), 1);
+  cache.RemoveConsumer(0);
+  EXPECT_EQ(Next(cache, 0), 0);
+}
+
+TEST(CrossJobCacheTest, PropagatesProducerErrors) {
+  CrossJobCache cache(
+      [](std::vector<Tensor>& element, bool& end_of_sequence) {
+        return errors::Internal("Producer failed");
+      },
+      kElementBytes);
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  EXPECT_EQ(cache.GetNext(0, element, end_of_sequence).code(),
+            error::INTERNAL);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
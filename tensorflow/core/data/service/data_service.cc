@@ -104,6 +104,25 @@ Status DataServiceDispatcherClient::GetDatasetDef(int64 dataset_id,
   return Status::OK();
 }
 
+Status DataServiceDispatcherClient::GetSplit(int64 task_id,
+                                             int64 previous_split_index,
+                                             int64& split_index,
+                                             bool& end_of_splits) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetSplitRequest req;
+  req.set_task_id(task_id);
+  req.set_previous_split_index(previous_split_index);
+  GetSplitResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get split", status);
+  }
+  split_index = resp.split_index();
+  end_of_splits = resp.end_of_splits();
+  return Status::OK();
+}
+
 Status DataServiceDispatcherClient::RegisterDataset(GraphDef dataset,
                                                     int64& dataset_id) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
@@ -86,6 +86,13 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // definition in `dataset_def`.
   Status GetDatasetDef(int64 dataset_id, DatasetDef& dataset_def);
 
+  // Gets the next split for the given task to process, after it finished
+  // processing `previous_split_index` (-1 for the first split). The split is
+  // stored in `split_index`. If the task has no more splits to process,
+  // `end_of_splits` will be `true`.
+  Status GetSplit(int64 task_id, int64 previous_split_index,
+                  int64& split_index, bool& end_of_splits);
+
   // Registers a dataset with the tf.data service, and stores the generated
   // dataset id in `dataset_id`.
   Status RegisterDataset(GraphDef dataset, int64& dataset_id);
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -51,6 +52,8 @@ namespace {
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
 // The name of the datasets directory inside the dispatcher's working directory.
 constexpr char kDatasetsDir[] = "datasets";
+// The default number of splits per worker for ONE_EPOCH jobs.
+constexpr int64 kDefaultSplitsPerWorker = 4;
 
 using Dataset = DispatcherState::Dataset;
 using Worker = DispatcherState::Worker;
@@ -187,6 +190,7 @@ Status DataServiceDispatcherImpl::RegisterWorker(
     task_def->set_dataset_id(job->dataset_id);
     task_def->set_job_id(job->job_id);
     task_def->set_task_id(task->task_id);
+    task_def->set_num_splits(job->num_splits);
   }
 
   VLOG(1) << "Registered worker at address " << request->worker_address();
@@ -228,6 +232,39 @@ Status DataServiceDispatcherImpl::GetDatasetDef(
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
+                                           GetSplitResponse* response) {
+  mutex_lock l(mu_);
+  int64 task_id = request->task_id();
+  std::shared_ptr<const Task> task;
+  TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
+  std::shared_ptr<const Job> job;
+  TF_RETURN_IF_ERROR(state_.JobFromId(task->job_id, job));
+  if (job->num_splits <= 0) {
+    return errors::FailedPrecondition("Job ", job->job_id,
+                                      " is not divided into splits.");
+  }
+  int64 split_index = task->split_index;
+  if (request->previous_split_index() == task->split_index) {
+    TF_RETURN_IF_ERROR(state_.NextSplitForTask(
+        task_id, config_.reissue_straggler_splits(), split_index));
+    Update update;
+    AcquireSplitUpdate* acquire_split = update.mutable_acquire_split();
+    acquire_split->set_task_id(task_id);
+    acquire_split->set_split_index(split_index);
+    TF_RETURN_IF_ERROR(Apply(update));
+  } else {
+    // The response to the previous request was lost, so return the same
+    // split again.
+    VLOG(1) << "Received a retried GetSplit request for task " << task_id;
+  }
+  response->set_split_index(split_index);
+  response->set_end_of_splits(split_index < 0);
+  VLOG(3) << "Task " << task_id << " acquired split " << split_index << " of "
+          << job->num_splits << " for job " << job->job_id;
+  return Status::OK();
+}
+
 Status DataServiceDispatcherImpl::GetOrRegisterDataset(
     const GetOrRegisterDatasetRequest* request,
     GetOrRegisterDatasetResponse* response) {
@@ -384,13 +421,22 @@ Status DataServiceDispatcherImpl::CreateJob(
     int64 dataset_id, ProcessingMode processing_mode,
     absl::optional<NamedJobKey> named_job_key, std::shared_ptr<const Job>& job)
     EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64 num_splits = 0;
   switch (processing_mode) {
     case ProcessingMode::PARALLEL_EPOCHS:
       break;
-    case ProcessingMode::ONE_EPOCH:
-      return errors::Unimplemented(
-          "CreateJob only supports the PARALLEL_EPOCHS job mode. "
-          "ONE_EPOCH is not currently supported.");
+    case ProcessingMode::ONE_EPOCH: {
+      // Dividing the epoch into more splits than workers lets fast workers
+      // take over the work that slow workers would otherwise do at the end of
+      // the epoch.
+      const int64 splits_per_worker = config_.splits_per_worker() > 0
+                                          ? config_.splits_per_worker()
+                                          : kDefaultSplitsPerWorker;
+      const int64 num_workers =
+          std::max<int64>(1, state_.ListWorkers().size());
+      num_splits = splits_per_worker * num_workers;
+      break;
+    }
     default:
       return errors::Unimplemented("ProcessingMode ",
                                    ProcessingModeToString(processing_mode),
@@ -402,6 +448,7 @@ Status DataServiceDispatcherImpl::CreateJob(
   create_job->set_job_id(job_id);
   create_job->set_dataset_id(dataset_id);
   create_job->set_processing_mode(ProcessingModeDef(processing_mode));
+  create_job->set_num_splits(num_splits);
   if (named_job_key.has_value()) {
     NamedJobKeyDef* key = create_job->mutable_named_job_key();
     key->set_name(named_job_key->name);
@@ -498,8 +545,12 @@ Status DataServiceDispatcherImpl::AssignTask(std::shared_ptr<const Task> task)
   ProcessTaskRequest req;
   TaskDef* task_def = req.mutable_task();
   task_def->set_dataset_id(task->dataset_id);
+  task_def->set_job_id(task->job_id);
   {
     mutex_lock l(mu_);
+    std::shared_ptr<const Job> job;
+    TF_RETURN_IF_ERROR(state_.JobFromId(task->job_id, job));
+    task_def->set_num_splits(job->num_splits);
     std::shared_ptr<const Dataset> dataset;
     TF_RETURN_IF_ERROR(state_.DatasetFromId(task->dataset_id, dataset));
     std::string dataset_key =
@@ -48,6 +48,9 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kFinishTask:
       FinishTask(update.finish_task());
       break;
+    case Update::kAcquireSplit:
+      AcquireSplit(update.acquire_split());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -84,7 +87,7 @@ void DispatcherState::CreateJob(const CreateJobUpdate& create_job) {
   }
   auto job = std::make_shared<Job>(job_id, create_job.dataset_id(),
                                    ProcessingMode(create_job.processing_mode()),
-                                   named_job_key);
+                                   named_job_key, create_job.num_splits());
   DCHECK(!jobs_.contains(job_id));
   jobs_[job_id] = job;
   tasks_by_job_[job_id] = std::vector<std::shared_ptr<Task>>();
@@ -146,6 +149,31 @@ void DispatcherState::FinishTask(const FinishTaskUpdate& finish_task) {
   jobs_[task->job_id]->finished = all_finished;
 }
 
+void DispatcherState::AcquireSplit(const AcquireSplitUpdate& acquire_split) {
+  auto& task = tasks_[acquire_split.task_id()];
+  DCHECK(task != nullptr);
+  auto& job = jobs_[task->job_id];
+  DCHECK(job != nullptr);
+  if (task->split_index >= 0) {
+    // The split is finished, even if a reissued copy is still being processed.
+    job->num_tasks_by_split.erase(task->split_index);
+  }
+  task->split_index = acquire_split.split_index();
+  if (task->split_index < 0) {
+    return;
+  }
+  if (task->split_index >= job->next_split) {
+    DCHECK_EQ(task->split_index, job->next_split);
+    job->next_split = task->split_index + 1;
+    job->num_tasks_by_split[task->split_index] = 1;
+  } else {
+    auto it = job->num_tasks_by_split.find(task->split_index);
+    if (it != job->num_tasks_by_split.end()) {
+      it->second++;
+    }
+  }
+}
+
 int64 DispatcherState::NextAvailableDatasetId() const {
   return next_available_dataset_id_;
 }
@@ -277,6 +305,29 @@ Status DispatcherState::TasksForWorker(
   return Status::OK();
 }
 
+Status DispatcherState::NextSplitForTask(int64 task_id, bool reissue_splits,
+                                         int64& split_index) const {
+  std::shared_ptr<const Task> task;
+  TF_RETURN_IF_ERROR(TaskFromId(task_id, task));
+  std::shared_ptr<const Job> job;
+  TF_RETURN_IF_ERROR(JobFromId(task->job_id, job));
+  if (job->next_split < job->num_splits) {
+    split_index = job->next_split;
+    return Status::OK();
+  }
+  if (reissue_splits) {
+    for (const auto& split_and_num_tasks : job->num_tasks_by_split) {
+      if (split_and_num_tasks.first != task->split_index &&
+          split_and_num_tasks.second == 1) {
+        split_index = split_and_num_tasks.first;
+        return Status::OK();
+      }
+    }
+  }
+  split_index = -1;
+  return Status::OK();
+}
+
 int64 DispatcherState::NextAvailableTaskId() const {
   return next_available_task_id_;
 }
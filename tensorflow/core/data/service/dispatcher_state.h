@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_STATE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_STATE_H_
 
+#include <map>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
@@ -96,19 +98,27 @@ class DispatcherState {
   // A job for processing a dataset.
   struct Job {
     explicit Job(int64 job_id, int64 dataset_id, ProcessingMode processing_mode,
-                 absl::optional<NamedJobKey> named_job_key)
+                 absl::optional<NamedJobKey> named_job_key, int64 num_splits)
         : job_id(job_id),
           dataset_id(dataset_id),
           processing_mode(processing_mode),
-          named_job_key(named_job_key) {}
+          named_job_key(named_job_key),
+          num_splits(num_splits) {}
 
     const int64 job_id;
     const int64 dataset_id;
     const ProcessingMode processing_mode;
     const absl::optional<NamedJobKey> named_job_key;
+    // The number of splits that the job is divided into, or 0 if each task
+    // processes the whole dataset.
+    const int64 num_splits;
     int64 num_clients = 0;
     int64 last_client_released_micros = -1;
     bool finished = false;
+    // The next split that no task has acquired yet.
+    int64 next_split = 0;
+    // The number of tasks processing each acquired but unfinished split.
+    std::map<int64, int64> num_tasks_by_split;
   };
 
   struct Task {
@@ -124,6 +134,8 @@ class DispatcherState {
     const int64 dataset_id;
     const std::string worker_address;
     bool finished = false;
+    // The split that the task is processing, or -1 if it has none.
+    int64 split_index = -1;
   };
 
   // Returns the next available dataset id.
@@ -169,6 +181,14 @@ class DispatcherState {
   // NOT_FOUND if there is no such worker.
   Status TasksForWorker(const absl::string_view worker_address,
                         std::vector<std::shared_ptr<const Task>>& tasks) const;
+  // Chooses the split that the given task should acquire once it finishes its
+  // current split, and stores it in `split_index`. This is the first split that
+  // no task acquired yet; once all the splits have been acquired and if
+  // `reissue_splits` is true, it is the first split that only one other task is
+  // still processing. If there is no such split, `split_index` is set to -1.
+  // Returns NOT_FOUND if there is no such task.
+  Status NextSplitForTask(int64 task_id, bool reissue_splits,
+                          int64& split_index) const;
 
  private:
   void RegisterDataset(const RegisterDatasetUpdate& register_dataset);
@@ -178,6 +198,7 @@ class DispatcherState {
   void ReleaseJobClient(const ReleaseJobClientUpdate& release_job_client);
   void CreateTask(const CreateTaskUpdate& create_task);
   void FinishTask(const FinishTaskUpdate& finish_task);
+  void AcquireSplit(const AcquireSplitUpdate& acquire_split);
 
   int64 next_available_dataset_id_ = 0;
   // Registered datasets, keyed by dataset ids.
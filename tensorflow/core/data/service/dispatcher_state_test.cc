@@ -81,6 +81,18 @@ Status CreateNamedJob(int64 job_id, int64 dataset_id, NamedJobKey named_job_key,
   return Status::OK();
 }
 
+Status CreateSplitJob(int64 job_id, int64 dataset_id, int64 num_splits,
+                      DispatcherState& state) {
+  Update update;
+  CreateJobUpdate* create_job = update.mutable_create_job();
+  create_job->set_job_id(job_id);
+  create_job->set_dataset_id(dataset_id);
+  create_job->set_processing_mode(ProcessingModeDef::ONE_EPOCH);
+  create_job->set_num_splits(num_splits);
+  TF_RETURN_IF_ERROR(state.Apply(update));
+  return Status::OK();
+}
+
 Status AcquireJobClientId(int64 job_id, int64 job_client_id,
                           DispatcherState& state) {
   Update update;
@@ -115,6 +127,19 @@ Status CreateTask(int64 task_id, int64 job_id, int64 dataset_id,
   return Status::OK();
 }
 
+// Chooses the next split for `task_id` and applies the corresponding update.
+Status AcquireSplit(int64 task_id, bool reissue_splits, DispatcherState& state,
+                    int64& split_index) {
+  TF_RETURN_IF_ERROR(
+      state.NextSplitForTask(task_id, reissue_splits, split_index));
+  Update update;
+  AcquireSplitUpdate* acquire_split = update.mutable_acquire_split();
+  acquire_split->set_task_id(task_id);
+  acquire_split->set_split_index(split_index);
+  TF_RETURN_IF_ERROR(state.Apply(update));
+  return Status::OK();
+}
+
 Status FinishTask(int64 task_id, DispatcherState& state) {
   Update update;
   FinishTaskUpdate* finish_task = update.mutable_finish_task();
@@ -467,5 +492,90 @@ TEST(DispatcherState, ReleaseJobClientId) {
   EXPECT_EQ(s.code(), error::NOT_FOUND);
 }
 
+TEST(DispatcherState, AcquireSplits) {
+  int64 job_id = 3;
+  int64 dataset_id = 10;
+  int64 task_id_1 = 8;
+  int64 task_id_2 = 9;
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(CreateSplitJob(job_id, dataset_id, /*num_splits=*/3, state));
+  TF_EXPECT_OK(CreateTask(task_id_1, job_id, dataset_id, "worker1", state));
+  TF_EXPECT_OK(CreateTask(task_id_2, job_id, dataset_id, "worker2", state));
+  {
+    std::shared_ptr<const Job> job;
+    TF_EXPECT_OK(state.JobFromId(job_id, job));
+    EXPECT_EQ(job->num_splits, 3);
+  }
+  // Fast tasks keep acquiring splits until there are none left.
+  int64 split_index;
+  TF_EXPECT_OK(AcquireSplit(task_id_1, /*reissue_splits=*/false, state,
+                            split_index));
+  EXPECT_EQ(split_index, 0);
+  TF_EXPECT_OK(AcquireSplit(task_id_2, /*reissue_splits=*/false, state,
+                            split_index));
+  EXPECT_EQ(split_index, 1);
+  TF_EXPECT_OK(AcquireSplit(task_id_1, /*reissue_splits=*/false, state,
+                            split_index));
+  EXPECT_EQ(split_index, 2);
+  TF_EXPECT_OK(AcquireSplit(task_id_1, /*reissue_splits=*/false, state,
+                            split_index));
+  EXPECT_EQ(split_index, -1);
+  std::shared_ptr<const Task> task;
+  TF_EXPECT_OK(state.TaskFromId(task_id_2, task));
+  EXPECT_EQ(task->split_index, 1);
+  std::shared_ptr<const Job> job;
+  TF_EXPECT_OK(state.JobFromId(job_id, job));
+  EXPECT_EQ(job->next_split, 3);
+  EXPECT_EQ(job->num_tasks_by_split.size(), 1);
+}
+
+TEST(DispatcherState, ReissueStragglerSplits) {
+  int64 job_id = 3;
+  int64 dataset_id = 10;
+  int64 task_id_1 = 8;
+  int64 task_id_2 = 9;
+  int64 task_id_3 = 10;
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(CreateSplitJob(job_id, dataset_id, /*num_splits=*/2, state));
+  TF_EXPECT_OK(CreateTask(task_id_1, job_id, dataset_id, "worker1", state));
+  TF_EXPECT_OK(CreateTask(task_id_2, job_id, dataset_id, "worker2", state));
+  TF_EXPECT_OK(CreateTask(task_id_3, job_id, dataset_id, "worker3", state));
+  int64 split_index;
+  TF_EXPECT_OK(AcquireSplit(task_id_1, /*reissue_splits=*/true, state,
+                            split_index));
+  EXPECT_EQ(split_index, 0);
+  TF_EXPECT_OK(AcquireSplit(task_id_2, /*reissue_splits=*/true, state,
+                            split_index));
+  EXPECT_EQ(split_index, 1);
+  // Task 1 finishes split 0 and takes over split 1 from straggling task 2.
+  TF_EXPECT_OK(AcquireSplit(task_id_1, /*reissue_splits=*/true, state,
+                            split_index));
+  EXPECT_EQ(split_index, 1);
+  // A split is reissued at most once.
+  TF_EXPECT_OK(AcquireSplit(task_id_3, /*reissue_splits=*/true, state,
+                            split_index));
+  EXPECT_EQ(split_index, -1);
+  // Once task 1 finishes split 1, task 2 has nothing left to do.
+  TF_EXPECT_OK(AcquireSplit(task_id_1, /*reissue_splits=*/true, state,
+                            split_index));
+  EXPECT_EQ(split_index, -1);
+  TF_EXPECT_OK(AcquireSplit(task_id_2, /*reissue_splits=*/true, state,
+                            split_index));
+  EXPECT_EQ(split_index, -1);
+  std::shared_ptr<const Job> job;
+  TF_EXPECT_OK(state.JobFromId(job_id, job));
+  EXPECT_TRUE(job->num_tasks_by_split.empty());
+}
+
+TEST(DispatcherState, NextSplitForMissingTask) {
+  DispatcherState state;
+  int64 split_index;
+  Status s = state.NextSplitForTask(/*task_id=*/1, /*reissue_splits=*/false,
+                                    split_index);
+  EXPECT_EQ(s.code(), error::NOT_FOUND);
+}
+
 }  // namespace data
 }  // namespace tensorflow
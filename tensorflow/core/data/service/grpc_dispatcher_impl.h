@@ -42,6 +42,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(RegisterWorker);
   HANDLER(WorkerUpdate);
   HANDLER(GetDatasetDef);
+  HANDLER(GetSplit);
   HANDLER(GetOrRegisterDataset);
   HANDLER(CreateJob);
   HANDLER(ReleaseJobClient);
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
 
+#include <memory>
+#include <string>
+
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker_impl.h"
@@ -31,9 +34,12 @@ class GrpcWorkerImpl : public WorkerService::Service {
   // `server_builder`.
   explicit GrpcWorkerImpl(const experimental::WorkerConfig& config,
                           ::grpc::ServerBuilder& server_builder);
-  ~GrpcWorkerImpl() override {}
+  ~GrpcWorkerImpl() override;
 
   Status Start(const std::string& worker_address);
+  // Stops serving elements to clients in the same process. Elements are still
+  // served over RPC until the gRPC server shuts down.
+  void Stop();
 
 #define HANDLER(method)                                 \
   ::grpc::Status method(::grpc::ServerContext* context, \
@@ -44,7 +50,10 @@ class GrpcWorkerImpl : public WorkerService::Service {
 #undef HANDLER
 
  private:
-  DataServiceWorkerImpl impl_;
+  std::string worker_address_;
+  // A shared pointer so that clients in the same process can keep using the
+  // worker during its shutdown. See `LocalWorkers`.
+  std::shared_ptr<DataServiceWorkerImpl> impl_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerImpl);
 };
@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/local_workers.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+
+namespace {
+
+using WorkerMap =
+    absl::flat_hash_map<std::string, std::shared_ptr<DataServiceWorkerImpl>>;
+
+mutex mu(LINKER_INITIALIZED);
+WorkerMap* workers TF_GUARDED_BY(mu) = new WorkerMap();
+
+}  // namespace
+
+void LocalWorkers::Add(const std::string& worker_address,
+                       std::shared_ptr<DataServiceWorkerImpl> worker) {
+  DCHECK(worker != nullptr) << "Adding a nullptr local worker is disallowed.";
+  VLOG(1) << "Register local worker at address " << worker_address;
+  mutex_lock l(mu);
+  (*workers)[worker_address] = std::move(worker);
+}
+
+std::shared_ptr<DataServiceWorkerImpl> LocalWorkers::Get(
+    const std::string& worker_address) {
+  tf_shared_lock l(mu);
+  auto it = workers->find(worker_address);
+  if (it == workers->end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void LocalWorkers::Remove(const std::string& worker_address) {
+  VLOG(1) << "Remove local worker at address " << worker_address;
+  mutex_lock l(mu);
+  workers->erase(worker_address);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_LOCAL_WORKERS_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_LOCAL_WORKERS_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/data/service/worker_impl.h"
+
+namespace tensorflow {
+namespace data {
+
+// Keeps track of the tf.data service workers running in the current process.
+//
+// Clients in the same process as a worker fetch elements by calling the
+// worker directly instead of sending RPCs to it, which avoids serializing the
+// elements and sending them through the loopback interface.
+//
+// This class is thread-safe.
+class LocalWorkers {
+ public:
+  // Registers `worker`, which is running at `worker_address`. Replaces any
+  // worker previously registered at the same address.
+  static void Add(const std::string& worker_address,
+                  std::shared_ptr<DataServiceWorkerImpl> worker);
+
+  // Returns the worker running at `worker_address`, or nullptr if there is no
+  // such worker in the current process.
+  static std::shared_ptr<DataServiceWorkerImpl> Get(
+      const std::string& worker_address);
+
+  // Unregisters the worker running at `worker_address`, if there is one.
+  static void Remove(const std::string& worker_address);
+
+ private:
+  LocalWorkers() = delete;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_LOCAL_WORKERS_H_
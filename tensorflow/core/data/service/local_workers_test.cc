@@ -0,0 +1,64 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/local_workers.h"
+
+#include <memory>
+
+#include "tensorflow/core/data/service/test_cluster.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(LocalWorkers, AddGetRemove) {
+  const std::string address = "local_workers_test:1";
+  EXPECT_EQ(nullptr, LocalWorkers::Get(address));
+  auto worker =
+      std::make_shared<DataServiceWorkerImpl>(experimental::WorkerConfig());
+  LocalWorkers::Add(address, worker);
+  EXPECT_EQ(worker, LocalWorkers::Get(address));
+  LocalWorkers::Remove(address);
+  EXPECT_EQ(nullptr, LocalWorkers::Get(address));
+  // Removing an unknown worker is a no-op.
+  LocalWorkers::Remove(address);
+}
+
+TEST(LocalWorkers, RegistersClusterWorkers) {
+  std::string worker_address;
+  {
+    TestCluster cluster(/*num_workers=*/2);
+    TF_ASSERT_OK(cluster.Initialize());
+    worker_address = cluster.WorkerAddress(0);
+    std::shared_ptr<DataServiceWorkerImpl> worker =
+        LocalWorkers::Get(worker_address);
+    ASSERT_NE(nullptr, worker);
+    EXPECT_NE(worker, LocalWorkers::Get(cluster.WorkerAddress(1)));
+
+    // Requests are served by the worker without going through gRPC.
+    GetElementRequest request;
+    request.set_task_id(42);
+    GetElementResponse response;
+    EXPECT_TRUE(errors::IsNotFound(worker->GetElement(&request, &response)));
+  }
+  // Workers are unregistered when they shut down.
+  EXPECT_EQ(nullptr, LocalWorkers::Get(worker_address));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
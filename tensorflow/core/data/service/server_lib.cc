@@ -70,6 +70,7 @@ void GrpcDataServerBase::Stop() {
   if (stopped_) {
     return;
   }
+  StopServiceInternal();
   server_->Shutdown();
   stopped_ = true;
   LOG(INFO) << "Shut down " << server_type_ << " server running at port "
@@ -138,6 +139,8 @@ Status WorkerGrpcDataServer::StartServiceInternal() {
   return Status::OK();
 }
 
+void WorkerGrpcDataServer::StopServiceInternal() { service_->Stop(); }
+
 Status NewDispatchServer(const experimental::DispatcherConfig& config,
                          std::unique_ptr<DispatchGrpcDataServer>& out_server) {
   out_server = absl::make_unique<DispatchGrpcDataServer>(config);
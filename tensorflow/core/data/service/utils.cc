@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/utils.h"
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
@@ -25,6 +31,22 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+namespace {
+// A prefix for the names of the nodes added by `ShardDatasetGraph`.
+constexpr char kShardNodePrefix[] = "tf_data_service_shard/";
+
+void AddInt64Const(const std::string& name, int64 value, GraphDef& graph) {
+  NodeDef* node = graph.add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  auto& attr = *node->mutable_attr();
+  attr["dtype"].set_type(DT_INT64);
+  TensorProto* tensor = attr["value"].mutable_tensor();
+  tensor->set_dtype(DT_INT64);
+  tensor->add_int64_val(value);
+}
+}  // namespace
+
 Status WriteDatasetDef(const std::string& path, const DatasetDef& dataset_def) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(path, &file));
@@ -50,5 +72,53 @@ Status ReadDatasetDef(const std::string& path, DatasetDef& dataset_def) {
   return Status::OK();
 }
 
+Status ShardDatasetGraph(const GraphDef& graph, int64 num_shards, int64 index,
+                         GraphDef& sharded) {
+  sharded = graph;
+  NodeDef* retval = nullptr;
+  for (NodeDef& node : *sharded.mutable_node()) {
+    if (node.op() == "_Retval") {
+      retval = &node;
+    }
+  }
+  if (retval == nullptr || retval->input_size() == 0) {
+    return errors::NotFound("Failed to find a _Retval op in the given dataset");
+  }
+  const std::string dataset_input = retval->input(0);
+  const std::string dataset_node_name =
+      std::vector<std::string>(absl::StrSplit(dataset_input, ':'))[0];
+  const NodeDef* dataset_node = nullptr;
+  for (const NodeDef& node : sharded.node()) {
+    if (node.name() == dataset_node_name) {
+      dataset_node = &node;
+    }
+  }
+  if (dataset_node == nullptr || !dataset_node->attr().count("output_types") ||
+      !dataset_node->attr().count("output_shapes")) {
+    return errors::FailedPrecondition(
+        "Failed to find the output types and shapes of dataset node ",
+        dataset_node_name);
+  }
+  NodeDef shard_node;
+  shard_node.set_name(absl::StrCat(kShardNodePrefix, "AutoShardDataset"));
+  shard_node.set_op("AutoShardDataset");
+  auto& attr = *shard_node.mutable_attr();
+  attr["output_types"] = dataset_node->attr().at("output_types");
+  attr["output_shapes"] = dataset_node->attr().at("output_shapes");
+  attr["auto_shard_policy"].set_i(0);  // AutoShardPolicy::AUTO
+  attr["num_replicas"].set_i(0);
+  const std::string num_shards_name =
+      absl::StrCat(kShardNodePrefix, "num_shards");
+  const std::string index_name = absl::StrCat(kShardNodePrefix, "index");
+  shard_node.add_input(dataset_input);
+  shard_node.add_input(num_shards_name);
+  shard_node.add_input(index_name);
+  retval->set_input(0, shard_node.name());
+  AddInt64Const(num_shards_name, num_shards, sharded);
+  AddInt64Const(index_name, index, sharded);
+  *sharded.add_node() = std::move(shard_node);
+  return Status::OK();
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_UTILS_H_
 
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -32,6 +33,13 @@ Status WriteDatasetDef(const std::string& path, const DatasetDef& dataset_def);
 // `dataset_def`. Returns NOT_FOUND if the path cannot be found.
 Status ReadDatasetDef(const std::string& path, DatasetDef& dataset_def);
 
+// Stores in `sharded` a copy of the dataset graph `graph` that only produces
+// the `index`-th of `num_shards` shards of the dataset. The dataset is sharded
+// with `AutoShardDataset`, which divides the input files of the dataset between
+// the shards when possible, and its elements otherwise.
+Status ShardDatasetGraph(const GraphDef& graph, int64 num_shards, int64 index,
+                         GraphDef& sharded);
+
 }  // namespace data
 }  // namespace tensorflow
 
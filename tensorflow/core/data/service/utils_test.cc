@@ -15,7 +15,10 @@ limitations under the License.
 #include "tensorflow/core/data/service/utils.h"
 
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
@@ -58,6 +61,49 @@ TEST(Utils, OverwriteDataset) {
   EXPECT_EQ(result.graph().version(), version_2);
 }
 
+TEST(Utils, ShardDatasetGraph) {
+  GraphDef graph;
+  NodeDef* dataset = graph.add_node();
+  dataset->set_name("dataset");
+  dataset->set_op("RangeDataset");
+  (*dataset->mutable_attr())["output_types"].mutable_list()->add_type(
+      DT_INT64);
+  (*dataset->mutable_attr())["output_shapes"].mutable_list()->add_shape();
+  NodeDef* retval = graph.add_node();
+  retval->set_name("retval");
+  retval->set_op("_Retval");
+  retval->add_input("dataset:0");
+
+  GraphDef sharded;
+  TF_ASSERT_OK(
+      ShardDatasetGraph(graph, /*num_shards=*/5, /*index=*/2, sharded));
+  ASSERT_EQ(sharded.node_size(), 5);
+  const NodeDef* shard = nullptr;
+  for (const NodeDef& node : sharded.node()) {
+    if (node.name() == "retval") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "tf_data_service_shard/AutoShardDataset");
+    } else if (node.op() == "AutoShardDataset") {
+      shard = &node;
+    } else if (node.op() == "Const") {
+      const int64 value = node.attr().at("value").tensor().int64_val(0);
+      EXPECT_EQ(value, node.name() == "tf_data_service_shard/index" ? 2 : 5);
+    }
+  }
+  ASSERT_NE(shard, nullptr);
+  ASSERT_EQ(shard->input_size(), 3);
+  EXPECT_EQ(shard->input(0), "dataset:0");
+  EXPECT_EQ(shard->attr().at("output_types").list().type(0), DT_INT64);
+}
+
+TEST(Utils, ShardDatasetGraphWithoutRetval) {
+  GraphDef graph;
+  graph.add_node()->set_name("dataset");
+  GraphDef sharded;
+  Status s = ShardDatasetGraph(graph, /*num_shards=*/2, /*index=*/0, sharded);
+  EXPECT_EQ(s.code(), error::NOT_FOUND);
+}
+
 TEST(Utils, ReadDatasetNotFound) {
   std::string filename = testing::TmpDir();
   ASSERT_TRUE(Env::Default()->CreateUniqueFileName(&filename, "journal_dir"));
@@ -45,6 +45,13 @@ auto* tf_data_service_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/data/service/created",
                                     "Whether a tf.data service server "
                                     "has been created.");
+
+// An iterator together with the dataset it iterates over, destroyed in that
+// order.
+struct DatasetIterator {
+  std::unique_ptr<standalone::Dataset> dataset;
+  std::unique_ptr<standalone::Iterator> iterator;
+};
 }  // namespace
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(
@@ -110,15 +117,13 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
   if (task.initialized) {
     return Status::OK();
   }
-  standalone::Dataset::Params params;
-
+  DatasetDef def;
+  const GraphDef* graph;
   switch (task.task_def.dataset_case()) {
     case TaskDef::kDatasetDef:
-      TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
-          params, task.task_def.dataset_def().graph(), &task.dataset));
+      graph = &task.task_def.dataset_def().graph();
       break;
     case TaskDef::kPath: {
-      DatasetDef def;
       Status s = ReadDatasetDef(task.task_def.path(), def);
       if (!s.ok()) {
         LOG(INFO) << "Failed to read dataset from " << task.task_def.path()
@@ -126,24 +131,95 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
         TF_RETURN_IF_ERROR(
             dispatcher_->GetDatasetDef(task.task_def.dataset_id(), def));
       }
-      TF_RETURN_IF_ERROR(
-          standalone::Dataset::FromGraph(params, def.graph(), &task.dataset));
+      graph = &def.graph();
       break;
     }
     case TaskDef::DATASET_NOT_SET:
       return errors::Internal("Unrecognized dataset case: ",
                               task.task_def.dataset_case());
   }
-  TF_RETURN_IF_ERROR(task.dataset->MakeIterator(&task.iterator));
+  if (task.task_def.num_splits() > 0) {
+    // The iterator is created when the task acquires its first split.
+    task.graph = *graph;
+  } else if (config_.cross_job_cache_size_bytes() > 0) {
+    TF_RETURN_IF_ERROR(GetOrCreateCrossJobCache(
+        task.task_def.dataset_id(), *graph, task.cross_job_cache));
+  } else {
+    standalone::Dataset::Params params;
+    TF_RETURN_IF_ERROR(
+        standalone::Dataset::FromGraph(params, *graph, &task.dataset));
+    TF_RETURN_IF_ERROR(task.dataset->MakeIterator(&task.iterator));
+  }
   task.initialized = true;
   VLOG(3) << "Created iterator for task " << task.task_def.task_id();
   return Status::OK();
 }
 
+Status DataServiceWorkerImpl::GetOrCreateCrossJobCache(
+    int64 dataset_id, const GraphDef& graph,
+    std::shared_ptr<CrossJobCache>& cache) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::weak_ptr<CrossJobCache>& entry = cross_job_caches_[dataset_id];
+  cache = entry.lock();
+  if (cache != nullptr && !cache->producer_finished()) {
+    VLOG(3) << "Sharing the iterator of dataset " << dataset_id;
+    return Status::OK();
+  }
+  auto dataset_iterator = std::make_shared<DatasetIterator>();
+  standalone::Dataset::Params params;
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
+      params, graph, &dataset_iterator->dataset));
+  TF_RETURN_IF_ERROR(
+      dataset_iterator->dataset->MakeIterator(&dataset_iterator->iterator));
+  cache = std::make_shared<CrossJobCache>(
+      [dataset_iterator](std::vector<Tensor>& element, bool& end_of_sequence) {
+        return dataset_iterator->iterator->GetNext(&element, &end_of_sequence);
+      },
+      config_.cross_job_cache_size_bytes());
+  entry = cache;
+  VLOG(3) << "Created a cross-job cache for dataset " << dataset_id;
+  return Status::OK();
+}
+
+Status DataServiceWorkerImpl::GetNextFromSplits(Task& task,
+                                                std::vector<Tensor>& outputs,
+                                                bool& end_of_sequence) {
+  while (true) {
+    if (task.iterator) {
+      TF_RETURN_IF_ERROR(task.iterator->GetNext(&outputs, &end_of_sequence));
+      if (!end_of_sequence) {
+        return Status::OK();
+      }
+      task.iterator.reset();
+      task.dataset.reset();
+    }
+    int64 split_index;
+    bool end_of_splits;
+    TF_RETURN_IF_ERROR(dispatcher_->GetSplit(
+        task.task_def.task_id(), task.split_index, split_index, end_of_splits));
+    if (end_of_splits) {
+      task.split_index = -1;
+      end_of_sequence = true;
+      return Status::OK();
+    }
+    VLOG(3) << "Task " << task.task_def.task_id() << " processing split "
+            << split_index << " of " << task.task_def.num_splits();
+    GraphDef sharded;
+    TF_RETURN_IF_ERROR(ShardDatasetGraph(
+        task.graph, task.task_def.num_splits(), split_index, sharded));
+    standalone::Dataset::Params params;
+    TF_RETURN_IF_ERROR(
+        standalone::Dataset::FromGraph(params, sharded, &task.dataset));
+    TF_RETURN_IF_ERROR(task.dataset->MakeIterator(&task.iterator));
+    task.split_index = split_index;
+  }
+}
+
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
   VLOG(3) << "Received GetElement request for task " << request->task_id();
   bool end_of_sequence = false;
+  // Whether `outputs` may still be read by the tasks of other jobs.
+  bool shared_outputs = false;
   std::vector<tensorflow::Tensor> outputs;
   {
     mutex_lock l(mu_);
@@ -161,17 +237,30 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
     }
     auto& task = it->second;
     TF_RETURN_IF_ERROR(EnsureTaskInitialized(*task));
-    std::unique_ptr<standalone::Iterator>& iter = task->iterator;
-    if (iter == nullptr) {
+    if (task->finished) {
       VLOG(3) << "Task " << request->task_id() << " is already finished";
       response->set_end_of_sequence(true);
       return Status::OK();
     }
-    TF_RETURN_IF_ERROR(iter->GetNext(&outputs, &end_of_sequence));
+    if (task->task_def.num_splits() > 0) {
+      TF_RETURN_IF_ERROR(GetNextFromSplits(*task, outputs, end_of_sequence));
+    } else if (task->cross_job_cache) {
+      TF_RETURN_IF_ERROR(task->cross_job_cache->GetNext(
+          request->task_id(), outputs, end_of_sequence));
+      shared_outputs = true;
+    } else {
+      TF_RETURN_IF_ERROR(task->iterator->GetNext(&outputs, &end_of_sequence));
+    }
     if (end_of_sequence) {
       VLOG(3) << "Reached end_of_sequence for task " << request->task_id();
-      // Release iterator memory and leave a null entry as a tombstone.
-      iter.reset();
+      // Release iterator memory and leave the task as a tombstone.
+      task->finished = true;
+      task->iterator.reset();
+      task->dataset.reset();
+      if (task->cross_job_cache) {
+        task->cross_job_cache->RemoveConsumer(request->task_id());
+        task->cross_job_cache.reset();
+      }
       pending_completed_tasks_.insert(request->task_id());
       background_cv_.notify_one();
     }
@@ -205,7 +294,11 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
           "it produced ",
           variant.TypeName());
     }
-    compressed->Swap(response->mutable_compressed_element());
+    if (shared_outputs) {
+      *response->mutable_compressed_element() = *compressed;
+    } else {
+      compressed->Swap(response->mutable_compressed_element());
+    }
   }
   response->set_end_of_sequence(end_of_sequence);
 
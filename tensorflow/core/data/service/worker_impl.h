@@ -17,10 +17,12 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/cross_job_cache.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/data/experimental/service_config.pb.h"
 #include "tensorflow/core/public/session.h"
@@ -58,10 +60,19 @@ class DataServiceWorkerImpl {
     TaskDef task_def;
     mutex mu;
     bool initialized TF_GUARDED_BY(mu) = false;
+    // Whether the task has produced all its elements.
+    bool finished = false;
     // TODO(aaudibert): Have standalone::Iterator own a reference to
     // standalone::Dataset so that we don't need to store the dataset here.
     std::unique_ptr<standalone::Dataset> dataset;
     std::unique_ptr<standalone::Iterator> iterator;
+    // For tasks of jobs divided into splits: the dataset graph, and the split
+    // that `dataset` and `iterator` currently process (-1 if none).
+    GraphDef graph;
+    int64 split_index = -1;
+    // For tasks sharing their iterator with the tasks of other jobs, the
+    // cache they read from instead of `iterator`.
+    std::shared_ptr<CrossJobCache> cross_job_cache;
   };
 
   // Registers the worker with the dispatcher.
@@ -70,7 +81,17 @@ class DataServiceWorkerImpl {
   Status SendTaskUpdates() LOCKS_EXCLUDED(mu_);
   // Creates an iterator to process a task.
   Status ProcessTaskInternal(const TaskDef& task) EXCLUSIVE_LOCKS_REQUIRED(mu_);
-  Status EnsureTaskInitialized(Task& task);
+  Status EnsureTaskInitialized(Task& task) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Gets the cache shared by the tasks reading `dataset_id`, creating it if
+  // there is none or if its iterator has reached the end of the dataset.
+  Status GetOrCreateCrossJobCache(int64 dataset_id, const GraphDef& graph,
+                                  std::shared_ptr<CrossJobCache>& cache)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Gets the next element of a task whose job is divided into splits,
+  // acquiring new splits from the dispatcher as the previous ones are
+  // exhausted.
+  Status GetNextFromSplits(Task& task, std::vector<Tensor>& outputs,
+                           bool& end_of_sequence);
   // A thread for doing async background processing not associated with a
   // specific RPC, such as reporting finished tasks.
   void BackgroundThread() LOCKS_EXCLUDED(mu_);
@@ -85,6 +106,11 @@ class DataServiceWorkerImpl {
   absl::flat_hash_map<int64, std::unique_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
   // Completed tasks which haven't yet been communicated to the dispatcher.
   absl::flat_hash_set<int64> pending_completed_tasks_ TF_GUARDED_BY(mu_);
+  // Caches shared by the tasks of different jobs, keyed by dataset ids. The
+  // dispatcher gives datasets with the same fingerprint the same id. The
+  // caches are owned by the tasks reading them.
+  absl::flat_hash_map<int64, std::weak_ptr<CrossJobCache>> cross_job_caches_
+      TF_GUARDED_BY(mu_);
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
   // Whether the worker has registered with the dispatcher yet.
   bool registered_ TF_GUARDED_BY(mu_) = false;
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -335,6 +336,20 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
           }
         });
     return;
+  } else if (RendezvousWaitAccountingEnabled()) {
+    // The wait of a remote Recv lasts until its tensor is received.
+    const uint64 start_us = EnvTime::NowMicros();
+    RecvFromRemoteAsync(
+        parsed, recv_args,
+        [parsed, start_us, done = std::move(done)](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& in,
+            bool is_dead) {
+          if (status.ok()) {
+            RecordRendezvousWait(parsed, EnvTime::NowMicros() - start_us);
+          }
+          done(status, send_args, recv_args, in, is_dead);
+        });
   } else {
     RecvFromRemoteAsync(parsed, recv_args, std::move(done));
   }
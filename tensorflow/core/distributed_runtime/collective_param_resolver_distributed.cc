@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/distributed_runtime/cancellable_call.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -83,6 +84,16 @@ class CompleteInstanceCall : public CancellableCall {
   CompleteInstanceResponse resp_;
 };
 
+// Identifies the instances of a group that are completed identically by the
+// group leader, apart from their instance key.
+string InstanceSignature(const CollectiveParams& cp) {
+  return strings::StrCat(cp.instance.type, ":",
+                         DataTypeString(cp.instance.data_type), ":",
+                         cp.instance.shape.DebugString(), ":",
+                         absl::StrJoin(cp.instance.impl_details.subdiv_offsets,
+                                       ","));
+}
+
 }  // namespace
 
 CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
@@ -90,6 +101,7 @@ CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
     DeviceResolverDistributed* dev_resolver, WorkerCacheInterface* worker_cache,
     const string& task_name)
     : CollectiveParamResolverLocal(config, dev_mgr, dev_resolver, task_name),
+      dev_resolver_distributed_(dev_resolver),
       worker_cache_(worker_cache),
       group_leader_(task_name == config.experimental().collective_group_leader()
                         ? ""
@@ -279,15 +291,23 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
   VLOG(1) << "CompleteGroupDistributed group_key=" << cp->group.group_key
           << " dev: " << device.name()
           << " is_leader=" << (group_leader_.empty());
+  GroupRecCallback done_and_update_resolver =
+      [this, done](const Status& s, const GroupRec* gr) {
+        if (s.ok()) {
+          UpdateDeviceResolver(gr);
+        }
+        done(s, gr);
+      };
   if (group_leader_.empty()) {
     // This is the group leader, so resolution is local.
-    return CompleteGroupLocal(device, cp, done);
+    return CompleteGroupLocal(device, cp, done_and_update_resolver);
   } else if (GetCachedGroup(cp->group.group_key) == nullptr) {
     // Need to update Group cache from the leader.
     CompleteGroupCall* call =
         new CompleteGroupCall(cp->group, device, cp->instance.type, cancel_mgr,
                               group_leader_, worker_cache_);
-    call->Start([this, device, cp, call, done](const Status& s) {
+    call->Start([this, device, cp, call,
+                 done = std::move(done_and_update_resolver)](const Status& s) {
       if (s.ok()) {
         Status status = UpdateGroupCache(call->resp_);
         if (status.ok()) {
@@ -302,10 +322,29 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
     });
     return;
   } else {
-    return CompleteGroupLocal(device, cp, done);
+    return CompleteGroupLocal(device, cp, done_and_update_resolver);
   }
 }
 
+void CollectiveParamResolverDistributed::UpdateDeviceResolver(
+    const GroupRec* gr) {
+  {
+    mutex_lock l(group_mu_);
+    if (!seeded_groups_.insert(gr->group.group_key).second) {
+      return;
+    }
+  }
+  std::vector<DeviceAttributes> attributes;
+  {
+    mutex_lock l(gr->mu);
+    attributes.reserve(gr->devices.size());
+    for (const auto& item : gr->devices) {
+      attributes.push_back(item.second);
+    }
+  }
+  dev_resolver_distributed_->UpdateDeviceAttributes(attributes);
+}
+
 bool CollectiveParamResolverDistributed::InstanceIsCached(int32 group_key,
                                                           int32 instance_key) {
   mutex_lock l(instance_mu_);
@@ -317,6 +356,16 @@ bool CollectiveParamResolverDistributed::InstanceIsCached(int32 group_key,
   return instance_it != group_it->second.end();
 }
 
+bool CollectiveParamResolverDistributed::InstanceSignatureIsCached(
+    int32 group_key, const string& signature) {
+  mutex_lock l(instance_mu_);
+  auto group_it = instance_signatures_.find(group_key);
+  if (group_it == instance_signatures_.end()) {
+    return false;
+  }
+  return group_it->second.contains(signature);
+}
+
 void CollectiveParamResolverDistributed::UpdateInstanceCache(
     const GroupRec* gr, CollectiveParams* cp,
     const CompleteInstanceResponse& resp, const StatusCallback& done) {
@@ -383,19 +432,29 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else if (InstanceIsCached(gr->group.group_key, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
+  }
+  const string signature = InstanceSignature(*cp);
+  if (cp->instance.type != BROADCAST_COLLECTIVE &&
+      InstanceSignatureIsCached(gr->group.group_key, signature)) {
+    return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
         cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
         group_leader_, worker_cache_);
-    call->Start([this, device, gr, cp, call, done](const Status& s) {
+    call->Start([this, device, gr, cp, call, signature, done](const Status& s) {
       if (s.ok()) {
         UpdateInstanceCache(
-            gr, cp, call->resp_, [this, device, gr, cp, done](const Status& s) {
+            gr, cp, call->resp_,
+            [this, device, gr, cp, signature, done](const Status& s) {
               if (!s.ok()) {
                 done(s);
-              } else {
-                CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
+                return;
+              }
+              if (cp->instance.type != BROADCAST_COLLECTIVE) {
+                mutex_lock l(instance_mu_);
+                instance_signatures_[gr->group.group_key].insert(signature);
               }
+              CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
             });
       } else {
         done(s);
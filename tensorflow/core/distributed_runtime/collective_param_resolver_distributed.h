@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
 
 namespace tensorflow {
 class ConfigProto;
@@ -65,11 +67,24 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                 CancellationManager* cancel_mgr,
                                 const GroupRecCallback& done);
 
+  // Adds the attributes of all devices of the complete group `gr` to the
+  // device resolver, the first time the group is complete on this task, so
+  // that the attributes of peers need not be fetched from each of them.
+  void UpdateDeviceResolver(const GroupRec* gr)
+      TF_LOCKS_EXCLUDED(group_mu_, gr->mu);
+
   // Returns true iff there's an entry for this instance_key in the
   // local instance_table_.
   bool InstanceIsCached(int32 group_key, int32 instance_key)
       TF_LOCKS_EXCLUDED(instance_mu_);
 
+  // Returns true iff an instance of this group with the same signature was
+  // already completed by the group leader. Instances other than broadcasts
+  // get nothing from the leader beyond this check, so such instances are
+  // completed locally.
+  bool InstanceSignatureIsCached(int32 group_key, const string& signature)
+      TF_LOCKS_EXCLUDED(instance_mu_);
+
   // Updates instance_table_ with contents of resp.
   void UpdateInstanceCache(const GroupRec* gr, CollectiveParams* cp,
                            const CompleteInstanceResponse& resp,
@@ -85,8 +100,12 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                    const StatusCallback& done)
       TF_LOCKS_EXCLUDED(instance_mu_, gr->mu, group_mu_);
 
-  WorkerCacheInterface* worker_cache_;  // Not owned
+  DeviceResolverDistributed* dev_resolver_distributed_;  // Not owned
+  WorkerCacheInterface* worker_cache_;                   // Not owned
   const string group_leader_;
+  gtl::FlatSet<int32> seeded_groups_ TF_GUARDED_BY(group_mu_);
+  gtl::FlatMap<int32, gtl::FlatSet<string>> instance_signatures_
+      TF_GUARDED_BY(instance_mu_);
 };
 
 }  // namespace tensorflow
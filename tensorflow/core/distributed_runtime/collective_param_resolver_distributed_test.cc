@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <atomic>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
@@ -75,13 +77,19 @@ class FakeWorker : public TestWorkerInterface {
                              const CompleteInstanceRequest* request,
                              CompleteInstanceResponse* response,
                              StatusCallback done) override {
+    num_complete_instance_calls_++;
     param_resolver_->CompleteInstanceAsync(request, response, &cm_, done);
   }
 
+  int num_complete_instance_calls() const {
+    return num_complete_instance_calls_;
+  }
+
  private:
   string name_;
   DeviceMgr* device_mgr_;
   CancellationManager cm_;
+  std::atomic<int> num_complete_instance_calls_{0};
   CollectiveParamResolverDistributed* param_resolver_;
 };
 
@@ -321,6 +329,27 @@ TEST_F(DeviceResDistTest, Workers2Devices2) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+TEST_F(DeviceResDistTest, InstanceWithSameSignatureIsCompletedLocally) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  FakeWorker* leader = workers_["/job:worker/replica:0/task:0"].get();
+  const int num_calls = leader->num_complete_instance_calls();
+  EXPECT_GT(num_calls, 0);
+
+  for (auto& it : cp_) {
+    it.second = CreateCollectiveParams(num_workers, num_devices, "CPU");
+    it.second.instance.instance_key++;
+  }
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  // The new instance needed no call to the leader.
+  EXPECT_EQ(leader->num_complete_instance_calls(), num_calls);
+}
+
 TEST_F(DeviceResDistTest, DifferentIncarnation) {
   const int num_workers = 2;
   const int num_devices = 1;
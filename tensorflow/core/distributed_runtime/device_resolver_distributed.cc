@@ -93,20 +93,36 @@ void DeviceResolverDistributed::GetAllDeviceAttributesRecursive(
 
 void DeviceResolverDistributed::RefreshRemoteAttributes(
     const string& device, const string& task, const StatusCallback& done) {
+  {
+    mutex_lock l(mu_);
+    std::vector<StatusCallback>& waiters = pending_refreshes_[task];
+    waiters.push_back(done);
+    if (waiters.size() > 1) {
+      // A refresh of this task is already in flight.
+      return;
+    }
+  }
   GetStatusRequest* req = new GetStatusRequest;
   GetStatusResponse* resp = new GetStatusResponse;
   WorkerInterface* worker = worker_cache_->GetOrCreateWorker(task);
   CHECK(worker) << "Failed to get worker for " << task;
   worker->GetStatusAsync(
       req, resp, /*fail_fast=*/false,
-      [this, device, task, req, resp, worker, done](Status s) {
-        if (s.ok()) {
+      [this, device, task, req, resp, worker](Status s) {
+        std::vector<StatusCallback> waiters;
+        {
           mutex_lock l(mu_);
-          for (const DeviceAttributes& da : resp->device_attributes()) {
-            attr_table_[da.name()] = da;
+          if (s.ok()) {
+            for (const DeviceAttributes& da : resp->device_attributes()) {
+              attr_table_[da.name()] = da;
+            }
           }
+          waiters.swap(pending_refreshes_[task]);
+          pending_refreshes_.erase(task);
+        }
+        for (const StatusCallback& waiter : waiters) {
+          waiter(s);
         }
-        done(s);
         delete req;
         delete resp;
         worker_cache_->ReleaseWorker(task, worker);
@@ -129,4 +145,14 @@ Status DeviceResolverDistributed::GetTaskCached(
   return Status::OK();
 }
 
+void DeviceResolverDistributed::UpdateDeviceAttributes(
+    const std::vector<DeviceAttributes>& attributes) {
+  mutex_lock l(mu_);
+  for (const DeviceAttributes& da : attributes) {
+    if (!DeviceNameUtils::IsSameAddressSpace(task_name_, da.name())) {
+      attr_table_[da.name()] = da;
+    }
+  }
+}
+
 }  // namespace tensorflow
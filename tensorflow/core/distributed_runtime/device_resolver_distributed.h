@@ -46,8 +46,14 @@ class DeviceResolverDistributed : public DeviceResolverInterface {
   Status GetTaskCached(const string& task,
                        std::vector<DeviceAttributes>* attributes) override;
 
+  // Adds the attributes of remote devices learned by other means, e.g. from
+  // the group leader, so that looking them up needs no further RPC.
+  void UpdateDeviceAttributes(const std::vector<DeviceAttributes>& attributes)
+      TF_LOCKS_EXCLUDED(mu_);
+
  protected:
   // Loads attr_table_ with device attributes retrieved from remote task.
+  // Concurrent refreshes of the same task share a single RPC.
   void RefreshRemoteAttributes(const string& device, const string& task,
                                const StatusCallback& done)
       TF_LOCKS_EXCLUDED(mu_);
@@ -64,6 +70,9 @@ class DeviceResolverDistributed : public DeviceResolverInterface {
   const string task_name_;
   mutex mu_;
   absl::flat_hash_map<string, DeviceAttributes> attr_table_ TF_GUARDED_BY(mu_);
+  // Callbacks waiting for the in-flight refresh of each task.
+  absl::flat_hash_map<string, std::vector<StatusCallback>> pending_refreshes_
+      TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
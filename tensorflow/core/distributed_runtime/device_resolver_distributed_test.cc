@@ -212,5 +212,31 @@ TEST_F(DeviceResDistTest, Workers3Devices4) {
   }
 }
 
+TEST_F(DeviceResDistTest, UpdateDeviceAttributes) {
+  DefineWorkers(/*num_workers=*/1, /*num_devices=*/1, /*device_type=*/"CPU",
+                /*device_incarnation_base=*/1);
+  DeviceResolverDistributed* dres =
+      resolvers_["/job:worker/replica:0/task:0"];
+  // The task of this device has no worker, so it can only be found in the
+  // cache.
+  const string task_name = "/job:worker/replica:0/task:1";
+  const string dev_name = strings::StrCat(task_name, "/device:CPU:0");
+  std::vector<DeviceAttributes> update(1);
+  update[0].set_name(dev_name);
+  update[0].set_incarnation(7);
+  dres->UpdateDeviceAttributes(update);
+  Notification note;
+  Status status;
+  DeviceAttributes attributes;
+  dres->GetDeviceAttributesAsync(dev_name, task_name, &attributes,
+                                 [&note, &status](const Status& s) {
+                                   status = s;
+                                   note.Notify();
+                                 });
+  note.WaitForNotification();
+  TF_EXPECT_OK(status);
+  EXPECT_EQ(7, attributes.incarnation());
+}
+
 }  // namespace
 }  // namespace tensorflow
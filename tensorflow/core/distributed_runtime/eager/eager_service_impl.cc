@@ -97,17 +97,31 @@ Status GetEagerOperationAndNumRetvals(const Operation& operation,
                                       EagerExecutor* eager_executor,
                                       EagerOperation* eager_op,
                                       int* num_retvals) {
-  const char* name = operation.name().c_str();  // Shorthand
+  // The name, attrs, device and is_function of an operation sent with only
+  // the id of its signature are those of the registered signature.
+  std::shared_ptr<const Operation> registered_signature;
+  const Operation* signature = &operation;
+  if (operation.signature_id() != 0) {
+    if (operation.name().empty()) {
+      TF_RETURN_IF_ERROR(eager_context->RemoteMgr()->GetOpSignature(
+          operation.signature_id(), &registered_signature));
+      signature = registered_signature.get();
+    } else {
+      eager_context->RemoteMgr()->RegisterOpSignature(operation);
+    }
+  }
+
+  const char* name = signature->name().c_str();  // Shorthand
   absl::optional<tensorflow::EagerRemoteFunctionParams> remote_func_params =
       absl::nullopt;
-  if (operation.is_function()) {
+  if (signature->is_function()) {
     if (operation.is_component_function()) {
       remote_func_params = {operation.id(), operation.func_step_id()};
     } else {
       remote_func_params = {operation.id(), absl::nullopt};
     }
   }
-  TF_RETURN_IF_ERROR(eager_op->Reset(name, operation.device().c_str(), false,
+  TF_RETURN_IF_ERROR(eager_op->Reset(name, signature->device().c_str(), false,
                                      eager_executor, remote_func_params));
 
   {
@@ -136,12 +150,12 @@ Status GetEagerOperationAndNumRetvals(const Operation& operation,
     }
   }
 
-  for (const auto& attr : operation.attrs()) {
+  for (const auto& attr : signature->attrs()) {
     eager_op->MutableAttrs()->Set(attr.first, attr.second);
   }
 
   // TODO(nareshmodi): Consider caching this.
-  return GetNumRetvals(eager_context, operation.name(), operation.attrs(),
+  return GetNumRetvals(eager_context, signature->name(), signature->attrs(),
                        num_retvals);
 }
 
@@ -540,6 +554,10 @@ Status EagerServiceImpl::ExecuteOp(CallOptions* call_opts,
     add_device_fn = [queue_response] { return queue_response->add_device(); };
   }
 
+  if (operation.signature_id() != 0 && !operation.name().empty()) {
+    queue_response->set_op_signature_registered(true);
+  }
+
   return AddOpRetvalsToResponse(
       eager_context, operation.id(), num_retvals, /*output_nums=*/{},
       retvals.data(), [queue_response] { return queue_response->add_tensor(); },
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_mgr.h"
 
 namespace tensorflow {
 namespace eager {
@@ -37,7 +38,10 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
     ops.reserve(request_->queue_size());
     for (const QueueItem& item : request_->queue()) {
       if (item.has_operation()) {
-        ops.push_back(item.operation().name());
+        ops.push_back(item.operation().name().empty()
+                          ? absl::StrCat("OpSignature(",
+                                         item.operation().signature_id(), ")")
+                          : item.operation().name());
       } else {
         ops.push_back(absl::StrCat("DeleteHandle(",
                                    item.handle_to_decref().op_id(), ":",
@@ -73,14 +77,25 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
     handle->Ref();
   }
 
+  // The request is owned by this node, which outlives the callback.
+  EnqueueRequest* request = request_.get();
+  RemoteMgr* remote_mgr = eager_context_->RemoteMgr();
   eager_client_->StreamingEnqueueAsync(
-      call_opts.get(), request_.get(), response.get(),
+      call_opts.get(), request, response.get(),
       [inputs, retvals, call_opts, response, device,
-       context_view_id = context_view_id_, rpc_description, cm, token,
-       done](const Status& status) {
+       context_view_id = context_view_id_, rpc_description, cm, token, request,
+       remote_mgr, done](const Status& status) {
         if (cm != nullptr) {
           cm->TryDeregisterCallback(token);
         }
+        if (status.ok()) {
+          for (int i = 0; i < response->queue_response_size(); ++i) {
+            if (response->queue_response(i).op_signature_registered()) {
+              remote_mgr->SetOpSignatureRegistered(
+                  request->queue(i).operation().signature_id());
+            }
+          }
+        }
         for (auto handle : inputs) {
           handle->Unref();
         }
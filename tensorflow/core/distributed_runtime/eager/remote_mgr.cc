@@ -209,6 +209,53 @@ EagerExecutor& RemoteMgr::GetOrCreateExecutorForStream(uint64 stream_id) {
   return it->second;
 }
 
+int64 RemoteMgr::GetOpSignatureId(const string& remote_task,
+                                  uint64 context_view_id,
+                                  const Fprint128& fingerprint,
+                                  bool* registered) {
+  // The signatures are registered again when the cluster is updated, since
+  // the remote workers may have new contexts.
+  const uint64 task_fingerprint =
+      FingerprintCat64(Fingerprint64(remote_task), context_view_id);
+  const Fprint128 key = {
+      FingerprintCat64(fingerprint.low64, task_fingerprint),
+      FingerprintCat64(fingerprint.high64, task_fingerprint)};
+  mutex_lock l(op_signature_mu_);
+  auto it = op_signature_ids_.find(key);
+  if (it == op_signature_ids_.end()) {
+    it = op_signature_ids_.emplace(key, next_op_signature_id_++).first;
+  }
+  *registered = registered_op_signature_ids_.contains(it->second);
+  return it->second;
+}
+
+void RemoteMgr::SetOpSignatureRegistered(int64 signature_id) {
+  mutex_lock l(op_signature_mu_);
+  registered_op_signature_ids_.insert(signature_id);
+}
+
+void RemoteMgr::RegisterOpSignature(const Operation& operation) {
+  auto signature = std::make_shared<Operation>();
+  signature->set_name(operation.name());
+  *signature->mutable_attrs() = operation.attrs();
+  signature->set_device(operation.device());
+  signature->set_is_function(operation.is_function());
+  mutex_lock l(op_signature_mu_);
+  op_signatures_[operation.signature_id()] = std::move(signature);
+}
+
+Status RemoteMgr::GetOpSignature(int64 signature_id,
+                                 std::shared_ptr<const Operation>* signature) {
+  mutex_lock l(op_signature_mu_);
+  auto it = op_signatures_.find(signature_id);
+  if (it == op_signatures_.end()) {
+    return errors::InvalidArgument("Unknown remote op signature ",
+                                   signature_id);
+  }
+  *signature = it->second;
+  return Status::OK();
+}
+
 void RemoteMgr::DeleteExecutorForStream(uint64 stream_id) {
   mutex_lock l(executor_map_mu_);
   auto it = executor_map_.find(stream_id);
@@ -16,12 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_MGR_H_
 
+#include <memory>
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
 
 namespace tensorflow {
 namespace eager {
@@ -80,6 +85,25 @@ class RemoteMgr {
 
   void DeleteExecutorForStream(uint64 stream_id);
 
+  // On the master, returns the id of the signature `fingerprint` (of the op
+  // name, attrs and device) of the ops sent to `remote_task` in the context
+  // view `context_view_id`. Sets `*registered` if the remote worker
+  // acknowledged the registration of the signature, after which the ops may
+  // be sent with only its id.
+  int64 GetOpSignatureId(const string& remote_task, uint64 context_view_id,
+                         const Fprint128& fingerprint, bool* registered);
+
+  // On the master, records that a remote worker registered `signature_id`.
+  void SetOpSignatureRegistered(int64 signature_id);
+
+  // On a remote worker, registers the name, attrs, device and is_function of
+  // `operation` as its signature `operation.signature_id()`.
+  void RegisterOpSignature(const Operation& operation);
+
+  // On a remote worker, returns the operation registered for `signature_id`.
+  Status GetOpSignature(int64 signature_id,
+                        std::shared_ptr<const Operation>* signature);
+
  protected:
   mutex next_id_mutex_;
   uint64 next_op_id_ TF_GUARDED_BY(next_id_mutex_) = 1;
@@ -129,6 +153,18 @@ class RemoteMgr {
   mutex executor_map_mu_;
   std::unordered_map<uint64, EagerExecutor> executor_map_
       TF_GUARDED_BY(executor_map_mu_);
+
+  mutex op_signature_mu_;
+  // On the master, the ids of the op signatures sent to each remote task, and
+  // those known to be registered.
+  absl::flat_hash_map<Fprint128, int64, Fprint128Hasher> op_signature_ids_
+      TF_GUARDED_BY(op_signature_mu_);
+  absl::flat_hash_set<int64> registered_op_signature_ids_
+      TF_GUARDED_BY(op_signature_mu_);
+  int64 next_op_signature_id_ TF_GUARDED_BY(op_signature_mu_) = 1;
+  // On a remote worker, the registered op signatures.
+  absl::flat_hash_map<int64, std::shared_ptr<const Operation>> op_signatures_
+      TF_GUARDED_BY(op_signature_mu_);
 };
 
 }  // namespace eager
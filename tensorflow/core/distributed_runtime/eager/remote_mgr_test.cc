@@ -153,6 +153,46 @@ TEST_F(RemoteMgrTest, SetRemoteShapeWithClusterUpdate) {
   handle->Unref();
 }
 
+TEST_F(RemoteMgrTest, OpSignatures) {
+  // Master side.
+  RemoteMgr master(true, ctx_);
+  const Fprint128 fingerprint = Fingerprint128("MatMul");
+  const string task = "/job:worker/replica:0/task:0";
+  bool registered = true;
+  const int64 id = master.GetOpSignatureId(task, 0, fingerprint, &registered);
+  EXPECT_NE(id, 0);
+  EXPECT_FALSE(registered);
+  EXPECT_EQ(id, master.GetOpSignatureId(task, 0, fingerprint, &registered));
+  master.SetOpSignatureRegistered(id);
+  EXPECT_EQ(id, master.GetOpSignatureId(task, 0, fingerprint, &registered));
+  EXPECT_TRUE(registered);
+  // Other tasks and context views register the signatures again.
+  EXPECT_NE(id, master.GetOpSignatureId("/job:worker/replica:0/task:1", 0,
+                                        fingerprint, &registered));
+  EXPECT_FALSE(registered);
+  EXPECT_NE(id, master.GetOpSignatureId(task, 1, fingerprint, &registered));
+  EXPECT_FALSE(registered);
+
+  // Worker side.
+  RemoteMgr worker(false, ctx_);
+  std::shared_ptr<const Operation> signature;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(worker.GetOpSignature(id, &signature)));
+  Operation operation;
+  operation.set_id(7);
+  operation.set_name("MatMul");
+  operation.set_device(task);
+  (*operation.mutable_attrs())["transpose_a"].set_b(true);
+  operation.add_op_inputs()->mutable_remote_handle()->set_op_id(3);
+  operation.set_signature_id(id);
+  worker.RegisterOpSignature(operation);
+  TF_ASSERT_OK(worker.GetOpSignature(id, &signature));
+  EXPECT_EQ("MatMul", signature->name());
+  EXPECT_EQ(task, signature->device());
+  EXPECT_TRUE(signature->attrs().at("transpose_a").b());
+  EXPECT_EQ(0, signature->op_inputs_size());
+}
+
 }  // namespace
 }  // namespace eager
 }  // namespace tensorflow
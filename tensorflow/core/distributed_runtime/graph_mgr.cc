@@ -82,6 +82,19 @@ GraphMgr::Item::~Item() {
   }
 }
 
+Status GraphMgr::Item::GetParsedKey(const string& key,
+                                    const Rendezvous::ParsedKey** parsed) {
+  mutex_lock l(parsed_keys_mu_);
+  auto iter = parsed_keys_.find(key);
+  if (iter == parsed_keys_.end()) {
+    Rendezvous::ParsedKey parsed_key;
+    TF_RETURN_IF_ERROR(Rendezvous::ParseKey(key, &parsed_key));
+    iter = parsed_keys_.emplace(key, parsed_key).first;
+  }
+  *parsed = &iter->second;
+  return Status::OK();
+}
+
 // NOTE: node->device_name() is not set by GraphConstructor.  We
 // expects that NodeDef in GraphDef given to workers fully specifies
 // device names.
@@ -387,6 +400,49 @@ Status GraphMgr::RecvOutputs(const int64 step_id, NamedTensors* out) {
   return s;
 }
 
+Status GraphMgr::RecvOutputs(const string& handle, const int64 step_id,
+                             NamedTensors* out) {
+  Item* item = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto iter = table_.find(handle);
+    if (iter != table_.end()) {
+      item = iter->second;
+      item->Ref();
+    }
+  }
+  if (item == nullptr) {
+    return RecvOutputs(step_id, out);
+  }
+  core::ScopedUnref unref_item(item);
+  Rendezvous* rendezvous = worker_env_->rendezvous_mgr->Find(step_id);
+  core::ScopedUnref unref_rendezvous(rendezvous);
+  Status s;
+  size_t output_size = 0;
+  for (auto& p : *out) {
+    const Rendezvous::ParsedKey* parsed;
+    s = item->GetParsedKey(p.first, &parsed);
+    if (!s.ok()) break;
+    bool is_dead = false;
+    s = rendezvous->Recv(*parsed, Rendezvous::Args(), &p.second, &is_dead);
+    if (!s.ok()) break;
+    if (is_dead) {
+      s = errors::InvalidArgument("The tensor returned for ", p.first,
+                                  " was not valid.");
+      break;
+    }
+    output_size += p.second.AllocatedBytes();
+  }
+  if (!s.ok()) {
+    // Failing to fetch the outputs should not be possible, so rewrite the error
+    // status to an INTERNAL error.
+    return errors::Internal("Failed to fetch outputs for step ", step_id,
+                            ". (Original error message: ", s.ToString(), ")");
+  }
+  metrics::RecordGraphOutputTensors(output_size);
+  return Status::OK();
+}
+
 void GraphMgr::RecvOutputsAsync(const int64 step_id, NamedTensors* out,
                                 StatusCallback done) {
   Rendezvous* rendezvous = worker_env_->rendezvous_mgr->Find(step_id);
@@ -467,16 +523,14 @@ void GraphMgr::ExecuteAsync(const string& handle, const int64 step_id,
   // Sends values specified by the caller.
   size_t input_size = 0;
   if (s.ok()) {
-    std::vector<string> keys;
-    std::vector<Tensor> tensors_to_send;
-    keys.reserve(in.size());
-    tensors_to_send.reserve(in.size());
     for (auto& p : in) {
-      keys.push_back(p.first);
-      tensors_to_send.push_back(p.second);
+      const Rendezvous::ParsedKey* parsed;
+      s = item->GetParsedKey(p.first, &parsed);
+      if (!s.ok()) break;
+      s = rendezvous->Send(*parsed, Rendezvous::Args(), p.second, false);
+      if (!s.ok()) break;
       input_size += p.second.AllocatedBytes();
     }
-    s = SendTensorsToRendezvous(rendezvous, nullptr, {}, keys, tensors_to_send);
   }
 
   if (!s.ok()) {
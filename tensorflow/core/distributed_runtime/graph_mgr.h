@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -96,6 +97,10 @@ class GraphMgr {
 
   Status SendInputs(const int64 step_id, const NamedTensors& in);
   Status RecvOutputs(const int64 step_id, NamedTensors* out);
+  // Like RecvOutputs, but reuses the parsed rendezvous keys of the outputs of
+  // the graph registered as `handle` across steps.
+  Status RecvOutputs(const string& handle, const int64 step_id,
+                     NamedTensors* out);
   void RecvOutputsAsync(const int64 step_id, NamedTensors* out,
                         StatusCallback done);
 
@@ -142,6 +147,20 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64 collective_graph_key;
+
+    // Returns in `*parsed` the parsed form of the rendezvous key `key`, which
+    // is parsed only the first time it is seen.  The feed and fetch keys of a
+    // graph are the same in every step, so this avoids parsing their device
+    // names in every step.
+    Status GetParsedKey(const string& key,
+                        const Rendezvous::ParsedKey** parsed);
+
+   private:
+    mutex parsed_keys_mu_;
+    // Values are never erased, so pointers to them remain valid as long as
+    // the item does.
+    std::unordered_map<string, Rendezvous::ParsedKey> parsed_keys_
+        TF_GUARDED_BY(parsed_keys_mu_);
   };
 
   const WorkerEnv* worker_env_;  // Not owned.
@@ -0,0 +1,179 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_mgr.h"
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/debug.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kWorkerName[] = "/job:worker/replica:0/task:0";
+constexpr char kDeviceName[] = "/job:worker/replica:0/task:0/device:CPU:0";
+constexpr int64 kIncarnation = 1;
+
+string FeedKey() {
+  return Rendezvous::CreateKey(kDeviceName, kIncarnation, kDeviceName, "x",
+                               FrameAndIter(0, 0));
+}
+
+string FetchKey() {
+  return Rendezvous::CreateKey(kDeviceName, kIncarnation, kDeviceName, "y",
+                               FrameAndIter(0, 0));
+}
+
+// Registers and runs, as the master would, a partition that receives "x" from
+// the client and sends its identity "y" back.
+class GraphMgrTest : public ::testing::Test {
+ protected:
+  GraphMgrTest() : rendezvous_mgr_(&worker_env_) {
+    std::vector<std::unique_ptr<Device>> devices;
+    devices.push_back(DeviceFactory::NewDevice("CPU", {}, kWorkerName));
+    device_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(devices));
+    worker_env_.env = Env::Default();
+    worker_env_.device_mgr = device_mgr_.get();
+    worker_env_.rendezvous_mgr = &rendezvous_mgr_;
+    worker_env_.compute_pool = ComputePool(SessionOptions());
+    session_ = WorkerSession::CreateWithBorrowedDeviceMgr(
+        "", kWorkerName, /*worker_cache=*/nullptr, device_mgr_.get(),
+        absl::make_unique<GraphMgr>(&worker_env_, device_mgr_.get()),
+        /*remote_device_mgr=*/nullptr);
+  }
+
+  GraphMgr* graph_mgr() { return session_->graph_mgr(); }
+
+  void RegisterIdentityGraph(string* graph_handle) {
+    GraphDef graph_def;
+    TF_ASSERT_OK(NodeDefBuilder("recv", "_Recv")
+                     .Attr("tensor_type", DT_FLOAT)
+                     .Attr("tensor_name", "x")
+                     .Attr("send_device", kDeviceName)
+                     .Attr("send_device_incarnation", kIncarnation)
+                     .Attr("recv_device", kDeviceName)
+                     .Attr("client_terminated", true)
+                     .Device(kDeviceName)
+                     .Finalize(graph_def.add_node()));
+    TF_ASSERT_OK(NodeDefBuilder("identity", "Identity")
+                     .Input("recv", 0, DT_FLOAT)
+                     .Device(kDeviceName)
+                     .Finalize(graph_def.add_node()));
+    TF_ASSERT_OK(NodeDefBuilder("send", "_Send")
+                     .Input("identity", 0, DT_FLOAT)
+                     .Attr("tensor_name", "y")
+                     .Attr("send_device", kDeviceName)
+                     .Attr("send_device_incarnation", kIncarnation)
+                     .Attr("recv_device", kDeviceName)
+                     .Attr("client_terminated", true)
+                     .Device(kDeviceName)
+                     .Finalize(graph_def.add_node()));
+    TF_ASSERT_OK(graph_mgr()->Register(
+        "session", graph_def, session_.get(), GraphOptions(), DebugOptions(),
+        ConfigProto(), BuildGraphOptions::kNoCollectiveGraphKey,
+        session_->cluster_flr(), graph_handle));
+  }
+
+  Status Execute(const string& graph_handle, int64 step_id,
+                 const GraphMgr::NamedTensors& in) {
+    CancellationManager cancellation_manager;
+    Notification done;
+    Status status;
+    graph_mgr()->ExecuteAsync(graph_handle, step_id, session_.get(),
+                              ExecutorOpts(), /*collector=*/nullptr,
+                              /*response=*/nullptr, &cancellation_manager, in,
+                              [&done, &status](const Status& s) {
+                                status = s;
+                                done.Notify();
+                              });
+    done.WaitForNotification();
+    return status;
+  }
+
+  std::unique_ptr<DeviceMgr> device_mgr_;
+  WorkerEnv worker_env_;
+  RpcRendezvousMgr rendezvous_mgr_;
+  std::shared_ptr<WorkerSession> session_;
+};
+
+TEST_F(GraphMgrTest, RecvOutputsOfHandleMatchesRecvOutputs) {
+  string graph_handle;
+  RegisterIdentityGraph(&graph_handle);
+  // The parsed keys of the graph are cached on the first step and reused on
+  // the later ones, alternating with the steps that parse them every time.
+  for (int64 step_id = 1; step_id <= 4; ++step_id) {
+    const Tensor x = test::AsTensor<float>({1.0f * step_id, 2.0f * step_id});
+    TF_ASSERT_OK(Execute(graph_handle, step_id, {{FeedKey(), x}}));
+    GraphMgr::NamedTensors out = {{FetchKey(), Tensor()}};
+    if (step_id % 2 == 1) {
+      TF_ASSERT_OK(graph_mgr()->RecvOutputs(graph_handle, step_id, &out));
+    } else {
+      TF_ASSERT_OK(graph_mgr()->RecvOutputs(step_id, &out));
+    }
+    test::ExpectTensorEqual<float>(x, out[FetchKey()]);
+    rendezvous_mgr_.Cleanup(step_id);
+  }
+}
+
+TEST_F(GraphMgrTest, RecvOutputsOfUnknownHandleParsesKeys) {
+  string graph_handle;
+  RegisterIdentityGraph(&graph_handle);
+  const int64 step_id = 1;
+  const Tensor x = test::AsTensor<float>({3.0f, 4.0f});
+  TF_ASSERT_OK(Execute(graph_handle, step_id, {{FeedKey(), x}}));
+  GraphMgr::NamedTensors out = {{FetchKey(), Tensor()}};
+  TF_ASSERT_OK(graph_mgr()->RecvOutputs("unknown", step_id, &out));
+  test::ExpectTensorEqual<float>(x, out[FetchKey()]);
+  rendezvous_mgr_.Cleanup(step_id);
+}
+
+TEST_F(GraphMgrTest, InvalidKeysFailOnBothPaths) {
+  string graph_handle;
+  RegisterIdentityGraph(&graph_handle);
+  const Tensor x = test::AsTensor<float>({5.0f, 6.0f});
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      Execute(graph_handle, 1, {{"invalid key", x}})));
+  rendezvous_mgr_.Cleanup(1);
+
+  TF_ASSERT_OK(Execute(graph_handle, 2, {{FeedKey(), x}}));
+  GraphMgr::NamedTensors out = {{"invalid key", Tensor()}};
+  EXPECT_TRUE(
+      errors::IsInternal(graph_mgr()->RecvOutputs(graph_handle, 2, &out)));
+  EXPECT_TRUE(errors::IsInternal(graph_mgr()->RecvOutputs(2, &out)));
+  rendezvous_mgr_.Cleanup(2);
+}
+
+}  // namespace
+}  // namespace tensorflow
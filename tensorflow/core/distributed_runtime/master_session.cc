@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -56,6 +57,8 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
 
@@ -510,6 +513,7 @@ class RunManyGraphs {
     CallOptions opts;
     const string* worker_name;
     std::atomic<bool> done{false};
+    int64 start_micros = 0;
     std::unique_ptr<MutableRunGraphRequestWrapper> req;
     std::unique_ptr<MutableRunGraphResponseWrapper> resp;
   };
@@ -520,6 +524,9 @@ class RunManyGraphs {
     TRACEPRINTF("Partition %d %s", index, s.ToString().c_str());
     Call* call = get(index);
     call->done = true;
+    metrics::RecordDistributedStepPhase(
+        metrics::DistributedStepPhase::kMasterRunGraph,
+        Env::Default()->NowMicros() - call->start_micros);
     auto resp = call->resp.get();
     if (resp->status_code() != error::Code::OK) {
       // resp->status_code will only be non-OK if s.ok().
@@ -645,6 +652,13 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     int64 execution_count, PerStepState* pss, CallOptions* call_opts,
     const ClientRequestType& req, ClientResponseType* resp,
     CancellationManager* cm, bool is_last_partial_run) {
+  profiler::TraceMe activity(
+      [&] {
+        return profiler::TraceMeEncode("MasterSession::RunPartitions",
+                                       {{"id", step_id}});
+      },
+      profiler::TraceMeLevel::kInfo);
+  const uint64 start_micros = Env::Default()->NowMicros();
   // Collect execution cost stats on a smoothly decreasing frequency.
   ExecutorOpts exec_opts;
   if (pss->report_tensor_allocations_upon_oom) {
@@ -733,10 +747,15 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   }
 
   // Issues RunGraph calls.
+  const uint64 issue_micros = Env::Default()->NowMicros();
+  metrics::RecordDistributedStepPhase(
+      metrics::DistributedStepPhase::kMasterBuildRequests,
+      issue_micros - start_micros);
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
     RunManyGraphs::Call* call = calls.get(i);
     TRACEPRINTF("Partition %d %s", i, part.name.c_str());
+    call->start_micros = Env::Default()->NowMicros();
     part.worker->RunGraphAsync(
         &call->opts, call->req.get(), call->resp.get(),
         std::bind(&RunManyGraphs::WhenDone, &calls, i, std::placeholders::_1));
@@ -762,6 +781,10 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     return errors::Cancelled("Step was cancelled");
   }
   TF_RETURN_IF_ERROR(calls.status());
+  const uint64 collect_micros = Env::Default()->NowMicros();
+  metrics::RecordDistributedStepPhase(
+      metrics::DistributedStepPhase::kMasterWait,
+      collect_micros - issue_micros);
 
   // Collects fetches and metadata.
   Status status;
@@ -801,6 +824,9 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
       }
     }
   }
+  metrics::RecordDistributedStepPhase(
+      metrics::DistributedStepPhase::kMasterCollectFetches,
+      Env::Default()->NowMicros() - collect_micros);
   return status;
 }
 
@@ -0,0 +1,244 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_recv_tensors_table.h"
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Appends `message`, the encoding of a sub-message, to `*slices` as field
+// `field_number` of the enclosing message.
+void AppendLengthDelimited(int field_number, ::grpc::ByteBuffer* message,
+                           std::vector<::grpc::Slice>* slices) {
+  char header[1 + core::kMaxVarint64Bytes];
+  char* p = header;
+  // Wire type 2 is length-delimited; field numbers below 16 fit in one byte.
+  DCHECK_LT(field_number, 16);
+  *p++ = static_cast<char>((field_number << 3) | 2);
+  p = core::EncodeVarint64(p, message->Length());
+  slices->emplace_back(header, p - header);
+  std::vector<::grpc::Slice> message_slices;
+  if (message->Length() > 0) {
+    // Dump() only fails for an empty buffer.
+    (void)message->Dump(&message_slices);
+  }
+  for (::grpc::Slice& slice : message_slices) {
+    slices->push_back(std::move(slice));
+  }
+}
+
+// Appends `value` to `*slices` as field `field_number` of the enclosing
+// message, with the varint wire type.
+void AppendVarint(int field_number, uint64 value,
+                  std::vector<::grpc::Slice>* slices) {
+  char buffer[1 + core::kMaxVarint64Bytes];
+  char* p = buffer;
+  DCHECK_LT(field_number, 16);
+  *p++ = static_cast<char>(field_number << 3);
+  p = core::EncodeVarint64(p, value);
+  slices->emplace_back(buffer, p - buffer);
+}
+
+}  // namespace
+
+// A RecvTensors call waiting to be answered.
+struct GrpcRecvTensorsTable::Call {
+  Call(const RecvTensorsRequest* request, ::grpc::ByteBuffer* response,
+       StatusCallback done)
+      : request(request), response(response), done(std::move(done)) {}
+
+  const RecvTensorsRequest* const request;
+  ::grpc::ByteBuffer* const response;
+  const StatusCallback done;
+
+  // Set once all the sub-requests are in the table, and once the call is
+  // answered.
+  bool started = false;
+  bool finished = false;
+  // The positions and responses of the ready sub-requests.
+  std::vector<int> ready_indices;
+  std::vector<::grpc::ByteBuffer> ready_responses;
+  Status status;
+};
+
+// A sub-request that is in flight, or done but not answered yet.
+struct GrpcRecvTensorsTable::Entry {
+  explicit Entry(const RecvTensorRequest& request) : request(request) {}
+
+  const RecvTensorRequest request;
+  CallOptions opts;
+  ::grpc::ByteBuffer response;
+  bool done = false;
+  Status status;
+  // The call waiting for the entry, and the position of the entry in its
+  // request, if any.
+  std::shared_ptr<Call> waiter;
+  int index = -1;
+  // Whether nobody will ask for the entry anymore, so it is dropped when done.
+  bool orphaned = false;
+};
+
+GrpcRecvTensorsTable::~GrpcRecvTensorsTable() {}
+
+void GrpcRecvTensorsTable::RecvTensorsAsync(const RecvTensorsRequest* request,
+                                            ::grpc::ByteBuffer* response,
+                                            const StartRecvFn& start_recv,
+                                            StatusCallback done) {
+  auto call = std::make_shared<Call>(request, response, std::move(done));
+  std::vector<Entry*> to_start;
+  {
+    mutex_lock l(mu_);
+    for (int i = 0; i < request->request_size(); ++i) {
+      const RecvTensorRequest& sub_request = request->request(i);
+      const int64 request_id = sub_request.request_id();
+      if (request_id == 0) {
+        call->status.Update(errors::InvalidArgument(
+            "RecvTensors requires the request_id of every sub-request"));
+        break;
+      }
+      std::unique_ptr<Entry>& entry = entries_[request_id];
+      if (entry == nullptr) {
+        entry.reset(new Entry(sub_request));
+        to_start.push_back(entry.get());
+      } else if (entry->request.step_id() != sub_request.step_id() ||
+                 entry->waiter != nullptr) {
+        call->status.Update(errors::AlreadyExists(
+            "RecvTensors sub-request ", request_id,
+            " is already pending for another call"));
+        break;
+      }
+      if (entry->done) {
+        DeliverLocked(entry.get(), i, call.get());
+        entries_.erase(request_id);
+      } else {
+        entry->waiter = call;
+        entry->index = i;
+      }
+    }
+  }
+
+  for (Entry* entry : to_start) {
+    start_recv(&entry->opts, &entry->request, &entry->response,
+               [this, entry](const Status& s) { OnRecvDone(entry, s); });
+  }
+
+  bool reply;
+  {
+    mutex_lock l(mu_);
+    call->started = true;
+    reply = MaybeFinishLocked(call);
+  }
+  if (reply) Reply(call.get());
+}
+
+void GrpcRecvTensorsTable::OnRecvDone(Entry* entry, const Status& s) {
+  std::shared_ptr<Call> call;
+  bool reply = false;
+  {
+    mutex_lock l(mu_);
+    entry->done = true;
+    entry->status = s;
+    const int64 request_id = entry->request.request_id();
+    if (entry->waiter != nullptr) {
+      call = std::move(entry->waiter);
+      DeliverLocked(entry, entry->index, call.get());
+      entries_.erase(request_id);
+      reply = MaybeFinishLocked(call);
+    } else if (entry->orphaned) {
+      entries_.erase(request_id);
+    }
+  }
+  if (reply) Reply(call.get());
+}
+
+void GrpcRecvTensorsTable::DeliverLocked(Entry* entry, int index, Call* call) {
+  if (!entry->status.ok()) {
+    call->status.Update(entry->status);
+    return;
+  }
+  call->ready_indices.push_back(index);
+  call->ready_responses.emplace_back();
+  call->ready_responses.back().Swap(&entry->response);
+}
+
+bool GrpcRecvTensorsTable::MaybeFinishLocked(
+    const std::shared_ptr<Call>& call) {
+  if (!call->started || call->finished) return false;
+  const int num_requests = call->request->request_size();
+  if (call->status.ok() && call->ready_indices.empty() && num_requests > 0) {
+    return false;
+  }
+  call->finished = true;
+  // The sub-requests that are still pending wait for the next call that asks
+  // for them.
+  for (int i = 0; i < num_requests; ++i) {
+    auto it = entries_.find(call->request->request(i).request_id());
+    if (it != entries_.end() && it->second->waiter == call) {
+      it->second->waiter = nullptr;
+      it->second->index = -1;
+    }
+  }
+  return true;
+}
+
+void GrpcRecvTensorsTable::Reply(Call* call) {
+  if (call->status.ok()) {
+    std::vector<::grpc::Slice> slices;
+    for (::grpc::ByteBuffer& sub_response : call->ready_responses) {
+      AppendLengthDelimited(RecvTensorsResponse::kResponseFieldNumber,
+                            &sub_response, &slices);
+    }
+    for (int index : call->ready_indices) {
+      AppendVarint(RecvTensorsResponse::kIndexFieldNumber, index, &slices);
+    }
+    if (slices.empty()) {
+      call->response->Clear();
+    } else {
+      ::grpc::ByteBuffer fused(slices.data(), slices.size());
+      call->response->Swap(&fused);
+    }
+  }
+  VLOG(2) << "RecvTensors answered " << call->ready_indices.size() << " of "
+          << call->request->request_size() << " tensors";
+  call->done(call->status);
+}
+
+void GrpcRecvTensorsTable::CleanEntriesForStep(int64 step_id) {
+  mutex_lock l(mu_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    Entry* entry = it->second.get();
+    if (entry->request.step_id() != step_id || entry->waiter != nullptr) {
+      ++it;
+      continue;
+    }
+    if (entry->done) {
+      entries_.erase(it++);
+    } else {
+      // The sub-request still uses the entry.
+      entry->orphaned = true;
+      ++it;
+    }
+  }
+}
+
+}  // namespace tensorflow
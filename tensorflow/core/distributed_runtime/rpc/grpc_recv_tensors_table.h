@@ -0,0 +1,98 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_RECV_TENSORS_TABLE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_RECV_TENSORS_TABLE_H_
+
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Serves the sub-requests of RecvTensors calls.
+//
+// A RecvTensors call may fuse recvs whose tensors depend on each other through
+// other workers, e.g. the receiver needs the first tensor to produce an input
+// of the second one. The call therefore must not wait for all its tensors.
+// Instead, it is answered as soon as at least one of them is ready, with all
+// the ready ones. The sub-requests that are still pending stay in the table,
+// and are answered by a later RecvTensors call that asks for the same request
+// ids.
+//
+// The response of a call is a RecvTensorsResponse whose `index` field gives,
+// for each of its `response`s, the position of the sub-request it answers.
+class GrpcRecvTensorsTable {
+ public:
+  // Starts a single RecvTensor sub-request, which runs `done` once its
+  // response is encoded into `*response`. `opts`, `request` and `response`
+  // outlive the sub-request.
+  using StartRecvFn = std::function<void(
+      CallOptions* opts, const RecvTensorRequest* request,
+      ::grpc::ByteBuffer* response, StatusCallback done)>;
+
+  // The table must outlive the sub-requests it starts.
+  GrpcRecvTensorsTable() = default;
+  ~GrpcRecvTensorsTable();
+
+  // Answers `request` into `*response`, starting the sub-requests that are not
+  // in the table yet with `start_recv`. Runs `done` once some tensors are
+  // ready, or with the first error of a sub-request.
+  void RecvTensorsAsync(const RecvTensorsRequest* request,
+                        ::grpc::ByteBuffer* response,
+                        const StartRecvFn& start_recv, StatusCallback done);
+
+  // Drops the pending sub-requests of `step_id`, e.g. because the receiver
+  // gave up on them.
+  void CleanEntriesForStep(int64 step_id);
+
+ private:
+  struct Call;
+  struct Entry;
+
+  // Called when the sub-request of `entry` is done.
+  void OnRecvDone(Entry* entry, const Status& s);
+
+  // Moves the result of `entry`, which is done, into `call` as the answer to
+  // its `index`th sub-request.
+  static void DeliverLocked(Entry* entry, int index, Call* call);
+
+  // Returns true if `call` can be answered now, in which case the pending
+  // sub-requests are detached from it and the caller must run `Reply()`.
+  bool MaybeFinishLocked(const std::shared_ptr<Call>& call)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Encodes the response of `call` and runs its callback.
+  static void Reply(Call* call);
+
+  mutex mu_;
+  // The sub-requests that are in flight, or done but not answered yet, by
+  // request id.
+  absl::flat_hash_map<int64, std::unique_ptr<Entry>> entries_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GrpcRecvTensorsTable);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_RECV_TENSORS_TABLE_H_
@@ -0,0 +1,216 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_recv_tensors_table.h"
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Starts sub-requests whose response records their request id, and completes
+// them only when the test says so.
+class FakeRecvs {
+ public:
+  GrpcRecvTensorsTable::StartRecvFn start_fn() {
+    return [this](CallOptions* opts, const RecvTensorRequest* request,
+                  ::grpc::ByteBuffer* response, StatusCallback done) {
+      started_.push_back(request->request_id());
+      pending_.push_back({request->request_id(), response, std::move(done)});
+    };
+  }
+
+  // Completes the sub-request `request_id`, which must be in flight.
+  void Complete(int64 request_id, const Status& s = Status::OK()) {
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      if (it->request_id != request_id) continue;
+      Pending pending = std::move(*it);
+      pending_.erase(it);
+      RecvTensorResponse response;
+      response.set_send_start_micros(request_id);
+      CHECK(GrpcMaybeUnparseProto(response, pending.response).ok());
+      pending.done(s);
+      return;
+    }
+    LOG(FATAL) << "No sub-request " << request_id << " in flight";
+  }
+
+  const std::vector<int64>& started() const { return started_; }
+
+ private:
+  struct Pending {
+    int64 request_id;
+    ::grpc::ByteBuffer* response;
+    StatusCallback done;
+  };
+  std::vector<int64> started_;
+  std::vector<Pending> pending_;
+};
+
+RecvTensorsRequest MakeRequest(int64 step_id,
+                               const std::vector<int64>& request_ids) {
+  RecvTensorsRequest request;
+  for (int64 request_id : request_ids) {
+    RecvTensorRequest* sub_request = request.add_request();
+    sub_request->set_step_id(step_id);
+    sub_request->set_request_id(request_id);
+  }
+  return request;
+}
+
+// A RecvTensors call and its outcome.
+struct Call {
+  explicit Call(RecvTensorsRequest request) : request(std::move(request)) {}
+
+  void Start(GrpcRecvTensorsTable* table, FakeRecvs* recvs) {
+    table->RecvTensorsAsync(&request, &response, recvs->start_fn(),
+                            [this](const Status& s) {
+                              done = true;
+                              status = s;
+                            });
+  }
+
+  // Returns the request ids answered by the call, by position.
+  std::vector<std::pair<int, int64>> Answers() {
+    RecvTensorsResponse parsed;
+    CHECK(GrpcMaybeParseProto(&response, &parsed));
+    CHECK_EQ(parsed.response_size(), parsed.index_size());
+    std::vector<std::pair<int, int64>> answers;
+    for (int i = 0; i < parsed.response_size(); ++i) {
+      answers.emplace_back(parsed.index(i),
+                           parsed.response(i).send_start_micros());
+    }
+    return answers;
+  }
+
+  RecvTensorsRequest request;
+  ::grpc::ByteBuffer response;
+  bool done = false;
+  Status status;
+};
+
+using Answers = std::vector<std::pair<int, int64>>;
+
+TEST(GrpcRecvTensorsTableTest, AnswersOnceSomeTensorIsReady) {
+  GrpcRecvTensorsTable table;
+  FakeRecvs recvs;
+  Call call(MakeRequest(1, {10, 11, 12}));
+  call.Start(&table, &recvs);
+  EXPECT_FALSE(call.done);
+  recvs.Complete(11);
+  EXPECT_TRUE(call.done);
+  TF_EXPECT_OK(call.status);
+  EXPECT_EQ(Answers({{1, 11}}), call.Answers());
+}
+
+// The first tensor of a call is only produced once the receiver has the
+// second one, e.g. because it feeds a computation on another worker that
+// produces the first tensor. The call must not wait for both.
+TEST(GrpcRecvTensorsTableTest, CrossWorkerDependency) {
+  GrpcRecvTensorsTable table;
+  FakeRecvs recvs;
+  Call first(MakeRequest(1, {20, 21}));
+  first.Start(&table, &recvs);
+  recvs.Complete(21);
+  ASSERT_TRUE(first.done);
+  TF_ASSERT_OK(first.status);
+  EXPECT_EQ(Answers({{1, 21}}), first.Answers());
+
+  // The receiver asks for the remaining tensor again, which the worker
+  // produces only now.
+  Call second(MakeRequest(1, {20}));
+  second.Start(&table, &recvs);
+  EXPECT_FALSE(second.done);
+  recvs.Complete(20);
+  ASSERT_TRUE(second.done);
+  TF_ASSERT_OK(second.status);
+  EXPECT_EQ(Answers({{0, 20}}), second.Answers());
+
+  // Each sub-request was started once.
+  EXPECT_EQ(std::vector<int64>({20, 21}), recvs.started());
+}
+
+TEST(GrpcRecvTensorsTableTest, KeepsTensorsReadyBetweenCalls) {
+  GrpcRecvTensorsTable table;
+  FakeRecvs recvs;
+  Call first(MakeRequest(1, {30, 31, 32}));
+  first.Start(&table, &recvs);
+  recvs.Complete(32);
+  ASSERT_TRUE(first.done);
+  EXPECT_EQ(Answers({{2, 32}}), first.Answers());
+
+  // Both remaining tensors become ready before they are asked for again.
+  recvs.Complete(30);
+  recvs.Complete(31);
+  Call second(MakeRequest(1, {31, 30}));
+  second.Start(&table, &recvs);
+  ASSERT_TRUE(second.done);
+  TF_ASSERT_OK(second.status);
+  EXPECT_EQ(Answers({{0, 31}, {1, 30}}), second.Answers());
+  EXPECT_EQ(std::vector<int64>({30, 31, 32}), recvs.started());
+}
+
+TEST(GrpcRecvTensorsTableTest, ErrorFailsCall) {
+  GrpcRecvTensorsTable table;
+  FakeRecvs recvs;
+  Call call(MakeRequest(1, {40, 41}));
+  call.Start(&table, &recvs);
+  recvs.Complete(41, errors::Aborted("step aborted"));
+  ASSERT_TRUE(call.done);
+  EXPECT_TRUE(errors::IsAborted(call.status));
+  // The other sub-request is still in flight, and dropped once done.
+  table.CleanEntriesForStep(1);
+  recvs.Complete(40, errors::Aborted("step aborted"));
+}
+
+TEST(GrpcRecvTensorsTableTest, RejectsRequestsWithoutId) {
+  GrpcRecvTensorsTable table;
+  FakeRecvs recvs;
+  Call call(MakeRequest(1, {0}));
+  call.Start(&table, &recvs);
+  ASSERT_TRUE(call.done);
+  EXPECT_TRUE(errors::IsInvalidArgument(call.status));
+  EXPECT_TRUE(recvs.started().empty());
+}
+
+TEST(GrpcRecvTensorsTableTest, CleanEntriesForStep) {
+  GrpcRecvTensorsTable table;
+  FakeRecvs recvs;
+  Call first(MakeRequest(1, {50, 51}));
+  first.Start(&table, &recvs);
+  recvs.Complete(50);
+  recvs.Complete(51);
+  ASSERT_TRUE(first.done);
+  EXPECT_EQ(Answers({{0, 50}}), first.Answers());
+
+  // The receiver gave up on the step, so the ready tensor is dropped, and a
+  // new request with the same id starts over.
+  table.CleanEntriesForStep(1);
+  Call second(MakeRequest(1, {51}));
+  second.Start(&table, &recvs);
+  EXPECT_FALSE(second.done);
+  recvs.Complete(51);
+  ASSERT_TRUE(second.done);
+  EXPECT_EQ(std::vector<int64>({50, 51, 51}), recvs.started());
+}
+
+}  // namespace
+}  // namespace tensorflow
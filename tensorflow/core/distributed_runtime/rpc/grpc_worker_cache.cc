@@ -39,7 +39,17 @@ class GrpcWorkerCache : public WorkerCachePartial {
         local_worker_(local_worker),
         channel_cache_(channel_cache),
         worker_env_(worker_env),
-        next_round_robin_assignment_(0) {}
+        next_round_robin_assignment_(0) {
+    bool prewarm_channels = false;
+    Status status = ReadBoolFromEnvVar("TF_GRPC_WORKER_CACHE_PREWARM",
+                                       false, &prewarm_channels);
+    if (!status.ok()) {
+      LOG(ERROR) << "Error parsing TF_GRPC_WORKER_CACHE_PREWARM: " << status;
+    }
+    if (prewarm_channels) {
+      PrewarmChannels();
+    }
+  }
 
   void ListWorkers(std::vector<string>* workers) const override {
     channel_cache_->ListWorkers(workers);
@@ -89,6 +99,25 @@ class GrpcWorkerCache : public WorkerCachePartial {
   }
 
  private:
+  // Creates the channels to all remote workers and starts connecting them in
+  // the background, so that a large job does not pay for its connections one
+  // by one on the first RPC to each worker.
+  void PrewarmChannels() {
+    std::vector<string> workers;
+    ListWorkers(&workers);
+    for (const string& target : workers) {
+      if (target == local_target_) continue;
+      worker_env_->GetThreadPool()->Schedule(
+          [channel_cache = channel_cache_, target]() {
+            SharedGrpcChannelPtr channel =
+                channel_cache->FindWorkerChannel(target);
+            if (channel) {
+              channel->GetState(/*try_to_connect=*/true);
+            }
+          });
+    }
+  }
+
   size_t AssignWorkerToThread(const string& target) {
     // Round-robin target assignment, but keeps the same target on the same
     // polling thread always, as this is important for gRPC performance
@@ -39,17 +39,20 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -157,6 +160,13 @@ class GrpcWorkerServiceThread {
          ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_, static_cast<int>(GrpcWorkerMethod::kRecvTensors),
+                 100);
+         ++i) {
+      EnqueueRecvTensorsRequestRaw();
+    }
 
     void* tag;
     bool ok;
@@ -239,7 +249,12 @@ class GrpcWorkerServiceThread {
   }
 
   void RunGraphHandler(WorkerCall<RunGraphRequest, RunGraphResponse>* call) {
-    Schedule([this, call]() {
+    const uint64 enqueue_micros = Env::Default()->NowMicros();
+    Schedule([this, call, enqueue_micros]() {
+      const uint64 start_micros = Env::Default()->NowMicros();
+      metrics::RecordDistributedStepPhase(
+          metrics::DistributedStepPhase::kWorkerQueue,
+          start_micros - enqueue_micros);
       CallOptions* call_opts = new CallOptions;
       ProtoRunGraphRequest* wrapped_request =
           new ProtoRunGraphRequest(&call->request);
@@ -248,8 +263,12 @@ class GrpcWorkerServiceThread {
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->RunGraphAsync(call_opts, wrapped_request, wrapped_response,
                              [call, call_opts, wrapped_request,
-                              wrapped_response](const Status& s) {
+                              wrapped_response, start_micros](const Status& s) {
                                VLOG(1) << "RunGraph::Done";
+                               metrics::RecordDistributedStepPhase(
+                                   metrics::DistributedStepPhase::
+                                       kWorkerRunGraph,
+                                   Env::Default()->NowMicros() - start_micros);
                                if (!s.ok()) {
                                  VLOG(1) << "Bad response from RunGraph:" << s;
                                }
@@ -283,6 +302,26 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorsHandlerRaw(
+      WorkerCall<RecvTensorsRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+
+      worker_->GrpcRecvTensorsAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(1) << "Bad response from RecvTensors:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    EnqueueRecvTensorsRequestRaw();
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -352,6 +391,19 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueRecvTensorsRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+           RecvTensorsRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kRecvTensors),
+              &GrpcWorkerServiceThread::RecvTensorsHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -447,11 +499,22 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  const TensorWireCodec wire_codec = request->wire_codec();
+  auto do_response = [response, done, cache_enabled, wire_codec](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      RecvTensorResponse encoded;
+      if (wire_codec != TENSOR_WIRE_CODEC_NONE && !is_dead &&
+          EncodeTensorForWire(tensor, wire_codec, encoded.mutable_tensor())) {
+        encoded.set_wire_codec(wire_codec);
+        encoded.set_require_ack(cache_enabled);
+        encoded.set_send_start_micros(Env::Default()->NowMicros());
+        grpc::EncodeRecvTensorResponseToByteBuffer(encoded, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -508,13 +571,17 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   // the client.
   opts->SetCancelCallback(
       [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
+  const uint64 wait_micros = Env::Default()->NowMicros();
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      [opts, rendezvous_done, src_dev, request, wait_micros](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
         opts->ClearCancelCallback();
+        metrics::RecordDistributedStepPhase(
+            metrics::DistributedStepPhase::kWorkerRendezvousWait,
+            Env::Default()->NowMicros() - wait_micros);
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
           // the following three odd edge cases: 1) a zero-size
@@ -555,6 +622,24 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::GrpcRecvTensorsAsync(CallOptions* opts,
+                                      const RecvTensorsRequest* request,
+                                      ::grpc::ByteBuffer* response,
+                                      StatusCallback done) {
+  VLOG(1) << "GrpcRecvTensorsAsync req: " << request->request_size()
+          << " tensors";
+  // The sub-requests are independent RecvTensor calls, which are not
+  // cancelled with the fused call, as in `GrpcRecvTensorAsync()`.
+  recv_tensors_table_.RecvTensorsAsync(
+      request, response,
+      [this](CallOptions* sub_opts, const RecvTensorRequest* sub_request,
+             ::grpc::ByteBuffer* sub_response, StatusCallback sub_done) {
+        GrpcRecvTensorAsync(sub_opts, sub_request, sub_response,
+                            std::move(sub_done));
+      },
+      std::move(done));
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -734,6 +819,7 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  recv_tensors_table_.CleanEntriesForStep(request->step_id());
   Worker::CleanupGraphAsync(request, response, done);
 }
 
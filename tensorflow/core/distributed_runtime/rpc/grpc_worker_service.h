@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_recv_tensors_table.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -46,6 +47,16 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Receives the tensors of a fused RecvTensors call. Like
+  // `GrpcRecvTensorAsync()`, the response is generated directly into a
+  // ::grpc::ByteBuffer, whose wire format is a RecvTensorsResponse. The call
+  // is answered once some of the tensors are ready; see
+  // GrpcRecvTensorsTable.
+  virtual void GrpcRecvTensorsAsync(CallOptions* opts,
+                                    const RecvTensorsRequest* request,
+                                    ::grpc::ByteBuffer* response,
+                                    StatusCallback done);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -64,6 +75,7 @@ class GrpcWorker : public Worker {
 
  private:
   std::unique_ptr<GrpcResponseCache> response_cache_;
+  GrpcRecvTensorsTable recv_tensors_table_;
   const int32 recv_buf_max_chunk_;
 };
 
@@ -15,16 +15,23 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <algorithm>
 #include <unordered_set>
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -33,15 +40,101 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Returns the window, in microseconds, within which recvs from the same remote
+// worker are fused into a single RecvTensors call. Fusion is disabled when the
+// window is 0, which is the default.
+int64 ReadRecvTensorFusionWindowMicros() {
+  int64 value;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_FUSION_WINDOW_USECS", 0,
+                                  &value));
+  return value;
+}
+
+// Returns the maximum number of recvs fused into a single RecvTensors call. A
+// batch that reaches this size is sent without waiting for its window to end.
+int64 ReadRecvTensorFusionMaxBatchSize() {
+  int64 value;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_FUSION_MAX_BATCH_SIZE",
+                                  128, &value));
+  return std::max<int64>(value, 1);
+}
+
+// Returns the wire codecs the receiver asks senders to encode tensors with.
+// TF_RPC_RECV_TENSOR_WIRE_CODEC ("none", "bfloat16" or "snappy") is the codec,
+// and TF_RPC_RECV_TENSOR_WIRE_CODEC_TENSORS a comma-separated list of
+// substrings of the names of the tensors it applies to, e.g. "gradients/". A
+// lossy codec such as bfloat16 applies to no tensor without that list.
+TensorWireCodecPolicy ReadRecvTensorWireCodecPolicy() {
+  string name;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_RPC_RECV_TENSOR_WIRE_CODEC", "", &name));
+  TensorWireCodec codec = TENSOR_WIRE_CODEC_NONE;
+  Status s = ParseTensorWireCodec(name, &codec);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_RPC_RECV_TENSOR_WIRE_CODEC: " << s;
+    return TensorWireCodecPolicy();
+  }
+  string patterns;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_RPC_RECV_TENSOR_WIRE_CODEC_TENSORS", "",
+                                   &patterns));
+  std::vector<string> tensor_name_patterns =
+      str_util::Split(patterns, ',', str_util::SkipEmpty());
+  if (tensor_name_patterns.empty() && !IsLosslessTensorWireCodec(codec)) {
+    LOG(WARNING) << "TF_RPC_RECV_TENSOR_WIRE_CODEC=" << name << " is lossy, "
+                 << "and is not used until TF_RPC_RECV_TENSOR_WIRE_CODEC_"
+                 << "TENSORS names the tensors it applies to.";
+  }
+  return TensorWireCodecPolicy(codec, std::move(tensor_name_patterns));
+}
+
+// Reads the wire codecs once per process rather than for every step.
+const TensorWireCodecPolicy& GetRecvTensorWireCodecPolicy() {
+  static const TensorWireCodecPolicy* policy =
+      new TensorWireCodecPolicy(ReadRecvTensorWireCodecPolicy());
+  return *policy;
+}
+
+// Remembers the remote workers that do not implement the RecvTensors method,
+// so that recvs from them are not fused again.
+class UnfusedWorkers {
+ public:
+  static UnfusedWorkers* Global() {
+    static UnfusedWorkers* workers = new UnfusedWorkers;
+    return workers;
+  }
+
+  bool Contains(const string& worker) {
+    tf_shared_lock l(mu_);
+    return workers_.contains(worker);
+  }
+
+  void Insert(const string& worker) {
+    mutex_lock l(mu_);
+    if (workers_.insert(worker).second) {
+      LOG(INFO) << "Worker " << worker << " does not support RecvTensors. "
+                << "Recvs from it will not be fused.";
+    }
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_set<string> workers_ TF_GUARDED_BY(mu_);
+};
+
+class RpcRecvTensorsCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+      : BaseRemoteRendezvous(env, step_id),
+        fusion_window_micros_(ReadRecvTensorFusionWindowMicros()),
+        fusion_max_batch_size_(ReadRecvTensorFusionMaxBatchSize()),
+        wire_codec_policy_(GetRecvTensorWireCodecPolicy()) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,8 +142,34 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
+  // Recvs are fused per source worker and cancellation manager, so that a
+  // fused call is cancelled together with the recvs it serves.
+  using BatchKey = std::pair<string, CancellationManager*>;
+
   ~RpcRemoteRendezvous() override {}
 
+  // Receives one tensor from a remote worker with a RecvTensor call.
+  void RecvFromRemoteUnfusedAsync(const Rendezvous::ParsedKey& parsed,
+                                  const Rendezvous::Args& recv_args,
+                                  DoneCallback done);
+
+  // Sends the pending batch of `key` if its id is `batch_id`.
+  void FlushBatch(const BatchKey& key, int64 batch_id);
+
+  // Sends `call` to its source worker, and takes ownership of it. Once the
+  // worker answers, the recvs it did not answer yet are asked for again.
+  void StartFusedCall(RpcRecvTensorsCall* call);
+
+  const int64 fusion_window_micros_;
+  const int64 fusion_max_batch_size_;
+  const TensorWireCodecPolicy& wire_codec_policy_;
+
+  mutex fusion_mu_;
+  int64 next_batch_id_ TF_GUARDED_BY(fusion_mu_) = 0;
+  // The batches of recvs waiting for their window to end.
+  absl::flat_hash_map<BatchKey, RpcRecvTensorsCall*> pending_batches_
+      TF_GUARDED_BY(fusion_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -60,8 +179,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
 
   void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
-            AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            TensorWireCodec wire_codec, AllocatorAttributes alloc_attrs,
+            Device* dst_device, const Rendezvous::Args& recv_args,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -70,6 +190,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    req_.set_wire_codec(wire_codec);
   }
 
   void Reset() {
@@ -230,10 +351,312 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve several tensors from the same remote process with a single
+// RecvTensors call.
+class RpcRecvTensorsCall : public BaseRecvTensorCall {
+ public:
+  // A recv served by the call.
+  struct Recv {
+    string key;
+    // Set once the recv has been sent to the source worker, which then
+    // identifies it by this id.
+    int64 request_id = 0;
+    TensorWireCodec wire_codec = TENSOR_WIRE_CODEC_NONE;
+    AllocatorAttributes alloc_attrs;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  // `resumes_pending` is true if the call asks for recvs that a previous call
+  // left pending on the worker.
+  RpcRecvTensorsCall(const string& src_worker, int64 batch_id,
+                     bool resumes_pending = false)
+      : src_worker_(src_worker),
+        batch_id_(batch_id),
+        resumes_pending_(resumes_pending),
+        wi_(nullptr) {}
+
+  ~RpcRecvTensorsCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorsCall destructor.";
+  }
+
+  void AddRecv(int64 step_id, Recv recv) {
+    RecvTensorRequest* request = req_.add_request();
+    request->set_step_id(step_id);
+    request->set_rendezvous_key(recv.key);
+    if (recv.request_id == 0) {
+      recv.request_id = GetUniqueRequestId();
+    }
+    request->set_request_id(recv.request_id);
+    request->set_wire_codec(recv.wire_codec);
+    recvs_.push_back(std::move(recv));
+  }
+
+  void SetWorker(WorkerInterface* wi) { wi_ = wi; }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    DCHECK_NE(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "RpcRecvTensorsCall::ReleaseWorker() called twice.";
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      // Make sure the Rendezvous abort checking is finished before running the
+      // callback, which might destroy the current call object.
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorsAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // NOTE: As in `RpcRecvTensorCall`, check if the rendezvous was aborted
+    // after sending out the RPC.
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  // Runs the done callback of every recv answered by the response with its
+  // tensor if `s` is OK, and of every recv with `s` otherwise. Moves the recvs
+  // that the worker left pending to `*pending`.
+  void Finish(const Status& s, std::vector<Recv>* pending) {
+    Status status = s;
+    // Workers answer all the recvs at once unless they say otherwise.
+    const bool has_index = resp_.index_size() > 0;
+    if (status.ok() &&
+        (has_index ? resp_.index_size() != resp_.response_size()
+                   : resp_.response_size() != req_.request_size())) {
+      status = errors::Internal("RecvTensors returned ", resp_.response_size(),
+                                " tensors and ", resp_.index_size(),
+                                " indices for ", req_.request_size(),
+                                " requests");
+    }
+    std::vector<bool> answered(recvs_.size(), !status.ok());
+    for (int i = 0; status.ok() && i < resp_.response_size(); ++i) {
+      const int index = has_index ? resp_.index(i) : i;
+      if (index < 0 || index >= static_cast<int>(recvs_.size()) ||
+          answered[index]) {
+        status = errors::Internal("RecvTensors returned an invalid index ",
+                                  index, " for ", req_.request_size(),
+                                  " requests");
+        break;
+      }
+      answered[index] = true;
+      Recv& recv = recvs_[index];
+      TensorResponse response;
+      response.InitAlloc(recv.dst_device, recv.alloc_attrs);
+      Status s = response.InitFrom(resp_.mutable_response(i));
+      recv.done(s, Rendezvous::Args(), recv.recv_args, response.tensor(),
+                response.metadata().is_dead());
+      recv.done = nullptr;
+    }
+    for (size_t i = 0; i < recvs_.size(); ++i) {
+      Recv& recv = recvs_[i];
+      if (recv.done == nullptr) continue;
+      if (!status.ok()) {
+        recv.done(status, Rendezvous::Args(), recv.recv_args, Tensor(), false);
+      } else if (!answered[i]) {
+        pending->push_back(std::move(recv));
+      }
+    }
+  }
+
+  const string& src_worker() const { return src_worker_; }
+  int64 batch_id() const { return batch_id_; }
+  bool resumes_pending() const { return resumes_pending_; }
+  size_t num_recvs() const { return recvs_.size(); }
+  std::vector<Recv>* recvs() { return &recvs_; }
+
+ private:
+  const string src_worker_;
+  const int64 batch_id_;
+  const bool resumes_pending_;
+  WorkerInterface* wi_;  // Not owned.
+  CallOptions opts_;
+  RecvTensorsRequest req_;
+  RecvTensorsResponse resp_;
+  std::vector<Recv> recvs_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorsCall);
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  string src_worker;
+  string src_rel_device;
+  Device* dst_device;
+  // Invalid keys are reported by the unfused path.
+  if (fusion_window_micros_ <= 0 ||
+      !DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device) ||
+      UnfusedWorkers::Global()->Contains(src_worker) ||
+      !session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device)
+           .ok()) {
+    RecvFromRemoteUnfusedAsync(parsed, recv_args, std::move(done));
+    return;
+  }
+
+  RpcRecvTensorsCall::Recv recv;
+  recv.key = string(parsed.FullKey());
+  recv.wire_codec = wire_codec_policy_.CodecFor(parsed.edge_name);
+  recv.alloc_attrs = recv_args.alloc_attrs;
+  recv.dst_device = dst_device;
+  recv.recv_args = recv_args;
+  recv.done = std::move(done);
+
+  const BatchKey key(src_worker, recv_args.cancellation_manager);
+  RpcRecvTensorsCall* full_batch = nullptr;
+  int64 new_batch_id = -1;
+  {
+    mutex_lock l(fusion_mu_);
+    RpcRecvTensorsCall*& batch = pending_batches_[key];
+    if (batch == nullptr) {
+      new_batch_id = next_batch_id_++;
+      batch = new RpcRecvTensorsCall(src_worker, new_batch_id);
+    }
+    batch->AddRecv(step_id_, std::move(recv));
+    if (static_cast<int64>(batch->num_recvs()) >= fusion_max_batch_size_) {
+      full_batch = batch;
+      pending_batches_.erase(key);
+    }
+  }
+  if (full_batch != nullptr) {
+    StartFusedCall(full_batch);
+  }
+  if (new_batch_id >= 0 && full_batch == nullptr) {
+    Ref();
+    env_->env->SchedClosureAfter(fusion_window_micros_,
+                                 [this, key, new_batch_id]() {
+                                   FlushBatch(key, new_batch_id);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const BatchKey& key, int64 batch_id) {
+  RpcRecvTensorsCall* call = nullptr;
+  {
+    mutex_lock l(fusion_mu_);
+    auto it = pending_batches_.find(key);
+    // The batch may have been sent early because it was full.
+    if (it == pending_batches_.end() || it->second->batch_id() != batch_id) {
+      return;
+    }
+    call = it->second;
+    pending_batches_.erase(it);
+  }
+  StartFusedCall(call);
+}
+
+void RpcRemoteRendezvous::StartFusedCall(RpcRecvTensorsCall* call) {
+  // A recv left pending on the worker can only be resumed by RecvTensors.
+  if (call->num_recvs() == 1 && !call->resumes_pending()) {
+    // Fusion would only add copies.
+    RpcRecvTensorsCall::Recv& recv = call->recvs()->front();
+    Rendezvous::ParsedKey parsed;
+    TF_CHECK_OK(Rendezvous::ParseKey(recv.key, &parsed));
+    RecvFromRemoteUnfusedAsync(parsed, recv.recv_args, std::move(recv.done));
+    delete call;
+    return;
+  }
+
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(call->src_worker());
+  std::vector<RpcRecvTensorsCall::Recv> pending;
+  if (rwi == nullptr) {
+    call->Finish(errors::Internal("No worker known as ", call->src_worker()),
+                 &pending);
+    delete call;
+    return;
+  }
+  call->SetWorker(rwi);
+
+  // All the recvs of the call share their cancellation manager.
+  RegisterCall(call, call->recvs()->front().recv_args);
+  if (!call->status().ok()) {
+    DeregisterCall(call);
+    call->ReleaseWorker(sess->worker_cache());
+    call->Finish(call->status(), &pending);
+    delete call;
+    return;
+  }
+
+  Ref();
+  const uint64 start_micros = env_->env->NowMicros();
+  call->Start([this, call, worker_cache, start_micros]() {
+    DeregisterCall(call);
+    Status s = call->status();
+    call->ReleaseWorker(session()->worker_cache());
+    if (errors::IsUnimplemented(s) && !call->resumes_pending()) {
+      // The source worker predates RecvTensors, so receive the tensors one at
+      // a time.
+      UnfusedWorkers::Global()->Insert(call->src_worker());
+      for (RpcRecvTensorsCall::Recv& recv : *call->recvs()) {
+        Rendezvous::ParsedKey parsed;
+        TF_CHECK_OK(Rendezvous::ParseKey(recv.key, &parsed));
+        RecvFromRemoteUnfusedAsync(parsed, recv.recv_args,
+                                   std::move(recv.done));
+      }
+    } else {
+      metrics::RecordRecvTensorFusedBatch(
+          call->num_recvs(), env_->env->NowMicros() - start_micros);
+      std::vector<RpcRecvTensorsCall::Recv> pending;
+      call->Finish(s, &pending);
+      if (!pending.empty()) {
+        // The tensors of these recvs were not ready yet, and may depend on
+        // the ones that were just received.
+        RpcRecvTensorsCall* resumed =
+            new RpcRecvTensorsCall(call->src_worker(), /*batch_id=*/-1,
+                                   /*resumes_pending=*/true);
+        for (RpcRecvTensorsCall::Recv& recv : pending) {
+          resumed->AddRecv(step_id_, std::move(recv));
+        }
+        StartFusedCall(resumed);
+      }
+    }
+    delete call;
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::RecvFromRemoteUnfusedAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -269,8 +692,9 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+  call->Init(rwi, step_id_, parsed.FullKey(),
+             wire_codec_policy_.CodecFor(parsed.edge_name),
+             recv_args.alloc_attrs, dst_device, recv_args, std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
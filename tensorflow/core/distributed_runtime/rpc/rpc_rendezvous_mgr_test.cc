@@ -15,13 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <map>
+
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,6 +71,66 @@ class DummyWorker : public TestWorkerInterface {
       done(Status::OK());
     });
   }
+
+  // Returns a string tensor holding the name of each requested tensor. The
+  // tensors whose name starts with "after_" are only ready once
+  // `ReleaseDependentTensors()` has been called, and are left pending until
+  // then, like GrpcWorker does.
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    Status s;
+    {
+      mutex_lock l(*fused_batch_sizes_mu());
+      fused_batch_sizes()->push_back(request->request_size());
+      for (int i = 0; i < request->request_size(); ++i) {
+        const RecvTensorRequest& sub_request = request->request(i);
+        Rendezvous::ParsedKey parsed;
+        TF_CHECK_OK(
+            Rendezvous::ParseKey(sub_request.rendezvous_key(), &parsed));
+        const string name(parsed.edge_name);
+        // A pending recv is asked for again with the same request id.
+        auto it = request_ids()->emplace(name, sub_request.request_id()).first;
+        if (it->second != sub_request.request_id()) {
+          s = errors::InvalidArgument("New request id for pending ", name);
+        }
+        if (absl::StartsWith(name, "after_") && !*dependent_tensors_ready()) {
+          continue;
+        }
+        V(name).AsProtoField(response->add_response()->mutable_tensor());
+        response->add_index(i);
+      }
+    }
+    if (s.ok() && response->response_size() == 0) {
+      s = errors::Internal("No tensor is ready");
+    }
+    SchedClosure([done = std::move(done), s]() { done(s); });
+  }
+
+  static void ReleaseDependentTensors() {
+    mutex_lock l(*fused_batch_sizes_mu());
+    *dependent_tensors_ready() = true;
+  }
+
+  // The number of tensors of each RecvTensors call.
+  static mutex* fused_batch_sizes_mu() {
+    static mutex* mu = new mutex;
+    return mu;
+  }
+  static std::vector<int>* fused_batch_sizes() {
+    static std::vector<int>* sizes = new std::vector<int>;
+    return sizes;
+  }
+
+ private:
+  static bool* dependent_tensors_ready() {
+    static bool* ready = new bool(false);
+    return ready;
+  }
+  static std::map<string, int64>* request_ids() {
+    static std::map<string, int64>* ids = new std::map<string, int64>;
+    return ids;
+  }
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -100,7 +165,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return Status::OK(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -344,4 +411,112 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvFused) {
+  const int64 step_id = 123;
+  {
+    mutex_lock l(*DummyWorker::fused_batch_sizes_mu());
+    DummyWorker::fused_batch_sizes()->clear();
+  }
+  setenv("TF_RPC_RECV_TENSOR_FUSION_WINDOW_USECS", "100000", 1);
+  setenv("TF_RPC_RECV_TENSOR_FUSION_MAX_BATCH_SIZE", "4", 1);
+  RemoteRendezvous* rendez = rmgr_.Find(step_id);
+  unsetenv("TF_RPC_RECV_TENSOR_FUSION_WINDOW_USECS");
+  unsetenv("TF_RPC_RECV_TENSOR_FUSION_MAX_BATCH_SIZE");
+  {
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    Rendezvous::Args args;
+
+    // Two full batches are sent right away, and the third when its window
+    // ends.
+    const int num_requests = 10;
+    std::vector<Tensor> vals(num_requests);
+    mutex mu;
+    Status status = Status::OK();
+    BlockingCounter counter(num_requests);
+    for (int i = 0; i < num_requests; i++) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          key, args,
+          [&mu, &status, &counter, &vals, i](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              vals[i] = val;
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    for (int i = 0; i < num_requests; i++) {
+      EXPECT_EQ(strings::StrCat("foo", i), V(vals[i]));
+    }
+  }
+  rmgr_.Cleanup(step_id);
+
+  mutex_lock l(*DummyWorker::fused_batch_sizes_mu());
+  EXPECT_EQ(std::vector<int>({4, 4, 2}), *DummyWorker::fused_batch_sizes());
+}
+
+// "after_bar" is only produced once the receiver has "bar", e.g. because "bar"
+// feeds a computation on another worker whose output is needed to produce
+// "after_bar". Both are fused into one call, which must not wait for both.
+TEST_F(RpcRendezvousMgrTest, RemoteRecvFusedCrossWorkerDependency) {
+  const int64 step_id = 124;
+  {
+    mutex_lock l(*DummyWorker::fused_batch_sizes_mu());
+    DummyWorker::fused_batch_sizes()->clear();
+  }
+  setenv("TF_RPC_RECV_TENSOR_FUSION_WINDOW_USECS", "100000", 1);
+  RemoteRendezvous* rendez = rmgr_.Find(step_id);
+  unsetenv("TF_RPC_RECV_TENSOR_FUSION_WINDOW_USECS");
+  {
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    Rendezvous::Args args;
+
+    const std::vector<string> names = {"after_bar", "bar"};
+    std::vector<Tensor> vals(names.size());
+    mutex mu;
+    Status status = Status::OK();
+    BlockingCounter counter(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", names[i], FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          key, args,
+          [&mu, &status, &counter, &vals, &names, i](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              vals[i] = val;
+            }
+            if (names[i] == "bar") {
+              DummyWorker::ReleaseDependentTensors();
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    for (size_t i = 0; i < names.size(); i++) {
+      EXPECT_EQ(names[i], V(vals[i]));
+    }
+  }
+  rmgr_.Cleanup(step_id);
+
+  // The first call only returns "bar", and "after_bar" is asked for again.
+  mutex_lock l(*DummyWorker::fused_batch_sizes_mu());
+  EXPECT_EQ(std::vector<int>({2, 1}), *DummyWorker::fused_batch_sizes());
+}
+
 }  // namespace tensorflow
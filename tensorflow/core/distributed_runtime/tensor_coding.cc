@@ -15,14 +15,27 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <algorithm>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/casts.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Size of the host buffer through which tensor content is copied to a device
+// when it is parsed.  This bounds the transient host memory of a response to
+// the received buffer plus one chunk, however large the tensor is.
+constexpr int64 kDeviceCopyChunkBytes = 4 << 20;
+
+}  // namespace
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
@@ -50,15 +63,40 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
 
+namespace {
+
+// Replaces the content of `meta->tensor()`, if it is encoded with a wire codec,
+// by the raw bytes of the tensor, for devices that make tensors from protos.
+Status DecodeWireContent(RecvTensorResponse* meta) {
+  if (meta->wire_codec() == TENSOR_WIRE_CODEC_NONE) {
+    return Status::OK();
+  }
+  Tensor decoded;
+  TF_RETURN_IF_ERROR(DecodeTensorFromWire(meta->tensor(), meta->wire_codec(),
+                                          cpu_allocator(), &decoded));
+  meta->clear_tensor();
+  decoded.AsProtoTensorContent(meta->mutable_tensor());
+  meta->set_wire_codec(TENSOR_WIRE_CODEC_NONE);
+  return Status::OK();
+}
+
+}  // namespace
+
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
   if (on_host_) {
-    if (!tensor_.FromProto(allocator_, meta_.tensor())) {
+    if (meta_.wire_codec() != TENSOR_WIRE_CODEC_NONE) {
+      s = DecodeTensorFromWire(meta_.tensor(), meta_.wire_codec(), allocator_,
+                               &tensor_);
+    } else if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
   } else {
-    s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    s = DecodeWireContent(&meta_);
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
   }
   {
     TensorProto empty;
@@ -80,6 +118,14 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
+  if (!on_host_ && CanStreamToDevice()) {
+    if (already_used_) {
+      ClearTensor();
+    }
+    already_used_ = true;
+    if (ParseFast(source)) return Status::OK();
+    ClearTensor();
+  }
   if (!on_host_) {
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
@@ -88,8 +134,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    Status s = DecodeWireContent(&meta_);
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -199,6 +247,11 @@ bool TensorResponse::ParseTensorSubmessage(
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
+        if (!on_host_) {
+          if (!ReadContentToDevice(input, &t)) return false;
+          tensor_ = std::move(t);
+          break;
+        }
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
         // the underlying ZeroCopyInputStream data is properly aligned
         // and compatible with what allocator_ wants.
@@ -216,6 +269,48 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
+bool TensorResponse::CanStreamToDevice() const {
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      device_->tensorflow_gpu_device_info();
+  return gpu_info != nullptr && gpu_info->default_context != nullptr;
+}
+
+bool TensorResponse::ReadContentToDevice(protobuf::io::CodedInputStream* input,
+                                         Tensor* dst) {
+  const int64 total_bytes = dst->TotalBytes();
+  if (total_bytes == 0) return true;
+  // View the destination as bytes so that it can be copied in slices.
+  Tensor dst_bytes;
+  if (!dst_bytes.BitcastFrom(*dst, DT_UINT8, TensorShape({total_bytes})).ok()) {
+    return false;
+  }
+  AllocatorAttributes staging_attrs;
+  staging_attrs.set_on_host(true);
+  staging_attrs.set_gpu_compatible(true);
+  const int64 chunk_bytes = std::min(total_bytes, kDeviceCopyChunkBytes);
+  Tensor staging(device_->GetAllocator(staging_attrs), DT_UINT8,
+                 TensorShape({chunk_bytes}));
+  DeviceContext* device_context =
+      device_->tensorflow_gpu_device_info()->default_context;
+  Device* device = down_cast<Device*>(device_);
+  for (int64 offset = 0; offset < total_bytes; offset += chunk_bytes) {
+    const int64 n = std::min(chunk_bytes, total_bytes - offset);
+    Tensor src = staging.Slice(0, n);
+    if (!input->ReadRaw(const_cast<char*>(src.tensor_data().data()), n)) {
+      return false;
+    }
+    Tensor dst_chunk = dst_bytes.Slice(offset, offset + n);
+    Status s = device_context->CopyCPUTensorToDeviceSync(&src, device,
+                                                         &dst_chunk);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to copy tensor content to " << device_->name()
+              << ": " << s;
+      return false;
+    }
+  }
+  return true;
+}
+
 bool TensorResponse::ParseFast(Source* source) {
   protobuf::io::CodedInputStream input(source->contents());
   input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
@@ -283,7 +378,14 @@ bool TensorResponse::ParseSlow(Source* source) {
   }
 
   Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
+  if (meta_.wire_codec() != TENSOR_WIRE_CODEC_NONE) {
+    // Decode straight into the destination allocator.
+    if (!DecodeTensorFromWire(meta_.tensor(), meta_.wire_codec(), allocator_,
+                              &parsed)
+             .ok()) {
+      return false;
+    }
+  } else if (!parsed.FromProto(allocator_, meta_.tensor())) {
     return false;
   }
   tensor_ = std::move(parsed);
@@ -97,6 +97,14 @@ class TensorResponse {
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
+  // Returns true if the tensor content can be copied to the device in chunks
+  // as it is parsed, instead of being parsed into host memory first.
+  bool CanStreamToDevice() const;
+
+  // Reads `dst->TotalBytes()` bytes of tensor content from `input` into the
+  // device tensor `*dst`, copying them through a bounded host staging buffer.
+  bool ReadContentToDevice(protobuf::io::CodedInputStream* input, Tensor* dst);
+
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +49,51 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// A device context that "copies" to a device whose memory is host memory, and
+// counts the copies.
+class CountingDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    StringPiece src = cpu_tensor->tensor_data();
+    CHECK_EQ(src.size(), device_tensor->TotalBytes());
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()), src.data(),
+           src.size());
+    done(Status::OK());
+  }
+
+  mutable int num_copies_ = 0;
+};
+
+// A non-CPU device whose tensors are copied with a CountingDeviceContext.
+class FakeAcceleratorDevice : public Device {
+ public:
+  explicit FakeAcceleratorDevice(const DeviceAttributes& attrs)
+      : Device(Env::Default(), attrs) {
+    device_context_ = new CountingDeviceContext;
+    gpu_device_info_.default_context = device_context_;
+    set_tensorflow_gpu_device_info(&gpu_device_info_);
+  }
+  ~FakeAcceleratorDevice() override { device_context_->Unref(); }
+
+  static DeviceAttributes Attributes() {
+    DeviceAttributes attrs;
+    attrs.set_name("/job:worker/replica:0/task:0/device:GPU:0");
+    attrs.set_device_type("GPU");
+    return attrs;
+  }
+
+  Status Sync() override { return Status::OK(); }
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+  CountingDeviceContext* device_context_;
+  GpuDeviceInfo gpu_device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +204,54 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, WireCodec) {
+  Tensor src(DT_INT32, TensorShape({4, 1000}));
+  test::FillFn<int32>(&src, [](int i) { return i % 7 == 0 ? i : 0; });
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  ASSERT_TRUE(EncodeTensorForWire(src, TENSOR_WIRE_CODEC_SNAPPY,
+                                  proto.mutable_tensor()));
+  proto.set_wire_codec(TENSOR_WIRE_CODEC_SNAPPY);
+  string encoded;
+  proto.AppendToString(&encoded);
+  EXPECT_LT(encoded.size(), src.TotalBytes());
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(123456, response.metadata().send_start_micros());
+  test::ExpectTensorEqual<int32>(src, response.tensor());
+
+  // The same response received as a proto, e.g. in a RecvTensors call.
+  TensorResponse from_proto;
+  from_proto.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_EXPECT_OK(from_proto.InitFrom(&proto));
+  test::ExpectTensorEqual<int32>(src, from_proto.tensor());
+}
+
+TEST_F(TensorResponseTest, CopiesToDeviceInChunks) {
+  // Larger than one chunk of the host staging buffer.
+  Tensor src(DT_FLOAT, TensorShape({3, 500000}));
+  test::FillFn<float>(&src, [](int i) { return i * 0.5f; });
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1 << 16);
+  FakeAcceleratorDevice device(FakeAcceleratorDevice::Attributes());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(123456, response.metadata().send_start_micros());
+  EXPECT_FALSE(response.metadata().tensor().has_tensor_content());
+  test::ExpectTensorEqual<float>(src, response.tensor());
+  EXPECT_EQ(2, device.device_context_->num_copies_);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
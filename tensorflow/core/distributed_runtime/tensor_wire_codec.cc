@@ -0,0 +1,152 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
+
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace {
+
+// Tensors smaller than this are not worth compressing.
+constexpr size_t kMinSnappyBytes = 1024;
+
+}  // namespace
+
+Status ParseTensorWireCodec(StringPiece name, TensorWireCodec* codec) {
+  const string lower = str_util::Lowercase(name);
+  if (lower.empty() || lower == "none") {
+    *codec = TENSOR_WIRE_CODEC_NONE;
+  } else if (lower == "bfloat16") {
+    *codec = TENSOR_WIRE_CODEC_BFLOAT16;
+  } else if (lower == "snappy") {
+    *codec = TENSOR_WIRE_CODEC_SNAPPY;
+  } else {
+    return errors::InvalidArgument("Unknown tensor wire codec: ", name);
+  }
+  return Status::OK();
+}
+
+bool IsLosslessTensorWireCodec(TensorWireCodec codec) {
+  return codec != TENSOR_WIRE_CODEC_BFLOAT16;
+}
+
+TensorWireCodecPolicy::TensorWireCodecPolicy(
+    TensorWireCodec codec, std::vector<string> tensor_name_patterns)
+    : codec_(codec), tensor_name_patterns_(std::move(tensor_name_patterns)) {}
+
+TensorWireCodec TensorWireCodecPolicy::CodecFor(StringPiece edge_name) const {
+  if (codec_ == TENSOR_WIRE_CODEC_NONE) return codec_;
+  if (tensor_name_patterns_.empty()) {
+    return IsLosslessTensorWireCodec(codec_) ? codec_ : TENSOR_WIRE_CODEC_NONE;
+  }
+  for (const string& pattern : tensor_name_patterns_) {
+    if (absl::StrContains(edge_name, pattern)) return codec_;
+  }
+  return TENSOR_WIRE_CODEC_NONE;
+}
+
+bool EncodeTensorForWire(const Tensor& tensor, TensorWireCodec codec,
+                         TensorProto* proto) {
+  string content;
+  switch (codec) {
+    case TENSOR_WIRE_CODEC_BFLOAT16: {
+      if (tensor.dtype() != DT_FLOAT || tensor.NumElements() == 0) {
+        return false;
+      }
+      const int64 n = tensor.NumElements();
+      content.resize(n * sizeof(bfloat16));
+      RoundFloatToBFloat16(tensor.flat<float>().data(),
+                           reinterpret_cast<bfloat16*>(&content[0]), n);
+      break;
+    }
+    case TENSOR_WIRE_CODEC_SNAPPY: {
+      if (!DataTypeCanUseMemcpy(tensor.dtype()) ||
+          tensor.TotalBytes() < kMinSnappyBytes) {
+        return false;
+      }
+      const StringPiece data = tensor.tensor_data();
+      if (!port::Snappy_Compress(data.data(), data.size(), &content) ||
+          content.size() >= data.size()) {
+        return false;
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+  proto->Clear();
+  proto->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto->mutable_tensor_shape());
+  proto->set_tensor_content(std::move(content));
+  return true;
+}
+
+Status DecodeTensorFromWire(const TensorProto& proto, TensorWireCodec codec,
+                            Allocator* allocator, Tensor* tensor) {
+  if (!TensorShape::IsValid(proto.tensor_shape())) {
+    return errors::InvalidArgument("Invalid shape in encoded tensor");
+  }
+  const TensorShape shape(proto.tensor_shape());
+  const string& content = proto.tensor_content();
+  switch (codec) {
+    case TENSOR_WIRE_CODEC_BFLOAT16: {
+      if (proto.dtype() != DT_FLOAT ||
+          content.size() != shape.num_elements() * sizeof(bfloat16)) {
+        return errors::InvalidArgument(
+            "Invalid bfloat16 encoding of a tensor of type ",
+            DataTypeString(proto.dtype()), " and shape ", shape.DebugString());
+      }
+      Tensor decoded(allocator, DT_FLOAT, shape);
+      BFloat16ToFloat(reinterpret_cast<const bfloat16*>(content.data()),
+                      decoded.flat<float>().data(), shape.num_elements());
+      *tensor = std::move(decoded);
+      return Status::OK();
+    }
+    case TENSOR_WIRE_CODEC_SNAPPY: {
+      if (!DataTypeCanUseMemcpy(proto.dtype())) {
+        return errors::InvalidArgument("Cannot decode snappy tensor of type ",
+                                       DataTypeString(proto.dtype()));
+      }
+      Tensor decoded(allocator, proto.dtype(), shape);
+      StringPiece buf = decoded.tensor_data();
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                              &length) ||
+          length != buf.size() ||
+          !port::Snappy_Uncompress(content.data(), content.size(),
+                                   const_cast<char*>(buf.data()))) {
+        return errors::DataLoss("Invalid snappy encoding of a tensor of type ",
+                                DataTypeString(proto.dtype()), " and shape ",
+                                shape.DebugString());
+      }
+      *tensor = std::move(decoded);
+      return Status::OK();
+    }
+    default:
+      return errors::InvalidArgument("Unsupported tensor wire codec ",
+                                     TensorWireCodec_Name(codec));
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_WIRE_CODEC_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_WIRE_CODEC_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Parses the name of a wire codec ("", "none", "bfloat16" or "snappy"), as
+// used by the TF_RPC_RECV_TENSOR_WIRE_CODEC environment variable.
+Status ParseTensorWireCodec(StringPiece name, TensorWireCodec* codec);
+
+// Returns true if `codec` decodes to exactly the tensor that was encoded.
+bool IsLosslessTensorWireCodec(TensorWireCodec codec);
+
+// Chooses the wire codec of each received tensor from the edge name of its
+// rendezvous key. A lossy codec such as BFLOAT16 suits gradients, but would
+// silently lose precision on e.g. variable reads, so it must be scoped.
+class TensorWireCodecPolicy {
+ public:
+  // Uses no codec.
+  TensorWireCodecPolicy() = default;
+
+  // Uses `codec` for the tensors whose edge name contains one of
+  // `tensor_name_patterns`. Without patterns, a lossless codec is used for
+  // every tensor, and a lossy one for none.
+  TensorWireCodecPolicy(TensorWireCodec codec,
+                        std::vector<string> tensor_name_patterns);
+
+  // Returns the codec to ask the sender of the tensor `edge_name` to use.
+  TensorWireCodec CodecFor(StringPiece edge_name) const;
+
+ private:
+  TensorWireCodec codec_ = TENSOR_WIRE_CODEC_NONE;
+  std::vector<string> tensor_name_patterns_;
+};
+
+// Encodes `tensor` into `*proto` with `codec`, setting its dtype, shape and
+// encoded content. Returns false, leaving `*proto` unchanged, if the codec
+// does not apply to the tensor or does not make it smaller, in which case the
+// tensor should be sent as is.
+bool EncodeTensorForWire(const Tensor& tensor, TensorWireCodec codec,
+                         TensorProto* proto);
+
+// Decodes `proto`, whose content was encoded with `codec`, directly into a
+// tensor allocated with `allocator`.
+Status DecodeTensorFromWire(const TensorProto& proto, TensorWireCodec codec,
+                            Allocator* allocator, Tensor* tensor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_WIRE_CODEC_H_
@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_wire_codec.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor RoundTrip(const Tensor& tensor, TensorWireCodec codec) {
+  TensorProto proto;
+  EXPECT_TRUE(EncodeTensorForWire(tensor, codec, &proto));
+  Tensor decoded;
+  TF_EXPECT_OK(DecodeTensorFromWire(proto, codec, cpu_allocator(), &decoded));
+  return decoded;
+}
+
+TEST(TensorWireCodecTest, ParseName) {
+  TensorWireCodec codec;
+  TF_EXPECT_OK(ParseTensorWireCodec("", &codec));
+  EXPECT_EQ(TENSOR_WIRE_CODEC_NONE, codec);
+  TF_EXPECT_OK(ParseTensorWireCodec("BFloat16", &codec));
+  EXPECT_EQ(TENSOR_WIRE_CODEC_BFLOAT16, codec);
+  TF_EXPECT_OK(ParseTensorWireCodec("snappy", &codec));
+  EXPECT_EQ(TENSOR_WIRE_CODEC_SNAPPY, codec);
+  EXPECT_TRUE(errors::IsInvalidArgument(ParseTensorWireCodec("lz5", &codec)));
+}
+
+TEST(TensorWireCodecTest, PolicyScopesLossyCodecs) {
+  EXPECT_EQ(TENSOR_WIRE_CODEC_NONE,
+            TensorWireCodecPolicy().CodecFor("edge_1_gradients/x"));
+
+  // A lossy codec is used for no tensor unless its tensors are named.
+  const TensorWireCodecPolicy unscoped(TENSOR_WIRE_CODEC_BFLOAT16, {});
+  EXPECT_EQ(TENSOR_WIRE_CODEC_NONE, unscoped.CodecFor("edge_1_gradients/x"));
+
+  const TensorWireCodecPolicy scoped(TENSOR_WIRE_CODEC_BFLOAT16,
+                                     {"gradients/", "_grad"});
+  EXPECT_EQ(TENSOR_WIRE_CODEC_BFLOAT16,
+            scoped.CodecFor("edge_1_gradients/MatMul"));
+  EXPECT_EQ(TENSOR_WIRE_CODEC_BFLOAT16, scoped.CodecFor("edge_2_Relu_grad"));
+  EXPECT_EQ(TENSOR_WIRE_CODEC_NONE, scoped.CodecFor("edge_3_dense/kernel"));
+
+  // A lossless codec is used for every tensor unless its tensors are named.
+  const TensorWireCodecPolicy lossless(TENSOR_WIRE_CODEC_SNAPPY, {});
+  EXPECT_EQ(TENSOR_WIRE_CODEC_SNAPPY, lossless.CodecFor("edge_3_dense/kernel"));
+  const TensorWireCodecPolicy scoped_lossless(TENSOR_WIRE_CODEC_SNAPPY,
+                                              {"embedding"});
+  EXPECT_EQ(TENSOR_WIRE_CODEC_NONE,
+            scoped_lossless.CodecFor("edge_3_dense/kernel"));
+}
+
+TEST(TensorWireCodecTest, BFloat16) {
+  Tensor tensor(DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&tensor, {0.0f, 1.0f, -2.5f, 1024.0f, 3.0e-3f, 7.0f});
+  TensorProto proto;
+  ASSERT_TRUE(EncodeTensorForWire(tensor, TENSOR_WIRE_CODEC_BFLOAT16, &proto));
+  EXPECT_EQ(tensor.NumElements() * sizeof(bfloat16),
+            proto.tensor_content().size());
+  test::ExpectTensorNear<float>(
+      tensor, RoundTrip(tensor, TENSOR_WIRE_CODEC_BFLOAT16), 1e-2);
+}
+
+TEST(TensorWireCodecTest, BFloat16OnlyAppliesToFloats) {
+  Tensor tensor(DT_INT32, TensorShape({4}));
+  TensorProto proto;
+  EXPECT_FALSE(
+      EncodeTensorForWire(tensor, TENSOR_WIRE_CODEC_BFLOAT16, &proto));
+}
+
+TEST(TensorWireCodecTest, Snappy) {
+  Tensor tensor(DT_INT64, TensorShape({1000}));
+  test::FillFn<int64>(&tensor, [](int i) { return i / 100; });
+  test::ExpectTensorEqual<int64>(tensor,
+                                 RoundTrip(tensor, TENSOR_WIRE_CODEC_SNAPPY));
+}
+
+TEST(TensorWireCodecTest, SnappySkipsSmallTensors) {
+  Tensor tensor(DT_INT64, TensorShape({4}));
+  test::FillValues<int64>(&tensor, {0, 0, 0, 0});
+  TensorProto proto;
+  EXPECT_FALSE(EncodeTensorForWire(tensor, TENSOR_WIRE_CODEC_SNAPPY, &proto));
+}
+
+TEST(TensorWireCodecTest, InvalidEncoding) {
+  Tensor tensor(DT_INT64, TensorShape({1000}));
+  test::FillFn<int64>(&tensor, [](int i) { return 0; });
+  TensorProto proto;
+  ASSERT_TRUE(EncodeTensorForWire(tensor, TENSOR_WIRE_CODEC_SNAPPY, &proto));
+  proto.mutable_tensor_shape()->mutable_dim(0)->set_size(999);
+  Tensor decoded;
+  EXPECT_TRUE(errors::IsDataLoss(DecodeTensorFromWire(
+      proto, TENSOR_WIRE_CODEC_SNAPPY, cpu_allocator(), &decoded)));
+  EXPECT_TRUE(errors::IsInvalidArgument(DecodeTensorFromWire(
+      proto, TENSOR_WIRE_CODEC_BFLOAT16, cpu_allocator(), &decoded)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -221,14 +221,15 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
     done(errors::Aborted("Call was aborted"));
     return;
   }
+  const string graph_handle = request->graph_handle();
   session->graph_mgr()->ExecuteAsync(
-      request->graph_handle(), step_id, session.get(), request->exec_opts(),
-      collector, response, cm, in,
-      [this, step_id, response, session, cm, out, token, collector,
-       profiler_session, opts, done](const Status& status) {
+      graph_handle, step_id, session.get(), request->exec_opts(), collector,
+      response, cm, in,
+      [this, graph_handle, step_id, response, session, cm, out, token,
+       collector, profiler_session, opts, done](const Status& status) {
         Status s = status;
         if (s.ok()) {
-          s = session->graph_mgr()->RecvOutputs(step_id, out);
+          s = session->graph_mgr()->RecvOutputs(graph_handle, step_id, out);
         }
 
         opts->ClearCancelCallback();
@@ -0,0 +1,163 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/allocation_timeline.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+struct AllocationTimeline::Slot {
+  // 0 while the slot is written, otherwise 1 + the index of its event. The
+  // fields are atomics so that Report() can read them while they are written.
+  std::atomic<uint64> seq{0};
+  std::atomic<uint64> time_ns{0};
+  std::atomic<const void*> ptr{nullptr};
+  std::atomic<int64> bytes{0};
+  std::atomic<int64> bytes_in_use{0};
+  std::atomic<const char*> op_name{nullptr};
+  std::atomic<int64> step_id{0};
+};
+
+/*static*/ std::unique_ptr<AllocationTimeline>
+AllocationTimeline::CreateFromEnv() {
+  const char* env = std::getenv("TF_ALLOCATION_TIMELINE_EVENTS");
+  if (env == nullptr) return nullptr;
+  int64 capacity = 0;
+  if (!absl::SimpleAtoi(env, &capacity) || capacity < 0) {
+    LOG(ERROR) << "Invalid TF_ALLOCATION_TIMELINE_EVENTS: " << env;
+    return nullptr;
+  }
+  if (capacity == 0) return nullptr;
+  return std::unique_ptr<AllocationTimeline>(new AllocationTimeline(capacity));
+}
+
+AllocationTimeline::AllocationTimeline(size_t capacity)
+    : capacity_(capacity), slots_(new Slot[capacity]) {
+  CHECK_GT(capacity, 0);
+}
+
+AllocationTimeline::~AllocationTimeline() {}
+
+void AllocationTimeline::Record(const void* ptr, int64 bytes,
+                                int64 bytes_in_use) {
+  const MemoryDebugAnnotation& annotation =
+      ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  const uint64 index = next_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[index % capacity_];
+  slot.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.time_ns.store(EnvTime::NowNanos(), std::memory_order_relaxed);
+  slot.ptr.store(ptr, std::memory_order_relaxed);
+  slot.bytes.store(bytes, std::memory_order_relaxed);
+  slot.bytes_in_use.store(bytes_in_use, std::memory_order_relaxed);
+  slot.op_name.store(annotation.pending_op_name, std::memory_order_relaxed);
+  slot.step_id.store(annotation.pending_step_id, std::memory_order_relaxed);
+  slot.seq.store(index + 1, std::memory_order_release);
+}
+
+AllocationTimelineReport AllocationTimeline::Report() {
+  AllocationTimelineReport report;
+  const uint64 end = next_.load(std::memory_order_acquire);
+  uint64 begin = reported_;
+  if (end - begin > capacity_) {
+    report.num_lost_events = end - capacity_ - begin;
+    begin = end - capacity_;
+  }
+  reported_ = end;
+
+  std::vector<Event> events;
+  events.reserve(end - begin);
+  for (uint64 index = begin; index < end; ++index) {
+    const Slot& slot = slots_[index % capacity_];
+    const uint64 seq = slot.seq.load(std::memory_order_acquire);
+    Event event;
+    event.time_ns = slot.time_ns.load(std::memory_order_relaxed);
+    event.ptr = slot.ptr.load(std::memory_order_relaxed);
+    event.bytes = slot.bytes.load(std::memory_order_relaxed);
+    event.bytes_in_use = slot.bytes_in_use.load(std::memory_order_relaxed);
+    event.op_name = slot.op_name.load(std::memory_order_relaxed);
+    event.step_id = slot.step_id.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq != index + 1 ||
+        slot.seq.load(std::memory_order_relaxed) != index + 1) {
+      ++report.num_lost_events;
+      continue;
+    }
+    events.push_back(event);
+  }
+  report.num_events = events.size();
+  if (events.empty()) return report;
+
+  size_t peak = 0;
+  for (size_t i = 1; i < events.size(); ++i) {
+    if (events[i].bytes_in_use > events[peak].bytes_in_use) peak = i;
+  }
+  report.peak_bytes_in_use = events[peak].bytes_in_use;
+  report.peak_time_ns = events[peak].time_ns;
+  report.peak_step_id = events[peak].step_id;
+
+  // Replay the events up to the peak to find the allocations live at the peak.
+  absl::flat_hash_map<const void*, const Event*> live;
+  for (size_t i = 0; i <= peak; ++i) {
+    if (events[i].bytes >= 0) {
+      live[events[i].ptr] = &events[i];
+    } else {
+      live.erase(events[i].ptr);
+    }
+  }
+  absl::flat_hash_map<string, int64> bytes_by_op;
+  int64 attributed_bytes = 0;
+  for (const auto& entry : live) {
+    const Event& event = *entry.second;
+    bytes_by_op[event.op_name ? event.op_name : "unknown"] += event.bytes;
+    attributed_bytes += event.bytes;
+  }
+  report.peak_bytes_by_op.assign(bytes_by_op.begin(), bytes_by_op.end());
+  std::sort(report.peak_bytes_by_op.begin(), report.peak_bytes_by_op.end(),
+            [](const std::pair<string, int64>& a,
+               const std::pair<string, int64>& b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+  report.peak_bytes_from_earlier =
+      std::max<int64>(0, report.peak_bytes_in_use - attributed_bytes);
+  return report;
+}
+
+string AllocationTimelineReport::DebugString() const {
+  string result = absl::StrCat(
+      "Peak bytes in use: ", peak_bytes_in_use, " (step ", peak_step_id,
+      "), events: ", num_events, " (", num_lost_events, " lost)",
+      ", fragmentation: ", fragmentation,
+      ", largest free chunk: ", largest_free_chunk_bytes, " bytes");
+  for (const auto& op_bytes : peak_bytes_by_op) {
+    absl::StrAppend(&result, "\n  ", op_bytes.first, ": ", op_bytes.second,
+                    " bytes");
+  }
+  absl::StrAppend(&result, "\n  (allocated earlier): ",
+                  peak_bytes_from_earlier, " bytes");
+  return result;
+}
+
+}  // namespace tensorflow
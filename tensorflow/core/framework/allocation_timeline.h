@@ -0,0 +1,118 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_ALLOCATION_TIMELINE_H_
+#define TENSORFLOW_CORE_FRAMEWORK_ALLOCATION_TIMELINE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Summary of the allocations recorded by an AllocationTimeline between two
+// calls to AllocationTimeline::Report(), typically one step.
+struct AllocationTimelineReport {
+  // Number of events summarized, and number of events that were overwritten
+  // before they could be summarized.
+  int64 num_events = 0;
+  int64 num_lost_events = 0;
+
+  // Highest bytes in use of the allocator, and when and in which step it was
+  // reached.
+  int64 peak_bytes_in_use = 0;
+  uint64 peak_time_ns = 0;
+  int64 peak_step_id = 0;
+
+  // The bytes live at the peak that were allocated since the previous report,
+  // by the op that allocated them (as annotated by ScopedMemoryDebugAnnotation,
+  // or "unknown"), in decreasing order.
+  std::vector<std::pair<string, int64>> peak_bytes_by_op;
+
+  // The bytes live at the peak that were allocated before the previous report
+  // (or whose allocation events were lost).
+  int64 peak_bytes_from_earlier = 0;
+
+  // Fragmentation of the allocator when the report is made, filled in by
+  // allocators that track it: the fraction of the free bytes that are not in
+  // the largest free chunk.
+  double fragmentation = 0;
+  int64 largest_free_chunk_bytes = 0;
+
+  string DebugString() const;
+};
+
+// A fixed-size buffer of compact allocation and deallocation events, tagged
+// with the op and step of the current ScopedMemoryDebugAnnotation, from which
+// the ops responsible for the peak memory use of a step can be reported.
+//
+// Recording is lock free: each event claims a slot with an atomic increment,
+// and overwrites the oldest event once the buffer is full. Report() reads the
+// slots optimistically and skips the events being written or overwritten
+// while it reads (as well as, in the unlikely case of a thread stalled while
+// the others record a whole buffer of events, one garbled event).
+//
+// The op names are the `const char*` of the annotations, so they are only
+// valid while the kernel that recorded them is; a report must be made before
+// the kernels of the step are destroyed.
+//
+// This class is thread-safe, but Report() must not be called concurrently with
+// itself.
+class AllocationTimeline {
+ public:
+  // Returns a timeline of `capacity` events for an allocator, or nullptr if
+  // the environment variable TF_ALLOCATION_TIMELINE_EVENTS, which sets the
+  // capacity, is unset or 0.
+  static std::unique_ptr<AllocationTimeline> CreateFromEnv();
+
+  explicit AllocationTimeline(size_t capacity);
+  ~AllocationTimeline();
+
+  // Records that `bytes` were allocated at `ptr`, or deallocated if `bytes` is
+  // negative, leaving `bytes_in_use` bytes allocated.
+  void Record(const void* ptr, int64 bytes, int64 bytes_in_use);
+
+  // Summarizes the events recorded since the previous call.
+  AllocationTimelineReport Report();
+
+ private:
+  struct Event {
+    uint64 time_ns;
+    const void* ptr;
+    int64 bytes;
+    int64 bytes_in_use;
+    const char* op_name;
+    int64 step_id;
+  };
+  struct Slot;
+
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  // Index of the next event to record.
+  std::atomic<uint64> next_{0};
+  // Index of the first event not reported yet. Only accessed by Report().
+  uint64 reported_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AllocationTimeline);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_ALLOCATION_TIMELINE_H_
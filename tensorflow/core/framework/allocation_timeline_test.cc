@@ -0,0 +1,92 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/allocation_timeline.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+typedef std::pair<string, int64> OpBytes;
+
+// Fake addresses of allocations.
+const void* Ptr(int i) { return reinterpret_cast<const void*>(64 * (i + 1)); }
+
+TEST(AllocationTimelineTest, EmptyReport) {
+  AllocationTimeline timeline(8);
+  AllocationTimelineReport report = timeline.Report();
+  EXPECT_EQ(report.num_events, 0);
+  EXPECT_EQ(report.num_lost_events, 0);
+  EXPECT_EQ(report.peak_bytes_in_use, 0);
+  EXPECT_TRUE(report.peak_bytes_by_op.empty());
+}
+
+TEST(AllocationTimelineTest, AttributesPeakToOps) {
+  AllocationTimeline timeline(16);
+  {
+    ScopedMemoryDebugAnnotation annotation("matmul", /*step_id=*/7);
+    timeline.Record(Ptr(0), 100, 100);
+    timeline.Record(Ptr(1), 300, 400);
+  }
+  {
+    ScopedMemoryDebugAnnotation annotation("relu", /*step_id=*/7);
+    timeline.Record(Ptr(2), 200, 600);
+    // Freed before the peak, so not attributed.
+    timeline.Record(Ptr(0), -100, 500);
+    timeline.Record(Ptr(3), 250, 750);
+  }
+  timeline.Record(Ptr(1), -300, 450);
+  timeline.Record(Ptr(2), -200, 250);
+
+  AllocationTimelineReport report = timeline.Report();
+  EXPECT_EQ(report.num_events, 7);
+  EXPECT_EQ(report.num_lost_events, 0);
+  EXPECT_EQ(report.peak_bytes_in_use, 750);
+  EXPECT_EQ(report.peak_step_id, 7);
+  EXPECT_EQ(report.peak_bytes_by_op,
+            std::vector<OpBytes>({{"relu", 450}, {"matmul", 300}}));
+  EXPECT_EQ(report.peak_bytes_from_earlier, 0);
+
+  // The next report only covers the events recorded since this one, and
+  // does not know who allocated the live bytes.
+  timeline.Record(Ptr(4), 50, 300);
+  report = timeline.Report();
+  EXPECT_EQ(report.num_events, 1);
+  EXPECT_EQ(report.peak_bytes_in_use, 300);
+  EXPECT_EQ(report.peak_bytes_by_op,
+            std::vector<OpBytes>({{"unknown", 50}}));
+  EXPECT_EQ(report.peak_bytes_from_earlier, 250);
+}
+
+TEST(AllocationTimelineTest, OverwritesOldestEvents) {
+  AllocationTimeline timeline(4);
+  ScopedMemoryDebugAnnotation annotation("op");
+  int64 bytes_in_use = 0;
+  for (int i = 0; i < 10; ++i) {
+    bytes_in_use += 10;
+    timeline.Record(Ptr(i), 10, bytes_in_use);
+  }
+  AllocationTimelineReport report = timeline.Report();
+  EXPECT_EQ(report.num_events, 4);
+  EXPECT_EQ(report.num_lost_events, 6);
+  EXPECT_EQ(report.peak_bytes_in_use, 100);
+  EXPECT_EQ(report.peak_bytes_by_op, std::vector<OpBytes>({{"op", 40}}));
+  EXPECT_EQ(report.peak_bytes_from_earlier, 60);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -38,7 +38,12 @@ string AllocatorStats::DebugString() const {
       "MaxAllocSize:     %20lld\n"
       "Reserved:         %20lld\n"
       "PeakReserved:     %20lld\n"
-      "LargestFreeBlock: %20lld\n",
+      "LargestFreeBlock: %20lld\n"
+      "ThreadCacheHits:  %20lld\n"
+      "ThreadCacheMiss:  %20lld\n"
+      "ThreadCacheBytes: %20lld\n"
+      "PlannedAllocs:    %20lld\n"
+      "PlanDivergences:  %20lld\n",
       static_cast<long long>(this->bytes_limit ? *this->bytes_limit : 0),
       static_cast<long long>(this->bytes_in_use),
       static_cast<long long>(this->peak_bytes_in_use),
@@ -46,7 +51,12 @@ string AllocatorStats::DebugString() const {
       static_cast<long long>(this->largest_alloc_size),
       static_cast<long long>(this->bytes_reserved),
       static_cast<long long>(this->peak_bytes_reserved),
-      static_cast<long long>(this->largest_free_block_bytes));
+      static_cast<long long>(this->largest_free_block_bytes),
+      static_cast<long long>(this->num_thread_cache_hits),
+      static_cast<long long>(this->num_thread_cache_misses),
+      static_cast<long long>(this->bytes_in_thread_caches),
+      static_cast<long long>(this->num_planned_allocs),
+      static_cast<long long>(this->num_plan_divergences));
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
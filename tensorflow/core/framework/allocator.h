@@ -164,6 +164,16 @@ struct AllocatorStats {
 
   int64 largest_free_block_bytes;  // Largest free block's size in heap.
 
+  // Stats for allocators that serve small allocations from thread-local
+  // caches. Bytes held by the caches are included in `bytes_in_use`.
+  int64 num_thread_cache_hits;    // Allocations served by a cache.
+  int64 num_thread_cache_misses;  // Allocations that missed the cache.
+  int64 bytes_in_thread_caches;   // Number of bytes of free cached memory.
+
+  // Stats for allocators that replay a precomputed memory plan.
+  int64 num_planned_allocs;    // Allocations served by the plan.
+  int64 num_plan_divergences;  // Steps that diverged from the plan.
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -171,7 +181,12 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        num_thread_cache_hits(0),
+        num_thread_cache_misses(0),
+        bytes_in_thread_caches(0),
+        num_planned_allocs(0),
+        num_plan_divergences(0) {}
 
   std::string DebugString() const;
 };
@@ -286,6 +301,15 @@ class Allocator {
   virtual void ClearStats() {}
 
   virtual void SetSafeFrontier(uint64 count) {}
+
+  // Informs the allocator that a new step is starting on its device. An
+  // allocator may use the step boundaries to learn the allocation pattern of
+  // repeated steps.
+  virtual void NotifyStepBegin() {}
+
+  // Informs the allocator that step `step_id` has ended on its device, e.g.
+  // to report the memory use of the step.
+  virtual void NotifyStepEnd(int64 step_id) {}
 };
 
 // An implementation of Allocator that delegates all calls to another Allocator.
@@ -338,6 +362,12 @@ class AllocatorWrapper : public Allocator {
     return wrapped_->AllocatedSizeSlow(ptr);
   }
 
+  void NotifyStepBegin() override { wrapped_->NotifyStepBegin(); }
+
+  void NotifyStepEnd(int64 step_id) override {
+    wrapped_->NotifyStepEnd(step_id);
+  }
+
  private:
   Allocator* const wrapped_;
 };
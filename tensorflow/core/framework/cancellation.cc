@@ -28,10 +28,14 @@ const CancellationToken CancellationManager::kInvalidToken = -1;
 CancellationManager::CancellationManager()
     : is_cancelling_(false),
       is_cancelled_(false),
+      has_state_(false),
       next_cancellation_token_(0) {}
 
 CancellationManager::CancellationManager(CancellationManager* parent)
-    : is_cancelling_(false), next_cancellation_token_(0), parent_(parent) {
+    : is_cancelling_(false),
+      has_state_(false),
+      next_cancellation_token_(0),
+      parent_(parent) {
   is_cancelled_ = parent->RegisterChild(this);
 }
 
@@ -73,8 +77,10 @@ void CancellationManager::StartCancel() {
   }
   {
     mutex_lock l(mu_);
-    is_cancelling_ = false;
+    // Set `is_cancelled_` first, so that lock-free readers never see neither
+    // flag set after cancellation started.
     is_cancelled_.store(true, std::memory_order_release);
+    is_cancelling_ = false;
   }
   if (cancelled_notification) {
     cancelled_notification->Notify();
@@ -89,6 +95,7 @@ bool CancellationManager::RegisterCallback(CancellationToken token,
   if (should_register) {
     if (!state_) {
       state_ = absl::make_unique<State>();
+      has_state_.store(true, std::memory_order_release);
     }
     std::swap(state_->callbacks[token], callback);
   }
@@ -96,6 +103,13 @@ bool CancellationManager::RegisterCallback(CancellationToken token,
 }
 
 bool CancellationManager::DeregisterCallback(CancellationToken token) {
+  // Fast path for managers that never had a callback registered, as in the
+  // many short function calls that are never cancelled. With no state there
+  // is no callback to wait for.
+  if (!has_state_.load(std::memory_order_acquire)) {
+    return !is_cancelled_.load(std::memory_order_acquire) &&
+           !is_cancelling_.load(std::memory_order_acquire);
+  }
   mu_.lock();
   if (is_cancelled_) {
     mu_.unlock();
@@ -130,6 +144,7 @@ bool CancellationManager::RegisterChild(CancellationManager* child) {
 
   if (!state_) {
     state_ = absl::make_unique<State>();
+    has_state_.store(true, std::memory_order_release);
   }
 
   // Push `child` onto the front of the list of children.
@@ -181,6 +196,10 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
 }
 
 bool CancellationManager::TryDeregisterCallback(CancellationToken token) {
+  if (!has_state_.load(std::memory_order_acquire)) {
+    return !is_cancelled_.load(std::memory_order_acquire) &&
+           !is_cancelling_.load(std::memory_order_acquire);
+  }
   mutex_lock lock(mu_);
   if (is_cancelled_ || is_cancelling_) {
     return false;
@@ -201,9 +220,4 @@ CancellationManager::~CancellationManager() {
   }
 }
 
-bool CancellationManager::IsCancelling() {
-  mutex_lock lock(mu_);
-  return is_cancelling_;
-}
-
 }  // end namespace tensorflow
@@ -144,7 +144,7 @@ class CancellationManager {
   bool TryDeregisterCallback(CancellationToken token);
 
   // Returns true iff cancellation is in progress.
-  bool IsCancelling();
+  bool IsCancelling() { return is_cancelling_.load(std::memory_order_acquire); }
 
  private:
   struct State {
@@ -159,8 +159,11 @@ class CancellationManager {
   bool RegisterChild(CancellationManager* child);
   void DeregisterChild(CancellationManager* child);
 
-  bool is_cancelling_;
+  std::atomic_bool is_cancelling_;
   std::atomic_bool is_cancelled_;
+  // Set once `state_` is allocated. Until then no callback or child has been
+  // registered, and deregistration need not take `mu_`.
+  std::atomic_bool has_state_;
   std::atomic<CancellationToken> next_cancellation_token_;
 
   CancellationManager* const parent_ = nullptr;  // Not owned.
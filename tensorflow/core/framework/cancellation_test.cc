@@ -187,15 +187,29 @@ TEST(Cancellation, TryDeregisterDuringCancel) {
     cancel_complete.Notify();
   });
   cancel_started.WaitForNotification();
+  EXPECT_TRUE(manager->IsCancelling());
 
   bool deregistered = manager->TryDeregisterCallback(token);
   EXPECT_FALSE(deregistered);
 
   finish_callback.Notify();
   cancel_complete.WaitForNotification();
+  EXPECT_FALSE(manager->IsCancelling());
   delete manager;
 }
 
+TEST(Cancellation, DeregisterWithoutCallbacks) {
+  CancellationManager manager;
+  auto token = manager.get_cancellation_token();
+  EXPECT_TRUE(manager.DeregisterCallback(token));
+  EXPECT_TRUE(manager.TryDeregisterCallback(token));
+  manager.StartCancel();
+  EXPECT_TRUE(manager.IsCancelled());
+  EXPECT_FALSE(manager.IsCancelling());
+  EXPECT_FALSE(manager.DeregisterCallback(token));
+  EXPECT_FALSE(manager.TryDeregisterCallback(token));
+}
+
 TEST(Cancellation, Parent_CancelManyChildren) {
   CancellationManager parent;
   std::vector<std::unique_ptr<CancellationManager>> children;
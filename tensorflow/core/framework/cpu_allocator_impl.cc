@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include <atomic>
+#include <memory>
 
+#include "tensorflow/core/framework/allocation_timeline.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -67,7 +69,8 @@ class CPUAllocator : public Allocator {
  public:
   CPUAllocator()
       : single_allocation_warning_count_(0),
-        total_allocation_warning_count_(0) {}
+        total_allocation_warning_count_(0),
+        timeline_(AllocationTimeline::CreateFromEnv()) {}
 
   ~CPUAllocator() override {}
 
@@ -92,6 +95,9 @@ class CPUAllocator : public Allocator {
           std::max<int64>(stats_.peak_bytes_in_use, stats_.bytes_in_use);
       stats_.largest_alloc_size =
           std::max<int64>(stats_.largest_alloc_size, alloc_size);
+      if (timeline_ != nullptr) {
+        timeline_->Record(p, alloc_size, stats_.bytes_in_use);
+      }
 
       if (stats_.bytes_in_use > TotalAllocationWarningBytes() &&
           total_allocation_warning_count_ < kMaxTotalAllocationWarnings) {
@@ -110,10 +116,23 @@ class CPUAllocator : public Allocator {
           port::MallocExtension_GetAllocatedSize(ptr);
       mutex_lock l(mu_);
       stats_.bytes_in_use -= alloc_size;
+      if (timeline_ != nullptr) {
+        timeline_->Record(ptr, -static_cast<int64>(alloc_size),
+                          stats_.bytes_in_use);
+      }
     }
     port::AlignedFree(ptr);
   }
 
+  // The allocation timeline is only recorded while the stats are collected,
+  // as the size of deallocations is only known then.
+  void NotifyStepEnd(int64 step_id) override {
+    if (timeline_ == nullptr) return;
+    mutex_lock l(report_mu_);
+    VLOG(1) << "Memory use of " << Name() << " in step " << step_id << ": "
+            << timeline_->Report().DebugString();
+  }
+
   absl::optional<AllocatorStats> GetStats() override {
     mutex_lock l(mu_);
     return stats_;
@@ -139,6 +158,10 @@ class CPUAllocator : public Allocator {
   std::atomic<int> single_allocation_warning_count_;
   int total_allocation_warning_count_ TF_GUARDED_BY(mu_);
 
+  // Only allocated if TF_ALLOCATION_TIMELINE_EVENTS is set.
+  const std::unique_ptr<AllocationTimeline> timeline_;
+  mutex report_mu_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(CPUAllocator);
 };
 
@@ -289,6 +289,14 @@ class CallFrameInterface {
   virtual bool CanConsumeArg(int index) const { return false; }
 
   virtual Status SetRetval(int index, const Tensor& val) = 0;
+
+  // Returns the allocator with which the caller wants the `index`-th return
+  // value to be allocated (e.g. so that it is computed directly in a buffer
+  // owned by the caller), or nullptr to use the device allocator.
+  //
+  // This is a hint: the value may still be allocated elsewhere, e.g. if the
+  // kernel that produces it forwards one of its inputs.
+  virtual Allocator* GetRetvalAllocator(int index) const { return nullptr; }
 };
 
 // Represents a function call frame. I.e., the data structure used to
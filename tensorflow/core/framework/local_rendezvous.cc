@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -40,10 +41,11 @@ struct LocalRendezvous::Item {
   }
 
   Item(Rendezvous::Args recv_args, Rendezvous::DoneCallback waiter,
-       CancellationToken cancellation_token)
+       CancellationToken cancellation_token, uint64 wait_start_us)
       : Item(recv_args, kRecv) {
     recv_state.waiter.Init(std::move(waiter));
     recv_state.cancellation_token = cancellation_token;
+    recv_state.wait_start_us = wait_start_us;
   }
 
   ~Item() {
@@ -73,6 +75,8 @@ struct LocalRendezvous::Item {
     struct {
       ManualConstructor<Rendezvous::DoneCallback> waiter;
       CancellationToken cancellation_token;
+      // Zero unless the rendezvous wait accounting is enabled.
+      uint64 wait_start_us;
     } recv_state;
   };
 
@@ -97,8 +101,16 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
 }
 
 LocalRendezvous::~LocalRendezvous() {
-  if (!table_.empty()) {
-    StartAbort(errors::Cancelled("LocalRendezvous deleted"));
+  for (TableShard& shard : shards_) {
+    bool empty;
+    {
+      mutex_lock l(shard.mu);
+      empty = shard.table.empty();
+    }
+    if (!empty) {
+      StartAbort(errors::Cancelled("LocalRendezvous deleted"));
+      return;
+    }
   }
 }
 
@@ -122,15 +134,16 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  mu_.lock();
-  if (!status_.ok()) {
+  TableShard* shard = GetShard(key_hash);
+  shard->mu.lock();
+  if (!shard->status.ok()) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
+    Status s = shard->status;
+    shard->mu.unlock();
     return s;
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = &shard->table[key_hash];
   if (queue->head == nullptr || queue->head->type == Item::kSend) {
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
@@ -139,7 +152,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     // the lock.
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
     queue->push_back(new Item(send_args, val, is_dead));
-    mu_.unlock();
+    shard->mu.unlock();
     return Status::OK();
   }
 
@@ -150,15 +163,19 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    shard->table.erase(key_hash);
   } else {
     queue->head = item->next;
   }
-  mu_.unlock();
+  shard->mu.unlock();
 
   // Notify the waiter by invoking its done closure, outside the
   // lock.
   DCHECK_EQ(item->type, Item::kRecv);
+  if (item->recv_state.wait_start_us != 0) {
+    RecordRendezvousWait(key,
+                         EnvTime::NowMicros() - item->recv_state.wait_start_us);
+  }
   (*item->recv_state.waiter)(Status::OK(), send_args, item->args, val, is_dead);
   delete item;
   return Status::OK();
@@ -170,16 +187,17 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   uint64 key_hash = KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-  mu_.lock();
-  if (!status_.ok()) {
+  TableShard* shard = GetShard(key_hash);
+  shard->mu.lock();
+  if (!shard->status.ok()) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
+    Status s = shard->status;
+    shard->mu.unlock();
     done(s, Rendezvous::Args(), recv_args, Tensor(), false);
     return;
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = &shard->table[key_hash];
   if (queue->head == nullptr || queue->head->type == Item::kRecv) {
     // There is no message to pick up.
     // Only recv-related fields need to be filled.
@@ -189,10 +207,11 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     if (cm != nullptr) {
       token = cm->get_cancellation_token();
       already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash] {
+        TableShard* shard = GetShard(key_hash);
         Item* item = nullptr;
         {
-          mutex_lock l(mu_);
-          ItemQueue* queue = &table_[key_hash];
+          mutex_lock l(shard->mu);
+          ItemQueue* queue = &shard->table[key_hash];
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
           if (queue->head != nullptr && queue->head->type == Item::kRecv) {
@@ -203,7 +222,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                 if (queue->head->next == nullptr) {
                   // We have a single-element queue, so we can erase it from
                   // the table.
-                  table_.erase(key_hash);
+                  shard->table.erase(key_hash);
                 } else {
                   // Remove the current item from the queue.
                   if (curr == queue->head) {
@@ -233,7 +252,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       });
     }
     if (already_cancelled) {
-      mu_.unlock();
+      shard->mu.unlock();
       done(StatusGroup::MakeDerived(
                errors::Cancelled("RecvAsync is cancelled.")),
            Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
@@ -241,6 +260,8 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     }
 
     DVLOG(2) << "Enqueue Recv Item (key:" << key.FullKey() << "). ";
+    const uint64 wait_start_us =
+        RendezvousWaitAccountingEnabled() ? EnvTime::NowMicros() : 0;
 
     // TODO(b/143786186): Investigate moving the allocation of `Item` outside
     // the lock.
@@ -256,12 +277,13 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
             cm->TryDeregisterCallback(token);
             done(s, send_args, recv_args, v, dead);
           },
-          token));
+          token, wait_start_us));
     } else {
-      queue->push_back(new Item(recv_args, std::move(done), token));
+      queue->push_back(
+          new Item(recv_args, std::move(done), token, wait_start_us));
     }
 
-    mu_.unlock();
+    shard->mu.unlock();
     return;
   }
 
@@ -273,11 +295,11 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    shard->table.erase(key_hash);
   } else {
     queue->head = item->next;
   }
-  mu_.unlock();
+  shard->mu.unlock();
 
   // Invoke done() without holding the table lock.
   DCHECK_EQ(item->type, Item::kSend);
@@ -288,22 +310,24 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
 
 void LocalRendezvous::StartAbort(const Status& status) {
   CHECK(!status.ok());
-  Table table;
-  {
-    mutex_lock l(mu_);
-    status_.Update(status);
-    table_.swap(table);
-  }
-  for (auto& p : table) {
-    Item* item = p.second.head;
-    while (item != nullptr) {
-      if (item->type == Item::kRecv) {
-        (*item->recv_state.waiter)(status, Rendezvous::Args(),
-                                   Rendezvous::Args(), Tensor(), false);
+  for (TableShard& shard : shards_) {
+    Table table;
+    {
+      mutex_lock l(shard.mu);
+      shard.status.Update(status);
+      shard.table.swap(table);
+    }
+    for (auto& p : table) {
+      Item* item = p.second.head;
+      while (item != nullptr) {
+        if (item->type == Item::kRecv) {
+          (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                     Rendezvous::Args(), Tensor(), false);
+        }
+        Item* to_delete = item;
+        item = item->next;
+        delete to_delete;
       }
-      Item* to_delete = item;
-      item = item->next;
-      delete to_delete;
     }
   }
 }
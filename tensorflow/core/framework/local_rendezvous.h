@@ -16,10 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -60,12 +60,27 @@ class LocalRendezvous {
     Item* tail = nullptr;
   };
 
-  typedef gtl::FlatMap<uint64, ItemQueue> Table;
+  typedef absl::flat_hash_map<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
-  Status status_ TF_GUARDED_BY(mu_);
+  // The table is sharded by key hash, so that the sends and receives of
+  // different edges rarely contend for the same lock. Every shard records
+  // the abort status, so that Send() and RecvAsync() only take the lock of
+  // their shard.
+  struct TableShard {
+    mutex mu;
+    Table table TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumTableShardsLog2 = 4;
+  static constexpr int kNumTableShards = 1 << kNumTableShardsLog2;
+
+  // Uses the high bits of the hash, so that the keys of a shard still differ
+  // in the bits that the table probes on.
+  TableShard* GetShard(uint64 key_hash) {
+    return &shards_[key_hash >> (64 - kNumTableShardsLog2)];
+  }
+
+  TableShard shards_[kNumTableShards];
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
 };
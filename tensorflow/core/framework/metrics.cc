@@ -54,6 +54,49 @@ auto* graph_run_output_tensor_bytes = monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 14 (256MB)
     {monitoring::Buckets::Exponential(1, 4, 14)});
 
+auto* recv_tensor_fused_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/recv_tensor_fused_batch_size",
+     "The number of tensors received by each fused RecvTensors call."},
+    // Power of 2 with bucket count 12 (>= 2048 tensors)
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+auto* recv_tensor_fused_batch_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/recv_tensor_fused_batch_usecs",
+     "The wall-clock time of each fused RecvTensors call in microseconds."},
+    // Power of 2 with bucket count 20 (> 10 seconds)
+    {monitoring::Buckets::Exponential(10, 2, 20)});
+
+auto* gpu_event_mgr_dispatch_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/gpu_event_mgr_dispatch_batch_size",
+     "The number of completion callbacks dispatched together by a GPU "
+     "EventMgr."},
+    // Power of 2 with bucket count 12 (>= 2048 callbacks)
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+auto* gpu_event_mgr_dispatch_delay_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/gpu_event_mgr_dispatch_delay_usecs",
+     "The time from observing the completion of GPU work to running its "
+     "EventMgr callbacks in microseconds."},
+    // Power of 2 with bucket count 20 (> 1 second)
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+auto* distributed_step_phase_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/distributed_step_phase_usecs",
+     "The wall-clock time spent in each phase of a distributed step in "
+     "microseconds.",
+     "phase"},
+    // Power of 2 with bucket count 24 (> 80 seconds)
+    {monitoring::Buckets::Exponential(10, 2, 24)});
+
+auto* grappler_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler_cache_lookups",
+    "The number of lookups in the cache of optimized graphs.", "result");
+
+auto* grappler_cache_saved_usecs = monitoring::Counter<0>::New(
+    "/tensorflow/core/grappler_cache_saved_usecs",
+    "The time the cached graphs took to optimize when they were inserted in "
+    "the cache of optimized graphs, summed over all cache hits.");
+
 auto* graph_unused_outputs = monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
@@ -149,6 +192,11 @@ auto* xla_compilation_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_compilations_avoided_by_bucketing = monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_compilations_avoided_by_bucketing",
+    "The number of new input shapes of XLA clusters that were served by the "
+    "executable of their shape bucket instead of being compiled.");
+
 auto* mlir_import_failure_count = monitoring::Counter<0>::New(
     "/tensorflow/mlir/import_failure_count",
     "The number of jobs that failed during mlir import or verification.");
@@ -268,6 +316,18 @@ void UpdateGrapplerPassTime(const string& pass_name,
   }
 }
 
+void RecordGrapplerCacheLookup(bool hit, const uint64 saved_usecs) {
+  static auto* hits_cell = grappler_cache_lookups->GetCell("hit");
+  static auto* misses_cell = grappler_cache_lookups->GetCell("miss");
+  static auto* saved_usecs_cell = grappler_cache_saved_usecs->GetCell();
+  if (hit) {
+    hits_cell->IncrementBy(1);
+    saved_usecs_cell->IncrementBy(saved_usecs);
+  } else {
+    misses_cell->IncrementBy(1);
+  }
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -288,6 +348,11 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordXlaCompilationAvoidedByBucketing() {
+  static auto* cell = xla_compilations_avoided_by_bucketing->GetCell();
+  cell->IncrementBy(1);
+}
+
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   static auto* bfc_allocator_delay_cell = bfc_allocator_delay->GetCell();
   if (delay_usecs > 0) {
@@ -295,6 +360,37 @@ void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   }
 }
 
+void RecordRecvTensorFusedBatch(int64 batch_size, uint64 latency_usecs) {
+  static auto* recv_tensor_fused_batch_size_cell =
+      recv_tensor_fused_batch_size->GetCell();
+  static auto* recv_tensor_fused_batch_usecs_cell =
+      recv_tensor_fused_batch_usecs->GetCell();
+  recv_tensor_fused_batch_size_cell->Add(batch_size);
+  recv_tensor_fused_batch_usecs_cell->Add(latency_usecs);
+}
+
+void RecordGpuEventMgrDispatch(int64 batch_size, uint64 delay_usecs) {
+  static auto* batch_size_cell = gpu_event_mgr_dispatch_batch_size->GetCell();
+  static auto* delay_usecs_cell = gpu_event_mgr_dispatch_delay_usecs->GetCell();
+  batch_size_cell->Add(batch_size);
+  delay_usecs_cell->Add(delay_usecs);
+}
+
+void RecordDistributedStepPhase(DistributedStepPhase phase,
+                                uint64 duration_usecs) {
+  // In the order of DistributedStepPhase.
+  static monitoring::SamplerCell* const cells[] = {
+      distributed_step_phase_usecs->GetCell("master_build_requests"),
+      distributed_step_phase_usecs->GetCell("master_run_graph"),
+      distributed_step_phase_usecs->GetCell("master_wait"),
+      distributed_step_phase_usecs->GetCell("master_collect_fetches"),
+      distributed_step_phase_usecs->GetCell("worker_queue"),
+      distributed_step_phase_usecs->GetCell("worker_run_graph"),
+      distributed_step_phase_usecs->GetCell("worker_rendezvous_wait"),
+  };
+  cells[static_cast<int>(phase)]->Add(duration_usecs);
+}
+
 void IncrementMLIRImportFailureCount() {
   static auto* mlir_import_failure_count_cell =
       mlir_import_failure_count->GetCell();
@@ -120,12 +120,53 @@ void UpdateGraphOptimizationPassTime(const string& pass_name,
 void UpdateGrapplerPassTime(const string& pass_name,
                             const uint64 running_time_usecs);
 
+// Records a lookup in the cache of graphs optimized by Grappler.  On a hit,
+// `saved_usecs` is the time the cached graph took to optimize.
+void RecordGrapplerCacheLookup(bool hit, const uint64 saved_usecs);
+
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records that an XLA cluster ran with a new input shape without being
+// compiled, because an executable for its shape bucket already existed.
+void RecordXlaCompilationAvoidedByBucketing();
+
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
+// Records a fused RecvTensors call that received `batch_size` tensors and took
+// `latency_usecs` microseconds from sending the request to receiving the
+// response.
+void RecordRecvTensorFusedBatch(int64 batch_size, uint64 latency_usecs);
+
+// Records that a GPU EventMgr dispatched `batch_size` completion callbacks
+// together, which started running `delay_usecs` microseconds after the
+// completion of their GPU work was observed.
+void RecordGpuEventMgrDispatch(int64 batch_size, uint64 delay_usecs);
+
+// The phases of a distributed step recorded by RecordDistributedStepPhase.
+enum class DistributedStepPhase {
+  // The master building the RunGraph requests.
+  kMasterBuildRequests,
+  // A RunGraph call as seen by the master.
+  kMasterRunGraph,
+  // The master waiting for all RunGraph calls.
+  kMasterWait,
+  // The master collecting the fetched tensors and step metadata.
+  kMasterCollectFetches,
+  // A RunGraph request waiting for a thread on the worker.
+  kWorkerQueue,
+  // A RunGraph call as seen by the worker.
+  kWorkerRunGraph,
+  // A RecvTensor request waiting for its tensor to be produced.
+  kWorkerRendezvousWait,
+};
+
+// Records that a phase of a distributed step took `duration_usecs`
+// microseconds.
+void RecordDistributedStepPhase(DistributedStepPhase phase,
+                                uint64 duration_usecs);
+
 // Increment the number of jobs that failed during import to mlir.
 void IncrementMLIRImportFailureCount();
 
@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/metrics.h"
+
+#include <memory>
+
+#include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace metrics {
+namespace {
+
+// Returns the histogram recorded for `phase` of distributed steps, or an empty
+// one if there is none.
+HistogramProto GetDistributedStepPhaseHistogram(const string& phase) {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  options.collect_metric_descriptors = false;
+  const std::unique_ptr<monitoring::CollectedMetrics> collected_metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  auto it = collected_metrics->point_set_map.find(
+      "/tensorflow/core/distributed_step_phase_usecs");
+  if (it != collected_metrics->point_set_map.end()) {
+    for (const auto& point : it->second->points) {
+      if (point->labels.size() == 1 && point->labels[0].value == phase) {
+        return point->histogram_value;
+      }
+    }
+  }
+  return HistogramProto();
+}
+
+TEST(MetricsTest, RecordDistributedStepPhase) {
+  const HistogramProto wait_before =
+      GetDistributedStepPhaseHistogram("master_wait");
+  const HistogramProto queue_before =
+      GetDistributedStepPhaseHistogram("worker_queue");
+
+  RecordDistributedStepPhase(DistributedStepPhase::kMasterWait, 100);
+  RecordDistributedStepPhase(DistributedStepPhase::kMasterWait, 20);
+  RecordDistributedStepPhase(DistributedStepPhase::kWorkerQueue, 3);
+
+  const HistogramProto wait = GetDistributedStepPhaseHistogram("master_wait");
+  EXPECT_EQ(wait_before.num() + 2, wait.num());
+  EXPECT_EQ(wait_before.sum() + 120, wait.sum());
+  const HistogramProto queue =
+      GetDistributedStepPhaseHistogram("worker_queue");
+  EXPECT_EQ(queue_before.num() + 1, queue.num());
+  EXPECT_EQ(queue_before.sum() + 3, queue.sum());
+  EXPECT_EQ(0, GetDistributedStepPhaseHistogram("worker_run_graph").num());
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace tensorflow
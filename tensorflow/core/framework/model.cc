@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <limits>
 #include <memory>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 
@@ -28,6 +30,15 @@ namespace {
 // Wrapper for the square function to reduce verbosity.
 inline double Square(double x) { return x * x; }
 
+// The models of the process that are alive, see `Model::ForEachModel()`.
+mutex live_models_mu(LINKER_INITIALIZED);
+
+absl::flat_hash_set<Model*>* LiveModels()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(live_models_mu) {
+  static auto* models = new absl::flat_hash_set<Model*>();
+  return models;
+}
+
 // The first input of InterleaveMany corresponds to the input dataset whose
 // elements are used to create the (derived) input datasets whose elements are
 // interleaved as output.
@@ -992,6 +1003,19 @@ std::shared_ptr<Node> Node::Snapshot() const {
   return result;
 }
 
+void Node::CopyParameters() {
+  mutex_lock l(mu_);
+  for (auto& pair : parameters_) {
+    pair.second = std::make_shared<Parameter>(*pair.second);
+  }
+}
+
+std::shared_ptr<Parameter> Node::parameter(const string& name) const {
+  tf_shared_lock l(mu_);
+  auto* parameter = gtl::FindOrNull(parameters_, name);
+  return parameter ? *parameter : nullptr;
+}
+
 double Node::SelfProcessingTime() const {
   tf_shared_lock l(mu_);
   return SelfProcessingTimeLocked();
@@ -1299,8 +1323,151 @@ void Model::FlushMetrics() {
   }
 }
 
+SharedBudget* SharedBudget::Global() {
+  static SharedBudget* global = new SharedBudget();
+  return global;
+}
+
+void SharedBudget::Register(const Model* model) {
+  mutex_lock l(mu_);
+  wait_times_.emplace(model, 0.0);
+}
+
+void SharedBudget::Unregister(const Model* model) {
+  mutex_lock l(mu_);
+  wait_times_.erase(model);
+}
+
+void SharedBudget::RecordWaitTime(const Model* model, double wait_time) {
+  mutex_lock l(mu_);
+  auto it = wait_times_.find(model);
+  if (it != wait_times_.end()) {
+    it->second = std::max(wait_time, 0.0);
+  }
+}
+
+void SharedBudget::GetShare(const Model* model, int64 cpu_budget,
+                            int64 ram_budget, int64* cpu_share,
+                            int64* ram_share) {
+  // The fraction of the budget that is split uniformly among the models.
+  constexpr double kUniformFraction = 0.2L;
+
+  double fraction = 1.0L;
+  {
+    tf_shared_lock l(mu_);
+    auto it = wait_times_.find(model);
+    if (it != wait_times_.end() && wait_times_.size() > 1) {
+      const double num_models = static_cast<double>(wait_times_.size());
+      double total_wait_time = 0.0L;
+      for (const auto& pair : wait_times_) {
+        total_wait_time += pair.second;
+      }
+      if (total_wait_time > 0) {
+        fraction = kUniformFraction / num_models +
+                   (1.0L - kUniformFraction) * it->second / total_wait_time;
+      } else {
+        fraction = 1.0L / num_models;
+      }
+    }
+  }
+  *cpu_share = std::max<int64>(1, std::round(fraction * cpu_budget));
+  *ram_share = static_cast<int64>(fraction * ram_budget);
+  VLOG(2) << "Share of the autotuning budget: " << *cpu_share << " of "
+          << cpu_budget << " CPUs, " << *ram_share << " of " << ram_budget
+          << " bytes";
+}
+
+Model::Model() : collect_resource_usage_(false) {
+  mutex_lock l(live_models_mu);
+  LiveModels()->insert(this);
+}
+
+Model::~Model() {
+  {
+    mutex_lock l(live_models_mu);
+    LiveModels()->erase(this);
+  }
+  if (shared_budget_) {
+    shared_budget_->Unregister(this);
+  }
+}
+
+void Model::ForEachModel(const std::function<void(Model*)>& fn) {
+  mutex_lock l(live_models_mu);
+  for (Model* model : *LiveModels()) {
+    fn(model);
+  }
+}
+
+std::vector<NodeAnalysis> Model::Analyze() {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock l(mu_);
+    if (!output_) {
+      return {};
+    }
+    snapshot = output_->Snapshot();
+  }
+  std::vector<std::shared_ptr<Node>> nodes = {snapshot};
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    // The analysis changes parallelism values, which the snapshot otherwise
+    // shares with the model.
+    nodes[i]->CopyParameters();
+    for (auto& input : nodes[i]->inputs()) {
+      nodes.push_back(std::move(input));
+    }
+  }
+
+  const double output_time =
+      OutputTime(snapshot, /*model_input_time=*/0, /*gradients=*/nullptr);
+  std::vector<NodeAnalysis> analyses;
+  analyses.reserve(nodes.size());
+  for (const auto& node : nodes) {
+    NodeAnalysis analysis;
+    analysis.name = node->name();
+    analysis.long_name = node->long_name();
+    analysis.num_elements = node->num_elements();
+    absl::flat_hash_map<string, double> input_times = {
+        {kModelInputTimeKey, 0}};
+    analysis.output_time =
+        node->OutputTime(&input_times, /*gradients=*/nullptr);
+    analysis.self_processing_time = node->SelfProcessingTime();
+    std::shared_ptr<Parameter> parallelism = node->parameter(kParallelism);
+    if (parallelism) {
+      analysis.parallelism = std::max(parallelism->value, 1.0);
+    }
+    // The share of the output latency that is spent processing elements in
+    // the node itself, as opposed to waiting for its inputs.
+    const double self_time =
+        analysis.self_processing_time / analysis.parallelism;
+    analysis.input_bound = analysis.output_time - self_time > self_time;
+    if (parallelism && parallelism->value < parallelism->max) {
+      const double value = parallelism->value;
+      parallelism->value = parallelism->max;
+      const double min_output_time =
+          OutputTime(snapshot, /*model_input_time=*/0, /*gradients=*/nullptr);
+      parallelism->value = value;
+      if (min_output_time > 0) {
+        analysis.estimated_speedup = output_time / min_output_time;
+      }
+    }
+    analyses.push_back(std::move(analysis));
+  }
+  return analyses;
+}
+
+void Model::ShareBudget(SharedBudget* budget) {
+  DCHECK(shared_budget_ == nullptr);
+  shared_budget_ = budget;
+  shared_budget_->Register(this);
+}
+
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
                      int64 ram_budget, double model_input_time) {
+  if (shared_budget_) {
+    shared_budget_->GetShare(this, cpu_budget, ram_budget, &cpu_budget,
+                             &ram_budget);
+  }
   switch (algorithm) {
     case AutotuneAlgorithm::HILL_CLIMB:
       OptimizeHillClimb(cpu_budget, ram_budget, model_input_time);
@@ -1416,9 +1583,13 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
     }
     output_time = new_output_time;
   }
-  VLOG(2) << "Number of tunable parameters: " << parameters.size();
   for (auto& pair : parameters) {
     pair.second->value = std::round(pair.second->value);
+  }
+  ShrinkToRamBudget(snapshot, model_input_time, ram_budget, parameters);
+  RecordWaitTime(snapshot, model_input_time, parameters);
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  for (auto& pair : parameters) {
     auto& parameter = pair.second;
     VLOG(2) << "Setting tunable parameter " << pair.first << " to "
             << parameter->value;
@@ -1464,11 +1635,18 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
     }
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
+    bool ram_bound = false;
     for (auto& pair : parameters) {
       if (pair.second->value == pair.second->max) {
         continue;
       }
       pair.second->value++;
+      if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+        // Increasing this parameter would exceed the memory budget.
+        pair.second->value--;
+        ram_bound = true;
+        continue;
+      }
       double new_output_time =
           OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
       double delta = output_time - new_output_time;
@@ -1480,6 +1658,12 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
       pair.second->value--;
     }
     if (!best_parameter) {
+      if (ram_bound) {
+        VLOG(2) << "The remaining tunable parameters cannot be increased "
+                   "without exceeding the RAM budget of "
+                << ram_budget << " bytes.";
+        break;
+      }
       VLOG(2) << "Failed to find a tunable parameter that would decrease the "
                  "output time. This means that the autotuning optimization got "
                  "stuck in a local maximum. The optimization attempt will be "
@@ -1488,6 +1672,8 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
     }
     best_parameter->value++;
   }
+  ShrinkToRamBudget(snapshot, model_input_time, ram_budget, parameters);
+  RecordWaitTime(snapshot, model_input_time, parameters);
   VLOG(2) << "Number of tunable parameters: " << parameters.size();
   for (auto& pair : parameters) {
     auto& parameter = pair.second;
@@ -1499,6 +1685,71 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
   }
 }
 
+void Model::ShrinkToRamBudget(
+    std::shared_ptr<Node> snapshot, double model_input_time, int64 ram_budget,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+        parameters) {
+  double total_bytes = TotalMaximumBufferedBytes(snapshot);
+  while (total_bytes > ram_budget) {
+    const double output_time =
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+    double best_cost = std::numeric_limits<double>::max();
+    double best_total_bytes = total_bytes;
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      if (pair.second->value - 1 < pair.second->min) {
+        continue;
+      }
+      pair.second->value--;
+      const double new_total_bytes = TotalMaximumBufferedBytes(snapshot);
+      const double saved_bytes = total_bytes - new_total_bytes;
+      if (saved_bytes > 0) {
+        // The output time increase per byte of memory saved.
+        const double cost =
+            (OutputTime(snapshot, model_input_time, /*gradients=*/nullptr) -
+             output_time) /
+            saved_bytes;
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_total_bytes = new_total_bytes;
+          best_parameter = pair.second.get();
+        }
+      }
+      pair.second->value++;
+    }
+    if (!best_parameter) {
+      VLOG(2) << "The worst-case total buffer size of " << total_bytes
+              << " bytes cannot be reduced to the RAM budget of " << ram_budget
+              << " bytes.";
+      return;
+    }
+    best_parameter->value--;
+    total_bytes = best_total_bytes;
+  }
+}
+
+void Model::RecordWaitTime(
+    std::shared_ptr<Node> snapshot, double model_input_time,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+        parameters) {
+  if (!shared_budget_) {
+    return;
+  }
+  const double output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  absl::flat_hash_map<string, double> values;
+  for (auto& pair : parameters) {
+    values[pair.first] = pair.second->value;
+    pair.second->value = pair.second->max;
+  }
+  const double min_output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  for (auto& pair : parameters) {
+    pair.second->value = values[pair.first];
+  }
+  shared_budget_->RecordWaitTime(this, output_time - min_output_time);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          absl::flat_hash_map<string, double>* gradients) {
   // To store the input time for each node.
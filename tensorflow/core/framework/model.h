@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
+#include <functional>
 #include <list>
 #include <memory>
 #include <string>
@@ -251,6 +252,11 @@ class Node {
   // Returns the node output.
   Node* output() const { return output_; }
 
+  // Returns the parameter with the given name, or `nullptr` if the node has no
+  // such parameter.
+  std::shared_ptr<Parameter> parameter(const string& name) const
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the aggregate processing time.
   int64 processing_time() const TF_LOCKS_EXCLUDED(mu_) {
     return processing_time_;
@@ -348,6 +354,11 @@ class Node {
   // operate over immutable state while allowing concurrent model updates.
   std::shared_ptr<Node> Snapshot() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Replaces the parameters of this node (but not those of its inputs) with
+  // copies, so that changing their values does not affect the node this node
+  // was snapshot from.
+  void CopyParameters() TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the per-element processing time spent in this node.
   double SelfProcessingTime() const TF_LOCKS_EXCLUDED(mu_);
 
@@ -589,6 +600,71 @@ std::shared_ptr<Node> MakeUnknownRatioNode(Node::Args args);
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+class Model;
+
+// Analysis of a node of a model, computed by `Model::Analyze()`. Times are in
+// nanoseconds per element.
+struct NodeAnalysis {
+  // The node name and unique node name.
+  string name;
+  string long_name;
+  // The number of elements produced by the node.
+  int64 num_elements = 0;
+  // The output latency of the node, i.e. the time it takes the node to
+  // produce an element, including the time spent waiting for its inputs
+  // (assuming that the input of the model is infinitely fast).
+  double output_time = 0;
+  // The processing time spent in the node itself, excluding its inputs.
+  double self_processing_time = 0;
+  // The current value of the parallelism of the node, or 1 if the node has no
+  // parallelism parameter.
+  double parallelism = 1;
+  // Whether the node spends more of its output latency waiting for its inputs
+  // than processing elements, in which case making the node itself faster
+  // would not help.
+  bool input_bound = false;
+  // The expected speedup of the whole model output if the parallelism of the
+  // node were increased to its maximum value, or 1 if the node has no
+  // parallelism parameter.
+  double estimated_speedup = 1;
+};
+
+// Shares a common CPU and RAM budget among all input pipelines of a process
+// that opt into it (see `Model::ShareBudget()`).
+//
+// Without sharing, every pipeline is tuned as if it had the whole machine to
+// itself, which makes concurrently running pipelines oversubscribe the CPU and
+// the memory. Instead, each model records the consumer wait time that it could
+// still remove by using more resources (see `RecordWaitTime()`), and the budget
+// is split among the models in proportion to it, so that resources move to the
+// pipelines whose consumers would benefit the most. A fraction of the budget
+// is split uniformly, so that no pipeline is starved.
+class SharedBudget {
+ public:
+  // Returns the budget shared by all input pipelines in the process.
+  static SharedBudget* Global();
+
+  SharedBudget() = default;
+
+  // Registers or unregisters a model that shares the budget.
+  void Register(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+  void Unregister(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Records the consumer wait time (in nanoseconds per element) that `model`
+  // could remove by tuning its parameters to their maximum values.
+  void RecordWaitTime(const Model* model, double wait_time)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Computes the share of `cpu_budget` and `ram_budget` available to `model`.
+  void GetShare(const Model* model, int64 cpu_budget, int64 ram_budget,
+                int64* cpu_share, int64* ram_share) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutex mu_;
+  // Maps each registered model to its last recorded wait time.
+  absl::flat_hash_map<const Model*, double> wait_times_ TF_GUARDED_BY(mu_);
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -602,11 +678,22 @@ std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 class Model {
  public:
   // Creates a new model.
-  Model() : collect_resource_usage_(false) {}
+  Model();
+
+  ~Model();
+
+  // Calls `fn` with every model of the process that is alive. Models are not
+  // destroyed while `fn` runs, so `fn` must not create or destroy models.
+  static void ForEachModel(const std::function<void(Model*)>& fn);
 
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
 
+  // Makes `Optimize()` tune the model within its share of `budget`, instead of
+  // the full CPU and RAM budgets it is given. Must be called before the first
+  // call to `Optimize()`.
+  void ShareBudget(SharedBudget* budget);
+
   // Adds a node with the given name and given parent.
   void AddNode(Node::Factory factory, const string& name,
                std::shared_ptr<Node> parent, std::shared_ptr<Node>* out_node)
@@ -622,6 +709,13 @@ class Model {
   // Removes the given node.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
 
+  // Analyzes a snapshot of the model, returning an analysis of each of its
+  // nodes from the output to the sources, in breadth-first order. The
+  // analysis can be used to find the bottleneck of the input pipeline: the
+  // compute-bound node with the largest output latency, or the node whose
+  // increased parallelism would speed up the model the most.
+  std::vector<NodeAnalysis> Analyze() TF_LOCKS_EXCLUDED(mu_);
+
  private:
   // Collects tunable parameters in the tree rooted in the given node, returning
   // a mapping from a (unique) node name to a tunable parameter.
@@ -641,10 +735,11 @@ class Model {
 
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then repeatedly identifies the
-  // parameter whose increase in parallelism decreases the output time the most.
-  // This process is repeated until all parameters reach their maximum values or
-  // the projected output time is less than or equal to the processing time
-  // needed to produce an element divided by CPU budget.
+  // parameter whose increase in parallelism decreases the output time the most,
+  // among the increases that keep the worst-case total buffer size within the
+  // RAM budget. This process is repeated until all parameters reach their
+  // maximum values or the projected output time is less than or equal to the
+  // processing time needed to produce an element divided by CPU budget.
   void OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
                          double model_input_time);
 
@@ -654,10 +749,30 @@ class Model {
   // projecting resulting values on the feasible intervals. Improvement step is
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
-  // an element divided by CPU budget.
+  // an element divided by CPU budget. The resulting parameters are then shrunk
+  // to fit into the RAM budget.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
                                double model_input_time);
 
+  // Decreases tunable parameters of `snapshot` until the worst-case total
+  // buffer size fits into `ram_budget`. Each step decreases the parameter with
+  // the lowest output time benefit per byte of buffered memory, so buffers
+  // whose elements are large but which barely reduce the output latency are
+  // shrunk first.
+  void ShrinkToRamBudget(
+      std::shared_ptr<Node> snapshot, double model_input_time,
+      int64 ram_budget,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+          parameters);
+
+  // Records in the shared budget (if any) the output time of `snapshot` that
+  // could still be removed by increasing the given parameters to their
+  // maximum values.
+  void RecordWaitTime(
+      std::shared_ptr<Node> snapshot, double model_input_time,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>&
+          parameters);
+
   // Collects the output time and if `gradients` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
   // node.
@@ -691,6 +806,9 @@ class Model {
   // tunable parameter (because the information is used for for tuning the value
   // of the parameter) and never stops.
   std::atomic<bool> collect_resource_usage_;
+
+  // The budget shared with other models, if any. Not owned.
+  SharedBudget* shared_budget_ = nullptr;
 };
 
 }  // namespace model
@@ -879,6 +879,185 @@ TEST_P(SelfProcessingTimeTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, SelfProcessingTimeTest,
                          ::testing::Values(0, 1, 2, 5, 10, 20, 40));
 
+class RamBudgetTest : public ::testing::TestWithParam<AutotuneAlgorithm> {};
+
+TEST_P(RamBudgetTest, Model) {
+  const AutotuneAlgorithm algorithm = GetParam();
+  auto mu = std::make_shared<mutex>();
+  auto cond_var = std::make_shared<condition_variable>();
+  auto large_buffer_size =
+      std::make_shared<SharedState>(kAutotune, mu, cond_var);
+  auto small_buffer_size =
+      std::make_shared<SharedState>(kAutotune, mu, cond_var);
+  Model model;
+  std::shared_ptr<Node> large;
+  model.AddNode(
+      [&large_buffer_size](Node::Args args) {
+        return MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {MakeParameter(kBufferSize, large_buffer_size, 1, 64)});
+      },
+      "large", nullptr, &large);
+  std::shared_ptr<Node> small;
+  model.AddNode(
+      [&small_buffer_size](Node::Args args) {
+        return MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {MakeParameter(kBufferSize, small_buffer_size, 1, 64)});
+      },
+      "small", large, &small);
+  std::shared_ptr<Node> source;
+  model.AddNode(MakeSourceNode, "source", small, &source);
+  for (int i = 0; i < 10; ++i) {
+    source->add_processing_time(1000);
+    source->record_element();
+    small->add_processing_time(100);
+    small->record_element();
+    large->add_processing_time(100);
+    large->record_element();
+  }
+  // Elements buffered by `large` are 100 times bigger than those buffered by
+  // `small`.
+  large->record_buffer_event(1000, 1);
+  small->record_buffer_event(10, 1);
+
+  constexpr int64 kRamBudget = 5000;
+  model.Optimize(algorithm, /*cpu_budget=*/4, kRamBudget,
+                 /*model_input_time=*/0);
+  EXPECT_GE(large_buffer_size->value, 1);
+  EXPECT_GE(small_buffer_size->value, 1);
+  // The bytes currently buffered are not part of the budget.
+  EXPECT_LE(large_buffer_size->value * 1000 + small_buffer_size->value * 10,
+            kRamBudget + 1010);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, RamBudgetTest,
+                         ::testing::Values(AutotuneAlgorithm::HILL_CLIMB,
+                                           AutotuneAlgorithm::GRADIENT_DESCENT));
+
+TEST(SharedBudgetTest, SingleModelGetsWholeBudget) {
+  SharedBudget budget;
+  Model model;
+  budget.Register(&model);
+  budget.RecordWaitTime(&model, 100);
+  int64 cpu_share, ram_share;
+  budget.GetShare(&model, 8, 1000, &cpu_share, &ram_share);
+  EXPECT_EQ(cpu_share, 8);
+  EXPECT_EQ(ram_share, 1000);
+  budget.Unregister(&model);
+}
+
+TEST(SharedBudgetTest, SplitsBudgetByWaitTime) {
+  SharedBudget budget;
+  Model model_a, model_b;
+  budget.Register(&model_a);
+  budget.Register(&model_b);
+  int64 cpu_share, ram_share;
+
+  // Without any recorded wait time, the budget is split uniformly.
+  budget.GetShare(&model_a, 10, 1000, &cpu_share, &ram_share);
+  EXPECT_EQ(cpu_share, 5);
+  EXPECT_EQ(ram_share, 500);
+
+  budget.RecordWaitTime(&model_a, 300);
+  budget.RecordWaitTime(&model_b, 100);
+  budget.GetShare(&model_a, 10, 1000, &cpu_share, &ram_share);
+  EXPECT_EQ(cpu_share, 7);
+  EXPECT_EQ(ram_share, 700);
+  budget.GetShare(&model_b, 10, 1000, &cpu_share, &ram_share);
+  EXPECT_EQ(cpu_share, 3);
+  EXPECT_EQ(ram_share, 300);
+
+  // A model whose consumer does not wait still gets part of the budget.
+  budget.RecordWaitTime(&model_b, 0);
+  budget.GetShare(&model_b, 10, 1000, &cpu_share, &ram_share);
+  EXPECT_EQ(cpu_share, 1);
+  EXPECT_EQ(ram_share, 100);
+
+  // Unregistered models give their share back.
+  budget.Unregister(&model_a);
+  budget.GetShare(&model_b, 10, 1000, &cpu_share, &ram_share);
+  EXPECT_EQ(cpu_share, 10);
+  EXPECT_EQ(ram_share, 1000);
+  budget.Unregister(&model_b);
+}
+
+class AnalyzeTest
+    : public ::testing::TestWithParam<std::tuple<int64, int64>> {};
+
+TEST_P(AnalyzeTest, Model) {
+  const int64 map_time = std::get<0>(GetParam());
+  const int64 source_time = std::get<1>(GetParam());
+  auto parallelism = std::make_shared<SharedState>(
+      /*value=*/1, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  Model model;
+  std::shared_ptr<Node> map;
+  model.AddNode(
+      [&parallelism](Node::Args args) {
+        return MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {MakeParameter(kParallelism, parallelism, 1, 8)});
+      },
+      "map", nullptr, &map);
+  std::shared_ptr<Node> source;
+  model.AddNode(MakeSourceNode, "source", map, &source);
+  for (int i = 0; i < 10; ++i) {
+    map->add_processing_time(map_time);
+    map->record_element();
+    source->add_processing_time(source_time);
+    source->record_element();
+  }
+
+  std::vector<NodeAnalysis> analyses = model.Analyze();
+  ASSERT_EQ(analyses.size(), 2);
+  const NodeAnalysis& map_analysis = analyses[0];
+  EXPECT_EQ(map_analysis.name, "map");
+  EXPECT_EQ(map_analysis.num_elements, 10);
+  EXPECT_EQ(map_analysis.self_processing_time, map_time);
+  EXPECT_EQ(map_analysis.parallelism, 1);
+  // The input of the model is infinitely fast, so `map` always waits for the
+  // source.
+  EXPECT_EQ(map_analysis.output_time, map_time + source_time);
+  EXPECT_EQ(map_analysis.input_bound, source_time > map_time);
+  EXPECT_DOUBLE_EQ(map_analysis.estimated_speedup,
+                   (map_time + source_time) / (map_time / 8.0 + source_time));
+  const NodeAnalysis& source_analysis = analyses[1];
+  EXPECT_EQ(source_analysis.name, "source");
+  EXPECT_EQ(source_analysis.output_time, source_time);
+  EXPECT_FALSE(source_analysis.input_bound);
+  EXPECT_EQ(source_analysis.estimated_speedup, 1);
+
+  // The analysis does not change the parameters of the model.
+  EXPECT_EQ(map->parameter(kParallelism)->value, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, AnalyzeTest,
+                         ::testing::Values(std::make_tuple(1000, 100),
+                                           std::make_tuple(10, 1000)));
+
+TEST(EmptyModelTest, Analyze) {
+  Model model;
+  EXPECT_TRUE(model.Analyze().empty());
+}
+
+TEST(ForEachModelTest, VisitsLiveModels) {
+  auto count = [](const Model* model) {
+    int count = 0;
+    Model::ForEachModel([&](Model* live_model) {
+      if (live_model == model) ++count;
+    });
+    return count;
+  };
+  const Model* destroyed;
+  {
+    Model model;
+    EXPECT_EQ(count(&model), 1);
+    destroyed = &model;
+  }
+  EXPECT_EQ(count(destroyed), 0);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
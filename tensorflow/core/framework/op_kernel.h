@@ -643,6 +643,18 @@ class OpKernelContext {
     // stored in this container..
     ScopedStepContainer* step_container = nullptr;
 
+    // If not null, an allocator whose buffers are only expected to live for
+    // the duration of the step. When set, it is used instead of the device
+    // allocator for allocations with default attributes.
+    Allocator* step_allocator = nullptr;
+
+    // If not null, an array indexed by output number for this node. When an
+    // element is not null, it is used instead of the device allocator to
+    // allocate the corresponding output, if it is allocated with default
+    // attributes (e.g. to compute a fetched value directly in a buffer owned
+    // by the caller).
+    Allocator* const* output_allocators = nullptr;
+
     // Mechanism used by this op kernel invocation to communicate with
     // computations running on other devices.
     RendezvousInterface* rendezvous = nullptr;
@@ -1282,6 +1294,12 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  // Allocates `out_tensor` with the given allocator, instead of the one for
+  // `allocator_attr`.
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
+
   // Helpers for `set_output()`.
 
   // Returns `true` if the tensor was copied into an allocated output.
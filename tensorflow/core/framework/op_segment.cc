@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -108,4 +110,84 @@ bool OpSegment::ShouldOwnKernel(FunctionLibraryRuntime* lib,
          node_op != "PartitionedCall" && node_op != "StatefulPartitionedCall";
 }
 
+/*static*/ SharedKernelCache* SharedKernelCache::Global() {
+  static SharedKernelCache* cache = new SharedKernelCache;
+  return cache;
+}
+
+SharedKernelCache::SharedKernelCache() {}
+
+SharedKernelCache::~SharedKernelCache() {
+  for (const auto& kv : kernels_) delete kv.second.kernel;
+}
+
+Status SharedKernelCache::FindOrCreate(const string& device_name,
+                                       int graph_def_version,
+                                       const NodeDef& ndef, OpKernel** kernel,
+                                       OpSegment::CreateKernelFn create_fn) {
+  string serialized_ndef;
+  if (!SerializeToStringDeterministic(ndef, &serialized_ndef)) {
+    return errors::Internal("Failed to serialize node ", ndef.name());
+  }
+  const string key =
+      strings::StrCat(device_name, "\n", graph_def_version, "\n",
+                      serialized_ndef);
+  {
+    mutex_lock l(mu_);
+    auto it = kernels_.find(key);
+    if (it != kernels_.end()) {
+      ++it->second.num_refs;
+      *kernel = it->second.kernel;
+      return Status::OK();
+    }
+  }
+  TF_RETURN_IF_ERROR(create_fn(kernel));
+  {
+    mutex_lock l(mu_);
+    Entry& entry = kernels_[key];
+    if (entry.kernel == nullptr) {
+      entry.kernel = *kernel;  // Inserts 'kernel' in the cache.
+      keys_[*kernel] = key;
+    } else {
+      delete *kernel;
+      *kernel = entry.kernel;
+    }
+    ++entry.num_refs;
+  }
+  return Status::OK();
+}
+
+bool SharedKernelCache::Release(const OpKernel* kernel) {
+  OpKernel* to_delete = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto key = keys_.find(kernel);
+    if (key == keys_.end()) return false;
+    auto it = kernels_.find(key->second);
+    DCHECK(it != kernels_.end());
+    if (--it->second.num_refs > 0) return true;
+    to_delete = it->second.kernel;
+    kernels_.erase(it);
+    keys_.erase(key);
+  }
+  delete to_delete;
+  return true;
+}
+
+/*static*/ bool SharedKernelCache::ShouldShareKernel(
+    FunctionLibraryRuntime* lib, const NodeDef& ndef) {
+  const string& op = ndef.op();
+  if (lib->IsStateful(op) ||
+      lib->GetFunctionLibraryDefinition()->Find(op) != nullptr ||
+      op == "PartitionedCall" || op == "StatefulPartitionedCall") {
+    return false;
+  }
+  for (const auto& attr : ndef.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // end namespace tensorflow
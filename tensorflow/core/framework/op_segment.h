@@ -84,6 +84,55 @@ class OpSegment {
   TF_DISALLOW_COPY_AND_ASSIGN(OpSegment);
 };
 
+// SharedKernelCache shares the kernels of stateless nodes between the
+// sessions of a process, so that sessions running the same model do not each
+// construct the same kernels again.
+//
+// Kernels are shared between nodes with the same NodeDef, including the node
+// name, placed on devices with the same name, for the same GraphDef version.
+// Every kernel returned by FindOrCreate() is reference-counted, and deleted
+// by the Release() call dropping its last reference.
+class SharedKernelCache {
+ public:
+  // Returns the process-wide cache.
+  static SharedKernelCache* Global();
+
+  SharedKernelCache();
+  ~SharedKernelCache();
+
+  // Returns in "*kernel" the kernel cached for "ndef" on "device_name", or
+  // creates it by calling create_fn() and caches it. Each successful call
+  // must be matched with a call to Release().
+  Status FindOrCreate(const std::string& device_name, int graph_def_version,
+                      const NodeDef& ndef, OpKernel** kernel,
+                      OpSegment::CreateKernelFn create_fn);
+
+  // Drops the reference on "kernel" taken by FindOrCreate(). Returns false
+  // if "kernel" was not returned by FindOrCreate().
+  bool Release(const OpKernel* kernel);
+
+  // Returns true if the kernel of "ndef" can be shared between sessions:
+  // the op must be stateless, and the node must not call any function, whose
+  // handles are tied to the function library runtime of a session.
+  static bool ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                const NodeDef& ndef);
+
+ private:
+  struct Entry {
+    OpKernel* kernel = nullptr;
+    int num_refs = 0;
+  };
+
+  mutable mutex mu_;
+  // Key, made of the device name, GraphDef version and serialized NodeDef ->
+  // entry.
+  std::unordered_map<string, Entry> kernels_ TF_GUARDED_BY(mu_);
+  // Kernel -> its key in kernels_.
+  std::unordered_map<const OpKernel*, string> keys_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedKernelCache);
+};
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_FRAMEWORK_OP_SEGMENT_H_
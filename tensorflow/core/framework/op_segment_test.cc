@@ -156,4 +156,62 @@ TEST_F(OpSegmentTest, AddRemoveHolds) {
   opseg.RemoveHold("foo");
 }
 
+TEST_F(OpSegmentTest, SharedKernelCache) {
+  SharedKernelCache cache;
+  const NodeDef& ndef = float_nodedefs_[0];
+  const string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+  int num_created = 0;
+  auto create_fn = [this, &ndef, &num_created](OpKernel** kernel) {
+    ++num_created;
+    return GetFn(&ndef)(kernel);
+  };
+
+  OpKernel* op1;
+  TF_EXPECT_OK(cache.FindOrCreate(device, TF_GRAPH_DEF_VERSION, ndef, &op1,
+                                  create_fn));
+  ValidateOpAndTypes(op1, ndef, DT_FLOAT);
+  OpKernel* op2;
+  TF_EXPECT_OK(cache.FindOrCreate(device, TF_GRAPH_DEF_VERSION, ndef, &op2,
+                                  create_fn));
+  EXPECT_EQ(op1, op2);
+  EXPECT_EQ(1, num_created);
+
+  // Another device, GraphDef version or NodeDef gets its own kernel.
+  OpKernel* op3;
+  TF_EXPECT_OK(
+      cache.FindOrCreate("/job:localhost/replica:0/task:0/device:CPU:1",
+                         TF_GRAPH_DEF_VERSION, ndef, &op3, create_fn));
+  EXPECT_NE(op1, op3);
+  OpKernel* op4;
+  TF_EXPECT_OK(cache.FindOrCreate(device, TF_GRAPH_DEF_VERSION - 1, ndef,
+                                  &op4, create_fn));
+  EXPECT_NE(op1, op4);
+  OpKernel* op5;
+  TF_EXPECT_OK(cache.FindOrCreate(
+      device, TF_GRAPH_DEF_VERSION, int32_nodedefs_[0], &op5,
+      GetFn(&int32_nodedefs_[0])));
+  ValidateOpAndTypes(op5, int32_nodedefs_[0], DT_INT32);
+  EXPECT_EQ(3, num_created);
+
+  // The kernel stays cached until its last reference is released.
+  EXPECT_TRUE(cache.Release(op1));
+  OpKernel* op6;
+  TF_EXPECT_OK(cache.FindOrCreate(device, TF_GRAPH_DEF_VERSION, ndef, &op6,
+                                  create_fn));
+  EXPECT_EQ(op1, op6);
+  EXPECT_EQ(3, num_created);
+  EXPECT_TRUE(cache.Release(op2));
+  EXPECT_TRUE(cache.Release(op6));
+  EXPECT_FALSE(cache.Release(op6));
+  TF_EXPECT_OK(cache.FindOrCreate(device, TF_GRAPH_DEF_VERSION, ndef, &op1,
+                                  create_fn));
+  EXPECT_EQ(4, num_created);
+
+  // Kernels that were not created by the cache are not released.
+  OpKernel* not_cached;
+  TF_ASSERT_OK(GetFn(&ndef)(&not_cached));
+  EXPECT_FALSE(cache.Release(not_cached));
+  delete not_cached;
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <utility>
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -174,4 +177,69 @@ class LocalRendezvousWrapper : public Rendezvous {
 
 Rendezvous* NewLocalRendezvous() { return new LocalRendezvousWrapper; }
 
+namespace {
+
+std::atomic<bool> wait_accounting_enabled{false};
+
+struct RendezvousWaitTable {
+  mutex mu;
+  // Keyed by "src_device;dst_device;edge_name".
+  gtl::FlatMap<string, RendezvousWaitStats> edges TF_GUARDED_BY(mu);
+};
+
+RendezvousWaitTable* GetRendezvousWaitTable() {
+  static RendezvousWaitTable* table = new RendezvousWaitTable;
+  return table;
+}
+
+}  // namespace
+
+void SetRendezvousWaitAccounting(bool enabled) {
+  wait_accounting_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool RendezvousWaitAccountingEnabled() {
+  return wait_accounting_enabled.load(std::memory_order_relaxed);
+}
+
+void RecordRendezvousWait(const Rendezvous::ParsedKey& key, int64 wait_us) {
+  if (!RendezvousWaitAccountingEnabled()) return;
+  const string edge =
+      strings::StrCat(key.src_device, ";", key.dst_device, ";", key.edge_name);
+  RendezvousWaitTable* table = GetRendezvousWaitTable();
+  mutex_lock l(table->mu);
+  RendezvousWaitStats& stats = table->edges[edge];
+  if (stats.num_waits == 0) {
+    stats.src_device = string(key.src_device);
+    stats.dst_device = string(key.dst_device);
+    stats.edge_name = string(key.edge_name);
+  }
+  ++stats.num_waits;
+  stats.total_wait_us += wait_us;
+  stats.max_wait_us = std::max(stats.max_wait_us, wait_us);
+}
+
+std::vector<RendezvousWaitStats> GetRendezvousWaitStats() {
+  std::vector<RendezvousWaitStats> result;
+  {
+    RendezvousWaitTable* table = GetRendezvousWaitTable();
+    mutex_lock l(table->mu);
+    result.reserve(table->edges.size());
+    for (const auto& edge : table->edges) {
+      result.push_back(edge.second);
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const RendezvousWaitStats& a, const RendezvousWaitStats& b) {
+              return a.total_wait_us > b.total_wait_us;
+            });
+  return result;
+}
+
+void ResetRendezvousWaitStats() {
+  RendezvousWaitTable* table = GetRendezvousWaitTable();
+  mutex_lock l(table->mu);
+  table->edges.clear();
+}
+
 }  // end namespace tensorflow
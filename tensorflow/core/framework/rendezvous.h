@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_RENDEZVOUS_H_
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -183,6 +184,32 @@ class Rendezvous : public RendezvousInterface, public core::RefCounted {
 // ownership of one Ref() on the returned object.
 Rendezvous* NewLocalRendezvous();
 
+// The time Recvs waited for their tensor, i.e. from the Recv request to the
+// arrival of the matching Send, aggregated per edge across steps, frames and
+// iterations.
+struct RendezvousWaitStats {
+  std::string src_device;
+  std::string dst_device;
+  std::string edge_name;
+  int64 num_waits = 0;
+  int64 total_wait_us = 0;
+  int64 max_wait_us = 0;
+};
+
+// Enables the accounting of the Recv waits, e.g. while profiling. It is
+// disabled by default.
+void SetRendezvousWaitAccounting(bool enabled);
+bool RendezvousWaitAccountingEnabled();
+
+// Records that a Recv of `key` waited `wait_us` for its tensor. Does nothing
+// unless the accounting is enabled.
+void RecordRendezvousWait(const Rendezvous::ParsedKey& key, int64 wait_us);
+
+// Returns the edges waited for since the last reset, by decreasing total
+// wait.
+std::vector<RendezvousWaitStats> GetRendezvousWaitStats();
+void ResetRendezvousWaitStats();
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_FRAMEWORK_RENDEZVOUS_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <atomic>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -384,6 +386,30 @@ TEST_F(LocalRendezvousTest, RecvSleepAbort) {
   EXPECT_TRUE(errors::IsAborted(status));
 }
 
+TEST_F(LocalRendezvousTest, AbortManyPendingRecvs) {
+  // Enough keys to have pending receivers in every shard of the table.
+  static const int N = 1000;
+  std::atomic<int> num_aborted(0);
+  for (int i = 0; i < N; ++i) {
+    rendez_->RecvAsync(MakeKey(strings::StrCat("recv_", i)),
+                       Rendezvous::Args(),
+                       [&num_aborted](const Status& status,
+                                      const Rendezvous::Args& sender_args,
+                                      const Rendezvous::Args& recver_args,
+                                      const Tensor& val, const bool val_dead) {
+                         EXPECT_TRUE(errors::IsAborted(status)) << status;
+                         ++num_aborted;
+                       });
+  }
+  rendez_->StartAbort(errors::Aborted(""));
+  EXPECT_EQ(N, num_aborted);
+  for (int i = 0; i < N; ++i) {
+    EXPECT_TRUE(errors::IsAborted(rendez_->Send(
+        MakeKey(strings::StrCat("send_", i)), Rendezvous::Args(), V("x"),
+        false)));
+  }
+}
+
 TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
   rendez_->StartAbort(errors::Aborted(""));
   Tensor val(DT_STRING);
@@ -394,6 +420,43 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
       errors::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+TEST_F(LocalRendezvousTest, AccountsRecvWaits) {
+  ResetRendezvousWaitStats();
+  SetRendezvousWaitAccounting(true);
+  Rendezvous::Args args;
+  for (int i = 0; i < 2; ++i) {
+    Notification received;
+    rendez_->RecvAsync(KeyFoo(), args,
+                       [&received](const Status& s, const Rendezvous::Args&,
+                                   const Rendezvous::Args&, const Tensor&,
+                                   bool) {
+                         TF_EXPECT_OK(s);
+                         received.Notify();
+                       });
+    Env::Default()->SleepForMicroseconds(10000);
+    TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V("hello"), false));
+    received.WaitForNotification();
+  }
+  // A Recv of a tensor which was already sent does not wait.
+  TF_ASSERT_OK(rendez_->Send(KeyBar(), args, V("hello"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyBar(), args, &val, &is_dead));
+  SetRendezvousWaitAccounting(false);
+
+  const std::vector<RendezvousWaitStats> stats = GetRendezvousWaitStats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].src_device, "/job:mnist/replica:1/task:2/CPU:0");
+  EXPECT_EQ(stats[0].dst_device, "/job:mnist/replica:1/task:2/device:GPU:0");
+  EXPECT_EQ(stats[0].edge_name, "foo");
+  EXPECT_EQ(stats[0].num_waits, 2);
+  EXPECT_GE(stats[0].total_wait_us, 2 * 10000);
+  EXPECT_GE(stats[0].max_wait_us, 10000);
+  EXPECT_LE(stats[0].max_wait_us, stats[0].total_wait_us);
+  ResetRendezvousWaitStats();
+  EXPECT_TRUE(GetRendezvousWaitStats().empty());
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -51,6 +51,12 @@ namespace tensorflow {
 // shared mutex prevents them from overlapping with dense writes, which is
 // necessary as dense writes can change the shape the of the tensor.
 //
+// A variable can also be made read-only by an `AssignVariableOp` with
+// `read_only=true`, e.g. for weights that are loaded once and then served.
+// Reads of a read-only variable then alias its tensor without grabbing the
+// mutex, whatever the mode of the variable, and writes fail; ops writing to
+// variables must call `CheckWritable()` before doing so.
+//
 // Transitioning a variable from copy-on-read mode to copy-on-write mode is
 // currently not supported. To upgrade a variable from copy-on-write to
 // copy-on-read use `EnsureSparseVariableAccess()`, and then grab the variable's
@@ -87,6 +93,19 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Set once the tensor has been assigned for the last time. From then on the
+  // tensor is never replaced nor written to, so it can be read without mu_.
+  std::atomic<bool> read_only{false};
+
+  // Returns an error if the variable is read-only.
+  Status CheckWritable() const {
+    if (read_only.load()) {
+      return errors::FailedPrecondition(
+          "Trying to write to a read-only variable: ", DebugString());
+    }
+    return Status::OK();
+  }
+
  private:
   mutex mu_;
   Tensor tensor_;
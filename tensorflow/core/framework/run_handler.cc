@@ -19,12 +19,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <list>
 #include <memory>
+#include <tuple>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -44,6 +47,21 @@ static constexpr int32 kMaxConcurrentHandlers = 128;
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+// Only one in this many tasks has its queueing delay recorded, to keep the
+// overhead of reading the clock off the scheduling fast path.
+static constexpr uint32 kQueueingDelaySamplingPeriod = 16;
+
+monitoring::Sampler<1>* QueueingDelaySampler() {
+  static monitoring::Sampler<1>* sampler = monitoring::Sampler<1>::New(
+      {"/tensorflow/core/run_handler/queueing_delay_usecs",
+       "Time that closures scheduled through a RunHandler spend in the queue "
+       "before they start running, by request priority.",
+       "priority"},
+      // Buckets from 1us to ~16s.
+      monitoring::Buckets::Exponential(1, 2, 24));
+  return sampler;
+}
+
 }  // namespace
 
 namespace internal {
@@ -82,6 +100,10 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
 }
 
 void RunHandlerEnvironment::ExecuteTask(const Task& t) {
+  if (t.f->queueing_delay_cell != nullptr) {
+    t.f->queueing_delay_cell->Add(EnvTime::NowMicros() -
+                                  t.f->enqueue_time_us);
+  }
   WithContext wc(t.f->context);
   tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                t.f->trace_id);
@@ -131,6 +153,7 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      queueing_delay_cell_(nullptr),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -260,6 +283,14 @@ int64 ThreadWorkSource::GetTracemeId() {
 
 void ThreadWorkSource::SetTracemeId(int64 value) { traceme_id_ = value; }
 
+void ThreadWorkSource::SetQueueingDelayCell(monitoring::SamplerCell* cell) {
+  queueing_delay_cell_.store(cell, std::memory_order_relaxed);
+}
+
+monitoring::SamplerCell* ThreadWorkSource::GetQueueingDelayCell() {
+  return queueing_delay_cell_.load(std::memory_order_relaxed);
+}
+
 void ThreadWorkSource::SetWaiter(uint64 version, Waiter* waiter, mutex* mutex) {
   {
     tf_shared_lock lock(run_handler_waiter_mu_);
@@ -384,6 +415,13 @@ void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking,
                                           std::function<void()> fn) {
   Task t = env_.CreateTask(std::move(fn));
+  thread_local uint32 sample_counter = 0;
+  if (++sample_counter % kQueueingDelaySamplingPeriod == 0) {
+    t.f->queueing_delay_cell = tws->GetQueueingDelayCell();
+    if (t.f->queueing_delay_cell != nullptr) {
+      t.f->enqueue_time_us = EnvTime::NowMicros();
+    }
+  }
   t = tws->EnqueueTask(std::move(t), is_blocking);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -728,11 +766,14 @@ class RunHandler::Impl {
   // Stores now time (in microseconds) since unix epoch when the handler is
   // requested via RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
+  // Time (in microseconds since unix epoch) by which the request should
+  // complete, or the maximum uint64 value if it has no deadline.
+  uint64 deadline_us() const { return deadline_us_; }
   int64 step_id() const { return step_id_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64 step_id,
+  void Reset(int64 step_id, int64 timeout_in_ms,
              const RunOptions::Experimental::RunHandlerPoolOptions& options);
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
@@ -757,6 +798,7 @@ class RunHandler::Impl {
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
+  uint64 deadline_us_;
   int64 step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
@@ -783,7 +825,10 @@ class RunHandlerPool::Impl {
         version_(0),
         sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
             "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
-            std::vector<double>({1}))) {
+            std::vector<double>({1}))),
+        starvation_threshold_us_(static_cast<uint64>(
+            1000 * ParamFromEnvWithDefault(
+                       "TF_RUN_HANDLER_STARVATION_THRESHOLD_MS", 0.0))) {
     VLOG(1) << "Creating a RunHandlerPool with max handlers: " << max_handlers_;
     free_handlers_.reserve(max_handlers_);
     handlers_.reserve(max_handlers_);
@@ -854,25 +899,27 @@ class RunHandlerPool::Impl {
           return nullptr;
         }
       }
-      // Remove the last entry from free_handlers_ and add to the end of
+      // Remove the last entry from free_handlers_ and add it to
       // sorted_active_handlers_.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      handler_impl->Reset(step_id, timeout_in_ms, options);
       free_handlers_.pop_back();
-
-      num_active_requests = sorted_active_handlers_.size() + 1;
+      sorted_active_handlers_.push_back(handler_impl);
+
+      // Recompute the order of all active handlers, since the handlers that
+      // have been starving since the last call may now have to move ahead.
+      // The sort is stable, so handlers with the same scheduling key remain
+      // in order of arrival.
+      const uint64 now_us = handler_impl->start_time_us();
+      sorted_active_handlers_.sort(
+          [this, now_us](RunHandler::Impl* a, RunHandler::Impl* b) {
+            return SchedulingKey(a, now_us) < SchedulingKey(b, now_us);
+          });
+
+      num_active_requests = sorted_active_handlers_.size();
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
-      bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
-          sorted_active_handlers_.insert(it, handler_impl);
-          new_handler_inserted = true;
-          // Point to the newly added handler.
-          --it;
-        }
         (*thread_work_sources)[i] = (*it)->tws();
         ++it;
       }
@@ -923,6 +970,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -931,6 +988,20 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the key by which the active handlers are sorted at time `now_us`:
+  // starving handlers first, in order of arrival, then the other handlers by
+  // decreasing priority and increasing deadline.
+  std::tuple<bool, int64, uint64> SchedulingKey(RunHandler::Impl* handler,
+                                                uint64 now_us) const {
+    const bool starving =
+        starvation_threshold_us_ > 0 &&
+        now_us >= handler->start_time_us() + starvation_threshold_us_;
+    if (starving) {
+      return std::make_tuple(false, int64{0}, handler->start_time_us());
+    }
+    return std::make_tuple(true, -handler->priority(), handler->deadline_us());
+  }
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -942,8 +1013,7 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by `SchedulingKey()`.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -958,6 +1028,10 @@ class RunHandlerPool::Impl {
   mutex mu_;
   int64 version_ TF_GUARDED_BY(mu_);
   const std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  // Handlers that have been active for longer than this are scheduled first.
+  // Zero disables starvation protection.
+  const uint64 starvation_threshold_us_;
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
@@ -1048,7 +1122,7 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
+  Reset(0, 0, RunOptions::Experimental::RunHandlerPoolOptions());
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -1064,10 +1138,17 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
 }
 
 void RunHandler::Impl::Reset(
-    int64 step_id,
+    int64 step_id, int64 timeout_in_ms,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
+  deadline_us_ = timeout_in_ms > 0 ? start_time_us_ + timeout_in_ms * 1000
+                                   : std::numeric_limits<uint64>::max();
   step_id_ = step_id;
+  if (options_.priority() != options.priority() ||
+      tws_.GetQueueingDelayCell() == nullptr) {
+    tws_.SetQueueingDelayCell(QueueingDelaySampler()->GetCell(
+        strings::StrCat(options.priority())));
+  }
   options_ = options;
   tws_.SetTracemeId(step_id);
 }
@@ -1092,6 +1173,10 @@ std::vector<int64> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64> RunHandlerPool::GetActiveHandlerStepIdsForTesting() const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -47,6 +48,15 @@ class RunHandler;
 // * Use handler for scheduling all inter-op work by:
 // handler->ScheduleInterOpClosure(closure);
 //
+// Work from the active handlers is dequeued in order of decreasing priority
+// (see `RunHandlerPoolOptions`), and of increasing deadline among the
+// handlers with the same priority. The deadline of a handler is derived from
+// the `timeout_in_ms` passed to `Get()`, and handlers without a timeout come
+// last. To prevent starvation, a handler that has been active for longer than
+// TF_RUN_HANDLER_STARVATION_THRESHOLD_MS milliseconds (if set) is moved ahead
+// of all other handlers the next time the order is recomputed, i.e. when a
+// handler is requested.
+//
 // This class is thread safe.
 class RunHandlerPool {
  public:
@@ -72,6 +82,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids for active handlers, in the order in which their work is
+  // dequeued.
+  std::vector<int64> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -116,6 +130,10 @@ class RunHandlerEnvironment {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // If not null, the time that the task spends in the queue is recorded in
+    // this cell.
+    monitoring::SamplerCell* queueing_delay_cell = nullptr;
+    uint64 enqueue_time_us = 0;
   };
   Env* const env_;
   const ThreadOptions thread_options_;
@@ -173,6 +191,12 @@ class ThreadWorkSource {
 
   void SetTracemeId(int64 value);
 
+  // Sets the cell in which the queueing delays of (a sample of) the tasks of
+  // this work source are recorded, or nullptr to not record them.
+  void SetQueueingDelayCell(monitoring::SamplerCell* cell);
+
+  monitoring::SamplerCell* GetQueueingDelayCell();
+
   void SetWaiter(uint64 version, Waiter* waiter, mutex* mutex);
 
   int64 GetInflightTaskCount(bool is_blocking);
@@ -204,6 +228,7 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64> traceme_id_;
+  std::atomic<monitoring::SamplerCell*> queueing_delay_cell_;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -113,6 +113,49 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/60000, options);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/1000, options);
+  options.set_priority(2);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  // Within a priority, requests are ordered by deadline, and requests without
+  // a deadline come last.
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64>({4, 3, 2, 1}));
+}
+
+TEST(RunHandlerUtilTest, StarvationProtectionTest) {
+  ASSERT_EQ(setenv("TF_RUN_HANDLER_STARVATION_THRESHOLD_MS", "50", true), 0);
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+  unsetenv("TF_RUN_HANDLER_STARVATION_THRESHOLD_MS");
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.set_priority(2);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64>({2, 1}));
+
+  // Once both requests have waited for longer than the threshold, they are
+  // scheduled in order of arrival, ahead of new higher-priority requests.
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  options.set_priority(3);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64>({1, 2, 3}));
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
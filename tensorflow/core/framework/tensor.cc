@@ -140,6 +140,53 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// A buffer for a small tensor in host memory, allocated along with its data.
+// The data comes first, to keep its alignment. This saves the second heap
+// allocation of a Buffer for scalars and other small tensors.
+class SmallHostTensorBuffer : public TensorBuffer {
+ public:
+  // Maximum size of the data.
+  static constexpr int64 kMaxBytes = 64;
+  static_assert(kMaxBytes % EIGEN_MAX_ALIGN_BYTES == 0,
+                "The buffer must follow aligned data");
+
+  static SmallHostTensorBuffer* New(int64 bytes) {
+    char* data = static_cast<char*>(port::AlignedMalloc(
+        kMaxBytes + sizeof(SmallHostTensorBuffer), EIGEN_MAX_ALIGN_BYTES));
+    return new (data + kMaxBytes) SmallHostTensorBuffer(data, bytes);
+  }
+
+  size_t size() const override { return bytes_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("SmallHostTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Frees the allocation holding the data, when `delete this` is called by
+  // `core::RefCounted::Unref()`.
+  static void operator delete(void* ptr) {
+    port::AlignedFree(static_cast<char*>(ptr) - kMaxBytes);
+  }
+
+  static void operator delete(void*, void*) {
+    // Matches the placement `new` of New().
+  }
+
+ private:
+  SmallHostTensorBuffer(void* data, int64 bytes)
+      : TensorBuffer(data), bytes_(bytes) {}
+  ~SmallHostTensorBuffer() override = default;
+
+  const int64 bytes_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SmallHostTensorBuffer);
+};
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -769,12 +816,45 @@ bool Tensor::RefCountIsOne() const {
                      LOG(FATAL) << "Unexpected type: " << TYPE_ENUM; \
                      , LOG(FATAL) << "Type not set";)
 
+// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
+// the default CPU allocator for NUMA zone 0. Accessing that currently involves
+// acquiring a lock, which guards initialization of the per-NUMA zone
+// allocators, and becomes highly contended.
+//
+// Note also that it would be better if all Tensor allocations required the user
+// to specify an allocator, for purposes of accounting, etc. However, the
+// default allocator is widely used throughout the codebase and in client code.
+static Allocator* get_default_cpu_allocator() {
+  static Allocator* default_cpu_allocator =
+      cpu_allocator(port::kNUMANoAffinity);
+  return default_cpu_allocator;
+}
+
+// Returns a buffer holding its data for a small tensor of the default CPU
+// allocator, or nullptr if the tensor must be allocated by `a`. The tensors
+// are left to `a` when their allocations are accounted for.
+static TensorBuffer* MaybeNewSmallHostTensorBuffer(
+    Allocator* a, DataType type, int64 num_elements,
+    const AllocationAttributes& allocation_attr = AllocationAttributes()) {
+  if (a != get_default_cpu_allocator() || !DataTypeCanUseMemcpy(type) ||
+      allocation_attr.freed_by_func != nullptr || CPUAllocatorStatsEnabled() ||
+      MemoryLoggingEnabled()) {
+    return nullptr;
+  }
+  const int64 bytes = num_elements * DataTypeSize(type);
+  if (bytes <= 0 || bytes > SmallHostTensorBuffer::kMaxBytes) return nullptr;
+  return SmallHostTensorBuffer::New(bytes);
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    buf_ = MaybeNewSmallHostTensorBuffer(a, type, shape_.num_elements());
+    if (buf_ == nullptr) {
+      CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    }
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -788,7 +868,12 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    buf_ = MaybeNewSmallHostTensorBuffer(a, type, shape_.num_elements(),
+                                         allocation_attr);
+    if (buf_ == nullptr) {
+      CASES(type,
+            buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    }
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
       buf_ != nullptr && buf_->data() != nullptr) {
@@ -797,20 +882,6 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   }
 }
 
-// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
-// the default CPU allocator for NUMA zone 0. Accessing that currently involves
-// acquiring a lock, which guards initialization of the per-NUMA zone
-// allocators, and becomes highly contended.
-//
-// Note also that it would be better if all Tensor allocations required the user
-// to specify an allocator, for purposes of accounting, etc. However, the
-// default allocator is widely used throughout the codebase and in client code.
-static Allocator* get_default_cpu_allocator() {
-  static Allocator* default_cpu_allocator =
-      cpu_allocator(port::kNUMANoAffinity);
-  return default_cpu_allocator;
-}
-
 Tensor::Tensor(DataType type, const TensorShape& shape)
     : Tensor(get_default_cpu_allocator(), type, shape) {}
 
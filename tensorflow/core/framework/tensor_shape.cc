@@ -289,24 +289,6 @@ void TensorShapeRep::SlowCopyFrom(const TensorShapeRep& b) {
   }
 }
 
-template <class Shape>
-int64 TensorShapeBase<Shape>::dim_size(int d) const {
-  if (unknown_rank()) return -1;
-  DCHECK_GE(d, 0);
-  DCHECK_LT(d, dims());
-  if (tag() == REP16) {
-    uint16 dim = as16()->dims_[d];
-    if (kIsPartial && dim == kUnknownRep16) return -1;
-    return dim;
-  } else if (tag() == REP32) {
-    uint32 dim = as32()->dims_[d];
-    if (kIsPartial && dim == kUnknownRep32) return -1;
-    return dim;
-  } else {
-    return (*as64()->dims_)[d];
-  }
-}
-
 void TensorShapeRep::Clear() {
   ClearAllButDataType();
   set_data_type(DT_INVALID);
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
@@ -575,6 +576,26 @@ inline TensorShapeBase<Shape>::TensorShapeBase(DataType dt) {
   set_num_elements(0);
 }
 
+template <class Shape>
+inline int64 TensorShapeBase<Shape>::dim_size(int d) const {
+  if (unknown_rank()) return -1;
+  DCHECK_GE(d, 0);
+  DCHECK_LT(d, dims());
+  // Most shapes fit in REP16, so check for it first.  For TensorShape the
+  // unknown dimension checks compile away.
+  if (TF_PREDICT_TRUE(tag() == REP16)) {
+    uint16 dim = as16()->dims_[d];
+    if (kIsPartial && dim == kUnknownRep16) return -1;
+    return dim;
+  } else if (tag() == REP32) {
+    uint32 dim = as32()->dims_[d];
+    if (kIsPartial && dim == kUnknownRep32) return -1;
+    return dim;
+  } else {
+    return (*as64()->dims_)[d];
+  }
+}
+
 // Declare explicit instantiations in .cc file
 extern template class TensorShapeBase<TensorShape>;
 extern template class TensorShapeBase<PartialTensorShape>;
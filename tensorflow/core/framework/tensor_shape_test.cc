@@ -701,5 +701,26 @@ static void BM_TensorShape_Assign(int iters, int arg) {
 }
 BENCHMARK(BM_TensorShape_Assign)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
 
+static void BM_TensorShape_DimSize(int iters, int arg) {
+  TensorShape s(MakeSizes(arg));
+  const int dims = s.dims();
+  while (--iters > 0) {
+    for (int d = 0; d < dims; ++d) {
+      tensorflow::testing::DoNotOptimize(s.dim_size(d));
+    }
+  }
+}
+BENCHMARK(BM_TensorShape_DimSize)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+
+static void BM_TensorShape_AddDim(int iters, int arg) {
+  auto sizes = MakeSizes(arg);
+  while (--iters > 0) {
+    TensorShape shape;
+    for (int64 size : sizes) shape.AddDim(size);
+    tensorflow::testing::DoNotOptimize(shape.num_elements());
+  }
+}
+BENCHMARK(BM_TensorShape_AddDim)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+
 }  // namespace
 }  // namespace tensorflow
@@ -1173,6 +1173,24 @@ TEST(Tensor, SharesBufferWith) {
   EXPECT_TRUE(a.SharesBufferWith(copy));
 }
 
+TEST(Tensor, SmallHostTensors) {
+  // Tensors of up to 64 bytes hold their data in their buffer.
+  for (int64 n : {1, 3, 16, 17}) {
+    Tensor t(DT_FLOAT, TensorShape({n}));
+    EXPECT_TRUE(t.IsAligned());
+    auto flat = t.flat<float>();
+    for (int64 i = 0; i < n; ++i) flat(i) = i;
+    Tensor slice = t.Slice(0, n);
+    EXPECT_TRUE(slice.SharesBufferWith(t));
+    for (int64 i = 0; i < n; ++i) EXPECT_EQ(slice.flat<float>()(i), i);
+    Tensor copy(DT_FLOAT, TensorShape({n}));
+    EXPECT_TRUE(copy.CopyFrom(t, t.shape()));
+    copy.flat<float>()(0) = -1;
+    EXPECT_EQ(flat(0), 0);
+    EXPECT_EQ(t.TotalBytes(), n * sizeof(float));
+  }
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
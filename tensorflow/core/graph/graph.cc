@@ -428,13 +428,20 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
     return nullptr;
   }
 
-  Node::NodeClass node_class = op_reg_data->is_function_op
+  return AddNode(std::move(node_def), *op_reg_data, std::move(inputs),
+                 std::move(outputs));
+}
+
+Node* Graph::AddNode(NodeDef node_def, const OpRegistrationData& op_reg_data,
+                     DataTypeVector inputs, DataTypeVector outputs) {
+  Node::NodeClass node_class = op_reg_data.is_function_op
                                    ? Node::NC_FUNCTION_OP
                                    : Node::GetNodeClassForOp(node_def.op());
 
   Node* node = AllocateNode(
-      std::make_shared<NodeProperties>(&op_reg_data->op_def,
-                                       std::move(node_def), inputs, outputs),
+      std::make_shared<NodeProperties>(&op_reg_data.op_def,
+                                       std::move(node_def), std::move(inputs),
+                                       std::move(outputs)),
       nullptr, node_class);
   return node;
 }
@@ -458,6 +465,56 @@ Node* Graph::CopyNode(const Node* node) {
   return copy;
 }
 
+void Graph::Copy(const Graph& src) {
+  for (Node* n : nodes()) {
+    CHECK(n->IsSource() || n->IsSink()) << "*this must be empty";
+  }
+
+  // Copy GraphDef versions
+  set_versions(src.versions());
+
+  // The OpDefs of `src` mapped to the ones of this graph, which differ for
+  // the functions that this graph owns.
+  absl::flat_hash_map<const OpDef*, const OpDef*> op_defs;
+  // Indices within src.device_names_ mapped to indices within device_names_.
+  std::vector<int> device_name_indices(src.device_names_.size(), -1);
+  device_name_indices[0] = 0;
+
+  // Copy the nodes. node_map[id in src] is the copy of the node in *this.
+  std::vector<Node*> node_map(src.num_node_ids(), nullptr);
+  node_map[kSourceId] = source_node();
+  node_map[kSinkId] = sink_node();
+  nodes_.reserve(nodes_.size() + src.num_op_nodes());
+  for (const Node* n : src.op_nodes()) {
+    Node* copy = AllocateNode(n->props_, n, n->class_);
+    int& device_name_index =
+        device_name_indices[n->assigned_device_name_index()];
+    if (device_name_index < 0) {
+      device_name_index = InternDeviceName(n->assigned_device_name());
+    }
+    copy->assigned_device_name_index_ = device_name_index;
+
+    auto op_def = op_defs.find(n->props_->op_def);
+    if (op_def == op_defs.end()) {
+      const OpDef* copy_op_def;
+      TF_CHECK_OK(ops_.LookUpOpDef(n->type_string(), &copy_op_def));
+      op_def = op_defs.emplace(n->props_->op_def, copy_op_def).first;
+    }
+    if (op_def->second != n->props_->op_def) {
+      copy->MaybeCopyOnWrite();
+      copy->props_->op_def = op_def->second;
+    }
+    node_map[n->id()] = copy;
+  }
+
+  // Copy the edges
+  edges_.reserve(edges_.size() + src.num_edges());
+  for (const Edge* e : src.edges()) {
+    AddEdge(node_map[e->src()->id()], e->src_output(), node_map[e->dst()->id()],
+            e->dst_input());
+  }
+}
+
 void Graph::RemoveNode(Node* node) {
   TF_DCHECK_OK(IsValidNode(node)) << node->DebugString();
   DCHECK(!node->IsSource());
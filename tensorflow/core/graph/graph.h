@@ -505,11 +505,22 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(NodeDef node_def, Status* status);
 
+  // Like AddNode() above, for a node whose Op `op_reg_data`, looked up in
+  // op_registry(), and input/output types were inferred by the caller.
+  Node* AddNode(NodeDef node_def, const OpRegistrationData& op_reg_data,
+                DataTypeVector inputs, DataTypeVector outputs);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
   Node* CopyNode(const Node* node);
 
+  // Copies the nodes and edges of `src` into *this, which must be empty.
+  // The copied nodes share their NodeProperties with the nodes of `src` until
+  // either is modified, and the ops and assigned devices are looked up once
+  // per distinct value rather than once per node.
+  void Copy(const Graph& src);
+
   // Removes a node from this graph, including all edges from or to it.
   // *node should not be accessed after calling this function.
   // REQUIRES: node->IsOp()
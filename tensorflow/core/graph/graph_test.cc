@@ -591,6 +591,44 @@ TEST_F(GraphTest, InputEdges) {
   TF_EXPECT_OK(b->input_edges(&edges));
 }
 
+TEST_F(GraphTest, Copy) {
+  Node* a = FromNodeDef("A", "OneOutput", 0);
+  Node* b = FromNodeDef("B", "TwoInputsOneOutput", 2);
+  Node* c = FromNodeDef("C", "OneInput", 1);
+  graph_.AddEdge(a, 0, b, 0);
+  graph_.AddEdge(a, 0, b, 1);
+  graph_.AddEdge(b, 0, c, 0);
+  graph_.AddControlEdge(a, c);
+  a->set_assigned_device_name("/job:a/replica:0/task:0/device:CPU:0");
+  c->set_assigned_device_name("/job:a/replica:0/task:0/device:CPU:0");
+  b->set_assigned_device_name("/job:a/replica:0/task:0/device:CPU:1");
+
+  Graph copy(OpRegistry::Global());
+  copy.Copy(graph_);
+  EXPECT_EQ(graph_.num_nodes(), copy.num_nodes());
+  EXPECT_EQ(graph_.num_edges(), copy.num_edges());
+  GraphDef expected;
+  graph_.ToGraphDef(&expected);
+  GraphDef actual;
+  copy.ToGraphDef(&actual);
+  EXPECT_EQ(expected.DebugString(), actual.DebugString());
+
+  for (Node* n : copy.op_nodes()) {
+    Node* original = FindNode(n->name());
+    // The copy shares the properties until one of them is modified.
+    EXPECT_EQ(original->properties(), n->properties());
+    EXPECT_EQ(original->assigned_device_name(), n->assigned_device_name());
+  }
+  Node* copy_a = nullptr;
+  for (Node* n : copy.op_nodes()) {
+    if (n->name() == "A") copy_a = n;
+  }
+  ASSERT_NE(copy_a, nullptr);
+  copy_a->AddAttr("foo", "bar");
+  EXPECT_NE(a->properties(), copy_a->properties());
+  EXPECT_EQ(nullptr, a->attrs().Find("foo"));
+}
+
 TEST_F(GraphTest, AddFunctionLibrary) {
   // Basic functionality
   FunctionDefLibrary proto;
@@ -742,6 +780,7 @@ BENCHMARK(BM_GraphCreation)->ArgPair(1 << 6, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 9, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 12, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 15, 16);
+BENCHMARK(BM_GraphCreation)->ArgPair(1 << 20, 2);
 
 static void BM_ToGraphDef(int iters, int num_nodes, int num_edges_per_node) {
   testing::StopTiming();
@@ -783,6 +822,29 @@ BENCHMARK(BM_ToGraphDef)->ArgPair(1 << 9, 16);
 BENCHMARK(BM_ToGraphDef)->ArgPair(1 << 12, 16);
 BENCHMARK(BM_ToGraphDef)->ArgPair(1 << 15, 16);
 
+static void BM_CopyGraph(int iters, int num_nodes, int num_edges_per_node) {
+  testing::StopTiming();
+  const GraphDef graph_def =
+      test::CreateGraphDef(num_nodes, num_edges_per_node);
+  const auto registry = OpRegistry::Global();
+  GraphConstructorOptions opts;
+  Graph graph(registry);
+  TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &graph));
+  int64 sum = 0;
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Graph copy(registry);
+    copy.Copy(graph);
+    sum += copy.num_node_ids();
+  }
+  VLOG(1) << sum;
+  testing::StopTiming();
+}
+BENCHMARK(BM_CopyGraph)->ArgPair(1 << 9, 4);
+BENCHMARK(BM_CopyGraph)->ArgPair(1 << 12, 4);
+BENCHMARK(BM_CopyGraph)->ArgPair(1 << 15, 4);
+BENCHMARK(BM_CopyGraph)->ArgPair(1 << 15, 16);
+
 static void BM_RemoveNode(int iters, int num_nodes, int num_edges_per_node) {
   testing::StopTiming();
   const GraphDef graph_def =
@@ -286,6 +286,8 @@ void GraphMemory::InferFromTrace(const StepStats& timeline) {
     for (const auto& live : live_at_peak) {
       peak_mem_usage.live_tensors.push_back(*live);
     }
+    live_tensors_[live_per_device.first].assign(live_per_device.second.begin(),
+                                                live_per_device.second.end());
   }
 }
 
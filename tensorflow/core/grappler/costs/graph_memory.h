@@ -60,6 +60,16 @@ class GraphMemory {
     return it->second;
   }
 
+  // Returns all the tensors allocated on the specified device during the step,
+  // along with their lifetimes.
+  const std::vector<LiveTensor>& GetLiveTensors(const string& device) const {
+    auto it = live_tensors_.find(device);
+    if (it == live_tensors_.end()) {
+      return unknown_usage_.live_tensors;
+    }
+    return it->second;
+  }
+
  private:
   void InferMemUsageForNodes(const std::vector<const NodeDef*>& nodes,
                              GraphProperties* properties, int64* worst_case,
@@ -72,6 +82,7 @@ class GraphMemory {
   const GrapplerItem& item_;
   std::unordered_map<string, int64> worst_case_memory_usage_;
   std::unordered_map<string, MemoryUsage> peak_usage_;
+  std::unordered_map<string, std::vector<LiveTensor>> live_tensors_;
   const MemoryUsage unknown_usage_;
 };
 
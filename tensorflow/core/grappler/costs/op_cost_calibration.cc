@@ -0,0 +1,146 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+// Name of the op the profiler adds to account for the time the device is idle
+// (see kIdle in core/profiler/utils/op_metrics_db_utils.h).
+constexpr char kIdleOp[] = "IDLE";
+}  // namespace
+
+void OpCostCalibrationFitter::AddOpMetricsDb(const profiler::OpMetricsDb& db,
+                                             const string& device_type,
+                                             const DeviceInfo& device_info) {
+  for (const profiler::OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.occurrences() == 0 || metrics.category().empty() ||
+        metrics.name() == kIdleOp) {
+      continue;
+    }
+    const double count = metrics.occurrences();
+    const uint64 time_ps =
+        metrics.self_time_ps() > 0 ? metrics.self_time_ps() : metrics.time_ps();
+    // Giga-ops per second and GB per second are ops and bytes per nanosecond.
+    const double x = metrics.flops() / count / device_info.gigaops +
+                     metrics.bytes_accessed() / count / device_info.gb_per_sec;
+    const double y = time_ps / count / 1e3;
+    Samples& samples = samples_[{device_type, metrics.category()}];
+    samples.count += count;
+    samples.sum_x += count * x;
+    samples.sum_y += count * y;
+    samples.sum_xx += count * x * x;
+    samples.sum_xy += count * x * y;
+  }
+}
+
+OpCostCorrectionList OpCostCalibrationFitter::Fit() const {
+  OpCostCorrectionList corrections;
+  for (const auto& entry : samples_) {
+    const Samples& s = entry.second;
+    double scale = 0;
+    double overhead = 0;
+    bool fitted = false;
+    const double denominator = s.count * s.sum_xx - s.sum_x * s.sum_x;
+    if (denominator > 1e-9 * s.count * s.sum_xx) {
+      scale = (s.count * s.sum_xy - s.sum_x * s.sum_y) / denominator;
+      overhead = (s.sum_y - scale * s.sum_x) / s.count;
+      // A negative scale or overhead makes no physical sense.
+      fitted = scale > 0 && overhead >= 0;
+    }
+    if (!fitted && s.sum_xx > 0) {
+      // The roofline times don't vary enough to fit an overhead.
+      scale = s.sum_xy / s.sum_xx;
+      overhead = 0;
+    } else if (!fitted) {
+      // The profile doesn't count the flops and bytes of the op: predict its
+      // mean measured time.
+      scale = 0;
+      overhead = s.sum_y / s.count;
+    }
+    OpCostCorrection* correction = corrections.add_correction();
+    correction->set_device_type(entry.first.first);
+    correction->set_op(entry.first.second);
+    correction->set_scale(scale);
+    correction->set_overhead(overhead);
+    correction->set_num_samples(s.count);
+  }
+  return corrections;
+}
+
+OpCostCalibration::OpCostCalibration(const OpCostCorrectionList& corrections) {
+  for (const OpCostCorrection& correction : corrections.correction()) {
+    corrections_[{correction.device_type(), correction.op()}] = correction;
+  }
+}
+
+/* static */
+Status OpCostCalibration::Load(
+    Env* env, const string& filename,
+    std::unique_ptr<OpCostCalibration>* calibration) {
+  OpCostCorrectionList corrections;
+  Status s = ReadBinaryProto(env, filename, &corrections);
+  if (!s.ok()) {
+    corrections.Clear();
+    Status text_status = ReadTextProto(env, filename, &corrections);
+    if (!text_status.ok()) return s;
+  }
+  calibration->reset(new OpCostCalibration(corrections));
+  return Status::OK();
+}
+
+/* static */
+const OpCostCalibration* OpCostCalibration::Global() {
+  static const OpCostCalibration* calibration = []() -> OpCostCalibration* {
+    string filename;
+    Status s = ReadStringFromEnvVar("TF_GRAPPLER_COST_CALIBRATION", "",
+                                    &filename);
+    if (s.ok() && filename.empty()) return nullptr;
+    std::unique_ptr<OpCostCalibration> loaded;
+    if (s.ok()) s = Load(Env::Default(), filename, &loaded);
+    if (!s.ok()) {
+      LOG(WARNING) << "Not using a cost calibration: " << s;
+      return nullptr;
+    }
+    VLOG(1) << "Loaded " << loaded->corrections_.size()
+            << " op cost corrections from " << filename;
+    return loaded.release();
+  }();
+  return calibration;
+}
+
+bool OpCostCalibration::Calibrate(const string& op, const string& device_type,
+                                  Costs* costs) const {
+  auto it = corrections_.find({device_type, op});
+  if (it == corrections_.end()) return false;
+  const double scale = it->second.scale();
+  const double overhead = it->second.overhead();
+  // The overhead doesn't depend on the amount of data the op accesses, so it
+  // is accounted as compute time.
+  costs->compute_time =
+      Costs::Duration(scale * costs->compute_time.count() + overhead);
+  costs->memory_time = Costs::Duration(scale * costs->memory_time.count());
+  costs->execution_time =
+      Costs::Duration(scale * costs->execution_time.count() + overhead);
+  return true;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
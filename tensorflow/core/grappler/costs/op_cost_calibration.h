@@ -0,0 +1,98 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fits a correction of the roofline time of each op type from the op metrics
+// of real executions, as collected by the profiler (see
+// core/profiler/convert/xplane_to_op_metrics_db.h).
+//
+// The roofline time of an op is the time it takes to run its flops at the
+// peak compute rate of the device plus the time it takes to access its bytes
+// at the peak bandwidth of the device, as OpLevelCostEstimator predicts it.
+// The correction is the linear function that best maps the roofline times of
+// the executions of the op onto their measured times, in the least squares
+// sense.
+class OpCostCalibrationFitter {
+ public:
+  // Adds the ops of `db`, which was collected on a device of type
+  // `device_type` (e.g. "CPU" or "GPU") with the peak performance
+  // `device_info`.
+  void AddOpMetricsDb(const profiler::OpMetricsDb& db,
+                      const string& device_type, const DeviceInfo& device_info);
+
+  // Returns the correction of every op type added so far, sorted by device
+  // type and op.
+  OpCostCorrectionList Fit() const;
+
+ private:
+  // Sums of the weighted least squares fit of measured time over roofline
+  // time, both in nanoseconds.
+  struct Samples {
+    double count = 0;
+    double sum_x = 0;
+    double sum_y = 0;
+    double sum_xx = 0;
+    double sum_xy = 0;
+  };
+  // Samples by device type and op.
+  std::map<std::pair<string, string>, Samples> samples_;
+};
+
+// Applies the corrections fitted by OpCostCalibrationFitter to the costs
+// predicted by OpLevelCostEstimator.
+class OpCostCalibration {
+ public:
+  explicit OpCostCalibration(const OpCostCorrectionList& corrections);
+
+  // Reads the corrections from `filename`, which holds an
+  // `OpCostCorrectionList` in binary or text format.
+  static Status Load(Env* env, const string& filename,
+                     std::unique_ptr<OpCostCalibration>* calibration);
+
+  // Returns the calibration in the file named by the
+  // TF_GRAPPLER_COST_CALIBRATION environment variable, or nullptr if it is
+  // not set or cannot be read.
+  static const OpCostCalibration* Global();
+
+  // Corrects the predicted `costs` of `op` running on a device of type
+  // `device_type`. Returns false, and leaves `costs` untouched, if there is no
+  // correction for the op.
+  bool Calibrate(const string& op, const string& device_type,
+                 Costs* costs) const;
+
+ private:
+  // Corrections by device type and op.
+  std::map<std::pair<string, string>, OpCostCorrection> corrections_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
@@ -0,0 +1,152 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Adds `occurrences` executions of an op that took `time_ns` each.
+void AddOp(const string& name, const string& type, uint32 occurrences,
+           uint64 flops, uint64 bytes_accessed, uint64 time_ns,
+           profiler::OpMetricsDb* db) {
+  profiler::OpMetrics* metrics = db->add_metrics_db();
+  metrics->set_name(name);
+  metrics->set_category(type);
+  metrics->set_occurrences(occurrences);
+  metrics->set_flops(occurrences * flops);
+  metrics->set_bytes_accessed(occurrences * bytes_accessed);
+  metrics->set_time_ps(occurrences * time_ns * 1000);
+  metrics->set_self_time_ps(occurrences * time_ns * 1000);
+}
+
+const OpCostCorrection* FindCorrection(const OpCostCorrectionList& list,
+                                       const string& op) {
+  for (const auto& correction : list.correction()) {
+    if (correction.op() == op) return &correction;
+  }
+  return nullptr;
+}
+
+TEST(OpCostCalibrationFitterTest, Fit) {
+  profiler::OpMetricsDb db;
+  // MatMul takes 3 times its roofline time plus 500ns.
+  AddOp("a", "MatMul", 2, 1000, 500, 4250, &db);
+  AddOp("b", "MatMul", 1, 3000, 1000, 11000, &db);
+  // A single execution only fits a scaling.
+  AddOp("c", "Relu", 1, 100, 400, 1000, &db);
+  // The flops and bytes of host ops are usually not known.
+  AddOp("d", "Enqueue", 4, 0, 0, 300, &db);
+  AddOp("IDLE", "IDLE", 1, 0, 0, 100000, &db);
+  AddOp("e", "Unknown", 0, 0, 0, 0, &db);
+
+  OpCostCalibrationFitter fitter;
+  DeviceInfo device_info(/*gigaops=*/1, /*gb_per_sec=*/2);
+  fitter.AddOpMetricsDb(db, "GPU", device_info);
+  const OpCostCorrectionList corrections = fitter.Fit();
+  ASSERT_EQ(3, corrections.correction_size());
+
+  const OpCostCorrection* matmul = FindCorrection(corrections, "MatMul");
+  ASSERT_NE(nullptr, matmul);
+  EXPECT_EQ("GPU", matmul->device_type());
+  EXPECT_NEAR(3, matmul->scale(), 1e-6);
+  EXPECT_NEAR(500, matmul->overhead(), 1e-3);
+  EXPECT_EQ(3, matmul->num_samples());
+
+  const OpCostCorrection* relu = FindCorrection(corrections, "Relu");
+  ASSERT_NE(nullptr, relu);
+  EXPECT_NEAR(1000.0 / 300, relu->scale(), 1e-6);
+  EXPECT_EQ(0, relu->overhead());
+
+  const OpCostCorrection* enqueue = FindCorrection(corrections, "Enqueue");
+  ASSERT_NE(nullptr, enqueue);
+  EXPECT_EQ(0, enqueue->scale());
+  EXPECT_NEAR(300, enqueue->overhead(), 1e-6);
+}
+
+TEST(OpCostCalibrationTest, CalibratesEstimator) {
+  OpCostCorrectionList corrections;
+  OpCostCorrection* correction = corrections.add_correction();
+  correction->set_op("MatMul");
+  correction->set_device_type("CPU");
+  correction->set_scale(3);
+  correction->set_overhead(500);
+  OpCostCalibration calibration(corrections);
+
+  OpContext op_context;
+  op_context.op_info.set_op("MatMul");
+  DeviceProperties* device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(10);
+  device->set_frequency(1000);
+  device->set_bandwidth(10000000);
+  for (int i = 0; i < 2; ++i) {
+    OpInfo::TensorProperties* input = op_context.op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(100);
+    input->mutable_shape()->add_dim()->set_size(100);
+  }
+
+  OpLevelCostEstimator estimator;
+  estimator.set_calibration(nullptr);
+  const Costs uncalibrated = estimator.PredictCosts(op_context);
+  estimator.set_calibration(&calibration);
+  const Costs calibrated = estimator.PredictCosts(op_context);
+  EXPECT_EQ(3 * uncalibrated.execution_time.count() + 500,
+            calibrated.execution_time.count());
+  EXPECT_EQ(3 * uncalibrated.memory_time.count(),
+            calibrated.memory_time.count());
+
+  // There is no correction for other device types.
+  device->set_type("GPU");
+  const Costs gpu = estimator.PredictCosts(op_context);
+  estimator.set_calibration(nullptr);
+  EXPECT_EQ(estimator.PredictCosts(op_context).execution_time,
+            gpu.execution_time);
+}
+
+TEST(OpCostCalibrationTest, Load) {
+  OpCostCorrectionList corrections;
+  OpCostCorrection* correction = corrections.add_correction();
+  correction->set_op("Relu");
+  correction->set_device_type("GPU");
+  correction->set_scale(2);
+  const string filename = io::JoinPath(testing::TmpDir(), "calibration.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), filename, corrections));
+
+  std::unique_ptr<OpCostCalibration> calibration;
+  TF_ASSERT_OK(OpCostCalibration::Load(Env::Default(), filename, &calibration));
+  Costs costs = Costs::ZeroCosts();
+  costs.execution_time = Costs::Duration(10);
+  EXPECT_TRUE(calibration->Calibrate("Relu", "GPU", &costs));
+  EXPECT_EQ(20, costs.execution_time.count());
+  EXPECT_FALSE(calibration->Calibrate("Relu", "CPU", &costs));
+  EXPECT_EQ(20, costs.execution_time.count());
+
+  EXPECT_FALSE(OpCostCalibration::Load(
+                   Env::Default(), io::JoinPath(testing::TmpDir(), "missing"),
+                   &calibration)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -636,9 +636,22 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+  calibration_ = OpCostCalibration::Global();
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
+  Costs costs = PredictUncalibratedCosts(op_context);
+  const auto& op_info = op_context.op_info;
+  if (calibration_ != nullptr && !costs.inaccurate &&
+      calibration_->Calibrate(op_info.op(), op_info.device().type(), &costs)) {
+    VLOG(1) << "Operation " << op_info.op() << " takes "
+            << costs.execution_time.count() << " ns after calibration.";
+  }
+  return costs;
+}
+
+Costs OpLevelCostEstimator::PredictUncalibratedCosts(
+    const OpContext& op_context) const {
   const auto& op_info = op_context.op_info;
   auto it = device_cost_impl_.find(op_info.op());
   if (it != device_cost_impl_.end()) {
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/util/padding.h"
 
@@ -39,6 +40,13 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Sets the corrections fitted from real profiles that are applied to the
+  // predicted costs. Defaults to OpCostCalibration::Global(); nullptr disables
+  // the calibration.
+  void set_calibration(const OpCostCalibration* calibration) {
+    calibration_ = calibration;
+  }
+
  protected:
   // Predict cost of an op for which no accurate estimator is defined.
   Costs PredictCostOfAnUnknownOp(const OpContext& op_context) const;
@@ -210,8 +218,13 @@ class OpLevelCostEstimator {
   // compute_time and memory_time, instead of sum of those two.
   bool compute_memory_overlap_;
   std::set<string> persistent_ops_;
+  // Not owned; nullptr if the predicted costs are not calibrated.
+  const OpCostCalibration* calibration_;
 
  private:
+  // Predicts the costs of the op from the roofline model only.
+  Costs PredictUncalibratedCosts(const OpContext& op_context) const;
+
   friend class OpLevelCostEstimatorTest;
 };
 
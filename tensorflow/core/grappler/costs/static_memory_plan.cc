@@ -0,0 +1,99 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/static_memory_plan.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+StaticMemoryPlan PlanStaticMemory(
+    const std::vector<GraphMemory::LiveTensor>& tensors, int64 alignment) {
+  if (alignment <= 0) {
+    alignment = 1;
+  }
+  std::vector<const GraphMemory::LiveTensor*> order;
+  for (const auto& tensor : tensors) {
+    if (tensor.memory_used > 0) {
+      order.push_back(&tensor);
+    }
+  }
+  // Placing the largest tensors first keeps the fragmentation low. Ties are
+  // broken by allocation time to keep the plan deterministic.
+  std::stable_sort(order.begin(), order.end(),
+                   [](const GraphMemory::LiveTensor* a,
+                      const GraphMemory::LiveTensor* b) {
+                     if (a->memory_used != b->memory_used) {
+                       return a->memory_used > b->memory_used;
+                     }
+                     return a->allocation_time < b->allocation_time;
+                   });
+
+  StaticMemoryPlan plan;
+  std::vector<const GraphMemory::LiveTensor*> placed;
+  std::vector<const StaticMemoryPlan::Allocation*> overlapping;
+  plan.allocations.reserve(order.size());
+  for (const GraphMemory::LiveTensor* tensor : order) {
+    // Collect the placed tensors that are live at the same time as this one,
+    // by increasing offset.
+    overlapping.clear();
+    for (int i = 0; i < placed.size(); ++i) {
+      if (placed[i]->allocation_time < tensor->deallocation_time &&
+          tensor->allocation_time < placed[i]->deallocation_time) {
+        overlapping.push_back(&plan.allocations[i]);
+      }
+    }
+    std::sort(overlapping.begin(), overlapping.end(),
+              [](const StaticMemoryPlan::Allocation* a,
+                 const StaticMemoryPlan::Allocation* b) {
+                return a->offset < b->offset;
+              });
+
+    // Use the first gap large enough to hold the tensor.
+    const int64 size = tensor->memory_used;
+    int64 offset = 0;
+    for (const StaticMemoryPlan::Allocation* allocation : overlapping) {
+      if (offset + size <= allocation->offset) {
+        break;
+      }
+      offset = std::max(offset, allocation->offset + allocation->size);
+      offset = (offset + alignment - 1) / alignment * alignment;
+    }
+
+    plan.allocations.push_back({tensor->node, tensor->output_id, offset, size});
+    placed.push_back(tensor);
+    plan.arena_size = std::max(plan.arena_size, offset + size);
+  }
+  return plan;
+}
+
+Status PlanStaticMemory(
+    const GrapplerItem& item,
+    const std::unordered_map<string, DeviceProperties>& devices,
+    const string& device, int64 alignment, StaticMemoryPlan* plan) {
+  if (devices.find(device) == devices.end()) {
+    return errors::InvalidArgument("Unknown device ", device);
+  }
+  GraphMemory memory(item);
+  TF_RETURN_IF_ERROR(memory.InferStatically(devices));
+  *plan = PlanStaticMemory(memory.GetLiveTensors(device), alignment);
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
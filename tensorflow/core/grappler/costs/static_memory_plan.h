@@ -0,0 +1,62 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_STATIC_MEMORY_PLAN_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/grappler/costs/graph_memory.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// The placement of the tensors produced by a step in a single preallocated
+// buffer (the arena), such that tensors that are live at the same time never
+// share memory.
+struct StaticMemoryPlan {
+  struct Allocation {
+    string node;
+    int output_id;
+    int64 offset;
+    int64 size;
+  };
+  // The size of the arena in bytes.
+  int64 arena_size = 0;
+  std::vector<Allocation> allocations;
+};
+
+// Assigns an offset aligned to `alignment` bytes to each tensor of `tensors`.
+// Tensors are placed from the largest to the smallest, each at the lowest
+// offset that doesn't overlap a tensor already placed whose lifetime overlaps
+// its own. Tensors that use no memory are not part of the plan.
+StaticMemoryPlan PlanStaticMemory(
+    const std::vector<GraphMemory::LiveTensor>& tensors, int64 alignment);
+
+// Plans the memory of the tensors allocated on `device` by one step of `item`,
+// with the tensor lifetimes inferred by simulating the step on `devices`.
+Status PlanStaticMemory(
+    const GrapplerItem& item,
+    const std::unordered_map<string, DeviceProperties>& devices,
+    const string& device, int64 alignment, StaticMemoryPlan* plan);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_STATIC_MEMORY_PLAN_H_
@@ -0,0 +1,121 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/static_memory_plan.h"
+
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GraphMemory::LiveTensor Tensor(const string& node, size_t size,
+                               int64 allocation_time, int64 deallocation_time) {
+  GraphMemory::LiveTensor tensor;
+  tensor.node = node;
+  tensor.output_id = 0;
+  tensor.memory_used = size;
+  tensor.allocation_time = Costs::Duration(allocation_time);
+  tensor.deallocation_time = Costs::Duration(deallocation_time);
+  return tensor;
+}
+
+// Checks that no two tensors live at the same time share memory.
+void ExpectValidPlan(const std::vector<GraphMemory::LiveTensor>& tensors,
+                     const StaticMemoryPlan& plan) {
+  std::unordered_map<string, const GraphMemory::LiveTensor*> by_name;
+  for (const auto& tensor : tensors) by_name[tensor.node] = &tensor;
+  for (const auto& a : plan.allocations) {
+    EXPECT_LE(a.offset + a.size, plan.arena_size);
+    for (const auto& b : plan.allocations) {
+      if (a.node == b.node) continue;
+      const GraphMemory::LiveTensor* ta = by_name[a.node];
+      const GraphMemory::LiveTensor* tb = by_name[b.node];
+      const bool live_together = ta->allocation_time < tb->deallocation_time &&
+                                 tb->allocation_time < ta->deallocation_time;
+      const bool share_memory =
+          a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+      EXPECT_FALSE(live_together && share_memory) << a.node << " " << b.node;
+    }
+  }
+}
+
+TEST(StaticMemoryPlanTest, ReusesMemoryOfDeadTensors) {
+  // a and b are live together, c reuses the memory of a once it is dead.
+  const std::vector<GraphMemory::LiveTensor> tensors = {
+      Tensor("a", 100, 0, 10), Tensor("b", 50, 5, 20), Tensor("c", 100, 10, 30),
+      Tensor("empty", 0, 0, 30)};
+  const StaticMemoryPlan plan = PlanStaticMemory(tensors, 1);
+  EXPECT_EQ(150, plan.arena_size);
+  EXPECT_EQ(3, plan.allocations.size());
+  ExpectValidPlan(tensors, plan);
+}
+
+TEST(StaticMemoryPlanTest, AlignsOffsets) {
+  const std::vector<GraphMemory::LiveTensor> tensors = {
+      Tensor("a", 100, 0, 10), Tensor("b", 10, 0, 10), Tensor("c", 10, 0, 10)};
+  const StaticMemoryPlan plan = PlanStaticMemory(tensors, 64);
+  for (const auto& allocation : plan.allocations) {
+    EXPECT_EQ(0, allocation.offset % 64);
+  }
+  EXPECT_EQ(192 + 10, plan.arena_size);
+  ExpectValidPlan(tensors, plan);
+}
+
+TEST(StaticMemoryPlanTest, FillsGaps) {
+  // b is placed above a, and c fits below b once a is dead.
+  const std::vector<GraphMemory::LiveTensor> tensors = {
+      Tensor("a", 100, 0, 10), Tensor("b", 80, 0, 30), Tensor("c", 60, 10, 30)};
+  const StaticMemoryPlan plan = PlanStaticMemory(tensors, 1);
+  EXPECT_EQ(180, plan.arena_size);
+  ExpectValidPlan(tensors, plan);
+}
+
+TEST(StaticMemoryPlanTest, PlansGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"/CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  item.feed.clear();
+
+  std::unordered_map<string, DeviceProperties> devices;
+  devices["/CPU:0"].set_type("CPU");
+  devices["/CPU:0"].set_num_cores(1);
+  devices["/CPU:0"].set_frequency(1);
+  devices["/CPU:0"].set_bandwidth(1);
+
+  StaticMemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(item, devices, "/CPU:0", 1, &plan));
+  EXPECT_FALSE(plan.allocations.empty());
+
+  // The arena can't be smaller than the peak memory usage, and reusing the
+  // memory of dead tensors makes it smaller than keeping every tensor.
+  GraphMemory memory(item);
+  TF_ASSERT_OK(memory.InferStatically(devices));
+  EXPECT_GE(plan.arena_size, memory.GetPeakMemoryUsage("/CPU:0").used_memory);
+  int64 total_size = 0;
+  for (const auto& allocation : plan.allocations) {
+    total_size += allocation.size;
+  }
+  EXPECT_LT(plan.arena_size, total_size);
+  ExpectValidPlan(memory.GetLiveTensors("/CPU:0"), plan);
+
+  EXPECT_FALSE(PlanStaticMemory(item, devices, "/GPU:0", 1, &plan).ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,289 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/elementwise_fusion.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Bounds the intermediate results the fused kernel keeps per tile.
+constexpr int kMaxFusedOps = 32;
+
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+
+// The ops supported by the _FusedElementwise kernel.
+bool IsFusableUnaryOp(const string& op) {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "Abs",   "Exp",     "Log",  "Neg",    "Reciprocal", "Relu",
+      "Rsqrt", "Sigmoid", "Sqrt", "Square", "Tanh"};
+  return ops->contains(op);
+}
+
+bool IsFusableBinaryOp(const string& op) {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "Add",     "AddV2", "Div", "Maximum",          "Minimum",
+      "Mul",     "RealDiv", "SquaredDifference", "Sub"};
+  return ops->contains(op);
+}
+
+bool IsSupportedType(DataType dtype) {
+  return dtype == DT_FLOAT || dtype == DT_HALF || dtype == DT_DOUBLE;
+}
+
+// Returns the ops `node` runs in a fused chain, or an empty list if it can't
+// be fused. The unary chains already composed by the arithmetic optimizer are
+// expanded back into their ops.
+std::vector<string> FusableOps(const NodeDef& node) {
+  if (node.op() == "_UnaryOpsComposition") {
+    std::vector<string> ops;
+    for (const string& op : node.attr().at("op_names").list().s()) {
+      if (!IsFusableUnaryOp(op)) return {};
+      ops.push_back(op);
+    }
+    return ops;
+  }
+  if (IsFusableUnaryOp(node.op()) || IsFusableBinaryOp(node.op())) {
+    return {node.op()};
+  }
+  return {};
+}
+
+// Returns true if `node` can be part of a fused chain. `allow_unplaced` is
+// true when the nodes without a device will run on the CPU.
+bool IsFusable(const NodeDef& node, const GraphProperties& properties,
+               bool allow_unplaced) {
+  if (FusableOps(node).empty()) return false;
+  if (!NodeIsOnCpu(&node) && !(node.device().empty() && allow_unplaced)) {
+    return false;
+  }
+  for (const auto& attr : node.attr()) {
+    // Internal attributes, e.g. colocation constraints, don't carry over to
+    // the fused op.
+    if (absl::StartsWith(attr.first, "_")) return false;
+  }
+  auto it = node.attr().find("T");
+  if (it == node.attr().end() || !IsSupportedType(it->second.type())) {
+    return false;
+  }
+  const int num_inputs = IsFusableBinaryOp(node.op()) ? 2 : 1;
+  if (NumNonControlInputs(node) != num_inputs ||
+      !properties.HasInputProperties(node.name()) ||
+      !properties.HasOutputProperties(node.name())) {
+    return false;
+  }
+  const auto& outputs = properties.GetOutputProperties(node.name());
+  if (outputs.size() != 1) return false;
+  const PartialTensorShape shape(outputs[0].shape());
+  if (!shape.IsFullyDefined()) return false;
+  for (const auto& input : properties.GetInputProperties(node.name())) {
+    const PartialTensorShape input_shape(input.shape());
+    if (!input_shape.IsIdenticalTo(shape) && input_shape.dims() != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+Status ElementwiseFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+  // The fused op only has a CPU kernel: don't move unplaced nodes off a GPU.
+  bool allow_unplaced = true;
+  if (cluster != nullptr) {
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "GPU") allow_unplaced = false;
+    }
+  }
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+  absl::flat_hash_map<string, const NodeDef*> nodes;
+  absl::flat_hash_map<string, int> positions;
+  absl::flat_hash_map<string, std::vector<string>> consumers;
+  absl::flat_hash_set<string> fusable;
+  for (int i = 0; i < topo_order.size(); ++i) {
+    const NodeDef* node = topo_order[i];
+    nodes[node->name()] = node;
+    positions[node->name()] = i;
+    for (const string& input : node->input()) {
+      consumers[NodeName(input)].push_back(node->name());
+    }
+    if (IsFusable(*node, properties, allow_unplaced)) {
+      fusable.insert(node->name());
+    }
+  }
+  const std::set<string> nodes_to_preserve = item.NodesToPreserve();
+  absl::flat_hash_map<string, int> indices;
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    indices[item.graph.node(i).name()] = i;
+  }
+
+  *optimized_graph = item.graph;
+  std::set<string> nodes_to_delete;
+  absl::flat_hash_set<string> visited;
+  int num_fused_chains = 0;
+  // Grow the chains from their last op, so that every op is reached from its
+  // consumers before it could start a chain of its own.
+  for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+    const NodeDef& root = **it;
+    if (visited.contains(root.name()) || !fusable.contains(root.name())) {
+      continue;
+    }
+    const PartialTensorShape shape(
+        properties.GetOutputProperties(root.name())[0].shape());
+    const DataType dtype = root.attr().at("T").type();
+    absl::flat_hash_set<string> members = {root.name()};
+    int num_ops = FusableOps(root).size();
+    bool grown = true;
+    while (grown) {
+      grown = false;
+      const std::vector<string> current(members.begin(), members.end());
+      for (const string& member : current) {
+        for (const string& input : nodes[member]->input()) {
+          if (IsControlInput(input)) continue;
+          const string producer = NodeName(input);
+          if (members.contains(producer) || visited.contains(producer) ||
+              !fusable.contains(producer) ||
+              nodes_to_preserve.count(producer) > 0) {
+            continue;
+          }
+          const NodeDef& node = *nodes[producer];
+          if (node.device() != root.device() ||
+              node.attr().at("T").type() != dtype || HasControlInputs(node) ||
+              !PartialTensorShape(
+                   properties.GetOutputProperties(producer)[0].shape())
+                   .IsIdenticalTo(shape)) {
+            continue;
+          }
+          const auto& fanouts = consumers[producer];
+          if (!std::all_of(fanouts.begin(), fanouts.end(),
+                           [&members](const string& consumer) {
+                             return members.contains(consumer);
+                           })) {
+            continue;
+          }
+          const int node_ops = FusableOps(node).size();
+          if (num_ops + node_ops > kMaxFusedOps) continue;
+          members.insert(producer);
+          num_ops += node_ops;
+          grown = true;
+        }
+      }
+    }
+    visited.insert(members.begin(), members.end());
+    if (members.size() < 2) continue;
+
+    std::vector<const NodeDef*> chain;
+    for (const string& member : members) chain.push_back(nodes[member]);
+    std::sort(chain.begin(), chain.end(),
+              [&positions](const NodeDef* a, const NodeDef* b) {
+                return positions[a->name()] < positions[b->name()];
+              });
+
+    // The values of the fused op are its inputs, then the results of its ops.
+    std::vector<string> inputs;
+    absl::flat_hash_map<string, int> values;
+    for (const NodeDef* node : chain) {
+      for (const string& input : node->input()) {
+        if (IsControlInput(input) || members.contains(NodeName(input))) {
+          continue;
+        }
+        if (values.emplace(input, inputs.size()).second) {
+          inputs.push_back(input);
+        }
+      }
+    }
+    std::vector<string> op_names;
+    std::vector<int> operands;
+    for (const NodeDef* node : chain) {
+      const std::vector<string> ops = FusableOps(*node);
+      int lhs = values.at(members.contains(NodeName(node->input(0)))
+                              ? NodeName(node->input(0))
+                              : node->input(0));
+      int rhs = -1;
+      if (IsFusableBinaryOp(node->op())) {
+        rhs = values.at(members.contains(NodeName(node->input(1)))
+                            ? NodeName(node->input(1))
+                            : node->input(1));
+      }
+      for (const string& op : ops) {
+        op_names.push_back(op);
+        operands.push_back(lhs);
+        operands.push_back(rhs);
+        lhs = inputs.size() + op_names.size() - 1;
+        rhs = -1;
+      }
+      values[node->name()] = lhs;
+    }
+
+    NodeDef* fused = optimized_graph->mutable_node(indices[root.name()]);
+    std::vector<string> control_inputs;
+    for (const string& input : root.input()) {
+      if (IsControlInput(input)) control_inputs.push_back(input);
+    }
+    fused->set_op(kFusedElementwise);
+    fused->clear_input();
+    for (const string& input : inputs) fused->add_input(input);
+    for (const string& input : control_inputs) fused->add_input(input);
+    fused->clear_attr();
+    auto* attr = fused->mutable_attr();
+    (*attr)["T"].set_type(dtype);
+    (*attr)["N"].set_i(inputs.size());
+    for (const string& op : op_names) {
+      (*attr)["op_names"].mutable_list()->add_s(op);
+    }
+    for (int operand : operands) {
+      (*attr)["operands"].mutable_list()->add_i(operand);
+    }
+    for (const NodeDef* node : chain) {
+      if (node->name() != root.name()) nodes_to_delete.insert(node->name());
+    }
+    ++num_fused_chains;
+  }
+  if (num_fused_chains == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  VLOG(1) << "Fused " << num_fused_chains << " chains of elementwise ops.";
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
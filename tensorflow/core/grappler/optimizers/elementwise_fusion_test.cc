@@ -0,0 +1,100 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/elementwise_fusion.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ElementwiseFusionTest : public GrapplerTest {};
+
+TEST_F(ElementwiseFusionTest, FuseChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 16}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 16}));
+  Output one = ops::Const(s.WithOpName("one"), 1.0f, {});
+  Output mul = ops::Mul(s.WithOpName("mul"), x, y);
+  Output add = ops::AddV2(s.WithOpName("add"), mul, one);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  ops::Mul(s.WithOpName("output"), tanh, y);
+
+  GrapplerItem item;
+  item.fetch = {"output"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({8, 16}));
+  auto y_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({8, 16}));
+  item.feed = {{"x", x_t}, {"y", y_t}};
+
+  ElementwiseFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("mul", node.name());
+    EXPECT_NE("tanh", node.name());
+    if (node.name() == "output") {
+      ++found;
+      EXPECT_EQ("_FusedElementwise", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("x", node.input(0));
+      EXPECT_EQ("y", node.input(1));
+      EXPECT_EQ("one", node.input(2));
+      EXPECT_EQ(4, node.attr().at("op_names").list().s_size());
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(ElementwiseFusionTest, KeepsSharedResultsAndBroadcasts) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 16}));
+  Output b = ops::Placeholder(s.WithOpName("b"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}));
+  // The result of `shared` is fetched, and `bcast` broadcasts `b`.
+  Output shared = ops::Tanh(s.WithOpName("shared"), x);
+  Output bcast = ops::AddV2(s.WithOpName("bcast"), shared, b);
+  ops::Relu(s.WithOpName("relu"), bcast);
+
+  GrapplerItem item;
+  item.fetch = {"shared", "relu"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  ElementwiseFusion optimizer;
+  GraphDef output;
+  Status status = optimizer.Optimize(nullptr, item, &output);
+  EXPECT_TRUE(errors::IsAborted(status)) << status;
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
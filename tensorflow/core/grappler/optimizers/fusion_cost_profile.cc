@@ -0,0 +1,108 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/fusion_cost_profile.h"
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+FusionCostProfile::FusionCostProfile(const OpPerformanceList& performance) {
+  for (const OpPerformance& op_performance : performance.op_performance()) {
+    const OpInfo& op_info = op_performance.op();
+    const double time = op_performance.compute_time() > 0
+                            ? op_performance.compute_time()
+                            : op_performance.compute_cost();
+    if (time <= 0) continue;
+    const std::vector<OpInfo::TensorProperties> inputs(
+        op_info.inputs().begin(), op_info.inputs().end());
+    std::vector<string> fused_ops;
+    auto it = op_info.attr().find("fused_ops");
+    if (it != op_info.attr().end()) {
+      fused_ops.assign(it->second.list().s().begin(),
+                       it->second.list().s().end());
+    }
+    Measurement& measurement = measurements_[Key(
+        op_info.op(), op_info.device().type(), inputs, fused_ops)];
+    measurement.total_time += time;
+    ++measurement.count;
+  }
+}
+
+/* static */
+Status FusionCostProfile::Load(Env* env, const string& filename,
+                               std::unique_ptr<FusionCostProfile>* profile) {
+  OpPerformanceList performance;
+  Status s = ReadBinaryProto(env, filename, &performance);
+  if (!s.ok()) {
+    performance.Clear();
+    Status text_status = ReadTextProto(env, filename, &performance);
+    if (!text_status.ok()) return s;
+  }
+  profile->reset(new FusionCostProfile(performance));
+  return Status::OK();
+}
+
+/* static */
+const FusionCostProfile* FusionCostProfile::Global() {
+  static const FusionCostProfile* profile = []() -> FusionCostProfile* {
+    string filename;
+    Status s = ReadStringFromEnvVar("TF_REMAPPER_FUSION_PROFILE", "",
+                                    &filename);
+    if (s.ok() && filename.empty()) return nullptr;
+    std::unique_ptr<FusionCostProfile> loaded;
+    if (s.ok()) s = Load(Env::Default(), filename, &loaded);
+    if (!s.ok()) {
+      LOG(WARNING) << "Not using a fusion cost profile: " << s;
+      return nullptr;
+    }
+    VLOG(1) << "Loaded " << loaded->measurements_.size()
+            << " op measurements from " << filename;
+    return loaded.release();
+  }();
+  return profile;
+}
+
+double FusionCostProfile::ComputeTime(
+    const string& op, const string& device_type,
+    const std::vector<OpInfo::TensorProperties>& inputs,
+    const std::vector<string>& fused_ops) const {
+  auto it = measurements_.find(Key(op, device_type, inputs, fused_ops));
+  if (it == measurements_.end()) return -1;
+  return it->second.total_time / it->second.count;
+}
+
+/* static */
+string FusionCostProfile::Key(
+    const string& op, const string& device_type,
+    const std::vector<OpInfo::TensorProperties>& inputs,
+    const std::vector<string>& fused_ops) {
+  string key = strings::StrCat(op, ";", device_type, ";");
+  for (const OpInfo::TensorProperties& input : inputs) {
+    strings::StrAppend(&key, DataTypeString(input.dtype()),
+                       PartialTensorShape(input.shape()).DebugString(), ";");
+  }
+  strings::StrAppend(&key, absl::StrJoin(fused_ops, ","));
+  return key;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
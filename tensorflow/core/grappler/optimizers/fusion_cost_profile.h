@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_FUSION_COST_PROFILE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_FUSION_COST_PROFILE_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Measured compute times of ops, used by the remapper to decide whether a
+// fused kernel is actually faster than the ops it replaces.
+//
+// Ops are identified by their type, the type of their device, the types and
+// shapes of their inputs and, for fused ops, the list of fused ops.
+class FusionCostProfile {
+ public:
+  explicit FusionCostProfile(const OpPerformanceList& performance);
+
+  // Reads a profile from `filename`, which holds an `OpPerformanceList` in
+  // binary or text format.
+  static Status Load(Env* env, const string& filename,
+                     std::unique_ptr<FusionCostProfile>* profile);
+
+  // Returns the profile in the file named by the TF_REMAPPER_FUSION_PROFILE
+  // environment variable, or nullptr if it is not set or cannot be read.
+  static const FusionCostProfile* Global();
+
+  // Returns the mean measured compute time of the op in nanoseconds, or a
+  // negative value if it was not measured.
+  double ComputeTime(const string& op, const string& device_type,
+                     const std::vector<OpInfo::TensorProperties>& inputs,
+                     const std::vector<string>& fused_ops) const;
+
+ private:
+  static string Key(const string& op, const string& device_type,
+                    const std::vector<OpInfo::TensorProperties>& inputs,
+                    const std::vector<string>& fused_ops);
+
+  struct Measurement {
+    double total_time = 0;
+    int count = 0;
+  };
+  std::unordered_map<string, Measurement> measurements_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_FUSION_COST_PROFILE_H_
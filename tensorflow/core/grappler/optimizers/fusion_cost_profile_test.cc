@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/fusion_cost_profile.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpInfo::TensorProperties FloatInput(const TensorShape& shape) {
+  OpInfo::TensorProperties input;
+  input.set_dtype(DT_FLOAT);
+  shape.AsProto(input.mutable_shape());
+  return input;
+}
+
+void AddMeasurement(const string& op, const string& device_type,
+                    const std::vector<OpInfo::TensorProperties>& inputs,
+                    const std::vector<string>& fused_ops, int64 compute_time,
+                    OpPerformanceList* performance) {
+  OpPerformance* op_performance = performance->add_op_performance();
+  OpInfo* op_info = op_performance->mutable_op();
+  op_info->set_op(op);
+  op_info->mutable_device()->set_type(device_type);
+  for (const auto& input : inputs) *op_info->add_inputs() = input;
+  if (!fused_ops.empty()) {
+    auto* list = (*op_info->mutable_attr())["fused_ops"].mutable_list();
+    for (const string& fused_op : fused_ops) list->add_s(fused_op);
+  }
+  op_performance->set_compute_time(compute_time);
+}
+
+TEST(FusionCostProfileTest, ComputeTime) {
+  const std::vector<OpInfo::TensorProperties> inputs = {
+      FloatInput(TensorShape({8, 16})), FloatInput(TensorShape({16, 4}))};
+  OpPerformanceList performance;
+  AddMeasurement("MatMul", "CPU", inputs, {}, 100, &performance);
+  AddMeasurement("MatMul", "CPU", inputs, {}, 200, &performance);
+  AddMeasurement("_FusedMatMul", "CPU", inputs, {"BiasAdd"}, 120, &performance);
+  FusionCostProfile profile(performance);
+
+  EXPECT_EQ(150, profile.ComputeTime("MatMul", "CPU", inputs, {}));
+  EXPECT_EQ(120,
+            profile.ComputeTime("_FusedMatMul", "CPU", inputs, {"BiasAdd"}));
+  // Measurements differ by device type, input shapes and fused ops.
+  EXPECT_LT(profile.ComputeTime("MatMul", "GPU", inputs, {}), 0);
+  EXPECT_LT(profile.ComputeTime("MatMul", "CPU", {inputs[0]}, {}), 0);
+  EXPECT_LT(profile.ComputeTime("_FusedMatMul", "CPU", inputs,
+                                {"BiasAdd", "Relu"}),
+            0);
+}
+
+TEST(FusionCostProfileTest, Load) {
+  const std::vector<OpInfo::TensorProperties> inputs = {
+      FloatInput(TensorShape({2}))};
+  OpPerformanceList performance;
+  AddMeasurement("Relu", "GPU", inputs, {}, 7, &performance);
+
+  const string binary = io::JoinPath(testing::TmpDir(), "profile.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), binary, performance));
+  std::unique_ptr<FusionCostProfile> profile;
+  TF_ASSERT_OK(FusionCostProfile::Load(Env::Default(), binary, &profile));
+  EXPECT_EQ(7, profile->ComputeTime("Relu", "GPU", inputs, {}));
+
+  const string text = io::JoinPath(testing::TmpDir(), "profile.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), text, performance));
+  TF_ASSERT_OK(FusionCostProfile::Load(Env::Default(), text, &profile));
+  EXPECT_EQ(7, profile->ComputeTime("Relu", "GPU", inputs, {}));
+
+  EXPECT_FALSE(FusionCostProfile::Load(
+                   Env::Default(), io::JoinPath(testing::TmpDir(), "missing"),
+                   &profile)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,403 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Smaller groups don't save enough kernel launches to pay for the Pack and
+// Unpack ops around the fused op.
+constexpr int kMinGroupSize = 4;
+
+constexpr char kSuffix[] = "/HorizontalFusion";
+
+enum class FusionKind { kMatMul, kBiasAdd, kUnary, kBinary };
+
+bool IsSupportedType(DataType dtype) {
+  return dtype == DT_FLOAT || dtype == DT_HALF || dtype == DT_DOUBLE;
+}
+
+bool GetFusionKind(const NodeDef& node, FusionKind* kind) {
+  static const auto* unary_ops = new absl::flat_hash_set<string>{
+      "Abs",  "Elu",  "Exp",     "Log",      "Neg",  "Relu",  "Relu6",
+      "Rsqrt", "Selu", "Sigmoid", "Softplus", "Sqrt", "Square", "Tanh"};
+  static const auto* binary_ops =
+      new absl::flat_hash_set<string>{"Add", "AddV2", "Mul", "Sub"};
+  if (IsMatMul(node)) {
+    *kind = FusionKind::kMatMul;
+  } else if (node.op() == "BiasAdd") {
+    auto it = node.attr().find("data_format");
+    if (it != node.attr().end() && it->second.s() != "NHWC") return false;
+    *kind = FusionKind::kBiasAdd;
+  } else if (unary_ops->contains(node.op())) {
+    *kind = FusionKind::kUnary;
+  } else if (binary_ops->contains(node.op())) {
+    *kind = FusionKind::kBinary;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the key grouping `node` with the ops it can be fused with, or an
+// empty string if it can't be fused.
+string FusionKey(const NodeDef& node, const GraphProperties& properties,
+                 int depth, const FrameView& frames) {
+  FusionKind kind;
+  if (!GetFusionKind(node, &kind) || frames.IsInFrame(node) ||
+      !properties.HasInputProperties(node.name())) {
+    return "";
+  }
+  std::map<string, const AttrValue*> attrs;
+  for (const auto& attr : node.attr()) {
+    // Internal attributes, e.g. colocation constraints, don't carry over to
+    // the fused op.
+    if (absl::StartsWith(attr.first, "_")) return "";
+    attrs[attr.first] = &attr.second;
+  }
+  auto it = node.attr().find("T");
+  if (it == node.attr().end() || !IsSupportedType(it->second.type())) {
+    return "";
+  }
+
+  const auto& inputs = properties.GetInputProperties(node.name());
+  const int num_inputs = kind == FusionKind::kUnary ? 1 : 2;
+  if (inputs.size() != num_inputs || NumNonControlInputs(node) != num_inputs) {
+    return "";
+  }
+  for (const auto& input : inputs) {
+    if (!PartialTensorShape(input.shape()).IsFullyDefined()) return "";
+  }
+  const int rank = inputs[0].shape().dim_size();
+  switch (kind) {
+    case FusionKind::kMatMul:
+      if (rank != 2 || inputs[1].shape().dim_size() != 2) return "";
+      break;
+    case FusionKind::kBiasAdd:
+      if (rank < 2 || inputs[1].shape().dim_size() != 1) return "";
+      break;
+    case FusionKind::kBinary:
+      // Broadcasts are not supported: the stacked inputs must match.
+      if (!PartialTensorShape(inputs[0].shape())
+               .IsIdenticalTo(PartialTensorShape(inputs[1].shape()))) {
+        return "";
+      }
+      break;
+    case FusionKind::kUnary:
+      break;
+  }
+
+  string key = strings::StrCat(node.op(), ";", node.device(), ";", depth);
+  for (const auto& input : inputs) {
+    strings::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                       PartialTensorShape(input.shape()).DebugString());
+  }
+  for (const auto& attr : attrs) {
+    strings::StrAppend(&key, ";", attr.first, "=",
+                       SummarizeAttrValue(*attr.second));
+  }
+  return key;
+}
+
+// The output of an op that was replaced by the slice `index` of the stacked
+// output `tensor` of a fused group of `size` ops.
+struct FusedOutput {
+  string tensor;
+  int index;
+  int size;
+};
+
+class HorizontalFusionRewriter {
+ public:
+  HorizontalFusionRewriter(const GraphProperties& properties, GraphDef* graph)
+      : properties_(properties), graph_(graph) {
+    for (const NodeDef& node : graph->node()) {
+      node_names_.insert(node.name());
+    }
+  }
+
+  // Fuses the ops at `members`, indices in the graph. Returns false if the
+  // group was left unchanged.
+  bool FuseGroup(const std::vector<int>& members);
+
+  // Removes the Identity and Unpack nodes that are no longer used.
+  void RemoveUnusedOutputs(const std::set<string>& nodes_to_preserve);
+
+ private:
+  // Returns the Pack of the inputs at `position` of the group, or the stacked
+  // output of a previously fused group that already holds them.
+  string StackedInput(const std::vector<const NodeDef*>& members, int position,
+                      const string& prefix, DataType dtype);
+
+  NodeDef* AddNode(const string& name, const string& op, const string& device);
+
+  const GraphProperties& properties_;
+  GraphDef* graph_;
+  absl::flat_hash_set<string> node_names_;
+  absl::flat_hash_map<string, FusedOutput> fused_outputs_;
+  std::vector<string> unpacks_;
+  std::vector<string> identities_;
+};
+
+NodeDef* HorizontalFusionRewriter::AddNode(const string& name, const string& op,
+                                           const string& device) {
+  NodeDef* node = graph_->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  node->set_device(device);
+  node_names_.insert(name);
+  return node;
+}
+
+string HorizontalFusionRewriter::StackedInput(
+    const std::vector<const NodeDef*>& members, int position,
+    const string& prefix, DataType dtype) {
+  const FusedOutput* stacked = nullptr;
+  for (int i = 0; i < members.size(); ++i) {
+    const TensorId input = ParseTensorName(members[i]->input(position));
+    auto it = fused_outputs_.find(input.node());
+    if (input.index() != 0 || it == fused_outputs_.end() ||
+        it->second.index != i || it->second.size != members.size() ||
+        (stacked != nullptr && stacked->tensor != it->second.tensor)) {
+      stacked = nullptr;
+      break;
+    }
+    stacked = &it->second;
+  }
+  if (stacked != nullptr) {
+    return stacked->tensor;
+  }
+
+  NodeDef* pack = AddNode(strings::StrCat(prefix, "/Pack_", position), "Pack",
+                          members[0]->device());
+  for (const NodeDef* member : members) {
+    pack->add_input(member->input(position));
+  }
+  (*pack->mutable_attr())["N"].set_i(members.size());
+  (*pack->mutable_attr())["T"].set_type(dtype);
+  (*pack->mutable_attr())["axis"].set_i(0);
+  return pack->name();
+}
+
+bool HorizontalFusionRewriter::FuseGroup(const std::vector<int>& members) {
+  std::vector<const NodeDef*> nodes;
+  for (int index : members) {
+    nodes.push_back(&graph_->node(index));
+  }
+  const NodeDef& first = *nodes[0];
+  const string prefix = strings::StrCat(first.name(), kSuffix);
+  for (const char* suffix : {"", "/Pack_0", "/Pack_1", "/Bias",
+                             "/BiasShape", "/Unpack"}) {
+    if (node_names_.contains(strings::StrCat(prefix, suffix))) return false;
+  }
+  FusionKind kind;
+  GetFusionKind(first, &kind);
+  const DataType dtype = first.attr().at("T").type();
+  const int num_inputs = kind == FusionKind::kUnary ? 1 : 2;
+
+  std::vector<string> stacked_inputs;
+  std::vector<string> control_inputs;
+  absl::flat_hash_set<string> seen_control_inputs;
+  for (const NodeDef* node : nodes) {
+    for (const string& input : node->input()) {
+      if (IsControlInput(input) && seen_control_inputs.insert(input).second) {
+        control_inputs.push_back(input);
+      }
+    }
+  }
+  for (int i = 0; i < num_inputs; ++i) {
+    stacked_inputs.push_back(StackedInput(nodes, i, prefix, dtype));
+  }
+
+  NodeDef* fused = nullptr;
+  switch (kind) {
+    case FusionKind::kMatMul: {
+      fused = AddNode(prefix, "BatchMatMulV2", first.device());
+      fused->add_input(stacked_inputs[0]);
+      fused->add_input(stacked_inputs[1]);
+      (*fused->mutable_attr())["T"].set_type(dtype);
+      (*fused->mutable_attr())["adj_x"].set_b(
+          first.attr().count("transpose_a") &&
+          first.attr().at("transpose_a").b());
+      (*fused->mutable_attr())["adj_y"].set_b(
+          first.attr().count("transpose_b") &&
+          first.attr().at("transpose_b").b());
+      break;
+    }
+    case FusionKind::kBiasAdd: {
+      // The stacked biases have shape [n, c]: reshape them into
+      // [n, 1, ..., 1, c] to broadcast them over the stacked values.
+      const auto& inputs = properties_.GetInputProperties(first.name());
+      const int rank = inputs[0].shape().dim_size();
+      Tensor shape(DT_INT32, TensorShape({rank + 1}));
+      auto shape_values = shape.vec<int32>();
+      shape_values(0) = nodes.size();
+      for (int i = 1; i < rank; ++i) shape_values(i) = 1;
+      shape_values(rank) = inputs[1].shape().dim(0).size();
+      NodeDef* bias_shape =
+          AddNode(strings::StrCat(prefix, "/BiasShape"), "Const",
+                  first.device());
+      (*bias_shape->mutable_attr())["dtype"].set_type(DT_INT32);
+      shape.AsProtoTensorContent(
+          (*bias_shape->mutable_attr())["value"].mutable_tensor());
+
+      NodeDef* bias =
+          AddNode(strings::StrCat(prefix, "/Bias"), "Reshape", first.device());
+      bias->add_input(stacked_inputs[1]);
+      bias->add_input(bias_shape->name());
+      (*bias->mutable_attr())["T"].set_type(dtype);
+      (*bias->mutable_attr())["Tshape"].set_type(DT_INT32);
+
+      fused = AddNode(prefix, "AddV2", first.device());
+      fused->add_input(stacked_inputs[0]);
+      fused->add_input(bias->name());
+      (*fused->mutable_attr())["T"].set_type(dtype);
+      break;
+    }
+    case FusionKind::kUnary:
+    case FusionKind::kBinary: {
+      fused = AddNode(prefix, first.op(), first.device());
+      for (const string& input : stacked_inputs) fused->add_input(input);
+      *fused->mutable_attr() = first.attr();
+      break;
+    }
+  }
+  for (const string& input : control_inputs) fused->add_input(input);
+
+  NodeDef* unpack =
+      AddNode(strings::StrCat(prefix, "/Unpack"), "Unpack", first.device());
+  unpack->add_input(prefix);
+  (*unpack->mutable_attr())["num"].set_i(nodes.size());
+  (*unpack->mutable_attr())["T"].set_type(dtype);
+  (*unpack->mutable_attr())["axis"].set_i(0);
+  unpacks_.push_back(unpack->name());
+
+  for (int i = 0; i < members.size(); ++i) {
+    NodeDef* node = graph_->mutable_node(members[i]);
+    node->set_op("Identity");
+    node->clear_input();
+    node->add_input(strings::StrCat(unpack->name(), ":", i));
+    node->clear_attr();
+    (*node->mutable_attr())["T"].set_type(dtype);
+    fused_outputs_[node->name()] = {prefix, i,
+                                    static_cast<int>(members.size())};
+    identities_.push_back(node->name());
+  }
+  return true;
+}
+
+void HorizontalFusionRewriter::RemoveUnusedOutputs(
+    const std::set<string>& nodes_to_preserve) {
+  for (const std::vector<string>* candidates : {&identities_, &unpacks_}) {
+    absl::flat_hash_set<string> used;
+    for (const NodeDef& node : graph_->node()) {
+      for (const string& input : node.input()) {
+        used.insert(NodeName(input));
+      }
+    }
+    std::set<string> to_delete;
+    for (const string& name : *candidates) {
+      if (!used.contains(name) && nodes_to_preserve.count(name) == 0) {
+        to_delete.insert(name);
+      }
+    }
+    EraseNodesFromGraph(to_delete, graph_);
+  }
+}
+
+}  // namespace
+
+Status HorizontalFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+  FrameView frames;
+  TF_RETURN_IF_ERROR(frames.InferFromGraph(item.graph));
+
+  // The depth of a node is the length of the longest path to it: nodes at
+  // the same depth can't depend on one another.
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+  absl::flat_hash_map<string, int> depths;
+  for (const NodeDef* node : topo_order) {
+    int depth = 0;
+    for (const string& input : node->input()) {
+      auto it = depths.find(NodeName(input));
+      if (it != depths.end()) depth = std::max(depth, it->second + 1);
+    }
+    depths[node->name()] = depth;
+  }
+
+  std::map<string, std::vector<int>> groups;
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    const NodeDef& node = item.graph.node(i);
+    const string key =
+        FusionKey(node, properties, depths[node.name()], frames);
+    if (!key.empty()) groups[key].push_back(i);
+  }
+  // Fuse the groups from the inputs to the outputs of the graph, so that the
+  // inputs of a group are fused before the group itself.
+  std::vector<std::pair<int, std::vector<int>>> ordered_groups;
+  for (auto& group : groups) {
+    if (group.second.size() < kMinGroupSize) continue;
+    const int depth = depths[item.graph.node(group.second[0]).name()];
+    ordered_groups.emplace_back(depth, std::move(group.second));
+  }
+  std::sort(ordered_groups.begin(), ordered_groups.end());
+
+  *optimized_graph = item.graph;
+  HorizontalFusionRewriter rewriter(properties, optimized_graph);
+  int num_fused_groups = 0;
+  for (const auto& group : ordered_groups) {
+    if (rewriter.FuseGroup(group.second)) ++num_fused_groups;
+  }
+  if (num_fused_groups == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  rewriter.RemoveUnusedOutputs(item.NodesToPreserve());
+  VLOG(1) << "Fused " << num_fused_groups << " groups of independent ops.";
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses groups of independent small ops into a single batched op, to reduce
+// the number of kernels launched by wide models (e.g. the towers of a
+// multi-tower recommender).
+//
+// Ops are grouped when they have the same type, attributes, device and fully
+// defined input shapes and are at the same depth in the graph, which
+// guarantees that none of them depends on another. The inputs of a group are
+// stacked with Pack, the group runs as one op on the stacked inputs, e.g.
+// BatchMatMulV2 for MatMuls, and the result is split back with Unpack. The
+// original ops become Identity nodes of the split results, so that their names
+// remain valid. When the inputs of a group are exactly the outputs of a group
+// fused before, the stacked result is used directly, so chains of fused groups
+// (MatMul -> BiasAdd -> Relu) don't stack and split in between.
+class HorizontalFusion : public GraphOptimizer {
+ public:
+  HorizontalFusion() {}
+  explicit HorizontalFusion(RewriterConfig::Toggle opt_level) {}
+
+  ~HorizontalFusion() override {}
+
+  string name() const override { return "horizontal_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
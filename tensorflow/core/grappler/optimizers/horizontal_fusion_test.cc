@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class HorizontalFusionTest : public GrapplerTest {};
+
+TEST_F(HorizontalFusionTest, FuseTowers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int i = 0; i < 4; ++i) {
+    const string tower = strings::StrCat("tower", i);
+    Output x = ops::Const(s.WithOpName(tower + "/x"),
+                          GenerateRandomTensor<DT_FLOAT>({2, 3}));
+    Output w = ops::Const(s.WithOpName(tower + "/w"),
+                          GenerateRandomTensor<DT_FLOAT>({3, 5}));
+    Output b = ops::Const(s.WithOpName(tower + "/b"),
+                          GenerateRandomTensor<DT_FLOAT>({5}));
+    Output matmul = ops::MatMul(s.WithOpName(tower + "/matmul"), x, w);
+    Output bias_add =
+        ops::BiasAdd(s.WithOpName(tower + "/bias_add"), matmul, b);
+    ops::Relu(s.WithOpName(tower + "/relu"), bias_add);
+    item.fetch.push_back(tower + "/relu");
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The towers run as a single BatchMatMulV2, AddV2 and Relu, without
+  // splitting and stacking the results in between.
+  EXPECT_EQ(0, CountOpNodes(output, "MatMul"));
+  EXPECT_EQ(0, CountOpNodes(output, "BiasAdd"));
+  EXPECT_EQ(1, CountOpNodes(output, "BatchMatMulV2"));
+  EXPECT_EQ(1, CountOpNodes(output, "AddV2"));
+  EXPECT_EQ(1, CountOpNodes(output, "Relu"));
+  EXPECT_EQ(3, CountOpNodes(output, "Pack"));
+  EXPECT_EQ(1, CountOpNodes(output, "Unpack"));
+  EXPECT_EQ(4, CountOpNodes(output, "Identity"));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("tower0/matmul", node.name());
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorNear<float>(tensors_expected[i], tensors[i], 1e-5);
+  }
+}
+
+TEST_F(HorizontalFusionTest, KeepsDependentAndMismatchedOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  // A chain of MatMuls can't be fused, nor can MatMuls of different shapes.
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateRandomTensor<DT_FLOAT>({3, 3}));
+  Output chain = ops::Const(s.WithOpName("x"),
+                            GenerateRandomTensor<DT_FLOAT>({2, 3}));
+  for (int i = 0; i < 4; ++i) {
+    chain = ops::MatMul(s.WithOpName(strings::StrCat("chain", i)), chain, w);
+  }
+  item.fetch.push_back(chain.name());
+  for (int i = 0; i < 4; ++i) {
+    Output x = ops::Const(s.WithOpName(strings::StrCat("y", i)),
+                          GenerateRandomTensor<DT_FLOAT>({i + 1, 3}));
+    ops::MatMul(s.WithOpName(strings::StrCat("matmul", i)), x, w);
+    item.fetch.push_back(strings::StrCat("matmul", i));
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusion optimizer;
+  GraphDef output;
+  Status status = optimizer.Optimize(nullptr, item, &output);
+  EXPECT_TRUE(errors::IsAborted(status)) << status;
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
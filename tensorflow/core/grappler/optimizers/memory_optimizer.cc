@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -440,9 +441,113 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns the number of bytes by which the estimated peak memory usage of the
+// graph exceeds the memory of its most oversubscribed device, 0 if the graph
+// fits on every device, or -1 if the memory usage can't be estimated.
+int64 RequiredMemorySavings(Cluster* cluster, const GrapplerItem& item) {
+  if (cluster == nullptr || item.fetch.empty()) {
+    return -1;
+  }
+  GraphMemory memory(item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  Status s = memory.InferStatically(devices);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return -1;
+  }
+  int64 required_savings = -1;
+  for (const auto& device : devices) {
+    const int64 memory_size = device.second.memory_size();
+    if (memory_size <= 0) {
+      continue;
+    }
+    const int64 peak = memory.GetPeakMemoryUsage(device.first).used_memory;
+    if (peak < 0) {
+      continue;
+    }
+    required_savings =
+        std::max(required_savings, std::max<int64>(0, peak - memory_size));
+  }
+  return required_savings;
+}
+
+// Keeps the subgraphs which free the most memory per unit of recomputation
+// time, until together they free at least `required_savings` bytes. The memory
+// freed by a subgraph is estimated as the size of the outputs of its nodes,
+// which no longer need to be kept alive until the gradients run.
+void SelectSubgraphsToRecompute(const GrapplerItem& item,
+                                const GraphDef& graph, int64 required_savings,
+                                std::vector<RecomputedSubGraph>* subgraphs) {
+  GraphProperties properties(item);
+  Status s = properties.InferStatically(/*assume_valid_feeds=*/false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes, recomputing all candidates: "
+            << s.error_message();
+    return;
+  }
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+  OpLevelCostEstimator estimator;
+
+  struct Candidate {
+    RecomputedSubGraph subgraph;
+    int64 freed_bytes = 0;
+    double recompute_time = 0;
+  };
+  std::vector<Candidate> candidates;
+  for (RecomputedSubGraph& subgraph : *subgraphs) {
+    Candidate candidate;
+    for (const NodeDef* node : subgraph.recomputed_source_nodes) {
+      if (!properties.HasOutputProperties(node->name())) {
+        continue;
+      }
+      for (const auto& output : properties.GetOutputProperties(node->name())) {
+        candidate.freed_bytes +=
+            std::max<int64>(0, CalculateTensorSize(output));
+      }
+      OpContext op_context;
+      op_context.name = node->name();
+      op_context.op_info = BuildOpInfoWithoutDevice(
+          *node, name_to_node, properties.GetInputProperties(node->name()));
+      *op_context.op_info.mutable_device() = GetDeviceInfo(node->device());
+      candidate.recompute_time +=
+          estimator.PredictCosts(op_context).execution_time.count();
+    }
+    candidate.subgraph = std::move(subgraph);
+    candidates.push_back(std::move(candidate));
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& a, const Candidate& b) {
+                     return a.freed_bytes * std::max(b.recompute_time, 1.0) >
+                            b.freed_bytes * std::max(a.recompute_time, 1.0);
+                   });
+
+  subgraphs->clear();
+  int64 freed_bytes = 0;
+  for (Candidate& candidate : candidates) {
+    if (freed_bytes >= required_savings) {
+      break;
+    }
+    freed_bytes += candidate.freed_bytes;
+    subgraphs->push_back(std::move(candidate.subgraph));
+  }
+  VLOG(1) << "Recomputing " << subgraphs->size() << " of "
+          << candidates.size() << " candidate subgraphs to free an estimated "
+          << freed_bytes << " of the " << required_savings
+          << " bytes required";
+}
+
+// Recomputes subgraphs of `graph` so that their outputs don't need to be kept
+// in memory until the nodes matching `recomputation_targets_name_scope` run.
+// If `required_savings` is non-negative, the heuristics only recompute as many
+// subgraphs as are needed to save that many bytes.
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                int64 required_savings, GraphDef* graph,
+                                const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -488,6 +593,10 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
+    if (required_savings > 0) {
+      SelectSubgraphsToRecompute(item, *graph, required_savings,
+                                 &recomputed_subgraphs);
+    }
   } else if (optimization_level == RewriterConfig::MANUAL) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
@@ -977,10 +1086,63 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Estimates the time at which the execution of each node completes by
+// simulating the graph on `cluster` with the virtual scheduler. Unlike
+// EstimateEarliestExecutionTimes, this accounts for the serialization of the
+// nodes placed on the same device, so the times can be used to overlap swaps
+// with the computation that actually runs on the device.
+static Status EstimateSimulatedCompletionTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* completion_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  TF_RETURN_IF_ERROR(vcluster.Provision());
+  TF_RETURN_IF_ERROR(vcluster.Initialize(item));
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  // The virtual cluster reports RESOURCE_EXHAUSTED when the graph doesn't fit
+  // in memory, which is expected here, but the timings are still valid.
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return s;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      completion_times->emplace(node_stats.node_name(), exec_time);
+    }
+  }
+  // The trace only has microsecond granularity, so a node and its fanout can
+  // appear to complete at the same time.
+  return BreakCompletionTimeTies(item.graph, completion_times);
+}
+
+// The simulated completion times of the nodes of a graph, estimated at most
+// once per swapping pass since the simulation is expensive.
+struct SimulatedCompletionTimes {
+  bool estimated = false;
+  Status status;
+  std::unordered_map<string, Costs::NanoSeconds> times;
+};
+
+static const Status& EstimateSimulatedCompletionTimesOnce(
+    Cluster* cluster, const GrapplerItem& item,
+    SimulatedCompletionTimes* completion_times) {
+  if (!completion_times->estimated) {
+    completion_times->status = EstimateSimulatedCompletionTimes(
+        cluster, item, &completion_times->times);
+    completion_times->estimated = true;
+  }
+  return completion_times->status;
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
     std::unordered_set<string>* skip_list,
+    SimulatedCompletionTimes* completion_times,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
   if ((*memory_ptr) == nullptr) {
     memory_ptr->reset(new GraphMemory(*item));
@@ -1011,31 +1173,12 @@ static bool IdentifySwappingCandidates(
     }
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
 
-    std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateSimulatedCompletionTimesOnce(cluster, *item, completion_times)
+             .ok()) {
+      return false;
     }
+    const std::unordered_map<string, Costs::NanoSeconds>& op_completion_times =
+        completion_times->times;
 
     Costs::Duration peak_time = -1;
     for (const auto& live_tensor : mem_usage.live_tensors) {
@@ -1150,12 +1293,15 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                   Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
                   GrapplerItem* item, std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
+  // The swap candidates and the swap placement below only read the graph, so
+  // they share one simulation of it.
+  SimulatedCompletionTimes completion_times;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
     IdentifySwappingCandidates(cluster, item, memory, skip_list,
-                               &nodes_to_swap);
+                               &completion_times, &nodes_to_swap);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1204,6 +1350,25 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times).ok()) {
     return false;
   }
+  // The earliest execution times assume that every node runs as soon as its
+  // inputs are ready. When the device is busy the nodes run later than that,
+  // so the swap-ins can be triggered at the wrong time and stall their
+  // consumers on the copy. Use the simulated times instead for the nodes the
+  // simulation ran.
+  const Status& s =
+      EstimateSimulatedCompletionTimesOnce(cluster, *item, &completion_times);
+  if (s.ok()) {
+    for (auto& execution_time : execution_times) {
+      auto it = completion_times.times.find(execution_time.first->name());
+      if (it != completion_times.times.end()) {
+        execution_time.second = it->second;
+      }
+    }
+  } else {
+    VLOG(1) << "Failed to simulate the graph, using the earliest execution "
+               "times to place the swaps: "
+            << s.error_message();
+  }
 
   std::unordered_map<string, const NodeDef*> name_map;
   for (const auto& node : item->graph.node()) {
@@ -1395,9 +1560,19 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    // The heuristics only recompute what is needed to fit the graph in the
+    // memory of the cluster, when its memory usage can be estimated.
+    int64 required_savings = -1;
+    if (optimization_level_ != RewriterConfig::MANUAL) {
+      required_savings = RequiredMemorySavings(cluster, optimized_item);
+    }
+    if (required_savings == 0) {
+      VLOG(1) << "Not recomputing, the graph fits in memory";
+    } else {
+      RecomputationRewritingPass(
+          optimization_level_, recomputation_targets_name_scope_,
+          required_savings, &optimized_item.graph, item);
+    }
   }
 
   std::unordered_set<string> skip_list;
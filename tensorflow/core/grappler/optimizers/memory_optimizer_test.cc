@@ -224,6 +224,45 @@ class MemoryOptimizerTest : public GrapplerTest {
   }
 };
 
+TEST_F(MemoryOptimizerTest, RecomputationMemoryBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output a = ops::Variable(s.WithOpName("Conv"), {64, 64}, DT_FLOAT);
+  Output b = ops::Identity(s.WithOpName("BN"), a);
+  Output c = ops::Identity(s.WithOpName("ReLU"), b);
+  Output d = ops::Identity(s.WithOpName("Conv1"), c);
+  Output trigger = ops::AddN(s.WithOpName("gradients/BN1Grad"), {d});
+  Output e = ops::AddN(s.WithOpName("gradients/Conv1Grad"), {trigger, c});
+  Output f = ops::AddN(s.WithOpName("gradients/ReLUGrad"), {e, c});
+  Output g = ops::AddN(s.WithOpName("gradients/BNGrad"), {f, a});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/BNGrad"};
+  NodeMap node_map(&item.graph);
+  node_map.GetNode("BN")->set_op("FusedBatchNorm");
+  node_map.GetNode("ReLU")->set_op("Relu");
+
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+
+  // The graph fits in the memory of the cluster: nothing is recomputed.
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  // The graph doesn't fit in the memory of the cluster: the candidate
+  // subgraph is recomputed.
+  std::unordered_map<string, DeviceProperties> devices = cluster->GetDevices();
+  for (auto& device : devices) {
+    device.second.set_memory_size(1024);
+  }
+  VirtualCluster small_cluster(devices);
+  TF_EXPECT_OK(optimizer.Optimize(&small_cluster, item, &output));
+  NodeMap output_map(&output);
+  EXPECT_NE(nullptr, output_map.GetNode("Recomputed/ReLU"));
+  EXPECT_EQ("Recomputed/ReLU", output_map.GetNode(f.name())->input(1));
+}
+
 TEST_F(MemoryOptimizerTest, SimpleSwapping) {
   // Build a simple graph with an op that's marked for swapping.
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
@@ -35,12 +35,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/elementwise_fusion.h"
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
@@ -51,9 +54,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
 
@@ -169,6 +176,47 @@ bool MemoryOptimizerEnabled(
   return mem_opt_type != RewriterConfig::NO_MEM_OPT;
 }
 
+// Returns whether the body of `func` calls one of the functions in `funcs`,
+// other than itself.
+bool CallsAnyOf(const FunctionDef& func, const FunctionLibraryDefinition& flib,
+                const absl::flat_hash_set<string>& funcs) {
+  const string& func_name = func.signature().name();
+  const auto is_other = [&](const string& name) {
+    return name != func_name && funcs.contains(name);
+  };
+  for (const NodeDef& node : func.node_def()) {
+    if (is_other(node.op()) && flib.Contains(node.op())) return true;
+    for (const auto& attr : node.attr()) {
+      const AttrValue& value = attr.second;
+      if (value.has_func() && is_other(value.func().name())) return true;
+      for (const NameAttrList& list_func : value.list().func()) {
+        if (is_other(list_func.name())) return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns the number of threads used to optimize the functions of the
+// library concurrently, which can be set with the environment variable
+// TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS. 1 optimizes them sequentially.
+int NumFunctionOptimizationThreads() {
+  static const int num_threads = []() {
+    int64 num_threads;
+    Status s = ReadInt64FromEnvVar("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS",
+                                   0, &num_threads);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+      num_threads = 0;
+    }
+    if (num_threads <= 0) {
+      num_threads = std::min(port::MaxParallelism(), 16);
+    }
+    return static_cast<int>(num_threads);
+  }();
+  return num_threads;
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, VALUE) \
@@ -191,6 +239,9 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
              cfg_.experimental_disable_compressed_tensor_optimization()));
   MK_OPT("shape", new ShapeOptimizer());
   MK_OPT("remap", new Remapper(cfg_.remapping()));
+  MK_OPT("horizontal_fusion", new HorizontalFusion(cfg_.horizontal_fusion()));
+  MK_OPT("elementwise_fusion",
+         new ElementwiseFusion(cfg_.elementwise_fusion()));
   MK_OPT("layout", new GenericLayoutOptimizer(
                        /*optimization level*/ cfg_.layout_optimizer(),
                        /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
@@ -272,6 +323,12 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         MakeUnique<ArithmeticOptimizer>(cfg_.arithmetic_optimization()));
   }
+  if (cfg_.horizontal_fusion() == RewriterConfig::ON) {
+    // Runs before the remapper, which would fuse the MatMuls of the towers
+    // with their BiasAdds.
+    optimizers->push_back(
+        MakeUnique<HorizontalFusion>(cfg_.horizontal_fusion()));
+  }
   if (cfg_.layout_optimizer() != RewriterConfig::OFF) {
     optimizers->push_back(MakeUnique<GenericLayoutOptimizer>(
         /*optimization level*/ cfg_.layout_optimizer(),
@@ -280,6 +337,12 @@ Status MetaOptimizer::InitializeOptimizers(
   if (cfg_.remapping() != RewriterConfig::OFF) {
     optimizers->push_back(MakeUnique<Remapper>(cfg_.remapping()));
   }
+  if (cfg_.elementwise_fusion() == RewriterConfig::ON) {
+    // Runs after the remapper, which fuses the activations of contractions
+    // into the contractions themselves.
+    optimizers->push_back(
+        MakeUnique<ElementwiseFusion>(cfg_.elementwise_fusion()));
+  }
   if (cfg_.loop_optimization() != RewriterConfig::OFF) {
     optimizers->push_back(
         MakeUnique<LoopOptimizer>(cfg_.loop_optimization(), cpu_device_));
@@ -402,6 +465,13 @@ void MetaOptimizer::InitializeVerifiers(
 
 Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                     GraphDef* optimized_graph) {
+  return OptimizeGraph(cluster, std::move(item), optimized_graph,
+                       &optimization_results_);
+}
+
+Status MetaOptimizer::OptimizeGraph(
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* optimization_results) {
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -461,6 +531,12 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
     CompressConstants(optimized_graph);
   }
 
+  // The number of changes made to the graph so far, and for each optimizer
+  // the number when it last did nothing. An optimizer that did nothing is not
+  // run again until the graph changes, since it would see the same graph.
+  int64 graph_version = 0;
+  std::unordered_map<const GraphOptimizer*, int64> unchanged_at_version;
+
   for (int iteration = 0; iteration < NumIterations(cfg_); ++iteration) {
     // Don't bother optimizing further if the graph is already tiny.
     if (optimized_graph->node_size() < min_graph_nodes) {
@@ -488,11 +564,26 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
         continue;
       }
 
+      auto unchanged = unchanged_at_version.find(optimizer.get());
+      if (unchanged != unchanged_at_version.end() &&
+          unchanged->second == graph_version) {
+        VLOG(3) << "Skipping " << optimizer->name() << " in iteration "
+                << iteration << ", the graph is unchanged since it last ran";
+        continue;
+      }
+
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
+      const OptimizerResult& result = optimization_result.results.back();
+      if (result.did_nothing) {
+        unchanged_at_version[optimizer.get()] = graph_version;
+      } else if (result.status.ok()) {
+        ++graph_version;
+      }
 
       if (iteration == 0 && optimizer->name() == "model_pruner") {
         CompressConstants(optimized_graph);
+        ++graph_version;
       }
 
       if (VLOG_IS_ON(4)) {
@@ -533,7 +624,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  optimization_results->push_back(optimization_result);
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -578,9 +669,11 @@ Status MetaOptimizer::RunOptimizer(
   metrics::UpdateGrapplerPassTime(optimizer->name(), end_us - start_us);
 
   string message;
+  bool did_nothing = false;
   if (!status.ok()) {
     optimized_graph->Swap(&optimized_item->graph);
     if (errors::IsAborted(status)) {
+      did_nothing = true;
       // By convention we (ab-)use the Aborted error code to signal that the
       // optimizer returned without performing any changes to the graph.
       message = strings::StrCat(optimizer->name(),
@@ -607,7 +700,8 @@ Status MetaOptimizer::RunOptimizer(
     optimized_graph->mutable_library()->Swap(&optimized_graph_function_library);
   }
 
-  OptimizerResult optimizer_result{optimizer->name(), message, status};
+  OptimizerResult optimizer_result{optimizer->name(), message, status,
+                                   did_nothing};
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok() && cfg_.fail_on_optimizer_errors()) return status;
@@ -728,6 +822,8 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // Collect the functions to optimize in this pass.
+    std::vector<const FunctionDef*> funcs_to_optimize;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -758,79 +854,153 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs_to_optimize.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    // Functions are optimized in waves. A function is optimized once the
+    // functions it calls in this pass have been, so that it sees their
+    // optimized bodies (e.g. when inlining them). The functions of a wave are
+    // independent and optimized concurrently, and then merged back into the
+    // library in order, which keeps the result deterministic.
+    absl::flat_hash_set<string> pending_funcs;
+    for (const FunctionDef* func : funcs_to_optimize) {
+      pending_funcs.insert(func->signature().name());
+    }
+    std::vector<const FunctionDef*> remaining_funcs = funcs_to_optimize;
+    while (!remaining_funcs.empty()) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+
+      std::vector<const FunctionDef*> wave;
+      std::vector<const FunctionDef*> next_remaining_funcs;
+      for (const FunctionDef* func : remaining_funcs) {
+        if (CallsAnyOf(*func, flib, pending_funcs)) {
+          next_remaining_funcs.push_back(func);
+        } else {
+          wave.push_back(func);
+        }
+      }
+      if (wave.empty()) {
+        // The remaining functions call each other: optimize them together.
+        wave.swap(next_remaining_funcs);
       }
+      remaining_funcs.swap(next_remaining_funcs);
+
+      // Make GrapplerItems from the FunctionDefs.
+      std::vector<GrapplerFunctionItem> func_items(wave.size());
+      for (int i = 0; i < wave.size(); ++i) {
+        const FunctionDef& func = *wave[i];
+        const string& func_name = func.signature().name();
+        GrapplerFunctionItem& func_item = func_items[i];
+        TF_RETURN_IF_ERROR(
+            MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+
+        // If we need to compute the gradient of optimized function at runtime,
+        // we can't perform non-differentiable rewrites.
+        func_item.optimization_options().allow_non_differentiable_rewrites =
+            !differentiable_functions.contains(func_name);
+
+        // Device set available to the function is defined only by the
+        // runtime, when we instantiate and execute the function. We can't use
+        // all devices available to the main graph, because after partitioning
+        // the function call node might execute on a remote worker.
+        if (!func_item.devices().empty()) {
+          return errors::Internal(
+              "GrapplerFunctionItem devices must be empty.");
+        }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        FunctionDefLibrary func_item_function_library;
-        func_item_function_library.Swap(func_item.graph.mutable_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        // We are not allowed to prune certain types of ops from the graph
+        // instantiated by the function definition, because we must guarantee
+        // function execution semantics wrt side effects (see
+        // function_optimizer.cc).
+        func_item.optimization_options()
+            .allow_pruning_stateful_and_dataset_ops = false;
       }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      // Optimize function body graphs.
+      const bool is_tpu_graph = IsTPUGraphDef(*optimized_graph);
+      std::vector<GraphDef> optimized_func_graphs(wave.size());
+      std::vector<std::vector<GraphOptimizationResult>> func_results(
+          wave.size());
+      std::vector<Status> func_statuses(wave.size());
+      const auto optimize_func = [&](int i) {
+        GrapplerFunctionItem& func_item = func_items[i];
+        if (is_tpu_graph) {
+          // Skip optimizing functions if this is a TPU graph. Currently,
+          // Grappler passes do not handle TPU functions correctly in a variety
+          // of ways (Note that due to the pre-placement TPU graph rewriting
+          // passes, the TPU-related ops are encapsulated away into functions).
+          // For example, TPU graphs contain TPUReplicateMetadata node that
+          // carries relevant TPU metadata and Grappler passes could prune that
+          // away. Grappler passes could also cause issues around shape
+          // inference. Since the desired and existing behavior is to not
+          // optimize TPU functions with Grappler, this check preserves that.
+          // The only exception is implementation selector what is required to
+          // swap in some TPU specific lowering code and is verified the work
+          // correctly on TPUs.
+          ImplementationSelector implementation_selector;
+
+          // Implementation selector needs to have access to valid function
+          // signature and attributes, and it doesn't need actual function
+          // body.
+          FunctionDefLibrary func_item_function_library;
+          func_item_function_library.Swap(func_item.graph.mutable_library());
+          *func_item.graph.mutable_library() =
+              GetFunctionDefLibraryStub(func_item_function_library);
+
+          func_statuses[i] = implementation_selector.Optimize(
+              cluster, func_item, &optimized_func_graphs[i]);
+        } else {
+          GrapplerFunctionItem func_item_copy = func_item;
+          func_statuses[i] =
+              OptimizeGraph(cluster, std::move(func_item_copy),
+                            &optimized_func_graphs[i], &func_results[i]);
+        }
+      };
+      const int num_threads =
+          std::min<int>(wave.size(), NumFunctionOptimizationThreads());
+      if (num_threads > 1) {
+        thread::ThreadPool pool(Env::Default(), "grappler_optimize_functions",
+                                num_threads);
+        BlockingCounter counter(wave.size());
+        for (int i = 0; i < wave.size(); ++i) {
+          pool.Schedule([&optimize_func, &counter, i]() {
+            optimize_func(i);
+            counter.DecrementCount();
+          });
         }
+        counter.Wait();
+      } else {
+        for (int i = 0; i < wave.size(); ++i) optimize_func(i);
       }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      // Merge the optimized functions back into the library, in order.
+      for (int i = 0; i < wave.size(); ++i) {
+        TF_RETURN_IF_ERROR(func_statuses[i]);
+        const string& func_name = wave[i]->signature().name();
+        GrapplerFunctionItem& func_item = func_items[i];
+        GraphDef& optimized_func_graph = optimized_func_graphs[i];
+        for (GraphOptimizationResult& result : func_results[i]) {
+          optimization_results_.push_back(std::move(result));
+        }
+
+        // Function body optimization might have created new specialized
+        // functions for each instantiation context. Add them to the library.
+        for (const FunctionDef& func_def :
+             optimized_func_graph.library().function()) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          }
+        }
+
+        // Convert optimized graph back to FunctionDef.
+        FunctionDef optimized_func;
+        func_item.SwapFunctionBody(std::move(optimized_func_graph));
+        TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        // Replace optimized function with a new FunctionDef.
+        TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        pending_funcs.erase(func_name);
+      }
     }
 
     // If optimized at least one function, update the graph library.
@@ -900,11 +1070,35 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  OptimizedGraphCache* cache = OptimizedGraphCache::Global();
+  string cache_key;
+  if (cache != nullptr) {
+    cache_key = OptimizedGraphCache::Key(item, cfg, cluster);
+    uint64 saved_usecs = 0;
+    const bool hit = cache->Lookup(cache_key, optimized_graph, &saved_usecs);
+    metrics::RecordGrapplerCacheLookup(hit, saved_usecs);
+    if (hit) {
+      VLOG(1) << "Using cached optimized graph " << cache_key << " for item "
+              << item.id;
+      return Status::OK();
+    }
+  }
+
+  const uint64 start_us = Env::Default()->NowMicros();
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(
+      optimizer.OptimizeConsumeItem(cluster, std::move(item), optimized_graph));
+  if (cache != nullptr) {
+    Status s = cache->Insert(cache_key, *optimized_graph,
+                             Env::Default()->NowMicros() - start_us);
+    if (!s.ok()) {
+      LOG(WARNING) << "Unable to cache optimized graph " << cache_key << ": "
+                   << s;
+    }
+  }
+  return Status::OK();
 }
 
 Status OptimizeGraph(
@@ -96,6 +96,8 @@ class MetaOptimizer : public GraphOptimizer {
     string optimizer_name;
     string message;
     Status status;
+    // Whether the optimizer reported that it left the graph unchanged.
+    bool did_nothing;
   };
 
   struct GraphOptimizationResult {
@@ -108,6 +110,12 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Same as OptimizeGraph above, but records the optimization results in
+  // `optimization_results`. Can be called concurrently for different items.
+  Status OptimizeGraph(
+      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+      std::vector<GraphOptimizationResult>* optimization_results);
+
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/function_testlib.h"
@@ -89,6 +90,37 @@ class TestOptimizerWithParams : public TestOptimizer {
 
 REGISTER_GRAPH_OPTIMIZER(TestOptimizerWithParams);
 
+// Counts its runs, and reports that it left the graph unchanged.
+class NoOpCountingOptimizer : public CustomGraphOptimizer {
+ public:
+  static int NumRuns() { return num_runs_; }
+  static void ResetNumRuns() { num_runs_ = 0; }
+
+  string name() const override { return "no_op_counting_optimizer"; }
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override {
+    ++num_runs_;
+    return errors::Aborted("Nothing to do.");
+  }
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+
+ private:
+  static int num_runs_;
+};
+
+int NoOpCountingOptimizer::num_runs_;
+
+REGISTER_GRAPH_OPTIMIZER(NoOpCountingOptimizer);
+
 // Record various properties of the GrapplerItems passed for optimization.
 class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
  public:
@@ -214,6 +246,45 @@ TEST_F(MetaOptimizerTest, RunOptimizersTwice) {
   TF_EXPECT_OK(status);
 }
 
+TEST_F(MetaOptimizerTest, SkipsOptimizersThatDidNothingOnUnchangedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("NoOpCountingOptimizer");
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_min_graph_nodes(-1);
+
+  NoOpCountingOptimizer::ResetNumRuns();
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(1, NoOpCountingOptimizer::NumRuns());
+}
+
+TEST_F(MetaOptimizerTest, RerunsOptimizersThatDidNothingOnChangedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("NoOpCountingOptimizer");
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_min_graph_nodes(-1);
+
+  NoOpCountingOptimizer::ResetNumRuns();
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(2, NoOpCountingOptimizer::NumRuns());
+}
+
 TEST_F(MetaOptimizerTest, RunToggleOptimizersAndCustomGraphOptimizerTwice) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -596,6 +667,66 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneFunctionBody) {
   test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryConcurrently) {
+  using test::function::NDef;
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("pruning");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  // Independent functions, each with a node that can be pruned, and a function
+  // calling the first of them, which must be optimized after it.
+  constexpr int kNumFunctions = 8;
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string name = absl::StrCat("Func", i);
+    funcs.push_back(FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {},
+        {{{"mul"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}},
+         {{"unused"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/{{"z", "mul:z:0"}}));
+    nodes.push_back(NDef(absl::StrCat("call", i), name, {"x"}, {}, kDevice));
+  }
+  funcs.push_back(FunctionDefHelper::Create(
+      "Outer", {"x:float"}, {"z:float"}, {},
+      {{{"call"}, "Func0", {"x"}, {}},
+       {{"unused"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"z", "call:z:0"}}));
+  nodes.push_back(NDef("call_outer", "Outer", {"x"}, {}, kDevice));
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+  for (int i = 0; i < kNumFunctions; ++i) {
+    item.fetch.push_back(absl::StrCat("call", i));
+  }
+  item.fetch.push_back("call_outer");
+
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Every function body was pruned.
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  EXPECT_EQ(kNumFunctions + 1, optimized_flib.num_functions());
+  for (const string& name : optimized_flib.ListFunctionNames()) {
+    const FunctionDef* func = optimized_flib.Find(name);
+    ASSERT_NE(func, nullptr);
+    EXPECT_EQ(1, func->node_def_size()) << name;
+  }
+
+  // The result doesn't depend on the order in which functions complete.
+  MetaOptimizer other_optimizer(nullptr, config_proto);
+  GraphDef other_output;
+  TF_EXPECT_OK(other_optimizer.Optimize(nullptr, item, &other_output));
+  EXPECT_EQ(output.DebugString(), other_output.DebugString());
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
   using test::function::NDef;
   using FDH = FunctionDefHelper;
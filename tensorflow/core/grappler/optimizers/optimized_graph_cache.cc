@@ -0,0 +1,200 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// The size of the header of a cache entry: the masked checksum of the rest of
+// the entry, followed by the optimization time.
+constexpr size_t kHeaderSize = sizeof(uint32) + sizeof(uint64);
+
+// Appends `piece` to `*s`, prefixed with its length so that the result
+// identifies the sequence of pieces.
+void AppendPiece(StringPiece piece, string* s) {
+  core::PutVarint64(s, piece.size());
+  s->append(piece.data(), piece.size());
+}
+
+void AppendProto(const protobuf::MessageLite& proto, string* s) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendPiece(serialized, s);
+}
+
+void AppendSorted(std::vector<string> strings, string* s) {
+  std::sort(strings.begin(), strings.end());
+  core::PutVarint64(s, strings.size());
+  for (const string& str : strings) AppendPiece(str, s);
+}
+
+}  // namespace
+
+OptimizedGraphCache::OptimizedGraphCache(Env* env, const string& dir)
+    : env_(env), dir_(dir) {}
+
+/* static */
+OptimizedGraphCache* OptimizedGraphCache::Global() {
+  static OptimizedGraphCache* cache = []() -> OptimizedGraphCache* {
+    string dir;
+    Status s = ReadStringFromEnvVar("TF_GRAPPLER_CACHE_DIR", "", &dir);
+    if (!s.ok()) {
+      LOG(WARNING) << "Not caching optimized graphs: " << s;
+      return nullptr;
+    }
+    if (dir.empty()) return nullptr;
+    VLOG(1) << "Caching optimized graphs in " << dir;
+    return new OptimizedGraphCache(Env::Default(), dir);
+  }();
+  return cache;
+}
+
+/* static */
+string OptimizedGraphCache::Key(const GrapplerItem& item,
+                                const ConfigProto& cfg,
+                                const Cluster* cluster) {
+  string s;
+  AppendPiece(TF_VERSION_STRING, &s);
+  core::PutVarint64(&s, TF_GRAPH_DEF_VERSION);
+
+  // The graph dominates the size of the key, so it is fingerprinted on its
+  // own rather than copied into `s`.
+  string graph;
+  SerializeToStringDeterministic(item.graph, &graph);
+  const Fprint128 graph_fingerprint = Fingerprint128(graph);
+  core::PutFixed64(&s, graph_fingerprint.low64);
+  core::PutFixed64(&s, graph_fingerprint.high64);
+
+  core::PutVarint64(&s, item.feed.size());
+  for (const auto& feed : item.feed) {
+    AppendPiece(feed.first, &s);
+    TensorProto value;
+    feed.second.AsProtoTensorContent(&value);
+    AppendProto(value, &s);
+  }
+  core::PutVarint64(&s, item.fetch.size());
+  for (const string& fetch : item.fetch) AppendPiece(fetch, &s);
+  AppendSorted(item.keep_ops, &s);
+  AppendSorted({item.devices().begin(), item.devices().end()}, &s);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  s.push_back(options.allow_non_differentiable_rewrites);
+  s.push_back(options.allow_pruning_stateful_and_dataset_ops);
+  s.push_back(options.optimize_function_library);
+  s.push_back(options.is_eager_mode);
+
+  AppendProto(cfg, &s);
+
+  if (cluster != nullptr) {
+    std::vector<string> device_names;
+    for (const auto& device : cluster->GetDevices()) {
+      device_names.push_back(device.first);
+    }
+    std::sort(device_names.begin(), device_names.end());
+    core::PutVarint64(&s, device_names.size());
+    for (const string& name : device_names) {
+      AppendPiece(name, &s);
+      AppendProto(cluster->GetDevices().at(name), &s);
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(s);
+  return strings::Printf("%016llx%016llx",
+                         static_cast<unsigned long long>(fingerprint.high64),
+                         static_cast<unsigned long long>(fingerprint.low64));
+}
+
+bool OptimizedGraphCache::Lookup(const string& key, GraphDef* graph,
+                                 uint64* optimization_usecs) {
+  const string filename = Filename(key);
+  if (!env_->FileExists(filename).ok()) return false;
+  string contents;
+  Status s = ReadFileToString(env_, filename, &contents);
+  if (!s.ok()) {
+    LOG(WARNING) << "Unable to read cached optimized graph " << filename
+                 << ": " << s;
+    return false;
+  }
+  if (contents.size() < kHeaderSize ||
+      crc32c::Unmask(core::DecodeFixed32(contents.data())) !=
+          crc32c::Value(contents.data() + sizeof(uint32),
+                        contents.size() - sizeof(uint32))) {
+    LOG(WARNING) << "Ignoring corrupted cached optimized graph " << filename;
+    return false;
+  }
+  GraphDef cached;
+  if (!cached.ParseFromArray(contents.data() + kHeaderSize,
+                             contents.size() - kHeaderSize)) {
+    LOG(WARNING) << "Ignoring unparseable cached optimized graph " << filename;
+    return false;
+  }
+  *optimization_usecs = core::DecodeFixed64(contents.data() + sizeof(uint32));
+  graph->Swap(&cached);
+  return true;
+}
+
+Status OptimizedGraphCache::Insert(const string& key, const GraphDef& graph,
+                                   uint64 optimization_usecs) {
+  string contents(sizeof(uint32), '\0');
+  core::PutFixed64(&contents, optimization_usecs);
+  if (!graph.AppendToString(&contents)) {
+    return errors::Internal("Unable to serialize the optimized graph");
+  }
+  core::EncodeFixed32(
+      &contents[0],
+      crc32c::Mask(crc32c::Value(contents.data() + sizeof(uint32),
+                                 contents.size() - sizeof(uint32))));
+
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(dir_));
+  // Write to a temporary file first, so that a concurrent lookup never sees
+  // a partial entry.
+  const string filename = Filename(key);
+  const string tmp_filename = strings::Printf(
+      "%s.tmp%016llx", filename.c_str(),
+      static_cast<unsigned long long>(random::New64()));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, tmp_filename, contents));
+  Status s = env_->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    env_->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+string OptimizedGraphCache::Filename(const string& key) const {
+  return io::JoinPath(dir_, strings::StrCat(key, ".graph"));
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// An on-disk cache of the graphs produced by the meta optimizer, so that a
+// process that optimizes the same graph as an earlier one can skip the
+// optimization.
+//
+// Entries are keyed by a fingerprint of everything the optimization depends
+// on: the item (graph, feeds, fetches, nodes to keep, devices and
+// optimization options), the session config, the devices of the cluster and
+// the TensorFlow version.  Each entry is a file in the cache directory that is
+// written atomically, so a cache can be shared by concurrent processes.
+class OptimizedGraphCache {
+ public:
+  OptimizedGraphCache(Env* env, const string& dir);
+
+  // Returns the cache in the directory named by the TF_GRAPPLER_CACHE_DIR
+  // environment variable, or nullptr if it is not set.
+  static OptimizedGraphCache* Global();
+
+  // Returns the key of the optimized graph of `item` under `cfg` on
+  // `cluster`, which may be null.
+  static string Key(const GrapplerItem& item, const ConfigProto& cfg,
+                    const Cluster* cluster);
+
+  // Sets `*graph` to the graph cached for `key`, and returns true if there is
+  // one.  `*optimization_usecs` is set to the time the optimization took when
+  // the entry was inserted.
+  bool Lookup(const string& key, GraphDef* graph, uint64* optimization_usecs);
+
+  // Caches `graph` for `key`; its optimization took `optimization_usecs`.
+  Status Insert(const string& key, const GraphDef& graph,
+                uint64 optimization_usecs);
+
+ private:
+  string Filename(const string& key) const;
+
+  Env* const env_;
+  const string dir_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OptimizedGraphCache);
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
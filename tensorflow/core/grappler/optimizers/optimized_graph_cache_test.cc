@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem MakeItem() {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+TEST(OptimizedGraphCacheTest, KeyDependsOnInputs) {
+  const GrapplerItem item = MakeItem();
+  ConfigProto cfg;
+  const string key = OptimizedGraphCache::Key(item, cfg, nullptr);
+  EXPECT_EQ(key, OptimizedGraphCache::Key(item, cfg, nullptr));
+
+  GrapplerItem other_graph = item;
+  other_graph.graph.mutable_node(0)->set_name("renamed");
+  EXPECT_NE(key, OptimizedGraphCache::Key(other_graph, cfg, nullptr));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch.push_back("other");
+  EXPECT_NE(key, OptimizedGraphCache::Key(other_fetch, cfg, nullptr));
+
+  GrapplerItem other_devices = item;
+  TF_ASSERT_OK(
+      other_devices.AddDevice("/job:localhost/replica:0/task:0/device:CPU:1"));
+  EXPECT_NE(key, OptimizedGraphCache::Key(other_devices, cfg, nullptr));
+
+  ConfigProto other_cfg;
+  other_cfg.mutable_graph_options()->mutable_rewrite_options()->set_remapping(
+      RewriterConfig::OFF);
+  EXPECT_NE(key, OptimizedGraphCache::Key(item, other_cfg, nullptr));
+}
+
+TEST(OptimizedGraphCacheTest, InsertAndLookup) {
+  const string dir = io::JoinPath(testing::TmpDir(), "insert_and_lookup");
+  OptimizedGraphCache cache(Env::Default(), dir);
+  const GrapplerItem item = MakeItem();
+  const string key = OptimizedGraphCache::Key(item, ConfigProto(), nullptr);
+
+  GraphDef graph;
+  uint64 usecs = 0;
+  EXPECT_FALSE(cache.Lookup(key, &graph, &usecs));
+
+  TF_ASSERT_OK(cache.Insert(key, item.graph, 1234));
+  ASSERT_TRUE(cache.Lookup(key, &graph, &usecs));
+  EXPECT_EQ(1234, usecs);
+  EXPECT_EQ(item.graph.DebugString(), graph.DebugString());
+
+  // A second cache in the same directory, as in a restarted process, sees the
+  // entry.
+  OptimizedGraphCache restarted(Env::Default(), dir);
+  GraphDef restarted_graph;
+  ASSERT_TRUE(restarted.Lookup(key, &restarted_graph, &usecs));
+  EXPECT_EQ(item.graph.DebugString(), restarted_graph.DebugString());
+}
+
+TEST(OptimizedGraphCacheTest, IgnoresCorruptedEntries) {
+  const string dir = io::JoinPath(testing::TmpDir(), "corrupted");
+  OptimizedGraphCache cache(Env::Default(), dir);
+  const GrapplerItem item = MakeItem();
+  const string key = OptimizedGraphCache::Key(item, ConfigProto(), nullptr);
+  TF_ASSERT_OK(cache.Insert(key, item.graph, 1));
+
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  ASSERT_EQ(1, children.size());
+  const string filename = io::JoinPath(dir, children[0]);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents[contents.size() - 1] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  GraphDef graph;
+  uint64 usecs = 0;
+  EXPECT_FALSE(cache.Lookup(key, &graph, &usecs));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
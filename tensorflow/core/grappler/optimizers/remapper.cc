@@ -22,11 +22,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/fusion_cost_profile.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -364,6 +366,60 @@ bool IsDeviceCompatible(const RemapperContext& ctx, Pattern& matched) {
   return IsCpuCompatible(ctx, matched) || IsGpuCompatible(ctx, matched);
 }
 
+// Returns false if the fusion cost profile measured the fused contraction to
+// be slower than `contraction`, `bias_add` and `activation` (if not null) run
+// separately.  Returns true if there is no profile or it lacks any of the
+// measurements, so that patterns are fused by default.
+bool IsFusionProfitable(const RemapperContext& ctx, const NodeDef& contraction,
+                        const NodeDef& bias_add, const NodeDef* activation) {
+  const FusionCostProfile* profile = FusionCostProfile::Global();
+  if (profile == nullptr || !ctx.inferred_graph_properties) return true;
+
+  const string device_type = NodeIsOnGpu(&contraction) ? "GPU" : "CPU";
+  const GraphProperties& properties = ctx.graph_properties;
+  std::vector<const NodeDef*> unfused = {&contraction, &bias_add};
+  if (activation != nullptr) unfused.push_back(activation);
+  double unfused_time = 0;
+  for (const NodeDef* node : unfused) {
+    const double time =
+        profile->ComputeTime(node->op(), device_type,
+                             properties.GetInputProperties(node->name()), {});
+    if (time < 0) return true;
+    unfused_time += time;
+  }
+
+  std::vector<OpInfo::TensorProperties> fused_inputs =
+      properties.GetInputProperties(contraction.name());
+  const auto& bias_add_inputs = properties.GetInputProperties(bias_add.name());
+  if (bias_add_inputs.size() < 2) return true;
+  fused_inputs.push_back(bias_add_inputs[1]);
+  std::vector<string> fused_ops = {"BiasAdd"};
+  if (activation != nullptr) fused_ops.push_back(activation->op());
+  const double fused_time =
+      profile->ComputeTime(strings::StrCat("_Fused", contraction.op()),
+                           device_type, fused_inputs, fused_ops);
+  if (fused_time < 0) return true;
+
+  VLOG(2) << "Fusing " << contraction.name() << " takes " << fused_time
+          << "ns instead of " << unfused_time << "ns";
+  return fused_time < unfused_time;
+}
+
+bool IsFusionProfitable(const RemapperContext& ctx,
+                        const ContractionWithBiasAdd& matched) {
+  return IsFusionProfitable(
+      ctx, *ctx.graph_view.GetNode(matched.contraction)->node(),
+      *ctx.graph_view.GetNode(matched.bias_add)->node(), nullptr);
+}
+
+bool IsFusionProfitable(const RemapperContext& ctx,
+                        const ContractionWithBiasAddAndActivation& matched) {
+  return IsFusionProfitable(
+      ctx, *ctx.graph_view.GetNode(matched.contraction)->node(),
+      *ctx.graph_view.GetNode(matched.bias_add)->node(),
+      ctx.graph_view.GetNode(matched.activation)->node());
+}
+
 bool IsSupportedActivation(const NodeDef& node) {
 // Disable LeakyRelu temporarily before MKL PR is merged.
 #ifndef INTEL_MKL
@@ -1651,6 +1707,12 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
+
+  // The measurements in a fusion cost profile are keyed by input shapes.
+  if (FusionCostProfile::Global() != nullptr &&
+      (IsBiasAdd(*node_def) || IsSupportedActivation(*node_def))) {
+    return true;
+  }
   const auto is_batch_norm_candidate = [&]() -> bool {
     if (!IsFusedBatchNorm(*node_def)) return false;
     if (GetDataTypeFromAttr(*node_def, "T") != DT_FLOAT) return false;
@@ -1807,7 +1869,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     // _Fused{Conv2D,DepthwiseConv2dNative,MatMul}
     ContractionWithBiasAdd contract_with_bias;
     if (allow_non_differentiable_rewrites &&
-        FindContractionWithBias(ctx, i, &contract_with_bias)) {
+        FindContractionWithBias(ctx, i, &contract_with_bias) &&
+        IsFusionProfitable(ctx, contract_with_bias)) {
       TF_RETURN_IF_ERROR(AddFusedContractionNode(
           &ctx, contract_with_bias, &invalidated_nodes, &nodes_to_delete));
       continue;
@@ -1818,7 +1881,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBiasAddAndActivation contract_with_bias_and_activation;
     if (allow_non_differentiable_rewrites &&
         FindContractionWithBiasAndActivation(
-            ctx, i, &contract_with_bias_and_activation)) {
+            ctx, i, &contract_with_bias_and_activation) &&
+        IsFusionProfitable(ctx, contract_with_bias_and_activation)) {
       TF_RETURN_IF_ERROR(
           AddFusedContractionNode(&ctx, contract_with_bias_and_activation,
                                   &invalidated_nodes, &nodes_to_delete));
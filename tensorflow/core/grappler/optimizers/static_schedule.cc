@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
+#include <algorithm>
 #include <deque>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -23,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 
@@ -199,5 +204,36 @@ Status EstimateRequiredTimes(
   return Status::OK();
 }
 
+Status BreakCompletionTimeTies(
+    const GraphDef& graph,
+    std::unordered_map<string, Costs::NanoSeconds>* completion_times) {
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(graph, &topo_order));
+
+  std::vector<std::pair<Costs::NanoSeconds, int>> times;
+  times.reserve(completion_times->size());
+  for (int i = 0, end = topo_order.size(); i < end; ++i) {
+    auto it = completion_times->find(topo_order[i]->name());
+    if (it != completion_times->end()) {
+      times.emplace_back(it->second, i);
+    }
+  }
+  std::sort(times.begin(), times.end());
+
+  // Shift each time past the previous one. This keeps the order given by the
+  // sort, and a node sorts after its fanins since it doesn't complete before
+  // them and has a larger topological index.
+  Costs::NanoSeconds previous = Costs::NanoSeconds::min();
+  for (const auto& time : times) {
+    Costs::NanoSeconds completion_time = time.first;
+    if (completion_time <= previous) {
+      completion_time = previous + Costs::NanoSeconds(1);
+    }
+    (*completion_times)[topo_order[time.second]->name()] = completion_time;
+    previous = completion_time;
+  }
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
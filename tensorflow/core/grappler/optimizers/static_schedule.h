@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_SCHEDULE_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_SCHEDULE_H_
 
+#include <string>
 #include <unordered_map>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -44,6 +45,15 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Makes the completion times of the nodes of `graph` in `completion_times`
+// distinct, e.g. after reading them from a step trace with microsecond
+// granularity. Nodes with the same time are ordered by their topological
+// index, so that each node completes strictly after its fanins. Nodes that
+// are not in `completion_times` are ignored.
+Status BreakCompletionTimeTies(
+    const GraphDef& graph,
+    std::unordered_map<string, Costs::NanoSeconds>* completion_times);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
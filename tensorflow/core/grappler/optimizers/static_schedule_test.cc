@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
+#include <algorithm>
+#include <set>
+
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
@@ -196,6 +199,41 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
                                       "Sign_2", "Sign_3", "y"}));
 }
 
+TEST_F(StaticScheduleTest, BreakCompletionTimeTies) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  Output b = ops::Sign(s.WithOpName("b"), a);
+  Output c = ops::Sign(s.WithOpName("c"), b);
+  Output d = ops::Const(s.WithOpName("d"), 2.0f, {});
+  Output e = ops::Sign(s.WithOpName("e"), d);
+  GraphDef graph;
+  TF_CHECK_OK(s.ToGraphDef(&graph));
+  // List the fanouts before their fanins, so that the order of the nodes in
+  // the graph can't be what orders them.
+  std::reverse(graph.mutable_node()->begin(), graph.mutable_node()->end());
+
+  // The simulated trace has microsecond granularity.
+  std::unordered_map<string, Costs::NanoSeconds> completion_times = {
+      {"a", Costs::MicroSeconds(5)},
+      {"b", Costs::MicroSeconds(5)},
+      {"c", Costs::MicroSeconds(5)},
+      {"d", Costs::MicroSeconds(5)},
+      {"e", Costs::MicroSeconds(7)}};
+  TF_ASSERT_OK(BreakCompletionTimeTies(graph, &completion_times));
+
+  EXPECT_EQ(5, completion_times.size());
+  EXPECT_GT(completion_times["b"], completion_times["a"]);
+  EXPECT_GT(completion_times["c"], completion_times["b"]);
+  EXPECT_EQ(Costs::MicroSeconds(7), completion_times["e"]);
+  std::set<Costs::NanoSeconds> tied_times;
+  for (const string& name : {"a", "b", "c", "d"}) {
+    EXPECT_GE(completion_times[name], Costs::MicroSeconds(5)) << name;
+    EXPECT_LT(completion_times[name], Costs::MicroSeconds(6)) << name;
+    tied_times.insert(completion_times[name]);
+  }
+  EXPECT_EQ(4, tied_times.size());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -172,8 +173,7 @@ class NodeMapInternal {
   }
 
   NodeDefT* GetNode(const string& name) const {
-    const string node_name = NodeName(name);
-    auto it = nodes_.find(node_name);
+    auto it = nodes_.find(NodeNameAsStringPiece(name));
     if (it == nodes_.end()) {
       VLOG(1) << "Node could not be found: " << name;
       return nullptr;
@@ -182,8 +182,7 @@ class NodeMapInternal {
   }
 
   bool NodeExists(const string& name) const {
-    const string node_name = NodeName(name);
-    return nodes_.find(node_name) != nodes_.end();
+    return nodes_.find(NodeNameAsStringPiece(name)) != nodes_.end();
   }
 
   void AddOutput(const string& node_name, const string& output_name) {
@@ -224,7 +223,7 @@ class NodeMapInternal {
   NodeDefT* GetNodeDefFromGraph(GraphDefT* graph, int64 i) const;
 
   const absl::flat_hash_set<NodeDefT*> empty_set_;
-  absl::node_hash_map<string, NodeDefT*> nodes_;
+  absl::flat_hash_map<string, NodeDefT*> nodes_;
   absl::node_hash_map<string, absl::flat_hash_set<NodeDefT*>> outputs_;
 };
 }  // namespace internal
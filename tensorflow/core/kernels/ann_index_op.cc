@@ -0,0 +1,648 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Approximate nearest neighbor search by inner product, over an inverted file
+// (IVF) index whose vectors are compressed by product quantization (PQ).
+//
+// The vectors are split between the partitions of a k-means of the training
+// vectors. Each vector is stored as the codes of its residual to the centroid
+// of its partition in `num_subspaces` sub-codebooks of 256 codewords. A search
+// scans the partitions of the `num_probes` centroids closest to the query, and
+// scores their vectors with a table of the inner products of the query with
+// every codeword.
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Codewords per sub-codebook, so that codes are bytes.
+constexpr int kNumCodes = 256;
+constexpr int kNumKMeansIterations = 10;
+
+float Dot(const float* a, const float* b, int64 size) {
+  // Independent partial sums let the compiler vectorize the loop.
+  float sums[4] = {0, 0, 0, 0};
+  int64 i = 0;
+  for (; i + 4 <= size; i += 4) {
+    sums[0] += a[i] * b[i];
+    sums[1] += a[i + 1] * b[i + 1];
+    sums[2] += a[i + 2] * b[i + 2];
+    sums[3] += a[i + 3] * b[i + 3];
+  }
+  for (; i < size; ++i) {
+    sums[0] += a[i] * b[i];
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// Returns the index of the closest of the `k` [k, dim] `centroids` to `x` in
+// L2 distance, given the squared `norms` of the centroids.
+int32 Nearest(const float* x, const float* centroids, const float* norms,
+              int k, int64 dim) {
+  int32 best = 0;
+  float best_distance = std::numeric_limits<float>::infinity();
+  for (int j = 0; j < k; ++j) {
+    // ||x - c||^2 - ||x||^2
+    const float distance = norms[j] - 2 * Dot(x, centroids + j * dim, dim);
+    if (distance < best_distance) {
+      best_distance = distance;
+      best = j;
+    }
+  }
+  return best;
+}
+
+void SquaredNorms(const float* centroids, int k, int64 dim, float* norms) {
+  for (int j = 0; j < k; ++j) {
+    norms[j] = Dot(centroids + j * dim, centroids + j * dim, dim);
+  }
+}
+
+// Clusters the `n` vectors of size `dim` starting every `stride` floats of
+// `data` into the `k` [k, dim] `centroids`, with Lloyd iterations started from
+// evenly spaced vectors. A centroid left without vectors stays in place.
+void KMeans(const DeviceBase::CpuWorkerThreads& workers, const float* data,
+            int64 n, int64 dim, int64 stride, int k, float* centroids) {
+  for (int j = 0; j < k; ++j) {
+    const float* x = data + (j * n / k) * stride;
+    std::copy(x, x + dim, centroids + j * dim);
+  }
+  std::vector<int32> assignments(n);
+  std::vector<float> norms(k);
+  std::vector<double> sums(k * dim);
+  std::vector<int64> counts(k);
+  for (int iteration = 0; iteration < kNumKMeansIterations; ++iteration) {
+    SquaredNorms(centroids, k, dim, norms.data());
+    Shard(workers.num_threads, workers.workers, n, 2 * k * dim,
+          [&](int64 start, int64 limit) {
+            for (int64 i = start; i < limit; ++i) {
+              assignments[i] =
+                  Nearest(data + i * stride, centroids, norms.data(), k, dim);
+            }
+          });
+    std::fill(sums.begin(), sums.end(), 0);
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int64 i = 0; i < n; ++i) {
+      const float* x = data + i * stride;
+      double* sum = &sums[assignments[i] * dim];
+      for (int64 d = 0; d < dim; ++d) {
+        sum[d] += x[d];
+      }
+      ++counts[assignments[i]];
+    }
+    for (int j = 0; j < k; ++j) {
+      if (counts[j] == 0) continue;
+      for (int64 d = 0; d < dim; ++d) {
+        centroids[j * dim + d] = sums[j * dim + d] / counts[j];
+      }
+    }
+  }
+}
+
+// Orders the candidates of a search by decreasing score.
+struct ScoreGreater {
+  bool operator()(const std::pair<float, int64>& a,
+                  const std::pair<float, int64>& b) const {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  }
+};
+
+}  // namespace
+
+class AnnIndex : public ResourceBase {
+ public:
+  AnnIndex(int64 dim, int64 num_partitions, int64 num_subspaces)
+      : dim_(dim),
+        num_partitions_(num_partitions),
+        num_subspaces_(num_subspaces),
+        subspace_dim_(dim / num_subspaces) {}
+
+  string DebugString() const override {
+    return strings::StrCat("AnnIndex(dim=", dim_,
+                           ", num_partitions=", num_partitions_,
+                           ", num_subspaces=", num_subspaces_, ")");
+  }
+
+  int64 MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    int64 bytes = sizeof(float) * (centroids_.size() + codebooks_.size());
+    for (const Partition& p : partitions_) {
+      bytes += sizeof(int64) * p.ids.size() + p.codes.size();
+    }
+    return bytes;
+  }
+
+  bool Matches(int64 dim, int64 num_partitions, int64 num_subspaces) const {
+    return dim == dim_ && num_partitions == num_partitions_ &&
+           num_subspaces == num_subspaces_;
+  }
+
+  // Trains the partitions and the sub-codebooks on the [n, dim] `vectors`,
+  // and empties the index.
+  Status Build(OpKernelContext* ctx, const Tensor& vectors) {
+    TF_RETURN_IF_ERROR(CheckVectors(vectors, "vectors"));
+    const int64 n = vectors.dim_size(0);
+    if (n == 0) {
+      return errors::InvalidArgument("An AnnIndex needs vectors to be built");
+    }
+    const auto& workers = *ctx->device()->tensorflow_cpu_worker_threads();
+    const float* data = vectors.flat<float>().data();
+
+    std::vector<float> centroids(num_partitions_ * dim_);
+    KMeans(workers, data, n, dim_, dim_, num_partitions_, centroids.data());
+
+    // The codebooks are trained on the residuals of the vectors to their
+    // partition, like the vectors they will encode.
+    std::vector<float> norms(num_partitions_);
+    SquaredNorms(centroids.data(), num_partitions_, dim_, norms.data());
+    std::vector<float> residuals(n * dim_);
+    Shard(workers.num_threads, workers.workers, n, 2 * num_partitions_ * dim_,
+          [&](int64 start, int64 limit) {
+            for (int64 i = start; i < limit; ++i) {
+              const float* x = data + i * dim_;
+              const float* c =
+                  centroids.data() + Nearest(x, centroids.data(), norms.data(),
+                                             num_partitions_, dim_) *
+                                         dim_;
+              for (int64 d = 0; d < dim_; ++d) {
+                residuals[i * dim_ + d] = x[d] - c[d];
+              }
+            }
+          });
+    std::vector<float> codebooks(num_subspaces_ * kNumCodes * subspace_dim_);
+    for (int64 s = 0; s < num_subspaces_; ++s) {
+      KMeans(workers, residuals.data() + s * subspace_dim_, n, subspace_dim_,
+             dim_, kNumCodes,
+             codebooks.data() + s * kNumCodes * subspace_dim_);
+    }
+
+    mutex_lock l(mu_);
+    centroids_ = std::move(centroids);
+    codebooks_ = std::move(codebooks);
+    partitions_.clear();
+    partitions_.resize(num_partitions_);
+    return Status::OK();
+  }
+
+  // Adds the [n, dim] `vectors` under the [n] `ids`.
+  Status Add(OpKernelContext* ctx, const Tensor& vectors, const Tensor& ids) {
+    TF_RETURN_IF_ERROR(CheckVectors(vectors, "vectors"));
+    const int64 n = vectors.dim_size(0);
+    if (!TensorShapeUtils::IsVector(ids.shape()) || ids.dim_size(0) != n) {
+      return errors::InvalidArgument("ids must be a vector of ", n,
+                                     " elements, got shape ",
+                                     ids.shape().DebugString());
+    }
+    const auto& workers = *ctx->device()->tensorflow_cpu_worker_threads();
+    const float* data = vectors.flat<float>().data();
+    const auto ids_flat = ids.flat<int64>();
+
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(CheckBuilt());
+    std::vector<float> centroid_norms(num_partitions_);
+    SquaredNorms(centroids_.data(), num_partitions_, dim_,
+                 centroid_norms.data());
+    std::vector<float> codeword_norms(num_subspaces_ * kNumCodes);
+    for (int64 s = 0; s < num_subspaces_; ++s) {
+      SquaredNorms(codebooks_.data() + s * kNumCodes * subspace_dim_,
+                   kNumCodes, subspace_dim_,
+                   codeword_norms.data() + s * kNumCodes);
+    }
+    // The shards read the index through these, under the lock held here.
+    const float* centroids = centroids_.data();
+    const float* codebooks = codebooks_.data();
+    std::vector<int32> assignments(n);
+    std::vector<uint8> codes(n * num_subspaces_);
+    Shard(workers.num_threads, workers.workers, n,
+          2 * (num_partitions_ + kNumCodes) * dim_,
+          [&](int64 start, int64 limit) {
+            std::vector<float> residual(dim_);
+            for (int64 i = start; i < limit; ++i) {
+              const float* x = data + i * dim_;
+              assignments[i] = Nearest(x, centroids, centroid_norms.data(),
+                                       num_partitions_, dim_);
+              const float* c = centroids + assignments[i] * dim_;
+              for (int64 d = 0; d < dim_; ++d) {
+                residual[d] = x[d] - c[d];
+              }
+              for (int64 s = 0; s < num_subspaces_; ++s) {
+                codes[i * num_subspaces_ + s] = Nearest(
+                    residual.data() + s * subspace_dim_,
+                    codebooks + s * kNumCodes * subspace_dim_,
+                    codeword_norms.data() + s * kNumCodes, kNumCodes,
+                    subspace_dim_);
+              }
+            }
+          });
+    for (int64 i = 0; i < n; ++i) {
+      Partition& p = partitions_[assignments[i]];
+      p.ids.push_back(ids_flat(i));
+      p.codes.insert(p.codes.end(), codes.begin() + i * num_subspaces_,
+                     codes.begin() + (i + 1) * num_subspaces_);
+    }
+    return Status::OK();
+  }
+
+  // Writes to the [q, k] `scores` and `ids` the approximate top `k` vectors
+  // by inner product with each of the [q, dim] `queries`, scanning the
+  // `num_probes` partitions closest to the query. Missing results have the
+  // id -1 and the score -inf.
+  Status Search(OpKernelContext* ctx, const Tensor& queries, int k,
+                int num_probes, Tensor* scores, Tensor* ids) const {
+    TF_RETURN_IF_ERROR(CheckVectors(queries, "queries"));
+    const int64 num_queries = queries.dim_size(0);
+    const auto& workers = *ctx->device()->tensorflow_cpu_worker_threads();
+    const float* data = queries.flat<float>().data();
+    auto scores_matrix = scores->matrix<float>();
+    auto ids_matrix = ids->matrix<int64>();
+
+    tf_shared_lock l(mu_);
+    TF_RETURN_IF_ERROR(CheckBuilt());
+    num_probes = std::min<int64>(num_probes, num_partitions_);
+    int64 num_vectors = 0;
+    for (const Partition& p : partitions_) {
+      num_vectors += p.ids.size();
+    }
+    // The shards read the index through these, under the lock held here.
+    const float* centroids = centroids_.data();
+    const float* codebooks = codebooks_.data();
+    const std::vector<Partition>& partitions = partitions_;
+    const int64 cost_per_query =
+        2 * (num_partitions_ + kNumCodes) * dim_ +
+        2 * num_subspaces_ * num_vectors * num_probes / num_partitions_;
+    Shard(
+        workers.num_threads, workers.workers, num_queries, cost_per_query,
+        [&](int64 start, int64 limit) {
+          std::vector<float> partition_scores(num_partitions_);
+          std::vector<int32> probes(num_partitions_);
+          std::vector<float> table(num_subspaces_ * kNumCodes);
+          for (int64 q = start; q < limit; ++q) {
+            const float* query = data + q * dim_;
+            for (int64 j = 0; j < num_partitions_; ++j) {
+              partition_scores[j] = Dot(query, centroids + j * dim_, dim_);
+            }
+            std::iota(probes.begin(), probes.end(), 0);
+            std::partial_sort(probes.begin(), probes.begin() + num_probes,
+                              probes.end(), [&](int32 a, int32 b) {
+                                return partition_scores[a] >
+                                       partition_scores[b];
+                              });
+            // The inner product of the query with a vector is that with its
+            // centroid, plus those of the query subvectors with the codewords
+            // of the residual.
+            for (int64 s = 0; s < num_subspaces_; ++s) {
+              for (int c = 0; c < kNumCodes; ++c) {
+                table[s * kNumCodes + c] =
+                    Dot(query + s * subspace_dim_,
+                        codebooks + (s * kNumCodes + c) * subspace_dim_,
+                        subspace_dim_);
+              }
+            }
+
+            gtl::TopN<std::pair<float, int64>, ScoreGreater> top(k);
+            for (int probe = 0; probe < num_probes; ++probe) {
+              const Partition& p = partitions[probes[probe]];
+              const float base = partition_scores[probes[probe]];
+              const uint8* codes = p.codes.data();
+              for (size_t e = 0; e < p.ids.size(); ++e) {
+                float score = base;
+                for (int64 s = 0; s < num_subspaces_; ++s) {
+                  score += table[s * kNumCodes + codes[s]];
+                }
+                codes += num_subspaces_;
+                if (top.size() < static_cast<size_t>(k) ||
+                    score > top.peek_bottom().first) {
+                  top.push(std::make_pair(score, p.ids[e]));
+                }
+              }
+            }
+            std::unique_ptr<std::vector<std::pair<float, int64>>> results(
+                top.Extract());
+            for (int i = 0; i < k; ++i) {
+              if (i < static_cast<int>(results->size())) {
+                scores_matrix(q, i) = (*results)[i].first;
+                ids_matrix(q, i) = (*results)[i].second;
+              } else {
+                scores_matrix(q, i) = -std::numeric_limits<float>::infinity();
+                ids_matrix(q, i) = -1;
+              }
+            }
+          }
+        });
+    return Status::OK();
+  }
+
+  // Writes the index to a tensor bundle under `prefix`.
+  Status Save(Env* env, const string& prefix) const {
+    tf_shared_lock l(mu_);
+    TF_RETURN_IF_ERROR(CheckBuilt());
+    int64 num_vectors = 0;
+    for (const Partition& p : partitions_) {
+      num_vectors += p.ids.size();
+    }
+    Tensor config(DT_INT64, TensorShape({3}));
+    config.vec<int64>()(0) = dim_;
+    config.vec<int64>()(1) = num_partitions_;
+    config.vec<int64>()(2) = num_subspaces_;
+    Tensor centroids(DT_FLOAT, TensorShape({num_partitions_, dim_}));
+    std::copy(centroids_.begin(), centroids_.end(),
+              centroids.flat<float>().data());
+    Tensor codebooks(DT_FLOAT,
+                     TensorShape({num_subspaces_, kNumCodes, subspace_dim_}));
+    std::copy(codebooks_.begin(), codebooks_.end(),
+              codebooks.flat<float>().data());
+    Tensor partition_sizes(DT_INT64, TensorShape({num_partitions_}));
+    Tensor ids(DT_INT64, TensorShape({num_vectors}));
+    Tensor codes(DT_UINT8, TensorShape({num_vectors, num_subspaces_}));
+    int64* ids_out = ids.flat<int64>().data();
+    uint8* codes_out = codes.flat<uint8>().data();
+    for (int64 j = 0; j < num_partitions_; ++j) {
+      const Partition& p = partitions_[j];
+      partition_sizes.vec<int64>()(j) = p.ids.size();
+      ids_out = std::copy(p.ids.begin(), p.ids.end(), ids_out);
+      codes_out = std::copy(p.codes.begin(), p.codes.end(), codes_out);
+    }
+
+    BundleWriter writer(env, prefix);
+    TF_RETURN_IF_ERROR(writer.Add("config", config));
+    TF_RETURN_IF_ERROR(writer.Add("centroids", centroids));
+    TF_RETURN_IF_ERROR(writer.Add("codebooks", codebooks));
+    TF_RETURN_IF_ERROR(writer.Add("partition_sizes", partition_sizes));
+    TF_RETURN_IF_ERROR(writer.Add("ids", ids));
+    TF_RETURN_IF_ERROR(writer.Add("codes", codes));
+    return writer.Finish();
+  }
+
+  // Replaces the index by the one saved under `prefix`.
+  Status Restore(Env* env, const string& prefix) {
+    BundleReader reader(env, prefix);
+    TF_RETURN_IF_ERROR(reader.status());
+    Tensor config, centroids, codebooks, partition_sizes, ids, codes;
+    TF_RETURN_IF_ERROR(reader.Lookup("config", &config));
+    if (config.dtype() != DT_INT64 || config.NumElements() != 3 ||
+        !Matches(config.flat<int64>()(0), config.flat<int64>()(1),
+                 config.flat<int64>()(2))) {
+      return errors::InvalidArgument("The AnnIndex saved under ", prefix,
+                                     " has another configuration than ",
+                                     DebugString());
+    }
+    TF_RETURN_IF_ERROR(reader.Lookup("centroids", &centroids));
+    TF_RETURN_IF_ERROR(reader.Lookup("codebooks", &codebooks));
+    TF_RETURN_IF_ERROR(reader.Lookup("partition_sizes", &partition_sizes));
+    TF_RETURN_IF_ERROR(reader.Lookup("ids", &ids));
+    TF_RETURN_IF_ERROR(reader.Lookup("codes", &codes));
+    const int64 num_vectors = ids.NumElements();
+    if (centroids.dtype() != DT_FLOAT || codebooks.dtype() != DT_FLOAT ||
+        partition_sizes.dtype() != DT_INT64 || ids.dtype() != DT_INT64 ||
+        codes.dtype() != DT_UINT8 ||
+        centroids.NumElements() != num_partitions_ * dim_ ||
+        codebooks.NumElements() != num_subspaces_ * kNumCodes * subspace_dim_ ||
+        partition_sizes.NumElements() != num_partitions_ ||
+        codes.NumElements() != num_vectors * num_subspaces_) {
+      return errors::DataLoss("The AnnIndex saved under ", prefix,
+                              " is inconsistent");
+    }
+    const auto sizes = partition_sizes.flat<int64>();
+    int64 total_size = 0;
+    for (int64 j = 0; j < num_partitions_; ++j) {
+      if (sizes(j) < 0) {
+        return errors::DataLoss("The AnnIndex saved under ", prefix,
+                                " has a partition of negative size");
+      }
+      total_size += sizes(j);
+    }
+    if (total_size != num_vectors) {
+      return errors::DataLoss("The AnnIndex saved under ", prefix, " has ",
+                              num_vectors, " vectors but partitions of ",
+                              total_size);
+    }
+
+    std::vector<Partition> partitions(num_partitions_);
+    const int64* ids_in = ids.flat<int64>().data();
+    const uint8* codes_in = codes.flat<uint8>().data();
+    for (int64 j = 0; j < num_partitions_; ++j) {
+      partitions[j].ids.assign(ids_in, ids_in + sizes(j));
+      partitions[j].codes.assign(codes_in,
+                                 codes_in + sizes(j) * num_subspaces_);
+      ids_in += sizes(j);
+      codes_in += sizes(j) * num_subspaces_;
+    }
+    const float* centroids_in = centroids.flat<float>().data();
+    const float* codebooks_in = codebooks.flat<float>().data();
+
+    mutex_lock l(mu_);
+    centroids_.assign(centroids_in, centroids_in + centroids.NumElements());
+    codebooks_.assign(codebooks_in, codebooks_in + codebooks.NumElements());
+    partitions_ = std::move(partitions);
+    return Status::OK();
+  }
+
+ private:
+  struct Partition {
+    std::vector<int64> ids;
+    // The num_subspaces codes of each vector, in the order of `ids`.
+    std::vector<uint8> codes;
+  };
+
+  Status CheckVectors(const Tensor& vectors, const char* name) const {
+    if (!TensorShapeUtils::IsMatrix(vectors.shape()) ||
+        vectors.dim_size(1) != dim_) {
+      return errors::InvalidArgument(name, " must be a matrix of ", dim_,
+                                     " columns, got shape ",
+                                     vectors.shape().DebugString());
+    }
+    return Status::OK();
+  }
+
+  Status CheckBuilt() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    if (centroids_.empty()) {
+      return errors::FailedPrecondition(DebugString(),
+                                        " has not been built or restored");
+    }
+    return Status::OK();
+  }
+
+  const int64 dim_;
+  const int64 num_partitions_;
+  const int64 num_subspaces_;
+  const int64 subspace_dim_;
+
+  mutable mutex mu_;
+  // [num_partitions, dim], empty until the index is built.
+  std::vector<float> centroids_ TF_GUARDED_BY(mu_);
+  // [num_subspaces, kNumCodes, subspace_dim]
+  std::vector<float> codebooks_ TF_GUARDED_BY(mu_);
+  std::vector<Partition> partitions_ TF_GUARDED_BY(mu_);
+};
+
+class AnnIndexOp : public ResourceOpKernel<AnnIndex> {
+ public:
+  explicit AnnIndexOp(OpKernelConstruction* ctx) : ResourceOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dim", &dim_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_partitions", &num_partitions_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_subspaces", &num_subspaces_));
+    OP_REQUIRES(ctx, dim_ % num_subspaces_ == 0,
+                errors::InvalidArgument("num_subspaces (", num_subspaces_,
+                                        ") must divide dim (", dim_, ")"));
+  }
+
+ private:
+  Status CreateResource(AnnIndex** index)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) override {
+    *index = new AnnIndex(dim_, num_partitions_, num_subspaces_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(AnnIndex* index) override {
+    if (!index->Matches(dim_, num_partitions_, num_subspaces_)) {
+      return errors::InvalidArgument("Shared AnnIndex ", cinfo_.name(),
+                                     " has another configuration: ",
+                                     index->DebugString());
+    }
+    return Status::OK();
+  }
+
+  int64 dim_;
+  int64 num_partitions_;
+  int64 num_subspaces_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndex").Device(DEVICE_CPU), AnnIndexOp);
+
+class AnnIndexBuildOp : public OpKernel {
+ public:
+  explicit AnnIndexBuildOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<AnnIndex> index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    OP_REQUIRES_OK(ctx, index->Build(ctx, ctx->input(1)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexBuild").Device(DEVICE_CPU),
+                        AnnIndexBuildOp);
+
+class AnnIndexAddOp : public OpKernel {
+ public:
+  explicit AnnIndexAddOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<AnnIndex> index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    OP_REQUIRES_OK(ctx, index->Add(ctx, ctx->input(1), ctx->input(2)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexAdd").Device(DEVICE_CPU), AnnIndexAddOp);
+
+class AnnIndexSearchOp : public OpKernel {
+ public:
+  explicit AnnIndexSearchOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<AnnIndex> index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    const Tensor& queries = ctx->input(1);
+    const Tensor& k_in = ctx->input(2);
+    const Tensor& num_probes_in = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(k_in.shape()),
+                errors::InvalidArgument("k must be a scalar, got shape ",
+                                        k_in.shape().DebugString()));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(num_probes_in.shape()),
+        errors::InvalidArgument("num_probes must be a scalar, got shape ",
+                                num_probes_in.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(queries.shape()),
+                errors::InvalidArgument("queries must be a matrix, got shape ",
+                                        queries.shape().DebugString()));
+    const int32 k = k_in.scalar<int32>()();
+    const int32 num_probes = num_probes_in.scalar<int32>()();
+    OP_REQUIRES(ctx, k >= 0, errors::InvalidArgument("Need k >= 0, got ", k));
+    OP_REQUIRES(ctx, num_probes >= 1,
+                errors::InvalidArgument("Need num_probes >= 1, got ",
+                                        num_probes));
+
+    const TensorShape output_shape({queries.dim_size(0), k});
+    Tensor* scores = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &scores));
+    Tensor* ids = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, output_shape, &ids));
+    OP_REQUIRES_OK(ctx,
+                   index->Search(ctx, queries, k, num_probes, scores, ids));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexSearch").Device(DEVICE_CPU),
+                        AnnIndexSearchOp);
+
+class AnnIndexSaveOp : public OpKernel {
+ public:
+  explicit AnnIndexSaveOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<AnnIndex> index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    const Tensor& prefix = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(prefix.shape()),
+                errors::InvalidArgument("prefix must be a scalar, got shape ",
+                                        prefix.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, index->Save(ctx->env(), prefix.scalar<tstring>()()));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexSave").Device(DEVICE_CPU),
+                        AnnIndexSaveOp);
+
+class AnnIndexRestoreOp : public OpKernel {
+ public:
+  explicit AnnIndexRestoreOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<AnnIndex> index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    const Tensor& prefix = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(prefix.shape()),
+                errors::InvalidArgument("prefix must be a scalar, got shape ",
+                                        prefix.shape().DebugString()));
+    OP_REQUIRES_OK(ctx,
+                   index->Restore(ctx->env(), prefix.scalar<tstring>()()));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexRestore").Device(DEVICE_CPU),
+                        AnnIndexRestoreOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,207 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kDim = 8;
+constexpr int64 kNumVectors = 1000;
+constexpr int kK = 10;
+
+// Returns `n` random unit vectors, so that each is its own best match.
+Tensor UnitVectors(int64 n) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor vectors(DT_FLOAT, TensorShape({n, kDim}));
+  auto matrix = vectors.matrix<float>();
+  for (int64 i = 0; i < n; ++i) {
+    float norm = 0;
+    for (int64 d = 0; d < kDim; ++d) {
+      matrix(i, d) = rnd.Normal(1.0);
+      norm += matrix(i, d) * matrix(i, d);
+    }
+    for (int64 d = 0; d < kDim; ++d) {
+      matrix(i, d) /= std::sqrt(norm);
+    }
+  }
+  return vectors;
+}
+
+Tensor Ids(int64 n) {
+  Tensor ids(DT_INT64, TensorShape({n}));
+  for (int64 i = 0; i < n; ++i) {
+    ids.flat<int64>()(i) = 100 + i;
+  }
+  return ids;
+}
+
+class AnnIndexOpTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // "index" is filled by the tests, and "restored" only by restoring it.
+    Graph g(OpRegistry::Global());
+    Node* index;
+    TF_ASSERT_OK(NodeBuilder("index", "AnnIndex")
+                     .Attr("dim", kDim)
+                     .Attr("num_partitions", 4)
+                     .Attr("num_subspaces", 4)
+                     .Finalize(&g, &index));
+    Node* restored;
+    TF_ASSERT_OK(NodeBuilder("restored", "AnnIndex")
+                     .Attr("dim", kDim)
+                     .Attr("num_partitions", 4)
+                     .Attr("num_subspaces", 4)
+                     .Finalize(&g, &restored));
+    Node* vectors = test::graph::Placeholder(&g, DT_FLOAT);
+    Node* ids = test::graph::Placeholder(&g, DT_INT64);
+    Node* num_probes = test::graph::Placeholder(&g, DT_INT32);
+    Node* prefix = test::graph::Constant(
+        &g, test::AsScalar<tstring>(io::JoinPath(testing::TmpDir(), "ann")));
+    Node* k = test::graph::Constant(&g, test::AsScalar<int32>(kK));
+    Node* node;
+    TF_ASSERT_OK(NodeBuilder("build", "AnnIndexBuild")
+                     .Input(index)
+                     .Input(vectors)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("add", "AnnIndexAdd")
+                     .Input(index)
+                     .Input(vectors)
+                     .Input(ids)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("search", "AnnIndexSearch")
+                     .Input(index)
+                     .Input(vectors)
+                     .Input(k)
+                     .Input(num_probes)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("search_restored", "AnnIndexSearch")
+                     .Input(restored)
+                     .Input(vectors)
+                     .Input(k)
+                     .Input(num_probes)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("save", "AnnIndexSave")
+                     .Input(index)
+                     .Input(prefix)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("restore", "AnnIndexRestore")
+                     .Input(restored)
+                     .Input(prefix)
+                     .Finalize(&g, &node));
+    vectors_ = vectors->name();
+    ids_ = ids->name();
+    num_probes_ = num_probes->name();
+
+    GraphDef graph_def;
+    g.ToGraphDef(&graph_def);
+    session_.reset(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session_->Create(graph_def));
+  }
+
+  Status Run(const string& op, const Tensor& vectors, const Tensor& ids) {
+    return session_->Run({{vectors_, vectors}, {ids_, ids}}, {}, {op},
+                         nullptr);
+  }
+
+  // Returns the scores and ids found for `queries`.
+  std::vector<Tensor> Search(const string& op, const Tensor& queries,
+                             int num_probes) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run(
+        {{vectors_, queries}, {num_probes_, test::AsScalar<int32>(num_probes)}},
+        {op + ":0", op + ":1"}, {}, &outputs));
+    return outputs;
+  }
+
+  string vectors_;
+  string ids_;
+  string num_probes_;
+  std::unique_ptr<Session> session_;
+};
+
+TEST_F(AnnIndexOpTest, FindsIndexedVectors) {
+  const Tensor vectors = UnitVectors(kNumVectors);
+  TF_ASSERT_OK(session_->Run({{vectors_, vectors}}, {}, {"build"}, nullptr));
+  TF_ASSERT_OK(Run("add", vectors, Ids(kNumVectors)));
+
+  // Searching every partition, the scores only suffer from quantization.
+  const std::vector<Tensor> outputs = Search("search", vectors, 4);
+  ASSERT_EQ(TensorShape({kNumVectors, kK}), outputs[0].shape());
+  const auto scores = outputs[0].matrix<float>();
+  const auto ids = outputs[1].matrix<int64>();
+  int64 found = 0;
+  for (int64 q = 0; q < kNumVectors; ++q) {
+    for (int j = 0; j < kK; ++j) {
+      if (j > 0) EXPECT_GE(scores(q, j - 1), scores(q, j));
+      if (ids(q, j) == 100 + q) ++found;
+    }
+  }
+  EXPECT_GE(found, 0.9 * kNumVectors);
+}
+
+TEST_F(AnnIndexOpTest, PadsMissingResults) {
+  const Tensor vectors = UnitVectors(3);
+  TF_ASSERT_OK(session_->Run({{vectors_, vectors}}, {}, {"build"}, nullptr));
+  TF_ASSERT_OK(Run("add", vectors, Ids(3)));
+  const std::vector<Tensor> outputs = Search("search", vectors, 4);
+  for (int64 q = 0; q < 3; ++q) {
+    for (int j = 3; j < kK; ++j) {
+      EXPECT_EQ(-1, outputs[1].matrix<int64>()(q, j));
+      EXPECT_EQ(-std::numeric_limits<float>::infinity(),
+                outputs[0].matrix<float>()(q, j));
+    }
+  }
+}
+
+TEST_F(AnnIndexOpTest, SaveAndRestore) {
+  const Tensor vectors = UnitVectors(kNumVectors);
+  TF_ASSERT_OK(session_->Run({{vectors_, vectors}}, {}, {"build"}, nullptr));
+  TF_ASSERT_OK(Run("add", vectors, Ids(kNumVectors)));
+  TF_ASSERT_OK(session_->Run({}, {}, {"save"}, nullptr));
+  TF_ASSERT_OK(session_->Run({}, {}, {"restore"}, nullptr));
+
+  const std::vector<Tensor> expected = Search("search", vectors, 2);
+  const std::vector<Tensor> restored = Search("search_restored", vectors, 2);
+  test::ExpectTensorEqual<float>(expected[0], restored[0]);
+  test::ExpectTensorEqual<int64>(expected[1], restored[1]);
+}
+
+TEST_F(AnnIndexOpTest, SearchBeforeBuild) {
+  std::vector<Tensor> outputs;
+  Status s = session_->Run({{vectors_, UnitVectors(1)},
+                            {num_probes_, test::AsScalar<int32>(1)}},
+                           {"search:0"}, {}, &outputs);
+  EXPECT_TRUE(errors::IsFailedPrecondition(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
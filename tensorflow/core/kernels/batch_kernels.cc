@@ -70,6 +70,7 @@ class BatchResource : public serving::BatchResourceBase {
                        const std::vector<int32>& allowed_batch_sizes,
                        FunctionLibraryRuntime::Handle fhandle,
                        bool enable_large_batch_splitting,
+                       int32 target_latency_micros,
                        std::unique_ptr<BatchResource>* resource) {
     BatcherT::Options batcher_options;
     batcher_options.num_batch_threads = num_batch_threads;
@@ -81,7 +82,8 @@ class BatchResource : public serving::BatchResourceBase {
         GetBatcherQueueOptions(num_batch_threads, max_batch_size,
                                batch_timeout_micros, max_enqueued_batches,
                                allowed_batch_sizes,
-                               enable_large_batch_splitting),
+                               enable_large_batch_splitting,
+                               target_latency_micros),
         allowed_batch_sizes));
     return Status::OK();
   }
@@ -163,6 +165,12 @@ class BatchFunctionKernel : public AsyncOpKernel {
       enable_large_batch_splitting_ = false;
       has_attribute_enable_large_batch_splitting_ = false;
     }
+    if (c->HasAttr("target_latency_micros")) {
+      OP_REQUIRES_OK(
+          c, c->GetAttr("target_latency_micros", &target_latency_micros_));
+    } else {
+      target_latency_micros_ = 0;
+    }
 
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
   }
@@ -181,7 +189,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, fhandle_,
-          enable_large_batch_splitting_, &new_resource));
+          enable_large_batch_splitting_, target_latency_micros_,
+          &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -234,6 +243,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   FunctionLibraryRuntime::Handle fhandle_;
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
+  int32 target_latency_micros_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("BatchFunction").Device(DEVICE_CPU),
@@ -266,8 +276,9 @@ class BatchKernel : public AsyncOpKernel {
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-          max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle, false,
-          &new_resource));
+          max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
+          /*enable_large_batch_splitting=*/false,
+          /*target_latency_micros=*/0, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
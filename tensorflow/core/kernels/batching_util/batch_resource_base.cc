@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
@@ -39,6 +40,17 @@ void RecordPaddingSize(int32 padding_size, const string& model_name,
       ->Add(static_cast<double>(padding_size));
 }
 
+void RecordPaddingRatio(double padding_ratio, const string& model_name) {
+  static auto* cell = tensorflow::monitoring::PercentileSampler<1>::New(
+      {"/tensorflow/serving/batching/padding_ratio",
+       "Tracks the fraction of padding rows in processed batches by "
+       "model_name (if available).",
+       "model_name"},
+      /*percentiles=*/{25.0, 50.0, 75.0, 90.0, 95.0, 99.0},
+      /*max_samples=*/1024, tensorflow::monitoring::UnitOfMeasure::kNumber);
+  cell->GetCell(model_name)->Add(padding_ratio);
+}
+
 void RecordInputBatchSize(int32 batch_size, const string& model_name) {
   static auto* cell = tensorflow::monitoring::PercentileSampler<1>::New(
       {"/tensorflow/serving/batching/input_batch_size",
@@ -79,10 +91,41 @@ const string& GetModelName(OpKernelContext* ctx) {
   return ctx->session_metadata()->name();
 }
 
+// Returns the key of the queue, among those named 'queue_name', for tasks with
+// 'inputs'. Tasks can only be batched with tasks whose inputs have the same
+// shape beyond the 0th dimension, so e.g. inputs of each sequence length are
+// batched in their own queue.
+string BatcherQueueKey(const string& queue_name,
+                       const std::vector<Tensor>& inputs) {
+  string key = queue_name;
+  for (const Tensor& input : inputs) {
+    absl::StrAppend(&key, ";");
+    for (int d = 1; d < input.dims(); ++d) {
+      absl::StrAppend(&key, input.dim_size(d), ",");
+    }
+  }
+  return key;
+}
+
+bool IsCancelled(OpKernelContext* context) {
+  return context->cancellation_manager() != nullptr &&
+         context->cancellation_manager()->IsCancelled();
+}
+
+// Returns rows [start, start + size) of 'tensor'. The result aliases the
+// buffer of 'tensor' if the rows are aligned, and is a copy otherwise, since
+// kernels require aligned inputs.
+Tensor SliceOrCopy(const Tensor& tensor, int64 start, int64 size) {
+  Tensor slice = tensor.Slice(start, start + size);
+  if (slice.IsAligned()) {
+    return slice;
+  }
+  return tensor::DeepCopy(slice);
+}
+
 }  // namespace
 
 using ::tensorflow::concat_split_util::Concat;
-using ::tensorflow::concat_split_util::Split;
 using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 Status BatchResourceBase::RegisterInput(
@@ -126,8 +169,9 @@ Status BatchResourceBase::RegisterInput(
   batch_components->status = std::make_shared<ThreadSafeStatus>();
 
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+      BatcherQueueKey(batcher_queue_name, batch_components->inputs),
+      &batcher_queue));
   return batcher_queue->Schedule(&batch_components);
 }
 
@@ -135,11 +179,12 @@ Status BatchResourceBase::RegisterInput(
 BatchResourceBase::GetBatcherQueueOptions(
     int32 num_batch_threads, int32 max_batch_size, int32 batch_timeout_micros,
     int32 max_enqueued_batches, const std::vector<int32>& allowed_batch_sizes,
-    bool enable_large_batch_splitting) {
+    bool enable_large_batch_splitting, int32 target_latency_micros) {
   BatcherT::QueueOptions batcher_queue_options;
   batcher_queue_options.input_batch_size_limit = max_batch_size;
   batcher_queue_options.max_enqueued_batches = max_enqueued_batches;
   batcher_queue_options.batch_timeout_micros = batch_timeout_micros;
+  batcher_queue_options.target_latency_micros = target_latency_micros;
   // Support for splitting large batch is still in progress.
   batcher_queue_options.enable_large_batch_splitting =
       enable_large_batch_splitting;
@@ -203,12 +248,20 @@ Status BatchResourceBase::ConcatInputTensors(
   const int padded_batch_size = RoundToLowestAllowedBatchSize(batch.size());
   const int padding_amount = padded_batch_size - batch.size();
   RecordPaddingSize(padding_amount, GetModelName(context), padded_batch_size);
+  RecordPaddingRatio(static_cast<double>(padding_amount) / padded_batch_size,
+                     GetModelName(context));
   RecordProcessedBatchSize(padded_batch_size, GetModelName(context));
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
 
+  // A batch of one task needs no concatenation.
+  if (batch.num_tasks() == 1 && padding_amount == 0) {
+    *concatenated_tensors = batch.task(0).inputs;
+    return Status::OK();
+  }
+
   // Process each input one at a time (the typical case has just one).
   for (int i = 0; i < num_inputs; ++i) {
     // Concatenate the tasks ith input tensors into a big output tensor.
@@ -329,31 +382,16 @@ Status BatchResourceBase::ConcatInputTensors(
   const int num_input_tensors = input_task.inputs.size();
 
   // Splits each input tensor according to `output_task_sizes`, and
-  // initializes input of `output_tasks` with split results.
+  // initializes input of `output_tasks` with split results. Split tasks that
+  // fill a batch alone are then processed without any copy.
   for (int i = 0; i < num_input_tensors; ++i) {
-    std::vector<Tensor> split_tensors;
     const Tensor& input_tensor = input_task.inputs[i];
-    // TODO(b/154140947):
-    // Figure out the optimal implementation of Split, by using
-    // 'Tensor::Slice' and eliminating unnecessary memcpy as much as possible.
-    const Status split_status = Split(input_task.context, input_tensor,
-                                      output_task_sizes, &split_tensors);
-    if (!split_status.ok()) {
-      return errors::Internal(
-          "When splitting input, Tensor split operation failed: ",
-          split_status.ToString());
-    }
-    if (split_tensors.size() != output_task_sizes.size()) {
-      return errors::Internal(
-          "When splitting input, tensor split operation did not work as "
-          "expected; got ",
-          split_tensors.size(), " splits; expected ", output_task_sizes.size());
-    }
+    int64 start = 0;
     for (int j = 0; j < output_tasks->size(); ++j) {
       BatchTask& output_task = *((*output_tasks)[j]);
-      auto moved_tensor_iter = std::next(split_tensors.begin(), j);
-      std::move(moved_tensor_iter, moved_tensor_iter + 1,
-                std::back_inserter(output_task.inputs));
+      output_task.inputs.push_back(
+          SliceOrCopy(input_tensor, start, output_task_sizes[j]));
+      start += output_task_sizes[j];
     }
   }
   return Status::OK();
@@ -401,30 +439,20 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
-    std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.ToString());
-    }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-      return errors::Internal(
-          "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
-    }
-
-    // Ignore a possible final split_tensors entry containing the padding.
+    // The outputs of tasks alias the batched output where possible, which
+    // keeps all of it alive until every task's output is released. The
+    // padding rows at the end are ignored.
+    int64 start = 0;
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
+      const int64 task_size = task_sizes_plus_optional_padding[j];
+      Tensor task_output = SliceOrCopy(output_tensor, start, task_size);
+      start += task_size;
       if (task.is_partial) {
         std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
-        tensor_vector[i] = std::move(split_tensor[j]);
+        tensor_vector[i] = std::move(task_output);
       } else {
-        task.context->set_output(i, split_tensor[j]);
+        task.context->set_output(i, std::move(task_output));
       }
     }
   }
@@ -432,7 +460,44 @@ Status BatchResourceBase::SplitOutputTensors(
   return Status::OK();
 }
 
+/*static*/ std::unique_ptr<BatchResourceBase::BatchT>
+BatchResourceBase::RemoveCancelledTasks(std::unique_ptr<BatchT> batch) {
+  bool has_cancelled_task = false;
+  for (int i = 0; i < batch->num_tasks() && !has_cancelled_task; ++i) {
+    has_cancelled_task = IsCancelled(batch->task(i).context);
+  }
+  if (!has_cancelled_task) {
+    return batch;
+  }
+
+  std::vector<std::unique_ptr<BatchTask>> tasks;
+  tasks.reserve(batch->num_tasks());
+  while (!batch->empty()) {
+    tasks.push_back(batch->RemoveTask());
+  }
+  auto remaining_batch =
+      absl::make_unique<BatchT>(batch->traceme_context_id());
+  for (auto it = tasks.rbegin(); it != tasks.rend(); ++it) {
+    BatchTask& task = **it;
+    if (!IsCancelled(task.context)) {
+      remaining_batch->AddTask(std::move(*it));
+      continue;
+    }
+    const Status status =
+        errors::Cancelled("Batched computation was cancelled before it ran");
+    if (task.is_partial) {
+      task.status->Update(status);
+    } else {
+      task.context->SetStatus(status);
+    }
+    task.done_callback();
+  }
+  remaining_batch->Close();
+  return remaining_batch;
+}
+
 void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
+  batch = RemoveCancelledTasks(std::move(batch));
   if (batch->empty()) {
     return;
   }
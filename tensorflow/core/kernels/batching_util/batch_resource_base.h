@@ -111,9 +111,11 @@ class BatchResourceBase : public ResourceBase {
   static BatcherT::QueueOptions GetBatcherQueueOptions(
       int32 num_batch_threads, int32 max_batch_size, int32 batch_timeout_micros,
       int32 max_enqueued_batches, const std::vector<int32>& allowed_batch_sizes,
-      bool enable_large_batch_splitting);
+      bool enable_large_batch_splitting, int32 target_latency_micros);
 
  private:
+  friend class BatchResourceBaseTest;
+
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
       const BatchResourceBase::BatchTask& last_task,
@@ -160,6 +162,12 @@ class BatchResourceBase : public ResourceBase {
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             BatchT* batch) const;
 
+  // Finishes the tasks of 'batch' whose step was cancelled while they were
+  // enqueued, e.g. because the deadline of the request passed, and returns
+  // the batch of the remaining tasks.
+  static std::unique_ptr<BatchT> RemoveCancelledTasks(
+      std::unique_ptr<BatchT> batch);
+
   void ProcessFuncBatch(std::unique_ptr<BatchT> batch) const;
 
   // Processes a batch of one or more BatchTask entries.
@@ -186,7 +194,8 @@ class BatchResourceBase : public ResourceBase {
   std::shared_ptr<BatcherT> batcher_;
   BatcherT::QueueOptions batcher_queue_options_;
 
-  // A collection of batcher queues, keyed on queue name.
+  // A collection of batcher queues, keyed on queue name and the shape of the
+  // inputs beyond the 0th dimension. Each gets its own batches and timeout.
   // TODO(olston): Garbage-collect unused queues (perhaps simply remove empty
   // ones (with a time delay?); it's okay if they get recreated later).
   mutable mutex batcher_queues_mu_;
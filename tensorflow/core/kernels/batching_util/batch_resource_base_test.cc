@@ -0,0 +1,264 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+class TestBatchResource : public BatchResourceBase {
+ public:
+  explicit TestBatchResource(std::vector<int32> allowed_batch_sizes)
+      : BatchResourceBase(/*has_process_batch_function=*/true,
+                          /*batcher=*/nullptr, BatcherT::QueueOptions(),
+                          std::move(allowed_batch_sizes)) {}
+
+  string DebugString() const override { return "TestBatchResource"; }
+
+ private:
+  void ProcessFuncBatchImpl(
+      const BatchTask& last_task, absl::Span<const Tensor> inputs,
+      std::vector<Tensor>* combined_outputs,
+      std::function<void(const Status&)> done) const override {
+    done(errors::Unimplemented("Not used in this test"));
+  }
+};
+
+// A [num_rows, row_size] float tensor holding 0, 1, 2, ...
+Tensor MakeInput(int64 num_rows, int64 row_size) {
+  Tensor tensor(DT_FLOAT, TensorShape({num_rows, row_size}));
+  test::FillIota<float>(&tensor, 0);
+  return tensor;
+}
+
+}  // namespace
+
+// Checks the batching steps that avoid copying tensors against the copies
+// they replace: a Concat of the task inputs, and a Split of the input or
+// output tensors. The results must be equal, and alias the original tensor
+// whenever the rows are aligned.
+class BatchResourceBaseTest : public ::testing::Test {
+ protected:
+  using BatchTask = BatchResourceBase::BatchTask;
+  using BatchT = BatchResourceBase::BatchT;
+
+  BatchResourceBaseTest()
+      : device_(
+            DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0")) {
+    NodeDef node_def;
+    TF_CHECK_OK(NodeDefBuilder("op", "Identity")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Finalize(&node_def));
+    Status status;
+    op_ = CreateOpKernel(DEVICE_CPU, device_.get(), cpu_allocator(), node_def,
+                         TF_GRAPH_DEF_VERSION, &status);
+    TF_CHECK_OK(status);
+    params_.device = device_.get();
+    params_.op_kernel = op_.get();
+  }
+
+  OpKernelContext* NewContext() {
+    contexts_.push_back(absl::make_unique<OpKernelContext>(&params_, 1));
+    return contexts_.back().get();
+  }
+
+  std::unique_ptr<BatchTask> NewTask(const Tensor& input) {
+    auto task = absl::make_unique<BatchTask>();
+    task->inputs.push_back(input);
+    task->context = NewContext();
+    task->output = std::make_shared<BatchResourceBase::TensorMatrix>();
+    task->status = std::make_shared<ThreadSafeStatus>();
+    return task;
+  }
+
+  // A partial task of 'num_rows' rows, whose single output is written to
+  // (*task->output)[0][0].
+  std::unique_ptr<BatchTask> NewPartialTask(int64 num_rows) {
+    std::unique_ptr<BatchTask> task = NewTask(MakeInput(num_rows, 1));
+    task->is_partial = true;
+    task->output->resize(1, std::vector<Tensor>(1));
+    return task;
+  }
+
+  static Status ConcatInputTensors(const BatchResourceBase& resource,
+                                   const BatchT& batch,
+                                   OpKernelContext* context,
+                                   std::vector<Tensor>* concatenated_tensors) {
+    return resource.ConcatInputTensors(batch, context, concatenated_tensors);
+  }
+
+  static Status SplitInputTask(
+      std::unique_ptr<BatchTask>* input_task_ptr, int open_batch_remaining_slot,
+      int max_batch_size,
+      std::vector<std::unique_ptr<BatchTask>>* output_tasks) {
+    return BatchResourceBase::SplitInputTask(input_task_ptr,
+                                             open_batch_remaining_slot,
+                                             max_batch_size, output_tasks);
+  }
+
+  static Status SplitOutputTensors(const BatchResourceBase& resource,
+                                   const std::vector<Tensor>& combined_outputs,
+                                   BatchT* batch) {
+    return resource.SplitOutputTensors(combined_outputs, batch);
+  }
+
+  // Splits 'input' as SplitInputTask does and checks the inputs of the split
+  // tasks against tensor::Split. Then completes the split tasks, passing
+  // their inputs through as outputs, and checks that the input task gets
+  // 'input' back as its output.
+  void ExpectSplitInputTask(const Tensor& input, int open_batch_remaining_slot,
+                            int max_batch_size,
+                            const std::vector<int64>& expected_sizes) {
+    std::unique_ptr<BatchTask> input_task = NewTask(input);
+    Notification done;
+    input_task->done_callback = [&done]() { done.Notify(); };
+    OpKernelContext* input_context = input_task->context;
+
+    std::vector<std::unique_ptr<BatchTask>> output_tasks;
+    TF_ASSERT_OK(SplitInputTask(&input_task, open_batch_remaining_slot,
+                                max_batch_size, &output_tasks));
+    std::vector<Tensor> expected;
+    TF_ASSERT_OK(tensor::Split(input, expected_sizes, &expected));
+    ASSERT_EQ(expected.size(), output_tasks.size());
+    int64 start = 0;
+    for (int i = 0; i < output_tasks.size(); ++i) {
+      const Tensor& split = output_tasks[i]->inputs[0];
+      test::ExpectTensorEqual<float>(expected[i], split);
+      EXPECT_EQ(input.Slice(start, start + expected_sizes[i]).IsAligned(),
+                split.SharesBufferWith(input));
+      start += expected_sizes[i];
+    }
+
+    for (const auto& task : output_tasks) {
+      (*task->output)[task->split_index][0] = task->inputs[0];
+      task->done_callback();
+    }
+    output_tasks.clear();
+    input_task.reset();
+    ASSERT_TRUE(done.HasBeenNotified());
+    TF_ASSERT_OK(input_context->status());
+    test::ExpectTensorEqual<float>(input, *input_context->mutable_output(0));
+  }
+
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<OpKernel> op_;
+  OpKernelContext::Params params_;
+  std::vector<std::unique_ptr<OpKernelContext>> contexts_;
+};
+
+namespace {
+
+TEST_F(BatchResourceBaseTest, ConcatOfOneTaskMatchesConcatOfTasks) {
+  core::RefCountPtr<TestBatchResource> resource(new TestBatchResource({}));
+  const Tensor input = MakeInput(3, 2);
+
+  BatchT single_task_batch;
+  single_task_batch.AddTask(NewTask(input));
+  single_task_batch.Close();
+  std::vector<Tensor> forwarded;
+  TF_ASSERT_OK(ConcatInputTensors(*resource, single_task_batch, NewContext(),
+                                  &forwarded));
+  ASSERT_EQ(1, forwarded.size());
+  EXPECT_TRUE(forwarded[0].SharesBufferWith(input));
+
+  BatchT two_task_batch;
+  two_task_batch.AddTask(NewTask(tensor::DeepCopy(input.Slice(0, 2))));
+  two_task_batch.AddTask(NewTask(tensor::DeepCopy(input.Slice(2, 3))));
+  two_task_batch.Close();
+  std::vector<Tensor> concatenated;
+  TF_ASSERT_OK(ConcatInputTensors(*resource, two_task_batch, NewContext(),
+                                  &concatenated));
+  ASSERT_EQ(1, concatenated.size());
+  test::ExpectTensorEqual<float>(concatenated[0], forwarded[0]);
+}
+
+TEST_F(BatchResourceBaseTest, ConcatOfOnePaddedTaskCopies) {
+  core::RefCountPtr<TestBatchResource> resource(new TestBatchResource({4}));
+  const Tensor input = MakeInput(3, 2);
+
+  BatchT batch;
+  batch.AddTask(NewTask(input));
+  batch.Close();
+  std::vector<Tensor> concatenated;
+  TF_ASSERT_OK(
+      ConcatInputTensors(*resource, batch, NewContext(), &concatenated));
+  ASSERT_EQ(1, concatenated.size());
+  EXPECT_FALSE(concatenated[0].SharesBufferWith(input));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 1, 2, 3, 4, 5, 0, 1}, TensorShape({4, 2})),
+      concatenated[0]);
+}
+
+TEST_F(BatchResourceBaseTest, SplitInputTaskAliasesAlignedRows) {
+  // Rows of 16 floats keep every slice aligned.
+  ExpectSplitInputTask(MakeInput(5, 16), /*open_batch_remaining_slot=*/2,
+                       /*max_batch_size=*/2, {2, 2, 1});
+}
+
+TEST_F(BatchResourceBaseTest, SplitInputTaskCopiesUnalignedRows) {
+  // Rows of a single float leave the slices after the first one unaligned.
+  ExpectSplitInputTask(MakeInput(5, 1), /*open_batch_remaining_slot=*/1,
+                       /*max_batch_size=*/2, {1, 2, 2});
+}
+
+TEST_F(BatchResourceBaseTest, SplitOutputTensorsMatchesSplit) {
+  for (const int64 row_size : {1, 16}) {
+    // The batch of 5 rows is padded to 8 rows, which the split ignores.
+    core::RefCountPtr<TestBatchResource> resource(new TestBatchResource({8}));
+    const Tensor combined_output = MakeInput(8, row_size);
+    BatchT batch;
+    batch.AddTask(NewPartialTask(2));
+    batch.AddTask(NewPartialTask(3));
+    batch.Close();
+    TF_ASSERT_OK(SplitOutputTensors(*resource, {combined_output}, &batch));
+
+    std::vector<Tensor> expected;
+    TF_ASSERT_OK(tensor::Split(combined_output, {2, 3, 3}, &expected));
+    int64 start = 0;
+    for (int i = 0; i < batch.num_tasks(); ++i) {
+      const Tensor& task_output = (*batch.task(i).output)[0][0];
+      test::ExpectTensorEqual<float>(expected[i], task_output);
+      EXPECT_EQ(combined_output.Slice(start, start + expected[i].dim_size(0))
+                    .IsAligned(),
+                task_output.SharesBufferWith(combined_output));
+      start += expected[i].dim_size(0);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
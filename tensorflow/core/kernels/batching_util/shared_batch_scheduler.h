@@ -18,8 +18,11 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cmath>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -194,6 +197,23 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If positive, the queue picks the batch size and timeout itself, aiming
+    // to process 99% of tasks within this many microseconds of their arrival,
+    // and 'batch_timeout_micros' is only used until the queue has measured
+    // how long batches take to process. Batches are then closed at the
+    // largest size that tasks arrive fast enough to fill within the target,
+    // with a timeout that leaves room for processing them.
+    //
+    // The time a closed batch waits for a free batch thread is not accounted
+    // for, so the target only holds while 'num_batch_threads' keeps up with
+    // the load.
+    int64 target_latency_micros = 0;
+
+    // Batches of queues with a higher priority are processed before those of
+    // queues with a lower priority, whenever both are ready to be processed.
+    // Queues of the same priority are serviced round-robin.
+    int priority = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -207,8 +227,14 @@ class SharedBatchScheduler
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
   // queue declines to provide a batch to process, moves onto the next queue. If
   // no queues provide a batch to process, just sleeps briefly and exits.
+  // Queues with a lower priority than another queue that has a schedulable
+  // batch are skipped.
   void ThreadLogic();
 
+  // Returns the highest priority of the queues that have a schedulable batch,
+  // or the lowest possible priority if all queues have the same priority.
+  int PriorityToSchedule() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const Options options_;
 
   mutex mu_;
@@ -242,6 +268,165 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// Chooses the size and timeout at which a queue with a latency target closes
+// its open batch (see QueueOptions::target_latency_micros), from the rate at
+// which tasks arrive and the measured time taken to process batches.
+//
+// Processing times are tracked per power-of-two bucket of batch sizes, as an
+// exponentially weighted mean and variance, and their 99th percentile is
+// estimated as that of a normal distribution. A bucket that has not been
+// measured yet is extrapolated linearly from the largest smaller bucket that
+// has. The chosen batch size is the largest bucket that the arrival rate fills
+// before its estimated processing time would exceed the target.
+//
+// Not thread-safe.
+class LatencyTargetPolicy {
+ public:
+  LatencyTargetPolicy(int64 target_latency_micros, size_t max_batch_size,
+                      int64 initial_batch_timeout_micros)
+      : target_latency_micros_(target_latency_micros),
+        max_batch_size_(max_batch_size),
+        batch_size_(max_batch_size),
+        batch_timeout_micros_(
+            std::min(initial_batch_timeout_micros, target_latency_micros)),
+        buckets_(BucketIndex(max_batch_size) + 1) {}
+
+  // Records that a task of size 'size' was enqueued at 'now_micros'.
+  void RecordArrival(size_t size, uint64 now_micros) {
+    if (!window_started_) {
+      window_started_ = true;
+      window_start_micros_ = now_micros;
+      return;
+    }
+    window_size_ += size;
+    const int64 elapsed_micros =
+        static_cast<int64>(now_micros - window_start_micros_);
+    if (elapsed_micros < kRateWindowMicros) {
+      return;
+    }
+    const double rate = static_cast<double>(window_size_) / elapsed_micros;
+    arrival_rate_ = arrival_rate_ < 0
+                        ? rate
+                        : arrival_rate_ + kRateWeight * (rate - arrival_rate_);
+    window_start_micros_ = now_micros;
+    window_size_ = 0;
+    Update();
+  }
+
+  // Records that a batch of size 'size' took 'latency_micros' to process.
+  void RecordProcessing(size_t size, int64 latency_micros) {
+    LatencyStats& stats = buckets_[BucketIndex(size)];
+    const double latency = latency_micros;
+    if (!stats.measured) {
+      stats.measured = true;
+      stats.mean = latency;
+      stats.variance = 0;
+    } else {
+      const double diff = latency - stats.mean;
+      const double increment = kLatencyWeight * diff;
+      stats.mean += increment;
+      stats.variance =
+          (1 - kLatencyWeight) * (stats.variance + diff * increment);
+    }
+    Update();
+  }
+
+  size_t batch_size() const { return batch_size_; }
+  int64 batch_timeout_micros() const { return batch_timeout_micros_; }
+
+ private:
+  struct LatencyStats {
+    bool measured = false;
+    double mean = 0;
+    double variance = 0;
+  };
+
+  // The arrival rate is sampled over windows of at least this length.
+  static constexpr int64 kRateWindowMicros = 10000;
+  // The weights of a new sample in the moving averages.
+  static constexpr double kRateWeight = 0.2;
+  static constexpr double kLatencyWeight = 0.1;
+  // The 99th percentile of the standard normal distribution.
+  static constexpr double kZ99 = 2.326;
+
+  static int BucketIndex(size_t size) {
+    int index = 0;
+    while ((size_t{1} << index) < size) {
+      ++index;
+    }
+    return index;
+  }
+
+  size_t BucketBatchSize(int index) const {
+    return std::min(size_t{1} << index, max_batch_size_);
+  }
+
+  // Returns the estimated 99th percentile of the time taken to process a
+  // batch in bucket 'index', or a negative value if no batch was measured.
+  double EstimatedLatencyMicros(int index) const {
+    for (int i = index; i >= 0; --i) {
+      if (buckets_[i].measured) {
+        return Percentile99(buckets_[i]) * BucketBatchSize(index) /
+               BucketBatchSize(i);
+      }
+    }
+    for (int i = index + 1; i < buckets_.size(); ++i) {
+      if (buckets_[i].measured) {
+        return Percentile99(buckets_[i]);
+      }
+    }
+    return -1;
+  }
+
+  static double Percentile99(const LatencyStats& stats) {
+    return stats.mean + kZ99 * std::sqrt(stats.variance);
+  }
+
+  void Update() {
+    for (int index = buckets_.size() - 1; index >= 0; --index) {
+      const double latency_micros = EstimatedLatencyMicros(index);
+      if (latency_micros < 0) {
+        // Keep the initial options until a batch has been measured.
+        return;
+      }
+      const double slack_micros = target_latency_micros_ - latency_micros;
+      if (slack_micros < 0) {
+        continue;
+      }
+      const size_t size = BucketBatchSize(index);
+      // A batch of one needs no other tasks to arrive.
+      if (index > 0 &&
+          (arrival_rate_ <= 0 || size / arrival_rate_ > slack_micros)) {
+        continue;
+      }
+      batch_size_ = size;
+      batch_timeout_micros_ = static_cast<int64>(slack_micros);
+      return;
+    }
+    // Even single tasks miss the target; process them as soon as possible.
+    batch_size_ = 1;
+    batch_timeout_micros_ = 0;
+  }
+
+  const int64 target_latency_micros_;
+  const size_t max_batch_size_;
+
+  size_t batch_size_;
+  int64 batch_timeout_micros_;
+
+  // Processing time statistics of batches of sizes in (2^(i-1), 2^i].
+  std::vector<LatencyStats> buckets_;
+
+  // The moving average of the task size arriving per microsecond, or a
+  // negative value before the first window ends.
+  double arrival_rate_ = -1;
+  bool window_started_ = false;
+  uint64 window_start_micros_ = 0;
+  size_t window_size_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LatencyTargetPolicy);
+};
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -298,6 +483,8 @@ class Queue {
   // Returns the maximum allowed size of tasks submitted to the queue.
   size_t max_task_size() const { return options_.input_batch_size_limit; }
 
+  int priority() const { return options_.priority; }
+
   // Returns the maximum allowed size of tasks to be enqueued.
   // Returned value would be less than or equal to the maximum allowed input
   // size that's provided by caller of batch scheduler.
@@ -318,6 +505,9 @@ class Queue {
   // Processes a batch that has been returned earlier by ScheduleBatch().
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
 
+  // Determines whether ScheduleBatch() would currently return a batch.
+  bool HasSchedulableBatch() const;
+
   // Determines whether the queue is empty, i.e. has no tasks waiting or being
   // processed.
   bool IsEmpty() const;
@@ -345,6 +535,11 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // The size and timeout at which the open batch is closed; these come from
+  // 'latency_policy_' if the queue has a latency target.
+  size_t OpenBatchSizeLimit() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  int64 OpenBatchTimeoutMicros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -390,6 +585,10 @@ class Queue {
   // 'empty_notification_->Notify()'.
   Notification* empty_notification_ TF_GUARDED_BY(mu_) = nullptr;
 
+  // Chooses the batch size and timeout. Null unless
+  // 'options_.target_latency_micros' is positive.
+  std::unique_ptr<LatencyTargetPolicy> latency_policy_ TF_GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(Queue);
 };
 
@@ -473,6 +672,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -539,6 +743,7 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
     mutex_lock l(mu_);
 
     const int num_queues = queues_.size();
+    const int priority_to_schedule = PriorityToSchedule();
     for (int num_queues_tried = 0;
          batch_to_process == nullptr && num_queues_tried < num_queues;
          ++num_queues_tried) {
@@ -551,7 +756,9 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
       const bool queue_closed = (*next_queue_to_schedule_)->closed();
 
       // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+      if ((*next_queue_to_schedule_)->priority() >= priority_to_schedule) {
+        batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+      }
       if (batch_to_process != nullptr) {
         queue_for_batch = next_queue_to_schedule_->get();
       }
@@ -583,6 +790,22 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   queue_for_batch->ProcessBatch(std::move(batch_to_process));
 }
 
+template <typename TaskType>
+int SharedBatchScheduler<TaskType>::PriorityToSchedule() const {
+  int priority = std::numeric_limits<int>::min();
+  if (std::all_of(queues_.begin(), queues_.end(), [this](const auto& queue) {
+        return queue->priority() == queues_.front()->priority();
+      })) {
+    return priority;
+  }
+  for (const auto& queue : queues_) {
+    if (queue->priority() > priority && queue->HasSchedulableBatch()) {
+      priority = queue->priority();
+    }
+  }
+  return priority;
+}
+
 namespace internal {
 
 template <typename TaskType>
@@ -596,6 +819,11 @@ Queue<TaskType>::Queue(
       schedulable_batch_callback_(schedulable_batch_callback) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
+  if (options_.target_latency_micros > 0) {
+    latency_policy_.reset(new LatencyTargetPolicy(
+        options_.target_latency_micros, max_execution_batch_size(),
+        options_.batch_timeout_micros));
+  }
 }
 
 template <typename TaskType>
@@ -622,6 +850,7 @@ Status Queue<TaskType>::ScheduleWithoutSplit(std::unique_ptr<TaskType>* task) {
                                    " is larger than maximum input batch size ",
                                    options_.input_batch_size_limit);
   }
+  const size_t task_size = (*task)->size();
 
   bool notify_of_schedulable_batch = false;
   {
@@ -629,8 +858,8 @@ Status Queue<TaskType>::ScheduleWithoutSplit(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() >
-        options_.input_batch_size_limit) {
+    if (!batches_.back()->empty() &&
+        batches_.back()->size() + task_size > OpenBatchSizeLimit()) {
       if (batches_.size() >= options_.max_enqueued_batches) {
         return errors::Unavailable(
             "The batch scheduling queue to which this task was submitted is "
@@ -649,6 +878,9 @@ Status Queue<TaskType>::ScheduleWithoutSplit(std::unique_ptr<TaskType>* task) {
         profiler::ContextType::kSharedBatchScheduler,
         batches_.back()->traceme_context_id());
     batches_.back()->AddTask(std::move(*task));
+    if (latency_policy_ != nullptr) {
+      latency_policy_->RecordArrival(task_size, env_->NowMicros());
+    }
 
     if (!schedulable_batch_) {
       if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
@@ -740,6 +972,9 @@ Status Queue<TaskType>::ScheduleWithSplit(std::unique_ptr<TaskType>* task) {
           batches_.back()->traceme_context_id());
       batches_.back()->AddTask(std::move(output_tasks[i]));
     }
+    if (latency_policy_ != nullptr) {
+      latency_policy_->RecordArrival(input_task_size, env_->NowMicros());
+    }
 
     if (!schedulable_batch_) {
       if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
@@ -815,10 +1050,16 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const size_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (latency_policy_ != nullptr) {
+      latency_policy_->RecordProcessing(
+          batch_size, env_->NowMicros() - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -826,6 +1067,12 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   }
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::HasSchedulableBatch() const {
+  mutex_lock l(mu_);
+  return batches_.size() >= 2 || IsOpenBatchSchedulable();
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
@@ -877,9 +1124,25 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= OpenBatchSizeLimit() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + OpenBatchTimeoutMicros();
+}
+
+template <typename TaskType>
+size_t Queue<TaskType>::OpenBatchSizeLimit() const {
+  if (latency_policy_ != nullptr) {
+    return std::min(latency_policy_->batch_size(), max_execution_batch_size());
+  }
+  return max_execution_batch_size();
+}
+
+template <typename TaskType>
+int64 Queue<TaskType>::OpenBatchTimeoutMicros() const {
+  if (latency_policy_ != nullptr) {
+    return latency_policy_->batch_timeout_micros();
+  }
+  return options_.batch_timeout_micros;
 }
 
 template <typename TaskType>
@@ -591,6 +591,130 @@ TEST(SharedBatchSchedulerTest, QueueDestructorBlocksUntilAllTasksProcessed) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, HigherPriorityQueuesGoFirst) {
+  mutex mu;
+  std::vector<int> processed_sizes;
+  Notification first_batch_started, first_batch_proceed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    if (batch->size() == 1) {
+      first_batch_started.Notify();
+      first_batch_proceed.WaitForNotification();
+    }
+    mutex_lock l(mu);
+    processed_sizes.push_back(batch->size());
+  };
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.input_batch_size_limit = 10;
+  queue_options.batch_timeout_micros = 0;
+  std::unique_ptr<BatchScheduler<FakeTask>> low_queue;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &low_queue));
+  queue_options.priority = 1;
+  std::unique_ptr<BatchScheduler<FakeTask>> high_queue;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &high_queue));
+
+  // Keep the batch thread busy while both queues get a batch, even though
+  // the low priority queue is next in the round-robin order.
+  TF_ASSERT_OK(ScheduleTask(1, high_queue.get()));
+  first_batch_started.WaitForNotification();
+  TF_ASSERT_OK(ScheduleTask(2, low_queue.get()));
+  TF_ASSERT_OK(ScheduleTask(3, high_queue.get()));
+  first_batch_proceed.Notify();
+  low_queue = nullptr;
+  high_queue = nullptr;
+
+  mutex_lock l(mu);
+  EXPECT_EQ(std::vector<int>({1, 3, 2}), processed_sizes);
+}
+
+// Records tasks of size 1 arriving every 'interval_micros' for 'count'
+// intervals.
+void RecordArrivals(int count, int interval_micros,
+                    internal::LatencyTargetPolicy* policy) {
+  for (int i = 0; i <= count; ++i) {
+    policy->RecordArrival(1, i * interval_micros);
+  }
+}
+
+TEST(LatencyTargetPolicyTest, KeepsInitialOptionsUntilMeasured) {
+  internal::LatencyTargetPolicy policy(/*target_latency_micros=*/1000,
+                                       /*max_batch_size=*/16,
+                                       /*initial_batch_timeout_micros=*/5000);
+  RecordArrivals(1000, 10, &policy);
+  EXPECT_EQ(16, policy.batch_size());
+  EXPECT_EQ(1000, policy.batch_timeout_micros());
+}
+
+TEST(LatencyTargetPolicyTest, PicksLargestBatchWithinTarget) {
+  internal::LatencyTargetPolicy policy(/*target_latency_micros=*/1000,
+                                       /*max_batch_size=*/16,
+                                       /*initial_batch_timeout_micros=*/0);
+  // One task every 10us.
+  RecordArrivals(1000, 10, &policy);
+  // Batches of 16 are estimated to take 1600us, and of 8 800us.
+  policy.RecordProcessing(1, 100);
+  EXPECT_EQ(8, policy.batch_size());
+  EXPECT_EQ(200, policy.batch_timeout_micros());
+
+  // Batches of 8 are measured to be faster than estimated, which leaves room
+  // for batches of 16.
+  policy.RecordProcessing(8, 400);
+  EXPECT_EQ(16, policy.batch_size());
+  EXPECT_EQ(200, policy.batch_timeout_micros());
+}
+
+TEST(LatencyTargetPolicyTest, AccountsForLatencyVariance) {
+  internal::LatencyTargetPolicy policy(/*target_latency_micros=*/1000,
+                                       /*max_batch_size=*/16,
+                                       /*initial_batch_timeout_micros=*/0);
+  RecordArrivals(1000, 10, &policy);
+  policy.RecordProcessing(8, 400);
+  EXPECT_EQ(16, policy.batch_size());
+  for (int i = 0; i < 10; ++i) {
+    policy.RecordProcessing(8, 200);
+    policy.RecordProcessing(8, 600);
+  }
+  EXPECT_EQ(8, policy.batch_size());
+}
+
+TEST(LatencyTargetPolicyTest, SmallBatchesUnderLowLoad) {
+  internal::LatencyTargetPolicy policy(/*target_latency_micros=*/1000,
+                                       /*max_batch_size=*/16,
+                                       /*initial_batch_timeout_micros=*/0);
+  // One task every 1ms can't fill batches of 2 in time.
+  RecordArrivals(20, 1000, &policy);
+  policy.RecordProcessing(1, 100);
+  EXPECT_EQ(1, policy.batch_size());
+  EXPECT_EQ(900, policy.batch_timeout_micros());
+}
+
+TEST(LatencyTargetPolicyTest, UnreachableTarget) {
+  internal::LatencyTargetPolicy policy(/*target_latency_micros=*/1000,
+                                       /*max_batch_size=*/16,
+                                       /*initial_batch_timeout_micros=*/0);
+  RecordArrivals(1000, 10, &policy);
+  policy.RecordProcessing(1, 2000);
+  EXPECT_EQ(1, policy.batch_size());
+  EXPECT_EQ(0, policy.batch_timeout_micros());
+}
+
+TEST(SharedBatchSchedulerTest, RejectsNegativeTargetLatency) {
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.target_latency_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            scheduler
+                ->AddQueue(queue_options,
+                           [](std::unique_ptr<Batch<FakeTask>> batch) {},
+                           &queue)
+                .code());
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
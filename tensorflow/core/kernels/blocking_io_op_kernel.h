@@ -0,0 +1,71 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BLOCKING_IO_OP_KERNEL_H_
+#define TENSORFLOW_CORE_KERNELS_BLOCKING_IO_OP_KERNEL_H_
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+// Base class for kernels that block on I/O, such as reading or writing whole
+// files. ComputeBlocking() runs on a process-wide pool of I/O threads rather
+// than on the inter-op thread that scheduled the kernel, which is free to run
+// other kernels in the meantime.
+//
+// The size of the pool is read from TF_NUM_BLOCKING_IO_THREADS, and defaults
+// to 16.
+class BlockingIOOpKernel : public AsyncOpKernel {
+ public:
+  using AsyncOpKernel::AsyncOpKernel;
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) final {
+    BlockingIOThreadPool()->Schedule([this, context, done]() {
+      ComputeBlocking(context);
+      done();
+    });
+  }
+
+ protected:
+  // Synchronous compute, which may block. Like OpKernel::Compute(), it
+  // reports errors with context->SetStatus().
+  virtual void ComputeBlocking(OpKernelContext* context) = 0;
+
+ private:
+  static thread::ThreadPool* BlockingIOThreadPool() {
+    static thread::ThreadPool* pool = [] {
+      int64 num_threads = 16;
+      Status s = ReadInt64FromEnvVar("TF_NUM_BLOCKING_IO_THREADS", 16,
+                                     &num_threads);
+      if (!s.ok() || num_threads < 1) {
+        LOG(ERROR) << "Invalid TF_NUM_BLOCKING_IO_THREADS, using 16 threads: "
+                   << s;
+        num_threads = 16;
+      }
+      return new thread::ThreadPool(Env::Default(), ThreadOptions(),
+                                    "blocking_io", num_threads,
+                                    /*low_latency_hint=*/false);
+    }();
+    return pool;
+  }
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BLOCKING_IO_OP_KERNEL_H_
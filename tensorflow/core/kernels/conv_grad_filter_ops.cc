@@ -645,6 +645,8 @@ struct ConvBackwardFilterAutoTuneGroup {
 typedef AutoTuneSingleton<ConvBackwardFilterAutoTuneGroup, ConvParameters,
                           se::dnn::AlgorithmConfig>
     AutoTuneConvBwdFilter;
+REGISTER_CONV_AUTOTUNE_MAP(ConvBackwardFilterAutoTuneGroup::name(),
+                           AutoTuneConvBwdFilter::GetInstance());
 
 template <typename T>
 void LaunchConv2DBackpropFilterOp<Eigen::GpuDevice, T>::operator()(
@@ -829,6 +829,8 @@ struct ConvBackwardDataAutoTuneGroup {
 typedef AutoTuneSingleton<ConvBackwardDataAutoTuneGroup, ConvParameters,
                           se::dnn::AlgorithmConfig>
     AutoTuneConvBwdData;
+REGISTER_CONV_AUTOTUNE_MAP(ConvBackwardDataAutoTuneGroup::name(),
+                           AutoTuneConvBwdData::GetInstance());
 
 template <typename T>
 void LaunchConv2DBackpropInputOp<GPUDevice, T>::operator()(
@@ -1099,6 +1099,9 @@ typedef AutoTuneSingleton<Conv3dBackwardDataAutoTuneGroup, ConvParameters,
                           se::dnn::AlgorithmConfig>
 
     AutoTuneConv3dBwdData;
+REGISTER_CONV_AUTOTUNE_MAP(Conv3dBackwardDataAutoTuneGroup::name(),
+                           AutoTuneConv3dBwdData::GetInstance());
+
 template <typename T>
 class Conv3DBackpropInputOp<GPUDevice, T> : public OpKernel {
  public:
@@ -1592,6 +1595,8 @@ struct Conv3dBackwardFilterAutoTuneGroup {
 typedef AutoTuneSingleton<Conv3dBackwardFilterAutoTuneGroup, ConvParameters,
                           se::dnn::AlgorithmConfig>
     AutoTuneConv3dBwdFilter;
+REGISTER_CONV_AUTOTUNE_MAP(Conv3dBackwardFilterAutoTuneGroup::name(),
+                           AutoTuneConv3dBwdFilter::GetInstance());
 
 template <typename T>
 class Conv3DBackpropFilterOp<GPUDevice, T> : public OpKernel {
@@ -641,6 +641,8 @@ struct ConvAutoTuneGroup {
 typedef AutoTuneSingleton<ConvAutoTuneGroup, ConvParameters,
                           se::dnn::AlgorithmConfig>
     AutoTuneConv;
+REGISTER_CONV_AUTOTUNE_MAP(ConvAutoTuneGroup::name(),
+                           AutoTuneConv::GetInstance());
 
 template <typename T>
 void LaunchConv2DOp<GPUDevice, T>::operator()(
@@ -964,7 +966,14 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
 
   int device_id = stream->parent()->device_ordinal();
   DataType dtype = input.dtype();
-  ConvParameters conv_parameters = {in_batch,             // batch
+#if GOOGLE_CUDA
+  // The algorithms do not depend on the batch size, unlike the MIOpen scratch
+  // sizes kept in the ROCm configs.
+  const int64 autotune_batch = ConvAutotuneBatchBucket(in_batch);
+#else
+  const int64 autotune_batch = in_batch;
+#endif
+  ConvParameters conv_parameters = {autotune_batch,       // batch
                                     in_depths,            // in_depths
                                     {{in_rows,            // in_rows
                                       in_cols}},          // in_cols
@@ -989,6 +998,12 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
   // if we do not have a cached algorithm_config for this conv_parameters
   cudnn_use_autotune = true;
 #endif
+  string device_kind;
+  if (cudnn_use_autotune &&
+      autotune_cache_registry::PersistentAutotuneCachesEnabled()) {
+    device_kind = AutotuneDeviceKind(stream->parent());
+    autotune_cache_registry::MaybeLoadPersistentAutotuneCaches(device_kind);
+  }
   if (cudnn_use_autotune &&
       !AutoTuneConv::GetInstance()->Find(conv_parameters, &algorithm_config)) {
 #if GOOGLE_CUDA
@@ -1113,6 +1128,10 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
                            conv_desc, stream->parent(), results);
     OP_REQUIRES_OK(ctx, BestCudnnConvAlgorithm(results, &algorithm_config));
     AutoTuneConv::GetInstance()->Insert(conv_parameters, algorithm_config);
+    if (!device_kind.empty()) {
+      autotune_cache_registry::MaybeSavePersistentAutotuneCache(
+          device_kind, ConvAutoTuneGroup::name());
+    }
   }
 
   VLOG(4) << "Convolution Algorithm: "
@@ -70,6 +70,8 @@ struct Conv3dAutoTuneGroup {
 typedef AutoTuneSingleton<Conv3dAutoTuneGroup, ConvParameters,
                           se::dnn::AlgorithmConfig>
     AutoTuneConv3d;
+REGISTER_CONV_AUTOTUNE_MAP(Conv3dAutoTuneGroup::name(),
+                           AutoTuneConv3d::GetInstance());
 
 // TODO(mjanusz): Share logic with 2d implementation as much as possible.
 template <typename T>
@@ -25,7 +25,10 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/gpu_utils.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/protobuf/conv_autotuning.pb.h"
+#include "tensorflow/core/util/autotune_cache_registry.h"
 #include "tensorflow/core/util/tensor_format.h"
 
 namespace tensorflow {
@@ -131,6 +134,36 @@ class ConvParameters {
     hash_code_ = Hash64Combine(hash_code_, group_count);
   }
 
+  // REQUIRES: the spatial dimensions of "proto" have at most 3 elements.
+  explicit ConvParameters(const ConvParametersProto& proto)
+      : ConvParameters(
+            proto.batch(), proto.in_depths(),
+            SpatialArray(proto.in().begin(), proto.in().end()),
+            static_cast<TensorFormat>(proto.data_format()), proto.out_depths(),
+            SpatialArray(proto.filter().begin(), proto.filter().end()),
+            SpatialArray(proto.dilation().begin(), proto.dilation().end()),
+            SpatialArray(proto.stride().begin(), proto.stride().end()),
+            SpatialArray(proto.padding().begin(), proto.padding().end()),
+            static_cast<DataType>(proto.dtype()), proto.device_id(),
+            proto.group_count()) {}
+
+  ConvParametersProto ToProto() const {
+    ConvParametersProto proto;
+    proto.set_batch(batch_);
+    proto.set_in_depths(in_depths_);
+    proto.set_out_depths(out_depths_);
+    for (int64 val : in_) proto.add_in(val);
+    proto.set_data_format(data_format_);
+    for (int64 val : filter_) proto.add_filter(val);
+    for (int64 val : dilation_) proto.add_dilation(val);
+    for (int64 val : stride_) proto.add_stride(val);
+    for (int64 val : padding_) proto.add_padding(val);
+    proto.set_dtype(dtype_);
+    proto.set_device_id(device_id_);
+    proto.set_group_count(group_count_);
+    return proto;
+  }
+
   bool operator==(const ConvParameters& other) const {
     return this->get_data_as_tuple() == other.get_data_as_tuple();
   }
@@ -224,6 +257,82 @@ class ConvParameters {
 
 typedef Eigen::GpuDevice GPUDevice;
 
+typedef AutoTuneMap<ConvParameters, se::dnn::AlgorithmConfig> ConvAutoTuneMap;
+
+// Serializes the accepted configs of "map" as a ConvAutotuneMapProto.
+inline Status SerializeConvAutoTuneMap(const ConvAutoTuneMap& map,
+                                       string* serialized) {
+  ConvAutotuneMapProto proto;
+  for (const auto& p : map.GetAcceptedConfigs()) {
+    ConvAutotuneMapProto::Entry* entry = proto.add_entries();
+    *entry->mutable_parameters() = p.first.ToProto();
+    const se::dnn::AlgorithmConfig& config = p.second;
+    if (config.algorithm().has_value()) {
+      *entry->mutable_algorithm() = config.algorithm()->ToProto();
+    }
+    if (config.algorithm_no_scratch().has_value()) {
+      *entry->mutable_algorithm_no_scratch() =
+          config.algorithm_no_scratch()->ToProto();
+    }
+    if (config.scratch_size().has_value()) {
+      entry->set_scratch_size(*config.scratch_size());
+    }
+  }
+  if (!proto.SerializeToString(serialized)) {
+    return errors::Internal("Unable to serialize the conv autotune map");
+  }
+  return Status::OK();
+}
+
+// Accepts the configs of the ConvAutotuneMapProto "serialized" in "map".
+inline Status DeserializeConvAutoTuneMap(const string& serialized,
+                                         ConvAutoTuneMap* map) {
+  ConvAutotuneMapProto proto;
+  if (!proto.ParseFromString(serialized)) {
+    return errors::InvalidArgument("Unable to parse a ConvAutotuneMapProto");
+  }
+  auto to_algorithm = [](const se::dnn::AlgorithmProto& algorithm) {
+    return se::dnn::AlgorithmDesc(
+        algorithm.algo_id(),
+        algorithm.math_type() == se::dnn::AlgorithmProto::TENSOR_OP_MATH);
+  };
+  for (const ConvAutotuneMapProto::Entry& entry : proto.entries()) {
+    const ConvParametersProto& params = entry.parameters();
+    if (params.in_size() > 3 || params.filter_size() > 3 ||
+        params.dilation_size() > 3 || params.stride_size() > 3 ||
+        params.padding_size() > 3) {
+      return errors::InvalidArgument("Invalid convolution parameters: ",
+                                     params.ShortDebugString());
+    }
+    se::dnn::AlgorithmConfig config;
+    if (entry.has_algorithm()) {
+      config.set_algorithm(to_algorithm(entry.algorithm()));
+    }
+    if (entry.has_algorithm_no_scratch()) {
+      config.set_algorithm_no_scratch(
+          to_algorithm(entry.algorithm_no_scratch()));
+    }
+    if (entry.scratch_size_oneof_case() ==
+        ConvAutotuneMapProto::Entry::kScratchSize) {
+      config.set_scratch_size(entry.scratch_size());
+    }
+    map->InsertAccepted(ConvParameters(params), config);
+  }
+  return Status::OK();
+}
+
+// Saves the accepted configs of the ConvAutoTuneMap* "map" with SavedModels
+// under "name", see autotune_cache_registry.h.
+#define REGISTER_CONV_AUTOTUNE_MAP(name, map)                     \
+  REGISTER_AUTOTUNE_CACHE(                                        \
+      name,                                                       \
+      [](string* serialized) {                                    \
+        return SerializeConvAutoTuneMap(*(map), serialized);      \
+      },                                                          \
+      [](const string& serialized) {                              \
+        return DeserializeConvAutoTuneMap(serialized, (map));     \
+      })
+
 }  // namespace tensorflow
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -19,6 +19,7 @@ limitations under the License.
 // See docs in ../ops/math_ops.cc.
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <functional>
 
 #define EIGEN_USE_THREADS
 
@@ -461,6 +462,81 @@ struct BinaryFunctor<CPUDevice, Functor, 2, false> {
   }
 #endif
 
+  // Rows shorter than this are broadcast by Eigen, for which the rows are too
+  // short to amortize evaluating them one at a time.
+  static constexpr int64 kMinRowwiseBCastCols = 128;
+
+  // Broadcasts a row or a column of one input over the matrix of the other
+  // one, e.g. [N, C] op [1, C] or [N, C] op [N, 1], one output row at a time.
+  // The rows are contiguous, so they are evaluated with packets and no index
+  // computation. Returns false, doing nothing, for the other broadcasts.
+  bool RowwiseBCast(
+      const CPUDevice& dev,
+      typename TTypes<typename Functor::out_type, NDIMS>::Tensor out,
+      typename TTypes<typename Functor::in_type, NDIMS>::ConstTensor in0,
+      typename TTypes<typename Functor::in_type, NDIMS>::ConstTensor in1) {
+    typedef typename Functor::out_type Tout;
+    typedef typename Functor::in_type Tin;
+    typedef typename Functor::func Binary;
+    typedef typename TTypes<Tout>::Flat OutRow;
+    typedef typename TTypes<Tin>::ConstFlat InRow;
+    const int64 rows = out.dimension(0);
+    const int64 cols = out.dimension(1);
+    if (cols < kMinRowwiseBCastCols) return false;
+    const bool in0_full = in0.dimension(0) == rows && in0.dimension(1) == cols;
+    const bool in1_full = in1.dimension(0) == rows && in1.dimension(1) == cols;
+    if (in0_full == in1_full) return false;
+    const Tin* full = in0_full ? in0.data() : in1.data();
+    const auto& other = in0_full ? in1 : in0;
+    const Tin* bcast = other.data();
+    Tout* out_data = out.data();
+    std::function<void(Eigen::Index, Eigen::Index)> fn;
+    if (other.dimension(0) == 1 && other.dimension(1) == cols) {
+      // The other input is a row.
+      fn = [in0_full, full, bcast, out_data, cols](Eigen::Index first,
+                                                   Eigen::Index last) {
+        Binary func;
+        InRow row(bcast, cols);
+        for (Eigen::Index i = first; i < last; ++i) {
+          OutRow o(out_data + i * cols, cols);
+          InRow m(full + i * cols, cols);
+          if (in0_full) {
+            o = m.binaryExpr(row, func);
+          } else {
+            o = row.binaryExpr(m, func);
+          }
+        }
+      };
+    } else if (other.dimension(0) == rows && other.dimension(1) == 1) {
+      // The other input is a column: a scalar per row.
+      fn = [in0_full, full, bcast, out_data, cols](Eigen::Index first,
+                                                   Eigen::Index last) {
+        typedef typename Eigen::internal::scalar_left<
+            Tout, Tin, Binary, /*is_scalar_in_host_memory=*/true>
+            Left;
+        typedef typename Eigen::internal::scalar_right<
+            Tout, Tin, Binary, /*is_scalar_in_host_memory=*/true>
+            Right;
+        for (Eigen::Index i = first; i < last; ++i) {
+          OutRow o(out_data + i * cols, cols);
+          InRow m(full + i * cols, cols);
+          if (in0_full) {
+            o = m.unaryExpr(Right(bcast + i));
+          } else {
+            o = m.unaryExpr(Left(bcast + i));
+          }
+        }
+      };
+    } else {
+      return false;
+    }
+    const Eigen::TensorOpCost row_cost(
+        2 * cols * sizeof(Tin), cols * sizeof(Tout),
+        cols * Eigen::internal::functor_traits<Binary>::Cost);
+    dev.parallelFor(rows, row_cost, fn);
+    return true;
+  }
+
   void BCast(const CPUDevice& dev,
              typename TTypes<typename Functor::out_type, NDIMS>::Tensor out,
              typename TTypes<typename Functor::in_type, NDIMS>::ConstTensor in0,
@@ -470,6 +546,7 @@ struct BinaryFunctor<CPUDevice, Functor, 2, false> {
              bool* error) {
     typedef typename Functor::in_type T;
     typename Functor::func func;
+    if (RowwiseBCast(dev, out, in0, in1)) return;
     if (Functor::use_bcast_optimization && use_bcast_optimization<T>::value) {
       // Optimize for speed by using Eigen::type2index and avoid
       // .broadcast() when we know it's a no-op.
@@ -52,6 +52,75 @@ struct UnaryFunctor<GPUDevice, Functor> {
   }
 };
 
+// Broadcasts of a row or a column, e.g. [N, C] op [1, C] or [N, C] op [N, 1],
+// for which type2index lets Eigen skip the index computations of the
+// broadcast dimension. Returns false, doing nothing, for the other broadcasts.
+// Like on CPU, only used for the functors and types that opt in with
+// use_bcast_optimization, to bound the code size.
+template <typename Functor, int NDIMS>
+struct BinaryRowOrColBCast {
+  bool operator()(
+      const GPUDevice& d,
+      typename TTypes<typename Functor::out_type, NDIMS>::Tensor out,
+      typename TTypes<typename Functor::in_type, NDIMS>::ConstTensor in0,
+      typename TTypes<typename Functor::in_type, NDIMS>::ConstTensor in1) {
+    return false;
+  }
+};
+
+template <typename Functor>
+struct BinaryRowOrColBCast<Functor, 2> {
+#if !defined(EIGEN_HAS_INDEX_LIST)
+  inline Eigen::DSizes<int, 2> NByOne(int n) {
+    return Eigen::DSizes<int, 2>(n, 1);
+  }
+  inline Eigen::DSizes<int, 2> OneByM(int m) {
+    return Eigen::DSizes<int, 2>(1, m);
+  }
+#else
+  inline Eigen::IndexList<int, Eigen::type2index<1>> NByOne(int n) {
+    Eigen::IndexList<int, Eigen::type2index<1>> ret;
+    ret.set(0, n);
+    return ret;
+  }
+  inline Eigen::IndexList<Eigen::type2index<1>, int> OneByM(int m) {
+    Eigen::IndexList<Eigen::type2index<1>, int> ret;
+    ret.set(1, m);
+    return ret;
+  }
+#endif
+
+  bool operator()(
+      const GPUDevice& d,
+      typename TTypes<typename Functor::out_type, 2>::Tensor out,
+      typename TTypes<typename Functor::in_type, 2>::ConstTensor in0,
+      typename TTypes<typename Functor::in_type, 2>::ConstTensor in1) {
+    typename Functor::func func;
+    const int rows = out.dimension(0);
+    const int cols = out.dimension(1);
+    const bool in0_full = in0.dimension(0) == rows && in0.dimension(1) == cols;
+    const bool in1_full = in1.dimension(0) == rows && in1.dimension(1) == cols;
+    if (in0_full && in1.dimension(0) == 1 && in1.dimension(1) == cols) {
+      To32Bit(out).device(d) = To32Bit(in0).binaryExpr(
+          To32Bit(in1).reshape(OneByM(cols)).broadcast(NByOne(rows)), func);
+    } else if (in0_full && in1.dimension(0) == rows && in1.dimension(1) == 1) {
+      To32Bit(out).device(d) = To32Bit(in0).binaryExpr(
+          To32Bit(in1).reshape(NByOne(rows)).broadcast(OneByM(cols)), func);
+    } else if (in1_full && in0.dimension(0) == 1 && in0.dimension(1) == cols) {
+      To32Bit(out).device(d) =
+          To32Bit(in0).reshape(OneByM(cols)).broadcast(NByOne(rows)).binaryExpr(
+              To32Bit(in1), func);
+    } else if (in1_full && in0.dimension(0) == rows && in0.dimension(1) == 1) {
+      To32Bit(out).device(d) =
+          To32Bit(in0).reshape(NByOne(rows)).broadcast(OneByM(cols)).binaryExpr(
+              To32Bit(in1), func);
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
 // Partial specialization of BinaryFunctor<Device=GPUDevice, Functor>.
 template <typename Functor, int NDIMS, bool has_errors>
 struct BinaryFunctor<GPUDevice, Functor, NDIMS, has_errors> {
@@ -93,6 +162,7 @@ struct BinaryFunctor<GPUDevice, Functor, NDIMS, has_errors> {
     typename Functor::func func;
     if ((NDIMS == 2) && Functor::use_bcast_optimization &&
         use_bcast_optimization<T>::value) {
+      if (BinaryRowOrColBCast<Functor, NDIMS>()(d, out, in0, in1)) return;
       const bool bcast0_all_one = AllOne<NDIMS>(bcast0);
       const bool bcast1_all_one = AllOne<NDIMS>(bcast1);
       if (bcast0_all_one && !bcast1_all_one) {
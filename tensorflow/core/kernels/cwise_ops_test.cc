@@ -456,5 +456,45 @@ BM_BCAST_ADD_CROSS_CR_ALL(sycl);
 #undef BM_BCAST_ADD_CROSS_CR_ALL
 #undef BM_BCAST_ADD_CROSS_CR
 
+// [rows, cols, channels] op [channels], e.g. a per channel op of NHWC images.
+Graph* BcastChannel(const string& op, int rows, int cols, int channels) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor lhs(DT_FLOAT, TensorShape({rows, cols, channels}));
+  lhs.flat<float>().setRandom();
+  Tensor rhs(DT_FLOAT, TensorShape({channels}));
+  rhs.flat<float>().setRandom();
+  test::graph::Binary(g, op, test::graph::Constant(g, lhs),
+                      test::graph::Constant(g, rhs));
+  return g;
+}
+
+#define BM_BCAST_CHANNEL(DEVICE, OP, R, C, CH)                                 \
+  void BM_##DEVICE##_Bcast##OP##Channel_R##R##_C##C##_CH##CH(int iters,        \
+                                                              int arg) {       \
+    const int rows = RowsFromArg(arg);                                         \
+    const int cols = ColsFromArg(arg);                                         \
+    const int64 tot = static_cast<int64>(iters) * rows * cols * CH;            \
+    testing::UseRealTime();                                                    \
+    testing::ItemsProcessed(tot);                                              \
+    testing::BytesProcessed(tot * sizeof(float));                              \
+    test::Benchmark(#DEVICE, BcastChannel(#OP, rows, cols, CH)).Run(iters);    \
+  }                                                                            \
+  BENCHMARK(BM_##DEVICE##_Bcast##OP##Channel_R##R##_C##C##_CH##CH)             \
+      ->Arg(RowsAndColsArg(R, C));
+
+#define BM_BCAST_CHANNEL_ALL(DEVICE, OP)         \
+  BM_BCAST_CHANNEL(DEVICE, OP, 32, 32, 3);       \
+  BM_BCAST_CHANNEL(DEVICE, OP, 64, 64, 64);      \
+  BM_BCAST_CHANNEL(DEVICE, OP, 32, 32, 512);     \
+  BM_BCAST_CHANNEL(DEVICE, OP, 16, 16, 2048);
+BM_BCAST_CHANNEL_ALL(cpu, Add);
+BM_BCAST_CHANNEL_ALL(cpu, Maximum);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_BCAST_CHANNEL_ALL(gpu, Add);
+BM_BCAST_CHANNEL_ALL(gpu, Maximum);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#undef BM_BCAST_CHANNEL_ALL
+#undef BM_BCAST_CHANNEL
+
 }  // namespace
 }  // namespace tensorflow
@@ -206,7 +206,11 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         // element is moved into the output batch.
         TensorShape first_element_shape(first_element.shape());
         batch_component_shape.AppendShape(first_element_shape);
-        out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
+        // Batches are often copied to a GPU, which can copy them
+        // asynchronously from gpu compatible (i.e. pinned) host memory.
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        out_tensors->emplace_back(ctx->allocator(attr), first_element.dtype(),
                                   batch_component_shape);
         if (!out_tensors->back().IsInitialized()) {
           return errors::ResourceExhausted(
@@ -14,16 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <atomic>
+#include <deque>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/cache_file_reader.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/index_permutation.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -46,6 +53,8 @@ constexpr char kLockFileSuffix[] = ".lockfile";
 constexpr char kIterationCompleted[] = "iteration_completed";
 constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
+constexpr char kSeed[] = "seed";
+constexpr char kSeed2[] = "seed2";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
@@ -61,11 +70,12 @@ constexpr char kCacheDataset[] = "CacheDataset";
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env, int64 shuffle_seed)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
         env_(env),
+        shuffle_seed_(shuffle_seed),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
@@ -559,6 +569,148 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // FileShuffledReaderIterator reads the elements of a complete cache in a
+    // random order, so that each epoch over the cache is fully shuffled
+    // without a shuffle buffer.
+    //
+    // Elements are read by index through a `CacheFileReader`, which is shared
+    // by the iterators of the dataset. The order is an `IndexPermutation`,
+    // so memory use does not depend on the size of the cache. The next
+    // `kReadAhead` elements are read in parallel with `ctx->runner()`.
+    class FileShuffledReaderIterator : public DatasetIterator<FileDatasetBase> {
+     public:
+      explicit FileShuffledReaderIterator(const Params& params)
+          : DatasetIterator<FileDatasetBase>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(dataset()->GetCacheFileReader(&reader_));
+        if (dataset()->shuffle_seed_ == 0) {
+          seed_ = random::New64();
+          seed2_ = random::New64();
+        } else {
+          // Each iterator uses a different permutation, which is determined
+          // by the seed and the number of iterators created before it.
+          seed_ = dataset()->shuffle_seed_;
+          seed2_ = dataset()->num_shuffled_iterators_.fetch_add(1);
+        }
+        ResetPermutation();
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (cur_index_ >= permutation_->size()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        *end_of_sequence = false;
+        ScheduleReads(ctx);
+        std::shared_ptr<Read> read = std::move(reads_.front());
+        reads_.pop_front();
+        cur_index_++;
+        ScheduleReads(ctx);
+        mutex_lock read_lock(read->mu);
+        while (!read->done) {
+          read->cond_var.wait(read_lock);
+        }
+        TF_RETURN_IF_ERROR(read->status);
+        *out_tensors = std::move(read->tensors);
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kCurIndex), cur_index_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seed_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed2), seed2_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kCurIndex), &cur_index_));
+        if (cur_index_ < 0) {
+          return errors::Internal("Invalid value for cur_index ", cur_index_);
+        }
+        // A checkpoint saved while the cache was being written has no seeds.
+        // The remaining elements of that epoch are then read from the
+        // permutation chosen by `Initialize()`.
+        if (reader->Contains(full_name(kSeed))) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed_));
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2_));
+        }
+        ResetPermutation();
+        return Status::OK();
+      }
+
+     private:
+      // The number of elements that are read ahead of the one being returned.
+      static constexpr int kReadAhead = 16;
+
+      // An element that is being read. Outstanding reads hold the reader, so
+      // they may finish after the iterator has been destroyed.
+      struct Read {
+        mutex mu;
+        condition_variable cond_var;
+        bool done TF_GUARDED_BY(mu) = false;
+        Status status TF_GUARDED_BY(mu);
+        std::vector<Tensor> tensors TF_GUARDED_BY(mu);
+      };
+
+      // Drops the reads in flight and restarts reading at `cur_index_`.
+      void ResetPermutation() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        permutation_ = absl::make_unique<IndexPermutation>(
+            reader_->num_elements(), seed_, seed2_);
+        reads_.clear();
+        next_read_index_ = cur_index_;
+      }
+
+      void ScheduleReads(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (reads_.size() < kReadAhead &&
+               next_read_index_ < permutation_->size()) {
+          auto read = std::make_shared<Read>();
+          const int64 element_index = (*permutation_)(next_read_index_++);
+          (*ctx->runner())(
+              [reader = reader_, read, element_index]() {
+                std::vector<Tensor> tensors;
+                Status s = reader->Read(element_index, &tensors);
+                mutex_lock l(read->mu);
+                read->status = s;
+                read->tensors = std::move(tensors);
+                read->done = true;
+                read->cond_var.notify_all();
+              });
+          reads_.push_back(std::move(read));
+        }
+      }
+
+      mutex mu_;
+      std::shared_ptr<const CacheFileReader> reader_ TF_GUARDED_BY(mu_);
+      int64 seed_ TF_GUARDED_BY(mu_) = 0;
+      int64 seed2_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<IndexPermutation> permutation_ TF_GUARDED_BY(mu_);
+      // The position in the permutation of the next element returned.
+      int64 cur_index_ TF_GUARDED_BY(mu_) = 0;
+      // The reads of the elements at positions [cur_index_, next_read_index_).
+      std::deque<std::shared_ptr<Read>> reads_ TF_GUARDED_BY(mu_);
+      int64 next_read_index_ TF_GUARDED_BY(mu_) = 0;
+    };  // FileShuffledReaderIterator
+
     Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator` and
@@ -571,9 +723,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              absl::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()->shuffle_seed_ >= 0) {
+            iterator_ = absl::make_unique<FileShuffledReaderIterator>(
+                FileShuffledReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = absl::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{dataset(),
+                                           strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
           iterator_ =
@@ -590,7 +748,28 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
   };  // FileIterator
 
+  // Returns the reader of the complete cache, creating it on the first call.
+  Status GetCacheFileReader(
+      std::shared_ptr<const CacheFileReader>* reader) const {
+    mutex_lock l(cache_file_reader_mu_);
+    if (cache_file_reader_ == nullptr) {
+      std::unique_ptr<CacheFileReader> new_reader;
+      TF_RETURN_IF_ERROR(CacheFileReader::Create(env_, filename_, num_tensors_,
+                                                 &new_reader));
+      cache_file_reader_ = std::move(new_reader);
+    }
+    *reader = cache_file_reader_;
+    return Status::OK();
+  }
+
   Env* const env_;
+  // If non-negative, a complete cache is read in a random order seeded by
+  // this value (or by a random seed if it is zero).
+  const int64 shuffle_seed_;
+  mutable std::atomic<int64> num_shuffled_iterators_{0};
+  mutable mutex cache_file_reader_mu_;
+  mutable std::shared_ptr<const CacheFileReader> cache_file_reader_
+      TF_GUARDED_BY(cache_file_reader_mu_);
   const size_t num_tensors_;
   const size_t tensor_index_padding_size_;
   static constexpr size_t kMaxItems = 10000000;  // 10 million
@@ -618,9 +797,9 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, Env* env, int64 shuffle_seed,
                          const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+      : FileDatasetBase(ctx, input, filename, env, shuffle_seed),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -1051,11 +1230,17 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       *output = new MemoryDataset(ctx, input, manager, std::move(handle));
     }
   } else {
+    // Reading a complete cache in a random order shuffles each epoch over it
+    // without an in-memory shuffle buffer, but changes the order of the
+    // elements, so this is opt-in. Zero picks a random seed for each epoch.
+    int64 shuffle_seed = -1;
+    OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_DATA_CACHE_SHUFFLE_SEED",
+                                            /*default_val=*/-1, &shuffle_seed));
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, ctx->env(),
+                                  shuffle_seed, ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env(), shuffle_seed);
     }
   }
 }
@@ -0,0 +1,243 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_file_reader.h"
+
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The key of the header entry of a tensor bundle.
+constexpr char kHeaderEntryKey[] = "";
+
+// Decodes a string tensor in the format written by `BundleWriter`: the varint
+// lengths of the strings, the masked checksum of the lengths, and the bytes of
+// the strings. Extends `*crc32c` with the checksum of `bytes`.
+Status DecodeStringTensor(StringPiece bytes, Tensor* tensor, uint32* crc32c) {
+  const char* p = bytes.data();
+  const char* const limit = bytes.data() + bytes.size();
+  const int64 num_elements = tensor->NumElements();
+  std::vector<uint64> lengths(num_elements);
+  for (int64 i = 0; i < num_elements; ++i) {
+    p = core::GetVarint64Ptr(p, limit, &lengths[i]);
+    if (p == nullptr) {
+      return errors::DataLoss("Truncated string lengths");
+    }
+    // The checksum covers each length as a fixed-size integer, using 32 bits
+    // when the length fits.
+    if (lengths[i] <= UINT32_MAX) {
+      const uint32 length = static_cast<uint32>(lengths[i]);
+      *crc32c = crc32c::Extend(
+          *crc32c, reinterpret_cast<const char*>(&length), sizeof(length));
+    } else {
+      *crc32c = crc32c::Extend(
+          *crc32c, reinterpret_cast<const char*>(&lengths[i]), sizeof(uint64));
+    }
+  }
+  uint32 length_checksum;
+  if (static_cast<size_t>(limit - p) < sizeof(length_checksum)) {
+    return errors::DataLoss("Truncated string length checksum");
+  }
+  std::memcpy(&length_checksum, p, sizeof(length_checksum));
+  if (crc32c::Unmask(length_checksum) != *crc32c) {
+    return errors::DataLoss("The length checksum does not match");
+  }
+  *crc32c = crc32c::Extend(*crc32c, p, sizeof(length_checksum));
+  p += sizeof(length_checksum);
+
+  tstring* strings = tensor->flat<tstring>().data();
+  for (int64 i = 0; i < num_elements; ++i) {
+    if (lengths[i] > static_cast<uint64>(limit - p)) {
+      return errors::DataLoss("Truncated string data");
+    }
+    strings[i].assign(p, lengths[i]);
+    *crc32c = crc32c::Extend(*crc32c, p, lengths[i]);
+    p += lengths[i];
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+CacheFileReader::CacheFileReader(size_t num_tensors,
+                                 std::unique_ptr<BundleReader> bundle)
+    : num_tensors_(num_tensors), bundle_(std::move(bundle)) {}
+
+/* static */
+Status CacheFileReader::Create(Env* env, const string& prefix,
+                               size_t num_tensors,
+                               std::unique_ptr<CacheFileReader>* reader) {
+  if (num_tensors == 0) {
+    return errors::InvalidArgument(
+        "Cache elements must have at least one component");
+  }
+  auto bundle = absl::make_unique<BundleReader>(env, prefix);
+  TF_RETURN_IF_ERROR(bundle->status());
+  BundleReader* bundle_reader = bundle.get();
+  reader->reset(new CacheFileReader(num_tensors, std::move(bundle)));
+  CacheFileReader* r = reader->get();
+
+  bundle_reader->Seek(kHeaderEntryKey);
+  BundleHeaderProto header;
+  if (!bundle_reader->Valid() ||
+      !header.ParseFromArray(bundle_reader->value().data(),
+                             bundle_reader->value().size())) {
+    return errors::DataLoss("Unable to read the header of the cache at ",
+                            prefix);
+  }
+  r->need_to_swap_bytes_ =
+      (header.endianness() == BundleHeaderProto::BIG) == port::kLittleEndian;
+
+  for (bundle_reader->Next(); bundle_reader->Valid(); bundle_reader->Next()) {
+    BundleEntryProto entry;
+    if (!entry.ParseFromArray(bundle_reader->value().data(),
+                              bundle_reader->value().size())) {
+      return errors::DataLoss("Entry for key ", bundle_reader->key(),
+                              " of the cache at ", prefix, " not parseable.");
+    }
+    if (!entry.slices().empty() || !TensorShape::IsValid(entry.shape()) ||
+        entry.shard_id() < 0 || entry.shard_id() >= header.num_shards() ||
+        entry.offset() < 0 || entry.size() < 0) {
+      return errors::DataLoss("Invalid entry for key ", bundle_reader->key(),
+                              " of the cache at ", prefix);
+    }
+    r->keys_.emplace_back(bundle_reader->key());
+    r->entries_.push_back(std::move(entry));
+  }
+  if (r->entries_.size() % num_tensors != 0) {
+    return errors::DataLoss("The cache at ", prefix, " holds ",
+                            r->entries_.size(), " tensors, which is not a ",
+                            "multiple of the number of components ",
+                            num_tensors);
+  }
+
+  r->data_files_.resize(header.num_shards());
+  for (int32 shard = 0; shard < header.num_shards(); ++shard) {
+    const string filename = DataFilename(prefix, shard, header.num_shards());
+    DataFile& data_file = r->data_files_[shard];
+    Status s =
+        env->NewReadOnlyMemoryRegionFromFile(filename, &data_file.region);
+    if (!s.ok()) {
+      VLOG(2) << "Reading " << filename << " without mapping it: " << s;
+      data_file.region.reset();
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &data_file.file));
+    }
+  }
+  return Status::OK();
+}
+
+Status CacheFileReader::Read(int64 index,
+                             std::vector<Tensor>* out_tensors) const {
+  if (index < 0 || index >= num_elements()) {
+    return errors::OutOfRange("Element ", index, " is not in a cache of ",
+                              num_elements(), " elements");
+  }
+  out_tensors->clear();
+  out_tensors->resize(num_tensors_);
+  for (size_t i = 0; i < num_tensors_; ++i) {
+    TF_RETURN_IF_ERROR(
+        ReadTensor(index * num_tensors_ + i, &(*out_tensors)[i]));
+  }
+  return Status::OK();
+}
+
+Status CacheFileReader::ReadTensor(size_t i, Tensor* tensor) const {
+  const BundleEntryProto& entry = entries_[i];
+  *tensor = Tensor(entry.dtype(), TensorShape(entry.shape()));
+  if (entry.dtype() == DT_VARIANT || need_to_swap_bytes_) {
+    mutex_lock l(mu_);
+    return bundle_->Lookup(keys_[i], tensor);
+  }
+
+  uint32 actual_crc32c = 0;
+  if (DataTypeCanUseMemcpy(entry.dtype())) {
+    if (static_cast<size_t>(entry.size()) != tensor->TotalBytes()) {
+      return errors::DataLoss("Invalid size in cache entry: key ", keys_[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", tensor->TotalBytes());
+    }
+    char* buffer = const_cast<char*>(tensor->tensor_data().data());
+    StringPiece bytes;
+    TF_RETURN_IF_ERROR(ReadBytes(entry, buffer, &bytes));
+    if (bytes.data() != buffer) {
+      std::memcpy(buffer, bytes.data(), bytes.size());
+    }
+    actual_crc32c = crc32c::Value(buffer, entry.size());
+  } else if (entry.dtype() == DT_STRING) {
+    if (entry.size() > 0) {
+      string scratch;
+      if (data_files_[entry.shard_id()].region == nullptr) {
+        scratch.resize(entry.size());
+      }
+      StringPiece bytes;
+      TF_RETURN_IF_ERROR(ReadBytes(entry, &scratch[0], &bytes));
+      TF_RETURN_IF_ERROR(DecodeStringTensor(bytes, tensor, &actual_crc32c));
+    }
+  } else {
+    return errors::Unimplemented("Unsupported dtype ",
+                                 DataTypeString(entry.dtype()),
+                                 " in cache entry: key ", keys_[i]);
+  }
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss("Checksum does not match for cache entry: key ",
+                            keys_[i]);
+  }
+  return Status::OK();
+}
+
+Status CacheFileReader::ReadBytes(const BundleEntryProto& entry, char* scratch,
+                                  StringPiece* bytes) const {
+  const DataFile& data_file = data_files_[entry.shard_id()];
+  const uint64 offset = entry.offset();
+  const uint64 size = entry.size();
+  if (data_file.region != nullptr) {
+    const uint64 length = data_file.region->length();
+    if (offset > length || size > length - offset) {
+      return errors::DataLoss("Cache entry at offset ", offset, " of size ",
+                              size, " extends past the end of data file ",
+                              entry.shard_id());
+    }
+    *bytes = StringPiece(
+        static_cast<const char*>(data_file.region->data()) + offset, size);
+    return Status::OK();
+  }
+  if (size == 0) {
+    *bytes = StringPiece();
+    return Status::OK();
+  }
+  Status s = data_file.file->Read(offset, size, bytes, scratch);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (bytes->size() != size) {
+    return errors::DataLoss("Cache entry at offset ", offset, " of size ",
+                            size, " extends past the end of data file ",
+                            entry.shard_id());
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_FILE_READER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_CACHE_FILE_READER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace data {
+
+// Reads the elements of a complete file cache written by `CacheDataset` in any
+// order.
+//
+// The cache is a tensor bundle whose keys sort in element order, and whose
+// metadata table gives the data file, offset and size of each component. The
+// reader loads the metadata into an in-memory index once, so that reading an
+// element does not touch the metadata table, and maps the data files into
+// memory when the file system supports it (falling back to positional reads
+// otherwise).
+//
+// `Read()` is thread safe and does not take a lock, so that several iterators
+// can share a reader. The exceptions are variant tensors and bundles written
+// with a different endianness, which are read with a `BundleReader` under a
+// lock.
+class CacheFileReader {
+ public:
+  // Creates a reader for the cache with prefix `prefix`, whose elements have
+  // `num_tensors` components.
+  static Status Create(Env* env, const string& prefix, size_t num_tensors,
+                       std::unique_ptr<CacheFileReader>* reader);
+
+  // Returns the number of elements in the cache.
+  int64 num_elements() const { return entries_.size() / num_tensors_; }
+
+  // Reads the components of the element at `index` into `*out_tensors`.
+  Status Read(int64 index, std::vector<Tensor>* out_tensors) const;
+
+ private:
+  // A data file of the bundle, either mapped into memory or opened for
+  // positional reads.
+  struct DataFile {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    std::unique_ptr<RandomAccessFile> file;
+  };
+
+  CacheFileReader(size_t num_tensors, std::unique_ptr<BundleReader> bundle);
+
+  // Reads the tensor described by `entries_[i]` into `*tensor`.
+  Status ReadTensor(size_t i, Tensor* tensor) const;
+
+  // Sets `*bytes` to the data of `entry`. `scratch` must hold `entry.size()`
+  // bytes and is used if the data file is not mapped.
+  Status ReadBytes(const BundleEntryProto& entry, char* scratch,
+                   StringPiece* bytes) const;
+
+  const size_t num_tensors_;
+  // The key and metadata of each tensor of the cache, in element order.
+  std::vector<string> keys_;
+  std::vector<BundleEntryProto> entries_;
+  // Indexed by shard id.
+  std::vector<DataFile> data_files_;
+  bool need_to_swap_bytes_ = false;
+
+  // Reads the tensors that are not decoded by `ReadTensor()` itself.
+  mutable mutex mu_;
+  const std::unique_ptr<BundleReader> bundle_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CacheFileReader);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_CACHE_FILE_READER_H_
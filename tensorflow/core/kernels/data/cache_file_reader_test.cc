@@ -0,0 +1,158 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_file_reader.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns the components of element `i`: a float vector and a string vector
+// whose sizes depend on `i`.
+std::vector<Tensor> Element(int64 i) {
+  Tensor floats(DT_FLOAT, TensorShape({i % 4}));
+  for (int64 j = 0; j < floats.NumElements(); ++j) {
+    floats.flat<float>()(j) = i + 0.5f * j;
+  }
+  Tensor strings(DT_STRING, TensorShape({2}));
+  strings.flat<tstring>()(0) = strings::StrCat("element ", i);
+  strings.flat<tstring>()(1) = string(i * 10, 'x');
+  return {floats, strings};
+}
+
+// Writes elements [begin, end) to a bundle with prefix `prefix`, with the keys
+// used by `CacheDataset`.
+void WriteElements(const string& prefix, int64 begin, int64 end) {
+  BundleWriter writer(Env::Default(), prefix);
+  for (int64 i = begin; i < end; ++i) {
+    std::vector<Tensor> element = Element(i);
+    for (size_t j = 0; j < element.size(); ++j) {
+      TF_ASSERT_OK(writer.Add(strings::Printf("%07lld_%zu",
+                                              static_cast<long long>(i), j),
+                              element[j]));
+    }
+  }
+  TF_ASSERT_OK(writer.Finish());
+}
+
+void ExpectElement(int64 i, const std::vector<Tensor>& element) {
+  std::vector<Tensor> expected = Element(i);
+  ASSERT_EQ(expected.size(), element.size());
+  test::ExpectTensorEqual<float>(expected[0], element[0]);
+  test::ExpectTensorEqual<tstring>(expected[1], element[1]);
+}
+
+TEST(CacheFileReaderTest, ReadsElementsInAnyOrder) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "any_order");
+  WriteElements(prefix, 0, 20);
+  std::unique_ptr<CacheFileReader> reader;
+  TF_ASSERT_OK(CacheFileReader::Create(Env::Default(), prefix,
+                                       /*num_tensors=*/2, &reader));
+  EXPECT_EQ(20, reader->num_elements());
+  for (int64 i : {7, 0, 19, 3, 3, 12}) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Read(i, &element));
+    ExpectElement(i, element);
+  }
+}
+
+TEST(CacheFileReaderTest, ReadsMergedShards) {
+  const string dir = testing::TmpDir();
+  const string prefix = io::JoinPath(dir, "merged");
+  const string shard0 = io::JoinPath(dir, "merged_0");
+  const string shard1 = io::JoinPath(dir, "merged_1");
+  WriteElements(shard0, 0, 5);
+  WriteElements(shard1, 5, 12);
+  TF_ASSERT_OK(MergeBundles(Env::Default(), {shard0, shard1}, prefix));
+  std::unique_ptr<CacheFileReader> reader;
+  TF_ASSERT_OK(CacheFileReader::Create(Env::Default(), prefix,
+                                       /*num_tensors=*/2, &reader));
+  ASSERT_EQ(12, reader->num_elements());
+  for (int64 i = 11; i >= 0; --i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Read(i, &element));
+    ExpectElement(i, element);
+  }
+}
+
+TEST(CacheFileReaderTest, ConcurrentReads) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "concurrent");
+  WriteElements(prefix, 0, 100);
+  std::unique_ptr<CacheFileReader> reader;
+  TF_ASSERT_OK(CacheFileReader::Create(Env::Default(), prefix,
+                                       /*num_tensors=*/2, &reader));
+  {
+    thread::ThreadPool pool(Env::Default(), "concurrent_reads", 4);
+    for (int thread = 0; thread < 4; ++thread) {
+      pool.Schedule([&reader, thread]() {
+        for (int64 i = thread; i < 100; i += 4) {
+          std::vector<Tensor> element;
+          TF_EXPECT_OK(reader->Read(i, &element));
+          ExpectElement(i, element);
+        }
+      });
+    }
+  }
+}
+
+TEST(CacheFileReaderTest, ElementOutOfRange) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "out_of_range");
+  WriteElements(prefix, 0, 3);
+  std::unique_ptr<CacheFileReader> reader;
+  TF_ASSERT_OK(CacheFileReader::Create(Env::Default(), prefix,
+                                       /*num_tensors=*/2, &reader));
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Read(3, &element)));
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Read(-1, &element)));
+}
+
+TEST(CacheFileReaderTest, WrongNumberOfComponents) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "wrong_components");
+  WriteElements(prefix, 0, 5);
+  std::unique_ptr<CacheFileReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(CacheFileReader::Create(
+      Env::Default(), prefix, /*num_tensors=*/3, &reader)));
+}
+
+TEST(CacheFileReaderTest, CorruptedData) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "corrupted");
+  WriteElements(prefix, 0, 5);
+  const string data_filename = DataFilename(prefix, 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), data_filename, &data));
+  data[data.size() - 1] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), data_filename, data));
+
+  std::unique_ptr<CacheFileReader> reader;
+  TF_ASSERT_OK(CacheFileReader::Create(Env::Default(), prefix,
+                                       /*num_tensors=*/2, &reader));
+  std::vector<Tensor> element;
+  TF_EXPECT_OK(reader->Read(0, &element));
+  EXPECT_TRUE(errors::IsDataLoss(reader->Read(4, &element)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
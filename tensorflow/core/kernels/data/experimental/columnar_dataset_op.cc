@@ -0,0 +1,527 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_file.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kBatchSize;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterLowerBounds;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterUpperBounds;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kNextRowGroup[] = "next_row_group";
+constexpr char kGroupOffset[] = "group_offset";
+
+namespace {
+
+// Keeps the rows of a column whose values are in [lower, upper].
+struct ColumnFilter {
+  std::string column;
+  double lower;
+  double upper;
+};
+
+template <typename T>
+void ApplyFilter(const Tensor& values, const ColumnFilter& filter,
+                 std::vector<bool>* keep) {
+  auto vec = values.vec<T>();
+  for (int64 i = 0; i < vec.size(); ++i) {
+    const double v = static_cast<double>(vec(i));
+    if (!(v >= filter.lower && v <= filter.upper)) (*keep)[i] = false;
+  }
+}
+
+}  // namespace
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<string> columns, int64 batch_size,
+          std::vector<ColumnFilter> filters, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        batch_size_(batch_size),
+        filters_(std::move(filters)),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    std::vector<tstring> filter_columns;
+    std::vector<double> filter_lower_bounds;
+    std::vector<double> filter_upper_bounds;
+    for (const ColumnFilter& filter : filters_) {
+      filter_columns.push_back(filter.column);
+      filter_lower_bounds.push_back(filter.lower);
+      filter_upper_bounds.push_back(filter.upper);
+    }
+    Node* filenames = nullptr;
+    Node* columns = nullptr;
+    Node* batch_size = nullptr;
+    Node* filter_columns_node = nullptr;
+    Node* filter_lower_bounds_node = nullptr;
+    Node* filter_upper_bounds_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    TF_RETURN_IF_ERROR(b->AddVector(filter_columns, &filter_columns_node));
+    TF_RETURN_IF_ERROR(
+        b->AddVector(filter_lower_bounds, &filter_lower_bounds_node));
+    TF_RETURN_IF_ERROR(
+        b->AddVector(filter_upper_bounds, &filter_upper_bounds_node));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {filenames, columns, batch_size, filter_columns_node,
+         filter_lower_bounds_node, filter_upper_bounds_node},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      // Rows [offset, offset + size) of the columns of a row group.
+      struct Slice {
+        std::vector<Tensor> columns;
+        int64 offset;
+        int64 size;
+      };
+      std::vector<Slice> slices;
+      int64 num_rows = 0;
+      while (num_rows < dataset()->batch_size_) {
+        if (group_offset_ < group_rows_) {
+          const int64 size = std::min(dataset()->batch_size_ - num_rows,
+                                      group_rows_ - group_offset_);
+          slices.push_back({group_, group_offset_, size});
+          group_offset_ += size;
+          num_rows += size;
+          continue;
+        }
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(LoadNextRowGroupLocked(ctx, &end_of_input));
+        if (end_of_input) break;
+      }
+      if (num_rows == 0) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      *end_of_sequence = false;
+
+      out_tensors->reserve(dataset()->columns_.size());
+      for (int i = 0; i < dataset()->columns_.size(); ++i) {
+        if (slices.size() == 1) {
+          // The batch aliases the buffer of the row group when it can.
+          const Slice& slice = slices[0];
+          Tensor batch =
+              slice.columns[i].Slice(slice.offset, slice.offset + slice.size);
+          if (batch.IsAligned()) {
+            out_tensors->push_back(std::move(batch));
+            continue;
+          }
+        }
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        out_tensors->emplace_back(ctx->allocator(attr),
+                                  dataset()->output_types_[i],
+                                  TensorShape({num_rows}));
+        int64 dst_offset = 0;
+        for (const Slice& slice : slices) {
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              slice.columns[i], slice.offset, dst_offset, slice.size,
+              &out_tensors->back()));
+          dst_offset += slice.size;
+        }
+      }
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
+                                             current_file_index_));
+      // `reader_` is empty before the first GetNext and once all files have
+      // been read.
+      if (reader_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kNextRowGroup), next_row_group_));
+        if (group_rows_ > 0) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kGroupOffset), group_offset_));
+        }
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      ResetRowGroupLocked();
+      reader_.reset();
+      int64 current_file_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
+                                            &current_file_index));
+      current_file_index_ = current_file_index;
+      if (!reader->Contains(full_name(kNextRowGroup))) {
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+      int64 next_row_group;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextRowGroup), &next_row_group));
+      if (next_row_group < 0 ||
+          next_row_group > reader_->footer().row_groups_size()) {
+        return errors::DataLoss("Invalid row group ", next_row_group,
+                                " in checkpoint.");
+      }
+      next_row_group_ = next_row_group;
+      if (reader->Contains(full_name(kGroupOffset))) {
+        // Filtering the row group again gives back the same rows.
+        TF_RETURN_IF_ERROR(ReadRowGroupLocked(ctx, next_row_group_ - 1));
+        int64 group_offset;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kGroupOffset), &group_offset));
+        if (group_offset < 0 || group_offset > group_rows_) {
+          return errors::DataLoss("Invalid row group offset ", group_offset,
+                                  " in checkpoint.");
+        }
+        group_offset_ = group_offset;
+      }
+      return Status::OK();
+    }
+
+   private:
+    // Opens the file `current_file_index_` and finds the columns to read.
+    Status OpenFileLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_file_index_ >= dataset()->filenames_.size()) {
+        return errors::InvalidArgument(
+            "current_file_index_:", current_file_index_,
+            " >= filenames_.size():", dataset()->filenames_.size());
+      }
+      const string& filename = dataset()->filenames_[current_file_index_];
+      std::unique_ptr<ColumnarFileReader> file_reader;
+      TF_RETURN_IF_ERROR(
+          ColumnarFileReader::Open(env, filename, &file_reader));
+
+      const ColumnarFileFooter& footer = file_reader->footer();
+      column_indices_.clear();
+      for (int i = 0; i < dataset()->columns_.size(); ++i) {
+        const string& name = dataset()->columns_[i];
+        const int column = file_reader->FindColumn(name);
+        if (column < 0) {
+          return errors::InvalidArgument("Column ", name, " not found in ",
+                                         filename);
+        }
+        if (footer.columns(column).dtype() != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", name, " of ", filename, " has type ",
+              DataTypeString(footer.columns(column).dtype()), " but ",
+              DataTypeString(dataset()->output_types_[i]), " was requested.");
+        }
+        column_indices_.push_back(column);
+      }
+      filter_indices_.clear();
+      for (const ColumnFilter& filter : dataset()->filters_) {
+        const int column = file_reader->FindColumn(filter.column);
+        if (column < 0) {
+          return errors::InvalidArgument("Filter column ", filter.column,
+                                         " not found in ", filename);
+        }
+        if (!HasColumnarStatistics(footer.columns(column).dtype())) {
+          return errors::InvalidArgument(
+              "Filter column ", filter.column, " of ", filename,
+              " must be numeric, got ",
+              DataTypeString(footer.columns(column).dtype()));
+        }
+        filter_indices_.push_back(column);
+      }
+      reader_ = std::move(file_reader);
+      next_row_group_ = 0;
+      return Status::OK();
+    }
+
+    // Reads the next row group with rows satisfying the filters, moving on to
+    // the next files as needed.
+    Status LoadNextRowGroupLocked(IteratorContext* ctx, bool* end_of_input)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ResetRowGroupLocked();
+      while (true) {
+        if (!reader_) {
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_input = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+        }
+        const ColumnarFileFooter& footer = reader_->footer();
+        while (next_row_group_ < footer.row_groups_size()) {
+          const int row_group = next_row_group_++;
+          if (!MayMatchFilters(footer.row_groups(row_group))) continue;
+          TF_RETURN_IF_ERROR(ReadRowGroupLocked(ctx, row_group));
+          if (group_rows_ > 0) return Status::OK();
+        }
+        reader_.reset();
+        ++current_file_index_;
+      }
+    }
+
+    // Returns false if the statistics of `row_group` show that none of its
+    // rows satisfies all the filters.
+    bool MayMatchFilters(const ColumnarFileFooter::RowGroup& row_group) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int i = 0; i < filter_indices_.size(); ++i) {
+        const ColumnFilter& filter = dataset()->filters_[i];
+        const auto& chunk = row_group.chunks(filter_indices_[i]);
+        if (chunk.max() < filter.lower || chunk.min() > filter.upper) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Reads the projected columns of `row_group`, keeping only the rows that
+    // satisfy the filters.
+    Status ReadRowGroupLocked(IteratorContext* ctx, int row_group)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      ResetRowGroupLocked();
+      Allocator* allocator = ctx->allocator({});
+      const auto& group = reader_->footer().row_groups(row_group);
+      const int64 num_rows = group.num_rows();
+
+      std::vector<bool> keep;
+      if (!filter_indices_.empty()) {
+        keep.assign(num_rows, true);
+        for (int i = 0; i < filter_indices_.size(); ++i) {
+          Tensor values;
+          TF_RETURN_IF_ERROR(reader_->ReadColumn(row_group, filter_indices_[i],
+                                                 allocator, &values));
+          bytes_counter->IncrementBy(
+              group.chunks(filter_indices_[i]).size());
+          const ColumnFilter& filter = dataset()->filters_[i];
+          switch (values.dtype()) {
+            case DT_FLOAT:
+              ApplyFilter<float>(values, filter, &keep);
+              break;
+            case DT_DOUBLE:
+              ApplyFilter<double>(values, filter, &keep);
+              break;
+            case DT_INT32:
+              ApplyFilter<int32>(values, filter, &keep);
+              break;
+            case DT_INT64:
+              ApplyFilter<int64>(values, filter, &keep);
+              break;
+            default:
+              return errors::Internal("Unexpected filter column type ",
+                                      DataTypeString(values.dtype()));
+          }
+        }
+      }
+      const int64 num_kept =
+          keep.empty() ? num_rows : std::count(keep.begin(), keep.end(), true);
+      if (num_kept == 0) return Status::OK();
+
+      std::vector<Tensor> columns(column_indices_.size());
+      for (int i = 0; i < column_indices_.size(); ++i) {
+        TF_RETURN_IF_ERROR(reader_->ReadColumn(row_group, column_indices_[i],
+                                               allocator, &columns[i]));
+        bytes_counter->IncrementBy(group.chunks(column_indices_[i]).size());
+        if (num_kept == num_rows) continue;
+        // Compact the kept rows, one run of consecutive rows at a time.
+        Tensor compacted(allocator, columns[i].dtype(),
+                         TensorShape({num_kept}));
+        int64 dst_offset = 0;
+        for (int64 row = 0; row < num_rows;) {
+          if (!keep[row]) {
+            ++row;
+            continue;
+          }
+          int64 end = row + 1;
+          while (end < num_rows && keep[end]) ++end;
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              columns[i], row, dst_offset, end - row, &compacted));
+          dst_offset += end - row;
+          row = end;
+        }
+        columns[i] = std::move(compacted);
+      }
+      group_ = std::move(columns);
+      group_rows_ = num_kept;
+      return Status::OK();
+    }
+
+    void ResetRowGroupLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      group_.clear();
+      group_rows_ = 0;
+      group_offset_ = 0;
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<ColumnarFileReader> reader_ TF_GUARDED_BY(mu_);
+    // Indices in the current file of the projected and filter columns.
+    std::vector<int> column_indices_ TF_GUARDED_BY(mu_);
+    std::vector<int> filter_indices_ TF_GUARDED_BY(mu_);
+    // Index of the next row group of the current file to consider.
+    int64 next_row_group_ TF_GUARDED_BY(mu_) = 0;
+    // Projected columns of the row group being read, holding only the rows
+    // satisfying the filters, and the number of rows already produced.
+    std::vector<Tensor> group_ TF_GUARDED_BY(mu_);
+    int64 group_rows_ TF_GUARDED_BY(mu_) = 0;
+    int64 group_offset_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const std::vector<string> filenames_;
+  const std::vector<string> columns_;
+  const int64 batch_size_;
+  const std::vector<ColumnFilter> filters_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+
+  const Tensor* columns_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kColumns, &columns_tensor));
+  OP_REQUIRES(ctx, columns_tensor->dims() == 1,
+              errors::InvalidArgument("`columns` must be a vector."));
+  OP_REQUIRES(ctx, columns_tensor->NumElements() == output_types_.size(),
+              errors::InvalidArgument(
+                  "`columns` has ", columns_tensor->NumElements(),
+                  " elements but there are ", output_types_.size(),
+                  " output types."));
+  std::vector<string> columns;
+  columns.reserve(columns_tensor->NumElements());
+  for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+    columns.push_back(columns_tensor->vec<tstring>()(i));
+  }
+
+  int64 batch_size = 0;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("`batch_size` must be positive."));
+
+  const Tensor* filter_columns;
+  OP_REQUIRES_OK(ctx, ctx->input(kFilterColumns, &filter_columns));
+  const Tensor* filter_lower_bounds;
+  OP_REQUIRES_OK(ctx, ctx->input(kFilterLowerBounds, &filter_lower_bounds));
+  const Tensor* filter_upper_bounds;
+  OP_REQUIRES_OK(ctx, ctx->input(kFilterUpperBounds, &filter_upper_bounds));
+  OP_REQUIRES(
+      ctx,
+      filter_columns->dims() == 1 &&
+          filter_lower_bounds->shape() == filter_columns->shape() &&
+          filter_upper_bounds->shape() == filter_columns->shape(),
+      errors::InvalidArgument("`filter_columns`, `filter_lower_bounds` and "
+                              "`filter_upper_bounds` must be vectors of the "
+                              "same size."));
+  std::vector<ColumnFilter> filters;
+  filters.reserve(filter_columns->NumElements());
+  for (int i = 0; i < filter_columns->NumElements(); ++i) {
+    filters.push_back({filter_columns->vec<tstring>()(i),
+                       filter_lower_bounds->vec<double>()(i),
+                       filter_upper_bounds->vec<double>()(i)});
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                        batch_size, std::move(filters), output_types_,
+                        output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,347 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_file.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "columnar_dataset";
+
+tstring LocalTempFilename() {
+  std::string path;
+  CHECK(Env::Default()->LocalTempFilename(&path));
+  return tstring(path);
+}
+
+class ColumnarDatasetParams : public DatasetParams {
+ public:
+  ColumnarDatasetParams(std::vector<tstring> filenames,
+                        std::vector<tstring> columns, int64 batch_size,
+                        std::vector<tstring> filter_columns,
+                        std::vector<double> filter_lower_bounds,
+                        std::vector<double> filter_upper_bounds,
+                        DataTypeVector output_dtypes, string node_name)
+      : DatasetParams(output_dtypes,
+                      std::vector<PartialTensorShape>(output_dtypes.size(),
+                                                      PartialTensorShape({-1})),
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        batch_size_(batch_size),
+        filter_columns_(std::move(filter_columns)),
+        filter_lower_bounds_(std::move(filter_lower_bounds)),
+        filter_upper_bounds_(std::move(filter_upper_bounds)) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    const int num_filters = filter_columns_.size();
+    return {
+        CreateTensor<tstring>(
+            TensorShape({static_cast<int64>(filenames_.size())}), filenames_),
+        CreateTensor<tstring>(
+            TensorShape({static_cast<int64>(columns_.size())}), columns_),
+        CreateTensor<int64>(TensorShape({}), {batch_size_}),
+        CreateTensor<tstring>(TensorShape({num_filters}), filter_columns_),
+        CreateTensor<double>(TensorShape({num_filters}), filter_lower_bounds_),
+        CreateTensor<double>(TensorShape({num_filters}),
+                             filter_upper_bounds_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ColumnarDatasetOp::kFileNames,
+                    ColumnarDatasetOp::kColumns,
+                    ColumnarDatasetOp::kBatchSize,
+                    ColumnarDatasetOp::kFilterColumns,
+                    ColumnarDatasetOp::kFilterLowerBounds,
+                    ColumnarDatasetOp::kFilterUpperBounds};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attributes) const override {
+    *attributes = {{ColumnarDatasetOp::kOutputTypes, output_dtypes_},
+                   {ColumnarDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return ColumnarDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  std::vector<tstring> columns_;
+  int64 batch_size_;
+  std::vector<tstring> filter_columns_;
+  std::vector<double> filter_lower_bounds_;
+  std::vector<double> filter_upper_bounds_;
+};
+
+class ColumnarDatasetOpTest : public DatasetOpsTestBase {};
+
+// A row group of the test files, with one value per row in each column.
+struct TestRowGroup {
+  std::vector<int64> ids;
+  std::vector<float> scores;
+  std::vector<tstring> names;
+};
+
+Status CreateTestFile(const tstring& filename,
+                      const std::vector<TestRowGroup>& row_groups) {
+  ColumnarFileWriter writer(filename, {"id", "score", "name"},
+                            {DT_INT64, DT_FLOAT, DT_STRING});
+  TF_RETURN_IF_ERROR(writer.Initialize(Env::Default()));
+  for (const TestRowGroup& group : row_groups) {
+    const int64 num_rows = group.ids.size();
+    TF_RETURN_IF_ERROR(writer.WriteRowGroup(
+        {CreateTensor<int64>(TensorShape({num_rows}), group.ids),
+         CreateTensor<float>(TensorShape({num_rows}), group.scores),
+         CreateTensor<tstring>(TensorShape({num_rows}), group.names)}));
+  }
+  return writer.Close();
+}
+
+// Two files holding the rows 0 to 7, in row groups of sizes 3, 2 and 3.
+std::vector<tstring> CreateTestFiles() {
+  std::vector<tstring> filenames = {LocalTempFilename(), LocalTempFilename()};
+  Status s =
+      CreateTestFile(filenames[0], {{{0, 1, 2}, {1, 2, 3}, {"a", "b", "c"}},
+                                    {{3, 4}, {10, 11}, {"d", "e"}}});
+  if (s.ok()) {
+    s = CreateTestFile(filenames[1], {{{5, 6, 7}, {4, 5, 6}, {"f", "g", "h"}}});
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to create the test files: " << s;
+  }
+  return filenames;
+}
+
+// Test case 1: projects two of the three columns, with batches spanning row
+// groups and files.
+ColumnarDatasetParams ColumnarDatasetParams1() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id", "name"},
+                               /*batch_size=*/2,
+                               /*filter_columns=*/{},
+                               /*filter_lower_bounds=*/{},
+                               /*filter_upper_bounds=*/{},
+                               /*output_dtypes=*/{DT_INT64, DT_STRING},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 2: filters on a column which is not projected. The second row
+// group is skipped using its statistics.
+ColumnarDatasetParams ColumnarDatasetParams2() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id"},
+                               /*batch_size=*/4,
+                               /*filter_columns=*/{"score"},
+                               /*filter_lower_bounds=*/{2.5},
+                               /*filter_upper_bounds=*/{5.0},
+                               /*output_dtypes=*/{DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 3: two filters, with a last partial batch.
+ColumnarDatasetParams ColumnarDatasetParams3() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"score", "id"},
+                               /*batch_size=*/2,
+                               /*filter_columns=*/{"score", "id"},
+                               /*filter_lower_bounds=*/{2.0, 0},
+                               /*filter_upper_bounds=*/{100.0, 6},
+                               /*output_dtypes=*/{DT_FLOAT, DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+// Test case 4: no row satisfies the filter.
+ColumnarDatasetParams ColumnarDatasetParams4() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id"},
+                               /*batch_size=*/2,
+                               /*filter_columns=*/{"score"},
+                               /*filter_lower_bounds=*/{20.0},
+                               /*filter_upper_bounds=*/{30.0},
+                               /*output_dtypes=*/{DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+ColumnarDatasetParams MissingColumnDatasetParams() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"weight"},
+                               /*batch_size=*/2,
+                               /*filter_columns=*/{},
+                               /*filter_lower_bounds=*/{},
+                               /*filter_upper_bounds=*/{},
+                               /*output_dtypes=*/{DT_FLOAT},
+                               /*node_name=*/kNodeName);
+}
+
+ColumnarDatasetParams WrongTypeDatasetParams() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id"},
+                               /*batch_size=*/2,
+                               /*filter_columns=*/{},
+                               /*filter_lower_bounds=*/{},
+                               /*filter_upper_bounds=*/{},
+                               /*output_dtypes=*/{DT_INT32},
+                               /*node_name=*/kNodeName);
+}
+
+ColumnarDatasetParams StringFilterDatasetParams() {
+  return ColumnarDatasetParams(CreateTestFiles(),
+                               /*columns=*/{"id"},
+                               /*batch_size=*/2,
+                               /*filter_columns=*/{"name"},
+                               /*filter_lower_bounds=*/{0},
+                               /*filter_upper_bounds=*/{1},
+                               /*output_dtypes=*/{DT_INT64},
+                               /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> ExpectedOutputs1() {
+  return {CreateTensor<int64>(TensorShape({2}), {0, 1}),
+          CreateTensor<tstring>(TensorShape({2}), {"a", "b"}),
+          CreateTensor<int64>(TensorShape({2}), {2, 3}),
+          CreateTensor<tstring>(TensorShape({2}), {"c", "d"}),
+          CreateTensor<int64>(TensorShape({2}), {4, 5}),
+          CreateTensor<tstring>(TensorShape({2}), {"e", "f"}),
+          CreateTensor<int64>(TensorShape({2}), {6, 7}),
+          CreateTensor<tstring>(TensorShape({2}), {"g", "h"})};
+}
+
+std::vector<Tensor> ExpectedOutputs2() {
+  return {CreateTensor<int64>(TensorShape({3}), {2, 5, 6})};
+}
+
+std::vector<Tensor> ExpectedOutputs3() {
+  return {CreateTensor<float>(TensorShape({2}), {2, 3}),
+          CreateTensor<int64>(TensorShape({2}), {1, 2}),
+          CreateTensor<float>(TensorShape({2}), {10, 11}),
+          CreateTensor<int64>(TensorShape({2}), {3, 4}),
+          CreateTensor<float>(TensorShape({2}), {4, 5}),
+          CreateTensor<int64>(TensorShape({2}), {5, 6})};
+}
+
+std::vector<GetNextTestCase<ColumnarDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/ColumnarDatasetParams1(),
+           /*expected_outputs=*/ExpectedOutputs1()},
+          {/*dataset_params=*/ColumnarDatasetParams2(),
+           /*expected_outputs=*/ExpectedOutputs2()},
+          {/*dataset_params=*/ColumnarDatasetParams3(),
+           /*expected_outputs=*/ExpectedOutputs3()},
+          {/*dataset_params=*/ColumnarDatasetParams4(),
+           /*expected_outputs=*/{}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(ColumnarDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_INT64, DT_STRING}));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes(
+      {PartialTensorShape({-1}), PartialTensorShape({-1})}));
+}
+
+TEST_F(ColumnarDatasetOpTest, Cardinality) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(ColumnarDatasetOpTest, IteratorOutputDtypes) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorOutputDtypes({DT_INT64, DT_STRING}));
+}
+
+TEST_F(ColumnarDatasetOpTest, IteratorOutputShapes) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorOutputShapes(
+      {PartialTensorShape({-1}), PartialTensorShape({-1})}));
+}
+
+TEST_F(ColumnarDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = ColumnarDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      ColumnarDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/ColumnarDatasetParams1(),
+           /*breakpoints=*/{0, 1, 2, 4, 6},
+           /*expected_outputs=*/ExpectedOutputs1()},
+          {/*dataset_params=*/ColumnarDatasetParams3(),
+           /*breakpoints=*/{0, 1, 3, 5},
+           /*expected_outputs=*/ExpectedOutputs3()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+class ParameterizedInvalidColumnTest
+    : public ColumnarDatasetOpTest,
+      public ::testing::WithParamInterface<ColumnarDatasetParams> {};
+
+TEST_P(ParameterizedInvalidColumnTest, InvalidColumn) {
+  auto dataset_params = GetParam();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+  EXPECT_TRUE(out_tensors.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ColumnarDatasetOpTest, ParameterizedInvalidColumnTest,
+    ::testing::ValuesIn({MissingColumnDatasetParams(), WrongTypeDatasetParams(),
+                         StringFilterDatasetParams()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
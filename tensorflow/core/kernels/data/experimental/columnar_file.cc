@@ -0,0 +1,308 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/columnar_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kMagic[] = "TFCOLMN1";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+// Footer size and trailing magic.
+constexpr size_t kTrailerSize = sizeof(uint64) + kMagicSize;
+
+template <typename T>
+void ComputeStatistics(const Tensor& values,
+                       ColumnarFileFooter::ColumnChunk* chunk) {
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  for (const T value : values.vec<T>()) {
+    const double v = static_cast<double>(value);
+    // Comparisons with NaN are false, so NaNs are skipped.
+    if (v < min) min = v;
+    if (v > max) max = v;
+  }
+  chunk->set_min(min);
+  chunk->set_max(max);
+}
+
+}  // namespace
+
+bool IsColumnarDataType(DataType dtype) {
+  return HasColumnarStatistics(dtype) || dtype == DT_STRING;
+}
+
+bool HasColumnarStatistics(DataType dtype) {
+  switch (dtype) {
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_INT32:
+    case DT_INT64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ColumnarFileWriter::ColumnarFileWriter(
+    const std::string& filename, const std::vector<std::string>& column_names,
+    const DataTypeVector& column_dtypes)
+    : filename_(filename) {
+  DCHECK_EQ(column_names.size(), column_dtypes.size());
+  for (int i = 0; i < column_names.size(); ++i) {
+    ColumnarFileFooter::Column* column = footer_.add_columns();
+    column->set_name(column_names[i]);
+    column->set_dtype(column_dtypes[i]);
+  }
+}
+
+Status ColumnarFileWriter::Initialize(Env* env) {
+  for (const auto& column : footer_.columns()) {
+    if (!IsColumnarDataType(column.dtype())) {
+      return errors::InvalidArgument(
+          "Column ", column.name(), " has unsupported type ",
+          DataTypeString(column.dtype()), " for a columnar file.");
+    }
+  }
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename_, &file_));
+  TF_RETURN_IF_ERROR(file_->Append(StringPiece(kMagic, kMagicSize)));
+  offset_ = kMagicSize;
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::WriteRowGroup(const std::vector<Tensor>& columns) {
+  if (columns.size() != footer_.columns_size()) {
+    return errors::InvalidArgument("Expected ", footer_.columns_size(),
+                                   " columns but got ", columns.size());
+  }
+  const int64 num_rows = columns.empty() ? 0 : columns[0].NumElements();
+  for (int i = 0; i < columns.size(); ++i) {
+    const Tensor& values = columns[i];
+    if (values.dtype() != footer_.columns(i).dtype() || values.dims() != 1 ||
+        values.NumElements() != num_rows) {
+      return errors::InvalidArgument(
+          "Column ", footer_.columns(i).name(), " should be a vector of ",
+          num_rows, " ", DataTypeString(footer_.columns(i).dtype()),
+          " but got ", values.DebugString());
+    }
+  }
+  if (num_rows == 0) return Status::OK();
+
+  ColumnarFileFooter::RowGroup* row_group = footer_.add_row_groups();
+  row_group->set_num_rows(num_rows);
+  for (const Tensor& values : columns) {
+    ColumnarFileFooter::ColumnChunk* chunk = row_group->add_chunks();
+    switch (values.dtype()) {
+      case DT_FLOAT:
+        ComputeStatistics<float>(values, chunk);
+        break;
+      case DT_DOUBLE:
+        ComputeStatistics<double>(values, chunk);
+        break;
+      case DT_INT32:
+        ComputeStatistics<int32>(values, chunk);
+        break;
+      case DT_INT64:
+        ComputeStatistics<int64>(values, chunk);
+        break;
+      default:
+        break;
+    }
+    if (values.dtype() != DT_STRING) {
+      TF_RETURN_IF_ERROR(WriteChunk(values.tensor_data(), chunk));
+      continue;
+    }
+    std::string data;
+    for (const tstring& value : values.vec<tstring>()) {
+      core::PutVarint64(&data, value.size());
+      data.append(value.data(), value.size());
+    }
+    TF_RETURN_IF_ERROR(WriteChunk(data, chunk));
+  }
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::WriteChunk(StringPiece data,
+                                      ColumnarFileFooter::ColumnChunk* chunk) {
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  chunk->set_offset(offset_);
+  chunk->set_size(data.size());
+  chunk->set_crc32c(crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  offset_ += data.size();
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::Close() {
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition("Columnar file ", filename_,
+                                      " is not open.");
+  }
+  std::string trailer;
+  if (!footer_.SerializeToString(&trailer)) {
+    return errors::Internal("Failed to serialize the footer of ", filename_);
+  }
+  const uint64 footer_size = trailer.size();
+  core::PutFixed64(&trailer, footer_size);
+  trailer.append(kMagic, kMagicSize);
+  TF_RETURN_IF_ERROR(file_->Append(trailer));
+  Status s = file_->Close();
+  file_.reset();
+  return s;
+}
+
+ColumnarFileReader::ColumnarFileReader(const std::string& filename,
+                                       std::unique_ptr<RandomAccessFile> file,
+                                       ColumnarFileFooter footer)
+    : filename_(filename), file_(std::move(file)), footer_(std::move(footer)) {}
+
+Status ColumnarFileReader::Open(Env* env, const std::string& filename,
+                                std::unique_ptr<ColumnarFileReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (file_size < kMagicSize + kTrailerSize) {
+    return errors::DataLoss("File ", filename,
+                            " is too small to be a columnar file.");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+
+  char magic[kMagicSize];
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(0, kMagicSize, &result, magic));
+  char trailer[kTrailerSize];
+  StringPiece trailer_result;
+  TF_RETURN_IF_ERROR(file->Read(file_size - kTrailerSize, kTrailerSize,
+                                &trailer_result, trailer));
+  if (result != StringPiece(kMagic, kMagicSize) ||
+      trailer_result.substr(sizeof(uint64)) !=
+          StringPiece(kMagic, kMagicSize)) {
+    return errors::DataLoss("File ", filename, " is not a columnar file.");
+  }
+
+  const uint64 footer_size = core::DecodeFixed64(trailer_result.data());
+  const uint64 data_end = file_size - kTrailerSize;
+  if (footer_size > data_end - kMagicSize) {
+    return errors::DataLoss("Corrupt footer size ", footer_size, " in ",
+                            filename);
+  }
+  std::string footer_data(footer_size, '\0');
+  TF_RETURN_IF_ERROR(file->Read(data_end - footer_size, footer_size, &result,
+                                &footer_data[0]));
+  ColumnarFileFooter footer;
+  if (!footer.ParseFromArray(result.data(), result.size())) {
+    return errors::DataLoss("Could not parse the footer of ", filename);
+  }
+
+  const uint64 chunks_end = data_end - footer_size;
+  for (const auto& column : footer.columns()) {
+    if (!IsColumnarDataType(column.dtype())) {
+      return errors::DataLoss("Column ", column.name(), " of ", filename,
+                              " has unsupported type ",
+                              DataTypeString(column.dtype()));
+    }
+  }
+  for (const auto& row_group : footer.row_groups()) {
+    if (row_group.num_rows() < 0 ||
+        row_group.chunks_size() != footer.columns_size()) {
+      return errors::DataLoss("Corrupt row group in ", filename);
+    }
+    for (const auto& chunk : row_group.chunks()) {
+      if (chunk.offset() < static_cast<int64>(kMagicSize) ||
+          chunk.size() < 0 ||
+          static_cast<uint64>(chunk.offset() + chunk.size()) > chunks_end) {
+        return errors::DataLoss("Column chunk out of bounds in ", filename);
+      }
+    }
+  }
+
+  reader->reset(
+      new ColumnarFileReader(filename, std::move(file), std::move(footer)));
+  return Status::OK();
+}
+
+int ColumnarFileReader::FindColumn(StringPiece name) const {
+  for (int i = 0; i < footer_.columns_size(); ++i) {
+    if (footer_.columns(i).name() == name) return i;
+  }
+  return -1;
+}
+
+Status ColumnarFileReader::ReadColumn(int row_group, int column,
+                                      Allocator* allocator,
+                                      Tensor* values) const {
+  const auto& group = footer_.row_groups(row_group);
+  const auto& chunk = group.chunks(column);
+  const DataType dtype = footer_.columns(column).dtype();
+  *values = Tensor(allocator, dtype, TensorShape({group.num_rows()}));
+
+  std::string string_data;
+  char* scratch;
+  if (dtype == DT_STRING) {
+    string_data.resize(chunk.size());
+    scratch = &string_data[0];
+  } else {
+    if (static_cast<size_t>(chunk.size()) != values->TotalBytes()) {
+      return errors::DataLoss(
+          "Column chunk of ", footer_.columns(column).name(), " in ",
+          filename_, " has ", chunk.size(), " bytes, expected ",
+          values->TotalBytes());
+    }
+    scratch = const_cast<char*>(values->tensor_data().data());
+  }
+  StringPiece data;
+  TF_RETURN_IF_ERROR(file_->Read(chunk.offset(), chunk.size(), &data, scratch));
+  if (data.size() != static_cast<size_t>(chunk.size())) {
+    return errors::DataLoss("Short read of a column chunk in ", filename_);
+  }
+  if (crc32c::Unmask(chunk.crc32c()) !=
+      crc32c::Value(data.data(), data.size())) {
+    return errors::DataLoss("Checksum mismatch in column ",
+                            footer_.columns(column).name(), " of ", filename_);
+  }
+
+  if (dtype != DT_STRING) {
+    // Some file systems return a view of their own buffers.
+    if (data.data() != scratch) {
+      memcpy(scratch, data.data(), data.size());
+    }
+    return Status::OK();
+  }
+  auto strings = values->vec<tstring>();
+  for (int64 i = 0; i < group.num_rows(); ++i) {
+    uint64 length;
+    if (!core::GetVarint64(&data, &length) || length > data.size()) {
+      return errors::DataLoss("Corrupt string column ",
+                              footer_.columns(column).name(), " in ",
+                              filename_);
+    }
+    strings(i).assign(data.data(), length);
+    data.remove_prefix(length);
+  }
+  return Status::OK();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FILE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/protobuf/data/experimental/columnar.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Returns whether columns of type `dtype` can be stored in columnar files.
+bool IsColumnarDataType(DataType dtype);
+
+// Returns whether columnar files keep min/max statistics for columns of type
+// `dtype`.
+bool HasColumnarStatistics(DataType dtype);
+
+// Writes a columnar file, as described in columnar.proto, one row group at a
+// time. Numeric values are stored in host byte order, and strings as a varint
+// length followed by their bytes.
+class ColumnarFileWriter {
+ public:
+  ColumnarFileWriter(const std::string& filename,
+                     const std::vector<std::string>& column_names,
+                     const DataTypeVector& column_dtypes);
+
+  Status Initialize(Env* env);
+
+  // Appends a row group. `columns` holds one vector per column, with the
+  // values of that column for every row of the group.
+  Status WriteRowGroup(const std::vector<Tensor>& columns);
+
+  // Writes the footer and closes the file.
+  Status Close();
+
+ private:
+  Status WriteChunk(StringPiece data, ColumnarFileFooter::ColumnChunk* chunk);
+
+  const std::string filename_;
+  ColumnarFileFooter footer_;
+  std::unique_ptr<WritableFile> file_;
+  int64 offset_ = 0;
+};
+
+// Reads the row groups of a columnar file, one column at a time.
+class ColumnarFileReader {
+ public:
+  // Opens `filename` and reads its footer.
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<ColumnarFileReader>* reader);
+
+  const ColumnarFileFooter& footer() const { return footer_; }
+
+  // Returns the index of the column named `name`, or -1 if there is none.
+  int FindColumn(StringPiece name) const;
+
+  // Reads the values of `column` in `row_group` into a vector allocated with
+  // `allocator`. Numeric values are read straight into the tensor buffer.
+  Status ReadColumn(int row_group, int column, Allocator* allocator,
+                    Tensor* values) const;
+
+ private:
+  ColumnarFileReader(const std::string& filename,
+                     std::unique_ptr<RandomAccessFile> file,
+                     ColumnarFileFooter footer);
+
+  const std::string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  const ColumnarFileFooter footer_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FILE_H_
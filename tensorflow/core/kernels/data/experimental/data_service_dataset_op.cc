@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/local_workers.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
@@ -481,6 +482,28 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // If the task reaches end_of_sequence or is cancelled (e.g. due to a
     // worker dying), GetElement returns Status::OK() without adding to
     // `results_`.
+    // Fetches the next element of `task` from its worker. If the worker runs
+    // in the current process, calls it directly so that the element is
+    // neither serialized nor sent through the loopback interface.
+    Status FetchElement(Task* task, CompressedElement& compressed,
+                        bool& end_of_sequence) TF_LOCKS_EXCLUDED(mu_) {
+      std::shared_ptr<DataServiceWorkerImpl> local_worker =
+          LocalWorkers::Get(task->address);
+      if (!local_worker) {
+        return task->worker->GetElement(task->task_id, compressed,
+                                        end_of_sequence);
+      }
+      GetElementRequest req;
+      req.set_task_id(task->task_id);
+      GetElementResponse resp;
+      TF_RETURN_IF_ERROR(local_worker->GetElement(&req, &resp));
+      end_of_sequence = resp.end_of_sequence();
+      if (!end_of_sequence) {
+        compressed.Swap(resp.mutable_compressed_element());
+      }
+      return Status::OK();
+    }
+
     Status GetElement(Task* task, int64 deadline_micros)
         TF_LOCKS_EXCLUDED(mu_) {
       VLOG(3) << "Getting an element for task id " << task->task_id;
@@ -489,8 +512,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       CompressedElement compressed;
       bool end_of_sequence;
       for (int num_retries = 0;; ++num_retries) {
-        Status s = task->worker->GetElement(task->task_id, compressed,
-                                            end_of_sequence);
+        Status s = FetchElement(task, compressed, end_of_sequence);
         if (s.ok()) {
           break;
         }
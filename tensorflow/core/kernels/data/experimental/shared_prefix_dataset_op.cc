@@ -0,0 +1,444 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/shared_prefix_dataset_op.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/serialization_utils.h"
+#include "tensorflow/core/kernels/data/unbounded_thread_pool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const SharedPrefixDatasetOp::kDatasetType;
+/* static */ constexpr const char* const SharedPrefixDatasetOp::kInputDataset;
+/* static */ constexpr const char* const SharedPrefixDatasetOp::kBufferSize;
+/* static */ constexpr const char* const SharedPrefixDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const SharedPrefixDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kNumElements[] = "num_elements";
+constexpr char kUnshared[] = "unshared";
+
+// Computes the key under which iterators over `input` share a producer, or
+// returns an error if `input` cannot be safely shared. Only inputs that
+// serialize completely and have no external state are shared, so that equal
+// fingerprints imply equal elements.
+Status ComputeSharingKey(OpKernelContext* ctx, const DatasetBase* input,
+                         int64 buffer_size, string* key) {
+  GraphDef graph_def;
+  SerializationContext::Params params;
+  std::vector<std::pair<string, Tensor>> input_list;
+  params.input_list = &input_list;
+  params.external_state_policy =
+      SerializationContext::ExternalStatePolicy::kFail;
+  TF_RETURN_IF_ERROR(
+      AsGraphDef(ctx, input, SerializationContext(params), &graph_def));
+  if (!input_list.empty()) {
+    return errors::Unimplemented(
+        "The input contains datasets that cannot be serialized.");
+  }
+  uint64 hash;
+  TF_RETURN_IF_ERROR(HashGraph(graph_def, &hash));
+  *key = strings::StrCat(ctx->device()->name(), "/", hash, "/", buffer_size);
+  return Status::OK();
+}
+
+// Runs an iterator over the shared input on behalf of any number of consumers.
+// Each consumer tracks its own position; elements are produced on demand by
+// whichever consumer is furthest ahead, and the most recent `buffer_size` of
+// them are kept for the others.
+//
+// The producer owns a copy of the function library runtime and the other
+// per-iterator state of the context it was created from, so that it may
+// outlive the iterator that created it.
+class SharedProducer {
+ public:
+  static Status Create(IteratorContext* ctx, const DatasetBase* input,
+                       const string& prefix, int64 buffer_size,
+                       std::shared_ptr<SharedProducer>* producer) {
+    auto result = std::shared_ptr<SharedProducer>(
+        new SharedProducer(ctx->env(), buffer_size));
+    TF_RETURN_IF_ERROR(result->Initialize(ctx, input, prefix));
+    *producer = std::move(result);
+    return Status::OK();
+  }
+
+  ~SharedProducer() { cancellation_manager_.StartCancel(); }
+
+  // Whether a new consumer can still start reading from the first element.
+  bool Joinable() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    return first_index_ == 0;
+  }
+
+  // Produces the element at position `index` of the input. Sets `*evicted`
+  // instead if that element has already been dropped from the buffer.
+  Status GetElement(int64 index, std::vector<Tensor>* out_tensors,
+                    bool* end_of_sequence, bool* evicted)
+      TF_LOCKS_EXCLUDED(mu_) {
+    *evicted = false;
+    while (true) {
+      {
+        mutex_lock l(mu_);
+        while (producing_ && index >= end_index()) {
+          cond_var_.wait(l);
+        }
+        if (index < first_index_) {
+          *evicted = true;
+          return Status::OK();
+        }
+        if (index < end_index()) {
+          const Element& element = buffer_[index - first_index_];
+          *out_tensors = element.tensors;
+          *end_of_sequence = false;
+          return element.status;
+        }
+        if (end_of_sequence_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        producing_ = true;
+      }
+      Element element;
+      bool end_of_input = false;
+      element.status =
+          input_impl_->GetNext(ctx_.get(), &element.tensors, &end_of_input);
+      mutex_lock l(mu_);
+      producing_ = false;
+      cond_var_.notify_all();
+      if (end_of_input && element.status.ok()) {
+        end_of_sequence_ = true;
+        continue;
+      }
+      buffer_.push_back(std::move(element));
+      if (static_cast<int64>(buffer_.size()) > buffer_size_) {
+        buffer_.pop_front();
+        ++first_index_;
+      }
+    }
+  }
+
+ private:
+  struct Element {
+    Status status;
+    std::vector<Tensor> tensors;
+  };
+
+  SharedProducer(Env* env, int64 buffer_size)
+      : buffer_size_(buffer_size),
+        thread_pool_(env, "tf_data_shared_prefix") {}
+
+  int64 end_index() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return first_index_ + static_cast<int64>(buffer_.size());
+  }
+
+  Status Initialize(IteratorContext* ctx, const DatasetBase* input,
+                    const string& prefix) {
+    FunctionLibraryRuntime* flr = nullptr;
+    TF_RETURN_IF_ERROR(
+        ctx->flr()->Clone(&flib_def_, &pflr_, &flr, /*skip_flib_def=*/true));
+    function_handle_cache_ = absl::make_unique<FunctionHandleCache>(flr);
+    IteratorContext::Params params(ctx);
+    params.flr = flr;
+    params.function_handle_cache = function_handle_cache_.get();
+    params.resource_mgr = &resource_mgr_;
+    params.cancellation_manager = &cancellation_manager_;
+    params.thread_factory = thread_pool_.get_thread_factory();
+    params.thread_pool = &thread_pool_;
+    // The shared input is not part of any single consumer's pipeline, so it
+    // is left out of their autotuning models.
+    params.model = nullptr;
+    ctx_ = absl::make_unique<IteratorContext>(std::move(params));
+    return input->MakeIterator(ctx_.get(), /*parent=*/nullptr, prefix,
+                               &input_impl_);
+  }
+
+  const int64 buffer_size_;
+  std::unique_ptr<FunctionLibraryDefinition> flib_def_;
+  std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
+  std::unique_ptr<FunctionHandleCache> function_handle_cache_;
+  ResourceMgr resource_mgr_;
+  CancellationManager cancellation_manager_;
+  UnboundedThreadPool thread_pool_;
+  std::unique_ptr<IteratorContext> ctx_;
+  std::unique_ptr<IteratorBase> input_impl_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // Holds the elements at positions [first_index_, first_index_ +
+  // buffer_.size()) of the input.
+  std::deque<Element> buffer_ TF_GUARDED_BY(mu_);
+  int64 first_index_ TF_GUARDED_BY(mu_) = 0;
+  // Whether a consumer is currently producing the next element.
+  bool producing_ TF_GUARDED_BY(mu_) = false;
+  bool end_of_sequence_ TF_GUARDED_BY(mu_) = false;
+};
+
+// Tracks the live producers of the process by sharing key.
+class SharedProducerRegistry {
+ public:
+  static SharedProducerRegistry* Global() {
+    static SharedProducerRegistry* registry = new SharedProducerRegistry();
+    return registry;
+  }
+
+  // Returns the joinable producer registered under `key`, or registers one
+  // made by `create`.
+  Status GetOrCreate(
+      const string& key,
+      const std::function<Status(std::shared_ptr<SharedProducer>*)>& create,
+      std::shared_ptr<SharedProducer>* producer) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::shared_ptr<SharedProducer> existing = producers_[key].lock();
+    if (existing && existing->Joinable()) {
+      *producer = std::move(existing);
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(create(producer));
+    for (auto it = producers_.begin(); it != producers_.end();) {
+      if (it->second.expired()) {
+        producers_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    producers_[key] = *producer;
+    return Status::OK();
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<string, std::weak_ptr<SharedProducer>> producers_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+class SharedPrefixDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
+          string sharing_key, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        buffer_size_(buffer_size),
+        sharing_key_(std::move(sharing_key)),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* buffer_size_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size_node));
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_graph_node, buffer_size_node}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      if (dataset()->sharing_key_.empty()) {
+        return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                               &input_impl_);
+      }
+      return SharedProducerRegistry::Global()->GetOrCreate(
+          dataset()->sharing_key_,
+          [this, ctx](std::shared_ptr<SharedProducer>* producer) {
+            return SharedProducer::Create(ctx, dataset()->input_, prefix(),
+                                          dataset()->buffer_size_, producer);
+          },
+          &producer_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (producer_) {
+        bool evicted = false;
+        Status s = producer_->GetElement(num_elements_, out_tensors,
+                                         end_of_sequence, &evicted);
+        if (!evicted) {
+          if (!*end_of_sequence) {
+            num_elements_++;
+          }
+          return s;
+        }
+        VLOG(1) << "Consumer of " << dataset()->sharing_key_
+                << " fell more than " << dataset()->buffer_size_
+                << " elements behind; continuing on an unshared input.";
+        TF_RETURN_IF_ERROR(Unshare(ctx));
+      }
+      Status s = input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+      if (!*end_of_sequence) {
+        num_elements_++;
+      }
+      return s;
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNumElements), num_elements_));
+      if (!producer_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kUnshared), ""));
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      return Status::OK();
+    }
+
+    // A restored iterator does not rejoin a shared producer. The position of
+    // an iterator saved while it was shared is recovered by replaying the
+    // input up to it.
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNumElements), &num_elements_));
+      if (reader->Contains(full_name(kUnshared))) {
+        producer_.reset();
+        if (!input_impl_) {
+          TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(
+              ctx, this, prefix(), &input_impl_));
+        }
+        return RestoreInput(ctx, reader, input_impl_);
+      }
+      return Unshare(ctx);
+    }
+
+   private:
+    // Switches to an unshared iterator over the input, positioned after the
+    // `num_elements_` elements already returned.
+    Status Unshare(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      producer_.reset();
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      for (int64 i = 0; i < num_elements_; ++i) {
+        std::vector<Tensor> unused;
+        bool end_of_sequence = false;
+        // Errors at these positions were already reported by the producer.
+        input_impl_->GetNext(ctx, &unused, &end_of_sequence).IgnoreError();
+        if (end_of_sequence) break;
+      }
+      return Status::OK();
+    }
+
+    mutex mu_;
+    // Set while this iterator reads from a shared producer; otherwise it reads
+    // from `input_impl_`.
+    std::shared_ptr<SharedProducer> producer_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // The number of elements (including errors) consumed from the input.
+    int64 num_elements_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* input_;
+  const int64 buffer_size_;
+  // Empty if the input is not shared.
+  const string sharing_key_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+SharedPrefixDatasetOp::SharedPrefixDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void SharedPrefixDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                        DatasetBase* input,
+                                        DatasetBase** output) {
+  int64 buffer_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(ctx, buffer_size > 0,
+              errors::InvalidArgument("`buffer_size` must be > 0 but is ",
+                                      buffer_size, "."));
+  string sharing_key;
+  Status s = ComputeSharingKey(ctx, input, buffer_size, &sharing_key);
+  if (!s.ok()) {
+    VLOG(1) << "Iterators of " << name() << " will not share their input: "
+            << s;
+    sharing_key.clear();
+  }
+  *output = new Dataset(ctx, input, buffer_size, std::move(sharing_key),
+                        output_types_, output_shapes_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("SharedPrefixDataset").Device(DEVICE_CPU),
+                        SharedPrefixDatasetOp);
+}  // namespace
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
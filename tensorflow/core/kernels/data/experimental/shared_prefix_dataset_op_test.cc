@@ -0,0 +1,196 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/shared_prefix_dataset_op.h"
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "shared_prefix_dataset";
+
+class SharedPrefixDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  SharedPrefixDatasetParams(T input_dataset_params, int64 buffer_size,
+                            DataTypeVector output_dtypes,
+                            std::vector<PartialTensorShape> output_shapes,
+                            string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        buffer_size_(buffer_size) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64>(TensorShape({}), {buffer_size_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {SharedPrefixDatasetOp::kInputDataset,
+                    SharedPrefixDatasetOp::kBufferSize};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{SharedPrefixDatasetOp::kOutputTypes, output_dtypes_},
+                    {SharedPrefixDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return SharedPrefixDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64 buffer_size_;
+};
+
+class SharedPrefixDatasetOpTest : public DatasetOpsTestBase {};
+
+SharedPrefixDatasetParams SharedPrefixDatasetParams1() {
+  return SharedPrefixDatasetParams(RangeDatasetParams(0, 10, 1),
+                                   /*buffer_size=*/2,
+                                   /*output_dtypes=*/{DT_INT64},
+                                   /*output_shapes=*/{PartialTensorShape({})},
+                                   /*node_name=*/kNodeName);
+}
+
+SharedPrefixDatasetParams SharedPrefixDatasetParams2() {
+  return SharedPrefixDatasetParams(RangeDatasetParams(0, 10, 3),
+                                   /*buffer_size=*/100,
+                                   /*output_dtypes=*/{DT_INT64},
+                                   /*output_shapes=*/{PartialTensorShape({})},
+                                   /*node_name=*/kNodeName);
+}
+
+SharedPrefixDatasetParams InvalidBufferSizeParams() {
+  return SharedPrefixDatasetParams(RangeDatasetParams(0, 10, 1),
+                                   /*buffer_size=*/0,
+                                   /*output_dtypes=*/{DT_INT64},
+                                   /*output_shapes=*/{PartialTensorShape({})},
+                                   /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<SharedPrefixDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/SharedPrefixDatasetParams1(),
+           /*expected_outputs=*/CreateTensors<int64>(
+               TensorShape({}),
+               {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+          {/*dataset_params=*/SharedPrefixDatasetParams2(),
+           /*expected_outputs=*/CreateTensors<int64>(TensorShape({}),
+                                                     {{0}, {3}, {6}, {9}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(SharedPrefixDatasetOpTest, SharedPrefixDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(SharedPrefixDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = SharedPrefixDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(SharedPrefixDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = SharedPrefixDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(SharedPrefixDatasetOp::kDatasetType)));
+}
+
+TEST_F(SharedPrefixDatasetOpTest, Cardinality) {
+  auto dataset_params = SharedPrefixDatasetParams2();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(4));
+}
+
+TEST_F(SharedPrefixDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = SharedPrefixDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      SharedPrefixDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
+}
+
+TEST_F(SharedPrefixDatasetOpTest, IteratorsInLockstep) {
+  auto dataset_params = SharedPrefixDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<IteratorBase> other;
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &other));
+  for (int64 i = 0; i < 10; ++i) {
+    for (IteratorBase* iterator : {iterator_.get(), other.get()}) {
+      std::vector<Tensor> next;
+      bool end_of_sequence = false;
+      TF_ASSERT_OK(
+          iterator->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      ASSERT_FALSE(end_of_sequence);
+      TF_EXPECT_OK(ExpectEqual(next,
+                               CreateTensors<int64>(TensorShape({}), {{i}}),
+                               /*compare_order=*/true));
+    }
+  }
+}
+
+TEST_F(SharedPrefixDatasetOpTest, IteratorFallsBehindBuffer) {
+  auto dataset_params = SharedPrefixDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<IteratorBase> other;
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &other));
+  std::vector<Tensor> expected_outputs = CreateTensors<int64>(
+      TensorShape({}), {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}});
+  TF_ASSERT_OK(CheckIteratorGetNext(iterator_.get(), iterator_ctx_.get(),
+                                    expected_outputs,
+                                    /*compare_order=*/true));
+  TF_ASSERT_OK(CheckIteratorGetNext(other.get(), iterator_ctx_.get(),
+                                    expected_outputs,
+                                    /*compare_order=*/true));
+}
+
+TEST_F(SharedPrefixDatasetOpTest, InvalidBufferSize) {
+  auto dataset_params = InvalidBufferSizeParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<SharedPrefixDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/SharedPrefixDatasetParams1(),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_outputs=*/CreateTensors<int64>(
+               TensorShape({}),
+               {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+          {/*dataset_params=*/SharedPrefixDatasetParams2(),
+           /*breakpoints=*/{0, 2, 5},
+           /*expected_outputs=*/CreateTensors<int64>(TensorShape({}),
+                                                     {{0}, {3}, {6}, {9}})}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(SharedPrefixDatasetOpTest,
+                                 SharedPrefixDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
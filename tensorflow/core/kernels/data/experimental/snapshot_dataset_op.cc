@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -248,6 +249,9 @@ class SnapshotDatasetV2Op::Dataset::Iterator::Writer
   mutex writer_status_mu_;
   std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
 
+  // Serializes and compresses the elements of all shards. This must outlive
+  // `writers_`.
+  std::unique_ptr<thread::ThreadPool> encoding_pool_ TF_GUARDED_BY(mu_);
   absl::flat_hash_map<int64, std::unique_ptr<snapshot_util::AsyncWriter>>
       writers_ TF_GUARDED_BY(mu_);
   Status writer_status_ TF_GUARDED_BY(writer_status_mu_);
@@ -699,6 +703,11 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Writer::GetNextInternal(
 
     // If the index does not exist, we will start a new thread.
     if (writers_.count(shard_index) == 0) {
+      if (encoding_pool_ == nullptr) {
+        encoding_pool_ = absl::make_unique<thread::ThreadPool>(
+            ctx->env(), ThreadOptions(), "snapshot_encoding",
+            port::MaxParallelism());
+      }
       auto snapshot_shard_directory =
           snapshot_util::ShardDirectory(run_dir_, shard_index);
       auto writer = std::make_unique<snapshot_util::AsyncWriter>(
@@ -710,7 +719,8 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Writer::GetNextInternal(
               mutex_lock l(writer_status_mu_);
               writer_status_ = s;
             }
-          });
+          },
+          encoding_pool_.get());
       writers_.insert({shard_index, std::move(writer)});
     }
     current_writer = writers_[shard_index].get();
@@ -922,9 +932,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            compression_ == io::compression::kZstd,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY' or 'ZSTD'."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
@@ -31,6 +31,9 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -126,6 +129,26 @@ Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
   return Status::OK();
 }
 
+Status TFRecordWriter::EncodeTensors(const std::vector<Tensor>& tensors,
+                                     std::vector<std::string>* records) const {
+  records->clear();
+  records->reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    records->push_back(proto.SerializeAsString());
+  }
+  return Status::OK();
+}
+
+Status TFRecordWriter::WriteEncodedTensors(
+    const std::vector<std::string>& records) {
+  for (const auto& record : records) {
+    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(record));
+  }
+  return Status::OK();
+}
+
 Status TFRecordWriter::Sync() {
   TF_RETURN_IF_ERROR(record_writer_->Flush());
   return dest_->Flush();
@@ -174,6 +197,12 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
         zlib_options.output_buffer_size, zlib_options);
     TF_CHECK_OK(zlib_output_buffer->Init());
     dest_.reset(zlib_output_buffer);
+  } else if (compression_type_ == io::compression::kZstd) {
+    zlib_underlying_dest_.swap(dest_);
+    auto zstd_output_buffer = absl::make_unique<io::ZstdOutputBuffer>(
+        zlib_underlying_dest_.get(), io::ZstdCompressionOptions());
+    TF_RETURN_IF_ERROR(zstd_output_buffer->Init());
+    dest_ = std::move(zstd_output_buffer);
   }
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
@@ -204,9 +233,22 @@ Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
 #endif  // PLATFORM_GOOGLE
   }
 
+  std::vector<std::string> records;
+  TF_RETURN_IF_ERROR(EncodeTensors(tensors, &records));
+  return WriteEncodedTensors(records);
+}
+
+Status CustomWriter::EncodeTensors(const std::vector<Tensor>& tensors,
+                                   std::vector<std::string>* records) const {
+  records->clear();
   if (compression_type_ != io::compression::kSnappy) {
-    return errors::InvalidArgument("Compression ", compression_type_,
-                                   " is not supported.");
+    experimental::SnapshotRecord record;
+    for (const auto& tensor : tensors) {
+      TensorProto* t = record.add_tensor();
+      tensor.AsProtoTensorContent(t);
+    }
+    records->push_back(record.SerializeAsString());
+    return Status::OK();
   }
 
   std::vector<const TensorBuffer*> tensor_buffers;
@@ -258,13 +300,16 @@ Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
   if (!port::Snappy_Compress(uncompressed.data(), total_size, &output)) {
     return errors::Internal("Failed to compress using snappy.");
   }
-#if defined(PLATFORM_GOOGLE)
-  absl::Cord metadata_serialized = metadata.SerializeAsCord();
-#else   // PLATFORM_GOOGLE
-  std::string metadata_serialized = metadata.SerializeAsString();
-#endif  // PLATFORM_GOOGLE
-  TF_RETURN_IF_ERROR(WriteRecord(metadata_serialized));
-  TF_RETURN_IF_ERROR(WriteRecord(output));
+  records->push_back(metadata.SerializeAsString());
+  records->push_back(std::move(output));
+  return Status::OK();
+}
+
+Status CustomWriter::WriteEncodedTensors(
+    const std::vector<std::string>& records) {
+  for (const auto& record : records) {
+    TF_RETURN_IF_ERROR(WriteRecord(record));
+  }
   return Status::OK();
 }
 
@@ -648,6 +693,10 @@ Status CustomReader::Initialize(Env* env) {
     input_stream_ = absl::make_unique<io::ZlibInputStream>(
         input_stream_.release(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options, true);
+  } else if (compression_type_ == io::compression::kZstd) {
+    input_stream_ = absl::make_unique<io::ZstdInputStream>(
+        input_stream_.release(), io::ZstdCompressionOptions(),
+        /*owns_input_stream=*/true);
   } else if (compression_type_ == io::compression::kSnappy) {
     if (version_ == 0) {
       input_stream_ = absl::make_unique<io::SnappyInputBuffer>(
@@ -924,7 +973,9 @@ AsyncWriter::AsyncWriter(Env* env, int64 file_index,
                          const std::string& shard_directory,
                          uint64 checkpoint_id, const std::string& compression,
                          int64 version, const DataTypeVector& output_types,
-                         std::function<void(Status)> done) {
+                         std::function<void(Status)> done,
+                         thread::ThreadPool* encoding_pool)
+    : encoding_pool_(encoding_pool) {
   thread_ = absl::WrapUnique(env->StartThread(
       ThreadOptions(), absl::StrCat("writer_thread_", file_index),
       [this, env, shard_directory, checkpoint_id, compression, version,
@@ -955,6 +1006,16 @@ void AsyncWriter::Consume(ElementOrEOF* be) {
   deque_.pop_front();
 }
 
+bool AsyncWriter::TryConsume(ElementOrEOF* be) {
+  mutex_lock l(mu_);
+  if (deque_.empty()) {
+    return false;
+  }
+  *be = deque_.front();
+  deque_.pop_front();
+  return true;
+}
+
 bool AsyncWriter::ElementAvailable() { return !deque_.empty(); }
 
 Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
@@ -968,6 +1029,10 @@ Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
       env, GetCheckpointFileName(shard_directory, checkpoint_id), compression,
       version, std::move(output_types), &writer));
 
+  if (encoding_pool_ != nullptr) {
+    return WriteEncodedElements(std::move(writer));
+  }
+
   while (true) {
     ElementOrEOF be;
     Consume(&be);
@@ -982,6 +1047,63 @@ Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
   return Status::OK();
 }
 
+Status AsyncWriter::WriteEncodedElements(std::shared_ptr<Writer> writer) {
+  // An element that is being encoded. The encoding holds the writer, so that
+  // an error does not have to wait for the encodings in flight.
+  struct EncodedElement {
+    mutex mu;
+    condition_variable cond_var;
+    bool done TF_GUARDED_BY(mu) = false;
+    Status status TF_GUARDED_BY(mu);
+    std::vector<std::string> records TF_GUARDED_BY(mu);
+  };
+  // Bounds the memory used by encoded elements that are waiting to be
+  // written, while keeping every thread of the pool busy.
+  const size_t max_in_flight = 2 * encoding_pool_->NumThreads();
+  std::deque<std::shared_ptr<EncodedElement>> in_flight;
+  bool end_of_sequence = false;
+  while (true) {
+    while (!end_of_sequence && in_flight.size() < max_in_flight) {
+      ElementOrEOF be;
+      if (in_flight.empty()) {
+        Consume(&be);
+      } else if (!TryConsume(&be)) {
+        break;
+      }
+      if (be.end_of_sequence) {
+        end_of_sequence = true;
+        break;
+      }
+      auto element = std::make_shared<EncodedElement>();
+      encoding_pool_->Schedule(
+          [writer, element, tensors = std::move(be.value)]() {
+            std::vector<std::string> records;
+            Status s = writer->EncodeTensors(tensors, &records);
+            mutex_lock l(element->mu);
+            element->status = s;
+            element->records = std::move(records);
+            element->done = true;
+            element->cond_var.notify_all();
+          });
+      in_flight.push_back(std::move(element));
+    }
+    if (in_flight.empty()) {
+      return writer->Close();
+    }
+
+    // Appends the oldest element to the file, so that elements are written
+    // in order.
+    std::shared_ptr<EncodedElement> element = std::move(in_flight.front());
+    in_flight.pop_front();
+    mutex_lock l(element->mu);
+    while (!element->done) {
+      element->cond_var.wait(l);
+    }
+    TF_RETURN_IF_ERROR(element->status);
+    TF_RETURN_IF_ERROR(writer->WriteEncodedTensors(element->records));
+  }
+}
+
 }  // namespace snapshot_util
 }  // namespace data
 }  // namespace tensorflow
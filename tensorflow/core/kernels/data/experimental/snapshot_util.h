@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -81,6 +82,17 @@ class Writer {
   // Writes a vector of tensors to the snapshot writer file.
   virtual Status WriteTensors(const std::vector<Tensor>& tensors) = 0;
 
+  // Serializes `tensors`, and compresses them if the file format compresses
+  // each element separately, into the records that `WriteEncodedTensors()`
+  // appends to the file. This lets the expensive part of `WriteTensors()` run
+  // on several threads. Thread safe.
+  virtual Status EncodeTensors(const std::vector<Tensor>& tensors,
+                               std::vector<std::string>* records) const = 0;
+
+  // Writes records returned by `EncodeTensors()` to the snapshot writer file.
+  virtual Status WriteEncodedTensors(
+      const std::vector<std::string>& records) = 0;
+
   // Flushes any in-memory buffers to disk.
   virtual Status Sync() = 0;
 
@@ -102,6 +114,11 @@ class TFRecordWriter : public Writer {
 
   Status WriteTensors(const std::vector<Tensor>& tensors) override;
 
+  Status EncodeTensors(const std::vector<Tensor>& tensors,
+                       std::vector<std::string>* records) const override;
+
+  Status WriteEncodedTensors(const std::vector<std::string>& records) override;
+
   Status Sync() override;
 
   Status Close() override;
@@ -134,6 +151,11 @@ class CustomWriter : public Writer {
 
   Status WriteTensors(const std::vector<Tensor>& tensors) override;
 
+  Status EncodeTensors(const std::vector<Tensor>& tensors,
+                       std::vector<std::string>* records) const override;
+
+  Status WriteEncodedTensors(const std::vector<std::string>& records) override;
+
   Status Sync() override;
 
   Status Close() override;
@@ -154,9 +176,10 @@ class CustomWriter : public Writer {
   const std::string filename_;
   const std::string compression_type_;
   const DataTypeVector dtypes_;
-  // We hold zlib_dest_ because we may create a ZlibOutputBuffer and put that
-  // in dest_ if we want compression. ZlibOutputBuffer doesn't own the original
-  // dest_ and so we need somewhere to store the original one.
+  // We hold zlib_dest_ because we may create a ZlibOutputBuffer or a
+  // ZstdOutputBuffer and put that in dest_ if we want compression. Neither
+  // owns the original dest_ and so we need somewhere to store the original
+  // one.
   std::unique_ptr<WritableFile> zlib_underlying_dest_;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
   int num_simple_ = 0;
@@ -317,13 +340,19 @@ struct ElementOrEOF {
 // }
 // writer->SignalEOF();
 // writer = nullptr;  // This will block until writes are flushed.
+//
+// If `encoding_pool` is not null, elements are serialized and compressed on
+// its threads, several at a time, and the writer thread appends the encoded
+// elements to the file in the order in which they were written. The pool may
+// be shared by several writers and must outlive them.
 class AsyncWriter {
  public:
   explicit AsyncWriter(Env* env, int64 file_index,
                        const std::string& shard_directory, uint64 checkpoint_id,
                        const std::string& compression, int64 version,
                        const DataTypeVector& output_types,
-                       std::function<void(Status)> done);
+                       std::function<void(Status)> done,
+                       thread::ThreadPool* encoding_pool = nullptr);
 
   // Writes the given tensors. The method is non-blocking and returns without
   // waiting for the element to be written.
@@ -335,11 +364,17 @@ class AsyncWriter {
 
  private:
   void Consume(ElementOrEOF* be) TF_LOCKS_EXCLUDED(mu_);
+  // Like `Consume()`, but returns false instead of waiting if no element is
+  // available.
+  bool TryConsume(ElementOrEOF* be) TF_LOCKS_EXCLUDED(mu_);
   bool ElementAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status WriterThread(Env* env, const std::string& shard_directory,
                       uint64 checkpoint_id, const std::string& compression,
                       int64 version, DataTypeVector output_types);
+  // Writes the elements of the deque, encoding them on `encoding_pool_`.
+  Status WriteEncodedElements(std::shared_ptr<Writer> writer);
 
+  thread::ThreadPool* const encoding_pool_;  // Not owned.
   mutex mu_;
   std::deque<ElementOrEOF> deque_ TF_GUARDED_BY(mu_);
 
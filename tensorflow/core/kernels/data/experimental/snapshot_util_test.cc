@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/snapshot_util.h"
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -85,10 +88,80 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 1);
   SnapshotRoundTrip(io::compression::kGzip, 1);
   SnapshotRoundTrip(io::compression::kSnappy, 1);
+  SnapshotRoundTrip(io::compression::kZstd, 1);
 
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
+  SnapshotRoundTrip(io::compression::kZstd, 2);
+}
+
+// Writes `num_elements` elements with an `AsyncWriter`, whose element `i` is
+// `tensors` followed by the scalar `i`, and returns the file written.
+std::string WriteAsync(const std::string& compression_type, int version,
+                       int num_elements, const std::vector<Tensor>& tensors,
+                       DataTypeVector dtypes,
+                       thread::ThreadPool* encoding_pool) {
+  std::string shard_directory;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&shard_directory));
+  dtypes.push_back(DT_INT64);
+  Notification done;
+  Status status;
+  {
+    AsyncWriter writer(
+        Env::Default(), /*file_index=*/0, shard_directory,
+        /*checkpoint_id=*/0, compression_type, version, dtypes,
+        [&done, &status](Status s) {
+          status = s;
+          done.Notify();
+        },
+        encoding_pool);
+    for (int64 i = 0; i < num_elements; ++i) {
+      std::vector<Tensor> element = tensors;
+      element.push_back(Tensor(i));
+      writer.Write(element);
+    }
+    writer.SignalEOF();
+  }
+  done.WaitForNotification();
+  TF_EXPECT_OK(status);
+  return GetCheckpointFileName(shard_directory, /*checkpoint_id=*/0);
+}
+
+void AsyncSnapshotRoundTrip(std::string compression_type, int version) {
+  std::vector<Tensor> tensors;
+  tensorflow::DataTypeVector dtypes;
+  GenerateTensorVector(dtypes, tensors);
+  thread::ThreadPool encoding_pool(Env::Default(), "encoding", 4);
+  const std::string filename = WriteAsync(compression_type, version, 100,
+                                          tensors, dtypes, &encoding_pool);
+
+  dtypes.push_back(DT_INT64);
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
+                              version, dtypes, &reader));
+  for (int64 i = 0; i < 100; ++i) {
+    std::vector<Tensor> read_tensors;
+    TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+    ASSERT_EQ(tensors.size() + 1, read_tensors.size());
+    EXPECT_EQ(tensors[0].scalar<tstring>()(),
+              read_tensors[0].scalar<tstring>()());
+    // Elements are written in order even though they are encoded in parallel.
+    EXPECT_EQ(i, read_tensors.back().scalar<int64>()());
+  }
+  std::vector<Tensor> read_tensors;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadTensors(&read_tensors)));
+}
+
+TEST(SnapshotUtilTest, AsyncWriterWithEncodingPoolRoundTripTest) {
+  AsyncSnapshotRoundTrip(io::compression::kNone, 1);
+  AsyncSnapshotRoundTrip(io::compression::kGzip, 1);
+  AsyncSnapshotRoundTrip(io::compression::kSnappy, 1);
+  AsyncSnapshotRoundTrip(io::compression::kZstd, 1);
+
+  AsyncSnapshotRoundTrip(io::compression::kNone, 2);
+  AsyncSnapshotRoundTrip(io::compression::kGzip, 2);
+  AsyncSnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
 void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
@@ -207,6 +280,50 @@ BENCHMARK(SnapshotTFRecordWriterNoneBenchmark);
 BENCHMARK(SnapshotTFRecordWriterGzipBenchmark);
 BENCHMARK(SnapshotTFRecordWriterSnappyBenchmark);
 
+// Measures the throughput of an `AsyncWriter` that encodes elements on
+// `num_threads` threads, or inline on its writer thread if `num_threads` is 0.
+void SnapshotAsyncWriterBenchmarkLoop(int iters, std::string compression_type,
+                                      int version, int num_threads) {
+  tensorflow::testing::StopTiming();
+
+  tensorflow::DataTypeVector dtypes;
+  std::vector<Tensor> tensors;
+  GenerateTensorVector(dtypes, tensors);
+  std::unique_ptr<thread::ThreadPool> encoding_pool;
+  if (num_threads > 0) {
+    encoding_pool = absl::make_unique<thread::ThreadPool>(
+        Env::Default(), "encoding", num_threads);
+  }
+
+  tensorflow::testing::StartTiming();
+  const std::string filename = WriteAsync(compression_type, version, iters,
+                                          tensors, dtypes, encoding_pool.get());
+  tensorflow::testing::StopTiming();
+
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+void SnapshotAsyncCustomWriterSnappyBenchmark(int iters, int num_threads) {
+  SnapshotAsyncWriterBenchmarkLoop(iters, io::compression::kSnappy, 1,
+                                   num_threads);
+}
+
+void SnapshotAsyncTFRecordWriterSnappyBenchmark(int iters, int num_threads) {
+  SnapshotAsyncWriterBenchmarkLoop(iters, io::compression::kSnappy, 2,
+                                   num_threads);
+}
+
+BENCHMARK(SnapshotAsyncCustomWriterSnappyBenchmark)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16);
+BENCHMARK(SnapshotAsyncTFRecordWriterSnappyBenchmark)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16);
+
 }  // namespace
 }  // namespace snapshot_util
 }  // namespace data
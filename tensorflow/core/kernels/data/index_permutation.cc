@@ -0,0 +1,71 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/index_permutation.h"
+
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+
+/* static */ constexpr int IndexPermutation::kNumRounds;
+
+IndexPermutation::IndexPermutation(int64 size, int64 seed, int64 seed2)
+    : size_(size) {
+  DCHECK_GE(size, 0);
+  // Each half holds at least one bit, so that the network is not the
+  // identity for sizes of at most two.
+  half_bits_ = 1;
+  while (half_bits_ < 32 && (uint64{1} << (2 * half_bits_)) < size_) {
+    ++half_bits_;
+  }
+  half_mask_ = (uint64{1} << half_bits_) - 1;
+
+  random::PhiloxRandom generator(seed, seed2);
+  random::PhiloxRandom::ResultType samples;
+  for (int round = 0; round < kNumRounds; ++round) {
+    if (round % 2 == 0) samples = generator();
+    keys_[round] = (static_cast<uint64>(samples[2 * (round % 2)]) << 32) |
+                   samples[2 * (round % 2) + 1];
+  }
+}
+
+uint64 IndexPermutation::Encrypt(uint64 x) const {
+  uint64 left = x >> half_bits_;
+  uint64 right = x & half_mask_;
+  for (int round = 0; round < kNumRounds; ++round) {
+    const uint64 next_right =
+        left ^ (FingerprintCat64(keys_[round], right) & half_mask_);
+    left = right;
+    right = next_right;
+  }
+  return (left << half_bits_) | right;
+}
+
+int64 IndexPermutation::operator()(int64 i) const {
+  DCHECK_GE(i, 0);
+  DCHECK_LT(i, size_);
+  // The network is a bijection of the domain, so walking the cycle that
+  // contains `i` reaches an index inside [0, size) before returning to `i`.
+  uint64 x = i;
+  do {
+    x = Encrypt(x);
+  } while (x >= static_cast<uint64>(size_));
+  return x;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_INDEX_PERMUTATION_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_INDEX_PERMUTATION_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A pseudo-random permutation of the indices [0, size), whose elements are
+// computed on demand in O(1) time and memory.
+//
+// The permutation is a balanced Feistel network over the smallest domain of
+// 2^(2k) indices that holds `size` indices, with round keys derived from the
+// seeds. Indices that the network maps outside of [0, size) are mapped again
+// until they fall inside it ("cycle walking"). Since the domain holds fewer
+// than `4 * size` indices (for sizes above one), this takes at most four
+// passes on average.
+class IndexPermutation {
+ public:
+  IndexPermutation(int64 size, int64 seed, int64 seed2);
+
+  int64 size() const { return size_; }
+
+  // Returns the index at position `i` of the permutation.
+  // REQUIRES: 0 <= i < size()
+  int64 operator()(int64 i) const;
+
+ private:
+  static constexpr int kNumRounds = 6;
+
+  uint64 Encrypt(uint64 x) const;
+
+  int64 size_;
+  int half_bits_;
+  uint64 half_mask_;
+  uint64 keys_[kNumRounds];
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_INDEX_PERMUTATION_H_
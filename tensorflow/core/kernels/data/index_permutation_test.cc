@@ -0,0 +1,66 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/index_permutation.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<int64> Permute(int64 size, int64 seed, int64 seed2) {
+  IndexPermutation permutation(size, seed, seed2);
+  EXPECT_EQ(size, permutation.size());
+  std::vector<int64> indices;
+  for (int64 i = 0; i < size; ++i) {
+    indices.push_back(permutation(i));
+  }
+  return indices;
+}
+
+TEST(IndexPermutationTest, IsPermutation) {
+  for (int64 size : {1, 2, 3, 4, 5, 16, 17, 1000, 4096, 4097}) {
+    std::vector<bool> seen(size, false);
+    for (int64 index : Permute(size, 42, 7)) {
+      ASSERT_GE(index, 0);
+      ASSERT_LT(index, size);
+      EXPECT_FALSE(seen[index]) << "Index " << index << " appears twice";
+      seen[index] = true;
+    }
+  }
+}
+
+TEST(IndexPermutationTest, DependsOnSeeds) {
+  const std::vector<int64> permutation = Permute(1000, 42, 7);
+  EXPECT_EQ(permutation, Permute(1000, 42, 7));
+  EXPECT_NE(permutation, Permute(1000, 42, 8));
+  EXPECT_NE(permutation, Permute(1000, 43, 7));
+}
+
+TEST(IndexPermutationTest, MovesMostIndices) {
+  const std::vector<int64> permutation = Permute(1000, 1, 2);
+  int num_fixed_points = 0;
+  for (int64 i = 0; i < permutation.size(); ++i) {
+    if (permutation[i] == i) ++num_fixed_points;
+  }
+  // A uniformly random permutation has one fixed point on average.
+  EXPECT_LT(num_fixed_points, 10);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -121,6 +121,9 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params) {
         model_ = std::make_shared<model::Model>();
+        // Concurrently running input pipelines share the CPU and RAM budget,
+        // instead of each being tuned as if it owned the whole machine.
+        model_->ShareBudget(model::SharedBudget::Global());
       }
 
       ~Iterator() override {
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -115,6 +116,14 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// While a deterministic `GetNext` is blocked on the current cycle element,
+// current workers which would otherwise be idle keep reading ahead on the other
+// elements of the cycle, up to `kStalledReadAheadFactor` times the buffer size
+// of each element. This way a slow element (e.g. a file on a slow disk) does
+// not leave the workers idle, and the results of the other elements are ready
+// to be consumed once the slow element catches up.
+constexpr int64 kStalledReadAheadFactor = 2;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -353,7 +362,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           if (deterministic_) {
             VLOG(3) << "Blocked waiting for element "
                     << current_elements_[cycle_index_]->id;
+            consumer_stalled_ = true;
+            ReadAheadOnOtherElements();
             current_elements_[cycle_index_]->cond_var.wait(l);
+            consumer_stalled_ = false;
           } else {
             any_element_available_cond_var_.wait(l);
           }
@@ -949,12 +961,41 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= BufferLimit(element)) {
           break;
         }
       }
     }
 
+    // Queues the current cycle elements other than the one `GetNext` waits
+    // for, so that idle current workers read ahead on them. An element only
+    // becomes active once a worker picks it up, so the elements which are
+    // already queued are skipped rather than queued again on every wait.
+    void ReadAheadOnOtherElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      bool queued = false;
+      for (int i = 0; i <= last_valid_current_element_; ++i) {
+        const std::shared_ptr<Element>& element = current_elements_[i];
+        if (i != cycle_index_ && NeedsProcessing(element) && !element->active &&
+            std::find(elements_to_process_.begin(), elements_to_process_.end(),
+                      i) == elements_to_process_.end()) {
+          elements_to_process_.push_back(i);
+          queued = true;
+        }
+      }
+      if (queued) {
+        current_workers_cond_var_.notify_all();
+      }
+    }
+
+    // Returns the number of results to buffer for `element`.
+    int64 BufferLimit(const std::shared_ptr<Element>& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (consumer_stalled_ && element->cycle_index != -1) {
+        return kStalledReadAheadFactor * dataset()->buffer_output_elements_;
+      }
+      return dataset()->buffer_output_elements_;
+    }
+
     // Initialize inputs and create an iterator for all elements up to
     // element_id.
     void InitializeInputs(int element_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1047,7 +1088,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < BufferLimit(element);
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1404,6 +1445,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // worker.
     std::deque<int> elements_to_process_;
 
+    // Whether a deterministic `GetNext` is blocked on the current cycle
+    // element. See `kStalledReadAheadFactor`.
+    bool consumer_stalled_ TF_GUARDED_BY(mu_) = false;
+
     // The last index in `current_elements_` containing a non-null element.
     // This allows us to optimize the situation when the cycle_length is large
     // but the input dataset doesn't have many elements. By tracking the index
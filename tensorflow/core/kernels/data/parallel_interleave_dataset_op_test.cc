@@ -11,7 +11,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace data {
@@ -20,6 +29,126 @@ namespace {
 constexpr char kNodeName[] = "parallel_interleave_dataset";
 constexpr int kOpVersion = 4;
 
+// Records the values which go through `ParallelInterleaveTestProbe`, and holds
+// up `kGatedValue` until the gate is opened.
+class Probe {
+ public:
+  static constexpr int64 kGatedValue = 0;
+
+  void Record(int64 value) {
+    mutex_lock l(mu_);
+    values_.push_back(value);
+    cv_.notify_all();
+    while (value == kGatedValue && !gate_open_) {
+      cv_.wait(l);
+    }
+  }
+
+  void OpenGate() {
+    mutex_lock l(mu_);
+    gate_open_ = true;
+    cv_.notify_all();
+  }
+
+  // Returns the number of recorded values which are at least `min_value`.
+  int NumRecordedAtLeast(int64 min_value) {
+    mutex_lock l(mu_);
+    return CountAtLeast(min_value);
+  }
+
+  // Waits up to `timeout_ms` for `n` values at least `min_value`, and returns
+  // their number.
+  int WaitForRecordedAtLeast(int64 min_value, int n, int64 timeout_ms) {
+    const uint64 deadline_micros =
+        Env::Default()->NowMicros() + timeout_ms * 1000;
+    mutex_lock l(mu_);
+    while (CountAtLeast(min_value) < n &&
+           Env::Default()->NowMicros() < deadline_micros) {
+      WaitForMilliseconds(&l, &cv_, 10);
+    }
+    return CountAtLeast(min_value);
+  }
+
+ private:
+  int CountAtLeast(int64 min_value) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return std::count_if(values_.begin(), values_.end(),
+                         [min_value](int64 v) { return v >= min_value; });
+  }
+
+  mutex mu_;
+  condition_variable cv_;
+  bool gate_open_ TF_GUARDED_BY(mu_) = false;
+  std::vector<int64> values_ TF_GUARDED_BY(mu_);
+};
+
+Probe* probe = nullptr;
+
+class ParallelInterleaveTestProbeOp : public OpKernel {
+ public:
+  explicit ParallelInterleaveTestProbeOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    probe->Record(ctx->input(0).scalar<int64>()());
+    ctx->set_output(0, ctx->input(0));
+  }
+};
+
+REGISTER_OP("ParallelInterleaveTestProbe")
+    .Input("x: int64")
+    .Output("y: int64")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::UnchangedShape);
+REGISTER_KERNEL_BUILDER(
+    Name("ParallelInterleaveTestProbe").Device(DEVICE_CPU),
+    ParallelInterleaveTestProbeOp);
+
+// x: int64 -> y: int64, through the probe.
+FunctionDef ProbeFunc() {
+  return FunctionDefHelper::Define(
+      // Name
+      "ProbeFunc",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: int64"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"y"}, "ParallelInterleaveTestProbe", {"x"}}});
+}
+
+// Makes the dataset of the elements of the vector `x`, each of which goes
+// through the probe when it is produced.
+FunctionDef MakeProbedDatasetFunc() {
+  const std::vector<PartialTensorShape> output_shapes = {
+      PartialTensorShape({})};
+  return FunctionDefHelper::Define(
+      // Name
+      "MakeProbedDataset",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: variant"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"slices"},
+        "TensorSliceDataset",
+        {"x"},
+        {{"Toutput_types", DataTypeVector({DT_INT64})},
+         {"output_shapes", output_shapes}}},
+       {{"y"},
+        "MapDataset",
+        {"slices"},
+        {{"f", FunctionDefHelper::FunctionRef("ProbeFunc")},
+         {"Targuments", DataTypeVector{}},
+         {"output_types", DataTypeVector({DT_INT64})},
+         {"output_shapes", output_shapes},
+         {"use_inter_op_parallelism", true},
+         {"preserve_cardinality", false}}}});
+}
+
 class ParallelInterleaveDatasetParams : public DatasetParams {
  public:
   template <typename T>
@@ -399,6 +528,30 @@ ParallelInterleaveDatasetParams LongCycleDeterministicParams() {
       /*node_name=*/kNodeName);
 }
 
+// Interleaves {0, 1, 2, 3} and {10, 11, 12, 13}, produced through the probe,
+// with one result buffered per element.
+ParallelInterleaveDatasetParams ProbedDeterministicParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{2, 4},
+                                          {0, 1, 2, 3, 10, 11, 12, 13})},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/2,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/0,
+      /*num_parallel_calls=*/2,
+      /*func=*/FunctionDefHelper::FunctionRef("MakeProbedDataset"),
+      /*func_lib=*/{MakeProbedDatasetFunc(), ProbeFunc()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*node_name=*/kNodeName);
+}
+
 ParallelInterleaveDatasetParams
 ParallelInterleaveDatasetParamsWithInvalidCycleLength() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
@@ -774,6 +927,49 @@ TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
   }
 }
 
+// While `GetNext` waits for the first element, which is held up by the probe,
+// the workers read ahead on the second one, up to `kStalledReadAheadFactor`
+// times `buffer_output_elements` results, and the output order is unchanged.
+TEST_F(ParallelInterleaveDatasetOpTest, ReadsAheadWhileBlockedOnElement) {
+  probe = new Probe;
+  auto dataset_params = ProbedDeterministicParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  Status first_status;
+  std::unique_ptr<Thread> consumer(Env::Default()->StartThread(
+      ThreadOptions(), "consumer", [&]() {
+        first_status = iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                          &end_of_sequence);
+      }));
+  // Without read-ahead, the second element would stop after 1 result.
+  EXPECT_EQ(2, probe->WaitForRecordedAtLeast(10, 2, /*timeout_ms=*/10000));
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  EXPECT_EQ(2, probe->NumRecordedAtLeast(10));
+  probe->OpenGate();
+  consumer.reset();
+  TF_ASSERT_OK(first_status);
+  ASSERT_FALSE(end_of_sequence);
+
+  std::vector<Tensor> outputs = out_tensors;
+  while (true) {
+    out_tensors.clear();
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    if (end_of_sequence) break;
+    outputs.insert(outputs.end(), out_tensors.begin(), out_tensors.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(
+      outputs,
+      CreateTensors<int64>(TensorShape({}),
+                           {{0}, {10}, {1}, {11}, {2}, {12}, {3}, {13}}),
+      /*compare_order=*/true));
+  iterator_.reset();
+  delete probe;
+  probe = nullptr;
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -20,10 +20,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/lib/io/parallel_record_reader.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -53,7 +55,8 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   bool use_mmap, int64 num_parallel_reads)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
@@ -62,6 +65,12 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    // Only uncompressed files can be read in place, or from several offsets
+    // at once.
+    const bool uncompressed =
+        options_.compression_type == io::RecordReaderOptions::NONE;
+    use_mmap_ = use_mmap && uncompressed;
+    num_parallel_reads_ = uncompressed ? num_parallel_reads : 0;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -115,11 +124,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
-          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
-                                    TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+        if (reader_ || mapped_reader_ || parallel_reader_) {
+          Status s = ReadRecordLocked(ctx, out_tensors);
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -128,7 +134,6 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             *end_of_sequence = false;
             return Status::OK();
           }
-          out_tensors->pop_back();
           if (!errors::IsOutOfRange(s)) {
             // In case of other errors e.g., DataLoss, we still move forward
             // the file index so that it works with ignore_errors.
@@ -150,7 +155,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env(), /*offset=*/0));
       } while (true);
     }
 
@@ -166,7 +171,14 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (mapped_reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(kOffset), static_cast<int64>(mapped_offset_)));
+      } else if (parallel_reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(kOffset),
+            static_cast<int64>(parallel_reader_->TellOffset())));
+      } else if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
       }
@@ -184,15 +196,45 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader->Contains(full_name(kOffset))) {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env(), offset));
       }
       return Status::OK();
     }
 
    private:
-    // Sets up reader streams to read from the file at `current_file_index_`.
-    Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    // Reads the next record of the current file into a new scalar tensor
+    // appended to `out_tensors`.
+    Status ReadRecordLocked(IteratorContext* ctx,
+                            std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        StringPiece record;
+        TF_RETURN_IF_ERROR(
+            mapped_reader_->ReadRecord(&mapped_offset_, &record));
+        // The record is copied straight out of the mapping. A view of the
+        // mapping would be moved as is into the output of e.g. batching, and
+        // outlive the mapping, which is unmapped at the end of the file.
+        out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                  TensorShape({}));
+        out_tensors->back().scalar<tstring>()().assign(record.data(),
+                                                       record.size());
+        return Status::OK();
+      }
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      tstring* record = &out_tensors->back().scalar<tstring>()();
+      Status s = parallel_reader_ ? parallel_reader_->ReadRecord(record)
+                                  : reader_->ReadRecord(record);
+      if (!s.ok()) {
+        out_tensors->pop_back();
+      }
+      return s;
+    }
+
+    // Sets up reader streams to read from the file at `current_file_index_`,
+    // starting with the record at `offset`.
+    Status SetupStreamsLocked(Env* env, uint64 offset)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
         return errors::InvalidArgument(
             "current_file_index_:", current_file_index_,
@@ -201,30 +243,73 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
+      if (dataset()->use_mmap_) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        Status s = env->NewReadOnlyMemoryRegionFromFile(next_filename, &region);
+        if (s.ok()) {
+          region_ = std::move(region);
+          mapped_reader_ =
+              absl::make_unique<io::MappedRecordReader>(region_.get());
+          mapped_offset_ = offset;
+          return Status::OK();
+        }
+        // E.g. the file system does not support memory mapping, or the file
+        // is empty.
+        VLOG(2) << "Failed to map " << next_filename
+                << " into memory, reading it as a stream instead: " << s;
+      }
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
+      if (dataset()->num_parallel_reads_ > 0) {
+        uint64 file_size;
+        TF_RETURN_IF_ERROR(env->GetFileSize(next_filename, &file_size));
+        io::ParallelRecordReader::Options options;
+        options.num_parallel_reads = dataset()->num_parallel_reads_;
+        parallel_reader_ = absl::make_unique<io::ParallelRecordReader>(
+            env, file_.get(), file_size, offset, options);
+        return Status::OK();
+      }
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
-      return Status::OK();
+      return reader_->SeekOffset(offset);
     }
 
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
+      parallel_reader_.reset();
       file_.reset();
+      mapped_reader_.reset();
+      region_.reset();
+      mapped_offset_ = 0;
     }
 
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
-    // `reader_` will borrow the object that `file_` points to, so
-    // we must destroy `reader_` before `file_`.
+    // `reader_` and `parallel_reader_` will borrow the object that `file_`
+    // points to, so we must destroy them before `file_`. At most one of them
+    // is set.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::ParallelRecordReader> parallel_reader_
+        TF_GUARDED_BY(mu_);
+
+    // Set instead of `file_` and `reader_` when the current file is mapped
+    // into memory. `mapped_offset_` is the offset of its next record.
+    std::unique_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::MappedRecordReader> mapped_reader_ TF_GUARDED_BY(mu_);
+    uint64 mapped_offset_ TF_GUARDED_BY(mu_) = 0;
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  // Whether to read the files through a memory mapping, copying each record
+  // once out of the mapping instead of through a read buffer.
+  bool use_mmap_;
+  // If positive, the number of byte ranges of a file that are read
+  // concurrently.
+  int64 num_parallel_reads_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
@@ -275,8 +360,22 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  // Reading uncompressed files through a memory mapping avoids the read
+  // syscalls and the copy through the read buffer, but the files must not be
+  // truncated while they are mapped, so this is opt-in.
+  bool use_mmap = false;
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_TFRECORD_DATASET_USE_MMAP",
+                                         /*default_val=*/false, &use_mmap));
+
+  // Fetching several byte ranges of a file concurrently hides the latency of
+  // remote file systems. Files that can be memory mapped are not affected.
+  int64 num_parallel_reads = 0;
+  OP_REQUIRES_OK(ctx,
+                 ReadInt64FromEnvVar("TF_TFRECORD_DATASET_NUM_PARALLEL_READS",
+                                     /*default_val=*/0, &num_parallel_reads));
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, use_mmap, num_parallel_reads);
 }
 
 namespace {
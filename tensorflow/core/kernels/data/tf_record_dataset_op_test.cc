@@ -137,6 +137,25 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: multiple text files without compression, which can be read
+// through a memory mapping.
+TFRecordDatasetParams TFRecordDatasetParams4() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -204,6 +223,51 @@ TEST_F(TFRecordDatasetOpTest, IteratorPrefix) {
       TFRecordDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
 }
 
+TEST_F(TFRecordDatasetOpTest, MemoryMappedFiles) {
+  setenv("TF_TFRECORD_DATASET_USE_MMAP", "1", /*overwrite=*/1);
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  unsetenv("TF_TFRECORD_DATASET_USE_MMAP");
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  std::vector<Tensor> records;
+  while (!end_of_sequence) {
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    records.insert(records.end(), out_tensors.begin(), out_tensors.end());
+    out_tensors.clear();
+  }
+  // The records own their bytes, so they remain valid once the iterator has
+  // unmapped their file, even when they are moved out of the tensors as by
+  // batching.
+  iterator_.reset();
+  std::vector<Tensor> moved_records;
+  for (Tensor& record : records) {
+    EXPECT_NE(record.scalar<tstring>()().type(), tstring::VIEW);
+    moved_records.emplace_back(DT_STRING, TensorShape({}));
+    moved_records.back().scalar<tstring>()() =
+        std::move(record.scalar<tstring>()());
+  }
+  records = std::move(moved_records);
+  TF_EXPECT_OK(ExpectEqual(
+      records,
+      CreateTensors<tstring>(
+          TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpTest, ParallelReads) {
+  setenv("TF_TFRECORD_DATASET_NUM_PARALLEL_READS", "4", /*overwrite=*/1);
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  unsetenv("TF_TFRECORD_DATASET_NUM_PARALLEL_READS");
+  TF_ASSERT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(
+          TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}}),
+      /*compare_order=*/true));
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -61,6 +61,11 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Helper for dequeuing num_elements elements from queues_ into a batch.
+  // REQUIRES: queues_ holds at least num_elements elements.
+  Status DequeueManyLocked(int num_elements, OpKernelContext* ctx,
+                           Tuple* tuple) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64 index,
                                              int component,
                                              OpKernelContext* ctx,
@@ -0,0 +1,239 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fifo_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs enqueues and dequeues directly against a FIFOQueue of int32 scalars,
+// so that each test controls whether they can complete at once (the fast
+// path) or have to wait as attempts (the slow path).
+class FIFOQueueTest : public ::testing::Test {
+ protected:
+  FIFOQueueTest()
+      : device_(
+            DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0")) {
+    NodeDef node_def;
+    TF_CHECK_OK(NodeDefBuilder("op", "NoOp").Finalize(&node_def));
+    Status status;
+    op_ = CreateOpKernel(DEVICE_CPU, device_.get(), cpu_allocator(), node_def,
+                         TF_GRAPH_DEF_VERSION, &status);
+    TF_CHECK_OK(status);
+    params_.device = device_.get();
+    params_.op_kernel = op_.get();
+    params_.cancellation_manager = &cancellation_manager_;
+  }
+
+  ~FIFOQueueTest() override {
+    if (queue_ != nullptr) queue_->Unref();
+  }
+
+  void MakeQueue(int32 capacity) {
+    queue_ = new FIFOQueue(capacity, {DT_INT32}, {TensorShape({})}, "test");
+    TF_ASSERT_OK(queue_->Initialize());
+  }
+
+  OpKernelContext* NewContext() {
+    contexts_.push_back(absl::make_unique<OpKernelContext>(&params_, 0));
+    return contexts_.back().get();
+  }
+
+  void StartEnqueue(int32 value, OpKernelContext* ctx, Notification* done) {
+    queue_->TryEnqueue({test::AsScalar<int32>(value)}, ctx,
+                       [done]() { done->Notify(); });
+  }
+
+  // Appends the dequeued value, if any, to *values.
+  void StartDequeue(OpKernelContext* ctx, std::vector<int32>* values,
+                    Notification* done) {
+    queue_->TryDequeue(ctx, [values, done](const QueueInterface::Tuple& t) {
+      if (!t.empty()) values->push_back(t[0].scalar<int32>()());
+      done->Notify();
+    });
+  }
+
+  // Appends the dequeued batch, if any, to *values.
+  void StartDequeueMany(int num_elements, OpKernelContext* ctx,
+                        std::vector<int32>* values, Notification* done) {
+    queue_->TryDequeueMany(
+        num_elements, ctx, /*allow_small_batch=*/false,
+        [values, done](const QueueInterface::Tuple& t) {
+          if (!t.empty()) {
+            auto batch = t[0].flat<int32>();
+            values->insert(values->end(), batch.data(),
+                           batch.data() + batch.size());
+          }
+          done->Notify();
+        });
+  }
+
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<OpKernel> op_;
+  CancellationManager cancellation_manager_;
+  OpKernelContext::Params params_;
+  std::vector<std::unique_ptr<OpKernelContext>> contexts_;
+  FIFOQueue* queue_ = nullptr;
+};
+
+TEST_F(FIFOQueueTest, UncontendedOperationsCompleteInline) {
+  MakeQueue(10);
+  for (int32 i = 0; i < 5; ++i) {
+    Notification enqueued;
+    StartEnqueue(i, NewContext(), &enqueued);
+    EXPECT_TRUE(enqueued.HasBeenNotified());
+  }
+  EXPECT_EQ(5, queue_->size());
+  std::vector<int32> values;
+  for (int32 i = 0; i < 5; ++i) {
+    OpKernelContext* ctx = NewContext();
+    Notification dequeued;
+    StartDequeue(ctx, &values, &dequeued);
+    EXPECT_TRUE(dequeued.HasBeenNotified());
+    TF_EXPECT_OK(ctx->status());
+  }
+  EXPECT_EQ(std::vector<int32>({0, 1, 2, 3, 4}), values);
+  EXPECT_EQ(0, queue_->size());
+}
+
+TEST_F(FIFOQueueTest, BlockedDequeuesGetSameElements) {
+  MakeQueue(10);
+  std::vector<int32> values;
+  Notification dequeued[3];
+  for (int i = 0; i < 3; ++i) {
+    StartDequeue(NewContext(), &values, &dequeued[i]);
+    EXPECT_FALSE(dequeued[i].HasBeenNotified());
+  }
+  for (int32 i = 0; i < 3; ++i) {
+    Notification enqueued;
+    StartEnqueue(i, NewContext(), &enqueued);
+    EXPECT_TRUE(enqueued.HasBeenNotified());
+    EXPECT_TRUE(dequeued[i].HasBeenNotified());
+  }
+  EXPECT_EQ(std::vector<int32>({0, 1, 2}), values);
+  EXPECT_EQ(0, queue_->size());
+}
+
+TEST_F(FIFOQueueTest, BlockedEnqueueKeepsOrder) {
+  MakeQueue(2);
+  Notification enqueued[3];
+  for (int32 i = 0; i < 3; ++i) {
+    StartEnqueue(i, NewContext(), &enqueued[i]);
+  }
+  EXPECT_TRUE(enqueued[0].HasBeenNotified());
+  EXPECT_TRUE(enqueued[1].HasBeenNotified());
+  EXPECT_FALSE(enqueued[2].HasBeenNotified());
+
+  std::vector<int32> values;
+  Notification dequeued[3];
+  StartDequeue(NewContext(), &values, &dequeued[0]);
+  EXPECT_TRUE(dequeued[0].HasBeenNotified());
+  EXPECT_TRUE(enqueued[2].HasBeenNotified());
+  StartDequeue(NewContext(), &values, &dequeued[1]);
+  StartDequeue(NewContext(), &values, &dequeued[2]);
+  EXPECT_TRUE(dequeued[2].HasBeenNotified());
+  EXPECT_EQ(std::vector<int32>({0, 1, 2}), values);
+}
+
+TEST_F(FIFOQueueTest, DequeueManyInlineAndBlocked) {
+  MakeQueue(10);
+  for (int32 i = 0; i < 6; ++i) {
+    Notification enqueued;
+    StartEnqueue(i, NewContext(), &enqueued);
+  }
+  std::vector<int32> inline_values;
+  Notification inline_dequeued;
+  StartDequeueMany(3, NewContext(), &inline_values, &inline_dequeued);
+  EXPECT_TRUE(inline_dequeued.HasBeenNotified());
+  EXPECT_EQ(std::vector<int32>({0, 1, 2}), inline_values);
+
+  std::vector<int32> blocked_values;
+  Notification blocked_dequeued;
+  OpKernelContext* ctx = NewContext();
+  StartDequeueMany(4, ctx, &blocked_values, &blocked_dequeued);
+  EXPECT_FALSE(blocked_dequeued.HasBeenNotified());
+  Notification enqueued;
+  StartEnqueue(6, NewContext(), &enqueued);
+  EXPECT_TRUE(blocked_dequeued.HasBeenNotified());
+  TF_EXPECT_OK(ctx->status());
+  EXPECT_EQ(std::vector<int32>({3, 4, 5, 6}), blocked_values);
+  EXPECT_EQ(0, queue_->size());
+}
+
+TEST_F(FIFOQueueTest, CancelledStepIsRejected) {
+  MakeQueue(10);
+  Notification enqueued;
+  StartEnqueue(0, NewContext(), &enqueued);
+  cancellation_manager_.StartCancel();
+
+  OpKernelContext* enqueue_ctx = NewContext();
+  Notification cancelled_enqueue;
+  StartEnqueue(1, enqueue_ctx, &cancelled_enqueue);
+  EXPECT_TRUE(cancelled_enqueue.HasBeenNotified());
+  EXPECT_TRUE(errors::IsCancelled(enqueue_ctx->status()));
+
+  OpKernelContext* dequeue_ctx = NewContext();
+  std::vector<int32> values;
+  Notification cancelled_dequeue;
+  StartDequeue(dequeue_ctx, &values, &cancelled_dequeue);
+  EXPECT_TRUE(cancelled_dequeue.HasBeenNotified());
+  EXPECT_TRUE(errors::IsCancelled(dequeue_ctx->status()));
+  EXPECT_TRUE(values.empty());
+  EXPECT_EQ(1, queue_->size());
+}
+
+TEST_F(FIFOQueueTest, ClosedQueueRejectsEnqueue) {
+  MakeQueue(10);
+  Notification enqueued;
+  StartEnqueue(0, NewContext(), &enqueued);
+  Notification closed;
+  queue_->Close(NewContext(), /*cancel_pending_enqueues=*/false,
+                [&closed]() { closed.Notify(); });
+  EXPECT_TRUE(closed.HasBeenNotified());
+
+  OpKernelContext* ctx = NewContext();
+  Notification rejected;
+  StartEnqueue(1, ctx, &rejected);
+  EXPECT_TRUE(rejected.HasBeenNotified());
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+
+  // The element enqueued before Close is still dequeued inline.
+  std::vector<int32> values;
+  Notification dequeued;
+  StartDequeue(NewContext(), &values, &dequeued);
+  EXPECT_TRUE(dequeued.HasBeenNotified());
+  EXPECT_EQ(std::vector<int32>({0}), values);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status Init(int num_inputs, const std::vector<string>& op_names,
+              const std::vector<int>& operands) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+            .Input(FakeInput(num_inputs, DT_FLOAT))
+            .Attr("op_names", op_names)
+            .Attr("operands", operands)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, MulAddTanhMul) {
+  // tanh(x * y + 1) * y, with the same value read by several ops.
+  TF_ASSERT_OK(Init(3, {"Mul", "AddV2", "Tanh", "Mul"},
+                    {0, 1, 3, 2, 4, -1, 5, 1}));
+  // More elements than a tile, so that several tiles run.
+  const int size = 10000;
+  std::vector<float> x(size), y(size), expected(size);
+  for (int i = 0; i < size; ++i) {
+    x[i] = 0.001f * i - 5.0f;
+    y[i] = 0.5f - 0.0001f * i;
+    expected[i] = std::tanh(x[i] * y[i] + 1.0f) * y[i];
+  }
+  AddInputFromArray<float>(TensorShape({100, 100}), x);
+  AddInputFromArray<float>(TensorShape({100, 100}), y);
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_tensor(allocator(), DT_FLOAT, TensorShape({100, 100}));
+  test::FillValues<float>(&expected_tensor, expected);
+  test::ExpectTensorNear<float>(expected_tensor, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsInvalidPrograms) {
+  EXPECT_TRUE(errors::IsInvalidArgument(Init(1, {"Tanh"}, {1, -1})));
+  EXPECT_TRUE(errors::IsInvalidArgument(Init(2, {"Tanh"}, {0, 1})));
+  EXPECT_TRUE(errors::IsInvalidArgument(Init(2, {"Add"}, {0, -1})));
+  EXPECT_TRUE(errors::IsInvalidArgument(Init(1, {"Cumsum"}, {0, -1})));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsBroadcasts) {
+  TF_ASSERT_OK(Init(2, {"Add"}, {0, 1}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
 #include "tensorflow/core/framework/bounds_check.h"
@@ -151,6 +154,63 @@ struct GatherFunctorCPU {
   }
 };
 
+// Gathers the rows indices[t] of params[t] into out[t] for every table t. The
+// copies of all the tables are sharded together, so that many small gathers
+// share a single parallel loop instead of one per table. Returns the index of a
+// table with an out of range index and sets *bad_i to its position in
+// indices[t], or returns -1.
+template <typename T, typename Index>
+int64 GroupedGatherFunctorCPU(
+    OpKernelContext* ctx,
+    const std::vector<typename TTypes<T>::ConstMatrix>& params,
+    const std::vector<typename TTypes<Index>::ConstFlat>& indices,
+    std::vector<typename TTypes<T>::Matrix>* out, int64* bad_i) {
+  const int num_tables = params.size();
+  // offsets[t] is the position of the first row of table t among the rows of
+  // all the tables.
+  std::vector<int64> offsets(num_tables + 1, 0);
+  int64 total_bytes = 0;
+  for (int t = 0; t < num_tables; ++t) {
+    offsets[t + 1] = offsets[t] + indices[t].size();
+    total_bytes += indices[t].size() * params[t].dimension(1) * sizeof(T);
+  }
+  const int64 total_rows = offsets[num_tables];
+  if (total_rows == 0) {
+    return -1;
+  }
+
+  mutex mu;
+  int64 bad_table = -1;
+  auto work = [&](int64 start, int64 end) {
+    int t = std::upper_bound(offsets.begin(), offsets.end(), start) -
+            offsets.begin() - 1;
+    for (int64 i = start; i < end; ++i) {
+      while (i >= offsets[t + 1]) {
+        ++t;
+      }
+      const int64 row = i - offsets[t];
+      const Index index = internal::SubtleMustCopy(indices[t](row));
+      if (!FastBoundsCheck(index, params[t].dimension(0))) {
+        mutex_lock l(mu);
+        bad_table = t;
+        *bad_i = row;
+        return;
+      }
+      const int64 slice_elems = params[t].dimension(1);
+      if (is_simple_type<T>::value) {
+        memcpy(&(*out)[t](row, 0), &params[t](index, 0),
+               slice_elems * sizeof(T));
+      } else {
+        (*out)[t].template chip<0>(row) = params[t].template chip<0>(index);
+      }
+    }
+  };
+  auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, total_rows,
+        std::max<int64>(1, total_bytes / total_rows), work);
+  return bad_table;
+}
+
 template <typename Device, typename T, typename Index>
 struct GatherFunctor {
   int64 operator()(OpKernelContext* ctx,
@@ -17,6 +17,8 @@ limitations under the License.
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <ctype.h>
+
 #include <iterator>
 
 #include "google/protobuf/any.pb.h"
@@ -228,6 +230,36 @@ void LogFusedConvForwardAutotuneResults(
 // TF_DETERMINISTIC_OPS on its own.
 // TODO(duncanriach): move to an API that uses tf.config and implement the first
 //                    phase of plumbing.
+string AutotuneDeviceKind(se::StreamExecutor* stream_exec) {
+  string kind = stream_exec->GetDeviceDescription().name();
+  if (auto* dnn = stream_exec->AsDnn()) {
+    se::port::StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const auto& version = version_or.ValueOrDie();
+      strings::StrAppend(&kind, "_dnn_", version.major_version(), ".",
+                         version.minor_version(), ".", version.patch());
+    }
+  }
+  // The kind names a directory.
+  for (char& c : kind) {
+    if (!isalnum(c) && c != '.' && c != '-') c = '_';
+  }
+  return kind;
+}
+
+int64 ConvAutotuneBatchBucket(int64 batch) {
+  static bool use_buckets = [] {
+    bool use_buckets = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_CONV_AUTOTUNE_BATCH_BUCKETS",
+                                   /*default_val=*/false, &use_buckets));
+    return use_buckets;
+  }();
+  if (!use_buckets || batch <= 1) return batch;
+  int64 bucket = 1;
+  while (bucket < batch) bucket <<= 1;
+  return bucket;
+}
+
 bool RequireCudnnDeterminism() {
   static bool require_cudnn_determinism = [] {
     bool deterministic_ops = false;
@@ -19,6 +19,8 @@ limitations under the License.
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -145,6 +147,29 @@ class AutoTuneMap {
     autotune_global_count_++;
   }
 
+  // Returns the configs that Find() returns.
+  std::vector<std::pair<Parameters, Config>> GetAcceptedConfigs() const {
+    mutex_lock lock(mu_);
+    std::vector<std::pair<Parameters, Config>> accepted;
+    for (const auto& p : params_config_map_) {
+      if (p.second.score >= min_score_threshold_ ||
+          p.second.count > max_autotune_count_) {
+        accepted.emplace_back(p.first, p.second.config);
+      }
+    }
+    return accepted;
+  }
+
+  // Accepts "config" for "params", as if it had won the autotuning, e.g. to
+  // restore the results of an earlier process.
+  void InsertAccepted(const Parameters& params, const Config& config) {
+    mutex_lock lock(mu_);
+    VLOG(1) << GetActionSummary("restores", params, config);
+    params_config_map_.erase(params);
+    params_config_map_.insert(
+        std::make_pair(params, ValueType{config, min_score_threshold_, 1}));
+  }
+
  private:
   AutoTuneMap(const std::string& name) : name_(name) {
     min_score_threshold_ = 1;
@@ -237,6 +262,17 @@ void LogFusedConvForwardAutotuneResults(
     double side_value_scale, se::dnn::ActivationMode activation_mode,
     se::StreamExecutor* stream_exec, absl::Span<const AutotuneResult> results);
 
+// Returns the kind of the device of "stream_exec" under which its autotune
+// results persist, see autotune_cache_registry.h: its model and the version of
+// its DNN library, e.g. "Tesla_V100-SXM2-16GB_dnn_7.6.5".
+string AutotuneDeviceKind(se::StreamExecutor* stream_exec);
+
+// Returns the batch size under which to autotune convolutions of batch size
+// "batch". It is "batch", unless TF_CONV_AUTOTUNE_BATCH_BUCKETS is set, in
+// which case it is rounded up to the next power of two so that the batch sizes
+// of a bucket share their results.
+int64 ConvAutotuneBatchBucket(int64 batch);
+
 // Returns the best algorithms for the config, one is the fastest, the other is
 // other is fastest with 0 scratch space. Unsuccessful autotuning results are
 // allowed and ignored.
@@ -0,0 +1,182 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Gathers from many tables in a single kernel, for models looking up one
+// embedding table per feature column.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/gather_functor.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/util.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Gathers the rows `indices[t]` of every `params[t]` into output t of `c`.
+// REQUIRES: params and indices have the same number of tensors.
+template <typename T, typename Index>
+void GroupedGather(OpKernelContext* c,
+                   const std::vector<const Tensor*>& params,
+                   const OpInputList& indices) {
+  const int num_tables = params.size();
+  std::vector<typename TTypes<T>::ConstMatrix> params_flat;
+  std::vector<typename TTypes<Index>::ConstFlat> indices_flat;
+  std::vector<typename TTypes<T>::Matrix> out_flat;
+  params_flat.reserve(num_tables);
+  indices_flat.reserve(num_tables);
+  out_flat.reserve(num_tables);
+  for (int t = 0; t < num_tables; ++t) {
+    const Tensor& table = *params[t];
+    OP_REQUIRES(c, TensorShapeUtils::IsVectorOrHigher(table.shape()),
+                errors::InvalidArgument("params[", t,
+                                        "] must be at least 1 dimensional"));
+    OP_REQUIRES(
+        c, table.dim_size(0) <= std::numeric_limits<Index>::max(),
+        errors::InvalidArgument("params[", t, "].shape[0] too large for ",
+                                DataTypeString(DataTypeToEnum<Index>::v()),
+                                " indexing: ", table.dim_size(0), " > ",
+                                std::numeric_limits<Index>::max()));
+
+    // The result shape is indices.shape + params.shape[1:].
+    TensorShape result_shape = indices[t].shape();
+    for (int i = 1; i < table.dims(); ++i) {
+      result_shape.AddDim(table.dim_size(i));
+    }
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(c, c->allocate_output(t, result_shape, &out));
+
+    params_flat.push_back(table.flat_outer_dims<T>());
+    indices_flat.push_back(indices[t].flat<Index>());
+    const int64 num_rows = indices[t].NumElements();
+    out_flat.push_back(out->shaped<T, 2>(
+        {num_rows, num_rows == 0 ? 0 : out->NumElements() / num_rows}));
+  }
+
+  int64 bad_i = -1;
+  const int64 bad_table = functor::GroupedGatherFunctorCPU<T, Index>(
+      c, params_flat, indices_flat, &out_flat, &bad_i);
+  OP_REQUIRES(c, bad_table < 0,
+              errors::InvalidArgument(
+                  "indices[", bad_table, "]",
+                  SliceDebugString(indices[bad_table].shape(), bad_i), " = ",
+                  indices_flat[bad_table](bad_i), " is not in [0, ",
+                  params[bad_table]->dim_size(0), ")"));
+}
+
+}  // namespace
+
+// Equivalent to one GatherV2 with axis 0 per pair of params and indices.
+template <typename T, typename Index>
+class GroupedGatherOp : public OpKernel {
+ public:
+  explicit GroupedGatherOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    OpInputList params;
+    OP_REQUIRES_OK(c, c->input_list("params", &params));
+    OpInputList indices;
+    OP_REQUIRES_OK(c, c->input_list("indices", &indices));
+    std::vector<const Tensor*> tables;
+    tables.reserve(params.size());
+    for (int t = 0; t < params.size(); ++t) {
+      tables.push_back(&params[t]);
+    }
+    GroupedGather<T, Index>(c, tables, indices);
+  }
+};
+
+// Equivalent to one ResourceGather per pair of resources and indices.
+template <typename T, typename Index>
+class ResourceGroupedGatherOp : public OpKernel {
+ public:
+  explicit ResourceGroupedGatherOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    OpInputList indices;
+    OP_REQUIRES_OK(c, c->input_list("indices", &indices));
+    const int num_tables = indices.size();
+    std::vector<core::RefCountPtr<Var>> vars(num_tables);
+    std::vector<mutex*> mutexes;
+    for (int t = 0; t < num_tables; ++t) {
+      OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, t), &vars[t]));
+      OP_REQUIRES_OK(
+          c, EnsureSparseVariableAccess<CPUDevice, T>(c, vars[t].get()));
+      // Read-only variables are never written, and need no lock.
+      if (!vars[t]->read_only.load()) mutexes.push_back(vars[t]->mu());
+    }
+    // Like ResourceGather, hold the locks for the whole gather rather than
+    // taking references to the tensors, which would make the next update of
+    // the variables copy them. The locks are acquired in address order to
+    // avoid deadlocks.
+    std::sort(mutexes.begin(), mutexes.end());
+    mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
+    std::vector<tf_shared_lock> locks;
+    locks.reserve(mutexes.size());
+    for (mutex* mu : mutexes) {
+      locks.emplace_back(*mu);
+    }
+
+    std::vector<const Tensor*> tables;
+    tables.reserve(num_tables);
+    for (int t = 0; t < num_tables; ++t) {
+      OP_REQUIRES(c, vars[t]->tensor()->dtype() == DataTypeToEnum<T>::v(),
+                  errors::InvalidArgument(
+                      "Trying to gather from variable ", t, " with dtype ",
+                      DataTypeString(vars[t]->tensor()->dtype()), " as ",
+                      DataTypeString(DataTypeToEnum<T>::v())));
+      tables.push_back(vars[t]->tensor());
+    }
+    GroupedGather<T, Index>(c, tables, indices);
+  }
+};
+
+#define REGISTER_GROUPED_GATHER_CPU(type, index_type)                  \
+  REGISTER_KERNEL_BUILDER(Name("GroupedGather")                        \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<type>("Tparams")         \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          GroupedGatherOp<type, index_type>);          \
+  REGISTER_KERNEL_BUILDER(Name("ResourceGroupedGather")                \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<type>("dtype")           \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          ResourceGroupedGatherOp<type, index_type>)
+
+#define REGISTER_GROUPED_GATHER_ALL_INDICES(type) \
+  REGISTER_GROUPED_GATHER_CPU(type, int32);       \
+  REGISTER_GROUPED_GATHER_CPU(type, int64)
+
+TF_CALL_ALL_TYPES(REGISTER_GROUPED_GATHER_ALL_INDICES);
+TF_CALL_QUANTIZED_TYPES(REGISTER_GROUPED_GATHER_ALL_INDICES);
+
+#undef REGISTER_GROUPED_GATHER_ALL_INDICES
+#undef REGISTER_GROUPED_GATHER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,128 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class GroupedGatherOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int n) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "GroupedGather")
+                     .Input(FakeInput(n, DT_FLOAT))
+                     .Input(FakeInput(n, DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(GroupedGatherOpTest, GathersEveryTable) {
+  MakeOp(3);
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<float>(TensorShape({4}), {10, 11, 12, 13});
+  AddInputFromArray<float>(TensorShape({2, 1}), {20, 21});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 0});
+  AddInputFromArray<int32>(TensorShape({2, 2}), {3, 3, 0, 1});
+  AddInputFromArray<int32>(TensorShape({0}), {});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected0, {4, 5, 0, 1});
+  test::ExpectTensorEqual<float>(expected0, *GetOutput(0));
+  Tensor expected1(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected1, {13, 13, 10, 11});
+  test::ExpectTensorEqual<float>(expected1, *GetOutput(1));
+  Tensor expected2(allocator(), DT_FLOAT, TensorShape({0, 1}));
+  test::ExpectTensorEqual<float>(expected2, *GetOutput(2));
+}
+
+TEST_F(GroupedGatherOpTest, Error_IndexOutOfRange) {
+  MakeOp(2);
+  AddInputFromArray<float>(TensorShape({2}), {0, 1});
+  AddInputFromArray<float>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 3});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(),
+                                "indices[1][1] = 3 is not in [0, 3)"))
+      << s;
+}
+
+// Gathers `batch_size` rows of `dim` floats from each of `num_tables` tables,
+// with either one GatherV2 per table or a single GroupedGather.
+static Graph* MultiTableGather(bool grouped, int num_tables, int batch_size,
+                               int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  constexpr int kVocabSize = 10000;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<NodeBuilder::NodeOut> params;
+  std::vector<NodeBuilder::NodeOut> indices;
+  for (int t = 0; t < num_tables; ++t) {
+    Tensor table(DT_FLOAT, TensorShape({kVocabSize, dim}));
+    table.flat<float>().setRandom();
+    params.emplace_back(test::graph::Constant(g, table));
+    Tensor ids(DT_INT32, TensorShape({batch_size}));
+    for (int i = 0; i < batch_size; ++i) {
+      ids.flat<int32>()(i) = rnd.Uniform(kVocabSize);
+    }
+    indices.emplace_back(test::graph::Constant(g, ids));
+  }
+  if (grouped) {
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g->NewName("grouped_gather"), "GroupedGather")
+                    .Input(params)
+                    .Input(indices)
+                    .Finalize(g, &node));
+  } else {
+    Node* axis = test::graph::Constant(g, test::AsScalar<int32>(0));
+    for (int t = 0; t < num_tables; ++t) {
+      test::graph::Gather(g, params[t].node, indices[t].node, axis);
+    }
+  }
+  return g;
+}
+
+#define BM_MultiTableGather(GROUPED, TABLES, BATCH, DIM)                      \
+  static void BM_MultiTableGather_##GROUPED##_##TABLES##_##BATCH##_##DIM(     \
+      int iters) {                                                            \
+    testing::ItemsProcessed(static_cast<int64>(iters) * TABLES * BATCH);      \
+    test::Benchmark("cpu", MultiTableGather(GROUPED, TABLES, BATCH, DIM))     \
+        .Run(iters);                                                          \
+  }                                                                           \
+  BENCHMARK(BM_MultiTableGather_##GROUPED##_##TABLES##_##BATCH##_##DIM);
+
+BM_MultiTableGather(false, 100, 256, 16);
+BM_MultiTableGather(true, 100, 256, 16);
+BM_MultiTableGather(false, 10, 4096, 64);
+BM_MultiTableGather(true, 10, 4096, 64);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,210 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/image/crop_resize_flip_and_normalize_op.h"
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+// Runs the usual input pipeline augmentations of an image batch in a single
+// kernel, so that uint8 images can be copied to the GPU and augmented there
+// instead of on the CPU threads feeding it.
+template <typename Device, typename T>
+class CropResizeFlipAndNormalizeOp : public OpKernel {
+ public:
+  explicit CropResizeFlipAndNormalizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("extrapolation_value",
+                                             &extrapolation_value_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& images = context->input(0);
+    const Tensor& boxes = context->input(1);
+    const Tensor& flip = context->input(2);
+    const Tensor& size = context->input(3);
+    const Tensor& mean = context->input(4);
+    const Tensor& scale = context->input(5);
+
+    OP_REQUIRES(context, images.dims() == 4,
+                errors::InvalidArgument("images must be 4-D",
+                                        images.shape().DebugString()));
+    const int64 batch_size = images.dim_size(0);
+    const int64 depth = images.dim_size(3);
+    OP_REQUIRES(
+        context, images.dim_size(1) > 0 && images.dim_size(2) > 0,
+        errors::InvalidArgument("image dimensions must be positive"));
+    OP_REQUIRES(context,
+                boxes.dims() == 2 && boxes.dim_size(0) == batch_size &&
+                    boxes.dim_size(1) == 4,
+                errors::InvalidArgument("boxes must have shape [", batch_size,
+                                        ", 4] but got ",
+                                        boxes.shape().DebugString()));
+    OP_REQUIRES(context,
+                flip.dims() == 1 && flip.dim_size(0) == batch_size,
+                errors::InvalidArgument("flip must have shape [", batch_size,
+                                        "] but got ",
+                                        flip.shape().DebugString()));
+    OP_REQUIRES(context, mean.dims() == 1 && mean.dim_size(0) == depth,
+                errors::InvalidArgument("mean must have shape [", depth,
+                                        "] but got ",
+                                        mean.shape().DebugString()));
+    OP_REQUIRES(context, scale.dims() == 1 && scale.dim_size(0) == depth,
+                errors::InvalidArgument("scale must have shape [", depth,
+                                        "] but got ",
+                                        scale.shape().DebugString()));
+    OP_REQUIRES(context, size.dims() == 1 && size.NumElements() == 2,
+                errors::InvalidArgument("size must be 1-D with two elements",
+                                        size.shape().DebugString()));
+    const int32 height = size.vec<int32>()(0);
+    const int32 width = size.vec<int32>()(1);
+    OP_REQUIRES(context, height > 0 && width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        height, ", ", width, "]"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch_size, height, width, depth}),
+                       &output));
+    if (output->NumElements() == 0) return;
+
+    functor::CropResizeFlipAndNormalize<Device, T>()(
+        context->eigen_device<Device>(), images.tensor<T, 4>(),
+        boxes.tensor<float, 2>(), flip.tensor<bool, 1>(),
+        mean.tensor<float, 1>(), scale.tensor<float, 1>(),
+        extrapolation_value_, output->tensor<float, 4>());
+  }
+
+ private:
+  float extrapolation_value_;
+};
+
+namespace functor {
+
+template <typename T>
+struct CropResizeFlipAndNormalize<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
+                  typename TTypes<float, 2>::ConstTensor boxes,
+                  typename TTypes<bool, 1>::ConstTensor flip,
+                  typename TTypes<float, 1>::ConstTensor mean,
+                  typename TTypes<float, 1>::ConstTensor scale,
+                  float extrapolation_value,
+                  typename TTypes<float, 4>::Tensor output) {
+    const int image_height = images.dimension(1);
+    const int image_width = images.dimension(2);
+    const int height = output.dimension(1);
+    const int width = output.dimension(2);
+    const int depth = output.dimension(3);
+    const int64 image_size = static_cast<int64>(image_height) * image_width *
+                             depth;
+
+    // Each unit of work is one output row.
+    auto work = [&](int64 start, int64 limit) {
+      for (int64 row = start; row < limit; ++row) {
+        const int b = row / height;
+        const int y = row % height;
+        const T* image = images.data() + b * image_size;
+        const float* box = &boxes(b, 0);
+        float* out = &output(b, y, 0, 0);
+        for (int x = 0; x < width; ++x) {
+          const int in_x = flip(b) ? width - 1 - x : x;
+          for (int c = 0; c < depth; ++c) {
+            const float value =
+                SampleCrop(image, image_height, image_width, depth, box,
+                           height, width, y, in_x, c, extrapolation_value);
+            out[x * depth + c] = (value - mean(c)) * scale(c);
+          }
+        }
+      }
+    };
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/4 * width * depth * sizeof(T),
+        /*bytes_stored=*/width * depth * sizeof(float),
+        /*compute_cycles=*/width * depth * 20);
+    d.parallelFor(output.dimension(0) * height, cost, work);
+  }
+};
+
+}  // namespace functor
+
+#define REGISTER_KERNEL(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("CropResizeFlipAndNormalize")   \
+                              .Device(DEVICE_CPU)              \
+                              .TypeConstraint<T>("T"),         \
+                          CropResizeFlipAndNormalizeOp<CPUDevice, T>);
+
+TF_CALL_uint8(REGISTER_KERNEL);
+TF_CALL_half(REGISTER_KERNEL);
+TF_CALL_float(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Forward declarations of the function specializations for GPU (to prevent
+// building the GPU versions here, they will be built compiling _gpu.cu.cc).
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                          \
+  template <>                                                        \
+  void CropResizeFlipAndNormalize<GPUDevice, T>::operator()(         \
+      const GPUDevice& d, typename TTypes<T, 4>::ConstTensor images, \
+      typename TTypes<float, 2>::ConstTensor boxes,                  \
+      typename TTypes<bool, 1>::ConstTensor flip,                    \
+      typename TTypes<float, 1>::ConstTensor mean,                   \
+      typename TTypes<float, 1>::ConstTensor scale,                  \
+      float extrapolation_value,                                     \
+      typename TTypes<float, 4>::Tensor output);                     \
+  extern template struct CropResizeFlipAndNormalize<GPUDevice, T>;
+
+DECLARE_GPU_SPEC(uint8);
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_KERNEL(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("CropResizeFlipAndNormalize")   \
+                              .Device(DEVICE_GPU)              \
+                              .TypeConstraint<T>("T")          \
+                              .HostMemory("size"),             \
+                          CropResizeFlipAndNormalizeOp<GPUDevice, T>);
+
+TF_CALL_uint8(REGISTER_KERNEL);
+TF_CALL_half(REGISTER_KERNEL);
+TF_CALL_float(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,93 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_IMAGE_CROP_RESIZE_FLIP_AND_NORMALIZE_OP_H_
+#define TENSORFLOW_CORE_KERNELS_IMAGE_CROP_RESIZE_FLIP_AND_NORMALIZE_OP_H_
+
+#include <cmath>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// Returns channel `d` of pixel (`y`, `x`) of the bilinear resize of `box` in
+// the image starting at `image`, with the same sampling as CropAndResize.
+template <typename T>
+EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE float SampleCrop(
+    const T* image, int image_height, int image_width, int depth,
+    const float* box, int crop_height, int crop_width, int y, int x, int d,
+    float extrapolation_value) {
+  const float y1 = box[0];
+  const float x1 = box[1];
+  const float y2 = box[2];
+  const float x2 = box[3];
+  const float in_y =
+      (crop_height > 1)
+          ? y1 * (image_height - 1) +
+                y * ((y2 - y1) * (image_height - 1) / (crop_height - 1))
+          : 0.5f * (y1 + y2) * (image_height - 1);
+  const float in_x =
+      (crop_width > 1)
+          ? x1 * (image_width - 1) +
+                x * ((x2 - x1) * (image_width - 1) / (crop_width - 1))
+          : 0.5f * (x1 + x2) * (image_width - 1);
+  if (in_y < 0 || in_y > image_height - 1 || in_x < 0 ||
+      in_x > image_width - 1) {
+    return extrapolation_value;
+  }
+
+  const int top_y_index = floorf(in_y);
+  const int bottom_y_index = ceilf(in_y);
+  const float y_lerp = in_y - top_y_index;
+  const int left_x_index = floorf(in_x);
+  const int right_x_index = ceilf(in_x);
+  const float x_lerp = in_x - left_x_index;
+
+  const T* top_row = image + top_y_index * image_width * depth;
+  const T* bottom_row = image + bottom_y_index * image_width * depth;
+  const float top_left = static_cast<float>(top_row[left_x_index * depth + d]);
+  const float top_right =
+      static_cast<float>(top_row[right_x_index * depth + d]);
+  const float bottom_left =
+      static_cast<float>(bottom_row[left_x_index * depth + d]);
+  const float bottom_right =
+      static_cast<float>(bottom_row[right_x_index * depth + d]);
+  const float top = top_left + (top_right - top_left) * x_lerp;
+  const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
+  return top + (bottom - top) * y_lerp;
+}
+
+// Crops boxes(b) out of images(b), resizes it bilinearly to the size of
+// output, mirrors it horizontally if flip(b), and normalizes channel d to
+// (value - mean(d)) * scale(d).
+template <typename Device, typename T>
+struct CropResizeFlipAndNormalize {
+  // We assume that the tensor sizes are correct.
+  void operator()(const Device& d, typename TTypes<T, 4>::ConstTensor images,
+                  typename TTypes<float, 2>::ConstTensor boxes,
+                  typename TTypes<bool, 1>::ConstTensor flip,
+                  typename TTypes<float, 1>::ConstTensor mean,
+                  typename TTypes<float, 1>::ConstTensor scale,
+                  float extrapolation_value,
+                  typename TTypes<float, 4>::Tensor output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_IMAGE_CROP_RESIZE_FLIP_AND_NORMALIZE_OP_H_
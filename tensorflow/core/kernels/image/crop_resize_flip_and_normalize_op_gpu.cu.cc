@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/image/crop_resize_flip_and_normalize_op.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+template <typename T>
+__global__ void CropResizeFlipAndNormalizeKernel(
+    const int32 nthreads, const T* __restrict__ images,
+    const float* __restrict__ boxes, const bool* __restrict__ flip,
+    const float* __restrict__ mean, const float* __restrict__ scale,
+    int image_height, int image_width, int height, int width, int depth,
+    float extrapolation_value, float* __restrict__ output) {
+  GPU_1D_KERNEL_LOOP(out_idx, nthreads) {
+    // out_idx = c + depth * (x + width * (y + height * b))
+    int idx = out_idx;
+    const int c = idx % depth;
+    idx /= depth;
+    const int x = idx % width;
+    idx /= width;
+    const int y = idx % height;
+    const int b = idx / height;
+
+    const int in_x = flip[b] ? width - 1 - x : x;
+    const float value = functor::SampleCrop(
+        images + static_cast<int64>(b) * image_height * image_width * depth,
+        image_height, image_width, depth, boxes + b * 4, height, width, y,
+        in_x, c, extrapolation_value);
+    output[out_idx] = (value - ldg(mean + c)) * ldg(scale + c);
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+struct CropResizeFlipAndNormalize<GPUDevice, T> {
+  void operator()(const GPUDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
+                  typename TTypes<float, 2>::ConstTensor boxes,
+                  typename TTypes<bool, 1>::ConstTensor flip,
+                  typename TTypes<float, 1>::ConstTensor mean,
+                  typename TTypes<float, 1>::ConstTensor scale,
+                  float extrapolation_value,
+                  typename TTypes<float, 4>::Tensor output) {
+    const int total_count = output.size();
+    GpuLaunchConfig config = GetGpuLaunchConfig(total_count, d);
+    TF_CHECK_OK(GpuLaunchKernel(
+        CropResizeFlipAndNormalizeKernel<T>, config.block_count,
+        config.thread_per_block, 0, d.stream(), config.virtual_thread_count,
+        images.data(), boxes.data(), flip.data(), mean.data(), scale.data(),
+        static_cast<int>(images.dimension(1)),
+        static_cast<int>(images.dimension(2)),
+        static_cast<int>(output.dimension(1)),
+        static_cast<int>(output.dimension(2)),
+        static_cast<int>(output.dimension(3)), extrapolation_value,
+        output.data()));
+  }
+};
+
+template struct CropResizeFlipAndNormalize<GPUDevice, uint8>;
+template struct CropResizeFlipAndNormalize<GPUDevice, Eigen::half>;
+template struct CropResizeFlipAndNormalize<GPUDevice, float>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
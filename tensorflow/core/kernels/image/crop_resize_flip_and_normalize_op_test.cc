@@ -0,0 +1,137 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class CropResizeFlipAndNormalizeOpTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  void MakeOp(float extrapolation_value) {
+    TF_EXPECT_OK(NodeDefBuilder("crop_resize_flip_and_normalize_op",
+                                "CropResizeFlipAndNormalize")
+                     .Input(FakeInput(DataTypeToEnum<T>::value))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_BOOL))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("extrapolation_value", extrapolation_value)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+// The first test runs two copies of a 2x2 image with channels [1, 2; 3, 4]
+// and [10, 20; 30, 40], of which only the second one is flipped.
+#define REGISTER_TEST(T)                                                      \
+  TEST_F(CropResizeFlipAndNormalizeOpTest, TestFlipAndNormalize##T) {         \
+    MakeOp<T>(0);                                                             \
+    AddInputFromArray<T>(TensorShape({2, 2, 2, 2}),                           \
+                         {1, 10, 2, 20, 3, 30, 4, 40,                         \
+                          1, 10, 2, 20, 3, 30, 4, 40});                       \
+    AddInputFromArray<float>(TensorShape({2, 4}), {0, 0, 1, 1, 0, 0, 1, 1});  \
+    AddInputFromArray<bool>(TensorShape({2}), {false, true});                 \
+    AddInputFromArray<int32>(TensorShape({2}), {2, 2});                       \
+    AddInputFromArray<float>(TensorShape({2}), {1, 10});                      \
+    AddInputFromArray<float>(TensorShape({2}), {2, 0.1});                     \
+    TF_ASSERT_OK(RunOpKernel());                                              \
+                                                                              \
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2, 2, 2}));        \
+    test::FillValues<float>(&expected, {0, 0, 2, 1, 4, 2, 6, 3,               \
+                                        2, 1, 0, 0, 6, 3, 4, 2});             \
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);             \
+  }                                                                           \
+                                                                              \
+  TEST_F(CropResizeFlipAndNormalizeOpTest, TestResize##T) {                   \
+    MakeOp<T>(0);                                                             \
+    AddInputFromArray<T>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});            \
+    AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});              \
+    AddInputFromArray<bool>(TensorShape({1}), {false});                       \
+    AddInputFromArray<int32>(TensorShape({2}), {1, 1});                       \
+    AddInputFromArray<float>(TensorShape({1}), {0});                          \
+    AddInputFromArray<float>(TensorShape({1}), {1});                          \
+    TF_ASSERT_OK(RunOpKernel());                                              \
+                                                                              \
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 1, 1, 1}));        \
+    test::FillValues<float>(&expected, {2.5});                                \
+    test::ExpectTensorEqual<float>(expected, *GetOutput(0));                  \
+  }
+
+REGISTER_TEST(float)
+REGISTER_TEST(uint8)
+
+#undef REGISTER_TEST
+
+TEST_F(CropResizeFlipAndNormalizeOpTest, TestCropAndResize) {
+  MakeOp<float>(0);
+  // Input:
+  //  1, 2, 3
+  //  4, 5, 6
+  //  7, 8, 9
+  AddInputFromArray<float>(TensorShape({1, 3, 3, 1}),
+                           {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 0.5, 1});
+  AddInputFromArray<bool>(TensorShape({1}), {true});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 3});
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2, 3, 1}));
+  test::FillValues<float>(&expected, {2, 1, 0, 5, 4, 3});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(CropResizeFlipAndNormalizeOpTest, TestExtrapolation) {
+  MakeOp<float>(5);
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {1.5, 1.5, 2, 2});
+  AddInputFromArray<bool>(TensorShape({1}), {false});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 1});
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({1}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 1, 1, 1}));
+  test::FillValues<float>(&expected, {8});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(CropResizeFlipAndNormalizeOpTest, TestInvalidBoxes) {
+  MakeOp<float>(0);
+  AddInputFromArray<float>(TensorShape({2, 2, 2, 1}),
+                           {1, 2, 3, 4, 1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<bool>(TensorShape({2}), {false, false});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 1});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  Status s = RunOpKernel();
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "boxes must have shape [2, 4]"))
+      << s;
+}
+
+}  // namespace tensorflow
@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -312,10 +315,16 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
 }  // namespace
 
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
+//
+// The buckets are split into kNumStripes contiguous ranges, each protected by
+// its own lock, so that lookups and inserts that touch different stripes run
+// concurrently. mu_ is held in shared mode while accessing the buckets and in
+// exclusive mode to reallocate them.
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
-  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel)
+      : stripes_(new mutex[kNumStripes]) {
     OP_REQUIRES_OK(
         ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
     OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
@@ -375,10 +384,7 @@ class MutableDenseHashTable final : public LookupInterface {
     OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
   }
 
-  size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
-    return num_entries_;
-  }
+  size_t size() const override { return num_entries_; }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override TF_LOCKS_EXCLUDED(mu_) {
@@ -406,6 +412,7 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const int64 bit_mask = num_buckets_ - 1;
+    StripeLock stripe_lock(stripes_.get(), stripe_shift_, /*exclusive=*/false);
     // TODO(andreasst): parallelize using work_sharder
     for (int64 i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
@@ -422,6 +429,7 @@ class MutableDenseHashTable final : public LookupInterface {
       int64 bucket_index = key_hash & bit_mask;
       int64 num_probes = 0;
       while (true) {
+        stripe_lock.Acquire(bucket_index);
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           for (int64 j = 0; j < value_size; ++j) {
             // TODO(andreasst): check if we can get rid of SubtleMustCopy
@@ -459,11 +467,24 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
     // For simplicity we assume that all keys in the input result in inserts
     // rather than updates. That means we may grow the table even though we
     // don't need to. As long as the number of keys inserted in one call is
     // small compared to the size of the map, the impact of this is minimal.
+    {
+      // Concurrent inserts reserve room for their keys, and only fall back to
+      // the exclusive lock when the table has to grow.
+      tf_shared_lock l(mu_);
+      const int64 reserved =
+          num_reserved_entries_.fetch_add(batch_size) + batch_size;
+      if (num_entries_ + reserved <= num_buckets_ * max_load_factor_) {
+        Status s = DoInsert(ctx, key, value, false);
+        num_reserved_entries_.fetch_sub(batch_size);
+        return s;
+      }
+      num_reserved_entries_.fetch_sub(batch_size);
+    }
+    mutex_lock l(mu_);
     const int64 pending_num_entries = num_entries_ + batch_size;
     if (pending_num_entries > num_buckets_ * max_load_factor_) {
       int64 new_num_buckets = num_buckets_;
@@ -484,14 +505,14 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return DoRemove(ctx, key);
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
-    num_buckets_ = keys.dim_size(0);
+    SetNumBuckets(keys.dim_size(0));
     key_buckets_ = PersistentTensor(keys);
     value_buckets_ = PersistentTensor(values);
     // Count the number of keys that are not the empty_key or deleted_key.
@@ -506,17 +527,20 @@ class MutableDenseHashTable final : public LookupInterface {
             {1, key_shape_.num_elements()});
     const auto key_buckets_tensor =
         key_buckets_.AccessTensor(ctx)->template matrix<K>();
+    int64 num_entries = 0;
     for (int64 i = 0; i < num_buckets_; ++i) {
       if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
           !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
-        ++num_entries_;
+        ++num_entries;
       }
     }
+    num_entries_ = num_entries;
     return Status::OK();
   }
 
   Status ExportValues(OpKernelContext* ctx) override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
+    // Exclude concurrent inserts, which only hold mu_ in shared mode.
+    mutex_lock l(mu_);
     Tensor key_buckets_tensor = *key_buckets_.AccessTensor(ctx);
     Tensor value_buckets_tensor = *value_buckets_.AccessTensor(ctx);
     TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_tensor));
@@ -564,9 +588,9 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
  private:
+  // Requires mu_, in shared mode at least.
   Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
-                  bool ignore_empty_and_deleted_key)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                  bool ignore_empty_and_deleted_key) {
     const int64 num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
     const int64 value_size = value_shape_.num_elements();
     const int64 key_size = key_shape_.num_elements();
@@ -582,27 +606,49 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_tensor =
         deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const int64 bit_mask = num_buckets_ - 1;
+
+    // Insert the keys grouped by the stripe of their first bucket, so that
+    // consecutive inserts mostly reuse the lock of the stripe.
+    std::vector<uint64> key_hashes(num_elements);
+    // The stripe of each key, or -1 for the keys that are skipped.
+    std::vector<int64> key_stripes(num_elements, -1);
+    std::vector<int64> stripe_offsets(kNumStripes + 1, 0);
     for (int64 i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
           IsEqualKey(empty_key_tensor, 0, key_matrix, i)) {
-        if (ignore_empty_and_deleted_key) {
-          continue;
+        if (!ignore_empty_and_deleted_key) {
+          return errors::InvalidArgument(
+              "Using the empty_key as a table key is not allowed");
         }
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_tensor, 0, key_matrix, i)) {
-        if (ignore_empty_and_deleted_key) {
-          continue;
+      } else if (deleted_key_hash_ == key_hash &&
+                 IsEqualKey(deleted_key_tensor, 0, key_matrix, i)) {
+        if (!ignore_empty_and_deleted_key) {
+          return errors::InvalidArgument(
+              "Using the deleted_key as a table key is not allowed");
         }
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
+      } else {
+        key_stripes[i] = (key_hash & bit_mask) >> stripe_shift_;
+        ++stripe_offsets[key_stripes[i] + 1];
       }
-      int64 bucket_index = key_hash & bit_mask;
+      key_hashes[i] = key_hash;
+    }
+    for (int64 i = 0; i < kNumStripes; ++i) {
+      stripe_offsets[i + 1] += stripe_offsets[i];
+    }
+    std::vector<int64> order(stripe_offsets[kNumStripes]);
+    for (int64 i = 0; i < num_elements; ++i) {
+      if (key_stripes[i] >= 0) {
+        order[stripe_offsets[key_stripes[i]]++] = i;
+      }
+    }
+
+    StripeLock stripe_lock(stripes_.get(), stripe_shift_, /*exclusive=*/true);
+    for (const int64 i : order) {
+      int64 bucket_index = key_hashes[i] & bit_mask;
       int64 num_probes = 0;
       while (true) {
+        stripe_lock.Acquire(bucket_index);
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           for (int64 j = 0; j < value_size; ++j) {
             value_buckets_matrix(bucket_index, j) =
@@ -636,8 +682,8 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status DoRemove(OpKernelContext* ctx, const Tensor& key)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // Requires mu_, in shared mode at least.
+  Status DoRemove(OpKernelContext* ctx, const Tensor& key) {
     const int64 num_elements = key.dim_size(0);
     const int64 key_size = key_shape_.num_elements();
     const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
@@ -651,6 +697,7 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_flat =
         deleted_key_.AccessTensor(ctx)->template flat<K>();
     const int64 bit_mask = num_buckets_ - 1;
+    StripeLock stripe_lock(stripes_.get(), stripe_shift_, /*exclusive=*/true);
     for (int64 i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -666,6 +713,7 @@ class MutableDenseHashTable final : public LookupInterface {
       int64 bucket_index = key_hash & bit_mask;
       int64 num_probes = 0;
       while (true) {
+        stripe_lock.Acquire(bucket_index);
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           --num_entries_;
           for (int64 j = 0; j < key_size; ++j) {
@@ -697,7 +745,7 @@ class MutableDenseHashTable final : public LookupInterface {
           "Number of buckets must be at least 4 and a power of 2, got: ",
           new_num_buckets);
     }
-    num_buckets_ = new_num_buckets;
+    SetNumBuckets(new_num_buckets);
     num_entries_ = 0;
 
     const int64 key_size = key_shape_.num_elements();
@@ -738,6 +786,57 @@ class MutableDenseHashTable final : public LookupInterface {
     return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
   }
 
+  void SetNumBuckets(int64 num_buckets) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    num_buckets_ = num_buckets;
+    stripe_shift_ = 0;
+    while ((num_buckets_ >> stripe_shift_) > kNumStripes) {
+      ++stripe_shift_;
+    }
+  }
+
+  // Holds the lock of at most one stripe at a time, in shared mode for lookups
+  // and in exclusive mode for updates. Probes that cross stripes release the
+  // previous stripe first, which keeps them free of deadlocks.
+  class StripeLock {
+   public:
+    StripeLock(mutex* stripes, int64 stripe_shift, bool exclusive)
+        : stripes_(stripes),
+          stripe_shift_(stripe_shift),
+          exclusive_(exclusive) {}
+    ~StripeLock() { Release(); }
+
+    // Locks the stripe of `bucket_index`.
+    void Acquire(int64 bucket_index) {
+      mutex* stripe = &stripes_[bucket_index >> stripe_shift_];
+      if (stripe == held_) return;
+      Release();
+      if (exclusive_) {
+        stripe->lock();
+      } else {
+        stripe->lock_shared();
+      }
+      held_ = stripe;
+    }
+
+   private:
+    void Release() {
+      if (held_ == nullptr) return;
+      if (exclusive_) {
+        held_->unlock();
+      } else {
+        held_->unlock_shared();
+      }
+      held_ = nullptr;
+    }
+
+    mutex* const stripes_;
+    const int64 stripe_shift_;
+    const bool exclusive_;
+    mutex* held_ = nullptr;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(StripeLock);
+  };
+
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64 index) const {
     if (key_shape_.num_elements() == 1) {
       return HashScalar(key(index, 0));
@@ -765,9 +864,17 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
+  static constexpr int64 kNumStripes = 64;
+
   mutable mutex mu_;
-  int64 num_entries_ TF_GUARDED_BY(mu_);
+  // Updated by concurrent inserts and removes, which hold mu_ in shared mode.
+  std::atomic<int64> num_entries_{0};
+  // Entries that inserts holding mu_ in shared mode may add.
+  std::atomic<int64> num_reserved_entries_{0};
   int64 num_buckets_ TF_GUARDED_BY(mu_);
+  // The stripe of a bucket is its index shifted right by stripe_shift_.
+  int64 stripe_shift_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<mutex[]> stripes_;
   PersistentTensor key_buckets_ TF_GUARDED_BY(mu_);
   PersistentTensor value_buckets_ TF_GUARDED_BY(mu_);
   PersistentTensor empty_key_;
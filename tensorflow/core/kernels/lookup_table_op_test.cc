@@ -0,0 +1,92 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+
+// Runs `num_finds` lookups and `num_inserts` inserts of `batch_size` keys
+// each, all concurrently, against a single MutableDenseHashTable.
+static Graph* DenseHashTableContention(int num_finds, int num_inserts,
+                                       int batch_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  constexpr int64 kNumKeys = 1 << 16;
+  constexpr int64 kEmptyKey = -1;
+  constexpr int64 kDeletedKey = -2;
+
+  Node* table;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("table"), "MutableDenseHashTableV2")
+          .Input(test::graph::Constant(g, test::AsScalar<int64>(kEmptyKey)))
+          .Input(test::graph::Constant(g, test::AsScalar<int64>(kDeletedKey)))
+          .Attr("key_dtype", DT_INT64)
+          .Attr("value_dtype", DT_FLOAT)
+          .Attr("initial_num_buckets", 4 * kNumKeys)
+          .Finalize(g, &table));
+
+  auto random_keys = [&]() {
+    Tensor keys(DT_INT64, TensorShape({batch_size}));
+    for (int i = 0; i < batch_size; ++i) {
+      keys.flat<int64>()(i) = random::New64() % kNumKeys;
+    }
+    return test::graph::Constant(g, keys);
+  };
+  Node* default_value = test::graph::Constant(g, test::AsScalar<float>(0));
+  for (int i = 0; i < num_finds; ++i) {
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g->NewName("find"), "LookupTableFindV2")
+                    .Input(table)
+                    .Input(random_keys())
+                    .Input(default_value)
+                    .Finalize(g, &node));
+  }
+  for (int i = 0; i < num_inserts; ++i) {
+    Tensor values(DT_FLOAT, TensorShape({batch_size}));
+    values.flat<float>().setRandom();
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g->NewName("insert"), "LookupTableInsertV2")
+                    .Input(table)
+                    .Input(random_keys())
+                    .Input(test::graph::Constant(g, values))
+                    .Finalize(g, &node));
+  }
+  return g;
+}
+
+#define BM_DenseHashTableContention(FINDS, INSERTS, BATCH)                  \
+  static void BM_DenseHashTableContention##_##FINDS##_##INSERTS##_##BATCH( \
+      int iters) {                                                          \
+    testing::ItemsProcessed(static_cast<int64>(iters) * (FINDS + INSERTS) * \
+                            BATCH);                                         \
+    test::Benchmark("cpu", DenseHashTableContention(FINDS, INSERTS, BATCH)) \
+        .Run(iters);                                                        \
+  }                                                                         \
+  BENCHMARK(BM_DenseHashTableContention##_##FINDS##_##INSERTS##_##BATCH);
+
+BM_DenseHashTableContention(16, 0, 1024);
+BM_DenseHashTableContention(64, 0, 1024);
+BM_DenseHashTableContention(16, 4, 1024);
+BM_DenseHashTableContention(64, 16, 1024);
+BM_DenseHashTableContention(64, 16, 64);
+BM_DenseHashTableContention(0, 16, 1024);
+
+}  // end namespace tensorflow
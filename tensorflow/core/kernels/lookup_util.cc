@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include "absl/strings/str_split.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -31,8 +33,50 @@ static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
 
+// Reads lines straight from the bytes of a file mapped in memory, like
+// io::InputBuffer::ReadLine: the trailing '\r' of a line is dropped, and the
+// last line may have no '\n'.
+class MappedLineReader {
+ public:
+  explicit MappedLineReader(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)),
+        data_(static_cast<const char*>(region_->data()), region_->length()) {}
+
+  Status ReadLine(StringPiece* line) {
+    if (pos_ >= data_.size()) {
+      return errors::OutOfRange("end of file reached");
+    }
+    size_t end = data_.find('\n', pos_);
+    if (end == StringPiece::npos) end = data_.size();
+    *line = data_.substr(pos_, end - pos_);
+    pos_ = end + 1;
+    if (!line->empty() && line->back() == '\r') line->remove_suffix(1);
+    return Status::OK();
+  }
+
+  int64 Tell() const { return std::min(pos_, data_.size()); }
+
+ private:
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  const StringPiece data_;
+  size_t pos_ = 0;
+};
+
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64* num_lines) {
+  if (MemmappedFileSystem::IsMemmappedPackageFilename(vocab_file)) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_RETURN_IF_ERROR(
+        env->NewReadOnlyMemoryRegionFromFile(vocab_file, &region));
+    MappedLineReader reader(std::move(region));
+    StringPiece line;
+    int64 next_id = 0;
+    while (reader.ReadLine(&line).ok()) {
+      next_id++;
+    }
+    *num_lines = next_id;
+    return Status::OK();
+  }
   std::unique_ptr<RandomAccessFile> file;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(vocab_file, &file));
 
@@ -57,6 +101,8 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
 //
 // What information of the line to populate the key or values is specified by
 // providing key_index and value_index.
+//
+// Files in a memmapped package are parsed straight from the mapped bytes.
 class TextFileLineIterator
     : public InitializableLookupTable::InitTableIterator {
  public:
@@ -87,10 +133,16 @@ class TextFileLineIterator
     value_index_ = value_index;
     env_ = env;
 
-    status_ = env->NewRandomAccessFile(filename_, &file_);
-    if (!status_.ok()) return status_;
-
-    input_buffer_.reset(new io::InputBuffer(file_.get(), kInputBufferSize));
+    if (MemmappedFileSystem::IsMemmappedPackageFilename(filename_)) {
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      status_ = env->NewReadOnlyMemoryRegionFromFile(filename_, &region);
+      if (!status_.ok()) return status_;
+      mapped_reader_.reset(new MappedLineReader(std::move(region)));
+    } else {
+      status_ = env->NewRandomAccessFile(filename_, &file_);
+      if (!status_.ok()) return status_;
+      input_buffer_.reset(new io::InputBuffer(file_.get(), kInputBufferSize));
+    }
     valid_ = true;
     next_id_ = 0;
     ignore_split_ = std::max(key_index_, value_index_) < 0;
@@ -101,8 +153,8 @@ class TextFileLineIterator
   void Next() override {
     if (!valid_) return;
 
-    string line;
-    status_ = input_buffer_->ReadLine(&line);
+    StringPiece line;
+    status_ = ReadLine(&line);
     if (!status_.ok()) {
       if (errors::IsOutOfRange(status_) && vocab_size_ != -1 &&
           next_id_ != vocab_size_) {
@@ -125,14 +177,14 @@ class TextFileLineIterator
     if (line.empty()) {
       status_ = errors::InvalidArgument("Invalid content in ", filename_,
                                         ": empty line found at position ",
-                                        input_buffer_->Tell(), ".");
+                                        Tell(), ".");
       valid_ = false;
       return;
     }
 
-    std::vector<string> tokens;
+    std::vector<StringPiece> tokens;
     if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
+      tokens = absl::StrSplit(line, delimiter_);
       if (static_cast<size_t>(std::max(key_index_, value_index_)) >=
           tokens.size()) {
         status_ = errors::InvalidArgument(
@@ -193,21 +245,34 @@ class TextFileLineIterator
   bool ignore_split_;
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
+  std::unique_ptr<MappedLineReader> mapped_reader_;
+  string line_buffer_;  // holds the lines read from input_buffer_
+
+  Status ReadLine(StringPiece* line) {
+    if (mapped_reader_) return mapped_reader_->ReadLine(line);
+    TF_RETURN_IF_ERROR(input_buffer_->ReadLine(&line_buffer_));
+    *line = line_buffer_;
+    return Status::OK();
+  }
+
+  int64 Tell() const {
+    return mapped_reader_ ? mapped_reader_->Tell() : input_buffer_->Tell();
+  }
 
   // Set the corresponding value from line or tokens based on 'index' into the
   // tensor 't'. The value is transformed to the given data type 'dtype'.
-  Status SetValue(const string& line, const std::vector<string>& tokens,
+  Status SetValue(StringPiece line, const std::vector<StringPiece>& tokens,
                   int64 index, Tensor* tensor) {
     if (index == kLineNumber) {
       tensor->flat<int64>()(0) = next_id_;
       return Status::OK();
     }
-    const string& token = (index == kWholeLine) ? line : tokens[index];
+    const StringPiece token = (index == kWholeLine) ? line : tokens[index];
     const DataType& dtype = tensor->dtype();
     switch (dtype) {
       case DT_INT32: {
         int32 value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
+        if (!strings::safe_strto32(token, &value)) {
           valid_ = false;
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid int32.");
@@ -216,7 +281,7 @@ class TextFileLineIterator
       } break;
       case DT_INT64: {
         int64 value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
+        if (!strings::safe_strto64(token, &value)) {
           valid_ = false;
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid int64.");
@@ -225,7 +290,7 @@ class TextFileLineIterator
       } break;
       case DT_FLOAT: {
         float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
+        if (!strings::safe_strtof(token, &value)) {
           valid_ = false;
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid float.");
@@ -234,7 +299,7 @@ class TextFileLineIterator
       } break;
       case DT_DOUBLE: {
         double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
+        if (!strings::safe_strtod(token, &value)) {
           valid_ = false;
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid double.");
@@ -242,7 +307,7 @@ class TextFileLineIterator
         tensor->flat<double>()(0) = value;
       } break;
       case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+        tensor->flat<tstring>()(0) = tstring(token.data(), token.size());
         break;
       default:
         valid_ = false;
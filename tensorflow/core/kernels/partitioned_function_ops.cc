@@ -230,16 +230,37 @@ Status PartitionedCallOp::Instantiate(FunctionLibraryRuntime* lib,
   return Status::OK();
 }
 
+ScopedStepContainer* PartitionedCallOp::GetStepContainer(
+    ResourceMgr* resource_mgr, int64 step_id) {
+  {
+    mutex_lock l(mu_);
+    auto it = free_step_containers_.find(resource_mgr);
+    if (it != free_step_containers_.end() && !it->second.empty()) {
+      ScopedStepContainer* step_container = it->second.back().release();
+      it->second.pop_back();
+      return step_container;
+    }
+  }
+  return new ScopedStepContainer(step_id, [resource_mgr](const string& name) {
+    resource_mgr->Cleanup(name).IgnoreError();
+  });
+}
+
+void PartitionedCallOp::ReleaseStepContainer(
+    ResourceMgr* resource_mgr, ScopedStepContainer* step_container) {
+  step_container->CleanUp();
+  mutex_lock l(mu_);
+  free_step_containers_[resource_mgr].emplace_back(step_container);
+}
+
 void PartitionedCallOp::RunFunction(FunctionLibraryRuntime::Handle handle,
                                     const std::vector<Tensor>& inputs,
                                     FunctionLibraryRuntime* lib,
                                     OpKernelContext* ctx, DoneCallback done) {
   FunctionLibraryRuntime::Options run_opts;
   ResourceMgr* resource_mgr = lib->device()->resource_manager();
-  ScopedStepContainer* step_container = new ScopedStepContainer(
-      run_opts.step_id, [resource_mgr](const string& name) {
-        resource_mgr->Cleanup(name).IgnoreError();
-      });
+  ScopedStepContainer* step_container =
+      GetStepContainer(resource_mgr, run_opts.step_id);
   run_opts.step_container = step_container;
   run_opts.cancellation_manager = ctx->cancellation_manager();
   run_opts.stats_collector = ctx->stats_collector();
@@ -259,7 +280,7 @@ void PartitionedCallOp::RunFunction(FunctionLibraryRuntime::Handle handle,
   const string& func_name = func_->name();
   profiler::TraceMe trace_me("PartitionedCallOp");
   lib->Run(run_opts, handle, inputs, rets,
-           [rets, done = std::move(done), ctx, func_name,
+           [this, rets, done = std::move(done), ctx, func_name, resource_mgr,
             step_container](const Status& status) {
              if (!status.ok()) {
                const string function_and_msg =
@@ -272,7 +293,7 @@ void PartitionedCallOp::RunFunction(FunctionLibraryRuntime::Handle handle,
                }
              }
              delete rets;
-             delete step_container;
+             ReleaseStepContainer(resource_mgr, step_container);
              done();
            });
 }
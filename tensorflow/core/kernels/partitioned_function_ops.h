@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_PARTITIONED_FUNCTION_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_PARTITIONED_FUNCTION_OPS_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
@@ -54,6 +58,13 @@ class PartitionedCallOp : public AsyncOpKernel {
                    FunctionLibraryRuntime* lib, OpKernelContext* ctx,
                    DoneCallback done);
 
+  // Returns a clean step container whose resources live in `resource_mgr`,
+  // reusing one released by an earlier call if possible.
+  ScopedStepContainer* GetStepContainer(ResourceMgr* resource_mgr,
+                                        int64 step_id);
+  void ReleaseStepContainer(ResourceMgr* resource_mgr,
+                            ScopedStepContainer* step_container);
+
   // Using unique pointers to avoid including proto headers in kernel headers
   std::unique_ptr<NameAttrList> func_;
   std::unique_ptr<ConfigProto> config_proto_;
@@ -66,6 +77,11 @@ class PartitionedCallOp : public AsyncOpKernel {
   // different FLRs.
   gtl::FlatMap<FunctionLibraryRuntime*, FunctionLibraryRuntime::Handle> handles_
       TF_GUARDED_BY(mu_);
+  // Step containers of finished calls, per resource manager. Each keeps the
+  // unique name it was created with, so a container is never shared by two
+  // running calls.
+  gtl::FlatMap<ResourceMgr*, std::vector<std::unique_ptr<ScopedStepContainer>>>
+      free_step_containers_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -37,8 +38,75 @@ namespace tensorflow {
 
 class QuantizedMatMulTest : public OpsTestBase {
  protected:
+  // Multiplies a 7x37 matrix by a 37x21 one, whose sizes are not multiples of
+  // the block sizes of any of the optimized paths, and compares the result
+  // with ReferenceGemm.
+  void RunAgainstReference(bool transpose_a, bool transpose_b) {
+    TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    const int m = 7;
+    const int k = 37;
+    const int n = 21;
+    const float a_min = -1.0f;
+    const float a_max = 1.0f;
+    const float b_min = -0.5f;
+    const float b_max = 2.0f;
+    std::vector<quint8> a_values(m * k);
+    for (int i = 0; i < m * k; ++i) {
+      a_values[i] = (i * 37 + 11) % 256;
+    }
+    std::vector<quint8> b_values(k * n);
+    for (int i = 0; i < k * n; ++i) {
+      b_values[i] = (i * 101 + 3) % 256;
+    }
+    AddInputFromArray<quint8>(transpose_a ? TensorShape({k, m})
+                                          : TensorShape({m, k}),
+                              a_values);
+    AddInputFromArray<quint8>(transpose_b ? TensorShape({n, k})
+                                          : TensorShape({k, n}),
+                              b_values);
+    AddInputFromArray<float>(TensorShape({1}), {a_min});
+    AddInputFromArray<float>(TensorShape({1}), {a_max});
+    AddInputFromArray<float>(TensorShape({1}), {b_min});
+    AddInputFromArray<float>(TensorShape({1}), {b_max});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(allocator(), DT_QINT32, TensorShape({m, n}));
+    ReferenceGemm<quint8, quint8, qint32>(
+        transpose_a, transpose_b, false, m, n, k, a_values.data(),
+        FloatToQuantizedUnclamped<quint8>(0.0f, a_min, a_max),
+        transpose_a ? m : k, b_values.data(),
+        FloatToQuantizedUnclamped<quint8>(0.0f, b_min, b_max),
+        transpose_b ? k : n, expected.flat<qint32>().data(), 0, 0, 1, n);
+    test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
+  }
 };
 
+TEST_F(QuantizedMatMulTest, OddSizes) { RunAgainstReference(false, false); }
+
+TEST_F(QuantizedMatMulTest, OddSizes_TransposeA) {
+  RunAgainstReference(true, false);
+}
+
+TEST_F(QuantizedMatMulTest, OddSizes_TransposeB) {
+  RunAgainstReference(false, true);
+}
+
+TEST_F(QuantizedMatMulTest, OddSizes_TransposeAB) {
+  RunAgainstReference(true, true);
+}
+
 // Runs two small matrices through the operator, and leaves all the parameters
 // at their default values.
 TEST_F(QuantizedMatMulTest, Small_NoParams) {
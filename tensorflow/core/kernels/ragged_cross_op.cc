@@ -364,11 +364,16 @@ class RaggedCrossOp : public OpKernel {
       output_writer->WriteOutputSlice(begin, end);
     };
 
-    // TODO(edloper): optimize cost_per_batch
-    const int cost_per_batch = 5000 * ragged_values_list.size();
+    // The cost of a row grows with the product of the number of values of
+    // each feature in that row, so measure it instead of estimating it.
     auto thread_pool =
         context->device()->tensorflow_cpu_worker_threads()->workers;
-    thread_pool->ParallelFor(batch_size, cost_per_batch, do_work);
+    thread_pool->ParallelFor(
+        batch_size,
+        thread::ThreadPool::SchedulingParams(
+            thread::ThreadPool::SchedulingStrategy::kMeasuredCost,
+            absl::nullopt /* cost_per_unit */, absl::nullopt /* block_size */),
+        do_work);
   }
 
  private:
@@ -394,6 +394,7 @@ class RandomBinomialOp : public OpKernel {
 
     core::RefCountPtr<Var> var;
     OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    OP_REQUIRES_OK(ctx, var->CheckWritable());
 
     Tensor* var_tensor = var->tensor();
     OP_REQUIRES(
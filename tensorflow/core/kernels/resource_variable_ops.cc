@@ -53,10 +53,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/resource_variable_ops.h"
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "absl/strings/str_join.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -73,6 +76,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/platform/casts.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -141,12 +145,15 @@ void ReadVariableOp::Compute(OpKernelContext* ctx) {
                   ". This could mean that the variable was uninitialized. ",
                   status.ToString()));
 
-  tf_shared_lock ml(*variable->mu());
   // We're acquiring a reference to the underlying buffer while
   // holding a shared lock to guarantee ordering of reads and
-  // writes when in copy-on-write mode.
+  // writes when in copy-on-write mode. Read-only variables have no
+  // writes to order with, and are aliased without contending on the lock.
+  const bool read_only = variable->read_only.load();
+  absl::optional<tf_shared_lock> ml;
+  if (!read_only) ml.emplace(*variable->mu());
   const Tensor* t = variable->tensor();
-  if (!variable->copy_on_read_mode.load()) {
+  if (read_only || !variable->copy_on_read_mode.load()) {
     OP_REQUIRES(
         ctx, dtype_ == t->dtype(),
         errors::InvalidArgument(
@@ -193,15 +200,17 @@ void ReadVariablesOp::Compute(OpKernelContext* ctx) {
   for (size_t i = 0; i < dtypes_.size(); ++i) {
     // We're acquiring a reference to the underlying buffer while
     // holding a shared lock to guarantee ordering of reads and
-    // writes.
-    tf_shared_lock ml(*variables[i]->mu());
+    // writes, unless the variable is read-only.
+    const bool read_only = variables[i]->read_only.load();
+    absl::optional<tf_shared_lock> ml;
+    if (!read_only) ml.emplace(*variables[i]->mu());
     OP_REQUIRES(ctx, dtypes_[i] == variables[i]->tensor()->dtype(),
                 errors::InvalidArgument(
                     "Trying to read variable ", handles[i]->name(),
                     " from Container: ", handles[i]->container(),
                     " with wrong dtype. Expected ", DataTypeString(dtypes_[i]),
                     " got ", DataTypeString(variables[i]->tensor()->dtype())));
-    if (variables[i]->copy_on_read_mode.load()) {
+    if (!read_only && variables[i]->copy_on_read_mode.load()) {
       OP_REQUIRES_OK(ctx, CopyVariable(i, ctx, variables[i]->tensor()));
     } else {
       const Tensor& t = *variables[i]->tensor();
@@ -301,9 +310,14 @@ class VariableShapeOp : public OpKernel {
     core::RefCountPtr<Var> variable;
     OP_REQUIRES_OK(ctx,
                    LookupResource(ctx, HandleFromInput(ctx, 0), &variable));
-    variable->mu()->lock_shared();
-    TensorShape shape = variable->tensor()->shape();
-    variable->mu()->unlock_shared();
+    TensorShape shape;
+    if (variable->read_only.load()) {
+      shape = variable->tensor()->shape();
+    } else {
+      variable->mu()->lock_shared();
+      shape = variable->tensor()->shape();
+      variable->mu()->unlock_shared();
+    }
     Tensor* output;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, {shape.dims()}, &output));
     for (int i = 0; i < shape.dims(); ++i) {
@@ -362,6 +376,7 @@ class AssignVariableOp : public OpKernel {
  public:
   explicit AssignVariableOp(OpKernelConstruction* c) : OpKernel(c) {
     OP_REQUIRES_OK(c, c->GetAttr("dtype", &dtype_));
+    OP_REQUIRES_OK(c, c->GetAttr("read_only", &read_only_));
     if (!c->GetAttr("_grappler_relax_allocator_constraints",
                     &relax_constraints_)
              .ok()) {
@@ -394,6 +409,7 @@ class AssignVariableOp : public OpKernel {
                                   return Status::OK();
                                 }));
     mutex_lock ml(*variable->mu());
+    OP_REQUIRES_OK(context, variable->CheckWritable());
     OP_REQUIRES(context, variable->tensor()->dtype() == dtype_,
                 errors::InvalidArgument(
                     "Trying to assign variable with wrong dtype. Expected ",
@@ -416,10 +432,13 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    // Set last, so that readers skipping the lock see the assigned tensor.
+    if (read_only_) variable->read_only.store(true);
   }
 
  private:
   DataType dtype_;
+  bool read_only_;
   bool relax_constraints_;
 };
 
@@ -431,6 +450,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
     OP_REQUIRES(c, dtype_ == DT_VARIANT,
                 errors::Internal("Variant kernel called with dtype: ",
                                  DataTypeString(dtype_)));
+    OP_REQUIRES_OK(c, c->GetAttr("read_only", &read_only_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -463,6 +483,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
         attr);
 
     mutex_lock ml(*variable->mu());
+    OP_REQUIRES_OK(context, variable->CheckWritable());
     OP_REQUIRES(context, variable->tensor()->dtype() == DT_VARIANT,
                 errors::InvalidArgument(
                     "Trying to assign variable with wrong dtype. Expected ",
@@ -473,6 +494,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
 
     if (input_alias) {
       *variable->tensor() = *input_alias;
+      if (read_only_) variable->read_only.store(true);
       return;
     }
 
@@ -494,6 +516,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
     for (int64 i = 0; i < elements_in.size(); ++i) {
       elements_out(i) = elements_in(i);
     }
+    if (read_only_) variable->read_only.store(true);
   }
 
  private:
@@ -540,6 +563,7 @@ class AssignUpdateVariableOp : public OpKernel {
     // PrepareToUpdateVariable() for commutative operations like Op ==
     // ADD if value's refcount was 1.
     mutex_lock ml(*variable->mu());
+    OP_REQUIRES_OK(context, variable->CheckWritable());
     Tensor* var_tensor = variable->tensor();
     OP_REQUIRES(context, var_tensor->shape().IsSameSize(value.shape()),
                 errors::InvalidArgument("Cannot update variable with shape ",
@@ -635,8 +659,10 @@ class ResourceGatherOp : public OpKernel {
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
     // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
-    tf_shared_lock ml(*v->mu());
+    // (potentially very large) tensor buffer. Read-only variables are
+    // never written, so they are gathered from without the lock.
+    absl::optional<tf_shared_lock> ml;
+    if (!v->read_only.load()) ml.emplace(*v->mu());
     const Tensor& params = *v->tensor();
     const Tensor& indices = c->input(1);
     OP_REQUIRES(
@@ -801,8 +827,10 @@ class ResourceGatherNdOp : public OpKernel {
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
     // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
-    tf_shared_lock ml(*v->mu());
+    // (potentially very large) tensor buffer. Read-only variables are
+    // never written, so they are gathered from without the lock.
+    absl::optional<tf_shared_lock> ml;
+    if (!v->read_only.load()) ml.emplace(*v->mu());
     const Tensor& params = *v->tensor();
     const Tensor& indices = c->input(1);
 
@@ -843,6 +871,96 @@ TF_CALL_GPU_NUMBER_TYPES(REGISTER_GATHER_ND_GPU);
 #undef REGISTER_GATHER_ND_ALL_INDICES
 #undef REGISTER_GATHER_ND_FULL
 
+// Aggregates the updates of a ResourceScatterUpdateOp before they are
+// applied.  Only addition and subtraction on CPU are aggregated.
+template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
+struct ScatterUpdatesAggregator {
+  static Status Run(OpKernelContext* c, Tensor* unique_indices,
+                    Tensor* summed, std::vector<Index>* positions,
+                    bool* aggregated) {
+    *aggregated = false;
+    return Status::OK();
+  }
+};
+
+template <typename T, typename Index>
+struct ScatterUpdatesAggregator<CPUDevice, T, Index,
+                                scatter_op::UpdateOp::ADD> {
+  // If `indices` has duplicates, sets `*unique_indices` to the distinct
+  // indices, `*summed` to the sum of the updates of each of them, and
+  // `*positions` to the position in `indices` of the first occurrence of
+  // each, and sets `*aggregated` to true.  Otherwise leaves the inputs to be
+  // applied as they are.
+  static Status Run(OpKernelContext* c, Tensor* unique_indices,
+                    Tensor* summed, std::vector<Index>* positions,
+                    bool* aggregated) {
+    *aggregated = false;
+    const Tensor& indices = c->input(1);
+    const Tensor& updates = c->input(2);
+    const int64 N = indices.NumElements();
+    if (N < 2 || N > std::numeric_limits<Index>::max() ||
+        TensorShapeUtils::IsScalar(updates.shape()) ||
+        updates.dims() < indices.dims() || updates.NumElements() % N != 0) {
+      return Status::OK();
+    }
+    const int64 row_size = updates.NumElements() / N;
+
+    auto indices_flat = indices.flat<Index>();
+    // Most batches have no duplicates.  Sorting a copy of the indices finds
+    // out without building the map below, which hashes every index.
+    {
+      std::vector<Index> sorted(indices_flat.data(),
+                                indices_flat.data() + N);
+      std::sort(sorted.begin(), sorted.end());
+      if (std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end()) {
+        return Status::OK();
+      }
+    }
+    gtl::FlatMap<Index, Index> slots(N);
+    std::vector<Index> slot_of(N);
+    positions->clear();
+    for (int64 i = 0; i < N; ++i) {
+      const Index next_slot = static_cast<Index>(positions->size());
+      auto it = slots.insert({indices_flat(i), next_slot}).first;
+      if (it->second == next_slot) positions->push_back(i);
+      slot_of[i] = it->second;
+    }
+    const int64 num_unique = positions->size();
+
+    TF_RETURN_IF_ERROR(c->allocate_temp(
+        indices.dtype(), TensorShape({num_unique}), unique_indices));
+    // Keep the trailing dimensions of `updates`, so that the shape checks in
+    // `DoCompute` accept the aggregated updates iff they accept the inputs.
+    TensorShape summed_shape({num_unique});
+    for (int d = indices.dims(); d < updates.dims(); ++d) {
+      summed_shape.AddDim(updates.dim_size(d));
+    }
+    TF_RETURN_IF_ERROR(
+        c->allocate_temp(DataTypeToEnum<T>::value, summed_shape, summed));
+    auto unique_flat = unique_indices->flat<Index>();
+    for (int64 s = 0; s < num_unique; ++s) {
+      unique_flat(s) = indices_flat((*positions)[s]);
+    }
+    const T* src = updates.flat<T>().data();
+    T* dst = summed->flat<T>().data();
+    std::fill(dst, dst + num_unique * row_size, T(0));
+    for (int64 i = 0; i < N; ++i) {
+      T* row = dst + slot_of[i] * row_size;
+      const T* update = src + i * row_size;
+      for (int64 j = 0; j < row_size; ++j) row[j] += update[j];
+    }
+    *aggregated = true;
+    return Status::OK();
+  }
+};
+
+// Subtracting the sum of the updates of an index is the same as subtracting
+// each of them.
+template <typename T, typename Index>
+struct ScatterUpdatesAggregator<CPUDevice, T, Index, scatter_op::UpdateOp::SUB>
+    : ScatterUpdatesAggregator<CPUDevice, T, Index,
+                               scatter_op::UpdateOp::ADD> {};
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ResourceScatterUpdateOp : public OpKernel {
  public:
@@ -858,29 +976,50 @@ class ResourceScatterUpdateOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    OP_REQUIRES_OK(c, v->CheckWritable());
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
-    const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
-                                  c->input_dtype(0) == DT_STRING ||
-                                  c->input_dtype(0) == DT_VARIANT;
+    // Input 0 is the handle, so the dtype that matters is that of the
+    // variable.
+    const DataType dtype = v->tensor()->dtype();
+    const bool is_non_pod_dtype = dtype == DT_RESOURCE ||
+                                  dtype == DT_STRING || dtype == DT_VARIANT;
     if (is_non_pod_dtype || use_exclusive_lock_) {
+      // Sum the updates of duplicate indices before taking the lock, so that
+      // the time spent holding it does not grow with the number of
+      // duplicates.
+      Tensor unique_indices;
+      Tensor summed_updates;
+      std::vector<Index> positions;
+      bool aggregated = false;
+      if (!is_non_pod_dtype) {
+        using Aggregator = ScatterUpdatesAggregator<Device, T, Index, op>;
+        OP_REQUIRES_OK(c, Aggregator::Run(c, &unique_indices, &summed_updates,
+                                          &positions, &aggregated));
+      }
       mutex_lock ml(*v->mu());
-      DoCompute(c);
+      if (aggregated) {
+        DoCompute(c, unique_indices, summed_updates, &positions);
+        return;
+      }
+      DoCompute(c, c->input(1), c->input(2), nullptr);
     } else {
       // For POD dtypes, we can safely run the update without the mutex.
       tf_shared_lock ml(*v->mu());
-      DoCompute(c);
+      DoCompute(c, c->input(1), c->input(2), nullptr);
     }
   }
 
  private:
   bool use_exclusive_lock_;
 
-  void DoCompute(OpKernelContext* c) {
+  // Applies `updates` at `indices`.  If `positions` is not null, `indices`
+  // and `updates` were aggregated by `ScatterUpdatesAggregator`, and
+  // `positions` maps them back to the op inputs for error messages.
+  void DoCompute(OpKernelContext* c, const Tensor& indices,
+                 const Tensor& updates, const std::vector<Index>* positions) {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
     Tensor* params = v->tensor();
-    const Tensor& indices = c->input(1);
-    const Tensor& updates = c->input(2);
 
     // Check that rank(updates.shape) = rank(indices.shape + params.shape[1:])
     OP_REQUIRES(c,
@@ -935,6 +1074,15 @@ class ResourceScatterUpdateOp : public OpKernel {
         functor::ScatterFunctor<Device, T, Index, op> functor;
         const Index bad_i = functor(c, c->template eigen_device<Device>(),
                                     params_flat, updates_flat, indices_flat);
+        if (bad_i >= 0 && positions != nullptr) {
+          const Tensor& input_indices = c->input(1);
+          const Index bad_pos = (*positions)[bad_i];
+          c->CtxFailure(errors::InvalidArgument(
+              "indices", SliceDebugString(input_indices.shape(), bad_pos),
+              " = ", indices_flat(bad_i), " is not in [0, ",
+              params->dim_size(0), ")"));
+          return;
+        }
         OP_REQUIRES(c, bad_i < 0,
                     errors::InvalidArgument(
                         "indices", SliceDebugString(indices.shape(), bad_i),
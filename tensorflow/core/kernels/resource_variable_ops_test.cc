@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class ResourceScatterOpTest : public OpsTestBase {
+ protected:
+  // Runs `op` with `use_locking` on a [4, 2] float variable that starts out
+  // as 1, ..., 8, and returns the status of the run.  The variable is left
+  // in `*result`.
+  Status RunScatter(const string& op, bool use_locking,
+                    const std::vector<int32>& indices,
+                    const std::vector<float>& updates, Tensor* result) {
+    TF_CHECK_OK(NodeDefBuilder("myop", op)
+                    .Input(FakeInput(DT_RESOURCE))
+                    .Input(FakeInput(DT_INT32))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Attr("use_locking", use_locking)
+                    .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    inputs_.clear();
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}, {4, 2});
+    var->is_initialized = true;
+    AddResourceInput("", strings::StrCat("var", num_runs_++), var);
+    const int64 num_indices = indices.size();
+    AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+    AddInputFromArray<float>(TensorShape({num_indices, 2}), updates);
+    Status s = RunOpKernel();
+    *result = *var->tensor();
+    return s;
+  }
+
+  // Checks that `op` gives the same variable with and without the lock, and
+  // that it matches `expected`.
+  void ExpectScatter(const string& op, const std::vector<int32>& indices,
+                     const std::vector<float>& updates,
+                     const std::vector<float>& expected) {
+    Tensor locked;
+    TF_ASSERT_OK(RunScatter(op, true, indices, updates, &locked));
+    Tensor unlocked;
+    TF_ASSERT_OK(RunScatter(op, false, indices, updates, &unlocked));
+    test::ExpectTensorEqual<float>(test::AsTensor<float>(expected, {4, 2}),
+                                   locked);
+    test::ExpectTensorEqual<float>(unlocked, locked);
+  }
+
+ private:
+  int num_runs_ = 0;
+};
+
+TEST_F(ResourceScatterOpTest, AddDistinctIndices) {
+  ExpectScatter("ResourceScatterAdd", {3, 0, 2}, {10, 20, 30, 40, 50, 60},
+                {31, 42, 3, 4, 55, 66, 17, 28});
+}
+
+TEST_F(ResourceScatterOpTest, AddDuplicateIndices) {
+  ExpectScatter("ResourceScatterAdd", {2, 0, 2, 2, 0},
+                {1, 2, 10, 20, 100, 200, 1000, 2000, 30, 40},
+                {41, 62, 3, 4, 1106, 2208, 7, 8});
+}
+
+TEST_F(ResourceScatterOpTest, SubDistinctIndices) {
+  ExpectScatter("ResourceScatterSub", {3, 0, 2}, {10, 20, 30, 40, 50, 60},
+                {-29, -38, 3, 4, -45, -54, -3, -12});
+}
+
+TEST_F(ResourceScatterOpTest, SubDuplicateIndices) {
+  ExpectScatter("ResourceScatterSub", {2, 0, 2, 2, 0},
+                {1, 2, 10, 20, 100, 200, 1000, 2000, 30, 40},
+                {-39, -58, 3, 4, -1096, -2196, 7, 8});
+}
+
+// Under the lock, the updates of an index are summed before they are added
+// to the variable.  With floats that can be told apart from adding them one
+// by one: 1 + 2^24 rounds to 2^24, so updating 1 with 2^24 and then -2^24
+// gives 0, while adding their sum gives 1.  2 + 2^24 is exact, so 2 stays
+// either way.
+TEST_F(ResourceScatterOpTest, AddSumsUpdatesOfDuplicateIndicesUnderLock) {
+  const float big = 1 << 24;
+  Tensor locked;
+  TF_ASSERT_OK(RunScatter("ResourceScatterAdd", true, {0, 0},
+                          {big, big, -big, -big}, &locked));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}, {4, 2}), locked);
+  Tensor unlocked;
+  TF_ASSERT_OK(RunScatter("ResourceScatterAdd", false, {0, 0},
+                          {big, big, -big, -big}, &unlocked));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 2, 3, 4, 5, 6, 7, 8}, {4, 2}), unlocked);
+}
+
+TEST_F(ResourceScatterOpTest, SubSumsUpdatesOfDuplicateIndicesUnderLock) {
+  const float big = 1 << 24;
+  Tensor locked;
+  TF_ASSERT_OK(RunScatter("ResourceScatterSub", true, {0, 0},
+                          {-big, -big, big, big}, &locked));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}, {4, 2}), locked);
+  Tensor unlocked;
+  TF_ASSERT_OK(RunScatter("ResourceScatterSub", false, {0, 0},
+                          {-big, -big, big, big}, &unlocked));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 2, 3, 4, 5, 6, 7, 8}, {4, 2}), unlocked);
+}
+
+TEST_F(ResourceScatterOpTest, DuplicateIndicesOutOfRange) {
+  Tensor result;
+  Status s = RunScatter("ResourceScatterAdd", true, {1, 1, 7, 1},
+                        {1, 1, 1, 1, 1, 1, 1, 1}, &result);
+  EXPECT_TRUE(
+      absl::StrContains(s.ToString(), "indices[2] = 7 is not in [0, 4)"))
+      << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
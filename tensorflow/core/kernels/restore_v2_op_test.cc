@@ -31,9 +31,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -356,5 +358,45 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
 
+TEST_F(RestoreV2OpTest, RestoreLargeTensorsFromSeveralThreads) {
+  // Enough bytes for each tensor to be read by a different thread.
+  const int kNumTensors = 3;
+  const int64 kNumElements = 4 << 20;
+  const string prefix =
+      io::JoinPath(testing::TmpDir(), "tensor_large_restore_v2");
+  {
+    BundleWriter writer(Env::Default(), prefix);
+    for (int t = 0; t < kNumTensors; ++t) {
+      Tensor tensor(DT_FLOAT, TensorShape({kNumElements}));
+      tensor.flat<float>().setConstant(t);
+      TF_ASSERT_OK(writer.Add(strings::StrCat("tensor_", t), tensor));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", DataTypeVector(kNumTensors, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  // The outputs follow the order of the names, not the sorted order in which
+  // they are read.
+  AddInputFromArray<tstring>(TensorShape({kNumTensors}),
+                             {"tensor_2", "tensor_0", "tensor_1"});
+  AddInputFromArray<tstring>(TensorShape({kNumTensors}), {"", "", ""});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const std::vector<float> expected = {2, 0, 1};
+  for (int i = 0; i < kNumTensors; ++i) {
+    const Tensor& output = *GetOutput(i);
+    ASSERT_EQ(kNumElements, output.NumElements());
+    EXPECT_EQ(expected[i], output.flat<float>()(0));
+    EXPECT_EQ(expected[i], output.flat<float>()(kNumElements - 1));
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
+#include <memory>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -234,38 +237,31 @@ void RestoreTensor(OpKernelContext* context,
 
 namespace {
 
-// Tensors larger than this threshold will be restored from a thread-pool.
-const int64 kLargeShapeThreshold = 16 << 20;  // 16M
+// Restores get one thread per this many bytes to read, since each thread
+// opens its own BundleReader.
+const int64 kBytesPerRestoreThread = 16 << 20;  // 16MB
+
+// The maximum number of threads a restore is spread over.
+const int kMaxRestoreThreads = 8;
+
+// Whether RestoreV2 shares the tensors equal to ones restored earlier in the
+// process, see BundleReader::LookupShared(). This only helps processes that
+// load many similar models, e.g. fine-tunes of one base model, at the cost of
+// comparing their tensors, so it is off by default.
+bool ShareRestoredTensors() {
+  static const bool share = [] {
+    bool share;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_RESTORE_SHARE_IDENTICAL_TENSORS",
+                                   /*default_val=*/false, &share));
+    return share;
+  }();
+  return share;
+}
 
-// A restore operation for a single tensor.  Small tensors may be restored
-// directly from the op thread to improve read locality.  Large tensors can be
-// restored from a thread pool: this requires creating a separate BundleReader
-// for each restore.
+// A restore operation for a single tensor.
 struct RestoreOp {
   RestoreOp& operator=(const RestoreOp&) = delete;
 
-  bool should_run_in_pool(BundleReader* reader) const {
-    TensorShape restored_full_shape;
-
-    // Ignore status here; we'll catch the error later.
-    if (!reader->LookupTensorShape(tensor_name, &restored_full_shape).ok()) {
-      return false;
-    }
-
-    return restored_full_shape.num_elements() > kLargeShapeThreshold;
-  }
-
-  // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
-    if (!reader.status().ok()) {
-      status = reader.status();
-      return;
-    }
-
-    status = run(&reader);
-  }
-
   Status run(BundleReader* reader) {
     TensorShape restored_full_shape;
     TF_RETURN_IF_ERROR(
@@ -274,7 +270,12 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && ShareRestoredTensors()) {
+      Tensor shared;
+      TF_RETURN_IF_ERROR(reader->LookupShared(tensor_name, &shared));
+      context->set_output(idx, shared);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -326,11 +327,17 @@ struct RestoreOp {
   size_t idx;
   string tensor_name;
   string shape_and_slice;
-  string reader_prefix;
-
-  ::tensorflow::Status status;
 };
 
+// Runs 'ops' in order with 'reader', stopping at the first error.
+Status RunRestoreOps(const std::vector<std::unique_ptr<RestoreOp>>& ops,
+                     size_t begin, size_t end, BundleReader* reader) {
+  for (size_t i = begin; i < end; ++i) {
+    TF_RETURN_IF_ERROR(ops[i]->run(reader));
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -350,12 +357,15 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
               return tensor_names_flat(a) < tensor_names_flat(b);
             });
 
-  std::vector<std::unique_ptr<RestoreOp> > pool_restore_ops;
-  std::vector<std::unique_ptr<RestoreOp> > direct_restore_ops;
-
-  BundleReader default_reader(Env::Default(), prefix_string);
+  // The env of the device also resolves the regions of a memmapped package,
+  // when the session uses a MemmappedEnv.
+  BundleReader default_reader(context->env(), prefix_string);
   TF_RETURN_IF_ERROR(default_reader.status());
 
+  // The estimated number of bytes to read for each tensor, in sorted order.
+  std::vector<int64> restore_bytes;
+  restore_bytes.reserve(sorted_name_idx.size());
+  int64 total_restore_bytes = 0;
   std::vector<string> mismatched_errors;
   for (const size_t i : sorted_name_idx) {
     TensorShape restored_full_shape;
@@ -363,6 +373,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     const string& tensor_name = tensor_names_flat(i);
     TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
         tensor_name, &original_dtype, &restored_full_shape));
+    restore_bytes.push_back(restored_full_shape.num_elements() *
+                            std::max(DataTypeSize(original_dtype), 1));
+    total_restore_bytes += restore_bytes.back();
     if (dtypes[i] != original_dtype) {
       string error_msg = strings::StrCat(
           "tensor_name = ", tensor_name, "; expected dtype ",
@@ -376,39 +389,60 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  std::vector<std::unique_ptr<RestoreOp>> restore_ops;
+  restore_ops.reserve(sorted_name_idx.size());
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
-    if (op->should_run_in_pool(&default_reader)) {
-      pool_restore_ops.emplace_back(op);
-    } else {
-      direct_restore_ops.emplace_back(op);
+    restore_ops.emplace_back(
+        new RestoreOp{context, i, tensor_name, shape_and_slice});
+  }
+
+  // Split the sorted tensors into contiguous ranges of about the same number
+  // of bytes, one per thread, so that every thread reads nearby data. The
+  // first range is read from the op thread.
+  const int num_threads = static_cast<int>(std::max<int64>(
+      1, std::min<int64>(kMaxRestoreThreads,
+                         total_restore_bytes / kBytesPerRestoreThread)));
+  std::vector<size_t> range_starts = {0};
+  int64 range_end_bytes = 0;
+  for (size_t i = 0; i < restore_ops.size(); ++i) {
+    const int64 num_ranges_started = range_starts.size();
+    if (i > 0 && num_ranges_started < num_threads &&
+        range_end_bytes >=
+            total_restore_bytes * num_ranges_started / num_threads) {
+      range_starts.push_back(i);
     }
+    range_end_bytes += restore_bytes[i];
   }
+  range_starts.push_back(restore_ops.size());
+  const int num_ranges = range_starts.size() - 1;
 
+  std::vector<Status> range_statuses(num_ranges);
   {
-    // Schedule any threaded operations first, skipping thread pool creation if
-    // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+    if (num_ranges > 1) {
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", num_ranges - 1));
+      for (int r = 1; r < num_ranges; ++r) {
+        reader_pool->Schedule([&, r]() {
+          BundleReader reader(context->env(), prefix_string);
+          range_statuses[r] = reader.status();
+          if (range_statuses[r].ok()) {
+            range_statuses[r] = RunRestoreOps(restore_ops, range_starts[r],
+                                              range_starts[r + 1], &reader);
+          }
+        });
       }
     }
-
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
-    }
+    range_statuses[0] = RunRestoreOps(restore_ops, range_starts[0],
+                                      range_starts[1], &default_reader);
   }
 
-  // Check status of pool ops; this must come after the pool shuts down.
-  for (auto& op : pool_restore_ops) {
-    TF_RETURN_IF_ERROR(op->status);
+  // Check the status of every range; this must come after the pool shuts
+  // down.
+  for (const Status& status : range_statuses) {
+    TF_RETURN_IF_ERROR(status);
   }
 
   for (auto i : sorted_name_idx) {
@@ -15,6 +15,7 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -37,6 +38,11 @@ namespace tensorflow {
 
 namespace {
 
+// SaveV2 writes a data file per this many bytes of tensors, in parallel, and
+// at most kMaxSaveShards of them.
+constexpr int64 kBytesPerSaveShard = 16 << 20;
+constexpr int kMaxSaveShards = 8;
+
 // Shared validations of the inputs to the SaveV2 and RestoreV2 ops.
 void ValidateInputs(bool is_save_op, OpKernelContext* context,
                     const Tensor& prefix, const Tensor& tensor_names,
@@ -105,7 +111,14 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    int64 total_bytes = 0;
+    for (int i = 0; i < num_tensors; ++i) {
+      total_bytes += context->input(i + kFixedInputs).TotalBytes();
+    }
+    BundleWriter::Options options;
+    options.num_shards = static_cast<int>(std::min<int64>(
+        kMaxSaveShards, std::max<int64>(1, total_bytes / kBytesPerSaveShard)));
+    BundleWriter writer(Env::Default(), prefix_string, options);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
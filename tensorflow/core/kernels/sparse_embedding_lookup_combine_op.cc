@@ -0,0 +1,322 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Fused embedding_lookup_sparse: gathers the rows of the embedding table for
+// the ids of every segment and combines them in a single pass, without
+// materializing the gathered rows.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtN };
+
+Status GetCombiner(OpKernelConstruction* context, Combiner* combiner) {
+  string name;
+  TF_RETURN_IF_ERROR(context->GetAttr("combiner", &name));
+  if (name == "sum") {
+    *combiner = Combiner::kSum;
+  } else if (name == "mean") {
+    *combiner = Combiner::kMean;
+  } else if (name == "sqrtn") {
+    *combiner = Combiner::kSqrtN;
+  } else {
+    return errors::InvalidArgument("Unsupported combiner ", name);
+  }
+  return Status::OK();
+}
+
+// Returns the factor the sum of the `num_ids` rows of a segment is scaled by.
+template <typename T>
+T CombinerScale(Combiner combiner, int64 num_ids) {
+  if (num_ids == 0 || combiner == Combiner::kSum) {
+    return T(1);
+  }
+  if (combiner == Combiner::kMean) {
+    return T(1) / static_cast<T>(num_ids);
+  }
+  return T(1) / std::sqrt(static_cast<T>(num_ids));
+}
+
+// Checks that `segment_ids` is sorted and in [0, num_segments), and returns
+// the index of the first id of every segment in `offsets`, followed by the
+// number of ids.
+template <typename SegmentId>
+Status GetSegmentOffsets(const Tensor& segment_ids, int64 num_segments,
+                         std::vector<int64>* offsets) {
+  const auto segment_ids_flat = segment_ids.flat<SegmentId>();
+  offsets->assign(num_segments + 1, 0);
+  SegmentId previous = 0;
+  for (int64 i = 0; i < segment_ids_flat.size(); ++i) {
+    const SegmentId segment = internal::SubtleMustCopy(segment_ids_flat(i));
+    if (segment < previous) {
+      return errors::InvalidArgument("segment ids are not increasing");
+    }
+    if (segment >= num_segments) {
+      return errors::InvalidArgument("Segment id ", segment,
+                                     " out of range [0, ", num_segments, ")");
+    }
+    ++(*offsets)[segment + 1];
+    previous = segment;
+  }
+  for (int64 s = 0; s < num_segments; ++s) {
+    (*offsets)[s + 1] += (*offsets)[s];
+  }
+  return Status::OK();
+}
+
+template <typename T>
+using Row = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+template <typename T>
+using ConstRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+}  // namespace
+
+template <typename T, typename Index, typename SegmentId>
+class SparseEmbeddingLookupCombineOp : public OpKernel {
+ public:
+  explicit SparseEmbeddingLookupCombineOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& num_segments_t = context->input(3);
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+                errors::InvalidArgument("params must be at least 1-D, got ",
+                                        params.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(context, ids.shape() == segment_ids.shape(),
+                errors::InvalidArgument(
+                    "ids and segment_ids should have the same shape, got ",
+                    ids.shape().DebugString(), " and ",
+                    segment_ids.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(num_segments_t.shape()),
+                errors::InvalidArgument("num_segments must be a scalar, got ",
+                                        num_segments_t.shape().DebugString()));
+    const int64 num_segments = num_segments_t.dtype() == DT_INT32
+                                   ? num_segments_t.scalar<int32>()()
+                                   : num_segments_t.scalar<int64>()();
+    OP_REQUIRES(context, num_segments >= 0,
+                errors::InvalidArgument("num_segments must be >= 0, got ",
+                                        num_segments));
+    std::vector<int64> offsets;
+    OP_REQUIRES_OK(context, GetSegmentOffsets<SegmentId>(
+                                segment_ids, num_segments, &offsets));
+
+    const auto ids_flat = ids.flat<Index>();
+    const int64 vocab_size = params.dim_size(0);
+    for (int64 i = 0; i < ids_flat.size(); ++i) {
+      const Index id = internal::SubtleMustCopy(ids_flat(i));
+      OP_REQUIRES(context, FastBoundsCheck(id, vocab_size),
+                  errors::InvalidArgument("ids[", i, "] = ", id,
+                                          " is not in [0, ", vocab_size, ")"));
+    }
+
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_segments);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) {
+      return;
+    }
+    const int64 dim = output->NumElements() / num_segments;
+    const T* params_data = params.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+
+    // Every shard accumulates whole segments, so the rows are summed with
+    // vectorized Eigen arrays rather than one element at a time.
+    auto combine = [&](int64 start, int64 limit) {
+      for (int64 s = start; s < limit; ++s) {
+        Row<T> out(output_data + s * dim, dim);
+        out.setZero();
+        for (int64 i = offsets[s]; i < offsets[s + 1]; ++i) {
+          out += ConstRow<T>(params_data + ids_flat(i) * dim, dim);
+        }
+        const int64 num_ids = offsets[s + 1] - offsets[s];
+        if (num_ids > 1 && combiner_ != Combiner::kSum) {
+          out *= CombinerScale<T>(combiner_, num_ids);
+        }
+      }
+    };
+    const int64 ids_per_segment =
+        std::max<int64>(1, ids_flat.size() / num_segments);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          /*cost_per_unit=*/ids_per_segment * dim, combine);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+// Gradient of SparseEmbeddingLookupCombine with respect to params, as
+// IndexedSlices with one row per distinct id.
+template <typename T, typename Index, typename SegmentId>
+class SparseEmbeddingLookupCombineGradOp : public OpKernel {
+ public:
+  explicit SparseEmbeddingLookupCombineGradOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& grad = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(grad.shape()),
+                errors::InvalidArgument("grad must be at least 1-D, got ",
+                                        grad.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(context, ids.shape() == segment_ids.shape(),
+                errors::InvalidArgument(
+                    "ids and segment_ids should have the same shape, got ",
+                    ids.shape().DebugString(), " and ",
+                    segment_ids.shape().DebugString()));
+    const int64 num_segments = grad.dim_size(0);
+    std::vector<int64> offsets;
+    OP_REQUIRES_OK(context, GetSegmentOffsets<SegmentId>(
+                                segment_ids, num_segments, &offsets));
+
+    // Deduplicate the ids, numbering them in order of first appearance.
+    const auto ids_flat = ids.flat<Index>();
+    const int64 num_ids = ids_flat.size();
+    absl::flat_hash_map<Index, int64> unique_index;
+    std::vector<Index> unique_ids;
+    std::vector<int64> id_to_unique(num_ids);
+    for (int64 i = 0; i < num_ids; ++i) {
+      const Index id = internal::SubtleMustCopy(ids_flat(i));
+      const int64 next_index = unique_ids.size();
+      auto it = unique_index.emplace(id, next_index).first;
+      if (it->second == next_index) {
+        unique_ids.push_back(id);
+      }
+      id_to_unique[i] = it->second;
+    }
+    const int64 num_unique = unique_ids.size();
+
+    TensorShape values_shape = grad.shape();
+    values_shape.set_dim(0, num_unique);
+    Tensor* values = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, values_shape, &values));
+    Tensor* indices = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({num_unique}), &indices));
+    std::copy(unique_ids.begin(), unique_ids.end(),
+              indices->flat<Index>().data());
+    if (values->NumElements() == 0) {
+      return;
+    }
+
+    // Group the positions of the ids by distinct id, so that every row of
+    // values is accumulated by a single shard.
+    std::vector<int64> unique_offsets(num_unique + 1, 0);
+    for (int64 i = 0; i < num_ids; ++i) {
+      ++unique_offsets[id_to_unique[i] + 1];
+    }
+    for (int64 u = 0; u < num_unique; ++u) {
+      unique_offsets[u + 1] += unique_offsets[u];
+    }
+    std::vector<int64> segments(num_ids);
+    {
+      std::vector<int64> next(unique_offsets.begin(), unique_offsets.end() - 1);
+      for (int64 s = 0; s < num_segments; ++s) {
+        for (int64 i = offsets[s]; i < offsets[s + 1]; ++i) {
+          segments[next[id_to_unique[i]]++] = s;
+        }
+      }
+    }
+    std::vector<T> scales(num_segments);
+    for (int64 s = 0; s < num_segments; ++s) {
+      scales[s] = CombinerScale<T>(combiner_, offsets[s + 1] - offsets[s]);
+    }
+
+    const int64 dim = values->NumElements() / num_unique;
+    const T* grad_data = grad.flat<T>().data();
+    T* values_data = values->flat<T>().data();
+    auto accumulate = [&](int64 start, int64 limit) {
+      for (int64 u = start; u < limit; ++u) {
+        Row<T> out(values_data + u * dim, dim);
+        out.setZero();
+        for (int64 i = unique_offsets[u]; i < unique_offsets[u + 1]; ++i) {
+          const int64 s = segments[i];
+          out += scales[s] * ConstRow<T>(grad_data + s * dim, dim);
+        }
+      }
+    };
+    const int64 ids_per_unique = std::max<int64>(1, num_ids / num_unique);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_unique,
+          /*cost_per_unit=*/ids_per_unique * dim * 2, accumulate);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+#define REGISTER_CPU_KERNELS_WITH_INDICES(type, index_type, segment_ids_type) \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SparseEmbeddingLookupCombine")                                    \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      SparseEmbeddingLookupCombineOp<type, index_type, segment_ids_type>);    \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SparseEmbeddingLookupCombineGrad")                                \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      SparseEmbeddingLookupCombineGradOp<type, index_type, segment_ids_type>);
+
+#define REGISTER_CPU_KERNELS(type)                        \
+  REGISTER_CPU_KERNELS_WITH_INDICES(type, int32, int32); \
+  REGISTER_CPU_KERNELS_WITH_INDICES(type, int32, int64); \
+  REGISTER_CPU_KERNELS_WITH_INDICES(type, int64, int32); \
+  REGISTER_CPU_KERNELS_WITH_INDICES(type, int64, int64);
+
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_CPU_KERNELS_WITH_INDICES
+
+}  // namespace tensorflow
@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class SparseEmbeddingLookupCombineOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op, const string& combiner) {
+    NodeDefBuilder builder("op", op);
+    builder.Input(FakeInput(DT_FLOAT))
+        .Input(FakeInput(DT_INT32))
+        .Input(FakeInput(DT_INT32));
+    if (op == "SparseEmbeddingLookupCombine") {
+      builder.Input(FakeInput(DT_INT32));
+    }
+    TF_ASSERT_OK(builder.Attr("combiner", combiner).Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+  }
+};
+
+TEST_F(SparseEmbeddingLookupCombineOpTest, Combiners) {
+  const float kSqrt2 = std::sqrt(2.0f);
+  const std::vector<std::pair<string, std::vector<float>>> cases = {
+      {"sum", {6, 8, 0, 0, 4, 5}},
+      {"mean", {3, 4, 0, 0, 4, 5}},
+      {"sqrtn", {6 / kSqrt2, 8 / kSqrt2, 0, 0, 4, 5}}};
+  for (const auto& c : cases) {
+    MakeOp("SparseEmbeddingLookupCombine", c.first);
+    AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 2, 3, 4, 5});
+    AddInputFromArray<int32>(TensorShape({3}), {1, 2, 2});
+    AddInputFromArray<int32>(TensorShape({3}), {0, 0, 2});
+    AddInputFromArray<int32>(TensorShape({}), {3});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+    test::FillValues<float>(&expected, c.second);
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+  }
+}
+
+TEST_F(SparseEmbeddingLookupCombineOpTest, InvalidIds) {
+  MakeOp("SparseEmbeddingLookupCombine", "sum");
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 3});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  AddInputFromArray<int32>(TensorShape({}), {1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+
+  MakeOp("SparseEmbeddingLookupCombine", "sum");
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(SparseEmbeddingLookupCombineOpTest, GradientIsDeduplicated) {
+  // Id 2 appears in both segments, once in each.
+  MakeOp("SparseEmbeddingLookupCombineGrad", "mean");
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 4, 1, 3});
+  AddInputFromArray<int32>(TensorShape({3}), {2, 0, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_values(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected_values, {2, 5, 1, 2});
+  test::ExpectTensorNear<float>(expected_values, *GetOutput(0), 1e-6);
+  Tensor expected_ids(allocator(), DT_INT32, TensorShape({2}));
+  test::FillValues<int32>(&expected_ids, {2, 0});
+  test::ExpectTensorEqual<int32>(expected_ids, *GetOutput(1));
+}
+
+// Looks up `ids_per_row` random ids of a [vocab_size, dim] table for every
+// row of a batch.
+static Graph* SparseEmbeddingLookup(bool fused, int batch_size,
+                                    int ids_per_row, int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  constexpr int kVocabSize = 100000;
+  Tensor params(DT_FLOAT, TensorShape({kVocabSize, dim}));
+  params.flat<float>().setRandom();
+  const int num_ids = batch_size * ids_per_row;
+  Tensor ids(DT_INT32, TensorShape({num_ids}));
+  Tensor segment_ids(DT_INT32, TensorShape({num_ids}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_ids; ++i) {
+    ids.flat<int32>()(i) = rnd.Uniform(kVocabSize);
+    segment_ids.flat<int32>()(i) = i / ids_per_row;
+  }
+  Node* node;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), fused ? "SparseEmbeddingLookupCombine"
+                                         : "SparseSegmentMeanWithNumSegments")
+          .Input(test::graph::Constant(g, params))
+          .Input(test::graph::Constant(g, ids))
+          .Input(test::graph::Constant(g, segment_ids))
+          .Input(test::graph::Constant(g, test::AsScalar<int32>(batch_size)))
+          .Finalize(g, &node));
+  return g;
+}
+
+#define BM_SparseEmbeddingLookup(FUSED, BATCH, IDS, DIM)                     \
+  static void BM_SparseEmbeddingLookup_##FUSED##_##BATCH##_##IDS##_##DIM(    \
+      int iters) {                                                           \
+    testing::ItemsProcessed(static_cast<int64>(iters) * BATCH * IDS * DIM);  \
+    test::Benchmark("cpu", SparseEmbeddingLookup(FUSED, BATCH, IDS, DIM))    \
+        .Run(iters);                                                         \
+  }                                                                          \
+  BENCHMARK(BM_SparseEmbeddingLookup_##FUSED##_##BATCH##_##IDS##_##DIM);
+
+BM_SparseEmbeddingLookup(false, 512, 20, 64);
+BM_SparseEmbeddingLookup(true, 512, 20, 64);
+BM_SparseEmbeddingLookup(false, 4096, 5, 16);
+BM_SparseEmbeddingLookup(true, 4096, 5, 16);
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,17 +19,125 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+Status KOutOfBoundsError(int64 k, std::size_t i, int rhs_index_a,
+                         std::size_t lhs_right) {
+  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
+                                 "] out of bounds (>=", lhs_right, ")");
+}
+
+Status MOutOfBoundsError(int64 m, std::size_t i, int lhs_index_a,
+                         int64 out_dim0) {
+  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
+                                 "] out of bounds (>=", out_dim0, ")");
+}
+
+// The entries of the sparse operand op(A) of a product, sorted by row: the
+// entries of row m are [row_starts[m], row_starts[m + 1]) in `cols`, their
+// column in op(A), and in `entries`, their position in a_values.
+template <typename Tindices>
+struct CsrIndices {
+  // The a_indices the structure was built from. Holding it keeps its buffer
+  // from being reused for other indices while the structure is cached.
+  Tensor a_indices;
+  int64 num_rows = 0;
+  int64 num_cols = 0;
+  std::vector<int64> row_starts;
+  std::vector<Tindices> cols;
+  std::vector<int64> entries;
+};
+
+// Sorts the entries of `a_indices` by row of op(A) with a counting sort.
+template <typename Tindices>
+Status BuildCsrIndices(const Tensor& a_indices, bool adjoint_a, int64 num_rows,
+                       int64 num_cols, CsrIndices<Tindices>* csr) {
+  const auto indices = a_indices.matrix<Tindices>();
+  const int64 nnz = indices.dimension(0);
+  const int row_index = adjoint_a ? 1 : 0;
+  const int col_index = adjoint_a ? 0 : 1;
+  // The indices are copied once, so that they are sorted as they were checked.
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> cols(nnz);
+  csr->row_starts.assign(num_rows + 1, 0);
+  for (int64 i = 0; i < nnz; ++i) {
+    rows[i] = internal::SubtleMustCopy(indices(i, row_index));
+    cols[i] = internal::SubtleMustCopy(indices(i, col_index));
+    if (!FastBoundsCheck(cols[i], num_cols)) {
+      return KOutOfBoundsError(cols[i], i, col_index, num_cols);
+    }
+    if (!FastBoundsCheck(rows[i], num_rows)) {
+      return MOutOfBoundsError(rows[i], i, row_index, num_rows);
+    }
+    ++csr->row_starts[rows[i] + 1];
+  }
+  std::partial_sum(csr->row_starts.begin(), csr->row_starts.end(),
+                   csr->row_starts.begin());
+  std::vector<int64> next(csr->row_starts.begin(), csr->row_starts.end() - 1);
+  csr->cols.resize(nnz);
+  csr->entries.resize(nnz);
+  for (int64 i = 0; i < nnz; ++i) {
+    const int64 position = next[rows[i]]++;
+    csr->cols[position] = cols[i];
+    csr->entries[position] = i;
+  }
+  csr->a_indices = a_indices;
+  csr->num_rows = num_rows;
+  csr->num_cols = num_cols;
+  return Status::OK();
+}
+
+// Computes out = op(A) * op(B) in parallel over the rows of `out`, given the
+// rows of op(A) in `csr` and op(B) as a row-major [csr.num_cols, n] matrix.
+template <typename T, typename Tindices>
+void CsrMatMul(OpKernelContext* ctx, const CsrIndices<Tindices>& csr,
+               bool adjoint_a, typename TTypes<T>::ConstVec a_values,
+               const T* b_rows, int64 n, typename TTypes<T>::Matrix out) {
+  const int64 nnz = csr.entries.size();
+  const int64 cost_per_row =
+      (1 + nnz / std::max<int64>(1, csr.num_rows)) * n * 2;
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, csr.num_rows,
+        cost_per_row, [&](int64 start, int64 limit) {
+          for (int64 m = start; m < limit; ++m) {
+            // Each output row stays in cache while the rows of op(B) it
+            // depends on are accumulated into it.
+            T* out_row = &out(m, 0);
+            std::fill(out_row, out_row + n, T(0));
+            for (int64 e = csr.row_starts[m]; e < csr.row_starts[m + 1]; ++e) {
+              const T a_value = a_values(csr.entries[e]);
+              const T a_scale = adjoint_a ? functor::MaybeConj(a_value)
+                                          : a_value;
+              const T* b_row = b_rows + csr.cols[e] * n;
+              for (int64 j = 0; j < n; ++j) {
+                out_row[j] += a_scale * b_row[j];
+              }
+            }
+          }
+        });
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tindices>
 class SparseTensorDenseMatMulOp : public OpKernel {
  public:
@@ -133,14 +241,22 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       return;
     }
 
-#define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                        \
-  if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                        \
-    Status functor_status = functor::SparseTensorDenseMatMulFunctor<       \
-        Device, T, Tindices, ADJ_A,                                        \
-        ADJ_B>::Compute(ctx->eigen_device<Device>(), out->matrix<T>(),     \
-                        a_indices->matrix<Tindices>(), a_values->vec<T>(), \
-                        b->matrix<T>());                                   \
-    OP_REQUIRES_OK(ctx, functor_status);                                   \
+    MatMul(ctx, ctx->eigen_device<Device>(), *a_indices, *a_values, *b, out);
+  }
+
+ private:
+  // Multiplies with the functor of the device.
+  template <typename D>
+  void MatMul(OpKernelContext* ctx, const D& d, const Tensor& a_indices,
+              const Tensor& a_values, const Tensor& b, Tensor* out) {
+#define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                           \
+  if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                           \
+    Status functor_status = functor::SparseTensorDenseMatMulFunctor<          \
+        D, T, Tindices, ADJ_A, ADJ_B>::Compute(d, out->matrix<T>(),           \
+                                              a_indices.matrix<Tindices>(),   \
+                                              a_values.vec<T>(),              \
+                                              b.matrix<T>());                 \
+    OP_REQUIRES_OK(ctx, functor_status);                                      \
   }
 
     MAYBE_ADJOINT(false, false);
@@ -151,9 +267,54 @@ class SparseTensorDenseMatMulOp : public OpKernel {
 #undef MAYBE_ADJOINT
   }
 
- private:
+  // Multiplies row by row with the CSR form of A. Converting A is skipped
+  // while the op is given the same a_indices buffer, like a constant
+  // adjacency matrix multiplied at every step.
+  void MatMul(OpKernelContext* ctx, const CPUDevice& d,
+              const Tensor& a_indices, const Tensor& a_values, const Tensor& b,
+              Tensor* out) {
+    const int64 num_rows = out->dim_size(0);
+    const int64 num_cols = adjoint_b_ ? b.dim_size(1) : b.dim_size(0);
+    std::shared_ptr<const CsrIndices<Tindices>> csr;
+    {
+      mutex_lock l(mu_);
+      csr = csr_;
+    }
+    if (csr == nullptr ||
+        csr->a_indices.tensor_data().data() !=
+            a_indices.tensor_data().data() ||
+        csr->a_indices.shape() != a_indices.shape() ||
+        csr->num_rows != num_rows || csr->num_cols != num_cols) {
+      auto new_csr = std::make_shared<CsrIndices<Tindices>>();
+      OP_REQUIRES_OK(ctx, BuildCsrIndices(a_indices, adjoint_a_, num_rows,
+                                          num_cols, new_csr.get()));
+      csr = std::move(new_csr);
+      mutex_lock l(mu_);
+      csr_ = csr;
+    }
+
+    const int64 n = out->dim_size(1);
+    const T* b_rows = b.flat<T>().data();
+    Tensor b_adjoint;
+    if (adjoint_b_) {
+      // The rows of op(B) are made contiguous once.
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                             TensorShape({num_cols, n}),
+                                             &b_adjoint));
+      Eigen::array<int, 2> shuffle(1, 0);
+      b_adjoint.matrix<T>().device(d) =
+          b.matrix<T>().shuffle(shuffle).conjugate();
+      b_rows = b_adjoint.flat<T>().data();
+    }
+    CsrMatMul<T, Tindices>(ctx, *csr, adjoint_a_, a_values.vec<T>(), b_rows, n,
+                           out->matrix<T>());
+  }
+
   bool adjoint_a_;
   bool adjoint_b_;
+  mutex mu_;
+  // The structure of the last A multiplied on CPU.
+  std::shared_ptr<const CsrIndices<Tindices>> csr_ TF_GUARDED_BY(mu_);
 };
 
 #define REGISTER_CPU(TypeT, TypeIndex)           \
@@ -225,97 +386,4 @@ REGISTER_KERNELS_GPU(float);
 #undef REGISTER_KERNELS_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-namespace functor {
-
-namespace {
-Status KOutOfBoundsError(int64 k, std::size_t i, int rhs_index_a,
-                         std::size_t lhs_right) {
-  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
-                                 "] out of bounds (>=", lhs_right, ")");
-}
-
-Status MOutOfBoundsError(int64 m, std::size_t i, int lhs_index_a,
-                         int64 out_dim0) {
-  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
-                                 "] out of bounds (>=", out_dim0, ")");
-}
-}  // namespace
-
-template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
-struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
-  // Vectorize certain operations above this size.
-  static constexpr std::size_t kNumVectorize = 32;
-
-  static Status Compute(const CPUDevice& d, typename TTypes<T>::Matrix out,
-                        typename TTypes<Tindices>::ConstMatrix a_indices,
-                        typename TTypes<T>::ConstVec a_values,
-                        typename TTypes<T>::ConstMatrix b) {
-    const std::size_t nnz = a_values.size();
-    const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
-    const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
-    const int lhs_index_a = ADJ_A ? 1 : 0;
-    const int rhs_index_a = ADJ_A ? 0 : 1;
-
-    out.setZero();
-
-    // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-    // approach that achieves the performance of the single threaded
-    // one.  Perhaps Eigen threadpool implementation is just too slow?
-
-    if (rhs_right < kNumVectorize) {
-      // Disable vectorization if the RHS of output is too small
-      auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
-
-      for (std::size_t i = 0; i < nnz; ++i) {
-        const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-        const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-        if (!FastBoundsCheck(k, lhs_right)) {
-          return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-        }
-        if (!FastBoundsCheck(m, out.dimension(0))) {
-          return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-        }
-        const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-        for (std::size_t n = 0; n < rhs_right; ++n) {
-          const T b_value = maybe_adjoint_b(k, n);
-          out(m, n) += a_value * b_value;
-        }
-      }
-    } else {
-      // Vectorization via Eigen.
-      const int b_chip_index = ADJ_B ? 1 : 0;
-
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
-    }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k) * a_value;                  \
-  }
-
-      if (ADJ_B) {
-        // Perform transpose and conjugation on B once, since we chip out B's
-        // columns in the nnz loop.
-        Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
-        Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
-            b.swap_layout().shuffle(shuffle).conjugate();
-        LOOP_NNZ(col_major_conj_b);
-      } else {
-        LOOP_NNZ(b);
-      }
-#undef LOOP_NNZ
-    }
-    return Status::OK();
-  }
-};
-
-}  // namespace functor
-
 }  // namespace tensorflow
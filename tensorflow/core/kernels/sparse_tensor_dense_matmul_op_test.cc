@@ -15,14 +15,91 @@ limitations under the License.
 
 #include <random>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class SparseTensorDenseMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool adjoint_a, bool adjoint_b) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "SparseTensorDenseMatMul")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("adjoint_a", adjoint_a)
+                     .Attr("adjoint_b", adjoint_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+  }
+};
+
+TEST_F(SparseTensorDenseMatMulOpTest, Adjoints) {
+  // A = [[1, 0, 2], [0, 0, 0], [3, 4, 0]] with unsorted indices, and
+  // B = [[1, 2], [3, 4], [5, 6]].
+  const std::vector<int64> indices = {2, 1, 0, 0, 2, 0, 0, 2};
+  const std::vector<float> values = {4, 1, 3, 2};
+  const std::vector<std::pair<bool, std::vector<float>>> a_cases = {
+      {false, {11, 14, 0, 0, 15, 22}}, {true, {16, 20, 20, 24, 2, 4}}};
+  for (const auto& a_case : a_cases) {
+    for (bool adjoint_b : {false, true}) {
+      MakeOp(a_case.first, adjoint_b);
+      AddInputFromArray<int64>(TensorShape({4, 2}), indices);
+      AddInputFromArray<float>(TensorShape({4}), values);
+      AddInputFromArray<int64>(TensorShape({2}), {3, 3});
+      if (adjoint_b) {
+        AddInputFromArray<float>(TensorShape({2, 3}), {1, 3, 5, 2, 4, 6});
+      } else {
+        AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+      }
+      TF_ASSERT_OK(RunOpKernel());
+      Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+      test::FillValues<float>(&expected, a_case.second);
+      test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+    }
+  }
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ReusesIndicesWithNewValues) {
+  MakeOp(false, false);
+  AddInputFromArray<int64>(TensorShape({2, 2}), {0, 1, 1, 0});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int64>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {10, 20});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&expected, {20, 20});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+
+  // The cached structure of A is reused, but not its values.
+  test::FillValues<float>(mutable_input(1).tensor, {3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::FillValues<float>(&expected, {60, 40});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, IndexOutOfBounds) {
+  MakeOp(false, false);
+  AddInputFromArray<int64>(TensorShape({2, 2}), {0, 1, 1, 2});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int64>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {10, 20});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "k (2) from index[1,1]")) << s;
+}
+
 Node* SparseTensorDenseMatMulNode(Graph* g, Node* a_indices, Node* a_values,
                                   Node* a_shape, Node* b, bool adjoint_a,
                                   bool adjoint_b) {
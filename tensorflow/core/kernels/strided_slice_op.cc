@@ -320,6 +320,7 @@ class StridedSliceAssignOp : public OpKernel {
         core::RefCountPtr<Var> v;
         OP_REQUIRES_OK(
             context, LookupResource(context, HandleFromInput(context, 0), &v));
+        OP_REQUIRES_OK(context, v->CheckWritable());
         OP_REQUIRES_OK(context,
                        EnsureSparseVariableAccess<Device, T>(context, v.get()));
         mutex_lock ml(*v->mu());
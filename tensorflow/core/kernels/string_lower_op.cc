@@ -17,7 +17,6 @@ limitations under the License.
 
 #include <string>
 
-#include "absl/strings/ascii.h"
 #include "unicode/unistr.h"  // from @icu
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,8 +24,21 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
+namespace {
+
+// Lowers the `size` ASCII bytes of `src` into `dst`. The loop has no branches
+// nor table lookups, so that compilers vectorize it.
+void AsciiToLower(const char* src, size_t size, char* dst) {
+  for (size_t i = 0; i < size; ++i) {
+    const char c = src[i];
+    dst[i] = static_cast<char>(c + ((c >= 'A' && c <= 'Z') << 5));
+  }
+}
+
+}  // namespace
 
 class StringLowerOp : public OpKernel {
  public:
@@ -48,18 +60,31 @@ class StringLowerOp : public OpKernel {
     const auto input = input_tensor->flat<tstring>();
     auto output = output_tensor->flat<tstring>();
 
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
     if (encoding_.empty()) {
-      for (int64 i = 0; i < input.size(); ++i) {
-        StringPiece entry(input(i));
-        output(i) = absl::AsciiStrToLower(entry);
-      }
+      // Lower every string straight into its output, without building a
+      // temporary string first.
+      static constexpr int64 kCostPerString = 50;
+      Shard(worker_threads->num_threads, worker_threads->workers, input.size(),
+            kCostPerString, [&input, &output](int64 start, int64 end) {
+              for (int64 i = start; i < end; ++i) {
+                const tstring& entry = input(i);
+                tstring& lowered = output(i);
+                lowered.resize_uninitialized(entry.size());
+                AsciiToLower(entry.data(), entry.size(), lowered.mdata());
+              }
+            });
     } else {
       // The validation of utf-8 has already been done in GetAttr above.
-      for (int64 i = 0; i < input.size(); ++i) {
-        icu::UnicodeString us(input(i).c_str(), "UTF-8");
-        us.toLower();
-        us.toUTF8String(output(i));
-      }
+      static constexpr int64 kCostPerString = 1000;
+      Shard(worker_threads->num_threads, worker_threads->workers, input.size(),
+            kCostPerString, [&input, &output](int64 start, int64 end) {
+              for (int64 i = start; i < end; ++i) {
+                icu::UnicodeString us(input(i).c_str(), "UTF-8");
+                us.toLower();
+                us.toUTF8String(output(i));
+              }
+            });
     }
   }
 
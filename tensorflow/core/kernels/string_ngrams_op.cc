@@ -13,12 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstring>
 #include <locale>
 #include <string>
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace text {
@@ -96,36 +98,55 @@ class StringNGramsOp : public tensorflow::OpKernel {
             0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
     auto ngrams_data = ngrams->flat<tstring>().data();
 
-    for (int i = 0; i < num_batch_items; ++i) {
-      auto data_start = &input_data[splits_vec(i)];
-      int output_start_idx = ngrams_splits_data[i];
-      for (int ngram_width : ngram_widths_) {
-        auto output_start = &ngrams_data[output_start_idx];
-        int length = splits_vec(i + 1) - splits_vec(i);
-        int num_ngrams = get_num_ngrams(length, ngram_width);
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
-        output_start_idx += num_ngrams;
-      }
-      // If we're preserving short sequences, check to see if no sequence was
-      // generated by comparing the current output start idx to the original
-      // one (ngram_splits_data). If no ngrams were generated, then they will
-      // be equal (since we increment output_start_idx by num_ngrams every
-      // time we create a set of ngrams.)
-      if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
-        int data_length = splits_vec(i + 1) - splits_vec(i);
-        // One legitimate reason to not have any ngrams when preserve_short_
-        // is true is if the sequence itself is empty. In that case, move on.
-        if (data_length == 0) {
-          continue;
-        }
-        // We don't have to worry about dynamic padding sizes here: if padding
-        // was dynamic, every sequence would have had sufficient padding to
-        // generate at least one ngram.
-        int ngram_width = data_length + 2 * pad_width_;
-        auto output_start = &ngrams_data[output_start_idx];
-        int num_ngrams = 1;
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+    // The batch items write disjoint ranges of the output, so they are built
+    // in parallel.
+    const int64 cost_per_item =
+        100 * std::max<int64>(1, ngrams_splits_data[num_batch_items] /
+                                     std::max(1, num_batch_items));
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_batch_items, cost_per_item, [&](int64 start, int64 end) {
+            for (int64 i = start; i < end; ++i) {
+              CreateBatchItemNgrams(input_data, splits_vec,
+                                    ngrams_splits_data, ngrams_data, i);
+            }
+          });
+  }
+
+  // Creates the ngrams of the batch item `i` of `input_data`.
+  void CreateBatchItemNgrams(const tstring* input_data,
+                             const typename TTypes<SPLITS_TYPE>::ConstFlat&
+                                 splits_vec,
+                             const SPLITS_TYPE* ngrams_splits_data,
+                             tstring* ngrams_data, int64 i) const {
+    auto data_start = &input_data[splits_vec(i)];
+    int output_start_idx = ngrams_splits_data[i];
+    for (int ngram_width : ngram_widths_) {
+      auto output_start = &ngrams_data[output_start_idx];
+      int length = splits_vec(i + 1) - splits_vec(i);
+      int num_ngrams = get_num_ngrams(length, ngram_width);
+      CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+      output_start_idx += num_ngrams;
+    }
+    // If we're preserving short sequences, check to see if no sequence was
+    // generated by comparing the current output start idx to the original
+    // one (ngram_splits_data). If no ngrams were generated, then they will
+    // be equal (since we increment output_start_idx by num_ngrams every
+    // time we create a set of ngrams.)
+    if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
+      int data_length = splits_vec(i + 1) - splits_vec(i);
+      // One legitimate reason to not have any ngrams when preserve_short_
+      // is true is if the sequence itself is empty. In that case, move on.
+      if (data_length == 0) {
+        return;
       }
+      // We don't have to worry about dynamic padding sizes here: if padding
+      // was dynamic, every sequence would have had sufficient padding to
+      // generate at least one ngram.
+      int ngram_width = data_length + 2 * pad_width_;
+      auto output_start = &ngrams_data[output_start_idx];
+      int num_ngrams = 1;
+      CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
     }
   }
 
@@ -154,29 +175,37 @@ class StringNGramsOp : public tensorflow::OpKernel {
       int num_separators = left_padding + right_padding + num_tokens - 1;
       ngram_size += num_separators * separator_.length();
 
-      // Build the ngram.
+      // Build the ngram in place: size it once, then copy its pieces without
+      // the capacity checks of append.
       tstring* ngram = &output[ngram_index];
-      ngram->reserve(ngram_size);
+      ngram->resize_uninitialized(ngram_size);
+      char* cursor = ngram->mdata();
       for (int n = 0; n < left_padding; ++n) {
-        ngram->append(left_pad_);
-        ngram->append(separator_);
+        cursor = Copy(left_pad_, cursor);
+        cursor = Copy(separator_, cursor);
       }
       for (int n = 0; n < num_tokens - 1; ++n) {
-        ngram->append(data[data_start_index + n]);
-        ngram->append(separator_);
+        cursor = Copy(data[data_start_index + n], cursor);
+        cursor = Copy(separator_, cursor);
       }
-      ngram->append(data[data_start_index + num_tokens - 1]);
+      cursor = Copy(data[data_start_index + num_tokens - 1], cursor);
       for (int n = 0; n < right_padding; ++n) {
-        ngram->append(separator_);
-        ngram->append(right_pad_);
+        cursor = Copy(separator_, cursor);
+        cursor = Copy(right_pad_, cursor);
       }
 
       // In debug mode only: validate that we've reserved enough space for the
       // ngram.
-      DCHECK_EQ(ngram_size, ngram->size());
+      DCHECK_EQ(ngram_size, cursor - ngram->data());
     }
   }
 
+  // Copies `piece` to `dst` and returns the end of the copy.
+  static char* Copy(StringPiece piece, char* dst) {
+    std::memcpy(dst, piece.data(), piece.size());
+    return dst + piece.size();
+  }
+
   string separator_;
   string left_pad_;
   string right_pad_;
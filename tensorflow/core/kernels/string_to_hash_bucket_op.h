@@ -23,9 +23,34 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Writes the bucket of every string of `input` under `hash` to `output`,
+// sharding the strings over the CPU threads of `context`.
+template <typename Hash>
+void HashStringsToBuckets(OpKernelContext* context,
+                          typename TTypes<tstring>::ConstFlat input,
+                          int64 num_buckets, const Hash& hash,
+                          typename TTypes<int64>::Flat output) {
+  // Roughly the cycles to hash a short string and compute its bucket.
+  static constexpr int64 kCostPerString = 100;
+  auto work = [&input, num_buckets, &hash, &output](int64 start, int64 end) {
+    for (int64 i = start; i < end; ++i) {
+      const uint64 input_hash = hash(input(i));
+      const uint64 bucket_id = input_hash % num_buckets;
+      // The number of buckets is always in the positive range of int64 so is
+      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
+      // safe.
+      output(i) = static_cast<int64>(bucket_id);
+    }
+  };
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, input.size(),
+        kCostPerString, work);
+}
+
 template <uint64 hash(StringPiece)>
 class StringToHashBucketOp : public OpKernel {
  public:
@@ -44,15 +69,9 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    HashStringsToBuckets(
+        context, input_flat, num_buckets_,
+        [](const tstring& s) { return hash(s); }, output_flat);
   }
 
  private:
@@ -86,15 +105,9 @@ class StringToKeyedHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    HashStringsToBuckets(
+        context, input_flat, num_buckets_,
+        [this](const tstring& s) { return hash(key_, s); }, output_flat);
   }
 
  private:
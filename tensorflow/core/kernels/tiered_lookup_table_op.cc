@@ -0,0 +1,448 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// Append-only file holding the rows evicted from the hot cache of a
+// MutableTieredHashTableOfTensors. Rows are never overwritten, so a reader
+// holding an offset keeps seeing a consistent row while the table changes.
+// The file is deleted once the last reference to it is dropped.
+class TieredRowFile {
+ public:
+  static Status Create(Env* env, const string& dir,
+                       std::shared_ptr<TieredRowFile>* file) {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+    std::shared_ptr<TieredRowFile> result(new TieredRowFile(
+        env, io::JoinPath(dir, strings::StrCat("tiered_table_",
+                                               random::New64(), ".rows"))));
+    TF_RETURN_IF_ERROR(env->NewWritableFile(result->path_, &result->writer_));
+    TF_RETURN_IF_ERROR(
+        env->NewRandomAccessFile(result->path_, &result->reader_));
+    *file = std::move(result);
+    return Status::OK();
+  }
+
+  ~TieredRowFile() {
+    if (writer_ != nullptr) {
+      writer_->Close().IgnoreError();
+    }
+    reader_.reset();
+    env_->DeleteFile(path_).IgnoreError();
+  }
+
+  // Appends `rows` to the file and makes them visible to Read().
+  Status Append(StringPiece rows) {
+    TF_RETURN_IF_ERROR(writer_->Append(rows));
+    TF_RETURN_IF_ERROR(writer_->Flush());
+    size_ += rows.size();
+    return Status::OK();
+  }
+
+  // Reads the `n` bytes at `offset`, possibly into `scratch`.
+  Status Read(int64 offset, size_t n, StringPiece* result,
+              char* scratch) const {
+    TF_RETURN_IF_ERROR(reader_->Read(offset, n, result, scratch));
+    if (result->size() != n) {
+      return errors::DataLoss("Short read of ", n, " bytes at offset ", offset,
+                              " from ", path_);
+    }
+    return Status::OK();
+  }
+
+  int64 size() const { return size_; }
+
+ private:
+  TieredRowFile(Env* env, string path) : env_(env), path_(std::move(path)) {}
+
+  Env* const env_;
+  const string path_;
+  std::unique_ptr<WritableFile> writer_;
+  std::unique_ptr<RandomAccessFile> reader_;
+  int64 size_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TieredRowFile);
+};
+
+// Lookup table for tables of vectors that don't fit in memory. The most
+// recently used rows are kept in a hot cache of at most `hot_capacity` rows,
+// the others live in a TieredRowFile under `storage_dir`, which is meant to be
+// on a local SSD. Only the index of the keys stays in memory.
+//
+// Inserted rows go to the hot cache, and are written to the file when they are
+// evicted. Rows missing from the cache are looked up without holding the table
+// lock, with the reads sorted by offset, coalesced and sharded over the intra
+// op threads. A row read from the file is only admitted to the hot cache once
+// it has been looked up `admission_threshold` times since it was last evicted,
+// so that a scan over the cold rows doesn't flush the hot ones.
+//
+// The file is log-structured: updating or removing a cold row leaves its old
+// copy behind. ImportValues() starts from a new file, so restoring a
+// checkpoint compacts the table.
+template <class K, class V>
+class MutableTieredHashTableOfTensors final : public LookupInterface {
+  static_assert(std::is_trivially_copyable<V>::value,
+                "Rows are stored as raw bytes");
+
+ public:
+  MutableTieredHashTableOfTensors(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Default value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "storage_dir", &storage_dir_));
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "hot_capacity", &hot_capacity_));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "admission_threshold",
+                                    &admission_threshold_));
+    value_dim_ = value_shape_.num_elements();
+    row_bytes_ = value_dim_ * sizeof(V);
+    env_ = ctx->env();
+    OP_REQUIRES_OK(ctx, TieredRowFile::Create(env_, storage_dir_, &file_));
+  }
+
+  size_t size() const override {
+    tf_shared_lock l(mu_);
+    return entries_.size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto default_flat = default_value.flat<V>();
+    const auto key_values = key.flat<K>();
+    V* value_data = value->flat<V>().data();
+
+    // (offset, key index) of the rows to read from the file.
+    std::vector<std::pair<int64, int64>> misses;
+    std::shared_ptr<TieredRowFile> file;
+    {
+      mutex_lock l(mu_);
+      file = file_;
+      for (int64 i = 0; i < key_values.size(); ++i) {
+        V* row = value_data + i * value_dim_;
+        auto it = entries_.find(SubtleMustCopyIfIntegral(key_values(i)));
+        if (it == entries_.end()) {
+          std::copy_n(default_flat.data(), value_dim_, row);
+        } else if (it->second.hot) {
+          std::copy_n(it->second.row.data(), value_dim_, row);
+          lru_.splice(lru_.begin(), lru_, it->second.lru);
+        } else {
+          misses.emplace_back(it->second.offset, i);
+        }
+      }
+    }
+    if (misses.empty()) {
+      return Status::OK();
+    }
+    std::sort(misses.begin(), misses.end());
+    TF_RETURN_IF_ERROR(ReadRows(ctx, *file, misses, value_data));
+
+    mutex_lock l(mu_);
+    if (file != file_) {
+      // The table has been imported in the meantime.
+      return Status::OK();
+    }
+    string evicted;
+    for (const auto& miss : misses) {
+      const K k = SubtleMustCopyIfIntegral(key_values(miss.second));
+      auto it = entries_.find(k);
+      if (it == entries_.end()) {
+        continue;
+      }
+      Entry& entry = it->second;
+      // Skip the rows admitted or rewritten since they were read.
+      if (entry.hot || entry.offset != miss.first) {
+        continue;
+      }
+      if (++entry.frequency < admission_threshold_) {
+        continue;
+      }
+      const V* row = value_data + miss.second * value_dim_;
+      entry.row.assign(row, row + value_dim_);
+      entry.dirty = false;
+      MakeHot(k, &entry, &evicted);
+    }
+    return WriteEvicted(evicted);
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    mutex_lock l(mu_);
+    return DoInsert(keys, values);
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      auto it = entries_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      if (it == entries_.end()) {
+        continue;
+      }
+      if (it->second.hot) {
+        lru_.erase(it->second.lru);
+      }
+      entries_.erase(it);
+    }
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    std::shared_ptr<TieredRowFile> file;
+    TF_RETURN_IF_ERROR(TieredRowFile::Create(env_, storage_dir_, &file));
+
+    mutex_lock l(mu_);
+    entries_.clear();
+    lru_.clear();
+    file_ = std::move(file);
+    return DoInsert(keys, values);
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    mutex_lock l(mu_);
+    const int64 size = entries_.size();
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TensorShape values_shape({size});
+    values_shape.AppendShape(value_shape_);
+    TF_RETURN_IF_ERROR(ctx->allocate_output("values", values_shape, &values));
+
+    auto keys_data = keys->flat<K>();
+    V* values_data = values->flat<V>().data();
+    std::vector<std::pair<int64, int64>> cold;
+    int64 i = 0;
+    for (auto it = entries_.begin(); it != entries_.end(); ++it, ++i) {
+      keys_data(i) = it->first;
+      if (it->second.hot) {
+        std::copy_n(it->second.row.data(), value_dim_,
+                    values_data + i * value_dim_);
+      } else {
+        cold.emplace_back(it->second.offset, i);
+      }
+    }
+    std::sort(cold.begin(), cold.end());
+    return ReadRows(ctx, *file_, cold, values_data);
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64 MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(MutableTieredHashTableOfTensors) +
+           entries_.size() * sizeof(typename decltype(entries_)::value_type) +
+           lru_.size() * (row_bytes_ + sizeof(K));
+  }
+
+ private:
+  struct Entry {
+    // Offset of the latest copy of the row in the file, or -1 if the row has
+    // never been evicted.
+    int64 offset = -1;
+    // Number of lookups from the file since the row was last evicted.
+    int64 frequency = 0;
+    // Whether the row is in the hot cache, and if so, whether it differs from
+    // the copy in the file.
+    bool hot = false;
+    bool dirty = false;
+    typename std::list<K>::iterator lru;
+    std::vector<V> row;
+  };
+
+  // Reads of consecutive rows are coalesced up to this size.
+  static constexpr int64 kMaxReadBytes = 1 << 20;
+
+  Status DoInsert(const Tensor& keys, const Tensor& values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto key_values = keys.flat<K>();
+    const V* value_data = values.flat<V>().data();
+
+    string evicted;
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      Entry& entry = entries_[k];
+      const V* row = value_data + i * value_dim_;
+      entry.row.assign(row, row + value_dim_);
+      entry.dirty = true;
+      if (entry.hot) {
+        lru_.splice(lru_.begin(), lru_, entry.lru);
+      } else {
+        MakeHot(k, &entry, &evicted);
+      }
+    }
+    return WriteEvicted(evicted);
+  }
+
+  // Adds `entry` to the hot cache. The dirty rows evicted to make room for it
+  // are appended to `evicted`, which the caller writes with WriteEvicted().
+  void MakeHot(const K& k, Entry* entry, string* evicted)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    entry->hot = true;
+    entry->frequency = 0;
+    lru_.push_front(k);
+    entry->lru = lru_.begin();
+    while (static_cast<int64>(lru_.size()) > hot_capacity_) {
+      Entry& victim = entries_[lru_.back()];
+      if (victim.dirty) {
+        victim.offset = file_->size() + evicted->size();
+        evicted->append(reinterpret_cast<const char*>(victim.row.data()),
+                        row_bytes_);
+      }
+      victim.hot = false;
+      victim.dirty = false;
+      std::vector<V>().swap(victim.row);
+      lru_.pop_back();
+    }
+  }
+
+  Status WriteEvicted(const string& evicted) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (evicted.empty()) {
+      return Status::OK();
+    }
+    return file_->Append(evicted);
+  }
+
+  // Copies the rows at the sorted offsets of `rows` from `file` to the
+  // corresponding rows of `output`.
+  Status ReadRows(OpKernelContext* ctx, const TieredRowFile& file,
+                  const std::vector<std::pair<int64, int64>>& rows,
+                  V* output) const {
+    struct Read {
+      int64 begin;
+      int64 end;
+      int64 offset;
+      int64 bytes;
+    };
+    std::vector<Read> reads;
+    for (int64 i = 0, end = rows.size(); i < end; ++i) {
+      const int64 offset = rows[i].first;
+      if (!reads.empty()) {
+        Read& read = reads.back();
+        const int64 read_end = read.offset + read.bytes;
+        if (offset == read_end - row_bytes_ ||
+            (offset == read_end && read.bytes + row_bytes_ <= kMaxReadBytes)) {
+          read.end = i + 1;
+          read.bytes = offset + row_bytes_ - read.offset;
+          continue;
+        }
+      }
+      reads.push_back({i, i + 1, offset, row_bytes_});
+    }
+
+    mutex status_mu;
+    Status status;
+    auto do_reads = [&](int64 start, int64 limit) {
+      std::vector<char> scratch;
+      for (int64 r = start; r < limit; ++r) {
+        const Read& read = reads[r];
+        scratch.resize(read.bytes);
+        StringPiece result;
+        Status s = file.Read(read.offset, read.bytes, &result, scratch.data());
+        if (!s.ok()) {
+          mutex_lock l(status_mu);
+          status.Update(s);
+          return;
+        }
+        for (int64 i = read.begin; i < read.end; ++i) {
+          std::memcpy(output + rows[i].second * value_dim_,
+                      result.data() + (rows[i].first - read.offset),
+                      row_bytes_);
+        }
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    // Reads are dominated by the storage latency, so shard them as much as
+    // possible.
+    Shard(worker_threads->num_threads, worker_threads->workers, reads.size(),
+          /*cost_per_unit=*/kMaxReadBytes, do_reads);
+    return status;
+  }
+
+  TensorShape value_shape_;
+  int64 value_dim_;
+  int64 row_bytes_;
+  string storage_dir_;
+  int64 hot_capacity_;
+  int64 admission_threshold_;
+  Env* env_;
+
+  mutable mutex mu_;
+  std::shared_ptr<TieredRowFile> file_ TF_GUARDED_BY(mu_);
+  std::unordered_map<K, Entry> entries_ TF_GUARDED_BY(mu_);
+  // Keys of the hot rows, most recently used first.
+  std::list<K> lru_ TF_GUARDED_BY(mu_);
+};
+
+template <class K, class V>
+constexpr int64 MutableTieredHashTableOfTensors<K, V>::kMaxReadBytes;
+
+}  // namespace lookup
+
+// Register the MutableTieredHashTableOfTensors op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                            \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("MutableTieredHashTableOfTensors")                              \
+          .Device(DEVICE_CPU)                                              \
+          .TypeConstraint<key_dtype>("key_dtype")                          \
+          .TypeConstraint<value_dtype>("value_dtype"),                     \
+      LookupTableOp<                                                       \
+          lookup::MutableTieredHashTableOfTensors<key_dtype, value_dtype>, \
+          key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
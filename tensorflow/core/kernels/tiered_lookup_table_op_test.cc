@@ -0,0 +1,214 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kNumKeys = 10;
+constexpr int64 kValueDim = 3;
+
+Tensor Keys(int64 num_keys) {
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    keys.flat<int64>()(i) = i;
+  }
+  return keys;
+}
+
+Tensor Values(int64 num_keys, float scale) {
+  Tensor values(DT_FLOAT, TensorShape({num_keys, kValueDim}));
+  for (int64 i = 0; i < num_keys * kValueDim; ++i) {
+    values.flat<float>()(i) = scale * i;
+  }
+  return values;
+}
+
+class TieredLookupTableOpTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    storage_dir_ = io::JoinPath(
+        testing::TmpDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    CreateSession(TensorShape({kValueDim}));
+  }
+
+  // Creates a session holding a table with rows of `value_shape`, or of the
+  // default value shape of the op if unset.
+  void CreateSession(const absl::optional<TensorShape>& value_shape) {
+    Graph g(OpRegistry::Global());
+    Node* table;
+    NodeBuilder table_builder("table", "MutableTieredHashTableOfTensors");
+    table_builder.Attr("key_dtype", DT_INT64)
+        .Attr("value_dtype", DT_FLOAT)
+        .Attr("storage_dir", storage_dir_)
+        .Attr("hot_capacity", 2)
+        .Attr("admission_threshold", 2);
+    if (value_shape) {
+      table_builder.Attr("value_shape", *value_shape);
+    }
+    TF_ASSERT_OK(table_builder.Finalize(&g, &table));
+    Node* keys = test::graph::Placeholder(&g, DT_INT64);
+    Node* values = test::graph::Placeholder(&g, DT_FLOAT);
+    Node* node;
+    TF_ASSERT_OK(NodeBuilder("insert", "LookupTableInsertV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Input(values)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("import", "LookupTableImportV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Input(values)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("remove", "LookupTableRemoveV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Finalize(&g, &node));
+    Tensor default_value(DT_FLOAT, value_shape.value_or(TensorShape()));
+    default_value.flat<float>().setConstant(-1);
+    TF_ASSERT_OK(NodeBuilder("find", "LookupTableFindV2")
+                     .Input(table)
+                     .Input(keys)
+                     .Input(test::graph::Constant(&g, default_value))
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("size", "LookupTableSizeV2")
+                     .Input(table)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("export", "LookupTableExportV2")
+                     .Input(table)
+                     .Attr("Tkeys", DT_INT64)
+                     .Attr("Tvalues", DT_FLOAT)
+                     .Finalize(&g, &node));
+    keys_ = keys->name();
+    values_ = values->name();
+
+    GraphDef graph_def;
+    g.ToGraphDef(&graph_def);
+    session_.reset(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session_->Create(graph_def));
+  }
+
+  void Update(const string& op, const Tensor& keys, const Tensor& values) {
+    TF_ASSERT_OK(
+        session_->Run({{keys_, keys}, {values_, values}}, {}, {op}, nullptr));
+  }
+
+  void Remove(const Tensor& keys) {
+    TF_ASSERT_OK(session_->Run({{keys_, keys}}, {}, {"remove"}, nullptr));
+  }
+
+  Tensor Find(const Tensor& keys) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({{keys_, keys}}, {"find"}, {}, &outputs));
+    return outputs[0];
+  }
+
+  int64 Size() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({}, {"size"}, {}, &outputs));
+    return outputs[0].scalar<int64>()();
+  }
+
+  // Returns the number of row files in the storage directory.
+  int NumRowFiles() {
+    std::vector<string> children;
+    TF_CHECK_OK(Env::Default()->GetChildren(storage_dir_, &children));
+    return children.size();
+  }
+
+  string storage_dir_;
+  string keys_;
+  string values_;
+  std::unique_ptr<Session> session_;
+};
+
+TEST_F(TieredLookupTableOpTest, FindsEvictedRows) {
+  Update("insert", Keys(kNumKeys), Values(kNumKeys, 1));
+  EXPECT_EQ(kNumKeys, Size());
+
+  // Most rows come from the file, and looking them up twice admits them back
+  // to the hot cache.
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorEqual<float>(Values(kNumKeys, 1), Find(Keys(kNumKeys)));
+  }
+
+  // Updates of hot and cold rows are both visible.
+  Update("insert", Keys(kNumKeys), Values(kNumKeys, 2));
+  test::ExpectTensorEqual<float>(Values(kNumKeys, 2), Find(Keys(kNumKeys)));
+
+  Remove(Keys(1));
+  EXPECT_EQ(kNumKeys - 1, Size());
+  Tensor expected = Values(kNumKeys, 2);
+  expected.matrix<float>().chip<0>(0).setConstant(-1);
+  test::ExpectTensorEqual<float>(expected, Find(Keys(kNumKeys)));
+}
+
+TEST_F(TieredLookupTableOpTest, ExportsAndImports) {
+  Update("insert", Keys(kNumKeys), Values(kNumKeys, 1));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session_->Run({}, {"export:0", "export:1"}, {}, &outputs));
+  ASSERT_EQ(kNumKeys, outputs[0].NumElements());
+  const auto keys = outputs[0].flat<int64>();
+  const auto values = outputs[1].matrix<float>();
+  for (int64 i = 0; i < kNumKeys; ++i) {
+    for (int64 j = 0; j < kValueDim; ++j) {
+      EXPECT_EQ(keys(i) * kValueDim + j, values(i, j));
+    }
+  }
+
+  // Importing replaces the content of the table, and its row file.
+  EXPECT_EQ(1, NumRowFiles());
+  Update("import", Keys(kNumKeys / 2), Values(kNumKeys / 2, 3));
+  EXPECT_EQ(1, NumRowFiles());
+  EXPECT_EQ(kNumKeys / 2, Size());
+  test::ExpectTensorEqual<float>(Values(kNumKeys / 2, 3),
+                                 Find(Keys(kNumKeys / 2)));
+}
+
+TEST_F(TieredLookupTableOpTest, DefaultValueShapeIsScalar) {
+  CreateSession(absl::nullopt);
+  // Of the 4 rows, 2 are evicted to the file.
+  const Tensor values = test::AsTensor<float>({1, 2, 3, 4});
+  Update("insert", Keys(4), values);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1, 2, 3, 4, -1}),
+                                 Find(Keys(5)));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session_->Run({}, {"export:0", "export:1"}, {}, &outputs));
+  ASSERT_EQ(TensorShape({4}), outputs[1].shape());
+  const auto keys = outputs[0].flat<int64>();
+  for (int64 i = 0; i < 4; ++i) {
+    EXPECT_EQ(keys(i) + 1, outputs[1].flat<float>()(i));
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -99,6 +100,97 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+namespace {
+
+// Orders the columns of a row by decreasing value, then increasing index, so
+// that the top k columns of a row are unique whichever way they are found.
+template <typename T>
+struct StableGreater {
+  bool operator()(const int32 a, const int32 b) const {
+    if (row[b] < row[a]) {
+      return true;
+    } else if (row[b] > row[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+
+  const T* row;
+};
+
+// Finds the top `k` columns of rows too few to keep every thread busy, by
+// splitting each row into blocks whose top k are found in parallel, then
+// merging the top k of the blocks of each row.
+// REQUIRES: k < num_cols.
+template <typename T>
+void TopKOfRowBlocks(const DeviceBase::CpuWorkerThreads& worker_threads,
+                     bool sorted, int k,
+                     const typename TTypes<T, 2>::ConstTensor& input,
+                     const int64 num_rows, const int64 num_cols,
+                     typename TTypes<T, 2>::Tensor values,
+                     typename TTypes<int, 2>::Tensor indices,
+                     const int64 block_size, const double cmp_cost) {
+  const int64 num_blocks = (num_cols + block_size - 1) / block_size;
+  // The top k of block b of row r are the candidates
+  // [(r * num_blocks + b) * k, (r * num_blocks + b) * k + num_candidates[.]).
+  std::vector<int32> candidates(num_rows * num_blocks * k);
+  std::vector<int32> num_candidates(num_rows * num_blocks);
+  const double log_k = Eigen::numext::log2(static_cast<float>(k + 1));
+
+  auto block_top_k = [&](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      const int64 r = i / num_blocks;
+      const int32 begin = (i % num_blocks) * block_size;
+      const int32 end = std::min<int64>(begin + block_size, num_cols);
+      StableGreater<T> comp{&input(r, 0)};
+      gtl::TopN<int32, StableGreater<T>> filter(k, comp);
+      for (int32 c = begin; c < end; ++c) {
+        filter.push(c);
+      }
+      int32* out = &candidates[i * k];
+      for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+           ++it) {
+        *out++ = *it;
+      }
+      num_candidates[i] = out - &candidates[i * k];
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        num_rows * num_blocks,
+        static_cast<int64>(4 * cmp_cost * block_size * log_k), block_top_k);
+
+  auto merge = [&](int64 start, int64 limit) {
+    for (int64 r = start; r < limit; ++r) {
+      StableGreater<T> comp{&input(r, 0)};
+      gtl::TopN<int32, StableGreater<T>> filter(k, comp);
+      for (int64 b = r * num_blocks; b < (r + 1) * num_blocks; ++b) {
+        for (int32 j = 0; j < num_candidates[b]; ++j) {
+          filter.push(candidates[b * k + j]);
+        }
+      }
+      int32 i = 0;
+      if (sorted) {
+        std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+        for (const int32 c : *top_k) {
+          indices(r, i++) = c;
+        }
+      } else {
+        for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+             ++it) {
+          indices(r, i++) = *it;
+        }
+      }
+      std::transform(&indices(r, 0), &indices(r, k), &values(r, 0),
+                     [r, &input](const int32 loc) { return input(r, loc); });
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        static_cast<int64>(4 * cmp_cost * num_blocks * k * log_k), merge);
+}
+
+}  // namespace
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -222,6 +314,21 @@ struct TopKFunctor<CPUDevice, T> {
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // Rows too few to use every thread are split into blocks of columns. The
+    // blocks keep at least a few times k columns, so that their top k are a
+    // small part of them, and at most a few blocks per thread.
+    static constexpr int64 kMinBlockSize = 16384;
+    const int64 block_size = std::max<int64>(
+        {kMinBlockSize, 8 * static_cast<int64>(k),
+         num_rows * num_cols / (4 * worker_threads.num_threads)});
+    if (k < num_cols && num_rows < worker_threads.num_threads &&
+        num_cols >= 2 * block_size) {
+      TopKOfRowBlocks<T>(worker_threads, sorted, k, input, num_rows, num_cols,
+                         values, indices, block_size, cmp_cost);
+      return Status::OK();
+    }
+
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TopKOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool sorted) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "TopKV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("sorted", sorted)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+  }
+};
+
+// Rows long enough to be split into blocks of columns, with many ties.
+TEST_F(TopKOpTest, LongRows) {
+  constexpr int kRows = 2;
+  constexpr int kCols = 100000;
+  constexpr int kK = 100;
+  std::vector<float> input(kRows * kCols);
+  for (int i = 0; i < kRows * kCols; ++i) {
+    input[i] = (i * 7919) % 1000;
+  }
+
+  for (const bool sorted : {true, false}) {
+    MakeOp(sorted);
+    AddInputFromArray<float>(TensorShape({kRows, kCols}), input);
+    AddInputFromArray<int32>(TensorShape({}), {kK});
+    TF_ASSERT_OK(RunOpKernel());
+
+    for (int r = 0; r < kRows; ++r) {
+      const float* row = &input[r * kCols];
+      std::vector<int32> expected(kCols);
+      std::iota(expected.begin(), expected.end(), 0);
+      std::stable_sort(expected.begin(), expected.end(),
+                       [row](int32 a, int32 b) { return row[a] > row[b]; });
+      expected.resize(kK);
+
+      const auto values = GetOutput(0)->matrix<float>();
+      const auto indices = GetOutput(1)->matrix<int32>();
+      std::vector<int32> actual(&indices(r, 0), &indices(r, 0) + kK);
+      for (int i = 0; i < kK; ++i) {
+        EXPECT_EQ(row[actual[i]], values(r, i));
+      }
+      if (!sorted) {
+        std::sort(actual.begin(), actual.end(), [row](int32 a, int32 b) {
+          return row[a] > row[b] || (row[a] == row[b] && a < b);
+        });
+      }
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
+static Graph* TopK(int rows, int cols, int k) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({rows, cols}));
+  input.flat<float>().setRandom();
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("topk"), "TopKV2")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, test::AsScalar<int32>(k)))
+                  .Finalize(g, &node));
+  return g;
+}
+
+#define BM_TopK(ROWS, COLS, K)                                          \
+  static void BM_TopK_##ROWS##_##COLS##_##K(int iters) {                \
+    testing::UseRealTime();                                             \
+    testing::ItemsProcessed(static_cast<int64>(iters) * ROWS * COLS);   \
+    test::Benchmark("cpu", TopK(ROWS, COLS, K)).Run(iters);             \
+  }                                                                     \
+  BENCHMARK(BM_TopK_##ROWS##_##COLS##_##K);
+
+BM_TopK(1, 10000000, 1000);
+BM_TopK(1, 1000000, 10);
+BM_TopK(4, 1000000, 100);
+BM_TopK(128, 10000, 10);
+
+}  // namespace
+}  // namespace tensorflow
@@ -27,10 +27,11 @@ namespace tensorflow {
 
 // Must be called before performing a sparse operation on a variable. Ensures
 // that no concurrent dense operations can happen while holding the variable's
-// lock.
+// lock. Read-only variables are left as they are, since nothing writes to
+// them.
 template <typename Device, typename T>
 Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
-  if (var->copy_on_read_mode.load()) {
+  if (var->copy_on_read_mode.load() || var->read_only.load()) {
     return Status::OK();
   }
   mutex_lock ml(*var->mu());
@@ -242,6 +243,7 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
   if (ctx->input_dtype(input) == DT_RESOURCE) {
     core::RefCountPtr<Var> var;
     TF_RETURN_IF_ERROR(LookupResource(ctx, HandleFromInput(ctx, input), &var));
+    TF_RETURN_IF_ERROR(var->CheckWritable());
     if (sparse) {
       TF_RETURN_IF_ERROR(EnsureSparseVariableAccess<Device, T>(ctx, var.get()));
       *out = *var->tensor();
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/util.h"
 
 #ifdef TENSORFLOW_USE_SYCL
@@ -45,6 +46,30 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+inline void PrefetchRow(int64 offset) {}
+
+template <typename Matrix, typename... Matrices>
+inline void PrefetchRow(int64 offset, const Matrix& flat,
+                        const Matrices&... flats) {
+  port::prefetch<port::PREFETCH_HINT_T0>(flat.data() + offset);
+  PrefetchRow(offset, flats...);
+}
+
+// Sparse updates touch rows scattered over tables much larger than the caches,
+// like embeddings. As in the gather kernels, the loops below prefetch the rows
+// of the next index while updating the current one; this prefetches row
+// indices(i + 1) of every matrix in `flats`, when it is valid.
+template <typename IndexVec, typename Tindex, typename Matrix,
+          typename... Matrices>
+inline void PrefetchNextSparseRow(const IndexVec& indices, Tindex i, Tindex n,
+                                  const Matrix& flat,
+                                  const Matrices&... flats) {
+  if (i + 1 >= n) return;
+  const Tindex next = internal::SubtleMustCopy(indices(i + 1));
+  if (!FastBoundsCheck(next, flat.dimension(0))) return;
+  PrefetchRow(static_cast<int64>(next) * flat.dimension(1), flat, flats...);
+}
 }  // namespace
 
 namespace functor {
@@ -409,6 +434,7 @@ struct SparseApplyKerasMomentum<CPUDevice, T, Tindex> {
     for (Tindex i = 0; i < N; i++) {
       const Tindex index = internal::SubtleMustCopy(indices(i));
       if (!FastBoundsCheck(index, first_dim_size)) return i;
+      PrefetchNextSparseRow(indices, i, N, var, accum);
       auto a = accum.template chip<0>(index);
       auto g = grad.template chip<0>(i);
       auto v = var.template chip<0>(index);
@@ -1040,6 +1066,8 @@ class SparseApplyAdadeltaOp : public OpKernel {
 
       for (Tindex i = 0; i < N; i++) {
         const Tindex index = indices_vec(i);
+        PrefetchNextSparseRow(indices_vec, i, N, var_flat, accum_grad_flat,
+                              accum_update_flat);
         auto accum_ = accum_grad_flat.template chip<0>(index);
         auto accum_update_ = accum_update_flat.template chip<0>(index);
         auto grad_ = grad_flat.template chip<0>(i);
@@ -1712,6 +1740,7 @@ class SparseApplyAdagradOp : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+            PrefetchNextSparseRow(indices_vec, i, N, var_flat, accum_flat);
             auto a = accum_flat.template chip<0>(index);
             auto g = grad_flat.template chip<0>(i);
             auto v = var_flat.template chip<0>(index);
@@ -1880,6 +1909,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+            PrefetchNextSparseRow(indices_vec, i, N, var_flat, accum_flat);
             auto a = accum_flat.template chip<0>(index);
             auto g = grad_flat.template chip<0>(i);
             auto v = var_flat.template chip<0>(index);
@@ -2051,6 +2081,7 @@ class SparseApplyProximalAdagradOp : public OpKernel {
                       errors::InvalidArgument(
                           strings::StrCat("Index ", index, " at offset ", i,
                                           " in indices is out of range")));
+          PrefetchNextSparseRow(indices_vec, i, N, var_flat, accum_flat);
           auto a = accum_flat.template chip<0>(index);
           auto g = grad_flat.template chip<0>(i);
           auto v = var_flat.template chip<0>(index);
@@ -2351,6 +2382,9 @@ class SparseApplyAdagradDAOp : public OpKernel {
                       errors::InvalidArgument(
                           strings::StrCat("Index ", index, " at offset ", i,
                                           " in indices is out of range")));
+          PrefetchNextSparseRow(indices_vec, i, N, var_flat,
+                                gradient_accum_flat,
+                                gradient_squared_accum_flat);
           auto ga = gradient_accum_flat.template chip<0>(index);
           auto da = gradient_squared_accum_flat.template chip<0>(index);
           auto g = grad_flat.template chip<0>(i);
@@ -2776,6 +2810,8 @@ class SparseApplyFtrlOp : public OpKernel {
                       errors::InvalidArgument(
                           strings::StrCat("Index ", index, " at offset ", i,
                                           " in indices is out of range")));
+          PrefetchNextSparseRow(indices_vec, i, N, var_flat, accum_flat,
+                                linear_flat);
           auto accum = accum_flat.template chip<0>(index);
           auto linear = linear_flat.template chip<0>(index);
           auto grad = grad_flat.template chip<0>(i);
@@ -3139,6 +3175,7 @@ class SparseApplyMomentumOp : public OpKernel {
                     errors::InvalidArgument(
                         strings::StrCat("Index ", index, " at offset ", i,
                                         " in indices is out of range")));
+        PrefetchNextSparseRow(indices_vec, i, N, var_flat, accum_flat);
         auto a = accum_flat.template chip<0>(index);
         auto g = grad_flat.template chip<0>(i);
         auto v = var_flat.template chip<0>(index);
@@ -4330,6 +4367,7 @@ class SparseApplyRMSPropOp : public OpKernel {
 
       for (Tindex i = 0; i < N; i++) {
         const Tindex index = indices_vec(i);
+        PrefetchNextSparseRow(indices_vec, i, N, var_flat, ms_flat, mom_flat);
 
         auto ms_ = ms_flat.template chip<0>(index);
         auto mom_ = mom_flat.template chip<0>(index);
@@ -4469,6 +4507,8 @@ class SparseApplyCenteredRMSPropOp : public OpKernel {
 
       for (Tindex i = 0; i < N; i++) {
         const Tindex index = indices_vec(i);
+        PrefetchNextSparseRow(indices_vec, i, N, var_flat, ms_flat, mom_flat,
+                              mg_flat);
 
         auto ms_ = ms_flat.template chip<0>(index);
         auto mom_ = mom_flat.template chip<0>(index);
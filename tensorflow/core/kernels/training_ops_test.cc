@@ -13,9 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -80,6 +89,17 @@ static Node* Iota(Graph* g, int n) {
   return test::graph::Constant(g, data);
 }
 
+// Returns the `n` indices i * 7919 mod `m`, which are distinct for a power of
+// two `m` and spread over the whole table, like the ids of an embedding.
+static Node* ScatteredIndices(Graph* g, int m, int n) {
+  Tensor data(DT_INT32, TensorShape({n}));
+  int32* base = data.flat<int32>().data();
+  for (int i = 0; i < n; ++i) {
+    base[i] = static_cast<int32>(static_cast<int64>(i) * 7919 % m);
+  }
+  return test::graph::Constant(g, data);
+}
+
 static Node* Scalar(Graph* g, float val) {
   Tensor data(DT_FLOAT, TensorShape({}));
   data.flat<float>()(0) = val;
@@ -146,7 +166,8 @@ static void BM_Adagrad(int iters, int params) {
 }
 BENCHMARK(BM_Adagrad)->Arg(128 << 10)->Arg(256 << 10);
 
-static void SparseAdagrad(int32 m, int32 n, Graph** init_g, Graph** train_g) {
+static void SparseAdagrad(int32 m, int32 n, Graph** init_g, Graph** train_g,
+                          int32 num_rows = 0) {
   {
     Graph* g = new Graph(OpRegistry::Global());
     auto var = Var(g, m, n);
@@ -161,8 +182,9 @@ static void SparseAdagrad(int32 m, int32 n, Graph** init_g, Graph** train_g) {
     auto var = Var(g, m, n);
     auto accum = Var(g, m, n);
     auto lr = Scalar(g, 0.01);
-    auto grad = Random(g, m, n);
-    auto indices = Iota(g, m);
+    // Updates all the rows in order, or `num_rows` rows scattered over var.
+    auto grad = Random(g, num_rows > 0 ? num_rows : m, n);
+    auto indices = num_rows > 0 ? ScatteredIndices(g, m, num_rows) : Iota(g, m);
     test::graph::Multi(g, "SparseApplyAdagrad",
                        {var, accum, lr, grad, indices});
     *train_g = g;
@@ -185,6 +207,23 @@ BENCHMARK(BM_SparseAdagrad)
     ->ArgPair(128, 32 << 10)
     ->ArgPair(128, 128 << 10);
 
+static void BM_SparseAdagradScattered(int iters, int m, int n) {
+  const int32 num_rows = 1 << 10;
+  const int64 tot = static_cast<int64>(iters) * num_rows * n;
+  testing::UseRealTime();
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * sizeof(float));
+  Graph* init;
+  Graph* train;
+  SparseAdagrad(m, n, &init, &train, num_rows);
+  test::Benchmark("cpu", train, GetOptions(), init).Run(iters);
+}
+BENCHMARK(BM_SparseAdagradScattered)
+    ->ArgPair(64 << 10, 16)
+    ->ArgPair(64 << 10, 64)
+    ->ArgPair(1 << 20, 16)
+    ->ArgPair(1 << 20, 64);
+
 static void Momentum(int32 n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
@@ -382,4 +421,108 @@ static void BM_PowerSign(int iters, int params) {
 }
 BENCHMARK(BM_PowerSign)->Arg(128 << 10)->Arg(256 << 10);
 
+// The sparse kernels prefetch the rows of the next index while they update
+// the current one, so these check that every row is still updated once per
+// index, down to the last index, and with duplicates.
+class SparseApplyOpTest : public OpsTestBase {
+ protected:
+  // Runs SparseApplyAdagrad on the [4, 2] variable 1, ..., 8, with an
+  // accumulator of 3s, a learning rate of 2 and gradients of 1s.
+  Status RunSparseAdagrad(const std::vector<int32>& indices) {
+    TF_CHECK_OK(NodeDefBuilder("myop", "SparseApplyAdagrad")
+                    .Input(FakeInput(DT_FLOAT_REF))
+                    .Input(FakeInput(DT_FLOAT_REF))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_INT32))
+                    .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    const int num_indices = indices.size();
+    AddInputFromArray<float>(TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8});
+    AddInputFromArray<float>(TensorShape({4, 2}), std::vector<float>(8, 3));
+    AddInputFromArray<float>(TensorShape({}), {2});
+    AddInputFromArray<float>(TensorShape({num_indices, 2}),
+                             std::vector<float>(2 * num_indices, 1));
+    AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+    return RunOpKernel();
+  }
+};
+
+TEST_F(SparseApplyOpTest, AdagradUpdatesLastRow) {
+  // Each row gets an accumulator of 3 + 1 = 4, and loses 2 * 1 / sqrt(4).
+  TF_ASSERT_OK(RunSparseAdagrad({1, 3}));
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({1, 2, 2, 3, 5, 6, 6, 7}, {4, 2}),
+      *mutable_input(0).tensor, 1e-5);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({3, 3, 4, 4, 3, 3, 4, 4}, {4, 2}),
+      *mutable_input(1).tensor);
+}
+
+TEST_F(SparseApplyOpTest, AdagradUpdatesDuplicateIndices) {
+  TF_ASSERT_OK(RunSparseAdagrad({3, 0, 3}));
+  const float twice = 1 + 2 / std::sqrt(5.0f);
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({0, 1, 3, 4, 5, 6, 7 - twice, 8 - twice}, {4, 2}),
+      *mutable_input(0).tensor, 1e-5);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({4, 4, 3, 3, 3, 3, 5, 5}, {4, 2}),
+      *mutable_input(1).tensor);
+}
+
+TEST_F(SparseApplyOpTest, AdagradLastIndexOutOfRange) {
+  Status s = RunSparseAdagrad({0, 4});
+  EXPECT_TRUE(absl::StrContains(
+      s.ToString(), "Index 4 at offset 1 in indices is out of range"))
+      << s;
+}
+
+TEST_F(SparseApplyOpTest, AdadeltaUpdatesLastRow) {
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SparseApplyAdadelta")
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT32))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const float lr = 0.5f, rho = 0.9f, epsilon = 0.1f;
+  std::vector<float> var = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<float> accum(8, 1);
+  std::vector<float> accum_update(8, 2);
+  const std::vector<float> grad = {1, 2, 3, 4, 5, 6};
+  const std::vector<int32> indices = {3, 1, 3};
+  AddInputFromArray<float>(TensorShape({4, 2}), var);
+  AddInputFromArray<float>(TensorShape({4, 2}), accum);
+  AddInputFromArray<float>(TensorShape({4, 2}), accum_update);
+  AddInputFromArray<float>(TensorShape({}), {lr});
+  AddInputFromArray<float>(TensorShape({}), {rho});
+  AddInputFromArray<float>(TensorShape({}), {epsilon});
+  AddInputFromArray<float>(TensorShape({3, 2}), grad);
+  AddInputFromArray<int32>(TensorShape({3}), indices);
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      const int k = 2 * indices[i] + j;
+      const float g = grad[2 * i + j];
+      accum[k] = accum[k] * rho + g * g * (1 - rho);
+      const float update =
+          std::sqrt(accum_update[k] + epsilon) / std::sqrt(accum[k] + epsilon) *
+          g;
+      var[k] -= update * lr;
+      accum_update[k] = accum_update[k] * rho + update * update * (1 - rho);
+    }
+  }
+  test::ExpectTensorNear<float>(test::AsTensor<float>(var, {4, 2}),
+                                *mutable_input(0).tensor, 1e-5);
+  test::ExpectTensorNear<float>(test::AsTensor<float>(accum, {4, 2}),
+                                *mutable_input(1).tensor, 1e-5);
+  test::ExpectTensorNear<float>(test::AsTensor<float>(accum_update, {4, 2}),
+                                *mutable_input(2).tensor, 1e-5);
+}
+
 }  // end namespace tensorflow
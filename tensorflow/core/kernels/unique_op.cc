@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +72,164 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs with at least this many elements are made unique in parallel.
+constexpr int64 kParallelUniqueMinSize = 1 << 17;
+
+// `ParallelUnique` computes the unique elements of a vector like the
+// sequential implementation in `UniqueOp`, but spreads the work over the
+// intra-op thread pool. The elements are hashed into one partition per
+// thread, each partition is made unique independently, and the partitions
+// are merged back in the order of first occurrence, so that the results are
+// identical to the sequential ones.
+//
+// Only integer elements are handled; `Compute()` returns false, and does
+// nothing, for other types and for small inputs.
+template <typename T, typename TIndex,
+          bool kIsIntegral = std::is_integral<T>::value>
+struct ParallelUnique {
+  static bool Compute(const DeviceBase::CpuWorkerThreads& worker_threads,
+                      typename TTypes<T>::ConstFlat Tin,
+                      typename TTypes<TIndex>::Vec idx_vec,
+                      std::vector<int32>* first_indices,
+                      std::vector<int32>* counts) {
+    return false;
+  }
+};
+
+template <typename T, typename TIndex>
+struct ParallelUnique<T, TIndex, true> {
+  // Sets `idx_vec`, the positions in `Tin` of the first occurrence of each
+  // unique element in `*first_indices` and, unless `counts` is null, the
+  // number of occurrences of each unique element in `*counts`.
+  static bool Compute(const DeviceBase::CpuWorkerThreads& worker_threads,
+                      typename TTypes<T>::ConstFlat Tin,
+                      typename TTypes<TIndex>::Vec idx_vec,
+                      std::vector<int32>* first_indices,
+                      std::vector<int32>* counts) {
+    const int32 N = static_cast<int32>(Tin.size());
+    if (N < kParallelUniqueMinSize || worker_threads.num_threads <= 1) {
+      return false;
+    }
+    const int32 num_partitions = worker_threads.num_threads;
+    // The input is split into as many contiguous shards as partitions.
+    const int32 num_shards = num_partitions;
+    const int32 shard_size = (N + num_shards - 1) / num_shards;
+    auto shard_begin = [N, shard_size](int64 s) {
+      return static_cast<int32>(std::min<int64>(N, s * shard_size));
+    };
+    // Runs `fn` for each of `total` units, each a shard or a partition, in
+    // parallel.
+    auto for_each = [&worker_threads, shard_size](
+                        int64 total, const std::function<void(int64)>& fn) {
+      Shard(worker_threads.num_threads, worker_threads.workers, total,
+            /*cost_per_unit=*/100 * static_cast<int64>(shard_size),
+            [&fn](int64 start, int64 limit) {
+              for (int64 unit = start; unit < limit; ++unit) {
+                fn(unit);
+              }
+            });
+    };
+    auto partition = [num_partitions](T value) {
+      // Fibonacci hashing, so that the partitions do not correlate with the
+      // hash of the per-partition maps.
+      const uint64 h = static_cast<uint64>(value) * 0x9E3779B97F4A7C15ull;
+      return static_cast<int32>((h >> 32) % num_partitions);
+    };
+
+    // Scatter the positions of the elements into their partitions, keeping
+    // the positions in each partition in input order.
+    std::vector<int32> histogram(num_shards * num_partitions, 0);
+    for_each(num_shards, [&](int64 s) {
+      int32* shard_histogram = &histogram[s * num_partitions];
+      for (int32 i = shard_begin(s); i < shard_begin(s + 1); ++i) {
+        ++shard_histogram[partition(Tin(i))];
+      }
+    });
+    std::vector<int32> partition_begin(num_partitions + 1);
+    int32 offset = 0;
+    for (int32 p = 0; p < num_partitions; ++p) {
+      partition_begin[p] = offset;
+      for (int32 s = 0; s < num_shards; ++s) {
+        const int32 count = histogram[s * num_partitions + p];
+        histogram[s * num_partitions + p] = offset;
+        offset += count;
+      }
+    }
+    partition_begin[num_partitions] = offset;
+    std::vector<int32> positions(N);
+    for_each(num_shards, [&](int64 s) {
+      int32* shard_offsets = &histogram[s * num_partitions];
+      for (int32 i = shard_begin(s); i < shard_begin(s + 1); ++i) {
+        positions[shard_offsets[partition(Tin(i))]++] = i;
+      }
+    });
+
+    // Make each partition unique, numbering its elements by first
+    // occurrence.
+    std::vector<int32> local_ids(N);
+    std::vector<uint8> is_first(N, 0);
+    std::vector<std::vector<int32>> local_counts(num_partitions);
+    std::vector<std::vector<int32>> local_to_global(num_partitions);
+    for_each(num_partitions, [&](int64 p) {
+      typename UniqueOpHashMap<T, int32>::map_type uniq;
+      uniq.reserve(2 * (partition_begin[p + 1] - partition_begin[p]));
+      std::vector<int32>& partition_counts = local_counts[p];
+      for (int32 k = partition_begin[p]; k < partition_begin[p + 1]; ++k) {
+        const int32 i = positions[k];
+        auto it = uniq.emplace(Tin(i), static_cast<int32>(uniq.size()));
+        local_ids[i] = it.first->second;
+        if (it.second) {
+          is_first[i] = 1;
+          if (counts != nullptr) partition_counts.push_back(0);
+        }
+        if (counts != nullptr) ++partition_counts[it.first->second];
+      }
+      local_to_global[p].resize(uniq.size());
+    });
+
+    // Number the unique elements of all partitions by first occurrence,
+    // with a prefix sum over the shards.
+    std::vector<int32> shard_uniques(num_shards + 1, 0);
+    for_each(num_shards, [&](int64 s) {
+      int32 count = 0;
+      for (int32 i = shard_begin(s); i < shard_begin(s + 1); ++i) {
+        count += is_first[i];
+      }
+      shard_uniques[s + 1] = count;
+    });
+    for (int32 s = 0; s < num_shards; ++s) {
+      shard_uniques[s + 1] += shard_uniques[s];
+    }
+    first_indices->resize(shard_uniques[num_shards]);
+    for_each(num_shards, [&](int64 s) {
+      int32 global_id = shard_uniques[s];
+      for (int32 i = shard_begin(s); i < shard_begin(s + 1); ++i) {
+        if (is_first[i]) {
+          (*first_indices)[global_id] = i;
+          local_to_global[partition(Tin(i))][local_ids[i]] = global_id;
+          ++global_id;
+        }
+      }
+    });
+
+    for_each(num_shards, [&](int64 s) {
+      for (int32 i = shard_begin(s); i < shard_begin(s + 1); ++i) {
+        idx_vec(i) = local_to_global[partition(Tin(i))][local_ids[i]];
+      }
+    });
+    if (counts != nullptr) {
+      counts->resize(first_indices->size());
+      for_each(num_partitions, [&](int64 p) {
+        const int32 num_local = local_counts[p].size();
+        for (int32 l = 0; l < num_local; ++l) {
+          (*counts)[local_to_global[p][l]] = local_counts[p][l];
+        }
+      });
+    }
+    return true;
+  }
+};
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -143,7 +305,28 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64 uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    // The number of occurrences of each unique element, if already counted.
+    std::vector<int32> counts;
+    bool counted = false;
+    std::vector<int32> first_indices;
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        ParallelUnique<T, TIndex>::Compute(
+            *context->device()->tensorflow_cpu_worker_threads(),
+            input.flat<T>(), idx_vec, &first_indices,
+            num_outputs() > 2 ? &counts : nullptr)) {
+      auto Tin = input.flat<T>();
+      counted = num_outputs() > 2;
+      uniq_size = static_cast<int64>(first_indices.size());
+      TensorShape output_shape(input.shape());
+      output_shape.set_dim(axis, uniq_size);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(0, output_shape, &output));
+      auto Tout = output->flat<T>();
+      for (int64 i = 0; i < uniq_size; ++i) {
+        Tout(i) = Tin(first_indices[i]);
+      }
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -230,10 +413,16 @@ class UniqueOp : public OpKernel {
       OP_REQUIRES_OK(context, context->allocate_output(
                                   2, TensorShape({uniq_size}), &output));
       auto count_output_vec = output->template vec<TIndex>();
-      count_output_vec.setZero();
-      const int N = idx_vec.size();
-      for (int64 i = 0; i < N; ++i) {
-        count_output_vec(idx_vec(i))++;
+      if (counted) {
+        for (int64 i = 0; i < uniq_size; ++i) {
+          count_output_vec(i) = counts[i];
+        }
+      } else {
+        count_output_vec.setZero();
+        const int N = idx_vec.size();
+        for (int64 i = 0; i < N; ++i) {
+          count_output_vec(idx_vec(i))++;
+        }
       }
     }
   }
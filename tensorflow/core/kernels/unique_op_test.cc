@@ -13,13 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -37,6 +43,47 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large enough inputs are made unique in parallel, which must give the same
+// results as the sequential implementation.
+TEST_F(UniqueOpTest, LargeInputKeepsOrderOfFirstOccurrence) {
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const int kSize = 1 << 18;
+  std::vector<int64> values(kSize);
+  std::unordered_map<int64, int32> first_ids;
+  std::vector<int64> expected_y;
+  std::vector<int32> expected_idx(kSize);
+  std::vector<int32> expected_count;
+  for (int i = 0; i < kSize; ++i) {
+    values[i] = (static_cast<int64>(i) * 7919) % 5003 - 2500;
+    auto it = first_ids.emplace(values[i], expected_y.size());
+    if (it.second) {
+      expected_y.push_back(values[i]);
+      expected_count.push_back(0);
+    }
+    expected_idx[i] = it.first->second;
+    ++expected_count[it.first->second];
+  }
+  AddInputFromArray<int64>(TensorShape({kSize}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const int64 num_unique = expected_y.size();
+  Tensor y(allocator(), DT_INT64, TensorShape({num_unique}));
+  test::FillValues<int64>(&y, expected_y);
+  test::ExpectTensorEqual<int64>(y, *GetOutput(0));
+  Tensor idx(allocator(), DT_INT32, TensorShape({kSize}));
+  test::FillValues<int32>(&idx, expected_idx);
+  test::ExpectTensorEqual<int32>(idx, *GetOutput(1));
+  Tensor count(allocator(), DT_INT32, TensorShape({num_unique}));
+  test::FillValues<int32>(&count, expected_count);
+  test::ExpectTensorEqual<int32>(count, *GetOutput(2));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
@@ -110,6 +157,40 @@ static void BM_Unique_INT32_Repeat(int iters, int dim, int max_int) {
       .Run(iters);
 }
 
+// Returns ids in [0, max_int) drawn from a power law, like the ids of a
+// recommender, where a few ids make up most of the input.
+Tensor GetSkewedInt64Tensor(int dim, int max_int) {
+  Tensor tensor(DT_INT64, TensorShape({dim}));
+  auto flat = tensor.flat<int64>();
+  for (int i = 0; i < dim; ++i) {
+    const double u = (std::rand() + 1.0) / (RAND_MAX + 2.0);
+    flat(i) = static_cast<int64>(std::pow(max_int, u)) - 1;
+  }
+  return tensor;
+}
+
+static void BM_UniqueWithCounts_INT64_Skewed(int iters, int dim,
+                                             int max_int) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input = GetSkewedInt64Tensor(dim, max_int);
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UniqueWithCounts")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR")
+      .Run(iters);
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -191,6 +272,14 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_UniqueWithCounts_INT64_Skewed)
+    ->ArgPair(1024 * 1024, 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 1024)
+    ->ArgPair(16 * 1024 * 1024, 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 1024 * 1024 * 1024);
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
@@ -0,0 +1,179 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/vnni_gemm.h"
+
+#ifdef __AVX512VNNI__
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace vnni {
+
+#ifdef __AVX512VNNI__
+
+namespace {
+
+// vpdpbusd multiplies groups of four unsigned bytes of the lhs with four
+// signed bytes of the rhs. The quint8 rhs is shifted into int8 by flipping its
+// top bit (b - 128), and the 128 * sum(a) this takes off the products is added
+// back when the result is written, together with the offset terms.
+constexpr int kDepthGroup = 4;   // Depth values summed by one vpdpbusd lane.
+constexpr int kBlockCols = 16;   // int32 lanes in one 512 bit register.
+constexpr int kBlockRows = 4;    // Lhs rows sharing each load of the rhs.
+
+// Returns element (row, col) of a matrix stored with the given layout.
+inline uint8 At(const uint8* data, bool transpose, int ld, int row, int col) {
+  return transpose ? data[col * ld + row] : data[row * ld + col];
+}
+
+// Repacks b as int8 in blocks of kBlockCols columns, each laid out as
+// depth_groups x kBlockCols x kDepthGroup bytes so that one 64 byte load
+// feeds a vpdpbusd. Pads k and n with zeros. Also returns the column sums of
+// the original b.
+void PackRhs(const uint8* b, bool transpose_b, int ldb, int k, int n,
+             int depth_groups, std::vector<int8>* packed,
+             std::vector<int32>* col_sums) {
+  const int col_blocks = (n + kBlockCols - 1) / kBlockCols;
+  packed->assign(col_blocks * depth_groups * kBlockCols * kDepthGroup, 0);
+  col_sums->assign(n, 0);
+  for (int l = 0; l < k; ++l) {
+    const int group = l / kDepthGroup;
+    const int lane = l % kDepthGroup;
+    for (int j = 0; j < n; ++j) {
+      const uint8 value = At(b, transpose_b, ldb, l, j);
+      const int block = j / kBlockCols;
+      const int col = j % kBlockCols;
+      (*packed)[((block * depth_groups + group) * kBlockCols + col) *
+                    kDepthGroup +
+                lane] = static_cast<int8>(value ^ 0x80);
+      (*col_sums)[j] += value;
+    }
+  }
+}
+
+}  // namespace
+
+bool IsSupportedAndEnabled() {
+  static const bool supported =
+      port::TestCPUFeature(port::CPUFeature::AVX512_VNNI);
+  return supported;
+}
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+  const uint8* a = &a_data->value;
+  const uint8* b = &b_data->value;
+  int32* c = &c_data->value;
+  if (m == 0 || n == 0) return;
+
+  const int depth_groups = (k + kDepthGroup - 1) / kDepthGroup;
+  const int col_blocks = (n + kBlockCols - 1) / kBlockCols;
+  std::vector<int8> packed_b;
+  std::vector<int32> col_sums_b;
+  PackRhs(b, transpose_b, ldb, k, n, depth_groups, &packed_b, &col_sums_b);
+  const int32 constant_term = k * offset_a * offset_b;
+
+  auto work = [&](int64 start, int64 limit) {
+    // Each row of the lhs panel holds its depth values packed four to an
+    // int32, ready to be broadcast to every lane.
+    std::vector<int32> panel(kBlockRows * depth_groups);
+    int32 result[kBlockRows][kBlockCols];
+    for (int64 row_block = start; row_block < limit; ++row_block) {
+      const int row_begin = row_block * kBlockRows;
+      const int rows = std::min(kBlockRows, m - row_begin);
+      int32 row_terms[kBlockRows] = {0};
+      std::fill(panel.begin(), panel.end(), 0);
+      uint8* panel_bytes = reinterpret_cast<uint8*>(panel.data());
+      for (int r = 0; r < rows; ++r) {
+        int32 row_sum = 0;
+        for (int l = 0; l < k; ++l) {
+          const uint8 value = At(a, transpose_a, lda, row_begin + r, l);
+          panel_bytes[r * depth_groups * kDepthGroup + l] = value;
+          row_sum += value;
+        }
+        row_terms[r] = (128 + offset_b) * row_sum + constant_term;
+      }
+
+      for (int block = 0; block < col_blocks; ++block) {
+        const int8* rhs =
+            packed_b.data() + block * depth_groups * kBlockCols * kDepthGroup;
+        const int32* lhs = panel.data();
+        __m512i acc0 = _mm512_setzero_si512();
+        __m512i acc1 = _mm512_setzero_si512();
+        __m512i acc2 = _mm512_setzero_si512();
+        __m512i acc3 = _mm512_setzero_si512();
+        for (int g = 0; g < depth_groups; ++g) {
+          const __m512i rhs_group =
+              _mm512_loadu_si512(rhs + g * kBlockCols * kDepthGroup);
+          acc0 = _mm512_dpbusd_epi32(acc0, _mm512_set1_epi32(lhs[g]),
+                                     rhs_group);
+          acc1 = _mm512_dpbusd_epi32(
+              acc1, _mm512_set1_epi32(lhs[depth_groups + g]), rhs_group);
+          acc2 = _mm512_dpbusd_epi32(
+              acc2, _mm512_set1_epi32(lhs[2 * depth_groups + g]), rhs_group);
+          acc3 = _mm512_dpbusd_epi32(
+              acc3, _mm512_set1_epi32(lhs[3 * depth_groups + g]), rhs_group);
+        }
+        _mm512_storeu_si512(result[0], acc0);
+        _mm512_storeu_si512(result[1], acc1);
+        _mm512_storeu_si512(result[2], acc2);
+        _mm512_storeu_si512(result[3], acc3);
+
+        const int col_begin = block * kBlockCols;
+        const int cols = std::min(kBlockCols, n - col_begin);
+        for (int r = 0; r < rows; ++r) {
+          int32* out = c + (row_begin + r) * ldc + col_begin;
+          for (int j = 0; j < cols; ++j) {
+            out[j] = result[r][j] + row_terms[r] +
+                     offset_a * col_sums_b[col_begin + j];
+          }
+        }
+      }
+    }
+  };
+
+  const int64 row_blocks = (m + kBlockRows - 1) / kBlockRows;
+  const int64 cost_per_block = static_cast<int64>(kBlockRows) * n * k;
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, row_blocks,
+        cost_per_block, work);
+}
+
+#else  // __AVX512VNNI__
+
+bool IsSupportedAndEnabled() { return false; }
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+  LOG(FATAL) << "QuantizedGemm: AVX512-VNNI kernels were not compiled in.";
+}
+
+#endif  // __AVX512VNNI__
+
+}  // namespace vnni
+}  // namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_VNNI_GEMM_H_
+#define TENSORFLOW_CORE_KERNELS_VNNI_GEMM_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace vnni {
+
+// Eight-bit matrix multiplication on x86 CPUs with AVX512-VNNI, which
+// computes four u8 x s8 products and accumulates them into int32 in a single
+// instruction (vpdpbusd). The kernels are only compiled in when the build
+// targets VNNI (e.g. -mavx512vnni or -march=cascadelake).
+
+// Returns true if the binary was built with VNNI support and the current CPU
+// has it. Use this call before calling QuantizedGemm; if the codepath is not
+// supported, QuantizedGemm logs a FATAL error.
+bool IsSupportedAndEnabled();
+
+// Calculates the quantized matrix multiplication, with the same semantics as
+// meta::QuantizedGemm:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] + offset_a) * (b_data[l, j] + offset_b)) : l in [0, k)
+//
+// If transpose_a is false the lhs operand has row major layout, otherwise
+// column major. Similarly transpose_b describes the layout of the rhs operand.
+// lda, ldb, and ldc are the strides of the lhs operand, rhs operand and the
+// result arrays. The int32 accumulators do not overflow for k < 65536.
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc);
+
+}  // namespace vnni
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_VNNI_GEMM_H_
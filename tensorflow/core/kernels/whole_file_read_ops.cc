@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/reader_base.pb.h"
 #include "tensorflow/core/framework/reader_op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/blocking_io_op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -97,10 +98,10 @@ REGISTER_KERNEL_BUILDER(Name("WholeFileReader").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("WholeFileReaderV2").Device(DEVICE_CPU),
                         WholeFileReaderOp);
 
-class ReadFileOp : public OpKernel {
+class ReadFileOp : public BlockingIOOpKernel {
  public:
-  using OpKernel::OpKernel;
-  void Compute(OpKernelContext* context) override {
+  using BlockingIOOpKernel::BlockingIOOpKernel;
+  void ComputeBlocking(OpKernelContext* context) override {
     const Tensor* input;
     OP_REQUIRES_OK(context, context->input("filename", &input));
     OP_REQUIRES(context, TensorShapeUtils::IsScalar(input->shape()),
@@ -119,10 +120,10 @@ class ReadFileOp : public OpKernel {
 
 REGISTER_KERNEL_BUILDER(Name("ReadFile").Device(DEVICE_CPU), ReadFileOp);
 
-class WriteFileOp : public OpKernel {
+class WriteFileOp : public BlockingIOOpKernel {
  public:
-  using OpKernel::OpKernel;
-  void Compute(OpKernelContext* context) override {
+  using BlockingIOOpKernel::BlockingIOOpKernel;
+  void ComputeBlocking(OpKernelContext* context) override {
     const Tensor* filename_input;
     const Tensor* contents_input;
     OP_REQUIRES_OK(context, context->input("filename", &filename_input));
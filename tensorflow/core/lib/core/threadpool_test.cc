@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 
 #include <atomic>
+#include <vector>
 
 #include "absl/synchronization/barrier.h"
 #include "absl/synchronization/blocking_counter.h"
@@ -314,6 +315,36 @@ TEST(ThreadPool, ParallelForWithAdaptiveSchedulingStrategy) {
   }
 }
 
+TEST(ThreadPool, ParallelForWithMeasuredCostSchedulingStrategy) {
+  Context outer_context(ContextKind::kThread);
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads += 7) {
+    fprintf(stderr, "Testing with %d threads\n", num_threads);
+    ThreadPool pool(Env::Default(), "test", num_threads);
+    for (int work_items : {0, 1, 7, 1000, 100000}) {
+      std::vector<std::atomic<bool>> work(work_items);
+      for (int i = 0; i < work_items; i++) {
+        work[i] = false;
+      }
+      pool.ParallelFor(
+          work_items,
+          ThreadPool::SchedulingParams(
+              ThreadPool::SchedulingStrategy::kMeasuredCost /* strategy */,
+              absl::nullopt /* cost_per_unit */,
+              absl::nullopt /* block_size */),
+          [&outer_context, &work](int64 begin, int64 end) {
+            Context inner_context(ContextKind::kThread);
+            ASSERT_EQ(outer_context, inner_context);
+            for (int64 i = begin; i < end; ++i) {
+              ASSERT_FALSE(work[i].exchange(true));
+            }
+          });
+      for (int i = 0; i < work_items; i++) {
+        ASSERT_TRUE(work[i]);
+      }
+    }
+  }
+}
+
 TEST(ThreadPool, ParallelForWithWorkerId) {
   // Make ParallelForWithWorkerId use as many threads as possible.
   int64 kHugeCost = 1 << 30;
@@ -19,8 +19,11 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -702,6 +705,56 @@ TEST(FlatMap, UniqueMapIter) {
   EXPECT_EQ(val_sum, key_sum + (kCount * kValueDelta));
 }
 
+// Benchmarks FlatMap against absl::flat_hash_map with the access patterns of
+// the runtime tables: short-lived entries keyed by a 64-bit hash, and lookups
+// of keys that are mostly present.
+uint64 BenchmarkKey(int64 i) { return Hash64Combine(i, 0x9e3779b97f4a7c15ull); }
+
+// Keeps a sliding window of `num_keys` live entries.
+template <typename Map>
+void BenchmarkInsertErase(int iters, int num_keys) {
+  Map map;
+  for (int i = 0; i < iters; ++i) {
+    map[BenchmarkKey(i)] = i;
+    if (i >= num_keys) map.erase(BenchmarkKey(i - num_keys));
+  }
+}
+
+template <typename Map>
+void BenchmarkLookup(int iters, int num_keys) {
+  Map map;
+  for (int i = 0; i < num_keys; ++i) {
+    map[BenchmarkKey(i)] = i;
+  }
+  int64 sum = 0;
+  for (int i = 0; i < iters; ++i) {
+    // About one lookup in nine misses.
+    auto it = map.find(BenchmarkKey(i % (num_keys + num_keys / 8)));
+    if (it != map.end()) sum += it->second;
+  }
+  testing::DoNotOptimize(sum);
+}
+
+static void BM_FlatMap_InsertErase(int iters, int num_keys) {
+  BenchmarkInsertErase<FlatMap<uint64, int64>>(iters, num_keys);
+}
+BENCHMARK(BM_FlatMap_InsertErase)->Arg(16)->Arg(1024)->Arg(65536);
+
+static void BM_AbslFlatHashMap_InsertErase(int iters, int num_keys) {
+  BenchmarkInsertErase<absl::flat_hash_map<uint64, int64>>(iters, num_keys);
+}
+BENCHMARK(BM_AbslFlatHashMap_InsertErase)->Arg(16)->Arg(1024)->Arg(65536);
+
+static void BM_FlatMap_Lookup(int iters, int num_keys) {
+  BenchmarkLookup<FlatMap<uint64, int64>>(iters, num_keys);
+}
+BENCHMARK(BM_FlatMap_Lookup)->Arg(16)->Arg(1024)->Arg(65536);
+
+static void BM_AbslFlatHashMap_Lookup(int iters, int num_keys) {
+  BenchmarkLookup<absl::flat_hash_map<uint64, int64>>(iters, num_keys);
+}
+BENCHMARK(BM_AbslFlatHashMap_Lookup)->Arg(16)->Arg(1024)->Arg(65536);
+
 }  // namespace
 }  // namespace gtl
 }  // namespace tensorflow
@@ -19,6 +19,10 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/crc32c.h"
 
 #include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/coding.h"
 
 namespace tensorflow {
@@ -263,6 +267,17 @@ uint32 Extend(uint32 crc, const char *buf, size_t size) {
   return l ^ 0xffffffffu;
 }
 
+uint32 CopyAndExtend(uint32 crc, const char *buf, size_t size, char *dst) {
+  // Small enough for a chunk to still be in the L1 cache when checksummed.
+  constexpr size_t kChunkSize = 16 * 1024;
+  for (size_t i = 0; i < size; i += kChunkSize) {
+    const size_t n = std::min(kChunkSize, size - i);
+    memcpy(dst + i, buf + i, n);
+    crc = Extend(crc, dst + i, n);
+  }
+  return crc;
+}
+
 #if defined(PLATFORM_GOOGLE)
 uint32 Extend(uint32 crc, const absl::Cord &cord) {
   for (absl::string_view fragment : cord.Chunks()) {
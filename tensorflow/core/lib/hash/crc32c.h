@@ -35,6 +35,13 @@ extern uint32 Extend(uint32 init_crc, const char* data, size_t n);
 // Return the crc32c of data[0,n-1]
 inline uint32 Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Copy data[0,n-1] to dst[0,n-1], and return the crc32c of
+// concat(A, dst[0,n-1]) where init_crc is the crc32c of some string A. The
+// checksum is computed on the copied bytes, while they are still in cache,
+// which is faster than a memcpy() followed by Extend() for large buffers.
+extern uint32 CopyAndExtend(uint32 init_crc, const char* data, size_t n,
+                            char* dst);
+
 #if defined(PLATFORM_GOOGLE)
 extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 inline uint32 Value(const absl::Cord& cord) { return Extend(0, cord); }
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
-// SSE4.2 accelerated CRC32c.
+// Hardware accelerated CRC32c, with the SSE4.2 crc32 instructions on x86-64,
+// or the ARMv8 CRC32 extension on AArch64.
 
 // See if the SSE4.2 crc32c instruction is available.
 #undef USE_SSE_CRC32C
@@ -37,14 +39,27 @@ limitations under the License.
 #undef USE_SSE_CRC32C
 #endif
 
+// See if the ARMv8 crc32c instructions are available, and can be detected at
+// runtime. They are enabled at compile time by -march=armv8-a+crc.
+#undef USE_ARM_CRC32C
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32) && defined(__linux__)
+#define USE_ARM_CRC32C 1
+#endif
+
 #ifdef USE_SSE_CRC32C
 #include <nmmintrin.h>
 #endif
 
+#ifdef USE_ARM_CRC32C
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
 namespace tensorflow {
 namespace crc32c {
 
-#ifndef USE_SSE_CRC32C
+#if !defined(USE_SSE_CRC32C) && !defined(USE_ARM_CRC32C)
 
 bool CanAccelerate() { return false; }
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
@@ -54,10 +69,137 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
 
 #else
 
+#if defined(USE_SSE_CRC32C)
+
 // SSE4.2 optimized crc32c computation.
 bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
 
+static inline uint32_t CrcByte(uint32_t crc, uint8_t v) {
+  return _mm_crc32_u8(crc, v);
+}
+static inline uint32_t CrcWord(uint32_t crc, uint64_t v) {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+}
+
+#else  // USE_ARM_CRC32C
+
+// ARMv8 optimized crc32c computation.
+bool CanAccelerate() { return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0; }
+
+static inline uint32_t CrcByte(uint32_t crc, uint8_t v) {
+  return __crc32cb(crc, v);
+}
+static inline uint32_t CrcWord(uint32_t crc, uint64_t v) {
+  return __crc32cd(crc, v);
+}
+
+#endif
+
+static inline uint64_t Load64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// The crc32 instructions have a latency of 3 cycles, but a throughput of one
+// per cycle. Large buffers are thus checksummed as three interleaved streams
+// of kLongBlock (or kShortBlock) bytes, whose CRCs are then combined. Combining
+// the CRC of a stream A with the one of the next stream B of `len` bytes is
+// CRC(A) * x^(8 * len) + CRC(B) in GF(2), where the multiplication by
+// x^(8 * len) is the same as extending CRC(A) with `len` zero bytes. That
+// linear operator is precomputed into ShiftTables of 4 x 256 entries.
+constexpr size_t kLongBlock = 8192;
+constexpr size_t kShortBlock = 256;
+constexpr uint32_t kPoly = 0x82f63b78;  // Reflected CRC32c polynomial.
+
+struct ShiftTable {
+  uint32_t table[4][256];
+};
+
+// Returns the product of the 32x32 GF(2) matrix `mat` and the vector `vec`.
+static uint32_t MatrixTimes(const uint32_t *mat, uint32_t vec) {
+  uint32_t sum = 0;
+  for (; vec != 0; vec >>= 1, ++mat) {
+    if (vec & 1) sum ^= *mat;
+  }
+  return sum;
+}
+
+static void MatrixSquare(uint32_t *square, const uint32_t *mat) {
+  for (int n = 0; n < 32; ++n) {
+    square[n] = MatrixTimes(mat, mat[n]);
+  }
+}
+
+// Builds the table extending a CRC with `len` zero bytes, for a power of two
+// `len`.
+static void MakeShiftTable(size_t len, ShiftTable *shift) {
+  uint32_t even[32];  // Operator for an even power of two zero bits.
+  uint32_t odd[32];   // Operator for an odd power of two zero bits.
+  // The operator for one zero bit.
+  odd[0] = kPoly;
+  for (int n = 1; n < 32; ++n) {
+    odd[n] = 1u << (n - 1);
+  }
+  MatrixSquare(even, odd);  // Two zero bits.
+  MatrixSquare(odd, even);  // Four zero bits.
+  // Squares up to one zero byte in even, then two in odd, and so on.
+  const uint32_t *op;
+  while (true) {
+    MatrixSquare(even, odd);
+    len >>= 1;
+    if (len == 0) {
+      op = even;
+      break;
+    }
+    MatrixSquare(odd, even);
+    len >>= 1;
+    if (len == 0) {
+      op = odd;
+      break;
+    }
+  }
+  for (uint32_t n = 0; n < 256; ++n) {
+    shift->table[0][n] = MatrixTimes(op, n);
+    shift->table[1][n] = MatrixTimes(op, n << 8);
+    shift->table[2][n] = MatrixTimes(op, n << 16);
+    shift->table[3][n] = MatrixTimes(op, n << 24);
+  }
+}
+
+static inline uint32_t Shift(const ShiftTable &shift, uint32_t crc) {
+  return shift.table[0][crc & 0xff] ^ shift.table[1][(crc >> 8) & 0xff] ^
+         shift.table[2][(crc >> 16) & 0xff] ^ shift.table[3][crc >> 24];
+}
+
+// Checksums the streams [p, p + block), [p + block, p + 2 * block) and
+// [p + 2 * block, p + 3 * block) in parallel, and combines them into `crc`.
+static inline uint32_t Extend3Way(uint32_t crc, const uint8_t *p, size_t block,
+                                  const ShiftTable &shift) {
+  uint32_t crc1 = 0;
+  uint32_t crc2 = 0;
+  const uint8_t *e = p + block;
+  for (; p < e; p += 8) {
+    crc = CrcWord(crc, Load64(p));
+    crc1 = CrcWord(crc1, Load64(p + block));
+    crc2 = CrcWord(crc2, Load64(p + 2 * block));
+  }
+  crc = Shift(shift, crc) ^ crc1;
+  return Shift(shift, crc) ^ crc2;
+}
+
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
+  static const ShiftTable *long_shift = [] {
+    ShiftTable *shift = new ShiftTable;
+    MakeShiftTable(kLongBlock, shift);
+    return shift;
+  }();
+  static const ShiftTable *short_shift = [] {
+    ShiftTable *shift = new ShiftTable;
+    MakeShiftTable(kShortBlock, shift);
+    return shift;
+  }();
+
   const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
   const uint8_t *e = p + size;
   uint32_t l = crc ^ 0xffffffffu;
@@ -70,23 +212,31 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
   if (x <= e) {
     // Process bytes until finished or p is 8-byte aligned
     while (p != x) {
-      l = _mm_crc32_u8(l, *p);
+      l = CrcByte(l, *p);
       p++;
     }
   }
 
+  // Process large buffers as three interleaved streams.
+  while (static_cast<size_t>(e - p) >= 3 * kLongBlock) {
+    l = Extend3Way(l, p, kLongBlock, *long_shift);
+    p += 3 * kLongBlock;
+  }
+  while (static_cast<size_t>(e - p) >= 3 * kShortBlock) {
+    l = Extend3Way(l, p, kShortBlock, *short_shift);
+    p += 3 * kShortBlock;
+  }
+
   // Process bytes 16 at a time
-  uint64_t l64 = l;
   while ((e - p) >= 16) {
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p));
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p + 8));
+    l = CrcWord(l, Load64(p));
+    l = CrcWord(l, Load64(p + 8));
     p += 16;
   }
 
   // Process remaining bytes one at a time.
-  l = l64;
   while (p < e) {
-    l = _mm_crc32_u8(l, *p);
+    l = CrcByte(l, *p);
     p++;
   }
 
@@ -62,6 +62,47 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+// A bitwise crc32c, to check the table-driven and accelerated versions.
+uint32 ReferenceExtend(uint32 crc, const char* data, size_t n) {
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc ^= static_cast<uint8>(data[i]);
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+TEST(CRC, LargeBuffers) {
+  // Covers the lengths around the interleaved blocks of the accelerated
+  // version, at all alignments.
+  std::string data(100000, 0);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 7919 + (i >> 8));
+  }
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t n : {767, 768, 769, 1000, 24575, 24576, 24577, 50000, 99990}) {
+      ASSERT_EQ(ReferenceExtend(0x12345678, data.data() + offset, n),
+                Extend(0x12345678, data.data() + offset, n))
+          << "offset " << offset << " n " << n;
+    }
+  }
+}
+
+TEST(CRC, CopyAndExtend) {
+  std::string data(100000, 0);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 31);
+  }
+  for (size_t n : {0, 1, 100, 16384, 16385, 100000}) {
+    std::string dst(n, 0);
+    ASSERT_EQ(Extend(42, data.data(), n),
+              CopyAndExtend(42, data.data(), n, &dst[0]));
+    ASSERT_EQ(data.substr(0, n), dst);
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -92,5 +133,30 @@ static void BM_CRC(int iters, int len) {
 }
 BENCHMARK(BM_CRC)->Range(1, 256 * 1024);
 
+static void BM_CopyThenExtend(int iters, int len) {
+  std::string input(len, 'x');
+  std::string output(len, 0);
+  uint32 h = 0;
+  for (int i = 0; i < iters; i++) {
+    memcpy(&output[0], input.data(), len);
+    h = Extend(h, output.data(), len);
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * len);
+  VLOG(1) << h;
+}
+BENCHMARK(BM_CopyThenExtend)->Range(1024, 16 * 1024 * 1024);
+
+static void BM_CopyAndExtend(int iters, int len) {
+  std::string input(len, 'x');
+  std::string output(len, 0);
+  uint32 h = 0;
+  for (int i = 0; i < iters; i++) {
+    h = CopyAndExtend(h, input.data(), len, &output[0]);
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * len);
+  VLOG(1) << h;
+}
+BENCHMARK(BM_CopyAndExtend)->Range(1024, 16 * 1024 * 1024);
+
 }  // namespace crc32c
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include <float.h>
 #include <math.h>
+
+#include <algorithm>
 #include <vector>
 #include "tensorflow/core/framework/summary.pb.h"
 
@@ -113,6 +115,20 @@ void Histogram::Add(double value) {
   sum_squares_ += (value * value);
 }
 
+void Histogram::Merge(const Histogram& other) {
+  DCHECK(std::equal(bucket_limits_.begin(), bucket_limits_.end(),
+                    other.bucket_limits_.begin(), other.bucket_limits_.end()));
+  if (other.num_ == 0) return;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  if (min_ > other.min_) min_ = other.min_;
+  if (max_ < other.max_) max_ = other.max_;
+  num_ += other.num_;
+  sum_ += other.sum_;
+  sum_squares_ += other.sum_squares_;
+}
+
 double Histogram::Median() const { return Percentile(50.0); }
 
 // Linearly map the variable x from [x0, x1] unto [y0, y1]
@@ -244,6 +260,11 @@ void ThreadSafeHistogram::Add(double value) {
   histogram_.Add(value);
 }
 
+void ThreadSafeHistogram::Merge(const Histogram& other) {
+  mutex_lock l(mu_);
+  histogram_.Merge(other);
+}
+
 void ThreadSafeHistogram::EncodeToProto(HistogramProto* proto,
                                         bool preserve_zero_buckets) const {
   mutex_lock l(mu_);
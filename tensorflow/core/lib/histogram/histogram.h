@@ -54,6 +54,10 @@ class Histogram {
   void Clear();
   void Add(double value);
 
+  // Adds the values of "other" to this histogram.
+  // REQUIRES: "other" has the same bucket boundaries as this histogram.
+  void Merge(const Histogram& other);
+
   // Save the current state of the histogram to "*proto".  If
   // "preserve_zero_buckets" is false, only non-zero bucket values and
   // ranges are saved, and the bucket boundaries of zero-valued buckets
@@ -120,6 +124,7 @@ class ThreadSafeHistogram {
   // TODO(touts): It might be a good idea to provide a AddN(<many values>)
   // method to avoid grabbing/releasing the lock when adding many values.
   void Add(double value);
+  void Merge(const Histogram& other);
 
   void EncodeToProto(HistogramProto* proto, bool preserve_zero_buckets) const;
   double Median() const;
@@ -112,6 +112,24 @@ TEST(Histogram, Basic) {
   Validate(h);
 }
 
+TEST(Histogram, Merge) {
+  Histogram all({0, 10, 100, DBL_MAX});
+  Histogram h1({0, 10, 100, DBL_MAX});
+  Histogram h2({0, 10, 100, DBL_MAX});
+  for (int i = 0; i < 50; i++) {
+    h1.Add(i * 3);
+    all.Add(i * 3);
+  }
+  for (int i = 0; i < 20; i++) {
+    h2.Add(-i);
+    all.Add(-i);
+  }
+  h1.Merge(h2);
+  h1.Merge(Histogram({0, 10, 100, DBL_MAX}));
+  EXPECT_EQ(h1.ToString(), all.ToString());
+  Validate(h1);
+}
+
 TEST(ThreadSafeHistogram, Basic) {
   // Fill a normal histogram.
   Histogram h;
@@ -0,0 +1,246 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/parallel_record_reader.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+
+/* static */ constexpr uint64 ParallelRecordReader::kNoRecord;
+
+ParallelRecordReader::ParallelRecordReader(Env* env, RandomAccessFile* file,
+                                           uint64 file_size, uint64 offset,
+                                           const Options& options)
+    : file_(file),
+      file_size_(file_size),
+      options_(options),
+      offset_(offset),
+      next_range_start_(offset) {
+  DCHECK_GT(options_.num_parallel_reads, 0);
+  DCHECK_GT(options_.range_size, 0);
+  thread_pool_ = absl::make_unique<thread::ThreadPool>(
+      env, "tf_record_parallel_read", options_.num_parallel_reads);
+  ScheduleRanges();
+}
+
+ParallelRecordReader::~ParallelRecordReader() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+  // Waits for the fetches that have already started.
+  thread_pool_.reset();
+}
+
+void ParallelRecordReader::ScheduleRanges() {
+  const size_t read_ahead = options_.read_ahead > 0
+                                ? options_.read_ahead
+                                : 2 * options_.num_parallel_reads;
+  while (ranges_.size() < read_ahead && next_range_start_ < file_size_) {
+    auto range = std::make_shared<Range>();
+    range->start = next_range_start_;
+    range->end = std::min<uint64>(file_size_,
+                                  next_range_start_ + options_.range_size);
+    // `offset_` is always a record boundary.
+    range->at_boundary = range->start == offset_;
+    next_range_start_ = range->end;
+    ranges_.push_back(range);
+    thread_pool_->Schedule([this, range]() {
+      {
+        mutex_lock l(mu_);
+        if (cancelled_) return;
+      }
+      FetchRange(range.get());
+      mutex_lock l(mu_);
+      range->done = true;
+      cond_var_.notify_all();
+    });
+  }
+}
+
+void ParallelRecordReader::FetchRange(Range* range) {
+  Chunk chunk;
+  Status s = ReadChunk(range->start, range->end, &chunk);
+  uint64 first_offset = kNoRecord;
+  if (s.ok()) {
+    if (range->at_boundary) {
+      first_offset = range->start;
+    } else {
+      for (uint64 offset = range->start; offset < range->end; ++offset) {
+        if (IsRecordAt(chunk, offset)) {
+          first_offset = offset;
+          break;
+        }
+      }
+    }
+    if (first_offset != kNoRecord) {
+      s = ReadRecords(chunk, first_offset, range->end, &range->records);
+    }
+  }
+  range->first_offset = first_offset;
+  range->status = s;
+}
+
+Status ParallelRecordReader::ReadChunk(uint64 start, uint64 end, Chunk* chunk) {
+  chunk->start = start;
+  chunk->data.resize(end - start);
+  StringPiece result;
+  Status s = file_->Read(start, end - start, &result, &chunk->data[0]);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (result.data() != chunk->data.data()) {
+    // The file did not use the scratch space.
+    chunk->data.assign(result.data(), result.size());
+  } else {
+    chunk->data.resize(result.size());
+  }
+  return Status::OK();
+}
+
+Status ParallelRecordReader::ReadChecksummed(const Chunk& chunk, uint64 offset,
+                                             size_t n, tstring* result) {
+  if (n >= SIZE_MAX - sizeof(uint32)) {
+    return errors::DataLoss("record size too large");
+  }
+  const size_t expected = n + sizeof(uint32);
+  const char* data;
+  if (offset >= chunk.start &&
+      offset - chunk.start + expected <= chunk.data.size()) {
+    data = chunk.data.data() + (offset - chunk.start);
+  } else {
+    // The bytes extend past the chunk.
+    if (offset >= file_size_) {
+      return errors::OutOfRange("eof");
+    }
+    result->resize_uninitialized(expected);
+    StringPiece read;
+    Status s = file_->Read(offset, expected, &read, &(*result)[0]);
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      return s;
+    }
+    if (read.size() != expected) {
+      return errors::DataLoss("truncated record at ", offset);
+    }
+    data = read.data();
+  }
+  const uint32 masked_crc = core::DecodeFixed32(data + n);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data, n)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  if (data == result->data()) {
+    result->resize(n);
+  } else {
+    result->assign(data, n);
+  }
+  return Status::OK();
+}
+
+bool ParallelRecordReader::IsRecordAt(const Chunk& chunk, uint64 offset) {
+  // Checking the length first rejects almost all offsets cheaply.
+  if (offset < chunk.start ||
+      offset - chunk.start + RecordReader::kHeaderSize > chunk.data.size()) {
+    return false;
+  }
+  const char* header = chunk.data.data() + (offset - chunk.start);
+  const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+    return false;
+  }
+  const uint64 length = core::DecodeFixed64(header);
+  if (length > file_size_ - offset - RecordReader::kHeaderSize) {
+    return false;
+  }
+  tstring data;
+  return ReadChecksummed(chunk, offset + RecordReader::kHeaderSize, length,
+                         &data)
+      .ok();
+}
+
+Status ParallelRecordReader::ReadRecords(const Chunk& chunk, uint64 offset,
+                                         uint64 end,
+                                         std::vector<tstring>* records) {
+  tstring header;
+  while (offset < end) {
+    TF_RETURN_IF_ERROR(ReadChecksummed(chunk, offset, sizeof(uint64), &header));
+    const uint64 length = core::DecodeFixed64(header.data());
+    records->emplace_back();
+    Status s = ReadChecksummed(chunk, offset + RecordReader::kHeaderSize,
+                               length, &records->back());
+    if (!s.ok()) {
+      records->pop_back();
+      if (errors::IsOutOfRange(s)) {
+        s = errors::DataLoss("truncated record at ", offset);
+      }
+      return s;
+    }
+    offset += RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+  }
+  return Status::OK();
+}
+
+Status ParallelRecordReader::ReadRecord(tstring* record) {
+  while (true) {
+    if (current_ && index_ < current_->records.size()) {
+      *record = std::move(current_->records[index_++]);
+      offset_ +=
+          RecordReader::kHeaderSize + record->size() + RecordReader::kFooterSize;
+      return Status::OK();
+    }
+    current_.reset();
+    if (ranges_.empty()) {
+      return errors::OutOfRange("eof");
+    }
+    std::shared_ptr<Range> range = ranges_.front();
+    ranges_.pop_front();
+    {
+      mutex_lock l(mu_);
+      while (!range->done) {
+        cond_var_.wait(l);
+      }
+    }
+    if (range->end <= offset_) {
+      // The range is covered by a record that started in an earlier range.
+      ScheduleRanges();
+      continue;
+    }
+    if (!range->status.ok() || range->first_offset != offset_) {
+      // The fetch did not resynchronize on the record that follows the
+      // records returned so far, so read the range again from that record.
+      VLOG(3) << "Rereading the records in [" << offset_ << ", " << range->end
+              << ") sequentially.";
+      range->records.clear();
+      Chunk chunk;
+      TF_RETURN_IF_ERROR(ReadChunk(offset_, range->end, &chunk));
+      TF_RETURN_IF_ERROR(
+          ReadRecords(chunk, offset_, range->end, &range->records));
+    }
+    current_ = std::move(range);
+    index_ = 0;
+    ScheduleRanges();
+  }
+}
+
+}  // namespace io
+}  // namespace tensorflow
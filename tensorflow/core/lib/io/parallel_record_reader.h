@@ -0,0 +1,157 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_PARALLEL_RECORD_READER_H_
+#define TENSORFLOW_CORE_LIB_IO_PARALLEL_RECORD_READER_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+class RandomAccessFile;
+
+namespace io {
+
+// Reads the records of an uncompressed TFRecord file in order, while fetching
+// several byte ranges of the file concurrently.
+//
+// This hides the per-request latency of remote file systems, which makes
+// strictly sequential reads slow. Each range is fetched on its own thread with
+// `RandomAccessFile::Read()`. Since a range generally does not start at a
+// record boundary, the fetch resynchronizes on the first offset that holds a
+// valid record (a length and data whose checksums match), and returns the
+// records starting in the range. The records are returned in file order: if
+// the resynchronization of a range did not find the record that follows the
+// records of the previous range (e.g. because the data of a record contains a
+// valid record), the range is read again sequentially from the right offset.
+//
+// Note: this class is not thread safe; external synchronization required.
+class ParallelRecordReader {
+ public:
+  struct Options {
+    // The number of ranges fetched concurrently.
+    int num_parallel_reads = 4;
+
+    // The size of each range, in bytes.
+    int64 range_size = 4 << 20;
+
+    // The maximum number of ranges that are fetched ahead of the range being
+    // consumed. If zero, `2 * num_parallel_reads` is used.
+    int read_ahead = 0;
+  };
+
+  // Create a reader that will return the records of "*file", which is
+  // `file_size` bytes long, starting with the record at `offset`.
+  // "*file" must remain live while this reader is in use.
+  ParallelRecordReader(Env* env, RandomAccessFile* file, uint64 file_size,
+                       uint64 offset, const Options& options);
+
+  // Waits for the outstanding fetches to finish.
+  ~ParallelRecordReader();
+
+  // Read the next record in the file into *record. Returns OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  Status ReadRecord(tstring* record);
+
+  // Return the offset of the next record returned by `ReadRecord()`.
+  uint64 TellOffset() const { return offset_; }
+
+ private:
+  // A byte range of the file, and the records that start in it.
+  struct Range {
+    uint64 start;
+    uint64 end;
+    // Whether `start` is known to be a record boundary.
+    bool at_boundary;
+
+    // Set once the range has been fetched.
+    bool done = false;
+    Status status;
+    // The offset of the first record found in the range, or `kNoRecord`.
+    uint64 first_offset;
+    std::vector<tstring> records;
+  };
+
+  static constexpr uint64 kNoRecord = ~uint64{0};
+
+  // The bytes of the file that were read with a single request.
+  struct Chunk {
+    uint64 start = 0;
+    string data;
+  };
+
+  // Schedules fetches until `read_ahead` ranges are outstanding.
+  void ScheduleRanges();
+
+  // Fetches `range`, resynchronizing on the first record in it unless it
+  // starts at a record boundary.
+  void FetchRange(Range* range);
+
+  // Reads the bytes in [start, end) into `chunk`.
+  Status ReadChunk(uint64 start, uint64 end, Chunk* chunk);
+
+  // Reads the records that start in [offset, end), using `chunk` for the bytes
+  // that it holds.
+  Status ReadRecords(const Chunk& chunk, uint64 offset, uint64 end,
+                     std::vector<tstring>* records);
+
+  // Returns true if a valid record starts at `offset`.
+  bool IsRecordAt(const Chunk& chunk, uint64 offset);
+
+  // Reads the `n` bytes at `offset` into *result, and checks that they are
+  // followed by their masked CRC.
+  Status ReadChecksummed(const Chunk& chunk, uint64 offset, size_t n,
+                         tstring* result);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const uint64 file_size_;
+  const Options options_;
+
+  // The offset of the next record returned by `ReadRecord()`.
+  uint64 offset_;
+
+  // The range being consumed, and the index of its next record.
+  std::shared_ptr<Range> current_;
+  size_t index_ = 0;
+
+  // The start of the next range to fetch.
+  uint64 next_range_start_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // The fetched or outstanding ranges, in file order.
+  std::deque<std::shared_ptr<Range>> ranges_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_PARALLEL_RECORD_READER_H_
@@ -0,0 +1,159 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/parallel_record_reader.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Writes `records` to `fname`, and returns the offset of each record.
+std::vector<uint64> WriteRecords(const string& fname,
+                                 const std::vector<string>& records) {
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+  RecordWriter writer(file.get());
+  std::vector<uint64> offsets;
+  uint64 offset = 0;
+  for (const string& record : records) {
+    offsets.push_back(offset);
+    TF_CHECK_OK(writer.WriteRecord(record));
+    offset += RecordReader::kHeaderSize + record.size() +
+              RecordReader::kFooterSize;
+  }
+  TF_CHECK_OK(writer.Close());
+  return offsets;
+}
+
+// Reads the records of `fname` starting at `offset` with a
+// `ParallelRecordReader`, and checks that they are `expected`.
+void CheckRecords(const string& fname, uint64 offset,
+                  const ParallelRecordReader::Options& options,
+                  const std::vector<string>& expected) {
+  Env* env = Env::Default();
+  uint64 file_size;
+  TF_CHECK_OK(env->GetFileSize(fname, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  ParallelRecordReader reader(env, file.get(), file_size, offset, options);
+  tstring record;
+  for (const string& value : expected) {
+    TF_ASSERT_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(value, record);
+  }
+  EXPECT_EQ(file_size, reader.TellOffset());
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
+std::vector<string> RandomRecords(int num_records) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<string> records;
+  for (int i = 0; i < num_records; ++i) {
+    // Include a few records that span many ranges.
+    const int size = rnd.OneIn(10) ? rnd.Uniform(1000) : rnd.Uniform(50);
+    string record(size, '\0');
+    for (char& c : record) {
+      c = static_cast<char>(rnd.Uniform(256));
+    }
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+TEST(ParallelRecordReaderTest, ReadsRecordsInOrder) {
+  const string fname = testing::TmpDir() + "/parallel_record_reader_test";
+  const std::vector<string> records = RandomRecords(500);
+  WriteRecords(fname, records);
+  for (int num_parallel_reads : {1, 2, 8}) {
+    for (int64 range_size : {1, 7, 64, 1000, 1 << 20}) {
+      ParallelRecordReader::Options options;
+      options.num_parallel_reads = num_parallel_reads;
+      options.range_size = range_size;
+      CheckRecords(fname, 0, options, records);
+    }
+  }
+}
+
+TEST(ParallelRecordReaderTest, StartsAtOffset) {
+  const string fname = testing::TmpDir() + "/parallel_record_reader_test";
+  const std::vector<string> records = RandomRecords(100);
+  const std::vector<uint64> offsets = WriteRecords(fname, records);
+  ParallelRecordReader::Options options;
+  options.range_size = 100;
+  for (int i : {1, 50, 99}) {
+    CheckRecords(fname, offsets[i], options,
+                 std::vector<string>(records.begin() + i, records.end()));
+  }
+}
+
+TEST(ParallelRecordReaderTest, RecordsContainingRecords) {
+  // The data of each record is itself a valid TFRecord file, so that ranges
+  // starting inside a record resynchronize on a record that does not exist.
+  const string inner_fname =
+      testing::TmpDir() + "/parallel_record_reader_inner_test";
+  WriteRecords(inner_fname, {"abc", "defgh", string(100, 'x')});
+  string inner;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), inner_fname, &inner));
+
+  const string fname = testing::TmpDir() + "/parallel_record_reader_test";
+  std::vector<string> records;
+  for (int i = 0; i < 20; ++i) {
+    records.push_back(inner);
+    records.push_back(string(i, 'y'));
+  }
+  WriteRecords(fname, records);
+  for (int64 range_size : {3, 17, 100}) {
+    ParallelRecordReader::Options options;
+    options.range_size = range_size;
+    CheckRecords(fname, 0, options, records);
+  }
+}
+
+TEST(ParallelRecordReaderTest, CorruptedRecord) {
+  const string fname = testing::TmpDir() + "/parallel_record_reader_test";
+  const std::vector<uint64> offsets =
+      WriteRecords(fname, {"abc", "defgh", "ijklmnop", "qr"});
+  string contents;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), fname, &contents));
+  contents[offsets[2] + RecordReader::kHeaderSize] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  ParallelRecordReader::Options options;
+  options.range_size = 8;
+  ParallelRecordReader reader(Env::Default(), file.get(), contents.size(), 0,
+                              options);
+  tstring record;
+  TF_ASSERT_OK(reader.ReadRecord(&record));
+  EXPECT_EQ("abc", record);
+  TF_ASSERT_OK(reader.ReadRecord(&record));
+  EXPECT_EQ("defgh", record);
+  EXPECT_TRUE(errors::IsDataLoss(reader.ReadRecord(&record)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -46,6 +46,8 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -77,6 +79,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZSTD_COMPRESSION) {
+    input_stream_.reset(new ZstdInputStream(input_stream_.release(),
+                                            options.zstd_options, true));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -245,5 +251,46 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+MappedRecordReader::MappedRecordReader(ReadOnlyMemoryRegion* region)
+    : data_(static_cast<const char*>(region->data())),
+      length_(region->length()) {}
+
+Status MappedRecordReader::ReadChecksummed(uint64 offset, size_t n,
+                                           StringPiece* result) {
+  if (offset == length_) {
+    return errors::OutOfRange("eof");
+  }
+  if (offset > length_ || n > length_ - offset ||
+      length_ - offset - n < sizeof(uint32)) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  const uint32 masked_crc = core::DecodeFixed32(data_ + offset + n);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data_ + offset, n)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  *result = StringPiece(data_ + offset, n);
+  return Status::OK();
+}
+
+Status MappedRecordReader::ReadRecord(uint64* offset, StringPiece* record) {
+  // Read header data.
+  StringPiece header;
+  TF_RETURN_IF_ERROR(ReadChecksummed(*offset, sizeof(uint64), &header));
+  const uint64 length = core::DecodeFixed64(header.data());
+
+  // Read data.
+  Status s =
+      ReadChecksummed(*offset + RecordReader::kHeaderSize, length, record);
+  if (!s.ok()) {
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated record at ", *offset);
+    }
+    return s;
+  }
+
+  *offset += RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
@@ -31,6 +33,7 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -38,7 +41,8 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -54,6 +58,7 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+  ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -174,6 +179,36 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Interface to read uncompressed TFRecord files that are mapped in memory.
+//
+// Unlike `RecordReader`, the records are not copied out of the file: they are
+// returned as views into the memory region.
+//
+// Note: this class is not thread safe; external synchronization required.
+class MappedRecordReader {
+ public:
+  // Create a reader that will return records from "*region".
+  // "*region" must remain live while this reader and the records it returned
+  // are in use.
+  explicit MappedRecordReader(ReadOnlyMemoryRegion* region);
+
+  // Read the record at "*offset" into *record and update *offset to point to
+  // the offset of the next record. *record points into the memory region.
+  // Returns OK on success, OUT_OF_RANGE for end of file, or something else for
+  // an error.
+  Status ReadRecord(uint64* offset, StringPiece* record);
+
+ private:
+  // Verify that the checksum of the n bytes at offset is stored in the next 4
+  // bytes, and store the n bytes in *result.
+  Status ReadChecksummed(uint64 offset, size_t n, StringPiece* result);
+
+  const char* const data_;
+  const uint64 length_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedRecordReader);
+};
+
 }  // namespace io
 }  // namespace tensorflow
 
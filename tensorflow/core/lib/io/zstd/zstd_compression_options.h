@@ -0,0 +1,52 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+struct ZstdCompressionOptions {
+  // Size of the buffer used for caching the data read from source file.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64 output_buffer_size = 256 << 10;
+
+  // Compression level. Levels 1 to 19 trade speed for ratio, negative levels
+  // are faster still, and 0 selects zstd's default level.
+  int32 compression_level = 3;
+
+  // Number of threads compressing in the background. With 0, compression
+  // happens on the calling thread inside Append() and Flush(). Requires zstd
+  // to be built with multithreading support. Ignored when decompressing.
+  int32 nb_workers = 0;
+
+  // Content used to prime the compressor: either raw sample data or a
+  // dictionary trained with `zstd --train`. Small records compress much better
+  // with a dictionary. Readers must be given the same dictionary.
+  std::string dictionary;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& zstd_options,
+                                 bool owns_input_stream)
+    : input_stream_(input_stream),
+      zstd_options_(zstd_options),
+      owns_input_stream_(owns_input_stream),
+      context_(ZSTD_createDCtx()),
+      output_buffer_(new char[zstd_options.output_buffer_size]) {
+  if (context_ == nullptr) {
+    init_status_ = errors::ResourceExhausted("Failed to create zstd context");
+  } else if (!zstd_options_.dictionary.empty()) {
+    const size_t ret =
+        ZSTD_DCtx_loadDictionary(context_, zstd_options_.dictionary.data(),
+                                 zstd_options_.dictionary.size());
+    if (ZSTD_isError(ret)) {
+      init_status_ = errors::InvalidArgument("Failed to load zstd dictionary: ",
+                                             ZSTD_getErrorName(ret));
+    }
+  }
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& zstd_options)
+    : ZstdInputStream(input_stream, zstd_options, false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  ZSTD_freeDCtx(context_);
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  result->resize_uninitialized(bytes_to_read);
+
+  char* result_ptr = result->mdata();
+
+  // Read as many bytes as possible from the cache.
+  size_t bytes_read = ReadBytesFromCache(bytes_to_read, result_ptr);
+  bytes_to_read -= bytes_read;
+  result_ptr += bytes_read;
+
+  while (bytes_to_read > 0) {
+    DCHECK_EQ(avail_out_, 0);
+
+    // Fill the cache with more data.
+    Status s = Decompress();
+    if (!s.ok()) {
+      result->resize(result_ptr - result->data());
+      return s;
+    }
+
+    size_t bytes_read = ReadBytesFromCache(bytes_to_read, result_ptr);
+    bytes_to_read -= bytes_read;
+    result_ptr += bytes_read;
+  }
+
+  return Status::OK();
+}
+
+#if defined(PLATFORM_GOOGLE)
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(buf.data());
+  return Status::OK();
+}
+#endif
+
+Status ZstdInputStream::Decompress() {
+  ZSTD_outBuffer output = {
+      output_buffer_.get(),
+      static_cast<size_t>(zstd_options_.output_buffer_size), 0};
+  while (output.pos == 0) {
+    if (input_.pos == input_.size && !output_full_) {
+      Status s = input_stream_->ReadNBytes(zstd_options_.input_buffer_size,
+                                           &input_buffer_);
+      if (!s.ok() && !errors::IsOutOfRange(s)) {
+        return s;
+      }
+      if (input_buffer_.empty()) {
+        if (frame_in_progress_) {
+          return errors::DataLoss("Truncated zstd stream.");
+        }
+        return errors::OutOfRange("End of zstd stream.");
+      }
+      input_ = {input_buffer_.data(), input_buffer_.size(), 0};
+    }
+    const size_t ret = ZSTD_decompressStream(context_, &output, &input_);
+    if (ZSTD_isError(ret)) {
+      return errors::DataLoss("zstd decompression failed: ",
+                              ZSTD_getErrorName(ret));
+    }
+    frame_in_progress_ = ret != 0;
+    output_full_ = output.pos == output.size;
+  }
+  next_out_ = output_buffer_.get();
+  avail_out_ = output.pos;
+  return Status::OK();
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           char* result) {
+  size_t can_read_bytes = std::min(bytes_to_read, avail_out_);
+  if (can_read_bytes) {
+    memcpy(result, next_out_, can_read_bytes);
+    next_out_ += can_read_bytes;
+    avail_out_ -= can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+int64 ZstdInputStream::Tell() const { return bytes_read_; }
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  // Resetting only the session keeps the loaded dictionary.
+  if (context_ != nullptr) {
+    ZSTD_DCtx_reset(context_, ZSTD_reset_session_only);
+  }
+  input_buffer_.clear();
+  input_ = {nullptr, 0, 0};
+  avail_out_ = 0;
+  output_full_ = false;
+  frame_in_progress_ = false;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
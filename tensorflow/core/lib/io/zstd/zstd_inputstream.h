@@ -0,0 +1,110 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+
+#include <zstd.h>
+
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// An ZstdInputStream provides support for reading from a stream compressed
+// using zstd (https://facebook.github.io/zstd/). Concatenated frames, such as
+// those of a file appended to by several ZstdOutputBuffers, are read as one
+// stream.
+class ZstdInputStream : public InputStreamInterface {
+ public:
+  // Creates a ZstdInputStream for `input_stream`, reading compressed data in
+  // chunks of `zstd_options.input_buffer_size` bytes and decompressing at most
+  // `zstd_options.output_buffer_size` bytes at a time.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& zstd_options,
+                  bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream = false.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the compressed data is corrupt or truncated.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+#if defined(PLATFORM_GOOGLE)
+  Status ReadNBytes(int64 bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Decompresses the next chunk of data into the output cache.
+  Status Decompress();
+
+  // Attempt to read `bytes_to_read` from the decompressed data cache. Returns
+  // the actual number of bytes read.
+  size_t ReadBytesFromCache(size_t bytes_to_read, char* result);
+
+  InputStreamInterface* input_stream_;
+  const ZstdCompressionOptions zstd_options_;
+  const bool owns_input_stream_;
+  ZSTD_DCtx* context_;
+  // Error creating `context_` or loading the dictionary, returned on reads.
+  Status init_status_;
+
+  // Compressed data read from `input_stream_`; input_.pos marks the bytes
+  // already consumed by zstd.
+  tstring input_buffer_;
+  ZSTD_inBuffer input_ = {nullptr, 0, 0};
+
+  // Decompressed data not yet read by the client.
+  std::unique_ptr<char[]> output_buffer_;
+  char* next_out_ = nullptr;
+  size_t avail_out_ = 0;
+  // Whether the last decompression call filled `output_buffer_`, in which case
+  // zstd may hold more output without needing further input.
+  bool output_full_ = false;
+  // Whether zstd is in the middle of a frame, so the input must not end.
+  bool frame_in_progress_ = false;
+
+  // Specifies the number of decompressed bytes currently read.
+  int64 bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
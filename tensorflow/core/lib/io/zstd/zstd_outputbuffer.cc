@@ -0,0 +1,151 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   const ZstdCompressionOptions& zstd_options)
+    : file_(file),
+      zstd_options_(zstd_options),
+      output_buffer_capacity_(zstd_options.output_buffer_size),
+      output_buffer_(new char[output_buffer_capacity_]) {}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(context_);
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  if (output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument("output_buffer_size should be positive");
+  }
+  context_ = ZSTD_createCCtx();
+  if (context_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create zstd context");
+  }
+  size_t ret = ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel,
+                                      zstd_options_.compression_level);
+  if (ZSTD_isError(ret)) {
+    return errors::InvalidArgument("Invalid zstd compression level ",
+                                   zstd_options_.compression_level, ": ",
+                                   ZSTD_getErrorName(ret));
+  }
+  if (zstd_options_.nb_workers > 0) {
+    ret = ZSTD_CCtx_setParameter(context_, ZSTD_c_nbWorkers,
+                                 zstd_options_.nb_workers);
+    if (ZSTD_isError(ret)) {
+      return errors::InvalidArgument("Failed to use ",
+                                     zstd_options_.nb_workers,
+                                     " zstd workers: ", ZSTD_getErrorName(ret));
+    }
+  }
+  if (!zstd_options_.dictionary.empty()) {
+    ret = ZSTD_CCtx_loadDictionary(context_, zstd_options_.dictionary.data(),
+                                   zstd_options_.dictionary.size());
+    if (ZSTD_isError(ret)) {
+      return errors::InvalidArgument("Failed to load zstd dictionary: ",
+                                     ZSTD_getErrorName(ret));
+    }
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Compress(ZSTD_inBuffer* input,
+                                  ZSTD_EndDirective end_op) {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "ZstdOutputBuffer is not initialized or already closed.");
+  }
+  while (true) {
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_,
+                             output_size_};
+    const size_t remaining =
+        ZSTD_compressStream2(context_, &output, input, end_op);
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("zstd compression failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    output_size_ = output.pos;
+    const bool done = end_op == ZSTD_e_continue ? input->pos == input->size
+                                                : remaining == 0;
+    if (done) return Status::OK();
+    if (output_size_ == output_buffer_capacity_) {
+      TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    }
+  }
+}
+
+Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_size_ > 0) {
+    TF_RETURN_IF_ERROR(
+        file_->Append(StringPiece(output_buffer_.get(), output_size_)));
+    output_size_ = 0;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  return Compress(&input, ZSTD_e_continue);
+}
+
+#if defined(PLATFORM_GOOGLE)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status ZstdOutputBuffer::Flush() {
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  TF_RETURN_IF_ERROR(Compress(&input, ZSTD_e_flush));
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (context_ != nullptr) {
+    ZSTD_inBuffer input = {nullptr, 0, 0};
+    TF_RETURN_IF_ERROR(Compress(&input, ZSTD_e_end));
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    ZSTD_freeCCtx(context_);
+    context_ = nullptr;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Tell(int64* position) { return file_->Tell(position); }
+
+}  // namespace io
+}  // namespace tensorflow
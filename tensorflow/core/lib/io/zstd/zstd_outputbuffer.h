@@ -0,0 +1,104 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <zstd.h>
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Provides support for writing zstd (https://facebook.github.io/zstd/)
+// compressed output to file as a single streaming frame.
+// A given instance of an ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Create a ZstdOutputBuffer for `file`, which caches at most
+  // `zstd_options.output_buffer_size` bytes of compressed output before
+  // writing it out. Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file,
+                   const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdOutputBuffer() override;
+
+  // Initializes the compression context. This call is required before any
+  // other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the compression pipeline. zstd buffers the input
+  // internally, so the compressed output reaches `file` in bulk.
+  Status Append(StringPiece data) override;
+
+#if defined(PLATFORM_GOOGLE)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Ends the current zstd block and writes all output to file, so that all
+  // data appended so far can be decompressed from the file.
+  Status Flush() override;
+
+  // Ends the zstd frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Compresses `input`, writing the output buffer to file whenever it fills
+  // up. Returns once all of `input` is consumed and, for `end_op` other than
+  // ZSTD_e_continue, once zstd has produced all of its pending output.
+  Status Compress(ZSTD_inBuffer* input, ZSTD_EndDirective end_op);
+
+  // Appends the contents of `output_buffer_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const ZstdCompressionOptions zstd_options_;
+  ZSTD_CCtx* context_ = nullptr;
+
+  const size_t output_buffer_capacity_;
+  std::unique_ptr<char[]> output_buffer_;
+  // Number of bytes of `output_buffer_` holding compressed data.
+  size_t output_size_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
@@ -0,0 +1,206 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+string GenTestString(int copies = 1) {
+  string result;
+  for (int i = 0; i < copies; i++) {
+    strings::StrAppend(&result, "Lorem ipsum dolor sit amet, record ", i,
+                       ", consectetur adipiscing elit. Fusce vehicula.");
+  }
+  return result;
+}
+
+// Writes `num_writes` copies of `data` to `fname`.
+Status WriteFile(const string& fname, const ZstdCompressionOptions& options,
+                 const string& data, int num_writes, bool with_flush) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), options);
+  TF_RETURN_IF_ERROR(out.Init());
+  for (int i = 0; i < num_writes; i++) {
+    TF_RETURN_IF_ERROR(out.Append(data));
+    if (with_flush) {
+      TF_RETURN_IF_ERROR(out.Flush());
+    }
+  }
+  TF_RETURN_IF_ERROR(out.Close());
+  return file_writer->Close();
+}
+
+// Reads `fname` back in chunks of `read_size` bytes.
+Status ReadFile(const string& fname, const ZstdCompressionOptions& options,
+                int64 read_size, string* result) {
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(fname, &file_reader));
+  ZstdInputStream in(new RandomAccessInputStream(file_reader.get()), options,
+                     /*owns_input_stream=*/true);
+  result->clear();
+  while (true) {
+    tstring chunk;
+    Status s = in.ReadNBytes(read_size, &chunk);
+    result->append(chunk.data(), chunk.size());
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+  }
+  EXPECT_EQ(in.Tell(), static_cast<int64>(result->size()));
+  return Status::OK();
+}
+
+void TestRoundTrip(const ZstdCompressionOptions& options, int num_writes,
+                   bool with_flush, int64 read_size) {
+  const string fname = testing::TmpDir() + "/zstd_buffers_test";
+  const string data = GenTestString(100);
+  TF_ASSERT_OK(WriteFile(fname, options, data, num_writes, with_flush));
+
+  string expected;
+  for (int i = 0; i < num_writes; i++) {
+    expected += data;
+  }
+  string result;
+  TF_ASSERT_OK(ReadFile(fname, options, read_size, &result));
+  EXPECT_EQ(result, expected);
+}
+
+TEST(ZstdBuffers, MultipleWritesWithoutFlush) {
+  ZstdCompressionOptions options;
+  TestRoundTrip(options, /*num_writes=*/10, /*with_flush=*/false,
+                /*read_size=*/1000);
+}
+
+TEST(ZstdBuffers, MultipleWritesWithFlush) {
+  ZstdCompressionOptions options;
+  TestRoundTrip(options, /*num_writes=*/10, /*with_flush=*/true,
+                /*read_size=*/1000);
+}
+
+TEST(ZstdBuffers, SmallBuffers) {
+  ZstdCompressionOptions options;
+  options.input_buffer_size = 7;
+  options.output_buffer_size = 13;
+  TestRoundTrip(options, /*num_writes=*/3, /*with_flush=*/true,
+                /*read_size=*/29);
+}
+
+TEST(ZstdBuffers, CompressionLevels) {
+  for (int level : {-5, 1, 19}) {
+    ZstdCompressionOptions options;
+    options.compression_level = level;
+    TestRoundTrip(options, /*num_writes=*/5, /*with_flush=*/false,
+                  /*read_size=*/4096);
+  }
+}
+
+TEST(ZstdBuffers, MultithreadedCompression) {
+  ZstdCompressionOptions options;
+  options.nb_workers = 2;
+  TestRoundTrip(options, /*num_writes=*/500, /*with_flush=*/false,
+                /*read_size=*/1 << 20);
+}
+
+TEST(ZstdBuffers, Dictionary) {
+  const string fname = testing::TmpDir() + "/zstd_dictionary_test";
+  const string data = GenTestString(3);
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(50);
+  TF_ASSERT_OK(WriteFile(fname, options, data, /*num_writes=*/1,
+                         /*with_flush=*/false));
+
+  string result;
+  TF_ASSERT_OK(ReadFile(fname, options, /*read_size=*/100, &result));
+  EXPECT_EQ(result, data);
+
+  // The frame references the dictionary, so it can't be read without it.
+  ZstdCompressionOptions no_dictionary;
+  Status s = ReadFile(fname, no_dictionary, /*read_size=*/100, &result);
+  EXPECT_TRUE(!s.ok() || result != data);
+}
+
+TEST(ZstdBuffers, ConcatenatedFrames) {
+  const string fname = testing::TmpDir() + "/zstd_concatenated_test";
+  const string data = GenTestString(10);
+  ZstdCompressionOptions options;
+  TF_ASSERT_OK(WriteFile(fname, options, data, /*num_writes=*/1,
+                         /*with_flush=*/false));
+  {
+    std::unique_ptr<WritableFile> file_writer;
+    TF_ASSERT_OK(Env::Default()->NewAppendableFile(fname, &file_writer));
+    ZstdOutputBuffer out(file_writer.get(), options);
+    TF_ASSERT_OK(out.Init());
+    TF_ASSERT_OK(out.Append(data));
+    TF_ASSERT_OK(out.Close());
+    TF_ASSERT_OK(file_writer->Close());
+  }
+
+  string result;
+  TF_ASSERT_OK(ReadFile(fname, options, /*read_size=*/100, &result));
+  EXPECT_EQ(result, data + data);
+}
+
+TEST(ZstdBuffers, TruncatedStream) {
+  const string fname = testing::TmpDir() + "/zstd_truncated_test";
+  const string data = GenTestString(100);
+  ZstdCompressionOptions options;
+  TF_ASSERT_OK(WriteFile(fname, options, data, /*num_writes=*/1,
+                         /*with_flush=*/false));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &contents));
+  contents.resize(contents.size() - 10);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, contents));
+
+  string result;
+  EXPECT_TRUE(
+      errors::IsDataLoss(ReadFile(fname, options, /*read_size=*/100, &result)));
+}
+
+TEST(ZstdBuffers, Reset) {
+  const string fname = testing::TmpDir() + "/zstd_reset_test";
+  const string data = GenTestString(100);
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(5);
+  TF_ASSERT_OK(WriteFile(fname, options, data, /*num_writes=*/1,
+                         /*with_flush=*/false));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file_reader));
+  ZstdInputStream in(new RandomAccessInputStream(file_reader.get()), options,
+                     /*owns_input_stream=*/true);
+  tstring first;
+  TF_ASSERT_OK(in.ReadNBytes(100, &first));
+  TF_ASSERT_OK(in.SkipNBytes(1000));
+  EXPECT_EQ(in.Tell(), 1100);
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  tstring second;
+  TF_ASSERT_OK(in.ReadNBytes(100, &second));
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first, data.substr(0, 100));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -27,6 +27,10 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
+namespace histogram {
+class Histogram;
+}  // namespace histogram
+
 namespace monitoring {
 
 // SamplerCell which has a null implementation.
@@ -36,6 +40,7 @@ class SamplerCell {
   ~SamplerCell() {}
 
   void Add(double value) {}
+  void Merge(const histogram::Histogram& samples) {}
   HistogramProto value() const { return HistogramProto(); }
 
  private:
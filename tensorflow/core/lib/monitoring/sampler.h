@@ -62,6 +62,11 @@ class SamplerCell {
   // Atomically adds a sample.
   void Add(double sample);
 
+  // Atomically adds the samples of `samples`, which must have the bucket
+  // boundaries of this cell. Lets callers accumulate samples without locking
+  // and add them in batches.
+  void Merge(const histogram::Histogram& samples);
+
   // Returns the current histogram value as a proto.
   HistogramProto value() const;
 
@@ -196,6 +201,10 @@ class Sampler {
 
 inline void SamplerCell::Add(const double sample) { histogram_.Add(sample); }
 
+inline void SamplerCell::Merge(const histogram::Histogram& samples) {
+  histogram_.Merge(samples);
+}
+
 inline HistogramProto SamplerCell::value() const {
   HistogramProto pb;
   histogram_.EncodeToProto(&pb, true /* preserve_zero_buckets */);
@@ -1250,6 +1250,31 @@ REGISTER_OP("GatherV2")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("GroupedGather")
+    .Input("params: N * Tparams")
+    .Input("indices: N * Tindices")
+    .Output("output: N * Tparams")
+    .Attr("N: int >= 1")
+    .Attr("Tparams: type")
+    .Attr("Tindices: {int32,int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      for (int i = 0; i < n; ++i) {
+        ShapeHandle params_shape;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &params_shape));
+        ShapeHandle params_inner_subshape;
+        TF_RETURN_IF_ERROR(
+            c->Subshape(params_shape, 1, &params_inner_subshape));
+        ShapeHandle out;
+        TF_RETURN_IF_ERROR(
+            c->Concatenate(c->input(n + i), params_inner_subshape, &out));
+        c->set_output(i, out);
+      }
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("GatherNd")
     .Input("params: Tparams")
@@ -54,6 +54,10 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'target_latency_micros' is positive, the batch size and timeout are
+    // chosen from the arrival rate and the measured processing latency, to
+    // keep the 99th percentile latency within the target.
+    .Attr("target_latency_micros: int = 0")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape);
@@ -936,6 +936,43 @@ REGISTER_OP("CropAndResizeGradBoxes")
       return Status::OK();
     });
 
+REGISTER_OP("CropResizeFlipAndNormalize")
+    .Input("images: T")
+    .Input("boxes: float")
+    .Input("flip: bool")
+    .Input("size: int32")
+    .Input("mean: float")
+    .Input("scale: float")
+    .Output("output: float")
+    .Attr("T: {uint8, half, float}")
+    .Attr("extrapolation_value: float = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle images;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &images));
+      ShapeHandle boxes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &boxes));
+      ShapeHandle flip;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &flip));
+      ShapeHandle mean;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &mean));
+      ShapeHandle scale;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 1, &scale));
+
+      // There is one box and one flip per image.
+      DimensionHandle batch;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(images, 0), c->Dim(boxes, 0), &batch));
+      TF_RETURN_IF_ERROR(c->Merge(batch, c->Dim(flip, 0), &batch));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 1), 4, &unused));
+
+      // mean and scale hold one value per channel.
+      DimensionHandle depth;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(images, 3), c->Dim(mean, 0), &depth));
+      TF_RETURN_IF_ERROR(c->Merge(depth, c->Dim(scale, 0), &depth));
+
+      return SetOutputToSizedImage(c, batch, 3 /* size_input_idx */, depth);
+    });
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("NonMaxSuppression")
@@ -404,6 +404,26 @@ REGISTER_OP("MutableHashTableOfTensorsV2")
       return MutableHashTableShape(c, /*key=*/c->Scalar(), /*value=*/value_s);
     });
 
+REGISTER_OP("MutableTieredHashTableOfTensors")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .Attr("value_shape: shape = {}")
+    .Attr("storage_dir: string")
+    .Attr("hot_capacity: int >= 1 = 65536")
+    .Attr("admission_threshold: int >= 1 = 2")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      PartialTensorShape value_p;
+      TF_RETURN_IF_ERROR(c->GetAttr("value_shape", &value_p));
+      ShapeHandle value_s;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromPartialTensorShape(value_p, &value_s));
+      return MutableHashTableShape(c, /*key=*/c->Scalar(), /*value=*/value_s);
+    });
+
 REGISTER_OP("MutableDenseHashTable")
     .Input("empty_key: key_dtype")
     .Output("table_handle: Ref(string)")
@@ -515,4 +535,85 @@ REGISTER_OP("InitializeTableFromDataset")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+
+REGISTER_OP("AnnIndex")
+    .Output("index_handle: resource")
+    .Attr("dim: int >= 1")
+    .Attr("num_partitions: int >= 1")
+    .Attr("num_subspaces: int >= 1")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+namespace {
+// Checks that the index handle is a scalar and that input `i` is a matrix of
+// vectors.
+Status AnnIndexVectorsShape(InferenceContext* c, int i, ShapeHandle* vectors) {
+  ShapeHandle handle;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, vectors));
+  return Status::OK();
+}
+
+Status TwoScalarInputs(InferenceContext* c) {
+  ShapeHandle handle;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &handle));
+  return Status::OK();
+}
+}  // namespace
+
+REGISTER_OP("AnnIndexBuild")
+    .Input("index_handle: resource")
+    .Input("vectors: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle vectors;
+      return AnnIndexVectorsShape(c, 1, &vectors);
+    });
+
+REGISTER_OP("AnnIndexAdd")
+    .Input("index_handle: resource")
+    .Input("vectors: float")
+    .Input("ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle vectors;
+      TF_RETURN_IF_ERROR(AnnIndexVectorsShape(c, 1, &vectors));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &ids));
+      DimensionHandle unused;
+      return c->Merge(c->Dim(vectors, 0), c->Dim(ids, 0), &unused);
+    });
+
+REGISTER_OP("AnnIndexSearch")
+    .Input("index_handle: resource")
+    .Input("queries: float")
+    .Input("k: int32")
+    .Input("num_probes: int32")
+    .Output("scores: float")
+    .Output("ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle queries;
+      TF_RETURN_IF_ERROR(AnnIndexVectorsShape(c, 1, &queries));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      DimensionHandle k;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &k));
+      ShapeHandle output = c->Matrix(c->Dim(queries, 0), k);
+      c->set_output(0, output);
+      c->set_output(1, output);
+      return Status::OK();
+    });
+
+REGISTER_OP("AnnIndexSave")
+    .Input("index_handle: resource")
+    .Input("prefix: string")
+    .SetShapeFn(TwoScalarInputs);
+
+REGISTER_OP("AnnIndexRestore")
+    .Input("index_handle: resource")
+    .Input("prefix: string")
+    .SetShapeFn(TwoScalarInputs);
+
 }  // namespace tensorflow
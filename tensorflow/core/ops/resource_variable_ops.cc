@@ -196,6 +196,7 @@ REGISTER_OP("AssignVariableOp")
     .Input("resource: resource")
     .Input("value: dtype")
     .Attr("dtype: type")
+    .Attr("read_only: bool = false")
     .SetShapeFn(CreateAssignShapeFn);
 
 REGISTER_OP("AssignAddVariableOp")
@@ -293,6 +294,42 @@ REGISTER_OP("ResourceGather")
       return Status::OK();
     });
 
+REGISTER_OP("ResourceGroupedGather")
+    .Input("resources: N * resource")
+    .Input("indices: N * Tindices")
+    .Output("output: N * dtype")
+    .Attr("N: int >= 1")
+    .Attr("dtype: type")
+    .Attr("Tindices: {int32,int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      DataType dtype;
+      TF_RETURN_IF_ERROR(c->GetAttr("dtype", &dtype));
+      for (int i = 0; i < n; ++i) {
+        auto* handle_data = c->input_handle_shapes_and_types(i);
+        ShapeHandle params_shape = c->UnknownShape();
+        if (handle_data != nullptr && !handle_data->empty()) {
+          if ((*handle_data)[0].dtype != dtype) {
+            return errors::InvalidArgument(
+                "Trying to read variable ", i, " with wrong dtype. Expected ",
+                DataTypeString((*handle_data)[0].dtype), " got ",
+                DataTypeString(dtype));
+          }
+          params_shape = (*handle_data)[0].shape;
+        }
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(params_shape, 1, &params_shape));
+        ShapeHandle params_inner_subshape;
+        TF_RETURN_IF_ERROR(
+            c->Subshape(params_shape, 1, &params_inner_subshape));
+        ShapeHandle out;
+        TF_RETURN_IF_ERROR(
+            c->Concatenate(c->input(n + i), params_inner_subshape, &out));
+        c->set_output(i, out);
+      }
+      return Status::OK();
+    });
+
 REGISTER_OP("ResourceGatherNd")
     .Input("resource: resource")
     .Input("indices: Tindices")
@@ -343,6 +380,7 @@ REGISTER_OP("ResourceScatterAdd")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("use_locking: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterSub")
@@ -351,6 +389,7 @@ REGISTER_OP("ResourceScatterSub")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("use_locking: bool = false")
     .SetShapeFn(ResourceScatterUpdateShape);
 
 REGISTER_OP("ResourceScatterMul")
@@ -0,0 +1,261 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_CACHING_FILE_SYSTEM_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_CACHING_FILE_SYSTEM_H_
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+/// \brief A wrapper to cache the contents read from another file system in
+/// blocks on a local disk.
+///
+/// Intended for remote file systems (e.g. GCS, S3 or HDFS) read repeatedly,
+/// such as datasets read once per epoch: the first epoch fills the cache, and
+/// the next ones read from the local disk. A file is cached under the
+/// signature of its length and modification time, checked each time the file
+/// is opened; a file changed since it was cached is read from the base file
+/// system again. Writes, renames and deletions through this file system drop
+/// the cached blocks of the files they change.
+///
+/// For example, to cache a file system of scheme "gs" on a local SSD:
+///
+///   class CachingGcsFileSystem
+///       : public CachingFileSystem<RetryingGcsFileSystem> {
+///    public:
+///     CachingGcsFileSystem()
+///         : CachingFileSystem(
+///               std::unique_ptr<RetryingGcsFileSystem>(
+///                   new RetryingGcsFileSystem),
+///               "/mnt/ssd/cache", 16 << 20 /* block size */,
+///               size_t{100} << 30 /* max bytes */) {}
+///   };
+///   REGISTER_FILE_SYSTEM("gs", CachingGcsFileSystem);
+template <typename Underlying>
+class CachingFileSystem : public FileSystem {
+ public:
+  /// Caches up to `max_bytes` of blocks of `block_size` bytes in a new
+  /// subdirectory of `cache_dir`. Blocks older than `max_staleness` seconds
+  /// are fetched again, unless `max_staleness` is 0.
+  CachingFileSystem(std::unique_ptr<Underlying> base_file_system,
+                    const string& cache_dir, size_t block_size,
+                    size_t max_bytes, uint64 max_staleness = 0,
+                    Env* env = Env::Default())
+      : base_file_system_(std::move(base_file_system)),
+        file_block_cache_(new DiskFileBlockCache(
+            block_size, max_bytes, max_staleness, cache_dir,
+            [this](const string& filename, size_t offset, size_t n,
+                   char* buffer, size_t* bytes_transferred) {
+              return LoadBufferFromBase(filename, offset, n, buffer,
+                                        bytes_transferred);
+            },
+            env)) {}
+
+  TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
+
+  Status NewRandomAccessFile(
+      const string& filename, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override;
+
+  Status NewWritableFile(const string& filename, TransactionToken* token,
+                         std::unique_ptr<WritableFile>* result) override {
+    file_block_cache_->RemoveFile(filename);
+    return base_file_system_->NewWritableFile(filename, token, result);
+  }
+
+  Status NewAppendableFile(const string& filename, TransactionToken* token,
+                           std::unique_ptr<WritableFile>* result) override {
+    file_block_cache_->RemoveFile(filename);
+    return base_file_system_->NewAppendableFile(filename, token, result);
+  }
+
+  Status NewReadOnlyMemoryRegionFromFile(
+      const string& filename, TransactionToken* token,
+      std::unique_ptr<ReadOnlyMemoryRegion>* result) override {
+    return base_file_system_->NewReadOnlyMemoryRegionFromFile(filename, token,
+                                                              result);
+  }
+
+  Status FileExists(const string& fname, TransactionToken* token) override {
+    return base_file_system_->FileExists(fname, token);
+  }
+
+  Status GetChildren(const string& dir, TransactionToken* token,
+                     std::vector<string>* result) override {
+    return base_file_system_->GetChildren(dir, token, result);
+  }
+
+  Status GetMatchingPaths(const string& pattern, TransactionToken* token,
+                          std::vector<string>* result) override {
+    return base_file_system_->GetMatchingPaths(pattern, token, result);
+  }
+
+  Status Stat(const string& fname, TransactionToken* token,
+              FileStatistics* stat) override {
+    return base_file_system_->Stat(fname, token, stat);
+  }
+
+  Status DeleteFile(const string& fname, TransactionToken* token) override {
+    file_block_cache_->RemoveFile(fname);
+    return base_file_system_->DeleteFile(fname, token);
+  }
+
+  Status CreateDir(const string& dirname, TransactionToken* token) override {
+    return base_file_system_->CreateDir(dirname, token);
+  }
+
+  Status DeleteDir(const string& dirname, TransactionToken* token) override {
+    return base_file_system_->DeleteDir(dirname, token);
+  }
+
+  Status GetFileSize(const string& fname, TransactionToken* token,
+                     uint64* file_size) override {
+    return base_file_system_->GetFileSize(fname, token, file_size);
+  }
+
+  Status RenameFile(const string& src, const string& target,
+                    TransactionToken* token) override {
+    file_block_cache_->RemoveFile(src);
+    file_block_cache_->RemoveFile(target);
+    return base_file_system_->RenameFile(src, target, token);
+  }
+
+  Status IsDirectory(const string& dirname, TransactionToken* token) override {
+    return base_file_system_->IsDirectory(dirname, token);
+  }
+
+  Status HasAtomicMove(const string& path, bool* has_atomic_move) override {
+    return base_file_system_->HasAtomicMove(path, has_atomic_move);
+  }
+
+  Status DeleteRecursively(const string& dirname, TransactionToken* token,
+                           int64* undeleted_files,
+                           int64* undeleted_dirs) override {
+    // The cache is not indexed by directory.
+    file_block_cache_->Flush();
+    return base_file_system_->DeleteRecursively(dirname, token, undeleted_files,
+                                                undeleted_dirs);
+  }
+
+  void FlushCaches(TransactionToken* token) override {
+    file_block_cache_->Flush();
+    base_file_system_->FlushCaches(token);
+  }
+
+  Underlying* underlying() const { return base_file_system_.get(); }
+
+  FileBlockCache* file_block_cache() const { return file_block_cache_.get(); }
+
+ private:
+  /// Reads a block of `filename` from the base file system, the fetcher of
+  /// file_block_cache_. Reading past the end of the file is not an error.
+  Status LoadBufferFromBase(const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+    *bytes_transferred = 0;
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(
+        base_file_system_->NewRandomAccessFile(filename, nullptr, &file));
+    StringPiece result;
+    Status status = file->Read(offset, n, &result, buffer);
+    if (!status.ok() && !errors::IsOutOfRange(status)) {
+      return status;
+    }
+    if (result.data() != buffer) {
+      memmove(buffer, result.data(), result.size());
+    }
+    *bytes_transferred = result.size();
+    return Status::OK();
+  }
+
+  std::unique_ptr<Underlying> base_file_system_;
+  std::unique_ptr<FileBlockCache> file_block_cache_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CachingFileSystem);
+};
+
+namespace caching_internals {
+
+class CachingRandomAccessFile : public RandomAccessFile {
+ public:
+  CachingRandomAccessFile(const string& filename,
+                          FileBlockCache* file_block_cache)
+      : filename_(filename), file_block_cache_(file_block_cache) {}
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return Status::OK();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    *result = StringPiece();
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(file_block_cache_->Read(filename_, offset, n, scratch,
+                                               &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      return errors::OutOfRange("EOF reached, ", result->size(),
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string filename_;
+  FileBlockCache* const file_block_cache_;  // Not owned.
+};
+
+}  // namespace caching_internals
+
+template <typename Underlying>
+Status CachingFileSystem<Underlying>::NewRandomAccessFile(
+    const string& filename, TransactionToken* token,
+    std::unique_ptr<RandomAccessFile>* result) {
+  if (!file_block_cache_->IsCacheEnabled()) {
+    return base_file_system_->NewRandomAccessFile(filename, token, result);
+  }
+  FileStatistics stat;
+  TF_RETURN_IF_ERROR(base_file_system_->Stat(filename, token, &stat));
+  if (stat.is_directory) {
+    return errors::FailedPrecondition(filename, " is a directory");
+  }
+  const int64 signature = static_cast<int64>(
+      Hash64Combine(static_cast<uint64>(stat.length),
+                    static_cast<uint64>(stat.mtime_nsec)));
+  if (!file_block_cache_->ValidateAndUpdateFileSignature(filename,
+                                                         signature)) {
+    VLOG(1) << "File signature has been changed. Refreshing the cache. Path: "
+            << filename;
+  }
+  result->reset(new caching_internals::CachingRandomAccessFile(
+      filename, file_block_cache_.get()));
+  return Status::OK();
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_CACHING_FILE_SYSTEM_H_
@@ -0,0 +1,106 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/caching_file_system.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/ram_file_system.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A RamFileSystem that counts the files opened for reading.
+class CountingRamFileSystem : public RamFileSystem {
+ public:
+  Status NewRandomAccessFile(
+      const string& fname, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override {
+    ++num_opened_;
+    return RamFileSystem::NewRandomAccessFile(fname, token, result);
+  }
+
+  int num_opened_ = 0;
+};
+
+class CachingFileSystemTest : public ::testing::Test {
+ protected:
+  CachingFileSystemTest()
+      : fs_(std::unique_ptr<CountingRamFileSystem>(new CountingRamFileSystem),
+            testing::TmpDir(), 4 /* block size */, 1024 /* max bytes */) {}
+
+  void WriteFile(const string& fname, const string& contents, bool append) {
+    std::unique_ptr<WritableFile> file;
+    if (append) {
+      TF_ASSERT_OK(fs_.underlying()->NewAppendableFile(fname, nullptr, &file));
+    } else {
+      TF_ASSERT_OK(fs_.underlying()->NewWritableFile(fname, nullptr, &file));
+    }
+    TF_ASSERT_OK(file->Append(contents));
+    TF_ASSERT_OK(file->Close());
+  }
+
+  string ReadFile(const string& fname) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(fs_.NewRandomAccessFile(fname, nullptr, &file));
+    char scratch[64];
+    StringPiece result;
+    Status status = file->Read(0, sizeof(scratch), &result, scratch);
+    EXPECT_TRUE(errors::IsOutOfRange(status)) << status;
+    return string(result);
+  }
+
+  CachingFileSystem<CountingRamFileSystem> fs_;
+};
+
+TEST_F(CachingFileSystemTest, ReadsFromCache) {
+  WriteFile("ram://a", "0123456789", /*append=*/false);
+  EXPECT_EQ(ReadFile("ram://a"), "0123456789");
+  // One open per block.
+  EXPECT_EQ(fs_.underlying()->num_opened_, 3);
+  EXPECT_EQ(fs_.file_block_cache()->CacheSize(), 10);
+
+  EXPECT_EQ(ReadFile("ram://a"), "0123456789");
+  EXPECT_EQ(fs_.underlying()->num_opened_, 3);
+}
+
+TEST_F(CachingFileSystemTest, FileChangedInBaseFileSystem) {
+  WriteFile("ram://a", "0123", /*append=*/false);
+  EXPECT_EQ(ReadFile("ram://a"), "0123");
+  // Changes the length, and with it the signature of the file.
+  WriteFile("ram://a", "45", /*append=*/true);
+  EXPECT_EQ(ReadFile("ram://a"), "012345");
+}
+
+TEST_F(CachingFileSystemTest, WritesDropCachedBlocks) {
+  WriteFile("ram://a", "0123", /*append=*/false);
+  EXPECT_EQ(ReadFile("ram://a"), "0123");
+  EXPECT_EQ(fs_.file_block_cache()->CacheSize(), 4);
+
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(fs_.NewAppendableFile("ram://a", nullptr, &file));
+  EXPECT_EQ(fs_.file_block_cache()->CacheSize(), 0);
+  TF_ASSERT_OK(file->Close());
+
+  EXPECT_EQ(ReadFile("ram://a"), "0123");
+  TF_ASSERT_OK(fs_.DeleteFile("ram://a", nullptr));
+  EXPECT_EQ(fs_.file_block_cache()->CacheSize(), 0);
+  std::unique_ptr<RandomAccessFile> deleted;
+  EXPECT_TRUE(errors::IsNotFound(
+      fs_.NewRandomAccessFile("ram://a", nullptr, &deleted)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/scanner.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/types.h"
@@ -37,6 +38,12 @@ namespace {
 constexpr uint64 kVerboseOutput = 0;
 
 // Proxy to the real libcurl implementation.
+//
+// Unless TF_CURL_SHARE_CONNECTIONS is set to false, all the curl handles share
+// one connection cache, DNS cache and TLS session cache. Connections are then
+// kept alive and reused across requests and threads, instead of each request
+// paying for a new TCP and TLS handshake. The DNS cache also holds the
+// addresses added by CurlHttpRequest::AddResolveOverride (e.g. by GcsDnsCache).
 class LibCurlProxy : public LibCurl {
  public:
   static LibCurlProxy* Load() {
@@ -47,7 +54,15 @@ class LibCurlProxy : public LibCurl {
     return libcurl;
   }
 
-  CURL* curl_easy_init() override { return ::curl_easy_init(); }
+  CURL* curl_easy_init() override {
+    CURL* curl = ::curl_easy_init();
+    if (curl != nullptr && share_ != nullptr) {
+      if (::curl_easy_setopt(curl, CURLOPT_SHARE, share_) != CURLE_OK) {
+        LOG(WARNING) << "Couldn't share the connections of a curl session.";
+      }
+    }
+    return curl;
+  }
 
   CURLcode curl_easy_setopt(CURL* curl, CURLoption option,
                             uint64 param) override {
@@ -114,6 +129,48 @@ class LibCurlProxy : public LibCurl {
   }
 
   void curl_free(void* p) override { ::curl_free(p); }
+
+ private:
+  LibCurlProxy() {
+    bool share_connections = true;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_CURL_SHARE_CONNECTIONS", true,
+                                   &share_connections));
+    if (!share_connections) return;
+    share_ = ::curl_share_init();
+    if (share_ == nullptr ||
+        ::curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &Lock) != CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &Unlock) !=
+            CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_USERDATA, this) != CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) !=
+            CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_SHARE,
+                            CURL_LOCK_DATA_SSL_SESSION) != CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT) !=
+            CURLSHE_OK) {
+      LOG(WARNING) << "Couldn't set up sharing between curl sessions, every "
+                      "HTTP request will use its own connection.";
+      if (share_ != nullptr) {
+        ::curl_share_cleanup(share_);
+        share_ = nullptr;
+      }
+    }
+  }
+
+  // The lock callbacks of the share handle, one mutex per kind of shared data.
+  static void Lock(CURL* curl, curl_lock_data data, curl_lock_access access,
+                   void* userptr) TF_NO_THREAD_SAFETY_ANALYSIS {
+    static_cast<LibCurlProxy*>(userptr)->share_mu_[data].lock();
+  }
+
+  static void Unlock(CURL* curl, curl_lock_data data,
+                     void* userptr) TF_NO_THREAD_SAFETY_ANALYSIS {
+    static_cast<LibCurlProxy*>(userptr)->share_mu_[data].unlock();
+  }
+
+  // Never freed, like the LibCurlProxy itself.
+  CURLSH* share_ = nullptr;
+  mutex share_mu_[CURL_LOCK_DATA_LAST];
 };
 }  // namespace
 
@@ -144,9 +201,19 @@ CurlHttpRequest::CurlHttpRequest(LibCurl* libcurl, Env* env)
   // Do not use signals for timeouts - does not work in multi-threaded programs.
   CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L));
 
-  // TODO(b/74351157): Enable HTTP/2.
-  CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
-                                           CURL_HTTP_VERSION_1_1));
+  // HTTP/2 is opt-in, and needs a libcurl built with nghttp2. Without it,
+  // setting the version fails and the request falls back to HTTP/1.1.
+  bool use_http2 = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_CURL_HTTP2", false, &use_http2));
+  if (!use_http2 ||
+      libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
+                                 CURL_HTTP_VERSION_2TLS) != CURLE_OK) {
+    CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
+                                             CURL_HTTP_VERSION_1_1));
+  }
+  // Keep idle connections alive, so that they can be reused.
+  CHECK_CURL_OK(
+      libcurl_->curl_easy_setopt(curl_, CURLOPT_TCP_KEEPALIVE, uint64{1}));
 
   // Set up the progress meter.
   CHECK_CURL_OK(
@@ -67,6 +67,12 @@ class FakeLibCurl : public LibCurl {
       case CURLOPT_PUT:
         is_put_ = param;
         break;
+      case CURLOPT_HTTP_VERSION:
+        if (param == CURL_HTTP_VERSION_2TLS && !supports_http2_) {
+          return CURLE_UNSUPPORTED_PROTOCOL;
+        }
+        http_version_ = param;
+        break;
       default:
         break;
     }
@@ -233,6 +239,7 @@ class FakeLibCurl : public LibCurl {
   string response_content_;
   uint64 response_code_;
   std::vector<string> response_headers_;
+  bool supports_http2_ = true;
 
   // Internal variables to store the libcurl state.
   string url_;
@@ -245,6 +252,7 @@ class FakeLibCurl : public LibCurl {
   std::vector<string>* headers_ = nullptr;
   bool is_post_ = false;
   bool is_put_ = false;
+  uint64 http_version_ = 0;
   void* write_data_ = nullptr;
   size_t (*write_callback_)(const void* ptr, size_t size, size_t nmemb,
                             void* userdata) = nullptr;
@@ -357,6 +365,28 @@ TEST(CurlHttpRequestTest, GetRequest_CustomCaInfoFlag) {
   EXPECT_EQ(200, http_request.GetResponseCode());
 }
 
+TEST(CurlHttpRequestTest, GetRequest_Http2) {
+  {
+    FakeLibCurl libcurl("get response", 200);
+    CurlHttpRequest http_request(&libcurl);
+    EXPECT_EQ(CURL_HTTP_VERSION_1_1, libcurl.http_version_);
+  }
+  setenv("TF_CURL_HTTP2", "true", 1);
+  {
+    FakeLibCurl libcurl("get response", 200);
+    CurlHttpRequest http_request(&libcurl);
+    EXPECT_EQ(CURL_HTTP_VERSION_2TLS, libcurl.http_version_);
+  }
+  {
+    // Falls back to HTTP/1.1 if libcurl was built without HTTP/2.
+    FakeLibCurl libcurl("get response", 200);
+    libcurl.supports_http2_ = false;
+    CurlHttpRequest http_request(&libcurl);
+    EXPECT_EQ(CURL_HTTP_VERSION_1_1, libcurl.http_version_);
+  }
+  unsetenv("TF_CURL_HTTP2");
+}
+
 TEST(CurlHttpRequestTest, GetRequest_Direct_ResponseTooLarge) {
   FakeLibCurl libcurl("get response", 200);
   CurlHttpRequest http_request(&libcurl);
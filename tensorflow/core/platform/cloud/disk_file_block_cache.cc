@@ -0,0 +1,266 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+DiskFileBlockCache::DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                                       uint64 max_staleness,
+                                       const string& cache_dir,
+                                       BlockFetcher block_fetcher, Env* env)
+    : block_size_(block_size),
+      max_bytes_(max_bytes),
+      max_staleness_(max_staleness),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  if (block_size_ > 0 && max_bytes_ > 0) {
+    // Several caches can be created at once in the same process.
+    static std::atomic<int64> num_caches(0);
+    string dir = io::JoinPath(
+        cache_dir, strings::StrCat("tf_block_cache_", num_caches++, "_"));
+    Status status = env_->CreateUniqueFileName(&dir, "")
+                        ? env_->RecursivelyCreateDir(dir)
+                        : errors::AlreadyExists("Cache directory exists");
+    if (status.ok()) {
+      cache_dir_ = dir;
+    } else {
+      LOG(WARNING) << "Could not create a block cache directory in "
+                   << cache_dir << ", disabling the disk block cache: "
+                   << status;
+    }
+  }
+  VLOG(1) << "Disk file block cache is "
+          << (IsCacheEnabled() ? "enabled in " + cache_dir_ : "disabled");
+}
+
+DiskFileBlockCache::~DiskFileBlockCache() {
+  if (cache_dir_.empty()) return;
+  int64 undeleted_files, undeleted_dirs;
+  Status status =
+      env_->DeleteRecursively(cache_dir_, &undeleted_files, &undeleted_dirs);
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not delete the block cache directory "
+                 << cache_dir_ << ": " << status;
+  }
+}
+
+bool DiskFileBlockCache::Lookup(const Key& key, Block* block) {
+  mutex_lock lock(mu_);
+  auto entry = block_map_.find(key);
+  if (entry == block_map_.end()) {
+    return false;
+  }
+  if (max_staleness_ > 0 &&
+      env_->NowSeconds() - entry->second.timestamp > max_staleness_) {
+    RemoveFile_Locked(key.first);
+    return false;
+  }
+  if (entry->second.lru_iterator != lru_list_.begin()) {
+    lru_list_.erase(entry->second.lru_iterator);
+    lru_list_.push_front(key);
+    entry->second.lru_iterator = lru_list_.begin();
+  }
+  *block = entry->second;
+  return true;
+}
+
+Status DiskFileBlockCache::Fetch(const Key& key, std::vector<char>* data) {
+  data->resize(block_size_);
+  size_t bytes_transferred;
+  TF_RETURN_IF_ERROR(block_fetcher_(key.first, key.second, block_size_,
+                                    data->data(), &bytes_transferred));
+  data->resize(bytes_transferred);
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+  }
+
+  Block block;
+  block.size = bytes_transferred;
+  {
+    mutex_lock lock(mu_);
+    block.path = io::JoinPath(cache_dir_, strings::StrCat(next_block_id_++));
+  }
+  // Failing to store the block only costs a fetch on the next read of it.
+  std::unique_ptr<WritableFile> file;
+  Status status = env_->NewWritableFile(block.path, &file);
+  if (status.ok()) status = file->Append(StringPiece(data->data(), block.size));
+  if (status.ok()) status = file->Close();
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not write the block cache file " << block.path
+                 << ": " << status;
+    env_->DeleteFile(block.path).IgnoreError();
+    return Status::OK();
+  }
+
+  mutex_lock lock(mu_);
+  auto entry = block_map_.find(key);
+  if (entry != block_map_.end()) {
+    // Another thread fetched the same block concurrently.
+    RemoveBlock(entry);
+  }
+  lru_list_.push_front(key);
+  block.lru_iterator = lru_list_.begin();
+  block.timestamp = env_->NowSeconds();
+  block_map_.emplace(key, block);
+  cache_size_ += block.size;
+  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
+    RemoveBlock(block_map_.find(lru_list_.back()));
+  }
+  return Status::OK();
+}
+
+Status DiskFileBlockCache::ReadBlock(const Block& block, size_t begin,
+                                     size_t end, char* buffer) {
+  // The block may be evicted concurrently, in which case opening it fails.
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(block.path, &file));
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(begin, end - begin, &result, buffer));
+  if (result.size() != end - begin) {
+    return errors::DataLoss("Truncated block cache file ", block.path);
+  }
+  if (result.data() != buffer) {
+    memmove(buffer, result.data(), result.size());
+  }
+  return Status::OK();
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return Status::OK();
+  }
+  if (!IsCacheEnabled() || (n > max_bytes_)) {
+    // The cache is effectively disabled, so we pass the read through to the
+    // fetcher without breaking it up into blocks.
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  std::vector<char> data;
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    Key key = std::make_pair(filename, pos);
+    Block block;
+    bool cached = Lookup(key, &block);
+    size_t block_data_size;
+    if (cached) {
+      block_data_size = block.size;
+    } else {
+      TF_RETURN_IF_ERROR(Fetch(key, &data));
+      block_data_size = data.size();
+    }
+    if (offset >= pos + block_data_size) {
+      // The requested offset is at or beyond the end of the file.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                block_data_size);
+    }
+    const size_t begin = offset > pos ? offset - pos : 0;
+    const size_t end = std::min(block_data_size, offset + n - pos);
+    if (begin < end) {
+      char* dst = &buffer[total_bytes_transferred];
+      if (!cached) {
+        memcpy(dst, data.data() + begin, end - begin);
+      } else if (!ReadBlock(block, begin, end, dst).ok()) {
+        // The block file went away: fetch the block again.
+        TF_RETURN_IF_ERROR(Fetch(key, &data));
+        if (data.size() != block_data_size) {
+          return errors::Internal("Block cache contents are inconsistent.");
+        }
+        memcpy(dst, data.data() + begin, end - begin);
+      } else if (cache_stats_ != nullptr) {
+        cache_stats_->RecordCacheHitBlockSize(block_data_size);
+      }
+      total_bytes_transferred += end - begin;
+    }
+    if (block_data_size < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return Status::OK();
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
+                                                        int64 file_signature) {
+  mutex_lock lock(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    // Remove the file from cache if the signatures don't match.
+    RemoveFile_Locked(filename);
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+void DiskFileBlockCache::Flush() {
+  mutex_lock lock(mu_);
+  while (!block_map_.empty()) {
+    RemoveBlock(block_map_.begin());
+  }
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  mutex_lock lock(mu_);
+  RemoveFile_Locked(filename);
+}
+
+void DiskFileBlockCache::RemoveFile_Locked(const string& filename) {
+  Key begin = std::make_pair(filename, 0);
+  auto it = block_map_.lower_bound(begin);
+  while (it != block_map_.end() && it->first.first == filename) {
+    auto next = std::next(it);
+    RemoveBlock(it);
+    it = next;
+  }
+}
+
+void DiskFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
+  env_->DeleteFile(entry->second.path).IgnoreError();
+  lru_list_.erase(entry->second.lru_iterator);
+  cache_size_ -= entry->second.size;
+  block_map_.erase(entry);
+}
+
+}  // namespace tensorflow
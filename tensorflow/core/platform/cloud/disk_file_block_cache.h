@@ -0,0 +1,153 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief An LRU block cache of file contents, keyed by {filename, offset},
+/// that stores the blocks as files on a local disk.
+///
+/// This class is meant to hold far more data than RamFileBlockCache, e.g. a
+/// whole dataset read from a remote filesystem in every epoch, on a local SSD.
+/// Each instance keeps its blocks in its own subdirectory of `cache_dir`,
+/// which is deleted with the cache; the cache does not persist across
+/// processes.
+///
+/// Concurrent misses of the same block may each fetch it; the last fetch wins.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  DiskFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
+                     const string& cache_dir, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  ~DiskFileBlockCache() override;
+
+  /// Read `n` bytes from `filename` starting at `offset` into `out`. See
+  /// FileBlockCache::Read for the returned status.
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  // Validate the given file signature with the existing file signature in the
+  // cache. Returns true if the signature doesn't change or the file doesn't
+  // exist before. If the signature changes, update the existing signature with
+  // the new one and remove the file from cache.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64 file_signature) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached blocks for `filename`.
+  void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached data.
+  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return max_staleness_; }
+
+  /// The current size (in bytes) of the cache.
+  size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the cache is enabled. If false, the BlockFetcher callback
+  // is always executed during Read. The cache is also disabled if its
+  // directory could not be created.
+  bool IsCacheEnabled() const override {
+    return block_size_ > 0 && max_bytes_ > 0 && !cache_dir_.empty();
+  }
+
+ private:
+  /// The key type for the file block cache, a {filename, offset} pair.
+  typedef std::pair<string, size_t> Key;
+
+  /// \brief A block of a file stored on disk.
+  ///
+  /// All fields are guarded by mu_. The file at `path` is written before the
+  /// block is inserted and never modified afterwards.
+  struct Block {
+    /// The local file holding the block data.
+    string path;
+    /// The size of the block data.
+    size_t size;
+    /// A list iterator pointing to the block's position in the LRU list.
+    std::list<Key>::iterator lru_iterator;
+    /// The timestamp (seconds since epoch) at which the block was cached.
+    uint64 timestamp;
+  };
+
+  typedef std::map<Key, Block> BlockMap;
+
+  /// Find a non-stale block, and move it to the front of the LRU list.
+  bool Lookup(const Key& key, Block* block) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetch a block from the backing filesystem, and store it on disk.
+  Status Fetch(const Key& key, std::vector<char>* data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Read the bytes [begin, end) of a cached block into `buffer`.
+  Status ReadBlock(const Block& block, size_t begin, size_t end, char* buffer);
+
+  /// Remove the block `entry` from the block map and LRU list, and delete its
+  /// file.
+  void RemoveBlock(BlockMap::iterator entry) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Remove all blocks of a file, with mu_ already held.
+  void RemoveFile_Locked(const string& filename)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const size_t block_size_;
+  const size_t max_bytes_;
+  const uint64 max_staleness_;
+  const BlockFetcher block_fetcher_;
+  Env* const env_;  // not owned
+  /// The directory of this cache instance, or empty if it couldn't be created.
+  string cache_dir_;
+
+  mutable mutex mu_;
+
+  /// The block map (map from Key to Block).
+  BlockMap block_map_ TF_GUARDED_BY(mu_);
+
+  /// The LRU list of block keys. The front of the list identifies the most
+  /// recently accessed block.
+  std::list<Key> lru_list_ TF_GUARDED_BY(mu_);
+
+  /// The combined number of bytes in all of the cached blocks.
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+
+  /// The number used to name the next block file.
+  uint64 next_block_id_ TF_GUARDED_BY(mu_) = 0;
+
+  // A filename->file_signature map.
+  std::map<string, int64> file_signature_map_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
@@ -0,0 +1,226 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/cloud/now_seconds_env.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+// Returns the number of block files in the cache directories under `dir`.
+int NumBlockFiles(const string& dir) {
+  std::vector<string> files;
+  TF_CHECK_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(dir, "tf_block_cache_*", "*"), &files));
+  return files.size();
+}
+
+TEST(DiskFileBlockCacheTest, IsCacheEnabled) {
+  auto fetcher = [](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    // Do nothing.
+    return Status::OK();
+  };
+  const string dir = testing::TmpDir();
+  DiskFileBlockCache cache1(0, 0, 0, dir, fetcher);
+  DiskFileBlockCache cache2(16, 0, 0, dir, fetcher);
+  DiskFileBlockCache cache3(0, 32, 0, dir, fetcher);
+  DiskFileBlockCache cache4(16, 32, 0, dir, fetcher);
+
+  EXPECT_FALSE(cache1.IsCacheEnabled());
+  EXPECT_FALSE(cache2.IsCacheEnabled());
+  EXPECT_FALSE(cache3.IsCacheEnabled());
+  EXPECT_TRUE(cache4.IsCacheEnabled());
+}
+
+TEST(DiskFileBlockCacheTest, CacheHits) {
+  const string dir = io::JoinPath(testing::TmpDir(), "CacheHits");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    for (size_t i = 0; i < n; ++i) {
+      buffer[i] = static_cast<char>(offset + i);
+    }
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  {
+    DiskFileBlockCache cache(16, 1024, 0, dir, fetcher);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "a", 4, 24, &out));
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(NumBlockFiles(dir), 2);
+    EXPECT_EQ(cache.CacheSize(), 32);
+    ASSERT_EQ(out.size(), 24);
+    for (size_t i = 0; i < out.size(); ++i) {
+      EXPECT_EQ(out[i], static_cast<char>(4 + i));
+    }
+    // The same bytes are read back from disk.
+    TF_EXPECT_OK(ReadCache(&cache, "a", 4, 24, &out));
+    EXPECT_EQ(calls, 2);
+    ASSERT_EQ(out.size(), 24);
+    for (size_t i = 0; i < out.size(); ++i) {
+      EXPECT_EQ(out[i], static_cast<char>(4 + i));
+    }
+  }
+  // The cache directory is deleted with the cache.
+  EXPECT_EQ(NumBlockFiles(dir), 0);
+}
+
+TEST(DiskFileBlockCacheTest, OutOfRange) {
+  const string dir = testing::TmpDir();
+  const size_t file_size = 24;
+  auto fetcher = [file_size](const string& filename, size_t offset, size_t n,
+                             char* buffer, size_t* bytes_transferred) {
+    *bytes_transferred = 0;
+    if (offset < file_size) {
+      *bytes_transferred = std::min(n, file_size - offset);
+      memset(buffer, 'x', *bytes_transferred);
+    }
+    return Status::OK();
+  };
+  DiskFileBlockCache cache(16, 1024, 0, dir, fetcher);
+  std::vector<char> out;
+  // A read past the end of the file returns the bytes up to it.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 8, 32, &out));
+  EXPECT_EQ(out.size(), 16);
+  // Again, from the cached partial block.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 8, 32, &out));
+  EXPECT_EQ(out.size(), 16);
+  // A read starting past the end of the file fails.
+  EXPECT_TRUE(errors::IsOutOfRange(ReadCache(&cache, "a", 28, 4, &out)));
+}
+
+TEST(DiskFileBlockCacheTest, LRU) {
+  const string dir = io::JoinPath(testing::TmpDir(), "LRU");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  std::vector<size_t> calls;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls.push_back(offset);
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  DiskFileBlockCache cache(16, 32, 0, dir, fetcher);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 16, 16, &out));
+  // Touch the first block, so that the next fetch evicts the second one.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 32, 16, &out));
+  EXPECT_EQ(cache.CacheSize(), 32);
+  EXPECT_EQ(NumBlockFiles(dir), 2);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, std::vector<size_t>({0, 16, 32}));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 16, 16, &out));
+  EXPECT_EQ(calls, std::vector<size_t>({0, 16, 32, 16}));
+}
+
+TEST(DiskFileBlockCacheTest, MaxStaleness) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  std::unique_ptr<NowSecondsEnv> env(new NowSecondsEnv);
+  DiskFileBlockCache cache(8, 32, 2 /* max staleness */, testing::TmpDir(),
+                           fetcher, env.get());
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 8, &out));
+  env->SetNowSeconds(2);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 8, &out));
+  EXPECT_EQ(calls, 1);
+  env->SetNowSeconds(4);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 8, &out));
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(DiskFileBlockCacheTest, RemoveFileAndFlush) {
+  const string dir = io::JoinPath(testing::TmpDir(), "RemoveFileAndFlush");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  DiskFileBlockCache cache(16, 1024, 0, dir, fetcher);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 32, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(NumBlockFiles(dir), 3);
+  cache.RemoveFile("a");
+  EXPECT_EQ(NumBlockFiles(dir), 1);
+  EXPECT_EQ(cache.CacheSize(), 16);
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 3);
+  cache.Flush();
+  EXPECT_EQ(NumBlockFiles(dir), 0);
+  EXPECT_EQ(cache.CacheSize(), 0);
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 4);
+}
+
+TEST(DiskFileBlockCacheTest, ValidateAndUpdateFileSignature) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  DiskFileBlockCache cache(16, 32, 0, testing::TmpDir(), fetcher);
+  std::vector<char> out;
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("a", 321));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
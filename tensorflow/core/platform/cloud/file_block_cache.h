@@ -56,6 +56,15 @@ class FileBlockCacheStatsInterface {
   /// RecordBlockLoadRequest is called to record the size of a missed block.
   virtual void RecordCacheMissBlockSize(size_t bytes_transferred) = 0;
 
+  /// RecordCacheReadAheadBlockSize is called to record the size of a block
+  /// fetched ahead of sequential reads.
+  virtual void RecordCacheReadAheadBlockSize(size_t bytes_transferred) {}
+
+  /// RecordCacheReadAheadHitBlockSize is called, in addition to
+  /// RecordCacheHitBlockSize, to record the size of a hit block that was
+  /// fetched ahead.
+  virtual void RecordCacheReadAheadHitBlockSize(size_t bytes_transferred) {}
+
   virtual ~FileBlockCacheStatsInterface() = default;
 };
 
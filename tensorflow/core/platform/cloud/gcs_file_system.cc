@@ -19,10 +19,12 @@ limitations under the License.
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/platform/strcat.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #endif
 #include "absl/base/macros.h"
 #include "json/json.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
@@ -47,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 #ifdef _WIN32
@@ -143,12 +147,43 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // default as the multiple API calls required add a risk of stranding temporary
 // objects.
 constexpr char kComposeAppend[] = "compose";
+// The environment variable that enables parallel composite uploads of writable
+// files, in parts of this many MB. See
+// GcsFileSystem::SetParallelUploadPartSize.
+constexpr char kParallelUploadPartSize[] = "GCS_PARALLEL_UPLOAD_PART_SIZE_MB";
+// The number of parts of a writable file uploaded concurrently.
+constexpr int kParallelUploadThreads = 8;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
 
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return Status::OK();
 }
 
+/// Copies the bytes [begin, end) of the file `src` to a new file `dst`.
+Status CopyFileRange(const string& src, uint64 begin, uint64 end,
+                     const string& dst) {
+  std::ifstream in(src, std::ifstream::binary);
+  in.seekg(begin);
+  std::ofstream out(dst, std::ofstream::binary);
+  std::unique_ptr<char[]> buffer(new char[kReadAppendableFileBufferSize]);
+  for (uint64 pos = begin; pos < end;) {
+    const size_t n = std::min<uint64>(kReadAppendableFileBufferSize, end - pos);
+    in.read(buffer.get(), n);
+    out.write(buffer.get(), n);
+    if (!in.good() || !out.good()) {
+      return errors::Internal("Could not copy the internal temporary file.");
+    }
+    pos += n;
+  }
+  out.close();
+  if (!out.good()) {
+    return errors::Internal("Could not copy the internal temporary file.");
+  }
+  return Status::OK();
+}
+
 /// Appends a trailing slash if the name doesn't already have one.
 string MaybeAppendSlash(const string& name) {
   if (name.empty()) {
@@ -281,6 +316,32 @@ class GcsRandomAccessFile : public RandomAccessFile {
     return read_fn_(filename_, offset, n, result, scratch);
   }
 
+  /// Issues the reads in parallel, so that the ranged GETs of requests
+  /// missing the block cache overlap. Thread safe.
+  void ReadAsync(std::vector<ReadRequest>* requests,
+                 std::function<void(const Status&)> done) const override {
+    if (requests->size() <= 1) {
+      RandomAccessFile::ReadAsync(requests, std::move(done));
+      return;
+    }
+    struct State {
+      std::atomic<size_t> pending;
+      std::function<void(const Status&)> done;
+    };
+    auto state = std::make_shared<State>();
+    state->pending = requests->size();
+    state->done = std::move(done);
+    for (ReadRequest& request : *requests) {
+      Env::Default()->SchedClosure([this, requests, &request, state]() {
+        request.status = read_fn_(filename_, request.offset, request.n,
+                                  &request.result, request.scratch);
+        if (state->pending.fetch_sub(1) == 1) {
+          state->done(MultiReadStatus(*requests));
+        }
+      });
+    }
+  }
+
  private:
   /// The filename of this file.
   const string filename_;
@@ -416,6 +477,7 @@ class GcsWritableFile : public WritableFile {
                   GcsFileSystem::TimeoutConfig* timeouts,
                   std::function<void()> file_cache_erase,
                   RetryConfig retry_config, bool compose_append,
+                  uint64 parallel_upload_part_size,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller)
       : bucket_(bucket),
@@ -427,6 +489,8 @@ class GcsWritableFile : public WritableFile {
         retry_config_(retry_config),
         compose_append_(compose_append),
         start_offset_(0),
+        parallel_upload_part_size_(compose_append ? 0
+                                                  : parallel_upload_part_size),
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)) {
@@ -448,6 +512,7 @@ class GcsWritableFile : public WritableFile {
                   GcsFileSystem::TimeoutConfig* timeouts,
                   std::function<void()> file_cache_erase,
                   RetryConfig retry_config, bool compose_append,
+                  uint64 parallel_upload_part_size,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller)
       : bucket_(bucket),
@@ -459,6 +524,8 @@ class GcsWritableFile : public WritableFile {
         retry_config_(retry_config),
         compose_append_(compose_append),
         start_offset_(0),
+        parallel_upload_part_size_(compose_append ? 0
+                                                  : parallel_upload_part_size),
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)) {
@@ -471,6 +538,9 @@ class GcsWritableFile : public WritableFile {
 
   ~GcsWritableFile() override {
     Close().IgnoreError();
+    // Waits for the part uploads still running if Close() failed.
+    part_upload_pool_.reset();
+    DeleteParts();
     std::remove(tmp_content_filename_.c_str());
   }
 
@@ -483,6 +553,9 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
+    if (parallel_upload_part_size_ > 0) {
+      return StartPartUploads();
+    }
     return Status::OK();
   }
 
@@ -492,6 +565,7 @@ class GcsWritableFile : public WritableFile {
       Status sync_status = Sync();
       if (sync_status.ok()) {
         outfile_.close();
+        DeleteParts();
       }
       return sync_status;
     }
@@ -542,6 +616,9 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    if (parts_end_ > 0) {
+      return ComposePartsImpl();
+    }
     UploadSessionHandle session_handle;
     uint64 start_offset = 0;
     string object_to_upload = object_;
@@ -601,6 +678,215 @@ class GcsWritableFile : public WritableFile {
     return upload_status;
   }
 
+  /// Schedules the upload of every full part written since the last call.
+  Status StartPartUploads() {
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    if (file_size - parts_end_ < parallel_upload_part_size_) {
+      return Status::OK();
+    }
+    // The part uploads read the temporary file by name.
+    outfile_.flush();
+    if (!outfile_.good()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    if (part_upload_pool_ == nullptr) {
+      part_upload_pool_.reset(new thread::ThreadPool(
+          Env::Default(), "gcs_part_upload", kParallelUploadThreads));
+    }
+    while (file_size - parts_end_ >= parallel_upload_part_size_) {
+      const uint64 begin = parts_end_;
+      const uint64 end = begin + parallel_upload_part_size_;
+      const string object = GetPartObject(begin);
+      size_t index;
+      {
+        mutex_lock l(parts_mu_);
+        index = parts_.size();
+        parts_.push_back({object, begin, end, Status::OK()});
+        ++pending_parts_;
+      }
+      part_upload_pool_->Schedule([this, index, object, begin, end]() {
+        const Status status = UploadPart(object, begin, end);
+        mutex_lock l(parts_mu_);
+        parts_[index].status = status;
+        --pending_parts_;
+        parts_cv_.notify_all();
+      });
+      parts_end_ = end;
+    }
+    return Status::OK();
+  }
+
+  /// Waits for the part uploads, uploads the data past the last full part,
+  /// and composes all of them into the object.
+  Status ComposePartsImpl() {
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    std::vector<Part> parts;
+    {
+      mutex_lock l(parts_mu_);
+      while (pending_parts_ > 0) {
+        parts_cv_.wait(l);
+      }
+      parts = parts_;
+    }
+    std::vector<string> sources;
+    for (size_t i = 0; i < parts.size(); ++i) {
+      const Part& part = parts[i];
+      if (!part.status.ok()) {
+        // Parts that failed in the background get a second chance here.
+        TF_RETURN_IF_ERROR(UploadPart(part.object, part.begin, part.end));
+        mutex_lock l(parts_mu_);
+        parts_[i].status = Status::OK();
+      }
+      sources.push_back(part.object);
+    }
+    string tail_object;
+    if (file_size > parts_end_) {
+      tail_object = GetPartObject(parts_end_);
+      TF_RETURN_IF_ERROR(UploadPart(tail_object, parts_end_, file_size));
+      sources.push_back(tail_object);
+    }
+    TF_RETURN_IF_ERROR(ComposeObjects(sources, object_));
+    // The next Sync() uploads the data past the last full part again.
+    if (!tail_object.empty()) {
+      DeleteObject(tail_object);
+    }
+    file_cache_erase_();
+    return Status::OK();
+  }
+
+  /// Uploads the bytes [begin, end) of the temporary file to `object`.
+  Status UploadPart(const string& object, uint64 begin, uint64 end) {
+    string part_filename;
+    TF_RETURN_IF_ERROR(GetTmpFilename(&part_filename));
+    auto remove_part_file = gtl::MakeCleanup(
+        [&part_filename] { std::remove(part_filename.c_str()); });
+    TF_RETURN_IF_ERROR(
+        CopyFileRange(tmp_content_filename_, begin, end, part_filename));
+
+    const uint64 size = end - begin;
+    const string gcs_path = GetGcsPathWithObject(object);
+    UploadSessionHandle session_handle;
+    TF_RETURN_IF_ERROR(
+        session_creator_(0, object, bucket_, size, gcs_path, &session_handle));
+    uint64 already_uploaded = 0;
+    bool first_attempt = true;
+    const Status upload_status = RetryingUtils::CallWithRetries(
+        [&]() {
+          if (session_handle.resumable && !first_attempt) {
+            bool completed;
+            TF_RETURN_IF_ERROR(status_poller_(session_handle.session_uri, size,
+                                              gcs_path, &completed,
+                                              &already_uploaded));
+            if (completed) {
+              return Status::OK();
+            }
+          }
+          first_attempt = false;
+          return object_uploader_(session_handle.session_uri, 0,
+                                  already_uploaded, part_filename, size,
+                                  gcs_path);
+        },
+        retry_config_);
+    if (upload_status.code() == errors::Code::NOT_FOUND) {
+      // As in SyncImpl(), the whole part is uploaded again by the next
+      // Sync().
+      return errors::Unavailable(
+          strings::StrCat("Upload to ", gcs_path,
+                          " failed, caused by: ", upload_status.ToString()));
+    }
+    return upload_status;
+  }
+
+  /// Composes `sources` into `destination`, through intermediate objects if
+  /// there are more sources than a single compose request accepts.
+  Status ComposeObjects(std::vector<string> sources,
+                        const string& destination) {
+    std::vector<string> intermediates;
+    auto delete_intermediates = gtl::MakeCleanup([this, &intermediates] {
+      for (const string& object : intermediates) {
+        DeleteObject(object);
+      }
+    });
+    for (int round = 0; sources.size() > kMaxComposeSources; ++round) {
+      std::vector<string> composed;
+      for (size_t i = 0; i < sources.size(); i += kMaxComposeSources) {
+        const std::vector<string> group(
+            sources.begin() + i,
+            sources.begin() + std::min(sources.size(), i + kMaxComposeSources));
+        const string object = strings::StrCat(
+            io::Dirname(object_), "/.tmpcompose/", io::Basename(object_),
+            ".compose.", round, ".", i / kMaxComposeSources);
+        TF_RETURN_IF_ERROR(ComposeRequest(group, object));
+        composed.push_back(object);
+        intermediates.push_back(object);
+      }
+      sources.swap(composed);
+    }
+    return ComposeRequest(sources, destination);
+  }
+
+  /// Issues a single compose request of at most kMaxComposeSources objects.
+  Status ComposeRequest(const std::vector<string>& sources,
+                        const string& destination) {
+    VLOG(3) << "ComposeRequest: " << sources.size() << " objects to "
+            << GetGcsPathWithObject(destination);
+    std::vector<string> source_names;
+    for (const string& source : sources) {
+      source_names.push_back(strings::StrCat("{'name': '", source, "'}"));
+    }
+    const string request_body =
+        strings::StrCat("{'sourceObjects': [",
+                        absl::StrJoin(source_names, ","), "]}");
+    return RetryingUtils::CallWithRetries(
+        [&]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(destination),
+                                          "/compose"));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(),
+                                     request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(
+              request->Send(), " when composing to ",
+              GetGcsPathWithObject(destination));
+          return Status::OK();
+        },
+        retry_config_);
+  }
+
+  /// Deletes a temporary object, logging rather than returning failures.
+  void DeleteObject(const string& object) {
+    const Status status =
+        filesystem_->DeleteFile(GetGcsPathWithObject(object), nullptr);
+    if (!status.ok()) {
+      LOG(WARNING) << "Could not delete the temporary object "
+                   << GetGcsPathWithObject(object) << ": " << status;
+    }
+  }
+
+  /// Deletes the uploaded parts.
+  void DeleteParts() {
+    std::vector<Part> parts;
+    {
+      mutex_lock l(parts_mu_);
+      parts.swap(parts_);
+    }
+    for (const Part& part : parts) {
+      DeleteObject(part.object);
+    }
+  }
+
+  string GetPartObject(uint64 begin) const {
+    return strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                           io::Basename(object_), ".part.", begin);
+  }
+
   Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -708,6 +994,24 @@ class GcsWritableFile : public WritableFile {
   RetryConfig retry_config_;
   bool compose_append_;
   uint64 start_offset_;
+
+  // A [begin, end) range of the temporary file uploaded to its own object.
+  struct Part {
+    string object;
+    uint64 begin;
+    uint64 end;
+    Status status;
+  };
+  // The part size of parallel composite uploads, or 0 if disabled.
+  const uint64 parallel_upload_part_size_;
+  // The end of the last part scheduled for upload.
+  uint64 parts_end_ = 0;
+  mutex parts_mu_;
+  condition_variable parts_cv_;
+  std::vector<Part> parts_ TF_GUARDED_BY(parts_mu_);
+  int pending_parts_ TF_GUARDED_BY(parts_mu_) = 0;
+  std::unique_ptr<thread::ThreadPool> part_upload_pool_;
+
   // Callbacks to the file system used to upload object into GCS.
   const SessionCreator session_creator_;
   const ObjectUploader object_uploader_;
@@ -779,12 +1083,17 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kReadAheadBlocks, strings::safe_strtou64, &value)) {
+    read_ahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "read-ahead blocks = " << read_ahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -905,6 +1214,10 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   } else {
     compose_append_ = false;
   }
+
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value)) {
+    parallel_upload_part_size_ = value * 1024 * 1024;
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -1017,7 +1330,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), read_ahead_blocks_));
   return file_block_cache;
 }
 
@@ -1268,7 +1582,8 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
-      compose_append_, session_creator, object_uploader, status_poller));
+      compose_append_, parallel_upload_part_size_, session_creator,
+      object_uploader, status_poller));
   return Status::OK();
 }
 
@@ -1335,7 +1650,8 @@ Status GcsFileSystem::NewAppendableFile(const string& fname,
   result->reset(new GcsWritableFile(
       bucket, object, this, old_content_filename, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
-      compose_append_, session_creator, object_uploader, status_poller));
+      compose_append_, parallel_upload_part_size_, session_creator,
+      object_uploader, status_poller));
   return Status::OK();
 }
 
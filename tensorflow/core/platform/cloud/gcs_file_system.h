@@ -50,6 +50,11 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the maximum number of blocks fetched
+// ahead of sequential reads. Read-ahead fetches share the GCS throttle with
+// all other requests.
+constexpr char kReadAheadBlocks[] = "GCS_READ_CACHE_READ_AHEAD_BLOCKS";
+constexpr size_t kDefaultReadAheadBlocks = 0;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -183,6 +188,14 @@ class GcsFileSystem : public FileSystem {
   /// Set an object to collect file block cache stats.
   void SetCacheStats(FileBlockCacheStatsInterface* cache_stats);
 
+  /// Upload writable files in parts of `part_size` bytes, in parallel and
+  /// while they are still being written, and compose the parts into the
+  /// object on Sync(). 0, the default, uploads each file in one request.
+  /// Does not apply in compose append mode.
+  void SetParallelUploadPartSize(uint64 part_size) {
+    parallel_upload_part_size_ = part_size;
+  }
+
   /// These accessors are mainly for testing purposes, to verify that the
   /// environment variables that control these parameters are handled correctly.
   size_t block_size() {
@@ -203,6 +216,9 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  uint64 parallel_upload_part_size() const {
+    return parallel_upload_part_size_;
+  }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -403,6 +419,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks the block cache fetches ahead of sequential
+  // reads.
+  size_t read_ahead_blocks_ = kDefaultReadAheadBlocks;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -421,6 +441,7 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<BucketLocationCache> bucket_location_cache_;
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
+  uint64 parallel_upload_part_size_ = 0;
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -38,14 +39,23 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     if (BlockNotStale(entry->second)) {
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
+        if (entry->second->prefetched) {
+          cache_stats_->RecordCacheReadAheadHitBlockSize(
+              entry->second->data.size());
+        }
       }
+      entry->second->prefetched = false;
       return entry->second;
     } else {
       // Remove the stale block and continue.
       RemoveFile_Locked(key.first);
     }
   }
+  return Insert(key);
+}
 
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -81,13 +91,15 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
 
   // Check for inconsistent state. If there is a block later in the same file
   // in the cache, and our current block is not block size, this likely means
-  // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // we have inconsistent state within the cache. Blocks fetched by read-ahead
+  // and not read since may lie past the end of the file, and do not count.
+  // Note: it's possible some incomplete reads may still go undetected.
   if (block->data.size() < block_size_) {
-    Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    for (auto it = block_map_.upper_bound(key);
+         it != block_map_.end() && it->first.first == key.first; ++it) {
+      if (!it->second->prefetched) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -97,7 +109,8 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
 }
 
 Status RamFileBlockCache::MaybeFetch(const Key& key,
-                                     const std::shared_ptr<Block>& block) {
+                                     const std::shared_ptr<Block>& block,
+                                     bool read_ahead) {
   bool downloaded_block = false;
   auto reconcile_state =
       gtl::MakeCleanup([this, &downloaded_block, &key, &block] {
@@ -135,7 +148,11 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
         status.Update(block_fetcher_(key.first, key.second, block_size_,
                                      block->data.data(), &bytes_transferred));
         if (cache_stats_ != nullptr) {
-          cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+          if (read_ahead) {
+            cache_stats_->RecordCacheReadAheadBlockSize(bytes_transferred);
+          } else {
+            cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+          }
         }
         block->mu.lock();  // Reacquire the lock immediately afterwards
         if (status.ok()) {
@@ -165,6 +182,57 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
       "Control flow should never reach the end of RamFileBlockCache::Fetch.");
 }
 
+size_t RamFileBlockCache::UpdateReadAhead(const string& filename,
+                                          size_t offset, size_t n) {
+  // Bounds the memory used to track files that are never removed.
+  constexpr size_t kMaxReadAheadFiles = 1024;
+  mutex_lock lock(mu_);
+  if (read_ahead_state_.size() >= kMaxReadAheadFiles &&
+      read_ahead_state_.find(filename) == read_ahead_state_.end()) {
+    read_ahead_state_.clear();
+  }
+  ReadAheadState& state = read_ahead_state_[filename];
+  if (offset == state.next_offset && offset > 0) {
+    // Keep the read-ahead within half of the cache, so that blocks fetched
+    // ahead are not evicted before they are read.
+    const size_t max_window =
+        std::min(max_read_ahead_blocks_, max_bytes_ / block_size_ / 2);
+    state.window = std::min(max_window, std::max<size_t>(1, 2 * state.window));
+  } else {
+    state.window = 0;
+  }
+  state.next_offset = offset + n;
+  return state.window;
+}
+
+void RamFileBlockCache::ReadAhead(const string& filename, size_t offset,
+                                  size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; ++i) {
+    Key key = std::make_pair(filename, offset + i * block_size_);
+    std::shared_ptr<Block> block;
+    {
+      mutex_lock lock(mu_);
+      if (block_map_.find(key) != block_map_.end()) continue;
+      block = Insert(key);
+      block->prefetched = true;
+    }
+    read_ahead_pool_->Schedule([this, key, block]() {
+      {
+        mutex_lock lock(mu_);
+        // The block was evicted before its turn came.
+        if (block->timestamp == 0) return;
+      }
+      Status status = MaybeFetch(key, block, /*read_ahead=*/true);
+      if (status.ok()) status = UpdateLRU(key, block);
+      // A failed block is fetched again by the next read of it.
+      if (!status.ok()) {
+        VLOG(1) << "Read-ahead of " << key.first << "@" << key.second
+                << " failed: " << status;
+      }
+    });
+  }
+}
+
 Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
                                char* buffer, size_t* bytes_transferred) {
   *bytes_transferred = 0;
@@ -176,6 +244,8 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     // fetcher without breaking it up into blocks.
     return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
   }
+  const size_t read_ahead_blocks =
+      read_ahead_pool_ ? UpdateReadAhead(filename, offset, n) : 0;
   // Calculate the block-aligned start and end of the read.
   size_t start = block_size_ * (offset / block_size_);
   size_t finish = block_size_ * ((offset + n) / block_size_);
@@ -220,10 +290,14 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
-      break;
+      *bytes_transferred = total_bytes_transferred;
+      return Status::OK();
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  if (read_ahead_blocks > 0) {
+    ReadAhead(filename, finish, read_ahead_blocks);
+  }
   return Status::OK();
 }
 
@@ -272,6 +346,7 @@ void RamFileBlockCache::Flush() {
   lru_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
+  read_ahead_state_.clear();
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -280,6 +355,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  read_ahead_state_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
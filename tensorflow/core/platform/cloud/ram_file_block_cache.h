@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -38,6 +39,11 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// With `max_read_ahead_blocks` > 0, sequential reads of a file also fetch the
+/// blocks following them in the background. The read-ahead window starts at
+/// one block and doubles with every sequential read, up to
+/// `max_read_ahead_blocks`; a non-sequential read resets it.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -51,21 +57,29 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_read_ahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_read_ahead_blocks_(max_read_ahead_blocks) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (IsCacheEnabled() && max_read_ahead_blocks_ > 0) {
+      read_ahead_pool_.reset(new thread::ThreadPool(
+          env_, "TF_read_ahead_FBC", max_read_ahead_blocks_));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying read_ahead_pool_ waits for the scheduled fetches.
+    read_ahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -131,6 +145,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of sequential reads.
+  const size_t max_read_ahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -175,6 +191,8 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was created by read-ahead and not read since.
+    bool prefetched = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -197,7 +215,23 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
-  Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
+  /// Insert a new empty block for a Key missing from the block cache.
+  std::shared_ptr<Block> Insert(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fetch the block unless it is already fetched. `read_ahead` tells whether
+  /// the fetch is issued by read-ahead rather than by a reader.
+  Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block,
+                    bool read_ahead = false) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Record a read of `n` bytes at `offset`, and return the number of blocks
+  /// to fetch ahead of it.
+  size_t UpdateReadAhead(const string& filename, size_t offset, size_t n)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Schedule background fetches of the `num_blocks` blocks of `filename`
+  /// starting at the block-aligned `offset` that are not already cached.
+  void ReadAhead(const string& filename, size_t offset, size_t num_blocks)
       TF_LOCKS_EXCLUDED(mu_);
 
   /// Trim the block cache to make room for another entry.
@@ -221,6 +255,17 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads fetching blocks ahead of sequential reads, if enabled.
+  std::unique_ptr<thread::ThreadPool> read_ahead_pool_;
+
+  /// \brief The read-ahead state of a file.
+  struct ReadAheadState {
+    /// The offset just past the previous read of the file.
+    size_t next_offset = 0;
+    /// The number of blocks to fetch ahead of the next sequential read.
+    size_t window = 0;
+  };
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -243,6 +288,9 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The read-ahead state of the files being read, if read-ahead is enabled.
+  std::map<string, ReadAheadState> read_ahead_state_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cloud/now_seconds_env.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -566,5 +568,79 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ReadAhead) {
+  const size_t block_size = 16;
+  mutex mu;
+  std::vector<size_t> fetched;
+  auto fetcher = [&mu, &fetched](const string& filename, size_t offset,
+                                 size_t n, char* buffer,
+                                 size_t* bytes_transferred) {
+    {
+      mutex_lock lock(mu);
+      fetched.push_back(offset);
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  std::vector<char> out;
+  {
+    RamFileBlockCache cache(block_size, 64 * block_size, 0, fetcher,
+                            Env::Default(), 4 /* max_read_ahead_blocks */);
+    // The window grows to 1, 2 and then 4 blocks past each read.
+    for (int i = 0; i < 4; ++i) {
+      TF_EXPECT_OK(ReadCache(&cache, "", i * block_size, block_size, &out));
+      EXPECT_EQ(out.size(), block_size);
+    }
+    // Destroying the cache waits for the read-ahead to finish.
+  }
+  std::sort(fetched.begin(), fetched.end());
+  std::vector<size_t> expected;
+  for (int i = 0; i < 8; ++i) expected.push_back(i * block_size);
+  EXPECT_EQ(fetched, expected);
+}
+
+TEST(RamFileBlockCacheTest, NoReadAheadForRandomReads) {
+  const size_t block_size = 16;
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 64 * block_size, 0, fetcher,
+                          Env::Default(), 4 /* max_read_ahead_blocks */);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, block_size, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "", 4 * block_size, block_size, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "", 2 * block_size, block_size, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "", 8 * block_size, block_size, &out));
+  EXPECT_EQ(calls, 4);
+}
+
+TEST(RamFileBlockCacheTest, ReadAheadPastEndOfFile) {
+  const size_t block_size = 16;
+  const size_t file_size = 2 * block_size + 4;
+  auto fetcher = [file_size](const string& filename, size_t offset, size_t n,
+                             char* buffer, size_t* bytes_transferred) {
+    *bytes_transferred = offset < file_size ? std::min(n, file_size - offset)
+                                            : 0;
+    memset(buffer, 'x', *bytes_transferred);
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 64 * block_size, 0, fetcher,
+                          Env::Default(), 4 /* max_read_ahead_blocks */);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, block_size / 2, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "", block_size / 2, block_size / 2, &out));
+  // This read fetches the last, partial block and the one past it ahead.
+  TF_EXPECT_OK(ReadCache(&cache, "", block_size, block_size / 2, &out));
+  // The empty block fetched ahead does not make the partial one inconsistent.
+  TF_EXPECT_OK(ReadCache(&cache, "", 2 * block_size, block_size, &out));
+  EXPECT_EQ(out.size(), 4);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -17,10 +17,15 @@ limitations under the License.
 
 #include <time.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+
 #include "nsync_cv.h"       // NOLINT
 #include "nsync_mu.h"       // NOLINT
 #include "nsync_mu_wait.h"  // NOLINT
 #include "nsync_time.h"     // NOLINT
+#include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
@@ -36,17 +41,159 @@ static inline nsync::nsync_mu *mu_cast(internal::MuData *mu) {
   return reinterpret_cast<nsync::nsync_mu *>(mu);
 }
 
+// The address the function using this macro returns to, which is in the code
+// that called it.
+#if defined(__GNUC__)
+#define TF_MUTEX_CALL_SITE() __builtin_return_address(0)
+#else
+#define TF_MUTEX_CALL_SITE() nullptr
+#endif
+
+namespace {
+
+// Period of the sampling of contended acquisitions, 0 if disabled.
+std::atomic<int64> contention_sampling_period{0};
+
+// Contention stats of one (mutex, call site) pair. The stats of all the pairs
+// are kept in an open addressing hash table of these, which is updated with
+// atomics only: it cannot lock a mutex, nor allocate.
+struct ContentionSlot {
+  // Hash of the pair, 0 while the slot is free.
+  std::atomic<uint64> key;
+  std::atomic<const void *> mutex;
+  std::atomic<const void *> call_site;
+  std::atomic<int64> num_contentions;
+  std::atomic<int64> total_wait_ns;
+  std::atomic<int64> max_wait_ns;
+};
+
+constexpr int kNumContentionSlots = 1024;
+// Number of slots probed for a pair before dropping its contention.
+constexpr int kMaxContentionProbes = 64;
+
+// Zero initialized, as it has static storage duration and trivial
+// constructors, so it can be used by mutexes constructed at any time.
+ContentionSlot contention_slots[kNumContentionSlots];
+
+uint64 ContentionKey(const void *mu, const void *call_site) {
+  constexpr uint64 kMul = 0x9ddfea08eb382d69ULL;
+  uint64 key = reinterpret_cast<uintptr_t>(mu) * kMul;
+  key = (key ^ (key >> 29) ^ reinterpret_cast<uintptr_t>(call_site)) * kMul;
+  return key == 0 ? 1 : key;
+}
+
+void RecordContention(const void *mu, const void *call_site, int64 wait_ns) {
+  const uint64 key = ContentionKey(mu, call_site);
+  for (int probe = 0; probe < kMaxContentionProbes; ++probe) {
+    ContentionSlot &slot =
+        contention_slots[(key + probe) % kNumContentionSlots];
+    uint64 slot_key = slot.key.load(std::memory_order_acquire);
+    if (slot_key == 0 &&
+        slot.key.compare_exchange_strong(slot_key, key,
+                                         std::memory_order_acq_rel)) {
+      slot.mutex.store(mu, std::memory_order_relaxed);
+      slot.call_site.store(call_site, std::memory_order_relaxed);
+      slot_key = key;
+    }
+    if (slot_key != key) continue;
+    slot.num_contentions.fetch_add(1, std::memory_order_relaxed);
+    slot.total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    int64 max_wait_ns = slot.max_wait_ns.load(std::memory_order_relaxed);
+    while (wait_ns > max_wait_ns &&
+           !slot.max_wait_ns.compare_exchange_weak(
+               max_wait_ns, wait_ns, std::memory_order_relaxed)) {
+    }
+    return;
+  }
+}
+
+// Locks `mu`, the representation of `m`, in shared mode if `shared` is true.
+// Times the acquisition if it is contended and sampled.
+void LockAndSampleContention(const mutex *m, nsync::nsync_mu *mu, bool shared,
+                             const void *call_site, int64 sampling_period) {
+  if (shared ? nsync::nsync_mu_rtrylock(mu) : nsync::nsync_mu_trylock(mu)) {
+    return;
+  }
+  // Number of contentions of this thread until the next sampled one.
+  static thread_local int64 contentions_to_next_sample = 0;
+  if (--contentions_to_next_sample > 0) {
+    shared ? nsync::nsync_mu_rlock(mu) : nsync::nsync_mu_lock(mu);
+    return;
+  }
+  contentions_to_next_sample = sampling_period;
+  const auto start = std::chrono::steady_clock::now();
+  shared ? nsync::nsync_mu_rlock(mu) : nsync::nsync_mu_lock(mu);
+  const int64 wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+  RecordContention(m, call_site, wait_ns);
+}
+
+}  // namespace
+
+void SetMutexContentionSamplingPeriod(int64 sampling_period) {
+  contention_sampling_period.store(std::max<int64>(sampling_period, 0),
+                                   std::memory_order_relaxed);
+}
+
+std::vector<MutexContentionStats> GetMutexContentionStats() {
+  std::vector<MutexContentionStats> result;
+  for (const ContentionSlot &slot : contention_slots) {
+    if (slot.key.load(std::memory_order_acquire) == 0) continue;
+    MutexContentionStats stats;
+    stats.mutex = slot.mutex.load(std::memory_order_relaxed);
+    stats.call_site = slot.call_site.load(std::memory_order_relaxed);
+    stats.num_contentions =
+        slot.num_contentions.load(std::memory_order_relaxed);
+    stats.total_wait_ns = slot.total_wait_ns.load(std::memory_order_relaxed);
+    stats.max_wait_ns = slot.max_wait_ns.load(std::memory_order_relaxed);
+    if (stats.num_contentions > 0) result.push_back(stats);
+  }
+  std::sort(result.begin(), result.end(),
+            [](const MutexContentionStats &a, const MutexContentionStats &b) {
+              return a.total_wait_ns > b.total_wait_ns;
+            });
+  return result;
+}
+
+void ResetMutexContentionStats() {
+  for (ContentionSlot &slot : contention_slots) {
+    slot.num_contentions.store(0, std::memory_order_relaxed);
+    slot.total_wait_ns.store(0, std::memory_order_relaxed);
+    slot.max_wait_ns.store(0, std::memory_order_relaxed);
+    slot.key.store(0, std::memory_order_release);
+  }
+}
+
 mutex::mutex() { nsync::nsync_mu_init(mu_cast(&mu_)); }
 
 mutex::mutex(LinkerInitialized x) {}
 
-void mutex::lock() { nsync::nsync_mu_lock(mu_cast(&mu_)); }
+void mutex::lock() {
+  const int64 sampling_period =
+      contention_sampling_period.load(std::memory_order_relaxed);
+  if (TF_PREDICT_FALSE(sampling_period > 0)) {
+    LockAndSampleContention(this, mu_cast(&mu_), /*shared=*/false,
+                            TF_MUTEX_CALL_SITE(), sampling_period);
+    return;
+  }
+  nsync::nsync_mu_lock(mu_cast(&mu_));
+}
 
 bool mutex::try_lock() { return nsync::nsync_mu_trylock(mu_cast(&mu_)) != 0; };
 
 void mutex::unlock() { nsync::nsync_mu_unlock(mu_cast(&mu_)); }
 
-void mutex::lock_shared() { nsync::nsync_mu_rlock(mu_cast(&mu_)); }
+void mutex::lock_shared() {
+  const int64 sampling_period =
+      contention_sampling_period.load(std::memory_order_relaxed);
+  if (TF_PREDICT_FALSE(sampling_period > 0)) {
+    LockAndSampleContention(this, mu_cast(&mu_), /*shared=*/true,
+                            TF_MUTEX_CALL_SITE(), sampling_period);
+    return;
+  }
+  nsync::nsync_mu_rlock(mu_cast(&mu_));
+}
 
 bool mutex::try_lock_shared() {
   return nsync::nsync_mu_rtrylock(mu_cast(&mu_)) != 0;
@@ -0,0 +1,218 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/platform/default/posix_io_uring.h"
+
+#include <errno.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TF_POSIX_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+#include <deque>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+#if defined(TF_POSIX_HAS_IO_URING)
+
+namespace {
+
+template <typename T>
+T* RingField(void* ring, unsigned offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+void* MapRing(int ring_fd, size_t size, off_t offset) {
+  void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  return ring == MAP_FAILED ? nullptr : ring;
+}
+
+}  // namespace
+
+std::unique_ptr<PosixIoUring> PosixIoUring::Create(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  const int ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+  if (ring_fd < 0) return nullptr;
+
+  std::unique_ptr<PosixIoUring> ring(new PosixIoUring);
+  ring->ring_fd_ = ring_fd;
+  ring->sq_entries_ = params.sq_entries;
+  ring->sq_ring_size_ =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sq_ring_ = MapRing(ring_fd, ring->sq_ring_size_, IORING_OFF_SQ_RING);
+  ring->cq_ring_ = MapRing(ring_fd, ring->cq_ring_size_, IORING_OFF_CQ_RING);
+  ring->sqes_ = MapRing(ring_fd, ring->sqes_size_, IORING_OFF_SQES);
+  if (ring->sq_ring_ == nullptr || ring->cq_ring_ == nullptr ||
+      ring->sqes_ == nullptr) {
+    return nullptr;
+  }
+
+  ring->sq_head_ = RingField<unsigned>(ring->sq_ring_, params.sq_off.head);
+  ring->sq_tail_ = RingField<unsigned>(ring->sq_ring_, params.sq_off.tail);
+  ring->sq_mask_ =
+      RingField<unsigned>(ring->sq_ring_, params.sq_off.ring_mask);
+  ring->sq_array_ = RingField<unsigned>(ring->sq_ring_, params.sq_off.array);
+  ring->cq_head_ = RingField<unsigned>(ring->cq_ring_, params.cq_off.head);
+  ring->cq_tail_ = RingField<unsigned>(ring->cq_ring_, params.cq_off.tail);
+  ring->cq_mask_ =
+      RingField<unsigned>(ring->cq_ring_, params.cq_off.ring_mask);
+  ring->cqes_ = RingField<void>(ring->cq_ring_, params.cq_off.cqes);
+  return ring;
+}
+
+PosixIoUring::~PosixIoUring() {
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0) close(ring_fd_);
+}
+
+bool PosixIoUring::ReadAll(std::vector<Read>* reads) {
+  std::vector<iovec> iovs(reads->size());
+  std::deque<size_t> queued;
+  for (size_t i = 0; i < reads->size(); ++i) {
+    Read& read = (*reads)[i];
+    read.bytes_read = 0;
+    read.error = 0;
+    if (read.n > 0) queued.push_back(i);
+  }
+
+  io_uring_sqe* sqes = static_cast<io_uring_sqe*>(sqes_);
+  io_uring_cqe* cqes = static_cast<io_uring_cqe*>(cqes_);
+  unsigned in_flight = 0;
+  while (!queued.empty() || in_flight > 0) {
+    // Fills the submission queue. Keeping at most sq_entries_ reads in
+    // flight also keeps the completion queue, twice as large, from
+    // overflowing.
+    unsigned tail = *sq_tail_;
+    unsigned to_submit = 0;
+    while (!queued.empty() && in_flight < sq_entries_) {
+      const size_t i = queued.front();
+      queued.pop_front();
+      Read& read = (*reads)[i];
+      iovs[i].iov_base = read.dst + read.bytes_read;
+      iovs[i].iov_len = read.n - read.bytes_read;
+
+      const unsigned index = tail & *sq_mask_;
+      io_uring_sqe* sqe = &sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = read.fd;
+      sqe->off = read.offset + read.bytes_read;
+      sqe->addr = reinterpret_cast<uint64_t>(&iovs[i]);
+      sqe->len = 1;
+      sqe->user_data = i;
+      sq_array_[index] = index;
+      ++tail;
+      ++to_submit;
+      ++in_flight;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // Submits the new reads and waits for at least one completion.
+    while (true) {
+      const int submitted = syscall(__NR_io_uring_enter, ring_fd_, to_submit,
+                                    1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (submitted >= 0) {
+        to_submit -= submitted;
+        if (to_submit == 0) break;
+      } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        // Takes back the reads the kernel did not accept, and waits for the
+        // others, which may still write into the buffers of `*reads`.
+        const int error = errno;
+        __atomic_store_n(sq_tail_, tail - to_submit, __ATOMIC_RELEASE);
+        WaitForCompletions(in_flight - to_submit);
+        errno = error;
+        return false;
+      }
+    }
+
+    unsigned head = *cq_head_;
+    const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != cq_tail; ++head) {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask_];
+      const size_t i = cqe.user_data;
+      Read& read = (*reads)[i];
+      --in_flight;
+      if (cqe.res < 0) {
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+          queued.push_back(i);
+        } else {
+          read.error = -cqe.res;
+        }
+      } else if (cqe.res > 0) {
+        read.bytes_read += cqe.res;
+        if (read.bytes_read < read.n &&
+            (read.alignment == 0 || read.bytes_read % read.alignment == 0)) {
+          queued.push_back(i);
+        }
+      }
+      // A zero result is EOF and leaves the read short.
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+  return true;
+}
+
+void PosixIoUring::WaitForCompletions(unsigned in_flight) {
+  while (in_flight > 0) {
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                nullptr, 0) < 0 &&
+        errno != EINTR) {
+      // Returning would let the caller free buffers the kernel writes into.
+      LOG(FATAL) << "Failed to wait for io_uring reads: " << strerror(errno);
+    }
+    unsigned head = *cq_head_;
+    const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != cq_tail && in_flight > 0; ++head) --in_flight;
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+}
+
+#else  // TF_POSIX_HAS_IO_URING
+
+std::unique_ptr<PosixIoUring> PosixIoUring::Create(unsigned entries) {
+  errno = ENOSYS;
+  return nullptr;
+}
+
+PosixIoUring::~PosixIoUring() {}
+
+bool PosixIoUring::ReadAll(std::vector<Read>* reads) {
+  errno = ENOSYS;
+  return false;
+}
+
+void PosixIoUring::WaitForCompletions(unsigned in_flight) {}
+
+#endif  // TF_POSIX_HAS_IO_URING
+
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+#define TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+namespace tensorflow {
+
+// A minimal io_uring instance (Linux 5.1+) that issues batches of preads,
+// used by PosixFileSystem when TF_POSIX_IO_URING is set. It talks to the
+// kernel through the raw syscalls, so that it needs no liburing.
+//
+// Not thread safe.
+class PosixIoUring {
+ public:
+  // One range to read.
+  struct Read {
+    int fd = -1;
+    uint64_t offset = 0;
+    size_t n = 0;
+    char* dst = nullptr;
+    // If nonzero, a short read is only resumed when it ends on a multiple of
+    // `alignment`, as O_DIRECT requires, and is taken as EOF otherwise.
+    size_t alignment = 0;
+
+    // Bytes stored in `dst[0..n-1]`, fewer than `n` at EOF or on error.
+    size_t bytes_read = 0;
+    // errno of the failed read, or 0.
+    int error = 0;
+  };
+
+  // Returns nullptr, with errno set, if io_uring is not available.
+  static std::unique_ptr<PosixIoUring> Create(unsigned entries);
+
+  ~PosixIoUring();
+
+  // Reads all of `*reads`, resubmitting short reads until EOF. Keeps up to
+  // `entries` reads in flight and submits each batch with a single syscall.
+  //
+  // Returns false, with errno set, if the ring itself failed. The outputs
+  // of `*reads` are then meaningless and the ring must not be reused. The
+  // kernel no longer writes into the buffers of `*reads` in either case.
+  bool ReadAll(std::vector<Read>* reads);
+
+ private:
+  PosixIoUring() = default;
+
+  // Waits for the completion of the `in_flight` reads the kernel accepted,
+  // and drops their results.
+  void WaitForCompletions(unsigned in_flight);
+
+  int ring_fd_ = -1;
+  unsigned sq_entries_ = 0;
+
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  void* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  void* cqes_ = nullptr;
+
+  PosixIoUring(const PosixIoUring&) = delete;
+  void operator=(const PosixIoUring&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_IO_URING_H_
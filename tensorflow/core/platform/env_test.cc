@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/env.h"
 
+#include <stdlib.h>
 #include <sys/stat.h>
 
 #include "tensorflow/core/framework/graph.pb.h"
@@ -113,6 +114,37 @@ TEST_F(DefaultEnvTest, ReadFileToString) {
   }
 }
 
+TEST_F(DefaultEnvTest, MultiRead) {
+  const string filename = io::JoinPath(BaseDir(), "multi_read");
+  const string input = CreateTestFile(env_, filename, 10000);
+  // Without io_uring support, TF_POSIX_IO_URING falls back to pread.
+  for (const char* io_uring : {"0", "1", "direct"}) {
+    setenv("TF_POSIX_IO_URING", io_uring, 1);
+    std::unique_ptr<RandomAccessFile> f;
+    TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+    unsetenv("TF_POSIX_IO_URING");
+
+    std::vector<char> scratch(3 * 5000);
+    std::vector<RandomAccessFile::ReadRequest> requests(3);
+    requests[0].offset = 4097;
+    requests[0].n = 5000;
+    requests[1].offset = 0;
+    requests[1].n = 10;
+    requests[2].offset = 9000;
+    requests[2].n = 5000;
+    for (int i = 0; i < 3; ++i) {
+      requests[i].scratch = scratch.data() + 5000 * i;
+    }
+    EXPECT_EQ(error::OUT_OF_RANGE, f->MultiRead(&requests).code()) << io_uring;
+    TF_EXPECT_OK(requests[0].status);
+    EXPECT_EQ(input.substr(4097, 5000), requests[0].result) << io_uring;
+    TF_EXPECT_OK(requests[1].status);
+    EXPECT_EQ(input.substr(0, 10), requests[1].result) << io_uring;
+    EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+    EXPECT_EQ(input.substr(9000), requests[2].result) << io_uring;
+  }
+}
+
 TEST_F(DefaultEnvTest, ReadWriteBinaryProto) {
   const GraphDef proto = CreateTestProto();
   const string filename = strings::StrCat(BaseDir(), "binary_proto");
@@ -31,6 +31,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/scanner.h"
 #include "tensorflow/core/platform/str_util.h"
@@ -451,4 +452,33 @@ std::string FileSystem::DecodeTransaction(const TransactionToken* token) {
   return "No Transaction";
 }
 
+void RandomAccessFile::ReadAsync(
+    std::vector<ReadRequest>* requests,
+    std::function<void(const Status&)> done) const {
+  for (ReadRequest& request : *requests) {
+    request.status =
+        Read(request.offset, request.n, &request.result, request.scratch);
+  }
+  done(MultiReadStatus(*requests));
+}
+
+Status RandomAccessFile::MultiRead(std::vector<ReadRequest>* requests) const {
+  Notification n;
+  Status status;
+  ReadAsync(requests, [&n, &status](const Status& s) {
+    status = s;
+    n.Notify();
+  });
+  n.WaitForNotification();
+  return status;
+}
+
+Status RandomAccessFile::MultiReadStatus(
+    const std::vector<ReadRequest>& requests) {
+  for (const ReadRequest& request : requests) {
+    if (!request.status.ok()) return request.status;
+  }
+  return Status::OK();
+}
+
 }  // namespace tensorflow
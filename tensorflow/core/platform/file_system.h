@@ -751,6 +751,38 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// \brief One of the ranges read by `ReadAsync`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// Must point at `n` writable bytes.
+    char* scratch = nullptr;
+
+    /// Set when the read completes, as `Read` sets its `result` and return
+    /// value.
+    StringPiece result;
+    Status status;
+  };
+
+  /// \brief Reads every range of `*requests`, then calls `done`.
+  ///
+  /// `done` receives OK if every read succeeded, and otherwise the status
+  /// of the first failed request. Each request's own `result` and `status`
+  /// are set either way. `*requests` and the scratch buffers must be live
+  /// until `done` is called, which may happen on another thread or before
+  /// `ReadAsync` returns.
+  ///
+  /// The default implementation calls `Read` for each range in turn on the
+  /// calling thread. Filesystems with a high per-read latency should
+  /// override it to issue the reads concurrently.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(std::vector<ReadRequest>* requests,
+                         std::function<void(const Status&)> done) const;
+
+  /// \brief Blocking form of `ReadAsync`.
+  tensorflow::Status MultiRead(std::vector<ReadRequest>* requests) const;
+
   // TODO(ebrevdo): Remove this ifdef when absl is updated.
 #if defined(PLATFORM_GOOGLE)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
@@ -762,6 +794,11 @@ class RandomAccessFile {
   }
 #endif
 
+ protected:
+  /// \brief Returns the status `ReadAsync` passes to `done` for `requests`.
+  static tensorflow::Status MultiReadStatus(
+      const std::vector<ReadRequest>& requests);
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
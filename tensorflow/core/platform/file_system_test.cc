@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/platform/file_system.h"
 
+#include <string.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
@@ -306,4 +309,68 @@ TEST(TestFileSystemTest, RootDirectory) {
   EXPECT_EQ("./test", results[0]);
 }
 
+// A file holding `contents` in memory.
+class StringRandomAccessFile : public RandomAccessFile {
+ public:
+  explicit StringRandomAccessFile(const string& contents)
+      : contents_(contents) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    if (offset > contents_.size()) {
+      *result = StringPiece();
+      return errors::OutOfRange("Read past the end");
+    }
+    const size_t available = std::min(n, contents_.size() - offset);
+    memcpy(scratch, contents_.data() + offset, available);
+    *result = StringPiece(scratch, available);
+    if (available < n) return errors::OutOfRange("Read less bytes");
+    return Status::OK();
+  }
+
+ private:
+  const string contents_;
+};
+
+TEST(RandomAccessFileTest, MultiRead) {
+  StringRandomAccessFile file("0123456789");
+  char scratch[8];
+  std::vector<RandomAccessFile::ReadRequest> requests(2);
+  requests[0].offset = 6;
+  requests[0].n = 3;
+  requests[0].scratch = scratch;
+  requests[1].offset = 1;
+  requests[1].n = 2;
+  requests[1].scratch = scratch + 3;
+  TF_EXPECT_OK(file.MultiRead(&requests));
+  EXPECT_EQ(requests[0].result, "678");
+  EXPECT_EQ(requests[1].result, "12");
+}
+
+TEST(RandomAccessFileTest, ReadAsyncReportsFirstError) {
+  StringRandomAccessFile file("0123456789");
+  char scratch[12];
+  std::vector<RandomAccessFile::ReadRequest> requests(3);
+  requests[0].offset = 0;
+  requests[0].n = 4;
+  requests[0].scratch = scratch;
+  requests[1].offset = 8;
+  requests[1].n = 4;
+  requests[1].scratch = scratch + 4;
+  requests[2].offset = 20;
+  requests[2].n = 4;
+  requests[2].scratch = scratch + 8;
+  bool done = false;
+  file.ReadAsync(&requests, [&done, &requests](const Status& s) {
+    EXPECT_EQ(s, requests[1].status);
+    done = true;
+  });
+  EXPECT_TRUE(done);
+  TF_EXPECT_OK(requests[0].status);
+  EXPECT_EQ(requests[0].result, "0123");
+  EXPECT_TRUE(errors::IsOutOfRange(requests[1].status));
+  EXPECT_EQ(requests[1].result, "89");
+  EXPECT_TRUE(errors::IsOutOfRange(requests[2].status));
+}
+
 }  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 // for std::try_to_lock_t and std::cv_status
 #include <condition_variable>  // NOLINT
 #include <mutex>               // NOLINT
+#include <vector>
 
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -250,6 +251,39 @@ inline ConditionResult WaitForMilliseconds(mutex_lock* mu,
   return (s == std::cv_status::timeout) ? kCond_Timeout : kCond_MaybeNotified;
 }
 
+// Contention profiling of mutexes, to find the locks that limit scaling.
+//
+// While enabled, one in every `sampling_period` contended acquisitions made by
+// a thread through mutex::lock() or mutex::lock_shared() is timed, and the
+// time spent waiting is attributed to the mutex and to the code that acquired
+// it. Disabled by default, in which case the only cost is a relaxed atomic
+// load per acquisition. The profiler enables it through
+// ProfileOptions.mutex_contention_sampling_period.
+struct MutexContentionStats {
+  // Address of the mutex, which may have been destroyed since.
+  const void* mutex = nullptr;
+  // Return address into the code that called lock() or lock_shared(), or
+  // nullptr where the compiler does not provide it.
+  const void* call_site = nullptr;
+  // Number of sampled contended acquisitions.
+  int64 num_contentions = 0;
+  // Total and longest time waited by the sampled acquisitions.
+  int64 total_wait_ns = 0;
+  int64 max_wait_ns = 0;
+};
+
+// Enables contention profiling with the given sampling period, or disables it
+// if `sampling_period` <= 0. The recorded stats are kept when disabling.
+void SetMutexContentionSamplingPeriod(int64 sampling_period);
+
+// Returns the stats recorded since the last ResetMutexContentionStats(), in
+// decreasing order of total wait time. A bounded number of (mutex, call site)
+// pairs are tracked; the contentions of the pairs that do not fit are dropped.
+std::vector<MutexContentionStats> GetMutexContentionStats();
+
+// Clears the recorded stats. Contentions recorded concurrently may be lost.
+void ResetMutexContentionStats();
+
 // ------------------------------------------------------------
 // Implementation details follow.   Clients should ignore them.
 
@@ -14,6 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/mutex.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -35,5 +41,63 @@ struct SharedMutexLockTest {
   mutex mu;
 };
 
+// Locks `mu` while another thread waits to acquire it, in shared mode if
+// `shared` is true.
+void Contend(mutex* mu, bool shared) {
+  mu->lock();
+  Notification started;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "contender", [&] {
+        started.Notify();
+        if (shared) {
+          tf_shared_lock l(*mu);
+        } else {
+          mutex_lock l(*mu);
+        }
+      }));
+  started.WaitForNotification();
+  Env::Default()->SleepForMicroseconds(20 * 1000);
+  mu->unlock();
+}
+
+std::vector<MutexContentionStats> StatsOf(const mutex& mu) {
+  std::vector<MutexContentionStats> result;
+  for (const MutexContentionStats& stats : GetMutexContentionStats()) {
+    if (stats.mutex == &mu) result.push_back(stats);
+  }
+  return result;
+}
+
+TEST(MutexContentionTest, DisabledByDefault) {
+  ResetMutexContentionStats();
+  mutex mu;
+  Contend(&mu, /*shared=*/false);
+  EXPECT_TRUE(StatsOf(mu).empty());
+}
+
+TEST(MutexContentionTest, SamplesContendedAcquisitions) {
+  ResetMutexContentionStats();
+  SetMutexContentionSamplingPeriod(1);
+  mutex mu;
+  Contend(&mu, /*shared=*/false);
+  Contend(&mu, /*shared=*/true);
+  {
+    // Uncontended acquisitions are not sampled.
+    mutex_lock l(mu);
+  }
+  SetMutexContentionSamplingPeriod(0);
+
+  int64 num_contentions = 0;
+  for (const MutexContentionStats& stats : StatsOf(mu)) {
+    num_contentions += stats.num_contentions;
+    EXPECT_GT(stats.total_wait_ns, 0);
+    EXPECT_LE(stats.max_wait_ns, stats.total_wait_ns);
+  }
+  EXPECT_EQ(2, num_contentions);
+
+  ResetMutexContentionStats();
+  EXPECT_TRUE(StatsOf(mu).empty());
+}
+
 }  // namespace
 }  // namespace tensorflow
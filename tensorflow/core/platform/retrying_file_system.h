@@ -189,6 +189,25 @@ class RetryingRandomAccessFile : public RandomAccessFile {
         retry_config_);
   }
 
+  void ReadAsync(std::vector<ReadRequest>* requests,
+                 std::function<void(const Status&)> done) const override {
+    // Lets the base file issue all the reads at once, then retries the
+    // failed ones one at a time.
+    base_file_->ReadAsync(
+        requests, [this, requests, done](const Status& status) {
+          if (!status.ok()) {
+            for (ReadRequest& request : *requests) {
+              if (request.status.ok() || errors::IsOutOfRange(request.status)) {
+                continue;
+              }
+              request.status = Read(request.offset, request.n, &request.result,
+                                    request.scratch);
+            }
+          }
+          done(MultiReadStatus(*requests));
+        });
+  }
+
  private:
   std::unique_ptr<RandomAccessFile> base_file_;
   const RetryConfig retry_config_;
@@ -278,6 +278,45 @@ TEST(RetryingFileSystemTest, NewRandomAccessFile_AllRetriesFailed) {
       << status;
 }
 
+TEST(RetryingFileSystemTest, NewRandomAccessFile_MultiReadRetriesFailedReads) {
+  // Configure the mock base random access file.
+  ExpectedCalls expected_file_calls(
+      {std::make_tuple("Read", errors::Unavailable("Something is wrong")),
+       std::make_tuple("Read", Status::OK()),
+       std::make_tuple("Read", errors::OutOfRange("Past the end")),
+       std::make_tuple("Read", Status::OK())});
+  std::unique_ptr<RandomAccessFile> base_file(
+      new MockRandomAccessFile(expected_file_calls));
+
+  // Configure the mock base file system.
+  ExpectedCalls expected_fs_calls(
+      {std::make_tuple("NewRandomAccessFile", Status::OK())});
+  std::unique_ptr<MockFileSystem> base_fs(
+      new MockFileSystem(expected_fs_calls));
+  base_fs->random_access_file_to_return = std::move(base_file);
+  RetryingFileSystem<MockFileSystem> fs(
+      std::move(base_fs), RetryConfig(0 /* init_delay_time_us */));
+
+  // Retrieve the wrapped random access file.
+  std::unique_ptr<RandomAccessFile> random_access_file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("filename.txt", nullptr, &random_access_file));
+
+  // Only the first read is retried; the out of range one is not.
+  char scratch[30];
+  std::vector<RandomAccessFile::ReadRequest> requests(3);
+  for (int i = 0; i < 3; ++i) {
+    requests[i].offset = 10 * i;
+    requests[i].n = 10;
+    requests[i].scratch = scratch + 10 * i;
+  }
+  const auto& status = random_access_file->MultiRead(&requests);
+  EXPECT_TRUE(errors::IsOutOfRange(status)) << status;
+  TF_EXPECT_OK(requests[0].status);
+  TF_EXPECT_OK(requests[1].status);
+  EXPECT_TRUE(errors::IsOutOfRange(requests[2].status)) << requests[2].status;
+}
+
 TEST(RetryingFileSystemTest, NewRandomAccessFile_NoRetriesForSomeErrors) {
   // Configure the mock base random access file.
   ExpectedCalls expected_file_calls({
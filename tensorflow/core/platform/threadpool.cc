@@ -21,7 +21,9 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/numa.h"
@@ -149,9 +151,43 @@ void ThreadPool::ParallelFor(int64 total,
       }
       break;
     }
+    case SchedulingStrategy::kMeasuredCost: {
+      ParallelForMeasuredCostScheduling(total, fn);
+      break;
+    }
   }
 }
 
+void ThreadPool::ParallelForMeasuredCostScheduling(
+    const int64 total, const std::function<void(int64, int64)>& fn) {
+  // Below this, the clock is too coarse to measure the units reliably.
+  constexpr uint64 kMinMeasuredNanos = 5000;
+  static const double cycles_per_nano = [] {
+    const double frequency = port::NominalCPUFrequency();
+    return frequency > 0 ? frequency / 1e9 : 1.0;
+  }();
+
+  const uint64 start_nanos = EnvTime::NowNanos();
+  uint64 elapsed_nanos = 0;
+  int64 measured = 0;
+  for (int64 units = 1; measured < total && elapsed_nanos < kMinMeasuredNanos;
+       units *= 2) {
+    const int64 limit = std::min(total, measured + units);
+    fn(measured, limit);
+    measured = limit;
+    elapsed_nanos = EnvTime::NowNanos() - start_nanos;
+  }
+  if (measured == total) return;
+
+  const double cost_per_unit =
+      std::max(1.0, elapsed_nanos * cycles_per_nano / measured);
+  threadpool_device_->parallelFor(
+      total - measured, Eigen::TensorOpCost(0, 0, cost_per_unit),
+      [measured, &fn](Eigen::Index first, Eigen::Index last) {
+        fn(measured + first, measured + last);
+      });
+}
+
 void ThreadPool::TransformRangeConcurrently(
     const int64 block_size, const int64 total,
     const std::function<void(int64, int64)>& fn) {
@@ -66,7 +66,14 @@ class ThreadPool {
     // on the number of threads available in the pool. Note that when there
     // aren't enough threads in the pool to achieve full parallelism, function
     // calls will be automatically queued.
-    kFixedBlockSize
+    kFixedBlockSize,
+    // The Measured Cost scheduling strategy runs the first units of work on
+    // the calling thread, doubling their number until they took a few
+    // microseconds, and then shards the remaining units like the Adaptive
+    // strategy would with the measured cost per unit. Use it when the cost of
+    // a unit depends on the inputs too much for a static 'cost_per_unit',
+    // which is ignored.
+    kMeasuredCost
   };
 
   // Contains additional parameters for either the Adaptive or the Fixed Block
@@ -227,6 +234,10 @@ class ThreadPool {
       const int64 total, const int64 block_size,
       const std::function<void(int64, int64)>& fn);
 
+  // Runs the units of work with the Measured Cost scheduling strategy.
+  void ParallelForMeasuredCostScheduling(
+      const int64 total, const std::function<void(int64, int64)>& fn);
+
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
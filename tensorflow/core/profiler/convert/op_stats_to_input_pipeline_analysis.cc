@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
 #include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
+#include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/utils/diagnostics.h"
 #include "tensorflow/core/profiler/utils/event_span.h"
 #include "tensorflow/core/profiler/utils/hardware_type_utils.h"
@@ -430,6 +431,33 @@ std::string DatasetIntroDoc() {
   return "https://www.tensorflow.org/guide/data";
 }
 
+// Recommends speeding up the slowest stage of each analyzed tf.data input
+// pipeline.
+void TfDataBottleneckAnalysis(
+    const TfDataStats& tf_data_stats,
+    InputPipelineAnalysisRecommendation* recommendation) {
+  for (const TfDataPipelineAnalysis& pipeline : tf_data_stats.pipelines()) {
+    if (pipeline.bottleneck_index() < 0 ||
+        pipeline.bottleneck_index() >= pipeline.nodes_size()) {
+      continue;
+    }
+    const TfDataNodeAnalysis& node =
+        pipeline.nodes(pipeline.bottleneck_index());
+    std::string detail = absl::StrFormat(
+        "tf.data bottleneck: %s is the slowest stage of its input pipeline, "
+        "taking %.1f us to produce an element (%.1f us with its inputs).",
+        node.long_name(), node.self_processing_time_ns() / 1e3,
+        node.output_latency_ns() / 1e3);
+    if (node.estimated_speedup() > 1.0) {
+      absl::StrAppendFormat(&detail,
+                            " Increasing its parallelism could speed up the "
+                            "pipeline by up to %.1fx.",
+                            node.estimated_speedup());
+    }
+    *recommendation->add_details() = std::move(detail);
+  }
+}
+
 }  // namespace
 
 void GenerateHostResult(const OpMetricsDb& host_tf_metrics_db,
@@ -565,6 +593,8 @@ InputPipelineAnalysisResult ConvertOpStatsToInputPipelineAnalysis(
   GenerateHostResult(op_stats.host_op_metrics_db(), &result);
 
   InputPipelineAnalysisRecommendation recommendation = GenerateRecommendation();
+  *result.mutable_tf_data_stats() = op_stats.tf_data_stats();
+  TfDataBottleneckAnalysis(op_stats.tf_data_stats(), &recommendation);
   BottleneckAnalysis bottleneck_analysis = ComputeBottleneckAnalysis(
       result.input_time_breakdown(), result.step_details());
   result.set_input_percent(bottleneck_analysis.input_percent());
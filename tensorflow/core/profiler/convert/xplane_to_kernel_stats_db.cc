@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/kernel_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/cost_utils.h"
 #include "tensorflow/core/profiler/utils/kernel_stats_utils.h"
 #include "tensorflow/core/profiler/utils/tf_op_utils.h"
 #include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
@@ -39,6 +40,7 @@ void ConvertDeviceTraceXPlaneToKernelReports(
     const std::function<void(const XEventVisitor&, KernelReport*)>&
         on_kernel_fn,
     KernelReportMap* reports) {
+  TfOpRoofLineCostEstimator op_level_cost_estimator;
   XPlaneVisitor plane = CreateTfXPlaneVisitor(&device_trace);
   plane.ForEachLine([&](const XLineVisitor& line) {
     if (IsDerivedThreadId(line.Id())) {
@@ -49,6 +51,9 @@ void ConvertDeviceTraceXPlaneToKernelReports(
       KernelReport kernel;
 
       absl::string_view equation;
+      absl::optional<uint64> measured_flops;
+      absl::optional<uint64> measured_dram_bytes;
+      double achieved_occupancy = 0;
       event.ForEachStat([&](const tensorflow::profiler::XStatVisitor& stat) {
         if (!stat.Type().has_value()) return;
         switch (stat.Type().value()) {
@@ -67,11 +72,35 @@ void ConvertDeviceTraceXPlaneToKernelReports(
           case StatType::kEquation:
             equation = stat.StrOrRefValue();
             break;
+          case StatType::kMeasuredFlops:
+            measured_flops = stat.IntOrUintValue();
+            break;
+          case StatType::kMeasuredDramBytes:
+            measured_dram_bytes = stat.IntOrUintValue();
+            break;
+          case StatType::kAchievedOccupancy:
+            achieved_occupancy = stat.DoubleValue();
+            break;
         }
       });
 
+      KernelReportValue value;
+      if (measured_flops.has_value() && measured_dram_bytes.has_value()) {
+        value.total_flops = *measured_flops;
+        value.total_bytes_accessed = *measured_dram_bytes;
+        value.is_cost_measured = true;
+      }
+
       if (!tf_op_fullname.empty()) {
         tensorflow::profiler::TfOp tf_op = ParseTfOpFullname(tf_op_fullname);
+        if (!value.is_cost_measured && tf_op.category != Category::kUnknown) {
+          // The estimates are those of the whole op, which may launch other
+          // kernels.
+          TfOpRoofLineCostEstimator::OpRoofLineStats costs =
+              op_level_cost_estimator.Predict(event);
+          value.total_flops = costs.flops;
+          value.total_bytes_accessed = costs.bytes_accessed;
+        }
 
         if (kernel.total_duration_ns()) {
           kernel.set_op_name(tf_op.name.data(), tf_op.name.size());
@@ -93,11 +122,11 @@ void ConvertDeviceTraceXPlaneToKernelReports(
       }
 
       if (kernel.total_duration_ns()) {
-        KernelReportValue value;
         value.total_duration_ns = event.DurationNs();
         value.min_duration_ns = event.DurationNs();
         value.max_duration_ns = event.DurationNs();
         value.occurrences = 1;
+        value.occupancy_duration_ns = achieved_occupancy * event.DurationNs();
         InsertOrUpdateKernelReport(kernel, value, reports);
       }
     });
@@ -143,6 +143,38 @@ block_z:1)MULTI"},
   }
 }
 
+TEST(ConvertXplaneToKernelStats, MeasuredKernelMetrics) {
+  XSpace space;
+  XPlane* device_trace = space.add_planes();
+  XPlaneBuilder device_trace_builder(device_trace);
+  XLineBuilder line_builder = device_trace_builder.GetOrCreateLine(0);
+  for (int i = 0; i < 2; ++i) {
+    CreateXEvent(&device_trace_builder, &line_builder, "kernel_name",
+                 /*offset_ps=*/10000 * (i + 1), /*duration_ps=*/1000,
+                 {{StatType::kLevel0, "mul_786"},
+                  {StatType::kKernelDetails, "registers_per_thread:16"},
+                  {StatType::kMeasuredFlops, uint64{1000}},
+                  {StatType::kMeasuredDramBytes, uint64{4000}}});
+  }
+
+  KernelReportMap reports;
+  ConvertDeviceTraceXPlaneToKernelReports(*device_trace, {}, &reports);
+  KernelStatsDb kernel_stats;
+  CopyTopKDurationKernelReportsToDb(reports, &kernel_stats);
+
+  ASSERT_EQ(kernel_stats.reports_size(), 1);
+  const KernelReport& kernel = kernel_stats.reports(0);
+  EXPECT_EQ(kernel.total_duration_ns(), 2);
+  EXPECT_TRUE(kernel.is_cost_measured());
+  EXPECT_EQ(kernel.total_flops(), 2000);
+  EXPECT_EQ(kernel.total_bytes_accessed(), 8000);
+
+  // 1 TFLOP/s and 1000 GB/s: the ridge point is 1 FLOP/byte.
+  ClassifyKernelReports(1, 1000, &kernel_stats);
+  EXPECT_EQ(kernel_stats.reports(0).bound(), KernelReport::MEMORY_BOUND);
+  EXPECT_DOUBLE_EQ(kernel_stats.reports(0).arithmetic_intensity(), 0.25);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
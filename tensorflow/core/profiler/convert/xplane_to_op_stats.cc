@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
 #include "tensorflow/core/profiler/convert/step_events_to_steps_db.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
 #include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
+#include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/tf_function.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/event_span.h"
@@ -124,6 +126,20 @@ void ProcessHostPlane(const XPlane* host_plane, bool use_device_step_events,
   });
 }
 
+// Collects the analyses of the tf.data input pipelines added by the tf.data
+// model collector.
+void ProcessMetadataPlane(const XPlane& metadata_plane,
+                          TfDataStats* tf_data_stats) {
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(&metadata_plane);
+  plane.ForEachStat([tf_data_stats](const XStatVisitor& stat) {
+    if (stat.Type() != StatType::kTfDataStats) return;
+    TfDataStats stats;
+    if (stats.ParseFromString(stat.RawStat().bytes_value())) {
+      tf_data_stats->MergeFrom(stats);
+    }
+  });
+}
+
 }  // namespace
 
 void PropagateXSpaceDiagnosticsToOpStats(const XSpace& space,
@@ -150,6 +166,10 @@ OpStats ConvertXSpaceToOpStats(const XSpace& space,
   OpStats op_stats;
   StepEvents step_events;
   PropagateXSpaceDiagnosticsToOpStats(space, &op_stats);
+  if (const XPlane* metadata_plane =
+          FindPlaneWithName(space, kMetadataPlaneName)) {
+    ProcessMetadataPlane(*metadata_plane, op_stats.mutable_tf_data_stats());
+  }
   // Convert device planes.
   OpMetricsDbCombiner op_metrics_db_combiner(
       op_stats.mutable_device_op_metrics_db());
@@ -182,6 +202,17 @@ OpStats ConvertXSpaceToOpStats(const XSpace& space,
   if (config.contains(KERNEL_STATS_DB)) {
     CopyTopKDurationKernelReportsToDb(reports,
                                       op_stats.mutable_kernel_stats_db());
+    if (!device_planes.empty()) {
+      const PerfEnv perf_env = op_stats.has_perf_env()
+                                   ? op_stats.perf_env()
+                                   : GetPerfEnvFromXPlane(*device_planes[0]);
+      ClassifyKernelReports(perf_env.peak_tera_flops_per_second(),
+                            perf_env.peak_hbm_bw_giga_bytes_per_second(),
+                            op_stats.mutable_kernel_stats_db());
+      VLOG(1) << "Kernel roofline:\n"
+              << FormatKernelRooflineTable(op_stats.kernel_stats_db(),
+                                           /*max_kernels=*/20);
+    }
   }
 
   bool has_device = !device_planes.empty();
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
 #include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
+#include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/tf_function.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/group_events.h"
@@ -167,6 +168,25 @@ TEST(ConvertXPlaneToOpStats, PropagateAndDedupErrors) {
   EXPECT_EQ(kError, op_stats.diagnostics().errors(/*index=*/0));
 }
 
+TEST(ConvertXPlaneToOpStats, TfDataStats) {
+  XSpace space;
+  XPlaneBuilder metadata_plane(space.add_planes());
+  metadata_plane.SetName(kMetadataPlaneName);
+  TfDataStats stats;
+  TfDataPipelineAnalysis* pipeline = stats.add_pipelines();
+  pipeline->set_bottleneck_index(0);
+  pipeline->add_nodes()->set_name("ParallelMap");
+  metadata_plane.AddStatValue(*metadata_plane.GetOrCreateStatMetadata(
+                                  GetStatTypeStr(StatType::kTfDataStats)),
+                              stats);
+
+  OpStats op_stats = ConvertXSpaceToOpStats(space, {});
+  ASSERT_EQ(1, op_stats.tf_data_stats().pipelines_size());
+  EXPECT_EQ(0, op_stats.tf_data_stats().pipelines(0).bottleneck_index());
+  EXPECT_EQ("ParallelMap",
+            op_stats.tf_data_stats().pipelines(0).nodes(0).name());
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <string>
 #include <utility>
@@ -20,9 +21,13 @@ limitations under the License.
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/internal/cpu/host_tracer_utils.h"
 #include "tensorflow/core/profiler/internal/profiler_factory.h"
@@ -30,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/internal/traceme_recorder.h"
 #include "tensorflow/core/profiler/profiler_options.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
 #include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_utils.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -38,13 +44,21 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
+// Interval at which the events are drained when the events buffered per thread
+// are bounded.
+constexpr int64 kDrainIntervalMicros = 100 * 1000;
+
 // Controls TraceMeRecorder and converts TraceMeRecorder::Events into
 // RunMetadata messages.
 //
+// When max_events_per_thread > 0, a thread drains the events while recording
+// and converts them into an XPlane incrementally, which bounds the memory used
+// by the TraceMeRecorder buffers. Only CollectData(XSpace*) is supported then.
+//
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public ProfilerInterface {
  public:
-  explicit HostTracer(int host_trace_level);
+  HostTracer(int host_trace_level, size_t max_events_per_thread);
   ~HostTracer() override;
 
   // Starts recording TraceMes.
@@ -60,9 +74,18 @@ class HostTracer : public ProfilerInterface {
   Status CollectData(XSpace* space) override;
 
  private:
+  bool streaming() const { return max_events_per_thread_ > 0; }
+
+  // Pairs up and converts `events` into plane_, keeping the start events not
+  // ended yet in pending_start_events_.
+  void DrainEvents(TraceMeRecorder::Events events);
+
   // Level of host tracing.
   const int host_trace_level_;
 
+  // Maximum number of events buffered per thread, or 0 if unbounded.
+  const size_t max_events_per_thread_;
+
   // True if currently recording.
   bool recording_ = false;
 
@@ -71,10 +94,27 @@ class HostTracer : public ProfilerInterface {
 
   // Container of all traced events.
   TraceMeRecorder::Events events_;
+
+  // The following are only used when streaming(). Until Stop() joins
+  // drain_thread_, the members below it are only accessed by that thread.
+  mutex mu_;
+  condition_variable stop_cv_;
+  bool stop_draining_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> drain_thread_;
+
+  // Start events whose end events have not been drained yet.
+  TraceMeRecorder::Events pending_start_events_;
+
+  // Events drained so far.
+  XPlane plane_;
+
+  // Number of events dropped because the buffer of their thread was full.
+  uint64 num_dropped_events_ = 0;
 };
 
-HostTracer::HostTracer(int host_trace_level)
-    : host_trace_level_(host_trace_level) {}
+HostTracer::HostTracer(int host_trace_level, size_t max_events_per_thread)
+    : host_trace_level_(host_trace_level),
+      max_events_per_thread_(max_events_per_thread) {}
 
 HostTracer::~HostTracer() { Stop().IgnoreError(); }
 
@@ -82,19 +122,65 @@ Status HostTracer::Start() {
   if (recording_) {
     return errors::Internal("TraceMeRecorder already started");
   }
-  recording_ = TraceMeRecorder::Start(host_trace_level_);
+  recording_ =
+      TraceMeRecorder::Start(host_trace_level_, max_events_per_thread_);
   if (!recording_) {
     return errors::Internal("Failed to start TraceMeRecorder");
   }
   start_timestamp_ns_ = EnvTime::NowNanos();
+  if (streaming()) {
+    plane_.Clear();
+    pending_start_events_.clear();
+    num_dropped_events_ = 0;
+    {
+      mutex_lock lock(mu_);
+      stop_draining_ = false;
+    }
+    drain_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "host_tracer_drain", [this] {
+          mutex_lock lock(mu_);
+          while (!stop_draining_) {
+            stop_cv_.wait_for(lock,
+                              std::chrono::microseconds(kDrainIntervalMicros));
+            if (stop_draining_) break;
+            DrainEvents(TraceMeRecorder::Consume());
+          }
+        }));
+  }
   return Status::OK();
 }
 
+void HostTracer::DrainEvents(TraceMeRecorder::Events events) {
+  MakeCompleteEvents(&events, &pending_start_events_);
+  for (const TraceMeRecorder::ThreadEvents& thread : events) {
+    num_dropped_events_ += thread.num_dropped_events;
+  }
+  ConvertCompleteEventsToXPlane(start_timestamp_ns_, events, &plane_);
+}
+
 Status HostTracer::Stop() {
   if (!recording_) {
     return errors::Internal("TraceMeRecorder not started");
   }
-  events_ = TraceMeRecorder::Stop();
+  if (streaming()) {
+    {
+      mutex_lock lock(mu_);
+      stop_draining_ = true;
+    }
+    stop_cv_.notify_all();
+    drain_thread_.reset();  // Joins the thread.
+    DrainEvents(TraceMeRecorder::Stop());
+    // Start events without end events are not traced.
+    pending_start_events_.clear();
+    if (num_dropped_events_ > 0) {
+      LOG(WARNING) << "Dropped " << num_dropped_events_
+                   << " TraceMe events, the buffer of at most "
+                   << max_events_per_thread_
+                   << " events per thread was full.";
+    }
+  } else {
+    events_ = TraceMeRecorder::Stop();
+  }
   recording_ = false;
   return Status::OK();
 }
@@ -103,6 +189,10 @@ Status HostTracer::CollectData(RunMetadata* run_metadata) {
   if (recording_) {
     return errors::Internal("TraceMeRecorder not stopped");
   }
+  if (streaming()) {
+    return errors::Unimplemented(
+        "RunMetadata is not supported with host_tracer_max_events_per_thread");
+  }
   MakeCompleteEvents(&events_);
 
   StepStats* step_stats = run_metadata->mutable_step_stats();
@@ -144,8 +234,19 @@ Status HostTracer::CollectData(XSpace* space) {
   if (recording_) {
     return errors::Internal("TraceMeRecorder not stopped");
   }
-  MakeCompleteEvents(&events_);
   XPlane* plane = FindOrAddMutablePlaneWithName(space, kHostThreadsPlaneName);
+  if (streaming()) {
+    MergePlanes(plane_, plane);
+    plane_.Clear();
+    if (num_dropped_events_ > 0) {
+      XPlaneBuilder xplane(plane);
+      xplane.AddStatValue(*xplane.GetOrCreateStatMetadata("dropped_events"),
+                          num_dropped_events_);
+      num_dropped_events_ = 0;
+    }
+    return Status::OK();
+  }
+  MakeCompleteEvents(&events_);
   ConvertCompleteEventsToXPlane(start_timestamp_ns_, events_, plane);
   events_.clear();
   return Status::OK();
@@ -157,7 +258,9 @@ Status HostTracer::CollectData(XSpace* space) {
 std::unique_ptr<ProfilerInterface> CreateHostTracer(
     const ProfileOptions& options) {
   if (options.host_tracer_level() == 0) return nullptr;
-  return absl::make_unique<HostTracer>(options.host_tracer_level());
+  return absl::make_unique<HostTracer>(
+      options.host_tracer_level(),
+      options.host_tracer_max_events_per_thread());
 }
 
 auto register_host_tracer_factory = [] {
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/profiler/internal/cpu/host_tracer_utils.h"
 
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -51,6 +52,7 @@ void MakeCompleteEvents(TraceMeRecorder::Events* events) {
           auto* start_event = iter->second;
           event.name = std::move(start_event->name);
           event.start_time = start_event->start_time;
+          start_event->start_time = 0;
           start_events.erase(iter);
         } else {  // cross-thread
           end_events.push_back(&event);
@@ -64,11 +66,34 @@ void MakeCompleteEvents(TraceMeRecorder::Events* events) {
       auto* start_event = iter->second;
       event->name = std::move(start_event->name);
       event->start_time = start_event->start_time;
+      start_event->start_time = 0;
       start_events.erase(iter);
     }
   }
 }
 
+void MakeCompleteEvents(TraceMeRecorder::Events* events,
+                        TraceMeRecorder::Events* pending_start_events) {
+  // The pending start events go first, as they were recorded before `events`.
+  events->insert(events->begin(),
+                 std::make_move_iterator(pending_start_events->begin()),
+                 std::make_move_iterator(pending_start_events->end()));
+  pending_start_events->clear();
+  MakeCompleteEvents(events);
+  for (auto& thread : *events) {
+    TraceMeRecorder::ThreadEvents* pending = nullptr;
+    for (auto& event : thread.events) {
+      if (!IsStartEvent(event)) continue;
+      if (pending == nullptr) {
+        pending_start_events->push_back({thread.thread, {}});
+        pending = &pending_start_events->back();
+      }
+      pending->events.push_back(std::move(event));
+      event.start_time = 0;
+    }
+  }
+}
+
 void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
                                    const TraceMeRecorder::Events& events,
                                    XPlane* raw_plane) {
@@ -39,9 +39,16 @@ inline bool IsCompleteEvent(const TraceMeRecorder::Event& event) {
 }
 
 // Combine events created by TraceMe::ActivityStart and TraceMe::ActivityEnd,
-// which can be paired up by their activity_id.
+// which can be paired up by their activity_id. The paired start events are
+// cleared, leaving neither start, end nor complete events.
 void MakeCompleteEvents(TraceMeRecorder::Events* events);
 
+// Like MakeCompleteEvents, for events consumed while recording: the start
+// events in `pending_start_events`, left unpaired by a previous call, are
+// paired first, and the start events left unpaired are moved there.
+void MakeCompleteEvents(TraceMeRecorder::Events* events,
+                        TraceMeRecorder::Events* pending_start_events);
+
 // Convert complete events to XPlane format.
 void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
                                    const TraceMeRecorder::Events& events,
@@ -0,0 +1,173 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/debugging/symbolize.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/profiler_factory.h"
+#include "tensorflow/core/profiler/internal/profiler_interface.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Number of most contended (mutex, call site) pairs reported.
+constexpr int kMaxContendedLocks = 100;
+
+// Returns the name of the function containing `call_site`, followed by its
+// address.
+std::string SymbolizeCallSite(const void* call_site) {
+  if (call_site == nullptr) return "unknown";
+  char symbol[1024];
+  // The call site is a return address, which may be past the end of the
+  // calling function if that function does not return.
+  const char* pc = static_cast<const char*>(call_site) - 1;
+  const auto address = absl::Hex(reinterpret_cast<uintptr_t>(pc));
+  if (absl::Symbolize(pc, symbol, sizeof(symbol))) {
+    return absl::StrCat(symbol, " (0x", address, ")");
+  }
+  return absl::StrCat("0x", address);
+}
+
+// MutexContentionCollector samples the contended acquisitions of
+// tensorflow::mutex while tracing, and reports the locks that were waited for
+// the longest. Each (mutex, call site) pair is a line of the mutex contention
+// plane, with an event lasting the total time waited, and the plane has a
+// summary table of all the pairs.
+class MutexContentionCollector : public ProfilerInterface {
+ public:
+  explicit MutexContentionCollector(int64 sampling_period)
+      : sampling_period_(sampling_period) {}
+
+  ~MutexContentionCollector() override { Stop().IgnoreError(); }
+
+  Status Start() override {
+    if (recording_) {
+      return errors::Internal("MutexContentionCollector already started");
+    }
+    ResetMutexContentionStats();
+    start_timestamp_ns_ = EnvTime::NowNanos();
+    SetMutexContentionSamplingPeriod(sampling_period_);
+    recording_ = true;
+    return Status::OK();
+  }
+
+  Status Stop() override {
+    if (recording_) {
+      SetMutexContentionSamplingPeriod(0);
+      recording_ = false;
+    }
+    return Status::OK();
+  }
+
+  Status CollectData(RunMetadata* run_metadata) override {
+    return Status::OK();  // legacy session is not supported.
+  }
+
+  Status CollectData(XSpace* space) override {
+    std::vector<MutexContentionStats> stats = GetMutexContentionStats();
+    if (stats.empty()) return Status::OK();
+    if (stats.size() > kMaxContendedLocks) stats.resize(kMaxContendedLocks);
+
+    XPlaneBuilder xplane(
+        FindOrAddMutablePlaneWithName(space, kMutexContentionPlaneName));
+    const XStatMetadata& mutex_stat = *xplane.GetOrCreateStatMetadata(
+        GetStatTypeStr(StatType::kMutexAddress));
+    const XStatMetadata& call_site_stat =
+        *xplane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kCallSite));
+    const XStatMetadata& num_contentions_stat =
+        *xplane.GetOrCreateStatMetadata(
+            GetStatTypeStr(StatType::kNumContentions));
+    const XStatMetadata& max_wait_stat =
+        *xplane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kMaxWaitPs));
+
+    std::string summary = absl::StrFormat(
+        "%4s %12s %16s %14s %18s  %s\n", "Rank", "Contentions",
+        "Total wait (us)", "Max wait (us)", "Mutex", "Call site");
+    xplane.ReserveLines(stats.size());
+    for (int i = 0; i < stats.size(); ++i) {
+      const MutexContentionStats& lock = stats[i];
+      const std::string call_site = SymbolizeCallSite(lock.call_site);
+      const std::string mutex_name = absl::StrCat(
+          "mutex@0x", absl::Hex(reinterpret_cast<uintptr_t>(lock.mutex)));
+      absl::StrAppendFormat(&summary, "%4d %12d %16.1f %14.1f %18s  %s\n",
+                            i + 1, lock.num_contentions,
+                            lock.total_wait_ns / 1000.0,
+                            lock.max_wait_ns / 1000.0, mutex_name, call_site);
+
+      XLineBuilder line = xplane.GetOrCreateLine(i);
+      line.SetName(call_site);
+      line.SetTimestampNs(start_timestamp_ns_);
+      XEventBuilder event =
+          line.AddEvent(*xplane.GetOrCreateEventMetadata(mutex_name));
+      event.SetOffsetPs(0);
+      event.SetDurationPs(NanosToPicos(lock.total_wait_ns));
+      event.AddStatValue(mutex_stat,
+                         static_cast<uint64>(
+                             reinterpret_cast<uintptr_t>(lock.mutex)));
+      event.AddStatValue(call_site_stat, call_site);
+      event.AddStatValue(num_contentions_stat, lock.num_contentions);
+      event.AddStatValue(max_wait_stat, NanosToPicos(lock.max_wait_ns));
+    }
+    xplane.AddStatValue(*xplane.GetOrCreateStatMetadata(
+                            GetStatTypeStr(StatType::kContentionSummary)),
+                        std::move(summary));
+    ResetMutexContentionStats();
+    return Status::OK();
+  }
+
+ private:
+  const int64 sampling_period_;
+  bool recording_ = false;
+  uint64 start_timestamp_ns_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MutexContentionCollector);
+};
+
+std::unique_ptr<ProfilerInterface> CreateMutexContentionCollector(
+    const ProfileOptions& options) {
+  if (options.mutex_contention_sampling_period() <= 0) return nullptr;
+  return absl::make_unique<MutexContentionCollector>(
+      options.mutex_contention_sampling_period());
+}
+
+}  // namespace
+
+auto register_mutex_contention_collector_factory = [] {
+  RegisterProfilerFactory(&CreateMutexContentionCollector);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace tensorflow
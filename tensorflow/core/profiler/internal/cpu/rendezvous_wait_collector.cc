@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/profiler_factory.h"
+#include "tensorflow/core/profiler/internal/profiler_interface.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Number of edges waited for the longest which are reported.
+constexpr int kMaxWaitedEdges = 100;
+
+// RendezvousWaitCollector accounts for the time Recvs wait for their tensor
+// while tracing, and reports the edges waited for the longest. Their producers
+// are the ones on the critical path of model-parallel steps. Each edge is a
+// line of the rendezvous wait plane, with an event lasting the total time
+// waited, and the plane has a summary table of the edges.
+class RendezvousWaitCollector : public ProfilerInterface {
+ public:
+  RendezvousWaitCollector() = default;
+
+  ~RendezvousWaitCollector() override { Stop().IgnoreError(); }
+
+  Status Start() override {
+    if (recording_) {
+      return errors::Internal("RendezvousWaitCollector already started");
+    }
+    ResetRendezvousWaitStats();
+    start_timestamp_ns_ = EnvTime::NowNanos();
+    SetRendezvousWaitAccounting(true);
+    recording_ = true;
+    return Status::OK();
+  }
+
+  Status Stop() override {
+    if (recording_) {
+      SetRendezvousWaitAccounting(false);
+      recording_ = false;
+    }
+    return Status::OK();
+  }
+
+  Status CollectData(RunMetadata* run_metadata) override {
+    return Status::OK();  // legacy session is not supported.
+  }
+
+  Status CollectData(XSpace* space) override {
+    std::vector<RendezvousWaitStats> stats = GetRendezvousWaitStats();
+    if (stats.empty()) return Status::OK();
+    if (stats.size() > kMaxWaitedEdges) stats.resize(kMaxWaitedEdges);
+
+    XPlaneBuilder xplane(
+        FindOrAddMutablePlaneWithName(space, kRendezvousWaitPlaneName));
+    const XStatMetadata& send_device_stat =
+        *xplane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kSendDevice));
+    const XStatMetadata& recv_device_stat =
+        *xplane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kRecvDevice));
+    const XStatMetadata& num_waits_stat =
+        *xplane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kNumWaits));
+    const XStatMetadata& max_wait_stat =
+        *xplane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kMaxWaitPs));
+
+    std::string summary =
+        absl::StrFormat("%4s %10s %16s %14s  %s\n", "Rank", "Waits",
+                        "Total wait (us)", "Max wait (us)", "Edge");
+    xplane.ReserveLines(stats.size());
+    for (int i = 0; i < stats.size(); ++i) {
+      const RendezvousWaitStats& edge = stats[i];
+      absl::StrAppendFormat(&summary, "%4d %10d %16d %14d  %s (%s -> %s)\n",
+                            i + 1, edge.num_waits, edge.total_wait_us,
+                            edge.max_wait_us, edge.edge_name, edge.src_device,
+                            edge.dst_device);
+
+      XLineBuilder line = xplane.GetOrCreateLine(i);
+      line.SetName(absl::StrCat(edge.src_device, " -> ", edge.dst_device));
+      line.SetTimestampNs(start_timestamp_ns_);
+      XEventBuilder event =
+          line.AddEvent(*xplane.GetOrCreateEventMetadata(edge.edge_name));
+      event.SetOffsetPs(0);
+      event.SetDurationPs(MicrosToPicos(edge.total_wait_us));
+      event.AddStatValue(send_device_stat, edge.src_device);
+      event.AddStatValue(recv_device_stat, edge.dst_device);
+      event.AddStatValue(num_waits_stat, edge.num_waits);
+      event.AddStatValue(max_wait_stat, MicrosToPicos(edge.max_wait_us));
+    }
+    xplane.AddStatValue(*xplane.GetOrCreateStatMetadata(
+                            GetStatTypeStr(StatType::kRendezvousWaitSummary)),
+                        std::move(summary));
+    ResetRendezvousWaitStats();
+    return Status::OK();
+  }
+
+ private:
+  bool recording_ = false;
+  uint64 start_timestamp_ns_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RendezvousWaitCollector);
+};
+
+std::unique_ptr<ProfilerInterface> CreateRendezvousWaitCollector(
+    const ProfileOptions& options) {
+  // The waits are accounted for along with the host activities.
+  if (options.host_tracer_level() == 0) return nullptr;
+  return absl::make_unique<RendezvousWaitCollector>();
+}
+
+}  // namespace
+
+auto register_rendezvous_wait_collector_factory = [] {
+  RegisterProfilerFactory(&CreateRendezvousWaitCollector);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,193 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/internal/profiler_factory.h"
+#include "tensorflow/core/profiler/internal/profiler_interface.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using data::model::Model;
+using data::model::NodeAnalysis;
+
+// Interval between two analyses of the tf.data models while tracing.
+constexpr int64 kAnalysisIntervalMs = 2000;
+
+// Converts the analysis of a model, returned by `Model::Analyze()`. The slowest
+// stage of the pipeline is the compute-bound node that takes the longest to
+// produce an element by itself.
+TfDataPipelineAnalysis ConvertNodeAnalyses(
+    const std::vector<NodeAnalysis>& analyses, int64 timestamp_ns) {
+  TfDataPipelineAnalysis result;
+  result.set_timestamp_ns(timestamp_ns);
+  result.set_bottleneck_index(-1);
+  double bottleneck_time = -1;
+  for (const NodeAnalysis& analysis : analyses) {
+    TfDataNodeAnalysis* node = result.add_nodes();
+    node->set_name(analysis.name);
+    node->set_long_name(analysis.long_name);
+    node->set_num_elements(analysis.num_elements);
+    node->set_output_latency_ns(analysis.output_time);
+    node->set_self_processing_time_ns(analysis.self_processing_time);
+    node->set_parallelism(analysis.parallelism);
+    node->set_input_bound(analysis.input_bound);
+    node->set_estimated_speedup(analysis.estimated_speedup);
+    const double self_time =
+        analysis.self_processing_time / analysis.parallelism;
+    if (!analysis.input_bound && self_time > bottleneck_time) {
+      bottleneck_time = self_time;
+      result.set_bottleneck_index(result.nodes_size() - 1);
+    }
+  }
+  return result;
+}
+
+// TfDataModelCollector periodically analyzes the autotuning models of the
+// tf.data input pipelines of the process while tracing, and adds the last
+// analysis of each pipeline to the metadata plane.
+class TfDataModelCollector : public ProfilerInterface {
+ public:
+  TfDataModelCollector() = default;
+
+  ~TfDataModelCollector() override { Stop().IgnoreError(); }
+
+  Status Start() override {
+    mutex_lock l(mu_);
+    if (thread_) {
+      return errors::Internal("TfDataModelCollector already started");
+    }
+    stop_ = false;
+    pipelines_.clear();
+    thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tf_data_model_collector", [this] { Run(); }));
+    return Status::OK();
+  }
+
+  Status Stop() override {
+    std::unique_ptr<Thread> thread;
+    {
+      mutex_lock l(mu_);
+      stop_ = true;
+      cond_var_.notify_all();
+      thread = std::move(thread_);
+    }
+    // Joins the thread, which analyzes the models one last time.
+    thread.reset();
+    return Status::OK();
+  }
+
+  Status CollectData(RunMetadata* run_metadata) override {
+    return Status::OK();  // legacy session is not supported.
+  }
+
+  Status CollectData(XSpace* space) override {
+    TfDataStats stats;
+    {
+      mutex_lock l(mu_);
+      for (auto& pair : pipelines_) {
+        *stats.add_pipelines() = std::move(pair.second);
+      }
+      pipelines_.clear();
+    }
+    if (stats.pipelines_size() > 0) {
+      XPlane* plane = FindOrAddMutablePlaneWithName(space, kMetadataPlaneName);
+      XPlaneBuilder xplane(plane);
+      xplane.AddStatValue(*xplane.GetOrCreateStatMetadata(
+                              GetStatTypeStr(StatType::kTfDataStats)),
+                          stats);
+    }
+    return Status::OK();
+  }
+
+ private:
+  void Run() {
+    bool stop = false;
+    while (!stop) {
+      {
+        mutex_lock l(mu_);
+        if (!stop_) {
+          WaitForMilliseconds(&l, &cond_var_, kAnalysisIntervalMs);
+        }
+        stop = stop_;
+      }
+      Analyze();
+    }
+  }
+
+  void Analyze() {
+    const int64 now_ns = EnvTime::NowNanos();
+    std::vector<std::pair<const Model*, TfDataPipelineAnalysis>> analyses;
+    Model::ForEachModel([&](Model* model) {
+      std::vector<NodeAnalysis> node_analyses = model->Analyze();
+      if (!node_analyses.empty()) {
+        analyses.emplace_back(model,
+                              ConvertNodeAnalyses(node_analyses, now_ns));
+      }
+    });
+    mutex_lock l(mu_);
+    for (auto& pair : analyses) {
+      pipelines_[pair.first] = std::move(pair.second);
+    }
+  }
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_ TF_GUARDED_BY(mu_);
+  // The last analysis of each model. Models destroyed during the session keep
+  // their last analysis.
+  absl::flat_hash_map<const Model*, TfDataPipelineAnalysis> pipelines_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TfDataModelCollector);
+};
+
+std::unique_ptr<ProfilerInterface> CreateTfDataModelCollector(
+    const ProfileOptions& options) {
+  if (options.host_tracer_level() == 0) return nullptr;
+  return absl::make_unique<TfDataModelCollector>();
+}
+
+}  // namespace
+
+auto register_tf_data_model_collector_factory = [] {
+  RegisterProfilerFactory(&CreateTfDataModelCollector);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/internal/gpu/cupti_tracer.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
@@ -428,6 +431,8 @@ void AddKernelActivityEvent(CuptiTraceCollector *collector,
   event.kernel_info.grid_x = kernel->gridX;
   event.kernel_info.grid_y = kernel->gridY;
   event.kernel_info.grid_z = kernel->gridZ;
+  event.kernel_metrics = collector->kernel_metric_map()->Take(
+      event.device_id, event.correlation_id);
   collector->AddEvent(std::move(event));
 }
 
@@ -579,6 +584,294 @@ void AddUnifiedMemoryActivityEvent(
   collector->AddEvent(std::move(event));
 }
 
+// Collects the KernelMetrics of the kernels with the kernel replay mode of the
+// CUPTI event API: the launches are serialized, and CUPTI replays each kernel
+// as many times as needed to count all the events of the metrics.
+class KernelMetricCollector {
+ public:
+  KernelMetricCollector(CuptiInterface *cupti_interface,
+                        KernelMetricMap *kernel_metric_map)
+      : cupti_interface_(cupti_interface),
+        kernel_metric_map_(kernel_metric_map) {}
+
+  // Best effort, as CUPTI may have been finalized.
+  ~KernelMetricCollector() {
+    absl::MutexLock lock(&launch_mutex_);
+    for (auto &context_and_state : contexts_) {
+      const ContextState &state = *context_and_state.second;
+      if (state.event_group_sets != nullptr) {
+        cupti_interface_->EventGroupSetsDestroy(state.event_group_sets);
+      }
+      cupti_interface_->DisableKernelReplayMode(context_and_state.first);
+    }
+  }
+
+  static bool IsMeasuredLaunch(CUpti_CallbackId cbid) {
+    return cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchKernel ||
+           cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchCooperativeKernel;
+  }
+
+  // Starts counting the events of the kernel being launched. The launches are
+  // serialized until OnLaunchExit, which is called by the same thread. An
+  // error disables the collection.
+  Status OnLaunchEnter(uint32 device_id, const CUpti_CallbackData *cbdata)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    if (disabled_.load(std::memory_order_relaxed)) return Status::OK();
+    launch_mutex_.Lock();
+    Status status = EnableEventGroups(device_id, cbdata->context);
+    if (!status.ok()) {
+      disabled_.store(true, std::memory_order_relaxed);
+      measured_state_ = nullptr;
+      launch_mutex_.Unlock();
+    }
+    return status;
+  }
+
+  // Waits for the kernel, and computes its metrics from the counted events.
+  Status OnLaunchExit(uint32 device_id, const CUpti_CallbackData *cbdata)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    ContextState *state = measured_state_;
+    if (state == nullptr) return Status::OK();
+    measured_state_ = nullptr;
+    Status status = ReadMetrics(device_id, cbdata->correlationId, state);
+    launch_mutex_.Unlock();
+    return status;
+  }
+
+ private:
+  // The metrics collected, and how they are combined into KernelMetrics.
+  enum class MetricKind { kAchievedOccupancy, kFlopCount, kDramBytes };
+
+  struct Metric {
+    MetricKind kind;
+    CUpti_MetricID id;
+    CUpti_MetricValueKind value_kind;
+    std::vector<CUpti_EventID> event_ids;
+  };
+
+  struct ContextState {
+    CUdevice device;
+    std::vector<Metric> metrics;
+    CUpti_EventGroupSets *event_group_sets = nullptr;
+    uint64 launch_start_ns = 0;
+  };
+
+  Status EnableEventGroups(uint32 device_id, CUcontext context)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mutex_) {
+    ContextState *state;
+    TF_RETURN_IF_ERROR(GetOrCreateContextState(device_id, context, &state));
+    if (state->event_group_sets == nullptr) {
+      return errors::Unavailable("No kernel metric supported by device ",
+                                 device_id);
+    }
+    CuptiApiTracingDisabler disabler;
+    // Waits for the kernels launched before, which are not measured.
+    TF_RETURN_IF_ERROR(ToStatus(cuCtxSynchronize()));
+    for (int i = 0; i < state->event_group_sets->numSets; ++i) {
+      const CUpti_EventGroupSet &set = state->event_group_sets->sets[i];
+      for (int j = 0; j < set.numEventGroups; ++j) {
+        RETURN_IF_CUPTI_ERROR(
+            cupti_interface_->EventGroupEnable(set.eventGroups[j]));
+      }
+    }
+    measured_state_ = state;
+    state->launch_start_ns = CuptiTracer::GetTimestamp();
+    return Status::OK();
+  }
+
+  Status ReadMetrics(uint32 device_id, uint32 correlation_id,
+                     ContextState *state)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mutex_) {
+    CuptiApiTracingDisabler disabler;
+    TF_RETURN_IF_ERROR(ToStatus(cuCtxSynchronize()));
+    // Only used for the metrics that are rates, which we do not collect.
+    const uint64 duration_ns =
+        CuptiTracer::GetTimestamp() - state->launch_start_ns;
+
+    absl::flat_hash_map<CUpti_EventID, uint64> event_values;
+    for (int i = 0; i < state->event_group_sets->numSets; ++i) {
+      const CUpti_EventGroupSet &set = state->event_group_sets->sets[i];
+      for (int j = 0; j < set.numEventGroups; ++j) {
+        CUpti_EventGroup group = set.eventGroups[j];
+        TF_RETURN_IF_ERROR(ReadEventGroup(group, &event_values));
+        RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupDisable(group));
+      }
+    }
+
+    KernelMetrics metrics;
+    for (const Metric &metric : state->metrics) {
+      std::vector<CUpti_EventID> event_ids = metric.event_ids;
+      std::vector<uint64_t> values;
+      values.reserve(event_ids.size());
+      for (CUpti_EventID event_id : event_ids) {
+        values.push_back(event_values[event_id]);
+      }
+      CUpti_MetricValue value;
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->MetricGetValue(
+          state->device, metric.id, event_ids.size() * sizeof(CUpti_EventID),
+          event_ids.data(), values.size() * sizeof(uint64_t), values.data(),
+          duration_ns, &value));
+      const double metric_value = ToDouble(metric.value_kind, value);
+      double *field = nullptr;
+      switch (metric.kind) {
+        case MetricKind::kAchievedOccupancy:
+          field = &metrics.achieved_occupancy;
+          break;
+        case MetricKind::kFlopCount:
+          field = &metrics.flop_count;
+          break;
+        case MetricKind::kDramBytes:
+          field = &metrics.dram_bytes;
+          break;
+      }
+      // The metrics of the same kind add up.
+      *field = std::max(*field, 0.0) + metric_value;
+    }
+    kernel_metric_map_->Add(device_id, correlation_id, metrics);
+    return Status::OK();
+  }
+
+  // Adds the values of the events of `group`, summed over the instances of
+  // their domain, to `event_values`.
+  Status ReadEventGroup(
+      CUpti_EventGroup group,
+      absl::flat_hash_map<CUpti_EventID, uint64> *event_values) {
+    uint32_t num_events = 0;
+    size_t size = sizeof(num_events);
+    RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_NUM_EVENTS, &size, &num_events));
+    std::vector<CUpti_EventID> event_ids(num_events);
+    size = num_events * sizeof(CUpti_EventID);
+    RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_EVENTS, &size, event_ids.data()));
+    uint32_t num_instances = 0;
+    size = sizeof(num_instances);
+    RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_INSTANCE_COUNT, &size, &num_instances));
+    std::vector<uint64_t> instance_values(num_instances);
+    for (CUpti_EventID event_id : event_ids) {
+      size = num_instances * sizeof(uint64_t);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupReadEvent(
+          group, CUPTI_EVENT_READ_FLAG_NONE, event_id, &size,
+          instance_values.data()));
+      uint64 &value = (*event_values)[event_id];
+      for (uint64_t instance_value : instance_values) value += instance_value;
+    }
+    return Status::OK();
+  }
+
+  static double ToDouble(CUpti_MetricValueKind kind,
+                         const CUpti_MetricValue &value) {
+    switch (kind) {
+      case CUPTI_METRIC_VALUE_KIND_DOUBLE:
+        return value.metricValueDouble;
+      case CUPTI_METRIC_VALUE_KIND_UINT64:
+        return value.metricValueUint64;
+      case CUPTI_METRIC_VALUE_KIND_INT64:
+        return value.metricValueInt64;
+      case CUPTI_METRIC_VALUE_KIND_PERCENT:
+        return value.metricValuePercent;
+      case CUPTI_METRIC_VALUE_KIND_THROUGHPUT:
+        return value.metricValueThroughput;
+      case CUPTI_METRIC_VALUE_KIND_UTILIZATION_LEVEL:
+        return value.metricValueUtilizationLevel;
+      default:
+        return 0;
+    }
+  }
+
+  // Looks up the metrics supported by the device of `context`, and creates
+  // the event groups counting their events, the first time a kernel is
+  // launched in the context.
+  Status GetOrCreateContextState(uint32 device_id, CUcontext context,
+                                 ContextState **result)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mutex_) {
+    auto it = contexts_.find(context);
+    if (it != contexts_.end()) {
+      *result = it->second.get();
+      return Status::OK();
+    }
+    auto state = absl::make_unique<ContextState>();
+    *result = state.get();
+    contexts_.emplace(context, std::move(state));
+    ContextState &new_state = **result;
+
+    CuptiApiTracingDisabler disabler;
+    TF_RETURN_IF_ERROR(ToStatus(cuDeviceGet(&new_state.device, device_id)));
+    static constexpr std::pair<const char *, MetricKind> kMetrics[] = {
+        {"achieved_occupancy", MetricKind::kAchievedOccupancy},
+        {"flop_count_hp", MetricKind::kFlopCount},
+        {"flop_count_sp", MetricKind::kFlopCount},
+        {"flop_count_dp", MetricKind::kFlopCount},
+        {"dram_read_bytes", MetricKind::kDramBytes},
+        {"dram_write_bytes", MetricKind::kDramBytes},
+    };
+    std::vector<CUpti_EventID> all_event_ids;
+    for (const auto &name_and_kind : kMetrics) {
+      Metric metric;
+      metric.kind = name_and_kind.second;
+      if (cupti_interface_->MetricGetIdFromName(new_state.device,
+                                                name_and_kind.first,
+                                                &metric.id) != CUPTI_SUCCESS) {
+        LOG(WARNING) << "Kernel metric " << name_and_kind.first
+                     << " is not supported by device " << device_id;
+        continue;
+      }
+      size_t size = sizeof(metric.value_kind);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->MetricGetAttribute(
+          metric.id, CUPTI_METRIC_ATTR_VALUE_KIND, &size, &metric.value_kind));
+      uint32_t num_events = 0;
+      RETURN_IF_CUPTI_ERROR(
+          cupti_interface_->MetricGetNumEvents(metric.id, &num_events));
+      metric.event_ids.resize(num_events);
+      size = num_events * sizeof(CUpti_EventID);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->MetricEnumEvents(
+          metric.id, &size, metric.event_ids.data()));
+      all_event_ids.insert(all_event_ids.end(), metric.event_ids.begin(),
+                           metric.event_ids.end());
+      new_state.metrics.push_back(std::move(metric));
+    }
+    if (new_state.metrics.empty()) return Status::OK();
+
+    std::sort(all_event_ids.begin(), all_event_ids.end());
+    all_event_ids.erase(std::unique(all_event_ids.begin(), all_event_ids.end()),
+                        all_event_ids.end());
+    RETURN_IF_CUPTI_ERROR(cupti_interface_->EnableKernelReplayMode(context));
+    RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupSetsCreate(
+        context, all_event_ids.size() * sizeof(CUpti_EventID),
+        all_event_ids.data(), &new_state.event_group_sets));
+    // Counts the events of all the instances of their domains, e.g. of all
+    // the multiprocessors, rather than of a sample of them.
+    uint32_t all_instances = 1;
+    for (int i = 0; i < new_state.event_group_sets->numSets; ++i) {
+      const CUpti_EventGroupSet &set = new_state.event_group_sets->sets[i];
+      for (int j = 0; j < set.numEventGroups; ++j) {
+        RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupSetAttribute(
+            set.eventGroups[j],
+            CUPTI_EVENT_GROUP_ATTR_PROFILE_ALL_DOMAIN_INSTANCES,
+            sizeof(all_instances), &all_instances));
+      }
+    }
+    return Status::OK();
+  }
+
+  CuptiInterface *cupti_interface_;
+  KernelMetricMap *kernel_metric_map_;
+  std::atomic<bool> disabled_{false};
+  // Held from the entry to the exit of each measured launch.
+  absl::Mutex launch_mutex_;
+  // The context of the launch being measured by the thread, if any. Only set
+  // while the thread holds launch_mutex_.
+  static thread_local ContextState *measured_state_;
+  absl::flat_hash_map<CUcontext, std::unique_ptr<ContextState>> contexts_
+      TF_GUARDED_BY(launch_mutex_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KernelMetricCollector);
+};
+
+thread_local KernelMetricCollector::ContextState
+    *KernelMetricCollector::measured_state_ = nullptr;
+
 // This hook uses cupti activity api to measure device side activities.
 class CuptiDriverApiHookWithActivityApi : public CuptiDriverApiHook {
  public:
@@ -587,7 +880,12 @@ class CuptiDriverApiHookWithActivityApi : public CuptiDriverApiHook {
                                     CuptiTraceCollector *collector)
       : option_(option),
         cupti_interface_(cupti_interface),
-        collector_(collector) {}
+        collector_(collector) {
+    if (option_.collect_kernel_metrics) {
+      kernel_metric_collector_ = absl::make_unique<KernelMetricCollector>(
+          cupti_interface_, collector_->kernel_metric_map());
+    }
+  }
 
   Status OnDriverApiEnter(int device_id, CUpti_CallbackDomain domain,
                           CUpti_CallbackId cbid,
@@ -595,11 +893,27 @@ class CuptiDriverApiHookWithActivityApi : public CuptiDriverApiHook {
     // Stash away the current Cupti timestamp into cbdata.
     *cbdata->correlationData =
         option_.required_callback_api_events ? CuptiTracer::GetTimestamp() : 0;
+    if (kernel_metric_collector_ &&
+        KernelMetricCollector::IsMeasuredLaunch(cbid)) {
+      Status status =
+          kernel_metric_collector_->OnLaunchEnter(device_id, cbdata);
+      if (!status.ok()) {
+        LOG(WARNING) << "Kernel metrics are not collected: " << status;
+      }
+    }
     return Status::OK();
   }
   Status OnDriverApiExit(int device_id, CUpti_CallbackDomain domain,
                          CUpti_CallbackId cbid,
                          const CUpti_CallbackData *cbdata) override {
+    if (kernel_metric_collector_ &&
+        KernelMetricCollector::IsMeasuredLaunch(cbid)) {
+      Status status = kernel_metric_collector_->OnLaunchExit(device_id, cbdata);
+      if (!status.ok()) {
+        LOG(WARNING) << "Kernel metrics of launch " << cbdata->correlationId
+                     << " are not collected: " << status;
+      }
+    }
     // If we are not collecting CPU events from Callback API, we can return now.
     if (!option_.required_callback_api_events) {
       return Status::OK();
@@ -642,6 +956,7 @@ class CuptiDriverApiHookWithActivityApi : public CuptiDriverApiHook {
   const CuptiTracerOptions option_;
   CuptiInterface *cupti_interface_;
   CuptiTraceCollector *collector_;
+  std::unique_ptr<KernelMetricCollector> kernel_metric_collector_;
   absl::Mutex mutex_;
   absl::flat_hash_set<CUcontext> contexts_ TF_GUARDED_BY(mutex_);
 
@@ -1370,6 +1685,28 @@ absl::string_view AnnotationMap::LookUp(uint32 device_id,
                                                     : absl::string_view();
 }
 
+void KernelMetricMap::Add(uint32 device_id, uint32 correlation_id,
+                          const KernelMetrics &metrics) {
+  if (device_id >= per_device_map_.size()) return;
+  auto &per_device_map = per_device_map_[device_id];
+  absl::MutexLock lock(&per_device_map.mutex);
+  if (per_device_map.correlation_map.size() < max_size_) {
+    per_device_map.correlation_map.emplace(correlation_id, metrics);
+  }
+}
+
+absl::optional<KernelMetrics> KernelMetricMap::Take(uint32 device_id,
+                                                    uint32 correlation_id) {
+  if (device_id >= per_device_map_.size()) return absl::nullopt;
+  auto &per_device_map = per_device_map_[device_id];
+  absl::MutexLock lock(&per_device_map.mutex);
+  auto it = per_device_map.correlation_map.find(correlation_id);
+  if (it == per_device_map.correlation_map.end()) return absl::nullopt;
+  KernelMetrics metrics = it->second;
+  per_device_map.correlation_map.erase(it);
+  return metrics;
+}
+
 /* static */ CuptiTracer *CuptiTracer::GetCuptiTracerSingleton() {
   static auto *singleton = new CuptiTracer(GetCuptiInterface());
   return singleton;
@@ -73,6 +73,19 @@ struct KernelDetails {
   uint64 grid_z;
 };
 
+// Metrics of a kernel collected with the CUPTI metric API, see
+// CuptiTracerOptions::collect_kernel_metrics. Negative values were not
+// collected, e.g. because the device does not support the metric.
+struct KernelMetrics {
+  // Ratio of the average number of active warps per cycle to the maximum
+  // number of warps of a multiprocessor.
+  double achieved_occupancy = -1;
+  // Number of half, single and double precision floating point operations.
+  double flop_count = -1;
+  // Number of bytes read from and written to device memory.
+  double dram_bytes = -1;
+};
+
 enum class CuptiTracerEventType {
   Unsupported = 0,
   Kernel = 1,
@@ -125,6 +138,8 @@ struct CuptiTracerEvent {
     MemAllocDetails memalloc_info;  // If type == MemoryAlloc
     KernelDetails kernel_info;      // If type == Kernel
   };
+  // If type == Kernel and the kernel metrics are collected.
+  absl::optional<KernelMetrics> kernel_metrics;
 };
 
 struct CuptiTracerOptions {
@@ -149,6 +164,12 @@ struct CuptiTracerOptions {
   bool cupti_finalize = false;
   // Whether to call cuCtxSynchronize for each device before Stop().
   bool sync_devices_before_stop = false;
+  // Whether to collect the KernelMetrics of the kernels with the CUPTI metric
+  // API. The kernel launches are serialized and the kernels are replayed to
+  // count all the events of the metrics, which slows them down by orders of
+  // magnitude: this is meant for analyzing a few steps. Only supported with
+  // the activity API, on devices supporting the CUPTI metric API.
+  bool collect_kernel_metrics = false;
 };
 
 struct CuptiTracerCollectorOptions {
@@ -188,11 +209,35 @@ class AnnotationMap {
   TF_DISALLOW_COPY_AND_ASSIGN(AnnotationMap);
 };
 
+// Keeps the KernelMetrics of the kernels, by device and correlation id, from
+// their launch until their activity records are processed.
+class KernelMetricMap {
+ public:
+  explicit KernelMetricMap(uint64 max_size, uint32 num_gpus)
+      : max_size_(max_size), per_device_map_(num_gpus) {}
+  void Add(uint32 device_id, uint32 correlation_id,
+           const KernelMetrics& metrics);
+  // Returns and forgets the metrics of a kernel, if any.
+  absl::optional<KernelMetrics> Take(uint32 device_id, uint32 correlation_id);
+
+ private:
+  struct PerDeviceKernelMetricMap {
+    absl::Mutex mutex;
+    absl::flat_hash_map<uint32, KernelMetrics> correlation_map;
+  };
+  const uint64 max_size_;
+  absl::FixedArray<PerDeviceKernelMetricMap> per_device_map_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KernelMetricMap);
+};
+
 class CuptiTraceCollector {
  public:
   explicit CuptiTraceCollector(const CuptiTracerCollectorOptions& options)
       : options_(options),
-        annotation_map_(options.max_annotation_strings, options.num_gpus) {}
+        annotation_map_(options.max_annotation_strings, options.num_gpus),
+        kernel_metric_map_(options.max_activity_api_events,
+                           options.num_gpus) {}
   virtual ~CuptiTraceCollector() {}
 
   virtual void AddEvent(CuptiTracerEvent&& event) = 0;
@@ -201,12 +246,14 @@ class CuptiTraceCollector {
   virtual void Flush() = 0;
 
   AnnotationMap* annotation_map() { return &annotation_map_; }
+  KernelMetricMap* kernel_metric_map() { return &kernel_metric_map_; }
 
  protected:
   CuptiTracerCollectorOptions options_;
 
  private:
   AnnotationMap annotation_map_;
+  KernelMetricMap kernel_metric_map_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(CuptiTraceCollector);
 };
@@ -106,6 +106,24 @@ void CreateXEvent(const CuptiTracerEvent& event, XPlaneBuilder* plane,
     xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
                             GetStatTypeStr(StatType::kKernelDetails)),
                         *plane->GetOrCreateStatMetadata(kernel_details));
+    if (event.kernel_metrics.has_value()) {
+      const KernelMetrics& metrics = *event.kernel_metrics;
+      if (metrics.achieved_occupancy >= 0) {
+        xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
+                                GetStatTypeStr(StatType::kAchievedOccupancy)),
+                            metrics.achieved_occupancy);
+      }
+      if (metrics.flop_count >= 0) {
+        xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
+                                GetStatTypeStr(StatType::kMeasuredFlops)),
+                            static_cast<uint64>(metrics.flop_count));
+      }
+      if (metrics.dram_bytes >= 0) {
+        xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
+                                GetStatTypeStr(StatType::kMeasuredDramBytes)),
+                            static_cast<uint64>(metrics.dram_bytes));
+      }
+    }
   } else if (event.type == CuptiTracerEventType::MemcpyH2D ||
              event.type == CuptiTracerEventType::MemcpyD2H ||
              event.type == CuptiTracerEventType::MemcpyD2D ||
@@ -601,6 +619,10 @@ Status GpuTracer::DoStart() {
       .IgnoreError();
   options_.enable_event_based_activity = !use_cupti_activity_api;
 
+  ReadBoolFromEnvVar("TF_GPU_CUPTI_COLLECT_KERNEL_METRICS", false,
+                     &options_.collect_kernel_metrics)
+      .IgnoreError();
+
   bool trace_concurrent_kernels = false;
   ReadBoolFromEnvVar("TF_GPU_CUPTI_FORCE_CONCURRENT_KERNEL", false,
                      &trace_concurrent_kernels)
@@ -44,6 +44,10 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// Maximum number of events buffered per thread, 0 if unbounded. Modified by
+// TraceMeRecorder singleton when tracing starts.
+std::atomic<size_t> g_max_events_per_thread(0);
+
 // A single-producer single-consumer queue of Events.
 //
 // Implemented as a linked-list of blocks containing numbered slots, with start
@@ -56,7 +60,10 @@ namespace {
 //
 // Push writes at end_, and then advances it, allocating a block if needed.
 // PopAll takes ownership of events in the range [start_, end_).
-// The end_ pointer is atomic so Push and PopAll can be concurrent.
+// The end_ pointer is atomic so Push and PopAll can be concurrent. The start_
+// pointer is atomic so that Push can drop the events beyond
+// g_max_events_per_thread, in which case the blocks in use stay bounded as
+// PopAll frees the blocks it empties.
 //
 // Push and PopAll are lock free and each might be called from at most one
 // thread. Push is only called by the owner thread. PopAll is called by the
@@ -73,7 +80,7 @@ class EventQueue {
       : start_block_(new Block{/*start=*/0, /*next=*/nullptr}),
         start_(start_block_->start),
         end_block_(start_block_),
-        end_(start_) {}
+        end_(start_block_->start) {}
 
   // REQUIRES: PopAll() was called since the last Push().
   // Memory should be deallocated and trace events destroyed on destruction.
@@ -88,6 +95,13 @@ class EventQueue {
   // Add a new event to the back of the queue. Fast and lock-free.
   void Push(TraceMeRecorder::Event&& event) {
     size_t end = end_.load(std::memory_order_relaxed);
+    const size_t max_events =
+        g_max_events_per_thread.load(std::memory_order_relaxed);
+    if (TF_PREDICT_FALSE(max_events != 0) &&
+        end - start_.load(std::memory_order_acquire) >= max_events) {
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
     new (&end_block_->events[end++ - end_block_->start].event)
         TraceMeRecorder::Event(std::move(event));
     if (TF_PREDICT_FALSE(end - end_block_->start == Block::kNumSlots)) {
@@ -107,35 +121,44 @@ class EventQueue {
   std::vector<TraceMeRecorder::Event> PopAll() {
     // Read index before contents.
     size_t end = end_.load(std::memory_order_acquire);
+    size_t start = start_.load(std::memory_order_relaxed);
     std::vector<TraceMeRecorder::Event> result;
-    result.reserve(end - start_);
-    while (start_ != end) {
-      result.emplace_back(Pop());
+    result.reserve(end - start);
+    while (start != end) {
+      result.emplace_back(Pop(&start));
     }
+    // Write index after freeing the slots.
+    start_.store(start, std::memory_order_release);
     return result;
   }
 
+  // Returns the number of events dropped since the previous call.
+  uint64 TakeNumDropped() {
+    return num_dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
  private:
   // Returns true if the queue is empty at the time of invocation.
   bool Empty() const {
-    return (start_ == end_.load(std::memory_order_acquire));
+    return (start_.load(std::memory_order_relaxed) ==
+            end_.load(std::memory_order_acquire));
   }
 
-  // Remove one event off the front of the queue and return it.
+  // Remove the event at *start off the front of the queue, advance *start and
+  // return the event.
   // REQUIRES: The queue must not be empty.
-  TraceMeRecorder::Event Pop() {
-    DCHECK(!Empty());
+  TraceMeRecorder::Event Pop(size_t* start) {
     // Move the next event into the output.
-    auto& event = start_block_->events[start_++ - start_block_->start].event;
+    auto& event = start_block_->events[(*start)++ - start_block_->start].event;
     TraceMeRecorder::Event out = std::move(event);
     event.~Event();  // Events must be individually destroyed.
     // If we reach the end of a block, we own it and should delete it.
     // The next block is present: end always points to something.
-    if (TF_PREDICT_FALSE(start_ - start_block_->start == Block::kNumSlots)) {
+    if (TF_PREDICT_FALSE(*start - start_block_->start == Block::kNumSlots)) {
       auto* next_block = start_block_->next;
       delete start_block_;
       start_block_ = next_block;
-      DCHECK_EQ(start_, start_block_->start);
+      DCHECK_EQ(*start, start_block_->start);
     }
     return out;
   }
@@ -162,10 +185,12 @@ class EventQueue {
 
   // Head of list for reading. Only accessed by consumer thread.
   Block* start_block_;
-  size_t start_;
+  std::atomic<size_t> start_;  // Atomic: also read by producer thread.
   // Tail of list for writing. Accessed by producer thread.
   Block* end_block_;
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
+  // Written by producer thread, read by consumer thread.
+  std::atomic<uint64> num_dropped_{0};
 };
 
 }  // namespace
@@ -194,7 +219,9 @@ class TraceMeRecorder::ThreadLocalRecorder {
 
   // Clear is called from the control thread when tracing starts/stops, or from
   // the owner thread when it shuts down (see destructor).
-  TraceMeRecorder::ThreadEvents Clear() { return {info_, queue_.PopAll()}; }
+  TraceMeRecorder::ThreadEvents Clear() {
+    return {info_, queue_.PopAll(), queue_.TakeNumDropped()};
+  }
 
  private:
   TraceMeRecorder::ThreadInfo info_;
@@ -216,7 +243,7 @@ void TraceMeRecorder::UnregisterThread(uint32 tid) {
   auto it = threads_.find(tid);
   if (it != threads_.end()) {
     auto events = it->second->Clear();
-    if (!events.events.empty()) {
+    if (!events.events.empty() || events.num_dropped_events != 0) {
       orphaned_events_.push_back(std::move(events));
     }
     threads_.erase(it);
@@ -233,16 +260,22 @@ TraceMeRecorder::Events TraceMeRecorder::Clear() {
   for (const auto& entry : threads_) {
     auto* recorder = entry.second;
     TraceMeRecorder::ThreadEvents events = recorder->Clear();
-    if (!events.events.empty()) {
+    if (!events.events.empty() || events.num_dropped_events != 0) {
       result.push_back(std::move(events));
     }
   }
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
+bool TraceMeRecorder::StartRecording(int level, size_t max_events_per_thread) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    return false;
+  }
+  g_max_events_per_thread.store(max_events_per_thread,
+                                std::memory_order_relaxed);
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
@@ -270,6 +303,16 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   return events;
 }
 
+TraceMeRecorder::Events TraceMeRecorder::ConsumeRecording() {
+  TraceMeRecorder::Events events;
+  mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    events = Clear();
+  }
+  return events;
+}
+
 /*static*/ uint64 TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
@@ -40,7 +40,12 @@ TF_EXPORT extern std::atomic<int> g_trace_level;
 // It can be safely and cheaply appended to by multiple threads.
 //
 // Start() and Stop() must be called in pairs, Stop() returns the events added
-// since the previous Start().
+// since the previous Start(), or since the last Consume() in between.
+//
+// Each thread buffers its events until they are returned. Long recordings can
+// bound the events buffered per thread, dropping (and counting) the events
+// recorded when the buffer is full, and call Consume() periodically to drain
+// the buffers while recording.
 //
 // This is the backend for TraceMe instrumentation.
 // The profiler starts the recorder, the TraceMe destructor records complete
@@ -64,18 +69,28 @@ class TraceMeRecorder {
   struct ThreadEvents {
     ThreadInfo thread;
     std::vector<Event> events;
+    // Number of events dropped because the buffer of the thread was full.
+    uint64 num_dropped_events = 0;
   };
   using Events = std::vector<ThreadEvents>;
 
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level) { return Get()->StartRecording(level); }
+  // If max_events_per_thread is not 0, each thread buffers at most that many
+  // events until they are returned by Consume() or Stop().
+  static bool Start(int level, size_t max_events_per_thread = 0) {
+    return Get()->StartRecording(level, max_events_per_thread);
+  }
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Returns the events recorded since Start() or the previous Consume(),
+  // without stopping the recording. Returns no events when not recording.
+  static Events Consume() { return Get()->ConsumeRecording(); }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
@@ -103,8 +118,9 @@ class TraceMeRecorder {
   void RegisterThread(uint32 tid, ThreadLocalRecorder* thread);
   void UnregisterThread(uint32 tid);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, size_t max_events_per_thread);
   Events StopRecording();
+  Events ConsumeRecording();
 
   // Gathers events from all active threads, and clears their buffers.
   Events Clear() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
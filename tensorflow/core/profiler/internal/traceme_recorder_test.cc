@@ -57,6 +57,43 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, BoundedDropsNewestEvents) {
+  uint64 start_time = Env::Default()->NowNanos();
+  uint64 end_time = start_time + kNanosInSec;
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({1, "kept1", start_time, end_time});
+  TraceMeRecorder::Record({2, "kept2", start_time, end_time});
+  TraceMeRecorder::Record({3, "dropped", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("kept1"), Named("kept2")));
+  EXPECT_EQ(results[0].num_dropped_events, 1);
+}
+
+TEST(RecorderTest, ConsumeWhileRecording) {
+  uint64 start_time = Env::Default()->NowNanos();
+  uint64 end_time = start_time + kNanosInSec;
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({1, "first1", start_time, end_time});
+  TraceMeRecorder::Record({2, "first2", start_time, end_time});
+  auto consumed = TraceMeRecorder::Consume();
+  // Consuming the events makes room for more.
+  TraceMeRecorder::Record({3, "second1", start_time, end_time});
+  TraceMeRecorder::Record({4, "second2", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(consumed.size(), 1);
+  EXPECT_THAT(consumed[0].events,
+              ElementsAre(Named("first1"), Named("first2")));
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events,
+              ElementsAre(Named("second1"), Named("second2")));
+  EXPECT_EQ(results[0].num_dropped_events, 0);
+}
+
 void SpinNanos(int nanos) {
   uint64 deadline = Env::Default()->NowNanos() + nanos;
   while (Env::Default()->NowNanos() < deadline) {
@@ -0,0 +1,169 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/lib/continuous_profiler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+auto* sampled_steps_counter = monitoring::Counter<0>::New(
+    "/tensorflow/core/profiler/continuous_profiler/sampled_steps",
+    "The number of steps profiled by continuous profilers.");
+
+}  // namespace
+
+ContinuousProfiler::ContinuousProfiler(Env* env,
+                                       ContinuousProfilerOptions options)
+    : env_(env), options_(std::move(options)) {
+  {
+    mutex_lock l(mu_);
+    ResetSummaryLocked();
+  }
+  if (options_.export_interval_micros > 0 && options_.export_fn) {
+    export_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "continuous_profiler_export",
+                                           [this] { ExportLoop(); }));
+  }
+}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+    cond_var_.notify_all();
+  }
+  export_thread_.reset();
+  if (options_.export_fn) Export();
+}
+
+ContinuousProfiler::ScopedStep::ScopedStep(ContinuousProfiler* profiler)
+    : profiler_(profiler), session_(profiler->MaybeStartSampledStep()) {}
+
+ContinuousProfiler::ScopedStep::~ScopedStep() {
+  if (session_) profiler_->EndSampledStep(std::move(session_));
+}
+
+OpMetricsDb ContinuousProfiler::Summary() const {
+  mutex_lock l(mu_);
+  return *summary_;
+}
+
+std::unique_ptr<ProfilerSession> ContinuousProfiler::MaybeStartSampledStep() {
+  if (options_.sample_every_n_steps <= 0) return nullptr;
+  // The first sampled step is the N-th one, leaving out the warmup.
+  const int64 step = num_steps_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (step % options_.sample_every_n_steps != 0) return nullptr;
+  bool capturing = false;
+  if (!capturing_.compare_exchange_strong(capturing, true)) return nullptr;
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(options_.profile_options);
+  if (!session->Status().ok()) {
+    VLOG(1) << "Not sampling step " << step << ": " << session->Status();
+    session.reset();
+    capturing_ = false;
+  }
+  return session;
+}
+
+void ContinuousProfiler::EndSampledStep(
+    std::unique_ptr<ProfilerSession> session) {
+  XSpace space;
+  const Status status = session->CollectData(&space);
+  session.reset();
+  capturing_ = false;
+  if (!status.ok()) {
+    VLOG(1) << "Failed to collect a sampled step: " << status;
+    return;
+  }
+  const XPlane* host_plane = FindPlaneWithName(space, kHostThreadsPlaneName);
+  if (host_plane == nullptr) return;
+  // The conversion runs outside of the lock, Summary() is not blocked on it.
+  const OpMetricsDb step_db =
+      ConvertHostThreadsXPlaneToOpMetricsDb(*host_plane);
+  {
+    mutex_lock l(mu_);
+    combiner_->Combine(step_db);
+    TrimSummaryLocked();
+  }
+  ++num_sampled_steps_;
+  sampled_steps_counter->GetCell()->IncrementBy(1);
+}
+
+void ContinuousProfiler::TrimSummaryLocked() {
+  if (options_.max_ops <= 0 ||
+      summary_->metrics_db_size() <= options_.max_ops) {
+    return;
+  }
+  OpMetricsDb trimmed = std::move(*summary_);
+  auto* metrics = trimmed.mutable_metrics_db();
+  std::sort(metrics->pointer_begin(), metrics->pointer_end(),
+            [](const OpMetrics* a, const OpMetrics* b) {
+              return a->self_time_ps() > b->self_time_ps();
+            });
+  metrics->DeleteSubrange(options_.max_ops,
+                          metrics->size() - options_.max_ops);
+  // The combiner indexes the ops of the summary, and is rebuilt with it.
+  ResetSummaryLocked();
+  combiner_->Combine(trimmed);
+}
+
+void ContinuousProfiler::ResetSummaryLocked() {
+  combiner_.reset();
+  summary_ = absl::make_unique<OpMetricsDb>();
+  combiner_ = absl::make_unique<OpMetricsDbCombiner>(summary_.get());
+}
+
+void ContinuousProfiler::ExportLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      const uint64 deadline_micros =
+          env_->NowMicros() + options_.export_interval_micros;
+      for (uint64 now = env_->NowMicros(); !stopping_ && now < deadline_micros;
+           now = env_->NowMicros()) {
+        cond_var_.wait_for(l,
+                           std::chrono::microseconds(deadline_micros - now));
+      }
+      if (stopping_) return;
+    }
+    Export();
+  }
+}
+
+void ContinuousProfiler::Export() {
+  OpMetricsDb summary;
+  {
+    mutex_lock l(mu_);
+    summary = std::move(*summary_);
+    ResetSummaryLocked();
+  }
+  options_.export_fn(summary);
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
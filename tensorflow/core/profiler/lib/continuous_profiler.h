@@ -0,0 +1,132 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct ContinuousProfilerOptions {
+  // Profiles one of every `sample_every_n_steps` steps.
+  int64 sample_every_n_steps = 1000;
+
+  // Maximum number of ops kept in the summary. When exceeded, the ops with the
+  // least self time are dropped.
+  int max_ops = 1000;
+
+  // Interval between two calls to `export_fn`. Zero disables the periodic
+  // export, leaving only Summary().
+  int64 export_interval_micros = 60 * 1000 * 1000;
+
+  // Called periodically, and on destruction, with the summary of the steps
+  // profiled since the previous call. The summary is then reset.
+  std::function<void(const OpMetricsDb&)> export_fn;
+
+  // Options of the ProfilerSession capturing each sampled step. Defaults to
+  // tracing the host only.
+  ProfileOptions profile_options = DefaultProfileOptions();
+
+  static ProfileOptions DefaultProfileOptions() {
+    ProfileOptions options = ProfilerSession::DefaultOptions();
+    options.set_device_tracer_level(0);
+    return options;
+  }
+};
+
+// A profiler meant to stay enabled in production. It captures one of every N
+// steps with a ProfilerSession, and aggregates the host op metrics of these
+// steps into a summary of bounded size, exported periodically.
+//
+// Steps which are not sampled only pay for incrementing a counter, and the
+// TraceMe instrumentation stays disabled outside of the sampled steps. Steps
+// running concurrently with a sampled step are profiled along with it. A step
+// is not sampled when another ProfilerSession, e.g. an on-demand capture, is
+// active.
+//
+// Thread-safety: ContinuousProfiler is thread-safe.
+class ContinuousProfiler {
+ public:
+  ContinuousProfiler(Env* env, ContinuousProfilerOptions options);
+
+  // Stops the periodic export and exports the last summary.
+  ~ContinuousProfiler();
+
+  // Marks the duration of a step, profiling it if it is sampled.
+  class ScopedStep {
+   public:
+    explicit ScopedStep(ContinuousProfiler* profiler);
+    ~ScopedStep();
+
+   private:
+    ContinuousProfiler* const profiler_;
+    std::unique_ptr<ProfilerSession> session_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedStep);
+  };
+
+  // Returns the summary of the steps profiled since the last export.
+  OpMetricsDb Summary() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of steps profiled so far.
+  int64 num_sampled_steps() const { return num_sampled_steps_; }
+
+ private:
+  // Returns a session capturing the step if it is sampled, or nullptr.
+  std::unique_ptr<ProfilerSession> MaybeStartSampledStep();
+  void EndSampledStep(std::unique_ptr<ProfilerSession> session)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Drops the ops with the least self time beyond `max_ops`.
+  void TrimSummaryLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ResetSummaryLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void ExportLoop() TF_LOCKS_EXCLUDED(mu_);
+  void Export() TF_LOCKS_EXCLUDED(mu_);
+
+  Env* const env_;
+  const ContinuousProfilerOptions options_;
+  std::atomic<int64> num_steps_{0};
+  std::atomic<int64> num_sampled_steps_{0};
+  // Whether a sampled step is being captured.
+  std::atomic<bool> capturing_{false};
+
+  mutable mutex mu_;
+  condition_variable cond_var_;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<OpMetricsDb> summary_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<OpMetricsDbCombiner> combiner_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> export_thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ContinuousProfiler);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
@@ -0,0 +1,120 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/lib/continuous_profiler.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+const OpMetrics* FindOp(const OpMetricsDb& db, const string& name) {
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == name) return &metrics;
+  }
+  return nullptr;
+}
+
+void RunStep(ContinuousProfiler* profiler) {
+  ContinuousProfiler::ScopedStep step(profiler);
+  {
+    TraceMe trace("matmul:MatMul");
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  {
+    TraceMe trace("add:AddV2");
+  }
+}
+
+TEST(ContinuousProfilerTest, SamplesOneInNSteps) {
+  ContinuousProfilerOptions options;
+  options.sample_every_n_steps = 2;
+  ContinuousProfiler profiler(Env::Default(), options);
+  for (int i = 0; i < 5; ++i) {
+    RunStep(&profiler);
+  }
+  EXPECT_EQ(profiler.num_sampled_steps(), 2);
+  const OpMetricsDb summary = profiler.Summary();
+  const OpMetrics* matmul = FindOp(summary, "matmul");
+  ASSERT_NE(matmul, nullptr);
+  EXPECT_EQ(matmul->occurrences(), 2);
+  EXPECT_GE(matmul->time_ps(), 2 * 1000 * 1000 * 1000ULL);
+  const OpMetrics* add = FindOp(summary, "add");
+  ASSERT_NE(add, nullptr);
+  EXPECT_EQ(add->occurrences(), 2);
+}
+
+TEST(ContinuousProfilerTest, KeepsOpsWithMostSelfTime) {
+  ContinuousProfilerOptions options;
+  options.sample_every_n_steps = 1;
+  options.max_ops = 1;
+  ContinuousProfiler profiler(Env::Default(), options);
+  RunStep(&profiler);
+  RunStep(&profiler);
+  const OpMetricsDb summary = profiler.Summary();
+  ASSERT_EQ(summary.metrics_db_size(), 1);
+  EXPECT_EQ(summary.metrics_db(0).name(), "matmul");
+  EXPECT_EQ(summary.metrics_db(0).occurrences(), 2);
+}
+
+TEST(ContinuousProfilerTest, ExportsAndResetsSummary) {
+  mutex mu;
+  std::vector<OpMetricsDb> exported;
+  {
+    ContinuousProfilerOptions options;
+    options.sample_every_n_steps = 1;
+    options.export_interval_micros = 0;
+    options.export_fn = [&](const OpMetricsDb& summary) {
+      mutex_lock l(mu);
+      exported.push_back(summary);
+    };
+    ContinuousProfiler profiler(Env::Default(), options);
+    RunStep(&profiler);
+  }
+  mutex_lock l(mu);
+  ASSERT_EQ(exported.size(), 1);
+  const OpMetrics* matmul = FindOp(exported[0], "matmul");
+  ASSERT_NE(matmul, nullptr);
+  EXPECT_EQ(matmul->occurrences(), 1);
+}
+
+TEST(ContinuousProfilerTest, ExportsPeriodically) {
+  mutex mu;
+  condition_variable exported_cv;
+  int num_exports = 0;
+  ContinuousProfilerOptions options;
+  options.export_interval_micros = 1000;
+  options.export_fn = [&](const OpMetricsDb& summary) {
+    mutex_lock l(mu);
+    ++num_exports;
+    exported_cv.notify_all();
+  };
+  ContinuousProfiler profiler(Env::Default(), options);
+  mutex_lock l(mu);
+  while (num_exports < 2) {
+    exported_cv.wait(l);
+  }
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
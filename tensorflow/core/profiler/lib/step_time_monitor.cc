@@ -0,0 +1,176 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/lib/step_time_monitor.h"
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/profiler_service.pb.h"
+#include "tensorflow/core/profiler/rpc/client/save_profile.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+auto* regression_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/profiler/step_time_monitor/regressions",
+    "The number of sustained step time regressions detected, by whether they "
+    "were captured.",
+    "captured");
+
+}  // namespace
+
+StepTimeMonitor::StepTimeMonitor(Env* env, StepTimeMonitorOptions options)
+    : env_(env), options_(std::move(options)) {}
+
+StepTimeMonitor::~StepTimeMonitor() {
+  std::unique_ptr<ProfilerSession> session;
+  {
+    mutex_lock l(mu_);
+    session = std::move(session_);
+  }
+  // Keeps the steps captured so far.
+  if (session) FinishCapture(std::move(session));
+}
+
+StepTimeMonitor::ScopedStep::ScopedStep(StepTimeMonitor* monitor)
+    : monitor_(monitor), start_micros_(monitor->env_->NowMicros()) {}
+
+StepTimeMonitor::ScopedStep::~ScopedStep() {
+  monitor_->RecordStep(monitor_->env_->NowMicros() - start_micros_);
+}
+
+void StepTimeMonitor::RecordStep(uint64 duration_micros) {
+  std::unique_ptr<ProfilerSession> finished;
+  {
+    mutex_lock l(mu_);
+    if (++num_steps_ <= options_.warmup_steps) return;
+    if (session_) {
+      // The captured steps are slowed down by the profiler, and are left out
+      // of the statistics.
+      if (++num_captured_steps_ >= options_.capture_steps) {
+        finished = std::move(session_);
+        cooldown_end_step_ = num_steps_ + options_.cooldown_steps;
+      }
+    } else {
+      step_times_.push_back(duration_micros);
+      const size_t window_size =
+          options_.baseline_steps + options_.recent_steps;
+      if (step_times_.size() > window_size) step_times_.pop_front();
+      if (step_times_.size() == window_size &&
+          num_steps_ > cooldown_end_step_) {
+        if (!IsRegressedLocked()) {
+          num_regressed_steps_ = 0;
+        } else if (++num_regressed_steps_ >= options_.sustained_steps) {
+          num_regressed_steps_ = 0;
+          StartCaptureLocked();
+        }
+      }
+    }
+  }
+  if (finished) FinishCapture(std::move(finished));
+}
+
+int64 StepTimeMonitor::num_captures() const {
+  mutex_lock l(mu_);
+  return num_captures_;
+}
+
+int64 StepTimeMonitor::num_regressions() const {
+  mutex_lock l(mu_);
+  return num_regressions_;
+}
+
+bool StepTimeMonitor::IsRegressedLocked() const {
+  const auto recent_begin = step_times_.end() - options_.recent_steps;
+  const grappler::RobustStats baseline(
+      std::vector<double>(step_times_.begin(), recent_begin));
+  const grappler::RobustStats recent(
+      std::vector<double>(recent_begin, step_times_.end()));
+  return recent.mean() > baseline.mean() * options_.regression_ratio;
+}
+
+void StepTimeMonitor::StartCaptureLocked() {
+  ++num_regressions_;
+  LOG(WARNING) << "Step time regressed by more than "
+               << (options_.regression_ratio - 1) * 100 << "% for "
+               << options_.sustained_steps << " steps at step " << num_steps_
+               << ".";
+  // Whatever the outcome, the next regression is looked for after a cooldown.
+  cooldown_end_step_ = num_steps_ + options_.cooldown_steps;
+  if (!options_.capture_fn && options_.logdir.empty()) {
+    regression_counter->GetCell("false")->IncrementBy(1);
+    return;
+  }
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(options_.profile_options);
+  if (!session->Status().ok()) {
+    // Typically, another capture is in progress.
+    LOG(WARNING) << "Not capturing the step time regression: "
+                 << session->Status();
+    regression_counter->GetCell("false")->IncrementBy(1);
+    return;
+  }
+  session_ = std::move(session);
+  num_captured_steps_ = 0;
+}
+
+void StepTimeMonitor::FinishCapture(
+    std::unique_ptr<ProfilerSession> session) {
+  XSpace space;
+  Status status = session->CollectData(&space);
+  session.reset();
+  if (status.ok()) {
+    if (options_.capture_fn) {
+      options_.capture_fn(space);
+    } else {
+      status = SaveCaptureToLogdir(options_.logdir, space);
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to capture the step time regression: " << status;
+    regression_counter->GetCell("false")->IncrementBy(1);
+    return;
+  }
+  regression_counter->GetCell("true")->IncrementBy(1);
+  mutex_lock l(mu_);
+  ++num_captures_;
+}
+
+/*static*/ Status StepTimeMonitor::SaveCaptureToLogdir(
+    const std::string& logdir, const XSpace& space) {
+  TF_RETURN_IF_ERROR(MaybeCreateEmptyEventFile(logdir));
+  ProfileResponse response;
+  ProfileToolData* tool_data = response.add_tool_data();
+  tool_data->set_name("xplane.pb");
+  space.SerializeToString(tool_data->mutable_data());
+  std::ostringstream os;
+  const Status status =
+      SaveProfile(GetTensorBoardProfilePluginDir(logdir),
+                  GetCurrentTimeStampAsString(), port::Hostname(), response,
+                  &os);
+  LOG(INFO) << os.str();
+  return status;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,141 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_STEP_TIME_MONITOR_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_STEP_TIME_MONITOR_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct StepTimeMonitorOptions {
+  // Number of steps ignored at the start of training, e.g. for compilation.
+  int64 warmup_steps = 10;
+
+  // Number of steps preceding the recent window which make the baseline.
+  int baseline_steps = 100;
+
+  // Number of most recent steps compared against the baseline.
+  int recent_steps = 10;
+
+  // A step time regression is detected when the robust mean of the recent
+  // steps exceeds the robust mean of the baseline by this factor.
+  double regression_ratio = 1.2;
+
+  // Number of consecutive steps the regression must be detected for before a
+  // capture is triggered, so that a single slow step does not trigger one.
+  int sustained_steps = 5;
+
+  // Number of steps captured once a regression is detected.
+  int capture_steps = 5;
+
+  // Minimum number of steps between the end of a capture and the next one.
+  int64 cooldown_steps = 1000;
+
+  // Options of the ProfilerSession capturing the regressed steps.
+  ProfileOptions profile_options = ProfilerSession::DefaultOptions();
+
+  // Called with each capture. When unset, the capture is saved under
+  // `logdir` for TensorBoard, see SaveCaptureToLogdir().
+  std::function<void(const XSpace&)> capture_fn;
+
+  // TensorBoard log directory the captures are saved to if `capture_fn` is
+  // unset. When both are unset, regressions are only logged.
+  std::string logdir;
+};
+
+// Watches the step times of a training loop, and captures a profile of a few
+// steps when they regress for a sustained period.
+//
+// Step times are compared using robust statistics (Huber mean), so that
+// outliers such as checkpointing or evaluation steps neither mask nor trigger
+// a regression. The baseline is rolling: once a regression lasts longer than
+// the baseline window, it becomes the new baseline.
+//
+// Thread-safety: StepTimeMonitor is thread-safe.
+class StepTimeMonitor {
+ public:
+  StepTimeMonitor(Env* env, StepTimeMonitorOptions options);
+  ~StepTimeMonitor();
+
+  // Marks the duration of a step and records it.
+  class ScopedStep {
+   public:
+    explicit ScopedStep(StepTimeMonitor* monitor);
+    ~ScopedStep();
+
+   private:
+    StepTimeMonitor* const monitor_;
+    const uint64 start_micros_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedStep);
+  };
+
+  // Records the duration of a completed step, starting or finishing a capture
+  // if needed.
+  void RecordStep(uint64 duration_micros) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of captures completed so far.
+  int64 num_captures() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of sustained regressions detected so far, including
+  // the ones which could not be captured.
+  int64 num_regressions() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Saves `space` for TensorBoard in a new run of `logdir`.
+  static Status SaveCaptureToLogdir(const std::string& logdir,
+                                    const XSpace& space);
+
+ private:
+  // Returns whether the recent steps are regressed against the baseline.
+  bool IsRegressedLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void StartCaptureLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FinishCapture(std::unique_ptr<ProfilerSession> session)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  Env* const env_;
+  const StepTimeMonitorOptions options_;
+
+  mutable mutex mu_;
+  int64 num_steps_ TF_GUARDED_BY(mu_) = 0;
+  // The last baseline_steps + recent_steps step times, in microseconds.
+  std::deque<double> step_times_ TF_GUARDED_BY(mu_);
+  int num_regressed_steps_ TF_GUARDED_BY(mu_) = 0;
+  // Step after which the cooldown of the last capture ends.
+  int64 cooldown_end_step_ TF_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<ProfilerSession> session_ TF_GUARDED_BY(mu_);
+  int num_captured_steps_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_captures_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_regressions_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepTimeMonitor);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_STEP_TIME_MONITOR_H_
@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/lib/step_time_monitor.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+StepTimeMonitorOptions TestOptions() {
+  StepTimeMonitorOptions options;
+  options.warmup_steps = 2;
+  options.baseline_steps = 20;
+  options.recent_steps = 5;
+  options.sustained_steps = 3;
+  options.capture_steps = 2;
+  options.cooldown_steps = 100;
+  options.profile_options.set_device_tracer_level(0);
+  return options;
+}
+
+TEST(StepTimeMonitorTest, IgnoresStableAndNoisySteps) {
+  StepTimeMonitorOptions options = TestOptions();
+  int num_captures = 0;
+  options.capture_fn = [&](const XSpace&) { ++num_captures; };
+  StepTimeMonitor monitor(Env::Default(), options);
+  for (int i = 0; i < 200; ++i) {
+    // One slow step out of 10, e.g. a checkpoint.
+    monitor.RecordStep(i % 10 == 0 ? 5000 : 1000 + i % 3);
+  }
+  EXPECT_EQ(monitor.num_regressions(), 0);
+  EXPECT_EQ(num_captures, 0);
+}
+
+TEST(StepTimeMonitorTest, CapturesSustainedRegression) {
+  StepTimeMonitorOptions options = TestOptions();
+  mutex mu;
+  std::vector<XSpace> captures;
+  options.capture_fn = [&](const XSpace& space) {
+    mutex_lock l(mu);
+    captures.push_back(space);
+  };
+  StepTimeMonitor monitor(Env::Default(), options);
+  for (int i = 0; i < 30; ++i) {
+    monitor.RecordStep(1000);
+  }
+  EXPECT_EQ(monitor.num_regressions(), 0);
+  int step = 0;
+  while (monitor.num_regressions() == 0 && step < 20) {
+    monitor.RecordStep(2000);
+    ++step;
+  }
+  EXPECT_EQ(monitor.num_regressions(), 1);
+  // The regression needs the recent steps to be mostly regressed, for
+  // `sustained_steps` steps.
+  EXPECT_GE(step, options.sustained_steps);
+  for (int i = 0; i < options.capture_steps; ++i) {
+    StepTimeMonitor::ScopedStep scoped_step(&monitor);
+    TraceMe trace("regressed_step");
+  }
+  EXPECT_EQ(monitor.num_captures(), 1);
+  {
+    mutex_lock l(mu);
+    ASSERT_EQ(captures.size(), 1);
+    EXPECT_GT(captures[0].planes_size(), 0);
+  }
+  // No capture during the cooldown, even though the steps are still slow.
+  for (int i = 0; i < 50; ++i) {
+    monitor.RecordStep(3000);
+  }
+  EXPECT_EQ(monitor.num_regressions(), 1);
+}
+
+TEST(StepTimeMonitorTest, SavesCaptureToLogdir) {
+  const string logdir = io::JoinPath(testing::TmpDir(), "step_time_monitor");
+  XSpace space;
+  space.add_planes()->set_name("/host:CPU");
+  TF_ASSERT_OK(StepTimeMonitor::SaveCaptureToLogdir(logdir, space));
+  std::vector<string> files;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(logdir, "plugins/profile/*/*.xplane.pb"), &files));
+  ASSERT_EQ(files.size(), 1);
+  XSpace saved;
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(), files[0], &saved));
+  ASSERT_EQ(saved.planes_size(), 1);
+  EXPECT_EQ(saved.planes(0).name(), "/host:CPU");
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
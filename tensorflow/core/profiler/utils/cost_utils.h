@@ -33,7 +33,8 @@ namespace profiler {
 class TfOpRoofLineCostEstimator
     : public tensorflow::grappler::OpLevelCostEstimator {
  public:
-  TfOpRoofLineCostEstimator() = default;
+  // The flops and bytes are read from the uncalibrated roofline costs.
+  TfOpRoofLineCostEstimator() { set_calibration(nullptr); }
   ~TfOpRoofLineCostEstimator() override;
 
   grappler::DeviceInfo GetDeviceInfo(
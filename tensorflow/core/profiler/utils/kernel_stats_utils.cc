@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/logging.h"
@@ -37,6 +38,35 @@ namespace {
 // The maximum number of Kernels displayed on Kernel Stats page.
 const int kMaxNumOfKernels = 1000;
 
+// A kernel using less than this fraction of both the peak FLOP rate and the
+// peak memory bandwidth is latency bound.
+constexpr double kLatencyBoundUtilization = 0.1;
+
+void ClassifyKernelReport(double peak_flops_per_second,
+                          double peak_bytes_per_second, KernelReport* kernel) {
+  kernel->set_bound(KernelReport::BOUND_UNKNOWN);
+  const double flops = kernel->total_flops();
+  const double bytes = kernel->total_bytes_accessed();
+  if (kernel->total_duration_ns() == 0 || (flops == 0 && bytes == 0)) return;
+  const double seconds = kernel->total_duration_ns() / 1e9;
+  if (bytes > 0) kernel->set_arithmetic_intensity(flops / bytes);
+  if (peak_flops_per_second <= 0 || peak_bytes_per_second <= 0) return;
+  kernel->set_flop_rate_utilization(flops / seconds / peak_flops_per_second);
+  kernel->set_memory_bandwidth_utilization(bytes / seconds /
+                                           peak_bytes_per_second);
+
+  const double ridge_point = peak_flops_per_second / peak_bytes_per_second;
+  if (std::max(kernel->flop_rate_utilization(),
+               kernel->memory_bandwidth_utilization()) <
+      kLatencyBoundUtilization) {
+    kernel->set_bound(KernelReport::LATENCY_BOUND);
+  } else if (bytes == 0 || kernel->arithmetic_intensity() >= ridge_point) {
+    kernel->set_bound(KernelReport::COMPUTE_BOUND);
+  } else {
+    kernel->set_bound(KernelReport::MEMORY_BOUND);
+  }
+}
+
 }  // namespace
 
 void ParseKernelLaunchParams(absl::string_view xstat_kernel_details,
@@ -270,6 +300,13 @@ void CopyTopKDurationKernelReportsToDb(const KernelReportMap& reports,
     report->set_min_duration_ns(kernel_value.min_duration_ns);
     report->set_max_duration_ns(kernel_value.max_duration_ns);
     report->set_total_duration_ns(kernel_value.total_duration_ns);
+    report->set_total_flops(kernel_value.total_flops);
+    report->set_total_bytes_accessed(kernel_value.total_bytes_accessed);
+    report->set_is_cost_measured(kernel_value.is_cost_measured);
+    if (kernel_value.total_duration_ns > 0) {
+      report->set_achieved_occupancy(kernel_value.occupancy_duration_ns /
+                                     kernel_value.total_duration_ns);
+    }
   }
 }
 
@@ -286,6 +323,10 @@ void InsertOrUpdateKernelReport(const KernelReport& kernel,
     element.max_duration_ns =
         std::max(element.max_duration_ns, value.max_duration_ns);
     element.occurrences += 1;
+    element.total_flops += value.total_flops;
+    element.total_bytes_accessed += value.total_bytes_accessed;
+    element.is_cost_measured &= value.is_cost_measured;
+    element.occupancy_duration_ns += value.occupancy_duration_ns;
   }
 }
 
@@ -295,6 +336,58 @@ void MergeKernelReports(const KernelReportMap& reports, KernelReportMap* dst) {
   }
 }
 
+void ClassifyKernelReports(double peak_tera_flops_per_second,
+                           double peak_hbm_bw_giga_bytes_per_second,
+                           KernelStatsDb* kernel_stats_db) {
+  kernel_stats_db->set_peak_tera_flops_per_second(peak_tera_flops_per_second);
+  kernel_stats_db->set_peak_hbm_bw_giga_bytes_per_second(
+      peak_hbm_bw_giga_bytes_per_second);
+  for (KernelReport& kernel : *kernel_stats_db->mutable_reports()) {
+    ClassifyKernelReport(peak_tera_flops_per_second * 1e12,
+                         peak_hbm_bw_giga_bytes_per_second * 1e9, &kernel);
+  }
+}
+
+std::string FormatKernelRooflineTable(const KernelStatsDb& kernel_stats_db,
+                                      int max_kernels) {
+  const double peak_tera_flops_per_second =
+      kernel_stats_db.peak_tera_flops_per_second();
+  const double peak_hbm_bw_giga_bytes_per_second =
+      kernel_stats_db.peak_hbm_bw_giga_bytes_per_second();
+  std::string table = absl::StrFormat(
+      "Peak: %.1f TFLOP/s, %.1f GB/s, ridge point: %.1f FLOP/byte\n",
+      peak_tera_flops_per_second, peak_hbm_bw_giga_bytes_per_second,
+      peak_hbm_bw_giga_bytes_per_second > 0
+          ? peak_tera_flops_per_second * 1e3 /
+                peak_hbm_bw_giga_bytes_per_second
+          : 0.0);
+  absl::StrAppendFormat(&table, "%-13s %12s %10s %10s %10s %7s %7s %9s  %s\n",
+                        "Bound", "Time (us)", "FLOP/byte", "GFLOP/s", "GB/s",
+                        "%FLOP", "%BW", "Occupancy", "Kernel");
+  const int num_kernels =
+      std::min(max_kernels, kernel_stats_db.reports_size());
+  for (int i = 0; i < num_kernels; ++i) {
+    const KernelReport& kernel = kernel_stats_db.reports(i);
+    const double seconds = kernel.total_duration_ns() / 1e9;
+    const double gflops_per_second =
+        seconds > 0 ? kernel.total_flops() / seconds / 1e9 : 0;
+    const double gbytes_per_second =
+        seconds > 0 ? kernel.total_bytes_accessed() / seconds / 1e9 : 0;
+    absl::StrAppendFormat(
+        &table, "%-13s %12.1f %10.2f %10.1f %10.1f %6.1f%% %6.1f%% %9s  %s%s\n",
+        absl::string_view(KernelReport::Bound_Name(kernel.bound())),
+        kernel.total_duration_ns() / 1e3, kernel.arithmetic_intensity(),
+        gflops_per_second, gbytes_per_second,
+        kernel.flop_rate_utilization() * 100,
+        kernel.memory_bandwidth_utilization() * 100,
+        kernel.achieved_occupancy() > 0
+            ? absl::StrFormat("%.2f", kernel.achieved_occupancy())
+            : "-",
+        kernel.name(), kernel.is_cost_measured() ? "" : " (estimated)");
+  }
+  return table;
+}
+
 KernelStatsByOpName GroupKernelReportsByOpName(
     const KernelStatsDb& kernel_stats_db) {
   KernelStatsByOpName op_level_kernel_stats;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_UTILS_KERNEL_STATS_UTILS_H_
 #define TENSORFLOW_CORE_PROFILER_UTILS_KERNEL_STATS_UTILS_H_
 
+#include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -59,6 +60,12 @@ struct KernelReportValue {
   uint64 min_duration_ns = 0;
   uint64 max_duration_ns = 0;
   uint64 occurrences = 0;
+  // Costs of the occurrences, see KernelReport.
+  uint64 total_flops = 0;
+  uint64 total_bytes_accessed = 0;
+  bool is_cost_measured = false;
+  // Sum over the occurrences of the achieved occupancy times the duration.
+  double occupancy_duration_ns = 0;
 };
 
 struct KernelKeyWrap {
@@ -110,6 +117,18 @@ void InsertOrUpdateKernelReport(const KernelReport& kernel,
 // Aggregates values from one KernelReportMap into another.
 void MergeKernelReports(const KernelReportMap& reports, KernelReportMap* dst);
 
+// Places the kernels of <kernel_stats_db> in the roofline model of a device
+// with the given peak FLOP rate and memory bandwidth, and classifies them as
+// memory, compute or latency bound.
+void ClassifyKernelReports(double peak_tera_flops_per_second,
+                           double peak_hbm_bw_giga_bytes_per_second,
+                           KernelStatsDb* kernel_stats_db);
+
+// Returns a table of the roofline positions of the first <max_kernels> kernels
+// of a classified <kernel_stats_db>.
+std::string FormatKernelRooflineTable(const KernelStatsDb& kernel_stats_db,
+                                      int max_kernels);
+
 // Kernel stats aggregated at TF operation level.
 struct OpLevelKernelStats {
   // Whether op is eligible to use TensorCore.
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/utils/kernel_stats_utils.h"
 
+#include <string>
+
+#include "absl/strings/match.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/profiler/protobuf/kernel_stats.pb.h"
 
@@ -66,6 +69,45 @@ TEST(KernelStatsUtilsTest, TestGroupKernelReportsByOpName) {
   EXPECT_EQ(op2_stats.tensor_core_duration_ns, 0);
 }
 
+KernelReport* AddKernel(absl::string_view name, uint64 duration_ns,
+                        uint64 flops, uint64 bytes, KernelStatsDb* db) {
+  KernelReport* kernel = db->add_reports();
+  kernel->set_name(std::string(name));
+  kernel->set_total_duration_ns(duration_ns);
+  kernel->set_total_flops(flops);
+  kernel->set_total_bytes_accessed(bytes);
+  return kernel;
+}
+
+TEST(KernelStatsUtilsTest, ClassifyKernelReports) {
+  KernelStatsDb kernel_stats_db;
+  // 10 TFLOP/s and 1000 GB/s: the ridge point is 10 FLOP/byte, and a
+  // kernel running for 1ms can do up to 1e10 FLOPs and access up to 1e9 bytes.
+  AddKernel("compute", 1000000, 8e9, 1e8, &kernel_stats_db);
+  AddKernel("memory", 1000000, 1e9, 9e8, &kernel_stats_db);
+  AddKernel("latency", 1000000, 1e6, 1e6, &kernel_stats_db);
+  AddKernel("unknown", 1000000, 0, 0, &kernel_stats_db);
+  ClassifyKernelReports(10, 1000, &kernel_stats_db);
+
+  const KernelReport& compute = kernel_stats_db.reports(0);
+  EXPECT_EQ(compute.bound(), KernelReport::COMPUTE_BOUND);
+  EXPECT_DOUBLE_EQ(compute.arithmetic_intensity(), 80);
+  EXPECT_NEAR(compute.flop_rate_utilization(), 0.8, 1e-9);
+  EXPECT_NEAR(compute.memory_bandwidth_utilization(), 0.1, 1e-9);
+  const KernelReport& memory = kernel_stats_db.reports(1);
+  EXPECT_EQ(memory.bound(), KernelReport::MEMORY_BOUND);
+  EXPECT_NEAR(memory.memory_bandwidth_utilization(), 0.9, 1e-9);
+  EXPECT_EQ(kernel_stats_db.reports(2).bound(), KernelReport::LATENCY_BOUND);
+  EXPECT_EQ(kernel_stats_db.reports(3).bound(), KernelReport::BOUND_UNKNOWN);
+
+  const std::string table =
+      FormatKernelRooflineTable(kernel_stats_db, /*max_kernels=*/2);
+  EXPECT_TRUE(absl::StrContains(table, "ridge point: 10.0 FLOP/byte"));
+  EXPECT_TRUE(absl::StrContains(table, "COMPUTE_BOUND"));
+  EXPECT_TRUE(absl::StrContains(table, "MEMORY_BOUND"));
+  EXPECT_FALSE(absl::StrContains(table, "LATENCY_BOUND"));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
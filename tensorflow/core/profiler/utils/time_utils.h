@@ -28,6 +28,7 @@ inline double PicosToMillis(uint64 ps) { return ps / 1E9; }
 inline double PicosToSeconds(uint64 ps) { return ps / 1E12; }
 inline uint64 NanosToPicos(uint64 ns) { return ns * 1000; }
 inline double NanosToMicros(uint64 ns) { return ns / 1E3; }
+inline uint64 MicrosToPicos(uint64 us) { return us * 1000000; }
 inline double MicrosToMillis(double us) { return us / 1E3; }
 inline uint64 MillisToPicos(uint64 ms) { return ms * 1000000000; }
 inline uint64 MillisToNanos(uint64 ms) { return ms * 1000000; }
@@ -31,6 +31,8 @@ const absl::string_view kCuptiDriverApiPlaneName = "/host:CUPTI";
 const absl::string_view kMetadataPlaneName = "/host:metadata";
 const absl::string_view kTFStreamzPlaneName = "/host:tfstreamz";
 const absl::string_view kPythonTracerPlaneName = "/host:python-tracer";
+const absl::string_view kMutexContentionPlaneName = "/host:mutex_contention";
+const absl::string_view kRendezvousWaitPlaneName = "/host:rendezvous_waits";
 
 const absl::string_view kStepLineName = "Steps";
 const absl::string_view kTensorFlowNameScopeLineName = "TensorFlow Name Scope";
@@ -190,6 +192,23 @@ const StatTypeMap& GetStatTypeMap() {
       {"SELF_DURATION_PS", kSelfDurationPs},
       {"MIN_DURATION_PS", kMinDurationPs},
       {"Hlo Proto", kHloProto},
+      // tf.data related.
+      {"tf_data_stats", kTfDataStats},
+      // Mutex contention related.
+      {"mutex", kMutexAddress},
+      {"call_site", kCallSite},
+      {"num_contentions", kNumContentions},
+      {"max_wait_ps", kMaxWaitPs},
+      {"contention_summary", kContentionSummary},
+      // Rendezvous wait related.
+      {"send_device", kSendDevice},
+      {"recv_device", kRecvDevice},
+      {"num_waits", kNumWaits},
+      {"rendezvous_wait_summary", kRendezvousWaitSummary},
+      // Kernel metrics related.
+      {"achieved_occupancy", kAchievedOccupancy},
+      {"measured_flops", kMeasuredFlops},
+      {"measured_dram_bytes", kMeasuredDramBytes},
       // Device capability related.
       {"clock_rate", kDevCapClockRateKHz},
       {"core_count", kDevCapCoreCount},
@@ -38,6 +38,10 @@ ABSL_CONST_INIT extern const absl::string_view kMetadataPlaneName;
 ABSL_CONST_INIT extern const absl::string_view kTFStreamzPlaneName;
 // Name of XPlane that contains events from python tracer.
 ABSL_CONST_INIT extern const absl::string_view kPythonTracerPlaneName;
+// Name of XPlane that contains the most contended mutexes.
+ABSL_CONST_INIT extern const absl::string_view kMutexContentionPlaneName;
+// Name of XPlane that contains the edges Recvs waited for the longest.
+ABSL_CONST_INIT extern const absl::string_view kRendezvousWaitPlaneName;
 
 // Names of XLines that contain ML-level events.
 ABSL_CONST_INIT extern const absl::string_view kStepLineName;
@@ -179,6 +183,23 @@ enum StatType {
   kSelfDurationPs,
   kMinDurationPs,
   kHloProto,
+  // tf.data related.
+  kTfDataStats,
+  // Mutex contention related.
+  kMutexAddress,
+  kCallSite,
+  kNumContentions,
+  kMaxWaitPs,
+  kContentionSummary,
+  // Rendezvous wait related.
+  kSendDevice,
+  kRecvDevice,
+  kNumWaits,
+  kRendezvousWaitSummary,
+  // Kernel metrics related.
+  kAchievedOccupancy,
+  kMeasuredFlops,
+  kMeasuredDramBytes,
   // Device capability related.
   kDevCapClockRateKHz,
   kDevCapCoreCount,
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
+class Allocator;
 class DeviceMgr;
 
 namespace thread {
@@ -274,6 +275,27 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Invokes the subgraph named by `handle` like the `RunCallable()`
+  /// overloads above, and allocates the `i`-th fetched tensor with
+  /// `fetch_allocators[i]` (unless it is null), so that the fetched values can
+  /// be computed directly in buffers owned by the caller. The feed tensors are
+  /// passed to the subgraph without being copied.
+  ///
+  /// `fetch_allocators` must be empty, or have one element per fetch. The
+  /// allocators are a hint: a fetched tensor that is not computed by a kernel
+  /// on the client CPU device (e.g. a constant, a variable, or a tensor that a
+  /// kernel forwarded from one of its inputs) is returned as usual.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallable(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Allocator*>& fetch_allocators) {
+    return errors::Unimplemented(
+        "RunCallable with fetch allocators is not supported for this "
+        "session.");
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
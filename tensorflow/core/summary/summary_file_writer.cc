@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -21,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -29,11 +33,17 @@ namespace {
 
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(const SummaryFileWriterOptions& options, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
-        max_queue_(max_queue),
-        flush_millis_(flush_millis),
+        max_queue_(options.max_queue),
+        flush_millis_(options.flush_millis),
+        async_(options.async),
+        // The background thread only wakes up once more than max_queue_
+        // events are pending, so that many must fit.
+        max_pending_events_(
+            std::max(options.max_pending_events, options.max_queue + 1)),
+        overflow_policy_(options.overflow_policy),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -45,13 +55,20 @@ class SummaryFileWriter : public SummaryWriterInterface {
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
     mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
+    {
+      mutex_lock wl(writer_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+    }
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (async_) {
+      thread_.reset(env_->StartThread(ThreadOptions(), "summary_file_writer",
+                                      [this]() { WriterLoop(); }));
+    }
     return Status::OK();
   }
 
@@ -60,10 +77,31 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    if (!async_) return InternalFlush();
+    // Waits for the background thread to write every event enqueued so far.
+    const int64 target = num_enqueued_;
+    if (num_written_ < target) {
+      flush_requested_ = true;
+      work_cv_.notify_one();
+      while (num_written_ < target) {
+        written_cv_.wait(ml);
+      }
+    }
+    Status s = background_status_;
+    background_status_ = Status::OK();
+    return s;
   }
 
   ~SummaryFileWriter() override {
+    if (thread_ != nullptr) {
+      {
+        mutex_lock ml(mu_);
+        shutting_down_ = true;
+        work_cv_.notify_one();
+      }
+      // Joins the thread once it has written the remaining events.
+      thread_.reset();
+    }
     (void)Flush();  // Ignore errors.
   }
 
@@ -140,6 +178,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    if (async_) return Enqueue(std::move(event), &ml);
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
@@ -156,27 +195,116 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+    const Status s = WriteBatch(queue_);
+    queue_.clear();
+    TF_RETURN_IF_ERROR(s);
+    last_flush_ = env_->NowMicros();
+    return Status::OK();
+  }
+
+  // Serializes and writes `batch`, then flushes the events file once.
+  Status WriteBatch(const std::vector<std::unique_ptr<Event>>& batch)
+      TF_LOCKS_EXCLUDED(writer_mu_) {
+    mutex_lock wl(writer_mu_);
+    for (const std::unique_ptr<Event>& e : batch) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
+  Status Enqueue(std::unique_ptr<Event> event, mutex_lock* ml)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (queue_.size() >= max_pending_events_) {
+      if (overflow_policy_ ==
+          SummaryFileWriterOptions::OverflowPolicy::kDropNewest) {
+        ++num_dropped_;
+        LOG_EVERY_N_SEC(WARNING, 10)
+            << "Summary writer queue is full, dropped " << num_dropped_
+            << " events so far.";
+        return Status::OK();
+      }
+      space_cv_.wait(*ml);
+    }
+    queue_.emplace_back(std::move(event));
+    ++num_enqueued_;
+    // The first event starts the flush_millis_ deadline of the background
+    // thread, and a full queue has it write the batch right away.
+    if (queue_.size() == 1 || queue_.size() > max_queue_) {
+      work_cv_.notify_one();
+    }
+    return Status::OK();
+  }
+
+  // Blocks until the background thread has a batch to write.
+  void WaitForWork(mutex_lock* ml) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (!shutting_down_ && !flush_requested_ &&
+           queue_.size() <= max_queue_) {
+      if (queue_.empty()) {
+        work_cv_.wait(*ml);
+        continue;
+      }
+      const uint64 now = env_->NowMicros();
+      const uint64 deadline = last_flush_ + 1000 * flush_millis_;
+      if (now >= deadline) return;
+      WaitForMilliseconds(ml, &work_cv_, (deadline - now + 999) / 1000);
+    }
+  }
+
+  // Body of the background thread of an async writer. Events are written
+  // without holding mu_, so producers only wait for one another.
+  void WriterLoop() {
+    std::vector<std::unique_ptr<Event>> batch;
+    bool shutting_down = false;
+    while (!shutting_down) {
+      int64 batch_end;
+      {
+        mutex_lock ml(mu_);
+        WaitForWork(&ml);
+        batch.swap(queue_);
+        batch_end = num_enqueued_;
+        flush_requested_ = false;
+        shutting_down = shutting_down_;
+        space_cv_.notify_all();
+      }
+      const Status s = WriteBatch(batch);
+      batch.clear();
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+      num_written_ = batch_end;
+      background_status_.Update(s);
+      written_cv_.notify_all();
+    }
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  const bool async_;
+  const int max_pending_events_;
+  const SummaryFileWriterOptions::OverflowPolicy overflow_policy_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  mutex writer_mu_ TF_ACQUIRED_AFTER(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+
+  // State of the background thread of an async writer.
+  std::unique_ptr<Thread> thread_;
+  condition_variable work_cv_;     // Signaled when there is a batch to write.
+  condition_variable space_cv_;    // Signaled when the queue has space.
+  condition_variable written_cv_;  // Signaled when a batch is written.
+  bool flush_requested_ TF_GUARDED_BY(mu_) = false;
+  bool shutting_down_ TF_GUARDED_BY(mu_) = false;
+  int64 num_enqueued_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_written_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_dropped_ TF_GUARDED_BY(mu_) = 0;
+  Status background_status_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace
@@ -185,7 +313,17 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  SummaryFileWriterOptions options;
+  options.max_queue = max_queue;
+  options.flush_millis = flush_millis;
+  return CreateSummaryFileWriter(options, logdir, filename_suffix, env, result);
+}
+
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result) {
+  SummaryFileWriter* w = new SummaryFileWriter(options, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
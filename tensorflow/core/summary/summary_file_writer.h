@@ -22,6 +22,33 @@ limitations under the License.
 
 namespace tensorflow {
 
+/// \brief Options for the writers created by CreateSummaryFileWriter.
+struct SummaryFileWriterOptions {
+  /// Summaries are written out once more than max_queue are enqueued.
+  int max_queue = 10;
+
+  /// Summaries are written out at least every flush_millis milliseconds.
+  int flush_millis = 10000;
+
+  /// If true, summaries are serialized, written and flushed by a background
+  /// thread, and writing a summary only enqueues it. Flush() still blocks
+  /// until every summary written before it is on disk, and returns the
+  /// errors the background thread hit since the previous Flush().
+  bool async = false;
+
+  /// The number of summaries which may wait for the background thread before
+  /// overflow_policy applies. Only used if async is true.
+  int max_pending_events = 1024;
+
+  enum class OverflowPolicy {
+    /// Writers block until the background thread catches up.
+    kBlock,
+    /// New summaries are dropped with a warning.
+    kDropNewest,
+  };
+  OverflowPolicy overflow_policy = OverflowPolicy::kBlock;
+};
+
 /// \brief Creates SummaryWriterInterface which writes to a file.
 ///
 /// The file is an append-only records file of tf.Event protos. That
@@ -38,6 +65,13 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Creates SummaryWriterInterface which writes to a file, configured
+/// by options.
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
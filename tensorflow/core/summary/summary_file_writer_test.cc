@@ -231,5 +231,69 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+// Returns the steps of the events in the only events file for test_name,
+// skipping the leading file version event.
+std::vector<int64> ReadSteps(Env* env, const string& test_name) {
+  std::vector<string> files;
+  TF_CHECK_OK(env->GetChildren(testing::TmpDir(), &files));
+  std::vector<int64> steps;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, test_name)) continue;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    while (reader.ReadRecord(&offset, &record).ok()) {
+      Event e;
+      CHECK(e.ParseFromString(record));
+      steps.push_back(e.step());
+    }
+  }
+  return steps;
+}
+
+TEST_F(SummaryFileWriterTest, AsyncWritesEventsInOrderOnFlush) {
+  SummaryFileWriterOptions options;
+  options.async = true;
+  options.max_queue = 100;
+  options.flush_millis = 1000000;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options, testing::TmpDir(),
+                                      "async_flush_test", &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  for (int step = 0; step < 3; ++step) {
+    TF_CHECK_OK(writer->WriteScalar(step, one, "name"));
+  }
+  TF_CHECK_OK(writer->Flush());
+  EXPECT_EQ(ReadSteps(&env_, "async_flush_test"),
+            std::vector<int64>({0, 1, 2}));
+}
+
+TEST_F(SummaryFileWriterTest, AsyncBlocksWhenQueueIsFull) {
+  SummaryFileWriterOptions options;
+  options.async = true;
+  options.max_queue = 4;
+  options.max_pending_events = 8;
+  options.overflow_policy = SummaryFileWriterOptions::OverflowPolicy::kBlock;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options, testing::TmpDir(),
+                                      "async_block_test", &env_, &writer));
+  std::vector<int64> expected;
+  for (int step = 0; step < 1000; ++step) {
+    std::unique_ptr<Event> e{new Event};
+    e->set_step(step);
+    TF_CHECK_OK(writer->WriteEvent(std::move(e)));
+    expected.push_back(step);
+  }
+  // Destroying the writer writes the remaining events.
+  writer->Unref();
+  EXPECT_EQ(ReadSteps(&env_, "async_block_test"), expected);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -553,6 +553,7 @@ xla::StatusOr<std::unique_ptr<OutputBuffers>> AllocateOutputTensors(
       // This output corresponds to a DT_RESOURCE input to the TPUExecute
       // operator. Update the corresponding variable.
       VariableInfo& var = input_buffers->variables[variable_index];
+      TF_RETURN_IF_ERROR(var.var()->CheckWritable());
       // TODO(b/35625933): the correct thing to do would be to transfer
       // ownership of the PersistentTensor into the Var object. However, Var
       // contains a Tensor so we can't.
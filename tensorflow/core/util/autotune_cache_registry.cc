@@ -0,0 +1,172 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_cache_registry.h"
+
+#include <map>
+#include <set>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace autotune_cache_registry {
+
+namespace {
+struct AutotuneCache {
+  SerializeFn serialize;
+  DeserializeFn deserialize;
+};
+
+struct AutotuneCacheState {
+  mutex mu;
+  std::map<std::string, AutotuneCache> caches TF_GUARDED_BY(mu);
+  // The device kinds loaded by MaybeLoadPersistentAutotuneCaches().
+  std::set<std::string> loaded_device_kinds TF_GUARDED_BY(mu);
+};
+
+AutotuneCacheState* GetSingletonState() {
+  static AutotuneCacheState* state = new AutotuneCacheState;
+  return state;
+}
+
+// Adds the results of the file "path", if it exists, to "cache".
+Status MaybeLoadCache(Env* env, const std::string& path,
+                      const AutotuneCache& cache) {
+  if (!env->FileExists(path).ok()) return Status::OK();
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &serialized));
+  Status s = cache.deserialize(serialized);
+  if (!s.ok()) {
+    return errors::DataLoss("Unable to load autotune cache ", path, ": ",
+                            s.error_message());
+  }
+  VLOG(1) << "Loaded autotune cache " << path;
+  return Status::OK();
+}
+
+// Returns TF_AUTOTUNE_CACHE_DIR, read once.
+const std::string& PersistentCacheRoot() {
+  static const std::string* root = [] {
+    std::string* root = new std::string;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_AUTOTUNE_CACHE_DIR", "", root));
+    return root;
+  }();
+  return *root;
+}
+
+// Returns the subdirectory "device_kind" of TF_AUTOTUNE_CACHE_DIR, or "" if
+// it is not set.
+std::string PersistentCacheDir(const std::string& device_kind) {
+  if (PersistentCacheRoot().empty()) return "";
+  return io::JoinPath(PersistentCacheRoot(), device_kind);
+}
+}  // namespace
+
+void RegisterAutotuneCache(const std::string& name, SerializeFn serialize,
+                           DeserializeFn deserialize) {
+  AutotuneCacheState* state = GetSingletonState();
+  mutex_lock l(state->mu);
+  CHECK(state->caches
+            .emplace(name, AutotuneCache{std::move(serialize),
+                                         std::move(deserialize)})
+            .second)
+      << "Autotune cache " << name << " registered twice";
+}
+
+Status SaveAutotuneCaches(Env* env, const std::string& dir) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  AutotuneCacheState* state = GetSingletonState();
+  mutex_lock l(state->mu);
+  for (const auto& p : state->caches) {
+    std::string serialized;
+    TF_RETURN_IF_ERROR(p.second.serialize(&serialized));
+    TF_RETURN_IF_ERROR(
+        WriteStringToFile(env, io::JoinPath(dir, p.first), serialized));
+  }
+  return Status::OK();
+}
+
+Status LoadAutotuneCaches(Env* env, const std::string& dir) {
+  AutotuneCacheState* state = GetSingletonState();
+  mutex_lock l(state->mu);
+  for (const auto& p : state->caches) {
+    TF_RETURN_IF_ERROR(
+        MaybeLoadCache(env, io::JoinPath(dir, p.first), p.second));
+  }
+  return Status::OK();
+}
+
+Status SaveAutotuneCache(Env* env, const std::string& dir,
+                         const std::string& name) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  AutotuneCacheState* state = GetSingletonState();
+  mutex_lock l(state->mu);
+  auto it = state->caches.find(name);
+  if (it == state->caches.end()) {
+    return errors::NotFound("No autotune cache named ", name);
+  }
+  const std::string path = io::JoinPath(dir, name);
+  // Keep the results that other processes saved since this one loaded them.
+  TF_RETURN_IF_ERROR(MaybeLoadCache(env, path, it->second));
+  std::string serialized;
+  TF_RETURN_IF_ERROR(it->second.serialize(&serialized));
+  std::string tmp_path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Unable to name a temporary file for ", path);
+  }
+  tmp_path = io::JoinPath(dir, io::Basename(tmp_path));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, serialized));
+  return env->RenameFile(tmp_path, path);
+}
+
+bool PersistentAutotuneCachesEnabled() {
+  return !PersistentCacheRoot().empty();
+}
+
+void MaybeLoadPersistentAutotuneCaches(const std::string& device_kind) {
+  const std::string dir = PersistentCacheDir(device_kind);
+  if (dir.empty()) return;
+  {
+    AutotuneCacheState* state = GetSingletonState();
+    mutex_lock l(state->mu);
+    if (!state->loaded_device_kinds.insert(device_kind).second) return;
+  }
+  Status s = LoadAutotuneCaches(Env::Default(), dir);
+  if (!s.ok()) {
+    LOG(WARNING) << "Unable to load the autotune caches of " << dir << ": "
+                 << s;
+  }
+}
+
+void MaybeSavePersistentAutotuneCache(const std::string& device_kind,
+                                      const std::string& name) {
+  const std::string dir = PersistentCacheDir(device_kind);
+  if (dir.empty()) return;
+  Status s = SaveAutotuneCache(Env::Default(), dir, name);
+  if (!s.ok()) {
+    LOG(WARNING) << "Unable to save the autotune cache " << name << " to "
+                 << dir << ": " << s;
+  }
+}
+
+}  // namespace autotune_cache_registry
+
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Lets the kernels that autotune their implementation, e.g. the cuDNN
+// convolutions, save their results with a SavedModel and start from them when
+// it is loaded, so that the first steps of a new process don't pay for the
+// autotuning.
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_CACHE_REGISTRY_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_CACHE_REGISTRY_H_
+
+#include <functional>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+namespace autotune_cache_registry {
+
+// Serializes the autotuning results of a kernel.
+typedef std::function<Status(std::string* serialized)> SerializeFn;
+// Adds serialized results to those of a kernel, as if it had autotuned them.
+typedef std::function<Status(const std::string& serialized)> DeserializeFn;
+
+// Registers the autotuning results of a kernel under "name", which must be
+// unique and a valid file name.
+void RegisterAutotuneCache(const std::string& name, SerializeFn serialize,
+                           DeserializeFn deserialize);
+
+// Writes the results of each registered kernel to the file "name" of the
+// directory "dir", which is created if needed.
+Status SaveAutotuneCaches(Env* env, const std::string& dir);
+
+// Adds the results of the files of "dir" written by SaveAutotuneCaches() to
+// those of the kernels of the same names, and ignores the other files. The
+// results must come from the same devices and library versions, e.g. of
+// cuDNN, since they are used without checking that they are still valid.
+Status LoadAutotuneCaches(Env* env, const std::string& dir);
+
+// Writes the results of the kernel "name" to the file "name" of the directory
+// "dir", after adding to them the results already in that file. Several
+// processes may share "dir": the file is replaced atomically, with the results
+// of all of them.
+Status SaveAutotuneCache(Env* env, const std::string& dir,
+                         const std::string& name);
+
+// The environment variable TF_AUTOTUNE_CACHE_DIR names a directory where the
+// results of the kernels persist across processes, in a subdirectory per
+// "device_kind" (e.g. the GPU model and library versions). The functions below
+// do nothing when it is not set, and only log their errors.
+
+// Returns whether TF_AUTOTUNE_CACHE_DIR is set.
+bool PersistentAutotuneCachesEnabled();
+
+// Loads the results of the subdirectory "device_kind", the first time it is
+// called for "device_kind".
+void MaybeLoadPersistentAutotuneCaches(const std::string& device_kind);
+
+// Saves the results of the kernel "name" to the subdirectory "device_kind",
+// e.g. after it has autotuned a new configuration.
+void MaybeSavePersistentAutotuneCache(const std::string& device_kind,
+                                      const std::string& name);
+
+#define REGISTER_AUTOTUNE_CACHE(name, serialize, deserialize) \
+  REGISTER_AUTOTUNE_CACHE_UNIQ_HELPER(__COUNTER__, name, serialize, deserialize)
+
+#define REGISTER_AUTOTUNE_CACHE_UNIQ_HELPER(ctr, name, serialize, deserialize) \
+  REGISTER_AUTOTUNE_CACHE_UNIQ(ctr, name, serialize, deserialize)
+
+#define REGISTER_AUTOTUNE_CACHE_UNIQ(ctr, name, serialize, deserialize) \
+  static bool autotune_cache_registry_registration_##ctr =             \
+      (::tensorflow::autotune_cache_registry::RegisterAutotuneCache(   \
+           name, serialize, deserialize),                              \
+       true)
+
+}  // namespace autotune_cache_registry
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_CACHE_REGISTRY_H_
@@ -0,0 +1,95 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_cache_registry.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace autotune_cache_registry {
+namespace {
+
+string* TestCache() {
+  static string* cache = new string("tuned");
+  return cache;
+}
+
+REGISTER_AUTOTUNE_CACHE(
+    "AutotuneCacheRegistryTest",
+    [](string* serialized) {
+      *serialized = *TestCache();
+      return Status::OK();
+    },
+    [](const string& serialized) {
+      if (serialized.empty()) return errors::InvalidArgument("Empty cache");
+      *TestCache() = serialized;
+      return Status::OK();
+    });
+
+TEST(AutotuneCacheRegistryTest, SavesAndLoads) {
+  Env* env = Env::Default();
+  const string dir = io::JoinPath(testing::TmpDir(), "autotune_saves");
+  TF_ASSERT_OK(SaveAutotuneCaches(env, dir));
+  *TestCache() = "forgotten";
+  TF_ASSERT_OK(LoadAutotuneCaches(env, dir));
+  EXPECT_EQ("tuned", *TestCache());
+}
+
+TEST(AutotuneCacheRegistryTest, IgnoresMissingAndUnknownCaches) {
+  Env* env = Env::Default();
+  const string dir = io::JoinPath(testing::TmpDir(), "autotune_unknown");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(WriteStringToFile(env, io::JoinPath(dir, "Unknown"), "x"));
+  *TestCache() = "kept";
+  TF_ASSERT_OK(LoadAutotuneCaches(env, dir));
+  EXPECT_EQ("kept", *TestCache());
+}
+
+TEST(AutotuneCacheRegistryTest, InvalidCache) {
+  Env* env = Env::Default();
+  const string dir = io::JoinPath(testing::TmpDir(), "autotune_invalid");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(WriteStringToFile(
+      env, io::JoinPath(dir, "AutotuneCacheRegistryTest"), ""));
+  EXPECT_TRUE(errors::IsDataLoss(LoadAutotuneCaches(env, dir)));
+}
+
+TEST(AutotuneCacheRegistryTest, SaveMergesSavedResults) {
+  Env* env = Env::Default();
+  const string dir = io::JoinPath(testing::TmpDir(), "autotune_merges");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+  const string path = io::JoinPath(dir, "AutotuneCacheRegistryTest");
+  TF_ASSERT_OK(WriteStringToFile(env, path, "saved by another process"));
+  *TestCache() = "tuned";
+  TF_ASSERT_OK(SaveAutotuneCache(env, dir, "AutotuneCacheRegistryTest"));
+  // The test cache keeps the last deserialized value, the one in the file.
+  EXPECT_EQ("saved by another process", *TestCache());
+  string saved;
+  TF_ASSERT_OK(ReadFileToString(env, path, &saved));
+  EXPECT_EQ("saved by another process", saved);
+  std::vector<string> children;
+  TF_ASSERT_OK(env->GetChildren(dir, &children));
+  EXPECT_EQ(1, children.size());
+  EXPECT_TRUE(errors::IsNotFound(SaveAutotuneCache(env, dir, "Unknown")));
+}
+
+}  // namespace
+}  // namespace autotune_cache_registry
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
 #include <vector>
 
 #include "absl/base/casts.h"
@@ -109,6 +110,56 @@ uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   return *static_cast<const uint8*>(ptr);
 }
 
+// Decodes the packed varints in [begin, end) and appends them to *list with a
+// single resize, instead of calling `CodedInputStream::ReadVarint64()` for each
+// value. Runs of 8 single-byte varints (small ids, labels, ...) are copied
+// after a single check of their continuation bits. Returns false if the bytes
+// are not a sequence of valid varints.
+template <typename Result>
+bool ParsePackedInt64List(const uint8* begin, const uint8* end,
+                          Result* int64_list) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  if (begin < end && (end[-1] & 0x80) != 0) return false;
+  // The last byte of each varint is its only byte without the continuation
+  // bit. This loop is simple enough to be vectorized.
+  size_t num_values = 0;
+  for (const uint8* p = begin; p < end; ++p) {
+    num_values += (*p & 0x80) == 0;
+  }
+  const size_t initial_size = int64_list->size();
+  int64_list->resize(initial_size + num_values);
+  // A LimitedArraySlice may hold fewer values than requested, in which case
+  // the values that do not fit are only validated.
+  int64* out = int64_list->data() + initial_size;
+  int64* const out_end = int64_list->data() + int64_list->size();
+  const uint8* p = begin;
+  while (p < end) {
+    if (end - p >= 8 && out_end - out >= 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) out[i] = p[i];
+        p += 8;
+        out += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    int shift = 0;
+    uint8 byte;
+    do {
+      // A varint has at most 10 bytes.
+      if (p == end || shift >= 70) return false;
+      byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (out < out_end) *out = static_cast<int64>(value);
+    ++out;
+  }
+  return true;
+}
+
 constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
@@ -299,15 +350,20 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        if (packed_length > 0) {
+          const void* packed_data;
+          int buffer_size;
+          if (!stream.GetDirectBufferPointer(&packed_data, &buffer_size) ||
+              static_cast<uint32>(buffer_size) < packed_length) {
+            return false;
+          }
+          const uint8* packed_begin = static_cast<const uint8*>(packed_data);
+          if (!ParsePackedInt64List(packed_begin, packed_begin + packed_length,
+                                    int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
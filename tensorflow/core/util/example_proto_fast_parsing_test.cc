@@ -13,12 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -170,6 +173,29 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64OfAllSizes) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  // Long runs of single-byte values, interleaved with multi-byte ones.
+  for (int i = 0; i < 50; ++i) int64_list->add_value(i % 100);
+  for (int64 value : {int64{128}, int64{300}, int64{-1}, int64{1} << 40,
+                      std::numeric_limits<int64>::max(),
+                      std::numeric_limits<int64>::min()}) {
+    int64_list->add_value(value);
+    for (int i = 0; i < 9; ++i) int64_list->add_value(i);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64) {
+  // The packed value 0x80 has a continuation bit but no following byte.
+  const string serialized =
+      "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x80";
+  Example fast_example;
+  EXPECT_FALSE(TestFastParse(serialized, &fast_example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
@@ -413,6 +439,41 @@ TEST(FastParse, FuzzTest) {
   }
 }
 
+TEST(TestFastParseExample, DensePackedInt64) {
+  std::vector<tstring> serialized;
+  for (int i = 0; i < 3; ++i) {
+    Example example;
+    auto* int64_list =
+        (*example.mutable_features()->mutable_feature())[kDenseInt64Key]
+            .mutable_int64_list();
+    for (int j = 0; j < 20; ++j) {
+      int64_list->add_value(j % 2 == 0 ? i * 20 + j : -(int64{1} << (i + j)));
+    }
+    serialized.push_back(Serialize(example));
+  }
+  FastParseExampleConfig config;
+  config.dense.push_back({kDenseInt64Key, DT_INT64, PartialTensorShape({20}),
+                          Tensor(DT_INT64, TensorShape({0})),
+                          /*variable_length=*/false,
+                          /*elements_per_stride=*/20});
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(1, result.dense_values.size());
+  auto values = result.dense_values[0].matrix<int64>();
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 20; ++j) {
+      EXPECT_EQ(j % 2 == 0 ? i * 20 + j : -(int64{1} << (i + j)),
+                values(i, j));
+    }
+  }
+
+  // Examples with too many values do not fit in the dense output.
+  config.dense[0].shape = PartialTensorShape({10});
+  config.dense[0].elements_per_stride = 10;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      FastParseExample(config, serialized, {}, nullptr, &result)));
+}
+
 TEST(TestFastParseExample, Empty) {
   Result result;
   FastParseExampleConfig config;
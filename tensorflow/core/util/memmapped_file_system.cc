@@ -14,6 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/memmapped_file_system.h"
 
+#include <algorithm>
+#include <set>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -149,6 +155,56 @@ Status MemmappedFileSystem::Stat(const string& fname, TransactionToken* token,
   auto status = GetFileSize(fname, token, &size);
   if (status.ok()) {
     stat->length = size;
+  } else if (errors::IsNotFound(status) && IsDirectory(fname, token).ok()) {
+    *stat = FileStatistics();
+    stat->is_directory = true;
+    status = Status::OK();
+  }
+  return status;
+}
+
+Status MemmappedFileSystem::GetChildren(const string& dir,
+                                        TransactionToken* token,
+                                        std::vector<string>* result) {
+  if (!mapped_memory_) {
+    return errors::FailedPrecondition("MemmappedEnv is not initialized");
+  }
+  const string prefix = absl::EndsWith(dir, "/") ? dir : absl::StrCat(dir, "/");
+  std::set<string> children;
+  for (const auto& element : directory_) {
+    StringPiece name = element.first;
+    if (!absl::ConsumePrefix(&name, prefix) || name.empty()) continue;
+    children.emplace(name.substr(0, name.find('/')));
+  }
+  if (children.empty()) {
+    return errors::NotFound("Directory ", dir, " is not found");
+  }
+  result->assign(children.begin(), children.end());
+  return Status::OK();
+}
+
+Status MemmappedFileSystem::GetMatchingPaths(const string& pattern,
+                                             TransactionToken* token,
+                                             std::vector<string>* results) {
+  if (!mapped_memory_) {
+    return errors::FailedPrecondition("MemmappedEnv is not initialized");
+  }
+  results->clear();
+  for (const auto& element : directory_) {
+    if (Match(element.first, pattern)) {
+      results->push_back(element.first);
+    }
+  }
+  std::sort(results->begin(), results->end());
+  return Status::OK();
+}
+
+Status MemmappedFileSystem::IsDirectory(const string& dirname,
+                                        TransactionToken* token) {
+  std::vector<string> children;
+  const Status status = GetChildren(dirname, token, &children);
+  if (errors::IsNotFound(status) && FileExists(dirname, token).ok()) {
+    return errors::FailedPrecondition(dirname, " is not a directory");
   }
   return status;
 }
@@ -165,19 +221,6 @@ Status MemmappedFileSystem::NewAppendableFile(
   return errors::Unimplemented("memmapped format doesn't support writing");
 }
 
-Status MemmappedFileSystem::GetChildren(const string& filename,
-                                        TransactionToken* token,
-                                        std::vector<string>* strings) {
-  return errors::Unimplemented("memmapped format doesn't support GetChildren");
-}
-
-Status MemmappedFileSystem::GetMatchingPaths(const string& pattern,
-                                             TransactionToken* token,
-                                             std::vector<string>* results) {
-  return errors::Unimplemented(
-      "memmapped format doesn't support GetMatchingPaths");
-}
-
 Status MemmappedFileSystem::DeleteFile(const string& filename,
                                        TransactionToken* token) {
   return errors::Unimplemented("memmapped format doesn't support DeleteFile");
@@ -261,7 +304,8 @@ bool MemmappedFileSystem::IsMemmappedPackageFilename(const string& filename) {
 namespace {
 bool IsValidRegionChar(char c) {
   return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
-         (c >= '0' && c <= '9') || c == '_' || c == '.';
+         (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '-' ||
+         c == '/';
 }
 }  // namespace
 
@@ -43,7 +43,9 @@ namespace tensorflow {
 // Region naming:
 // Region naming is up to the application, all of them starts from
 // kMemmappedPackagePrefix. The default graph usually has name
-// kMemmappedPackageDefaultGraphDef;
+// kMemmappedPackageDefaultGraphDef; Names may contain '/' to lay out regions
+// like the files of a directory, e.g. the variables and assets of a
+// SavedModel, which can then be listed with GetChildren and GetMatchingPaths.
 //
 // A "frozen" GraphDef can be converted into this format using
 // tensorflow/contrib/util/convert_graphdef_memmapped_format
@@ -77,10 +79,6 @@ class MemmappedFileSystem : public FileSystem {
                          std::unique_ptr<WritableFile>* result) override;
   Status NewAppendableFile(const string& fname, TransactionToken* token,
                            std::unique_ptr<WritableFile>* result) override;
-  Status GetChildren(const string& dir, TransactionToken* token,
-                     std::vector<string>* r) override;
-  Status GetMatchingPaths(const string& pattern, TransactionToken* token,
-                          std::vector<string>* results) override;
   Status DeleteFile(const string& f, TransactionToken* token) override;
   Status CreateDir(const string& d, TransactionToken* token) override;
   Status DeleteDir(const string& d, TransactionToken* token) override;
@@ -90,9 +88,15 @@ class MemmappedFileSystem : public FileSystem {
   // These functions are implemented.
   Status GetFileSize(const string& f, TransactionToken* token,
                      uint64* s) override;
-  // Currently just returns size.
+  // Currently just returns size, or that `fname` is a directory.
   Status Stat(const string& fname, TransactionToken* token,
               FileStatistics* stat) override;
+  // Directories are the prefixes of region names ending at a '/'.
+  Status GetChildren(const string& dir, TransactionToken* token,
+                     std::vector<string>* r) override;
+  Status GetMatchingPaths(const string& pattern, TransactionToken* token,
+                          std::vector<string>* results) override;
+  Status IsDirectory(const string& fname, TransactionToken* token) override;
 
   // Initializes filesystem from a file in memmapped format.
   Status InitializeFromFile(Env* env, const string& filename);
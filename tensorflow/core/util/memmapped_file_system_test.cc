@@ -110,6 +110,75 @@ TEST(MemmappedFileSystemTest, SimpleTest) {
             memmapped_env.FileExists("bla-bla-bla").code());
 }
 
+TEST(MemmappedFileSystemTest, SavedFiles) {
+  Env* env = Env::Default();
+  const string dir = testing::TmpDir();
+  const string vocab_filename = io::JoinPath(dir, "vocab.txt");
+  const string vocab = "a\nb\nc\n";
+  TF_ASSERT_OK(WriteStringToFile(env, vocab_filename, vocab));
+  const string bundle_prefix = io::JoinPath(dir, "bundle", "variables");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(io::JoinPath(dir, "bundle")));
+  TF_ASSERT_OK(WriteStringToFile(env, bundle_prefix + ".index", "index"));
+  TF_ASSERT_OK(WriteStringToFile(
+      env, bundle_prefix + ".data-00000-of-00001", "data"));
+
+  const string filename = io::JoinPath(dir, "memmapped_env_files_test");
+  MemmappedFileSystemWriter writer;
+  TF_ASSERT_OK(writer.InitializeToFile(env, filename));
+  TF_ASSERT_OK(writer.SaveFile(env, vocab_filename,
+                               "memmapped_package://assets/vocab.txt"));
+  TF_ASSERT_OK(writer.SaveTensorBundle(
+      env, bundle_prefix, "memmapped_package://variables/variables"));
+  TF_ASSERT_OK(writer.FlushAndClose());
+
+  MemmappedEnv memmapped_env(env);
+  TF_ASSERT_OK(memmapped_env.InitializeFromFile(filename));
+
+  // The saved files are read back from the mapped package.
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(
+      &memmapped_env, "memmapped_package://assets/vocab.txt", &contents));
+  EXPECT_EQ(vocab, contents);
+  TF_ASSERT_OK(ReadFileToString(
+      &memmapped_env, "memmapped_package://variables/variables.index",
+      &contents));
+  EXPECT_EQ("index", contents);
+  TF_ASSERT_OK(ReadFileToString(
+      &memmapped_env,
+      "memmapped_package://variables/variables.data-00000-of-00001",
+      &contents));
+  EXPECT_EQ("data", contents);
+
+  // The regions can be listed like the files of directories.
+  std::vector<string> children;
+  TF_ASSERT_OK(memmapped_env.GetChildren("memmapped_package://", &children));
+  EXPECT_EQ(std::vector<string>({"assets", "variables"}), children);
+  TF_ASSERT_OK(
+      memmapped_env.GetChildren("memmapped_package://variables", &children));
+  EXPECT_EQ(std::vector<string>({"variables.data-00000-of-00001",
+                                 "variables.index"}),
+            children);
+  EXPECT_EQ(error::NOT_FOUND,
+            memmapped_env.GetChildren("memmapped_package://bla", &children)
+                .code());
+
+  std::vector<string> matches;
+  TF_ASSERT_OK(memmapped_env.GetMatchingPaths(
+      "memmapped_package://variables/variables.data-*", &matches));
+  EXPECT_EQ(std::vector<string>(
+                {"memmapped_package://variables/"
+                 "variables.data-00000-of-00001"}),
+            matches);
+
+  TF_EXPECT_OK(memmapped_env.IsDirectory("memmapped_package://assets"));
+  EXPECT_EQ(
+      error::FAILED_PRECONDITION,
+      memmapped_env.IsDirectory("memmapped_package://assets/vocab.txt").code());
+  FileStatistics stat;
+  TF_ASSERT_OK(memmapped_env.Stat("memmapped_package://assets", &stat));
+  EXPECT_TRUE(stat.is_directory);
+}
+
 TEST(MemmappedFileSystemTest, NotInitialized) {
   MemmappedEnv memmapped_env(Env::Default());
   std::unique_ptr<ReadOnlyMemoryRegion> memory_region;
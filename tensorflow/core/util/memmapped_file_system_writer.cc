@@ -16,8 +16,16 @@ limitations under the License.
 
 #include <algorithm>
 
+#include "absl/strings/str_cat.h"
+
 namespace tensorflow {
 
+namespace {
+
+constexpr size_t kCopyBufferSize = 1 << 20;  // 1MB
+
+}  // namespace
+
 Status MemmappedFileSystemWriter::InitializeToFile(Env* env,
                                                    const string& filename) {
   auto status = env->NewWritableFile(filename, &output_file_);
@@ -33,13 +41,7 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
     return errors::FailedPrecondition(
         "MemmappedEnvWritter: saving tensor into not opened file");
   }
-  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
-          element_name)) {
-    return errors::InvalidArgument(
-        "MemmappedEnvWritter: element_name is invalid: must have memmapped ",
-        "package prefix ", MemmappedFileSystem::kMemmappedPackagePrefix,
-        " and include [A-Za-z0-9_.]");
-  }
+  TF_RETURN_IF_ERROR(CheckElementName(element_name));
   const auto tensor_data = tensor.tensor_data();
   if (tensor_data.empty()) {
     return errors::InvalidArgument(
@@ -61,14 +63,7 @@ Status MemmappedFileSystemWriter::SaveProtobuf(
     return errors::FailedPrecondition(
         "MemmappedEnvWritter: saving protobuf into not opened file");
   }
-  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
-          element_name)) {
-    return errors::InvalidArgument(
-        "MemmappedEnvWritter: element_name is invalid: must have memmapped "
-        "package prefix ",
-        MemmappedFileSystem::kMemmappedPackagePrefix,
-        " and include [A-Za-z0-9_.]");
-  }
+  TF_RETURN_IF_ERROR(CheckElementName(element_name));
   const string encoded = message.SerializeAsString();
   AddToDirectoryElement(element_name, encoded.size());
   const auto res = output_file_->Append(encoded);
@@ -78,6 +73,65 @@ Status MemmappedFileSystemWriter::SaveProtobuf(
   return res;
 }
 
+Status MemmappedFileSystemWriter::SaveFile(Env* env, const string& filename,
+                                           const string& element_name) {
+  if (!output_file_) {
+    return errors::FailedPrecondition(
+        "MemmappedEnvWritter: saving file into not opened file");
+  }
+  TF_RETURN_IF_ERROR(CheckElementName(element_name));
+  uint64 file_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  // Aligned like tensors, so that the mapped bytes can back tensors too.
+  TF_RETURN_IF_ERROR(AdjustAlignment(Allocator::kAllocatorAlignment));
+  AddToDirectoryElement(element_name, file_size);
+  std::unique_ptr<char[]> scratch(new char[kCopyBufferSize]);
+  for (uint64 offset = 0; offset < file_size;) {
+    const size_t to_read =
+        std::min(file_size - offset, static_cast<uint64>(kCopyBufferSize));
+    StringPiece data;
+    TF_RETURN_IF_ERROR(file->Read(offset, to_read, &data, scratch.get()));
+    if (data.size() != to_read) {
+      return errors::DataLoss("MemmappedEnvWritter: ", filename,
+                              " changed while being saved");
+    }
+    TF_RETURN_IF_ERROR(output_file_->Append(data));
+    output_file_offset_ += data.size();
+    offset += data.size();
+  }
+  return Status::OK();
+}
+
+Status MemmappedFileSystemWriter::SaveTensorBundle(
+    Env* env, const string& prefix, const string& element_prefix) {
+  // The file names of a bundle, see tensor_bundle.h.
+  std::vector<string> filenames;
+  TF_RETURN_IF_ERROR(
+      env->GetMatchingPaths(absl::StrCat(prefix, ".data-*"), &filenames));
+  filenames.push_back(absl::StrCat(prefix, ".index"));
+  for (const string& filename : filenames) {
+    TF_RETURN_IF_ERROR(SaveFile(
+        env, filename,
+        absl::StrCat(element_prefix, filename.substr(prefix.size()))));
+  }
+  return Status::OK();
+}
+
+Status MemmappedFileSystemWriter::CheckElementName(
+    const string& element_name) const {
+  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
+          element_name)) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: element_name is invalid: must have memmapped "
+        "package prefix ",
+        MemmappedFileSystem::kMemmappedPackagePrefix,
+        " and include [A-Za-z0-9_./-]");
+  }
+  return Status::OK();
+}
+
 namespace {
 
 StringPiece EncodeUint64LittleEndian(uint64 val, char* output_buffer) {
@@ -35,11 +35,21 @@ class MemmappedFileSystemWriter {
   Status SaveTensor(const Tensor& tensor, const string& element_name);
   Status SaveProtobuf(const protobuf::MessageLite& message,
                       const string& element_name);
+  // Copies the contents of `filename`, e.g. a vocabulary or a small dataset,
+  // into an aligned region. Reading the region then returns the mapped bytes.
+  Status SaveFile(Env* env, const string& filename,
+                  const string& element_name);
+  // Copies the index and data files of the tensor bundle `prefix`, e.g. the
+  // variables of a SavedModel, so that it can be read back as the bundle
+  // `element_prefix` through a MemmappedEnv.
+  Status SaveTensorBundle(Env* env, const string& prefix,
+                          const string& element_prefix);
   // Writes out the directory of regions and closes the output file.
   Status FlushAndClose();
 
  private:
   Status AdjustAlignment(uint64 alignment);
+  Status CheckElementName(const string& element_name) const;
   void AddToDirectoryElement(const string& element_name, uint64 length);
   MemmappedFileSystemDirectory directory_;
   // The current offset in the file, to support alignment.
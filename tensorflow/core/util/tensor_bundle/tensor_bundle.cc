@@ -21,6 +21,8 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -33,8 +35,10 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -42,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -403,6 +408,41 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// Densely packed bundles align the data of tensors of at least this many
+// bytes for BundleReader::LookupMapped().  Mapping smaller ones would save
+// little over copying them.
+constexpr size_t kMinMappedTensorBytes = 4096;
+
+// Appends the data of "val" to "out", followed by padding to "alignment", and
+// records its offset, size and checksum in "entry".  "size" is the current
+// size of "out", and is updated to the new size.
+Status AppendTensor(const Tensor& val, int alignment, FileOutputBuffer* out,
+                    int64* size, BundleEntryProto* entry) {
+  if (alignment == 1 && DataTypeCanUseMemcpy(val.dtype()) &&
+      val.TotalBytes() >= kMinMappedTensorBytes) {
+    TF_RETURN_IF_ERROR(
+        PadAlignment(out, Allocator::kAllocatorAlignment, size));
+  }
+  entry->set_offset(*size);
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->clear_crc32c();
+  if (val.dtype() == DT_STRING) {
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, out, &data_bytes_written, &crc32c));
+  } else if (val.dtype() == DT_VARIANT) {
+    TF_RETURN_IF_ERROR(
+        WriteVariantTensor(val, out, &data_bytes_written, &crc32c));
+  } else {
+    TF_RETURN_IF_ERROR(WriteTensor(val, out, &data_bytes_written));
+    crc32c = out->crc32c();
+  }
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return PadAlignment(out, alignment, size);
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -426,6 +466,9 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
+  status_ = Status::OK();
+  // The data files are only opened by Finish().
+  if (options_.num_shards > 1) return;
 
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(data_path_, &wrapper);
@@ -448,28 +491,15 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
+  if (options_.num_shards > 1) {
+    pending_.emplace_back(entry, val);
+    return status_;
+  }
   entry->set_shard_id(0);
-  entry->set_offset(size_);
 
   // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->clear_crc32c();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
-  }
-
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
-  }
+  status_ =
+      AppendTensor(val, options_.data_alignment, out_.get(), &size_, entry);
   return status_;
 }
 
@@ -514,10 +544,87 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+Status BundleWriter::WriteShards(int* num_shards) {
+  const int n = std::max<int>(
+      1, std::min<int64>(options_.num_shards, pending_.size()));
+  *num_shards = n;
+
+  // Spreads the tensors over the shards, by balancing their bytes and then
+  // their number of tensors, so that each of the "n" shards gets a tensor.
+  std::vector<std::vector<int>> shard_tensors(n);
+  std::vector<int64> shard_bytes(n, 0);
+  for (int i = 0; i < pending_.size(); ++i) {
+    int shard = 0;
+    for (int s = 1; s < n; ++s) {
+      if (std::make_pair(shard_bytes[s], shard_tensors[s].size()) <
+          std::make_pair(shard_bytes[shard], shard_tensors[shard].size())) {
+        shard = s;
+      }
+    }
+    shard_bytes[shard] += pending_[i].second.TotalBytes();
+    shard_tensors[shard].push_back(i);
+  }
+
+  std::vector<string> paths(n);
+  std::vector<Status> statuses(n);
+  auto write_shard = [this, n, &shard_tensors, &paths, &statuses](int shard) {
+    paths[shard] = DataFilename(prefix_, shard, n);
+    if (use_temp_file_) {
+      paths[shard] =
+          strings::StrCat(paths[shard], ".tempstate", random::New64());
+    }
+    std::unique_ptr<WritableFile> file;
+    Status& status = statuses[shard];
+    status = env_->NewWritableFile(paths[shard], &file);
+    if (!status.ok()) return;
+    VLOG(1) << "Writing to file " << paths[shard];
+    FileOutputBuffer out(file.release(), 8 << 20 /* 8MB write buffer */);
+    int64 size = 0;
+    for (int i : shard_tensors[shard]) {
+      BundleEntryProto* entry = pending_[i].first;
+      entry->set_shard_id(shard);
+      status = AppendTensor(pending_[i].second, options_.data_alignment, &out,
+                            &size, entry);
+      if (!status.ok()) break;
+    }
+    status.Update(out.Close());
+  };
+  {
+    std::unique_ptr<thread::ThreadPool> pool;
+    if (n > 1) {
+      pool.reset(new thread::ThreadPool(env_, "bundle_writer", n - 1));
+    }
+    for (int shard = 1; shard < n; ++shard) {
+      pool->Schedule([&write_shard, shard]() { write_shard(shard); });
+    }
+    write_shard(0);
+  }  // Waits for the other shards to be written.
+  pending_.clear();
+
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  if (!status.ok()) {
+    for (const string& path : paths) {
+      Env::Default()->DeleteFile(path).IgnoreError();
+    }
+    return status;
+  }
+  if (use_temp_file_) {
+    for (int shard = 0; shard < n; ++shard) {
+      TF_RETURN_IF_ERROR(Env::Default()->RenameFile(
+          paths[shard], DataFilename(prefix_, shard, n)));
+    }
+  }
+  return Status::OK();
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
+  int num_shards = 1;
+  if (options_.num_shards > 1) {
+    if (status_.ok()) status_ = WriteShards(&num_shards);
+  } else if (out_) {
     status_.Update(out_->Close());
     out_ = nullptr;
     if (status_.ok()) {
@@ -542,7 +649,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -950,6 +1057,151 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+namespace {
+
+// A buffer pointing into a memory-mapped data file, which it keeps mapped.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mapped_tensor_bundle");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// The tensors returned by BundleReader::LookupShared(), keyed by the checksum
+// of their contents.
+class SharedTensorStore {
+ public:
+  static SharedTensorStore* Global() {
+    static SharedTensorStore* store = new SharedTensorStore;
+    return store;
+  }
+
+  // Returns a stored tensor equal to "restored", whose contents have the
+  // checksum "crc32c", or stores and returns "restored" if there is none.
+  // REQUIRES: DataTypeCanUseMemcpy(restored.dtype())
+  Tensor Intern(uint32 crc32c, const Tensor& restored) {
+    uint64 key = Hash64Combine(crc32c, restored.dtype());
+    for (int d = 0; d < restored.dims(); ++d) {
+      key = Hash64Combine(key, restored.dim_size(d));
+    }
+    mutex_lock l(mu_);
+    std::vector<Tensor>& candidates = tensors_[key];
+    for (const Tensor& candidate : candidates) {
+      if (candidate.dtype() == restored.dtype() &&
+          candidate.shape() == restored.shape() &&
+          candidate.tensor_data() == restored.tensor_data()) {
+        return candidate;
+      }
+    }
+    candidates.push_back(restored);
+    if (++num_tensors_ >= 2 * num_tensors_after_sweep_) Sweep();
+    return restored;
+  }
+
+ private:
+  // Forgets the tensors that nothing but the store refers to any more.
+  void Sweep() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (auto it = tensors_.begin(); it != tensors_.end();) {
+      std::vector<Tensor>& candidates = it->second;
+      candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                      [](const Tensor& t) {
+                                        return t.RefCountIsOne();
+                                      }),
+                       candidates.end());
+      it = candidates.empty() ? tensors_.erase(it) : std::next(it);
+    }
+    num_tensors_ = 0;
+    for (const auto& p : tensors_) num_tensors_ += p.second.size();
+    num_tensors_after_sweep_ = std::max<int64>(num_tensors_, 64);
+  }
+
+  mutex mu_;
+  std::unordered_map<uint64, std::vector<Tensor>> tensors_ TF_GUARDED_BY(mu_);
+  int64 num_tensors_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_tensors_after_sweep_ TF_GUARDED_BY(mu_) = 64;
+};
+
+}  // namespace
+
+Status BundleReader::LookupShared(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Tensor restored(entry.dtype(), TensorShape(entry.shape()));
+  TF_RETURN_IF_ERROR(Lookup(key, &restored));
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype())) {
+    *val = restored;
+  } else {
+    *val = SharedTensorStore::Global()->Intern(entry.crc32c(), restored);
+  }
+  return Status::OK();
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  auto copy = [&]() {
+    *val = Tensor(entry.dtype(), shape);
+    return Lookup(key, val);
+  };
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_) {
+    return copy();
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    const Status status =
+        env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!status.ok()) {
+      VLOG(1) << "Copying tensors out of " << filename
+              << ", which can't be mapped: " << status;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) {
+    return copy();
+  }
+
+  const size_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size ||
+      entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), " at offset ",
+                            entry.offset(), "; expected size ", expected_size,
+                            " in a data file of ", region->length(), " bytes");
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment != 0) {
+    return copy();
+  }
+  auto* buf = new MappedTensorBuffer(region, data, entry.size());
+  *val = Tensor(entry.dtype(), shape, buf);
+  buf->Unref();
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1146,21 +1398,21 @@ Status FileOutputBuffer::Append(StringPiece data) {
   // points to tensor buffers, which may be concurrently written.
   if (data.size() + position_ <= buffer_size_) {
     // Can fit into the current buffer.
-    memcpy(&buffer_[position_], data.data(), data.size());
-    crc32c_ = crc32c::Extend(crc32c_, &buffer_[position_], data.size());
+    crc32c_ = crc32c::CopyAndExtend(crc32c_, data.data(), data.size(),
+                                    &buffer_[position_]);
   } else if (data.size() <= buffer_size_) {
     // Cannot fit, but can fit after flushing.
     TF_RETURN_IF_ERROR(FlushBuffer());
-    memcpy(&buffer_[0], data.data(), data.size());
-    crc32c_ = crc32c::Extend(crc32c_, &buffer_[0], data.size());
+    crc32c_ = crc32c::CopyAndExtend(crc32c_, data.data(), data.size(),
+                                    &buffer_[0]);
   } else {
     // Cannot fit even after flushing.  So we break down "data" by chunk, and
     // flush/checksum each chunk.
     TF_RETURN_IF_ERROR(FlushBuffer());
     for (size_t i = 0; i < data.size(); i += buffer_size_) {
       const size_t nbytes = std::min(data.size() - i, buffer_size_);
-      memcpy(&buffer_[0], data.data() + i, nbytes);
-      crc32c_ = crc32c::Extend(crc32c_, &buffer_[0], nbytes);
+      crc32c_ =
+          crc32c::CopyAndExtend(crc32c_, data.data() + i, nbytes, &buffer_[0]);
       position_ = nbytes;
       TF_RETURN_IF_ERROR(FlushBuffer());
     }
@@ -39,9 +39,11 @@ limitations under the License.
 //   reader.Lookup("name", &tensor);
 //
 // A tensor bundle can be built using BundleWriter.  Each BundleWriter builds a
-// single data file bundle.  Multiple bundles can then be merged by
-// MergeBundles() without reading and writing large chunk of data: it reads the
-// metadata files and outputs a single merged metadata.  Typical usage:
+// single data file bundle, unless it is asked to write several data files in
+// parallel (see BundleWriter::Options::num_shards).  Multiple bundles can then
+// be merged by MergeBundles() without reading and writing large chunk of data:
+// it reads the metadata files and outputs a single merged metadata.  Typical
+// usage:
 //
 //   worker 0:
 //     BundleWriter writer(env, "/fs/model/train/ckpt-step/tmp/worker0-step");
@@ -62,8 +64,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -110,8 +115,18 @@ class BundleWriter {
   struct Options {
     Options() {}
     // Alignment, in bytes, for tensor data.
-    // Must be >= 1. The default size of 1 densely packs tensors.
+    // Must be >= 1. The default size of 1 densely packs tensors, except that
+    // tensors of 4KiB or more that BundleReader::LookupMapped() can map are
+    // aligned to Allocator::kAllocatorAlignment. With other sizes, tensors
+    // are only mapped without a copy if this is a multiple of
+    // Allocator::kAllocatorAlignment.
     int data_alignment{1};
+    // Number of data files to write. If > 1, Add() only keeps a reference to
+    // the tensors, which must not be modified until Finish(), and Finish()
+    // writes (and checksums) the data files in parallel, one per thread. The
+    // tensors are spread over the files by size, and fewer files are written
+    // if there are fewer tensors.
+    int num_shards{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -146,6 +161,10 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // Writes the tensors in "pending_" in parallel, when options_.num_shards is
+  // > 1, and sets "num_shards" to the number of data files written.
+  Status WriteShards(int* num_shards);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -155,6 +174,8 @@ class BundleWriter {
   std::unique_ptr<FileOutputBuffer> out_;
   int64 size_;  // Number of bytes written into out_.
   std::map<string, BundleEntryProto> entries_;
+  // Tensors added but not yet written, when options_.num_shards is > 1.
+  std::vector<std::pair<BundleEntryProto*, Tensor>> pending_;
   Status status_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
@@ -219,6 +240,36 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but sets "val" to a read-only tensor whose buffer points
+  // into a memory mapping of the data file, which it keeps alive, instead of
+  // copying the contents out. Processes mapping the same bundle share its
+  // pages. Unlike Lookup(), "val" needs no preallocated buffer, and the
+  // checksum of mapped tensors is not validated, since that would read all
+  // of their pages.
+  //
+  // Falls back to copying for partitioned tensors, dtypes that can't be
+  // memcpy'd, bundles of a different endianness, data files that can't be
+  // mapped, and tensors whose data isn't aligned for Eigen, e.g. small
+  // tensors; see BundleWriter::Options::data_alignment.
+  //
+  // The caller must not modify the returned tensor.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Like Lookup(), but once the tensor is read and validated, sets "val" to
+  // an equal tensor returned by an earlier LookupShared() of any reader in the
+  // process, if there is one, and frees the one read. Tensors are compared by
+  // dtype, shape and contents, so that the bundles of similar models, e.g.
+  // fine-tunes of one base model, share the memory of their identical
+  // tensors. Unlike Lookup(), "val" needs no preallocated buffer.
+  //
+  // Partitioned tensors and dtypes that can't be memcpy'd are not shared.
+  //
+  // The caller must not modify the returned tensor in place: it is only
+  // safe to use with copy-on-write consumers, e.g. resource variables.
+  // REQUIRES: status().ok()
+  Status LookupShared(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -293,6 +344,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The memory mappings of data files used by LookupMapped(). Null for files
+  // that couldn't be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -18,6 +18,7 @@ limitations under the License.
 #include <random>
 #include <vector>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -541,6 +542,137 @@ TEST(TensorBundleTest, Basic) {
   TestBasic<bfloat16>();
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  BundleWriter::Options opts;
+  opts.data_alignment = Allocator::kAllocatorAlignment;
+  {
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("bar", Constant_2x3(2.f)));
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3(1.f)));
+    Tensor strings(DT_STRING, TensorShape({2}));
+    strings.flat<tstring>()(0) = "hello";
+    strings.flat<tstring>()(1) = "world";
+    TF_EXPECT_OK(writer.Add("strings", strings));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("mapped"));
+  TF_ASSERT_OK(reader.status());
+
+  Tensor foo, foo_again, bar;
+  TF_ASSERT_OK(reader.LookupMapped("foo", &foo));
+  TF_ASSERT_OK(reader.LookupMapped("foo", &foo_again));
+  TF_ASSERT_OK(reader.LookupMapped("bar", &bar));
+  test::ExpectTensorEqual<float>(Constant_2x3(1.f), foo);
+  test::ExpectTensorEqual<float>(Constant_2x3(2.f), bar);
+  EXPECT_TRUE(foo.IsAligned());
+  // Both lookups point into the same mapping.
+  EXPECT_EQ(foo.tensor_data().data(), foo_again.tensor_data().data());
+
+  // Strings are copied out.
+  Tensor strings;
+  TF_ASSERT_OK(reader.LookupMapped("strings", &strings));
+  EXPECT_EQ("hello", strings.flat<tstring>()(0));
+  EXPECT_EQ("world", strings.flat<tstring>()(1));
+
+  Tensor missing;
+  EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &missing)));
+}
+
+TEST(TensorBundleTest, LookupMappedDenselyPacked) {
+  const Tensor big = Constant(3.f, TensorShape({2048}));
+  {
+    BundleWriter writer(Env::Default(), Prefix("mapped_dense"));
+    TF_EXPECT_OK(writer.Add("a_small", Constant(true, TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("b_big", big));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("mapped_dense"));
+  TF_ASSERT_OK(reader.status());
+
+  // Only the big tensor is padded to be mapped.
+  BundleEntryProto entry;
+  TF_ASSERT_OK(reader.GetBundleEntryProto("b_big", &entry));
+  EXPECT_EQ(0, entry.offset() % Allocator::kAllocatorAlignment);
+  Tensor mapped, mapped_again;
+  TF_ASSERT_OK(reader.LookupMapped("b_big", &mapped));
+  TF_ASSERT_OK(reader.LookupMapped("b_big", &mapped_again));
+  test::ExpectTensorEqual<float>(big, mapped);
+  EXPECT_EQ(mapped.tensor_data().data(), mapped_again.tensor_data().data());
+  Expect<bool>(&reader, "a_small", Constant(true, TensorShape({3})));
+}
+
+TEST(TensorBundleTest, ParallelShards) {
+  BundleWriter::Options opts;
+  opts.num_shards = 3;
+  Tensor strings(DT_STRING, TensorShape({2}));
+  strings.flat<tstring>()(0) = "hello";
+  strings.flat<tstring>()(1) = "world";
+  {
+    BundleWriter writer(Env::Default(), Prefix("parallel"), opts);
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3(3.f)));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant(0.f, TensorShape({100}))));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3(2.f)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3(1.f)));
+    TF_EXPECT_OK(writer.Add("strings", strings));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int shard = 0; shard < 3; ++shard) {
+    TF_EXPECT_OK(Env::Default()->FileExists(
+        DataFilename(Prefix("parallel"), shard, 3)));
+  }
+  // Fewer tensors than shards only writes one data file per tensor.
+  {
+    BundleWriter writer(Env::Default(), Prefix("parallel_small"), opts);
+    TF_EXPECT_OK(writer.Add("bar", Constant_2x3(4.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      DataFilename(Prefix("parallel_small"), 0, 1)));
+
+  TF_ASSERT_OK(MergeBundles(Env::Default(),
+                            {Prefix("parallel"), Prefix("parallel_small")},
+                            Prefix("parallel_merged")));
+  for (const string& prefix : {Prefix("parallel"), Prefix("parallel_merged")}) {
+    BundleReader reader(Env::Default(), prefix);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo_000", Constant(0.f, TensorShape({100})));
+    Expect<float>(&reader, "foo_001", Constant_2x3(1.f));
+    Expect<float>(&reader, "foo_002", Constant_2x3(2.f));
+    Expect<float>(&reader, "foo_003", Constant_2x3(3.f));
+    Expect<tstring>(&reader, "strings", strings);
+  }
+  BundleReader reader(Env::Default(), Prefix("parallel_merged"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "bar", Constant_2x3(4.f));
+}
+
+TEST(TensorBundleTest, LookupShared) {
+  for (const string& model : {"base", "fine_tune"}) {
+    BundleWriter writer(Env::Default(), Prefix(model));
+    TF_EXPECT_OK(writer.Add("embedding", Constant_2x3(1.f)));
+    TF_EXPECT_OK(
+        writer.Add("head", Constant_2x3(model == "base" ? 2.f : 3.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader base(Env::Default(), Prefix("base"));
+  TF_ASSERT_OK(base.status());
+  BundleReader fine_tune(Env::Default(), Prefix("fine_tune"));
+  TF_ASSERT_OK(fine_tune.status());
+
+  Tensor base_embedding, base_head, fine_tune_embedding, fine_tune_head;
+  TF_ASSERT_OK(base.LookupShared("embedding", &base_embedding));
+  TF_ASSERT_OK(base.LookupShared("head", &base_head));
+  TF_ASSERT_OK(fine_tune.LookupShared("embedding", &fine_tune_embedding));
+  TF_ASSERT_OK(fine_tune.LookupShared("head", &fine_tune_head));
+  test::ExpectTensorEqual<float>(Constant_2x3(1.f), fine_tune_embedding);
+  test::ExpectTensorEqual<float>(Constant_2x3(2.f), base_head);
+  test::ExpectTensorEqual<float>(Constant_2x3(3.f), fine_tune_head);
+  EXPECT_EQ(base_embedding.tensor_data().data(),
+            fine_tune_embedding.tensor_data().data());
+  EXPECT_NE(base_head.tensor_data().data(),
+            fine_tune_head.tensor_data().data());
+}
+
 TEST(TensorBundleTest, Endianness) {
   TestEndianness<float>();
   TestEndianness<double>();
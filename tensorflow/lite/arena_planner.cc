@@ -31,14 +31,18 @@ constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_inputs, bool preserve_intermediates,
-                           int tensor_alignment)
+                           int tensor_alignment,
+                           ArenaPlanningStrategy strategy,
+                           std::vector<int32_t> offline_offsets)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_inputs_(preserve_inputs),
       preserve_intermediates_(preserve_intermediates),
-      tensor_alignment_(tensor_alignment) {}
+      tensor_alignment_(tensor_alignment),
+      strategy_(strategy),
+      offline_offsets_(std::move(offline_offsets)) {}
 
 ArenaPlanner::~ArenaPlanner() {}
 
@@ -297,9 +301,97 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
   // Indices of tensors in order their allocation offsets will be calculated.
   std::sort(tensor_order.begin(), tensor_order.end(), tensor_compare);
 
+  if (strategy_ == ArenaPlanningStrategy::kGreedyByBreadth) {
+    auto lives_through_inference = [this](int32_t tensor_index) {
+      return alloc_node_[tensor_index] == 0 &&
+             dealloc_node_[tensor_index] == kNodeNotAssigned;
+    };
+    OrderByOperatorBreadth(
+        std::partition_point(tensor_order.begin(), tensor_order.end(),
+                             lives_through_inference),
+        tensor_order.end());
+  }
+
+  // Offline planned tensors go first, so no tensor planned at runtime takes
+  // their place.
+  std::stable_partition(
+      tensor_order.begin(), tensor_order.end(),
+      [this](int32_t tensor_index) { return HasOfflineOffset(tensor_index); });
+
   return tensor_order;
 }
 
+void ArenaPlanner::OrderByOperatorBreadth(
+    std::vector<int32_t>::iterator begin,
+    std::vector<int32_t>::iterator end) const {
+  const int num_nodes = graph_info_->num_nodes();
+  if (num_nodes == 0 || begin == end) return;
+
+  // Computes the breadth of every node from the difference between the bytes
+  // allocated and deallocated around it.
+  auto first_use = [this](int32_t tensor_index) {
+    return std::min(FirstConcurrentNode(alloc_node_[tensor_index]),
+                    static_cast<int32_t>(graph_info_->num_nodes() - 1));
+  };
+  auto last_use = [this](int32_t tensor_index) {
+    return std::min(LastConcurrentNode(dealloc_node_[tensor_index]),
+                    static_cast<int32_t>(graph_info_->num_nodes() - 1));
+  };
+  std::vector<int64_t> breadth(num_nodes + 1, 0);
+  for (auto it = begin; it != end; ++it) {
+    const int64_t bytes = graph_info_->tensor(*it)->bytes;
+    breadth[first_use(*it)] += bytes;
+    breadth[last_use(*it) + 1] -= bytes;
+  }
+  for (int i = 1; i < num_nodes; ++i) {
+    breadth[i] += breadth[i - 1];
+  }
+  std::vector<int32_t> node_order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    node_order[i] = i;
+  }
+  std::stable_sort(node_order.begin(), node_order.end(),
+                   [&breadth](int32_t node1, int32_t node2) {
+                     return breadth[node1] > breadth[node2];
+                   });
+
+  // The tensors each node uses keep their order, by non-increasing size.
+  std::vector<int32_t> tensors(begin, end);
+  std::vector<bool> ordered(tensors.size(), false);
+  auto out = begin;
+  for (int32_t node : node_order) {
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      if (!ordered[i] && first_use(tensors[i]) <= node &&
+          node <= last_use(tensors[i])) {
+        ordered[i] = true;
+        *out++ = tensors[i];
+      }
+    }
+  }
+}
+
+bool ArenaPlanner::HasOfflineOffset(int tensor_index) const {
+  return tensor_index < static_cast<int>(offline_offsets_.size()) &&
+         offline_offsets_[tensor_index] >= 0 &&
+         graph_info_->tensor(tensor_index)->allocation_type == kTfLiteArenaRw;
+}
+
+int32_t ArenaPlanner::FirstConcurrentNode(int32_t node) const {
+  if (node == kNodeNotAssigned ||
+      static_cast<size_t>(node) >= graph_info_->num_nodes()) {
+    return node;
+  }
+  return graph_info_->concurrent_nodes(node).first;
+}
+
+int32_t ArenaPlanner::LastConcurrentNode(int32_t node) const {
+  if (node == kNodeNotAssigned ||
+      static_cast<size_t>(node) >= graph_info_->num_nodes()) {
+    return node;
+  }
+  return graph_info_->concurrent_nodes(node).second;
+}
+
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Indices of tensors in order their allocation offsets will be calculated.
   const std::vector<int32_t> tensor_order =
@@ -318,10 +410,20 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      // The tensor must stay alive for as long as any node that may run at the
+      // same time as its first or last user.
+      const int32_t first_use = FirstConcurrentNode(alloc_node_[tensor_index]);
+      const int32_t last_use = LastConcurrentNode(dealloc_node_[tensor_index]);
+      if (HasOfflineOffset(tensor_index)) {
+        TF_LITE_ENSURE_STATUS(arena_.AllocateAt(
+            context_, tensor_alignment_, offline_offsets_[tensor_index],
+            tensor.bytes, tensor_index, first_use, last_use,
+            &allocs_[tensor_index]));
+      } else {
+        TF_LITE_ENSURE_STATUS(arena_.Allocate(
+            context_, tensor_alignment_, tensor.bytes, tensor_index, first_use,
+            last_use, &allocs_[tensor_index]));
+      }
     }
     if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
       TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
@@ -30,6 +30,19 @@ namespace tflite {
 constexpr const int kDefaultArenaAlignment = 64;
 struct AllocationInfo;
 
+// The order in which ArenaPlanner assigns offsets to tensors. Each tensor is
+// put into the smallest gap of the arena that fits it, so the order decides
+// how much memory is wasted between tensors.
+enum class ArenaPlanningStrategy {
+  // Tensors are placed in non-increasing order of their size.
+  kGreedyBySize,
+  // Operators are visited in non-increasing order of their breadth, the total
+  // size of the tensors alive while they execute. The tensors used by each
+  // operator are then placed in non-increasing order of their size. This
+  // usually does better than kGreedyBySize for models with a few wide layers.
+  kGreedyByBreadth,
+};
+
 // A memory planner that makes all the allocations using arenas.
 //
 // Before a model is executed by the interpreter, this class determines when
@@ -49,9 +62,18 @@ class ArenaPlanner : public MemoryPlanner {
   // ArenaPlanner is destroyed. If 'preserve_inputs' is true the inputs to the
   // graph will not share memory with any other tensor, effectively preserving
   // them until the end of inference.
+  //
+  // If not empty, 'offline_offsets' holds an offset in the arena for each
+  // tensor, as computed ahead of time, or -1 for tensors that are planned at
+  // runtime. Offline offsets are only used for kTfLiteArenaRw tensors, and
+  // are ignored if they would make the tensor overlap another one, e.g.
+  // because the tensor was resized.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_inputs, bool preserve_intermediates,
-               int tensor_alignment);
+               int tensor_alignment,
+               ArenaPlanningStrategy strategy =
+                   ArenaPlanningStrategy::kGreedyBySize,
+               std::vector<int32_t> offline_offsets = {});
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -79,13 +101,30 @@ class ArenaPlanner : public MemoryPlanner {
   // - Other tensors (e.g. intermediate and temporary ones) are sorted in
   // non-increasing order of their size. If sizes of two tensors are equal, the
   // one that needs to be allocated earlier goes first.
+  //
+  // With kGreedyByBreadth, the tensors that don't live through the whole
+  // inference are then reordered by OrderByOperatorBreadth(). In all cases,
+  // tensors with an offline offset go first.
   std::vector<int32_t> CreateTensorAllocationVector(int first_node,
                                                     int last_node);
 
+  // Reorders the tensors in [begin, end), which must be sorted by size, by
+  // the breadth of the operators using them. See kGreedyByBreadth.
+  void OrderByOperatorBreadth(std::vector<int32_t>::iterator begin,
+                              std::vector<int32_t>::iterator end) const;
+
+  // Returns true if the tensor must be placed at its offline planned offset.
+  bool HasOfflineOffset(int tensor_index) const;
+
   // Traverse the allocation queue and reserve space in the appropriate arena
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Return the first (last) node that may be executing at the same time as
+  // `node`, according to GraphInfo::concurrent_nodes().
+  int32_t FirstConcurrentNode(int32_t node) const;
+  int32_t LastConcurrentNode(int32_t node) const;
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -131,6 +170,13 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Order in which tensors are placed in `arena_`.
+  ArenaPlanningStrategy strategy_;
+
+  // Offsets in `arena_` computed ahead of time, indexed by tensor, or -1 for
+  // the tensors planned at runtime. Empty if there is no offline plan.
+  std::vector<int32_t> offline_offsets_;
 };
 
 }  // namespace tflite
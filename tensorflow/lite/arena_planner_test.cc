@@ -16,6 +16,9 @@ limitations under the License.
 
 #include <cstdarg>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -105,10 +108,20 @@ class TestGraph {
   const std::vector<int>& outputs() { return outputs_; }
   const std::vector<int>& variables() { return variables_; }
 
+  const std::vector<std::pair<size_t, size_t>>& concurrent_nodes() {
+    return concurrent_nodes_;
+  }
+
   void SetVariables(const std::vector<int>& variables) {
     variables_ = variables;
   }
 
+  // Sets the nodes that may be executing at the same time as each node.
+  void SetConcurrentNodes(
+      const std::vector<std::pair<size_t, size_t>>& concurrent_nodes) {
+    concurrent_nodes_ = concurrent_nodes;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -123,6 +136,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<std::pair<size_t, size_t>> concurrent_nodes_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -144,6 +158,12 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) const override {
+    if (graph_->concurrent_nodes().empty()) {
+      return GraphInfo::concurrent_nodes(index);
+    }
+    return graph_->concurrent_nodes()[index];
+  }
 
  private:
   TestGraph* graph_;
@@ -163,12 +183,16 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_inputs = false) {
+  void SetGraph(TestGraph* graph, bool preserve_inputs = false,
+                ArenaPlanningStrategy strategy =
+                    ArenaPlanningStrategy::kGreedyBySize,
+                std::vector<int32_t> offline_offsets = {}) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment));
+        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment,
+        strategy, std::move(offline_offsets)));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -710,6 +734,111 @@ TEST_F(ArenaPlannerTest, GraphWithIntermediates) {
   EXPECT_EQ(GetOffset(2), GetOffsetAfter(5));
 }
 
+TEST_F(ArenaPlannerTest, ConcurrentNodesDontShareMemory) {
+  // The first two ops are independent, and their temporaries can share memory
+  // only if the ops are executed one after the other.
+  auto make_graph = [] {
+    return new TestGraph({0},
+                         {
+                             /* in, out, tmp */
+                             {{0}, {1}, {2}},
+                             {{0}, {3}, {4}},
+                             {{1, 3}, {5}, {}},
+                         },
+                         {5});
+  };
+  std::unique_ptr<TestGraph> sequential(make_graph());
+  SetGraph(sequential.get());
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(2), GetOffset(4));
+
+  std::unique_ptr<TestGraph> concurrent(make_graph());
+  concurrent->SetConcurrentNodes({{0, 1}, {0, 1}, {2, 2}});
+  SetGraph(concurrent.get());
+  Execute(0, 10);
+  for (int a : {1, 2, 3, 4}) {
+    for (int b : {1, 2, 3, 4}) {
+      if (a == b) continue;
+      EXPECT_TRUE(GetOffsetAfter(a) <= GetOffset(b) ||
+                  GetOffsetAfter(b) <= GetOffset(a))
+          << "tensors " << a << " and " << b << " overlap";
+    }
+  }
+}
+
+// A chain of nodes, where placing the largest tensors first wastes memory.
+std::unique_ptr<TestGraph> MakeChainGraph() {
+  std::unique_ptr<TestGraph> graph(new TestGraph({0},
+                                                 {
+                                                     /* in, out, tmp */
+                                                     {{0}, {1}, {}},
+                                                     {{1}, {2}, {}},
+                                                     {{2}, {3}, {}},
+                                                     {{3}, {4}, {}},
+                                                     {{4}, {5}, {}},
+                                                 },
+                                                 {5}));
+  const std::vector<size_t> bytes = {24, 32, 32, 8, 32, 4};
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    (*graph->tensors())[i].bytes = bytes[i];
+  }
+  return graph;
+}
+
+TEST_F(ArenaPlannerTest, GreedyBySize) {
+  std::unique_ptr<TestGraph> graph = MakeChainGraph();
+  SetGraph(graph.get());
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(5), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffsetAfter(3), 72);
+}
+
+TEST_F(ArenaPlannerTest, GreedyByBreadth) {
+  std::unique_ptr<TestGraph> graph = MakeChainGraph();
+  SetGraph(graph.get(), /*preserve_inputs=*/false,
+           ArenaPlanningStrategy::kGreedyByBreadth);
+  Execute(0, 10);
+
+  // Node 1 is the widest, then node 0, and so on.
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffsetAfter(2), 64);
+}
+
+TEST_F(ArenaPlannerTest, OfflineOffsets) {
+  std::unique_ptr<TestGraph> graph = MakeChainGraph();
+  SetGraph(graph.get(), /*preserve_inputs=*/false,
+           ArenaPlanningStrategy::kGreedyBySize, {-1, -1, -1, 100, -1, -1});
+  Execute(0, 10);
+
+  // The other tensors are planned around tensor 3.
+  EXPECT_EQ(GetOffset(3), 100);
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(4), 0);
+}
+
+TEST_F(ArenaPlannerTest, OverlappingOfflineOffsetsArePlannedAtRuntime) {
+  std::unique_ptr<TestGraph> graph = MakeChainGraph();
+  // Tensors 1 and 2 are used by node 1 at the same time.
+  SetGraph(graph.get(), /*preserve_inputs=*/false,
+           ArenaPlanningStrategy::kGreedyBySize, {-1, 0, 0, -1, -1, -1});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+}
+
 }  // namespace
 }  // namespace tflite
 
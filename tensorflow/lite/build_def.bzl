@@ -659,16 +659,26 @@ def gen_zipped_test_file(name, file, toco, flags):
         srcs = [file],
     )
 
-def gen_selected_ops(name, model, namespace = "", **kwargs):
+def gen_selected_ops(name, model, namespace = "", op_types = False, **kwargs):
     """Generate the library that includes only used ops.
 
     Args:
       name: Name of the generated library.
       model: TFLite models to interpret, expect a list in case of multiple models.
       namespace: Namespace in which to put RegisterSelectedOps.
+      op_types: Whether to also generate tflite_ops_to_register.h, listing the
+        tensor types used by each builtin op. Builtin kernels compiled with
+        TFLITE_SELECTIVE_REGISTRATION defined and this header on the include
+        path drop the type specializations the models do not use.
       **kwargs: Additional kwargs to pass to genrule.
     """
     out = name + "_registration.cc"
+    outs = [out]
+    op_types_args = ""
+    if op_types:
+        op_types_out = "tflite_ops_to_register.h"
+        outs.append(op_types_out)
+        op_types_args = " --output_op_types=$(location %s)" % op_types_out
     tool = clean_dep("//tensorflow/lite/tools:generate_op_registrations")
     tflite_path = "//tensorflow/lite"
 
@@ -683,9 +693,9 @@ def gen_selected_ops(name, model, namespace = "", **kwargs):
     native.genrule(
         name = name,
         srcs = model,
-        outs = [out],
-        cmd = ("$(location %s) --namespace=%s --output_registration=$(location %s) --tflite_path=%s %s") %
-              (tool, namespace, out, tflite_path[2:], input_models_args),
+        outs = outs,
+        cmd = ("$(location %s) --namespace=%s --output_registration=$(location %s) --tflite_path=%s %s%s") %
+              (tool, namespace, out, tflite_path[2:], input_models_args, op_types_args),
         tools = [tool],
         **kwargs
     )
@@ -17,8 +17,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/lite/arena_planner.h"
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
@@ -186,6 +190,9 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) const override {
+    return subgraph_->GetConcurrentExecutionPlanIndices(index);
+  }
 
  public:
   Subgraph* subgraph_;
@@ -448,6 +455,17 @@ void Subgraph::SetExternalContext(struct TfLiteContext* context,
   return static_cast<Subgraph*>(context->impl_)->SetExternalContext(type, ctx);
 }
 
+TfLiteExternalContext* Subgraph::GetInterOpWorkerExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    for (auto& worker : subgraph->inter_op_workers_) {
+      if (&worker->context == context) return &worker->cpu_backend_context;
+    }
+  }
+  return subgraph->GetExternalContext(type);
+}
+
 // Gets an TfLiteIntArray* representing the execution plan. The interpreter owns
 // this memory and it is only guaranteed to exist during the invocation of the
 // delegate prepare.
@@ -548,6 +566,207 @@ void Subgraph::SetCancellationFunction(void* data,
   check_cancelled_func_ = check_cancelled_func;
 }
 
+TfLiteStatus Subgraph::SetInterOpThreadPool(InterOpThreadPool* thread_pool) {
+  if (thread_pool == inter_op_thread_pool_) {
+    return kTfLiteOk;
+  }
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetInterOpThreadPool is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  inter_op_thread_pool_ = thread_pool;
+  inter_op_workers_.clear();
+  if (thread_pool) {
+    for (int i = 1; i < thread_pool->num_threads(); ++i) {
+      inter_op_workers_.emplace_back(new InterOpWorker);
+    }
+  }
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetMemoryPlanningStrategy(
+    ArenaPlanningStrategy strategy) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetMemoryPlanningStrategy is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  memory_planning_strategy_ = strategy;
+  // The planner is created again with the new strategy by the next
+  // AllocateTensors().
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetOfflineMemoryPlan(std::vector<int32_t> offsets) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetOfflineMemoryPlan is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  offline_memory_plan_ = std::move(offsets);
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+std::pair<int, int> Subgraph::GetConcurrentExecutionPlanIndices(
+    int execution_plan_index) const {
+  // The stages are stale if the execution plan changed since they were
+  // planned, until the next AllocateTensors().
+  if (execution_plan_stages_.size() != execution_plan_.size()) {
+    return {execution_plan_index, execution_plan_index};
+  }
+  return execution_stages_[execution_plan_stages_[execution_plan_index]];
+}
+
+TfLiteStatus Subgraph::PlanExecutionStages() {
+  execution_stages_.clear();
+  execution_plan_stages_.clear();
+  if (!inter_op_thread_pool_ || inter_op_thread_pool_->num_threads() <= 1) {
+    return kTfLiteOk;
+  }
+
+  // A node is in the stage after the ones of the nodes producing its inputs.
+  // Nodes whose execution could interfere with other nodes are alone in their
+  // stage, in execution plan order with respect to all other nodes.
+  std::vector<int> tensor_stages(tensors_.size(), -1);
+  std::vector<int> node_stages(execution_plan_.size());
+  int first_stage = 0;
+  int last_stage = -1;
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[i]];
+    const TfLiteNode& node = node_and_registration.first;
+    const TfLiteRegistration& registration = node_and_registration.second;
+    bool alone = node.delegate != nullptr ||
+                 registration.builtin_code == kTfLiteBuiltinCustom ||
+                 registration.builtin_code == kTfLiteBuiltinIf ||
+                 registration.builtin_code == kTfLiteBuiltinWhile;
+    int stage = first_stage;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      alone |= tensors_[tensor_index].is_variable;
+      stage = std::max(stage, tensor_stages[tensor_index] + 1);
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      alone |= tensors_[tensor_index].is_variable;
+    }
+    if (alone) {
+      stage = last_stage + 1;
+      first_stage = stage + 1;
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      tensor_stages[tensor_index] = stage;
+    }
+    node_stages[i] = stage;
+    last_stage = std::max(last_stage, stage);
+  }
+
+  // Every node comes after the nodes producing its inputs, in a stage of its
+  // own, so sorting the plan by stage keeps it in dependency order.
+  std::vector<int> order(execution_plan_.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&node_stages](int a, int b) {
+    return node_stages[a] < node_stages[b];
+  });
+  std::vector<int> sorted_plan;
+  sorted_plan.reserve(order.size());
+  for (int i : order) {
+    sorted_plan.push_back(execution_plan_[i]);
+    execution_plan_stages_.push_back(node_stages[i]);
+  }
+  execution_stages_.assign(last_stage + 1, {0, -1});
+  for (int i = 0; i < execution_plan_stages_.size(); ++i) {
+    auto& stage = execution_stages_[execution_plan_stages_[i]];
+    if (stage.second < stage.first) stage.first = i;
+    stage.second = i;
+  }
+
+  if (sorted_plan != execution_plan_) {
+    execution_plan_ = std::move(sorted_plan);
+    // The allocations were planned in the previous order.
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanInvokeExecutionStagesConcurrently() const {
+  return !execution_stages_.empty() &&
+         execution_plan_stages_.size() == execution_plan_.size() &&
+         execution_stages_.size() < execution_plan_.size() &&
+         next_execution_plan_index_to_prepare_ == execution_plan_.size() &&
+         !has_dynamic_tensors_ && !profiler_;
+}
+
+TfLiteStatus Subgraph::InvokeExecutionStages() {
+  std::vector<TfLiteStatus> statuses;
+  for (const auto& stage : execution_stages_) {
+    for (int i = stage.first; i <= stage.second; ++i) {
+      const TfLiteNode& node =
+          nodes_and_registration_[execution_plan_[i]].first;
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        TfLiteTensor* tensor = &tensors_[tensor_index];
+        if (tensor->delegate && tensor->delegate != node.delegate &&
+            tensor->data_is_stale) {
+          TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+        }
+      }
+    }
+
+    if (IsCancelled()) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    EnsureTensorsVectorCapacity();
+    const int num_nodes = stage.second - stage.first + 1;
+    if (num_nodes == 1) {
+      const int node_index = execution_plan_[stage.first];
+      TfLiteNode& node = nodes_and_registration_[node_index].first;
+      const TfLiteRegistration& registration =
+          nodes_and_registration_[node_index].second;
+      if (OpInvoke(registration, &node) != kTfLiteOk) {
+        return ReportOpError(&context_, node, registration, node_index,
+                             "failed to invoke");
+      }
+      continue;
+    }
+
+    for (auto& worker : inter_op_workers_) {
+      worker->context = context_;
+      worker->context.GetExternalContext = GetInterOpWorkerExternalContext;
+      // Inter-op parallelism takes the place of intra-op parallelism on the
+      // workers.
+      worker->context.recommended_num_threads = 1;
+    }
+    statuses.assign(num_nodes, kTfLiteOk);
+    inter_op_thread_pool_->Run(num_nodes, [&](int thread_index, int task) {
+      const int node_index = execution_plan_[stage.first + task];
+      TfLiteContext* context =
+          thread_index == 0 ? &context_
+                            : &inter_op_workers_[thread_index - 1]->context;
+      statuses[task] =
+          OpInvoke(context, nodes_and_registration_[node_index].second,
+                   &nodes_and_registration_[node_index].first);
+    });
+    for (int task = 0; task < num_nodes; ++task) {
+      if (statuses[task] != kTfLiteOk) {
+        const int node_index = execution_plan_[stage.first + task];
+        return ReportOpError(&context_,
+                             nodes_and_registration_[node_index].first,
+                             nodes_and_registration_[node_index].second,
+                             node_index, "failed to invoke");
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 bool Subgraph::IsCancelled() {
   return (check_cancelled_func_ != nullptr) &&
          (*check_cancelled_func_)(cancellation_data_);
@@ -654,6 +873,7 @@ TfLiteStatus Subgraph::AllocateTensors() {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
+  TF_LITE_ENSURE_STATUS(PlanExecutionStages());
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
   state_ = kStateInvokable;
@@ -881,7 +1101,8 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
     memory_planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
         /*preserve_inputs=*/true, /*preserve_intermediates*/ false,
-        kDefaultTensorAlignment));
+        kDefaultTensorAlignment, memory_planning_strategy_,
+        offline_memory_plan_));
     memory_planner_->PlanAllocations();
   }
 
@@ -960,6 +1181,10 @@ TfLiteStatus Subgraph::Invoke() {
     applied_nnapi_delegate_ = true;
   }
 
+  if (CanInvokeExecutionStagesConcurrently()) {
+    return InvokeExecutionStages();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1516,6 +1741,60 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::BindExternalTensorData(
+    const std::vector<std::pair<int, TfLiteCustomAllocation>>& buffers) {
+  TF_LITE_ENSURE(context(), bound_tensors_data_.empty());
+  if (state_ == kStateUninvokable) {
+    ReportError("AllocateTensors() must be called before binding buffers.");
+    return kTfLiteError;
+  }
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.allocation_type == kTfLiteDynamic) {
+      ReportError("Buffers can't be bound in a graph with dynamic tensors.");
+      return kTfLiteError;
+    }
+  }
+
+  for (const auto& index_and_buffer : buffers) {
+    const int tensor_index = index_and_buffer.first;
+    const bool is_input_or_output =
+        std::find(inputs_.begin(), inputs_.end(), tensor_index) !=
+            inputs_.end() ||
+        std::find(outputs_.begin(), outputs_.end(), tensor_index) !=
+            outputs_.end();
+    if (!is_input_or_output) {
+      ReportError("Tensor %d is not an input or output.", tensor_index);
+      UnbindExternalTensorData();
+      return kTfLiteError;
+    }
+    TfLiteTensor* tensor = &context_.tensors[tensor_index];
+    // Delegates with buffer handles don't read or write the tensor data.
+    if ((tensor->allocation_type != kTfLiteArenaRw &&
+         tensor->allocation_type != kTfLiteArenaRwPersistent &&
+         tensor->allocation_type != kTfLiteCustom) ||
+        tensor->buffer_handle != kTfLiteNullBufferHandle ||
+        ValidateCustomAllocationForTensor(context(), tensor,
+                                          index_and_buffer.second) !=
+            kTfLiteOk) {
+      ReportError("Can't bind the buffer of tensor %d.", tensor_index);
+      UnbindExternalTensorData();
+      return kTfLiteError;
+    }
+    bound_tensors_data_.emplace_back(tensor_index, tensor->data.data);
+    tensor->data.data = index_and_buffer.second.data;
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::UnbindExternalTensorData() {
+  // Restore in reverse order, in case a tensor was bound more than once.
+  for (auto it = bound_tensors_data_.rbegin(); it != bound_tensors_data_.rend();
+       ++it) {
+    context_.tensors[it->first].data.data = it->second;
+  }
+  bound_tensors_data_.clear();
+}
+
 }  // namespace impl
 
 }  // namespace tflite
@@ -18,15 +18,19 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -276,6 +280,38 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Sets the thread pool used to execute independent nodes at the same time,
+  // or nullptr to execute the nodes one at a time. The pool is not owned, and
+  // must outlive this subgraph or be unset.
+  // When a pool is set, AllocateTensors() reorders the execution plan so that
+  // the nodes that can execute at the same time are adjacent, and plans their
+  // tensors not to share memory. Like ResizeInputTensor(), this requires
+  // AllocateTensors() to be called again before Invoke().
+  // Invoke() only executes nodes at the same time when the graph has no
+  // dynamic tensors and no profiler is set. Nodes of delegates, control flow
+  // and custom ops, and nodes using variable tensors, are always executed on
+  // their own.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetInterOpThreadPool(InterOpThreadPool* thread_pool);
+
+  // Sets the order in which the memory planner places tensors in the arena.
+  // Like ResizeInputTensor(), this requires AllocateTensors() to be called
+  // again before Invoke().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetMemoryPlanningStrategy(ArenaPlanningStrategy strategy);
+
+  // Sets the offsets of tensors in the arena computed ahead of time, indexed
+  // by tensor, with -1 for the tensors to be planned at runtime. Like
+  // ResizeInputTensor(), this requires AllocateTensors() to be called again
+  // before Invoke().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetOfflineMemoryPlan(std::vector<int32_t> offsets);
+
+  // Returns the first and last execution plan indices of the nodes that may be
+  // executing at the same time as the node at `execution_plan_index`.
+  std::pair<int, int> GetConcurrentExecutionPlanIndices(
+      int execution_plan_index) const;
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -355,6 +391,22 @@ class Subgraph {
   TfLiteStatus SetCustomAllocationForTensor(
       int tensor_index, const TfLiteCustomAllocation& allocation);
 
+  // Points input and output tensors to caller-owned buffers, until
+  // UnbindExternalTensorData is called, without copying their data. The
+  // buffers should satisfy conditions 2-4 of SetCustomAllocationForTensor.
+  // The memory planned for the tensors is left untouched, and is used again
+  // once the buffers are unbound. Fails if tensors are not allocated, or if
+  // the subgraph has dynamic tensors, whose reallocation during Invoke would
+  // overwrite the bound data pointers.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus BindExternalTensorData(
+      const std::vector<std::pair<int, TfLiteCustomAllocation>>& buffers);
+
+  // Points the tensors bound by BindExternalTensorData to their own memory
+  // again.
+  void UnbindExternalTensorData();
+
  private:
   // SubgraphAwareProfiler wraps an actual TFLite profiler, such as a
   // BufferedProfiler instance, and takes care of event profiling/tracing in a
@@ -427,10 +479,30 @@ class Subgraph {
 
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node) {
+    return OpInvoke(&context_, op_reg, node);
+  }
+
+  // Invoke the operator represented by 'node' with the given 'context', which
+  // is either 'context_' or the context of an inter-op worker.
+  static TfLiteStatus OpInvoke(TfLiteContext* context,
+                               const TfLiteRegistration& op_reg,
+                               TfLiteNode* node) {
     if (op_reg.invoke == nullptr) return kTfLiteError;
-    return op_reg.invoke(&context_, node);
+    return op_reg.invoke(context, node);
   }
 
+  // Groups the execution plan into stages of nodes that can execute at the
+  // same time, and sorts the plan by stage. Clears the stages if no
+  // inter-op thread pool is set.
+  TfLiteStatus PlanExecutionStages();
+
+  // Whether Invoke() can execute the nodes of a stage at the same time.
+  bool CanInvokeExecutionStagesConcurrently() const;
+
+  // Invokes the whole execution plan stage by stage, running the nodes of a
+  // stage on `inter_op_thread_pool_`.
+  TfLiteStatus InvokeExecutionStages();
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -545,6 +617,11 @@ class Subgraph {
   static TfLiteExternalContext* GetExternalContext(
       struct TfLiteContext* context, TfLiteExternalContextType type);
 
+  // The GetExternalContext of the context of an inter-op worker, returning the
+  // worker's own CPU backend context.
+  static TfLiteExternalContext* GetInterOpWorkerExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+
   // Set the value of an external context.
   static void SetExternalContext(struct TfLiteContext* context,
                                  TfLiteExternalContextType type,
@@ -709,6 +786,10 @@ class Subgraph {
   // Contains <tensor idx, custom allocation> pairs for all applicable tensors.
   std::vector<std::pair<int, TfLiteCustomAllocation>> custom_allocations_;
 
+  // Contains <tensor idx, own data> pairs for the tensors bound to external
+  // buffers by BindExternalTensorData, in binding order.
+  std::vector<std::pair<int, void*>> bound_tensors_data_;
+
   // Tracking bit for whether a tensor was resized in the course of an op
   // invocation. This is a useful hint to ensure that dynamic tensor outputs
   // trigger downstream reallocation after op invocation.
@@ -737,6 +818,31 @@ class Subgraph {
 
   // A map of resources. Owned by interpreter and shared by multiple subgraphs.
   resource::ResourceMap* resources_ = nullptr;
+
+  // The state of a thread of `inter_op_thread_pool_` other than the one
+  // calling Invoke().
+  struct InterOpWorker {
+    // A copy of `context_`, refreshed at every stage, which gives the worker
+    // its own CPU backend context: those aren't safe to use from several
+    // threads at the same time.
+    TfLiteContext context;
+    ExternalCpuBackendContext cpu_backend_context;
+  };
+
+  // Not owned. Null unless independent nodes are executed at the same time.
+  InterOpThreadPool* inter_op_thread_pool_ = nullptr;
+  std::vector<std::unique_ptr<InterOpWorker>> inter_op_workers_;
+
+  // The first and last execution plan indices of every stage of nodes
+  // that can execute at the same time, and the stage of every execution plan
+  // index. Empty unless `inter_op_thread_pool_` is set.
+  std::vector<std::pair<int, int>> execution_stages_;
+  std::vector<int> execution_plan_stages_;
+
+  // Passed to the ArenaPlanner when it is created.
+  ArenaPlanningStrategy memory_planning_strategy_ =
+      ArenaPlanningStrategy::kGreedyBySize;
+  std::vector<int32_t> offline_memory_plan_;
 };
 
 }  // namespace impl
@@ -21,8 +21,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstring>
+#include <deque>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_errors.h"
@@ -570,6 +572,214 @@ TensorObjectDef TensorToDef(const Tensor& tensor) {
   return def;
 }
 
+class AsyncInferenceRunnerImpl : public AsyncInferenceRunner {
+ public:
+  AsyncInferenceRunnerImpl(Environment* environment,
+                           std::unique_ptr<InferenceContext> context)
+      : environment_(environment), context_(std::move(context)) {}
+
+  ~AsyncInferenceRunnerImpl() override {
+    // Pending requests still use the staging buffers and the user memory.
+    WaitForAll().IgnoreError();
+  }
+
+  absl::Status Initialize(const std::vector<TensorTieDef>& inputs,
+                          const std::vector<TensorTieDef>& outputs) {
+    RETURN_IF_ERROR(CreateCLCommandQueue(
+        environment_->device(), environment_->context(), &upload_queue_));
+    RETURN_IF_ERROR(CreateCLCommandQueue(
+        environment_->device(), environment_->context(), &download_queue_));
+    auto converter_builder = NewConverterBuilder(environment_);
+    RETURN_IF_ERROR(
+        LinkTensors(inputs, /*is_input=*/true, converter_builder.get(),
+                    &inputs_));
+    return LinkTensors(outputs, /*is_input=*/false, converter_builder.get(),
+                       &outputs_);
+  }
+
+  std::vector<TensorObjectDef> inputs() const override {
+    return GetExternalDefinitions(inputs_);
+  }
+
+  std::vector<TensorObjectDef> outputs() const override {
+    return GetExternalDefinitions(outputs_);
+  }
+
+  absl::Status Enqueue(const std::vector<CpuMemory>& inputs,
+                       const std::vector<CpuMemory>& outputs,
+                       uint64_t* request_id) override {
+    RETURN_IF_ERROR(ValidateMemory(inputs_, inputs));
+    RETURN_IF_ERROR(ValidateMemory(outputs_, outputs));
+    const int slot = next_request_id_ % kNumSlots;
+    Slot& s = slots_[slot];
+    CLCommandQueue* compute_queue = environment_->queue();
+
+    // Uploads may only overwrite the staging buffers once the computation of
+    // the previous request using the slot has consumed them.
+    RETURN_IF_ERROR(upload_queue_.EnqueueBarrier({&s.inputs_consumed}));
+    for (int i = 0; i < inputs_.size(); ++i) {
+      RETURN_IF_ERROR(upload_queue_.EnqueueWriteBufferAsync(
+          inputs_[i].staging[slot].memory(), inputs_[i].size_bytes,
+          inputs[i].data));
+    }
+    CLEvent uploaded;
+    RETURN_IF_ERROR(upload_queue_.EnqueueEvent(&uploaded));
+
+    // Likewise, results may only overwrite the staging buffers once the
+    // previous request using the slot has downloaded them.
+    RETURN_IF_ERROR(
+        compute_queue->EnqueueBarrier({&uploaded, &s.outputs_downloaded}));
+    for (auto& input : inputs_) {
+      RETURN_IF_ERROR(input.converter->Convert(
+          OpenClBuffer{input.staging[slot].memory()}, input.internal_object));
+    }
+    RETURN_IF_ERROR(compute_queue->EnqueueEvent(&s.inputs_consumed));
+    RETURN_IF_ERROR(context_->AddToQueue(compute_queue));
+    for (auto& output : outputs_) {
+      RETURN_IF_ERROR(output.converter->Convert(
+          output.internal_object, OpenClBuffer{output.staging[slot].memory()}));
+    }
+    CLEvent computed;
+    RETURN_IF_ERROR(compute_queue->EnqueueEvent(&computed));
+
+    RETURN_IF_ERROR(download_queue_.EnqueueBarrier({&computed}));
+    for (int i = 0; i < outputs_.size(); ++i) {
+      RETURN_IF_ERROR(download_queue_.EnqueueReadBufferAsync(
+          outputs_[i].staging[slot].memory(), outputs_[i].size_bytes,
+          outputs[i].data));
+    }
+    RETURN_IF_ERROR(download_queue_.EnqueueEvent(&s.outputs_downloaded));
+    CLEvent done;
+    RETURN_IF_ERROR(download_queue_.EnqueueEvent(&done));
+
+    clFlush(upload_queue_.queue());
+    clFlush(compute_queue->queue());
+    clFlush(download_queue_.queue());
+    *request_id = next_request_id_++;
+    pending_requests_.emplace_back(*request_id, std::move(done));
+    return absl::OkStatus();
+  }
+
+  absl::Status Wait(uint64_t request_id) override {
+    if (request_id >= next_request_id_) {
+      return absl::InvalidArgumentError("Request was not enqueued");
+    }
+    // Downloads complete in order, so the request completes after all the
+    // requests before it.
+    while (!pending_requests_.empty() &&
+           pending_requests_.front().first <= request_id) {
+      if (pending_requests_.front().first == request_id) {
+        pending_requests_.front().second.Wait();
+      }
+      pending_requests_.pop_front();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WaitForAll() override {
+    RETURN_IF_ERROR(download_queue_.WaitForCompletion());
+    pending_requests_.clear();
+    return absl::OkStatus();
+  }
+
+ private:
+  // Number of requests whose inputs and outputs can be on the device at the
+  // same time, which is enough for a request to upload while the previous one
+  // downloads.
+  static constexpr int kNumSlots = 2;
+
+  // Input or output of the graph, with a staging buffer per slot.
+  struct IoTensor {
+    TensorObjectDef external_def;
+    TensorObject internal_object;
+    size_t size_bytes;
+    CLMemory staging[kNumSlots];
+    // Converts between the staging buffers and the internal object.
+    std::unique_ptr<TensorObjectConverter> converter;
+  };
+
+  // Events of the last request that used a slot.
+  struct Slot {
+    CLEvent inputs_consumed;
+    CLEvent outputs_downloaded;
+  };
+
+  absl::Status LinkTensors(const std::vector<TensorTieDef>& defs,
+                           bool is_input,
+                           TensorObjectConverterBuilder* converter_builder,
+                           std::vector<IoTensor>* tensors) {
+    tensors->resize(defs.size());
+    for (int i = 0; i < defs.size(); ++i) {
+      IoTensor& tensor = (*tensors)[i];
+      const TensorObjectDef& internal_def = defs[i].internal_def;
+      tensor.internal_object = TensorToObj(*context_->GetTensor(defs[i].id));
+      tensor.external_def = internal_def;
+      tensor.external_def.object_def.data_type = DataType::FLOAT32;
+      tensor.external_def.object_def.data_layout = DataLayout::BHWC;
+      tensor.external_def.object_def.object_type = ObjectType::CPU_MEMORY;
+      tensor.external_def.object_def.user_provided = true;
+      tensor.size_bytes =
+          NumElements(tensor.external_def) * SizeOf(DataType::FLOAT32);
+
+      TensorObjectDef staging_def = tensor.external_def;
+      staging_def.object_def.object_type = ObjectType::OPENCL_BUFFER;
+      if (is_input) {
+        RETURN_IF_ERROR(converter_builder->MakeConverter(
+            staging_def, internal_def, &tensor.converter));
+      } else {
+        RETURN_IF_ERROR(converter_builder->MakeConverter(
+            internal_def, staging_def, &tensor.converter));
+      }
+      const auto& dims = staging_def.dimensions;
+      const TensorDescriptor desc{DataType::FLOAT32, TensorStorageType::BUFFER,
+                                  Layout::BHWC};
+      for (int slot = 0; slot < kNumSlots; ++slot) {
+        RETURN_IF_ERROR(AllocateTensorMemory(
+            environment_->context(), BHWC(dims.b, dims.h, dims.w, dims.c),
+            desc, &tensor.staging[slot]));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  static absl::Status ValidateMemory(const std::vector<IoTensor>& tensors,
+                                     const std::vector<CpuMemory>& memory) {
+    if (memory.size() != tensors.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Expected ", tensors.size(), " objects, got ",
+                       memory.size()));
+    }
+    for (int i = 0; i < tensors.size(); ++i) {
+      if (!memory[i].data || memory[i].size_bytes < tensors[i].size_bytes) {
+        return absl::InvalidArgumentError("Given object is not valid");
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  static std::vector<TensorObjectDef> GetExternalDefinitions(
+      const std::vector<IoTensor>& tensors) {
+    std::vector<TensorObjectDef> defs;
+    defs.reserve(tensors.size());
+    for (auto& tensor : tensors) {
+      defs.push_back(tensor.external_def);
+    }
+    return defs;
+  }
+
+  Environment* environment_;
+  std::unique_ptr<InferenceContext> context_;
+  // Computations go to the environment queue, which the converters use too.
+  CLCommandQueue upload_queue_;
+  CLCommandQueue download_queue_;
+  std::vector<IoTensor> inputs_;
+  std::vector<IoTensor> outputs_;
+  Slot slots_[kNumSlots];
+  uint64_t next_request_id_ = 0;
+  // Requests that may not have completed yet, in the order of their ids.
+  std::deque<std::pair<uint64_t, CLEvent>> pending_requests_;
+};
+
 class InferenceBuilderImpl : public InferenceBuilder {
  public:
   explicit InferenceBuilderImpl(Environment* environment)
@@ -668,6 +878,17 @@ class InferenceBuilderImpl : public InferenceBuilder {
     return absl::OkStatus();
   }
 
+  // Like Build, but creates a runner that pipelines requests. Input and output
+  // object definitions set on the builder are ignored, the runner always uses
+  // CPU memory.
+  absl::Status BuildAsync(std::unique_ptr<AsyncInferenceRunner>* runner) {
+    auto runner_impl = absl::make_unique<AsyncInferenceRunnerImpl>(
+        environment_, std::move(context_));
+    RETURN_IF_ERROR(runner_impl->Initialize(inputs_, outputs_));
+    *runner = std::move(runner_impl);
+    return absl::OkStatus();
+  }
+
  private:
   TensorStorageType GetStorageType(const InferenceOptions& options) const {
     // Fallback to BUFFER that should be supported by default.
@@ -864,6 +1085,15 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     return absl::OkStatus();
   }
 
+  absl::Status NewAsyncInferenceRunner(
+      const InferenceOptions& options, GraphFloat32 model,
+      std::unique_ptr<AsyncInferenceRunner>* runner) final {
+    std::unique_ptr<InferenceBuilder> builder;
+    RETURN_IF_ERROR(NewInferenceBuilder(options, std::move(model), &builder));
+    return static_cast<InferenceBuilderImpl*>(builder.get())
+        ->BuildAsync(runner);
+  }
+
   std::vector<uint8_t> GetSerializedBinaryCache() const final {
     std::vector<uint8_t> data;
     // Is there was a problem, data would be empty.
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
@@ -69,6 +70,53 @@ struct InferenceEnvironmentProperties {
   bool is_cl_to_gl_fast_sync_supported = false;
 };
 
+// Runs inference requests asynchronously, overlapping the upload of a
+// request, the computation of the previous one and the download of the one
+// before that. Uploads, computations and downloads go to three command queues
+// synchronized with events, and inputs and outputs are double-buffered on the
+// device, so that host<->device copies don't serialize with computations. It
+// raises the throughput when requests come in a stream, e.g. video frames.
+//
+// Inputs and outputs are CPU memory in BHWC FLOAT32 layout.
+//
+// Usage example:
+//
+//   std::unique_ptr<AsyncInferenceRunner> runner;
+//   RETURN_IF_ERROR(env->NewAsyncInferenceRunner(options, model, &runner));
+//   uint64_t previous = 0;
+//   for (int i = 0; i < num_frames; ++i) {
+//     uint64_t current;
+//     RETURN_IF_ERROR(runner->Enqueue({frames[i]}, {results[i]}, &current));
+//     if (i > 0) {
+//       RETURN_IF_ERROR(runner->Wait(previous));
+//       // results[i - 1] is ready.
+//     }
+//     previous = current;
+//   }
+//   RETURN_IF_ERROR(runner->WaitForAll());
+class AsyncInferenceRunner {
+ public:
+  virtual ~AsyncInferenceRunner() {}
+
+  // Returns inference graph inputs and outputs definitions.
+  virtual std::vector<TensorObjectDef> inputs() const = 0;
+  virtual std::vector<TensorObjectDef> outputs() const = 0;
+
+  // Schedules a request and returns without waiting for it. The memory of
+  // |inputs| and |outputs| must stay valid, and must not be accessed, until
+  // the request completes. Returns an id for Wait in |request_id|.
+  virtual absl::Status Enqueue(const std::vector<CpuMemory>& inputs,
+                               const std::vector<CpuMemory>& outputs,
+                               uint64_t* request_id) = 0;
+
+  // Blocks until the given request, and all requests enqueued before it,
+  // complete.
+  virtual absl::Status Wait(uint64_t request_id) = 0;
+
+  // Blocks until all enqueued requests complete.
+  virtual absl::Status WaitForAll() = 0;
+};
+
 // Environment manages all resources that need to stay until any inference is
 // running using OpenCL backend.
 class InferenceEnvironment {
@@ -79,6 +127,11 @@ class InferenceEnvironment {
       const InferenceOptions& options, GraphFloat32 model,
       std::unique_ptr<InferenceBuilder>* builder) = 0;
 
+  // Creates a runner that pipelines requests, see AsyncInferenceRunner.
+  virtual absl::Status NewAsyncInferenceRunner(
+      const InferenceOptions& options, GraphFloat32 model,
+      std::unique_ptr<AsyncInferenceRunner>* runner) = 0;
+
   // Returns opaque binary blob that contains a collection of already compiled
   // OpenCL kernels present in a cache. Returned data could be re-used later
   // to speed up compilation time when new environment is created for the same
@@ -156,6 +156,57 @@ absl::Status CLCommandQueue::EnqueueReadBuffer(cl_mem memory,
   return absl::OkStatus();
 }
 
+absl::Status CLCommandQueue::EnqueueWriteBufferAsync(cl_mem memory,
+                                                     size_t size_in_bytes,
+                                                     const void* data) {
+  auto error_code = clEnqueueWriteBuffer(
+      queue_, memory, CL_FALSE, 0, size_in_bytes, data, 0, nullptr, nullptr);
+  if (error_code != CL_SUCCESS) {
+    return absl::UnknownError(
+        absl::StrCat("Failed to upload data to GPU (clEnqueueWriteBuffer) - ",
+                     CLErrorCodeToString(error_code)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CLCommandQueue::EnqueueReadBufferAsync(cl_mem memory,
+                                                    size_t size_in_bytes,
+                                                    void* data) {
+  auto error_code = clEnqueueReadBuffer(
+      queue_, memory, CL_FALSE, 0, size_in_bytes, data, 0, nullptr, nullptr);
+  if (error_code != CL_SUCCESS) {
+    return absl::UnknownError(
+        absl::StrCat("Failed to read data from GPU (clEnqueueReadBuffer) - ",
+                     CLErrorCodeToString(error_code)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CLCommandQueue::EnqueueBarrier(
+    const std::vector<const CLEvent*>& events) {
+  std::vector<cl_event> wait_list;
+  wait_list.reserve(events.size());
+  for (const CLEvent* event : events) {
+    if (event->is_valid()) {
+      wait_list.push_back(event->event());
+    }
+  }
+  if (wait_list.empty()) {
+    return absl::OkStatus();
+  }
+  // clEnqueueBarrierWithWaitList is only available since OpenCL 1.2.
+  const int error_code =
+      clEnqueueBarrierWithWaitList
+          ? clEnqueueBarrierWithWaitList(queue_, wait_list.size(),
+                                         wait_list.data(), nullptr)
+          : clEnqueueWaitForEvents(queue_, wait_list.size(), wait_list.data());
+  if (error_code != CL_SUCCESS) {
+    return absl::UnknownError(absl::StrCat("Failed to enqueue barrier - ",
+                                           CLErrorCodeToString(error_code)));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CLCommandQueue::WaitForCompletion() {
   auto error_code = clFinish(queue_);
   if (error_code != CL_SUCCESS) {
@@ -90,6 +90,17 @@ class CLCommandQueue {
   absl::Status EnqueueReadBuffer(cl_mem memory, size_t size_in_bytes,
                                  void* data);
 
+  // Non-blocking versions of the above. |data| must stay valid, and must not
+  // be modified for writes or read for reads, until the command completes.
+  absl::Status EnqueueWriteBufferAsync(cl_mem memory, size_t size_in_bytes,
+                                       const void* data);
+  absl::Status EnqueueReadBufferAsync(cl_mem memory, size_t size_in_bytes,
+                                      void* data);
+
+  // Commands enqueued after the barrier wait for all |events|, which may come
+  // from other queues of the same context. Invalid events are skipped.
+  absl::Status EnqueueBarrier(const std::vector<const CLEvent*>& events);
+
   absl::Status WaitForCompletion();
 
  protected:
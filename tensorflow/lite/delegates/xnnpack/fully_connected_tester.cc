@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/xnnpack/fully_connected_tester.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <numeric>
@@ -90,6 +92,17 @@ void FullyConnectedTester::Test(TfLiteDelegate* delegate) const {
       default_interpreter->inputs()[0]);
   std::generate(default_input_data, default_input_data + InputSize(),
                 std::ref(input_rng));
+  if (DynamicRangeQuantizedWeights()) {
+    // The hybrid operator quantizes every input row to INT8 with the scale
+    // max(abs(row)) / 127. Make the quantization of inputs exact, so that the
+    // outputs match the FP32 computation on the dequantized filter.
+    for (int32_t i = 0; i < InputSize(); i++) {
+      default_input_data[i] = i % InputChannels() == 0
+                                  ? 1.0f
+                                  : std::round(default_input_data[i] * 127.0f) /
+                                        127.0f;
+    }
+  }
 
   float* delegate_input_data = delegate_interpreter->typed_tensor<float>(
       delegate_interpreter->inputs()[0]);
@@ -118,6 +131,7 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
       std::uniform_real_distribution<float>(-25.0f, 25.0f), std::ref(rng));
 
   flatbuffers::FlatBufferBuilder builder;
+  float filter_scale = 1.0f;
   std::vector<flatbuffers::Offset<OperatorCode>> operator_codes{
       {CreateOperatorCode(builder, BuiltinOperator_FULLY_CONNECTED)}};
   std::vector<flatbuffers::Offset<Operator>> operators;
@@ -195,14 +209,46 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
       }
     }
 
-    buffers.emplace_back(CreateBuffer(
-        builder, builder.CreateVector(
-                     reinterpret_cast<const uint8_t*>(filter_data.data()),
-                     sizeof(float) * filter_data.size())));
+    if (INT8Weights() || DynamicRangeQuantizedWeights()) {
+      // Symmetric per-tensor quantization, as in the hybrid operator.
+      float max_abs_filter = 0.0f;
+      for (float value : filter_data) {
+        max_abs_filter = std::max(max_abs_filter, std::abs(value));
+      }
+      filter_scale = max_abs_filter / 127.0f;
+      std::vector<int8_t> quantized_filter_data(filter_data.size());
+      for (size_t i = 0; i < filter_data.size(); i++) {
+        quantized_filter_data[i] =
+            static_cast<int8_t>(std::round(filter_data[i] / filter_scale));
+      }
+      buffers.emplace_back(CreateBuffer(
+          builder, builder.CreateVector(reinterpret_cast<const uint8_t*>(
+                                            quantized_filter_data.data()),
+                                        quantized_filter_data.size())));
+    } else {
+      buffers.emplace_back(CreateBuffer(
+          builder, builder.CreateVector(
+                       reinterpret_cast<const uint8_t*>(filter_data.data()),
+                       sizeof(float) * filter_data.size())));
+    }
     buffers.emplace_back(CreateBuffer(
         builder,
         builder.CreateVector(reinterpret_cast<const uint8_t*>(bias_data.data()),
                              sizeof(float) * bias_data.size())));
+
+    if (INT8Weights()) {
+      operator_codes.emplace_back(
+          CreateOperatorCode(builder, BuiltinOperator_DEQUANTIZE));
+
+      const std::array<int32_t, 1> dequantize_filter_inputs{{0}};
+      const std::array<int32_t, 1> dequantize_filter_outputs{{2}};
+      operators.emplace_back(CreateOperator(
+          builder, /*opcode_index=*/1,
+          builder.CreateVector<int32_t>(dequantize_filter_inputs.data(),
+                                        dequantize_filter_inputs.size()),
+          builder.CreateVector<int32_t>(dequantize_filter_outputs.data(),
+                                        dequantize_filter_outputs.size())));
+    }
   }
 
   const std::array<int32_t, 2> filter_shape{
@@ -210,6 +256,15 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
   const std::array<int32_t, 1> bias_shape{{OutputChannels()}};
 
   const std::vector<int32_t> output_shape = OutputShape();
+  const std::array<float, 1> filter_scales{{filter_scale}};
+  const std::array<int64_t, 1> filter_zero_points{{0}};
+  flatbuffers::Offset<QuantizationParameters> filter_quantization =
+      CreateQuantizationParameters(
+          builder, /*min=*/0, /*max=*/0,
+          builder.CreateVector<float>(filter_scales.data(),
+                                      filter_scales.size()),
+          builder.CreateVector<int64_t>(filter_zero_points.data(),
+                                        filter_zero_points.size()));
   std::vector<flatbuffers::Offset<Tensor>> tensors;
   if (FP16Weights()) {
     tensors.emplace_back(CreateTensor(
@@ -220,15 +275,27 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
         builder,
         builder.CreateVector<int32_t>(bias_shape.data(), bias_shape.size()),
         TensorType_FLOAT16, /*buffer=*/2));
+  } else if (INT8Weights()) {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_INT8, /*buffer=*/1, /*name=*/0, filter_quantization));
   }
   tensors.emplace_back(CreateTensor(
       builder,
       builder.CreateVector<int32_t>(InputShape().data(), InputShape().size()),
       TensorType_FLOAT32));
-  tensors.emplace_back(CreateTensor(
-      builder,
-      builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
-      TensorType_FLOAT32, /*buffer=*/FP16Weights() ? 0 : 1));
+  if (DynamicRangeQuantizedWeights()) {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_INT8, /*buffer=*/1, /*name=*/0, filter_quantization));
+  } else {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        TensorType_FLOAT32, /*buffer=*/FP16Weights() || INT8Weights() ? 0 : 1));
+  }
   tensors.emplace_back(CreateTensor(
       builder,
       builder.CreateVector<int32_t>(bias_shape.data(), bias_shape.size()),
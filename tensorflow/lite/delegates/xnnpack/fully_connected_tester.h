@@ -78,6 +78,26 @@ class FullyConnectedTester {
 
   inline bool FP16Weights() const { return fp16_weights_; }
 
+  // Quantizes the filter to INT8 and dequantizes it with a Dequantize
+  // operator.
+  inline FullyConnectedTester& INT8Weights() {
+    int8_weights_ = true;
+    return *this;
+  }
+
+  inline bool INT8Weights() const { return int8_weights_; }
+
+  // Quantizes the filter to INT8, and feeds it directly to the hybrid
+  // Fully Connected operator, which quantizes the input dynamically.
+  inline FullyConnectedTester& DynamicRangeQuantizedWeights() {
+    dynamic_range_quantized_weights_ = true;
+    return *this;
+  }
+
+  inline bool DynamicRangeQuantizedWeights() const {
+    return dynamic_range_quantized_weights_;
+  }
+
   inline FullyConnectedTester& ReluActivation() {
     activation_ = ::tflite::ActivationFunctionType_RELU;
     return *this;
@@ -110,6 +130,8 @@ class FullyConnectedTester {
   int32_t output_channels_ = 1;
   bool keep_dims_ = false;
   bool fp16_weights_ = false;
+  bool int8_weights_ = false;
+  bool dynamic_range_quantized_weights_ = false;
   ::tflite::ActivationFunctionType activation_ =
       ::tflite::ActivationFunctionType_NONE;
 };
@@ -19,8 +19,11 @@ limitations under the License.
 #include <array>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -35,6 +38,61 @@ limitations under the License.
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/tools/optimize/sparsity/format_converter.h"
 
+struct TfLiteXNNPackDelegateWeightsCache {
+  // Identifies the weights computed by an operator from static data.
+  struct Key {
+    const void* data;
+    size_t bytes;
+    int builtin_code;
+    // Fingerprint of the static data, as other data may get the same address
+    // once the model owning it is destroyed.
+    uint64_t fingerprint;
+
+    bool operator==(const Key& other) const {
+      return data == other.data && bytes == other.bytes &&
+             builtin_code == other.builtin_code &&
+             fingerprint == other.fingerprint;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<const void*>()(key.data) ^
+             static_cast<size_t>(key.fingerprint);
+    }
+  };
+
+  // Returns the weights for `key`, or null if no delegate uses them anymore.
+  std::shared_ptr<const std::vector<char>> Find(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = entries.find(key);
+    return it == entries.end() ? nullptr : it->second.lock();
+  }
+
+  // Caches `weights` for `key`, unless another delegate did it first, and
+  // returns the cached weights.
+  std::shared_ptr<const std::vector<char>> Insert(
+      const Key& key, std::shared_ptr<const std::vector<char>> weights) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+      it = it->second.expired() ? entries.erase(it) : std::next(it);
+    }
+    std::weak_ptr<const std::vector<char>>& entry = entries[key];
+    std::shared_ptr<const std::vector<char>> cached = entry.lock();
+    if (cached) {
+      return cached;
+    }
+    entry = weights;
+    return weights;
+  }
+
+  std::mutex mutex;
+  // The cache doesn't keep weights alive, so they are freed with the last
+  // delegate using them.
+  std::unordered_map<Key, std::weak_ptr<const std::vector<char>>, KeyHash>
+      entries;
+};
+
 namespace tflite {
 namespace xnnpack {
 namespace {
@@ -42,6 +100,117 @@ namespace {
 // Forward declaration.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
+// FNV-1a hash of the data, 8 bytes at a time.
+uint64_t Fingerprint(const void* data, size_t bytes) {
+  constexpr uint64_t kPrime = 0x100000001b3;
+  uint64_t hash = 0xcbf29ce484222325;
+  const char* bytes_ptr = static_cast<const char*>(data);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes_ptr + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < bytes; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(bytes_ptr[i])) * kPrime;
+  }
+  return hash;
+}
+
+// Checks if the tensor holds static INT8 or UINT8 data with valid per-tensor
+// or per-channel affine quantization parameters.
+bool IsStaticQuantizedTensor(const TfLiteTensor& tensor) {
+  if (tensor.allocation_type != kTfLiteMmapRo || tensor.sparsity != nullptr ||
+      (tensor.type != kTfLiteInt8 && tensor.type != kTfLiteUInt8) ||
+      tensor.quantization.type != kTfLiteAffineQuantization) {
+    return false;
+  }
+  const auto* params = static_cast<const TfLiteAffineQuantization*>(
+      tensor.quantization.params);
+  if (params == nullptr || params->scale == nullptr ||
+      params->zero_point == nullptr ||
+      params->scale->size != params->zero_point->size) {
+    return false;
+  }
+  if (params->scale->size == 1) {
+    return true;
+  }
+  const int quantized_dimension = params->quantized_dimension;
+  return quantized_dimension >= 0 &&
+         quantized_dimension < tensor.dims->size &&
+         tensor.dims->data[quantized_dimension] == params->scale->size;
+}
+
+// Checks if the node is a dynamic-range quantized (hybrid) convolution or
+// fully connected operator, i.e. an operator with FP32 input and output, and
+// a static INT8 filter with symmetric quantization. XNNPACK computes such
+// operators in FP32 with the dequantized filter.
+bool HasDynamicRangeQuantizedFilter(const TfLiteContext* context,
+                                    const TfLiteRegistration* registration,
+                                    const TfLiteNode* node) {
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinConv2d:
+    case kTfLiteBuiltinDepthwiseConv2d:
+    case kTfLiteBuiltinFullyConnected:
+      break;
+    default:
+      return false;
+  }
+  if (node->inputs->size < 2 || node->outputs->size != 1) {
+    return false;
+  }
+  const TfLiteTensor& input_tensor = context->tensors[node->inputs->data[0]];
+  const TfLiteTensor& filter_tensor = context->tensors[node->inputs->data[1]];
+  const TfLiteTensor& output_tensor = context->tensors[node->outputs->data[0]];
+  if (input_tensor.type != kTfLiteFloat32 ||
+      output_tensor.type != kTfLiteFloat32 ||
+      filter_tensor.type != kTfLiteInt8 ||
+      !IsStaticQuantizedTensor(filter_tensor)) {
+    return false;
+  }
+  const TfLiteIntArray* zero_point =
+      static_cast<const TfLiteAffineQuantization*>(
+          filter_tensor.quantization.params)
+          ->zero_point;
+  return std::all_of(&zero_point->data[0], &zero_point->data[zero_point->size],
+                     [](int z) { return z == 0; });
+}
+
+// Dequantizes the static data of `tensor`, which must satisfy
+// IsStaticQuantizedTensor, to FP32.
+void DequantizeStaticTensor(const TfLiteTensor& tensor,
+                            float* dequantized_data) {
+  const auto* params = static_cast<const TfLiteAffineQuantization*>(
+      tensor.quantization.params);
+  const int num_channels = params->scale->size;
+  // Elements are indexed as [outer][channel][inner] with respect to the
+  // quantized dimension.
+  size_t outer_size = 1;
+  size_t inner_size = 1;
+  for (int d = 0; d < tensor.dims->size; d++) {
+    if (num_channels == 1 || d > params->quantized_dimension) {
+      inner_size *= tensor.dims->data[d];
+    } else if (d < params->quantized_dimension) {
+      outer_size *= tensor.dims->data[d];
+    }
+  }
+  size_t i = 0;
+  for (size_t o = 0; o < outer_size; o++) {
+    for (int c = 0; c < num_channels; c++) {
+      const float scale = params->scale->data[c];
+      const int32_t zero_point = params->zero_point->data[c];
+      for (size_t k = 0; k < inner_size; k++, i++) {
+        const int32_t quantized_value =
+            tensor.type == kTfLiteInt8
+                ? static_cast<int32_t>(tensor.data.int8[i])
+                : static_cast<int32_t>(tensor.data.uint8[i]);
+        dequantized_data[i] =
+            scale * static_cast<float>(quantized_value - zero_point);
+      }
+    }
+  }
+}
+
 class Delegate {
   friend class Subgraph;
 
@@ -53,6 +222,9 @@ class Delegate {
           pthreadpool_create(static_cast<size_t>(options->num_threads)));
     }
 #endif
+    if (options != nullptr) {
+      weights_cache_ = options->weights_cache;
+    }
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                          "Created TensorFlow Lite XNNPACK delegate for CPU.");
   }
@@ -60,6 +232,12 @@ class Delegate {
   TfLiteIntArray* PrepareOpsToDelegate(TfLiteContext* context);
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
 
+  // Gets the FP32 data `unpack` computes from the static data of `tensor`
+  // for an operator, from `weights_cache_` if possible.
+  std::shared_ptr<const std::vector<char>> UnpackStaticData(
+      int builtin_code, const TfLiteTensor& tensor, size_t unpacked_bytes,
+      const std::function<TfLiteStatus(float*)>& unpack);
+
   pthreadpool_t threadpool() const {
 #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
     return nullptr;
@@ -78,12 +256,14 @@ class Delegate {
       kTfLiteDelegateFlagsNone,       // .flags
   };
 
-  // Unpacked data for quasi-static tensors, i.e. tensors produced by
-  // dequantizing or unpacking static buffers.
-  std::vector<char> static_unpacked_data_;
-  // Mapping from a tensor index for a quasi-static tensor to the offset to
-  // its unpacked data within static_unpacked_data_.
-  std::unordered_map<int, size_t> static_unpacked_data_map_;
+  // Mapping from a tensor index for a quasi-static tensor, i.e. a tensor
+  // produced by dequantizing or unpacking static buffers, to its unpacked
+  // data. The data may be shared with other delegates through
+  // weights_cache_, and is read-only.
+  std::unordered_map<int, std::shared_ptr<const std::vector<char>>>
+      static_unpacked_data_;
+  // Not owned. Null if unpacked data is not shared.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_ = nullptr;
   // Set of indices of nodes which unpack static data, e.g. Dequantize
   // operators which convert FP16 static weights to FP32. These nodes are simply
   // ignored in the delegate implementation, because their outputs are
@@ -110,7 +290,7 @@ class Subgraph {
       const int output_tensor_idx = params->output_tensors->data[o];
       // Exclude quasi-static tensors which may have become subgraph outputs
       // after partitioning.
-      if (delegate->static_unpacked_data_map_.count(output_tensor_idx) == 0) {
+      if (delegate->static_unpacked_data_.count(output_tensor_idx) == 0) {
         outputs.insert(output_tensor_idx);
       }
     }
@@ -187,7 +367,11 @@ class Subgraph {
     // XNNPACK Value IDs for TFLite tensors
     std::vector<uint32_t> xnnpack_tensors(tensors.back() + 1);
     for (int t : tensors) {
-      if (context->tensors[t].type != kTfLiteFloat32) {
+      // Quasi-static tensors, e.g. dequantized INT8 filters, are defined with
+      // their FP32 unpacked data.
+      const auto unpacked_it = delegate->static_unpacked_data_.find(t);
+      if (context->tensors[t].type != kTfLiteFloat32 &&
+          unpacked_it == delegate->static_unpacked_data_.end()) {
         TF_LITE_KERNEL_LOG(
             context,
             "unsupported datatype (%s) of tensor %d in XNNPACK delegate",
@@ -197,14 +381,10 @@ class Subgraph {
 
       uint32_t flags = 0;
       const void* data = nullptr;
-      if (context->tensors[t].allocation_type == kTfLiteMmapRo) {
+      if (unpacked_it != delegate->static_unpacked_data_.end()) {
+        data = unpacked_it->second->data();
+      } else if (context->tensors[t].allocation_type == kTfLiteMmapRo) {
         data = context->tensors[t].data.raw_const;
-      } else {
-        // Check for quasi-static data.
-        const auto it = delegate->static_unpacked_data_map_.find(t);
-        if (it != delegate->static_unpacked_data_map_.end()) {
-          data = delegate->static_unpacked_data_.data() + it->second;
-        }
       }
       if (inputs.count(t) != 0) {
         flags |= XNN_VALUE_FLAG_EXTERNAL_INPUT;
@@ -232,8 +412,7 @@ class Subgraph {
 
     // Create a set of quasi-static tensors for VisitNode function
     std::unordered_set<int> quasi_static_tensors;
-    for (const std::pair<const int, size_t>& entry :
-         delegate->static_unpacked_data_map_) {
+    for (const auto& entry : delegate->static_unpacked_data_) {
       quasi_static_tensors.insert(entry.first);
     }
 
@@ -1205,8 +1384,11 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    // Quasi-static filters may be INT8, and are dequantized to FP32.
+    if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
+      TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+          logging_context, filter_tensor, node->inputs->data[1], node_index));
+    }
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1293,8 +1475,11 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    // Quasi-static filters may be INT8, and are dequantized to FP32.
+    if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
+      TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+          logging_context, filter_tensor, node->inputs->data[1], node_index));
+    }
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 4,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -1438,8 +1623,11 @@ class Subgraph {
         logging_context, input_tensor, node->inputs->data[0], node_index));
 
     const TfLiteTensor& filter_tensor = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
-        logging_context, filter_tensor, node->inputs->data[1], node_index));
+    // Quasi-static filters may be INT8, and are dequantized to FP32.
+    if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
+      TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+          logging_context, filter_tensor, node->inputs->data[1], node_index));
+    }
     TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, filter_tensor, 2,
                                            node->inputs->data[1]));
     if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
@@ -2790,9 +2978,35 @@ class Subgraph {
   bool first_run_{true};
 };
 
+std::shared_ptr<const std::vector<char>> Delegate::UnpackStaticData(
+    int builtin_code, const TfLiteTensor& tensor, size_t unpacked_bytes,
+    const std::function<TfLiteStatus(float*)>& unpack) {
+  TfLiteXNNPackDelegateWeightsCache::Key key = {};
+  if (weights_cache_ != nullptr) {
+    key.data = tensor.data.raw_const;
+    key.bytes = tensor.bytes;
+    key.builtin_code = builtin_code;
+    key.fingerprint = Fingerprint(tensor.data.raw_const, tensor.bytes);
+    std::shared_ptr<const std::vector<char>> cached = weights_cache_->Find(key);
+    if (cached && cached->size() == unpacked_bytes + XNN_EXTRA_BYTES) {
+      return cached;
+    }
+  }
+
+  // XNNPACK may read up to XNN_EXTRA_BYTES past the end of static data.
+  auto unpacked_data =
+      std::make_shared<std::vector<char>>(unpacked_bytes + XNN_EXTRA_BYTES);
+  if (unpack(reinterpret_cast<float*>(unpacked_data->data())) != kTfLiteOk) {
+    return nullptr;
+  }
+  if (weights_cache_ == nullptr) {
+    return unpacked_data;
+  }
+  return weights_cache_->Insert(key, std::move(unpacked_data));
+}
+
 TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   // Clear previous data, in case the delegate is reused without re-creation.
-  static_unpacked_data_map_.clear();
   static_unpacked_data_.clear();
   static_unpack_nodes_.clear();
 
@@ -2827,15 +3041,16 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       continue;  // Soft error (skip this node).
     }
 
-    // Prepare to unpack FP16 tensors.
+    // Prepare to unpack FP16, INT8, and UINT8 tensors.
     if (registration->builtin_code == kTfLiteBuiltinDequantize &&
         node->inputs->size == 1 && node->outputs->size == 1) {
       const TfLiteTensor& input_tensor =
           context->tensors[node->inputs->data[0]];
       const TfLiteTensor& output_tensor =
           context->tensors[node->outputs->data[0]];
-      if (input_tensor.allocation_type == kTfLiteMmapRo &&
-          input_tensor.type == kTfLiteFloat16 &&
+      if (((input_tensor.allocation_type == kTfLiteMmapRo &&
+            input_tensor.type == kTfLiteFloat16) ||
+           IsStaticQuantizedTensor(input_tensor)) &&
           output_tensor.type == kTfLiteFloat32) {
         static_unpack_nodes_.insert(i);
         quasi_static_tensors_producers[node->outputs->data[0]] = i;
@@ -2872,6 +3087,13 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       }
     }
 
+    // Prepare to dequantize INT8 filters of dynamic-range quantized operators.
+    // Unlike the outputs of Dequantize nodes, these tensors have no producer
+    // node, and are unpacked in place.
+    if (HasDynamicRangeQuantizedFilter(context, registration, node)) {
+      quasi_static_tensors.insert(node->inputs->data[1]);
+    }
+
     if (Subgraph::VisitNode(/*subgraph=*/nullptr, context, registration, node,
                             node_index, quasi_static_tensors,
                             std::vector<uint32_t>()) != kTfLiteOk) {
@@ -2900,7 +3122,27 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
 
   // Unpack static data of all tensors
   for (int t : quasi_static_tensors_to_unpack) {
-    const int producer_index = quasi_static_tensors_producers[t];
+    const auto producer_it = quasi_static_tensors_producers.find(t);
+    if (producer_it == quasi_static_tensors_producers.end()) {
+      // Dynamic-range quantized filter.
+      const TfLiteTensor& filter_tensor = context->tensors[t];
+      const size_t tensor_elements = filter_tensor.bytes / sizeof(int8_t);
+      std::shared_ptr<const std::vector<char>> unpacked_data =
+          UnpackStaticData(kTfLiteBuiltinDequantize, filter_tensor,
+                           tensor_elements * sizeof(float),
+                           [&](float* dequantized_data) -> TfLiteStatus {
+                             DequantizeStaticTensor(filter_tensor,
+                                                    dequantized_data);
+                             return kTfLiteOk;
+                           });
+      if (!unpacked_data) {
+        TfLiteIntArrayFree(nodes_to_delegate);
+        return nullptr;  // Hard error.
+      }
+      static_unpacked_data_[t] = std::move(unpacked_data);
+      continue;
+    }
+    const int producer_index = producer_it->second;
     // Check if TFLite nodes can be delegated to XNNPACK
     TfLiteNode* node = nullptr;
     TfLiteRegistration* registration = nullptr;
@@ -2948,82 +3190,84 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     }
     const size_t tensor_elements = output_tensor.bytes / sizeof(float);
 
-    // Align to XNN_EXTRA_BYTES bytes
-    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
-      static_unpacked_data_.push_back(0);
-    }
-    const size_t tensor_offset = static_unpacked_data_.size();
-    static_unpacked_data_.resize(tensor_offset + context->tensors[t].bytes);
+    auto unpack = [&](float* unpacked_data) -> TfLiteStatus {
+      switch (registration->builtin_code) {
+        case kTfLiteBuiltinDequantize: {
+          if (IsStaticQuantizedTensor(input_tensor)) {
+            DequantizeStaticTensor(input_tensor, unpacked_data);
+            break;
+          }
 
-    float* unpacked_data =
-        reinterpret_cast<float*>(static_unpacked_data_.data() + tensor_offset);
-    switch (registration->builtin_code) {
-      case kTfLiteBuiltinDequantize: {
-        if (input_tensor.type != kTfLiteFloat16) {
-          TF_LITE_KERNEL_LOG(
-              context, "unexpected tensor %d data type (%s) in node %d",
-              node->inputs->data[0], TfLiteTypeGetName(input_tensor.type),
-              producer_index);
-          TfLiteIntArrayFree(nodes_to_delegate);
-          return nullptr;  // Hard error.
-        }
+          if (input_tensor.type != kTfLiteFloat16) {
+            TF_LITE_KERNEL_LOG(
+                context, "unexpected tensor %d data type (%s) in node %d",
+                node->inputs->data[0], TfLiteTypeGetName(input_tensor.type),
+                producer_index);
+            return kTfLiteError;
+          }
 
-        if (input_tensor.sparsity != nullptr) {
-          TF_LITE_KERNEL_LOG(context,
-                             "unexpected FP16 sparse tensor %d in node %d",
-                             node->inputs->data[0], producer_index);
-          TfLiteIntArrayFree(nodes_to_delegate);
-          return nullptr;  // Hard error.
-        }
+          if (input_tensor.sparsity != nullptr) {
+            TF_LITE_KERNEL_LOG(context,
+                               "unexpected FP16 sparse tensor %d in node %d",
+                               node->inputs->data[0], producer_index);
+            return kTfLiteError;
+          }
 
-        const uint16_t* packed_data =
-            static_cast<const uint16_t*>(input_tensor.data.data);
-        for (size_t i = 0; i < tensor_elements; i++) {
-          unpacked_data[i] = fp16_ieee_to_fp32_value(packed_data[i]);
-        }
-        break;
-      }
-      case kTfLiteBuiltinDensify: {
-        if (input_tensor.type != kTfLiteFloat32) {
-          TF_LITE_KERNEL_LOG(
-              context, "unexpected tensor %d data type (%s) in node %d",
-              node->inputs->data[0], TfLiteTypeGetName(input_tensor.type),
-              producer_index);
-          TfLiteIntArrayFree(nodes_to_delegate);
-          return nullptr;  // Hard error.
+          const uint16_t* packed_data =
+              static_cast<const uint16_t*>(input_tensor.data.data);
+          for (size_t i = 0; i < tensor_elements; i++) {
+            unpacked_data[i] = fp16_ieee_to_fp32_value(packed_data[i]);
+          }
+          break;
         }
+        case kTfLiteBuiltinDensify: {
+          if (input_tensor.type != kTfLiteFloat32) {
+            TF_LITE_KERNEL_LOG(
+                context, "unexpected tensor %d data type (%s) in node %d",
+                node->inputs->data[0], TfLiteTypeGetName(input_tensor.type),
+                producer_index);
+            return kTfLiteError;
+          }
 
-        if (input_tensor.sparsity == nullptr) {
-          TF_LITE_KERNEL_LOG(context, "unexpected dense tensor %d in node %d",
-                             node->inputs->data[0], producer_index);
-          TfLiteIntArrayFree(nodes_to_delegate);
-          return nullptr;  // Hard error.
-        }
+          if (input_tensor.sparsity == nullptr) {
+            TF_LITE_KERNEL_LOG(context, "unexpected dense tensor %d in node %d",
+                               node->inputs->data[0], producer_index);
+            return kTfLiteError;
+          }
 
-        const int dims_count = output_tensor.dims->size;
-        std::vector<int> vector_shape(dims_count);
-        for (int i = 0; i < dims_count; i++) {
-          vector_shape[i] = output_tensor.dims->data[i];
-        }
+          const int dims_count = output_tensor.dims->size;
+          std::vector<int> vector_shape(dims_count);
+          for (int i = 0; i < dims_count; i++) {
+            vector_shape[i] = output_tensor.dims->data[i];
+          }
 
-        tflite::optimize::sparsity::FormatConverter<float> converter(
-            vector_shape, *input_tensor.sparsity);
-        converter.SparseToDense(input_tensor.data.f);
-        const std::vector<float> out = converter.GetData();
-        for (int i = 0; i < out.size(); i++) {
-          unpacked_data[i] = out[i];
-        }
+          tflite::optimize::sparsity::FormatConverter<float> converter(
+              vector_shape, *input_tensor.sparsity);
+          converter.SparseToDense(input_tensor.data.f);
+          const std::vector<float> out = converter.GetData();
+          for (int i = 0; i < out.size(); i++) {
+            unpacked_data[i] = out[i];
+          }
 
-        break;
+          break;
+        }
+        default:
+          TF_LITE_KERNEL_LOG(context,
+                             "unexpected op registration %d at node %d",
+                             registration->builtin_code, producer_index);
+          return kTfLiteError;
       }
-      default:
-        TF_LITE_KERNEL_LOG(context, "unexpected op registration %d at node %d",
-                           registration->builtin_code, producer_index);
-        TfLiteIntArrayFree(nodes_to_delegate);
-        return nullptr;  // Hard error.
-    }
+      return kTfLiteOk;
+    };
 
-    static_unpacked_data_map_[t] = tensor_offset;
+    std::shared_ptr<const std::vector<char>> unpacked_data =
+        UnpackStaticData(registration->builtin_code, input_tensor,
+                         output_tensor.bytes, unpack);
+    if (!unpacked_data) {
+      TfLiteIntArrayFree(nodes_to_delegate);
+      return nullptr;  // Hard error.
+    }
+    static_unpacked_data_[t] = std::move(unpacked_data);
   }
 
   // Add nodes that unpack static data consumed by delegated nodes.
@@ -3130,3 +3374,12 @@ void TfLiteXNNPackDelegateDelete(TfLiteDelegate* delegate) {
     delete static_cast<::tflite::xnnpack::Delegate*>(delegate->data_);
   }
 }
+
+TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate() {
+  return new TfLiteXNNPackDelegateWeightsCache;
+}
+
+void TfLiteXNNPackDelegateWeightsCacheDelete(
+    TfLiteXNNPackDelegateWeightsCache* weights_cache) {
+  delete weights_cache;
+}
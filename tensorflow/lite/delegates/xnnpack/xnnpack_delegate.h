@@ -22,12 +22,31 @@ limitations under the License.
 extern "C" {
 #endif  // __cplusplus
 
+// A cache of the weights the delegate computes from static model data, e.g.
+// FP32 weights converted from FP16 ones. Delegates sharing a cache, e.g. the
+// delegates of many interpreters for the same model, share these weights
+// instead of computing and storing them again. Thread-safe.
+typedef struct TfLiteXNNPackDelegateWeightsCache
+    TfLiteXNNPackDelegateWeightsCache;
+
 typedef struct {
   // Number of threads to use in the thread pool.
   // 0 or negative value means no thread pool used.
   int32_t num_threads;
+  // Cache of weights shared with other delegates. Not owned, and must outlive
+  // the delegate. If null, weights are not shared.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache;
 } TfLiteXNNPackDelegateOptions;
 
+// Creates a new weights cache that need to be destroyed with
+// `TfLiteXNNPackDelegateWeightsCacheDelete` when no delegate uses it anymore.
+TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate();
+
+// Destroys a weights cache created with
+// `TfLiteXNNPackDelegateWeightsCacheCreate` call.
+void TfLiteXNNPackDelegateWeightsCacheDelete(
+    TfLiteXNNPackDelegateWeightsCache* weights_cache);
+
 // Returns a structure with the default XNNPack delegate options.
 TfLiteXNNPackDelegateOptions TfLiteXNNPackDelegateOptionsDefault();
 
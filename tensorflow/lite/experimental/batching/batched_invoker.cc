@@ -0,0 +1,167 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batched_invoker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/lite/model.h"
+
+namespace tflite {
+namespace batching {
+
+std::unique_ptr<BatchedInvoker> BatchedInvoker::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options, ErrorReporter* error_reporter) {
+  std::vector<int> batch_sizes = options.batch_sizes;
+  std::sort(batch_sizes.begin(), batch_sizes.end());
+  batch_sizes.erase(std::unique(batch_sizes.begin(), batch_sizes.end()),
+                    batch_sizes.end());
+  if (batch_sizes.empty() || batch_sizes[0] < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Batch sizes must be positive, and at least one "
+                         "batch size is required.");
+    return nullptr;
+  }
+
+  std::unique_ptr<BatchedInvoker> invoker(new BatchedInvoker(error_reporter));
+  ExternalCpuBackendContext* cpu_backend_context = options.cpu_backend_context;
+  if (!cpu_backend_context) {
+    invoker->owned_cpu_backend_context_.reset(new ExternalCpuBackendContext);
+    cpu_backend_context = invoker->owned_cpu_backend_context_.get();
+  }
+  for (int batch_size : batch_sizes) {
+    if (invoker->AddInterpreter(model, op_resolver, batch_size,
+                                options.num_threads,
+                                cpu_backend_context) != kTfLiteOk) {
+      return nullptr;
+    }
+  }
+  return invoker;
+}
+
+TfLiteStatus BatchedInvoker::AddInterpreter(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int batch_size, int num_threads,
+    ExternalCpuBackendContext* cpu_backend_context) {
+  std::unique_ptr<Interpreter> interpreter;
+  TF_LITE_ENSURE_STATUS(InterpreterBuilder(model, op_resolver,
+                                           error_reporter_)(&interpreter,
+                                                            num_threads));
+  interpreter->SetExternalContext(kTfLiteCpuBackendContext,
+                                  cpu_backend_context);
+
+  for (int input : interpreter->inputs()) {
+    const TfLiteTensor* tensor = interpreter->tensor(input);
+    if (tensor->type == kTfLiteString || tensor->dims->size == 0) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Input '%s' must be a numeric tensor with a batch "
+                           "dimension.",
+                           tensor->name);
+      return kTfLiteError;
+    }
+    std::vector<int> dims(tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size);
+    dims[0] = batch_size;
+    TF_LITE_ENSURE_STATUS(interpreter->ResizeInputTensor(input, dims));
+  }
+  TF_LITE_ENSURE_STATUS(interpreter->AllocateTensors());
+
+  // The sizes of the tensors of a single request, which must be the same for
+  // all the batch sizes.
+  std::vector<size_t> input_bytes;
+  for (int input : interpreter->inputs()) {
+    input_bytes.push_back(interpreter->tensor(input)->bytes / batch_size);
+  }
+  std::vector<size_t> output_bytes;
+  for (int output : interpreter->outputs()) {
+    const TfLiteTensor* tensor = interpreter->tensor(output);
+    if (tensor->type == kTfLiteString ||
+        tensor->allocation_type == kTfLiteDynamic || tensor->dims->size == 0 ||
+        tensor->dims->data[0] != batch_size) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Output '%s' must be a static numeric tensor with "
+                           "the same batch dimension as the inputs.",
+                           tensor->name);
+      return kTfLiteError;
+    }
+    output_bytes.push_back(tensor->bytes / batch_size);
+  }
+  if (interpreters_.empty()) {
+    input_bytes_ = std::move(input_bytes);
+    output_bytes_ = std::move(output_bytes);
+  } else if (input_bytes != input_bytes_ || output_bytes != output_bytes_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The size of a request depends on the batch size.");
+    return kTfLiteError;
+  }
+
+  batch_sizes_.push_back(batch_size);
+  interpreters_.push_back(std::move(interpreter));
+  return kTfLiteOk;
+}
+
+TfLiteStatus BatchedInvoker::Invoke(const std::vector<Request>& requests) {
+  for (const Request& request : requests) {
+    if (request.inputs.size() != input_bytes_.size() ||
+        request.outputs.size() != output_bytes_.size()) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Requests must have %d inputs and %d outputs.",
+                           inputs_size(), outputs_size());
+      return kTfLiteError;
+    }
+  }
+
+  size_t begin = 0;
+  while (begin < requests.size()) {
+    const int remaining = requests.size() - begin;
+    // Use the smallest batch that fits the remaining requests, or the
+    // largest batch if none does.
+    const int index = std::min<int>(
+        std::lower_bound(batch_sizes_.begin(), batch_sizes_.end(), remaining) -
+            batch_sizes_.begin(),
+        batch_sizes_.size() - 1);
+    Interpreter* interpreter = interpreters_[index].get();
+    const int batch_size = batch_sizes_[index];
+    const int num_requests = std::min(remaining, batch_size);
+
+    for (int i = 0; i < inputs_size(); ++i) {
+      const size_t bytes = input_bytes_[i];
+      char* data = interpreter->input_tensor(i)->data.raw;
+      for (int r = 0; r < num_requests; ++r) {
+        std::memcpy(data + r * bytes, requests[begin + r].inputs[i], bytes);
+      }
+      // Don't run the padding rows on data left by earlier requests.
+      std::memset(data + num_requests * bytes, 0,
+                  (batch_size - num_requests) * bytes);
+    }
+
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+
+    for (int i = 0; i < outputs_size(); ++i) {
+      const size_t bytes = output_bytes_[i];
+      const char* data = interpreter->output_tensor(i)->data.raw_const;
+      for (int r = 0; r < num_requests; ++r) {
+        std::memcpy(requests[begin + r].outputs[i], data + r * bytes, bytes);
+      }
+    }
+    begin += num_requests;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace batching
+}  // namespace tflite
@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHED_INVOKER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHED_INVOKER_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+namespace batching {
+
+// Runs many requests to a model at once, by stacking their inputs along the
+// first dimension of the input tensors, invoking the model once, and
+// splitting the outputs the same way. This is meant for servers, where
+// running requests one by one underuses the hardware.
+//
+// The first dimension of every input and output of the model must be the
+// batch dimension, and the model must not have dynamic or string tensors.
+// One interpreter is built and allocated for each of the given batch sizes,
+// so running a batch never plans memory again. They share the model weights
+// and the CPU backend context, including its thread pool.
+//
+// Example:
+//
+//   BatchedInvoker::Options options;
+//   options.batch_sizes = {1, 4, 16};
+//   auto invoker = BatchedInvoker::Create(*model, resolver, options);
+//   std::vector<BatchedInvoker::Request> requests(n);
+//   ... point requests[i].inputs and .outputs to the data of request i ...
+//   invoker->Invoke(requests);
+//
+// WARNING: This is an experimental API and subject to change.
+class BatchedInvoker {
+ public:
+  struct Options {
+    // The batch sizes to build interpreters for. Requests are run in batches
+    // of the smallest of these sizes that fits them, padded if necessary.
+    // More requests than the largest size are split into several batches.
+    std::vector<int> batch_sizes = {1, 2, 4, 8, 16, 32};
+
+    // The number of threads of each interpreter, as in
+    // Interpreter::SetNumThreads().
+    int num_threads = -1;
+
+    // If set, the CPU backend context used by the interpreters, for example
+    // to share a thread pool between several invokers. Not owned, and must
+    // outlive the invoker. Like for interpreters, invokers sharing a context
+    // must not be invoked at the same time.
+    ExternalCpuBackendContext* cpu_backend_context = nullptr;
+  };
+
+  // The data of a single request, which would be the data of the model's
+  // tensors if the batch dimension was 1.
+  struct Request {
+    // One buffer of input_bytes(i) bytes per input i of the model.
+    std::vector<const void*> inputs;
+    // One buffer of output_bytes(i) bytes per output i of the model.
+    std::vector<void*> outputs;
+  };
+
+  // Builds an invoker for `model`, which must outlive it. Returns nullptr in
+  // case of failure.
+  static std::unique_ptr<BatchedInvoker> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const Options& options,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
+  BatchedInvoker(const BatchedInvoker&) = delete;
+  BatchedInvoker& operator=(const BatchedInvoker&) = delete;
+
+  // Runs all the requests, and writes their outputs. Must not be called from
+  // several threads at the same time.
+  TfLiteStatus Invoke(const std::vector<Request>& requests);
+
+  int inputs_size() const { return input_bytes_.size(); }
+  int outputs_size() const { return output_bytes_.size(); }
+
+  // The number of bytes of input (output) `index` of a single request.
+  size_t input_bytes(int index) const { return input_bytes_[index]; }
+  size_t output_bytes(int index) const { return output_bytes_[index]; }
+
+ private:
+  explicit BatchedInvoker(ErrorReporter* error_reporter)
+      : error_reporter_(error_reporter) {}
+
+  // Builds the interpreter running batches of `batch_size` requests.
+  TfLiteStatus AddInterpreter(const FlatBufferModel& model,
+                              const OpResolver& op_resolver, int batch_size,
+                              int num_threads,
+                              ExternalCpuBackendContext* cpu_backend_context);
+
+  ErrorReporter* error_reporter_;
+
+  // Set unless the context is given in the options. Must outlive
+  // `interpreters_`.
+  std::unique_ptr<ExternalCpuBackendContext> owned_cpu_backend_context_;
+
+  // In increasing order of batch size.
+  std::vector<int> batch_sizes_;
+  std::vector<std::unique_ptr<Interpreter>> interpreters_;
+
+  std::vector<size_t> input_bytes_;
+  std::vector<size_t> output_bytes_;
+};
+
+}  // namespace batching
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHED_INVOKER_H_
@@ -0,0 +1,123 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batched_invoker.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace batching {
+namespace {
+
+// The model computes 3 * input for inputs of shape [1, 8, 8, 3].
+constexpr char kAddModel[] = "tensorflow/lite/testdata/add.bin";
+constexpr int kRequestSize = 8 * 8 * 3;
+
+class BatchedInvokerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(kAddModel);
+    ASSERT_NE(model_, nullptr);
+  }
+
+  // Runs `num_requests` requests, where request r has all its inputs set to
+  // r, and checks the outputs.
+  void InvokeAndCheck(BatchedInvoker* invoker, int num_requests) {
+    std::vector<std::vector<float>> inputs(num_requests);
+    std::vector<std::vector<float>> outputs(num_requests);
+    std::vector<BatchedInvoker::Request> requests(num_requests);
+    for (int r = 0; r < num_requests; ++r) {
+      inputs[r].assign(kRequestSize, r);
+      outputs[r].assign(kRequestSize, -1);
+      requests[r].inputs = {inputs[r].data()};
+      requests[r].outputs = {outputs[r].data()};
+    }
+    ASSERT_EQ(invoker->Invoke(requests), kTfLiteOk);
+    for (int r = 0; r < num_requests; ++r) {
+      EXPECT_THAT(outputs[r], testing::Each(3.0f * r)) << "request " << r;
+    }
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolver resolver_;
+};
+
+TEST_F(BatchedInvokerTest, RequestSizes) {
+  BatchedInvoker::Options options;
+  options.batch_sizes = {4, 1};
+  auto invoker = BatchedInvoker::Create(*model_, resolver_, options);
+  ASSERT_NE(invoker, nullptr);
+  ASSERT_EQ(invoker->inputs_size(), 1);
+  ASSERT_EQ(invoker->outputs_size(), 1);
+  EXPECT_EQ(invoker->input_bytes(0), kRequestSize * sizeof(float));
+  EXPECT_EQ(invoker->output_bytes(0), kRequestSize * sizeof(float));
+}
+
+TEST_F(BatchedInvokerTest, InvokesAnyNumberOfRequests) {
+  BatchedInvoker::Options options;
+  options.batch_sizes = {1, 2, 4};
+  auto invoker = BatchedInvoker::Create(*model_, resolver_, options);
+  ASSERT_NE(invoker, nullptr);
+  // Covers full, padded and split batches.
+  for (int num_requests : {0, 1, 2, 3, 4, 7, 9}) {
+    InvokeAndCheck(invoker.get(), num_requests);
+  }
+}
+
+TEST_F(BatchedInvokerTest, SharesCpuBackendContext) {
+  ExternalCpuBackendContext cpu_backend_context;
+  BatchedInvoker::Options options;
+  options.batch_sizes = {2};
+  options.cpu_backend_context = &cpu_backend_context;
+  auto invoker1 = BatchedInvoker::Create(*model_, resolver_, options);
+  auto invoker2 = BatchedInvoker::Create(*model_, resolver_, options);
+  ASSERT_NE(invoker1, nullptr);
+  ASSERT_NE(invoker2, nullptr);
+  InvokeAndCheck(invoker1.get(), 3);
+  InvokeAndCheck(invoker2.get(), 2);
+}
+
+TEST_F(BatchedInvokerTest, InvalidOptions) {
+  BatchedInvoker::Options options;
+  options.batch_sizes = {};
+  EXPECT_EQ(BatchedInvoker::Create(*model_, resolver_, options), nullptr);
+  options.batch_sizes = {0, 2};
+  EXPECT_EQ(BatchedInvoker::Create(*model_, resolver_, options), nullptr);
+}
+
+TEST_F(BatchedInvokerTest, InvalidRequests) {
+  auto invoker =
+      BatchedInvoker::Create(*model_, resolver_, BatchedInvoker::Options());
+  ASSERT_NE(invoker, nullptr);
+  std::vector<BatchedInvoker::Request> requests(1);
+  EXPECT_EQ(invoker->Invoke(requests), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace batching
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
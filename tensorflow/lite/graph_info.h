@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_GRAPH_INFO_H_
 #define TENSORFLOW_LITE_GRAPH_INFO_H_
 
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
@@ -53,6 +54,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the first and last indices of the nodes that may be executing at
+  // the same time as the node at `index`. By default nodes are executed one at
+  // a time, in index order.
+  virtual std::pair<size_t, size_t> concurrent_nodes(size_t index) const {
+    return {index, index};
+  }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
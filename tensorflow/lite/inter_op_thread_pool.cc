@@ -0,0 +1,86 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/inter_op_thread_pool.h"
+
+namespace tflite {
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&InterOpThreadPool::WorkerLoop, this, i);
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exiting_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::Run(int num_tasks,
+                            const std::function<void(int, int)>& fn) {
+  if (workers_.empty() || num_tasks <= 1) {
+    for (int task = 0; task < num_tasks; ++task) {
+      fn(/*thread_index=*/0, task);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_tasks_ = num_tasks;
+    next_task_.store(0);
+    busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks(/*thread_index=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+  fn_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop(int thread_index) {
+  int64_t last_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, last_generation] {
+        return exiting_ || generation_ != last_generation;
+      });
+      if (exiting_) return;
+      last_generation = generation_;
+    }
+    RunTasks(thread_index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_workers_ == 0) work_done_.notify_one();
+    }
+  }
+}
+
+void InterOpThreadPool::RunTasks(int thread_index) {
+  for (int task = next_task_.fetch_add(1); task < num_tasks_;
+       task = next_task_.fetch_add(1)) {
+    (*fn_)(thread_index, task);
+  }
+}
+
+}  // namespace tflite
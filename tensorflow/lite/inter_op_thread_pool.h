@@ -0,0 +1,74 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of threads running batches of independent tasks, used to execute
+// the independent nodes of a graph at the same time.
+//
+// The thread calling Run() takes part in running the tasks, so a pool of
+// `num_threads` threads only starts `num_threads` - 1 of them.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  // The number of threads running tasks, including the one calling Run().
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Calls `fn(thread_index, task)` for every task in [0, num_tasks), and
+  // returns once all the calls returned. `thread_index` is in
+  // [0, num_threads()) and identifies the thread making the call; 0 is the
+  // thread calling Run(). Run() must not be called by more than one thread at
+  // a time, nor from within `fn`.
+  void Run(int num_tasks, const std::function<void(int, int)>& fn);
+
+ private:
+  void WorkerLoop(int thread_index);
+  void RunTasks(int thread_index);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented for every batch of tasks handed to the workers.
+  int64_t generation_ = 0;
+  // The workers that didn't finish the current batch yet.
+  int busy_workers_ = 0;
+  bool exiting_ = false;
+
+  // The current batch. Set under `mutex_` before `generation_` is incremented.
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
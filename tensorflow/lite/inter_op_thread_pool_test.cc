@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/inter_op_thread_pool.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <set>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TEST(InterOpThreadPoolTest, RunsEveryTaskOnce) {
+  InterOpThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 100}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    pool.Run(num_tasks, [&](int thread_index, int task) {
+      EXPECT_GE(thread_index, 0);
+      EXPECT_LT(thread_index, 4);
+      runs[task]++;
+    });
+    for (int task = 0; task < num_tasks; ++task) {
+      EXPECT_EQ(runs[task], 1) << "task " << task;
+    }
+  }
+}
+
+TEST(InterOpThreadPoolTest, SingleThreadRunsOnCaller) {
+  InterOpThreadPool pool(1);
+  std::set<int> thread_indices;
+  pool.Run(3, [&](int thread_index, int task) {
+    thread_indices.insert(thread_index);
+  });
+  EXPECT_THAT(thread_indices, ::testing::ElementsAre(0));
+}
+
+TEST(InterOpThreadPoolTest, RunsTasksConcurrently) {
+  InterOpThreadPool pool(2);
+  // Each task waits for the other one to start, which only happens if they are
+  // run at the same time.
+  std::atomic<int> started(0);
+  std::atomic<int> saw_other(0);
+  pool.Run(2, [&](int thread_index, int task) {
+    started++;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (started < 2 && std::chrono::steady_clock::now() < deadline) {
+    }
+    if (started == 2) saw_other++;
+  });
+  EXPECT_EQ(saw_other, 2);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
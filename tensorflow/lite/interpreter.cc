@@ -248,6 +248,7 @@ void Interpreter::AddSubgraphs(int subgraphs_to_add,
   for (int i = 0; i < subgraphs_to_add; ++i) {
     Subgraph* subgraph = new Subgraph(error_reporter_, external_contexts_,
                                       &subgraphs_, &resources_);
+    subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
     subgraphs_.emplace_back(subgraph);
   }
 }
@@ -295,6 +296,14 @@ TfLiteStatus Interpreter::Invoke() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::InvokeWithCustomAllocations(
+    const std::vector<std::pair<int, TfLiteCustomAllocation>>& buffers) {
+  TF_LITE_ENSURE_STATUS(primary_subgraph().BindExternalTensorData(buffers));
+  const TfLiteStatus status = Invoke();
+  primary_subgraph().UnbindExternalTensorData();
+  return status;
+}
+
 TfLiteStatus Interpreter::AddTensors(int tensors_to_add,
                                      int* first_new_tensor_index) {
   return primary_subgraph().AddTensors(tensors_to_add, first_new_tensor_index);
@@ -374,6 +383,37 @@ TfLiteStatus Interpreter::SetNumThreads(int num_threads) {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetNumInterOpThreads(int num_threads) {
+  if (num_threads < 1) {
+    context_->ReportError(context_, "num_threads should be >= 1.");
+    return kTfLiteError;
+  }
+
+  std::unique_ptr<InterOpThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool.reset(new InterOpThreadPool(num_threads));
+  }
+  for (auto& subgraph : subgraphs_) {
+    if (subgraph->SetInterOpThreadPool(thread_pool.get()) != kTfLiteOk) {
+      // Don't leave any subgraph with the pool about to be destroyed.
+      for (auto& other_subgraph : subgraphs_) {
+        other_subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
+      }
+      return kTfLiteError;
+    }
+  }
+  inter_op_thread_pool_ = std::move(thread_pool);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetMemoryPlanningStrategy(
+    ArenaPlanningStrategy strategy) {
+  for (auto& subgraph : subgraphs_) {
+    TF_LITE_ENSURE_STATUS(subgraph->SetMemoryPlanningStrategy(strategy));
+  }
+  return kTfLiteOk;
+}
+
 void Interpreter::SetAllowFp16PrecisionForFp32(bool allow) {
   for (auto& subgraph : subgraphs_) {
     subgraph->context()->allow_fp32_relax_to_fp16 = allow;
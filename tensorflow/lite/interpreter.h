@@ -26,12 +26,14 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/common.h"  // IWYU pragma: export
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/type_to_tflitetype.h"
@@ -385,6 +387,29 @@ class Interpreter {
   /// available to itself.
   TfLiteStatus SetNumThreads(int num_threads);
 
+  /// Set the number of threads executing independent nodes of the graph at
+  /// the same time, for graphs with independent branches. With the default of
+  /// 1, nodes are executed one at a time. With more, the nodes executed on
+  /// the extra threads are single-threaded.
+  ///
+  /// NOTE: Like ResizeInputTensor(), this requires AllocateTensors() to be
+  /// called again before Invoke(). The tensors of nodes that may execute at
+  /// the same time don't share memory, so more memory may be allocated.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
+  /// Set the order in which tensors are placed in the memory arena. With
+  /// ArenaPlanningStrategy::kGreedyByBreadth, some models need less memory
+  /// than with the default kGreedyBySize, at the cost of a slower
+  /// AllocateTensors(). Tensors with offsets planned offline, in the
+  /// "OfflineMemoryAllocation" metadata of the model, use these offsets
+  /// regardless of the strategy.
+  ///
+  /// NOTE: Like ResizeInputTensor(), this requires AllocateTensors() to be
+  /// called again before Invoke().
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetMemoryPlanningStrategy(ArenaPlanningStrategy strategy);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// default: not allow.
   /// WARNING: This is an experimental API and subject to change.
@@ -551,6 +576,22 @@ class Interpreter {
   TfLiteStatus SetCustomAllocationForTensor(
       int tensor_index, const TfLiteCustomAllocation& allocation);
 
+  // Invokes the interpreter once, with the data of some input and output
+  // tensors in caller-owned buffers, e.g. camera frames or network buffers,
+  // instead of copying them in and out of the tensors. `buffers` holds
+  // <tensor index, buffer> pairs, and the buffers should satisfy conditions
+  // 2-4 of SetCustomAllocationForTensor. The tensors point to their own memory
+  // again after the call.
+  //
+  // The memory planned for the tensors is not used during the call. To leave
+  // the tensors out of the arena altogether, give them a custom allocation
+  // with SetCustomAllocationForTensor before AllocateTensors. Graphs with
+  // dynamic tensors are not supported.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus InvokeWithCustomAllocations(
+      const std::vector<std::pair<int, TfLiteCustomAllocation>>& buffers);
+
 #ifndef DOXYGEN_SKIP
   /// Adds `subgraphs_to_add` subgraphs, preserving pre-existing Subgraph
   /// entries. The value pointed to by `first_new_subgraph_index` will be set to
@@ -647,6 +688,11 @@ class Interpreter {
   // nullptr if necessary.
   std::unique_ptr<ExternalCpuBackendContext> own_external_cpu_backend_context_;
 
+  // Executes independent nodes at the same time, for all subgraphs. Null
+  // unless SetNumInterOpThreads() was called with more than one thread. Must
+  // outlive `subgraphs_`.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
   // Subgraphs
   std::vector<std::unique_ptr<Subgraph>> subgraphs_;
 
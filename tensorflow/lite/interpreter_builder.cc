@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -106,6 +107,10 @@ TfLiteStatus ParseSparseIndexVector(const DimensionMetadata* src,
 
 const char* kEmptyTensorName = "";
 
+// Name of the model metadata holding tensor offsets planned ahead of time.
+// This is the same format as used by TFLite Micro.
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+
 // Using weak symbols to create a delegate allows automatic injection of the
 // delegate simply by adding it as a dependency.
 // For flex delegate, see also the strong override in
@@ -558,6 +563,66 @@ TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter,
   return kTfLiteOk;
 }
 
+// The buffer of the "OfflineMemoryAllocation" metadata is a list of 32-bit
+// integers: the format version (1), the index of the subgraph the offsets
+// apply to, the number of tensors n of the subgraph, and then n arena offsets
+// of the tensors, or -1 for the tensors to be planned at runtime.
+TfLiteStatus InterpreterBuilder::ParseOfflineMemoryPlans(
+    Interpreter* interpreter) {
+  if (!model_->metadata()) {
+    return kTfLiteOk;
+  }
+  constexpr int kHeaderSize = 3;
+  for (const auto* metadata : *model_->metadata()) {
+    if (!metadata->name() ||
+        strcmp(metadata->name()->c_str(), kOfflineMemAllocMetadata) != 0) {
+      continue;
+    }
+    const auto* buffers = model_->buffers();
+    const flatbuffers::Vector<uint8_t>* data = nullptr;
+    if (metadata->buffer() < buffers->size()) {
+      data = buffers->Get(metadata->buffer())->data();
+    }
+    if (!data || data->size() % sizeof(int32_t) != 0 ||
+        data->size() < kHeaderSize * sizeof(int32_t)) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Invalid buffer for %s metadata.\n",
+                           kOfflineMemAllocMetadata);
+      return kTfLiteError;
+    }
+    // The buffer isn't necessarily aligned, so copy it.
+    std::vector<int32_t> values(data->size() / sizeof(int32_t));
+    memcpy(values.data(), data->data(), data->size());
+    const int version = values[0];
+    const int subgraph_index = values[1];
+    const int num_offsets = values[2];
+    if (version != 1) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Unsupported %s metadata version %d.\n",
+                           kOfflineMemAllocMetadata, version);
+      return kTfLiteError;
+    }
+    Subgraph* subgraph = interpreter->subgraph(subgraph_index);
+    if (!subgraph) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Invalid subgraph index %d in %s metadata.\n",
+                           subgraph_index, kOfflineMemAllocMetadata);
+      return kTfLiteError;
+    }
+    if (num_offsets != subgraph->tensors_size() ||
+        num_offsets != static_cast<int>(values.size()) - kHeaderSize) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Number of offline buffer offsets (%d) in metadata "
+                           "not equal to number of tensors (%d).\n",
+                           num_offsets, subgraph->tensors_size());
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_STATUS(subgraph->SetOfflineMemoryPlan(
+        std::vector<int32_t>(values.begin() + kHeaderSize, values.end())));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::operator()(
     std::unique_ptr<Interpreter>* interpreter) {
   return operator()(interpreter, /*num_threads=*/-1);
@@ -668,6 +733,9 @@ TfLiteStatus InterpreterBuilder::operator()(
     modified_subgraph->SetVariables(std::move(variables));
   }
 
+  if (ParseOfflineMemoryPlans(interpreter->get()) != kTfLiteOk)
+    return cleanup_and_error();
+
   if (num_fp32_tensors_ > 0) {
     (*interpreter)->lazy_delegate_providers_ =
         op_resolver_.GetDelegates(num_threads);
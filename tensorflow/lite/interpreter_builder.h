@@ -78,6 +78,7 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
       Subgraph* subgraph);
   TfLiteStatus ApplyDelegates(Interpreter* interpreter, int num_threads);
+  TfLiteStatus ParseOfflineMemoryPlans(Interpreter* interpreter);
   TfLiteStatus ParseQuantization(const QuantizationParameters* src_quantization,
                                  TfLiteQuantization* quantization,
                                  const std::vector<int>& dims);
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 
 #include <gmock/gmock.h>
@@ -1302,6 +1304,166 @@ TEST_F(TestExecutionPlan, NullExecutionPlan) {
   ASSERT_EQ(run_order_, std::vector<int>());
 }
 
+class InterOpParallelismTest : public ::testing::Test {
+ protected:
+  // Build a kernel registration for an op that doubles its float input. If
+  // `rendezvous`, the op also waits for another such op to run at the same
+  // time, and records whether it did.
+  static TfLiteRegistration DoubleOpRegistration(bool rendezvous) {
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = GetInput(context, node, 0);
+      TfLiteTensor* output = GetOutput(context, node, 0);
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = GetInput(context, node, 0);
+      TfLiteTensor* output = GetOutput(context, node, 0);
+      for (int i = 0; i < NumElements(input); ++i) {
+        output->data.f[i] = 2 * input->data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    if (rendezvous) {
+      reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+        rendezvous_arrivals_++;
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (rendezvous_arrivals_ < 2 &&
+               std::chrono::steady_clock::now() < deadline) {
+        }
+        if (rendezvous_arrivals_ >= 2) rendezvous_successes_++;
+        return DoubleOpRegistration(/*rendezvous=*/false).invoke(context, node);
+      };
+    }
+    return reg;
+  }
+
+  // Build a kernel registration for an op that adds its two float inputs.
+  static TfLiteRegistration AddOpRegistration() {
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = GetInput(context, node, 0);
+      TfLiteTensor* output = GetOutput(context, node, 0);
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input0 = GetInput(context, node, 0);
+      const TfLiteTensor* input1 = GetInput(context, node, 1);
+      TfLiteTensor* output = GetOutput(context, node, 0);
+      for (int i = 0; i < NumElements(input0); ++i) {
+        output->data.f[i] = input0->data.f[i] + input1->data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    return reg;
+  }
+
+  void SetUp() final {
+    rendezvous_arrivals_ = 0;
+    rendezvous_successes_ = 0;
+  }
+
+  // Adds `num_tensors` float tensors of shape {3}. The first one is the input
+  // and the last one the output.
+  void AddTensors(int num_tensors) {
+    ASSERT_EQ(interpreter_.AddTensors(num_tensors), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({num_tensors - 1}), kTfLiteOk);
+    TfLiteQuantizationParams quantized;
+    for (int i = 0; i < num_tensors; ++i) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                          {3}, quantized),
+                kTfLiteOk);
+    }
+  }
+
+  void AddNode(const std::vector<int>& inputs, const std::vector<int>& outputs,
+               TfLiteRegistration registration) {
+    ASSERT_EQ(interpreter_.AddNodeWithParameters(inputs, outputs, nullptr, 0,
+                                                 nullptr, &registration),
+              kTfLiteOk);
+  }
+
+  // Sets the input to {1, 2, 3}, invokes the interpreter and returns the
+  // output.
+  std::vector<float> Invoke() {
+    float* input = interpreter_.typed_tensor<float>(0);
+    for (int i = 0; i < 3; ++i) input[i] = i + 1;
+    if (interpreter_.Invoke() != kTfLiteOk) return {};
+    const float* output =
+        interpreter_.typed_tensor<float>(interpreter_.outputs()[0]);
+    return std::vector<float>(output, output + 3);
+  }
+
+  static std::atomic<int> rendezvous_arrivals_;
+  static std::atomic<int> rendezvous_successes_;
+
+  Interpreter interpreter_;
+};
+
+std::atomic<int> InterOpParallelismTest::rendezvous_arrivals_;
+std::atomic<int> InterOpParallelismTest::rendezvous_successes_;
+
+TEST_F(InterOpParallelismTest, ExecutesIndependentNodesConcurrently) {
+  // Two independent branches doubling the input, and their sum.
+  AddTensors(4);
+  AddNode({0}, {1}, DoubleOpRegistration(/*rendezvous=*/true));
+  AddNode({0}, {2}, DoubleOpRegistration(/*rendezvous=*/true));
+  AddNode({1, 2}, {3}, AddOpRegistration());
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(interpreter_.SetNumInterOpThreads(2), kTfLiteOk);
+  // The memory plan changes, so the tensors must be allocated again.
+  EXPECT_EQ(interpreter_.Invoke(), kTfLiteError);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  // Both branches are live at the same time, so they can't share memory.
+  const TfLiteTensor* branch0 = interpreter_.tensor(1);
+  const TfLiteTensor* branch1 = interpreter_.tensor(2);
+  EXPECT_TRUE(branch0->data.raw + branch0->bytes <= branch1->data.raw ||
+              branch1->data.raw + branch1->bytes <= branch0->data.raw);
+
+  EXPECT_THAT(Invoke(), testing::ElementsAre(4, 8, 12));
+  EXPECT_EQ(rendezvous_successes_, 2);
+}
+
+TEST_F(InterOpParallelismTest, SortsExecutionPlanByStage) {
+  // Node 1 depends on node 0, node 2 is independent of both, and node 3
+  // depends on nodes 1 and 2.
+  AddTensors(5);
+  AddNode({0}, {1}, DoubleOpRegistration(/*rendezvous=*/false));
+  AddNode({1}, {2}, DoubleOpRegistration(/*rendezvous=*/false));
+  AddNode({0}, {3}, DoubleOpRegistration(/*rendezvous=*/false));
+  AddNode({2, 3}, {4}, AddOpRegistration());
+  ASSERT_EQ(interpreter_.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  EXPECT_EQ(interpreter_.execution_plan(), std::vector<int>({0, 2, 1, 3}));
+  EXPECT_THAT(Invoke(), testing::ElementsAre(6, 12, 18));
+}
+
+TEST_F(InterOpParallelismTest, NodesUsingVariablesKeepTheirOrder) {
+  // Like in SortsExecutionPlanByStage, but tensor 1 is a variable, so nodes 0
+  // and 1 execute alone and in order with respect to node 2.
+  AddTensors(5);
+  TfLiteQuantizationParams quantized;
+  ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                1, kTfLiteFloat32, "", {3}, quantized, /*is_variable=*/true),
+            kTfLiteOk);
+  AddNode({0}, {1}, DoubleOpRegistration(/*rendezvous=*/false));
+  AddNode({1}, {2}, DoubleOpRegistration(/*rendezvous=*/false));
+  AddNode({0}, {3}, DoubleOpRegistration(/*rendezvous=*/false));
+  AddNode({2, 3}, {4}, AddOpRegistration());
+  ASSERT_EQ(interpreter_.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  EXPECT_EQ(interpreter_.execution_plan(), std::vector<int>({0, 1, 2, 3}));
+  EXPECT_THAT(Invoke(), testing::ElementsAre(6, 12, 18));
+}
+
 TEST(TestDelegateOwnership, ProperlyDisposed) {
   struct TfLiteInterpreterOwnedDelegate : public TfLiteDelegate {
     TfLiteInterpreterOwnedDelegate(bool* destroyed, bool* prepared)
@@ -1762,6 +1924,61 @@ TEST_F(TestCustomAllocation, ResizeTensorsWithEnoughMemory) {
   VerifyInvoke();
 }
 
+TEST_F(TestCustomAllocation, InvokeWithCustomAllocations) {
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  float* planned_input_data = interpreter_->typed_tensor<float>(0);
+  float* planned_output_data = interpreter_->typed_tensor<float>(4);
+
+  const size_t bytes = 3 * sizeof(float);
+  auto input0_alloc = NewCustomAlloc(bytes, kDefaultTensorAlignment);
+  auto input1_alloc = NewCustomAlloc(bytes, kDefaultTensorAlignment);
+  auto output_alloc = NewCustomAlloc(bytes, kDefaultTensorAlignment);
+  const std::vector<float> input0 = {1.0f, 2.0f, 3.0f};
+  const std::vector<float> input1 = {10.0f, 20.0f, 30.0f};
+  memcpy(input0_alloc.data, input0.data(), bytes);
+  memcpy(input1_alloc.data, input1.data(), bytes);
+  memset(interpreter_->typed_tensor<float>(5), 0, bytes);
+
+  ASSERT_EQ(interpreter_->InvokeWithCustomAllocations(
+                {{0, input0_alloc}, {1, input1_alloc}, {4, output_alloc}}),
+            kTfLiteOk);
+  // Tensor 4 = 2 * tensor 0 + tensor 1.
+  const float* output = static_cast<const float*>(output_alloc.data);
+  EXPECT_EQ(output[0], 12.0f);
+  EXPECT_EQ(output[1], 24.0f);
+  EXPECT_EQ(output[2], 36.0f);
+
+  // The tensors use their planned memory again.
+  EXPECT_EQ(interpreter_->typed_tensor<float>(0), planned_input_data);
+  EXPECT_EQ(interpreter_->typed_tensor<float>(4), planned_output_data);
+  VerifyInvoke();
+}
+
+TEST_F(TestCustomAllocation, InvokeWithCustomAllocationsInvalidBuffers) {
+  auto alloc = NewCustomAlloc(3 * sizeof(float), kDefaultTensorAlignment);
+  // Tensors must be allocated first.
+  ASSERT_EQ(interpreter_->InvokeWithCustomAllocations({{0, alloc}}),
+            kTfLiteError);
+
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  float* planned_input_data = interpreter_->typed_tensor<float>(0);
+  // Only inputs and outputs can be bound.
+  ASSERT_EQ(interpreter_->InvokeWithCustomAllocations({{0, alloc}, {2, alloc}}),
+            kTfLiteError);
+  EXPECT_EQ(interpreter_->typed_tensor<float>(0), planned_input_data);
+  // Buffers must be large enough.
+  auto small_alloc = NewCustomAlloc(4, kDefaultTensorAlignment);
+  ASSERT_EQ(interpreter_->InvokeWithCustomAllocations({{0, small_alloc}}),
+            kTfLiteError);
+  // Buffers must be aligned.
+  TfLiteCustomAllocation misaligned_alloc{static_cast<char*>(alloc.data) + 1,
+                                          3 * sizeof(float)};
+  ASSERT_EQ(interpreter_->InvokeWithCustomAllocations({{0, misaligned_alloc}}),
+            kTfLiteError);
+  EXPECT_EQ(interpreter_->typed_tensor<float>(0), planned_input_data);
+  VerifyInvoke();
+}
+
 }  // namespace
 }  // namespace tflite
 
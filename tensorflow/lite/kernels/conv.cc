@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
@@ -30,14 +31,17 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/densify.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/selective_registration.h"
 
 namespace tflite {
 namespace ops {
@@ -103,6 +107,16 @@ struct OpData {
   bool supports_multithreaded_kernel = false;
   bool is_hybrid_per_channel = false;
   bool compute_hybrid_row_sums = true;
+
+  // A float filter with sparsity, re-encoded as a sparse
+  // [channels_out, filter_height * filter_width * channels_in] matrix in a
+  // format of the sparse FullyConnected kernels. See PrepareSparseFilter.
+  bool has_sparse_filter = false;
+  std::vector<float> sparse_filter_values;
+  TfLiteIntArray* sparse_filter_segments = nullptr;
+  TfLiteIntArray* sparse_filter_indices = nullptr;
+  TfLiteDimensionMetadata sparse_filter_dim_metadata[3];
+  TfLiteSparsity sparse_filter;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -128,7 +142,71 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
 
 void Free(TfLiteContext* context, void* buffer) {
   eigen_support::DecrementUsageCounter(context);
-  delete reinterpret_cast<OpData*>(buffer);
+  OpData* data = reinterpret_cast<OpData*>(buffer);
+  if (data->sparse_filter_segments != nullptr) {
+    TfLiteIntArrayFree(data->sparse_filter_segments);
+  }
+  if (data->sparse_filter_indices != nullptr) {
+    TfLiteIntArrayFree(data->sparse_filter_indices);
+  }
+  delete data;
+}
+
+// Re-encodes the sparse float `filter` for optimized_ops::ConvSparseWeight, as
+// a [channels_out, filter_height * filter_width * channels_in] matrix. If the
+// depth of the matrix is a multiple of 4, the matrix is stored in 1x4 blocks
+// for the SIMD kernel of block sparse FullyConnected, and otherwise in random
+// sparse format. Only the blocks (or values) which are non-zero are kept, so
+// the filter is never held densely after Prepare, whatever the sparsity format
+// in the model.
+TfLiteStatus PrepareSparseFilter(TfLiteContext* context,
+                                 const TfLiteTensor* filter, OpData* data) {
+  TF_LITE_ENSURE(context, IsConstantTensor(filter));
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const int rows = filter_shape.Dims(0);
+  const int cols = FlatSizeSkipDim(filter_shape, 0);
+  std::vector<float> dense_filter(filter_shape.FlatSize());
+  reference_ops::Densify(filter->sparsity, filter_shape,
+                         GetTensorData<float>(filter), filter_shape,
+                         dense_filter.data());
+
+  const int block_size = cols % 4 == 0 ? 4 : 1;
+  const int num_blocks = cols / block_size;
+  std::vector<int> segments = {0};
+  std::vector<int> indices;
+  for (int row = 0; row < rows; ++row) {
+    for (int block = 0; block < num_blocks; ++block) {
+      const float* block_data =
+          dense_filter.data() + row * cols + block * block_size;
+      if (std::any_of(block_data, block_data + block_size,
+                      [](float value) { return value != 0.0f; })) {
+        indices.push_back(block);
+        data->sparse_filter_values.insert(data->sparse_filter_values.end(),
+                                          block_data, block_data + block_size);
+      }
+    }
+    segments.push_back(static_cast<int>(indices.size()));
+  }
+
+  data->sparse_filter_segments = TfLiteIntArrayCreate(segments.size());
+  std::copy(segments.begin(), segments.end(),
+            data->sparse_filter_segments->data);
+  data->sparse_filter_indices = TfLiteIntArrayCreate(indices.size());
+  std::copy(indices.begin(), indices.end(), data->sparse_filter_indices->data);
+
+  data->sparse_filter_dim_metadata[0] = {kTfLiteDimDense, rows, nullptr,
+                                         nullptr};
+  data->sparse_filter_dim_metadata[1] = {kTfLiteDimSparseCSR, num_blocks,
+                                         data->sparse_filter_segments,
+                                         data->sparse_filter_indices};
+  data->sparse_filter_dim_metadata[2] = {kTfLiteDimDense, block_size, nullptr,
+                                         nullptr};
+  data->sparse_filter.traversal_order = nullptr;
+  data->sparse_filter.block_map = nullptr;
+  data->sparse_filter.dim_metadata = data->sparse_filter_dim_metadata;
+  data->sparse_filter.dim_metadata_size = block_size == 4 ? 3 : 2;
+  data->has_sparse_filter = true;
+  return kTfLiteOk;
 }
 
 // Naive implementation of transpose for floats. Could be optimized to be more
@@ -168,6 +246,9 @@ bool IsIm2ColRequired(const TfLiteTensor* input, TfLiteConvParams* params,
   // Return early as basic requirement is not met
   if (!need_im2col) return false;
 
+  // The sparse filter kernel always computes the convolution on im2col.
+  if (filter->sparsity != nullptr) return true;
+
   // Special case for Hybrid, as it supports only non-dilated im2col currently
   const bool is_hybrid_non_dilated = is_hybrid && need_non_dilated_im2col;
   const bool is_quantized =
@@ -375,7 +456,13 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) &&
-      !IsDynamicTensor(filter);
+      !IsDynamicTensor(filter) && (filter->sparsity == nullptr);
+
+  if (filter->sparsity != nullptr && !data->has_sparse_filter) {
+    TF_LITE_ENSURE_TYPES_EQ(context, input_type, kTfLiteFloat32);
+    TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_STATUS(PrepareSparseFilter(context, filter, data));
+  }
 
   TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(
       context, node, is_hybrid, data->is_hybrid_per_channel, kernel_type));
@@ -743,6 +830,17 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = params->dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  if (data->has_sparse_filter) {
+    optimized_ops::ConvSparseWeight(
+        data->sparse_filter, op_params, GetTensorShape(input),
+        GetTensorData<float>(input), GetTensorShape(filter),
+        data->sparse_filter_values.data(), GetTensorShape(bias),
+        GetTensorData<float>(bias), GetTensorShape(output),
+        GetTensorData<float>(output), GetTensorShape(im2col),
+        GetTensorData<float>(im2col),
+        CpuBackendContext::GetFromContext(context));
+    return;
+  }
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(op_params, GetTensorShape(input),
@@ -997,20 +1095,26 @@ template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, 0);
 
+  // Types left out of a selective build fall through to the error below.
   switch (input->type) {
     case kTfLiteFloat32:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("CONV_2D", kTfLiteFloat32)) break;
       return EvalImpl<kernel_type, kTfLiteFloat32>(context, node);
     case kTfLiteUInt8:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("CONV_2D", kTfLiteUInt8)) break;
       return EvalImpl<kernel_type, kTfLiteUInt8>(context, node);
     case kTfLiteInt8:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("CONV_2D", kTfLiteInt8)) break;
       return EvalImpl<kernel_type, kTfLiteInt8>(context, node);
     case kTfLiteInt16:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("CONV_2D", kTfLiteInt16)) break;
       return EvalImpl<kernel_type, kTfLiteInt16>(context, node);
     default:
-      TF_LITE_KERNEL_LOG(context, "Type %s not currently supported.",
-                         TfLiteTypeGetName(input->type));
-      return kTfLiteError;
+      break;
   }
+  TF_LITE_KERNEL_LOG(context, "Type %s not currently supported.",
+                     TfLiteTypeGetName(input->type));
+  return kTfLiteError;
 }
 
 }  // namespace conv
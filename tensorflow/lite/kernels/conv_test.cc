@@ -861,6 +861,130 @@ TEST_P(ConvolutionOpTest, SimpleTestFloatWithDilation) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({5, 5, 5, 5, 5, 5, 5, 5, 5}));
 }
 
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input, const TensorData& filter,
+                           const std::vector<float>& filter_data,
+                           int stride_width, int stride_height) {
+    input_ = AddInput(input);
+    filter_ = AddConstSparseInput(filter, filter_data);
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, stride_width,
+                                     stride_height)
+                     .Union());
+
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, SparseFilterFloat32) {
+  TensorData filter = {};
+  filter.type = TensorType_FLOAT32;
+  filter.shape = {3, 2, 2, 1};
+  filter.traversal_order = {0, 1, 2, 3};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  SparseConvolutionOpModel m(GetRegistration(),
+                             {TensorType_FLOAT32, {2, 2, 4, 1}}, filter,
+                             {
+                                 1, 0, 3, 0,    // first 2x2 filter
+                                 0, 0, 0, 0,    // second 2x2 filter
+                                 -1, -1, 1, 1,  // third 2x2 filter
+                             },
+                             /*stride_width=*/2, /*stride_height=*/2);
+
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 1, 2, 3}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 8, 2, 5,   // first batch, left
+                                 8, 2, 5,   // first batch, right
+                                 5, 2, 3,   // second batch, left
+                                 13, 2, 3,  // second batch, right
+                             }));
+}
+
+TEST_P(ConvolutionOpTest, SparseFilterFloat32RandomSparse) {
+  // The filters have 9 values, which can't be split in 1x4 blocks.
+  TensorData filter = {};
+  filter.type = TensorType_FLOAT32;
+  filter.shape = {2, 3, 3, 1};
+  filter.traversal_order = {0, 1, 2, 3};
+  filter.format = {kTfLiteDimDense, kTfLiteDimSparseCSR, kTfLiteDimSparseCSR,
+                   kTfLiteDimSparseCSR};
+  SparseConvolutionOpModel m(GetRegistration(),
+                             {TensorType_FLOAT32, {1, 3, 3, 1}}, filter,
+                             {
+                                 1, 0, 0, 0, 1, 0, 0, 0, 1,   // first filter
+                                 0, 0, 0, 0, 0, 0, 0, 0, -1,  // second filter
+                             },
+                             /*stride_width=*/1, /*stride_height=*/1);
+
+  m.SetInput({1, 2, 3, 4, 5, 6, 7, 8, 9});
+  m.SetBias({0, 10});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 1, 1, 2}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({15, 1}));
+}
+
+TEST_P(ConvolutionOpTest, SparseFilterFloat32BlockSparse1x1) {
+  TensorData filter = {};
+  filter.type = TensorType_FLOAT32;
+  filter.shape = {2, 1, 1, 4};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  SparseConvolutionOpModel m(GetRegistration(),
+                             {TensorType_FLOAT32, {1, 1, 2, 4}}, filter,
+                             {
+                                 1, 1, 1, 1,  // first filter
+                                 0, 0, 0, 0,  // second filter
+                             },
+                             /*stride_width=*/1, /*stride_height=*/1);
+
+  m.SetInput({1, 2, 3, 4, 5, 6, 7, 8});
+  m.SetBias({0, 1});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 1, 2, 2}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({10, 1, 26, 1}));
+}
+
 class QuantizedConvolutionOpModel : public BaseConvolutionOpModel<uint8_t> {
  public:
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
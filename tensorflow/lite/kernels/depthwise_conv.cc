@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/selective_registration.h"
 
 namespace tflite {
 namespace ops {
@@ -549,20 +550,30 @@ template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
 
+  // Types left out of a selective build fall through to the error below.
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("DEPTHWISE_CONV_2D", kTfLiteFloat32))
+        break;
       return EvalImpl<kernel_type, kTfLiteFloat32>(context, node);
     case kTfLiteUInt8:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("DEPTHWISE_CONV_2D", kTfLiteUInt8))
+        break;
       return EvalImpl<kernel_type, kTfLiteUInt8>(context, node);
     case kTfLiteInt8:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("DEPTHWISE_CONV_2D", kTfLiteInt8))
+        break;
       return EvalImpl<kernel_type, kTfLiteInt8>(context, node);
     case kTfLiteInt16:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("DEPTHWISE_CONV_2D", kTfLiteInt16))
+        break;
       return EvalImpl<kernel_type, kTfLiteInt16>(context, node);
     default:
-      context->ReportError(context, "Type %d not currently supported.",
-                           input->type);
-      return kTfLiteError;
+      break;
   }
+  context->ReportError(context, "Type %d not currently supported.",
+                       input->type);
+  return kTfLiteError;
 }
 
 }  // namespace depthwise_conv
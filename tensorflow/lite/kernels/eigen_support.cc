@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <utility>
 
 #include "tensorflow/lite/arena_planner.h"
@@ -97,8 +98,10 @@ class LazyEigenThreadPoolHolder {
     SetNumThreads(num_threads);
   }
 
-  // Gets the ThreadPoolDevice, creating if necessary.
+  // Gets the ThreadPoolDevice, creating if necessary. Thread-safe, as nodes
+  // executed on inter-op threads share the same holder.
   const Eigen::ThreadPoolDevice* GetThreadPoolDevice() {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (!device_) {
       thread_pool_wrapper_.reset(
           new EigenThreadPoolWrapper(target_num_threads_));
@@ -110,6 +113,7 @@ class LazyEigenThreadPoolHolder {
 
   // Updates the thread count, invalidating the ThreadPoolDevice if necessary.
   void SetNumThreads(int num_threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
     const int target_num_threads = GetNumThreads(num_threads);
     if (target_num_threads_ != target_num_threads) {
       target_num_threads_ = target_num_threads;
@@ -120,6 +124,7 @@ class LazyEigenThreadPoolHolder {
   }
 
  private:
+  std::mutex mutex_;
   int target_num_threads_ = kDefaultNumThreadpoolThreads;
   // Both device_ and thread_pool_wrapper_ are lazily created.
   std::unique_ptr<Eigen::ThreadPoolDevice> device_;
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/selective_registration.h"
 
 namespace tflite {
 namespace ops {
@@ -701,11 +702,16 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           : nullptr;
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
+  // Types left out of a selective build fall through to the error below.
   switch (filter->type) {
     case kTfLiteFloat32:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("FULLY_CONNECTED", kTfLiteFloat32))
+        break;
       return EvalFloat<kernel_type>(context, node, params, data, input, filter,
                                     bias, output);
     case kTfLiteUInt8:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("FULLY_CONNECTED", kTfLiteUInt8))
+        break;
       if (params->weights_format ==
           kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8) {
         TfLiteTensor* shuffled_input_workspace =
@@ -723,6 +729,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
       }
     case kTfLiteInt8:
+      if (!TFLITE_SHOULD_REGISTER_OP_TYPE("FULLY_CONNECTED", kTfLiteInt8))
+        break;
       if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
@@ -732,12 +740,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
       }
     default:
-      context->ReportError(context,
-                           "Filter data type %s currently not supported.",
-                           TfLiteTypeGetName(filter->type));
-      return kTfLiteError;
+      break;
   }
-  return kTfLiteOk;
+  context->ReportError(context, "Filter data type %s currently not supported.",
+                       TfLiteTypeGetName(filter->type));
+  return kTfLiteError;
 }
 
 }  // namespace fully_connected
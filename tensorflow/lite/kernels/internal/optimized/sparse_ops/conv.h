@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_CONV_H_
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/im2col_utils.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Float convolution with a sparse filter. The filter is a
+// [output_depth, filter_height * filter_width * input_depth] matrix in one of
+// the sparse formats of FullyConnectedSparseWeight (random sparse, with 2
+// dimensions of metadata) or FullyConnectedSparseWeight1x4 (1x4 block sparse,
+// with 3 dimensions of metadata), and `filter_shape` is its 4D shape.
+inline void ConvSparseWeight(
+    const TfLiteSparsity& sparsity, const ConvParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& filter_shape, const float* filter_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    const RuntimeShape& im2col_shape, float* im2col_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Conv/Sparse");
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  // NB: the float 0.0f value is represented by all zero bytes.
+  const uint8 float_zero_byte = 0x00;
+  const float* gemm_input_data = nullptr;
+  const RuntimeShape* gemm_input_shape = nullptr;
+  const int filter_width = filter_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const bool need_dilated_im2col =
+      params.dilation_width_factor != 1 || params.dilation_height_factor != 1;
+  const bool need_im2col = params.stride_width != 1 ||
+                           params.stride_height != 1 || filter_width != 1 ||
+                           filter_height != 1;
+  if (need_dilated_im2col) {
+    DilatedIm2col(params, float_zero_byte, input_shape, input_data,
+                  filter_shape, output_shape, im2col_data);
+    gemm_input_data = im2col_data;
+    gemm_input_shape = &im2col_shape;
+  } else if (need_im2col) {
+    TFLITE_DCHECK(im2col_data);
+    Im2col(params, filter_height, filter_width, float_zero_byte, input_shape,
+           input_data, im2col_shape, im2col_data);
+    gemm_input_data = im2col_data;
+    gemm_input_shape = &im2col_shape;
+  } else {
+    gemm_input_data = input_data;
+    gemm_input_shape = &input_shape;
+  }
+
+  // The convolution is a fully connected layer on the rows of the im2col
+  // matrix.
+  const int gemm_input_dims = gemm_input_shape->DimensionsCount();
+  const int m = FlatSizeSkipDim(*gemm_input_shape, gemm_input_dims - 1);
+  const int n = output_shape.Dims(3);
+  const int k = gemm_input_shape->Dims(gemm_input_dims - 1);
+  TFLITE_DCHECK_EQ(k, FlatSizeSkipDim(filter_shape, 0));
+
+  FullyConnectedParams fc_params;
+  fc_params.float_activation_min = params.float_activation_min;
+  fc_params.float_activation_max = params.float_activation_max;
+  const RuntimeShape fc_input_shape({m, k});
+  const RuntimeShape fc_weights_shape({n, k});
+  const RuntimeShape fc_output_shape({m, n});
+  if (sparsity.dim_metadata_size == 2) {
+    FullyConnectedSparseWeight(sparsity, fc_params, fc_input_shape,
+                               gemm_input_data, fc_weights_shape, filter_data,
+                               bias_shape, bias_data, fc_output_shape,
+                               output_data);
+  } else {
+    TFLITE_DCHECK_EQ(sparsity.dim_metadata_size, 3);
+    FullyConnectedSparseWeight1x4(sparsity, fc_params, fc_input_shape,
+                                  gemm_input_data, fc_weights_shape,
+                                  filter_data, bias_shape, bias_data,
+                                  fc_output_shape, output_data,
+                                  cpu_backend_context);
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_CONV_H_
@@ -0,0 +1,57 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_SELECTIVE_REGISTRATION_H_
+#define TENSORFLOW_LITE_KERNELS_SELECTIVE_REGISTRATION_H_
+
+// Builtin kernels compiled with TFLITE_SELECTIVE_REGISTRATION defined keep
+// only the tensor type specializations listed by the model-derived header
+// "tflite_ops_to_register.h", so that the linker can discard the others.
+// That header is generated by gen_op_registration_main's --output_op_types
+// flag (see gen_selected_ops in build_def.bzl) and must be on the include
+// path. It defines TFLITE_SHOULD_REGISTER_OP_TYPE(op, type), a constant
+// expression that is true when the builtin `op` is used with `type`.
+//
+// Kernels wrap each type specialization of their dispatch in it:
+//
+//   case kTfLiteFloat32:
+//     if (!TFLITE_SHOULD_REGISTER_OP_TYPE("CONV_2D", kTfLiteFloat32)) break;
+//     return EvalFloat(context, node);
+
+#ifdef TFLITE_SELECTIVE_REGISTRATION
+
+namespace tflite {
+namespace selective_registration {
+
+// Compile-time string comparison for the generated header.
+constexpr inline bool IsEqual(const char* x, const char* y) {
+  return (*x == 0 && *y == 0) || (*x == *y && IsEqual(x + 1, y + 1));
+}
+
+}  // namespace selective_registration
+}  // namespace tflite
+
+#include "tflite_ops_to_register.h"
+
+#ifndef TFLITE_SHOULD_REGISTER_OP_TYPE
+#error "tflite_ops_to_register.h must define TFLITE_SHOULD_REGISTER_OP_TYPE"
+#endif
+
+#else  // TFLITE_SELECTIVE_REGISTRATION
+
+#define TFLITE_SHOULD_REGISTER_OP_TYPE(op, type) true
+
+#endif  // TFLITE_SELECTIVE_REGISTRATION
+
+#endif  // TENSORFLOW_LITE_KERNELS_SELECTIVE_REGISTRATION_H_
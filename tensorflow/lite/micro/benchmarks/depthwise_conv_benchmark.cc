@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
 #include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/micro/testing/test_utils.h"
 
@@ -32,15 +34,14 @@ TfLiteStatus ValidateDepthwiseConvGoldens(TfLiteTensor* tensors,
                                           int tolerance, int output_length,
                                           const int8_t* expected_output_data,
                                           ErrorReporter* reporter) {
-  TfLiteContext context;
-  PopulateContext(tensors, tensors_size, reporter, &context);
-
   const TfLiteRegistration registration =
       ops::micro::Register_DEPTHWISE_CONV_2D();
 
   int input_depth = tensors[0].dims->data[3];
   int output_depth = tensors[1].dims->data[3];
-  TF_LITE_ENSURE(&context, input_depth > 0);
+  if (input_depth <= 0) {
+    return kTfLiteError;
+  }
   int depth_mul = output_depth / input_depth;
   TfLiteDepthwiseConvParams builtin_data;
   builtin_data.padding = kTfLitePaddingValid;
@@ -51,13 +52,6 @@ TfLiteStatus ValidateDepthwiseConvGoldens(TfLiteTensor* tensors,
   builtin_data.dilation_width_factor = 1;
   builtin_data.depth_multiplier = depth_mul;
 
-  const char* init_data = reinterpret_cast<const char*>(&builtin_data);
-  size_t init_data_size = 0;
-  void* user_data = nullptr;
-  if (registration.init) {
-    user_data = registration.init(&context, init_data, init_data_size);
-  }
-
   // For an N element array, the raw array will be {N, Element 1, ... Element N}
   // There are 3 inputs at index 0, 1 and 2 in the tensors array.
   int inputs_array_data[] = {3, 0, 1, 2};
@@ -66,30 +60,16 @@ TfLiteStatus ValidateDepthwiseConvGoldens(TfLiteTensor* tensors,
   int outputs_array_data[] = {1, 3};
   TfLiteIntArray* outputs_array = IntArrayFromInts(outputs_array_data);
 
-  TfLiteNode node;
-  node.inputs = inputs_array;
-  node.outputs = outputs_array;
-  node.user_data = user_data;
-  node.builtin_data = reinterpret_cast<void*>(&builtin_data);
-  node.custom_initial_data = nullptr;
-  node.custom_initial_data_size = 0;
-
-  if (registration.prepare) {
-    TfLiteStatus prepare_status = registration.prepare(&context, &node);
-    if (prepare_status != kTfLiteOk) {
-      return prepare_status;
-    }
-  }
+  micro::KernelRunner runner(registration, tensors, tensors_size, inputs_array,
+                             outputs_array,
+                             reinterpret_cast<void*>(&builtin_data), reporter);
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
 
   int32_t start = tflite::GetCurrentTimeTicks();
-  TfLiteStatus invoke_status = registration.invoke(&context, &node);
+  TfLiteStatus invoke_status = runner.Invoke();
   TF_LITE_REPORT_ERROR(reporter, "invoke took %d cycles\n",
                        tflite::GetCurrentTimeTicks() - start);
 
-  if (registration.free) {
-    registration.free(&context, user_data);
-  }
-
   if (invoke_status != kTfLiteOk) {
     return invoke_status;
   }
@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+
+/*
+ * Benchmark of the int8 FULLY_CONNECTED kernel on its own, so that the cycle
+ * counts of an optimized kernel variant (for example TAGS=cmsis-nn) can be
+ * compared against the reference kernel on the same target.
+ */
+
+namespace {
+
+constexpr int kBatches = 1;
+constexpr int kInputDepth = 256;
+constexpr int kOutputDepth = 64;
+
+int8_t input_data[kBatches * kInputDepth];
+int8_t weights_data[kOutputDepth * kInputDepth];
+int32_t bias_data[kOutputDepth];
+int8_t output_data[kBatches * kOutputDepth];
+
+const int input_shape[] = {2, kBatches, kInputDepth};
+const int weights_shape[] = {2, kOutputDepth, kInputDepth};
+const int bias_shape[] = {1, kOutputDepth};
+const int output_shape[] = {2, kBatches, kOutputDepth};
+
+constexpr int kTensorsSize = 4;
+TfLiteTensor tensors[kTensorsSize];
+int inputs_array_data[] = {3, 0, 1, 2};
+int outputs_array_data[] = {1, 3};
+
+TfLiteFullyConnectedParams builtin_data = {
+    kTfLiteActNone, kTfLiteFullyConnectedWeightsFormatDefault, false, false};
+
+tflite::micro::KernelRunner* kernel_runner = nullptr;
+
+void InitializeFullyConnectedRunner() {
+  for (int i = 0; i < kBatches * kInputDepth; ++i) {
+    input_data[i] = static_cast<int8_t>((i * 7) % 256 - 128);
+  }
+  for (int i = 0; i < kOutputDepth * kInputDepth; ++i) {
+    weights_data[i] = static_cast<int8_t>((i * 25) % 255 - 127);
+  }
+  for (int i = 0; i < kOutputDepth; ++i) {
+    bias_data[i] = i * 100;
+  }
+
+  // The weights are symmetric and the accumulators are scaled by the output
+  // scale back into the int8 range.
+  tensors[0] = tflite::testing::CreateQuantizedTensor(
+      input_data, tflite::testing::IntArrayFromInts(input_shape), 0.5f, -1);
+  tensors[1] = tflite::testing::CreateQuantizedTensor(
+      weights_data, tflite::testing::IntArrayFromInts(weights_shape), 0.25f,
+      0);
+  tensors[2] = tflite::testing::CreateInt32Tensor(
+      bias_data, tflite::testing::IntArrayFromInts(bias_shape));
+  tensors[2].params.scale = 0.5f * 0.25f;
+  tensors[3] = tflite::testing::CreateQuantizedTensor(
+      output_data, tflite::testing::IntArrayFromInts(output_shape), 256.0f, 0);
+
+  // NOLINTNEXTLINE
+  static tflite::micro::KernelRunner runner(
+      tflite::ops::micro::Register_FULLY_CONNECTED(), tensors, kTensorsSize,
+      tflite::testing::IntArrayFromInts(inputs_array_data),
+      tflite::testing::IntArrayFromInts(outputs_array_data), &builtin_data,
+      micro_benchmark::reporter);
+  kernel_runner = &runner;
+  if (kernel_runner->InitAndPrepare() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(micro_benchmark::reporter, "Prepare failed.");
+  }
+}
+
+// This method assumes InitializeFullyConnectedRunner has already been run.
+void FullyConnectedRunNIterations(int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    if (kernel_runner->Invoke() != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(micro_benchmark::reporter, "Invoke failed.");
+    }
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+TF_LITE_MICRO_BENCHMARK(InitializeFullyConnectedRunner());
+
+TF_LITE_MICRO_BENCHMARK(FullyConnectedRunNIterations(1));
+
+TF_LITE_MICRO_BENCHMARK(FullyConnectedRunNIterations(10));
+
+TF_LITE_MICRO_BENCHMARKS_END
@@ -0,0 +1,137 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+
+/*
+ * Benchmark of the int8 AVERAGE_POOL_2D and MAX_POOL_2D kernels on their own,
+ * so that the cycle counts of an optimized kernel variant (for example
+ * TAGS=cmsis-nn) can be compared against the reference kernels on the same
+ * target.
+ */
+
+namespace {
+
+constexpr int kInputHeight = 32;
+constexpr int kInputWidth = 32;
+constexpr int kDepth = 16;
+constexpr int kFilterSize = 3;
+constexpr int kStride = 2;
+constexpr int kOutputHeight = (kInputHeight - kFilterSize) / kStride + 1;
+constexpr int kOutputWidth = (kInputWidth - kFilterSize) / kStride + 1;
+
+int8_t input_data[kInputHeight * kInputWidth * kDepth];
+int8_t average_pool_output_data[kOutputHeight * kOutputWidth * kDepth];
+int8_t max_pool_output_data[kOutputHeight * kOutputWidth * kDepth];
+
+const int input_shape[] = {4, 1, kInputHeight, kInputWidth, kDepth};
+const int output_shape[] = {4, 1, kOutputHeight, kOutputWidth, kDepth};
+
+constexpr int kTensorsSize = 2;
+TfLiteTensor average_pool_tensors[kTensorsSize];
+TfLiteTensor max_pool_tensors[kTensorsSize];
+int inputs_array_data[] = {1, 0};
+int outputs_array_data[] = {1, 1};
+
+TfLitePoolParams builtin_data = {kTfLitePaddingValid,
+                                 kStride,
+                                 kStride,
+                                 kFilterSize,
+                                 kFilterSize,
+                                 kTfLiteActNone,
+                                 {}};
+
+tflite::micro::KernelRunner* average_pool_runner = nullptr;
+tflite::micro::KernelRunner* max_pool_runner = nullptr;
+
+// Pooling requires the input and output to share their quantization.
+constexpr float kScale = 0.5f;
+constexpr int kZeroPoint = -1;
+
+void InitializeTensors(int8_t* output, TfLiteTensor* tensors) {
+  tensors[0] = tflite::testing::CreateQuantizedTensor(
+      input_data, tflite::testing::IntArrayFromInts(input_shape), kScale,
+      kZeroPoint);
+  tensors[1] = tflite::testing::CreateQuantizedTensor(
+      output, tflite::testing::IntArrayFromInts(output_shape), kScale,
+      kZeroPoint);
+}
+
+void InitializePoolingRunners() {
+  for (int i = 0; i < kInputHeight * kInputWidth * kDepth; ++i) {
+    input_data[i] = static_cast<int8_t>((i * 7) % 256 - 128);
+  }
+  InitializeTensors(average_pool_output_data, average_pool_tensors);
+  InitializeTensors(max_pool_output_data, max_pool_tensors);
+
+  // NOLINTNEXTLINE
+  static tflite::micro::KernelRunner average_pool(
+      tflite::ops::micro::Register_AVERAGE_POOL_2D(), average_pool_tensors,
+      kTensorsSize, tflite::testing::IntArrayFromInts(inputs_array_data),
+      tflite::testing::IntArrayFromInts(outputs_array_data), &builtin_data,
+      micro_benchmark::reporter);
+  // NOLINTNEXTLINE
+  static tflite::micro::KernelRunner max_pool(
+      tflite::ops::micro::Register_MAX_POOL_2D(), max_pool_tensors,
+      kTensorsSize, tflite::testing::IntArrayFromInts(inputs_array_data),
+      tflite::testing::IntArrayFromInts(outputs_array_data), &builtin_data,
+      micro_benchmark::reporter);
+  average_pool_runner = &average_pool;
+  max_pool_runner = &max_pool;
+  if (average_pool_runner->InitAndPrepare() != kTfLiteOk ||
+      max_pool_runner->InitAndPrepare() != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(micro_benchmark::reporter, "Prepare failed.");
+  }
+}
+
+// These methods assume InitializePoolingRunners has already been run.
+void RunNIterations(tflite::micro::KernelRunner* runner, int iterations) {
+  for (int i = 0; i < iterations; ++i) {
+    if (runner->Invoke() != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(micro_benchmark::reporter, "Invoke failed.");
+    }
+  }
+}
+
+void AveragePoolRunNIterations(int iterations) {
+  RunNIterations(average_pool_runner, iterations);
+}
+
+void MaxPoolRunNIterations(int iterations) {
+  RunNIterations(max_pool_runner, iterations);
+}
+
+}  // namespace
+
+TF_LITE_MICRO_BENCHMARKS_BEGIN
+
+TF_LITE_MICRO_BENCHMARK(InitializePoolingRunners());
+
+TF_LITE_MICRO_BENCHMARK(AveragePoolRunNIterations(1));
+
+TF_LITE_MICRO_BENCHMARK(AveragePoolRunNIterations(10));
+
+TF_LITE_MICRO_BENCHMARK(MaxPoolRunNIterations(1));
+
+TF_LITE_MICRO_BENCHMARK(MaxPoolRunNIterations(10));
+
+TF_LITE_MICRO_BENCHMARKS_END
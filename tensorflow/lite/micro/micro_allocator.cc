@@ -1021,6 +1021,12 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
     SimpleMemoryAllocator tmp_allocator(error_reporter_,
                                         memory_allocator_->GetBufferHead(),
                                         memory_allocator_->GetTail());
+    // The plan is committed from the start of the head, so the space it can use
+    // is measured from there rather than from the current head watermark. When
+    // several models share this allocator, the head left behind by an earlier
+    // model is reused and may be grown by a model needing more of it.
+    const size_t actual_available_arena_size =
+        tmp_allocator.GetAvailableMemory(kBufferAlignment);
 
     AllocationInfoBuilder builder(error_reporter_, &tmp_allocator);
     TF_LITE_ENSURE_STATUS(
@@ -1044,9 +1050,6 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
     TF_LITE_ENSURE_STATUS(
         CreatePlan(error_reporter_, &planner, allocation_info, builder.Size()));
 
-    size_t actual_available_arena_size =
-        memory_allocator_->GetAvailableMemory(kBufferAlignment);
-
     // Make sure we have enough arena size.
     if (planner.GetMaximumMemorySize() > actual_available_arena_size) {
       TF_LITE_REPORT_ERROR(
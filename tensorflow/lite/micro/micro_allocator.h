@@ -90,6 +90,14 @@ typedef struct {
 //                                               - ->GetDataSize()
 // persistent area (tail)
 // ************** .memory_allocator->GetBuffer() + ->GetMaxBufferSize()
+//
+// More than one model can be allocated from the same instance, one after the
+// other. Each model keeps its own persistent allocations in the tail, while the
+// head is shared: every memory plan starts at the beginning of the head, which
+// grows to the largest plan seen so far rather than to the sum of the plans.
+// Interpreters sharing an allocator must therefore not be invoked
+// concurrently, and the contents of non-persistent tensors (including inputs
+// and outputs) are only valid until another of the models is invoked.
 class MicroAllocator {
  public:
   // Creates a MicroAllocator instance from a given tensor arena. This arena
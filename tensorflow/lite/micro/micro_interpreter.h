@@ -99,7 +99,9 @@ class MicroInterpreter {
   // This constructor should be used when creating an allocator that needs to
   // have allocation handled in more than one interpreter or for recording
   // allocations inside the interpreter. The lifetime of the allocator must be
-  // as long as that of the interpreter object.
+  // as long as that of the interpreter object. Interpreters sharing an
+  // allocator reuse the same non-persistent memory and must be invoked one at
+  // a time, see MicroAllocator for details.
   MicroInterpreter(const Model* model, const MicroOpResolver& op_resolver,
                    MicroAllocator* allocator, ErrorReporter* error_reporter,
                    tflite::Profiler* profiler = nullptr);
@@ -214,6 +214,72 @@ TF_LITE_MICRO_TEST(TestMultiTenantInterpreter) {
       allocator->GetSimpleMemoryAllocator()->GetHeadUsedBytes());
 }
 
+TF_LITE_MICRO_TEST(TestMultiTenantInterpreterGrowsSharedHead) {
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+  constexpr size_t arena_size = 8192;
+  uint8_t arena[arena_size];
+
+  size_t simple_model_head_usage = 0, complex_model_head_usage = 0;
+  {
+    tflite::RecordingMicroAllocator* allocator =
+        tflite::RecordingMicroAllocator::Create(arena, arena_size,
+                                                micro_test::reporter);
+    tflite::MicroInterpreter interpreter(tflite::testing::GetSimpleMockModel(),
+                                         op_resolver, allocator,
+                                         micro_test::reporter);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+    simple_model_head_usage =
+        allocator->GetSimpleMemoryAllocator()->GetHeadUsedBytes();
+  }
+  {
+    tflite::RecordingMicroAllocator* allocator =
+        tflite::RecordingMicroAllocator::Create(arena, arena_size,
+                                                micro_test::reporter);
+    tflite::MicroInterpreter interpreter(
+        tflite::testing::GetComplexMockModel(), op_resolver, allocator,
+        micro_test::reporter);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+    complex_model_head_usage =
+        allocator->GetSimpleMemoryAllocator()->GetHeadUsedBytes();
+  }
+
+  // Allocate the simple model first, so that the complex model allocated next
+  // from the same `allocator` has to grow the head left behind by it.
+  tflite::RecordingMicroAllocator* allocator =
+      tflite::RecordingMicroAllocator::Create(arena, arena_size,
+                                              micro_test::reporter);
+  tflite::MicroInterpreter interpreter1(tflite::testing::GetSimpleMockModel(),
+                                        op_resolver, allocator,
+                                        micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.AllocateTensors());
+  tflite::MicroInterpreter interpreter2(
+      tflite::testing::GetComplexMockModel(), op_resolver, allocator,
+      micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.AllocateTensors());
+
+  // The shared head is as large as the largest of the two plans.
+  const size_t expected_head_usage =
+      simple_model_head_usage > complex_model_head_usage
+          ? simple_model_head_usage
+          : complex_model_head_usage;
+  TF_LITE_MICRO_EXPECT_EQ(
+      expected_head_usage,
+      allocator->GetSimpleMemoryAllocator()->GetHeadUsedBytes());
+
+  // Both models still produce correct results when invoked one at a time.
+  interpreter1.input(0)->data.i32[0] = 21;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(42, interpreter1.output(0)->data.i32[0]);
+
+  interpreter2.input(0)->data.i32[0] = 10;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter2.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(10, interpreter2.output(0)->data.i32[0]);
+
+  interpreter1.input(0)->data.i32[0] = 4;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter1.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(25, interpreter1.output(0)->data.i32[0]);
+}
+
 TF_LITE_MICRO_TEST(TestKernelMemoryPlanning) {
   const tflite::Model* model = tflite::testing::GetSimpleStatefulModel();
   TF_LITE_MICRO_EXPECT_NE(nullptr, model);
@@ -105,6 +105,13 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Records hardware counters for operator invoke events. Pass null to stop
+  // recording them. The counters must outlive the profiler.
+  void SetHardwareCounters(
+      const hardware::PerfEventCounters* hardware_counters) {
+    buffer_.SetHardwareCounters(hardware_counters);
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -0,0 +1,116 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+#ifdef __linux__
+namespace {
+
+int OpenPerfEvent(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Only the leader is disabled, which starts and stops the whole group.
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+}  // namespace
+#endif
+
+bool PerfEventCounters::IsSupported() {
+#ifdef __linux__
+  return true;
+#endif
+  return false;
+}
+
+std::unique_ptr<PerfEventCounters> PerfEventCounters::Create() {
+#ifdef __linux__
+  std::unique_ptr<PerfEventCounters> counters(new PerfEventCounters);
+  const std::pair<uint64_t, int64_t HardwareCounters::*> kEvents[] = {
+      {PERF_COUNT_HW_CPU_CYCLES, &HardwareCounters::cpu_cycles},
+      {PERF_COUNT_HW_INSTRUCTIONS, &HardwareCounters::instructions},
+      {PERF_COUNT_HW_CACHE_REFERENCES, &HardwareCounters::cache_references},
+      {PERF_COUNT_HW_CACHE_MISSES, &HardwareCounters::cache_misses},
+  };
+  for (const auto& event : kEvents) {
+    // Events the PMU doesn't provide are skipped and read as 0.
+    const int fd = OpenPerfEvent(event.first, counters->group_fd_);
+    if (fd == -1) continue;
+    if (counters->group_fd_ == -1) counters->group_fd_ = fd;
+    counters->events_.emplace_back(fd, event.second);
+  }
+  if (counters->group_fd_ == -1) return nullptr;
+  ioctl(counters->group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  if (ioctl(counters->group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) ==
+      -1) {
+    return nullptr;
+  }
+  return counters;
+#else
+  return nullptr;
+#endif
+}
+
+PerfEventCounters::~PerfEventCounters() {
+#ifdef __linux__
+  // Close the leader last.
+  for (auto it = events_.rbegin(); it != events_.rend(); ++it) {
+    close(it->first);
+  }
+#endif
+}
+
+bool PerfEventCounters::Read(HardwareCounters* counters) const {
+#ifdef __linux__
+  // With PERF_FORMAT_GROUP the leader reads the number of events followed by
+  // the value of each of them.
+  uint64_t values[1 + 4];
+  const size_t size = (1 + events_.size()) * sizeof(uint64_t);
+  if (read(group_fd_, values, size) != static_cast<ssize_t>(size) ||
+      values[0] != events_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < events_.size(); ++i) {
+    counters->*(events_[i].second) = static_cast<int64_t>(values[1 + i]);
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,93 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+// Size of the cache line assumed when estimating memory traffic from last
+// level cache misses.
+constexpr int kCacheLineBytes = 64;
+
+// Values of the hardware performance counters of the calling thread. Counters
+// that can't be read on the platform stay 0.
+struct HardwareCounters {
+  int64_t cpu_cycles = 0;
+  int64_t instructions = 0;
+  // Accesses to and misses in the last level cache.
+  int64_t cache_references = 0;
+  int64_t cache_misses = 0;
+
+  HardwareCounters operator+(HardwareCounters const& obj) const {
+    HardwareCounters res;
+    res.cpu_cycles = cpu_cycles + obj.cpu_cycles;
+    res.instructions = instructions + obj.instructions;
+    res.cache_references = cache_references + obj.cache_references;
+    res.cache_misses = cache_misses + obj.cache_misses;
+    return res;
+  }
+
+  HardwareCounters operator-(HardwareCounters const& obj) const {
+    HardwareCounters res;
+    res.cpu_cycles = cpu_cycles - obj.cpu_cycles;
+    res.instructions = instructions - obj.instructions;
+    res.cache_references = cache_references - obj.cache_references;
+    res.cache_misses = cache_misses - obj.cache_misses;
+    return res;
+  }
+};
+
+// Reads hardware counters through Linux perf events. The counters only count
+// the thread that created the reader, so work done by the threads of a CPU
+// backend thread pool is not included; profile with a single thread to get
+// complete numbers for an op.
+class PerfEventCounters {
+ public:
+  // Indicates whether perf events are available on the platform at all.
+  static bool IsSupported();
+
+  // Opens the counters for the calling thread. Returns nullptr if none of them
+  // can be opened, e.g. when perf events are disabled by
+  // /proc/sys/kernel/perf_event_paranoid or not virtualized.
+  static std::unique_ptr<PerfEventCounters> Create();
+
+  ~PerfEventCounters();
+
+  // Reads the current value of the counters. Returns false if the counters
+  // could not be read, in which case `counters` is left unchanged.
+  bool Read(HardwareCounters* counters) const;
+
+ private:
+  PerfEventCounters() {}
+
+  // File descriptor of the group leader, which reads all counters at once.
+  int group_fd_ = -1;
+  // All opened file descriptors, and the field each of them is read into, in
+  // the order they were added to the group.
+  std::vector<std::pair<int, int64_t HardwareCounters::*>> events_;
+};
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
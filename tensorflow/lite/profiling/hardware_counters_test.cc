@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+TEST(HardwareCounters, AddAndSub) {
+  HardwareCounters counters1, counters2;
+  counters1.cpu_cycles = 500;
+  counters1.instructions = 700;
+  counters1.cache_references = 20;
+  counters1.cache_misses = 3;
+
+  counters2.cpu_cycles = 300;
+  counters2.instructions = 700;
+  counters2.cache_references = 40;
+  counters2.cache_misses = 1;
+
+  const auto add_counters = counters1 + counters2;
+  EXPECT_EQ(800, add_counters.cpu_cycles);
+  EXPECT_EQ(1400, add_counters.instructions);
+  EXPECT_EQ(60, add_counters.cache_references);
+  EXPECT_EQ(4, add_counters.cache_misses);
+
+  const auto sub_counters = counters1 - counters2;
+  EXPECT_EQ(200, sub_counters.cpu_cycles);
+  EXPECT_EQ(0, sub_counters.instructions);
+  EXPECT_EQ(-20, sub_counters.cache_references);
+  EXPECT_EQ(2, sub_counters.cache_misses);
+}
+
+TEST(PerfEventCounters, Read) {
+#ifdef __linux__
+  EXPECT_TRUE(PerfEventCounters::IsSupported());
+#else
+  EXPECT_FALSE(PerfEventCounters::IsSupported());
+#endif
+  // Perf events may be disabled, e.g. in containers or virtual machines.
+  auto perf_counters = PerfEventCounters::Create();
+  if (perf_counters == nullptr) return;
+
+  HardwareCounters begin, end;
+  ASSERT_TRUE(perf_counters->Read(&begin));
+  volatile int sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  ASSERT_TRUE(perf_counters->Read(&end));
+  const auto delta = end - begin;
+  EXPECT_GE(delta.cpu_cycles, 0);
+  EXPECT_GE(delta.instructions, 0);
+  EXPECT_GE(delta.cache_references, 0);
+  EXPECT_GE(delta.cache_misses, 0);
+}
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 
@@ -48,6 +49,15 @@ struct ProfileEvent {
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
 
+  // Whether the hardware counters below were recorded for this event. They
+  // are only recorded for OPERATOR_INVOKE_EVENTs, and only if the buffer has
+  // hardware counters set.
+  bool has_hardware_counters;
+  // The hardware counters when the event begins.
+  hardware::HardwareCounters begin_hw_counters;
+  // The hardware counters when the event ends.
+  hardware::HardwareCounters end_hw_counters;
+
   // The field containing the type of event. This must be one of the event types
   // in EventType.
   EventType event_type;
@@ -63,7 +73,10 @@ struct ProfileEvent {
 class ProfileBuffer {
  public:
   ProfileBuffer(uint32_t max_num_entries, bool enabled)
-      : enabled_(enabled), current_index_(0), event_buffer_(max_num_entries) {}
+      : enabled_(enabled),
+        current_index_(0),
+        event_buffer_(max_num_entries),
+        hardware_counters_(nullptr) {}
 
   // Adds an event to the buffer with begin timestamp set to the current
   // timestamp. Returns a handle to event that can be used to call EndEvent. If
@@ -89,6 +102,12 @@ class ProfileBuffer {
     if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
     }
+    // Read the counters last so that they cover as little of the bookkeeping
+    // above as possible.
+    event_buffer_[index].has_hardware_counters =
+        hardware_counters_ != nullptr &&
+        event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+        hardware_counters_->Read(&event_buffer_[index].begin_hw_counters);
     current_index_++;
     return index;
   }
@@ -96,6 +115,14 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Sets the counters read at the beginning and end of operator invoke
+  // events, or disables reading them if |hardware_counters| is null. The
+  // counters must outlive the buffer.
+  void SetHardwareCounters(
+      const hardware::PerfEventCounters* hardware_counters) {
+    hardware_counters_ = hardware_counters;
+  }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -113,6 +140,11 @@ class ProfileBuffer {
     }
 
     int event_index = event_handle % max_size;
+    if (event_buffer_[event_index].has_hardware_counters) {
+      event_buffer_[event_index].has_hardware_counters =
+          hardware_counters_ != nullptr &&
+          hardware_counters_->Read(&event_buffer_[event_index].end_hw_counters);
+    }
     event_buffer_[event_index].end_timestamp_us = time::NowMicros();
     if (event_buffer_[event_index].event_type !=
         Profiler::EventType::OPERATOR_INVOKE_EVENT) {
@@ -143,6 +175,7 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = start;
     event_buffer_[index].end_timestamp_us = end;
+    event_buffer_[index].has_hardware_counters = false;
     current_index_++;
   }
 
@@ -177,6 +210,7 @@ class ProfileBuffer {
   bool enabled_;
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
+  const hardware::PerfEventCounters* hardware_counters_;
 };
 
 }  // namespace profiling
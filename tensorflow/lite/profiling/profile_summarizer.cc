@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <sstream>
+#include <utility>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -156,6 +157,25 @@ void ProfileSummarizer::ProcessProfiles(
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, start_us, node_exec_time,
                                      0 /*memory */);
+      if (event->has_hardware_counters) {
+        const auto key = std::make_pair(static_cast<uint32_t>(subgraph_index),
+                                        node_name_in_stats);
+        auto it = op_hardware_counters_index_.find(key);
+        if (it == op_hardware_counters_index_.end()) {
+          it = op_hardware_counters_index_
+                   .emplace(key, op_hardware_counters_.size())
+                   .first;
+          op_hardware_counters_.emplace_back();
+          op_hardware_counters_.back().node_name = node_name_in_stats;
+          op_hardware_counters_.back().node_type = type_in_stats;
+        }
+        OperatorHardwareCounters& op_counters =
+            op_hardware_counters_[it->second];
+        ++op_counters.run_count;
+        op_counters.total_time_us += node_exec_time;
+        op_counters.total = op_counters.total + (event->end_hw_counters -
+                                                 event->begin_hw_counters);
+      }
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
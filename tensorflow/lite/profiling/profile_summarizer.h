@@ -17,7 +17,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_PROFILE_SUMMARIZER_H_
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
@@ -41,10 +43,12 @@ class ProfileSummarizer {
                        const tflite::Interpreter& interpreter);
 
   // Returns a string detailing the accumulated runtime stats in the format of
-  // summary_formatter_.
+  // summary_formatter_. Hardware counters of the operators, if any were
+  // recorded, follow the runtime stats.
   std::string GetOutputString() {
     return summary_formatter_->GetOutputString(stats_calculator_map_,
-                                               *delegate_stats_calculator_);
+                                               *delegate_stats_calculator_) +
+           summary_formatter_->GetHardwareCounterString(op_hardware_counters_);
   }
 
   std::string GetShortSummary() {
@@ -69,6 +73,12 @@ class ProfileSummarizer {
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // Hardware counters per operator in the order operators were first seen,
+  // and the index of each operator in it, keyed by subgraph and node name.
+  std::vector<OperatorHardwareCounters> op_hardware_counters_;
+  std::map<std::pair<uint32_t, std::string>, size_t>
+      op_hardware_counters_index_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <vector>
 
 namespace tflite {
 namespace profiling {
@@ -76,6 +80,77 @@ std::string ProfileSummaryDefaultFormatter::GenerateReport(
   return stream.str();
 }
 
+std::string ProfileSummaryDefaultFormatter::GetHardwareCounterString(
+    const std::vector<OperatorHardwareCounters>& op_counters) const {
+  std::vector<const OperatorHardwareCounters*> sorted_counters;
+  for (const auto& counters : op_counters) {
+    if (counters.run_count > 0) sorted_counters.push_back(&counters);
+  }
+  if (sorted_counters.empty()) return "";
+  // Most expensive ops first.
+  std::stable_sort(sorted_counters.begin(), sorted_counters.end(),
+                   [](const OperatorHardwareCounters* a,
+                      const OperatorHardwareCounters* b) {
+                     return a->total.cpu_cycles > b->total.cpu_cycles;
+                   });
+
+  const bool format_as_csv = GetStatSummarizerOptions().format_as_csv;
+  const std::vector<int> widths = {24, 10, 14, 14, 8, 12, 12, 10, 10, 0};
+  std::stringstream stream;
+  auto write_row = [&stream, &widths,
+                    format_as_csv](const std::vector<std::string>& row) {
+    for (size_t i = 0; i < row.size(); ++i) {
+      if (format_as_csv) {
+        stream << (i == 0 ? "" : ",") << row[i];
+      } else {
+        stream << "\t" << std::right << std::setw(widths[i]) << row[i];
+      }
+    }
+    stream << std::endl;
+  };
+  auto to_string = [](double value, int precision) {
+    std::stringstream value_stream;
+    value_stream << std::fixed << std::setprecision(precision) << value;
+    return value_stream.str();
+  };
+
+  stream << "============================== Hardware counters per op "
+            "=============================="
+         << std::endl;
+  write_row({"[node type]", "[avg ms]", "[cycles]", "[instructions]", "[IPC]",
+             "[LLC refs]", "[LLC misses]", "[MPKI]", "[est. GB/s]",
+             "[Name]"});
+  for (const auto* counters : sorted_counters) {
+    const double runs = counters->run_count;
+    const auto& total = counters->total;
+    // Instructions per cycle, and last level cache misses per thousand
+    // instructions: a low IPC with a high MPKI suggests a memory-bound op.
+    const double ipc =
+        total.cpu_cycles > 0
+            ? static_cast<double>(total.instructions) / total.cpu_cycles
+            : 0.0;
+    const double mpki = total.instructions > 0
+                            ? 1000.0 * total.cache_misses / total.instructions
+                            : 0.0;
+    // Each miss is assumed to read one cache line from memory, which ignores
+    // prefetches and write-backs.
+    const double bytes_from_memory =
+        static_cast<double>(total.cache_misses) * hardware::kCacheLineBytes;
+    const double est_gb_per_s =
+        counters->total_time_us > 0
+            ? bytes_from_memory / (counters->total_time_us * 1000.0)
+            : 0.0;
+    write_row({counters->node_type,
+               to_string(counters->total_time_us / runs / 1000.0, 3),
+               to_string(total.cpu_cycles / runs, 0),
+               to_string(total.instructions / runs, 0), to_string(ipc, 3),
+               to_string(total.cache_references / runs, 0),
+               to_string(total.cache_misses / runs, 0), to_string(mpki, 3),
+               to_string(est_gb_per_s, 3), counters->node_name});
+  }
+  return stream.str();
+}
+
 tensorflow::StatSummarizerOptions
 ProfileSummaryDefaultFormatter::GetStatSummarizerOptions() const {
   auto options = tensorflow::StatSummarizerOptions();
@@ -23,10 +23,20 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 
 namespace tflite {
 namespace profiling {
 
+// Hardware counters of one operator, accumulated over all of its invocations.
+struct OperatorHardwareCounters {
+  std::string node_name;
+  std::string node_type;
+  int64_t run_count = 0;
+  int64_t total_time_us = 0;
+  hardware::HardwareCounters total;
+};
+
 // Formats the profile summary in a certain way.
 class ProfileSummaryFormatter {
  public:
@@ -46,6 +56,12 @@ class ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator) const = 0;
   virtual tensorflow::StatSummarizerOptions GetStatSummarizerOptions()
       const = 0;
+  // Returns a string detailing the hardware counters of the operators, or an
+  // empty string if there are none.
+  virtual std::string GetHardwareCounterString(
+      const std::vector<OperatorHardwareCounters>& op_counters) const {
+    return "";
+  }
 };
 
 class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
@@ -63,6 +79,8 @@ class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator)
       const override;
   tensorflow::StatSummarizerOptions GetStatSummarizerOptions() const override;
+  std::string GetHardwareCounterString(
+      const std::vector<OperatorHardwareCounters>& op_counters) const override;
 
  private:
   std::string GenerateReport(
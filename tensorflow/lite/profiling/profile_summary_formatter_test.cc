@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -152,6 +153,43 @@ TEST(SummaryWriterTest, DelegationShortSummary) {
   ASSERT_TRUE(output.find("Delegate internal") != std::string::npos);
 }
 
+TEST(SummaryWriterTest, EmptyHardwareCounterString) {
+  ProfileSummaryDefaultFormatter writer;
+  EXPECT_EQ(writer.GetHardwareCounterString({}), "");
+}
+
+TEST(SummaryWriterTest, HardwareCounterString) {
+  std::vector<OperatorHardwareCounters> op_counters(2);
+  op_counters[0].node_name = "[output]:0";
+  op_counters[0].node_type = "ADD";
+  op_counters[0].run_count = 2;
+  op_counters[0].total_time_us = 4;
+  op_counters[0].total.cpu_cycles = 1000;
+  op_counters[0].total.instructions = 2000;
+  op_counters[0].total.cache_misses = 4;
+  op_counters[1].node_name = "[conv_output]:1";
+  op_counters[1].node_type = "CONV_2D";
+  op_counters[1].run_count = 2;
+  op_counters[1].total_time_us = 8;
+  op_counters[1].total.cpu_cycles = 4000;
+  op_counters[1].total.instructions = 4000;
+
+  ProfileSummaryDefaultFormatter writer;
+  std::string output = writer.GetHardwareCounterString(op_counters);
+  EXPECT_NE(output.find("Hardware counters per op"), std::string::npos);
+  // Sorted by cycles.
+  EXPECT_LT(output.find("CONV_2D"), output.find("ADD"));
+  // IPC of ADD.
+  EXPECT_NE(output.find("2.000"), std::string::npos);
+
+  ProfileSummaryCSVFormatter csv_writer;
+  output = csv_writer.GetHardwareCounterString(op_counters);
+  // 2 misses of 64 bytes per 2us is 0.064 GB/s.
+  EXPECT_NE(output.find("ADD,0.002,500,1000,2.000,0,2,2.000,0.064,[output]:0"),
+            std::string::npos)
+      << output;
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
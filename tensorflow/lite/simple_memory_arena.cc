@@ -75,13 +75,47 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   // Update the required buffer size.
   high_water_mark_ = std::max(high_water_mark_, best_offset + size);
   new_alloc->offset = best_offset;
+  InsertAlloc(*new_alloc);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SimpleMemoryArena::AllocateAt(
+    TfLiteContext* context, size_t alignment, size_t offset, size_t size,
+    int32_t tensor, int32_t first_node, int32_t last_node,
+    ArenaAllocWithUsageInterval* new_alloc) {
+  TF_LITE_ENSURE(context, alignment <= arena_alignment_);
+  if (size == 0 || offset % alignment != 0) {
+    return Allocate(context, alignment, size, tensor, first_node, last_node,
+                    new_alloc);
+  }
+  for (const auto& alloc : ordered_allocs_) {
+    if (alloc.last_node < first_node || alloc.first_node > last_node) {
+      continue;
+    }
+    if (alloc.offset < offset + size && offset < alloc.offset + alloc.size) {
+      // The requested offset is taken, e.g. because the tensor grew since the
+      // offsets were planned.
+      return Allocate(context, alignment, size, tensor, first_node, last_node,
+                      new_alloc);
+    }
+  }
+
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  new_alloc->offset = offset;
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  InsertAlloc(*new_alloc);
+  return kTfLiteOk;
+}
 
+void SimpleMemoryArena::InsertAlloc(const ArenaAllocWithUsageInterval& alloc) {
   auto insertion_it = ordered_allocs_.begin();
-  while (insertion_it != ordered_allocs_.end() && *insertion_it < *new_alloc) {
+  while (insertion_it != ordered_allocs_.end() && *insertion_it < alloc) {
     ++insertion_it;
   }
-  ordered_allocs_.insert(insertion_it, *new_alloc);
-  return kTfLiteOk;
+  ordered_allocs_.insert(insertion_it, alloc);
 }
 
 TfLiteStatus SimpleMemoryArena::Deallocate(
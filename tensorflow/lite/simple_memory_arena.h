@@ -73,6 +73,14 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Like Allocate(), but places the allocation at the given offset if that
+  // doesn't overlap with any allocation used between first_node and
+  // last_node. Otherwise, falls back to Allocate().
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t alignment,
+                          size_t offset, size_t size, int32_t tensor,
+                          int32_t first_node, int32_t last_node,
+                          ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
@@ -106,6 +114,9 @@ class SimpleMemoryArena {
   }
 
  private:
+  // Adds `alloc` to `ordered_allocs_`, keeping it sorted by offset.
+  void InsertAlloc(const ArenaAllocWithUsageInterval& alloc);
+
   bool committed_;
   size_t arena_alignment_;
   size_t high_water_mark_;
@@ -44,6 +44,30 @@ TEST(SimpleMemoryArenaTest, BasicArenaOperations) {
   EXPECT_EQ(allocs[5].offset, 2048);
 }
 
+TEST(SimpleMemoryArenaTest, AllocateAtOffset) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[4];
+
+  ASSERT_EQ(arena.AllocateAt(&context, 32, 4096, 2047, 0, 1, 3, &allocs[0]),
+            kTfLiteOk);
+  // Overlaps with the first alloc, so goes into the first gap that fits.
+  ASSERT_EQ(arena.AllocateAt(&context, 32, 4096, 1023, 1, 2, 5, &allocs[1]),
+            kTfLiteOk);
+  // The first alloc isn't used anymore by node 4.
+  ASSERT_EQ(arena.AllocateAt(&context, 32, 4096, 2047, 2, 4, 6, &allocs[2]),
+            kTfLiteOk);
+  // Misaligned offsets are ignored.
+  ASSERT_EQ(arena.AllocateAt(&context, 32, 8200, 1023, 3, 5, 6, &allocs[3]),
+            kTfLiteOk);
+
+  EXPECT_EQ(allocs[0].offset, 4096);
+  EXPECT_EQ(allocs[1].offset, 0);
+  EXPECT_EQ(allocs[2].offset, 4096);
+  EXPECT_EQ(allocs[3].offset, 1024);
+  EXPECT_EQ(arena.RequiredBufferSize(), 64 + 4096 + 2047 + 64);
+}
+
 TEST(SimpleMemoryArenaTest, BasicZeroAlloc) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
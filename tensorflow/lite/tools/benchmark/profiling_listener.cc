@@ -25,7 +25,8 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_entries,
     const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    bool enable_hardware_counters)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
@@ -33,6 +34,15 @@ ProfilingListener::ProfilingListener(
       profiler_(max_num_entries) {
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
+  if (enable_hardware_counters) {
+    hardware_counters_ = profiling::hardware::PerfEventCounters::Create();
+    if (hardware_counters_) {
+      profiler_.SetHardwareCounters(hardware_counters_.get());
+    } else {
+      TFLITE_LOG(WARN) << "Hardware counters are not available, only "
+                          "operator timings will be reported.";
+    }
+  }
 
   // We start profiling here in order to catch events that are recorded during
   // the benchmark run preparation stage where TFLite interpreter is
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -33,7 +34,8 @@ class ProfilingListener : public BenchmarkListener {
       Interpreter* interpreter, uint32_t max_num_entries,
       const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      bool enable_hardware_counters = false);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -52,6 +54,9 @@ class ProfilingListener : public BenchmarkListener {
   void WriteOutput(const std::string& header, const string& data,
                    std::ostream* stream);
   Interpreter* interpreter_;
+  // Counters of the thread running the benchmark, or null if they are not
+  // enabled or not available.
+  std::unique_ptr<profiling::hardware::PerfEventCounters> hardware_counters_;
   profiling::BufferedProfiler profiler_;
 };
 
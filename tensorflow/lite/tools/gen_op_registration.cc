@@ -18,9 +18,64 @@ limitations under the License.
 #include <vector>
 
 #include "re2/re2.h"
+#include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/model.h"
+#include "tensorflow/lite/stderr_reporter.h"
 
 namespace tflite {
+namespace {
+
+// Returns the name of the TfLiteType enumerator of `type`.
+string TfLiteTypeEnumName(TensorType type) {
+  TfLiteType tflite_type = kTfLiteNoType;
+  if (ConvertTensorType(type, &tflite_type, DefaultErrorReporter()) !=
+      kTfLiteOk) {
+    return "kTfLiteNoType";
+  }
+  switch (tflite_type) {
+    case kTfLiteFloat32:
+      return "kTfLiteFloat32";
+    case kTfLiteInt32:
+      return "kTfLiteInt32";
+    case kTfLiteUInt8:
+      return "kTfLiteUInt8";
+    case kTfLiteInt64:
+      return "kTfLiteInt64";
+    case kTfLiteString:
+      return "kTfLiteString";
+    case kTfLiteBool:
+      return "kTfLiteBool";
+    case kTfLiteInt16:
+      return "kTfLiteInt16";
+    case kTfLiteComplex64:
+      return "kTfLiteComplex64";
+    case kTfLiteInt8:
+      return "kTfLiteInt8";
+    case kTfLiteFloat16:
+      return "kTfLiteFloat16";
+    case kTfLiteFloat64:
+      return "kTfLiteFloat64";
+    case kTfLiteComplex128:
+      return "kTfLiteComplex128";
+    case kTfLiteNoType:
+      return "kTfLiteNoType";
+  }
+  return "kTfLiteNoType";
+}
+
+void AddTensorTypes(const ::tflite::SubGraph* subgraph,
+                    const flatbuffers::Vector<int32_t>* tensor_indices,
+                    std::set<string>* types) {
+  if (!tensor_indices || !subgraph->tensors()) return;
+  const int32_t num_tensors = subgraph->tensors()->size();
+  for (const int32_t index : *tensor_indices) {
+    // Skip optional tensors and invalid indices.
+    if (index < 0 || index >= num_tensors) continue;
+    types->insert(TfLiteTypeEnumName(subgraph->tensors()->Get(index)->type()));
+  }
+}
+
+}  // namespace
 
 string NormalizeCustomOpName(const string& op) {
   string method(op);
@@ -54,4 +109,22 @@ void ReadOpsFromModel(const ::tflite::Model* model,
   }
 }
 
+void ReadOpTypesFromModel(const ::tflite::Model* model,
+                          RegisteredOpTypeMap* op_types) {
+  if (!model || !model->operator_codes() || !model->subgraphs()) return;
+  auto opcodes = model->operator_codes();
+  for (const auto* subgraph : *model->subgraphs()) {
+    if (!subgraph->operators()) continue;
+    for (const auto* op : *subgraph->operators()) {
+      if (op->opcode_index() >= opcodes->size()) continue;
+      const auto builtin_code =
+          opcodes->Get(op->opcode_index())->builtin_code();
+      if (builtin_code == ::tflite::BuiltinOperator_CUSTOM) continue;
+      auto& types = (*op_types)[tflite::EnumNameBuiltinOperator(builtin_code)];
+      AddTensorTypes(subgraph, op->inputs(), &types);
+      AddTensorTypes(subgraph, op->outputs(), &types);
+    }
+  }
+}
+
 }  // namespace tflite
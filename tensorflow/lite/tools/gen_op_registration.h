@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_GEN_OP_REGISTRATION_H_
 #define TENSORFLOW_LITE_TOOLS_GEN_OP_REGISTRATION_H_
 
+#include <map>
+#include <set>
+
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/string_type.h"
 
@@ -37,6 +40,15 @@ void ReadOpsFromModel(const ::tflite::Model* model,
                       RegisteredOpMap* builtin_ops,
                       RegisteredOpMap* custom_ops);
 
+// A map from builtin op name to the names of the TfLiteType enumerators of
+// its tensors, e.g. "CONV_2D" -> {"kTfLiteFloat32"}.
+typedef std::map<string, std::set<string>> RegisteredOpTypeMap;
+
+// Read the types of the input and output tensors of every builtin op in the
+// TFLite model. Custom ops are skipped.
+void ReadOpTypesFromModel(const ::tflite::Model* model,
+                          RegisteredOpTypeMap* op_types);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_TOOLS_GEN_OP_REGISTRATION_H_
@@ -30,11 +30,12 @@ const char kNamespace[] = "namespace";
 const char kOutputRegistrationFlag[] = "output_registration";
 const char kTfLitePathFlag[] = "tflite_path";
 const char kForMicro[] = "for_micro";
+const char kOutputOpTypesFlag[] = "output_op_types";
 
 void ParseFlagAndInit(int* argc, char** argv, std::string* input_models,
                       std::string* output_registration,
                       std::string* tflite_path, std::string* namespace_flag,
-                      bool* for_micro) {
+                      bool* for_micro, std::string* output_op_types) {
   std::vector<tflite::Flag> flag_list = {
       tflite::Flag::CreateFlag(kInputModelFlag, input_models,
                                "path to the tflite models, separated by comma"),
@@ -49,6 +50,11 @@ void ParseFlagAndInit(int* argc, char** argv, std::string* input_models,
           kForMicro, for_micro,
           "By default this script generate TFL registration file, but can "
           "also generate TFLM files when this flag is set to true"),
+      tflite::Flag::CreateFlag(
+          kOutputOpTypesFlag, output_op_types,
+          "If set, filename for a tflite_ops_to_register.h header listing the "
+          "tensor types used by every builtin op, for builds with "
+          "TFLITE_SELECTIVE_REGISTRATION defined"),
   };
 
   tflite::Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
@@ -135,9 +141,37 @@ void GenerateFileContent(const std::string& tflite_path,
   fout.close();
 }
 
+// Generates the header read by tensorflow/lite/kernels/selective_registration.h
+void GenerateOpTypesFileContent(const std::string& tflite_path,
+                                const std::string& filename,
+                                const tflite::RegisteredOpTypeMap& op_types) {
+  std::ofstream fout(filename);
+  fout << "// This file was autogenerated by generate_op_registrations.\n";
+  fout << "#ifndef TFLITE_OPS_TO_REGISTER_H_\n";
+  fout << "#define TFLITE_OPS_TO_REGISTER_H_\n\n";
+  // Included from kernels/selective_registration.h, which defines IsEqual.
+  fout << "#include \"" << tflite_path << "/c/common.h\"\n\n";
+  fout << "constexpr inline bool TfLiteShouldRegisterOpType(const char* op,\n"
+          "                                                 TfLiteType type) "
+          "{\n";
+  fout << "  return false";
+  for (const auto& op : op_types) {
+    for (const auto& type : op.second) {
+      fout << "\n      || (::tflite::selective_registration::IsEqual(op, \""
+           << op.first << "\") && type == " << type << ")";
+    }
+  }
+  fout << ";\n}\n\n";
+  fout << "#define TFLITE_SHOULD_REGISTER_OP_TYPE(op, type) \\\n"
+          "  TfLiteShouldRegisterOpType(op, type)\n\n";
+  fout << "#endif  // TFLITE_OPS_TO_REGISTER_H_\n";
+  fout.close();
+}
+
 void AddOpsFromModel(const std::string& input_model,
                      tflite::RegisteredOpMap* builtin_ops,
-                     tflite::RegisteredOpMap* custom_ops) {
+                     tflite::RegisteredOpMap* custom_ops,
+                     tflite::RegisteredOpTypeMap* op_types) {
   std::ifstream fin(input_model);
   std::stringstream content;
   content << fin.rdbuf();
@@ -145,6 +179,7 @@ void AddOpsFromModel(const std::string& input_model,
   std::string content_str = content.str();
   const ::tflite::Model* model = ::tflite::GetModel(content_str.data());
   ::tflite::ReadOpsFromModel(model, builtin_ops, custom_ops);
+  ::tflite::ReadOpTypesFromModel(model, op_types);
 }
 
 }  // namespace
@@ -155,22 +190,27 @@ int main(int argc, char** argv) {
   std::string tflite_path;
   std::string namespace_flag;
   bool for_micro = false;
+  std::string output_op_types;
   ParseFlagAndInit(&argc, argv, &input_models, &output_registration,
-                   &tflite_path, &namespace_flag, &for_micro);
+                   &tflite_path, &namespace_flag, &for_micro, &output_op_types);
 
   tflite::RegisteredOpMap builtin_ops;
   tflite::RegisteredOpMap custom_ops;
+  tflite::RegisteredOpTypeMap op_types;
   if (!input_models.empty()) {
     std::vector<std::string> models = absl::StrSplit(input_models, ',');
     for (const std::string& input_model : models) {
-      AddOpsFromModel(input_model, &builtin_ops, &custom_ops);
+      AddOpsFromModel(input_model, &builtin_ops, &custom_ops, &op_types);
     }
   }
   for (int i = 1; i < argc; i++) {
-    AddOpsFromModel(argv[i], &builtin_ops, &custom_ops);
+    AddOpsFromModel(argv[i], &builtin_ops, &custom_ops, &op_types);
   }
 
   GenerateFileContent(tflite_path, output_registration, namespace_flag,
                       builtin_ops, custom_ops, for_micro);
+  if (!output_op_types.empty()) {
+    GenerateOpTypesFileContent(tflite_path, output_op_types, op_types);
+  }
   return 0;
 }
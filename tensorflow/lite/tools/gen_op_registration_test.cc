@@ -85,6 +85,21 @@ TEST_F(GenOpRegistrationTest, TestBrokenMmap) {
   EXPECT_EQ(custom_ops_.size(), 0);
 }
 
+TEST_F(GenOpRegistrationTest, TestOpTypes) {
+  RegisteredOpTypeMap op_types;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin");
+  ASSERT_TRUE(model);
+  ReadOpTypesFromModel(model->GetModel(), &op_types);
+  // The custom op is skipped.
+  RegisteredOpTypeMap expected{{"CONV_2D", {"kTfLiteFloat32"}}};
+  EXPECT_THAT(op_types, ElementsAreArray(expected));
+
+  op_types.clear();
+  ReadOpTypesFromModel(nullptr, &op_types);
+  EXPECT_EQ(op_types.size(), 0);
+}
+
 TEST_F(GenOpRegistrationTest, TestNormalizeCustomOpName) {
   std::vector<std::pair<string, string>> testcase = {
       {"CustomOp", "CUSTOM_OP"},
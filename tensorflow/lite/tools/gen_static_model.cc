@@ -0,0 +1,798 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/gen_static_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+// Alignment of every tensor in the generated arena, enough for SIMD loads.
+constexpr int64_t kArenaAlignment = 16;
+
+int64_t AlignTo(int64_t bytes) {
+  return (bytes + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+// Returns a float literal that reads back as exactly `value`.
+string FloatLiteral(float value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.9g", value);
+  string literal(buf);
+  if (literal.find_first_of(".e") == string::npos) literal += ".0";
+  return literal + "f";
+}
+
+// Where a tensor lives in the generated code.
+struct TensorInfo {
+  // Whether the tensor is used at all by the generated code.
+  bool used = false;
+  // Constant tensors are emitted as static arrays, all others live in the
+  // arena at `offset`.
+  bool is_constant = false;
+  int64_t bytes = 0;
+  int64_t offset = 0;
+  // Index of the first and the last operator using the tensor. Model inputs
+  // are live from the start and model outputs until the end.
+  int first_use = -1;
+  int last_use = -1;
+  // Whether the tensor is a model input or an operator output.
+  bool written = false;
+};
+
+class StaticModelGenerator {
+ public:
+  StaticModelGenerator(const ::tflite::Model* model,
+                       const StaticModelOptions& options,
+                       ErrorReporter* error_reporter)
+      : model_(model), options_(options), error_reporter_(error_reporter) {}
+
+  TfLiteStatus Generate(string* header, string* source);
+
+ private:
+  const ::tflite::Tensor* tensor(int index) const {
+    return subgraph_->tensors()->Get(index);
+  }
+  std::vector<int32_t> Dims(int index) const;
+  int64_t NumElements(int index) const;
+
+  // Validates the tensors and computes their lifetimes.
+  TfLiteStatus AnalyzeTensors();
+  // Assigns arena offsets to the non-constant tensors, reusing the memory of
+  // tensors whose lifetimes do not overlap.
+  void PlanArena();
+
+  // Returns the generated expressions for the shape and the data of tensor
+  // `index`, which may be -1 for an omitted optional tensor.
+  string Shape(int index);
+  string Data(int index) const;
+
+  // Writes the generated code for an operator.
+  TfLiteStatus EmitOperator(int op_index, const ::tflite::Operator* op,
+                            string* code);
+  TfLiteStatus EmitElementwise(const ::tflite::Operator* op,
+                               const char* function,
+                               ActivationFunctionType activation,
+                               string* code);
+  TfLiteStatus EmitConv(const ::tflite::Operator* op, bool depthwise,
+                        string* code);
+  TfLiteStatus EmitPool(const ::tflite::Operator* op, const char* function,
+                        string* code);
+  TfLiteStatus EmitFullyConnected(const ::tflite::Operator* op, string* code);
+  TfLiteStatus EmitReshape(const ::tflite::Operator* op, string* code);
+  TfLiteStatus EmitSoftmax(const ::tflite::Operator* op, string* code);
+
+  // Writes the float activation range of a fused activation function.
+  TfLiteStatus EmitActivationRange(ActivationFunctionType activation,
+                                   string* code);
+  // Writes the padding and strides of a windowed operator, and checks that
+  // the output shape in the model matches the one implied by its options.
+  TfLiteStatus EmitPadding(int input, int output, int filter_height,
+                           int filter_width, int stride_height,
+                           int stride_width, int dilation_height,
+                           int dilation_width, ::tflite::Padding padding,
+                           string* code);
+
+  TfLiteStatus CheckRank(int index, int rank) const;
+  TfLiteStatus CheckSameShape(int a, int b) const;
+
+  string HeaderContent() const;
+  string SourceContent(const string& invoke_body) const;
+
+  const ::tflite::Model* model_;
+  const StaticModelOptions& options_;
+  ErrorReporter* error_reporter_;
+  const ::tflite::SubGraph* subgraph_ = nullptr;
+  std::vector<TensorInfo> tensors_;
+  std::set<int> used_shapes_;
+  int64_t arena_size_ = 0;
+  string current_op_;
+};
+
+std::vector<int32_t> StaticModelGenerator::Dims(int index) const {
+  std::vector<int32_t> dims;
+  if (const auto* shape = tensor(index)->shape()) {
+    dims.assign(shape->begin(), shape->end());
+  }
+  return dims;
+}
+
+int64_t StaticModelGenerator::NumElements(int index) const {
+  int64_t num_elements = 1;
+  for (const int32_t dim : Dims(index)) num_elements *= dim;
+  return num_elements;
+}
+
+TfLiteStatus StaticModelGenerator::AnalyzeTensors() {
+  const int num_tensors =
+      subgraph_->tensors() ? subgraph_->tensors()->size() : 0;
+  const int num_ops =
+      subgraph_->operators() ? subgraph_->operators()->size() : 0;
+  tensors_.assign(num_tensors, TensorInfo());
+  auto use = [&](int index, int op_index, bool is_output) -> TfLiteStatus {
+    if (index < 0) return kTfLiteOk;
+    if (index >= num_tensors) {
+      TF_LITE_REPORT_ERROR(error_reporter_, "Invalid tensor index %d.", index);
+      return kTfLiteError;
+    }
+    TensorInfo& info = tensors_[index];
+    if (is_output && info.first_use >= 0) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Tensor %d is written more than once.", index);
+      return kTfLiteError;
+    }
+    if (!info.used || is_output) info.first_use = op_index;
+    info.last_use = std::max(info.last_use, op_index);
+    info.used = true;
+    info.written |= is_output;
+    return kTfLiteOk;
+  };
+
+  // Model inputs are written before the first operator runs.
+  if (subgraph_->inputs()) {
+    for (const int32_t index : *subgraph_->inputs()) {
+      TF_LITE_ENSURE_STATUS(use(index, 0, /*is_output=*/true));
+    }
+  }
+  auto opcodes = model_->operator_codes();
+  for (int i = 0; i < num_ops; ++i) {
+    const auto* op = subgraph_->operators()->Get(i);
+    if (!opcodes || op->opcode_index() >= opcodes->size()) {
+      TF_LITE_REPORT_ERROR(error_reporter_, "Invalid opcode index.");
+      return kTfLiteError;
+    }
+    const auto builtin_code = opcodes->Get(op->opcode_index())->builtin_code();
+    if (op->inputs()) {
+      for (int k = 0; k < op->inputs()->size(); ++k) {
+        // The shape input of RESHAPE is fixed at generation time.
+        if (builtin_code == BuiltinOperator_RESHAPE && k == 1) continue;
+        TF_LITE_ENSURE_STATUS(
+            use(op->inputs()->Get(k), i, /*is_output=*/false));
+      }
+    }
+    if (op->outputs()) {
+      for (const int32_t index : *op->outputs()) {
+        TF_LITE_ENSURE_STATUS(use(index, i, /*is_output=*/true));
+      }
+    }
+  }
+  // Model outputs are read after the last operator has run.
+  if (subgraph_->outputs()) {
+    for (const int32_t index : *subgraph_->outputs()) {
+      TF_LITE_ENSURE_STATUS(use(index, num_ops, /*is_output=*/false));
+    }
+  }
+
+  for (int i = 0; i < num_tensors; ++i) {
+    TensorInfo& info = tensors_[i];
+    if (!info.used) continue;
+    const auto* t = tensor(i);
+    const char* name = t->name() ? t->name()->c_str() : "";
+    if (t->type() != TensorType_FLOAT32) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Tensor %d (%s) has type %s, only FLOAT32 is "
+                           "supported.",
+                           i, name, EnumNameTensorType(t->type()));
+      return kTfLiteError;
+    }
+    if (const auto* signature = t->shape_signature()) {
+      for (const int32_t dim : *signature) {
+        if (dim < 0) {
+          TF_LITE_REPORT_ERROR(error_reporter_,
+                               "Tensor %d (%s) has a dynamic shape.", i, name);
+          return kTfLiteError;
+        }
+      }
+    }
+    if (t->is_variable() || t->sparsity()) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Tensor %d (%s) is a variable or sparse tensor.", i,
+                           name);
+      return kTfLiteError;
+    }
+    info.bytes = NumElements(i) * sizeof(float);
+    const flatbuffers::Vector<uint8_t>* data = nullptr;
+    if (model_->buffers() && t->buffer() < model_->buffers()->size()) {
+      data = model_->buffers()->Get(t->buffer())->data();
+    }
+    info.is_constant = data && data->size() > 0;
+    if (info.is_constant) {
+      if (data->size() != info.bytes) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Tensor %d (%s) has %d bytes of data, expected "
+                             "%d.",
+                             i, name, static_cast<int>(data->size()),
+                             static_cast<int>(info.bytes));
+        return kTfLiteError;
+      }
+      if (info.written || info.last_use == num_ops) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Tensor %d (%s) is constant, but is written or "
+                             "is a model output.",
+                             i, name);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+void StaticModelGenerator::PlanArena() {
+  std::vector<int> order;
+  for (int i = 0; i < tensors_.size(); ++i) {
+    if (tensors_[i].used && !tensors_[i].is_constant) order.push_back(i);
+  }
+  // Placing the largest tensors first keeps the arena small.
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return tensors_[a].bytes > tensors_[b].bytes;
+  });
+  std::vector<const TensorInfo*> placed;
+  for (const int index : order) {
+    TensorInfo& info = tensors_[index];
+    std::vector<const TensorInfo*> live;
+    for (const TensorInfo* other : placed) {
+      if (other->first_use <= info.last_use &&
+          info.first_use <= other->last_use) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(),
+              [](const TensorInfo* a, const TensorInfo* b) {
+                return a->offset < b->offset;
+              });
+    // Take the first gap between the live tensors that is large enough.
+    int64_t offset = 0;
+    for (const TensorInfo* other : live) {
+      if (offset + info.bytes <= other->offset) break;
+      offset = std::max(offset, AlignTo(other->offset + other->bytes));
+    }
+    info.offset = offset;
+    arena_size_ = std::max(arena_size_, AlignTo(offset + info.bytes));
+    placed.push_back(&info);
+  }
+}
+
+string StaticModelGenerator::Shape(int index) {
+  if (index < 0 || Dims(index).empty()) return "RuntimeShape()";
+  used_shapes_.insert(index);
+  return absl::StrCat("RuntimeShape(", Dims(index).size(), ", kShape", index,
+                      ")");
+}
+
+string StaticModelGenerator::Data(int index) const {
+  if (index < 0) return "nullptr";
+  return absl::StrCat(tensors_[index].is_constant ? "kTensor" : "t", index);
+}
+
+TfLiteStatus StaticModelGenerator::CheckRank(int index, int rank) const {
+  if (index < 0 || static_cast<int>(Dims(index).size()) != rank) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "%s: tensor %d must have rank %d.",
+                         current_op_.c_str(), index, rank);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::CheckSameShape(int a, int b) const {
+  if (a < 0 || b < 0 || Dims(a) != Dims(b)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "%s: tensors %d and %d must have the same shape; "
+                         "broadcasting is not supported.",
+                         current_op_.c_str(), a, b);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitActivationRange(
+    ActivationFunctionType activation, string* code) {
+  string min = "std::numeric_limits<float>::lowest()";
+  string max = "std::numeric_limits<float>::max()";
+  switch (activation) {
+    case ActivationFunctionType_NONE:
+      break;
+    case ActivationFunctionType_RELU:
+      min = "0.0f";
+      break;
+    case ActivationFunctionType_RELU_N1_TO_1:
+      min = "-1.0f";
+      max = "1.0f";
+      break;
+    case ActivationFunctionType_RELU6:
+      min = "0.0f";
+      max = "6.0f";
+      break;
+    default:
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "%s: fused activation %s is not supported.",
+                           current_op_.c_str(),
+                           EnumNameActivationFunctionType(activation));
+      return kTfLiteError;
+  }
+  absl::StrAppend(code, "    params.float_activation_min = ", min, ";\n",
+                  "    params.float_activation_max = ", max, ";\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitPadding(
+    int input, int output, int filter_height, int filter_width,
+    int stride_height, int stride_width, int dilation_height,
+    int dilation_width, ::tflite::Padding padding, string* code) {
+  TF_LITE_ENSURE_STATUS(CheckRank(input, 4));
+  TF_LITE_ENSURE_STATUS(CheckRank(output, 4));
+  const std::vector<int32_t> input_dims = Dims(input);
+  const std::vector<int32_t> output_dims = Dims(output);
+  int out_height = 0;
+  int out_width = 0;
+  const TfLitePaddingValues values = ComputePaddingHeightWidth(
+      stride_height, stride_width, dilation_height, dilation_width,
+      input_dims[1], input_dims[2], filter_height, filter_width,
+      padding == Padding_SAME ? kTfLitePaddingSame : kTfLitePaddingValid,
+      &out_height, &out_width);
+  if (out_height != output_dims[1] || out_width != output_dims[2]) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "%s: output is %dx%d, but the options give %dx%d.",
+                         current_op_.c_str(), output_dims[1], output_dims[2],
+                         out_height, out_width);
+    return kTfLiteError;
+  }
+  absl::StrAppend(
+      code, "    params.padding_type = ::tflite::PaddingType::",
+      padding == Padding_SAME ? "kSame" : "kValid", ";\n",
+      "    params.padding_values.width = ", values.width, ";\n",
+      "    params.padding_values.height = ", values.height, ";\n",
+      "    params.padding_values.width_offset = ", values.width_offset, ";\n",
+      "    params.padding_values.height_offset = ", values.height_offset, ";\n",
+      "    params.stride_width = ", stride_width, ";\n",
+      "    params.stride_height = ", stride_height, ";\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitElementwise(
+    const ::tflite::Operator* op, const char* function,
+    ActivationFunctionType activation, string* code) {
+  const int input1 = op->inputs()->Get(0);
+  const int input2 = op->inputs()->Get(1);
+  const int output = op->outputs()->Get(0);
+  TF_LITE_ENSURE_STATUS(CheckSameShape(input1, output));
+  TF_LITE_ENSURE_STATUS(CheckSameShape(input2, output));
+  absl::StrAppend(code, "    ::tflite::ArithmeticParams params;\n");
+  TF_LITE_ENSURE_STATUS(EmitActivationRange(activation, code));
+  absl::StrAppend(code, "    reference_ops::", function, "(params, ",
+                  Shape(input1), ", ", Data(input1), ", ", Shape(input2), ", ",
+                  Data(input2), ", ", Shape(output), ", ", Data(output),
+                  ");\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitConv(const ::tflite::Operator* op,
+                                            bool depthwise, string* code) {
+  const int input = op->inputs()->Get(0);
+  const int filter = op->inputs()->Get(1);
+  const int bias = op->inputs()->size() > 2 ? op->inputs()->Get(2) : -1;
+  const int output = op->outputs()->Get(0);
+  TF_LITE_ENSURE_STATUS(CheckRank(filter, 4));
+  const std::vector<int32_t> filter_dims = Dims(filter);
+  if (depthwise) {
+    const auto* options = op->builtin_options_as_DepthwiseConv2DOptions();
+    if (!options) {
+      TF_LITE_REPORT_ERROR(error_reporter_, "%s: missing options.",
+                           current_op_.c_str());
+      return kTfLiteError;
+    }
+    absl::StrAppend(code, "    ::tflite::DepthwiseParams params;\n");
+    TF_LITE_ENSURE_STATUS(EmitPadding(
+        input, output, filter_dims[1], filter_dims[2], options->stride_h(),
+        options->stride_w(), options->dilation_h_factor(),
+        options->dilation_w_factor(), options->padding(), code));
+    absl::StrAppend(code, "    params.dilation_width_factor = ",
+                    options->dilation_w_factor(), ";\n",
+                    "    params.dilation_height_factor = ",
+                    options->dilation_h_factor(), ";\n",
+                    "    params.depth_multiplier = ",
+                    options->depth_multiplier(), ";\n");
+    TF_LITE_ENSURE_STATUS(
+        EmitActivationRange(options->fused_activation_function(), code));
+  } else {
+    const auto* options = op->builtin_options_as_Conv2DOptions();
+    if (!options) {
+      TF_LITE_REPORT_ERROR(error_reporter_, "%s: missing options.",
+                           current_op_.c_str());
+      return kTfLiteError;
+    }
+    absl::StrAppend(code, "    ::tflite::ConvParams params;\n");
+    TF_LITE_ENSURE_STATUS(EmitPadding(
+        input, output, filter_dims[1], filter_dims[2], options->stride_h(),
+        options->stride_w(), options->dilation_h_factor(),
+        options->dilation_w_factor(), options->padding(), code));
+    absl::StrAppend(code, "    params.dilation_width_factor = ",
+                    options->dilation_w_factor(), ";\n",
+                    "    params.dilation_height_factor = ",
+                    options->dilation_h_factor(), ";\n");
+    TF_LITE_ENSURE_STATUS(
+        EmitActivationRange(options->fused_activation_function(), code));
+  }
+  absl::StrAppend(code, "    reference_ops::",
+                  depthwise ? "DepthwiseConv" : "Conv", "(params, ",
+                  Shape(input), ", ", Data(input), ", ", Shape(filter), ", ",
+                  Data(filter), ", ", Shape(bias), ", ", Data(bias), ", ",
+                  Shape(output), ", ", Data(output),
+                  depthwise ? ");\n" : ", RuntimeShape(), nullptr);\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitPool(const ::tflite::Operator* op,
+                                            const char* function,
+                                            string* code) {
+  const int input = op->inputs()->Get(0);
+  const int output = op->outputs()->Get(0);
+  const auto* options = op->builtin_options_as_Pool2DOptions();
+  if (!options) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "%s: missing options.",
+                         current_op_.c_str());
+    return kTfLiteError;
+  }
+  absl::StrAppend(code, "    ::tflite::PoolParams params;\n");
+  TF_LITE_ENSURE_STATUS(EmitPadding(
+      input, output, options->filter_height(), options->filter_width(),
+      options->stride_h(), options->stride_w(), /*dilation_height=*/1,
+      /*dilation_width=*/1, options->padding(), code));
+  absl::StrAppend(code, "    params.filter_height = ",
+                  options->filter_height(), ";\n",
+                  "    params.filter_width = ", options->filter_width(),
+                  ";\n");
+  TF_LITE_ENSURE_STATUS(
+      EmitActivationRange(options->fused_activation_function(), code));
+  absl::StrAppend(code, "    reference_ops::", function, "(params, ",
+                  Shape(input), ", ", Data(input), ", ", Shape(output), ", ",
+                  Data(output), ");\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitFullyConnected(
+    const ::tflite::Operator* op, string* code) {
+  const int input = op->inputs()->Get(0);
+  const int weights = op->inputs()->Get(1);
+  const int bias = op->inputs()->size() > 2 ? op->inputs()->Get(2) : -1;
+  const int output = op->outputs()->Get(0);
+  ActivationFunctionType activation = ActivationFunctionType_NONE;
+  if (const auto* options = op->builtin_options_as_FullyConnectedOptions()) {
+    if (options->weights_format() !=
+        FullyConnectedOptionsWeightsFormat_DEFAULT) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "%s: only the default weights format is "
+                           "supported.",
+                           current_op_.c_str());
+      return kTfLiteError;
+    }
+    activation = options->fused_activation_function();
+  }
+  TF_LITE_ENSURE_STATUS(CheckRank(weights, 2));
+  absl::StrAppend(code, "    ::tflite::FullyConnectedParams params;\n");
+  TF_LITE_ENSURE_STATUS(EmitActivationRange(activation, code));
+  absl::StrAppend(code, "    reference_ops::FullyConnected(params, ",
+                  Shape(input), ", ", Data(input), ", ", Shape(weights), ", ",
+                  Data(weights), ", ", Shape(bias), ", ", Data(bias), ", ",
+                  Shape(output), ", ", Data(output), ");\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitReshape(const ::tflite::Operator* op,
+                                               string* code) {
+  const int input = op->inputs()->Get(0);
+  const int output = op->outputs()->Get(0);
+  if (NumElements(input) != NumElements(output)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "%s: input and output sizes differ.",
+                         current_op_.c_str());
+    return kTfLiteError;
+  }
+  absl::StrAppend(code, "    std::memcpy(", Data(output), ", ", Data(input),
+                  ", ", tensors_[output].bytes, ");\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitSoftmax(const ::tflite::Operator* op,
+                                               string* code) {
+  const int input = op->inputs()->Get(0);
+  const int output = op->outputs()->Get(0);
+  TF_LITE_ENSURE_STATUS(CheckSameShape(input, output));
+  const auto* options = op->builtin_options_as_SoftmaxOptions();
+  const float beta = options ? options->beta() : 1.0f;
+  absl::StrAppend(code, "    ::tflite::SoftmaxParams params;\n",
+                  "    params.beta = ", FloatLiteral(beta), ";\n",
+                  "    reference_ops::Softmax(params, ", Shape(input), ", ",
+                  Data(input), ", ", Shape(output), ", ", Data(output),
+                  ");\n");
+  return kTfLiteOk;
+}
+
+TfLiteStatus StaticModelGenerator::EmitOperator(int op_index,
+                                                const ::tflite::Operator* op,
+                                                string* code) {
+  const auto builtin_code =
+      model_->operator_codes()->Get(op->opcode_index())->builtin_code();
+  current_op_ = absl::StrCat("Operator ", op_index, " (",
+                             EnumNameBuiltinOperator(builtin_code), ")");
+  int min_inputs = 1;
+  switch (builtin_code) {
+    case BuiltinOperator_ADD:
+    case BuiltinOperator_MUL:
+    case BuiltinOperator_CONV_2D:
+    case BuiltinOperator_DEPTHWISE_CONV_2D:
+    case BuiltinOperator_FULLY_CONNECTED:
+      min_inputs = 2;
+      break;
+    default:
+      break;
+  }
+  if (!op->inputs() || op->inputs()->size() < min_inputs || !op->outputs() ||
+      op->outputs()->size() != 1 || op->inputs()->Get(0) < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "%s: unexpected number of tensors.",
+                         current_op_.c_str());
+    return kTfLiteError;
+  }
+
+  absl::StrAppend(code, "  // ", current_op_, "\n  {\n");
+  switch (builtin_code) {
+    case BuiltinOperator_ADD: {
+      const auto* options = op->builtin_options_as_AddOptions();
+      TF_LITE_ENSURE_STATUS(EmitElementwise(
+          op, "Add",
+          options ? options->fused_activation_function()
+                  : ActivationFunctionType_NONE,
+          code));
+      break;
+    }
+    case BuiltinOperator_MUL: {
+      const auto* options = op->builtin_options_as_MulOptions();
+      TF_LITE_ENSURE_STATUS(EmitElementwise(
+          op, "Mul",
+          options ? options->fused_activation_function()
+                  : ActivationFunctionType_NONE,
+          code));
+      break;
+    }
+    case BuiltinOperator_CONV_2D:
+      TF_LITE_ENSURE_STATUS(EmitConv(op, /*depthwise=*/false, code));
+      break;
+    case BuiltinOperator_DEPTHWISE_CONV_2D:
+      TF_LITE_ENSURE_STATUS(EmitConv(op, /*depthwise=*/true, code));
+      break;
+    case BuiltinOperator_FULLY_CONNECTED:
+      TF_LITE_ENSURE_STATUS(EmitFullyConnected(op, code));
+      break;
+    case BuiltinOperator_AVERAGE_POOL_2D:
+      TF_LITE_ENSURE_STATUS(EmitPool(op, "AveragePool", code));
+      break;
+    case BuiltinOperator_MAX_POOL_2D:
+      TF_LITE_ENSURE_STATUS(EmitPool(op, "MaxPool", code));
+      break;
+    case BuiltinOperator_RESHAPE:
+      TF_LITE_ENSURE_STATUS(EmitReshape(op, code));
+      break;
+    case BuiltinOperator_SOFTMAX:
+      TF_LITE_ENSURE_STATUS(EmitSoftmax(op, code));
+      break;
+    default:
+      TF_LITE_REPORT_ERROR(error_reporter_, "%s is not supported.",
+                           current_op_.c_str());
+      return kTfLiteError;
+  }
+  absl::StrAppend(code, "  }\n");
+  return kTfLiteOk;
+}
+
+string StaticModelGenerator::HeaderContent() const {
+  const std::vector<string> namespaces =
+      absl::StrSplit(options_.namespace_name, "::", absl::SkipEmpty());
+  const string& name = options_.class_name;
+  string header = absl::StrCat(
+      "// Generated by generate_static_model, from a TensorFlow Lite model.  "
+      "DO NOT EDIT!\n"
+      "//\n"
+      "// clang-format off\n\n"
+      "#ifndef TFLITE_GENERATED_",
+      name, "_H_  // NOLINT(build/header_guard)\n#define TFLITE_GENERATED_",
+      name, "_H_  // NOLINT(build/header_guard)\n\n#include <cstdint>\n\n");
+  for (const string& ns : namespaces) {
+    absl::StrAppend(&header, "namespace ", ns, " {\n");
+  }
+  absl::StrAppend(
+      &header, "\n// ", name,
+      " runs a TensorFlow Lite model without an interpreter: shapes,\n"
+      "// kernel parameters and buffer offsets were all fixed when the code "
+      "was\n"
+      "// generated. Usage example:\n//\n//   ",
+      name,
+      " model;\n"
+      "//   // ...fill the inputs using model.inputN()\n"
+      "//   model.Invoke();\n"
+      "//   // ...read the outputs using model.outputN()\n"
+      "//\n"
+      "// Inputs, outputs and intermediate tensors share one arena inside the\n"
+      "// object. The buffers of inputs may be reused for intermediate "
+      "results, so\n"
+      "// the inputs must be set before every call to Invoke.\n"
+      "//\n"
+      "// This class is thread-compatible.\n"
+      "class ",
+      name, " {\n public:\n");
+  const int num_inputs = subgraph_->inputs() ? subgraph_->inputs()->size() : 0;
+  const int num_outputs =
+      subgraph_->outputs() ? subgraph_->outputs()->size() : 0;
+  absl::StrAppend(
+      &header, "  static constexpr int kNumInputs = ", num_inputs, ";\n",
+      "  static constexpr int kNumOutputs = ", num_outputs, ";\n\n",
+      "  // Size in bytes of the arena holding all non-constant tensors.\n",
+      "  static constexpr int kArenaSize = ", arena_size_, ";\n\n  ", name,
+      "() = default;\n  ", name, "(const ", name, "&) = delete;\n  ", name,
+      "& operator=(const ", name, "&) = delete;\n\n",
+      "  // Runs the model, reading the inputs and writing the outputs.\n",
+      "  void Invoke();\n");
+  // Emits e.g. kInput0Size and input0() for the tensor `index`.
+  auto accessors = [&](const char* constant, const char* method, int i,
+                       int index, bool is_const) {
+    const char* qualifier = is_const ? "const " : "";
+    absl::StrAppend(&header, "\n  // ", constant, " ", i, ": float32[",
+                    absl::StrJoin(Dims(index), ","), "], k", constant, i,
+                    "Size elements.\n  static constexpr int k", constant, i,
+                    "Size = ", NumElements(index), ";\n  ", qualifier,
+                    "float* ", method, i, "()", is_const ? " const" : "",
+                    " {\n    return reinterpret_cast<", qualifier,
+                    "float*>(arena_ + ", tensors_[index].offset, ");\n  }\n");
+  };
+  for (int i = 0; i < num_inputs; ++i) {
+    accessors("Input", "input", i, subgraph_->inputs()->Get(i),
+              /*is_const=*/false);
+  }
+  for (int i = 0; i < num_outputs; ++i) {
+    accessors("Output", "output", i, subgraph_->outputs()->Get(i),
+              /*is_const=*/true);
+  }
+  absl::StrAppend(&header, "\n private:\n  alignas(", kArenaAlignment,
+                  ") std::uint8_t arena_[", std::max<int64_t>(arena_size_, 1),
+                  "];\n};\n\n");
+  for (auto it = namespaces.rbegin(); it != namespaces.rend(); ++it) {
+    absl::StrAppend(&header, "}  // namespace ", *it, "\n");
+  }
+  absl::StrAppend(&header, "\n#endif  // TFLITE_GENERATED_", name, "_H_\n");
+  return header;
+}
+
+string StaticModelGenerator::SourceContent(const string& invoke_body) const {
+  const std::vector<string> namespaces =
+      absl::StrSplit(options_.namespace_name, "::", absl::SkipEmpty());
+  const string& tflite_path = options_.tflite_path;
+  const string header_path = options_.header_path.empty()
+                                 ? options_.class_name + ".h"
+                                 : options_.header_path;
+  string source = absl::StrCat(
+      "// Generated by generate_static_model, from a TensorFlow Lite model.  "
+      "DO NOT EDIT!\n"
+      "//\n"
+      "// clang-format off\n\n"
+      "#include \"",
+      header_path,
+      "\"\n\n#include <cstring>\n#include <limits>\n\n#include \"",
+      tflite_path, "/kernels/internal/reference/reference_ops.h\"\n#include \"",
+      tflite_path, "/kernels/internal/types.h\"\n\n");
+  for (const string& ns : namespaces) {
+    absl::StrAppend(&source, "namespace ", ns, " {\n");
+  }
+  absl::StrAppend(&source,
+                  "namespace {\n\n"
+                  "using ::tflite::RuntimeShape;\n"
+                  "namespace reference_ops = ::tflite::reference_ops;\n");
+  for (int i = 0; i < tensors_.size(); ++i) {
+    if (!tensors_[i].used || !tensors_[i].is_constant) continue;
+    const auto* data = model_->buffers()->Get(tensor(i)->buffer())->data();
+    absl::StrAppend(&source, "\nalignas(", kArenaAlignment,
+                    ") const std::uint8_t kBuffer", i, "[] = {");
+    for (int b = 0; b < data->size(); ++b) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "0x%02x,", data->Get(b));
+      absl::StrAppend(&source, b % 12 == 0 ? "\n   " : "", " ", buf);
+    }
+    absl::StrAppend(&source, "\n};\nconst float* const kTensor", i,
+                    " = reinterpret_cast<const float*>(kBuffer", i, ");\n");
+  }
+  absl::StrAppend(&source, "\n");
+  for (const int i : used_shapes_) {
+    absl::StrAppend(&source, "constexpr std::int32_t kShape", i, "[] = {",
+                    absl::StrJoin(Dims(i), ", "), "};\n");
+  }
+  absl::StrAppend(&source, "\n}  // namespace\n\nvoid ", options_.class_name,
+                  "::Invoke() {\n");
+  for (int i = 0; i < tensors_.size(); ++i) {
+    if (!tensors_[i].used || tensors_[i].is_constant) continue;
+    absl::StrAppend(&source, "  float* const t", i,
+                    " = reinterpret_cast<float*>(arena_ + ",
+                    tensors_[i].offset, ");\n");
+  }
+  absl::StrAppend(&source, "\n", invoke_body, "}\n\n");
+  for (auto it = namespaces.rbegin(); it != namespaces.rend(); ++it) {
+    absl::StrAppend(&source, "}  // namespace ", *it, "\n");
+  }
+  return source;
+}
+
+TfLiteStatus StaticModelGenerator::Generate(string* header, string* source) {
+  if (!model_ || !model_->subgraphs() || model_->subgraphs()->size() != 1) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The model must have exactly one subgraph.");
+    return kTfLiteError;
+  }
+  subgraph_ = model_->subgraphs()->Get(0);
+  TF_LITE_ENSURE_STATUS(AnalyzeTensors());
+  PlanArena();
+
+  string invoke_body;
+  if (subgraph_->operators()) {
+    for (int i = 0; i < subgraph_->operators()->size(); ++i) {
+      TF_LITE_ENSURE_STATUS(
+          EmitOperator(i, subgraph_->operators()->Get(i), &invoke_body));
+    }
+  }
+  *header = HeaderContent();
+  *source = SourceContent(invoke_body);
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus GenerateStaticModel(const ::tflite::Model* model,
+                                 const StaticModelOptions& options,
+                                 string* header, string* source,
+                                 ErrorReporter* error_reporter) {
+  return StaticModelGenerator(model, options, error_reporter)
+      .Generate(header, source);
+}
+
+}  // namespace tflite
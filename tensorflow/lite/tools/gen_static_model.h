@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_GEN_STATIC_MODEL_H_
+#define TENSORFLOW_LITE_TOOLS_GEN_STATIC_MODEL_H_
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/string_type.h"
+
+namespace tflite {
+
+// Options for GenerateStaticModel.
+struct StaticModelOptions {
+  // Name of the generated class.
+  string class_name = "StaticModel";
+  // Optional namespace of the generated class, e.g. "foo::bar".
+  string namespace_name;
+  // Path under which the generated source includes the generated header.
+  string header_path;
+  // Path to the tensorflow lite dir, used in the generated includes.
+  string tflite_path = "tensorflow/lite";
+};
+
+// Generates C++ code that runs the first subgraph of `model` without an
+// interpreter. Every tensor must have a static shape, so that shapes, kernel
+// parameters and the arena layout are all fixed at generation time: the
+// generated Invoke calls the reference kernels directly with constant shapes
+// and buffer offsets, and there is no Prepare, no op resolution and no
+// allocation at runtime.
+//
+// Only float32 models built from ADD, MUL, CONV_2D, DEPTHWISE_CONV_2D,
+// FULLY_CONNECTED, AVERAGE_POOL_2D, MAX_POOL_2D, RESHAPE and SOFTMAX, without
+// broadcasting, are supported; anything else is reported to `error_reporter`
+// and kTfLiteError is returned. Models that do not fit should keep using the
+// interpreter.
+TfLiteStatus GenerateStaticModel(const ::tflite::Model* model,
+                                 const StaticModelOptions& options,
+                                 string* header, string* source,
+                                 ErrorReporter* error_reporter);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_GEN_STATIC_MODEL_H_
@@ -0,0 +1,82 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/gen_static_model.h"
+
+const char kInputModelFlag[] = "input_model";
+const char kOutputHeaderFlag[] = "output_header";
+const char kOutputSourceFlag[] = "output_source";
+const char kClassNameFlag[] = "class_name";
+const char kNamespaceFlag[] = "namespace";
+const char kHeaderPathFlag[] = "header_path";
+const char kTfLitePathFlag[] = "tflite_path";
+
+int main(int argc, char** argv) {
+  std::string input_model;
+  std::string output_header;
+  std::string output_source;
+  tflite::StaticModelOptions options;
+  std::vector<tflite::Flag> flag_list = {
+      tflite::Flag::CreateFlag(kInputModelFlag, &input_model,
+                               "path to the tflite model"),
+      tflite::Flag::CreateFlag(kOutputHeaderFlag, &output_header,
+                               "filename for the generated header"),
+      tflite::Flag::CreateFlag(kOutputSourceFlag, &output_source,
+                               "filename for the generated source"),
+      tflite::Flag::CreateFlag(kClassNameFlag, &options.class_name,
+                               "name of the generated class"),
+      tflite::Flag::CreateFlag(kNamespaceFlag, &options.namespace_name,
+                               "namespace of the generated class, e.g. "
+                               "foo::bar"),
+      tflite::Flag::CreateFlag(kHeaderPathFlag, &options.header_path,
+                               "path under which the generated source "
+                               "includes the generated header"),
+      tflite::Flag::CreateFlag(kTfLitePathFlag, &options.tflite_path,
+                               "Path to tensorflow lite dir"),
+  };
+  if (!tflite::Flags::Parse(&argc, const_cast<const char**>(argv),
+                            flag_list) ||
+      input_model.empty() || output_header.empty() || output_source.empty()) {
+    fprintf(stderr, "%s",
+            tflite::Flags::Usage(argv[0], flag_list).c_str());
+    return 1;
+  }
+
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      tflite::FlatBufferModel::BuildFromFile(input_model.c_str());
+  if (!model) {
+    fprintf(stderr, "Could not read the model from %s\n", input_model.c_str());
+    return 1;
+  }
+  std::string header;
+  std::string source;
+  if (tflite::GenerateStaticModel(model->GetModel(), options, &header,
+                                  &source, tflite::DefaultErrorReporter()) !=
+      kTfLiteOk) {
+    return 1;
+  }
+  std::ofstream(output_header) << header;
+  std::ofstream(output_source) << source;
+  return 0;
+}
@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that code generated by generate_static_model for
+// testdata/multi_add.bin computes the same outputs as the interpreter.
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/tools/multi_add_static_model.h"
+
+namespace tflite {
+namespace {
+
+TEST(GenStaticModelMultiAddTest, MatchesInterpreter) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver)(&interpreter), kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+
+  MultiAddStaticModel static_model;
+  const int num_inputs = MultiAddStaticModel::kNumInputs;
+  const int num_outputs = MultiAddStaticModel::kNumOutputs;
+  ASSERT_EQ(interpreter->inputs().size(), num_inputs);
+  ASSERT_EQ(interpreter->outputs().size(), num_outputs);
+
+  // Run twice, since the generated code reuses input buffers.
+  for (int run = 0; run < 2; ++run) {
+    float* static_inputs[] = {static_model.input0(), static_model.input1(),
+                              static_model.input2(), static_model.input3()};
+    for (int i = 0; i < num_inputs; ++i) {
+      float* input = interpreter->typed_input_tensor<float>(i);
+      for (int j = 0; j < MultiAddStaticModel::kInput0Size; ++j) {
+        input[j] = static_inputs[i][j] = run + i * 0.5f + j * 0.25f;
+      }
+    }
+    ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+    static_model.Invoke();
+
+    const float* static_outputs[] = {static_model.output0(),
+                                     static_model.output1()};
+    for (int i = 0; i < num_outputs; ++i) {
+      const float* output = interpreter->typed_output_tensor<float>(i);
+      for (int j = 0; j < MultiAddStaticModel::kOutput0Size; ++j) {
+        EXPECT_EQ(static_outputs[i][j], output[j]) << i << " " << j;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,95 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/gen_static_model.h"
+
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/stderr_reporter.h"
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+namespace tflite {
+namespace {
+
+class GenStaticModelTest : public ::testing::Test {
+ protected:
+  TfLiteStatus Generate(const string& model_path) {
+    model_ = FlatBufferModel::BuildFromFile(model_path.c_str());
+    if (!model_) return kTfLiteError;
+    options_.class_name = "MyModel";
+    options_.namespace_name = "foo::bar";
+    options_.header_path = "my_model.h";
+    return GenerateStaticModel(model_->GetModel(), options_, &header_,
+                               &source_, DefaultErrorReporter());
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  StaticModelOptions options_;
+  string header_;
+  string source_;
+};
+
+TEST_F(GenStaticModelTest, Add) {
+  ASSERT_EQ(Generate("tensorflow/lite/testdata/add.bin"), kTfLiteOk);
+  EXPECT_THAT(header_, HasSubstr("namespace foo {\nnamespace bar {\n"));
+  EXPECT_THAT(header_, HasSubstr("class MyModel {"));
+  EXPECT_THAT(header_, HasSubstr("static constexpr int kNumInputs = 1;"));
+  EXPECT_THAT(header_, HasSubstr("static constexpr int kNumOutputs = 1;"));
+  EXPECT_THAT(header_, HasSubstr("static constexpr int kInput0Size = 192;"));
+  EXPECT_THAT(header_, HasSubstr("float* input0()"));
+  EXPECT_THAT(header_, HasSubstr("const float* output0() const"));
+  // The input, the intermediate and the output are all live during the
+  // second ADD.
+  EXPECT_THAT(header_, HasSubstr("static constexpr int kArenaSize = 2304;"));
+
+  EXPECT_THAT(source_, HasSubstr("#include \"my_model.h\""));
+  EXPECT_THAT(source_, HasSubstr("void MyModel::Invoke() {"));
+  EXPECT_THAT(source_,
+              HasSubstr("constexpr std::int32_t kShape1[] = {1, 8, 8, 3};"));
+  EXPECT_THAT(source_,
+              HasSubstr("reference_ops::Add(params, RuntimeShape(4, kShape1), "
+                        "t1, RuntimeShape(4, kShape1), t1, "
+                        "RuntimeShape(4, kShape0), t0);"));
+}
+
+TEST_F(GenStaticModelTest, ReusesArena) {
+  ASSERT_EQ(Generate("tensorflow/lite/testdata/multi_add.bin"), kTfLiteOk);
+  // Seven tensors of 768 bytes, but at most five are live at once.
+  EXPECT_THAT(header_, HasSubstr("static constexpr int kArenaSize = 3840;"));
+  EXPECT_THAT(header_, HasSubstr("float* input3()"));
+  EXPECT_THAT(header_, HasSubstr("const float* output1() const"));
+  EXPECT_THAT(header_, Not(HasSubstr("input4")));
+}
+
+TEST_F(GenStaticModelTest, UnsupportedModels) {
+  // Custom op.
+  EXPECT_EQ(Generate("tensorflow/lite/testdata/test_model.bin"), kTfLiteError);
+  // Dynamic shapes.
+  EXPECT_EQ(Generate("tensorflow/lite/testdata/dynamic_shapes.bin"),
+            kTfLiteError);
+  // Quantized tensors.
+  EXPECT_EQ(Generate("tensorflow/lite/testdata/add_quantized.bin"),
+            kTfLiteError);
+  // Several subgraphs.
+  EXPECT_EQ(Generate("tensorflow/lite/testdata/2_subgraphs.bin"),
+            kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
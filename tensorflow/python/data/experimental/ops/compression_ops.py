@@ -21,11 +21,14 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 
-def compress(element):
+def compress(element, compression="SNAPPY"):
   """Compress a dataset element.
 
   Args:
     element: A nested structure of types supported by Tensorflow.
+    compression: (Optional.) How to compress the element. One of "SNAPPY",
+      "NONE" to leave it uncompressed, or "AUTO" to leave it uncompressed if
+      snappy does not shrink it significantly.
 
   Returns:
     A variant tensor representing the compressed element. This variant can be
@@ -33,7 +36,7 @@ def compress(element):
   """
   element_spec = structure.type_spec_from_value(element)
   tensor_list = structure.to_tensor_list(element_spec, element)
-  return ged_ops.compress_element(tensor_list)
+  return ged_ops.compress_element(tensor_list, compression=compression)
 
 
 def uncompress(element, output_spec):
@@ -249,7 +249,8 @@ def _distribute(processing_mode,
                 service,
                 job_name=None,
                 max_outstanding_requests=None,
-                task_refresh_interval_hint_ms=None):
+                task_refresh_interval_hint_ms=None,
+                compression="SNAPPY"):
   """A transformation that moves dataset processing to the tf.data service.
 
   This transformation is similar to `distribute`, but supports additional
@@ -271,6 +272,11 @@ def _distribute(processing_mode,
       `max_outstanding_requests` of memory.
     task_refresh_interval_hint_ms: (Optional.) A hint for how often to query the
       dispatcher for task changes.
+    compression: (Optional.) How to compress the elements sent by the tf.data
+      workers. One of "SNAPPY", "NONE" to save the CPU time of compressing and
+      uncompressing elements when network bandwidth is not a bottleneck, or
+      "AUTO" to only send compressed the elements that snappy shrinks
+      significantly.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
@@ -278,7 +284,7 @@ def _distribute(processing_mode,
   ProcessingMode.validate(processing_mode)
 
   def _apply_fn(dataset):  # pylint: disable=missing-docstring
-    dataset_id = register_dataset(service, dataset)
+    dataset_id = _register_dataset(service, dataset, compression=compression)
     return _from_dataset_id(
         processing_mode,
         service,
@@ -460,6 +466,11 @@ def register_dataset(service, dataset):
   Returns:
     A scalar int64 tensor of the registered dataset's id.
   """
+  return _register_dataset(service, dataset, compression="SNAPPY")
+
+
+def _register_dataset(service, dataset, compression):
+  """Registers a dataset, compressing its elements with `compression`."""
   protocol, address = _parse_service(service)
   external_state_policy = dataset.options().experimental_external_state_policy
   if external_state_policy is None:
@@ -469,7 +480,8 @@ def register_dataset(service, dataset):
   # be sent over the network.
   # TODO(b/157105111): Make this an autotuned parallel map when we have a way
   # to limit memory usage.
-  dataset = dataset.map(lambda *x: compression_ops.compress(x))
+  dataset = dataset.map(
+      lambda *x: compression_ops.compress(x, compression=compression))
   # Prefetch one compressed element to reduce latency when requesting data
   # from tf.data workers.
   # TODO(b/157105111): Set this to autotune when we have a way to limit
@@ -746,6 +746,27 @@ class BinaryOpTest(test.TestCase):
   def testBCast_15D(self):
     self._testBCastD([10, 3, 1, 2], [3, 1, 2])
 
+  @test_util.run_deprecated_v1
+  def testBCastWideRowsAndColumns(self):
+    # Rows long enough for the CPU kernels to broadcast them one at a time.
+    funcs = [
+        (np.add, math_ops.add),
+        (np.subtract, math_ops.subtract),
+        (np.maximum, math_ops.maximum),
+        (np.true_divide, math_ops.truediv),
+    ]
+    shapes = [([5, 300], [300]), ([5, 300], [5, 1]), ([2, 3, 4, 160], [160]),
+              ([2, 3, 160], [2, 3, 1])]
+    for xs, ys in shapes:
+      for dtype in [np.float32, np.float64, np.int64]:
+        x = (1 + np.linspace(0, 5, np.prod(xs))).astype(dtype).reshape(xs)
+        y = (1 + np.linspace(0, 5, np.prod(ys))).astype(dtype).reshape(ys)
+        for np_func, tf_func in funcs:
+          self._compareCpu(x, y, np_func, tf_func)
+          self._compareCpu(y, x, np_func, tf_func)
+          self._compareGpu(x, y, np_func, tf_func)
+          self._compareGpu(y, x, np_func, tf_func)
+
   @test_util.run_deprecated_v1
   def testMismatchedDimensions(self):
     for func in [
@@ -211,6 +211,34 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
         resource_variable_ops.assign_variable_op(
             handle, constant_op.constant([1.], dtype=dtypes.float32))
 
+  def testReadOnlyVariable(self):
+    with context.eager_mode():
+      handle = resource_variable_ops.var_handle_op(
+          dtype=dtypes.float32, shape=[3], name="foo")
+      resource_variable_ops.assign_variable_op(
+          handle, constant_op.constant([1., 2., 3.]), read_only=True)
+      self.assertAllEqual(
+          resource_variable_ops.read_variable_op(handle, dtype=dtypes.float32),
+          [1., 2., 3.])
+      self.assertAllEqual(
+          resource_variable_ops.resource_gather(
+              handle, [2, 0], dtype=dtypes.float32), [3., 1.])
+      with self.assertRaisesRegex(errors.FailedPreconditionError,
+                                  "read-only variable"):
+        resource_variable_ops.assign_add_variable_op(
+            handle, constant_op.constant([1., 1., 1.]))
+      with self.assertRaisesRegex(errors.FailedPreconditionError,
+                                  "read-only variable"):
+        resource_variable_ops.resource_scatter_update(
+            handle, [0], constant_op.constant([5.]))
+      with self.assertRaisesRegex(errors.FailedPreconditionError,
+                                  "read-only variable"):
+        resource_variable_ops.assign_variable_op(
+            handle, constant_op.constant([4., 5., 6.]))
+      self.assertAllEqual(
+          resource_variable_ops.read_variable_op(handle, dtype=dtypes.float32),
+          [1., 2., 3.])
+
   def testRepr(self):
     with context.eager_mode():
       v = resource_variable_ops.ResourceVariable(1)
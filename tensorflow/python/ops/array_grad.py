@@ -588,6 +588,27 @@ def _GatherGrad(op, grad):
   return [ops.IndexedSlices(values, indices, params_shape), None]
 
 
+@ops.RegisterGradient("GroupedGather")
+def _GroupedGatherGrad(op, *grads):
+  """Gradient for GroupedGather op."""
+  n = op.get_attr("N")
+  params_grads = []
+  for params, indices, grad in zip(op.inputs[:n], op.inputs[n:], grads):
+    if grad is None:
+      params_grads.append(None)
+      continue
+    with ops.colocate_with(params):
+      params_shape = array_ops.shape(params, out_type=ops.dtypes.int64)
+      params_shape = math_ops.cast(params_shape, dtypes.int32)
+    size = array_ops.expand_dims(array_ops.size(indices), 0)
+    values_shape = array_ops.concat([size, params_shape[1:]], 0)
+    values = array_ops.reshape(
+        _IndexedSlicesToTensorNoWarning(grad), values_shape)
+    indices = array_ops.reshape(indices, size)
+    params_grads.append(ops.IndexedSlices(values, indices, params_shape))
+  return params_grads + [None] * n
+
+
 def _GetBatchIndices(params_shape, indices, batch_dims):
   """Addds the batch offsets to the given indices and returns the results."""
   batch_indices = indices
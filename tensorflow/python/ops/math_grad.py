@@ -387,6 +387,18 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("SparseEmbeddingLookupCombine")
+def _SparseEmbeddingLookupCombineGrad(op, grad):
+  """Gradient for SparseEmbeddingLookupCombine, with one row per distinct id."""
+  params = op.inputs[0]
+  with ops.colocate_with(params):
+    params_shape = array_ops.shape(params, out_type=ops.dtypes.int64)
+    params_shape = math_ops.cast(params_shape, dtypes.int32)
+  values, unique_ids = gen_math_ops.sparse_embedding_lookup_combine_grad(
+      grad, op.inputs[1], op.inputs[2], combiner=op.get_attr("combiner"))
+  return (ops.IndexedSlices(values, unique_ids, params_shape), None, None, None)
+
+
 def _SegmentMinOrMaxGrad(op, grad):
   """ Gradient for SegmentMin and SegmentMax. """
   zeros = array_ops.zeros_like(op.inputs[0], dtype=op.inputs[0].dtype)
@@ -2168,6 +2168,24 @@ def _GatherGrad(op, grad):
   return (ops.IndexedSlices(values, indices, params_shape), None)
 
 
+@ops.RegisterGradient("ResourceGroupedGather")
+def _GroupedGatherGrad(op, *grads):
+  """Gradient for grouped gather op."""
+  n = op.get_attr("N")
+  params_grads = []
+  for handle, indices, grad in zip(op.inputs[:n], op.inputs[n:], grads):
+    if grad is None:
+      params_grads.append(None)
+      continue
+    params_shape = variable_shape(handle)
+    size = array_ops.expand_dims(array_ops.size(indices), 0)
+    values_shape = array_ops.concat([size, params_shape[1:]], 0)
+    values = array_ops.reshape(grad, values_shape)
+    indices = array_ops.reshape(indices, size)
+    params_grads.append(ops.IndexedSlices(values, indices, params_shape))
+  return params_grads + [None] * n
+
+
 def _to_proto_fn(v, export_scope=None):
   """Converts Variable and ResourceVariable to VariableDef for collections."""
   return v.to_proto(export_scope=export_scope)
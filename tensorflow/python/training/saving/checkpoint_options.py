@@ -39,9 +39,10 @@ class CheckpointOptions(object):
   """
 
   # Define object attributes in __slots__ for improved memory and performance.
-  __slots__ = ("experimental_io_device",)
+  __slots__ = ("experimental_io_device", "experimental_enable_async_checkpoint")
 
-  def __init__(self, experimental_io_device=None):
+  def __init__(self, experimental_io_device=None,
+               experimental_enable_async_checkpoint=False):
     """Creates an object that stores options for a Checkpoint.
 
     Args:
@@ -54,5 +55,16 @@ class CheckpointOptions(object):
         This is for example useful if you want to save to a local directory,
         such as "/tmp" when running in a distributed setting. In that case pass
         a device for the host where the "/tmp" directory is accessible.
+      experimental_enable_async_checkpoint: bool. Applies when executing
+        eagerly. If `True`, saving only snapshots the values to save, and
+        returns while they are written to the filesystem on a background
+        thread, so that the next training steps overlap the write. The next
+        save or restore waits for the write, and raises its error if it
+        failed. The snapshot aliases the variable values, which makes the
+        first update of each variable after a save copy it. `Checkpoint.save`
+        updates the state read by `tf.train.latest_checkpoint` once the write
+        succeeds.
     """
     self.experimental_io_device = experimental_io_device
+    self.experimental_enable_async_checkpoint = (
+        experimental_enable_async_checkpoint)
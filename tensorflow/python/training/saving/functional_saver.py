@@ -18,8 +18,12 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import atexit
+import threading
 import uuid
 
+from six.moves import queue
+
 from tensorflow.core.protobuf import saver_pb2
 from tensorflow.python.eager import context
 from tensorflow.python.eager import def_function
@@ -35,9 +39,82 @@ from tensorflow.python.training.saving import checkpoint_options
 from tensorflow.python.training.saving import saveable_hook
 from tensorflow.python.training.saving import saveable_object
 from tensorflow.python.training.saving import saveable_object_util
+from tensorflow.python.platform import tf_logging as logging
 from tensorflow.python.util import nest
 
 
+class _AsyncSaveQueue(object):
+  """Runs the writes of asynchronous saves, in order, on a background thread.
+
+  Once a write fails, the writes queued after it are skipped until `sync()`
+  reports the error.
+  """
+
+  def __init__(self):
+    self._lock = threading.Lock()
+    self._queue = queue.Queue()
+    self._thread = None
+    self._error = None
+
+  def put(self, fn):
+    """Runs `fn` after the writes queued before it."""
+    with self._lock:
+      if self._thread is None:
+        self._thread = threading.Thread(
+            target=self._run, name="async_checkpoint_writer")
+        self._thread.daemon = True
+        self._thread.start()
+    self._queue.put(fn)
+
+  def _run(self):
+    while True:
+      fn = self._queue.get()
+      try:
+        if self._error is None:
+          fn()
+      except Exception as e:  # pylint: disable=broad-except
+        self._error = e
+      finally:
+        self._queue.task_done()
+
+  def sync(self):
+    """Waits for the queued writes, and raises the error of a failed one."""
+    self._queue.join()
+    error, self._error = self._error, None
+    if error is not None:
+      raise error
+
+
+_ASYNC_SAVES = _AsyncSaveQueue()
+
+
+def sync_async_saves():
+  """Blocks until all asynchronous checkpoint saves are written.
+
+  Saves and restores call this before they start, so it only needs to be
+  called explicitly before reading checkpoint files some other way.
+
+  Raises:
+    The error of the first asynchronous save that failed since the last call.
+  """
+  _ASYNC_SAVES.sync()
+
+
+def run_after_async_saves(fn):
+  """Runs `fn` on the writer thread once the pending async saves succeed."""
+  _ASYNC_SAVES.put(fn)
+
+
+def _sync_async_saves_at_exit():
+  try:
+    _ASYNC_SAVES.sync()
+  except Exception as e:  # pylint: disable=broad-except
+    logging.error("Asynchronous checkpoint save failed: %s", e)
+
+
+atexit.register(_sync_async_saves_at_exit)
+
+
 class _SingleDeviceSaver(object):
   """Saves and restores checkpoints from the current device."""
 
@@ -79,6 +156,28 @@ class _SingleDeviceSaver(object):
     with ops.device(save_device):
       return io_ops.save_v2(file_prefix, tensor_names, tensor_slices, tensors)
 
+  def snapshot(self):
+    """Returns a saver for host copies of the current values to save.
+
+    Copies on the host alias the variable buffers instead of copying them: the
+    next update of a variable then copies it, since the buffer is shared.
+
+    Returns:
+      A `_SingleDeviceSaver` whose tensors no longer change.
+    """
+    saveables = []
+    for saveable in self._saveable_objects:
+      specs = []
+      for spec in saveable.specs:
+        tensor = spec.tensor
+        with ops.device(saveable_object_util.set_cpu0(spec.device)):
+          tensor = array_ops.identity(tensor)
+        specs.append(saveable_object.SaveSpec(
+            tensor, spec.slice_spec, spec.name, dtype=spec.dtype))
+      saveables.append(saveable_object.SaveableObject(
+          saveable.op, specs, saveable.name))
+    return _SingleDeviceSaver(saveables)
+
   def restore(self, file_prefix, options=None):
     """Restore the saveable objects from a checkpoint with `file_prefix`.
 
@@ -212,6 +311,8 @@ class MultiDeviceSaver(object):
       An `Operation`, or None when executing eagerly.
     """
     options = options or checkpoint_options.CheckpointOptions()
+    if context.executing_eagerly():
+      sync_async_saves()
     for callback in self._before_save_callbacks:
       callback()
 
@@ -251,14 +352,14 @@ class MultiDeviceSaver(object):
       tmp_checkpoint_prefix = string_ops.string_join(
           [file_prefix, sharded_suffix])
 
-    def save_fn():
-      num_shards = len(self._single_device_savers)
+    def save_fn(single_device_savers):
+      num_shards = len(single_device_savers)
       sharded_saves = []
       sharded_prefixes = []
       num_shards_tensor = constant_op.constant(num_shards, name="num_shards")
       last_device = None
       for shard, (device, saver) in enumerate(
-          sorted(self._single_device_savers.items())):
+          sorted(single_device_savers.items())):
         last_device = device
         with ops.device(saveable_object_util.set_cpu0(device)):
           shard_prefix = sharded_filename(tmp_checkpoint_prefix, shard,
@@ -287,14 +388,27 @@ class MultiDeviceSaver(object):
     # cases where it is needed: eager and when there are multiple tasks/single
     # device savers. Note that the retrace is needed to ensure we pickup the
     # latest values of options like experimental_io_device.
-    if context.executing_eagerly() and len(self._single_device_savers) > 1:
-      # Explicitly place the identity op on the first device.
-      @def_function.function(experimental_compile=False)
-      def tf_function_save():
-        save_fn()
-      tf_function_save()
+    def eager_save(single_device_savers):
+      if len(single_device_savers) > 1:
+        # Explicitly place the identity op on the first device.
+        @def_function.function(experimental_compile=False)
+        def tf_function_save():
+          save_fn(single_device_savers)
+        tf_function_save()
+      else:
+        save_fn(single_device_savers)
+
+    if not context.executing_eagerly():
+      return save_fn(self._single_device_savers)
+    if options.experimental_enable_async_checkpoint:
+      # Only the snapshot of the values blocks the caller, so that training can
+      # go on updating the variables while they are written.
+      snapshots = {}
+      for device, saver in self._single_device_savers.items():
+        snapshots[device] = saver.snapshot()
+      run_after_async_saves(lambda: eager_save(snapshots))
     else:
-      return save_fn()
+      eager_save(self._single_device_savers)
 
   def restore(self, file_prefix, options=None):
     """Restore the saveable objects from a checkpoint with `file_prefix`.
@@ -308,6 +422,8 @@ class MultiDeviceSaver(object):
       A dictionary mapping from SaveableObject names to restore operations.
     """
     options = options or checkpoint_options.CheckpointOptions()
+    if context.executing_eagerly():
+      sync_async_saves()
 
     def restore_fn():
       restore_ops = {}
@@ -26,6 +26,7 @@ from tensorflow.python.eager import test
 from tensorflow.python.eager import wrap_function
 from tensorflow.python.framework import config
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import resource_variable_ops
@@ -189,6 +190,45 @@ class SaverTest(test.TestCase):
         if op.type in ("SaveV2", "RestoreV2", "MergeV2Checkpoints"):
           self.assertEqual(LOCALHOST, op.device)
 
+  def test_async_save_writes_snapshot(self):
+    with ops.device("cpu:0"):
+      v0 = resource_variable_ops.ResourceVariable(0.)
+    with ops.device("cpu:1"):
+      v1 = resource_variable_ops.ResourceVariable(1.)
+    saver = functional_saver.MultiDeviceSaver(
+        list(saveable_object_util.saveable_objects_for_op(v0, "v0")) +
+        list(saveable_object_util.saveable_objects_for_op(v1, "v1")))
+    prefix = os.path.join(self.get_temp_dir(), "ckpt")
+    options = checkpoint_options.CheckpointOptions(
+        experimental_enable_async_checkpoint=True)
+    saver.save(constant_op.constant(prefix), options)
+    # Updates after save() returns are not part of the checkpoint.
+    v0.assign_add(10.)
+    v1.assign(-1.)
+    functional_saver.sync_async_saves()
+    self.assertEqual(2, len(gfile.Glob(prefix + "*")))
+    v0.assign(-1.)
+    saver.restore(constant_op.constant(prefix))
+    self.assertEqual(0., self.evaluate(v0))
+    self.assertEqual(1., self.evaluate(v1))
+
+  def test_async_save_error_is_raised_on_sync(self):
+    v0 = resource_variable_ops.ResourceVariable(0.)
+    saver = functional_saver.MultiDeviceSaver(
+        saveable_object_util.saveable_objects_for_op(v0, "v0"))
+    # A checkpoint can't be written under a regular file.
+    not_a_dir = os.path.join(self.get_temp_dir(), "not_a_dir")
+    with gfile.GFile(not_a_dir, "w") as f:
+      f.write("")
+    prefix = os.path.join(not_a_dir, "ckpt")
+    options = checkpoint_options.CheckpointOptions(
+        experimental_enable_async_checkpoint=True)
+    saver.save(constant_op.constant(prefix), options)
+    with self.assertRaises(errors_impl.OpError):
+      functional_saver.sync_async_saves()
+    # The error is only reported once.
+    functional_saver.sync_async_saves()
+
   def test_callbacks_run(self):
     #  Use dict because an int would be shadowed inside callback.
     called = {
@@ -2099,11 +2099,20 @@ class Checkpoint(tracking.AutoTrackable):
       checkpoint_number = assign_op.numpy()
     file_path = self.write("%s-%d" % (file_prefix, checkpoint_number),
                            options=options)
-    checkpoint_management.update_checkpoint_state_internal(
-        save_dir=os.path.dirname(file_prefix),
-        model_checkpoint_path=file_path,
-        all_model_checkpoint_paths=[file_path],
-        save_relative_paths=True)
+
+    def update_checkpoint_state():
+      checkpoint_management.update_checkpoint_state_internal(
+          save_dir=os.path.dirname(file_prefix),
+          model_checkpoint_path=file_path,
+          all_model_checkpoint_paths=[file_path],
+          save_relative_paths=True)
+
+    if (not graph_building and
+        options.experimental_enable_async_checkpoint):
+      # Only point to the checkpoint once it is written.
+      functional_saver.run_after_async_saves(update_checkpoint_state)
+    else:
+      update_checkpoint_state()
     return file_path
 
   def read(self, save_path, options=None):
@@ -994,6 +994,103 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+#if CUDA_VERSION >= 10010
+  // Only prevent unsafe calls from this thread, so that other streams can keep
+  // being used (and synchronized) while this one is capturing.
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin capturing CUDA stream");
+#else
+  RETURN_IF_CUDA_RES_ERROR(cuStreamBeginCapture(stream),
+                           "Failed to begin capturing CUDA stream");
+#endif
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Stream capture requires CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      GpuGraphHandle* graph) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  *graph = nullptr;
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end capturing CUDA stream");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Stream capture requires CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::DestroyGraph(GpuContext* context,
+                                                  GpuGraphHandle* graph) {
+  if (*graph == nullptr) {
+    return port::Status::OK();
+  }
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphDestroy(*graph),
+                           "Failed to destroy CUDA graph");
+  *graph = nullptr;
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph, GpuGraphExecHandle* exec) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  CHECK(graph != nullptr);
+  *exec = nullptr;
+  RETURN_IF_CUDA_RES_ERROR(cuGraphInstantiate(exec, graph, nullptr, nullptr, 0),
+                           "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle exec,
+                                                 CUstream stream) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  CHECK(exec != nullptr);
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::DestroyGraphExec(
+    GpuContext* context, GpuGraphExecHandle* exec) {
+  if (*exec == nullptr) {
+    return port::Status::OK();
+  }
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphExecDestroy(*exec),
+                           "Failed to destroy CUDA graph executable");
+  *exec = nullptr;
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.0");
+#endif
+}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(GpuContext* context,
                                                           void* host_dst,
                                                           CUdeviceptr gpu_src,
@@ -346,6 +346,44 @@ class GpuDriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(GpuContext* context, GpuStreamHandle stream);
 
+  // Begins capturing the work enqueued onto stream into a graph, via
+  // cuStreamBeginCapture. While the stream is capturing, the work enqueued
+  // onto it is recorded instead of executed, until StreamEndCapture() is
+  // called. Only the calling thread may make unsafe CUDA calls (e.g.
+  // synchronous memory copies) during the capture.
+  //
+  // Requires CUDA 10.0 or later; returns an Unimplemented error otherwise, and
+  // on ROCm.
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends the capture started by StreamBeginCapture(), via cuStreamEndCapture.
+  // On success, *graph holds the captured work, and is owned by the caller
+  // (see DestroyGraph()). If any of the captured work was invalid (e.g. an
+  // operation that is not supported while capturing), an error is returned,
+  // and the stream is no longer capturing.
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Destroys *graph and turns it into a nullptr, via cuGraphDestroy.
+  static port::Status DestroyGraph(GpuContext* context, GpuGraphHandle* graph);
+
+  // Creates an executable graph from graph, via cuGraphInstantiate. *exec is
+  // owned by the caller (see DestroyGraphExec()), and does not depend on graph
+  // once this returns.
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* exec);
+
+  // Enqueues all of the work of exec onto stream, via cuGraphLaunch.
+  static port::Status GraphLaunch(GpuContext* context, GpuGraphExecHandle exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys *exec and turns it into a nullptr, via cuGraphExecDestroy.
+  static port::Status DestroyGraphExec(GpuContext* context,
+                                       GpuGraphExecHandle* exec);
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e
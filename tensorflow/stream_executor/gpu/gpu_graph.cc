@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/stream_executor/gpu/gpu_graph.h"
+
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#include "tensorflow/stream_executor/platform/logging.h"
+#include "tensorflow/stream_executor/stream.h"
+
+namespace stream_executor {
+namespace gpu {
+
+/* static */ port::Status GpuGraph::BeginCapture(Stream* stream) {
+  GpuStream* gpu_stream = AsGpuStream(stream);
+  return GpuDriver::StreamBeginCapture(gpu_stream->parent()->gpu_context(),
+                                       gpu_stream->gpu_stream());
+}
+
+/* static */ port::StatusOr<std::unique_ptr<GpuGraph>> GpuGraph::EndCapture(
+    Stream* stream) {
+  GpuStream* gpu_stream = AsGpuStream(stream);
+  GpuContext* context = gpu_stream->parent()->gpu_context();
+  GpuGraphHandle graph = nullptr;
+  port::Status status =
+      GpuDriver::StreamEndCapture(context, gpu_stream->gpu_stream(), &graph);
+  if (!status.ok()) {
+    // The graph, if any, is incomplete.
+    GpuDriver::DestroyGraph(context, &graph).IgnoreError();
+    return status;
+  }
+  GpuGraphExecHandle exec = nullptr;
+  status = GpuDriver::GraphInstantiate(context, graph, &exec);
+  // The executable graph does not depend on the graph it was instantiated
+  // from.
+  port::Status destroy_status = GpuDriver::DestroyGraph(context, &graph);
+  if (!destroy_status.ok()) {
+    LOG(ERROR) << destroy_status;
+  }
+  if (!status.ok()) {
+    return status;
+  }
+  return std::unique_ptr<GpuGraph>(new GpuGraph(context, exec));
+}
+
+GpuGraph::~GpuGraph() {
+  port::Status status = GpuDriver::DestroyGraphExec(context_, &exec_);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+}
+
+port::Status GpuGraph::Launch(Stream* stream) {
+  return GpuDriver::GraphLaunch(context_, exec_, AsGpuStreamValue(stream));
+}
+
+}  // namespace gpu
+}  // namespace stream_executor
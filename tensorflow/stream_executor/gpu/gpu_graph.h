@@ -0,0 +1,80 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Defines the GpuGraph type, which replays the work captured from a GpuStream
+// with a single launch.
+
+#ifndef TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_GRAPH_H_
+#define TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_GRAPH_H_
+
+#include <memory>
+
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_types.h"
+#include "tensorflow/stream_executor/lib/status.h"
+#include "tensorflow/stream_executor/lib/statusor.h"
+#include "tensorflow/stream_executor/platform/port.h"
+
+namespace stream_executor {
+
+class Stream;
+
+namespace gpu {
+
+// An executable graph of the work that was enqueued onto a stream between
+// BeginCapture() and EndCapture(). Launching the graph enqueues all of that
+// work again, reading and writing the same device memory, at the cost of a
+// single launch.
+//
+// Example:
+//   TF_RETURN_IF_ERROR(GpuGraph::BeginCapture(stream));
+//   ... enqueue kernels onto stream; they are recorded, not executed ...
+//   TF_ASSIGN_OR_RETURN(std::unique_ptr<GpuGraph> graph,
+//                       GpuGraph::EndCapture(stream));
+//   TF_RETURN_IF_ERROR(graph->Launch(stream));  // Runs the recorded work.
+//
+// Thread-compatible.
+class GpuGraph {
+ public:
+  // Starts capturing the work enqueued onto "stream", which must be backed by
+  // a GpuStream, and must not already be capturing.
+  static port::Status BeginCapture(Stream* stream);
+
+  // Stops capturing the work enqueued onto "stream" (see BeginCapture()), and
+  // returns it as an executable graph. On error (e.g. if an operation that
+  // cannot be captured was enqueued), none of the captured work is executed,
+  // and the stream is no longer capturing.
+  static port::StatusOr<std::unique_ptr<GpuGraph>> EndCapture(Stream* stream);
+
+  ~GpuGraph();
+
+  // Enqueues the captured work onto "stream", which must belong to the same
+  // StreamExecutor as the stream it was captured from.
+  port::Status Launch(Stream* stream);
+
+ private:
+  GpuGraph(GpuContext* context, GpuGraphExecHandle exec)
+      : context_(context), exec_(exec) {}
+
+  GpuContext* context_;
+  GpuGraphExecHandle exec_;
+
+  SE_DISALLOW_COPY_AND_ASSIGN(GpuGraph);
+};
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_GRAPH_H_
@@ -59,6 +59,9 @@ using GpuSharedMemConfig = hipSharedMemConfig;
 using GpuComplexType = hipComplex;
 using GpuDoubleComplexType = hipDoubleComplex;
 using GpuRngHandle = hiprandGenerator_t;
+// Stream capture is not supported on ROCm (see GpuDriver::StreamBeginCapture).
+using GpuGraphHandle = void*;
+using GpuGraphExecHandle = void*;
 
 #else  // CUDA
 
@@ -77,6 +80,14 @@ using GpuSharedMemConfig = CUsharedconfig;
 using GpuComplexType = cuComplex;
 using GpuDoubleComplexType = cuDoubleComplex;
 using GpuRngHandle = curandGenerator_t;
+#if CUDA_VERSION >= 10000
+using GpuGraphHandle = CUgraph;
+using GpuGraphExecHandle = CUgraphExec;
+#else
+// Stream capture requires CUDA 10.0 (see GpuDriver::StreamBeginCapture).
+using GpuGraphHandle = void*;
+using GpuGraphExecHandle = void*;
+#endif
 
 #endif
 
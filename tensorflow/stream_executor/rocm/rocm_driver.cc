@@ -831,6 +831,40 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      GpuStreamHandle stream,
+                                                      GpuGraphHandle* graph) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::DestroyGraph(GpuContext* context,
+                                                  GpuGraphHandle* graph) {
+  *graph = nullptr;
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph, GpuGraphExecHandle* exec) {
+  return port::UnimplementedError("Graph launches are not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle exec,
+                                                 GpuStreamHandle stream) {
+  return port::UnimplementedError("Graph launches are not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::DestroyGraphExec(
+    GpuContext* context, GpuGraphExecHandle* exec) {
+  *exec = nullptr;
+  return port::Status::OK();
+}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(
     GpuContext* context, void* host_dst, hipDeviceptr_t gpu_src, uint64 size) {
   ScopedActivateContext activation{context};
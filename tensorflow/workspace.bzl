@@ -810,6 +810,18 @@ def tf_repositories(path_prefix = "", tf_repo_name = ""):
         ],
     )
 
+    tf_http_archive(
+        name = "zstd",
+        build_file = clean_dep("//third_party:zstd.BUILD"),
+        sha256 = "98e91c7c6bf162bf90e4e70fdbc41a8188b9fa8de5ad840c401198014406ce9e",
+        strip_prefix = "zstd-1.4.5",
+        system_build_file = clean_dep("//third_party/systemlibs:zstd.BUILD"),
+        urls = [
+            "https://storage.googleapis.com/mirror.tensorflow.org/github.com/facebook/zstd/releases/download/v1.4.5/zstd-1.4.5.tar.gz",
+            "https://github.com/facebook/zstd/releases/download/v1.4.5/zstd-1.4.5.tar.gz",
+        ],
+    )
+
     tf_http_archive(
         name = "nccl_archive",
         build_file = clean_dep("//third_party:nccl/archive.BUILD"),
@@ -44,6 +44,7 @@ VALID_LIBS = [
     "termcolor_archive",
     "wrapt",
     "zlib",
+    "zstd",
 ]
 
 def auto_configure_fail(msg):